@@ -41,6 +41,14 @@ enum CoreSettings : uint32_t
     GaplessPlayback     = 10 | Type::Bool,
     Language            = 11 | Type::String,
     BufferLength        = 12 | Type::Int,
+    ReplayGainMode      = 13 | Type::Int,
+    ReplayGainPreAmp    = 14 | Type::Double,
+    OutputSampleRate    = 15 | Type::Int,
+    ResampleQuality     = 16 | Type::Int,
+    DspChain            = 17 | Type::StringList,
+    RealtimePlayback    = 18 | Type::Bool,
+    BitPerfect          = 19 | Type::Bool,
+    PerPlaylistQueue    = 20 | Type::Bool,
 };
 Q_ENUM_NS(CoreSettings)
 } // namespace Fooyin::Settings::Core
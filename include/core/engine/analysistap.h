@@ -0,0 +1,98 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audioformat.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Holds the most recent audio sent to the output, for visualisations such as spectrums and VU meters.
+ *
+ * The renderer writes into it from whichever thread feeds the output, and readers copy from it at
+ * their own rate (e.g. once per frame). Neither side ever blocks: readers use a sequence counter to
+ * detect a write that overlapped their copy and simply retry.
+ *
+ * Every write is stamped with the time its first frame will be heard, so readers can ask for the audio
+ * playing at a given steady_clock time, the same clock used for playback position.
+ */
+class FYCORE_EXPORT AnalysisTap
+{
+public:
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    // Frames of history kept, enough for an 8192 point FFT with room to spare
+    static constexpr int Capacity = 16384;
+    // Audio with more channels than this isn't captured
+    static constexpr int MaxChannels = 8;
+
+    AnalysisTap();
+
+    AnalysisTap(const AnalysisTap& other)            = delete;
+    AnalysisTap& operator=(const AnalysisTap& other) = delete;
+
+    /*!
+     * Appends @p frameCount frames of @p data, which will start being heard at @p audibleAt.
+     * @note writer only. This doesn't allocate, so is safe to call from an audio callback.
+     */
+    void write(const AudioFormat& format, const std::byte* data, int frameCount, TimePoint audibleAt);
+    /*!
+     * Discards the history, e.g. after a seek. Applied on the next @fn write.
+     * @note this is thread-safe.
+     */
+    void clear();
+
+    /** Returns the format of the captured audio, which is invalid if nothing has been captured. */
+    [[nodiscard]] AudioFormat format() const;
+
+    /*!
+     * Copies the last @p frameCount frames heard at @p time into @p data as interleaved floats.
+     * Frames before the start of the captured history are filled with silence.
+     * @note this is thread-safe and lock-free.
+     * @returns the format of the copied audio, which is invalid if nothing could be copied, or if
+     * @p data is too small to hold @p frameCount frames.
+     */
+    AudioFormat read(std::span<float> data, int frameCount, TimePoint time = Clock::now()) const;
+
+private:
+    std::vector<float> m_samples;
+
+    std::atomic<uint32_t> m_sequence{0};
+    // Format and timing of the captured audio, guarded by m_sequence
+    std::atomic<int> m_sampleRate{0};
+    std::atomic<int> m_channels{0};
+    std::atomic<uint64_t> m_writePos{0};
+    // Frame position and time at which the most recent write starts being heard
+    std::atomic<uint64_t> m_anchorPos{0};
+    std::atomic<int64_t> m_anchorTime{0};
+
+    std::atomic<uint32_t> m_clearRequest{0};
+    // Writer only
+    uint32_t m_clearSeen{0};
+};
+} // namespace Fooyin
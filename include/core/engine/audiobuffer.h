@@ -25,16 +25,30 @@
 
 #include <QExplicitlySharedDataPointer>
 
+#include <memory>
 #include <span>
 
 namespace Fooyin {
 class FYCORE_EXPORT AudioBuffer
 {
 public:
+    enum class RampCurve : uint8_t
+    {
+        Linear,
+        // Constant perceived loudness when crossfading with the inverse ramp
+        EqualPower,
+    };
+
     AudioBuffer();
     AudioBuffer(AudioFormat format, uint64_t startTime);
     AudioBuffer(std::span<const std::byte> data, AudioFormat format, uint64_t startTime);
     AudioBuffer(const uint8_t* data, size_t size, AudioFormat format, uint64_t startTime);
+    /*!
+     * Wraps @p data without copying it. @p owner is kept alive for as long as the data is referenced.
+     * @note the data is copied into storage owned by the buffer on the first modification.
+     */
+    AudioBuffer(std::span<const std::byte> data, std::shared_ptr<const void> owner, AudioFormat format,
+                uint64_t startTime);
     ~AudioBuffer();
 
     AudioBuffer(const AudioBuffer& other);
@@ -50,13 +64,19 @@ public:
     void reset();
 
     [[nodiscard]] bool isValid() const;
+    /** Returns true if the buffer references data it doesn't own. */
+    [[nodiscard]] bool isExternal() const;
     void detach();
 
+    /** Returns @p size bytes starting at @p offset. Wrapped data is shared rather than copied. */
+    [[nodiscard]] AudioBuffer slice(int offset, int size) const;
+
     [[nodiscard]] AudioFormat format() const;
     [[nodiscard]] int frameCount() const;
     [[nodiscard]] int sampleCount() const;
     [[nodiscard]] int byteCount() const;
     [[nodiscard]] uint64_t startTime() const;
+    void setStartTime(uint64_t startTime);
     [[nodiscard]] uint64_t duration() const;
 
     [[nodiscard]] std::span<const std::byte> constData() const;
@@ -66,10 +86,20 @@ public:
     void fillSilence();
     void fillRemainingWithSilence();
     void scale(double volume);
+    /** Scales the buffer by a gain moving from @p startVolume to @p endVolume over its length. */
+    void scale(double startVolume, double endVolume, RampCurve curve = RampCurve::Linear);
 
 private:
     struct Private;
     QExplicitlySharedDataPointer<Private> p;
 };
 using AudioData = std::vector<AudioBuffer>;
+
+namespace Audio {
+/*!
+ * Scales @p frameCount interleaved frames of @p data in place.
+ * For outputs which render directly into memory they don't own, such as a DMA area.
+ */
+FYCORE_EXPORT void scale(const AudioFormat& format, std::byte* data, int frameCount, double volume);
+} // namespace Audio
 } // namespace Fooyin
@@ -27,8 +27,12 @@ namespace Fooyin {
 class AudioFormat;
 
 namespace Audio {
-FYCORE_EXPORT AudioBuffer convert(const AudioBuffer& buffer, const AudioFormat& outputFormat);
+/*!
+ * Converts @p buffer to @p outputFormat.
+ * If @p dither is set, TPDF dither is applied when reducing float samples to S16.
+ */
+FYCORE_EXPORT AudioBuffer convert(const AudioBuffer& buffer, const AudioFormat& outputFormat, bool dither = false);
 FYCORE_EXPORT bool convert(const AudioFormat& inputFormat, const std::byte* input, const AudioFormat& outputFormat,
-                           std::byte* output, int sampleCount);
+                           std::byte* output, int sampleCount, bool dither = false);
 }; // namespace Audio
 } // namespace Fooyin
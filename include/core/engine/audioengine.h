@@ -21,9 +21,14 @@
 
 #include "fycore_export.h"
 
+#include <core/engine/dspnode.h>
 #include <core/engine/outputplugin.h>
 
+#include <algorithm>
+#include <map>
+
 namespace Fooyin {
+class AnalysisTap;
 class Track;
 
 enum class PlaybackState
@@ -34,6 +39,69 @@ enum class PlaybackState
     Error
 };
 
+/*!
+ * How much decoded audio the engine holds ahead of the output.
+ * The target adapts to how quickly the current source can be read.
+ */
+struct BufferFillState
+{
+    // Both in ms
+    uint64_t buffered{0};
+    uint64_t target{0};
+
+    /** Returns the fill level in the range [0, 1]. */
+    [[nodiscard]] double fill() const
+    {
+        return target > 0 ? std::min(1.0, static_cast<double>(buffered) / static_cast<double>(target)) : 0.0;
+    }
+};
+
+/*!
+ * Timing and buffering figures from the engine, for diagnosing dropouts.
+ * Durations are in microseconds. Maxima and counts cover the whole session.
+ */
+struct EngineStats
+{
+    // Time the decoder took to produce the most recent buffer
+    uint64_t decodeTime{0};
+    uint64_t maxDecodeTime{0};
+    // Frames waiting in the renderer, not yet handed to the output
+    uint64_t queuedFrames{0};
+    // As last reported by the output. Only available for outputs which are written to.
+    int outputFreeSamples{0};
+    int outputQueuedSamples{0};
+    // How long audio handed to the output takes to be heard
+    uint64_t outputLatency{0};
+    // How far behind its interval the most recent write to the output ran
+    uint64_t timerLateness{0};
+    uint64_t maxTimerLateness{0};
+    // Times the output ran out of audio during playback
+    uint64_t underruns{0};
+    // Underruns for each output used this session, keyed by output name. Only filled in by EngineController.
+    std::map<QString, uint64_t> outputUnderruns;
+};
+
+/*!
+ * Describes what happens to decoded audio on its way to the output.
+ * Playback is bit-perfect when the output receives exactly the samples that were decoded.
+ */
+struct OutputPath
+{
+    AudioFormat source;
+    AudioFormat output;
+    // Bit-perfect playback was requested, but the output couldn't take the source format
+    bool conversionForced{false};
+    // Samples are altered by DSPs, ReplayGain, crossfading or software volume
+    bool processing{false};
+
+    [[nodiscard]] bool bitPerfect() const
+    {
+        return source.isValid() && source == output && !processing;
+    }
+
+    bool operator==(const OutputPath& other) const = default;
+};
+
 enum class TrackStatus
 {
     NoTrack,
@@ -56,20 +124,57 @@ public:
     virtual void seek(uint64_t pos) = 0;
 
     virtual void changeTrack(const Track& track) = 0;
+    /*!
+     * Opens and primes @p track so it can follow the current one without a gap.
+     * Called in response to @fn trackAboutToFinish.
+     */
+    virtual void prepareNextTrack(const Track& track) = 0;
 
     virtual void play()  = 0;
     virtual void pause() = 0;
     virtual void stop()  = 0;
 
     virtual void setVolume(double volume) = 0;
+    /*!
+     * Sets how often (in ms) positionChanged is emitted while playing.
+     * An @p interval of 0 means nothing is displaying the position, so it is only updated occasionally.
+     */
+    virtual void setPositionInterval(int interval) = 0;
+
+    /*!
+     * Returns the current read-ahead state.
+     * @note this is thread-safe.
+     */
+    [[nodiscard]] virtual BufferFillState bufferFill() const = 0;
+
+    /*!
+     * Returns the current timing and buffering figures.
+     * @note this is thread-safe.
+     */
+    [[nodiscard]] virtual EngineStats stats() const = 0;
+
+    /** Returns how the current track reaches the output. */
+    [[nodiscard]] virtual OutputPath outputPath() const = 0;
+
+    /*!
+     * Returns the tap holding the audio most recently sent to the output.
+     * @note the tap itself is thread-safe and outlives the engine's playback.
+     */
+    [[nodiscard]] virtual const AnalysisTap* analysisTap() const = 0;
 
     virtual void setAudioOutput(const OutputCreator& output, const QString& device) = 0;
     virtual void setOutputDevice(const QString& device)                             = 0;
 
+    /** Replaces the DSP chain with nodes created by @p dsps, run in the given order. */
+    virtual void setDsps(const DspCreators& dsps) = 0;
+
 signals:
     void stateChanged(PlaybackState state);
     void trackStatusChanged(TrackStatus status);
     void positionChanged(uint64_t ms);
     void trackAboutToFinish();
+    void outputPathChanged(const OutputPath& path);
+    /** Emitted when an internet stream announces a new title, usually the song now playing. */
+    void streamTitleChanged(const QString& title);
 };
 } // namespace Fooyin
@@ -39,10 +39,29 @@ struct OutputDevice
 {
     QString name;
     QString desc;
+
+    bool operator==(const OutputDevice& other) const = default;
 };
 
 using OutputDevices = std::vector<OutputDevice>;
 
+/*!
+ * Provides rendered audio to outputs which pull data from a real-time callback.
+ * @see AudioOutput::PullMode
+ */
+class FYCORE_EXPORT AudioSource
+{
+public:
+    virtual ~AudioSource() = default;
+
+    /*!
+     * Copies up to @p frameCount frames of audio into @p data.
+     * @note this is lock-free and never blocks, so it is safe to call from an audio thread.
+     * @returns the number of frames copied.
+     */
+    virtual int readFrames(std::byte* data, int frameCount) = 0;
+};
+
 /*!
  * An abstract interface for an audio output driver.
  */
@@ -57,6 +76,26 @@ public:
         Disconnected
     };
 
+    enum Capability
+    {
+        None = 0,
+        /*!
+         * The output requests data itself from a real-time callback using the source set
+         * through @fn setSource, rather than having it written through @fn write.
+         */
+        PullMode = 1 << 0,
+    };
+    Q_DECLARE_FLAGS(Capabilities, Capability)
+
+    /*!
+     * Returns the features supported by this output.
+     * @note the base class implementation returns @c None, i.e. a push-style output.
+     */
+    [[nodiscard]] virtual Capabilities capabilities() const
+    {
+        return None;
+    }
+
     /** Initialises the output with the given @p format. */
     virtual bool init(const AudioFormat& format) = 0;
     /*!
@@ -92,6 +131,19 @@ public:
      *  @note this will only be called if @fn initialised returns @c true.
      */
     virtual int bufferSize() const = 0;
+    /*!
+     * Returns how long (in seconds) until audio handed to the output now is heard, i.e. the delay reported
+     * by the device for everything already queued ahead of it.
+     * This is used to keep the playback position in step with what is actually being heard.
+     * @note in @c PullMode this is called from the output's callback, just before it reads from its source,
+     * so it must not block.
+     * @note the base class implementation returns a negative value, meaning the delay isn't known and is
+     * estimated from @fn bufferSize instead.
+     */
+    [[nodiscard]] virtual double latency() const
+    {
+        return -1.0;
+    }
     /*!
      *  Returns a list of all device names and descriptions for this driver.
      *  @note this may be called on multiple instances, so don't rely on a
@@ -108,6 +160,17 @@ public:
     virtual int write(const AudioBuffer& buffer) = 0;
     virtual void setPaused(bool pause)           = 0;
 
+    /*!
+     * Sets the @p source which a @c PullMode output should read from in its callback.
+     * A @c nullptr source detaches the current one; the output should then render silence.
+     * @note this is only called if @fn capabilities contains @c PullMode.
+     * @note the base class implementation of this function does nothing.
+     */
+    virtual void setSource(AudioSource* source)
+    {
+        Q_UNUSED(source)
+    }
+
     /*!
      * Set's the volume of the audio driver.
      * @note this may be called regardless of the current initialised state.
@@ -125,3 +188,5 @@ signals:
 };
 using OutputCreator = std::function<std::unique_ptr<AudioOutput>()>;
 } // namespace Fooyin
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Fooyin::AudioOutput::Capabilities)
@@ -0,0 +1,72 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audioformat.h>
+
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A single stage of the engine's DSP chain.
+ * Nodes run on the decode thread and process interleaved float samples in place, a block at a time.
+ * The sample rate and channel count stay the same from one node to the next.
+ */
+class FYCORE_EXPORT DspNode
+{
+public:
+    virtual ~DspNode() = default;
+
+    /** Returns the display name of this node. */
+    [[nodiscard]] virtual QString name() const = 0;
+
+    /*!
+     * Called before the first block, and whenever the format changes.
+     * Any memory needed by @fn process should be allocated here.
+     * @param format the format of the audio, always SampleFormat::Float.
+     * @param maxFrames the largest number of frames passed to a single @fn process call.
+     */
+    virtual void prepare(const AudioFormat& format, int maxFrames) = 0;
+
+    /*!
+     * Processes @p frames frames of interleaved samples in @p data in place.
+     * @note this is called on the decode thread and must not block.
+     */
+    virtual void process(std::span<float> data, int frames) = 0;
+
+    /** Returns how many frames the output of this node lags its input by. */
+    [[nodiscard]] virtual int latency() const
+    {
+        return 0;
+    }
+
+    /** Clears any state carried over from previous blocks, e.g. after a seek. */
+    virtual void reset() { }
+};
+using DspCreator  = std::function<std::unique_ptr<DspNode>()>;
+using DspCreators = std::vector<DspCreator>;
+} // namespace Fooyin
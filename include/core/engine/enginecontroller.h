@@ -28,10 +28,48 @@
 
 namespace Fooyin {
 struct AudioOutputBuilder;
+struct DspBuilder;
+class AnalysisTap;
 class AudioDecoder;
 
 using OutputNames = std::vector<QString>;
 
+struct DspInfo
+{
+    QString id;
+    QString name;
+};
+using DspInfos = std::vector<DspInfo>;
+
+enum class ReplayGainMode : uint8_t
+{
+    Off = 0,
+    Track,
+    // Falls back to track gain for tracks without album values
+    Album,
+};
+
+enum class ResampleQuality : uint8_t
+{
+    Fast = 0,
+    Medium,
+    High,
+};
+
+struct BufferPoolStats
+{
+    uint64_t hits{0};
+    uint64_t misses{0};
+    // Bytes currently held for reuse
+    size_t pooledBytes{0};
+
+    [[nodiscard]] double hitRate() const
+    {
+        const uint64_t total = hits + misses;
+        return total > 0 ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+    }
+};
+
 class FYCORE_EXPORT EngineController : public QObject
 {
     Q_OBJECT
@@ -44,7 +82,12 @@ public:
     /** Returns a list of all output names. */
     [[nodiscard]] virtual OutputNames getAllOutputs() const = 0;
 
-    /** Returns a list of all output devices for the given @p output. */
+    /*!
+     * Returns the devices of the given @p output, as last enumerated.
+     * Enumerating can be slow, so it runs in the background and this never blocks. Each call refreshes
+     * the list, and outputDevicesChanged is emitted once it differs from what was returned.
+     * @note the list is empty until @p output has been enumerated once.
+     */
     [[nodiscard]] virtual OutputDevices getOutputDevices(const QString& output) const = 0;
 
     /*!
@@ -53,12 +96,47 @@ public:
      */
     virtual void addOutput(const AudioOutputBuilder& output) = 0;
 
+    /** Returns all DSPs which can be added to the chain, built-in ones first. */
+    [[nodiscard]] virtual DspInfos getAllDsps() const = 0;
+
+    /*!
+     * Adds a DSP which can be enabled in Settings::Core::DspChain.
+     * @note dsp.id must be unique.
+     */
+    virtual void addDsp(const DspBuilder& dsp) = 0;
+
     virtual std::unique_ptr<AudioDecoder> createDecoder() = 0;
 
+    /** Returns how often audio buffer storage was served from the pool rather than the heap. */
+    [[nodiscard]] virtual BufferPoolStats bufferPoolStats() const = 0;
+
+    /** Returns how much audio is decoded ahead of the output, for display of the buffer level. */
+    [[nodiscard]] virtual BufferFillState bufferFill() const = 0;
+
+    /*!
+     * Returns decode, buffering and output timings along with underrun counts for each output.
+     * Cheap enough to be polled at display rate.
+     */
+    [[nodiscard]] virtual EngineStats engineStats() const = 0;
+
+    /*!
+     * Returns how the current track reaches the output, e.g. to show whether playback is bit-perfect.
+     * @see Settings::Core::BitPerfect
+     */
+    [[nodiscard]] virtual OutputPath outputPath() const = 0;
+
+    /*!
+     * Returns the most recent audio sent to the output, for visualisations.
+     * Reading from it never blocks or slows down playback, so it can be polled at display rate.
+     */
+    [[nodiscard]] virtual const AnalysisTap* analysisTap() const = 0;
+
 signals:
     void outputChanged(const QString& output, const QString& device);
     void deviceChanged(const QString& device);
+    void outputDevicesChanged(const QString& output);
     void trackStatusChanged(TrackStatus status);
     void trackAboutToFinish();
+    void outputPathChanged(const OutputPath& path);
 };
 } // namespace Fooyin
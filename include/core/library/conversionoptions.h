@@ -0,0 +1,57 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <cstdint>
+
+namespace Fooyin {
+/*!
+ * How MusicLibrary::convertTracks encodes tracks into new files.
+ *
+ * Converted files keep their folder layout relative to the deepest folder holding every track of the request,
+ * so converting the same tracks again maps each one to the same file.
+ */
+struct ConversionOptions
+{
+    enum class Codec : uint8_t
+    {
+        Opus = 0,
+        Vorbis,
+        Mp3,
+        Aac,
+        Flac,
+    };
+
+    Codec codec{Codec::Opus};
+    // Target bitrate in kbps, ignored by lossless codecs
+    int bitrate{128};
+    // Sample rate to convert to, or 0 to keep the source's where the codec supports it
+    int sampleRate{0};
+    QString outputDirectory;
+    // Replace files which already exist, rather than skipping them as converted by an earlier request
+    bool overwrite{false};
+    // Copy the tags and front cover of each track to its converted file
+    bool copyTags{true};
+    // Hold off while something is playing, so conversion never competes with playback
+    bool pauseDuringPlayback{false};
+};
+} // namespace Fooyin
@@ -0,0 +1,52 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <cstdint>
+
+namespace Fooyin {
+/*!
+ * How MusicLibrary::organiseFiles renames, moves or copies the files of tracks.
+ *
+ * Each track's new path comes from evaluating @c naming for it, with @c / separating folders and its extension
+ * added to the end. Characters which aren't valid in filenames are replaced, and the result is always kept below
+ * the destination folder.
+ */
+struct FileOperationOptions
+{
+    enum class Type : uint8_t
+    {
+        // Files are moved to their new paths and the library follows them
+        Move = 0,
+        // Copies are written to the new paths and left for the library to add like any other file
+        Copy,
+    };
+
+    Type type{Type::Move};
+    // Script giving each track's new path without its extension, e.g. %albumartist%/%album%/%track% - %title%
+    QString naming;
+    // Folder the paths given by @c naming are relative to, or each track's library folder if empty
+    QString destination;
+    // Remove folders left empty once their files have been moved out
+    bool removeEmptyFolders{true};
+};
+} // namespace Fooyin
@@ -0,0 +1,79 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/trackfwd.h>
+
+#include <QStringList>
+
+#include <memory>
+#include <vector>
+
+namespace Fooyin {
+class DbConnectionPool;
+
+/*!
+ * Shares the results of grouping scripts between the views which group the library, e.g. library trees
+ * and filters. Each distinct script is evaluated at most once per track, and the values are kept until the
+ * track is updated or removed, so any number of views using the same script only pay for it once.
+ *
+ * Scripts are evaluated without any playlist or playback context, so the values only depend on the track.
+ * With a persistent store, the values of scripts which don't read playback statistics are also kept on disk,
+ * so unchanged tracks aren't evaluated again after a restart.
+ * @note all methods are thread-safe. Concurrent requests for the same script wait for a single evaluation.
+ */
+class FYCORE_EXPORT GroupingCache
+{
+public:
+    GroupingCache();
+    ~GroupingCache();
+
+    GroupingCache(const GroupingCache& other)            = delete;
+    GroupingCache& operator=(const GroupingCache& other) = delete;
+
+    /*!
+     * Returns the values of @p script for each of @p tracks, in the same order, as from
+     * ScriptParser::evaluateEachValues. Only tracks without a cached result are evaluated.
+     */
+    [[nodiscard]] std::vector<QStringList> values(const QString& script, const TrackList& tracks) const;
+
+    /*!
+     * Keeps the values of scripts which can be persisted in the database of @p pool as well,
+     * see ScriptCacheDatabase. Passing nullptr stops persisting values.
+     */
+    void setPersistentStore(std::shared_ptr<DbConnectionPool> pool);
+
+    /** Discards the values of @p tracks, which are evaluated again when next requested. */
+    void invalidate(const TrackList& tracks);
+    /** Discards the values of @p tracks only for scripts which read playback statistics or the rating. */
+    void invalidateStats(const TrackList& tracks);
+    void clear();
+
+    /** Returns the number of scripts with cached values. */
+    [[nodiscard]] int scriptCount() const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
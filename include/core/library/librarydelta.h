@@ -0,0 +1,66 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/track.h>
+
+namespace Fooyin {
+/*!
+ * A change to every track of one library, described once rather than as a list of each track changed.
+ * Holders of tracks apply it in a single pass over their own, patching those of the library in place.
+ */
+struct FYCORE_EXPORT LibraryDelta
+{
+    enum class Type : uint8_t
+    {
+        // The library was removed: its tracks no longer belong to a library, and those in @c removedIds are gone
+        Removed,
+        // The library's root moved from @c oldPath to @c newPath, along with the paths of its tracks
+        Relocated,
+    };
+
+    Type type{Type::Removed};
+    int libraryId{-1};
+    // Tracks deleted outright, sorted by id
+    TrackIds removedIds;
+    QString oldPath;
+    QString newPath;
+
+    static LibraryDelta removal(int libraryId, TrackIds removedIds);
+    static LibraryDelta relocation(int libraryId, const QString& oldPath, const QString& newPath);
+
+    /** Returns @c true if @p track belongs to the library, so is changed or removed by this delta. */
+    [[nodiscard]] bool affects(const Track& track) const;
+    /** Returns @c true if @p track was deleted by this delta. */
+    [[nodiscard]] bool removes(const Track& track) const;
+
+    /*!
+     * Patches @p track if it belongs to the library.
+     * @returns @c true if @p track was changed.
+     */
+    bool apply(Track& track) const;
+
+    /** Returns @p path moved to the new root if it lies under the old one, otherwise @p path unchanged. */
+    [[nodiscard]] QString relocatedPath(const QString& path) const;
+};
+} // namespace Fooyin
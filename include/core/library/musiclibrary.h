@@ -21,17 +21,27 @@
 
 #include "fycore_export.h"
 
+#include <core/library/conversionoptions.h>
+#include <core/library/fileoperationoptions.h>
+#include <core/library/librarydelta.h>
+#include <core/library/tracksnapshot.h>
 #include <core/track.h>
 
 #include <QObject>
 
 namespace Fooyin {
 struct LibraryInfo;
+class GroupingCache;
+class TrackSearchIndex;
 
 /*!
- * There are two types of scan request:
+ * There are six types of scan request:
  * - Tracks: Scans a TrackList; emits tracksScanned when finished.
  * - Library: Scans an entire library; emits tracksAdded, tracksUpdated, tracksDeleted.
+ * - ReplayGain: Calculates ReplayGain for a TrackList; emits tracksUpdated as each album finishes.
+ * - Metadata: Writes metadata to the files of a TrackList; emits tracksUpdated once when finished.
+ * - Conversion: Converts a TrackList into new files; only reports progress, as the library isn't changed.
+ * - FileOperation: Moves or copies the files of a TrackList; emits tracksUpdated once with the moved tracks.
  * In-progress requests can be cancelled early using cancel().
  */
 struct ScanRequest
@@ -40,6 +50,10 @@ struct ScanRequest
     {
         Tracks = 0,
         Library,
+        ReplayGain,
+        Metadata,
+        Conversion,
+        FileOperation,
     };
 
     Type type;
@@ -87,14 +101,53 @@ public:
      */
     virtual ScanRequest scanTracks(const TrackList& tracks) = 0;
 
-    /** Returns all tracks for all libraries */
+    /*!
+     * Calculates ReplayGain values for @p tracks and writes them to the files and database.
+     * Tracks which already have ReplayGain values are skipped unless @p recalculate is @c true.
+     * @returns a ScanRequest representing a queued calculation.
+     */
+    virtual ScanRequest calculateReplayGain(const TrackList& tracks, bool recalculate) = 0;
+
+    /*!
+     * Converts @p tracks into new files in @c options.outputDirectory, several at a time.
+     * Files converted by an earlier request are skipped unless @c options.overwrite is set, so running a cancelled
+     * request again carries on where it stopped.
+     * @returns a ScanRequest representing a queued conversion.
+     */
+    virtual ScanRequest convertTracks(const TrackList& tracks, const ConversionOptions& options) = 0;
+
+    /*!
+     * Renames, moves or copies the files of @p tracks to the paths given by @c options.naming.
+     * Moves are all or nothing: if any file can't be moved, or the request is cancelled, every file is put back.
+     * Moved tracks are updated in place rather than scanned again.
+     * @returns a ScanRequest representing a queued operation.
+     */
+    virtual ScanRequest organiseFiles(const TrackList& tracks, const FileOperationOptions& options) = 0;
+
+    /** Returns a copy of all tracks for all libraries, see snapshot */
     [[nodiscard]] virtual TrackList tracks() const = 0;
+    /*!
+     * Returns the current snapshot of all tracks for all libraries.
+     * Snapshots are cheap to copy and never change, so this is preferred over tracks() for reading.
+     * @note thread-safe.
+     */
+    [[nodiscard]] virtual TrackSnapshot snapshot() const = 0;
 
     /** Returns a TrackList containing each track (if) found with an id from @p ids  */
     [[nodiscard]] virtual TrackList tracksForIds(const TrackIds& ids) const = 0;
 
-    /** Updates the metdata in the database for @p tracks and writes metdata to files  */
-    virtual void updateTrackMetadata(const TrackList& tracks) = 0;
+    /** Returns the search index of all tracks, kept up to date as tracks are added, updated and removed */
+    [[nodiscard]] virtual const TrackSearchIndex& searchIndex() const = 0;
+
+    /** Returns the values of grouping scripts shared by the views of the library, dropped as tracks change */
+    [[nodiscard]] virtual const GroupingCache& groupingCache() const = 0;
+
+    /*!
+     * Writes the metadata of @p tracks to their files, several at a time, then updates them in the database.
+     * Tracks whose files were written before the request is cancelled are still updated.
+     * @note tracks which are still being loaded are written once loaded, and aren't covered by the request.
+     */
+    virtual ScanRequest updateTrackMetadata(const TrackList& tracks) = 0;
 
     /** Updates the statistics (playcount, rating etc) in the database for @p track  */
     virtual void updateTrackStats(const Track& track) = 0;
@@ -109,5 +162,10 @@ signals:
     void tracksPlayed(const TrackList& tracks);
     void tracksDeleted(const TrackList& tracks);
     void tracksSorted(const TrackList& tracks);
+    /*!
+     * Emitted when a library is removed or relocated, in place of tracksDeleted and tracksUpdated for each of
+     * its tracks. The library's tracks() have already been patched.
+     */
+    void libraryChanged(const Fooyin::LibraryDelta& delta);
 };
 } // namespace Fooyin
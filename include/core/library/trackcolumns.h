@@ -0,0 +1,101 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/library/trackquery.h>
+#include <core/trackfwd.h>
+
+#include <Qt>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A column store over a list of tracks, with rows in the order of the tracks given to build.
+ *
+ * Each numeric and time field is held as one contiguous array of values, and low-cardinality text fields
+ * (genre, extension) as codes into a dictionary of their distinct values. Selections scan a column in
+ * blocks of 64 rows without branching, so the compiler can vectorise them, and write one bit per row.
+ */
+class FYCORE_EXPORT TrackColumns
+{
+public:
+    using Field = TrackQuery::Field;
+
+    /** Returns @c true if @p field is held as a numeric column, i.e. it's a numeric or time field. */
+    [[nodiscard]] static bool isNumericColumn(Field field);
+    /** Returns @c true if @p field is held as a dictionary column. */
+    [[nodiscard]] static bool isDictionaryColumn(Field field);
+
+    /** Replaces the contents of the columns with @p tracks. */
+    void build(const TrackList& tracks);
+    void clear();
+
+    [[nodiscard]] size_t size() const;
+
+    /** Returns the values of the numeric @p field, one per row, with NaN for tracks without one. */
+    [[nodiscard]] std::span<const double> values(Field field) const;
+    /** Returns the distinct case folded values of the dictionary @p field, indexed by code. */
+    [[nodiscard]] std::span<const QString> dictionary(Field field) const;
+
+    /*!
+     * Fills @p words with one bit per row, set if the row's value of the numeric @p field is within @p range.
+     * Rows without a value never match.
+     * @param words at least (size() + 63) / 64 words
+     */
+    void selectRange(Field field, const TrackQuery::Range& range, std::span<uint64_t> words) const;
+    /*!
+     * Fills @p words with one bit per row, set if any of the row's values of the dictionary @p field
+     * has its code marked in @p codes.
+     * @param codes one entry per dictionary value
+     * @param words at least (size() + 63) / 64 words
+     */
+    void selectCodes(Field field, const std::vector<bool>& codes, std::span<uint64_t> words) const;
+
+    /*!
+     * Returns the order of @p keys using a stable radix sort, so equal keys keep their original order.
+     * NaN, used for no value, sorts before every number.
+     * @returns the indexes of @p keys in sorted order
+     */
+    [[nodiscard]] static std::vector<uint32_t> radixSort(std::span<const double> keys,
+                                                         Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+    // The values of a text field as a compressed row list: the codes of row i are
+    // codes[offsets[i]] to codes[offsets[i + 1]]
+    struct DictionaryColumn
+    {
+        std::vector<QString> dictionary;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> codes;
+    };
+
+    static constexpr auto FieldCount = static_cast<size_t>(Field::Tag) + 1;
+
+    size_t m_size{0};
+    std::array<std::vector<double>, FieldCount> m_numeric;
+    std::array<DictionaryColumn, FieldCount> m_text;
+};
+} // namespace Fooyin
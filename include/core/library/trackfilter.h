@@ -25,6 +25,10 @@
 
 class QString;
 
+namespace Fooyin {
+class TrackSearchIndex;
+} // namespace Fooyin
+
 namespace Fooyin::Filter {
 /*!
  * Filters @p tracks using the @p search string
@@ -34,10 +38,16 @@ namespace Fooyin::Filter {
  * - Album
  * - Artist
  * - Album Artist
- * @note the search is case-insensitive
+ * - Filename
+ * @note the search ignores case and accents
  * @param tracks the tracks to filter
  * @param search the search string
  * @returns a new TrackList containing the tracks which match @p search
  */
 FYCORE_EXPORT TrackList filterTracks(const TrackList& tracks, const QString& search);
+/*!
+ * Filters @p tracks using the @p search string, looking up indexed tracks in @p index.
+ * Matches the same tracks as the overload above, without comparing every field of every track.
+ */
+FYCORE_EXPORT TrackList filterTracks(const TrackList& tracks, const QString& search, const TrackSearchIndex& index);
 } // namespace Fooyin::Filter
@@ -0,0 +1,48 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/track.h>
+
+#include <optional>
+
+namespace Fooyin {
+/** The tracks which turn one list into another, regardless of order. */
+struct TrackListDiff
+{
+    TrackList added;
+    TrackList removed;
+
+    [[nodiscard]] bool empty() const
+    {
+        return added.empty() && removed.empty();
+    }
+};
+
+/*!
+ * Returns the tracks to add to and remove from @p from to hold the same tracks as @p to.
+ * Tracks are matched by id, and one whose data is no longer shared with the track it matches, e.g. after
+ * its metadata was edited, is removed and added again. Duplicates are matched one for one.
+ * @returns std::nullopt if either list holds tracks which aren't in the database, as they can't be matched.
+ */
+FYCORE_EXPORT std::optional<TrackListDiff> diffTracks(const TrackList& from, const TrackList& to);
+} // namespace Fooyin
@@ -0,0 +1,183 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/trackfwd.h>
+
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A parsed library query, e.g. `artist = "Aphex Twin" AND (playcount > 5 OR added < 30 days)`.
+ *
+ * A query is a list of terms, implicitly joined by AND, combined with `AND`, `OR`, `NOT` and parentheses.
+ * Each term is either a comparison `field op value` or bare text, which matches tracks in the same way
+ * as the search bar. Comparisons support `=`, `!=`, `<`, `<=`, `>`, `>=` and `:` (contains).
+ *
+ * - Text fields (title, artist, album etc.) compare case-insensitively, and match if any value does.
+ * - Numeric fields take plain numbers. Duration is in seconds unless written as `m:ss`.
+ * - Time fields (added, modified, firstplayed, lastplayed) take a date (`2024-01-31`) or an age
+ *   such as `30 days`, `2w` or `1 year`. Comparing against an age compares how long ago it was,
+ *   so `added < 30 days` matches tracks added in the last 30 days. Tracks without a time never match.
+ * - Any other field is looked up as a tag on each track.
+ *
+ * @see TrackQueryIndex to evaluate queries against a whole library.
+ */
+class FYCORE_EXPORT TrackQuery
+{
+public:
+    enum class Field : uint8_t
+    {
+        // Bare text, matched against all searchable fields
+        Any = 0,
+        Title,
+        Artist,
+        Album,
+        AlbumArtist,
+        Genre,
+        Composer,
+        Performer,
+        Comment,
+        Filename,
+        Path,
+        Extension,
+        Year,
+        TrackNumber,
+        DiscNumber,
+        Duration,
+        Bitrate,
+        SampleRate,
+        Channels,
+        BitDepth,
+        FileSize,
+        PlayCount,
+        Rating,
+        Added,
+        Modified,
+        FirstPlayed,
+        LastPlayed,
+        // A tag without a dedicated field, named by Predicate::tag
+        Tag,
+    };
+
+    enum class Op : uint8_t
+    {
+        Contains = 0,
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+    };
+
+    /*!
+     * The values a numeric comparison accepts, after converting ages to times.
+     * Bounds are inclusive unless marked otherwise.
+     */
+    struct Range
+    {
+        double low{-std::numeric_limits<double>::infinity()};
+        double high{std::numeric_limits<double>::infinity()};
+        bool lowExclusive{false};
+        bool highExclusive{false};
+
+        [[nodiscard]] bool contains(double value) const
+        {
+            return (lowExclusive ? value > low : value >= low) && (highExclusive ? value < high : value <= high);
+        }
+    };
+
+    struct Predicate
+    {
+        Field field{Field::Any};
+        Op op{Op::Contains};
+        // Upper case tag name for Field::Tag
+        QString tag;
+        // Case folded text of the value
+        QString text;
+        // Numeric value for numeric and time fields, in the field's own units
+        double number{0};
+        // Whether number is an age in ms rather than a point in time
+        bool age{false};
+
+        /** Returns the values matched by a numeric comparison at time @p now (ms since epoch). */
+        [[nodiscard]] Range range(uint64_t now) const;
+    };
+
+    struct Node
+    {
+        enum class Type : uint8_t
+        {
+            And = 0,
+            Or,
+            Not,
+            Predicate,
+        };
+
+        Type type{Type::And};
+        std::vector<Node> children;
+        TrackQuery::Predicate predicate;
+    };
+
+    TrackQuery();
+
+    /** Parses @p query, returning an invalid query with an error message if it could not be parsed. */
+    static TrackQuery parse(const QString& query);
+
+    [[nodiscard]] bool isValid() const;
+    /** Returns @c true if the query has no terms, in which case it matches every track. */
+    [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] QString error() const;
+    [[nodiscard]] const Node& root() const;
+
+    /** Returns @c true if any term compares @p field. Bare text depends on every text field. */
+    [[nodiscard]] bool usesField(Field field) const;
+    /** Returns @c true if any term compares against an age, so results change as time passes. */
+    [[nodiscard]] bool isTimeRelative() const;
+
+    /** Returns @c true if @p track matches the query at time @p now (ms since epoch). */
+    [[nodiscard]] bool matches(const Track& track, uint64_t now) const;
+    [[nodiscard]] static bool matches(const Node& node, const Track& track, uint64_t now);
+    [[nodiscard]] static bool matches(const Predicate& predicate, const Track& track, uint64_t now);
+    /** Returns @c true if a single case folded @p value of a text field matches @p predicate. */
+    [[nodiscard]] static bool matchesText(const Predicate& predicate, const QString& value, uint64_t now);
+
+    [[nodiscard]] static bool isNumeric(Field field);
+    [[nodiscard]] static bool isTime(Field field);
+    /** Returns the value of a numeric or time @p field, or nothing if the track has none. */
+    [[nodiscard]] static std::optional<double> numericValue(const Track& track, Field field);
+    /** Returns the case folded values of a text @p field. */
+    [[nodiscard]] static QStringList textValues(const Track& track, Field field, const QString& tag = {});
+
+private:
+    Node m_root;
+    QString m_error;
+};
+} // namespace Fooyin
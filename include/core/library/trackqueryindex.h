@@ -0,0 +1,69 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/library/trackquery.h>
+#include <core/trackfwd.h>
+
+#include <memory>
+
+namespace Fooyin {
+class TrackSearchIndex;
+
+/*!
+ * Per-field indexes over a list of tracks for evaluating a TrackQuery without testing every track.
+ *
+ * Numeric and time fields and low-cardinality text fields are held in a TrackColumns store, so comparisons
+ * are a single scan of contiguous values, and other text fields map each distinct value to the tracks
+ * holding it, so equality is a single lookup. When evaluating, indexed terms of an AND are resolved first
+ * and the remaining terms (e.g. other tags) are only tested against the tracks still matching.
+ * @note evaluate is safe to call from several threads, but not while building.
+ */
+class FYCORE_EXPORT TrackQueryIndex
+{
+public:
+    TrackQueryIndex();
+    ~TrackQueryIndex();
+
+    TrackQueryIndex(const TrackQueryIndex& other)            = delete;
+    TrackQueryIndex& operator=(const TrackQueryIndex& other) = delete;
+
+    /** Replaces the contents of the index with @p tracks. */
+    void build(const TrackList& tracks);
+    void clear();
+
+    [[nodiscard]] int size() const;
+
+    /*!
+     * Returns the indexed tracks matching @p query at time @p now (ms since epoch), in their original order.
+     * Bare text is looked up in @p searchIndex if given, which must hold the same tracks, and compared
+     * directly otherwise.
+     */
+    [[nodiscard]] TrackList evaluate(const TrackQuery& query, uint64_t now,
+                                     const TrackSearchIndex* searchIndex = nullptr) const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,82 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/trackfwd.h>
+
+#include <QString>
+
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * A trigram index over the searchable fields of the library's tracks.
+ * Searches look up the trigrams of the search string and only compare the text of tracks
+ * containing all of them, rather than every field of every track.
+ *
+ * Tracks are matched on the same fields, and with the same substring search, as Filter::filterTracks.
+ * Both the indexed text and searches are normalised with searchKey, so matches ignore case and accents.
+ * @note all methods are thread-safe, and building does not block concurrent searches.
+ */
+class FYCORE_EXPORT TrackSearchIndex
+{
+public:
+    TrackSearchIndex();
+    ~TrackSearchIndex();
+
+    TrackSearchIndex(const TrackSearchIndex& other)            = delete;
+    TrackSearchIndex& operator=(const TrackSearchIndex& other) = delete;
+
+    /*!
+     * Replaces the contents of the index with @p tracks.
+     * Calls to update and remove made while building are applied on top of the result.
+     */
+    void build(const TrackList& tracks);
+    /** Adds @p tracks, replacing any already indexed tracks with the same id. */
+    void update(const TrackList& tracks);
+    void remove(const TrackList& tracks);
+    void clear();
+
+    [[nodiscard]] int size() const;
+
+    /*!
+     * Returns the tracks in @p tracks which match @p search, in their original order.
+     * Tracks which aren't in the index are compared directly.
+     */
+    [[nodiscard]] TrackList filter(const TrackList& tracks, const QString& search) const;
+
+    /*!
+     * Returns the normalised text of @p track which searches are matched against.
+     * Results are cached by the text they're normalised from, so searching the same tracks again is cheap.
+     */
+    static QString searchText(const Track& track);
+    /*!
+     * Returns @p text normalised for searching, i.e. compatibility decomposed (NFKD),
+     * with diacritics removed and case folded, so "Beyonce" matches "Beyoncé".
+     */
+    static QString searchKey(const QString& text);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
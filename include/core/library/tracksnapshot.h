@@ -0,0 +1,74 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/track.h>
+
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * An immutable, implicitly shared view of the library's tracks, along with an index of them by id.
+ * Copying a snapshot is a reference count increment, so it can be held by views or handed to other
+ * threads instead of copying the TrackList.
+ *
+ * Changes produce a new snapshot. Tracks are themselves implicitly shared, so only the list of handles
+ * is rebuilt, and updates which keep every track in place also share the id index with the original.
+ */
+class FYCORE_EXPORT TrackSnapshot
+{
+public:
+    TrackSnapshot();
+    explicit TrackSnapshot(TrackList tracks);
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] const TrackList& tracks() const;
+    [[nodiscard]] TrackList::const_iterator begin() const;
+    [[nodiscard]] TrackList::const_iterator end() const;
+
+    [[nodiscard]] bool contains(int id) const;
+    /** Returns the track with @p id, or @c nullptr if it isn't in the snapshot. */
+    [[nodiscard]] const Track* track(int id) const;
+    /** Returns the tracks with an id in @p ids, in the same order, skipping any which aren't found. */
+    [[nodiscard]] TrackList tracksForIds(const TrackIds& ids) const;
+    /*!
+     * Returns the track whose file is @p filepath, or @c nullptr if there isn't one.
+     * Tracks of CUE sheets are skipped, as they only cover part of their file.
+     * @note the index is built on the first call for each snapshot, and shared by its copies.
+     */
+    [[nodiscard]] const Track* trackForPath(const QString& filepath) const;
+
+    /*!
+     * Returns a snapshot with each of @p tracks replacing the track with the same id.
+     * Tracks keep their position, and ones which aren't in this snapshot are ignored.
+     */
+    [[nodiscard]] TrackSnapshot updated(const TrackList& tracks) const;
+
+private:
+    struct Data;
+    explicit TrackSnapshot(std::shared_ptr<const Data> data);
+
+    std::shared_ptr<const Data> m_data;
+};
+} // namespace Fooyin
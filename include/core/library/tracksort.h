@@ -25,6 +25,8 @@
 
 #include <Qt>
 
+#include <vector>
+
 class QString;
 
 namespace Fooyin {
@@ -36,6 +38,7 @@ namespace Sorting {
  * @param sort the sort script as a string
  * @param tracks the tracks to calculate
  * @returns a new TrackList with the calculated sortFields
+ * @note this detaches every track. Prefer calcSortKeys unless the key has to be kept with the track.
  */
 TrackList FYCORE_EXPORT calcSortFields(const QString& sort, const TrackList& tracks);
 
@@ -44,9 +47,97 @@ TrackList FYCORE_EXPORT calcSortFields(const QString& sort, const TrackList& tra
  * @param sortScript the parsed sort script
  * @param tracks the tracks to calculate
  * @returns a new TrackList with the calculated sortFields
+ * @note this detaches every track. Prefer calcSortKeys unless the key has to be kept with the track.
  */
 TrackList FYCORE_EXPORT calcSortFields(const ParsedScript& sortScript, const TrackList& tracks);
 
+/*!
+ * Calculates the sort key of each of @p tracks using the @p sort script, without modifying the tracks
+ * @param sort the sort script as a string
+ * @param tracks the tracks to calculate
+ * @returns the sort keys, in the same order as @p tracks
+ */
+std::vector<QString> FYCORE_EXPORT calcSortKeys(const QString& sort, const TrackList& tracks);
+
+/*!
+ * Calculates the sort key of each of @p tracks using the parsed @p sort script, without modifying the tracks
+ * @param sortScript the parsed sort script
+ * @param tracks the tracks to calculate
+ * @returns the sort keys, in the same order as @p tracks
+ */
+std::vector<QString> FYCORE_EXPORT calcSortKeys(const ParsedScript& sortScript, const TrackList& tracks);
+
+/*!
+ * Works out the sorted order of @p keys, keeping equal keys in their original order.
+ * Large sorts collate the keys and merge sort them across the global thread pool.
+ * @param keys the sort keys, e.g. from calcSortKeys
+ * @param order the order in which to sort the keys
+ * @returns the indexes of @p keys in sorted order
+ */
+std::vector<int> FYCORE_EXPORT sortIndexes(const std::vector<QString>& keys, Qt::SortOrder order = Qt::AscendingOrder);
+
+/*!
+ * Works out the order of all @p keys after sorting only those at @p indexes, leaving the rest in place
+ * @param keys the sort keys, e.g. from calcSortKeys
+ * @param indexes the indexes to sort
+ * @param order the order in which to sort the keys
+ * @returns the index into @p keys of the key at each position
+ */
+std::vector<int> FYCORE_EXPORT sortIndexes(const std::vector<QString>& keys, const std::vector<int>& indexes,
+                                           Qt::SortOrder order = Qt::AscendingOrder);
+
+/*!
+ * Calculates the sort keys of @p tracks and works out their sorted order, without copying them
+ * @param sort the sort script as a string
+ * @param tracks the tracks to sort
+ * @param order the order in which to sort the tracks
+ * @returns the index into @p tracks of the track at each position, see applySortOrder
+ */
+std::vector<int> FYCORE_EXPORT calcSortOrder(const QString& sort, const TrackList& tracks,
+                                             Qt::SortOrder order = Qt::AscendingOrder);
+
+/*!
+ * Calculates the sort keys of @p tracks in the given @p indexes and works out their sorted order.
+ * Tracks not under an index in @p indexes retain their position.
+ * @param sort the sort script as a string
+ * @param tracks the tracks to sort
+ * @param indexes the indexes to sort
+ * @param order the order in which to sort the tracks
+ * @returns the index into @p tracks of the track at each position, see applySortOrder
+ */
+std::vector<int> FYCORE_EXPORT calcSortOrder(const QString& sort, const TrackList& tracks,
+                                             const std::vector<int>& indexes, Qt::SortOrder order = Qt::AscendingOrder);
+
+/*!
+ * Calculates the sort keys of @p tracks and works out their sorted order, without copying them
+ * @param sortScript the parsed sort script
+ * @param tracks the tracks to sort
+ * @param order the order in which to sort the tracks
+ * @returns the index into @p tracks of the track at each position, see applySortOrder
+ */
+std::vector<int> FYCORE_EXPORT calcSortOrder(const ParsedScript& sortScript, const TrackList& tracks,
+                                             Qt::SortOrder order = Qt::AscendingOrder);
+
+/*!
+ * Calculates the sort keys of @p tracks in the given @p indexes and works out their sorted order.
+ * Tracks not under an index in @p indexes retain their position.
+ * @param sortScript the parsed sort script
+ * @param tracks the tracks to sort
+ * @param indexes the indexes to sort
+ * @param order the order in which to sort the tracks
+ * @returns the index into @p tracks of the track at each position, see applySortOrder
+ */
+std::vector<int> FYCORE_EXPORT calcSortOrder(const ParsedScript& sortScript, const TrackList& tracks,
+                                             const std::vector<int>& indexes, Qt::SortOrder order = Qt::AscendingOrder);
+
+/*!
+ * Rearranges @p tracks into @p sortOrder
+ * @param tracks the tracks to rearrange
+ * @param sortOrder the index into @p tracks of the track at each position, e.g. from calcSortOrder
+ * @returns a new TrackList in @p sortOrder
+ */
+TrackList FYCORE_EXPORT applySortOrder(const TrackList& tracks, const std::vector<int>& sortOrder);
+
 /*!
  * Sorts @p tracks using their current sort fields
  * @param tracks the tracks to sort
@@ -56,7 +147,19 @@ TrackList FYCORE_EXPORT calcSortFields(const ParsedScript& sortScript, const Tra
 TrackList FYCORE_EXPORT sortTracks(const TrackList& tracks, Qt::SortOrder order = Qt::AscendingOrder);
 
 /*!
- * Calculates the sort fields and then sorts @p tracks
+ * Merges @p changes into the already sorted @p tracks using their current sort fields.
+ * Tracks in @p tracks with the same id as a change are replaced, and the rest of @p changes are added.
+ * Only @p changes are sorted, so this costs O(n + m log n) comparisons rather than a full sort.
+ * @param tracks the tracks to merge into, sorted in @p order
+ * @param changes the new and updated tracks
+ * @param order the order in which @p tracks are sorted
+ * @returns a new sorted TrackList
+ */
+TrackList FYCORE_EXPORT mergeTracks(const TrackList& tracks, const TrackList& changes,
+                                    Qt::SortOrder order = Qt::AscendingOrder);
+
+/*!
+ * Calculates the sort keys and then sorts @p tracks, leaving their sort fields untouched
  * @param sort the sort script as a string
  * @param tracks the tracks to sort
  * @param order the order in which to sort the tracks
@@ -66,7 +169,7 @@ TrackList FYCORE_EXPORT calcSortTracks(const QString& sort, const TrackList& tra
                                        Qt::SortOrder order = Qt::AscendingOrder);
 
 /*!
- * Calculates the sort fields and then sorts @p tracks in the given @p indexes.
+ * Calculates the sort keys and then sorts @p tracks in the given @p indexes, leaving their sort fields untouched.
  * @param sort the sort script as a string
  * @param tracks the tracks to sort
  * @param indexes the indexes to sort
@@ -77,7 +180,7 @@ TrackList FYCORE_EXPORT calcSortTracks(const QString& sort, const TrackList& tra
                                        Qt::SortOrder order = Qt::AscendingOrder);
 
 /*!
- * Calculates the sort fields and then sorts @p tracks
+ * Calculates the sort keys and then sorts @p tracks, leaving their sort fields untouched
  * @param sortScript the parsed sort script
  * @param tracks the tracks to sort
  * @param order the order in which to sort the tracks
@@ -87,7 +190,7 @@ TrackList FYCORE_EXPORT calcSortTracks(const ParsedScript& sortScript, const Tra
                                        Qt::SortOrder order = Qt::AscendingOrder);
 
 /*!
- * Calculates the sort fields and then sorts @p tracks in the given @p indexes.
+ * Calculates the sort keys and then sorts @p tracks in the given @p indexes, leaving their sort fields untouched.
  * Tracks not under an index in @p indexes retain their position.
  * @param sortScript the parsed sort script
  * @param tracks the tracks to sort
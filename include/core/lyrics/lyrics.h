@@ -0,0 +1,86 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QString>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * The lyrics of a track, either synced to playback or plain text.
+ *
+ * Synced lyrics are parsed from LRC, including the word timestamps of enhanced LRC. Their lines are held
+ * sorted by timestamp, so the line playing at a position is found by binary search.
+ */
+class FYCORE_EXPORT Lyrics
+{
+public:
+    struct Word
+    {
+        // Milliseconds from the start of the track
+        uint64_t timestamp{0};
+        QString text;
+    };
+
+    struct Line
+    {
+        // Milliseconds from the start of the track, always 0 for plain lyrics
+        uint64_t timestamp{0};
+        QString text;
+        // Only set for enhanced LRC
+        std::vector<Word> words;
+    };
+
+    Lyrics() = default;
+
+    /*!
+     * Parses @p text as LRC. Lines may have several timestamps, and [offset:] is applied to all of them.
+     * Text without any timestamps is kept line for line as plain lyrics.
+     */
+    static Lyrics parse(const QString& text);
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] bool isSynced() const;
+    [[nodiscard]] const std::vector<Line>& lines() const;
+    /** Returns the value of an ID tag such as "ar" or "ti", or an empty string if it isn't set. */
+    [[nodiscard]] QString tag(const QString& key) const;
+
+    /*!
+     * Returns the index of the line playing at @p position, or -1 if the lyrics aren't synced or the
+     * first line hasn't started yet.
+     * @p hint is the previous result. As playback mostly stays on a line or moves to the next one, it and its
+     * successor are checked before searching.
+     */
+    [[nodiscard]] int lineAt(uint64_t position, int hint = -1) const;
+
+    /** Returns a rough size in bytes, for use as a cache cost. */
+    [[nodiscard]] size_t cost() const;
+
+private:
+    std::vector<Line> m_lines;
+    std::map<QString, QString> m_tags;
+    bool m_synced{false};
+};
+} // namespace Fooyin
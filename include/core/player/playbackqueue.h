@@ -24,13 +24,21 @@
 #include <core/player/playerdefs.h>
 #include <core/track.h>
 
+#include <deque>
 #include <map>
 #include <set>
+#include <unordered_map>
 
 namespace Fooyin {
 using PlaylistIndexes = std::map<int, std::vector<int>>;
 using QueueTracks     = std::vector<PlaylistTrack>;
 
+/*!
+ * The tracks queued to play next, in order.
+ *
+ * Taking the next track and queueing more are constant time, and the queue positions of each
+ * playlist's tracks are kept indexed so looking them up doesn't scan the whole queue.
+ */
 class FYCORE_EXPORT PlaybackQueue
 {
 public:
@@ -41,9 +49,19 @@ public:
     [[nodiscard]] QueueTracks tracks() const;
     [[nodiscard]] PlaylistTrack track(int index) const;
     [[nodiscard]] int trackCount() const;
+    /** Returns the queue positions of the queued tracks of the playlist with @p id, by their index in the playlist. */
     [[nodiscard]] PlaylistIndexes indexesForPlaylist(const Id& id) const;
 
+    /*!
+     * Returns the queue position of the next track to play while the playlist with @p playlistId is playing,
+     * i.e. the first track queued from that playlist or from outside any playlist, or -1 if there isn't one.
+     * An invalid @p playlistId matches every track.
+     */
+    [[nodiscard]] int nextIndex(const Id& playlistId) const;
+
     PlaylistTrack nextTrack();
+    /** Removes and returns the track at queue position @p index. */
+    PlaylistTrack takeTrack(int index);
 
     void addTracks(const QueueTracks& tracks);
     QueueTracks removeTracks(const QueueTracks& tracks);
@@ -52,6 +70,13 @@ public:
     void clear();
 
 private:
-    QueueTracks m_tracks;
+    void updateIndexes() const;
+
+    std::deque<PlaylistTrack> m_tracks;
+
+    // Positions are stored relative to the front of the queue when they were indexed
+    mutable std::unordered_map<Id, PlaylistIndexes, Id::IdHash> m_playlistIndexes;
+    mutable bool m_indexesValid{false};
+    mutable int m_indexOffset{0};
 };
 } // namespace Fooyin
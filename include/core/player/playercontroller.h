@@ -64,6 +64,8 @@ public:
      * @note the track will be invalid if the state is 'Stopped'.
      */
     [[nodiscard]] PlaylistTrack currentPlaylistTrack() const;
+    /** Returns the title announced by the current internet stream, usually the song now playing. */
+    [[nodiscard]] QString streamTitle() const;
 
     /** Starts playback of the current playlist. */
     void play();
@@ -88,8 +90,26 @@ public:
     void changeCurrentTrack(const PlaylistTrack& track);
     void updateCurrentTrackPlaylist(const Id& playlistId);
     void updateCurrentTrackIndex(int index);
+    /** Sets the title announced by the current internet stream. Cleared whenever the track changes. */
+    void setStreamTitle(const QString& title);
 
-    [[nodiscard]] PlaybackQueue playbackQueue() const;
+    /*!
+     * Asks for positionChanged to be emitted at least every @p interval ms on behalf of @p listener,
+     * e.g. while a seekbar is visible. The position is updated at the finest interval requested, and
+     * only occasionally once nothing is listening.
+     * @note requests are released automatically when @p listener is destroyed.
+     */
+    void requestPositionUpdates(QObject* listener, int interval);
+    void releasePositionUpdates(QObject* listener);
+    /** Returns the finest update interval requested in ms, or 0 if nothing is listening. */
+    [[nodiscard]] int positionInterval() const;
+
+    [[nodiscard]] const PlaybackQueue& playbackQueue() const;
+    /*!
+     * Returns the queued track which will play next, or an invalid track if the queue won't be used.
+     * @note with a per-playlist queue, only tracks queued from the current playlist (or none) are considered.
+     */
+    [[nodiscard]] PlaylistTrack nextQueuedTrack() const;
 
     /** Queues the @p track to be played at the end of the current track. */
     void queueTrack(const Track& track);
@@ -114,10 +134,14 @@ signals:
 
     void positionChanged(uint64_t ms);
     void positionMoved(uint64_t ms);
+    void positionIntervalChanged(int interval);
 
     void currentTrackChanged(const Track& track);
     void playlistTrackChanged(const PlaylistTrack& track);
+    void streamTitleChanged(const QString& title);
     void trackPlayed(const Track& track);
+    /** Emitted once per track, shortly before it finishes, so the following track can be prefetched. */
+    void trackNearingEnd();
 
     void tracksQueued(const QueueTracks& tracks);
     void tracksDequeued(const QueueTracks& tracks);
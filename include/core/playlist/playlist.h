@@ -26,11 +26,17 @@
 
 #include <QObject>
 
+#include <functional>
+
 namespace Fooyin {
+struct LibraryDelta;
+
 /*!
  * Represents a list of tracks for playback.
  * Playlists are saved to the database and restored
  * on startup unless marked temporary.
+ * Restored playlists only know their track count and duration until their tracks
+ * are first accessed, at which point they are loaded.
  */
 class FYCORE_EXPORT Playlist final
 {
@@ -43,7 +49,7 @@ public:
         RepeatPlaylist = 1 << 0,
         RepeatAlbum    = 1 << 1, // Not implemented
         RepeatTrack    = 1 << 2,
-        ShuffleAlbums  = 1 << 3, // Not implemented
+        ShuffleAlbums  = 1 << 3, // Shuffles albums, playing the tracks of each in order
         ShuffleTracks  = 1 << 4,
         Random         = 1 << 5, // Not implemented
     };
@@ -62,9 +68,18 @@ public:
     [[nodiscard]] QString name() const;
     [[nodiscard]] int index() const;
 
-    [[nodiscard]] TrackList tracks() const;
+    /*!
+     * Returns the tracks of this playlist without copying them, loading them first if needed.
+     * @note the reference is only valid until the playlist is next modified.
+     */
+    [[nodiscard]] const TrackList& tracks() const;
     [[nodiscard]] Track track(int index) const;
+    /** Returns the number of tracks, without loading them. */
     [[nodiscard]] int trackCount() const;
+    /** Returns the total duration of the tracks in milliseconds, without loading them. */
+    [[nodiscard]] uint64_t duration() const;
+    /** Returns @c true if the tracks of this playlist are in memory. */
+    [[nodiscard]] bool isLoaded() const;
 
     [[nodiscard]] int currentTrackIndex() const;
     [[nodiscard]] Track currentTrack() const;
@@ -75,6 +90,8 @@ public:
     [[nodiscard]] bool tracksModified() const;
     /** Returns @c true if this playlist does not persist (saved to db). */
     [[nodiscard]] bool isTemporary() const;
+    /** Returns a number which changes whenever the tracks or their metadata do, e.g. to tell if a view is current. */
+    [[nodiscard]] uint64_t revision() const;
 
     /*!
      * Schedules the track to be played after the current track is finished.
@@ -116,10 +133,56 @@ private:
     void setModified(bool modified);
     void setTracksModified(bool modified);
 
+    /*!
+     * Defers loading the tracks until they are first needed, at which point @p loader is called.
+     * @p trackCount and @p duration are reported until then.
+     */
+    void setLoader(int trackCount, uint64_t duration, std::function<TrackList()> loader);
+
     void replaceTracks(const TrackList& tracks);
     void appendTracks(const TrackList& tracks);
     std::vector<int> removeTracks(const std::vector<int>& indexes);
 
+    /*
+     * The targeted mutators below keep the shuffle order, current and scheduled tracks pointing at the
+     * same tracks, and only mark the tracks as modified if the stored track ids change.
+     */
+
+    /*!
+     * Inserts @p tracks before @p index, or at the end if @p index is out of range.
+     * @returns the index of the first inserted track.
+     */
+    int insertTracks(int index, const TrackList& tracks);
+    /*!
+     * Replaces the track at each of @p indexes with the track at the same position in @p tracks.
+     * @returns @c false if the sizes differ or an index is out of range, in which case nothing is changed.
+     */
+    bool updateTracksAt(const std::vector<int>& indexes, const TrackList& tracks);
+    /*!
+     * Moves the tracks at @p indexes, keeping their relative order, to before the track at @p to
+     * (or to the end if @p to is the track count).
+     * @returns the new indexes of the moved tracks.
+     */
+    std::vector<int> moveTracks(const std::vector<int>& indexes, int to);
+    /*!
+     * Rearranges the tracks so the track at index @c order[i] ends up at @c i.
+     * @returns the new index of each track by its old index, or nothing if @p order isn't a permutation of
+     * every index, in which case nothing is changed.
+     */
+    std::vector<int> reorderTracks(const std::vector<int>& order);
+    /*!
+     * Replaces the tracks in this playlist which share an id with any of @p tracks.
+     * @returns the indexes of the replaced tracks, in ascending order.
+     */
+    std::vector<int> updateTracks(const TrackList& tracks);
+    /*!
+     * Patches the tracks in this playlist belonging to the library changed by @p delta.
+     * @returns the indexes of the changed tracks, in ascending order.
+     */
+    std::vector<int> applyLibraryDelta(const LibraryDelta& delta);
+    /** Returns the indexes of all tracks in this playlist with the same id as any of @p tracks, in ascending order. */
+    std::vector<int> indexesOf(const TrackList& tracks);
+
     /** Removes all tracks, including all shuffle order history */
     void clear();
 
@@ -21,13 +21,17 @@
 
 #include "fycore_export.h"
 
+#include <core/library/tracksnapshot.h>
 #include <core/playlist/playlist.h>
 #include <core/trackfwd.h>
 #include <utils/database/dbconnectionpool.h>
 
 #include <QObject>
 
+#include <functional>
+
 namespace Fooyin {
+struct LibraryDelta;
 class SettingsManager;
 class PlayerController;
 
@@ -36,8 +40,12 @@ class FYCORE_EXPORT PlaylistHandler : public QObject
     Q_OBJECT
 
 public:
-    explicit PlaylistHandler(DbConnectionPoolPtr dbPool, PlayerController* playerController, SettingsManager* settings,
-                             QObject* parent = nullptr);
+    /*!
+     * Playlists are saved through @p dbPool. Their tracks are restored through @p readPool if it has a connection
+     * for this thread, so restoring isn't held up by writers such as a library scan.
+     */
+    explicit PlaylistHandler(DbConnectionPoolPtr dbPool, const DbConnectionPoolPtr& readPool,
+                             PlayerController* playerController, SettingsManager* settings, QObject* parent = nullptr);
     ~PlaylistHandler() override;
 
     /** Returns the playlist with the @p id if it exists, otherwise nullptr. */
@@ -66,6 +74,18 @@ public:
 
     /** Adds @p tracks to the end of the playlist with @p id if found. */
     void appendToPlaylist(const Id& id, const TrackList& tracks);
+    /** Inserts @p tracks before @p index of the playlist with @p id if found. */
+    void insertPlaylistTracks(const Id& id, int index, const TrackList& tracks);
+    /** Replaces the tracks at @p indexes of the playlist with @p id with @p tracks, keeping its shuffle order. */
+    void updatePlaylistTracks(const Id& id, const std::vector<int>& indexes, const TrackList& tracks);
+    /** Moves the tracks at @p indexes of the playlist with @p id to before @p to, keeping its shuffle order. */
+    void reorderPlaylistTracks(const Id& id, const std::vector<int>& indexes, int to);
+    /*!
+     * Rearranges the tracks of the playlist with @p id so the track at index @c order[i] ends up at @c i,
+     * e.g. from Sorting::calcSortOrder. The shuffle order, playing track and queued tracks follow their tracks.
+     * @note emits playlistTracksReordered rather than playlistTracksChanged, as nothing was replaced.
+     */
+    void sortPlaylistTracks(const Id& id, const std::vector<int>& order);
     /** Replaces the @p tracks of the playlist with @p id if found. */
     void replacePlaylistTracks(const Id& id, const TrackList& tracks);
     /** Moves the tracks of the playlist with @p id to the playlist with @p replaceId. */
@@ -106,22 +126,42 @@ public:
     void savePlaylists();
     void savePlaylist(const Id& id);
 
+    /*!
+     * Sets the function used to fetch the library's tracks when a restored playlist is first loaded.
+     * If not set, the tracks passed to populatePlaylists are used.
+     */
+    void setTrackSource(std::function<TrackSnapshot()> source);
+
 signals:
     void playlistsPopulated();
     void playlistAdded(Playlist* playlist);
     void playlistTracksAdded(Playlist* playlist, const TrackList& tracks, int index);
     void playlistTracksChanged(Playlist* playlist, const std::vector<int>& indexes);
+    /** Emitted by sortPlaylistTracks with the @p indexes whose track changed, in place of playlistTracksChanged. */
+    void playlistTracksReordered(Playlist* playlist, const std::vector<int>& indexes);
     void playlistTracksPlayed(Playlist* playlist, const std::vector<int>& indexes);
     void playlistTracksRemoved(Playlist* playlist, const std::vector<int>& indexes);
     void playlistRemoved(Playlist* playlist);
     void playlistRenamed(Playlist* playlist);
     void activePlaylistChanged(Playlist* playlist);
+    /** Emitted in response to @fn trackAboutToFinish with the track which will be played next. */
+    void nextTrackReady(const Track& track);
+    /*!
+     * Emitted as the current track nears its end with the track expected to follow it,
+     * so its file, artwork and other per-track data can be loaded ahead of the change.
+     */
+    void upcomingTrack(const Track& track);
 
 public slots:
-    void populatePlaylists(const TrackList& tracks);
+    /*!
+     * Restores the active playlist from @p tracks.
+     * Other playlists only load their tracks once they are first needed.
+     */
+    void populatePlaylists(const TrackSnapshot& tracks);
     void tracksUpdated(const TrackList& tracks);
     void tracksPlayed(const TrackList& tracks);
     void tracksRemoved(const TrackList& tracks);
+    void libraryChanged(const Fooyin::LibraryDelta& delta);
     void trackAboutToFinish();
 
 private:
@@ -0,0 +1,83 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/trackfwd.h>
+
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class QIODevice;
+
+namespace Fooyin::PlaylistParser {
+enum class Format : uint8_t
+{
+    Unknown = 0,
+    M3u,
+    M3u8,
+    Pls,
+    Xspf,
+};
+
+/*!
+ * A single item read from a playlist file.
+ * @c filepath is absolute and cleaned; relative entries are resolved against the playlist's directory.
+ */
+struct Entry
+{
+    QString filepath;
+    QString title;
+    // Milliseconds, or 0 if the playlist doesn't give one
+    uint64_t duration{0};
+};
+// Return false to stop reading
+using EntryCallback = std::function<bool(const Entry&)>;
+
+/** Returns the file extensions of the supported playlist formats, without a leading dot. */
+FYCORE_EXPORT QStringList supportedExtensions();
+/** Returns the format matching the extension of @p filepath. */
+FYCORE_EXPORT Format formatForFile(const QString& filepath);
+
+/*!
+ * Reads the entries of a playlist in @p format from @p device, calling @p callback for each one as it's parsed.
+ * Only the current entry is held in memory, so playlists of any length are read in constant space.
+ * Entries which aren't local files (e.g. http streams) are skipped.
+ * @returns false if the playlist is malformed, with the reason in @p error if given. Entries before the
+ * point of failure will already have been reported.
+ */
+FYCORE_EXPORT bool read(QIODevice* device, Format format, const QString& dir, const EntryCallback& callback,
+                        QString* error = nullptr);
+/** Opens and reads @p filepath, deducing the format from its extension. */
+FYCORE_EXPORT bool read(const QString& filepath, const EntryCallback& callback, QString* error = nullptr);
+
+/*!
+ * Writes @p tracks to @p device as a playlist in @p format, one entry at a time.
+ * If @p relativePaths is set, files below @p dir are written relative to it.
+ */
+FYCORE_EXPORT bool write(QIODevice* device, Format format, const TrackList& tracks, const QString& dir,
+                         bool relativePaths = false);
+/** Writes @p tracks to @p filepath, deducing the format from its extension. */
+FYCORE_EXPORT bool write(const QString& filepath, const TrackList& tracks, bool relativePaths = false);
+} // namespace Fooyin::PlaylistParser
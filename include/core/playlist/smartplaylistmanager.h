@@ -0,0 +1,93 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/trackfwd.h>
+#include <utils/id.h>
+
+#include <QObject>
+
+#include <vector>
+
+namespace Fooyin {
+class MusicLibrary;
+class Playlist;
+class PlaylistHandler;
+class SettingsManager;
+
+/*!
+ * Keeps playlists filled with the library tracks matching a TrackQuery.
+ *
+ * Each smart playlist is evaluated against the whole library once, when playlists are populated
+ * or its query changes. After that only the tracks the library reports as added, updated, played
+ * or removed are tested, and played tracks are skipped entirely for queries not depending on play
+ * counts or times. Queries comparing against an age (e.g. `added < 30 days`) are also fully
+ * re-evaluated periodically, as time passing changes their results.
+ *
+ * Smart playlists are ordinary playlists, identified by their database id, with their queries
+ * stored in the settings file.
+ */
+class FYCORE_EXPORT SmartPlaylistManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct SmartPlaylist
+    {
+        Id playlistId;
+        QString name;
+        QString query;
+    };
+
+    SmartPlaylistManager(MusicLibrary* library, PlaylistHandler* playlistHandler, SettingsManager* settings,
+                         QObject* parent = nullptr);
+    ~SmartPlaylistManager() override;
+
+    [[nodiscard]] std::vector<SmartPlaylist> smartPlaylists() const;
+    [[nodiscard]] bool isSmartPlaylist(const Id& playlistId) const;
+    /** Returns the query of the smart playlist with @p playlistId, or an empty string if it isn't one. */
+    [[nodiscard]] QString query(const Id& playlistId) const;
+
+    /*!
+     * Creates the smart playlist @p name, or changes its query if it exists, and fills it with the matching tracks.
+     * An existing playlist called @p name is turned into a smart playlist.
+     * @returns the playlist, or nullptr if @p query could not be parsed, with the reason in @p error if given.
+     */
+    Playlist* setSmartPlaylist(const QString& name, const QString& query, QString* error = nullptr);
+    /** Stops maintaining the playlist with @p playlistId, leaving its current tracks in place. */
+    void removeSmartPlaylist(const Id& playlistId);
+
+    /** Re-evaluates every smart playlist against the whole library. */
+    void refresh();
+
+signals:
+    void smartPlaylistsChanged();
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
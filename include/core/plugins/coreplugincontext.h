@@ -20,11 +20,14 @@
 #pragma once
 
 namespace Fooyin {
+class DbExecutor;
 class PluginManager;
 class SettingsManager;
 class EngineController;
 class PlayerController;
 class PlaylistHandler;
+class SmartPlaylistManager;
+class LibraryApi;
 class LibraryManager;
 class MusicLibrary;
 
@@ -35,14 +38,18 @@ struct CorePluginContext
 {
     CorePluginContext(PluginManager* pluginManager_, EngineController* engine_, PlayerController* playerController_,
                       LibraryManager* libraryManager_, MusicLibrary* library_, PlaylistHandler* playlistHandler_,
-                      SettingsManager* settingsManager_)
+                      SmartPlaylistManager* smartPlaylists_, SettingsManager* settingsManager_,
+                      DbExecutor* dbExecutor_, LibraryApi* libraryApi_)
         : pluginManager{pluginManager_}
         , playerController{playerController_}
         , libraryManager{libraryManager_}
         , library{library_}
         , playlistHandler{playlistHandler_}
+        , smartPlaylists{smartPlaylists_}
         , settingsManager{settingsManager_}
         , engine{engine_}
+        , dbExecutor{dbExecutor_}
+        , libraryApi{libraryApi_}
     { }
 
     PluginManager* pluginManager;
@@ -50,7 +57,12 @@ struct CorePluginContext
     LibraryManager* libraryManager;
     MusicLibrary* library;
     PlaylistHandler* playlistHandler;
+    SmartPlaylistManager* smartPlaylists;
     SettingsManager* settingsManager;
     EngineController* engine;
+    // Runs queries against fooyin's database off the calling thread
+    DbExecutor* dbExecutor;
+    // Shared lookups, grouping and queries over the library, see LibraryApi::version
+    LibraryApi* libraryApi;
 };
 } // namespace Fooyin
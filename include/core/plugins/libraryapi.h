@@ -0,0 +1,96 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/library/trackquery.h>
+#include <core/library/tracksnapshot.h>
+
+#include <QStringList>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace Fooyin {
+class GroupingCache;
+class MusicLibrary;
+class TrackSearchIndex;
+
+/*!
+ * Read access to the library for plugins, without every plugin keeping its own copy or indexes.
+ *
+ * Lookups by id and path use the indexes of the current TrackSnapshot, grouping scripts share the
+ * library's GroupingCache, and queries are evaluated against one TrackQueryIndex built per snapshot.
+ * Changes are announced by the MusicLibrary signals as before; results always reflect the latest snapshot.
+ *
+ * Plugins should check version() against the Version they were built with before relying on newer calls.
+ * @note thread-safe.
+ */
+class FYCORE_EXPORT LibraryApi
+{
+public:
+    // Increased whenever calls are added; existing calls keep their behaviour
+    static constexpr int Version = 1;
+
+    explicit LibraryApi(MusicLibrary* library);
+    LibraryApi(std::function<TrackSnapshot()> snapshot, const TrackSearchIndex* searchIndex,
+               const GroupingCache* groupingCache);
+    ~LibraryApi();
+
+    LibraryApi(const LibraryApi& other)            = delete;
+    LibraryApi& operator=(const LibraryApi& other) = delete;
+
+    /** Returns the version of the API provided by the running fooyin. */
+    [[nodiscard]] static int version();
+
+    /** Returns the current snapshot of all tracks, which never changes and is cheap to copy. */
+    [[nodiscard]] TrackSnapshot snapshot() const;
+
+    [[nodiscard]] std::optional<Track> trackForId(int id) const;
+    /** Returns the tracks with an id in @p ids, in the same order, skipping any which aren't found. */
+    [[nodiscard]] TrackList tracksForIds(const TrackIds& ids) const;
+    /** Returns the track whose file is @p filepath. Tracks of CUE sheets aren't found by path. */
+    [[nodiscard]] std::optional<Track> trackForPath(const QString& filepath) const;
+
+    /*!
+     * Returns the values of the grouping @p script for each of @p tracks, in the same order.
+     * Values already evaluated by any view or plugin are reused rather than evaluated again.
+     */
+    [[nodiscard]] std::vector<QStringList> groupValues(const QString& script, const TrackList& tracks) const;
+    /** Returns the distinct values of @p script across the library, in the order they're first found. */
+    [[nodiscard]] QStringList groups(const QString& script) const;
+    /** Returns the tracks with @p group among their values of @p script, in library order. */
+    [[nodiscard]] TrackList tracksInGroup(const QString& script, const QString& group) const;
+
+    /*!
+     * Returns the tracks matching @p query, in library order, using the syntax of TrackQuery::parse.
+     * If the query can't be parsed, nothing is returned and @p error is set if given.
+     */
+    [[nodiscard]] TrackList tracksMatching(const QString& query, QString* error = nullptr) const;
+    [[nodiscard]] TrackList tracksMatching(const TrackQuery& query) const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -26,7 +26,13 @@
 
 #include <QObject>
 
+#include <chrono>
+#include <memory>
+#include <span>
+
 namespace Fooyin {
+struct ScriptProgram;
+
 struct ScriptError
 {
     int position;
@@ -35,11 +41,56 @@ struct ScriptError
 };
 using ErrorList = std::vector<ScriptError>;
 
+/*!
+ * What a script reads when evaluated, so callers can skip evaluating it again after a change
+ * to a track which it doesn't read.
+ */
+struct FYCORE_EXPORT ScriptDependencies
+{
+    // Names of the variables read, sorted
+    QStringList variables;
+    // Reads any of a track's tags, through $meta or $info
+    bool allFields{false};
+    // Reads the state of playback, e.g. %playback_time%
+    bool playback{false};
+    // Reads variables provided by the registry rather than the track, e.g. a playlist's %queueindex%
+    bool context{false};
+
+    /** Returns whether the result may change with any of @p fields of the track. */
+    [[nodiscard]] bool dependsOn(const QStringList& fields) const;
+    /** Returns whether the result may change when a track's playback statistics or rating are updated. */
+    [[nodiscard]] bool dependsOnStats() const;
+};
+
+/*!
+ * The time spent in one of a script's variables or functions, summed over every evaluation profiled.
+ * The time of a function doesn't include its arguments, which are profiled as entries of their own.
+ */
+struct ScriptProfileEntry
+{
+    QString name;
+    bool function{false};
+    int calls{0};
+    std::chrono::nanoseconds time{0};
+};
+
+struct ScriptProfile
+{
+    // The time taken to evaluate the whole script, for every track
+    std::chrono::nanoseconds total{0};
+    int evaluations{0};
+    // Sorted by time, most expensive first
+    std::vector<ScriptProfileEntry> entries;
+};
+
 struct ParsedScript
 {
     QString input;
     ExpressionList expressions;
     ErrorList errors;
+    ScriptDependencies dependencies;
+    // The expressions compiled for evaluation, shared between copies
+    std::shared_ptr<const ScriptProgram> program;
 
     [[nodiscard]] bool isValid() const
     {
@@ -68,6 +119,42 @@ public:
     QString evaluate(const ParsedScript& input, const TrackList& tracks);
 
     void clearCache();
+    /*!
+     * Caches the results of function calls which only depend on the track, so scripts evaluated one after
+     * another for the same track (e.g. a playlist's headers and columns) only evaluate them once.
+     * Tracks are compared by id and filepath, so keep it enabled only for the duration of one pass.
+     */
+    void setTrackCacheEnabled(bool enabled);
+
+    /*!
+     * Evaluates @p script once for each of @p tracks and reports where the time went.
+     * Function calls folded into constants when parsing cost nothing, so never appear in the profile.
+     */
+    ScriptProfile profile(const ParsedScript& script, const TrackList& tracks);
+
+    /*!
+     * Evaluates @p script for each of @p tracks, writing each result to the same index of @p out,
+     * which must hold at least as many elements as @p tracks.
+     * Cheaper than calling evaluate in a loop, as the compiled script is only looked up once.
+     */
+    void evaluateBatch(const ParsedScript& script, std::span<const Track> tracks, std::span<QString> out);
+    /** As above, with each of the values of a multi-value result kept separate. */
+    void evaluateBatch(const ParsedScript& script, std::span<const Track> tracks, std::span<QStringList> out);
+
+    /*!
+     * Evaluates @p script for each of @p tracks, in chunks spread over the global thread pool.
+     * Parsers hold state while evaluating, so each chunk uses one of its own. They share @p registry,
+     * which is only read from, or a default registry if it is @c nullptr.
+     * @returns the result for each track, in the same order as @p tracks
+     */
+    static std::vector<QString> evaluateEach(const ParsedScript& script, const TrackList& tracks,
+                                             ScriptRegistry* registry = nullptr);
+    /*!
+     * As evaluateEach, but with each of the values of a multi-value result kept separate rather than joined.
+     * Only the values the script emits are included, so a script with no result gives an empty list.
+     */
+    static std::vector<QStringList> evaluateEachValues(const ParsedScript& script, const TrackList& tracks,
+                                                       ScriptRegistry* registry = nullptr);
 
 private:
     struct Private;
@@ -28,12 +28,36 @@
 
 namespace Fooyin {
 class PlayerController;
+class TrackListAggregate;
 
 class FYCORE_EXPORT ScriptRegistry
 {
 public:
     using FuncRet = std::variant<int, uint64_t, QString, QStringList>;
 
+    /*!
+     * A variable or function name resolved by bindVariable or bindFunction.
+     * Evaluating through a binding calls the property or function directly, rather than looking it up by name.
+     * @note only valid for the registry which created it.
+     */
+    struct Binding
+    {
+        int metadata{-1};
+        int playback{-1};
+        int list{-1};
+        int function{-1};
+        // Index into a subclass's own variables
+        int custom{-1};
+        // The name as stored in Track::extraTags
+        QString tag;
+
+        /** Returns whether the variable's value depends on nothing but the track it's evaluated for. */
+        [[nodiscard]] bool isTrackValue() const
+        {
+            return playback < 0 && custom < 0;
+        }
+    };
+
     explicit ScriptRegistry(PlayerController* playerController = nullptr);
     virtual ~ScriptRegistry();
 
@@ -48,8 +72,26 @@ public:
     [[nodiscard]] virtual ScriptResult function(const QString& func, const ScriptValueList& args,
                                                 const TrackList& tracks) const;
 
+    [[nodiscard]] virtual Binding bindVariable(const QString& var) const;
+    [[nodiscard]] Binding bindFunction(const QString& func) const;
+    /** Returns whether the result of @p func depends on nothing but its arguments. */
+    [[nodiscard]] bool isConstantFunction(const Binding& func) const;
+
+    [[nodiscard]] virtual ScriptResult value(const Binding& var, const Track& track) const;
+    [[nodiscard]] virtual ScriptResult value(const Binding& var, const TrackList& tracks) const;
+    [[nodiscard]] ScriptResult function(const Binding& func, const ScriptValueList& args, const Track& track) const;
+    [[nodiscard]] ScriptResult function(const Binding& func, const ScriptValueList& args,
+                                        const TrackList& tracks) const;
+
     virtual void setValue(const QString& var, const FuncRet& value, Track& track);
 
+    /*!
+     * Sets totals kept for the tracks which are evaluated next, read by list properties (e.g. %playtime%)
+     * instead of visiting every track. Only used while the number of tracks matches.
+     * Pass @c nullptr once done, as @p aggregate must outlive its use.
+     */
+    void setListAggregate(const TrackListAggregate* aggregate);
+
 protected:
     template <typename NewCntr, typename Cntr>
     NewCntr containerCast(const Cntr& from) const
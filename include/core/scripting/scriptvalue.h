@@ -19,17 +19,29 @@
 
 #pragma once
 
-#include <QString>
+#include <QStringList>
 
 namespace Fooyin {
+/*!
+ * The result of evaluating a variable or function.
+ * A multi-value result (e.g. a track's genres) holds each of its values in @c values and leaves @c value empty,
+ * so they don't need to be joined and split again while evaluating.
+ */
 struct ScriptResult
 {
     explicit operator QString() const
     {
-        return value;
+        return values.empty() ? value : values.join(u'\037');
     }
+
+    [[nodiscard]] bool isMultiValue() const
+    {
+        return !values.empty();
+    }
+
     QString value;
     bool cond{false};
+    QStringList values;
 };
 using ScriptValueList = std::vector<ScriptResult>;
 } // namespace Fooyin
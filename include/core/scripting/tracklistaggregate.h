@@ -0,0 +1,62 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/trackfwd.h>
+
+#include <QString>
+
+#include <map>
+
+namespace Fooyin {
+/*!
+ * Totals over a list of tracks, kept up to date as tracks are added and removed, so the list properties
+ * of a group (%trackcount%, %playtime%, %genres%) can be read without visiting every track.
+ */
+class FYCORE_EXPORT TrackListAggregate
+{
+public:
+    TrackListAggregate() = default;
+    explicit TrackListAggregate(const TrackList& tracks);
+
+    void add(const Track& track);
+    void add(const TrackList& tracks);
+    /** Adds the totals of @p other, as if each of its tracks were added. */
+    void merge(const TrackListAggregate& other);
+    /** Removes @p track, which must have been added before with the same metadata. */
+    void remove(const Track& track);
+    void clear();
+
+    [[nodiscard]] int trackCount() const;
+    /** Returns the summed duration in milliseconds. */
+    [[nodiscard]] uint64_t duration() const;
+    [[nodiscard]] uint64_t fileSize() const;
+    /** Returns each distinct genre with the number of tracks it appears in, ordered by name. */
+    [[nodiscard]] const std::map<QString, int>& genres() const;
+
+private:
+    int m_trackCount{0};
+    uint64_t m_duration{0};
+    uint64_t m_fileSize{0};
+    std::map<QString, int> m_genres;
+};
+} // namespace Fooyin
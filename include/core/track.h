@@ -24,6 +24,8 @@
 #include <QList>
 #include <QSharedDataPointer>
 
+#include <memory>
+
 namespace Fooyin {
 /*!
  * Represents a music track and it's associated metadata.
@@ -74,8 +76,19 @@ public:
     Track& operator=(const Track& other);
     bool operator==(const Track& other) const;
     bool operator!=(const Track& other) const;
+    /** Returns @c true if this and @p other share their data, i.e. neither has been changed since one was copied. */
+    [[nodiscard]] bool isSharedWith(const Track& other) const;
 
-    QString generateHash();
+    /*!
+     * Regenerates the hash identifying this track by its artists, album, disc, track number and title.
+     * The hash is the same between runs, so it's used to match stats and missing tracks.
+     */
+    uint64_t generateHash();
+    /*!
+     * Returns the MD5 hex hash which identified this track before schema version 10.
+     * Only used to find the stats kept under it for tracks which weren't in the database when it was upgraded.
+     */
+    [[nodiscard]] QString legacyHash() const;
 
     [[nodiscard]] bool isValid() const;
     [[nodiscard]] bool isEnabled() const;
@@ -86,11 +99,21 @@ public:
     [[nodiscard]] int libraryId() const;
 
     [[nodiscard]] int id() const;
-    [[nodiscard]] QString hash() const;
+    [[nodiscard]] uint64_t hash() const;
     [[nodiscard]] QString albumHash() const;
+    /*!
+     * Returns the id of the album (as identified by albumHash) assigned by the database, or -1 if there isn't one.
+     * Reset once any of the fields making up the album change, until the track is next stored.
+     */
+    [[nodiscard]] int albumId() const;
     [[nodiscard]] Type type() const;
     [[nodiscard]] QString typeString() const;
     [[nodiscard]] QString filepath() const;
+    /*!
+     * Returns a path identifying this track among tracks sharing its file, i.e. CUE sheet tracks.
+     * This is the filepath for tracks covering a whole file.
+     */
+    [[nodiscard]] QString uniqueFilepath() const;
     [[nodiscard]] QString relativePath() const;
     [[nodiscard]] QString filename() const;
     [[nodiscard]] QString path() const;
@@ -113,6 +136,17 @@ public:
     [[nodiscard]] QString composer() const;
     [[nodiscard]] QString performer() const;
     [[nodiscard]] uint64_t duration() const;
+    /** Returns the start of the track within its file in ms, which is only non-zero for CUE sheet tracks. */
+    [[nodiscard]] uint64_t offset() const;
+    /** Returns @c true if this track was read from a CUE sheet and covers part of its file. */
+    [[nodiscard]] bool hasCue() const;
+    [[nodiscard]] QString cuePath() const;
+    /** Returns @c true if this track is a file stored inside an archive. */
+    [[nodiscard]] bool isInArchive() const;
+    /** Returns the path of the archive holding this track, or an empty string if it isn't in one. */
+    [[nodiscard]] QString archivePath() const;
+    /** Returns the path of this track's file within its archive. */
+    [[nodiscard]] QString pathInArchive() const;
     [[nodiscard]] QString comment() const;
     [[nodiscard]] QString date() const;
     [[nodiscard]] int year() const;
@@ -141,10 +175,17 @@ public:
 
     [[nodiscard]] QString sort() const;
 
+    /*!
+     * Returns an estimate of the bytes held by this track's data.
+     * Interned metadata (artists, albums, genres, ...) is shared with other tracks, so isn't included.
+     */
+    [[nodiscard]] size_t memoryUsage() const;
+
     void setLibraryId(int id);
+    void setAlbumId(int id);
     void setIsEnabled(bool enabled);
     void setId(int id);
-    void setHash(const QString& hash);
+    void setHash(uint64_t hash);
     void setType(Type type);
     void setFilePath(const QString& path);
     void setRelativePath(const QString& path);
@@ -160,6 +201,8 @@ public:
     void setComposer(const QString& composer);
     void setPerformer(const QString& performer);
     void setDuration(uint64_t duration);
+    void setOffset(uint64_t offset);
+    void setCuePath(const QString& path);
     void setComment(const QString& comment);
     void setDate(const QString& date);
     void setYear(int year);
@@ -190,19 +233,28 @@ public:
     void setSort(const QString& sort);
     void clearWasModified();
 
+    /** Returns the filepath of the file at @p entryPath inside the archive at @p archivePath. */
+    static QString archiveFilepath(const QString& archivePath, const QString& entryPath);
+
     static QStringList supportedFileExtensions();
     static QStringList supportedMimeTypes();
 
 private:
     struct Private;
     QSharedDataPointer<Private> p;
+    // Play count, rating and play times, shared separately so changing them doesn't copy the metadata
+    struct Stats;
+    QSharedDataPointer<Stats> m_stats;
 };
 FYCORE_EXPORT size_t qHash(const Track& track);
 
 using TrackIds      = std::vector<int>;
 using TrackList     = std::vector<Track>;
+// Shares a list across threads without copying it into each queued signal
+using TrackListPtr  = std::shared_ptr<const TrackList>;
 using TrackIdMap    = std::unordered_map<int, Track>;
 using TrackFieldMap = std::unordered_map<QString, Track>;
+using TrackHashMap  = std::unordered_map<uint64_t, Track>;
 } // namespace Fooyin
 
 FYCORE_EXPORT QDataStream& operator<<(QDataStream& stream, const Fooyin::TrackIds& tracks);
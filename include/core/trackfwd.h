@@ -19,9 +19,11 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 namespace Fooyin {
 class Track;
-using TrackList = std::vector<Track>;
+using TrackList    = std::vector<Track>;
+using TrackListPtr = std::shared_ptr<const TrackList>;
 } // namespace Fooyin
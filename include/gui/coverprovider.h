@@ -25,6 +25,7 @@
 
 #include <QObject>
 
+#include <cstdint>
 #include <memory>
 
 class QPixmap;
@@ -42,6 +43,21 @@ class FYGUI_EXPORT CoverProvider : public QObject
     Q_OBJECT
 
 public:
+    struct CacheStats
+    {
+        uint64_t memoryHits{0};
+        uint64_t memoryMisses{0};
+        uint64_t memoryEvictions{0};
+        size_t memoryUsage{0};
+        size_t memoryBudget{0};
+        int memoryEntries{0};
+
+        uint64_t diskHits{0};
+        uint64_t diskMisses{0};
+        int64_t diskUsage{0};
+        int diskEntries{0};
+    };
+
     explicit CoverProvider(SettingsManager* settings, QObject* parent = nullptr);
     ~CoverProvider() override;
 
@@ -67,6 +83,11 @@ public:
     void setLimitThumbSize(bool enabled);
     /** If @c true, overrides the default behaviour of only storing thumbnails for embedded artwork. */
     void setAlwaysStoreThumbnail(bool enabled);
+    /*!
+     * Cancels covers requested by this provider which haven't started loading, e.g. after the view
+     * showing them has been reset. @fn coverAdded won't be emitted for them.
+     */
+    void cancelPending();
 
     /*!
      * This will return the picture of @p type for the @p track if it exists in the cache.
@@ -92,12 +113,16 @@ public:
      */
     [[nodiscard]] QPixmap trackCoverThumbnail(const Track& track, Track::Cover type = Track::Cover::Front) const;
 
-    /** Clears the QPixmapCache as well as the on-disk cache. */
+    /** Clears the in-memory cover cache as well as the on-disk cache. */
     static void clearCache();
     /** Removes all covers of the @p track from the cache. */
     static void removeFromCache(const Track& track);
     /** Removes the cover with the @p key from the cache. */
     static void removeFromCache(const QString& key);
+    /** Returns hit/miss counts and usage of the cover cache shared by all providers. */
+    static CacheStats cacheStats();
+    /** Sets the memory budget of the cover cache shared by all providers to @p bytes. */
+    static void setCacheBudget(size_t bytes);
 
 signals:
     /** Emitted after a @fn trackCover or @fn trackCoverThumbnail call if and when the cover is added to the cache. */
@@ -106,6 +106,8 @@ namespace Actions {
 constexpr auto AddFiles        = "File.AddFiles";
 constexpr auto AddFolders      = "File.AddFolders";
 constexpr auto NewPlaylist     = "File.NewPlaylist";
+constexpr auto ImportPlaylist  = "File.ImportPlaylist";
+constexpr auto ExportPlaylist  = "File.ExportPlaylist";
 constexpr auto New             = "File.New";
 constexpr auto Exit            = "File.Exit";
 constexpr auto Settings        = "Edit.Settings";
@@ -122,6 +124,7 @@ constexpr auto Previous        = "Playback.Previous";
 constexpr auto PlaybackDefault = "Playback.Order.Default";
 constexpr auto RepeatTrack     = "Playback.Order.RepeatTrack";
 constexpr auto RepeatPlaylist  = "Playback.Order.RepeatPlaylist";
+constexpr auto ShuffleAlbums   = "Playback.Order.ShuffleAlbums";
 constexpr auto ShuffleTracks   = "Playback.Order.ShuffleTracks";
 constexpr auto ScriptSandbox   = "View.ScriptSandbox";
 constexpr auto SelectAll       = "Edit.SelectAll";
@@ -143,6 +146,7 @@ constexpr auto TrackIds      = "application/x-fooyin-trackIds";
 namespace Page {
 constexpr auto GeneralCore        = "Fooyin.Page.General.Core";
 constexpr auto Engine             = "Fooyin.Page.Engine";
+constexpr auto EngineDsp          = "Fooyin.Page.Engine.Dsp";
 constexpr auto InterfaceGeneral   = "Fooyin.Page.Interface.General";
 constexpr auto Artwork            = "Fooyin.Page.Interface.Artwork";
 constexpr auto LibraryGeneral     = "Fooyin.Page.Library.General";
@@ -27,4 +27,5 @@ namespace Fooyin::Gui {
 FYGUI_EXPORT QString layoutsPath();
 FYGUI_EXPORT QString activeLayoutPath();
 FYGUI_EXPORT QString coverPath();
+FYGUI_EXPORT QString previewPath();
 } // namespace Fooyin::Gui
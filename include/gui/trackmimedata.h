@@ -0,0 +1,62 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fygui_export.h"
+
+#include <core/track.h>
+
+#include <QMimeData>
+
+namespace Fooyin {
+class MusicLibrary;
+
+/*!
+ * Mime data for a drag of tracks.
+ *
+ * The tracks themselves are held, so a drop within fooyin can use them directly. The serialised
+ * Constants::Mime::TrackIds format is only built if something outside the process asks for it.
+ */
+class FYGUI_EXPORT TrackMimeData : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    explicit TrackMimeData(TrackList tracks);
+
+    [[nodiscard]] const TrackList& tracks() const;
+
+    [[nodiscard]] bool hasFormat(const QString& mimeType) const override;
+    [[nodiscard]] QStringList formats() const override;
+
+    /*!
+     * Returns the tracks dropped as @p data.
+     * Tracks from a TrackMimeData are used as is, otherwise the serialised ids are looked up in @p library.
+     */
+    static TrackList tracksFromMimeData(const QMimeData* data, MusicLibrary* library);
+
+protected:
+    [[nodiscard]] QVariant retrieveData(const QString& mimeType, QMetaType type) const override;
+
+private:
+    TrackList m_tracks;
+    mutable QByteArray m_trackIds;
+};
+} // namespace Fooyin
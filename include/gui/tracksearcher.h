@@ -0,0 +1,72 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fygui_export.h"
+
+#include <core/trackfwd.h>
+
+#include <QObject>
+
+#include <memory>
+
+namespace Fooyin {
+class MusicLibrary;
+
+/*!
+ * Searches the library off the GUI thread as the user types.
+ *
+ * Searches are delayed slightly so a burst of keystrokes runs a single query. Starting a new
+ * search cancels any still running, and results of stale searches are never delivered.
+ * When a search extends the previous one, only the previous results are searched.
+ */
+class FYGUI_EXPORT TrackSearcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TrackSearcher(MusicLibrary* library, QObject* parent = nullptr);
+    ~TrackSearcher() override;
+
+    /** Returns the last search passed to search. */
+    [[nodiscard]] QString currentSearch() const;
+    /** Returns @c true if a search has been requested but its results haven't been delivered yet. */
+    [[nodiscard]] bool isSearching() const;
+
+    /** Sets how long (in ms) to wait after the last call to search before running it. */
+    void setDelay(int delay);
+
+    /*!
+     * Searches all tracks in the library for @p search, emitting searchFinished once done.
+     * An empty @p search finishes straight away with every track.
+     */
+    void search(const QString& search);
+    /** Cancels any pending or running search. */
+    void cancel();
+
+signals:
+    void searchFinished(const QString& search, const Fooyin::TrackList& tracks);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
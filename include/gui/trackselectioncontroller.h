@@ -54,6 +54,31 @@ enum ActionOption
 Q_DECLARE_FLAGS(ActionOptions, ActionOption)
 } // namespace PlaylistAction
 
+/*!
+ * A handle on a selection of tracks which is cheap to copy, as the tracks themselves are shared.
+ */
+class FYGUI_EXPORT TrackSelection
+{
+public:
+    TrackSelection();
+    explicit TrackSelection(TrackList tracks);
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+    /** Returns the first track, or an invalid track if the selection is empty. */
+    [[nodiscard]] Track front() const;
+    [[nodiscard]] const TrackList& tracks() const;
+
+private:
+    TrackListPtr m_tracks;
+};
+
+/*!
+ * Tracks the selection of each widget context and which one is active.
+ *
+ * Changes are applied immediately, but selectionChanged is emitted at most once a frame, so subscribers
+ * aren't refreshed for every step of a selection made with key repeat or a drag.
+ */
 class FYGUI_EXPORT TrackSelectionController : public QObject
 {
     Q_OBJECT
@@ -67,6 +92,8 @@ public:
 
     [[nodiscard]] Track selectedTrack() const;
     [[nodiscard]] TrackList selectedTracks() const;
+    /** Returns the selection of the active context without copying its tracks. */
+    [[nodiscard]] TrackSelection selection() const;
     void changeSelectedTracks(WidgetContext* context, int index, const TrackList& tracks, const QString& title = {});
     void changeSelectedTracks(WidgetContext* context, const TrackList& tracks, const QString& title = {});
     void changePlaybackOnSend(WidgetContext* context, bool enabled);
@@ -21,6 +21,8 @@
 
 #include <gui/fywidget.h>
 
+#include <functional>
+
 namespace Fooyin {
 class SettingsManager;
 class WidgetProvider;
@@ -61,8 +63,10 @@ public:
 
     /*!
      * Convenience method to load all widgets in the @p widgets array.
+     * Widgets at an index for which @p defer returns @c true won't be visible initially, so are only
+     * created once first shown.
      */
-    void loadWidgets(const QJsonArray& widgets);
+    void loadWidgets(const QJsonArray& widgets, const std::function<bool(int index)>& defer = {});
 
 private:
     WidgetProvider* m_widgetProvider;
@@ -55,6 +55,13 @@ public:
      * @returns true if the widget was registered, or false if a widget at @p key already exists.
      */
     bool registerWidget(const QString& key, std::function<FyWidget*()> instantiator, const QString& displayName);
+    /*!
+     * Registers a placeholder for a widget whose plugin hasn't been initialised yet.
+     * The first time the widget is created, @p loader is called to initialise the plugin, which
+     * is expected to register the real widget at @p key using @fn registerWidget.
+     * @returns true if the placeholder was registered, or false if a widget at @p key already exists.
+     */
+    bool registerPlaceholder(const QString& key, std::function<void()> loader, const QString& displayName);
 
     /*!
      * Sets the submenus the widget at @p key appears at in add/replace menus when layout editing.
@@ -69,6 +76,8 @@ public:
 
     /** Returns @c true if the widget at @p key exists. */
     [[nodiscard]] bool widgetExists(const QString& key) const;
+    /** Returns the display name of the widget at @p key, or @p key if it has none. */
+    [[nodiscard]] QString widgetName(const QString& key) const;
     /** Returns @c true if an instance can be created of the widget at @p key. */
     [[nodiscard]] bool canCreateWidget(const QString& key) const;
 
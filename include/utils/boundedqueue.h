@@ -0,0 +1,221 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A blocking queue holding at most a fixed number of items, for handing work between threads.
+ * Any number of threads may push and pop. Producers block while the queue is full, so a slow
+ * consumer holds back its producers rather than letting the queue grow without bound.
+ *
+ * Consumers can take several items under one lock with popBatch(), which amortises the synchronisation
+ * when each item is cheap to handle.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+        : m_capacity{std::max<size_t>(capacity, 1)}
+    { }
+
+    BoundedQueue(const BoundedQueue&)            = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /*!
+     * Adds @p item to the back of the queue, waiting for space if it is full.
+     * @returns false if the queue has been closed, in which case @p item is dropped.
+     */
+    bool push(T item)
+    {
+        std::unique_lock lock{m_mutex};
+        m_notFull.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+
+        if(m_closed) {
+            return false;
+        }
+
+        return pushLocked(std::move(item), lock);
+    }
+
+    /*!
+     * Adds @p item to the back of the queue if there is space for it.
+     * @returns false if the queue is full or closed, in which case @p item is left untouched.
+     */
+    bool tryPush(T&& item)
+    {
+        std::unique_lock lock{m_mutex};
+
+        if(m_closed || m_items.size() >= m_capacity) {
+            return false;
+        }
+
+        return pushLocked(std::move(item), lock);
+    }
+
+    /*!
+     * Adds @p item to the back of the queue, waiting up to @p timeout for space if it is full.
+     * @returns false if the wait timed out or the queue has been closed, in which case @p item is left untouched.
+     */
+    template <typename Rep, typename Period>
+    bool pushFor(T&& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock lock{m_mutex};
+
+        if(!m_notFull.wait_for(lock, timeout, [this]() { return m_closed || m_items.size() < m_capacity; })
+           || m_closed) {
+            return false;
+        }
+
+        return pushLocked(std::move(item), lock);
+    }
+
+    /*!
+     * Removes the item at the front of the queue, waiting for one if it is empty.
+     * @returns std::nullopt once the queue has been closed and emptied.
+     */
+    std::optional<T> pop()
+    {
+        std::unique_lock lock{m_mutex};
+        m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+
+        if(m_items.empty()) {
+            return {};
+        }
+
+        T item{std::move(m_items.front())};
+        m_items.pop_front();
+        lock.unlock();
+
+        m_notFull.notify_one();
+        return item;
+    }
+
+    /** Removes the item at the front of the queue if there is one, without waiting. */
+    std::optional<T> tryPop()
+    {
+        std::unique_lock lock{m_mutex};
+
+        if(m_items.empty()) {
+            return {};
+        }
+
+        T item{std::move(m_items.front())};
+        m_items.pop_front();
+        lock.unlock();
+
+        m_notFull.notify_one();
+        return item;
+    }
+
+    /*!
+     * Removes up to @p count items from the front of the queue, waiting for at least one if it is empty.
+     * @returns an empty list once the queue has been closed and emptied.
+     */
+    std::vector<T> popBatch(size_t count)
+    {
+        std::vector<T> items;
+
+        std::unique_lock lock{m_mutex};
+        m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+
+        const size_t taken = std::min(std::max<size_t>(count, 1), m_items.size());
+        items.reserve(taken);
+        std::move(m_items.begin(), m_items.begin() + static_cast<std::ptrdiff_t>(taken), std::back_inserter(items));
+        m_items.erase(m_items.begin(), m_items.begin() + static_cast<std::ptrdiff_t>(taken));
+        lock.unlock();
+
+        if(taken == 1) {
+            m_notFull.notify_one();
+        }
+        else if(taken > 1) {
+            m_notFull.notify_all();
+        }
+        return items;
+    }
+
+    /** Stops accepting new items. Items already queued can still be popped. */
+    void close()
+    {
+        {
+            const std::scoped_lock lock{m_mutex};
+            m_closed = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    /** Closes the queue and drops any items still in it. */
+    void cancel()
+    {
+        {
+            const std::scoped_lock lock{m_mutex};
+            m_closed = true;
+            m_items.clear();
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    [[nodiscard]] bool closed() const
+    {
+        const std::scoped_lock lock{m_mutex};
+        return m_closed;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        const std::scoped_lock lock{m_mutex};
+        return m_items.size();
+    }
+
+private:
+    bool pushLocked(T&& item, std::unique_lock<std::mutex>& lock)
+    {
+        m_items.push_back(std::move(item));
+        lock.unlock();
+
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    size_t m_capacity;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<T> m_items;
+    bool m_closed{false};
+};
+} // namespace Fooyin
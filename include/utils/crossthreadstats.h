@@ -0,0 +1,51 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * Counts the bytes copied into queued signals, i.e. across thread boundaries, per named channel.
+ * Large payloads should be handed over through a shared pointer instead, which this makes easy to check.
+ *
+ * Counting only happens in debug builds; in release builds every call is a no-op.
+ * Channel names must have static storage duration, i.e. be string literals.
+ * @note thread-safe.
+ */
+namespace Fooyin::CrossThreadStats {
+/** Records @p bytes copied for a queued signal on @p channel. */
+FYUTILS_EXPORT void recordCopy(const char* channel, size_t bytes);
+
+/** Records the copy of the elements of @p container, not including anything they share with the original. */
+template <typename Container>
+    requires requires(const Container& container) { container.size(); }
+void recordCopy(const char* channel, const Container& container)
+{
+    recordCopy(channel, container.size() * sizeof(typename Container::value_type));
+}
+
+/** Returns the total bytes recorded on every channel. */
+[[nodiscard]] FYUTILS_EXPORT uint64_t bytesCopied();
+/** Logs the bytes and copies recorded on each channel, if any. */
+FYUTILS_EXPORT void logSummary();
+} // namespace Fooyin::CrossThreadStats
@@ -22,7 +22,14 @@
 #include "fyutils_export.h"
 
 #include <QCryptographicHash>
+#include <QHashFunctions>
 #include <QString>
+#include <QSysInfo>
+#include <QVarLengthArray>
+#include <QtEndian>
+
+#include <concepts>
+#include <cstdint>
 
 namespace Fooyin::Utils {
 template <typename... Args>
@@ -35,6 +42,73 @@ QString generateHash(const Args&... args)
     return headerKey;
 }
 
+/*!
+ * Returns the 64-bit XXH64 hash of @p size bytes at @p data.
+ * The hash is the same between runs and platforms, so it may be persisted.
+ */
+FYUTILS_EXPORT uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+namespace Detail {
+using HashBuffer = QVarLengthArray<char16_t, 256>;
+
+inline char16_t toLittleEndian(char16_t value)
+{
+    return static_cast<char16_t>(qToLittleEndian(static_cast<quint16>(value)));
+}
+
+inline void appendHashData(HashBuffer& buffer, QStringView str)
+{
+    if constexpr(QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
+        buffer.append(str.utf16(), str.size());
+    }
+    else {
+        for(const QChar chr : str) {
+            buffer.push_back(toLittleEndian(chr.unicode()));
+        }
+    }
+    // Separates arguments, so ("ab", "c") and ("a", "bc") differ
+    buffer.push_back(toLittleEndian(u'\x1f'));
+}
+
+template <std::integral T>
+void appendHashData(HashBuffer& buffer, T value)
+{
+    auto bits = static_cast<uint64_t>(value);
+    for(int i{0}; i < 4; ++i) {
+        buffer.push_back(toLittleEndian(static_cast<char16_t>(bits & 0xFFFF)));
+        bits >>= 16;
+    }
+}
+} // namespace Detail
+
+/*!
+ * Returns a 64-bit hash of @p args, which may be strings or integers.
+ * Unlike generateHash, strings are hashed as they are, without being converted to UTF-8 or allocating.
+ * The hash is the same between runs and platforms, so it may be persisted.
+ */
+template <typename... Args>
+uint64_t generateHash64(const Args&... args)
+{
+    Detail::HashBuffer buffer;
+    (Detail::appendHashData(buffer, args), ...);
+    return hash64(buffer.constData(), static_cast<size_t>(buffer.size()) * sizeof(char16_t));
+}
+
+/*!
+ * Returns a key identifying @p args, for nodes held in memory.
+ * Much cheaper than generateHash, but the value may differ between runs, so it must never be persisted.
+ */
+template <typename... Args>
+QString generateKey(const Args&... args)
+{
+    return QString::number(static_cast<quint64>(qHashMulti(0, args...)), 16);
+}
+
 FYUTILS_EXPORT QString generateRandomHash();
 FYUTILS_EXPORT QString generateUniqueHash();
+/*!
+ * Returns a key which is distinct from every other one returned during this run.
+ * A cheap alternative to generateRandomHash for nodes held in memory.
+ */
+FYUTILS_EXPORT QString generateUniqueKey();
 } // namespace Fooyin::Utils
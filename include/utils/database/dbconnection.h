@@ -21,18 +21,42 @@
 
 #include "fyutils_export.h"
 
+#include "dbquery.h"
+
 #include <QSqlDatabase>
 
+#include <cstdint>
+#include <unordered_map>
+
 namespace Fooyin {
 class FYUTILS_EXPORT DbConnection
 {
 public:
+    /*!
+     * SQLite tuning applied to every connection opened from the same parameters.
+     * @note the journal mode is stored in the database file itself, so switching profiles
+     * only takes effect once no other connection is open.
+     */
+    enum class Profile : uint8_t
+    {
+        // Rollback journal with full syncs, as SQLite creates databases
+        Default,
+        // WAL journal, relaxed syncing, memory mapped I/O and a larger page cache
+        Performance,
+    };
+
     struct DbParams
     {
         QString type;
         QString connectOptions;
         QString hostName;
         QString filePath;
+        Profile profile{Profile::Default};
+        /*!
+         * Connections can't write (PRAGMA query_only), and never try to change the journal mode.
+         * With a WAL journal, their reads see a snapshot and are never blocked by a writer's transaction.
+         */
+        bool readOnly{false};
     };
 
     DbConnection(const DbParams& params, const QString& connectionName);
@@ -43,6 +67,8 @@ public:
     DbConnection(const DbConnection&&) = delete;
 
     [[nodiscard]] QString name() const;
+    [[nodiscard]] Profile profile() const;
+    [[nodiscard]] bool readOnly() const;
 
     bool open();
     void close();
@@ -51,7 +77,16 @@ public:
 
     [[nodiscard]] QSqlDatabase db() const;
 
+    /*!
+     * Returns a query prepared with @p statement, which is kept for as long as the connection is open.
+     * Avoids preparing the same statement again and again in hot paths such as bulk inserts.
+     */
+    DbQuery& cachedQuery(const QString& statement);
+
 private:
     QString m_name;
+    Profile m_profile;
+    bool m_readOnly;
+    std::unordered_map<QString, DbQuery> m_queries;
 };
 } // namespace Fooyin
@@ -39,7 +39,12 @@ public:
     DbConnectionPool(const DbConnectionPool& other)  = delete;
     DbConnectionPool(const DbConnectionPool&& other) = delete;
 
-    static DbConnectionPoolPtr create(const DbConnection::DbParams& params, const QString& connectionName);
+    /*!
+     * Creates a pool opening one connection per thread from @p params.
+     * @param connectionLimit the most connections open at once, or 0 for no limit. Threads beyond it get none.
+     */
+    static DbConnectionPoolPtr create(const DbConnection::DbParams& params, const QString& connectionName,
+                                      int connectionLimit = 0);
 
     [[nodiscard]] bool hasThreadConnection() const;
 
@@ -53,6 +58,8 @@ private:
 
     QThreadStorage<DbConnection*> m_threadConnections;
     std::atomic_int m_connectionCount;
+    std::atomic_int m_openConnections;
+    int m_connectionLimit;
     DbConnection m_prototype;
 };
 } // namespace Fooyin
@@ -31,6 +31,8 @@ public:
     explicit DbConnectionProvider(DbConnectionPoolPtr pool);
 
     [[nodiscard]] QSqlDatabase db() const;
+    /** Returns the thread connection's cached query for @p statement, or nullptr if there is no connection. */
+    [[nodiscard]] DbQuery* cachedQuery(const QString& statement) const;
 
 private:
     DbConnectionPoolPtr m_connectionPool;
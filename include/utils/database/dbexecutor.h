@@ -0,0 +1,99 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include "dbconnectionpool.h"
+#include "dbconnectionprovider.h"
+
+#include <QFuture>
+#include <QPromise>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace Fooyin {
+/*!
+ * Runs database work on a small set of threads, each holding its own connection from a DbConnectionPool.
+ * Queries are submitted as callables taking a DbConnectionProvider, and their result is returned
+ * through a QFuture, so callers never block on the database or create threads of their own.
+ *
+ * One thread only ever runs interactive work, so it is never stuck behind a long background task.
+ * @note tasks still queued when the executor is destroyed are cancelled.
+ */
+class FYUTILS_EXPORT DbExecutor
+{
+public:
+    enum class Priority : uint8_t
+    {
+        // Work the user is waiting on, which always runs before background work
+        Interactive,
+        // Maintenance and bulk work which can wait
+        Background,
+    };
+
+    using Task = std::function<void(const DbConnectionProvider&)>;
+
+    static constexpr int DefaultThreadCount = 2;
+
+    explicit DbExecutor(DbConnectionPoolPtr pool, int threadCount = DefaultThreadCount);
+    ~DbExecutor();
+
+    DbExecutor(const DbExecutor& other)            = delete;
+    DbExecutor& operator=(const DbExecutor& other) = delete;
+
+    /*!
+     * Queues @p func to be called with a provider for the executing thread's connection.
+     * @returns a future holding the value returned by @p func. It is cancelled if @p func never runs.
+     * @note @p func is skipped if the future has been cancelled before it is started.
+     */
+    template <typename Func>
+    auto run(Priority priority, Func func) -> QFuture<std::invoke_result_t<Func, const DbConnectionProvider&>>
+    {
+        using Result = std::invoke_result_t<Func, const DbConnectionProvider&>;
+
+        auto promise = std::make_shared<QPromise<Result>>();
+        auto future  = promise->future();
+
+        enqueue(priority, [promise, func = std::move(func)](const DbConnectionProvider& provider) mutable {
+            promise->start();
+            if(!promise->isCanceled()) {
+                if constexpr(std::is_void_v<Result>) {
+                    func(provider);
+                }
+                else {
+                    promise->addResult(func(provider));
+                }
+            }
+            promise->finish();
+        });
+
+        return future;
+    }
+
+private:
+    void enqueue(Priority priority, Task task);
+
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
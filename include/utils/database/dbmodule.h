@@ -37,6 +37,11 @@ public:
         return m_dbProvider.db();
     }
 
+    [[nodiscard]] DbQuery* cachedQuery(const QString& statement) const
+    {
+        return m_dbProvider.cachedQuery(statement);
+    }
+
 private:
     DbConnectionProvider m_dbProvider;
 };
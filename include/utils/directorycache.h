@@ -0,0 +1,89 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <utils/fileutils.h>
+
+#include <QStringList>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Listings of directories, cached until the directory's modification time changes.
+ *
+ * Adding, removing or renaming an entry updates a directory's modification time, so an unchanged
+ * directory is only stat'd rather than read again. Changing a file's contents doesn't, so the size and
+ * modification time of cached files may be out of date; only their paths can be relied upon.
+ *
+ * Hidden entries are skipped, as with QDir defaults, and entries are sorted by name, ignoring case.
+ * Cached listings are evicted least recently used first once they exceed the budget.
+ * @note thread-safe.
+ */
+class FYUTILS_EXPORT DirectoryCache
+{
+public:
+    struct Listing
+    {
+        QString path;
+        // Milliseconds since epoch
+        uint64_t modifiedTime{0};
+        // Files matching the extensions of the cache
+        std::vector<Utils::File::FileEntry> files;
+        // Absolute paths
+        QStringList subdirectories;
+    };
+    // Return false to stop the walk
+    using ListingCallback = std::function<bool(const Listing&)>;
+
+    explicit DirectoryCache(QStringList fileExtensions, size_t budget = DefaultBudget);
+    ~DirectoryCache();
+
+    DirectoryCache(const DirectoryCache& other)            = delete;
+    DirectoryCache& operator=(const DirectoryCache& other) = delete;
+
+    static constexpr size_t DefaultBudget = 8 * 1024 * 1024;
+
+    [[nodiscard]] QStringList fileExtensions() const;
+
+    /** Returns the listing of @p directory, which is empty if it doesn't exist. */
+    [[nodiscard]] Listing listing(const QString& directory);
+
+    /*!
+     * Calls @p callback with the listing of @p directory, then, if @p recursive, those of its subdirectories
+     * in breadth first order. Results are handed over one directory at a time, as each is listed.
+     * @returns false if the walk was stopped by @p callback.
+     */
+    bool walk(const QString& directory, bool recursive, const ListingCallback& callback);
+    /** Returns the paths of all files found by @fn walk. */
+    [[nodiscard]] QStringList files(const QString& directory, bool recursive);
+
+    void invalidate(const QString& directory);
+    void clear();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
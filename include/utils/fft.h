@@ -0,0 +1,65 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <complex>
+#include <span>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A fast Fourier transform of real input, e.g. windowed audio for a spectrum.
+ *
+ * The input is packed into a complex transform of half the size, which is then split into the spectrum
+ * of the real signal. Twiddle factors and the bit-reversal order are computed once, on construction, and
+ * the loops are kept simple and contiguous so the compiler can vectorise them.
+ * @note a single instance isn't thread-safe, as it transforms in a buffer of its own.
+ */
+class FYUTILS_EXPORT RealFft
+{
+public:
+    /** Creates a transform of @p size points, rounded up to a power of two of at least 4. */
+    explicit RealFft(int size);
+
+    [[nodiscard]] int size() const;
+    /** Returns the number of frequency bins produced, i.e. size() / 2 + 1. */
+    [[nodiscard]] int binCount() const;
+
+    /*!
+     * Transforms size() samples of @p input into binCount() bins in @p output, from 0 Hz to the Nyquist
+     * frequency. The output isn't normalised.
+     */
+    void transform(std::span<const float> input, std::span<std::complex<float>> output);
+    /** As @fn transform, but only writes the magnitude of each bin, divided by size() / 2. */
+    void magnitudes(std::span<const float> input, std::span<float> output);
+
+private:
+    int m_size;
+    std::vector<std::complex<float>> m_buffer;
+    // For the half size complex transform
+    std::vector<std::complex<float>> m_twiddles;
+    std::vector<int> m_bitReversed;
+    // For splitting the complex transform into the real spectrum
+    std::vector<std::complex<float>> m_splitTwiddles;
+    std::vector<std::complex<float>> m_spectrum;
+};
+} // namespace Fooyin
@@ -24,19 +24,86 @@
 #include <QStringList>
 #include <QUrl>
 
+#include <functional>
+
 class QDir;
 
 namespace Fooyin::Utils::File {
+/*!
+ * A file found by @fn findFilesRecursive.
+ * The size and modification time are taken from the stat done while enumerating,
+ * so callers don't need to query the filesystem again.
+ */
+struct FileEntry
+{
+    QString path;
+    int64_t size{0};
+    // Milliseconds since epoch, matching QFileInfo::lastModified
+    uint64_t modifiedTime{0};
+};
+// Return false to stop enumerating
+using FileEntryCallback = std::function<bool(const FileEntry&)>;
+
+/*!
+ * A directory visited by @fn findFilesRecursive, before any of its files are reported.
+ * Adding, removing or renaming an entry updates the modification time, but changing a file's contents doesn't.
+ */
+struct DirectoryEntry
+{
+    QString path;
+    // Milliseconds since epoch
+    uint64_t modifiedTime{0};
+    // Number of entries, excluding hidden ones
+    int entryCount{0};
+};
+
+enum class DirectoryAction : uint8_t
+{
+    Visit,
+    // Don't report the files in this directory, but still visit its subdirectories
+    SkipFiles,
+    Stop,
+};
+using DirectoryCallback = std::function<DirectoryAction(const DirectoryEntry&)>;
+
+/*!
+ * The device a path is stored on.
+ * Paths on different devices can be read in parallel without competing for the same disk.
+ */
+struct StorageDevice
+{
+    // The st_dev of the path, or -1 if it couldn't be read
+    int64_t id{-1};
+    // Spinning disks slow down when reads seek back and forth between files
+    bool rotational{false};
+    // Every stat, open and read of a network filesystem costs a round trip
+    bool network{false};
+};
+
 FYUTILS_EXPORT QString cleanPath(const QString& path);
 FYUTILS_EXPORT bool isSamePath(const QString& filename1, const QString& filename2);
 FYUTILS_EXPORT bool isSubdir(const QString& dir, const QString& parentDir);
 FYUTILS_EXPORT QString getParentDirectory(const QString& filename);
+FYUTILS_EXPORT StorageDevice storageDevice(const QString& path);
+/** Returns @c true if the open file @p fd is on a network filesystem (NFS, SMB/CIFS, or FUSE such as sshfs). */
+FYUTILS_EXPORT bool isNetworkFilesystem(int fd);
 
 FYUTILS_EXPORT bool createDirectories(const QString& path);
 FYUTILS_EXPORT void openDirectory(const QString& dir);
 
 FYUTILS_EXPORT QStringList getFilesInDir(const QDir& baseDirectory, const QStringList& fileExtensions = {});
 FYUTILS_EXPORT QStringList getFilesInDirRecursive(const QDir& baseDirectory, const QStringList& fileExtensions = {});
+/*!
+ * Walks @p directory and its subdirectories, calling @p callback for each file matching @p fileExtensions
+ * as soon as it is found.
+ * Hidden files and directories are skipped, and symlinked directories are only visited once.
+ * If set, @p directoryCallback is called for each directory and decides whether its files are reported.
+ * @note files are reported in directory order, not sorted.
+ * @returns false if the walk was stopped by either callback.
+ */
+FYUTILS_EXPORT bool findFilesRecursive(const QString& directory, const QStringList& fileExtensions,
+                                       const FileEntryCallback& callback,
+                                       const DirectoryCallback& directoryCallback = {});
 FYUTILS_EXPORT QList<QUrl> getUrlsInDir(const QDir& baseDirectory, const QStringList& fileExtensions = {});
 FYUTILS_EXPORT QList<QUrl> getUrlsInDirRecursive(const QDir& baseDirectory, const QStringList& fileExtensions = {});
 FYUTILS_EXPORT QStringList getFiles(const QStringList& paths, const QStringList& fileExtensions = {});
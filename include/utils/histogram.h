@@ -0,0 +1,120 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace Fooyin {
+/*!
+ * Counts values in power-of-two buckets, e.g. frame times in microseconds.
+ * Bucket 0 holds zero, and bucket i holds values in [2^(i-1), 2^i), with the last bucket holding everything above.
+ * Percentiles are the upper bound of the bucket they fall in, so they're accurate to within a factor of two.
+ */
+class Histogram
+{
+public:
+    static constexpr size_t BucketCount = 40;
+
+    void add(uint64_t value)
+    {
+        const auto bucket = std::min(static_cast<size_t>(std::bit_width(value)), BucketCount - 1);
+        ++m_buckets[bucket];
+        ++m_count;
+        m_sum += value;
+        m_max = std::max(m_max, value);
+    }
+
+    void clear()
+    {
+        *this = {};
+    }
+
+    /** Adds every value counted by @p other. */
+    void merge(const Histogram& other)
+    {
+        for(size_t bucket{0}; bucket < BucketCount; ++bucket) {
+            m_buckets[bucket] += other.m_buckets[bucket];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    [[nodiscard]] uint64_t count() const
+    {
+        return m_count;
+    }
+
+    [[nodiscard]] uint64_t sum() const
+    {
+        return m_sum;
+    }
+
+    [[nodiscard]] uint64_t max() const
+    {
+        return m_max;
+    }
+
+    [[nodiscard]] double mean() const
+    {
+        return m_count > 0 ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0;
+    }
+
+    [[nodiscard]] uint64_t bucketCount(size_t bucket) const
+    {
+        return m_buckets.at(bucket);
+    }
+
+    /** Returns an upper bound for the value below which @p percentile (0-100) of values fall. */
+    [[nodiscard]] uint64_t percentile(double percentile) const
+    {
+        if(m_count == 0) {
+            return 0;
+        }
+
+        const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+        const auto target     = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(m_count)));
+
+        uint64_t seen{0};
+        for(size_t bucket{0}; bucket < BucketCount; ++bucket) {
+            seen += m_buckets[bucket];
+            if(seen >= target) {
+                if(bucket == BucketCount - 1) {
+                    return m_max;
+                }
+                const uint64_t upper = bucket == 0 ? 0 : (uint64_t{1} << bucket) - 1;
+                return std::min(upper, m_max);
+            }
+        }
+
+        return m_max;
+    }
+
+private:
+    std::array<uint64_t, BucketCount> m_buckets{};
+    uint64_t m_count{0};
+    uint64_t m_sum{0};
+    uint64_t m_max{0};
+};
+} // namespace Fooyin
@@ -0,0 +1,188 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace Fooyin {
+/*!
+ * A least recently used cache bounded by the total cost of its entries rather than their number.
+ * Inserting beyond the budget evicts the entries which were looked up longest ago.
+ *
+ * Costs are supplied by the caller, e.g. the size in bytes of a decoded image.
+ * @note not thread-safe.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+    };
+
+    explicit LruCache(size_t budget = 0)
+        : m_budget{budget}
+    { }
+
+    [[nodiscard]] size_t budget() const
+    {
+        return m_budget;
+    }
+
+    /** Changes the budget to @p budget, evicting entries if the cache no longer fits. */
+    void setBudget(size_t budget)
+    {
+        m_budget = budget;
+        trim(m_budget);
+    }
+
+    /** Returns the combined cost of all entries. */
+    [[nodiscard]] size_t cost() const
+    {
+        return m_cost;
+    }
+
+    [[nodiscard]] size_t count() const
+    {
+        return m_entries.size();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return m_entries.empty();
+    }
+
+    [[nodiscard]] Stats stats() const
+    {
+        return m_stats;
+    }
+
+    void resetStats()
+    {
+        m_stats = {};
+    }
+
+    /** Returns @c true if @p key is cached, without affecting its recency or the hit/miss stats. */
+    [[nodiscard]] bool contains(const Key& key) const
+    {
+        return m_index.contains(key);
+    }
+
+    /*!
+     * Returns the value cached for @p key and marks it as the most recently used.
+     * @returns nullptr if @p key isn't cached.
+     * @note the returned pointer is invalidated by the next insertion or removal.
+     */
+    const Value* find(const Key& key)
+    {
+        const auto it = m_index.find(key);
+        if(it == m_index.end()) {
+            ++m_stats.misses;
+            return nullptr;
+        }
+
+        ++m_stats.hits;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return &it->second->value;
+    }
+
+    /*!
+     * Caches @p value for @p key, replacing any existing entry.
+     * @returns @c false if @p cost alone exceeds the budget, in which case nothing is cached.
+     */
+    bool insert(const Key& key, Value value, size_t cost)
+    {
+        remove(key);
+
+        if(cost > m_budget) {
+            return false;
+        }
+
+        trim(m_budget - cost);
+
+        m_entries.emplace_front(key, std::move(value), cost);
+        m_index.emplace(key, m_entries.begin());
+        m_cost += cost;
+
+        return true;
+    }
+
+    bool remove(const Key& key)
+    {
+        const auto it = m_index.find(key);
+        if(it == m_index.end()) {
+            return false;
+        }
+
+        m_cost -= it->second->cost;
+        m_entries.erase(it->second);
+        m_index.erase(it);
+
+        return true;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+        m_cost = 0;
+    }
+
+    /** Evicts the least recently used entries until their combined cost is at most @p limit. */
+    void trim(size_t limit)
+    {
+        while(m_cost > limit && !m_entries.empty()) {
+            const Entry& entry = m_entries.back();
+            m_cost -= entry.cost;
+            m_index.erase(entry.key);
+            m_entries.pop_back();
+            ++m_stats.evictions;
+        }
+    }
+
+private:
+    struct Entry
+    {
+        Entry(Key key_, Value value_, size_t cost_)
+            : key{std::move(key_)}
+            , value{std::move(value_)}
+            , cost{cost_}
+        { }
+
+        Key key;
+        Value value;
+        size_t cost;
+    };
+
+    size_t m_budget;
+    size_t m_cost{0};
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> m_index;
+    Stats m_stats;
+};
+} // namespace Fooyin
@@ -0,0 +1,101 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+/*!
+ * Accounts for memory held by each subsystem (tracks, covers, model items, ...) and frees what can be
+ * rebuilt when memory runs short.
+ *
+ * Subsystems register a source reporting their usage, and optionally a way to trim it. Sources sharing a
+ * name, e.g. one per playlist view, are reported together.
+ * @note must only be used from the main thread.
+ */
+namespace Fooyin::MemoryUsage {
+struct Usage
+{
+    size_t bytes{0};
+    size_t entries{0};
+};
+
+struct Report
+{
+    QString name;
+    Usage usage;
+    bool trimmable{false};
+};
+using ReportList = std::vector<Report>;
+
+/*!
+ * Order in which sources are trimmed, so what's cheapest to rebuild goes first.
+ * Sources of the same priority are trimmed in the order they were added.
+ */
+enum class TrimPriority : uint8_t
+{
+    First = 0,
+    Normal,
+    Last,
+};
+
+using UsageFunc = std::function<Usage()>;
+using TrimFunc  = std::function<void()>;
+
+/*!
+ * Adds a source called @p name, whose current usage is returned by @p usage.
+ * If @p trim is set, it's called to free as much as the source can when memory is short.
+ * @returns an id to pass to removeSource once the source is destroyed.
+ */
+FYUTILS_EXPORT int addSource(const QString& name, UsageFunc usage, TrimFunc trim = {},
+                             TrimPriority priority = TrimPriority::Normal);
+FYUTILS_EXPORT void removeSource(int id);
+
+/** Returns the usage of every source, in the order they were first added. */
+[[nodiscard]] FYUTILS_EXPORT ReportList report();
+/** Returns the combined usage of every source in bytes. */
+[[nodiscard]] FYUTILS_EXPORT size_t total();
+
+/*!
+ * Trims sources in priority order until the total is at most @p target bytes, then hands freed memory
+ * back to the system.
+ * @returns the number of bytes freed.
+ */
+FYUTILS_EXPORT size_t trim(size_t target = 0);
+
+/*!
+ * Returns the share of the last 10 seconds in which some thread was stalled waiting on memory, as a
+ * percentage, from the kernel's pressure stall information.
+ * @returns std::nullopt if not supported by the system.
+ */
+[[nodiscard]] FYUTILS_EXPORT std::optional<double> pressure();
+
+/** Returns the number of bytes held by @p str, whether or not its storage is shared. */
+[[nodiscard]] FYUTILS_EXPORT size_t stringBytes(const QString& str);
+/** Returns the number of bytes held by @p strings, including each of its strings. */
+[[nodiscard]] FYUTILS_EXPORT size_t stringBytes(const QStringList& strings);
+} // namespace Fooyin::MemoryUsage
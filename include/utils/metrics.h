@@ -0,0 +1,206 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*!
+ * A process-wide registry of counters, gauges and histograms, exported in the OpenMetrics text format.
+ *
+ * Metrics are registered once by name and live until the process exits, so call sites keep a reference in a
+ * function-local static. Recording is a single relaxed atomic operation and never takes a lock, so it's safe
+ * on the audio and decode threads.
+ *
+ * Values which already exist elsewhere, e.g. engine statistics, are better reported by a collector, which is
+ * only called when the metrics are exported.
+ *
+ * Names must have static storage duration, i.e. be string literals, and should be in base units (seconds,
+ * bytes) as OpenMetrics expects. Histograms record microseconds and are exported in seconds.
+ */
+namespace Fooyin::Metrics {
+// Kept on their own cache line so threads updating neighbouring metrics don't contend
+inline constexpr size_t CacheLine = 64;
+
+class alignas(CacheLine) Counter
+{
+public:
+    void add(uint64_t count = 1)
+    {
+        m_value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t value() const
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+class alignas(CacheLine) Gauge
+{
+public:
+    void set(double value)
+    {
+        m_value.store(std::bit_cast<uint64_t>(value), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] double value() const
+    {
+        return std::bit_cast<double>(m_value.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::atomic<uint64_t> m_value{std::bit_cast<uint64_t>(0.0)};
+};
+
+/*!
+ * Counts durations in microseconds in power-of-two buckets, as Histogram does.
+ * Bucket 0 holds zero, and bucket i holds values in [2^(i-1), 2^i), with the last bucket holding everything above.
+ */
+class alignas(CacheLine) LatencyHistogram
+{
+public:
+    static constexpr size_t BucketCount = 32;
+
+    void record(uint64_t micros)
+    {
+        const auto bucket = std::min(static_cast<size_t>(std::bit_width(micros)), BucketCount - 1);
+        m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    void record(std::chrono::steady_clock::duration duration)
+    {
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+    }
+
+    [[nodiscard]] uint64_t count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t sum() const
+    {
+        return m_sum.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t bucketCount(size_t bucket) const
+    {
+        return m_buckets.at(bucket).load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+};
+
+/*!
+ * Records the time from construction to destruction in @p histogram.
+ * @code
+ * static auto& queryTime = Metrics::histogram("fooyin_db_query_seconds", "Time taken to execute a query");
+ * const Metrics::ScopedTimer timer{queryTime};
+ * @endcode
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(LatencyHistogram& histogram)
+        : m_histogram{histogram}
+        , m_start{std::chrono::steady_clock::now()}
+    { }
+
+    ~ScopedTimer()
+    {
+        m_histogram.record(std::chrono::steady_clock::now() - m_start);
+    }
+
+    ScopedTimer(const ScopedTimer&)            = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    LatencyHistogram& m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/*!
+ * Returns the counter called @p name, registering it with @p help the first time.
+ * Counters are exported with a _total suffix, which @p name shouldn't include.
+ */
+[[nodiscard]] FYUTILS_EXPORT Counter& counter(const char* name, const char* help);
+/** Returns the gauge called @p name, registering it with @p help the first time. */
+[[nodiscard]] FYUTILS_EXPORT Gauge& gauge(const char* name, const char* help);
+/** Returns the histogram called @p name, registering it with @p help the first time. */
+[[nodiscard]] FYUTILS_EXPORT LatencyHistogram& histogram(const char* name, const char* help);
+
+enum class Type : uint8_t
+{
+    Counter = 0,
+    Gauge,
+};
+
+/*!
+ * A value reported by a collector.
+ * Samples sharing a name are exported as one family, e.g. one per output device told apart by @c labels,
+ * which are formatted as by label(). Only the type and help of the first sample in a family are used.
+ */
+struct Sample
+{
+    QString name;
+    QString help;
+    Type type{Type::Gauge};
+    QString labels;
+    double value{0};
+};
+using SampleList = std::vector<Sample>;
+
+using CollectFunc = std::function<void(SampleList&)>;
+
+/*!
+ * Adds a collector which appends its current values to the list it's given when metrics are exported.
+ * @returns an id to pass to removeCollector before whatever @p collect reads is destroyed.
+ * @note collectors are called on the thread exporting the metrics, which should be the main thread.
+ */
+FYUTILS_EXPORT int addCollector(CollectFunc collect);
+FYUTILS_EXPORT void removeCollector(int id);
+
+/** Returns @p key="@p value", escaped for use as the labels of a Sample. */
+[[nodiscard]] FYUTILS_EXPORT QString label(const QString& key, const QString& value);
+
+/** Returns every metric and collected sample in the OpenMetrics text format, ending with # EOF. */
+[[nodiscard]] FYUTILS_EXPORT QByteArray openMetrics();
+} // namespace Fooyin::Metrics
@@ -0,0 +1,83 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <cstdint>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * A key-value store of binary blobs held in a single file.
+ * Records are appended to the end of the file; replaced and removed records leave dead space behind,
+ * which is reclaimed by @fn compact. The index of keys to records is rebuilt when the file is opened
+ * by scanning the record headers, so lookups never touch the disk.
+ *
+ * A torn record at the end of the file (e.g. after a crash) is discarded when opened.
+ * @note thread-safe.
+ */
+class FYUTILS_EXPORT PackFile
+{
+public:
+    explicit PackFile(const QString& filepath);
+    ~PackFile();
+
+    PackFile(const PackFile& other)            = delete;
+    PackFile& operator=(const PackFile& other) = delete;
+
+    [[nodiscard]] QString filepath() const;
+
+    /** Opens the file, creating it if it doesn't exist or isn't a valid pack file. */
+    bool open();
+    void close();
+    [[nodiscard]] bool isOpen() const;
+
+    [[nodiscard]] bool contains(const QString& key) const;
+    /** Returns the data stored for @p key, or an empty array if there is none. */
+    [[nodiscard]] QByteArray value(const QString& key) const;
+
+    /*!
+     * Stores @p data for @p key, replacing any existing record.
+     * @note empty @p data is not stored; use @fn remove instead.
+     */
+    bool insert(const QString& key, const QByteArray& data);
+    bool remove(const QString& key);
+    /** Removes every record and truncates the file. */
+    bool clear();
+
+    [[nodiscard]] int count() const;
+    /** Returns the size of the file in bytes. */
+    [[nodiscard]] int64_t size() const;
+    /** Returns the number of bytes taken up by replaced or removed records. */
+    [[nodiscard]] int64_t wastedSize() const;
+
+    /** Rewrites the file with only the live records. */
+    bool compact();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,145 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A Fenwick (binary indexed) tree over a sequence of non-negative values, e.g. row heights.
+ *
+ * Building from a full sequence is O(n); changing a single value, querying a prefix sum and
+ * finding the item containing an offset are all O(log n).
+ */
+template <typename T>
+class PrefixSumTree
+{
+    static_assert(std::is_arithmetic_v<T>, "PrefixSumTree only supports arithmetic types");
+
+public:
+    PrefixSumTree() = default;
+
+    explicit PrefixSumTree(std::span<const T> values)
+    {
+        assign(values);
+    }
+
+    /** Replaces the contents with @p values. */
+    void assign(std::span<const T> values)
+    {
+        m_values.assign(values.begin(), values.end());
+        m_tree = m_values;
+
+        const size_t count = m_tree.size();
+        for(size_t i{1}; i <= count; ++i) {
+            const size_t parent = i + (i & (~i + 1));
+            if(parent <= count) {
+                m_tree[parent - 1] += m_tree[i - 1];
+            }
+        }
+    }
+
+    void clear()
+    {
+        m_values.clear();
+        m_tree.clear();
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return m_values.size();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return m_values.empty();
+    }
+
+    [[nodiscard]] T value(size_t index) const
+    {
+        return m_values.at(index);
+    }
+
+    /** Changes the value at @p index to @p value. */
+    void set(size_t index, T value)
+    {
+        const T delta = value - m_values.at(index);
+        if(delta == T{}) {
+            return;
+        }
+
+        m_values[index] = value;
+
+        const size_t count = m_tree.size();
+        for(size_t i{index + 1}; i <= count; i += i & (~i + 1)) {
+            m_tree[i - 1] += delta;
+        }
+    }
+
+    /** Returns the sum of the first @p count values. */
+    [[nodiscard]] T prefix(size_t count) const
+    {
+        T sum{};
+        for(size_t i{std::min(count, m_tree.size())}; i > 0; i -= i & (~i + 1)) {
+            sum += m_tree[i - 1];
+        }
+        return sum;
+    }
+
+    [[nodiscard]] T total() const
+    {
+        return prefix(m_tree.size());
+    }
+
+    /*!
+     * Returns the index of the item spanning @p offset, i.e. the first item whose running total exceeds it.
+     * Items with a value of zero are skipped.
+     * @returns size() if @p offset is at or beyond the total.
+     */
+    [[nodiscard]] size_t indexAt(T offset) const
+    {
+        if(offset < T{}) {
+            return 0;
+        }
+
+        const size_t count = m_tree.size();
+        size_t pos{0};
+        T remaining{offset};
+
+        for(size_t step{std::bit_floor(count)}; step > 0; step >>= 1) {
+            if(pos + step <= count && m_tree[pos + step - 1] <= remaining) {
+                pos += step;
+                remaining -= m_tree[pos - 1];
+            }
+        }
+
+        return pos;
+    }
+
+private:
+    std::vector<T> m_values;
+    std::vector<T> m_tree;
+};
+} // namespace Fooyin
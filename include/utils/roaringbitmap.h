@@ -0,0 +1,411 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A compressed set of 32-bit values, e.g. track ids, in the style of a roaring bitmap.
+ * Values are split into chunks by their upper 16 bits. Sparse chunks are held as a sorted array of the lower
+ * 16 bits, and dense chunks as a 65536-bit bitmap, so both sparse and dense sets stay small.
+ *
+ * Intersections and unions work a chunk at a time, and on dense chunks a 64-bit word at a time,
+ * which is far cheaper than comparing lists of values.
+ */
+class RoaringBitmap
+{
+public:
+    RoaringBitmap() = default;
+
+    template <typename Range>
+    static RoaringBitmap fromValues(const Range& values)
+    {
+        RoaringBitmap bitmap;
+        for(const auto value : values) {
+            bitmap.add(static_cast<uint32_t>(value));
+        }
+        return bitmap;
+    }
+
+    /** Adds @p value, returning @c true if it wasn't already in the set. */
+    bool add(uint32_t value)
+    {
+        const auto key      = static_cast<uint16_t>(value >> 16);
+        const auto low      = static_cast<uint16_t>(value & 0xFFFF);
+        const auto position = findContainer(key);
+
+        if(position == m_containers.end() || position->key != key) {
+            auto& container = *m_containers.insert(position, Container{key});
+            container.array.push_back(low);
+            container.count = 1;
+            return true;
+        }
+
+        return position->add(low);
+    }
+
+    /** Removes @p value, returning @c true if it was in the set. */
+    bool remove(uint32_t value)
+    {
+        const auto key      = static_cast<uint16_t>(value >> 16);
+        const auto position = findContainer(key);
+
+        if(position == m_containers.end() || position->key != key) {
+            return false;
+        }
+
+        const bool removed = position->remove(static_cast<uint16_t>(value & 0xFFFF));
+        if(position->count == 0) {
+            m_containers.erase(position);
+        }
+        return removed;
+    }
+
+    [[nodiscard]] bool contains(uint32_t value) const
+    {
+        const auto key      = static_cast<uint16_t>(value >> 16);
+        const auto position = findContainer(key);
+
+        return position != m_containers.end() && position->key == key
+            && position->contains(static_cast<uint16_t>(value & 0xFFFF));
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        size_t count{0};
+        for(const Container& container : m_containers) {
+            count += container.count;
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return m_containers.empty();
+    }
+
+    void clear()
+    {
+        m_containers.clear();
+    }
+
+    /** Calls @p func with each value in the set, in ascending order. */
+    template <typename Func>
+    void forEach(Func&& func) const
+    {
+        for(const Container& container : m_containers) {
+            const uint32_t high = static_cast<uint32_t>(container.key) << 16;
+
+            if(container.isBitmap()) {
+                for(size_t word{0}; word < BitmapWords; ++word) {
+                    uint64_t bits = container.bits[word];
+                    while(bits != 0) {
+                        const auto bit = static_cast<uint32_t>(std::countr_zero(bits));
+                        func(high | static_cast<uint32_t>(word * 64 + bit));
+                        bits &= bits - 1;
+                    }
+                }
+            }
+            else {
+                for(const uint16_t low : container.array) {
+                    func(high | low);
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] std::vector<uint32_t> values() const
+    {
+        std::vector<uint32_t> result;
+        result.reserve(size());
+        forEach([&result](uint32_t value) { result.push_back(value); });
+        return result;
+    }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other)
+    {
+        std::vector<Container> result;
+
+        auto lhs = m_containers.begin();
+        auto rhs = other.m_containers.cbegin();
+
+        while(lhs != m_containers.end() && rhs != other.m_containers.cend()) {
+            if(lhs->key < rhs->key) {
+                ++lhs;
+            }
+            else if(rhs->key < lhs->key) {
+                ++rhs;
+            }
+            else {
+                Container container = intersect(*lhs, *rhs);
+                if(container.count > 0) {
+                    result.push_back(std::move(container));
+                }
+                ++lhs;
+                ++rhs;
+            }
+        }
+
+        m_containers = std::move(result);
+        return *this;
+    }
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other)
+    {
+        std::vector<Container> result;
+        result.reserve(std::max(m_containers.size(), other.m_containers.size()));
+
+        auto lhs = m_containers.begin();
+        auto rhs = other.m_containers.cbegin();
+
+        while(lhs != m_containers.end() || rhs != other.m_containers.cend()) {
+            if(rhs == other.m_containers.cend() || (lhs != m_containers.end() && lhs->key < rhs->key)) {
+                result.push_back(std::move(*lhs++));
+            }
+            else if(lhs == m_containers.end() || rhs->key < lhs->key) {
+                result.push_back(*rhs++);
+            }
+            else {
+                result.push_back(unite(*lhs++, *rhs++));
+            }
+        }
+
+        m_containers = std::move(result);
+        return *this;
+    }
+
+    friend RoaringBitmap operator&(RoaringBitmap lhs, const RoaringBitmap& rhs)
+    {
+        lhs &= rhs;
+        return lhs;
+    }
+
+    friend RoaringBitmap operator|(RoaringBitmap lhs, const RoaringBitmap& rhs)
+    {
+        lhs |= rhs;
+        return lhs;
+    }
+
+    friend bool operator==(const RoaringBitmap& lhs, const RoaringBitmap& rhs)
+    {
+        return lhs.m_containers == rhs.m_containers;
+    }
+
+private:
+    // Chunks with more values than this are held as bitmaps, which are then no larger than the array
+    static constexpr uint32_t ArrayLimit = 4096;
+    static constexpr size_t BitmapWords  = 65536 / 64;
+
+    struct Container
+    {
+        explicit Container(uint16_t key_)
+            : key{key_}
+        { }
+
+        uint16_t key{0};
+        uint32_t count{0};
+        // Sorted lower bits of each value, only used while this isn't a bitmap
+        std::vector<uint16_t> array;
+        std::vector<uint64_t> bits;
+
+        [[nodiscard]] bool isBitmap() const
+        {
+            return !bits.empty();
+        }
+
+        [[nodiscard]] bool contains(uint16_t low) const
+        {
+            if(isBitmap()) {
+                return (bits[low / 64] >> (low % 64)) & 1U;
+            }
+            return std::ranges::binary_search(array, low);
+        }
+
+        bool add(uint16_t low)
+        {
+            if(isBitmap()) {
+                uint64_t& word     = bits[low / 64];
+                const uint64_t bit = uint64_t{1} << (low % 64);
+                if(word & bit) {
+                    return false;
+                }
+                word |= bit;
+                ++count;
+                return true;
+            }
+
+            const auto position = std::ranges::lower_bound(array, low);
+            if(position != array.end() && *position == low) {
+                return false;
+            }
+            array.insert(position, low);
+            ++count;
+
+            if(count > ArrayLimit) {
+                toBitmap();
+            }
+            return true;
+        }
+
+        bool remove(uint16_t low)
+        {
+            if(isBitmap()) {
+                uint64_t& word     = bits[low / 64];
+                const uint64_t bit = uint64_t{1} << (low % 64);
+                if(!(word & bit)) {
+                    return false;
+                }
+                word &= ~bit;
+                --count;
+
+                if(count <= ArrayLimit) {
+                    toArray();
+                }
+                return true;
+            }
+
+            const auto position = std::ranges::lower_bound(array, low);
+            if(position == array.end() || *position != low) {
+                return false;
+            }
+            array.erase(position);
+            --count;
+            return true;
+        }
+
+        void toBitmap()
+        {
+            bits.assign(BitmapWords, 0);
+            for(const uint16_t low : array) {
+                bits[low / 64] |= uint64_t{1} << (low % 64);
+            }
+            array = {};
+        }
+
+        void toArray()
+        {
+            std::vector<uint16_t> values;
+            values.reserve(count);
+            for(size_t word{0}; word < BitmapWords; ++word) {
+                uint64_t wordBits = bits[word];
+                while(wordBits != 0) {
+                    values.push_back(static_cast<uint16_t>(word * 64 + std::countr_zero(wordBits)));
+                    wordBits &= wordBits - 1;
+                }
+            }
+            array = std::move(values);
+            bits  = {};
+        }
+
+        // Recounts a bitmap after combining words, converting back to an array if it became sparse
+        void updateCount()
+        {
+            count = 0;
+            for(const uint64_t word : bits) {
+                count += static_cast<uint32_t>(std::popcount(word));
+            }
+            if(count <= ArrayLimit) {
+                toArray();
+            }
+        }
+
+        friend bool operator==(const Container& lhs, const Container& rhs)
+        {
+            return lhs.key == rhs.key && lhs.count == rhs.count && lhs.array == rhs.array && lhs.bits == rhs.bits;
+        }
+    };
+
+    [[nodiscard]] std::vector<Container>::iterator findContainer(uint16_t key)
+    {
+        return std::ranges::lower_bound(m_containers, key, {}, &Container::key);
+    }
+
+    [[nodiscard]] std::vector<Container>::const_iterator findContainer(uint16_t key) const
+    {
+        return std::ranges::lower_bound(m_containers, key, {}, &Container::key);
+    }
+
+    static Container intersect(const Container& lhs, const Container& rhs)
+    {
+        Container result{lhs.key};
+
+        if(lhs.isBitmap() && rhs.isBitmap()) {
+            result.bits.resize(BitmapWords);
+            for(size_t i{0}; i < BitmapWords; ++i) {
+                result.bits[i] = lhs.bits[i] & rhs.bits[i];
+            }
+            result.updateCount();
+        }
+        else if(lhs.isBitmap() || rhs.isBitmap()) {
+            const Container& bitmap = lhs.isBitmap() ? lhs : rhs;
+            const Container& array  = lhs.isBitmap() ? rhs : lhs;
+            std::ranges::copy_if(array.array, std::back_inserter(result.array),
+                                 [&bitmap](uint16_t low) { return bitmap.contains(low); });
+            result.count = static_cast<uint32_t>(result.array.size());
+        }
+        else {
+            std::ranges::set_intersection(lhs.array, rhs.array, std::back_inserter(result.array));
+            result.count = static_cast<uint32_t>(result.array.size());
+        }
+
+        return result;
+    }
+
+    static Container unite(const Container& lhs, const Container& rhs)
+    {
+        Container result{lhs.key};
+
+        if(lhs.isBitmap() && rhs.isBitmap()) {
+            result.bits.resize(BitmapWords);
+            for(size_t i{0}; i < BitmapWords; ++i) {
+                result.bits[i] = lhs.bits[i] | rhs.bits[i];
+            }
+            result.updateCount();
+        }
+        else if(lhs.isBitmap() || rhs.isBitmap()) {
+            result                 = lhs.isBitmap() ? lhs : rhs;
+            const Container& array = lhs.isBitmap() ? rhs : lhs;
+            for(const uint16_t low : array.array) {
+                result.add(low);
+            }
+        }
+        else {
+            result.array.reserve(lhs.array.size() + rhs.array.size());
+            std::ranges::set_union(lhs.array, rhs.array, std::back_inserter(result.array));
+            result.count = static_cast<uint32_t>(result.array.size());
+            if(result.count > ArrayLimit) {
+                result.toBitmap();
+            }
+        }
+
+        return result;
+    }
+
+    // Sorted by key
+    std::vector<Container> m_containers;
+};
+} // namespace Fooyin
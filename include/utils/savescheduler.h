@@ -0,0 +1,70 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <QObject>
+
+#include <functional>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * Coalesces writes of state which changes often, e.g. playlists and settings.
+ *
+ * Each target is saved once, a fixed delay after it was first marked dirty, however often it changes in the
+ * meantime. Nothing is scheduled while no target is dirty, so an idle player never wakes up to write.
+ * @note must only be used from the thread the scheduler lives in.
+ */
+class FYUTILS_EXPORT SaveScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    using SaveFunc = std::function<void()>;
+
+    explicit SaveScheduler(QObject* parent = nullptr);
+    ~SaveScheduler() override;
+
+    /*!
+     * Adds a target saved by calling @p func, at most @p delayMs after it's marked dirty.
+     * @returns an id for marking the target dirty.
+     */
+    int addTarget(int delayMs, SaveFunc func);
+
+    /** Marks @p id as needing to be saved, scheduling it if it isn't already. */
+    void markDirty(int id);
+    [[nodiscard]] bool isDirty(int id) const;
+
+    /** Saves @p id now if it's dirty. */
+    void flush(int id);
+    /** Saves every dirty target now, e.g. on shutdown. */
+    void flushAll();
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
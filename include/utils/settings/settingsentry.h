@@ -23,6 +23,10 @@
 
 #include <QVariant>
 
+#include <atomic>
+#include <bit>
+#include <memory>
+
 namespace Fooyin {
 namespace Settings {
 enum Type : uint32_t
@@ -51,6 +55,35 @@ public:
     [[nodiscard]] QVariant defaultValue() const;
     [[nodiscard]] bool isTemporary() const;
     [[nodiscard]] bool wasChanged() const;
+    // Returns @c true if the value has changed since it was last written to file.
+    [[nodiscard]] bool isUnsaved() const;
+    void markSaved();
+
+    /*!
+     * Reads of the current value, safe to call from any thread while the value is being changed.
+     * The typed reads must match the type of the setting and are lock-free; Variant, String, StringList and
+     * ByteArray settings are read through publishedValue.
+     */
+    [[nodiscard]] bool boolValue() const
+    {
+        return m_scalar.load(std::memory_order_relaxed) != 0;
+    }
+
+    [[nodiscard]] int intValue() const
+    {
+        return static_cast<int>(std::bit_cast<int64_t>(m_scalar.load(std::memory_order_relaxed)));
+    }
+
+    [[nodiscard]] double doubleValue() const
+    {
+        return std::bit_cast<double>(m_scalar.load(std::memory_order_relaxed));
+    }
+
+    [[nodiscard]] QVariant publishedValue() const
+    {
+        const auto value = std::atomic_load_explicit(&m_published, std::memory_order_acquire);
+        return value ? *value : QVariant{};
+    }
 
     bool setValue(const QVariant& value);
     bool setValueSilently(const QVariant& value);
@@ -69,11 +102,22 @@ signals:
     void settingChangedByteArray(const QByteArray& value);
 
 private:
+    void publish();
+
     QString m_key;
     Settings::Type m_type;
     QVariant m_value;
     QVariant m_defaultValue;
     bool m_isTemporary;
     bool m_wasChanged;
+    bool m_unsaved;
+
+    // Bool, Int and Double values, bit cast to 64 bits
+    std::atomic<uint64_t> m_scalar;
+    /*!
+     * An immutable copy of the current value. Replaced copies are freed once the last reader holding one is done.
+     * Only accessed through the atomic shared_ptr functions, as std::atomic<std::shared_ptr> needs libstdc++ 12.
+     */
+    std::shared_ptr<const QVariant> m_published;
 };
 } // namespace Fooyin
@@ -25,6 +25,8 @@
 
 #include <QMetaEnum>
 
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <shared_mutex>
 
@@ -90,6 +92,9 @@ concept ValidValueType = IsVariant<key, Value> || IsBool<key, Value> || IsDouble
  * Q_ENUM (or Q_ENUM_NS) should be used (so the enum name can be found). Values can be associated with a type to support
  * compile-time checking of values, and for subscribers to receive the value cast to the correct type.
  *
+ * Enum key-based settings are also found through a table indexed by the enum value, so value<key> takes no lock
+ * and does no string work, and can be called from any thread.
+ *
  * @see CoreSettings
  * @see Settings::Type
  *
@@ -100,6 +105,7 @@ class FYUTILS_EXPORT SettingsManager : public QObject
 
 public:
     explicit SettingsManager(const QString& settingsPath, QObject* parent = nullptr);
+    ~SettingsManager() override;
 
     void createSettingsDialog(QMainWindow* mainWindow);
 
@@ -110,9 +116,9 @@ public:
      */
     [[nodiscard]] SettingsDialogController* settingsDialog() const;
 
-    // Returns @c true if any settings have been changed since program startup.
+    // Returns @c true if anything has changed since settings were last written to file.
     [[nodiscard]] bool settingsHaveChanged() const;
-    // Writes only changed settings to file, overwriting any existing values.
+    // Writes only settings changed since they were last written, and skips the file entirely if there are none.
     void storeSettings();
     // Writes all settings to file, overwriting any existing values.
     void storeAllSettings();
@@ -214,40 +220,29 @@ public:
     template <auto key>
     auto value() const
     {
-        const auto mapKey = getMapKey(key);
-
-        const std::shared_lock lock(m_lock);
-
-        QVariant settingValue;
-
-        if(m_settings.contains(mapKey)) {
-            if(auto* setting = m_settings.at(mapKey)) {
-                settingValue = setting->value();
-            }
-        }
-
-        const auto type = findType<key>();
+        const SettingsEntry* setting = entry<key>();
+        const auto type              = findType<key>();
 
         if constexpr(type == Settings::Bool) {
-            return settingValue.toBool();
+            return setting && setting->boolValue();
         }
         else if constexpr(type == Settings::Double) {
-            return settingValue.toDouble();
+            return setting ? setting->doubleValue() : 0.0;
         }
         else if constexpr(type == Settings::Int) {
-            return settingValue.toInt();
+            return setting ? setting->intValue() : 0;
         }
         else if constexpr(type == Settings::String) {
-            return settingValue.toString();
+            return setting ? setting->publishedValue().toString() : QString{};
         }
         else if constexpr(type == Settings::StringList) {
-            return settingValue.toStringList();
+            return setting ? setting->publishedValue().toStringList() : QStringList{};
         }
         else if constexpr(type == Settings::ByteArray) {
-            return settingValue.toByteArray();
+            return setting ? setting->publishedValue().toByteArray() : QByteArray{};
         }
         else {
-            return settingValue;
+            return setting ? setting->publishedValue() : QVariant{};
         }
     }
 
@@ -262,22 +257,20 @@ public:
         requires ValidValueType<key, Value>
     bool set(Value value)
     {
-        const QString mapKey = getMapKey(key);
-
-        std::unique_lock lock(m_lock);
-
-        if(!m_settings.contains(mapKey)) {
+        SettingsEntry* setting = entry<key>();
+        if(!setting) {
             return false;
         }
 
-        SettingsEntry* setting = m_settings.at(mapKey);
+        std::unique_lock lock(m_lock);
 
-        const bool success = setting && setting->setValue(value);
+        const bool success = setting->setValue(value);
 
         lock.unlock();
 
         if(success) {
             setting->notifySubscribers();
+            emit settingsModified();
         }
 
         return success;
@@ -292,24 +285,21 @@ public:
     template <auto key>
     bool reset()
     {
-        const auto mapKey = getMapKey(key);
-
-        std::unique_lock lock(m_lock);
-
-        if(!m_settings.contains(mapKey)) {
-            m_lock.unlock();
+        SettingsEntry* setting = entry<key>();
+        if(!setting) {
             return false;
         }
 
-        SettingsEntry* setting = m_settings.at(mapKey);
+        std::unique_lock lock(m_lock);
 
-        const bool success = setting && setting->reset();
+        const bool success = setting->reset();
 
         lock.unlock();
 
         if(success) {
             fileRemove(setting->key());
             setting->notifySubscribers();
+            emit settingsModified();
         }
 
         return success;
@@ -342,44 +332,36 @@ public:
     template <auto key, typename Obj, typename Func>
     void subscribe(const Obj* obj, Func&& func)
     {
-        const auto mapKey = getMapKey(key);
-        const auto type   = findType<key>();
+        SettingsEntry* setting = entry<key>();
+        if(!setting) {
+            return;
+        }
 
-        const std::shared_lock lock(m_lock);
+        const auto type = findType<key>();
 
-        if(m_settings.contains(mapKey)) {
-            if constexpr(type == Settings::Variant) {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedVariant, obj,
-                                 std::forward<Func>(func));
-            }
-            else if constexpr(type == Settings::Bool) {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedBool, obj,
-                                 std::forward<Func>(func));
-            }
-            else if constexpr(type == Settings::Double) {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedDouble, obj,
-                                 std::forward<Func>(func));
-            }
-            else if constexpr(type == Settings::Int) {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedInt, obj,
-                                 std::forward<Func>(func));
-            }
-            else if constexpr(type == Settings::String) {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedString, obj,
-                                 std::forward<Func>(func));
-            }
-            else if constexpr(type == Settings::StringList) {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedStringList, obj,
-                                 std::forward<Func>(func));
-            }
-            else if constexpr(type == Settings::ByteArray) {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedByteArray, obj,
-                                 std::forward<Func>(func));
-            }
-            else {
-                QObject::connect(m_settings.at(mapKey), &SettingsEntry::settingChangedVariant, obj,
-                                 std::forward<Func>(func));
-            }
+        if constexpr(type == Settings::Variant) {
+            QObject::connect(setting, &SettingsEntry::settingChangedVariant, obj, std::forward<Func>(func));
+        }
+        else if constexpr(type == Settings::Bool) {
+            QObject::connect(setting, &SettingsEntry::settingChangedBool, obj, std::forward<Func>(func));
+        }
+        else if constexpr(type == Settings::Double) {
+            QObject::connect(setting, &SettingsEntry::settingChangedDouble, obj, std::forward<Func>(func));
+        }
+        else if constexpr(type == Settings::Int) {
+            QObject::connect(setting, &SettingsEntry::settingChangedInt, obj, std::forward<Func>(func));
+        }
+        else if constexpr(type == Settings::String) {
+            QObject::connect(setting, &SettingsEntry::settingChangedString, obj, std::forward<Func>(func));
+        }
+        else if constexpr(type == Settings::StringList) {
+            QObject::connect(setting, &SettingsEntry::settingChangedStringList, obj, std::forward<Func>(func));
+        }
+        else if constexpr(type == Settings::ByteArray) {
+            QObject::connect(setting, &SettingsEntry::settingChangedByteArray, obj, std::forward<Func>(func));
+        }
+        else {
+            QObject::connect(setting, &SettingsEntry::settingChangedVariant, obj, std::forward<Func>(func));
         }
     }
 
@@ -408,16 +390,55 @@ public:
     template <auto key, typename Obj>
     void unsubscribe(const Obj* obj)
     {
-        const auto mapKey = getMapKey(key);
+        if(SettingsEntry* setting = entry<key>()) {
+            QObject::disconnect(setting, nullptr, obj, nullptr);
+        }
+    }
 
-        const std::shared_lock lock(m_lock);
+signals:
+    // Emitted whenever a setting or file value changes, so a save can be scheduled.
+    void settingsModified();
+
+private:
+    // Limits of the enum value tables
+    static constexpr size_t MaxSettingEnums = 64;
+    static constexpr size_t MaxEnumSettings = 256;
+
+    struct SlotTable
+    {
+        std::array<std::atomic<SettingsEntry*>, MaxEnumSettings> entries;
+    };
+
+    template <auto key>
+    static constexpr size_t slotIndex()
+    {
+        // The bits below the type
+        return static_cast<uint32_t>(key) & 0x0F'FF'FF'FF;
+    }
+
+    template <typename Enum>
+    static size_t tableIndex()
+    {
+        static const size_t index = enumIndex(QMetaEnum::fromType<Enum>().name());
+        return index;
+    }
 
-        if(m_settings.contains(mapKey)) {
-            QObject::disconnect(m_settings.at(mapKey), nullptr, obj, nullptr);
+    template <auto key>
+    SettingsEntry* entry() const
+    {
+        static_assert(slotIndex<key>() < MaxEnumSettings, "Setting enum value exceeds MaxEnumSettings");
+
+        using Enum         = decltype(key);
+        const size_t table = tableIndex<Enum>();
+        if(table >= MaxSettingEnums) {
+            const auto meta = QMetaEnum::fromType<Enum>();
+            return findEntry(QString::fromLatin1(meta.name()) + QString::fromLatin1(meta.valueToKey(key)));
         }
+
+        const SlotTable* slotTable = m_slotTables[table].load(std::memory_order_acquire);
+        return slotTable ? slotTable->entries[slotIndex<key>()].load(std::memory_order_acquire) : nullptr;
     }
 
-private:
     template <auto key, typename Value>
         requires ValidValueType<key, Value>
     void createNewSetting(const Value& value, const QString& settingKey, bool isTemporary)
@@ -436,36 +457,34 @@ private:
             return;
         }
 
-        m_settings.emplace(mapKey, new SettingsEntry(settingKey, value, type, this));
+        auto* setting = m_settings.emplace(mapKey, new SettingsEntry(settingKey, value, type, this)).first->second;
 
-        if(auto* setting = m_settings.at(mapKey)) {
-            if(isTemporary) {
-                setting->setIsTemporary(isTemporary);
-            }
-            else {
-                checkLoadSetting(setting);
-            }
+        if(isTemporary) {
+            setting->setIsTemporary(isTemporary);
+        }
+        else {
+            checkLoadSetting(setting);
         }
-    }
-
-    template <typename Enum>
-    auto constexpr getMapKey(Enum key) const
-    {
-        const auto meta      = QMetaEnum::fromType<Enum>();
-        const auto enumName  = QString::fromLatin1(meta.name());
-        const auto keyString = QString::fromLatin1(meta.valueToKey(key));
-        const auto mapKey    = enumName + keyString;
 
-        return QString::fromUtf8(mapKey.toUtf8());
+        addSlot(tableIndex<Enum>(), slotIndex<key>(), setting);
     }
 
+    // Returns the index of the table for the enum @p enumName, which is the same for every manager
+    static size_t enumIndex(const char* enumName);
+    void addSlot(size_t table, size_t slot, SettingsEntry* setting);
+    // Fallback for enums beyond MaxSettingEnums
+    SettingsEntry* findEntry(const QString& mapKey) const;
+
     bool settingExists(const QString& key) const;
     void checkLoadSetting(SettingsEntry* setting) const;
     void saveSettings(bool onlyChanged);
 
     QSettings* m_settingsFile;
+    // Set by writes made directly to file, which haven't been synced yet
+    std::atomic<bool> m_fileModified;
     std::map<QString, SettingsEntry*> m_settings;
     mutable std::shared_mutex m_lock;
+    std::array<std::atomic<SlotTable*>, MaxSettingEnums> m_slotTables;
 
     SettingsDialogController* m_settingsDialog;
 };
@@ -0,0 +1,263 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A lock-free, wait-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * The capacity is always rounded up to the next power of two. Read and write positions are
+ * monotonically increasing counters, so the full capacity is usable and no slot is wasted.
+ *
+ * @note resize and clear are not thread-safe and must only be called while neither side is
+ * accessing the buffer.
+ */
+template <typename T>
+class SpscRingBuffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRingBuffer only supports trivially copyable types");
+
+public:
+    /*!
+     * A view of data available for reading (or space available for writing).
+     * The region may wrap around the end of the buffer, in which case @c second is non-empty.
+     */
+    template <typename U>
+    struct Regions
+    {
+        std::span<U> first;
+        std::span<U> second;
+
+        [[nodiscard]] size_t size() const
+        {
+            return first.size() + second.size();
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return first.empty() && second.empty();
+        }
+    };
+    using ReadRegions  = Regions<const T>;
+    using WriteRegions = Regions<T>;
+
+    SpscRingBuffer() = default;
+
+    explicit SpscRingBuffer(size_t capacity)
+    {
+        resize(capacity);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&)            = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /** Reallocates the buffer to hold at least @p capacity items, discarding any contents. */
+    void resize(size_t capacity)
+    {
+        capacity = capacity > 0 ? std::bit_ceil(capacity) : 0;
+
+        m_buffer.assign(capacity, T{});
+        m_mask = capacity > 0 ? capacity - 1 : 0;
+        m_readPos.store(0, std::memory_order_relaxed);
+        m_writePos.store(0, std::memory_order_relaxed);
+    }
+
+    /** Discards all contents without reallocating. */
+    void clear()
+    {
+        m_readPos.store(0, std::memory_order_relaxed);
+        m_writePos.store(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return m_buffer.size();
+    }
+
+    /** Returns the number of items available to the consumer. */
+    [[nodiscard]] size_t readAvailable() const
+    {
+        const size_t write = m_writePos.load(std::memory_order_acquire);
+        const size_t read  = m_readPos.load(std::memory_order_relaxed);
+        return write - read;
+    }
+
+    /** Returns the amount of free space available to the producer. */
+    [[nodiscard]] size_t writeAvailable() const
+    {
+        const size_t read  = m_readPos.load(std::memory_order_acquire);
+        const size_t write = m_writePos.load(std::memory_order_relaxed);
+        return capacity() - (write - read);
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return readAvailable() == 0;
+    }
+
+    /** Total number of items ever written. Used to express positions within the stream. */
+    [[nodiscard]] size_t totalWritten() const
+    {
+        return m_writePos.load(std::memory_order_acquire);
+    }
+
+    /** Total number of items ever read. Used to express positions within the stream. */
+    [[nodiscard]] size_t totalRead() const
+    {
+        return m_readPos.load(std::memory_order_acquire);
+    }
+
+    /*!
+     * Copies up to @p count items from @p data into the buffer.
+     * @note producer only.
+     * @returns the number of items written.
+     */
+    size_t write(const T* data, size_t count)
+    {
+        const auto regions = writeRegions(count);
+        if(regions.empty()) {
+            return 0;
+        }
+
+        std::memcpy(regions.first.data(), data, regions.first.size_bytes());
+        if(!regions.second.empty()) {
+            std::memcpy(regions.second.data(), data + regions.first.size(), regions.second.size_bytes());
+        }
+
+        commitWrite(regions.size());
+        return regions.size();
+    }
+
+    size_t write(std::span<const T> data)
+    {
+        return write(data.data(), data.size());
+    }
+
+    /*!
+     * Copies up to @p count items from the buffer into @p data.
+     * @note consumer only.
+     * @returns the number of items read.
+     */
+    size_t read(T* data, size_t count)
+    {
+        const auto regions = readRegions(count);
+        if(regions.empty()) {
+            return 0;
+        }
+
+        std::memcpy(data, regions.first.data(), regions.first.size_bytes());
+        if(!regions.second.empty()) {
+            std::memcpy(data + regions.first.size(), regions.second.data(), regions.second.size_bytes());
+        }
+
+        commitRead(regions.size());
+        return regions.size();
+    }
+
+    size_t read(std::span<T> data)
+    {
+        return read(data.data(), data.size());
+    }
+
+    /*!
+     * Returns up to @p count items of contiguous space which the producer can write into directly.
+     * Call @fn commitWrite once the data has been written.
+     * @note producer only.
+     */
+    WriteRegions writeRegions(size_t count = SIZE_MAX)
+    {
+        const size_t write = m_writePos.load(std::memory_order_relaxed);
+        const size_t read  = m_readPos.load(std::memory_order_acquire);
+
+        count = std::min(count, capacity() - (write - read));
+        return regionsAt<T>(m_buffer.data(), write, count);
+    }
+
+    /*!
+     * Returns up to @p count items of contiguous data which the consumer can read directly.
+     * Call @fn commitRead once the data has been consumed.
+     * @note consumer only.
+     */
+    ReadRegions readRegions(size_t count = SIZE_MAX) const
+    {
+        const size_t read  = m_readPos.load(std::memory_order_relaxed);
+        const size_t write = m_writePos.load(std::memory_order_acquire);
+
+        count = std::min(count, write - read);
+        return regionsAt<const T>(m_buffer.data(), read, count);
+    }
+
+    /** Publishes @p count items previously written through @fn writeRegions. */
+    void commitWrite(size_t count)
+    {
+        m_writePos.store(m_writePos.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    /** Releases @p count items previously read through @fn readRegions. */
+    void commitRead(size_t count)
+    {
+        m_readPos.store(m_readPos.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    /*!
+     * Drops up to @p count items from the consumer side.
+     * @note consumer only.
+     * @returns the number of items skipped.
+     */
+    size_t skip(size_t count)
+    {
+        count = std::min(count, readAvailable());
+        commitRead(count);
+        return count;
+    }
+
+private:
+    template <typename U, typename Ptr>
+    Regions<U> regionsAt(Ptr* base, size_t pos, size_t count) const
+    {
+        if(count == 0) {
+            return {};
+        }
+
+        const size_t start      = pos & m_mask;
+        const size_t firstCount = std::min(count, capacity() - start);
+
+        return {{base + start, firstCount}, {base, count - firstCount}};
+    }
+
+    // Keep the producer and consumer positions on separate cache lines
+    static constexpr size_t CacheLineSize = 64;
+
+    std::vector<T> m_buffer;
+    size_t m_mask{0};
+
+    alignas(CacheLineSize) std::atomic<size_t> m_readPos{0};
+    alignas(CacheLineSize) std::atomic<size_t> m_writePos{0};
+};
+} // namespace Fooyin
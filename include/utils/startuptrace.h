@@ -0,0 +1,75 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <QString>
+
+#include <cstdint>
+
+/*!
+ * Records a timeline of application startup which can be opened in chrome://tracing or Perfetto.
+ *
+ * Tracing is off unless enabled (e.g. with --trace-startup), in which case every call below is a
+ * single relaxed atomic load. Event names must have static storage duration, i.e. be string literals.
+ * @note thread-safe.
+ */
+namespace Fooyin::StartupTrace {
+/** Starts recording, writing the trace to @p path once finish is called. */
+FYUTILS_EXPORT void enable(const QString& path);
+[[nodiscard]] FYUTILS_EXPORT bool isEnabled();
+
+/** Marks a single point in time on the calling thread. */
+FYUTILS_EXPORT void instant(const char* name);
+
+/*!
+ * Begins a phase which ends in a continuation, possibly on another thread, e.g. a query which
+ * completes in a signal. Pass the returned id to endAsync.
+ * @returns 0 if tracing is disabled.
+ */
+[[nodiscard]] FYUTILS_EXPORT uint64_t beginAsync(const char* name);
+/** Ends the async phase @p id. Ids of 0, or of phases already ended, are ignored. */
+FYUTILS_EXPORT void endAsync(uint64_t id);
+
+/*!
+ * Stops recording, writes the trace and logs a summary of each phase.
+ * Async phases still running are closed at the time of the call.
+ * @returns false if tracing wasn't enabled or the trace couldn't be written.
+ */
+FYUTILS_EXPORT bool finish();
+
+/** Records the lifetime of the scope it's declared in, or until end is called, as a phase. */
+class FYUTILS_EXPORT Scope
+{
+public:
+    explicit Scope(const char* name);
+    ~Scope();
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    void end();
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+} // namespace Fooyin::StartupTrace
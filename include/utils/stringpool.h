@@ -0,0 +1,45 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <QStringList>
+
+namespace Fooyin::StringPool {
+/*!
+ * Returns a copy of @p str which shares its storage with every other interned string of the same value.
+ * Metadata such as artists, albums and genres repeats across many tracks; interning it means each
+ * value is only held in memory once, and comparisons between interned strings succeed on the pointer.
+ *
+ * Strings are dropped from the pool once nothing else refers to them.
+ * @note thread-safe.
+ */
+FYUTILS_EXPORT QString intern(const QString& str);
+/** Interns each string of @p strings. */
+FYUTILS_EXPORT QStringList intern(const QStringList& strings);
+
+/** Returns the number of distinct strings currently held. */
+FYUTILS_EXPORT qsizetype size();
+/** Returns the number of bytes held by the pool and its strings. */
+FYUTILS_EXPORT size_t memoryUsage();
+/** Drops every string nothing else refers to any more, rather than waiting for the pool to grow. */
+FYUTILS_EXPORT void prune();
+} // namespace Fooyin::StringPool
@@ -0,0 +1,41 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <optional>
+
+/*!
+ * Reports how busy the system is and how it's powered, e.g. to decide whether background work should wait.
+ * Information the system doesn't provide is reported as std::nullopt.
+ */
+namespace Fooyin::SystemLoad {
+/** Returns the 1 minute load average divided by the number of cores, so 1.0 means every core is kept busy. */
+[[nodiscard]] FYUTILS_EXPORT std::optional<double> loadPerCore();
+/*!
+ * Returns the share of the last 10 seconds in which some thread was stalled waiting on I/O, as a
+ * percentage, from the kernel's pressure stall information.
+ */
+[[nodiscard]] FYUTILS_EXPORT std::optional<double> ioPressure();
+/** Returns @c true if the system is running from a battery, rather than mains power. */
+[[nodiscard]] FYUTILS_EXPORT bool onBattery();
+} // namespace Fooyin::SystemLoad
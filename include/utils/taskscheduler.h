@@ -0,0 +1,143 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Fooyin {
+/*!
+ * A shared pool of threads running short tasks in priority lanes.
+ *
+ * Each thread keeps its own queue, which tasks submitted from that thread are added to, and idle threads
+ * steal from the others before sleeping. Tasks submitted from other threads go to a shared queue.
+ * Lanes are always tried in order, and background and I/O work is limited to fewer threads than the pool
+ * has, so the interactive lane always has a thread free.
+ *
+ * Idle work can also be throttled, e.g. on battery or while the system is busy. Work on its own threads
+ * which should be throttled along with it goes through an IdleGate.
+ *
+ * Tasks should not block for long; anything waiting on a dependency is better split into several tasks.
+ * @note tasks still queued when the scheduler is destroyed are dropped.
+ */
+class FYUTILS_EXPORT TaskScheduler
+{
+public:
+    enum class Lane : uint8_t
+    {
+        // Populating views the user is waiting on
+        Interactive = 0,
+        // Analysis and other work which can wait
+        Background,
+        // Work mostly spent waiting on disk or the database
+        IO,
+        // Work which can wait for the system to be quiet, e.g. analysis nobody is waiting on
+        Idle,
+    };
+
+    enum class Throttle : uint8_t
+    {
+        // Idle work runs as freely as background work
+        None = 0,
+        // Idle work is limited to a single thread
+        Reduced,
+        // Idle work is held until throttling is lifted
+        Paused,
+    };
+
+    using Task = std::function<void()>;
+
+    /*!
+     * Creates a scheduler with @p threadCount threads.
+     * @param threadCount the number of threads, or 0 to use one per core.
+     */
+    explicit TaskScheduler(int threadCount = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler& other)            = delete;
+    TaskScheduler& operator=(const TaskScheduler& other) = delete;
+
+    /** Returns the scheduler shared by the application, created on first use. */
+    static TaskScheduler* instance();
+
+    [[nodiscard]] int threadCount() const;
+    /** Returns the number of @p lane tasks which may run at the same time, ignoring any throttling. */
+    [[nodiscard]] int laneLimit(Lane lane) const;
+
+    [[nodiscard]] Throttle throttle() const;
+    void setThrottle(Throttle throttle);
+    /** Returns the number of steps of idle work which may run at once under the current throttle, or -1 if any. */
+    [[nodiscard]] int idleLimit() const;
+
+    void submit(Lane lane, Task task);
+
+    /*!
+     * Lifts throttling for as long as it exists, e.g. while waiting on idle tasks to finish, so nothing
+     * waits on work which is being held back. Guards may nest.
+     */
+    class FYUTILS_EXPORT Unthrottle
+    {
+    public:
+        explicit Unthrottle(TaskScheduler* scheduler);
+        ~Unthrottle();
+
+        Unthrottle(const Unthrottle& other)            = delete;
+        Unthrottle& operator=(const Unthrottle& other) = delete;
+
+    private:
+        TaskScheduler* m_scheduler;
+    };
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+
+/*!
+ * Throttles idle work running on its own threads, e.g. the readers of a library scan, along with the
+ * scheduler's idle lane. Each step of the work runs between @fn acquire and @fn release.
+ */
+class FYUTILS_EXPORT IdleGate
+{
+public:
+    explicit IdleGate(TaskScheduler* scheduler = TaskScheduler::instance());
+
+    IdleGate(const IdleGate& other)            = delete;
+    IdleGate& operator=(const IdleGate& other) = delete;
+
+    /*!
+     * Blocks until the throttle leaves room for another step, or @p cancelled returns @c true.
+     * @returns @c false if cancelled, in which case @fn release must not be called.
+     */
+    bool acquire(const std::function<bool()>& cancelled);
+    void release();
+
+private:
+    TaskScheduler* m_scheduler;
+    std::mutex m_mutex;
+    std::condition_variable m_released;
+    int m_running;
+};
+} // namespace Fooyin
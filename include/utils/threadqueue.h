@@ -22,6 +22,7 @@
 #include <condition_variable>
 #include <deque>
 #include <mutex>
+#include <utility>
 
 namespace Fooyin {
 template <typename QueueItem>
@@ -59,7 +60,8 @@ template <typename QueueItem>
 ThreadQueue<QueueItem>::ThreadQueue(ThreadQueue&& other) noexcept
 {
     std::lock_guard lock(other.m_mtx);
-    m_queue = std::move(other.m_queue);
+    m_queue    = std::move(other.m_queue);
+    m_blocking = other.m_blocking;
 }
 
 template <typename QueueItem>
@@ -68,7 +70,8 @@ ThreadQueue<QueueItem>& ThreadQueue<QueueItem>::ThreadQueue::operator=(ThreadQue
     std::lock_guard lock(m_mtx);
     std::lock_guard otherLock(other.m_mtx);
 
-    m_queue = other.m_queue;
+    m_queue    = other.m_queue;
+    m_blocking = other.m_blocking;
 
     return *this;
 }
@@ -86,7 +89,8 @@ ThreadQueue<QueueItem>& ThreadQueue<QueueItem>::ThreadQueue::operator=(ThreadQue
     std::lock_guard lock(m_mtx);
     std::lock_guard otherLock(other.m_mtx);
 
-    m_queue = std::move(other.m_queue);
+    m_queue    = std::move(other.m_queue);
+    m_blocking = other.m_blocking;
 
     return *this;
 }
@@ -141,7 +145,7 @@ QueueItem ThreadQueue<QueueItem>::ThreadQueue::dequeue()
         }
     }
 
-    QueueItem item = m_queue.front();
+    QueueItem item = std::move(m_queue.front());
     m_queue.pop_front();
     return item;
 }
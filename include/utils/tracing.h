@@ -0,0 +1,76 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fyutils_export.h"
+
+#include <QString>
+
+#include <cstdint>
+
+/*!
+ * Records spans on every thread into one timeline, which can be opened in Perfetto or chrome://tracing.
+ *
+ * Spans are only compiled in when building with BUILD_TRACING, and are only recorded once start has been
+ * called (e.g. with --trace). Each thread writes into its own fixed-size ring buffer without locking, so
+ * only the most recent spans of each thread are kept, and a dump can be taken at any time while running.
+ *
+ * Span names must have static storage duration, i.e. be string literals.
+ * @note thread-safe.
+ */
+namespace Fooyin::Tracing {
+/** Returns @c true if spans were compiled in. */
+[[nodiscard]] FYUTILS_EXPORT bool isAvailable();
+
+/** Starts recording spans, discarding any recorded before. */
+FYUTILS_EXPORT void start();
+FYUTILS_EXPORT void stop();
+[[nodiscard]] FYUTILS_EXPORT bool isRecording();
+
+/*!
+ * Writes the spans currently held by every thread to @p path, without stopping recording.
+ * @returns false if nothing was recorded or the file couldn't be written.
+ */
+FYUTILS_EXPORT bool dump(const QString& path);
+
+/** Records the lifetime of the scope it's declared in. Use FY_TRACE_SCOPE rather than this directly. */
+class FYUTILS_EXPORT Span
+{
+public:
+    explicit Span(const char* name);
+    ~Span();
+
+    Span(const Span&)            = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+} // namespace Fooyin::Tracing
+
+#define FY_TRACE_CONCAT_IMPL(a, b) a##b
+#define FY_TRACE_CONCAT(a, b) FY_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(FOOYIN_TRACING)
+#define FY_TRACE_SCOPE(name) const Fooyin::Tracing::Span FY_TRACE_CONCAT(fyTraceSpan, __LINE__){name}
+#else
+#define FY_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
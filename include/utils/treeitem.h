@@ -52,20 +52,41 @@ public:
     {
         m_children.emplace_back(child);
         child->m_parent = static_cast<Item*>(this);
+        child->m_row    = childCount() - 1;
     }
 
     virtual void insertChild(int row, Item* child)
     {
         m_children.insert(m_children.begin() + row, child);
         child->m_parent = static_cast<Item*>(this);
+        renumberChildren(row);
+    }
+
+    /** Inserts @p children at @p row, renumbering the rows after them once. */
+    virtual void insertChildren(int row, const std::vector<Item*>& children)
+    {
+        m_children.insert(m_children.begin() + row, children.cbegin(), children.cend());
+        for(Item* child : children) {
+            child->m_parent = static_cast<Item*>(this);
+        }
+        renumberChildren(row);
     }
 
     virtual void removeChild(int index)
     {
-        if(index < 0 && index >= childCount()) {
+        removeChildren(index, 1);
+    }
+
+    /** Removes @p count children starting at @p index, renumbering the rows after them once. */
+    virtual void removeChildren(int index, int count)
+    {
+        if(index < 0 || count <= 0 || index + count > childCount()) {
             return;
         }
-        m_children.erase(m_children.cbegin() + index);
+
+        // Removed children may already have been deleted by their owner, so they aren't touched
+        m_children.erase(m_children.cbegin() + index, m_children.cbegin() + index + count);
+        renumberChildren(index);
     }
 
     virtual void clearChildren()
@@ -86,10 +107,14 @@ public:
         return static_cast<int>(m_children.size());
     }
 
+    /*!
+     * Rows are kept up to date as children are added and removed, so this is O(1).
+     * After resetRow, e.g. when children were reordered directly, the first call renumbers every sibling.
+     */
     [[nodiscard]] virtual int row() const
     {
         if(m_row < 0 && m_parent) {
-            m_row = Utils::findIndex(m_parent->m_children, this);
+            m_parent->renumberChildren(0);
         }
         return m_row;
     }
@@ -104,19 +129,30 @@ public:
         m_row = -1;
     }
 
+    /** Renumbers the rows of every descendant, e.g. after children were reordered directly. */
     virtual void resetChildren()
     {
         for(Item* child : m_children) {
             if(child) {
                 child->resetChildren();
-                child->resetRow();
             }
         }
+        renumberChildren(0);
     }
 
 private:
     friend Item;
 
+    void renumberChildren(int first) const
+    {
+        const int count = childCount();
+        for(int i{first}; i < count; ++i) {
+            if(Item* child = m_children.at(i)) {
+                child->m_row = i;
+            }
+        }
+    }
+
     Item* m_parent{nullptr};       // Not owned
     std::vector<Item*> m_children; // Not owned
     mutable int m_row{-1};
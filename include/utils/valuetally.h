@@ -0,0 +1,143 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <limits>
+#include <map>
+
+namespace Fooyin {
+/*!
+ * Counts occurrences of distinct strings, e.g. the values of one field across a selection of tracks.
+ *
+ * Only the first @c limit distinct values are kept. Once another is seen the tally has overflowed: new values
+ * are no longer looked at, which ends the work early for fields shown as "multiple values", but removing
+ * values can no longer be applied exactly, so the tally has to be rebuilt instead.
+ */
+class ValueTally
+{
+public:
+    static constexpr size_t Unlimited = std::numeric_limits<size_t>::max();
+
+    explicit ValueTally(size_t limit = Unlimited)
+        : m_limit{limit}
+    { }
+
+    /** Counts @p value, ignoring empty strings. */
+    void add(const QString& value)
+    {
+        if(value.isEmpty() || m_overflowed) {
+            return;
+        }
+
+        if(const auto it = m_counts.find(value); it != m_counts.end()) {
+            ++it->second;
+            return;
+        }
+
+        if(m_counts.size() >= m_limit) {
+            m_overflowed = true;
+            return;
+        }
+
+        m_counts.emplace(value, 1);
+    }
+
+    void add(const QStringList& values)
+    {
+        for(const QString& value : values) {
+            add(value);
+        }
+    }
+
+    /*!
+     * Removes one occurrence of @p value.
+     * @returns false if the tally has overflowed, in which case it's left as it was.
+     */
+    bool remove(const QString& value)
+    {
+        if(m_overflowed) {
+            return false;
+        }
+
+        if(const auto it = m_counts.find(value); it != m_counts.end() && --it->second == 0) {
+            m_counts.erase(it);
+        }
+        return true;
+    }
+
+    bool remove(const QStringList& values)
+    {
+        if(m_overflowed) {
+            return false;
+        }
+
+        for(const QString& value : values) {
+            remove(value);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool overflowed() const
+    {
+        return m_overflowed;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return m_counts.empty();
+    }
+
+    /** Returns the number of distinct values kept. */
+    [[nodiscard]] size_t size() const
+    {
+        return m_counts.size();
+    }
+
+    [[nodiscard]] int count(const QString& value) const
+    {
+        const auto it = m_counts.find(value);
+        return it != m_counts.end() ? it->second : 0;
+    }
+
+    /** Returns the values kept and their counts, ordered by value. */
+    [[nodiscard]] const std::map<QString, int>& counts() const
+    {
+        return m_counts;
+    }
+
+    [[nodiscard]] QStringList values() const
+    {
+        QStringList values;
+        values.reserve(static_cast<qsizetype>(m_counts.size()));
+        for(const auto& [value, _] : m_counts) {
+            values.append(value);
+        }
+        return values;
+    }
+
+private:
+    size_t m_limit;
+    std::map<QString, int> m_counts;
+    bool m_overflowed{false};
+};
+} // namespace Fooyin
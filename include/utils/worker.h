@@ -21,8 +21,15 @@
 
 #include "fyutils_export.h"
 
+#include <utils/taskscheduler.h>
+
 #include <QObject>
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
 namespace Fooyin {
 class FYUTILS_EXPORT Worker : public QObject
 {
@@ -37,23 +44,64 @@ public:
     };
 
     explicit Worker(QObject* parent = nullptr);
+    ~Worker() override;
 
     virtual void initialiseThread();
     virtual void stopThread();
     virtual void pauseThread();
+    /** Stops the current task and drops any still queued by @fn schedule. */
     virtual void closeThread();
 
+    /*!
+     * Runs @p task on the shared TaskScheduler, in this worker's lane.
+     * Tasks of one worker run one at a time and in order, but not necessarily on the same thread,
+     * so they must not rely on thread-local state such as database connections between tasks.
+     */
+    void schedule(std::function<void()> task);
+    /*!
+     * Starts a new job with @p task, superseding everything scheduled before it.
+     * Queued tasks are dropped, the running one is cancelled (@fn mayRun returns @c false) and
+     * results already emitted by them become stale (@fn isCurrent returns @c false for their generation).
+     * Later calls to @fn schedule add to this job.
+     */
+    void startJob(std::function<void()> task);
+    /*!
+     * Blocks until no task scheduled by this worker is queued or running.
+     * Owners should call this, after @fn closeThread, before destroying anything the tasks use.
+     */
+    void waitForTasks();
+
+    [[nodiscard]] TaskScheduler::Lane lane() const;
+    void setLane(TaskScheduler::Lane lane);
+
     [[nodiscard]] State state() const;
     void setState(State state);
 
+    /** Returns @c false if the worker is stopped, closing, or the running task has been superseded. */
     [[nodiscard]] bool mayRun() const;
     [[nodiscard]] bool closing() const;
 
+    /*!
+     * Returns the generation of the job the running task belongs to.
+     * Results emitted by a task should carry this, so receivers can discard them once superseded.
+     */
+    [[nodiscard]] uint64_t jobGeneration() const;
+    /** Returns @c true if no job has been started since the one of @p generation. */
+    [[nodiscard]] bool isCurrent(uint64_t generation) const;
+
 signals:
     void finished();
 
 private:
+    void runNextTask();
+
     std::atomic<State> m_state;
     std::atomic<bool> m_closing;
+    // The latest job, and the job of the running task
+    std::atomic<uint64_t> m_generation;
+    std::atomic<uint64_t> m_jobGeneration;
+
+    struct TaskQueue;
+    std::unique_ptr<TaskQueue> m_tasks;
 };
 } // namespace Fooyin
@@ -23,15 +23,37 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QDir>
 #include <QObject>
 
 #include <getopt.h>
 #include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+// Values of options without a short form
+enum LongOption : int
+{
+    Headless = 256,
+    Play,
+    Pause,
+    PlayPause,
+    Stop,
+    Next,
+    Previous,
+    Trace,
+    DumpTrace,
+};
+} // namespace
 
 CommandLine::CommandLine(int argc, char** argv)
     : m_argc{argc}
     , m_argv{argv}
     , m_skipSingle{false}
+    , m_command{Command::None}
+    , m_headless{false}
+    , m_dumpTrace{false}
 { }
 
 bool CommandLine::parse()
@@ -39,16 +61,36 @@ bool CommandLine::parse()
     static constexpr option cmdOptions[] = {{"help", no_argument, nullptr, 'h'},
                                             {"version", no_argument, nullptr, 'v'},
                                             {"skip", no_argument, nullptr, 's'},
+                                            {"trace-startup", optional_argument, nullptr, 't'},
+                                            {"headless", no_argument, nullptr, Headless},
+                                            {"play", no_argument, nullptr, Play},
+                                            {"pause", no_argument, nullptr, Pause},
+                                            {"play-pause", no_argument, nullptr, PlayPause},
+                                            {"stop", no_argument, nullptr, Stop},
+                                            {"next", no_argument, nullptr, Next},
+                                            {"previous", no_argument, nullptr, Previous},
+                                            {"trace", optional_argument, nullptr, Trace},
+                                            {"dump-trace", no_argument, nullptr, DumpTrace},
                                             {nullptr, 0, nullptr, 0}};
 
     static const auto help = QStringLiteral("%1: fooyin [%2] [%3]\n"
                                             "\n"
                                             "%4:\n"
-                                            "  -h, --help      %5\n"
-                                            "  -v, --version   %6\n"
+                                            "  -h, --help                 %5\n"
+                                            "  -v, --version              %6\n"
+                                            "  --trace-startup[=<file>]   %7\n"
+                                            "  --headless                 %8\n"
+                                            "  --play                     %9\n"
+                                            "  --pause                    %10\n"
+                                            "  --play-pause               %11\n"
+                                            "  --stop                     %12\n"
+                                            "  --next                     %13\n"
+                                            "  --previous                 %14\n"
+                                            "  --trace[=<file>]           %15\n"
+                                            "  --dump-trace               %16\n"
                                             "\n"
-                                            "%7:\n"
-                                            "  urls            %8\n");
+                                            "%17:\n"
+                                            "  urls                       %18\n");
 
     for(;;) {
         const int c = getopt_long(m_argc, m_argv, "hvs", cmdOptions, nullptr);
@@ -58,10 +100,21 @@ bool CommandLine::parse()
 
         switch(c) {
             case('h'): {
-                const auto helpText = QString{help}.arg(
-                    QObject::tr("Usage"), QObject::tr("options"), QObject::tr("urls"), QObject::tr("Options"),
-                    QObject::tr("Displays help on command line options"), QObject::tr("Displays version information"),
-                    QObject::tr("Arguments"), QObject::tr("Files to open"));
+                const auto helpText
+                    = QString{help}
+                          .arg(QObject::tr("Usage"), QObject::tr("options"), QObject::tr("urls"),
+                               QObject::tr("Options"), QObject::tr("Displays help on command line options"),
+                               QObject::tr("Displays version information"),
+                               QObject::tr("Writes a timeline of startup to file, for chrome://tracing or Perfetto"),
+                               QObject::tr("Runs without a window, controlled through MPRIS or the command line"),
+                               QObject::tr("Starts playback"))
+                          .arg(QObject::tr("Pauses playback"), QObject::tr("Toggles between playing and paused"),
+                               QObject::tr("Stops playback"), QObject::tr("Plays the next track"),
+                               QObject::tr("Plays the previous track"),
+                               QObject::tr("Records spans on every thread, written to file on exit"),
+                               QObject::tr("Writes the spans recorded by the running instance so far"),
+                               QObject::tr("Arguments"),
+                               QObject::tr("Files to open, or - to read them from standard input"));
                 std::cout << helpText.toLocal8Bit().constData() << '\n';
                 return false;
             }
@@ -74,16 +127,62 @@ bool CommandLine::parse()
             case('s'):
                 m_skipSingle = true;
                 break;
+            case('t'):
+                m_tracePath = optarg ? QFile::decodeName(optarg)
+                                     : QDir::temp().filePath(QStringLiteral("fooyin-startup.json"));
+                break;
+            case(Headless):
+                m_headless = true;
+                break;
+            case(Play):
+                m_command = Command::Play;
+                break;
+            case(Pause):
+                m_command = Command::Pause;
+                break;
+            case(PlayPause):
+                m_command = Command::PlayPause;
+                break;
+            case(Stop):
+                m_command = Command::Stop;
+                break;
+            case(Next):
+                m_command = Command::Next;
+                break;
+            case(Previous):
+                m_command = Command::Previous;
+                break;
+            case(Trace):
+                m_spanTracePath = optarg ? QFile::decodeName(optarg)
+                                         : QDir::temp().filePath(QStringLiteral("fooyin-trace.json"));
+                break;
+            case(DumpTrace):
+                m_dumpTrace = true;
+                break;
             default:
                 return false;
         }
     }
 
-    for(int i{optind}; i < m_argc; ++i) {
-        const QFileInfo fileinfo{QFile::decodeName(m_argv[i])};
+    const auto addFile = [this](const QString& path) {
+        const QFileInfo fileinfo{path};
         if(fileinfo.exists()) {
             m_files.append(QUrl::fromLocalFile(fileinfo.canonicalFilePath()));
         }
+    };
+
+    for(int i{optind}; i < m_argc; ++i) {
+        // A lone dash reads one path per line from stdin, e.g. piped from find
+        if(std::string_view{m_argv[i]} == "-") {
+            std::string line;
+            while(std::getline(std::cin, line)) {
+                if(!line.empty()) {
+                    addFile(QFile::decodeName(line.c_str()));
+                }
+            }
+            continue;
+        }
+        addFile(QFile::decodeName(m_argv[i]));
     }
 
     return true;
@@ -91,7 +190,7 @@ bool CommandLine::parse()
 
 bool CommandLine::empty() const
 {
-    return m_files.empty() && !m_skipSingle;
+    return m_files.empty() && !m_skipSingle && m_command == Command::None && !m_dumpTrace;
 }
 
 QList<QUrl> CommandLine::files() const
@@ -104,6 +203,31 @@ bool CommandLine::skipSingleApp() const
     return m_skipSingle;
 }
 
+CommandLine::Command CommandLine::command() const
+{
+    return m_command;
+}
+
+bool CommandLine::headless() const
+{
+    return m_headless;
+}
+
+QString CommandLine::tracePath() const
+{
+    return m_tracePath;
+}
+
+QString CommandLine::spanTracePath() const
+{
+    return m_spanTracePath;
+}
+
+bool CommandLine::dumpTrace() const
+{
+    return m_dumpTrace;
+}
+
 QByteArray CommandLine::saveOptions() const
 {
     QByteArray out;
@@ -111,6 +235,8 @@ QByteArray CommandLine::saveOptions() const
 
     stream << m_files;
     stream << m_skipSingle;
+    stream << m_command;
+    stream << m_dumpTrace;
 
     return out;
 }
@@ -122,4 +248,6 @@ void CommandLine::loadOptions(const QByteArray& options)
 
     stream >> m_files;
     stream >> m_skipSingle;
+    stream >> m_command;
+    stream >> m_dumpTrace;
 }
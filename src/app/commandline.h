@@ -22,9 +22,23 @@
 #include <QList>
 #include <QUrl>
 
+#include <cstdint>
+
 class CommandLine
 {
 public:
+    // Playback controls, passed on to the running instance
+    enum class Command : uint8_t
+    {
+        None = 0,
+        Play,
+        Pause,
+        PlayPause,
+        Stop,
+        Next,
+        Previous,
+    };
+
     explicit CommandLine(int argc = 0, char** argv = nullptr);
 
     bool parse();
@@ -32,6 +46,15 @@ public:
     [[nodiscard]] bool empty() const;
     [[nodiscard]] QList<QUrl> files() const;
     [[nodiscard]] bool skipSingleApp() const;
+    [[nodiscard]] Command command() const;
+    /** Returns @c true if only the core should be run, without any windows. */
+    [[nodiscard]] bool headless() const;
+    /** Returns the file to write a startup trace to, or an empty string if tracing wasn't requested. */
+    [[nodiscard]] QString tracePath() const;
+    /** Returns the file to write spans to on exit, or an empty string if they aren't being recorded. */
+    [[nodiscard]] QString spanTracePath() const;
+    /** Returns @c true if the running instance should write the spans it has recorded. */
+    [[nodiscard]] bool dumpTrace() const;
 
     [[nodiscard]] QByteArray saveOptions() const;
     void loadOptions(const QByteArray& options);
@@ -41,4 +64,9 @@ private:
     char** m_argv;
     QList<QUrl> m_files;
     bool m_skipSingle;
+    Command m_command;
+    bool m_headless;
+    QString m_tracePath;
+    QString m_spanTracePath;
+    bool m_dumpTrace;
 };
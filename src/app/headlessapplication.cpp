@@ -0,0 +1,89 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "headlessapplication.h"
+
+#include <core/library/musiclibrary.h>
+#include <core/playlist/playlist.h>
+#include <core/playlist/playlisthandler.h>
+#include <core/plugins/pluginmanager.h>
+#include <utils/fileutils.h>
+
+#include <QTimer>
+
+#include <algorithm>
+
+// Matches the playlist files opened in the GUI are added to
+constexpr auto DefaultPlaylist = "Default";
+
+namespace Fooyin {
+HeadlessApplication::HeadlessApplication(const CorePluginContext& core, QObject* parent)
+    : QObject{parent}
+    , m_core{core}
+{
+    QTimer::singleShot(0, this, [this]() { m_core.pluginManager->initialiseLazyPlugins(); });
+}
+
+void HeadlessApplication::openFiles(const QList<QUrl>& urls)
+{
+    const QStringList filepaths = Utils::File::getFiles(urls, Track::supportedFileExtensions());
+    if(filepaths.empty()) {
+        return;
+    }
+
+    TrackList tracks;
+    tracks.reserve(filepaths.size());
+    std::ranges::transform(filepaths, std::back_inserter(tracks), [](const QString& path) { return Track{path}; });
+
+    auto* library             = m_core.library;
+    auto* handler             = m_core.playlistHandler;
+    const ScanRequest request = library->scanTracks(tracks);
+
+    // Only lives until the scan it's waiting for has finished
+    auto* receiver = new QObject(this);
+    QObject::connect(library, &MusicLibrary::tracksScanned, receiver,
+                     [receiver, handler, request](int id, const TrackList& scannedTracks) {
+                         if(id != request.id) {
+                             return;
+                         }
+                         receiver->deleteLater();
+
+                         if(scannedTracks.empty()) {
+                             return;
+                         }
+
+                         const QString name = QString::fromLatin1(DefaultPlaylist);
+                         Playlist* playlist = handler->playlistByName(name);
+                         if(playlist) {
+                             const int indexToPlay = playlist->trackCount();
+                             handler->appendToPlaylist(playlist->id(), scannedTracks);
+                             playlist->changeCurrentIndex(indexToPlay);
+                         }
+                         else {
+                             playlist = handler->createPlaylist(name, scannedTracks);
+                         }
+
+                         if(playlist) {
+                             handler->startPlayback(playlist);
+                         }
+                     });
+}
+} // namespace Fooyin
+
+#include "moc_headlessapplication.cpp"
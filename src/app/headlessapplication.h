@@ -0,0 +1,45 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/plugins/coreplugincontext.h>
+
+#include <QObject>
+#include <QUrl>
+
+namespace Fooyin {
+/*!
+ * Runs the core without a window, for instances controlled through MPRIS or the command line.
+ * Lazy plugins are initialised with the core context only, so nothing GUI-related is created.
+ */
+class HeadlessApplication : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessApplication(const CorePluginContext& core, QObject* parent = nullptr);
+
+    /** Reads @p urls, appends them to the default playlist and starts playing the first of them. */
+    void openFiles(const QList<QUrl>& urls);
+
+private:
+    CorePluginContext m_core;
+};
+} // namespace Fooyin
@@ -20,13 +20,103 @@
 #include "version.h"
 
 #include "commandline.h"
+#include "headlessapplication.h"
 
 #include <core/application.h>
+#include <core/player/playercontroller.h>
+#include <core/playlist/playlisthandler.h>
 #include <gui/guiapplication.h>
+#include <utils/startuptrace.h>
+#include <utils/tracing.h>
 
 #include <kdsingleapplication.h>
 
 #include <QApplication>
+#include <QTimer>
+
+// Writes the startup trace even if playlists are never populated
+constexpr auto StartupTraceTimeout = 30000;
+
+namespace {
+void runCommand(Fooyin::PlayerController* playerController, CommandLine::Command command)
+{
+    switch(command) {
+        case(CommandLine::Command::Play):
+            playerController->play();
+            break;
+        case(CommandLine::Command::Pause):
+            playerController->pause();
+            break;
+        case(CommandLine::Command::PlayPause):
+            playerController->playPause();
+            break;
+        case(CommandLine::Command::Stop):
+            playerController->stop();
+            break;
+        case(CommandLine::Command::Next):
+            playerController->next();
+            break;
+        case(CommandLine::Command::Previous):
+            playerController->previous();
+            break;
+        case(CommandLine::Command::None):
+            break;
+    }
+}
+
+void dumpTrace(const QString& path)
+{
+    if(path.isEmpty()) {
+        qWarning() << "Spans aren't being recorded; start fooyin with --trace";
+        return;
+    }
+    Fooyin::Tracing::dump(path);
+}
+
+int runHeadless(int argc, char** argv, const CommandLine& commandLine)
+{
+    const QCoreApplication app{argc, argv};
+    KDSingleApplication instance{QCoreApplication::applicationName(),
+                                 KDSingleApplication::Option::IncludeUsernameInSocketName};
+    if(!instance.isPrimaryInstance()) {
+        instance.sendMessage(commandLine.saveOptions());
+        return 0;
+    }
+
+    Fooyin::Application coreApp;
+    Fooyin::HeadlessApplication headlessApp{coreApp.context()};
+    auto* playerController = coreApp.context().playerController;
+
+    if(!commandLine.files().empty()) {
+        headlessApp.openFiles(commandLine.files());
+    }
+    runCommand(playerController, commandLine.command());
+
+    const QString tracePath = commandLine.spanTracePath();
+
+    QObject::connect(&instance, &KDSingleApplication::messageReceived, &headlessApp,
+                     [&headlessApp, playerController, tracePath](const QByteArray& options) {
+                         CommandLine command;
+                         command.loadOptions(options);
+                         if(!command.files().empty()) {
+                             headlessApp.openFiles(command.files());
+                         }
+                         runCommand(playerController, command.command());
+                         if(command.dumpTrace()) {
+                             dumpTrace(tracePath);
+                         }
+                     });
+
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &coreApp, [&coreApp, tracePath]() {
+        coreApp.shutdown();
+        if(!tracePath.isEmpty()) {
+            Fooyin::Tracing::dump(tracePath);
+        }
+    });
+
+    return QCoreApplication::exec();
+}
+} // namespace
 
 int main(int argc, char** argv)
 {
@@ -63,11 +153,21 @@ int main(int argc, char** argv)
         if(!commandLine.parse()) {
             return 1;
         }
+        if(const QString tracePath = commandLine.tracePath(); !tracePath.isEmpty()) {
+            Fooyin::StartupTrace::enable(tracePath);
+        }
+        if(!commandLine.spanTracePath().isEmpty()) {
+            Fooyin::Tracing::start();
+        }
         if(!checkInstance(instance)) {
             return 0;
         }
     }
 
+    if(commandLine.headless()) {
+        return runHeadless(argc, argv, commandLine);
+    }
+
     const QApplication app{argc, argv};
     KDSingleApplication instance{QCoreApplication::applicationName(),
                                  KDSingleApplication::Option::IncludeUsernameInSocketName};
@@ -76,27 +176,52 @@ int main(int argc, char** argv)
     }
 
     // Startup
+    Fooyin::StartupTrace::Scope coreTrace{"Application"};
     Fooyin::Application coreApp;
+    coreTrace.end();
+
+    Fooyin::StartupTrace::Scope guiTrace{"GuiApplication"};
     Fooyin::GuiApplication guiApp{coreApp.context()};
+    guiTrace.end();
 
-    if(!commandLine.empty()) {
-        guiApp.openFiles(commandLine.files());
+    if(Fooyin::StartupTrace::isEnabled()) {
+        // Startup is complete once restored playlists have been shown
+        QObject::connect(coreApp.context().playlistHandler, &Fooyin::PlaylistHandler::playlistsPopulated, &guiApp,
+                         []() { QTimer::singleShot(0, []() { Fooyin::StartupTrace::finish(); }); });
+        QTimer::singleShot(StartupTraceTimeout, []() { Fooyin::StartupTrace::finish(); });
     }
 
-    QObject::connect(&instance, &KDSingleApplication::messageReceived, &guiApp, [&guiApp](const QByteArray& options) {
-        CommandLine command;
-        command.loadOptions(options);
-        if(!command.empty()) {
-            guiApp.openFiles(command.files());
-        }
-        else {
-            guiApp.raise();
-        }
-    });
+    auto* playerController  = coreApp.context().playerController;
+    const QString tracePath = commandLine.spanTracePath();
 
-    QObject::connect(&app, &QCoreApplication::aboutToQuit, &coreApp, [&coreApp, &guiApp]() {
+    if(!commandLine.files().empty()) {
+        guiApp.openFiles(commandLine.files());
+    }
+    runCommand(playerController, commandLine.command());
+
+    QObject::connect(&instance, &KDSingleApplication::messageReceived, &guiApp,
+                     [&guiApp, playerController, tracePath](const QByteArray& options) {
+                         CommandLine command;
+                         command.loadOptions(options);
+                         if(command.empty()) {
+                             guiApp.raise();
+                             return;
+                         }
+                         if(!command.files().empty()) {
+                             guiApp.openFiles(command.files());
+                         }
+                         runCommand(playerController, command.command());
+                         if(command.dumpTrace()) {
+                             dumpTrace(tracePath);
+                         }
+                     });
+
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &coreApp, [&coreApp, &guiApp, tracePath]() {
         guiApp.shutdown();
         coreApp.shutdown();
+        if(!tracePath.isEmpty()) {
+            Fooyin::Tracing::dump(tracePath);
+        }
     });
 
     return QCoreApplication::exec();
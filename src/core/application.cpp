@@ -21,36 +21,40 @@
 
 #include "corepaths.h"
 #include "database/database.h"
+#include "database/databasemaintenance.h"
+#include "engine/audiofingerprint.h"
 #include "engine/enginehandler.h"
 #include "internalcoresettings.h"
 #include "library/librarymanager.h"
 #include "library/unifiedmusiclibrary.h"
 #include "plugins/pluginmanager.h"
+#include "schedulingpolicy.h"
 #include "translations.h"
 
+#include <core/engine/dspplugin.h>
 #include <core/engine/outputplugin.h>
 #include <core/player/playercontroller.h>
 #include <core/playlist/playlisthandler.h>
+#include <core/playlist/smartplaylistmanager.h>
 #include <core/plugins/coreplugin.h>
+#include <core/plugins/libraryapi.h>
+#include <utils/crossthreadstats.h>
+#include <utils/database/dbexecutor.h>
+#include <utils/memoryusage.h>
+#include <utils/savescheduler.h>
 #include <utils/settings/settingsmanager.h>
+#include <utils/startuptrace.h>
+#include <utils/stringpool.h>
 
-#include <QBasicTimer>
 #include <QCoreApplication>
 #include <QProcess>
-#include <QTimerEvent>
-
-using namespace std::chrono_literals;
 
 constexpr auto LastPlaybackPosition = "Player/LastPositon";
 constexpr auto LastPlaybackState    = "Player/LastState";
 
-#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
-constexpr auto PlaylistSaveInterval = 30s;
-constexpr auto SettingsSaveInterval = 5min;
-#else
-constexpr auto PlaylistSaveInterval = 30000;
-constexpr auto SettingsSaveInterval = 300000;
-#endif
+// Longest time a change waits before being written, counted from the first change since the last write
+constexpr int PlaylistSaveDelay = 30000;
+constexpr int SettingsSaveDelay = 300000;
 
 namespace Fooyin {
 struct Application::Private
@@ -61,53 +65,114 @@ struct Application::Private
     CoreSettings coreSettings;
     Translations translations;
     Database* database;
+    DbExecutor dbExecutor;
+    DatabaseMaintenance* databaseMaintenance;
     PlayerController* playerController;
+    SchedulingPolicy* schedulingPolicy;
     EngineHandler engine;
     LibraryManager* libraryManager;
     UnifiedMusicLibrary* library;
     PlaylistHandler* playlistHandler;
+    SmartPlaylistManager* smartPlaylists;
+    LibraryApi libraryApi;
 
     PluginManager pluginManager;
     CorePluginContext corePluginContext;
 
-    QBasicTimer playlistSaveTimer;
-    QBasicTimer settingsSaveTimer;
+    SaveScheduler saveScheduler;
+    int playlistSaveTarget{-1};
+    int settingsSaveTarget{-1};
+
+    std::vector<int> memorySources;
 
     explicit Private(Application* self_)
         : self{self_}
         , settingsManager{new SettingsManager(Core::settingsPath(), self)}
         , coreSettings{settingsManager}
         , translations{settingsManager}
-        , database{new Database(self)}
+        , database{new Database(settingsManager, self)}
+        , dbExecutor{database->connectionPool()}
+        , databaseMaintenance{new DatabaseMaintenance(&dbExecutor, settingsManager, self)}
         , playerController{new PlayerController(settingsManager, self)}
+        , schedulingPolicy{new SchedulingPolicy(playerController, settingsManager, self)}
         , engine{playerController, settingsManager}
         , libraryManager{new LibraryManager(database->connectionPool(), settingsManager, self)}
         , library{new UnifiedMusicLibrary(libraryManager, database->connectionPool(), settingsManager, self)}
-        , playlistHandler{new PlaylistHandler(database->connectionPool(), playerController, settingsManager, self)}
+        , playlistHandler{new PlaylistHandler(database->connectionPool(), database->readConnectionPool(),
+                                              playerController, settingsManager, self)}
+        , smartPlaylists{new SmartPlaylistManager(library, playlistHandler, settingsManager, self)}
+        , libraryApi{library}
         , pluginManager{settingsManager}
-        , corePluginContext{&pluginManager, &engine,         playerController, libraryManager,
-                            library,        playlistHandler, settingsManager}
+        , corePluginContext{&pluginManager,  &engine,        playerController, libraryManager, library,
+                            playlistHandler, smartPlaylists, settingsManager,  &dbExecutor,    &libraryApi}
     {
         registerTypes();
+        registerMemorySources();
         loadPlugins();
 
-        settingsSaveTimer.start(SettingsSaveInterval, self);
+        playlistSaveTarget = saveScheduler.addTarget(PlaylistSaveDelay, [this]() { playlistHandler->savePlaylists(); });
+        settingsSaveTarget = saveScheduler.addTarget(SettingsSaveDelay, [this]() {
+            if(settingsManager->settingsHaveChanged()) {
+                settingsManager->storeSettings();
+            }
+        });
+        QObject::connect(settingsManager, &SettingsManager::settingsModified, &saveScheduler,
+                         [this]() { saveScheduler.markDirty(settingsSaveTarget); });
+    }
+
+    ~Private()
+    {
+        for(const int source : memorySources) {
+            MemoryUsage::removeSource(source);
+        }
     }
 
+    Private(const Private&)            = delete;
+    Private& operator=(const Private&) = delete;
+
     static void registerTypes()
     {
+        const StartupTrace::Scope trace{"Application::registerTypes"};
+
         qRegisterMetaType<Track>("Track");
         qRegisterMetaType<TrackList>("TrackList");
+        qRegisterMetaType<TrackListPtr>("TrackListPtr");
         qRegisterMetaType<TrackIds>("TrackIds");
         qRegisterMetaType<TrackIdMap>("TrackIdMap");
         qRegisterMetaType<TrackFieldMap>("TrackFieldMap");
+        qRegisterMetaType<TrackFingerprintMap>("TrackFingerprintMap");
         qRegisterMetaType<OutputCreator>("OutputCreator");
+        qRegisterMetaType<OutputPath>("OutputPath");
         qRegisterMetaType<LibraryInfo>("LibraryInfo");
         qRegisterMetaType<LibraryInfoMap>("LibraryInfoMap");
+        qRegisterMetaType<ScanMetrics>("ScanMetrics");
+    }
+
+    void registerMemorySources()
+    {
+        memorySources.push_back(MemoryUsage::addSource(QStringLiteral("Tracks"), [this]() {
+            const TrackList tracks = library->tracks();
+
+            MemoryUsage::Usage usage{.bytes = 0, .entries = tracks.size()};
+            for(const Track& track : tracks) {
+                usage.bytes += track.memoryUsage();
+            }
+            return usage;
+        }));
+
+        memorySources.push_back(MemoryUsage::addSource(
+            QStringLiteral("Interned strings"),
+            []() {
+                return MemoryUsage::Usage{.bytes   = StringPool::memoryUsage(),
+                                          .entries = static_cast<size_t>(StringPool::size())};
+            },
+            StringPool::prune, MemoryUsage::TrimPriority::Last));
     }
 
     void loadPlugins()
     {
+        const StartupTrace::Scope trace{"Application::loadPlugins"};
+
         const QStringList pluginPaths{Core::pluginPaths()};
         pluginManager.findPlugins(pluginPaths);
         pluginManager.loadPlugins();
@@ -119,11 +184,16 @@ struct Application::Private
             const AudioOutputBuilder builder = plugin->registerOutput();
             engine.addOutput(builder);
         });
+
+        pluginManager.initialisePlugins<DspPlugin>([this](DspPlugin* plugin) {
+            const DspBuilder builder = plugin->registerDsp();
+            engine.addDsp(builder);
+        });
     }
 
-    void startSaveTimer()
+    void playlistsChanged()
     {
-        playlistSaveTimer.start(PlaylistSaveInterval, self);
+        saveScheduler.markDirty(playlistSaveTarget);
     }
 
     void savePlaybackState() const
@@ -143,6 +213,8 @@ struct Application::Private
 
     void loadPlaybackState() const
     {
+        const StartupTrace::Scope trace{"Application::loadPlaybackState"};
+
         if(!settingsManager->value<Settings::Core::Internal::SavePlaybackState>()) {
             return;
         }
@@ -170,27 +242,40 @@ Application::Application(QObject* parent)
     , p{std::make_unique<Private>(this)}
 {
     QObject::connect(p->playlistHandler, &PlaylistHandler::playlistTracksAdded, this,
-                     [this]() { p->startSaveTimer(); });
+                     [this]() { p->playlistsChanged(); });
     QObject::connect(p->playlistHandler, &PlaylistHandler::playlistTracksChanged, this,
-                     [this]() { p->startSaveTimer(); });
+                     [this]() { p->playlistsChanged(); });
+    QObject::connect(p->playlistHandler, &PlaylistHandler::playlistTracksReordered, this,
+                     [this]() { p->playlistsChanged(); });
     QObject::connect(p->playlistHandler, &PlaylistHandler::playlistTracksRemoved, this,
-                     [this]() { p->startSaveTimer(); });
+                     [this]() { p->playlistsChanged(); });
     QObject::connect(p->playlistHandler, &PlaylistHandler::playlistsPopulated, this,
                      [this]() { p->loadPlaybackState(); });
 
     QObject::connect(p->playerController, &PlayerController::trackPlayed, p->library,
                      &UnifiedMusicLibrary::trackWasPlayed);
-    QObject::connect(p->library, &MusicLibrary::tracksLoaded, p->playlistHandler, &PlaylistHandler::populatePlaylists);
+    QObject::connect(p->playerController, &PlayerController::playStateChanged, p->library,
+                     &UnifiedMusicLibrary::updatePlayState);
+    p->playlistHandler->setTrackSource([this]() { return p->library->snapshot(); });
+    QObject::connect(p->library, &MusicLibrary::tracksLoaded, p->playlistHandler,
+                     [this]() { p->playlistHandler->populatePlaylists(p->library->snapshot()); });
     QObject::connect(p->libraryManager, &LibraryManager::removingLibraryTracks, p->playlistHandler,
                      &PlaylistHandler::savePlaylists);
     QObject::connect(p->library, &MusicLibrary::tracksUpdated, p->playlistHandler,
                      [this](const TrackList& tracks) { p->playlistHandler->tracksUpdated(tracks); });
+    QObject::connect(p->library, &MusicLibrary::libraryChanged, p->playlistHandler,
+                     &PlaylistHandler::libraryChanged);
     QObject::connect(p->library, &MusicLibrary::tracksPlayed, p->playlistHandler,
                      [this](const TrackList& tracks) { p->playlistHandler->tracksPlayed(tracks); });
     QObject::connect(&p->engine, &EngineHandler::trackAboutToFinish, p->playlistHandler,
                      &PlaylistHandler::trackAboutToFinish);
+    QObject::connect(p->playlistHandler, &PlaylistHandler::nextTrackReady, &p->engine,
+                     &EngineHandler::prepareNextTrack);
+    QObject::connect(p->playlistHandler, &PlaylistHandler::upcomingTrack, &p->engine, &EngineHandler::prefetchTrack);
 
     p->library->loadAllTracks();
+
+    const StartupTrace::Scope engineTrace{"EngineHandler::setup"};
     p->engine.setup();
 }
 
@@ -201,21 +286,6 @@ CorePluginContext Application::context() const
     return p->corePluginContext;
 }
 
-void Application::timerEvent(QTimerEvent* event)
-{
-    if(event->timerId() == p->playlistSaveTimer.timerId()) {
-        p->playlistSaveTimer.stop();
-        p->playlistHandler->savePlaylists();
-    }
-    else if(event->timerId() == p->settingsSaveTimer.timerId()) {
-        if(p->settingsManager->settingsHaveChanged()) {
-            p->settingsManager->storeSettings();
-        }
-    }
-
-    QObject::timerEvent(event);
-}
-
 void Application::shutdown()
 {
     p->savePlaybackState();
@@ -224,6 +294,8 @@ void Application::shutdown()
     p->pluginManager.shutdown();
     p->settingsManager->storeSettings();
     p->library->cleanupTracks();
+
+    CrossThreadStats::logSummary();
 }
 
 void Application::quit()
@@ -0,0 +1,284 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "archivecache.h"
+
+#include "archivereader.h"
+
+#include <core/track.h>
+#include <utils/crypto.h>
+#include <utils/lrucache.h>
+#include <utils/paths.h>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Default size of the shared cache
+constexpr uint64_t CacheLimit = 1024ULL * 1024 * 1024;
+// Share of the cache which can be filled by reading ahead in a solid archive
+constexpr uint64_t ReadAheadDivisor = 4;
+// Size of the chunks streamed from an archive to disk
+constexpr int64_t CopyBufferSize = 256 * 1024;
+
+namespace {
+// Removes its file once evicted from the cache
+class ExtractedFile
+{
+public:
+    explicit ExtractedFile(QString path)
+        : m_path{std::move(path)}
+    { }
+
+    ~ExtractedFile()
+    {
+        if(!m_path.isEmpty()) {
+            QFile::remove(m_path);
+        }
+    }
+
+    ExtractedFile(ExtractedFile&& other) noexcept
+        : m_path{std::exchange(other.m_path, {})}
+    { }
+
+    ExtractedFile& operator=(ExtractedFile&& other) noexcept
+    {
+        std::swap(m_path, other.m_path);
+        return *this;
+    }
+
+    ExtractedFile(const ExtractedFile&)            = delete;
+    ExtractedFile& operator=(const ExtractedFile&) = delete;
+
+    [[nodiscard]] const QString& path() const
+    {
+        return m_path;
+    }
+
+private:
+    QString m_path;
+};
+
+// Identifies a version of an archive, so files of one which has since been replaced aren't used
+QString archiveKey(const QFileInfo& info)
+{
+    return Fooyin::Utils::generateHash(info.absoluteFilePath(), QString::number(info.size()),
+                                       QString::number(info.lastModified().toMSecsSinceEpoch()));
+}
+} // namespace
+
+namespace Fooyin {
+struct ArchiveCache::Private
+{
+    QString directory;
+    uint64_t limit;
+
+    mutable std::mutex mutex;
+    LruCache<QString, ExtractedFile> files;
+
+    Private(QString directory_, uint64_t limit_)
+        : directory{std::move(directory_)}
+        , limit{limit_}
+        , files{static_cast<size_t>(limit_)}
+    { }
+
+    QString cachedFile(const QString& key)
+    {
+        const std::scoped_lock lock{mutex};
+        if(const auto* file = files.find(key)) {
+            return file->path();
+        }
+        return {};
+    }
+
+    // Streams the current entry of @p reader to a new file and caches it under @p key
+    QString store(ArchiveReader& reader, const ArchiveReader::Entry& entry, const QString& key)
+    {
+        const QFileInfo entryInfo{entry.path};
+        QTemporaryFile file{directory + u'/' + Utils::generateHash(key) + QStringLiteral("-XXXXXX.")
+                            + entryInfo.suffix()};
+        file.setAutoRemove(false);
+        if(!file.open()) {
+            qWarning() << "[ArchiveCache] Unable to create file in" << directory << file.errorString();
+            return {};
+        }
+
+        std::vector<std::byte> buffer(static_cast<size_t>(CopyBufferSize));
+        bool success{true};
+
+        while(true) {
+            const int64_t count = reader.read(buffer.data(), CopyBufferSize);
+            if(count == 0) {
+                break;
+            }
+            if(count < 0 || file.write(reinterpret_cast<const char*>(buffer.data()), count) != count) {
+                success = false;
+                break;
+            }
+        }
+
+        const QString path = file.fileName();
+        const qint64 size  = file.size();
+        file.close();
+
+        if(!success) {
+            qWarning() << "[ArchiveCache] Unable to extract" << entry.path;
+            QFile::remove(path);
+            return {};
+        }
+
+        const std::scoped_lock lock{mutex};
+
+        // Extracted by another reader in the meantime
+        if(const auto* cached = files.find(key)) {
+            QFile::remove(path);
+            return cached->path();
+        }
+
+        if(!files.insert(key, ExtractedFile{path}, static_cast<size_t>(size))) {
+            qWarning() << "[ArchiveCache] File too large to cache:" << entry.path;
+            QFile::remove(path);
+            return {};
+        }
+
+        return path;
+    }
+
+    QString extract(const QString& archivePath, const QString& archive, const QString& entryPath)
+    {
+        ArchiveReader reader;
+        if(!reader.open(archivePath)) {
+            return {};
+        }
+
+        QString result;
+        uint64_t readAhead{0};
+
+        ArchiveReader::Entry entry;
+        while(reader.nextEntry(entry)) {
+            const QString key = archive + entry.path;
+
+            if(result.isEmpty()) {
+                if(entry.path != entryPath) {
+                    continue;
+                }
+            }
+            else if(!reader.isSolid() || readAhead >= limit / ReadAheadDivisor) {
+                break;
+            }
+            else if(!ArchiveReader::isTrackFile(entry.path) || !cachedFile(key).isEmpty()) {
+                continue;
+            }
+
+            const QString path = store(reader, entry, key);
+            if(path.isEmpty()) {
+                break;
+            }
+
+            if(result.isEmpty()) {
+                result = path;
+            }
+            else {
+                readAhead += static_cast<uint64_t>(std::max<int64_t>(entry.size, 0));
+            }
+        }
+
+        if(result.isEmpty()) {
+            qWarning() << "[ArchiveCache] Unable to find" << entryPath << "in" << archivePath;
+        }
+
+        return result;
+    }
+};
+
+ArchiveCache::ArchiveCache(QString directory, uint64_t limit)
+    : p{std::make_unique<Private>(std::move(directory), limit)}
+{
+    // Files are only tracked for the lifetime of the cache, so any left over are orphans
+    QDir dir{p->directory};
+    dir.removeRecursively();
+    dir.mkpath(QStringLiteral("."));
+}
+
+ArchiveCache::~ArchiveCache() = default;
+
+ArchiveCache& ArchiveCache::instance()
+{
+    static ArchiveCache cache{Utils::cachePath(QStringLiteral("archives")), CacheLimit};
+    return cache;
+}
+
+QString ArchiveCache::file(const QString& filepath)
+{
+    const Track track{filepath};
+    if(!track.isInArchive()) {
+        return {};
+    }
+
+    const QFileInfo info{track.archivePath()};
+    if(!info.exists()) {
+        return {};
+    }
+
+    const QString archive = archiveKey(info);
+    if(QString path = p->cachedFile(archive + track.pathInArchive()); !path.isEmpty()) {
+        return path;
+    }
+
+    return p->extract(track.archivePath(), archive, track.pathInArchive());
+}
+
+uint64_t ArchiveCache::size() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->files.cost();
+}
+
+size_t ArchiveCache::count() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->files.count();
+}
+
+bool ArchiveCache::contains(const QString& filepath) const
+{
+    const Track track{filepath};
+    const QFileInfo info{track.archivePath()};
+    if(!track.isInArchive() || !info.exists()) {
+        return false;
+    }
+
+    const std::scoped_lock lock{p->mutex};
+    return p->files.contains(archiveKey(info) + track.pathInArchive());
+}
+
+void ArchiveCache::clear()
+{
+    const std::scoped_lock lock{p->mutex};
+    p->files.clear();
+}
+} // namespace Fooyin
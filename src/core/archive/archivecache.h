@@ -0,0 +1,72 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QString>
+
+#include <cstdint>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * A bounded on-disk cache of tracks extracted from archives, for reading them with random access.
+ *
+ * Extracting a track of a solid archive also stores the tracks following it, as reaching any of them later
+ * would mean decompressing the archive from the start again. Playing an album in order then passes through
+ * its archive once per read-ahead, rather than once per track.
+ * Once the cache grows beyond its limit the least recently used files are removed.
+ * @note files only last for the lifetime of the cache, and any left in its directory are removed on creation.
+ */
+class FYCORE_EXPORT ArchiveCache
+{
+public:
+    /** Creates a cache of at most @p limit bytes of files in @p directory. */
+    ArchiveCache(QString directory, uint64_t limit);
+    ~ArchiveCache();
+
+    ArchiveCache(const ArchiveCache&)            = delete;
+    ArchiveCache& operator=(const ArchiveCache&) = delete;
+
+    /** Returns the cache shared by the decoders and tag reader. */
+    static ArchiveCache& instance();
+
+    /*!
+     * Returns the path of a local copy of the archived track at @p filepath, extracting it if it isn't cached.
+     * @returns an empty string if @p filepath isn't in an archive or couldn't be extracted.
+     * @note the file may be removed once evicted, so it should be opened straight away.
+     */
+    QString file(const QString& filepath);
+
+    /** Returns the combined size of all cached files. */
+    [[nodiscard]] uint64_t size() const;
+    /** Returns the number of cached files. */
+    [[nodiscard]] size_t count() const;
+    /** Returns @c true if the track at @p filepath is cached. */
+    [[nodiscard]] bool contains(const QString& filepath) const;
+
+    void clear();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,238 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "archivereader.h"
+
+#include <core/track.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+#include <archive.h>
+#include <archive_entry.h>
+#endif
+
+#include <algorithm>
+
+// Size of the blocks libarchive reads from the archive file at a time
+constexpr size_t ReadBlockSize = 64 * 1024;
+// Largest file read into memory by readAll
+constexpr int64_t MaxReadAllSize = 1024LL * 1024 * 1024;
+
+namespace Fooyin {
+struct ArchiveReader::Private
+{
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+    archive* reader{nullptr};
+#endif
+    QString filepath;
+    bool solid{false};
+    int64_t entrySize{-1};
+};
+
+ArchiveReader::ArchiveReader()
+    : p{std::make_unique<Private>()}
+{ }
+
+ArchiveReader::~ArchiveReader()
+{
+    close();
+}
+
+QStringList ArchiveReader::supportedExtensions()
+{
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+    static const QStringList extensions{QStringLiteral("*.zip"), QStringLiteral("*.7z"), QStringLiteral("*.rar")};
+    return extensions;
+#else
+    return {};
+#endif
+}
+
+bool ArchiveReader::isArchive(const QString& filepath)
+{
+    return QDir::match(supportedExtensions(), filepath.sliced(filepath.lastIndexOf(u'/') + 1));
+}
+
+bool ArchiveReader::isTrackFile(const QString& entryPath)
+{
+    const QString filename = entryPath.sliced(entryPath.lastIndexOf(u'/') + 1);
+    return QDir::match(Track::supportedFileExtensions(), filename)
+        && !filename.endsWith(QLatin1String(".cue"), Qt::CaseInsensitive) && !isArchive(filename);
+}
+
+bool ArchiveReader::open(const QString& filepath)
+{
+    close();
+
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+    p->reader = archive_read_new();
+    if(!p->reader) {
+        return false;
+    }
+
+    // The seekable reader goes straight to the central directory, rather than trusting local headers
+    archive_read_support_format_zip_seekable(p->reader);
+    archive_read_support_format_7zip(p->reader);
+    archive_read_support_format_rar(p->reader);
+    archive_read_support_format_rar5(p->reader);
+
+    if(archive_read_open_filename(p->reader, QFile::encodeName(filepath).constData(), ReadBlockSize) != ARCHIVE_OK) {
+        qWarning() << "[ArchiveReader] Unable to open archive" << filepath << archive_error_string(p->reader);
+        close();
+        return false;
+    }
+
+    p->filepath = filepath;
+    return true;
+#else
+    qDebug() << "[ArchiveReader] Built without archive support, unable to open" << filepath;
+    return false;
+#endif
+}
+
+void ArchiveReader::close()
+{
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+    if(p->reader) {
+        archive_read_free(p->reader);
+        p->reader = nullptr;
+    }
+#endif
+    p->filepath.clear();
+    p->solid     = false;
+    p->entrySize = -1;
+}
+
+bool ArchiveReader::isOpen() const
+{
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+    return p->reader != nullptr;
+#else
+    return false;
+#endif
+}
+
+bool ArchiveReader::nextEntry(Entry& entry)
+{
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+    if(!p->reader) {
+        return false;
+    }
+
+    archive_entry* header{nullptr};
+    while(true) {
+        const int result = archive_read_next_header(p->reader, &header);
+        if(result == ARCHIVE_EOF) {
+            return false;
+        }
+        if(result < ARCHIVE_WARN) {
+            qWarning() << "[ArchiveReader] Unable to read" << p->filepath << archive_error_string(p->reader);
+            return false;
+        }
+        if(archive_entry_filetype(header) == AE_IFREG) {
+            break;
+        }
+    }
+
+    const int format = archive_format(p->reader) & ARCHIVE_FORMAT_BASE_MASK;
+    p->solid = format == ARCHIVE_FORMAT_7ZIP || format == ARCHIVE_FORMAT_RAR || format == ARCHIVE_FORMAT_RAR_V5;
+
+    // Names are only stored as UTF-8 by newer archivers, older ones use the system's encoding
+    if(const char* name = archive_entry_pathname_utf8(header)) {
+        entry.path = QString::fromUtf8(name);
+    }
+    else {
+        entry.path = QString::fromLocal8Bit(archive_entry_pathname(header));
+    }
+
+    entry.size         = archive_entry_size_is_set(header) ? archive_entry_size(header) : -1;
+    p->entrySize       = entry.size;
+    entry.modifiedTime = archive_entry_mtime_is_set(header) ? static_cast<uint64_t>(archive_entry_mtime(header)) * 1000
+                                                            : 0;
+    return true;
+#else
+    Q_UNUSED(entry);
+    return false;
+#endif
+}
+
+bool ArchiveReader::isSolid() const
+{
+    return p->solid;
+}
+
+int64_t ArchiveReader::read(std::byte* data, int64_t size)
+{
+#ifdef FOOYIN_HAVE_LIBARCHIVE
+    if(!p->reader || size < 0) {
+        return -1;
+    }
+
+    const auto count = archive_read_data(p->reader, data, static_cast<size_t>(size));
+    if(count < 0) {
+        qWarning() << "[ArchiveReader] Unable to read" << p->filepath << archive_error_string(p->reader);
+        return -1;
+    }
+    return static_cast<int64_t>(count);
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    return -1;
+#endif
+}
+
+QByteArray ArchiveReader::readAll()
+{
+    if(p->entrySize > MaxReadAllSize) {
+        qWarning() << "[ArchiveReader] Skipping file too large to read into memory in" << p->filepath;
+        return {};
+    }
+
+    QByteArray data;
+    // One more block than needed, so the end is reached without growing the array
+    data.resize(static_cast<qsizetype>(std::max<int64_t>(p->entrySize, 0)) + static_cast<qsizetype>(ReadBlockSize));
+    int64_t total{0};
+
+    while(true) {
+        if(data.size() - total < static_cast<qsizetype>(ReadBlockSize)) {
+            data.resize(data.size() * 2);
+        }
+
+        const int64_t count = read(reinterpret_cast<std::byte*>(data.data()) + total, data.size() - total);
+        if(count < 0) {
+            return {};
+        }
+        if(count == 0) {
+            break;
+        }
+
+        total += count;
+        if(total > MaxReadAllSize) {
+            qWarning() << "[ArchiveReader] Skipping file too large to read into memory in" << p->filepath;
+            return {};
+        }
+    }
+
+    data.resize(static_cast<qsizetype>(total));
+    return data;
+}
+} // namespace Fooyin
@@ -0,0 +1,86 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <cstddef>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * Reads the files of a ZIP, 7z or RAR archive in a single forward pass, streaming their contents.
+ * Entries can't be revisited or read out of order, so anything needing random access to a file
+ * goes through the ArchiveCache instead.
+ * @note archive support is optional, and every archive fails to open if fooyin was built without libarchive.
+ */
+class FYCORE_EXPORT ArchiveReader
+{
+public:
+    struct Entry
+    {
+        QString path;
+        int64_t size{0};
+        uint64_t modifiedTime{0};
+    };
+
+    ArchiveReader();
+    ~ArchiveReader();
+
+    ArchiveReader(const ArchiveReader&)            = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+    /** Returns the name filters of the archive formats which can be read, or an empty list if none can. */
+    static QStringList supportedExtensions();
+    /** Returns @c true if @p filepath has the extension of an archive format which can be read. */
+    static bool isArchive(const QString& filepath);
+    /** Returns @c true if @p entryPath is a file which can be played from an archive, i.e. not a sheet or archive. */
+    static bool isTrackFile(const QString& entryPath);
+
+    bool open(const QString& filepath);
+    void close();
+    [[nodiscard]] bool isOpen() const;
+
+    /*!
+     * Advances to the next regular file of the archive, skipping anything left of the current one.
+     * @returns false at the end of the archive or on error.
+     */
+    bool nextEntry(Entry& entry);
+
+    /*!
+     * Returns @c true if files share compressed blocks, so reaching one means decompressing those before it.
+     * Only known once the first entry has been read. 7z and RAR archives are assumed to be solid.
+     */
+    [[nodiscard]] bool isSolid() const;
+
+    /** Reads up to @p size bytes of the current entry, returning the number read, 0 at its end or -1 on error. */
+    int64_t read(std::byte* data, int64_t size);
+    /** Reads the rest of the current entry, or returns an empty array on error. */
+    QByteArray readAll();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -21,32 +21,51 @@
 
 #include "dbschema.h"
 
+#include "internalcoresettings.h"
+
 #include <core/coresettings.h>
+#include <utils/database/dbconnectionprovider.h>
 #include <utils/fileutils.h>
 #include <utils/paths.h>
 #include <utils/settings/settingsmanager.h>
 
 #include <QFileInfo>
+#include <QSqlQuery>
 
-const auto CurrentSchemaVersion = 5;
+const auto CurrentSchemaVersion = 16;
+// Also analyses tables which haven't been yet, looking at no more than AnalysisLimit rows of each index
+constexpr auto StartupOptimise = 0x10002;
+constexpr auto AnalysisLimit   = 1000;
+// Read-only connections, kept apart from those the scanner and other writers use
+constexpr auto ReadConnectionLimit = 4;
 
 namespace {
-Fooyin::DbConnection::DbParams dbConnectionParams()
+Fooyin::DbConnection::DbParams dbConnectionParams(Fooyin::SettingsManager* settings)
 {
     Fooyin::DbConnection::DbParams params;
     params.type           = QStringLiteral("QSQLITE");
     params.connectOptions = QStringLiteral("QSQLITE_OPEN_URI");
     params.filePath       = Fooyin::Utils::sharePath() + QStringLiteral("/fooyin.db");
+    params.profile        = Fooyin::Database::profile(settings);
+
+    return params;
+}
 
+Fooyin::DbConnection::DbParams readConnectionParams(Fooyin::SettingsManager* settings)
+{
+    auto params     = dbConnectionParams(settings);
+    params.readOnly = true;
     return params;
 }
 } // namespace
 
 namespace Fooyin {
-Database::Database(QObject* parent)
+Database::Database(SettingsManager* settings, QObject* parent)
     : QObject{parent}
-    , m_dbPool(DbConnectionPool::create(dbConnectionParams(), QStringLiteral("fooyin")))
+    , m_dbPool(DbConnectionPool::create(dbConnectionParams(settings), QStringLiteral("fooyin")))
     , m_connectionHandler{m_dbPool}
+    , m_readPool{DbConnectionPool::create(readConnectionParams(settings), QStringLiteral("fooyin-read"),
+                                          ReadConnectionLimit)}
     , m_status{Status::Ok}
 {
     if(!m_connectionHandler.hasConnection()) {
@@ -54,7 +73,24 @@ Database::Database(QObject* parent)
         return;
     }
 
-    initSchema();
+    if(!initSchema()) {
+        return;
+    }
+
+    if(profile(settings) == DbConnection::Profile::Performance) {
+        QSqlQuery query{DbConnectionProvider{m_dbPool}.db()};
+        query.exec(QStringLiteral("PRAGMA analysis_limit = %1;").arg(AnalysisLimit));
+        query.exec(QStringLiteral("PRAGMA optimize = %1;").arg(StartupOptimise));
+    }
+
+    // Opened once the schema exists, as these connections can't create it
+    m_readHandler = DbConnectionHandler{m_readPool};
+}
+
+DbConnection::Profile Database::profile(SettingsManager* settings)
+{
+    return settings->value<Settings::Core::Internal::DatabaseTuning>() ? DbConnection::Profile::Performance
+                                                                        : DbConnection::Profile::Default;
 }
 
 DbConnectionPoolPtr Database::connectionPool() const
@@ -62,6 +98,11 @@ DbConnectionPoolPtr Database::connectionPool() const
     return m_dbPool;
 }
 
+DbConnectionPoolPtr Database::readConnectionPool() const
+{
+    return m_readPool;
+}
+
 Database::Status Database::status() const
 {
     return m_status;
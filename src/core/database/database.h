@@ -19,13 +19,17 @@
 
 #pragma once
 
+#include "fycore_export.h"
+
 #include <utils/database/dbconnectionhandler.h>
 #include <utils/database/dbconnectionpool.h>
 
 #include <QObject>
 
 namespace Fooyin {
-class Database : public QObject
+class SettingsManager;
+
+class FYCORE_EXPORT Database : public QObject
 {
     Q_OBJECT
 
@@ -39,9 +43,18 @@ public:
         ConnectionError,
     };
 
-    explicit Database(QObject* parent = nullptr);
+    explicit Database(SettingsManager* settings, QObject* parent = nullptr);
+
+    /** Returns the connection profile selected in @p settings, used for all of fooyin's databases. */
+    static DbConnection::Profile profile(SettingsManager* settings);
 
     [[nodiscard]] DbConnectionPoolPtr connectionPool() const;
+    /*!
+     * Returns a pool of read-only connections, for reads the user is waiting on.
+     * With database tuning enabled (a WAL journal), these never wait on a writer such as a library scan.
+     * The main thread already has a connection.
+     */
+    [[nodiscard]] DbConnectionPoolPtr readConnectionPool() const;
 
     [[nodiscard]] Status status() const;
 
@@ -54,6 +67,8 @@ private:
 
     DbConnectionPoolPtr m_dbPool;
     DbConnectionHandler m_connectionHandler;
+    DbConnectionPoolPtr m_readPool;
+    DbConnectionHandler m_readHandler;
     Status m_status;
 };
 } // namespace Fooyin
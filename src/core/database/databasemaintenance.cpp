@@ -0,0 +1,221 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "databasemaintenance.h"
+
+#include "database.h"
+#include "trackdatabase.h"
+
+#include <utils/database/dbexecutor.h>
+#include <utils/database/dbquery.h>
+#include <utils/taskscheduler.h>
+
+#include <QElapsedTimer>
+#include <QTimerEvent>
+
+// Leaves startup alone, then runs hourly, or after a short delay if the system is busy
+constexpr auto InitialDelay        = 5 * 60 * 1000;
+constexpr auto MaintenanceInterval = 60 * 60 * 1000;
+constexpr auto DeferredDelay       = 5 * 60 * 1000;
+// Matches the limit used at startup, see Database
+constexpr auto OptimiseMask  = 0x10002;
+constexpr auto AnalysisLimit = 1000;
+// A full VACUUM rewrites the whole file, so it's only worth it once a quarter of it is free
+constexpr auto VacuumFreeFraction = 4;
+// PRAGMA auto_vacuum value for INCREMENTAL
+constexpr auto IncrementalAutoVacuum = 2;
+
+namespace {
+int pragmaValue(const QSqlDatabase& db, const QString& pragma)
+{
+    DbQuery query{db, QStringLiteral("PRAGMA %1;").arg(pragma)};
+    if(!query.exec() || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool execStatement(const QSqlDatabase& db, const QString& statement)
+{
+    DbQuery query{db, statement};
+    return query.exec();
+}
+
+int incrementalVacuum(const QSqlDatabase& db)
+{
+    if(pragmaValue(db, QStringLiteral("auto_vacuum")) != IncrementalAutoVacuum) {
+        return 0;
+    }
+
+    const int freePages = pragmaValue(db, QStringLiteral("freelist_count"));
+    if(freePages <= 0) {
+        return 0;
+    }
+
+    if(!execStatement(db, QStringLiteral("PRAGMA incremental_vacuum;"))) {
+        return -1;
+    }
+
+    return freePages - pragmaValue(db, QStringLiteral("freelist_count"));
+}
+
+int enableIncrementalVacuum(const QSqlDatabase& db)
+{
+    if(pragmaValue(db, QStringLiteral("auto_vacuum")) == IncrementalAutoVacuum) {
+        return 0;
+    }
+
+    const int freePages = pragmaValue(db, QStringLiteral("freelist_count"));
+    const int pageCount = pragmaValue(db, QStringLiteral("page_count"));
+    if(freePages <= 0 || freePages * VacuumFreeFraction < pageCount) {
+        return 0;
+    }
+
+    // The new mode only takes effect once the file has been rebuilt
+    if(!execStatement(db, QStringLiteral("PRAGMA auto_vacuum = INCREMENTAL;"))
+       || !execStatement(db, QStringLiteral("VACUUM;"))) {
+        return -1;
+    }
+
+    return freePages;
+}
+
+int optimise(const QSqlDatabase& db)
+{
+    // Unlike the connections which run queries, this one has no history for a plain optimize to go on
+    execStatement(db, QStringLiteral("PRAGMA analysis_limit = %1;").arg(AnalysisLimit));
+    return execStatement(db, QStringLiteral("PRAGMA optimize = %1;").arg(OptimiseMask)) ? 0 : -1;
+}
+
+QString jobName(Fooyin::DatabaseMaintenance::Job job)
+{
+    using Job = Fooyin::DatabaseMaintenance::Job;
+
+    switch(job) {
+        case(Job::RemoveUnmanagedTracks):
+            return QStringLiteral("Remove unmanaged tracks");
+        case(Job::MarkUnusedStats):
+            return QStringLiteral("Mark unused stats");
+        case(Job::DeleteExpiredStats):
+            return QStringLiteral("Delete expired stats");
+        case(Job::DeleteUnusedValues):
+            return QStringLiteral("Delete unused artists and genres");
+        case(Job::IncrementalVacuum):
+            return QStringLiteral("Incremental vacuum");
+        case(Job::EnableIncrementalVacuum):
+            return QStringLiteral("Enable incremental vacuum");
+        case(Job::Optimise):
+            return QStringLiteral("Optimise");
+        default:
+            return {};
+    }
+}
+} // namespace
+
+namespace Fooyin {
+DatabaseMaintenance::DatabaseMaintenance(DbExecutor* executor, SettingsManager* settings, QObject* parent)
+    : QObject{parent}
+    , m_executor{executor}
+    , m_idleJobs{Job::MarkUnusedStats, Job::DeleteExpiredStats, Job::DeleteUnusedValues, Job::IncrementalVacuum}
+    , m_running{false}
+{
+    if(Database::profile(settings) == DbConnection::Profile::Performance) {
+        m_idleJobs.push_back(Job::Optimise);
+    }
+
+    m_timer.start(InitialDelay, this);
+}
+
+void DatabaseMaintenance::run(const DbConnectionProvider& dbProvider, const Jobs& jobs)
+{
+    TrackDatabase trackDatabase;
+    trackDatabase.initialise(dbProvider);
+
+    const QSqlDatabase db = dbProvider.db();
+
+    for(const Job job : jobs) {
+        QElapsedTimer timer;
+        timer.start();
+
+        int rows{0};
+        switch(job) {
+            case(Job::RemoveUnmanagedTracks):
+                rows = trackDatabase.removeUnmanagedTracks();
+                break;
+            case(Job::MarkUnusedStats):
+                rows = trackDatabase.markUnusedStatsForDelete();
+                break;
+            case(Job::DeleteExpiredStats):
+                rows = trackDatabase.deleteExpiredStats();
+                break;
+            case(Job::DeleteUnusedValues):
+                rows = trackDatabase.deleteUnusedValues();
+                break;
+            case(Job::IncrementalVacuum):
+                rows = incrementalVacuum(db);
+                break;
+            case(Job::EnableIncrementalVacuum):
+                rows = enableIncrementalVacuum(db);
+                break;
+            case(Job::Optimise):
+                rows = optimise(db);
+                break;
+        }
+
+        if(rows < 0) {
+            qWarning() << "[DB] Maintenance job failed:" << jobName(job);
+            continue;
+        }
+
+        // Vacuum jobs count pages rather than rows
+        qDebug() << "[DB]" << jobName(job) << "touched" << rows << "rows in" << timer.elapsed() << "ms";
+    }
+}
+
+void DatabaseMaintenance::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == m_timer.timerId()) {
+        // Held back idle work means the system is busy or playing on battery, so try again later
+        if(TaskScheduler::instance()->throttle() == TaskScheduler::Throttle::Paused) {
+            m_timer.start(DeferredDelay, this);
+        }
+        else {
+            m_timer.start(MaintenanceInterval, this);
+            runIdleJobs();
+        }
+    }
+    QObject::timerEvent(event);
+}
+
+void DatabaseMaintenance::runIdleJobs()
+{
+    if(m_running) {
+        return;
+    }
+
+    m_running = true;
+
+    m_executor
+        ->run(DbExecutor::Priority::Background,
+              [jobs = m_idleJobs](const DbConnectionProvider& dbProvider) { run(dbProvider, jobs); })
+        .then(this, [this]() { m_running = false; });
+}
+} // namespace Fooyin
+
+#include "moc_databasemaintenance.cpp"
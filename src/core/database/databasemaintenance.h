@@ -0,0 +1,79 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QBasicTimer>
+#include <QObject>
+
+#include <cstdint>
+#include <vector>
+
+namespace Fooyin {
+class DbConnectionProvider;
+class DbExecutor;
+class SettingsManager;
+
+/*!
+ * Runs housekeeping on fooyin's database in the background while the application is idle.
+ * Each job logs how long it took and how many rows it touched, so slow queries are easy to spot.
+ */
+class DatabaseMaintenance : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Job : uint8_t
+    {
+        // Deletes tracks outside of a library which no playlist references
+        RemoveUnmanagedTracks,
+        // Starts the expiry of stats for tracks no longer in the database
+        MarkUnusedStats,
+        DeleteExpiredStats,
+        // Deletes artists and genres which no track holds any more
+        DeleteUnusedValues,
+        // Returns free pages to the filesystem, if incremental auto-vacuum is enabled
+        IncrementalVacuum,
+        // Enables incremental auto-vacuum with a full VACUUM, once enough of the file is unused
+        EnableIncrementalVacuum,
+        // Updates the statistics used by the query planner
+        Optimise,
+    };
+    using Jobs = std::vector<Job>;
+
+    DatabaseMaintenance(DbExecutor* executor, SettingsManager* settings, QObject* parent = nullptr);
+
+    /*!
+     * Runs @p jobs in order using the calling thread's connection from @p dbProvider.
+     * @note blocks until all jobs have finished.
+     */
+    static void run(const DbConnectionProvider& dbProvider, const Jobs& jobs);
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    void runIdleJobs();
+
+    DbExecutor* m_executor;
+    Jobs m_idleJobs;
+    QBasicTimer m_timer;
+    bool m_running;
+};
+} // namespace Fooyin
@@ -227,7 +227,10 @@ DbSchema::Revision DbSchema::readRevision()
             revision.description = m_xmlReader.readElementText().trimmed();
         }
         else if(m_xmlReader.name() == u"sql") {
-            revision.sql = m_xmlReader.readElementText().trimmed();
+            revision.stages.push_back({.sql = m_xmlReader.readElementText().trimmed(), .step = {}});
+        }
+        else if(m_xmlReader.name() == u"step") {
+            revision.stages.push_back({.sql = {}, .step = m_xmlReader.readElementText().trimmed()});
         }
         else {
             m_xmlReader.skipCurrentElement();
@@ -245,7 +248,7 @@ DbSchema::UpgradeResult DbSchema::applyRevision(int currentRevision, int revisio
         revision.minCompatVersion = revisionToApply;
     }
 
-    if(revision.sql.isEmpty()) {
+    if(revision.stages.empty()) {
         return UpgradeResult::Error;
     }
 
@@ -253,7 +256,34 @@ DbSchema::UpgradeResult DbSchema::applyRevision(int currentRevision, int revisio
 
     DbTransaction transaction{db()};
 
-    const QStringList statements = revision.sql.split(QStringLiteral(";"));
+    for(const Stage& stage : revision.stages) {
+        const auto result = stage.step.isEmpty()
+                              ? (applyStatements(stage.sql) ? UpgradeResult::Success : UpgradeResult::Failed)
+                              : runStep(stage.step);
+        if(result != UpgradeResult::Success) {
+            transaction.rollback();
+            return result;
+        }
+    }
+
+    if(revisionToApply > currentRevision) {
+        m_settingsDb.set(QString::fromLatin1(VersionKey), revisionToApply);
+        m_settingsDb.set(QString::fromLatin1(LastVersionKey), revisionToApply);
+        m_settingsDb.set(QString::fromLatin1(MinCompatVersionKey), revision.minCompatVersion);
+        qInfo() << "[DB] Upgraded schema to version" << revisionToApply;
+    }
+    else {
+        qInfo() << "[DB] Reapplied schema migration to version" << revisionToApply;
+    }
+
+    transaction.commit();
+
+    return UpgradeResult::Success;
+}
+
+bool DbSchema::applyStatements(const QString& sql)
+{
+    const QStringList statements = sql.split(QStringLiteral(";"));
 
     bool result{false};
 
@@ -274,23 +304,25 @@ DbSchema::UpgradeResult DbSchema::applyRevision(int currentRevision, int revisio
         }
     }
 
-    if(!result) {
-        transaction.rollback();
-        return UpgradeResult::Failed;
-    }
+    return result;
+}
 
-    if(revisionToApply > currentRevision) {
-        m_settingsDb.set(QString::fromLatin1(VersionKey), revisionToApply);
-        m_settingsDb.set(QString::fromLatin1(LastVersionKey), revisionToApply);
-        m_settingsDb.set(QString::fromLatin1(MinCompatVersionKey), revision.minCompatVersion);
-        qInfo() << "[DB] Upgraded schema to version" << revisionToApply;
+DbSchema::UpgradeResult DbSchema::runStep(const QString& step)
+{
+    if(step == u"rehashTracks") {
+        return TrackDatabase::rehashTracks(db()) ? UpgradeResult::Success : UpgradeResult::Failed;
     }
-    else {
-        qInfo() << "[DB] Reapplied schema migration to version" << revisionToApply;
+    if(step == u"indexTrackValues") {
+        return TrackDatabase::indexTrackValues(db()) ? UpgradeResult::Success : UpgradeResult::Failed;
+    }
+    if(step == u"indexAlbums") {
+        return TrackDatabase::indexAlbums(db()) ? UpgradeResult::Success : UpgradeResult::Failed;
+    }
+    if(step == u"summariseAlbums") {
+        return TrackDatabase::summariseAlbums(db()) ? UpgradeResult::Success : UpgradeResult::Failed;
     }
 
-    transaction.commit();
-
-    return UpgradeResult::Success;
+    qCritical() << "[DB] Unknown schema migration step" << step;
+    return UpgradeResult::Error;
 }
 } // namespace Fooyin
@@ -23,6 +23,8 @@
 
 #include <QXmlStreamReader>
 
+#include <vector>
+
 namespace Fooyin {
 class SettingsManager;
 
@@ -48,17 +50,27 @@ public:
     UpgradeResult upgradeDatabase(int targetVersion, const QString& schemaFilename);
 
 private:
+    // Part of a revision: either SQL statements, or the name of a step run in code (see runStep)
+    struct Stage
+    {
+        QString sql;
+        QString step;
+    };
+
     struct Revision
     {
         int version{0};
         int minCompatVersion{0};
         QString description;
-        QString sql;
+        // Applied in order, within a single transaction
+        std::vector<Stage> stages;
     };
 
     bool readSchema(const QString& schemaFilename);
     Revision readRevision();
     UpgradeResult applyRevision(int currentRevision, int revisionToApply);
+    bool applyStatements(const QString& sql);
+    UpgradeResult runStep(const QString& step);
 
     SettingsDatabase m_settingsDb;
     QXmlStreamReader m_xmlReader;
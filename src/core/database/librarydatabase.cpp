@@ -20,6 +20,7 @@
 #include "librarydatabase.h"
 
 #include <utils/database/dbquery.h>
+#include <utils/database/dbtransaction.h>
 
 namespace Fooyin {
 bool LibraryDatabase::getAllLibraries(LibraryInfoMap& libraries)
@@ -93,4 +94,121 @@ bool LibraryDatabase::renameLibrary(int id, const QString& name)
 
     return query.exec();
 }
+
+bool LibraryDatabase::relocateLibrary(int id, const QString& oldPath, const QString& newPath)
+{
+    if(id < 0 || oldPath.isEmpty() || newPath.isEmpty()) {
+        return false;
+    }
+
+    DbTransaction transaction{db()};
+
+    if(!transaction) {
+        return false;
+    }
+
+    {
+        const QString statement = QStringLiteral("UPDATE Libraries SET Path = :path WHERE LibraryID = :id;");
+
+        DbQuery query{db(), statement};
+
+        query.bindValue(QStringLiteral(":path"), newPath);
+        query.bindValue(QStringLiteral(":id"), id);
+
+        if(!query.exec()) {
+            return false;
+        }
+    }
+
+    // Subdirectories sort between "root/" and "root0", which avoids escaping wildcards for LIKE
+    const QString statement
+        = QStringLiteral("UPDATE LibraryDirectories SET Path = :newPath || SUBSTR(Path, LENGTH(:oldPath) + 1) "
+                         "WHERE LibraryID = :id AND (Path = :root OR (Path >= :start AND Path < :end));");
+
+    DbQuery query{db(), statement};
+
+    query.bindValue(QStringLiteral(":newPath"), newPath);
+    query.bindValue(QStringLiteral(":oldPath"), oldPath);
+    query.bindValue(QStringLiteral(":id"), id);
+    query.bindValue(QStringLiteral(":root"), oldPath);
+    query.bindValue(QStringLiteral(":start"), QString{oldPath + u'/'});
+    query.bindValue(QStringLiteral(":end"), QString{oldPath + u'0'});
+
+    if(!query.exec()) {
+        return false;
+    }
+
+    return transaction.commit();
+}
+
+bool LibraryDatabase::getDirectories(int libraryId, LibraryDirectoryMap& directories)
+{
+    const QString statement
+        = QStringLiteral("SELECT Path, ModifiedTime, EntryCount FROM LibraryDirectories WHERE LibraryID = :id;");
+
+    DbQuery query{db(), statement};
+
+    query.bindValue(QStringLiteral(":id"), libraryId);
+
+    if(!query.exec()) {
+        return false;
+    }
+
+    while(query.next()) {
+        const QString path = query.value(0).toString();
+        const LibraryDirectory directory{query.value(1).toULongLong(), query.value(2).toInt()};
+
+        directories.emplace(path, directory);
+    }
+
+    return true;
+}
+
+bool LibraryDatabase::storeDirectories(int libraryId, const QString& root, const LibraryDirectoryMap& directories)
+{
+    if(libraryId < 0) {
+        return false;
+    }
+
+    DbTransaction transaction{db()};
+
+    if(!transaction) {
+        return false;
+    }
+
+    // Subdirectories sort between "root/" and "root0", which avoids escaping wildcards for LIKE
+    const QString deleteStatement
+        = QStringLiteral("DELETE FROM LibraryDirectories WHERE LibraryID = :id AND (Path = :root OR "
+                         "(Path >= :start AND Path < :end));");
+
+    DbQuery deleteQuery{db(), deleteStatement};
+
+    deleteQuery.bindValue(QStringLiteral(":id"), libraryId);
+    deleteQuery.bindValue(QStringLiteral(":root"), root);
+    deleteQuery.bindValue(QStringLiteral(":start"), QString{root + u'/'});
+    deleteQuery.bindValue(QStringLiteral(":end"), QString{root + u'0'});
+
+    if(!deleteQuery.exec()) {
+        return false;
+    }
+
+    const QString insertStatement
+        = QStringLiteral("INSERT INTO LibraryDirectories (LibraryID, Path, ModifiedTime, EntryCount) "
+                         "VALUES (:id, :path, :modifiedTime, :entryCount);");
+
+    DbQuery insertQuery{db(), insertStatement};
+
+    for(const auto& [path, directory] : directories) {
+        insertQuery.bindValue(QStringLiteral(":id"), libraryId);
+        insertQuery.bindValue(QStringLiteral(":path"), path);
+        insertQuery.bindValue(QStringLiteral(":modifiedTime"), static_cast<quint64>(directory.modifiedTime));
+        insertQuery.bindValue(QStringLiteral(":entryCount"), directory.entryCount);
+
+        if(!insertQuery.exec()) {
+            return false;
+        }
+    }
+
+    return transaction.commit();
+}
 } // namespace Fooyin
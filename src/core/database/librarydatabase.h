@@ -19,12 +19,29 @@
 
 #pragma once
 
+#include "fycore_export.h"
+
 #include "library/libraryinfo.h"
 
 #include <utils/database/dbmodule.h>
 
+#include <unordered_map>
+
 namespace Fooyin {
-class LibraryDatabase : public DbModule
+/*!
+ * The state of a library directory when it was last scanned.
+ * If neither value has changed, no entries have been added, removed or renamed since.
+ */
+struct LibraryDirectory
+{
+    uint64_t modifiedTime{0};
+    int entryCount{0};
+
+    bool operator==(const LibraryDirectory& other) const = default;
+};
+using LibraryDirectoryMap = std::unordered_map<QString, LibraryDirectory>;
+
+class FYCORE_EXPORT LibraryDatabase : public DbModule
 {
 public:
     bool getAllLibraries(LibraryInfoMap& libraries);
@@ -33,5 +50,11 @@ public:
 
     bool removeLibrary(int id);
     bool renameLibrary(int id, const QString& name);
+    /** Moves the library @p id and its stored directories from @p oldPath to @p newPath. */
+    bool relocateLibrary(int id, const QString& oldPath, const QString& newPath);
+
+    bool getDirectories(int libraryId, LibraryDirectoryMap& directories);
+    /** Replaces the stored directories of @p libraryId at or below @p root with @p directories. */
+    bool storeDirectories(int libraryId, const QString& root, const LibraryDirectoryMap& directories);
 };
 } // namespace Fooyin
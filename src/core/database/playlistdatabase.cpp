@@ -22,11 +22,46 @@
 #include <utils/database/dbquery.h>
 #include <utils/database/dbtransaction.h>
 
+#include <QtEndian>
+
+#include <set>
+
+namespace {
+// Track ids are stored as consecutive little endian 32-bit integers
+QByteArray encodeTrackIds(const std::vector<int>& trackIds)
+{
+    QByteArray data(static_cast<qsizetype>(trackIds.size() * sizeof(int32_t)), Qt::Uninitialized);
+    auto* out = reinterpret_cast<uchar*>(data.data());
+
+    for(const int id : trackIds) {
+        qToLittleEndian(static_cast<int32_t>(id), out);
+        out += sizeof(int32_t);
+    }
+
+    return data;
+}
+
+std::vector<int> decodeTrackIds(const QByteArray& data)
+{
+    const auto count = static_cast<size_t>(data.size()) / sizeof(int32_t);
+    const auto* in   = reinterpret_cast<const uchar*>(data.constData());
+
+    std::vector<int> trackIds;
+    trackIds.reserve(count);
+
+    for(size_t i{0}; i < count; ++i) {
+        trackIds.push_back(qFromLittleEndian<int32_t>(in + (i * sizeof(int32_t))));
+    }
+
+    return trackIds;
+}
+} // namespace
+
 namespace Fooyin {
 std::vector<PlaylistInfo> PlaylistDatabase::getAllPlaylists()
 {
-    const QString query
-        = QStringLiteral("SELECT PlaylistID, Name, PlaylistIndex FROM Playlists ORDER BY PlaylistIndex;");
+    const QString query = QStringLiteral(
+        "SELECT PlaylistID, Name, PlaylistIndex, TrackCount, Duration FROM Playlists ORDER BY PlaylistIndex;");
 
     DbQuery q{db(), query};
 
@@ -43,13 +78,18 @@ std::vector<PlaylistInfo> PlaylistDatabase::getAllPlaylists()
         playlist.name  = q.value(1).toString();
         playlist.index = q.value(2).toInt();
 
+        if(!q.value(3).isNull()) {
+            playlist.trackCount = q.value(3).toInt();
+            playlist.duration   = q.value(4).toULongLong();
+        }
+
         playlists.emplace_back(playlist);
     }
 
     return playlists;
 }
 
-TrackList PlaylistDatabase::getPlaylistTracks(const Playlist& playlist, const TrackIdMap& tracks)
+TrackList PlaylistDatabase::getPlaylistTracks(const Playlist& playlist, const TrackSnapshot& tracks)
 {
     return populatePlaylistTracks(playlist, tracks);
 }
@@ -138,38 +178,85 @@ bool PlaylistDatabase::renamePlaylist(int id, const QString& name)
     return query.exec();
 }
 
-bool PlaylistDatabase::insertPlaylistTrack(int playlistId, const Track& track, int index)
-{
-    const QString statement = QStringLiteral(
-        "INSERT INTO PlaylistTracks (PlaylistID, TrackID, TrackIndex) VALUES (:playlistId, :trackId, :index);");
-
-    DbQuery query{db(), statement};
-    query.bindValue(QStringLiteral(":playlistId"), playlistId);
-    query.bindValue(QStringLiteral(":trackId"), track.id());
-    query.bindValue(QStringLiteral(":index"), index);
-
-    return query.exec();
-}
-
 bool PlaylistDatabase::insertPlaylistTracks(int playlistId, const TrackList& tracks)
 {
     if(playlistId < 0) {
         return false;
     }
 
-    // Remove current playlist tracks
-    const auto statement = QStringLiteral("DELETE FROM PlaylistTracks WHERE PlaylistID = :id;");
+    std::vector<int> trackIds;
+    trackIds.reserve(tracks.size());
+    uint64_t duration{0};
+    for(const auto& track : tracks) {
+        if(track.isValid() && track.isInDatabase()) {
+            trackIds.push_back(track.id());
+            duration += track.duration();
+        }
+    }
+
+    const auto statement = QStringLiteral("UPDATE Playlists SET TrackIds = :trackIds, TrackCount = :count, "
+                                          "Duration = :duration WHERE PlaylistID = :id;");
 
     DbQuery query{db(), statement};
+    query.bindValue(QStringLiteral(":trackIds"), encodeTrackIds(trackIds));
+    query.bindValue(QStringLiteral(":count"), static_cast<int>(trackIds.size()));
+    query.bindValue(QStringLiteral(":duration"), QVariant::fromValue(duration));
     query.bindValue(QStringLiteral(":id"), playlistId);
 
     if(!query.exec()) {
         return false;
     }
 
-    for(int i{0}; const auto& track : tracks) {
-        if(track.isValid() && track.isInDatabase()) {
-            if(!insertPlaylistTrack(playlistId, track, i++)) {
+    return updatePlaylistReferences(playlistId, trackIds);
+}
+
+bool PlaylistDatabase::updatePlaylistReferences(int playlistId, const std::vector<int>& trackIds)
+{
+    // Unmanaged tracks are only kept while a playlist references them (see TrackDatabase::cleanupTracks)
+    const auto selectStatement = QStringLiteral("SELECT DISTINCT TrackID FROM PlaylistTracks WHERE PlaylistID = :id;");
+
+    DbQuery select{db(), selectStatement};
+    select.bindValue(QStringLiteral(":id"), playlistId);
+
+    if(!select.exec()) {
+        return false;
+    }
+
+    std::set<int> current;
+    while(select.next()) {
+        current.emplace(select.value(0).toInt());
+    }
+
+    const std::set<int> wanted{trackIds.cbegin(), trackIds.cend()};
+
+    const auto deleteStatement
+        = QStringLiteral("DELETE FROM PlaylistTracks WHERE PlaylistID = :playlistId AND TrackID = :trackId;");
+    const auto insertStatement = QStringLiteral(
+        "INSERT INTO PlaylistTracks (PlaylistID, TrackID, TrackIndex) VALUES (:playlistId, :trackId, 0);");
+
+    for(const int id : current) {
+        if(!wanted.contains(id)) {
+            DbQuery* remove = cachedQuery(deleteStatement);
+            if(!remove) {
+                return false;
+            }
+            remove->bindValue(QStringLiteral(":playlistId"), playlistId);
+            remove->bindValue(QStringLiteral(":trackId"), id);
+            if(!remove->exec()) {
+                return false;
+            }
+        }
+    }
+
+    for(const int id : wanted) {
+        if(!current.contains(id)) {
+            DbQuery* insert = cachedQuery(insertStatement);
+            if(!insert) {
+                return false;
+            }
+            insert->bindValue(QStringLiteral(":playlistId"), playlistId);
+            insert->bindValue(QStringLiteral(":trackId"), id);
+            if(!insert->exec()) {
                 return false;
             }
         }
@@ -178,27 +265,42 @@ bool PlaylistDatabase::insertPlaylistTracks(int playlistId, const TrackList& tra
     return true;
 }
 
-TrackList PlaylistDatabase::populatePlaylistTracks(const Playlist& playlist, const TrackIdMap& tracks)
+TrackList PlaylistDatabase::populatePlaylistTracks(const Playlist& playlist, const TrackSnapshot& tracks)
+{
+    const auto statement = QStringLiteral("SELECT TrackIds FROM Playlists WHERE PlaylistID = :playlistId;");
+
+    DbQuery query{db(), statement};
+    query.bindValue(QStringLiteral(":playlistId"), playlist.dbId());
+
+    if(!query.exec() || !query.next()) {
+        return {};
+    }
+
+    const QVariant data = query.value(0);
+    // Playlists which haven't been saved since the order moved to Playlists.TrackIds
+    const std::vector<int> trackIds
+        = data.isNull() ? legacyPlaylistTrackIds(playlist.dbId()) : decodeTrackIds(data.toByteArray());
+
+    return tracks.tracksForIds(trackIds);
+}
+
+std::vector<int> PlaylistDatabase::legacyPlaylistTrackIds(int playlistId) const
 {
     const auto statement
         = QStringLiteral("SELECT TrackID FROM PlaylistTracks WHERE PlaylistID=:playlistId ORDER BY TrackIndex;");
 
     DbQuery query{db(), statement};
-    query.bindValue(QStringLiteral(":playlistId"), playlist.dbId());
+    query.bindValue(QStringLiteral(":playlistId"), playlistId);
 
     if(!query.exec()) {
         return {};
     }
 
-    TrackList playlistTracks;
-
+    std::vector<int> trackIds;
     while(query.next()) {
-        const int trackId = query.value(0).toInt();
-        if(tracks.contains(trackId)) {
-            playlistTracks.push_back(tracks.at(trackId));
-        }
+        trackIds.push_back(query.value(0).toInt());
     }
 
-    return playlistTracks;
+    return trackIds;
 }
 } // namespace Fooyin
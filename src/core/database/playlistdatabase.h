@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <core/library/tracksnapshot.h>
 #include <core/playlist/playlist.h>
 #include <core/track.h>
 #include <utils/database/dbmodule.h>
@@ -29,13 +30,16 @@ struct PlaylistInfo
     int dbId{-1};
     QString name;
     int index{-1};
+    // -1 if not yet stored
+    int trackCount{-1};
+    uint64_t duration{0};
 };
 
 class PlaylistDatabase : public DbModule
 {
 public:
     std::vector<PlaylistInfo> getAllPlaylists();
-    TrackList getPlaylistTracks(const Playlist& playlist, const TrackIdMap& tracks);
+    TrackList getPlaylistTracks(const Playlist& playlist, const TrackSnapshot& tracks);
 
     int insertPlaylist(const QString& name, int index);
 
@@ -45,8 +49,13 @@ public:
     bool renamePlaylist(int id, const QString& name);
 
 private:
-    bool insertPlaylistTrack(int playlistId, const Fooyin::Track& track, int index);
+    /*!
+     * Stores the track ids of @p tracks in order, and updates the tracks referenced by the playlist
+     * by only adding and removing the ids which changed.
+     */
     bool insertPlaylistTracks(int playlistId, const TrackList& tracks);
-    TrackList populatePlaylistTracks(const Playlist& playlist, const TrackIdMap& tracks);
+    bool updatePlaylistReferences(int playlistId, const std::vector<int>& trackIds);
+    TrackList populatePlaylistTracks(const Playlist& playlist, const TrackSnapshot& tracks);
+    [[nodiscard]] std::vector<int> legacyPlaylistTrackIds(int playlistId) const;
 };
 } // namespace Fooyin
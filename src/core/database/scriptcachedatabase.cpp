@@ -0,0 +1,204 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scriptcachedatabase.h"
+
+#include "version.h"
+
+#include <utils/crypto.h>
+#include <utils/database/dbquery.h>
+#include <utils/database/dbtransaction.h>
+#include <utils/paths.h>
+
+#include <QDataStream>
+#include <QDateTime>
+
+constexpr auto DayMs = 24 * 60 * 60 * 1000LL;
+
+namespace {
+// SQLite integers are signed, so hashes are stored as their bit pattern
+QVariant hashValue(uint64_t hash)
+{
+    return QVariant::fromValue(static_cast<qint64>(hash));
+}
+
+QByteArray serialiseValues(const QStringList& values)
+{
+    QByteArray out;
+    QDataStream stream{&out, QDataStream::WriteOnly};
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << values;
+    return out;
+}
+
+QStringList deserialiseValues(const QByteArray& data)
+{
+    QDataStream stream{data};
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    QStringList values;
+    stream >> values;
+    return stream.status() == QDataStream::Ok ? values : QStringList{};
+}
+} // namespace
+
+namespace Fooyin {
+void ScriptCacheDatabase::initialiseDatabase() const
+{
+    const QStringList statements{QStringLiteral("CREATE TABLE IF NOT EXISTS Scripts ("
+                                                "ScriptHash INTEGER PRIMARY KEY, "
+                                                "LastUsed INTEGER);"),
+                                 QStringLiteral("CREATE TABLE IF NOT EXISTS ScriptValues ("
+                                                "ScriptHash INTEGER NOT NULL, "
+                                                "TrackID INTEGER NOT NULL, "
+                                                "ModifiedDate INTEGER NOT NULL, "
+                                                "Value BLOB, "
+                                                "PRIMARY KEY (ScriptHash, TrackID)) WITHOUT ROWID;"),
+                                 QStringLiteral("CREATE INDEX IF NOT EXISTS ScriptValuesTrackIndex "
+                                                "ON ScriptValues(TrackID);")};
+
+    for(const QString& statement : statements) {
+        DbQuery query{db(), statement};
+        query.exec();
+    }
+}
+
+ScriptCacheDatabase::ValueMap ScriptCacheDatabase::loadValues(uint64_t scriptHash) const
+{
+    DbQuery usedQuery{db(), QStringLiteral("INSERT OR REPLACE INTO Scripts (ScriptHash, LastUsed) "
+                                           "VALUES (:scriptHash, :lastUsed);")};
+
+    usedQuery.bindValue(QStringLiteral(":scriptHash"), hashValue(scriptHash));
+    usedQuery.bindValue(QStringLiteral(":lastUsed"), QDateTime::currentMSecsSinceEpoch());
+    usedQuery.exec();
+
+    DbQuery query{db(), QStringLiteral("SELECT TrackID, ModifiedDate, Value FROM ScriptValues "
+                                       "WHERE ScriptHash = :scriptHash;")};
+
+    query.bindValue(QStringLiteral(":scriptHash"), hashValue(scriptHash));
+
+    ValueMap values;
+
+    if(!query.exec()) {
+        return values;
+    }
+
+    while(query.next()) {
+        values.emplace(query.value(0).toInt(), StoredValues{.modifiedTime = query.value(1).toULongLong(),
+                                                            .values = deserialiseValues(query.value(2).toByteArray())});
+    }
+
+    return values;
+}
+
+bool ScriptCacheDatabase::storeValues(uint64_t scriptHash, const ValueMap& values) const
+{
+    if(values.empty()) {
+        return true;
+    }
+
+    DbTransaction transaction{db()};
+
+    if(!transaction) {
+        return false;
+    }
+
+    DbQuery usedQuery{db(), QStringLiteral("INSERT OR REPLACE INTO Scripts (ScriptHash, LastUsed) "
+                                           "VALUES (:scriptHash, :lastUsed);")};
+    DbQuery query{db(), QStringLiteral("INSERT OR REPLACE INTO ScriptValues (ScriptHash, TrackID, ModifiedDate, Value) "
+                                       "VALUES (:scriptHash, :trackId, :modifiedDate, :value);")};
+
+    usedQuery.bindValue(QStringLiteral(":scriptHash"), hashValue(scriptHash));
+    usedQuery.bindValue(QStringLiteral(":lastUsed"), QDateTime::currentMSecsSinceEpoch());
+    if(!usedQuery.exec()) {
+        return false;
+    }
+
+    for(const auto& [trackId, stored] : values) {
+        query.bindValue(QStringLiteral(":scriptHash"), hashValue(scriptHash));
+        query.bindValue(QStringLiteral(":trackId"), trackId);
+        query.bindValue(QStringLiteral(":modifiedDate"), QVariant::fromValue(stored.modifiedTime));
+        query.bindValue(QStringLiteral(":value"), serialiseValues(stored.values));
+
+        if(!query.exec()) {
+            return false;
+        }
+    }
+
+    return transaction.commit();
+}
+
+bool ScriptCacheDatabase::removeTracks(const std::vector<int>& trackIds) const
+{
+    if(trackIds.empty()) {
+        return true;
+    }
+
+    DbTransaction transaction{db()};
+
+    if(!transaction) {
+        return false;
+    }
+
+    DbQuery query{db(), QStringLiteral("DELETE FROM ScriptValues WHERE TrackID = :trackId;")};
+
+    for(const int trackId : trackIds) {
+        query.bindValue(QStringLiteral(":trackId"), trackId);
+        if(!query.exec()) {
+            return false;
+        }
+    }
+
+    return transaction.commit();
+}
+
+bool ScriptCacheDatabase::removeUnusedScripts(int days) const
+{
+    const QVariant cutoff = QDateTime::currentMSecsSinceEpoch() - (days * DayMs);
+
+    DbQuery valuesQuery{db(), QStringLiteral("DELETE FROM ScriptValues WHERE ScriptHash IN "
+                                             "(SELECT ScriptHash FROM Scripts WHERE LastUsed < :cutoff);")};
+    DbQuery scriptsQuery{db(), QStringLiteral("DELETE FROM Scripts WHERE LastUsed < :cutoff;")};
+
+    valuesQuery.bindValue(QStringLiteral(":cutoff"), cutoff);
+    scriptsQuery.bindValue(QStringLiteral(":cutoff"), cutoff);
+
+    return valuesQuery.exec() && scriptsQuery.exec();
+}
+
+bool ScriptCacheDatabase::clearCache() const
+{
+    DbQuery valuesQuery{db(), QStringLiteral("DELETE FROM ScriptValues;")};
+    DbQuery scriptsQuery{db(), QStringLiteral("DELETE FROM Scripts;")};
+    DbQuery cleanQuery{db(), QStringLiteral("VACUUM")};
+
+    return valuesQuery.exec() && scriptsQuery.exec() && cleanQuery.exec();
+}
+
+QString ScriptCacheDatabase::cachePath()
+{
+    return Utils::cachePath() + QStringLiteral("/scriptcache.db");
+}
+
+uint64_t ScriptCacheDatabase::scriptHash(const QString& script)
+{
+    const QByteArray key = QByteArray{VERSION} + '\037' + script.toUtf8();
+    return Utils::hash64(key.constData(), static_cast<size_t>(key.size()));
+}
+} // namespace Fooyin
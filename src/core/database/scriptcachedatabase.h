@@ -0,0 +1,63 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <utils/database/dbmodule.h>
+
+#include <QStringList>
+
+#include <unordered_map>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Persists the values of grouping scripts by script and track id, so views can be populated after a restart
+ * without evaluating the scripts again. Each value is held with the modification time of the track it was
+ * evaluated for, so those of tracks changed since are ignored.
+ * Lives in its own database in the cache directory, alongside other caches such as seek indexes.
+ */
+class ScriptCacheDatabase : public DbModule
+{
+public:
+    struct StoredValues
+    {
+        uint64_t modifiedTime{0};
+        QStringList values;
+    };
+    // Stored values by track id
+    using ValueMap = std::unordered_map<int, StoredValues>;
+
+    void initialiseDatabase() const;
+
+    /** Returns the values stored for the script with @p scriptHash, and marks the script as used. */
+    [[nodiscard]] ValueMap loadValues(uint64_t scriptHash) const;
+    /** Stores @p values for the script with @p scriptHash, replacing those held for the same tracks. */
+    bool storeValues(uint64_t scriptHash, const ValueMap& values) const;
+    /** Removes the values of every script for the tracks with @p trackIds. */
+    bool removeTracks(const std::vector<int>& trackIds) const;
+    /** Removes the values of scripts which haven't been used for @p days. */
+    bool removeUnusedScripts(int days) const;
+    [[nodiscard]] bool clearCache() const;
+
+    static QString cachePath();
+    /** Returns the key of @p script, which also changes with the version, as functions may behave differently. */
+    static uint64_t scriptHash(const QString& script);
+};
+} // namespace Fooyin
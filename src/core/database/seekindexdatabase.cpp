@@ -0,0 +1,152 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "seekindexdatabase.h"
+
+#include "engine/seekindex.h"
+
+#include <utils/crypto.h>
+#include <utils/database/dbquery.h>
+#include <utils/paths.h>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+
+namespace {
+using Fooyin::SeekIndex;
+
+QByteArray serialiseIndex(const SeekIndex& index)
+{
+    QByteArray out;
+    QDataStream stream{&out, QDataStream::WriteOnly};
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    const auto& points = index.points();
+    stream << static_cast<qint64>(points.size());
+
+    // Stored as deltas, which compress far better than absolute values
+    SeekIndex::Point last;
+    for(const auto& point : points) {
+        stream << static_cast<qint64>(point.timestamp - last.timestamp);
+        stream << static_cast<qint64>(point.pos - last.pos);
+        last = point;
+    }
+
+    return qCompress(out, 9);
+}
+
+bool deserialiseIndex(const QByteArray& data, SeekIndex& index)
+{
+    QByteArray in = qUncompress(data);
+    QDataStream stream{&in, QDataStream::ReadOnly};
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    qint64 size{0};
+    stream >> size;
+    if(size <= 0) {
+        return false;
+    }
+
+    std::vector<SeekIndex::Point> points;
+    points.reserve(static_cast<size_t>(size));
+
+    SeekIndex::Point last;
+    while(size > 0 && stream.status() == QDataStream::Ok) {
+        --size;
+
+        qint64 timestamp{0};
+        qint64 pos{0};
+        stream >> timestamp >> pos;
+
+        last.timestamp += timestamp;
+        last.pos += pos;
+        points.push_back(last);
+    }
+
+    if(stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    index.setPoints(std::move(points));
+    return true;
+}
+} // namespace
+
+namespace Fooyin {
+void SeekIndexDatabase::initialiseDatabase() const
+{
+    const auto statement = QStringLiteral("CREATE TABLE IF NOT EXISTS SeekIndex ("
+                                          "TrackKey TEXT PRIMARY KEY, "
+                                          "Data BLOB);");
+
+    DbQuery query{db(), statement};
+    query.exec();
+}
+
+bool SeekIndexDatabase::loadIndex(const QString& key, SeekIndex& index) const
+{
+    const auto statement = QStringLiteral("SELECT Data FROM SeekIndex WHERE TrackKey = :trackKey;");
+
+    DbQuery query{db(), statement};
+
+    query.bindValue(QStringLiteral(":trackKey"), key);
+
+    if(query.exec() && query.next()) {
+        return deserialiseIndex(query.value(0).toByteArray(), index);
+    }
+
+    return false;
+}
+
+bool SeekIndexDatabase::storeIndex(const QString& key, const SeekIndex& index) const
+{
+    const auto statement
+        = QStringLiteral("INSERT OR REPLACE INTO SeekIndex (TrackKey, Data) VALUES (:trackKey, :data);");
+
+    DbQuery query{db(), statement};
+
+    query.bindValue(QStringLiteral(":trackKey"), key);
+    query.bindValue(QStringLiteral(":data"), serialiseIndex(index));
+
+    return query.exec();
+}
+
+bool SeekIndexDatabase::clearCache() const
+{
+    const auto statement = QStringLiteral("DELETE FROM SeekIndex;");
+
+    DbQuery query{db(), statement};
+    DbQuery cleanQuery{db(), QStringLiteral("VACUUM")};
+
+    return query.exec() && cleanQuery.exec();
+}
+
+QString SeekIndexDatabase::cachePath()
+{
+    return Utils::cachePath() + QStringLiteral("/seekindex.db");
+}
+
+QString SeekIndexDatabase::cacheKey(const QString& filepath)
+{
+    const QFileInfo info{filepath};
+    return Utils::generateHash(filepath, QString::number(info.size()),
+                               QString::number(info.lastModified().toMSecsSinceEpoch()));
+}
+} // namespace Fooyin
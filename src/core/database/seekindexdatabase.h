@@ -0,0 +1,43 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <utils/database/dbmodule.h>
+
+namespace Fooyin {
+class SeekIndex;
+
+/*!
+ * Persists decoder seek indexes, keyed on the file's path, size and modification time.
+ * Lives in its own database in the cache directory, alongside other caches such as waveforms.
+ */
+class SeekIndexDatabase : public DbModule
+{
+public:
+    void initialiseDatabase() const;
+
+    [[nodiscard]] bool loadIndex(const QString& key, SeekIndex& index) const;
+    [[nodiscard]] bool storeIndex(const QString& key, const SeekIndex& index) const;
+    [[nodiscard]] bool clearCache() const;
+
+    static QString cachePath();
+    static QString cacheKey(const QString& filepath);
+};
+} // namespace Fooyin
@@ -24,13 +24,19 @@
 #include <utils/database/dbquery.h>
 #include <utils/database/dbtransaction.h>
 #include <utils/fileutils.h>
+#include <utils/tracing.h>
 
 #include <QFileInfo>
 
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <utility>
+
 using BindingsMap = std::map<QString, QVariant>;
 
 namespace {
-QString fetchTrackColumns()
+QString fetchTrackColumns(Fooyin::TrackDatabase::Projection projection = Fooyin::TrackDatabase::Projection::Full)
 {
     static const QString columns = QStringLiteral("TrackID,"
                                                   "FilePath,"
@@ -63,9 +69,28 @@ QString fetchTrackColumns()
                                                   "FirstPlayed,"
                                                   "LastPlayed,"
                                                   "PlayCount,"
-                                                  "Rating");
+                                                  "Rating,"
+                                                  "CuePath,"
+                                                  "Offset,"
+                                                  "AlbumID");
+
+    // Skipped columns are replaced with NULL so the indexes read by readToTrack stay the same
+    static const QString lightColumns = QString{columns}
+                                            .replace(QStringLiteral("Comment,"), QStringLiteral("NULL,"))
+                                            .replace(QStringLiteral("ExtraTags,"), QStringLiteral("NULL,"));
+
+    return projection == Fooyin::TrackDatabase::Projection::Light ? lightColumns : columns;
+}
+
+// SQLite integers are signed, so hashes are stored as their bit pattern
+QVariant hashValue(uint64_t hash)
+{
+    return QVariant::fromValue(static_cast<qint64>(hash));
+}
 
-    return columns;
+uint64_t readHash(const QVariant& value)
+{
+    return static_cast<uint64_t>(value.toLongLong());
 }
 
 BindingsMap trackBindings(const Fooyin::Track& track)
@@ -93,11 +118,251 @@ BindingsMap trackBindings(const Fooyin::Track& track)
             {QStringLiteral(":extraTags"), track.serialiseExtrasTags()},
             {QStringLiteral(":type"), static_cast<int>(track.type())},
             {QStringLiteral(":modifiedDate"), QVariant::fromValue(track.modifiedTime())},
-            {QStringLiteral(":trackHash"), track.hash()},
-            {QStringLiteral(":libraryID"), track.libraryId()}};
+            {QStringLiteral(":trackHash"), hashValue(track.hash())},
+            {QStringLiteral(":libraryID"), track.libraryId()},
+            {QStringLiteral(":cuePath"), track.cuePath()},
+            {QStringLiteral(":offset"), QVariant::fromValue(track.offset())}};
+}
+
+// Column and placeholder for each value bound by trackBindings
+constexpr std::array InsertColumns{
+    std::pair{"FilePath", ":filePath"},         std::pair{"Title", ":title"},
+    std::pair{"TrackNumber", ":trackNumber"},   std::pair{"TrackTotal", ":trackTotal"},
+    std::pair{"Artists", ":artists"},           std::pair{"AlbumArtist", ":albumArtist"},
+    std::pair{"Album", ":album"},               std::pair{"DiscNumber", ":discNumber"},
+    std::pair{"DiscTotal", ":discTotal"},       std::pair{"Date", ":date"},
+    std::pair{"Composer", ":composer"},         std::pair{"Performer", ":performer"},
+    std::pair{"Genres", ":genres"},             std::pair{"Comment", ":comment"},
+    std::pair{"Duration", ":duration"},         std::pair{"FileSize", ":fileSize"},
+    std::pair{"BitRate", ":bitRate"},           std::pair{"SampleRate", ":sampleRate"},
+    std::pair{"Channels", ":channels"},         std::pair{"BitDepth", ":bitDepth"},
+    std::pair{"ExtraTags", ":extraTags"},       std::pair{"Type", ":type"},
+    std::pair{"ModifiedDate", ":modifiedDate"}, std::pair{"TrackHash", ":trackHash"},
+    std::pair{"LibraryID", ":libraryID"},       std::pair{"CuePath", ":cuePath"},
+    std::pair{"Offset", ":offset"}};
+
+constexpr std::array StatsPlaceholders{":trackHash", ":addedDate", ":firstPlayed", ":lastPlayed", ":playCount",
+                                       ":rating"};
+
+// Placeholders are suffixed with the row number, e.g. (:filePath0, :title0), (:filePath1, :title1)
+template <size_t N>
+QString valueRows(const std::array<const char*, N>& placeholders, size_t rows)
+{
+    QStringList values;
+    for(size_t row{0}; row < rows; ++row) {
+        QStringList rowValues;
+        for(const char* placeholder : placeholders) {
+            rowValues.append(QLatin1String{placeholder} + QString::number(row));
+        }
+        values.append(QStringLiteral("(%1)").arg(rowValues.join(u',')));
+    }
+    return values.join(u',');
+}
+
+QString insertStatement(size_t rows)
+{
+    std::array<const char*, InsertColumns.size()> placeholders{};
+    QStringList columns;
+    for(size_t i{0}; i < InsertColumns.size(); ++i) {
+        columns.append(QLatin1String{InsertColumns.at(i).first});
+        placeholders.at(i) = InsertColumns.at(i).second;
+    }
+
+    return QStringLiteral("INSERT INTO Tracks (%1) VALUES %2 RETURNING TrackID, FilePath, CuePath, Offset;")
+        .arg(columns.join(u','), valueRows(placeholders, rows));
+}
+
+/*!
+ * Merges stats into any existing row: the earliest added and first played times,
+ * the latest last played time and highest play count are kept, and the rating is replaced.
+ */
+QString statsStatement(size_t rows)
+{
+    return QStringLiteral(
+               "INSERT INTO TrackStats (TrackHash, AddedDate, FirstPlayed, LastPlayed, PlayCount, Rating) VALUES %1 "
+               "ON CONFLICT(TrackHash) DO UPDATE SET "
+               "AddedDate = CASE WHEN IFNULL(AddedDate, 0) = 0 OR (excluded.AddedDate > 0 AND excluded.AddedDate < "
+               "AddedDate) THEN excluded.AddedDate ELSE AddedDate END, "
+               "FirstPlayed = CASE WHEN IFNULL(FirstPlayed, 0) = 0 OR (excluded.FirstPlayed > 0 AND "
+               "excluded.FirstPlayed < FirstPlayed) THEN excluded.FirstPlayed ELSE FirstPlayed END, "
+               "LastPlayed = MAX(IFNULL(LastPlayed, 0), excluded.LastPlayed), "
+               "PlayCount = MAX(IFNULL(PlayCount, 0), excluded.PlayCount), "
+               "Rating = excluded.Rating;")
+        .arg(valueRows(StatsPlaceholders, rows));
+}
+
+// Identifies an inserted row, as several CUE sheet tracks can share a file
+QString insertedKey(const QString& filepath, const QString& cuePath, uint64_t offset)
+{
+    return filepath + u'|' + cuePath + u'|' + QString::number(offset);
+}
+
+// Artists and album artists share the Artists table, and are told apart by their role in TrackArtists
+enum class ArtistRole : uint8_t
+{
+    Artist = 0,
+    AlbumArtist,
+};
+
+/*!
+ * Returns a statement recomputing the totals of the albums matching @p condition from their tracks.
+ * The format is the file extension held by most of an album's tracks, taken from the file name alone,
+ * so files without one (or in a directory with a '.' in its name) don't count towards it.
+ */
+QString summariseAlbumsStatement(const QString& condition)
+{
+    return QStringLiteral("UPDATE Albums SET "
+                          "TrackCount = (SELECT COUNT(*) FROM Tracks WHERE Tracks.AlbumID = Albums.AlbumID),"
+                          "Duration = (SELECT COALESCE(SUM(Tracks.Duration), 0) FROM Tracks "
+                          "WHERE Tracks.AlbumID = Albums.AlbumID),"
+                          "Format = (SELECT LOWER(SUBSTR(FileName, LENGTH(RTRIM(FileName, REPLACE(FileName, '.', ''))) "
+                          "+ 1)) AS Extension FROM (SELECT SUBSTR(FilePath, LENGTH(RTRIM(FilePath, "
+                          "REPLACE(FilePath, '/', ''))) + 1) AS FileName FROM Tracks WHERE Tracks.AlbumID = "
+                          "Albums.AlbumID) WHERE INSTR(FileName, '.') > 0 "
+                          "GROUP BY Extension ORDER BY COUNT(*) DESC, Extension LIMIT 1) "
+                          "WHERE %1")
+        .arg(condition);
+}
+
+// The values of a multi-value field to link, each held once
+QStringList uniqueValues(QStringList values)
+{
+    values.removeAll(QString{});
+    values.removeDuplicates();
+    return values;
 }
 
-Fooyin::Track readToTrack(const Fooyin::DbQuery& q)
+/*!
+ * Writes the artists, album artists, genres and album of tracks to the normalised value tables,
+ * which list each distinct value once and link it to the tracks holding it.
+ * Value ids are remembered, so each distinct value is only looked up once per writer.
+ */
+class ValueWriter
+{
+public:
+    explicit ValueWriter(const QSqlDatabase& db)
+        : m_clearArtists{db, QStringLiteral("DELETE FROM TrackArtists WHERE TrackID = :trackId;")}
+        , m_clearGenres{db, QStringLiteral("DELETE FROM TrackGenres WHERE TrackID = :trackId;")}
+        , m_addArtist{db, QStringLiteral("INSERT OR IGNORE INTO Artists (Name) VALUES (:name);")}
+        , m_addGenre{db, QStringLiteral("INSERT OR IGNORE INTO Genres (Name) VALUES (:name);")}
+        , m_findArtist{db, QStringLiteral("SELECT ArtistID FROM Artists WHERE Name = :name;")}
+        , m_findGenre{db, QStringLiteral("SELECT GenreID FROM Genres WHERE Name = :name;")}
+        , m_linkArtist{db, QStringLiteral("INSERT OR IGNORE INTO TrackArtists (ArtistID, Role, TrackID) "
+                                          "VALUES (:valueId, :role, :trackId);")}
+        , m_linkGenre{db, QStringLiteral("INSERT OR IGNORE INTO TrackGenres (GenreID, TrackID) "
+                                         "VALUES (:valueId, :trackId);")}
+        , m_addAlbum{db, QStringLiteral("INSERT OR IGNORE INTO Albums (AlbumKey) VALUES (:name);")}
+        , m_findAlbum{db, QStringLiteral("SELECT AlbumID FROM Albums WHERE AlbumKey = :name;")}
+        , m_linkAlbum{db, QStringLiteral("UPDATE Tracks SET AlbumID = :valueId WHERE TrackID = :trackId;")}
+    { }
+
+    /*!
+     * Links the track with @p trackId to its values.
+     * @param replace whether the track may already have values, which are removed first
+     */
+    bool write(int trackId, const QStringList& artists, const QStringList& albumArtists, const QStringList& genres,
+               bool replace)
+    {
+        if(replace) {
+            m_clearArtists.bindValue(QStringLiteral(":trackId"), trackId);
+            m_clearGenres.bindValue(QStringLiteral(":trackId"), trackId);
+            if(!m_clearArtists.exec() || !m_clearGenres.exec()) {
+                return false;
+            }
+        }
+
+        auto linkArtists = [this, trackId](const QStringList& names, ArtistRole role) {
+            return std::ranges::all_of(names, [this, trackId, role](const QString& name) {
+                const int artistId = valueId(name, m_addArtist, m_findArtist, m_artistIds);
+                if(artistId < 0) {
+                    return false;
+                }
+                m_linkArtist.bindValue(QStringLiteral(":valueId"), artistId);
+                m_linkArtist.bindValue(QStringLiteral(":role"), static_cast<int>(role));
+                m_linkArtist.bindValue(QStringLiteral(":trackId"), trackId);
+                return m_linkArtist.exec();
+            });
+        };
+
+        auto linkGenres = [this, trackId](const QStringList& names) {
+            return std::ranges::all_of(names, [this, trackId](const QString& name) {
+                const int genreId = valueId(name, m_addGenre, m_findGenre, m_genreIds);
+                if(genreId < 0) {
+                    return false;
+                }
+                m_linkGenre.bindValue(QStringLiteral(":valueId"), genreId);
+                m_linkGenre.bindValue(QStringLiteral(":trackId"), trackId);
+                return m_linkGenre.exec();
+            });
+        };
+
+        return linkArtists(artists, ArtistRole::Artist) && linkArtists(albumArtists, ArtistRole::AlbumArtist)
+            && linkGenres(genres);
+    }
+
+    /** Links the track with @p trackId to the album identified by @p albumKey, returning its id or -1 on error. */
+    int writeAlbum(int trackId, const QString& albumKey)
+    {
+        const int albumId = valueId(albumKey, m_addAlbum, m_findAlbum, m_albumIds);
+        if(albumId < 0) {
+            return -1;
+        }
+
+        m_linkAlbum.bindValue(QStringLiteral(":valueId"), albumId);
+        m_linkAlbum.bindValue(QStringLiteral(":trackId"), trackId);
+        return m_linkAlbum.exec() ? albumId : -1;
+    }
+
+    bool write(Fooyin::Track& track, bool replace)
+    {
+        if(!write(track.id(), uniqueValues(track.artists()), uniqueValues(track.albumArtists()),
+                  uniqueValues(track.genres()), replace)) {
+            return false;
+        }
+
+        const int albumId = writeAlbum(track.id(), track.albumHash());
+        track.setAlbumId(albumId);
+        return albumId >= 0;
+    }
+
+private:
+    // Returns the id of @p name, adding it to its table if it's new, or -1 on error
+    static int valueId(const QString& name, Fooyin::DbQuery& add, Fooyin::DbQuery& find,
+                       std::unordered_map<QString, int>& ids)
+    {
+        if(const auto idIt = ids.find(name); idIt != ids.cend()) {
+            return idIt->second;
+        }
+
+        add.bindValue(QStringLiteral(":name"), name);
+        find.bindValue(QStringLiteral(":name"), name);
+        if(!add.exec() || !find.exec() || !find.next()) {
+            return -1;
+        }
+
+        const int id = find.value(0).toInt();
+        ids.emplace(name, id);
+        return id;
+    }
+
+    Fooyin::DbQuery m_clearArtists;
+    Fooyin::DbQuery m_clearGenres;
+    Fooyin::DbQuery m_addArtist;
+    Fooyin::DbQuery m_addGenre;
+    Fooyin::DbQuery m_findArtist;
+    Fooyin::DbQuery m_findGenre;
+    Fooyin::DbQuery m_linkArtist;
+    Fooyin::DbQuery m_linkGenre;
+    Fooyin::DbQuery m_addAlbum;
+    Fooyin::DbQuery m_findAlbum;
+    Fooyin::DbQuery m_linkAlbum;
+    std::unordered_map<QString, int> m_artistIds;
+    std::unordered_map<QString, int> m_genreIds;
+    std::unordered_map<QString, int> m_albumIds;
+};
+
+Fooyin::Track readToTrack(const Fooyin::DbQuery& q,
+                          Fooyin::TrackDatabase::Projection projection = Fooyin::TrackDatabase::Projection::Full)
 {
     Fooyin::Track track;
 
@@ -127,15 +392,23 @@ Fooyin::Track readToTrack(const Fooyin::DbQuery& q)
     track.setType(static_cast<Fooyin::Track::Type>(q.value(23).toInt()));
     track.setModifiedTime(q.value(24).toULongLong());
     track.setLibraryId(q.value(25).toInt());
-    track.setHash(q.value(26).toString());
+    track.setHash(readHash(q.value(26)));
     track.setAddedTime(q.value(27).toULongLong());
     track.setFirstPlayed(q.value(28).toULongLong());
     track.setLastPlayed(q.value(29).toULongLong());
     track.setPlayCount(q.value(30).toInt());
     track.setRating(q.value(31).toFloat());
+    track.setCuePath(q.value(32).toString());
+    track.setOffset(q.value(33).toULongLong());
+    // Set last, as setting the album's fields resets it
+    track.setAlbumId(q.value(34).isNull() ? -1 : q.value(34).toInt());
 
-    track.generateHash();
-    track.setIsEnabled(QFileInfo::exists(track.filepath()));
+    if(track.hash() == 0) {
+        track.generateHash();
+    }
+    if(projection == Fooyin::TrackDatabase::Projection::Full) {
+        track.setIsEnabled(QFileInfo::exists(track.isInArchive() ? track.archivePath() : track.filepath()));
+    }
 
     return track;
 }
@@ -144,6 +417,7 @@ Fooyin::Track readToTrack(const Fooyin::DbQuery& q)
 namespace Fooyin {
 bool TrackDatabase::storeTracks(TrackList& tracks)
 {
+    FY_TRACE_SCOPE("TrackDatabase::storeTracks");
     if(tracks.empty()) {
         return true;
     }
@@ -154,18 +428,31 @@ bool TrackDatabase::storeTracks(TrackList& tracks)
         return false;
     }
 
+    std::vector<Track*> newTracks;
+    std::vector<Track*> updatedTracks;
+
     for(auto& track : tracks) {
         if(track.id() >= 0) {
-            updateTrack(track);
+            if(updateTrackRow(track)) {
+                updatedTracks.push_back(&track);
+            }
         }
         else {
-            insertTrack(track);
+            newTracks.push_back(&track);
         }
     }
 
+    insertTracks(newTracks);
+    writeValues(updatedTracks, true);
+
     return transaction.commit();
 }
 
+void TrackDatabase::setBatchSize(int size)
+{
+    m_batchSize = std::clamp(size, 1, MaxVariables / static_cast<int>(InsertColumns.size()));
+}
+
 bool TrackDatabase::reloadTrack(Track& track) const
 {
     const auto statement
@@ -188,6 +475,7 @@ bool TrackDatabase::reloadTrack(Track& track) const
 
 bool TrackDatabase::reloadTracks(TrackList& tracks) const
 {
+    FY_TRACE_SCOPE("TrackDatabase::reloadTracks");
     const auto statement
         = QStringLiteral("SELECT %1 FROM TracksView WHERE TrackID IN (:trackIds);").arg(fetchTrackColumns());
 
@@ -214,6 +502,7 @@ bool TrackDatabase::reloadTracks(TrackList& tracks) const
 
 TrackList TrackDatabase::getAllTracks() const
 {
+    FY_TRACE_SCOPE("TrackDatabase::getAllTracks");
     const auto statement = QStringLiteral("SELECT %1 FROM TracksView").arg(fetchTrackColumns());
 
     DbQuery q{db(), statement};
@@ -236,14 +525,98 @@ TrackList TrackDatabase::getAllTracks() const
     return tracks;
 }
 
-TrackList TrackDatabase::tracksByHash(const QString& hash) const
+TrackDatabase::Cursor TrackDatabase::cursor(Projection projection, int pageSize) const
+{
+    return Cursor{this, projection, pageSize};
+}
+
+TrackDatabase::Cursor::Cursor(const TrackDatabase* database, Projection projection, int pageSize)
+    : m_database{database}
+    , m_projection{projection}
+    , m_pageSize{std::max(pageSize, 1)}
+    , m_lastId{-1}
+    , m_atEnd{false}
+{ }
+
+TrackList TrackDatabase::Cursor::nextPage()
+{
+    if(m_atEnd) {
+        return {};
+    }
+
+    TrackList tracks = m_database->tracksAfter(m_lastId, m_pageSize, m_projection);
+
+    m_atEnd = std::cmp_less(tracks.size(), m_pageSize);
+    if(!tracks.empty()) {
+        m_lastId = tracks.back().id();
+    }
+
+    return tracks;
+}
+
+bool TrackDatabase::Cursor::atEnd() const
+{
+    return m_atEnd;
+}
+
+TrackList TrackDatabase::tracksByHash(uint64_t hash) const
 {
     const auto statement
         = QStringLiteral("SELECT %1 FROM TracksView WHERE TrackHash = :trackHash").arg(fetchTrackColumns());
 
     DbQuery q{db(), statement};
 
-    q.bindValue(QStringLiteral(":trackHash"), hash);
+    q.bindValue(QStringLiteral(":trackHash"), hashValue(hash));
+
+    TrackList tracks;
+
+    if(!q.exec()) {
+        return tracks;
+    }
+
+    while(q.next()) {
+        tracks.emplace_back(readToTrack(q));
+    }
+
+    return tracks;
+}
+
+TrackList TrackDatabase::tracksByArtist(const QString& artist, bool albumArtist) const
+{
+    const auto statement
+        = QStringLiteral("SELECT %1 FROM TracksView WHERE TrackID IN (SELECT TrackID FROM TrackArtists "
+                         "WHERE ArtistID = (SELECT ArtistID FROM Artists WHERE Name = :name) AND Role = :role);")
+              .arg(fetchTrackColumns());
+
+    DbQuery q{db(), statement};
+
+    q.bindValue(QStringLiteral(":name"), artist);
+    const auto role = albumArtist ? ArtistRole::AlbumArtist : ArtistRole::Artist;
+    q.bindValue(QStringLiteral(":role"), static_cast<int>(role));
+
+    TrackList tracks;
+
+    if(!q.exec()) {
+        return tracks;
+    }
+
+    while(q.next()) {
+        tracks.emplace_back(readToTrack(q));
+    }
+
+    return tracks;
+}
+
+TrackList TrackDatabase::tracksByGenre(const QString& genre) const
+{
+    const auto statement
+        = QStringLiteral("SELECT %1 FROM TracksView WHERE TrackID IN (SELECT TrackID FROM TrackGenres "
+                         "WHERE GenreID = (SELECT GenreID FROM Genres WHERE Name = :name));")
+              .arg(fetchTrackColumns());
+
+    DbQuery q{db(), statement};
+
+    q.bindValue(QStringLiteral(":name"), genre);
 
     TrackList tracks;
 
@@ -258,7 +631,12 @@ TrackList TrackDatabase::tracksByHash(const QString& hash) const
     return tracks;
 }
 
-bool TrackDatabase::updateTrack(const Track& track)
+bool TrackDatabase::updateTrack(Track& track)
+{
+    return updateTrackRow(track) && writeValues({&track}, true);
+}
+
+bool TrackDatabase::updateTrackRow(const Track& track)
 {
     if(track.id() < 0) {
         qDebug() << QStringLiteral("Cannot update track %1 (Invalid ID)").arg(track.filepath());
@@ -290,29 +668,121 @@ bool TrackDatabase::updateTrack(const Track& track)
                                           "Type = :type,"
                                           "ModifiedDate = :modifiedDate,"
                                           "TrackHash = :trackHash,"
-                                          "LibraryID = :libraryID"
+                                          "LibraryID = :libraryID,"
+                                          "CuePath = :cuePath,"
+                                          "Offset = :offset"
                                           " WHERE TrackID = :trackId;");
 
-    DbQuery query{db(), statement};
+    DbQuery* query = cachedQuery(statement);
+    if(!query) {
+        return false;
+    }
 
-    query.bindValue(QStringLiteral(":trackId"), track.id());
+    query->bindValue(QStringLiteral(":trackId"), track.id());
 
     const auto bindings = trackBindings(track);
     for(const auto& [name, value] : bindings) {
-        query.bindValue(name, value);
+        query->bindValue(name, value);
     }
 
-    return query.exec();
+    return query->exec();
 }
 
-bool TrackDatabase::updateTrackStats(const TrackList& tracks)
+bool TrackDatabase::updateTracks(TrackList& tracks)
 {
-    bool success{true};
+    FY_TRACE_SCOPE("TrackDatabase::updateTracks");
+    DbTransaction transaction{db()};
 
+    if(!transaction) {
+        return false;
+    }
+
+    const bool success = std::ranges::all_of(tracks, [this](const Track& track) { return updateTrackRow(track); });
+    if(!success) {
+        return false;
+    }
+
+    std::vector<Track*> updatedTracks;
+    updatedTracks.reserve(tracks.size());
+    std::ranges::transform(tracks, std::back_inserter(updatedTracks), [](Track& track) { return &track; });
+
+    return writeValues(updatedTracks, true) && transaction.commit();
+}
+
+bool TrackDatabase::updateTrackPaths(const TrackList& tracks)
+{
     DbTransaction transaction{db()};
 
+    if(!transaction) {
+        return false;
+    }
+
+    const auto statement
+        = QStringLiteral("UPDATE Tracks SET FilePath = :filePath, LibraryID = :libraryID WHERE TrackID = :trackId;");
+
+    DbQuery* query = cachedQuery(statement);
+    if(!query) {
+        return false;
+    }
+
     for(const Track& track : tracks) {
-        if(!insertOrUpdateStats(track)) {
+        if(track.id() < 0) {
+            continue;
+        }
+
+        query->bindValue(QStringLiteral(":filePath"), Utils::File::cleanPath(track.filepath()));
+        query->bindValue(QStringLiteral(":libraryID"), track.libraryId());
+        query->bindValue(QStringLiteral(":trackId"), track.id());
+
+        if(!query->exec()) {
+            return false;
+        }
+    }
+
+    return transaction.commit();
+}
+
+bool TrackDatabase::updateTrackStats(const TrackList& tracks)
+{
+    FY_TRACE_SCOPE("TrackDatabase::updateTrackStats");
+    DbTransaction transaction{db()};
+
+    std::vector<const Track*> statsTracks;
+    statsTracks.reserve(tracks.size());
+    std::ranges::transform(tracks, std::back_inserter(statsTracks), [](const Track& track) { return &track; });
+
+    const bool success = insertOrUpdateStats(statsTracks);
+
+    return success && transaction.commit();
+}
+
+bool TrackDatabase::storeFingerprints(const TrackFingerprintMap& fingerprints)
+{
+    if(fingerprints.empty()) {
+        return true;
+    }
+
+    DbTransaction transaction{db()};
+
+    const auto statement = QStringLiteral("INSERT OR REPLACE INTO TrackFingerprints (TrackID, Fingerprint) "
+                                          "VALUES (:trackId, :fingerprint);");
+
+    DbQuery* query = cachedQuery(statement);
+    if(!query) {
+        return false;
+    }
+
+    bool success{true};
+
+    for(const auto& [trackId, fingerprint] : fingerprints) {
+        if(fingerprint.empty()) {
+            continue;
+        }
+
+        query->bindValue(QStringLiteral(":trackId"), trackId);
+        query->bindValue(QStringLiteral(":fingerprint"), AudioFingerprinter::serialise(fingerprint));
+
+        if(!query->exec()) {
             success = false;
         }
     }
@@ -320,6 +790,38 @@ bool TrackDatabase::updateTrackStats(const TrackList& tracks)
     return success && transaction.commit();
 }
 
+TrackFingerprintMap TrackDatabase::fingerprints(const std::vector<int>& trackIds) const
+{
+    if(trackIds.empty()) {
+        return {};
+    }
+
+    const auto statement
+        = QStringLiteral("SELECT TrackID, Fingerprint FROM TrackFingerprints WHERE TrackID IN (:trackIds);");
+
+    DbQuery q{db(), statement};
+
+    QStringList ids;
+    std::ranges::transform(trackIds, std::back_inserter(ids), [](int id) { return QString::number(id); });
+
+    q.bindValue(QStringLiteral(":trackIds"), ids);
+
+    if(!q.exec()) {
+        return {};
+    }
+
+    TrackFingerprintMap fingerprints;
+
+    while(q.next()) {
+        auto fingerprint = AudioFingerprinter::deserialise(q.value(1).toByteArray());
+        if(!fingerprint.empty()) {
+            fingerprints.emplace(q.value(0).toInt(), std::move(fingerprint));
+        }
+    }
+
+    return fingerprints;
+}
+
 bool TrackDatabase::deleteTrack(int id)
 {
     const QString statement = QStringLiteral("DELETE FROM Tracks WHERE TrackID = :trackID;");
@@ -333,6 +835,7 @@ bool TrackDatabase::deleteTrack(int id)
 
 bool TrackDatabase::deleteTracks(const TrackList& tracks)
 {
+    FY_TRACE_SCOPE("TrackDatabase::deleteTracks");
     if(tracks.empty()) {
         return true;
     }
@@ -356,8 +859,9 @@ std::set<int> TrackDatabase::deleteLibraryTracks(int libraryId)
     std::set<int> tracksToRemove;
 
     {
-        const auto statement = QStringLiteral("SELECT TrackID FROM Tracks WHERE LibraryID = :libraryId AND TrackID "
-                                              "NOT IN (SELECT TrackID FROM PlaylistTracks);");
+        const auto statement
+            = QStringLiteral("SELECT TrackID FROM Tracks WHERE LibraryID = :libraryId AND NOT EXISTS "
+                             "(SELECT 1 FROM PlaylistTracks WHERE PlaylistTracks.TrackID = Tracks.TrackID);");
 
         DbQuery query{db(), statement};
 
@@ -373,8 +877,9 @@ std::set<int> TrackDatabase::deleteLibraryTracks(int libraryId)
     }
 
     {
-        const auto statement = QStringLiteral(
-            "DELETE FROM Tracks WHERE LibraryID = :libraryId AND TrackID NOT IN (SELECT TrackID FROM PlaylistTracks);");
+        const auto statement
+            = QStringLiteral("DELETE FROM Tracks WHERE LibraryID = :libraryId AND NOT EXISTS "
+                             "(SELECT 1 FROM PlaylistTracks WHERE PlaylistTracks.TrackID = Tracks.TrackID);");
 
         DbQuery query{db(), statement};
 
@@ -399,11 +904,46 @@ std::set<int> TrackDatabase::deleteLibraryTracks(int libraryId)
     return tracksToRemove;
 }
 
-void TrackDatabase::cleanupTracks()
+bool TrackDatabase::relocateLibraryTracks(int libraryId, const QString& oldPath, const QString& newPath)
 {
-    removeUnmanagedTracks();
-    markUnusedStatsForDelete();
-    deleteExpiredStats();
+    if(libraryId < 0 || oldPath.isEmpty() || newPath.isEmpty()) {
+        return false;
+    }
+
+    // Files inside archives have the archive's path after the scheme
+    const QString oldArchive = Track::archiveFilepath(oldPath, {}).chopped(1);
+    const QString newArchive = Track::archiveFilepath(newPath, {}).chopped(1);
+
+    // Paths under a root sort between "root/" and "root0", which avoids escaping wildcards for LIKE
+    const auto statement = QStringLiteral(
+        "UPDATE Tracks SET "
+        "FilePath = CASE "
+        "WHEN FilePath >= :fileStart AND FilePath < :fileEnd "
+        "THEN :fileNewPath || SUBSTR(FilePath, LENGTH(:fileOldPath) + 1) "
+        "WHEN FilePath >= :archiveStart AND FilePath < :archiveEnd "
+        "THEN :archiveNewPath || SUBSTR(FilePath, LENGTH(:archiveOldPath) + 1) "
+        "ELSE FilePath END, "
+        "CuePath = CASE "
+        "WHEN CuePath >= :cueStart AND CuePath < :cueEnd "
+        "THEN :cueNewPath || SUBSTR(CuePath, LENGTH(:cueOldPath) + 1) "
+        "ELSE CuePath END "
+        "WHERE LibraryID = :libraryId;");
+
+    DbQuery query{db(), statement};
+
+    for(const QString& prefix : {QStringLiteral(":file"), QStringLiteral(":cue")}) {
+        query.bindValue(prefix + QStringLiteral("Start"), QString{oldPath + u'/'});
+        query.bindValue(prefix + QStringLiteral("End"), QString{oldPath + u'0'});
+        query.bindValue(prefix + QStringLiteral("NewPath"), newPath);
+        query.bindValue(prefix + QStringLiteral("OldPath"), oldPath);
+    }
+    query.bindValue(QStringLiteral(":archiveStart"), QString{oldArchive + u'/'});
+    query.bindValue(QStringLiteral(":archiveEnd"), QString{oldArchive + u'0'});
+    query.bindValue(QStringLiteral(":archiveNewPath"), newArchive);
+    query.bindValue(QStringLiteral(":archiveOldPath"), oldArchive);
+    query.bindValue(QStringLiteral(":libraryId"), libraryId);
+
+    return query.exec();
 }
 
 void TrackDatabase::dropViews(const QSqlDatabase& db)
@@ -450,7 +990,10 @@ void TrackDatabase::insertViews(const QSqlDatabase& db)
                                           "TrackStats.FirstPlayed,"
                                           "TrackStats.LastPlayed,"
                                           "TrackStats.PlayCount,"
-                                          "TrackStats.Rating"
+                                          "TrackStats.Rating,"
+                                          "Tracks.CuePath,"
+                                          "Tracks.Offset,"
+                                          "Tracks.AlbumID"
                                           " FROM Tracks "
                                           "LEFT JOIN Libraries ON Tracks.LibraryID = Libraries.LibraryID "
                                           "LEFT JOIN TrackStats ON Tracks.TrackHash = TrackStats.TrackHash;");
@@ -460,6 +1003,167 @@ void TrackDatabase::insertViews(const QSqlDatabase& db)
     query.exec();
 }
 
+bool TrackDatabase::rehashTracks(const QSqlDatabase& db)
+{
+    DbQuery tracksQuery{db, QStringLiteral("SELECT TrackID, LegacyHash, FilePath, Title, Artists, Album, DiscNumber, "
+                                           "TrackNumber, CuePath, Offset FROM Tracks;")};
+    DbQuery hashQuery{db, QStringLiteral("UPDATE Tracks SET TrackHash = :trackHash WHERE TrackID = :trackId;")};
+    // Tracks with the same metadata had the same hash before, so only the first needs to move the stats
+    DbQuery statsQuery{db, QStringLiteral("INSERT OR IGNORE INTO TrackStats (TrackHash, LastSeen, AddedDate, "
+                                          "FirstPlayed, LastPlayed, PlayCount, Rating) SELECT :trackHash, LastSeen, "
+                                          "AddedDate, FirstPlayed, LastPlayed, PlayCount, Rating FROM LegacyTrackStats "
+                                          "WHERE TrackHash = :legacyHash;")};
+
+    if(!tracksQuery.exec()) {
+        return false;
+    }
+
+    int count{0};
+
+    while(tracksQuery.next()) {
+        // Set in the same way as readToTrack, so the hash matches the one generated when loading
+        Track track;
+        track.setFilePath(tracksQuery.value(2).toString());
+        track.setTitle(tracksQuery.value(3).toString());
+        track.setArtists(tracksQuery.value(4).toStringList());
+        track.setAlbum(tracksQuery.value(5).toString());
+        track.setDiscNumber(tracksQuery.value(6).toInt());
+        track.setTrackNumber(tracksQuery.value(7).toInt());
+        track.setCuePath(tracksQuery.value(8).toString());
+        track.setOffset(tracksQuery.value(9).toULongLong());
+
+        const QVariant hash = hashValue(track.generateHash());
+
+        hashQuery.bindValue(QStringLiteral(":trackHash"), hash);
+        hashQuery.bindValue(QStringLiteral(":trackId"), tracksQuery.value(0));
+        statsQuery.bindValue(QStringLiteral(":trackHash"), hash);
+        statsQuery.bindValue(QStringLiteral(":legacyHash"), tracksQuery.value(1));
+
+        if(!hashQuery.exec() || !statsQuery.exec()) {
+            return false;
+        }
+        ++count;
+    }
+
+    qInfo() << "[DB] Rehashed" << count << "tracks";
+
+    return true;
+}
+
+bool TrackDatabase::indexTrackValues(const QSqlDatabase& db)
+{
+    DbQuery tracksQuery{db, QStringLiteral("SELECT TrackID, Artists, AlbumArtist, Genres FROM Tracks;")};
+
+    if(!tracksQuery.exec()) {
+        return false;
+    }
+
+    ValueWriter writer{db};
+    int count{0};
+
+    while(tracksQuery.next()) {
+        // Read in the same way as readToTrack, so the values match those of the loaded tracks
+        if(!writer.write(tracksQuery.value(0).toInt(), uniqueValues(tracksQuery.value(1).toStringList()),
+                         uniqueValues(tracksQuery.value(2).toStringList()),
+                         uniqueValues(tracksQuery.value(3).toStringList()), false)) {
+            return false;
+        }
+        ++count;
+    }
+
+    qInfo() << "[DB] Indexed the artists and genres of" << count << "tracks";
+
+    return true;
+}
+
+bool TrackDatabase::summariseAlbums(const QSqlDatabase& db)
+{
+    // Kept up to date by SQLite itself, so every way tracks are added, changed or removed is covered
+    const std::array triggers{
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS AlbumTrackInserted AFTER INSERT ON Tracks "
+                       "WHEN NEW.AlbumID IS NOT NULL BEGIN %1; END;")
+            .arg(summariseAlbumsStatement(QStringLiteral("AlbumID = NEW.AlbumID"))),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS AlbumTrackUpdated AFTER UPDATE OF AlbumID, Duration, FilePath "
+                       "ON Tracks BEGIN %1; END;")
+            .arg(summariseAlbumsStatement(QStringLiteral("AlbumID IN (OLD.AlbumID, NEW.AlbumID)"))),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS AlbumTrackDeleted AFTER DELETE ON Tracks "
+                       "WHEN OLD.AlbumID IS NOT NULL BEGIN %1; END;")
+            .arg(summariseAlbumsStatement(QStringLiteral("AlbumID = OLD.AlbumID"))),
+    };
+
+    for(const QString& trigger : triggers) {
+        DbQuery query{db, trigger};
+        if(!query.exec()) {
+            return false;
+        }
+    }
+
+    DbQuery summariseQuery{db, summariseAlbumsStatement(QStringLiteral("1"))};
+    if(!summariseQuery.exec()) {
+        return false;
+    }
+
+    qInfo() << "[DB] Summarised" << summariseQuery.numRowsAffected() << "albums";
+
+    return true;
+}
+
+bool TrackDatabase::indexAlbums(const QSqlDatabase& db)
+{
+    DbQuery tracksQuery{db, QStringLiteral("SELECT TrackID, FilePath, Artists, AlbumArtist, Album, Date FROM Tracks;")};
+
+    if(!tracksQuery.exec()) {
+        return false;
+    }
+
+    ValueWriter writer{db};
+    int count{0};
+
+    while(tracksQuery.next()) {
+        // Set in the same way as readToTrack, so the key matches the one built for the loaded tracks
+        Track track;
+        track.setFilePath(tracksQuery.value(1).toString());
+        track.setArtists(tracksQuery.value(2).toStringList());
+        track.setAlbumArtists(tracksQuery.value(3).toStringList());
+        track.setAlbum(tracksQuery.value(4).toString());
+        track.setDate(tracksQuery.value(5).toString());
+
+        if(writer.writeAlbum(tracksQuery.value(0).toInt(), track.albumHash()) < 0) {
+            return false;
+        }
+        ++count;
+    }
+
+    qInfo() << "[DB] Linked" << count << "tracks to their albums";
+
+    return true;
+}
+
+TrackList TrackDatabase::tracksAfter(int id, int limit, Projection projection) const
+{
+    const auto statement
+        = QStringLiteral("SELECT %1 FROM TracksView WHERE TrackID > :lastId ORDER BY TrackID LIMIT :limit;")
+              .arg(fetchTrackColumns(projection));
+
+    DbQuery q{db(), statement};
+
+    q.bindValue(QStringLiteral(":lastId"), id);
+    q.bindValue(QStringLiteral(":limit"), limit);
+
+    if(!q.exec()) {
+        return {};
+    }
+
+    TrackList tracks;
+    tracks.reserve(limit);
+
+    while(q.next()) {
+        tracks.emplace_back(readToTrack(q, projection));
+    }
+
+    return tracks;
+}
+
 int TrackDatabase::trackCount() const
 {
     const auto statement = QStringLiteral("SELECT COUNT(*) FROM Tracks;");
@@ -477,203 +1181,223 @@ int TrackDatabase::trackCount() const
     return -1;
 }
 
-bool TrackDatabase::insertTrack(Track& track) const
-{
-    const auto statement = QStringLiteral("INSERT INTO Tracks ("
-                                          "FilePath,"
-                                          "Title,"
-                                          "TrackNumber,"
-                                          "TrackTotal,"
-                                          "Artists,"
-                                          "AlbumArtist,"
-                                          "Album,"
-                                          "DiscNumber,"
-                                          "DiscTotal,"
-                                          "Date,"
-                                          "Composer,"
-                                          "Performer,"
-                                          "Genres,"
-                                          "Comment,"
-                                          "Duration,"
-                                          "FileSize,"
-                                          "BitRate,"
-                                          "SampleRate,"
-                                          "Channels,"
-                                          "BitDepth,"
-                                          "ExtraTags,"
-                                          "Type,"
-                                          "ModifiedDate,"
-                                          "TrackHash,"
-                                          "LibraryID"
-                                          ") "
-                                          "VALUES ("
-                                          ":filePath,"
-                                          ":title, "
-                                          ":trackNumber,"
-                                          ":trackTotal,"
-                                          ":artists,"
-                                          ":albumArtist,"
-                                          ":album,"
-                                          ":discNumber,"
-                                          ":discTotal,"
-                                          ":date, "
-                                          ":composer,"
-                                          ":performer,"
-                                          ":genres,"
-                                          ":comment,"
-                                          ":duration,"
-                                          ":fileSize,"
-                                          ":bitRate,"
-                                          ":sampleRate,"
-                                          ":channels,"
-                                          ":bitDepth,"
-                                          ":extraTags, "
-                                          ":type,"
-                                          ":modifiedDate,"
-                                          ":trackHash,"
-                                          ":libraryID"
-                                          ");");
+bool TrackDatabase::insertTracks(const std::vector<Track*>& tracks) const
+{
+    FY_TRACE_SCOPE("TrackDatabase::insertTracks");
+    bool success{true};
 
-    DbQuery query{db(), statement};
+    for(size_t start{0}; start < tracks.size(); start += static_cast<size_t>(m_batchSize)) {
+        const size_t count = std::min(static_cast<size_t>(m_batchSize), tracks.size() - start);
 
-    const auto bindings = trackBindings(track);
-    for(const auto& [name, value] : bindings) {
-        query.bindValue(name, value);
-    }
+        DbQuery* query = cachedQuery(insertStatement(count));
+        if(!query) {
+            return false;
+        }
 
-    if(!query.exec()) {
-        return false;
+        std::unordered_map<QString, Track*> batch;
+        for(size_t i{0}; i < count; ++i) {
+            Track* track      = tracks.at(start + i);
+            const auto suffix = QString::number(i);
+
+            const auto bindings = trackBindings(*track);
+            for(const auto& [name, value] : bindings) {
+                query->bindValue(name + suffix, value);
+            }
+            batch.emplace(insertedKey(Utils::File::cleanPath(track->filepath()), track->cuePath(), track->offset()),
+                          track);
+        }
+
+        if(!query->exec()) {
+            success = false;
+            continue;
+        }
+
+        // RETURNING doesn't guarantee any order, so ids are matched up by the (unique) path and offset
+        while(query->next()) {
+            const QString key
+                = insertedKey(query->value(1).toString(), query->value(2).toString(), query->value(3).toULongLong());
+            if(const auto trackIt = batch.find(key); trackIt != batch.end()) {
+                trackIt->second->setId(query->value(0).toInt());
+            }
+        }
     }
 
-    track.setId(query.lastInsertId().toInt());
+    std::vector<Track*> insertedTracks;
+    std::ranges::copy_if(tracks, std::back_inserter(insertedTracks),
+                         [](const Track* track) { return track->id() >= 0; });
 
-    return insertOrUpdateStats(track);
+    const std::vector<const Track*> statsTracks{insertedTracks.cbegin(), insertedTracks.cend()};
+    return recoverLegacyStats(insertedTracks) && insertOrUpdateStats(statsTracks)
+        && writeValues(insertedTracks, false) && success;
 }
 
-bool TrackDatabase::insertOrUpdateStats(const Track& track) const
+bool TrackDatabase::writeValues(const std::vector<Track*>& tracks, bool replace) const
 {
-    if(track.hash().isEmpty()) {
-        qDebug() << "Cannot insert/update track stats (Hash empty)";
-        return false;
+    FY_TRACE_SCOPE("TrackDatabase::writeValues");
+    if(tracks.empty()) {
+        return true;
     }
 
-    uint64_t added{0};
-    uint64_t firstPlayed{0};
-    uint64_t lastPlayed{0};
-    int playCount{0};
-    float rating{0};
+    ValueWriter writer{db()};
+    return std::ranges::all_of(tracks, [&writer, replace](Track* track) { return writer.write(*track, replace); });
+}
 
-    {
-        const auto statement = QStringLiteral("SELECT AddedDate, FirstPlayed, LastPlayed, PlayCount, Rating FROM "
-                                              "TrackStats WHERE TrackHash = :trackHash;");
+bool TrackDatabase::insertOrUpdateStats(const std::vector<const Track*>& tracks) const
+{
+    std::vector<const Track*> statsTracks;
+    std::ranges::copy_if(tracks, std::back_inserter(statsTracks), [](const Track* track) {
+        if(track->hash() == 0) {
+            qDebug() << "Cannot insert/update track stats (Hash empty)";
+            return false;
+        }
+        return true;
+    });
 
-        DbQuery query{db(), statement};
+    bool success{true};
 
-        query.bindValue(QStringLiteral(":trackHash"), track.hash());
+    const auto batchSize = static_cast<size_t>(m_batchSize);
+    for(size_t start{0}; start < statsTracks.size(); start += batchSize) {
+        const size_t count = std::min(batchSize, statsTracks.size() - start);
 
-        if(!query.exec()) {
+        DbQuery* query = cachedQuery(statsStatement(count));
+        if(!query) {
             return false;
         }
 
-        if(query.next()) {
-            added       = query.value(0).toULongLong();
-            firstPlayed = query.value(1).toULongLong();
-            lastPlayed  = query.value(2).toULongLong();
-            playCount   = query.value(3).toInt();
-            rating      = query.value(4).toFloat();
+        for(size_t i{0}; i < count; ++i) {
+            const Track* track = statsTracks.at(start + i);
+            const auto suffix  = QString::number(i);
+
+            query->bindValue(QStringLiteral(":trackHash") + suffix, hashValue(track->hash()));
+            query->bindValue(QStringLiteral(":addedDate") + suffix, QVariant::fromValue(track->addedTime()));
+            query->bindValue(QStringLiteral(":firstPlayed") + suffix, QVariant::fromValue(track->firstPlayed()));
+            query->bindValue(QStringLiteral(":lastPlayed") + suffix, QVariant::fromValue(track->lastPlayed()));
+            query->bindValue(QStringLiteral(":playCount") + suffix, track->playCount());
+            query->bindValue(QStringLiteral(":rating") + suffix, track->rating());
+        }
+
+        if(!query->exec()) {
+            success = false;
         }
     }
 
-    bool dbNeedsUpdate{false};
+    return success;
+}
 
-    const uint64_t trackAdded       = track.addedTime();
-    const uint64_t trackFirstPlayed = track.firstPlayed();
-    const uint64_t trackLastPlayed  = track.lastPlayed();
-    const int trackPlayCount        = track.playCount();
-    const float trackRating         = track.rating();
+bool TrackDatabase::recoverLegacyStats(const std::vector<Track*>& tracks) const
+{
+    DbQuery remainingQuery{db(), QStringLiteral("SELECT 1 FROM LegacyTrackStats LIMIT 1;")};
+    if(!remainingQuery.exec()) {
+        return false;
+    }
+    // Nearly always the case, and skips generating an MD5 hash for every track
+    if(!remainingQuery.next()) {
+        return true;
+    }
+
+    DbQuery statsQuery{db(), QStringLiteral("SELECT AddedDate, FirstPlayed, LastPlayed, PlayCount, Rating "
+                                            "FROM LegacyTrackStats WHERE TrackHash = :legacyHash AND NOT EXISTS "
+                                            "(SELECT 1 FROM TrackStats WHERE TrackHash = :trackHash);")};
+    DbQuery deleteQuery{db(), QStringLiteral("DELETE FROM LegacyTrackStats WHERE TrackHash = :legacyHash;")};
 
-    if(trackAdded != added) {
-        if(added == 0 || (trackAdded > 0 && trackAdded < added)) {
-            added         = trackAdded;
-            dbNeedsUpdate = true;
+    // Earliest of the times the track was added or first played, ignoring those never set
+    const auto earliest = [](uint64_t time, uint64_t legacyTime) {
+        return (time == 0 || (legacyTime > 0 && legacyTime < time)) ? legacyTime : time;
+    };
+
+    int count{0};
+
+    for(Track* track : tracks) {
+        if(track->hash() == 0) {
+            continue;
         }
-    }
-    if(trackFirstPlayed != firstPlayed) {
-        if(firstPlayed == 0 || (trackFirstPlayed > 0 && trackFirstPlayed < firstPlayed)) {
-            firstPlayed   = trackFirstPlayed;
-            dbNeedsUpdate = true;
+
+        const QString legacyHash = track->legacyHash();
+
+        statsQuery.bindValue(QStringLiteral(":legacyHash"), legacyHash);
+        statsQuery.bindValue(QStringLiteral(":trackHash"), hashValue(track->hash()));
+        if(!statsQuery.exec()) {
+            return false;
         }
-    }
-    if(trackLastPlayed != lastPlayed) {
-        if(trackLastPlayed > lastPlayed) {
-            lastPlayed    = trackLastPlayed;
-            dbNeedsUpdate = true;
+        if(!statsQuery.next()) {
+            continue;
         }
-    }
-    if(trackPlayCount != playCount) {
-        if(trackPlayCount > playCount) {
-            playCount     = trackPlayCount;
-            dbNeedsUpdate = true;
+
+        // Merged in the same way as statsStatement, so written along with the track's own stats
+        track->setAddedTime(earliest(track->addedTime(), statsQuery.value(0).toULongLong()));
+        track->setFirstPlayed(earliest(track->firstPlayed(), statsQuery.value(1).toULongLong()));
+        track->setLastPlayed(std::max(track->lastPlayed(), statsQuery.value(2).toULongLong()));
+        track->setPlayCount(std::max(track->playCount(), statsQuery.value(3).toInt()));
+        if(const float rating = statsQuery.value(4).toFloat(); rating > 0) {
+            track->setRating(rating);
         }
-    }
-    if(trackRating != rating) {
-        rating        = trackRating;
-        dbNeedsUpdate = true;
+
+        deleteQuery.bindValue(QStringLiteral(":legacyHash"), legacyHash);
+        if(!deleteQuery.exec()) {
+            return false;
+        }
+        ++count;
     }
 
-    if(!dbNeedsUpdate) {
-        return true;
+    if(count > 0) {
+        qInfo() << "[DB] Recovered the stats of" << count << "tracks from before their hashes changed";
     }
 
-    const auto statement = QStringLiteral(
-        "INSERT OR REPLACE INTO TrackStats (TrackHash, AddedDate, FirstPlayed, LastPlayed, PlayCount, Rating) VALUES "
-        "(:trackHash, :addedDate, :firstPlayed, :lastPlayed, :playCount, :rating);");
+    return true;
+}
 
-    DbQuery query{db(), statement};
+int TrackDatabase::removeUnmanagedTracks() const
+{
+    const auto statement
+        = QStringLiteral("DELETE FROM Tracks WHERE LibraryID = -1 AND NOT EXISTS "
+                         "(SELECT 1 FROM PlaylistTracks WHERE PlaylistTracks.TrackID = Tracks.TrackID);");
 
-    query.bindValue(QStringLiteral(":trackHash"), track.hash());
-    query.bindValue(QStringLiteral(":addedDate"), QVariant::fromValue(added));
-    query.bindValue(QStringLiteral(":firstPlayed"), QVariant::fromValue(firstPlayed));
-    query.bindValue(QStringLiteral(":lastPlayed"), QVariant::fromValue(lastPlayed));
-    query.bindValue(QStringLiteral(":playCount"), playCount);
-    query.bindValue(QStringLiteral(":rating"), rating);
+    DbQuery query{db(), statement};
 
-    return query.exec();
+    return query.exec() ? query.numRowsAffected() : -1;
 }
 
-void TrackDatabase::removeUnmanagedTracks() const
+int TrackDatabase::deleteUnusedValues() const
 {
-    const auto statement = QStringLiteral(
-        "DELETE FROM Tracks WHERE LibraryID = -1 AND TrackID NOT IN (SELECT TrackID FROM PlaylistTracks);");
-
-    DbQuery query{db(), statement};
+    DbQuery artistsQuery{db(), QStringLiteral("DELETE FROM Artists WHERE NOT EXISTS "
+                                              "(SELECT 1 FROM TrackArtists WHERE TrackArtists.ArtistID = "
+                                              "Artists.ArtistID);")};
+    DbQuery genresQuery{db(), QStringLiteral("DELETE FROM Genres WHERE NOT EXISTS "
+                                             "(SELECT 1 FROM TrackGenres WHERE TrackGenres.GenreID = "
+                                             "Genres.GenreID);")};
+    DbQuery albumsQuery{db(), QStringLiteral("DELETE FROM Albums WHERE NOT EXISTS "
+                                             "(SELECT 1 FROM Tracks WHERE Tracks.AlbumID = Albums.AlbumID);")};
+
+    if(!artistsQuery.exec() || !genresQuery.exec() || !albumsQuery.exec()) {
+        return -1;
+    }
 
-    query.exec();
+    return artistsQuery.numRowsAffected() + genresQuery.numRowsAffected() + albumsQuery.numRowsAffected();
 }
 
-void TrackDatabase::markUnusedStatsForDelete() const
+int TrackDatabase::markUnusedStatsForDelete() const
 {
     const auto statement
-        = QStringLiteral("UPDATE TrackStats SET LastSeen = :lastSeen WHERE LastSeen IS NULL AND TrackHash NOT IN "
-                         "(SELECT TrackHash FROM Tracks);");
+        = QStringLiteral("UPDATE TrackStats SET LastSeen = :lastSeen WHERE LastSeen IS NULL AND NOT EXISTS "
+                         "(SELECT 1 FROM Tracks WHERE Tracks.TrackHash = TrackStats.TrackHash);");
 
     DbQuery query{db(), statement};
 
     query.bindValue(QStringLiteral(":lastSeen"), QDateTime::currentMSecsSinceEpoch());
 
-    query.exec();
+    return query.exec() ? query.numRowsAffected() : -1;
 }
 
-void TrackDatabase::deleteExpiredStats() const
+int TrackDatabase::deleteExpiredStats() const
 {
     const auto statement
         = QStringLiteral("DELETE FROM TrackStats WHERE LastSeen IS NOT NULL AND LastSeen <= :clearInterval AND "
-                         "TrackHash NOT IN (SELECT TrackHash FROM Tracks);");
+                         "NOT EXISTS (SELECT 1 FROM Tracks WHERE Tracks.TrackHash = TrackStats.TrackHash);");
 
     DbQuery query{db(), statement};
 
     query.bindValue(QStringLiteral(":clearInterval"), QDateTime::currentDateTime().addDays(-28).toMSecsSinceEpoch());
 
-    query.exec();
+    return query.exec() ? query.numRowsAffected() : -1;
 }
 } // namespace Fooyin
@@ -19,40 +19,143 @@
 
 #pragma once
 
+#include "fycore_export.h"
+
+#include "engine/audiofingerprint.h"
+
 #include <core/trackfwd.h>
 #include <utils/database/dbmodule.h>
 
+#include <QString>
+
 #include <set>
+#include <vector>
 
 namespace Fooyin {
-class TrackDatabase : public DbModule
+class FYCORE_EXPORT TrackDatabase : public DbModule
 {
 public:
+    // SQLite's limit on bound values per statement (as of 3.32)
+    static constexpr int MaxVariables     = 32766;
+    static constexpr int DefaultBatchSize = 128;
+    static constexpr int DefaultPageSize  = 5000;
+
+    enum class Projection : uint8_t
+    {
+        // Every column, and tracks are disabled if their file no longer exists
+        Full,
+        // Enough to display, group and sort tracks: the comment and extra tags are left empty,
+        // and files aren't checked for existence
+        Light,
+    };
+
+    /*!
+     * Reads all tracks a page at a time in id order.
+     * Pages start after the last id read rather than at an offset, so each one costs the same.
+     */
+    class Cursor
+    {
+    public:
+        Cursor(const TrackDatabase* database, Projection projection, int pageSize);
+
+        /** Returns the next page of up to pageSize tracks, which is empty once all have been read. */
+        TrackList nextPage();
+        [[nodiscard]] bool atEnd() const;
+
+    private:
+        const TrackDatabase* m_database;
+        Projection m_projection;
+        int m_pageSize;
+        int m_lastId;
+        bool m_atEnd;
+    };
+
+    /*!
+     * Inserts new tracks and updates existing ones in a single transaction.
+     * New tracks are written in multi-row statements (see @fn setBatchSize), and their ids are set.
+     */
     bool storeTracks(TrackList& tracksToStore);
+    /** Sets the number of rows written per INSERT statement. */
+    void setBatchSize(int size);
 
     bool reloadTrack(Track& track) const;
     bool reloadTracks(TrackList& tracks) const;
     [[nodiscard]] TrackList getAllTracks() const;
-    [[nodiscard]] TrackList tracksByHash(const QString& hash) const;
+    [[nodiscard]] Cursor cursor(Projection projection, int pageSize = DefaultPageSize) const;
+    [[nodiscard]] TrackList tracksByHash(uint64_t hash) const;
+    /*!
+     * Returns the tracks with @p artist among their artists, or their album artists if @p albumArtist is set.
+     * Artists are matched ignoring (ASCII) case, using the index of the Artists and TrackArtists tables.
+     */
+    [[nodiscard]] TrackList tracksByArtist(const QString& artist, bool albumArtist = false) const;
+    /** Returns the tracks with @p genre among their genres, matched ignoring (ASCII) case. */
+    [[nodiscard]] TrackList tracksByGenre(const QString& genre) const;
 
-    bool updateTrack(const Track& track);
+    /** Updates @p track, and assigns its album id. */
+    bool updateTrack(Track& track);
+    /** Updates @p tracks in a single transaction, so either all or none are changed, and assigns their album ids. */
+    bool updateTracks(TrackList& tracks);
+    /*!
+     * Updates only the path and library of @p tracks in a single transaction, for files which have been moved.
+     * Their metadata is left as it is, so this is far cheaper than updateTracks.
+     */
+    bool updateTrackPaths(const TrackList& tracks);
     bool updateTrackStats(const TrackList& track);
 
+    /** Stores acoustic fingerprints by track id, replacing any already stored for the same tracks. */
+    bool storeFingerprints(const TrackFingerprintMap& fingerprints);
+    /** Returns the stored fingerprints of the tracks in @p trackIds. Tracks without one are left out. */
+    [[nodiscard]] TrackFingerprintMap fingerprints(const std::vector<int>& trackIds) const;
+
     bool deleteTrack(int id);
     bool deleteTracks(const TrackList& tracks);
     std::set<int> deleteLibraryTracks(int libraryId);
+    /** Moves the files and CUE sheets of the tracks of @p libraryId under @p oldPath to @p newPath. */
+    bool relocateLibraryTracks(int libraryId, const QString& oldPath, const QString& newPath);
 
-    void cleanupTracks();
+    // Maintenance queries run by DatabaseMaintenance, which return the number of rows changed or -1 on error
+    /** Deletes tracks outside of a library which no playlist references. */
+    int removeUnmanagedTracks() const;
+    /** Marks the stats of tracks no longer in the database, which are deleted once expired. */
+    int markUnusedStatsForDelete() const;
+    /** Deletes artists, genres and albums which no track holds any more. */
+    int deleteUnusedValues() const;
+    int deleteExpiredStats() const;
 
     static void dropViews(const QSqlDatabase& db);
     static void insertViews(const QSqlDatabase& db);
+    /*!
+     * Schema migration step which sets the hash of every track from its metadata, and moves the stats held
+     * under its previous hash (in LegacyHash and LegacyTrackStats) to the new one.
+     */
+    static bool rehashTracks(const QSqlDatabase& db);
+    /** Schema migration step which fills the Artists, Genres and link tables from the values of every track. */
+    static bool indexTrackValues(const QSqlDatabase& db);
+    /** Schema migration step which fills the Albums table and links every track to its album. */
+    static bool indexAlbums(const QSqlDatabase& db);
+    /*!
+     * Schema migration step which adds the triggers keeping the totals of each album up to date,
+     * and computes them for the albums already stored.
+     */
+    static bool summariseAlbums(const QSqlDatabase& db);
 
 private:
+    [[nodiscard]] TrackList tracksAfter(int id, int limit, Projection projection) const;
     int trackCount() const;
-    bool insertTrack(Track& track) const;
-    bool insertOrUpdateStats(const Track& track) const;
-    void removeUnmanagedTracks() const;
-    void markUnusedStatsForDelete() const;
-    void deleteExpiredStats() const;
+    bool updateTrackRow(const Track& track);
+    /*!
+     * Links @p tracks to their artists, genres and album, replacing any links already held if @p replace is set.
+     * The album id of each track is set as it's linked.
+     */
+    bool writeValues(const std::vector<Track*>& tracks, bool replace) const;
+    bool insertTracks(const std::vector<Track*>& tracks) const;
+    bool insertOrUpdateStats(const std::vector<const Track*>& tracks) const;
+    /*!
+     * Moves the stats kept under the MD5 hash of @p tracks (see Track::legacyHash) onto them,
+     * for any without stats under their own hash.
+     */
+    bool recoverLegacyStats(const std::vector<Track*>& tracks) const;
+
+    int m_batchSize{DefaultBatchSize};
 };
 } // namespace Fooyin
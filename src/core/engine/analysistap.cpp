@@ -0,0 +1,159 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/engine/analysistap.h>
+
+#include <core/engine/audioconverter.h>
+
+#include <algorithm>
+#include <cstring>
+
+// A reader only retries when a write lands in the middle of its copy, which is rare and short
+constexpr auto MaxReadAttempts = 16;
+
+namespace Fooyin {
+AnalysisTap::AnalysisTap()
+    : m_samples(static_cast<size_t>(Capacity * MaxChannels), 0.0F)
+{ }
+
+void AnalysisTap::write(const AudioFormat& format, const std::byte* data, int frameCount, TimePoint audibleAt)
+{
+    const int channels = format.channelCount();
+    if(frameCount <= 0 || !format.isValid() || channels <= 0 || channels > MaxChannels) {
+        return;
+    }
+
+    const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const uint32_t clearRequest = m_clearRequest.load(std::memory_order_acquire);
+    if(clearRequest != m_clearSeen || channels != m_channels.load(std::memory_order_relaxed)
+       || format.sampleRate() != m_sampleRate.load(std::memory_order_relaxed)) {
+        m_clearSeen = clearRequest;
+        m_channels.store(channels, std::memory_order_relaxed);
+        m_sampleRate.store(format.sampleRate(), std::memory_order_relaxed);
+        m_writePos.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+
+    // Only the end of a write larger than the history can be kept
+    if(frameCount > Capacity) {
+        const int skipped = frameCount - Capacity;
+        data += format.bytesForFrames(skipped);
+        audibleAt += std::chrono::milliseconds{format.durationForFrames(skipped)};
+        writePos += static_cast<uint64_t>(skipped);
+        frameCount = Capacity;
+    }
+
+    const AudioFormat floatFormat{SampleFormat::Float, format.sampleRate(), channels};
+
+    int written{0};
+    while(written < frameCount) {
+        const auto offset = static_cast<int>((writePos + static_cast<uint64_t>(written)) % Capacity);
+        const int frames  = std::min(frameCount - written, Capacity - offset);
+
+        auto* output = reinterpret_cast<std::byte*>(m_samples.data() + (static_cast<size_t>(offset) * channels));
+        Audio::convert(format, data + format.bytesForFrames(written), floatFormat, output, frames);
+        written += frames;
+    }
+
+    const auto anchorTime = std::chrono::duration_cast<std::chrono::nanoseconds>(audibleAt.time_since_epoch());
+    m_anchorPos.store(writePos, std::memory_order_relaxed);
+    m_anchorTime.store(anchorTime.count(), std::memory_order_relaxed);
+    m_writePos.store(writePos + static_cast<uint64_t>(frameCount), std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void AnalysisTap::clear()
+{
+    m_clearRequest.fetch_add(1, std::memory_order_release);
+}
+
+AudioFormat AnalysisTap::format() const
+{
+    const int sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+    const int channels   = m_channels.load(std::memory_order_relaxed);
+    if(sampleRate <= 0 || channels <= 0) {
+        return {};
+    }
+    return {SampleFormat::Float, sampleRate, channels};
+}
+
+AudioFormat AnalysisTap::read(std::span<float> data, int frameCount, TimePoint time) const
+{
+    if(frameCount <= 0) {
+        return {};
+    }
+
+    const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+
+    for(int attempt{0}; attempt < MaxReadAttempts; ++attempt) {
+        const uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+        if(sequence & 1) {
+            continue;
+        }
+
+        const int sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+        const int channels   = m_channels.load(std::memory_order_relaxed);
+        const auto writePos  = static_cast<int64_t>(m_writePos.load(std::memory_order_relaxed));
+        const auto anchorPos = static_cast<int64_t>(m_anchorPos.load(std::memory_order_relaxed));
+        const int64_t anchor = m_anchorTime.load(std::memory_order_relaxed);
+
+        if(sampleRate <= 0 || channels <= 0 || writePos == 0
+           || data.size() < static_cast<size_t>(frameCount) * static_cast<size_t>(channels)) {
+            return {};
+        }
+
+        // The frame being heard at the requested time, which can't be ahead of what has been written
+        const auto elapsed = static_cast<double>(now - anchor) / 1e9;
+        const auto heard   = anchorPos + static_cast<int64_t>(elapsed * sampleRate);
+        const int64_t end  = std::clamp<int64_t>(heard, 0, writePos);
+
+        const int64_t oldest = std::max<int64_t>(0, writePos - Capacity);
+        const int64_t start  = end - frameCount;
+        const auto silence   = static_cast<int>(std::clamp<int64_t>(oldest - start, 0, frameCount));
+
+        const auto stride = static_cast<size_t>(channels);
+        std::fill_n(data.begin(), static_cast<size_t>(silence) * stride, 0.0F);
+
+        auto pos = start + silence;
+        for(int copied{silence}; copied < frameCount;) {
+            const auto offset = static_cast<int>(pos % Capacity);
+            const int frames  = std::min(frameCount - copied, Capacity - offset);
+
+            std::memcpy(data.data() + (static_cast<size_t>(copied) * stride),
+                        m_samples.data() + (static_cast<size_t>(offset) * stride),
+                        static_cast<size_t>(frames) * stride * sizeof(float));
+
+            copied += frames;
+            pos += frames;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(m_sequence.load(std::memory_order_relaxed) == sequence) {
+            return {SampleFormat::Float, sampleRate, channels};
+        }
+    }
+
+    return {};
+}
+} // namespace Fooyin
@@ -19,6 +19,9 @@
 
 #include <core/engine/audiobuffer.h>
 
+#include "audiobufferpool.h"
+#include "audiokernels.h"
+
 #include <QDebug>
 
 #include <ranges>
@@ -31,47 +34,115 @@ struct AudioBuffer::Private : QSharedData
     AudioFormat format;
     uint64_t startTime;
 
+    // Set when wrapping data owned elsewhere
+    std::span<const std::byte> external;
+    std::shared_ptr<const void> owner;
+
     Private(std::span<const std::byte> data_, AudioFormat format_, uint64_t startTime_)
-        : format{format_}
+        : buffer{AudioBufferPool::instance().acquire(data_.size())}
+        , format{format_}
         , startTime{startTime_}
     {
         buffer.assign(data_.begin(), data_.end());
     }
 
     Private(const uint8_t* data_, size_t size, AudioFormat format_, uint64_t startTime_)
-        : format{format_}
+        : buffer{AudioBufferPool::instance().acquire(size)}
+        , format{format_}
         , startTime{startTime_}
     {
         buffer.resize(size);
         std::memmove(buffer.data(), data_, size);
     }
 
+    Private(std::span<const std::byte> data_, std::shared_ptr<const void> owner_, AudioFormat format_,
+            uint64_t startTime_)
+        : format{format_}
+        , startTime{startTime_}
+        , external{data_}
+        , owner{std::move(owner_)}
+    { }
+
+    Private(const Private& other)
+        : QSharedData{other}
+        , buffer{AudioBufferPool::instance().acquire(other.buffer.size())}
+        , format{other.format}
+        , startTime{other.startTime}
+        , external{other.external}
+        , owner{other.owner}
+    {
+        buffer.assign(other.buffer.cbegin(), other.buffer.cend());
+    }
+
+    Private& operator=(const Private&) = delete;
+
+    ~Private()
+    {
+        AudioBufferPool::instance().release(std::move(buffer));
+    }
+
+    static void* operator new(size_t size)
+    {
+        return AudioBufferPool::instance().allocateNode(size);
+    }
+
+    static void operator delete(void* ptr, size_t size)
+    {
+        AudioBufferPool::instance().releaseNode(ptr, size);
+    }
+
+    void ensureCapacity(size_t size)
+    {
+        if(size <= buffer.capacity()) {
+            return;
+        }
+
+        auto storage = AudioBufferPool::instance().acquire(std::max(size, buffer.capacity() * 2));
+        storage.assign(buffer.cbegin(), buffer.cend());
+        AudioBufferPool::instance().release(std::exchange(buffer, std::move(storage)));
+    }
+
+    [[nodiscard]] bool isExternal() const
+    {
+        return !!owner;
+    }
+
+    [[nodiscard]] std::span<const std::byte> view() const
+    {
+        return isExternal() ? external : std::span<const std::byte>{buffer};
+    }
+
+    void detachExternal(size_t reserve = 0)
+    {
+        if(!isExternal()) {
+            return;
+        }
+
+        buffer.clear();
+        ensureCapacity(std::max(reserve, external.size()));
+        buffer.assign(external.begin(), external.end());
+        external = {};
+        owner.reset();
+    }
+
     void fillSilence()
     {
+        detachExternal();
+
         const bool unsignedFormat = format.sampleFormat() == SampleFormat::U8;
         std::ranges::fill(buffer, unsignedFormat ? std::byte{0x80} : std::byte{0});
     }
 
     void fillRemainingWithSilence()
     {
+        if(isExternal()) {
+            return;
+        }
+
         const bool unsignedFormat = format.sampleFormat() == SampleFormat::U8;
         std::fill(buffer.begin() + buffer.size(), buffer.begin() + buffer.capacity(),
                   unsignedFormat ? std::byte{0x80} : std::byte{0});
     }
-
-    template <typename T>
-    void scale(const double volume)
-    {
-        const auto bytes = static_cast<int>(buffer.size());
-        const int bps    = format.bytesPerSample();
-
-        for(int i{0}; i < bytes; i += bps) {
-            T sample;
-            std::memcpy(&sample, buffer.data() + i, bps);
-            sample *= volume;
-            std::memcpy(buffer.data() + i, &sample, bps);
-        }
-    }
 };
 
 AudioBuffer::AudioBuffer() = default;
@@ -88,6 +159,11 @@ AudioBuffer::AudioBuffer(const uint8_t* data, size_t size, AudioFormat format, u
     : p{new Private(data, size, format, startTime)}
 { }
 
+AudioBuffer::AudioBuffer(std::span<const std::byte> data, std::shared_ptr<const void> owner, AudioFormat format,
+                         uint64_t startTime)
+    : p{new Private(data, std::move(owner), format, startTime)}
+{ }
+
 AudioBuffer::~AudioBuffer() = default;
 
 AudioBuffer::AudioBuffer(const AudioBuffer& other)            = default;
@@ -97,13 +173,24 @@ AudioBuffer::AudioBuffer(AudioBuffer&& other) noexcept        = default;
 void AudioBuffer::reserve(size_t size)
 {
     if(isValid()) {
-        p->buffer.reserve(size);
+        if(p->isExternal()) {
+            p->detachExternal(size);
+        }
+        else {
+            p->ensureCapacity(size);
+        }
     }
 }
 
 void AudioBuffer::resize(size_t size)
 {
     if(isValid()) {
+        if(p->isExternal() && size <= p->external.size()) {
+            p->external = p->external.first(size);
+            return;
+        }
+        p->detachExternal(size);
+        p->ensureCapacity(size);
         p->buffer.resize(size);
     }
 }
@@ -118,7 +205,13 @@ void AudioBuffer::append(std::span<const std::byte> data)
 void AudioBuffer::append(const std::byte* data, size_t size)
 {
     if(isValid()) {
+        if(size == 0) {
+            return;
+        }
+        p->detachExternal(p->external.size() + size);
+
         const size_t index = p->buffer.size();
+        p->ensureCapacity(index + size);
         p->buffer.resize(index + size);
         std::memcpy(p->buffer.data() + index, data, size);
     }
@@ -127,6 +220,10 @@ void AudioBuffer::append(const std::byte* data, size_t size)
 void AudioBuffer::erase(size_t size)
 {
     if(isValid()) {
+        if(p->isExternal()) {
+            p->external = p->external.subspan(std::min(size, p->external.size()));
+            return;
+        }
         p->buffer.erase(p->buffer.begin(), p->buffer.begin() + size);
     }
 }
@@ -134,6 +231,8 @@ void AudioBuffer::erase(size_t size)
 void AudioBuffer::clear()
 {
     if(isValid()) {
+        p->external = {};
+        p->owner.reset();
         p->buffer.clear();
     }
 }
@@ -150,6 +249,11 @@ bool AudioBuffer::isValid() const
     return !!p;
 }
 
+bool AudioBuffer::isExternal() const
+{
+    return isValid() && p->isExternal();
+}
+
 void AudioBuffer::detach()
 {
     if(isValid()) {
@@ -157,6 +261,26 @@ void AudioBuffer::detach()
     }
 }
 
+AudioBuffer AudioBuffer::slice(int offset, int size) const
+{
+    if(!isValid() || offset < 0 || size < 0) {
+        return {};
+    }
+
+    const auto data = p->view();
+    if(static_cast<size_t>(offset) > data.size()) {
+        return {};
+    }
+
+    const auto bytes     = data.subspan(offset, std::min(static_cast<size_t>(size), data.size() - offset));
+    const uint64_t start = p->startTime + p->format.durationForBytes(offset);
+
+    if(p->isExternal()) {
+        return {bytes, p->owner, p->format, start};
+    }
+    return {bytes, p->format, start};
+}
+
 AudioFormat AudioBuffer::format() const
 {
     if(isValid()) {
@@ -177,7 +301,7 @@ int AudioBuffer::sampleCount() const
 
 int AudioBuffer::byteCount() const
 {
-    return isValid() ? static_cast<int>(p->buffer.size()) : 0;
+    return isValid() ? static_cast<int>(p->view().size()) : 0;
 }
 
 uint64_t AudioBuffer::startTime() const
@@ -185,6 +309,13 @@ uint64_t AudioBuffer::startTime() const
     return isValid() ? p->startTime : -1;
 }
 
+void AudioBuffer::setStartTime(uint64_t startTime)
+{
+    if(isValid()) {
+        p->startTime = startTime;
+    }
+}
+
 uint64_t AudioBuffer::duration() const
 {
     return format().durationForFrames(frameCount());
@@ -193,7 +324,7 @@ uint64_t AudioBuffer::duration() const
 std::span<const std::byte> AudioBuffer::constData() const
 {
     if(isValid()) {
-        return p->buffer;
+        return p->view();
     }
     return {};
 }
@@ -201,7 +332,7 @@ std::span<const std::byte> AudioBuffer::constData() const
 const std::byte* AudioBuffer::data() const
 {
     if(isValid()) {
-        return p->buffer.data();
+        return p->view().data();
     }
     return {};
 }
@@ -209,6 +340,7 @@ const std::byte* AudioBuffer::data() const
 std::byte* AudioBuffer::data()
 {
     if(isValid()) {
+        p->detachExternal();
         return p->buffer.data();
     }
     return {};
@@ -234,28 +366,37 @@ void AudioBuffer::scale(double volume)
         return;
     }
 
-    if(volume == 0.0) {
-        fillSilence();
+    if(format().sampleFormat() == SampleFormat::Unknown) {
+        qDebug() << "Unable to scale samples of unsupported format";
+        return;
+    }
+
+    Audio::applyGain(p->format, data(), frameCount(), static_cast<float>(volume));
+}
+
+void AudioBuffer::scale(double startVolume, double endVolume, RampCurve curve)
+{
+    if(!isValid() || (startVolume == 1.0 && endVolume == 1.0)) {
+        return;
+    }
+
+    if(format().sampleFormat() == SampleFormat::Unknown) {
+        qDebug() << "Unable to scale samples of unsupported format";
         return;
     }
 
-    switch(format().sampleFormat()) {
-        case(SampleFormat::U8):
-            p->scale<uint8_t>(volume);
-            break;
-        case(SampleFormat::S16):
-            p->scale<int16_t>(volume);
-            break;
-        case(SampleFormat::S24):
-        case(SampleFormat::S32):
-            p->scale<int32_t>(volume);
-            break;
-        case(SampleFormat::Float):
-            p->scale<float>(volume);
-            break;
-        case(SampleFormat::Unknown):
-        default:
-            qDebug() << "Unable to scale samples of unsupported format";
+    Audio::GainRamp ramp{static_cast<float>(startVolume), static_cast<float>(endVolume), frameCount(), 0, curve};
+    Audio::applyRamp(p->format, data(), frameCount(), ramp);
+}
+
+namespace Audio {
+void scale(const AudioFormat& format, std::byte* data, int frameCount, double volume)
+{
+    if(!data || format.sampleFormat() == SampleFormat::Unknown) {
+        return;
     }
+
+    applyGain(format, data, frameCount, static_cast<float>(volume));
 }
+} // namespace Audio
 } // namespace Fooyin
@@ -0,0 +1,156 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiobufferpool.h"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+
+namespace Fooyin {
+AudioBufferPool::AudioBufferPool()
+{
+    // Reserve up front so returning storage never allocates
+    for(auto& sizeClass : m_classes) {
+        sizeClass.reserve(MaxPerClass);
+    }
+    m_nodes.reserve(MaxNodes);
+}
+
+AudioBufferPool& AudioBufferPool::instance()
+{
+    // Intentionally leaked, as buffers may still be released during static destruction
+    static auto* pool = new AudioBufferPool();
+    return *pool;
+}
+
+std::vector<std::byte> AudioBufferPool::acquire(size_t size)
+{
+    std::vector<std::byte> storage;
+
+    if(size == 0) {
+        return storage;
+    }
+
+    const size_t required = std::bit_ceil(std::max(size, classSize(0)));
+    const auto index      = static_cast<size_t>(std::countr_zero(required)) - MinClassShift;
+
+    if(index >= ClassCount) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        storage.reserve(size);
+        return storage;
+    }
+
+    {
+        const std::scoped_lock lock{m_mutex};
+        auto& sizeClass = m_classes.at(index);
+        if(!sizeClass.empty()) {
+            storage = std::move(sizeClass.back());
+            sizeClass.pop_back();
+        }
+    }
+
+    if(storage.capacity() > 0) {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        storage.reserve(required);
+    }
+
+    return storage;
+}
+
+void AudioBufferPool::release(std::vector<std::byte>&& storage)
+{
+    const size_t capacity = storage.capacity();
+    if(capacity < classSize(0)) {
+        return;
+    }
+
+    // Round down so every buffer in a class can hold the full class size
+    const auto index = static_cast<size_t>(std::bit_width(capacity)) - 1 - MinClassShift;
+    if(index >= ClassCount) {
+        return;
+    }
+
+    storage.clear();
+
+    const std::scoped_lock lock{m_mutex};
+    auto& sizeClass = m_classes.at(index);
+    if(sizeClass.size() < MaxPerClass) {
+        sizeClass.push_back(std::move(storage));
+    }
+}
+
+void* AudioBufferPool::allocateNode(size_t size)
+{
+    {
+        const std::scoped_lock lock{m_mutex};
+        if(m_nodeSize == 0) {
+            m_nodeSize = size;
+        }
+        if(size == m_nodeSize && !m_nodes.empty()) {
+            void* node = m_nodes.back();
+            m_nodes.pop_back();
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return node;
+        }
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void AudioBufferPool::releaseNode(void* node, size_t size)
+{
+    if(!node) {
+        return;
+    }
+
+    {
+        const std::scoped_lock lock{m_mutex};
+        if(size == m_nodeSize && m_nodes.size() < MaxNodes) {
+            m_nodes.push_back(node);
+            return;
+        }
+    }
+
+    ::operator delete(node);
+}
+
+BufferPoolStats AudioBufferPool::stats() const
+{
+    BufferPoolStats stats;
+    stats.hits   = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+
+    const std::scoped_lock lock{m_mutex};
+    for(size_t i{0}; i < ClassCount; ++i) {
+        stats.pooledBytes += m_classes.at(i).size() * classSize(i);
+    }
+
+    return stats;
+}
+
+size_t AudioBufferPool::classSize(size_t index)
+{
+    return size_t{1} << (index + MinClassShift);
+}
+} // namespace Fooyin
@@ -0,0 +1,74 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/enginecontroller.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Recycles the storage behind AudioBuffer so steady-state playback doesn't touch the heap.
+ *
+ * Sample storage is grouped into power-of-two size classes, and any released buffer can satisfy a later
+ * request of the same class. Buffer bookkeeping objects, which are all the same size, are kept in a
+ * separate free list.
+ */
+class FYCORE_EXPORT AudioBufferPool
+{
+public:
+    static AudioBufferPool& instance();
+
+    /** Returns empty storage with a capacity of at least @p size bytes. */
+    std::vector<std::byte> acquire(size_t size);
+    /** Returns @p storage to the pool, or frees it if the pool already holds enough of its class. */
+    void release(std::vector<std::byte>&& storage);
+
+    void* allocateNode(size_t size);
+    void releaseNode(void* node, size_t size);
+
+    [[nodiscard]] BufferPoolStats stats() const;
+
+private:
+    AudioBufferPool();
+
+    // Classes range from 4KiB to 4MiB
+    static constexpr size_t MinClassShift = 12;
+    static constexpr size_t ClassCount    = 11;
+    static constexpr size_t MaxPerClass   = 32;
+    static constexpr size_t MaxNodes      = 256;
+
+    static size_t classSize(size_t index);
+
+    mutable std::mutex m_mutex;
+    std::array<std::vector<std::vector<std::byte>>, ClassCount> m_classes;
+    std::vector<void*> m_nodes;
+    size_t m_nodeSize{0};
+
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+};
+} // namespace Fooyin
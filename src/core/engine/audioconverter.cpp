@@ -19,45 +19,69 @@
 
 #include <core/engine/audioconverter.h>
 
+#include "audiobufferpool.h"
+#include "audiokernels.h"
+
 #include <core/engine/audiobuffer.h>
-#include <utils/math.h>
 
+#include <algorithm>
 #include <array>
-#include <cfenv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 namespace {
 using ChannelMap = std::array<int, 32>;
 
 template <typename InputType, typename OutputType, typename Func>
-void convert(const Fooyin::AudioFormat& inputFormat, const std::byte* input, const Fooyin::AudioFormat& outputFormat,
-             std::byte* output, int sampleCount, const ChannelMap& channelMap, Func&& conversionFunc)
+void convert(const std::byte* input, std::byte* output, int sampleCount, Func&& conversionFunc)
 {
-    const int inBps  = inputFormat.bytesPerSample();
-    const int outBps = outputFormat.bytesPerSample();
+    for(int i{0}; i < sampleCount; ++i) {
+        InputType inSample;
+        std::memcpy(&inSample, input + (i * sizeof(InputType)), sizeof(InputType));
 
-    const int inChannels  = inputFormat.channelCount();
-    const int outChannels = outputFormat.channelCount();
+        const OutputType outSample = conversionFunc(inSample);
+        std::memcpy(output + (i * sizeof(OutputType)), &outSample, sizeof(OutputType));
+    }
+}
 
-    for(int i{0}; i < sampleCount; ++i) {
-        for(int ch{0}; ch < outChannels; ++ch) {
-            if(channelMap.at(ch) < 0) {
-                continue;
-            }
+template <typename T>
+void remap(const std::byte* input, int inChannels, std::byte* output, int outChannels, int frameCount,
+           const ChannelMap& channelMap, T silence)
+{
+    const auto* in = reinterpret_cast<const T*>(input);
+    auto* out      = reinterpret_cast<T*>(output);
 
-            InputType inSample;
-            const auto inOffset = (i * inChannels + channelMap.at(ch)) * inBps;
-            std::memcpy(&inSample, input + inOffset, inBps);
+    for(int i{0}; i < frameCount; ++i) {
+        const T* inFrame = in + static_cast<ptrdiff_t>(i) * inChannels;
+        T* outFrame      = out + static_cast<ptrdiff_t>(i) * outChannels;
 
-            OutputType outSample = conversionFunc(inSample);
-            const auto outOffset = (i * outChannels + channelMap.at(ch)) * outBps;
-            std::memcpy(output + outOffset, &outSample, outBps);
+        for(int ch{0}; ch < outChannels; ++ch) {
+            const int inChannel = channelMap.at(ch);
+            outFrame[ch]        = inChannel < 0 ? silence : inFrame[inChannel];
         }
     }
 }
 
-uint8_t convertU8ToU8(const uint8_t inSample)
+ChannelMap defaultChannelMap(int inChannels, int outChannels)
 {
-    return inSample;
+    ChannelMap channels;
+    channels.fill(-1);
+
+    // TODO: Handle channel layout of output
+    const int count = std::min(outChannels, static_cast<int>(channels.size()));
+    for(int i{0}; i < count; ++i) {
+        if(inChannels == 1) {
+            // Upmix mono to every output channel
+            channels.at(i) = 0;
+        }
+        else if(i < inChannels) {
+            channels.at(i) = i;
+        }
+    }
+
+    return channels;
 }
 
 int16_t convertU8ToS16(const uint8_t inSample)
@@ -75,11 +99,6 @@ float convertU8ToFloat(const uint8_t inSample)
     return static_cast<float>(inSample) / 0x80 - 1.0F;
 }
 
-int16_t convertS16ToS16(const int16_t inSample)
-{
-    return inSample;
-}
-
 uint8_t convertS16ToU8(const int16_t inSample)
 {
     return static_cast<uint8_t>(inSample >> 8 ^ 0x80);
@@ -90,11 +109,6 @@ int32_t convertS16ToS32(const int16_t inSample)
     return inSample << 16;
 }
 
-float convertS16ToFloat(const int16_t inSample)
-{
-    return static_cast<float>(inSample) / static_cast<float>(std::numeric_limits<int16_t>::max());
-}
-
 uint8_t convertS32ToU8(const int32_t inSample)
 {
     return static_cast<int8_t>(inSample >> 24 ^ 0x80);
@@ -105,98 +119,50 @@ int16_t convertS32ToS16(const int32_t inSample)
     return static_cast<int16_t>(inSample >> 16);
 }
 
-int32_t convertS32ToS32(const int32_t inSample)
-{
-    return inSample;
-}
-
-float convertS32ToFloat(const int32_t inSample)
-{
-    return static_cast<float>(inSample) / static_cast<float>(std::numeric_limits<int32_t>::max());
-}
-
 uint8_t convertFloatToU8(const float inSample)
 {
-    const int prevRoundingMode = std::fegetround();
-    std::fesetround(FE_TONEAREST);
-
-    static constexpr auto minS8 = static_cast<int>(std::numeric_limits<int8_t>::min());
-    static constexpr auto maxS8 = static_cast<int>(std::numeric_limits<int8_t>::max());
-
-    int intSample = Fooyin::Math::fltToInt(inSample * 0x80);
-    intSample     = std::clamp(intSample, minS8, maxS8);
+    static constexpr auto minS8 = static_cast<float>(std::numeric_limits<int8_t>::min());
+    static constexpr auto maxS8 = static_cast<float>(std::numeric_limits<int8_t>::max());
 
-    std::fesetround(prevRoundingMode);
+    const auto intSample = static_cast<int>(std::lrint(std::clamp(inSample * 0x80, minS8, maxS8)));
 
     return static_cast<uint8_t>(intSample ^ 0x80);
 }
 
-int16_t convertFloatToS16(const float inSample)
+bool convertSamples(Fooyin::SampleFormat inFormat, const std::byte* input, Fooyin::SampleFormat outFormat,
+                    std::byte* output, int sampleCount, bool dither)
 {
-    const int prevRoundingMode = std::fegetround();
-    std::fesetround(FE_TONEAREST);
-
-    static constexpr auto minS16 = static_cast<int>(std::numeric_limits<int16_t>::min());
-    static constexpr auto maxS16 = static_cast<int>(std::numeric_limits<int16_t>::max());
-
-    int intSample = Fooyin::Math::fltToInt(inSample * 0x8000);
-    intSample     = std::clamp(intSample, minS16, maxS16);
-
-    std::fesetround(prevRoundingMode);
-
-    return static_cast<int16_t>(intSample);
-}
-
-int32_t convertFloatToS32(const float inSample)
-{
-    const int prevRoundingMode = std::fegetround();
-    std::fesetround(FE_TONEAREST);
-
-    static constexpr int minS32 = std::numeric_limits<int32_t>::min();
-    static constexpr int maxS32 = std::numeric_limits<int32_t>::max();
-
-    int intSample = Fooyin::Math::fltToInt(inSample * 0x80000000);
-    intSample     = std::clamp(intSample, minS32, maxS32);
-
-    std::fesetround(prevRoundingMode);
+    using SampleFormat = Fooyin::SampleFormat;
 
-    return intSample;
-}
+    const auto& kernels = Fooyin::Audio::sampleKernels();
+    const auto count    = static_cast<size_t>(sampleCount);
 
-float convertFloatToFloat(const float inSample)
-{
-    return inSample;
-}
+    const auto* inS16   = reinterpret_cast<const int16_t*>(input);
+    const auto* inS32   = reinterpret_cast<const int32_t*>(input);
+    const auto* inFloat = reinterpret_cast<const float*>(input);
 
-bool convertFormat(const Fooyin::AudioFormat& inFormat, const std::byte* input, const Fooyin::AudioFormat& outFormat,
-                   std::byte* output, int samples)
-{
-    ChannelMap channels;
-    std::iota(channels.begin(), channels.end(), -1);
+    const auto isS32 = [](SampleFormat format) {
+        return format == SampleFormat::S24 || format == SampleFormat::S32;
+    };
 
-    // TODO: Handle channel layout of output
-    const int outputChannels = outFormat.channelCount();
-    for(int i{0}; i < outputChannels; ++i) {
-        channels.at(i) = i;
+    if(inFormat == outFormat || (isS32(inFormat) && isS32(outFormat))) {
+        const Fooyin::AudioFormat format{inFormat, 0, 1};
+        std::memcpy(output, input, count * format.bytesPerSample());
+        return true;
     }
 
-    using SampleFormat = Fooyin::SampleFormat;
-
-    switch(inFormat.sampleFormat()) {
+    switch(inFormat) {
         case(SampleFormat::U8): {
-            switch(outFormat.sampleFormat()) {
-                case(SampleFormat::U8):
-                    convert<uint8_t, uint8_t>(inFormat, input, outFormat, output, samples, channels, convertU8ToU8);
-                    return true;
+            switch(outFormat) {
                 case(SampleFormat::S16):
-                    convert<uint8_t, int16_t>(inFormat, input, outFormat, output, samples, channels, convertU8ToS16);
+                    convert<uint8_t, int16_t>(input, output, sampleCount, convertU8ToS16);
                     return true;
                 case(SampleFormat::S24):
                 case(SampleFormat::S32):
-                    convert<uint8_t, int32_t>(inFormat, input, outFormat, output, samples, channels, convertU8ToS32);
+                    convert<uint8_t, int32_t>(input, output, sampleCount, convertU8ToS32);
                     return true;
                 case(SampleFormat::Float):
-                    convert<uint8_t, float>(inFormat, input, outFormat, output, samples, channels, convertU8ToFloat);
+                    convert<uint8_t, float>(input, output, sampleCount, convertU8ToFloat);
                     return true;
                 default:
                     break;
@@ -204,19 +170,16 @@ bool convertFormat(const Fooyin::AudioFormat& inFormat, const std::byte* input,
             break;
         }
         case(SampleFormat::S16): {
-            switch(outFormat.sampleFormat()) {
+            switch(outFormat) {
                 case(SampleFormat::U8):
-                    convert<int16_t, uint8_t>(inFormat, input, outFormat, output, samples, channels, convertS16ToU8);
-                    return true;
-                case(SampleFormat::S16):
-                    convert<int16_t, int16_t>(inFormat, input, outFormat, output, samples, channels, convertS16ToS16);
+                    convert<int16_t, uint8_t>(input, output, sampleCount, convertS16ToU8);
                     return true;
                 case(SampleFormat::S24):
                 case(SampleFormat::S32):
-                    convert<int16_t, int32_t>(inFormat, input, outFormat, output, samples, channels, convertS16ToS32);
+                    convert<int16_t, int32_t>(input, output, sampleCount, convertS16ToS32);
                     return true;
                 case(SampleFormat::Float):
-                    convert<int16_t, float>(inFormat, input, outFormat, output, samples, channels, convertS16ToFloat);
+                    kernels.s16ToFloat(inS16, reinterpret_cast<float*>(output), count);
                     return true;
                 default:
                     break;
@@ -225,19 +188,15 @@ bool convertFormat(const Fooyin::AudioFormat& inFormat, const std::byte* input,
         }
         case(SampleFormat::S24):
         case(SampleFormat::S32): {
-            switch(outFormat.sampleFormat()) {
+            switch(outFormat) {
                 case(SampleFormat::U8):
-                    convert<int32_t, uint8_t>(inFormat, input, outFormat, output, samples, channels, convertS32ToU8);
+                    convert<int32_t, uint8_t>(input, output, sampleCount, convertS32ToU8);
                     return true;
                 case(SampleFormat::S16):
-                    convert<int32_t, int16_t>(inFormat, input, outFormat, output, samples, channels, convertS32ToS16);
-                    return true;
-                case(SampleFormat::S24):
-                case(SampleFormat::S32):
-                    convert<int32_t, int32_t>(inFormat, input, outFormat, output, samples, channels, convertS32ToS32);
+                    convert<int32_t, int16_t>(input, output, sampleCount, convertS32ToS16);
                     return true;
                 case(SampleFormat::Float):
-                    convert<int32_t, float>(inFormat, input, outFormat, output, samples, channels, convertS32ToFloat);
+                    kernels.s32ToFloat(inS32, reinterpret_cast<float*>(output), count);
                     return true;
                 default:
                     break;
@@ -245,19 +204,23 @@ bool convertFormat(const Fooyin::AudioFormat& inFormat, const std::byte* input,
             break;
         }
         case(SampleFormat::Float): {
-            switch(outFormat.sampleFormat()) {
+            switch(outFormat) {
                 case(SampleFormat::U8):
-                    convert<float, uint8_t>(inFormat, input, outFormat, output, samples, channels, convertFloatToU8);
+                    convert<float, uint8_t>(input, output, sampleCount, convertFloatToU8);
                     return true;
                 case(SampleFormat::S16):
-                    convert<float, int16_t>(inFormat, input, outFormat, output, samples, channels, convertFloatToS16);
+                    if(dither) {
+                        // Keep the noise sequence running across buffers
+                        thread_local Fooyin::Audio::DitherState ditherState;
+                        kernels.floatToS16Dither(inFloat, reinterpret_cast<int16_t*>(output), count, ditherState);
+                    }
+                    else {
+                        kernels.floatToS16(inFloat, reinterpret_cast<int16_t*>(output), count);
+                    }
                     return true;
                 case(SampleFormat::S24):
                 case(SampleFormat::S32):
-                    convert<float, int32_t>(inFormat, input, outFormat, output, samples, channels, convertFloatToS32);
-                    return true;
-                case(SampleFormat::Float):
-                    convert<float, float>(inFormat, input, outFormat, output, samples, channels, convertFloatToFloat);
+                    kernels.floatToS32(inFloat, reinterpret_cast<int32_t*>(output), count);
                     return true;
                 default:
                     break;
@@ -265,15 +228,64 @@ bool convertFormat(const Fooyin::AudioFormat& inFormat, const std::byte* input,
             break;
         }
         default:
-            return false;
+            break;
     }
 
     return false;
 }
+
+bool remapChannels(const std::byte* input, const Fooyin::AudioFormat& inFormat, std::byte* output,
+                   const Fooyin::AudioFormat& outFormat, int frameCount)
+{
+    const int inChannels  = inFormat.channelCount();
+    const int outChannels = outFormat.channelCount();
+    const auto channelMap = defaultChannelMap(inChannels, outChannels);
+
+    switch(outFormat.bytesPerSample()) {
+        case(1):
+            remap<uint8_t>(input, inChannels, output, outChannels, frameCount, channelMap, 0x80);
+            return true;
+        case(2):
+            remap<int16_t>(input, inChannels, output, outChannels, frameCount, channelMap, 0);
+            return true;
+        case(4):
+            remap<int32_t>(input, inChannels, output, outChannels, frameCount, channelMap, 0);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool convertFormat(const Fooyin::AudioFormat& inFormat, const std::byte* input, const Fooyin::AudioFormat& outFormat,
+                   std::byte* output, int frameCount, bool dither)
+{
+    const int inChannels  = inFormat.channelCount();
+    const int outChannels = outFormat.channelCount();
+
+    if(inChannels == outChannels) {
+        return convertSamples(inFormat.sampleFormat(), input, outFormat.sampleFormat(), output,
+                              frameCount * inChannels, dither);
+    }
+
+    // Convert using the input layout, then map the channels onto the output layout
+    Fooyin::AudioFormat convertedFormat{inFormat};
+    convertedFormat.setSampleFormat(outFormat.sampleFormat());
+
+    auto& pool     = Fooyin::AudioBufferPool::instance();
+    auto converted = pool.acquire(static_cast<size_t>(convertedFormat.bytesForFrames(frameCount)));
+    converted.resize(static_cast<size_t>(convertedFormat.bytesForFrames(frameCount)));
+
+    const bool success = convertSamples(inFormat.sampleFormat(), input, outFormat.sampleFormat(), converted.data(),
+                                        frameCount * inChannels, dither)
+                      && remapChannels(converted.data(), convertedFormat, output, outFormat, frameCount);
+
+    pool.release(std::move(converted));
+    return success;
+}
 } // namespace
 
 namespace Fooyin::Audio {
-AudioBuffer convert(const AudioBuffer& buffer, const AudioFormat& outputFormat)
+AudioBuffer convert(const AudioBuffer& buffer, const AudioFormat& outputFormat, bool dither)
 {
     if(!buffer.isValid() || !outputFormat.isValid()) {
         return {};
@@ -282,7 +294,7 @@ AudioBuffer convert(const AudioBuffer& buffer, const AudioFormat& outputFormat)
     AudioBuffer output{outputFormat, buffer.startTime()};
     output.resize(outputFormat.bytesForFrames(buffer.frameCount()));
 
-    if(convert(buffer.format(), buffer.constData().data(), outputFormat, output.data(), buffer.frameCount())) {
+    if(convert(buffer.format(), buffer.constData().data(), outputFormat, output.data(), buffer.frameCount(), dither)) {
         return output;
     }
 
@@ -290,15 +302,12 @@ AudioBuffer convert(const AudioBuffer& buffer, const AudioFormat& outputFormat)
 }
 
 bool convert(const AudioFormat& inputFormat, const std::byte* input, const AudioFormat& outputFormat, std::byte* output,
-             int sampleCount)
+             int sampleCount, bool dither)
 {
     if(!inputFormat.isValid() || !outputFormat.isValid()) {
         return false;
     }
 
-    convertFormat(inputFormat, input, outputFormat, output, sampleCount);
-
-    return true;
+    return convertFormat(inputFormat, input, outputFormat, output, sampleCount, dither);
 }
-
 } // namespace Fooyin::Audio
@@ -0,0 +1,255 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiofingerprint.h"
+
+#include "segmentdecoder.h"
+
+#include <core/engine/audioconverter.h>
+#include <core/track.h>
+
+#include <QDebug>
+#include <QtEndian>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+constexpr int ReducedRate = 5512;
+constexpr int HopLength   = 512;
+constexpr int MaxSamples  = ReducedRate * Fooyin::AudioFingerprinter::MaxSeconds;
+constexpr double LowBand  = 300.0;
+constexpr double HighBand = 2000.0;
+constexpr double BandQ    = 8.0;
+// Below roughly -70dBFS on average, the fingerprint would only describe noise
+constexpr double SilenceEnergy = 1e-7;
+// Alignments tried either side of the start, in words, e.g. for differing encoder delay or leading silence
+constexpr int MaxShift = 8;
+// Words which must overlap for a comparison to mean anything
+constexpr int MinOverlap = 32;
+constexpr uint32_t SerialVersion = 1;
+
+namespace Fooyin {
+AudioFingerprinter::AudioFingerprinter(int sampleRate, int channels)
+    : m_channels{std::max(channels, 1)}
+    , m_step{std::max(static_cast<double>(sampleRate) / ReducedRate, 1.0)}
+{
+    const double ratio = std::pow(HighBand / LowBand, 1.0 / (Bands - 1));
+
+    for(int i{0}; i < Bands; ++i) {
+        // Band-pass with a constant 0dB peak gain, from the RBJ audio EQ cookbook
+        const double centre = LowBand * std::pow(ratio, i);
+        const double w0     = 2.0 * std::numbers::pi * centre / ReducedRate;
+        const double alpha  = std::sin(w0) / (2.0 * BandQ);
+        const double a0     = 1.0 + alpha;
+
+        Band& band = m_bands.at(i);
+        band.b0    = alpha / a0;
+        band.b2    = -alpha / a0;
+        band.a1    = -2.0 * std::cos(w0) / a0;
+        band.a2    = (1.0 - alpha) / a0;
+    }
+
+    m_words.reserve(MaxSamples / HopLength);
+}
+
+void AudioFingerprinter::addFrames(const float* data, int frameCount)
+{
+    for(int frame{0}; frame < frameCount && !isComplete(); ++frame) {
+        double mono{0.0};
+        for(int channel{0}; channel < m_channels; ++channel) {
+            mono += data[(frame * m_channels) + channel];
+        }
+
+        // Averaging over each reduced sample doubles as a (rough) low-pass filter
+        m_sum += mono / m_channels;
+        ++m_count;
+        m_phase += 1.0;
+
+        if(m_phase >= m_step) {
+            m_phase -= m_step;
+            addSample(m_sum / m_count);
+            m_sum   = 0.0;
+            m_count = 0;
+        }
+    }
+}
+
+bool AudioFingerprinter::isComplete() const
+{
+    return m_samples >= MaxSamples;
+}
+
+AudioFingerprint AudioFingerprinter::fingerprint() const
+{
+    if(m_samples == 0 || m_totalEnergy / m_samples < SilenceEnergy) {
+        return {};
+    }
+    return m_words;
+}
+
+AudioFingerprint AudioFingerprinter::fromTrack(const Track& track)
+{
+    SegmentDecoder decoder;
+    if(!decoder.init(track)) {
+        qWarning() << "[Fingerprint] Unable to open" << track.filepath();
+        return {};
+    }
+
+    AudioFormat floatFormat{decoder.format()};
+    floatFormat.setSampleFormat(SampleFormat::Float);
+
+    AudioFingerprinter fingerprinter{floatFormat.sampleRate(), floatFormat.channelCount()};
+
+    decoder.start();
+
+    while(!fingerprinter.isComplete()) {
+        AudioBuffer buffer = decoder.readBuffer();
+        if(!buffer.isValid()) {
+            break;
+        }
+
+        if(buffer.format().sampleFormat() != SampleFormat::Float) {
+            buffer = Audio::convert(buffer, floatFormat);
+        }
+
+        fingerprinter.addFrames(reinterpret_cast<const float*>(buffer.constData().data()), buffer.frameCount());
+    }
+
+    decoder.stop();
+
+    return fingerprinter.fingerprint();
+}
+
+double AudioFingerprinter::distance(const AudioFingerprint& one, const AudioFingerprint& two)
+{
+    double best{1.0};
+
+    for(int shift{-MaxShift}; shift <= MaxShift; ++shift) {
+        const size_t oneStart = shift > 0 ? static_cast<size_t>(shift) : 0;
+        const size_t twoStart = shift < 0 ? static_cast<size_t>(-shift) : 0;
+        if(oneStart >= one.size() || twoStart >= two.size()) {
+            continue;
+        }
+
+        const size_t overlap = std::min(one.size() - oneStart, two.size() - twoStart);
+        if(overlap < MinOverlap) {
+            continue;
+        }
+
+        uint64_t differing{0};
+        for(size_t i{0}; i < overlap; ++i) {
+            differing += static_cast<uint64_t>(std::popcount(one[oneStart + i] ^ two[twoStart + i]));
+        }
+
+        best = std::min(best, static_cast<double>(differing) / static_cast<double>(overlap * 32));
+    }
+
+    return best;
+}
+
+QByteArray AudioFingerprinter::serialise(const AudioFingerprint& fingerprint)
+{
+    if(fingerprint.empty()) {
+        return {};
+    }
+
+    QByteArray data{static_cast<qsizetype>((fingerprint.size() + 1) * sizeof(uint32_t)), Qt::Uninitialized};
+    auto* out = data.data();
+
+    qToLittleEndian(SerialVersion, out);
+    for(const uint32_t word : fingerprint) {
+        out += sizeof(uint32_t);
+        qToLittleEndian(word, out);
+    }
+
+    return data;
+}
+
+AudioFingerprint AudioFingerprinter::deserialise(const QByteArray& data)
+{
+    const auto count = static_cast<size_t>(data.size()) / sizeof(uint32_t);
+    if(count < 2 || qFromLittleEndian<uint32_t>(data.constData()) != SerialVersion) {
+        return {};
+    }
+
+    AudioFingerprint fingerprint(count - 1);
+    for(size_t i{0}; i < fingerprint.size(); ++i) {
+        fingerprint[i] = qFromLittleEndian<uint32_t>(data.constData() + ((i + 1) * sizeof(uint32_t)));
+    }
+
+    return fingerprint;
+}
+
+void AudioFingerprinter::addSample(double sample)
+{
+    ++m_samples;
+    m_totalEnergy += sample * sample;
+
+    auto& energies = m_hopEnergies.at(m_hops % 4);
+
+    for(int i{0}; i < Bands; ++i) {
+        Band& band = m_bands[i];
+
+        // Transposed direct form II, with b1 being zero for a band-pass
+        const double out = (band.b0 * sample) + band.state[0];
+        band.state[0]    = band.state[1] - (band.a1 * out);
+        band.state[1]    = (band.b2 * sample) - (band.a2 * out);
+
+        energies[i] += out * out;
+    }
+
+    if(++m_hopSamples == HopLength) {
+        finishHop();
+    }
+}
+
+void AudioFingerprinter::finishHop()
+{
+    m_hopSamples = 0;
+    ++m_hops;
+
+    if(m_hops >= 4) {
+        std::array<double, Bands> frame{};
+        for(const auto& energies : m_hopEnergies) {
+            for(int i{0}; i < Bands; ++i) {
+                frame[i] += energies[i];
+            }
+        }
+
+        if(m_hops > 4) {
+            // Each bit is whether the energy difference between neighbouring bands rose since the last frame
+            uint32_t word{0};
+            for(int i{0}; i < Bands - 1; ++i) {
+                const double change = (frame[i] - frame[i + 1]) - (m_previous[i] - m_previous[i + 1]);
+                if(change > 0.0) {
+                    word |= 1U << i;
+                }
+            }
+            m_words.push_back(word);
+        }
+
+        m_previous = frame;
+    }
+
+    // The oldest hop is replaced by the next one
+    m_hopEnergies.at(m_hops % 4).fill(0.0);
+}
+} // namespace Fooyin
@@ -0,0 +1,103 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QByteArray>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Fooyin {
+class Track;
+
+using AudioFingerprint = std::vector<uint32_t>;
+// Fingerprints by track id
+using TrackFingerprintMap = std::unordered_map<int, AudioFingerprint>;
+
+/*!
+ * Computes a compact acoustic fingerprint of the start of a track, following Haitsma and Kalker.
+ * Audio is mixed to mono at around 5.5kHz, and every 93ms gives a 32-bit word from the changes in energy
+ * between 33 bands from 300Hz to 2kHz. The same recording gives nearly the same words whatever its tags,
+ * container or encoding, so it identifies files which were moved and retagged.
+ */
+class FYCORE_EXPORT AudioFingerprinter
+{
+public:
+    // Only the start of each track is used, which is enough to tell recordings apart
+    static constexpr int MaxSeconds = 30;
+    static constexpr int Bands      = 33;
+
+    AudioFingerprinter(int sampleRate, int channels);
+
+    void addFrames(const float* data, int frameCount);
+    /** Returns @c true once MaxSeconds have been added, after which further frames are ignored. */
+    [[nodiscard]] bool isComplete() const;
+    /** Returns the fingerprint of everything added so far, which is empty for silent or very short audio. */
+    [[nodiscard]] AudioFingerprint fingerprint() const;
+
+    /** Decodes the start of @p track and returns its fingerprint, or an empty one if it can't be read. */
+    static AudioFingerprint fromTrack(const Track& track);
+
+    /*!
+     * Returns the proportion of bits which differ between @p one and @p two at their best alignment.
+     * Copies of the same recording are close to 0 and unrelated audio is around 0.5.
+     * Returns 1.0 if they're too short to compare.
+     */
+    static double distance(const AudioFingerprint& one, const AudioFingerprint& two);
+
+    static QByteArray serialise(const AudioFingerprint& fingerprint);
+    static AudioFingerprint deserialise(const QByteArray& data);
+
+private:
+    struct Band
+    {
+        double b0{0.0};
+        double b2{0.0};
+        double a1{0.0};
+        double a2{0.0};
+        std::array<double, 2> state{};
+    };
+
+    void addSample(double sample);
+    void finishHop();
+
+    int m_channels;
+    // Input samples per reduced sample
+    double m_step;
+    double m_phase{0.0};
+    double m_sum{0.0};
+    int m_count{0};
+    int m_samples{0};
+
+    std::array<Band, Bands> m_bands;
+    // Each frame spans four hops, so its energy is kept for the last four
+    std::array<std::array<double, Bands>, 4> m_hopEnergies{};
+    int m_hopSamples{0};
+    int m_hops{0};
+    std::array<double, Bands> m_previous{};
+    double m_totalEnergy{0.0};
+
+    AudioFingerprint m_words;
+};
+} // namespace Fooyin
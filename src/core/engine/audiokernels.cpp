@@ -0,0 +1,1097 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audiokernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numbers>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define FY_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define FY_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+constexpr float S16Max     = static_cast<float>(std::numeric_limits<int16_t>::max());
+constexpr float S32Max     = static_cast<float>(std::numeric_limits<int32_t>::max());
+constexpr float S16Scale   = 32768.0F;
+constexpr float S32Scale   = 2147483648.0F;
+constexpr float S16Lowest  = -32768.0F;
+constexpr float S16Highest = 32767.0F;
+constexpr float S32Lowest  = -2147483648.0F;
+// Largest float below 2^31
+constexpr float S32Highest = 2147483520.0F;
+// Scales a 24bit random integer to [0, 1)
+constexpr float DitherScale = 1.0F / 16777216.0F;
+// Number of per-sample gains computed at once when applying a ramp
+constexpr int RampBlockSize = 1024;
+
+uint32_t nextRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+float ditherNoise(uint32_t& state)
+{
+    const auto a = static_cast<float>(nextRandom(state) >> 8);
+    const auto b = static_cast<float>(nextRandom(state) >> 8);
+    return (a - b) * DitherScale;
+}
+
+void s16ToFloatScalar(const int16_t* in, float* out, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) / S16Max;
+    }
+}
+
+void s32ToFloatScalar(const int32_t* in, float* out, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) / S32Max;
+    }
+}
+
+void floatToS16Scalar(const float* in, int16_t* out, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        out[i] = static_cast<int16_t>(std::lrint(std::clamp(in[i] * S16Scale, S16Lowest, S16Highest)));
+    }
+}
+
+void floatToS32Scalar(const float* in, int32_t* out, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        out[i] = static_cast<int32_t>(std::lrint(std::clamp(in[i] * S32Scale, S32Lowest, S32Highest)));
+    }
+}
+
+void floatToS16DitherScalar(const float* in, int16_t* out, size_t count, size_t offset,
+                            Fooyin::Audio::DitherState& state)
+{
+    for(size_t i{offset}; i < count; ++i) {
+        auto& seed           = state.seeds[i % Fooyin::Audio::DitherState::Lanes];
+        const float noise    = ditherNoise(seed);
+        const float dithered = std::clamp((in[i] * S16Scale) + noise, S16Lowest, S16Highest);
+        out[i]               = static_cast<int16_t>(std::lrint(dithered));
+    }
+}
+
+void floatToS16DitherScalar(const float* in, int16_t* out, size_t count, Fooyin::Audio::DitherState& state)
+{
+    floatToS16DitherScalar(in, out, count, 0, state);
+}
+
+void scaleS16Scalar(int16_t* data, size_t count, float gain)
+{
+    for(size_t i{0}; i < count; ++i) {
+        const float sample = static_cast<float>(data[i]) * gain;
+        data[i]            = static_cast<int16_t>(std::lrint(std::clamp(sample, S16Lowest, S16Highest)));
+    }
+}
+
+void scaleS32Scalar(int32_t* data, size_t count, float gain)
+{
+    for(size_t i{0}; i < count; ++i) {
+        const float sample = static_cast<float>(data[i]) * gain;
+        data[i]            = static_cast<int32_t>(std::lrint(std::clamp(sample, S32Lowest, S32Highest)));
+    }
+}
+
+void scaleFloatScalar(float* data, size_t count, float gain)
+{
+    for(size_t i{0}; i < count; ++i) {
+        data[i] *= gain;
+    }
+}
+
+void multiplyS16Scalar(int16_t* data, const float* gains, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        const float sample = static_cast<float>(data[i]) * gains[i];
+        data[i]            = static_cast<int16_t>(std::lrint(std::clamp(sample, S16Lowest, S16Highest)));
+    }
+}
+
+void multiplyS32Scalar(int32_t* data, const float* gains, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        const float sample = static_cast<float>(data[i]) * gains[i];
+        data[i]            = static_cast<int32_t>(std::lrint(std::clamp(sample, S32Lowest, S32Highest)));
+    }
+}
+
+void multiplyFloatScalar(float* data, const float* gains, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        data[i] *= gains[i];
+    }
+}
+
+void mixS16Scalar(int16_t* data, const int16_t* in, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        const int sum = static_cast<int>(data[i]) + static_cast<int>(in[i]);
+        data[i]       = static_cast<int16_t>(std::clamp<int>(sum, std::numeric_limits<int16_t>::min(),
+                                                             std::numeric_limits<int16_t>::max()));
+    }
+}
+
+void mixS32Scalar(int32_t* data, const int32_t* in, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        const int64_t sum = static_cast<int64_t>(data[i]) + static_cast<int64_t>(in[i]);
+        data[i]           = static_cast<int32_t>(std::clamp<int64_t>(sum, std::numeric_limits<int32_t>::min(),
+                                                                     std::numeric_limits<int32_t>::max()));
+    }
+}
+
+void mixFloatScalar(float* data, const float* in, size_t count)
+{
+    for(size_t i{0}; i < count; ++i) {
+        data[i] += in[i];
+    }
+}
+
+#if defined(FY_KERNELS_X86)
+// SSE2 is part of the x86-64 baseline, so these need no runtime check
+
+void s16ToFloatSse2(const int16_t* in, float* out, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(S16Max);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i lo      = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        const __m128i hi      = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(out + i, _mm_div_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_div_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+
+    s16ToFloatScalar(in + i, out + i, count - i);
+}
+
+void s32ToFloatSse2(const int32_t* in, float* out, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(S32Max);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(out + i, _mm_div_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+
+    s32ToFloatScalar(in + i, out + i, count - i);
+}
+
+void floatToS16Sse2(const float* in, int16_t* out, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(S16Scale);
+    const __m128 low   = _mm_set1_ps(S16Lowest);
+    const __m128 high  = _mm_set1_ps(S16Highest);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128 a  = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), low), high);
+        const __m128 b  = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), low), high);
+        const __m128i s = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), s);
+    }
+
+    floatToS16Scalar(in + i, out + i, count - i);
+}
+
+void floatToS32Sse2(const float* in, int32_t* out, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(S32Scale);
+    const __m128 low   = _mm_set1_ps(S32Lowest);
+    const __m128 high  = _mm_set1_ps(S32Highest);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), low), high);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_cvtps_epi32(a));
+    }
+
+    floatToS32Scalar(in + i, out + i, count - i);
+}
+
+__m128i nextRandomSse2(__m128i& state)
+{
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+    state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+    return state;
+}
+
+__m128 ditherNoiseSse2(__m128i& state)
+{
+    const __m128 a = _mm_cvtepi32_ps(_mm_srli_epi32(nextRandomSse2(state), 8));
+    const __m128 b = _mm_cvtepi32_ps(_mm_srli_epi32(nextRandomSse2(state), 8));
+    return _mm_mul_ps(_mm_sub_ps(a, b), _mm_set1_ps(DitherScale));
+}
+
+void floatToS16DitherSse2(const float* in, int16_t* out, size_t count, Fooyin::Audio::DitherState& state)
+{
+    const __m128 scale = _mm_set1_ps(S16Scale);
+    const __m128 low   = _mm_set1_ps(S16Lowest);
+    const __m128 high  = _mm_set1_ps(S16Highest);
+
+    __m128i seedsLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.seeds.data()));
+    __m128i seedsHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.seeds.data() + 4));
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        __m128 a = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), ditherNoiseSse2(seedsLo));
+        __m128 b = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), ditherNoiseSse2(seedsHi));
+        a        = _mm_min_ps(_mm_max_ps(a, low), high);
+        b        = _mm_min_ps(_mm_max_ps(b, low), high);
+        const __m128i s = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), s);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state.seeds.data()), seedsLo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state.seeds.data() + 4), seedsHi);
+
+    floatToS16DitherScalar(in, out, count, i, state);
+}
+
+[[gnu::target("avx2")]] void s16ToFloatAvx2(const int16_t* in, float* out, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(S16Max);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(samples)), scale));
+    }
+
+    s16ToFloatScalar(in + i, out + i, count - i);
+}
+
+[[gnu::target("avx2")]] void s32ToFloatAvx2(const int32_t* in, float* out, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(S32Max);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+
+    s32ToFloatScalar(in + i, out + i, count - i);
+}
+
+[[gnu::target("avx2")]] void floatToS16Avx2(const float* in, int16_t* out, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(S16Scale);
+    const __m256 low   = _mm256_set1_ps(S16Lowest);
+    const __m256 high  = _mm256_set1_ps(S16Highest);
+
+    size_t i{0};
+    for(; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), low), high);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), low), high);
+        // packs works within 128bit lanes, so restore sample order afterwards
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+
+    floatToS16Sse2(in + i, out + i, count - i);
+}
+
+[[gnu::target("avx2")]] void floatToS32Avx2(const float* in, int32_t* out, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(S32Scale);
+    const __m256 low   = _mm256_set1_ps(S32Lowest);
+    const __m256 high  = _mm256_set1_ps(S32Highest);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), low), high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtps_epi32(a));
+    }
+
+    floatToS32Scalar(in + i, out + i, count - i);
+}
+
+[[gnu::target("avx2")]] __m256i nextRandomAvx2(__m256i& state)
+{
+    state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+    state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+    state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+    return state;
+}
+
+[[gnu::target("avx2")]] void floatToS16DitherAvx2(const float* in, int16_t* out, size_t count,
+                                                    Fooyin::Audio::DitherState& state)
+{
+    const __m256 scale       = _mm256_set1_ps(S16Scale);
+    const __m256 low         = _mm256_set1_ps(S16Lowest);
+    const __m256 high        = _mm256_set1_ps(S16Highest);
+    const __m256 ditherScale = _mm256_set1_ps(DitherScale);
+
+    __m256i seeds = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state.seeds.data()));
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const __m256 r1    = _mm256_cvtepi32_ps(_mm256_srli_epi32(nextRandomAvx2(seeds), 8));
+        const __m256 r2    = _mm256_cvtepi32_ps(_mm256_srli_epi32(nextRandomAvx2(seeds), 8));
+        const __m256 noise = _mm256_mul_ps(_mm256_sub_ps(r1, r2), ditherScale);
+
+        __m256 a = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), noise);
+        a        = _mm256_min_ps(_mm256_max_ps(a, low), high);
+
+        const __m256i ints = _mm256_cvtps_epi32(a);
+        const __m128i s    = _mm_packs_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), s);
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(state.seeds.data()), seeds);
+
+    floatToS16DitherScalar(in, out, count, i, state);
+}
+
+__m128i scaleS32Sse2(__m128i samples, __m128 gain)
+{
+    const __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(samples), gain);
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(a, _mm_set1_ps(S32Lowest)), _mm_set1_ps(S32Highest)));
+}
+
+__m128i scaleS16Sse2(__m128i samples, __m128 gainLo, __m128 gainHi)
+{
+    const __m128 low  = _mm_set1_ps(S16Lowest);
+    const __m128 high = _mm_set1_ps(S16Highest);
+
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+    lo        = _mm_min_ps(_mm_max_ps(_mm_mul_ps(lo, gainLo), low), high);
+    hi        = _mm_min_ps(_mm_max_ps(_mm_mul_ps(hi, gainHi), low), high);
+
+    return _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+}
+
+void scaleS16Sse2(int16_t* data, size_t count, float gain)
+{
+    const __m128 scale = _mm_set1_ps(gain);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, scaleS16Sse2(_mm_loadu_si128(ptr), scale, scale));
+    }
+
+    scaleS16Scalar(data + i, count - i, gain);
+}
+
+void scaleS32Sse2(int32_t* data, size_t count, float gain)
+{
+    const __m128 scale = _mm_set1_ps(gain);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, scaleS32Sse2(_mm_loadu_si128(ptr), scale));
+    }
+
+    scaleS32Scalar(data + i, count - i, gain);
+}
+
+void scaleFloatSse2(float* data, size_t count, float gain)
+{
+    const __m128 scale = _mm_set1_ps(gain);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), scale));
+    }
+
+    scaleFloatScalar(data + i, count - i, gain);
+}
+
+void multiplyS16Sse2(int16_t* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, scaleS16Sse2(_mm_loadu_si128(ptr), _mm_loadu_ps(gains + i), _mm_loadu_ps(gains + i + 4)));
+    }
+
+    multiplyS16Scalar(data + i, gains + i, count - i);
+}
+
+void multiplyS32Sse2(int32_t* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, scaleS32Sse2(_mm_loadu_si128(ptr), _mm_loadu_ps(gains + i)));
+    }
+
+    multiplyS32Scalar(data + i, gains + i, count - i);
+}
+
+void multiplyFloatSse2(float* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(gains + i)));
+    }
+
+    multiplyFloatScalar(data + i, gains + i, count - i);
+}
+
+void mixS16Sse2(int16_t* data, const int16_t* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, _mm_adds_epi16(_mm_loadu_si128(ptr),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+    }
+
+    mixS16Scalar(data + i, in + i, count - i);
+}
+
+// SSE2 has no saturating 32bit add, so overflowed lanes are replaced with the limit matching their sign
+__m128i addsS32Sse2(__m128i a, __m128i b)
+{
+    const __m128i sum       = _mm_add_epi32(a, b);
+    const __m128i overflow  = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(a, sum), _mm_xor_si128(b, sum)), 31);
+    const __m128i saturated = _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(std::numeric_limits<int32_t>::max()));
+    return _mm_or_si128(_mm_and_si128(overflow, saturated), _mm_andnot_si128(overflow, sum));
+}
+
+void mixS32Sse2(int32_t* data, const int32_t* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr,
+                         addsS32Sse2(_mm_loadu_si128(ptr), _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+    }
+
+    mixS32Scalar(data + i, in + i, count - i);
+}
+
+void mixFloatSse2(float* data, const float* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_add_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(in + i)));
+    }
+
+    mixFloatScalar(data + i, in + i, count - i);
+}
+
+[[gnu::target("avx2")]] __m256i scaleS32Avx2(__m256i samples, __m256 gain)
+{
+    const __m256 a = _mm256_mul_ps(_mm256_cvtepi32_ps(samples), gain);
+    return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(a, _mm256_set1_ps(S32Lowest)), _mm256_set1_ps(S32Highest)));
+}
+
+[[gnu::target("avx2")]] __m128i scaleS16Avx2(__m128i samples, __m256 gain)
+{
+    __m256 a = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(samples)), gain);
+    a        = _mm256_min_ps(_mm256_max_ps(a, _mm256_set1_ps(S16Lowest)), _mm256_set1_ps(S16Highest));
+
+    const __m256i ints = _mm256_cvtps_epi32(a);
+    return _mm_packs_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+}
+
+[[gnu::target("avx2")]] void scaleS16Avx2(int16_t* data, size_t count, float gain)
+{
+    const __m256 scale = _mm256_set1_ps(gain);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, scaleS16Avx2(_mm_loadu_si128(ptr), scale));
+    }
+
+    scaleS16Scalar(data + i, count - i, gain);
+}
+
+[[gnu::target("avx2")]] void scaleS32Avx2(int32_t* data, size_t count, float gain)
+{
+    const __m256 scale = _mm256_set1_ps(gain);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(ptr, scaleS32Avx2(_mm256_loadu_si256(ptr), scale));
+    }
+
+    scaleS32Scalar(data + i, count - i, gain);
+}
+
+[[gnu::target("avx2")]] void scaleFloatAvx2(float* data, size_t count, float gain)
+{
+    const __m256 scale = _mm256_set1_ps(gain);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), scale));
+    }
+
+    scaleFloatScalar(data + i, count - i, gain);
+}
+
+[[gnu::target("avx2")]] void multiplyS16Avx2(int16_t* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, scaleS16Avx2(_mm_loadu_si128(ptr), _mm256_loadu_ps(gains + i)));
+    }
+
+    multiplyS16Scalar(data + i, gains + i, count - i);
+}
+
+[[gnu::target("avx2")]] void multiplyS32Avx2(int32_t* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(ptr, scaleS32Avx2(_mm256_loadu_si256(ptr), _mm256_loadu_ps(gains + i)));
+    }
+
+    multiplyS32Scalar(data + i, gains + i, count - i);
+}
+
+[[gnu::target("avx2")]] void multiplyFloatAvx2(float* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), _mm256_loadu_ps(gains + i)));
+    }
+
+    multiplyFloatScalar(data + i, gains + i, count - i);
+}
+
+[[gnu::target("avx2")]] void mixS16Avx2(int16_t* data, const int16_t* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 16 <= count; i += 16) {
+        auto* ptr = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(ptr, _mm256_adds_epi16(_mm256_loadu_si256(ptr),
+                                                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i))));
+    }
+
+    mixS16Scalar(data + i, in + i, count - i);
+}
+
+[[gnu::target("avx2")]] void mixS32Avx2(int32_t* data, const int32_t* in, size_t count)
+{
+    const __m256i max = _mm256_set1_epi32(std::numeric_limits<int32_t>::max());
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        auto* ptr       = reinterpret_cast<__m256i*>(data + i);
+        const __m256i a = _mm256_loadu_si256(ptr);
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+
+        const __m256i sum       = _mm256_add_epi32(a, b);
+        const __m256i overflow  = _mm256_and_si256(_mm256_xor_si256(a, sum), _mm256_xor_si256(b, sum));
+        const __m256i saturated = _mm256_xor_si256(_mm256_srai_epi32(a, 31), max);
+        _mm256_storeu_si256(ptr, _mm256_castps_si256(_mm256_blendv_ps(
+                                     _mm256_castsi256_ps(sum), _mm256_castsi256_ps(saturated),
+                                     _mm256_castsi256_ps(overflow))));
+    }
+
+    mixS32Scalar(data + i, in + i, count - i);
+}
+
+[[gnu::target("avx2")]] void mixFloatAvx2(float* data, const float* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_add_ps(_mm256_loadu_ps(data + i), _mm256_loadu_ps(in + i)));
+    }
+
+    mixFloatScalar(data + i, in + i, count - i);
+}
+
+bool hasAvx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+#if defined(FY_KERNELS_NEON)
+void s16ToFloatNeon(const int16_t* in, float* out, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(S16Max);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const int16x8_t samples = vld1q_s16(in + i);
+        vst1q_f32(out + i, vdivq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), scale));
+        vst1q_f32(out + i + 4, vdivq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+    }
+
+    s16ToFloatScalar(in + i, out + i, count - i);
+}
+
+void s32ToFloatNeon(const int32_t* in, float* out, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(S32Max);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vdivq_f32(vcvtq_f32_s32(vld1q_s32(in + i)), scale));
+    }
+
+    s32ToFloatScalar(in + i, out + i, count - i);
+}
+
+void floatToS16Neon(const float* in, int16_t* out, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(S16Scale);
+    const float32x4_t low   = vdupq_n_f32(S16Lowest);
+    const float32x4_t high  = vdupq_n_f32(S16Highest);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        const float32x4_t a = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(in + i), scale), low), high);
+        const float32x4_t b = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(in + i + 4), scale), low), high);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+
+    floatToS16Scalar(in + i, out + i, count - i);
+}
+
+void floatToS32Neon(const float* in, int32_t* out, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(S32Scale);
+    const float32x4_t low   = vdupq_n_f32(S32Lowest);
+    const float32x4_t high  = vdupq_n_f32(S32Highest);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        const float32x4_t a = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(in + i), scale), low), high);
+        vst1q_s32(out + i, vcvtnq_s32_f32(a));
+    }
+
+    floatToS32Scalar(in + i, out + i, count - i);
+}
+
+uint32x4_t nextRandomNeon(uint32x4_t& state)
+{
+    state = veorq_u32(state, vshlq_n_u32(state, 13));
+    state = veorq_u32(state, vshrq_n_u32(state, 17));
+    state = veorq_u32(state, vshlq_n_u32(state, 5));
+    return state;
+}
+
+float32x4_t ditherNoiseNeon(uint32x4_t& state)
+{
+    const float32x4_t a = vcvtq_f32_u32(vshrq_n_u32(nextRandomNeon(state), 8));
+    const float32x4_t b = vcvtq_f32_u32(vshrq_n_u32(nextRandomNeon(state), 8));
+    return vmulq_f32(vsubq_f32(a, b), vdupq_n_f32(DitherScale));
+}
+
+void floatToS16DitherNeon(const float* in, int16_t* out, size_t count, Fooyin::Audio::DitherState& state)
+{
+    const float32x4_t scale = vdupq_n_f32(S16Scale);
+    const float32x4_t low   = vdupq_n_f32(S16Lowest);
+    const float32x4_t high  = vdupq_n_f32(S16Highest);
+
+    uint32x4_t seedsLo = vld1q_u32(state.seeds.data());
+    uint32x4_t seedsHi = vld1q_u32(state.seeds.data() + 4);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        // Keep the multiply and add separate so results match the scalar reference
+        float32x4_t a = vaddq_f32(vmulq_f32(vld1q_f32(in + i), scale), ditherNoiseNeon(seedsLo));
+        float32x4_t b = vaddq_f32(vmulq_f32(vld1q_f32(in + i + 4), scale), ditherNoiseNeon(seedsHi));
+        a             = vminq_f32(vmaxq_f32(a, low), high);
+        b             = vminq_f32(vmaxq_f32(b, low), high);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+
+    vst1q_u32(state.seeds.data(), seedsLo);
+    vst1q_u32(state.seeds.data() + 4, seedsHi);
+
+    floatToS16DitherScalar(in, out, count, i, state);
+}
+int32x4_t scaleS32Neon(int32x4_t samples, float32x4_t gain)
+{
+    const float32x4_t a = vmulq_f32(vcvtq_f32_s32(samples), gain);
+    return vcvtnq_s32_f32(vminq_f32(vmaxq_f32(a, vdupq_n_f32(S32Lowest)), vdupq_n_f32(S32Highest)));
+}
+
+int16x8_t scaleS16Neon(int16x8_t samples, float32x4_t gainLo, float32x4_t gainHi)
+{
+    const float32x4_t low  = vdupq_n_f32(S16Lowest);
+    const float32x4_t high = vdupq_n_f32(S16Highest);
+
+    float32x4_t lo = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), gainLo);
+    float32x4_t hi = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), gainHi);
+    lo             = vminq_f32(vmaxq_f32(lo, low), high);
+    hi             = vminq_f32(vmaxq_f32(hi, low), high);
+
+    return vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(lo)), vqmovn_s32(vcvtnq_s32_f32(hi)));
+}
+
+void scaleS16Neon(int16_t* data, size_t count, float gain)
+{
+    const float32x4_t scale = vdupq_n_f32(gain);
+
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        vst1q_s16(data + i, scaleS16Neon(vld1q_s16(data + i), scale, scale));
+    }
+
+    scaleS16Scalar(data + i, count - i, gain);
+}
+
+void scaleS32Neon(int32_t* data, size_t count, float gain)
+{
+    const float32x4_t scale = vdupq_n_f32(gain);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        vst1q_s32(data + i, scaleS32Neon(vld1q_s32(data + i), scale));
+    }
+
+    scaleS32Scalar(data + i, count - i, gain);
+}
+
+void scaleFloatNeon(float* data, size_t count, float gain)
+{
+    const float32x4_t scale = vdupq_n_f32(gain);
+
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), scale));
+    }
+
+    scaleFloatScalar(data + i, count - i, gain);
+}
+
+void multiplyS16Neon(int16_t* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        vst1q_s16(data + i, scaleS16Neon(vld1q_s16(data + i), vld1q_f32(gains + i), vld1q_f32(gains + i + 4)));
+    }
+
+    multiplyS16Scalar(data + i, gains + i, count - i);
+}
+
+void multiplyS32Neon(int32_t* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        vst1q_s32(data + i, scaleS32Neon(vld1q_s32(data + i), vld1q_f32(gains + i)));
+    }
+
+    multiplyS32Scalar(data + i, gains + i, count - i);
+}
+
+void multiplyFloatNeon(float* data, const float* gains, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), vld1q_f32(gains + i)));
+    }
+
+    multiplyFloatScalar(data + i, gains + i, count - i);
+}
+
+void mixS16Neon(int16_t* data, const int16_t* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 8 <= count; i += 8) {
+        vst1q_s16(data + i, vqaddq_s16(vld1q_s16(data + i), vld1q_s16(in + i)));
+    }
+
+    mixS16Scalar(data + i, in + i, count - i);
+}
+
+void mixS32Neon(int32_t* data, const int32_t* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        vst1q_s32(data + i, vqaddq_s32(vld1q_s32(data + i), vld1q_s32(in + i)));
+    }
+
+    mixS32Scalar(data + i, in + i, count - i);
+}
+
+void mixFloatNeon(float* data, const float* in, size_t count)
+{
+    size_t i{0};
+    for(; i + 4 <= count; i += 4) {
+        vst1q_f32(data + i, vaddq_f32(vld1q_f32(data + i), vld1q_f32(in + i)));
+    }
+
+    mixFloatScalar(data + i, in + i, count - i);
+}
+#endif
+
+Fooyin::Audio::SampleKernels selectKernels()
+{
+#if defined(FY_KERNELS_X86)
+    if(hasAvx2()) {
+        return {"avx2",
+                s16ToFloatAvx2,
+                s32ToFloatAvx2,
+                floatToS16Avx2,
+                floatToS32Avx2,
+                floatToS16DitherAvx2,
+                scaleS16Avx2,
+                scaleS32Avx2,
+                scaleFloatAvx2,
+                multiplyS16Avx2,
+                multiplyS32Avx2,
+                multiplyFloatAvx2,
+                mixS16Avx2,
+                mixS32Avx2,
+                mixFloatAvx2};
+    }
+    return {"sse2",
+            s16ToFloatSse2,
+            s32ToFloatSse2,
+            floatToS16Sse2,
+            floatToS32Sse2,
+            floatToS16DitherSse2,
+            scaleS16Sse2,
+            scaleS32Sse2,
+            scaleFloatSse2,
+            multiplyS16Sse2,
+            multiplyS32Sse2,
+            multiplyFloatSse2,
+            mixS16Sse2,
+            mixS32Sse2,
+            mixFloatSse2};
+#elif defined(FY_KERNELS_NEON)
+    return {"neon",
+            s16ToFloatNeon,
+            s32ToFloatNeon,
+            floatToS16Neon,
+            floatToS32Neon,
+            floatToS16DitherNeon,
+            scaleS16Neon,
+            scaleS32Neon,
+            scaleFloatNeon,
+            multiplyS16Neon,
+            multiplyS32Neon,
+            multiplyFloatNeon,
+            mixS16Neon,
+            mixS32Neon,
+            mixFloatNeon};
+#else
+    return Fooyin::Audio::scalarSampleKernels();
+#endif
+}
+} // namespace
+
+namespace Fooyin::Audio {
+const SampleKernels& sampleKernels()
+{
+    static const SampleKernels kernels = selectKernels();
+    return kernels;
+}
+
+const SampleKernels& scalarSampleKernels()
+{
+    static const SampleKernels kernels{"scalar",
+                                       s16ToFloatScalar,
+                                       s32ToFloatScalar,
+                                       floatToS16Scalar,
+                                       floatToS32Scalar,
+                                       floatToS16DitherScalar,
+                                       scaleS16Scalar,
+                                       scaleS32Scalar,
+                                       scaleFloatScalar,
+                                       multiplyS16Scalar,
+                                       multiplyS32Scalar,
+                                       multiplyFloatScalar,
+                                       mixS16Scalar,
+                                       mixS32Scalar,
+                                       mixFloatScalar};
+    return kernels;
+}
+
+float GainRamp::gainAt(int frame) const
+{
+    if(length <= 0 || frame >= length) {
+        return to;
+    }
+
+    const float t = static_cast<float>(std::max(frame, 0)) / static_cast<float>(length);
+
+    if(curve == AudioBuffer::RampCurve::EqualPower) {
+        static constexpr auto HalfPi = std::numbers::pi_v<float> / 2;
+        if(to > from) {
+            return from + ((to - from) * std::sin(t * HalfPi));
+        }
+        return to + ((from - to) * std::cos(t * HalfPi));
+    }
+
+    return from + ((to - from) * t);
+}
+
+void applyGain(const AudioFormat& format, std::byte* data, int frameCount, float gain)
+{
+    if(gain == 1.0F || frameCount <= 0) {
+        return;
+    }
+
+    const int sampleCount = frameCount * format.channelCount();
+    const auto count      = static_cast<size_t>(sampleCount);
+
+    if(gain == 0.0F) {
+        const bool unsignedFormat = format.sampleFormat() == SampleFormat::U8;
+        std::memset(data, unsignedFormat ? 0x80 : 0, static_cast<size_t>(format.bytesForFrames(frameCount)));
+        return;
+    }
+
+    const auto& kernels = sampleKernels();
+
+    switch(format.sampleFormat()) {
+        case(SampleFormat::U8): {
+            auto* samples = reinterpret_cast<uint8_t*>(data);
+            for(size_t i{0}; i < count; ++i) {
+                const float sample = std::clamp((static_cast<float>(samples[i]) - 128.0F) * gain, -128.0F, 127.0F);
+                samples[i]         = static_cast<uint8_t>(std::lrint(sample) + 128);
+            }
+            break;
+        }
+        case(SampleFormat::S16):
+            kernels.scaleS16(reinterpret_cast<int16_t*>(data), count, gain);
+            break;
+        case(SampleFormat::S24):
+        case(SampleFormat::S32):
+            kernels.scaleS32(reinterpret_cast<int32_t*>(data), count, gain);
+            break;
+        case(SampleFormat::Float):
+            kernels.scaleFloat(reinterpret_cast<float*>(data), count, gain);
+            break;
+        case(SampleFormat::Unknown):
+        default:
+            break;
+    }
+}
+
+void applyRamp(const AudioFormat& format, std::byte* data, int frameCount, GainRamp& ramp)
+{
+    const int channels = format.channelCount();
+    if(frameCount <= 0 || channels <= 0 || channels > RampBlockSize) {
+        return;
+    }
+
+    const auto& kernels   = sampleKernels();
+    const int rampFrames  = std::min(frameCount, std::max(ramp.length - ramp.position, 0));
+    const int blockFrames = RampBlockSize / channels;
+
+    std::array<float, RampBlockSize> gains;
+
+    int frame{0};
+    while(frame < rampFrames) {
+        const int frames = std::min(blockFrames, rampFrames - frame);
+
+        for(int i{0}; i < frames; ++i) {
+            std::fill_n(gains.begin() + (i * channels), channels, ramp.gainAt(ramp.position + i + 1) * ramp.scale);
+        }
+
+        std::byte* block = data + format.bytesForFrames(frame);
+        const auto count = static_cast<size_t>(frames * channels);
+
+        switch(format.sampleFormat()) {
+            case(SampleFormat::U8): {
+                auto* samples = reinterpret_cast<uint8_t*>(block);
+                for(size_t i{0}; i < count; ++i) {
+                    const float sample = (static_cast<float>(samples[i]) - 128.0F) * gains[i];
+                    samples[i]         = static_cast<uint8_t>(std::lrint(std::clamp(sample, -128.0F, 127.0F)) + 128);
+                }
+                break;
+            }
+            case(SampleFormat::S16):
+                kernels.multiplyS16(reinterpret_cast<int16_t*>(block), gains.data(), count);
+                break;
+            case(SampleFormat::S24):
+            case(SampleFormat::S32):
+                kernels.multiplyS32(reinterpret_cast<int32_t*>(block), gains.data(), count);
+                break;
+            case(SampleFormat::Float):
+                kernels.multiplyFloat(reinterpret_cast<float*>(block), gains.data(), count);
+                break;
+            case(SampleFormat::Unknown):
+            default:
+                break;
+        }
+
+        ramp.position += frames;
+        frame += frames;
+    }
+
+    if(frame < frameCount) {
+        applyGain(format, data + format.bytesForFrames(frame), frameCount - frame, ramp.to * ramp.scale);
+    }
+}
+
+void mix(const AudioFormat& format, std::byte* data, const std::byte* in, int frameCount)
+{
+    if(frameCount <= 0) {
+        return;
+    }
+
+    const auto& kernels = sampleKernels();
+    const auto count    = static_cast<size_t>(frameCount * format.channelCount());
+
+    switch(format.sampleFormat()) {
+        case(SampleFormat::U8): {
+            auto* samples      = reinterpret_cast<uint8_t*>(data);
+            const auto* inputs = reinterpret_cast<const uint8_t*>(in);
+            for(size_t i{0}; i < count; ++i) {
+                const int sum = static_cast<int>(samples[i]) + static_cast<int>(inputs[i]) - 128;
+                samples[i]    = static_cast<uint8_t>(std::clamp(sum, 0, 255));
+            }
+            break;
+        }
+        case(SampleFormat::S16):
+            kernels.mixS16(reinterpret_cast<int16_t*>(data), reinterpret_cast<const int16_t*>(in), count);
+            break;
+        case(SampleFormat::S24):
+        case(SampleFormat::S32):
+            kernels.mixS32(reinterpret_cast<int32_t*>(data), reinterpret_cast<const int32_t*>(in), count);
+            break;
+        case(SampleFormat::Float):
+            kernels.mixFloat(reinterpret_cast<float*>(data), reinterpret_cast<const float*>(in), count);
+            break;
+        case(SampleFormat::Unknown):
+        default:
+            break;
+    }
+}
+} // namespace Fooyin::Audio
@@ -0,0 +1,113 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audiobuffer.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Fooyin::Audio {
+/*!
+ * State for triangular (TPDF) dither.
+ * Holds one xorshift generator per vector lane so every implementation produces identical output.
+ */
+struct DitherState
+{
+    static constexpr size_t Lanes = 8;
+    std::array<uint32_t, Lanes> seeds{0x9E3779B9U, 0x7F4A7C15U, 0x85EBCA6BU, 0xC2B2AE35U,
+                                      0x27D4EB2FU, 0x165667B1U, 0xD3A2646CU, 0xFD7046C5U};
+};
+
+/*!
+ * Sample conversion kernels operating on contiguous arrays of @p count samples.
+ * Integer/float scaling follows the same conventions as the scalar converters, i.e. S16 and S32
+ * are divided by their maximum value and floats are scaled by 2^15/2^31, rounded to nearest and clamped.
+ */
+struct SampleKernels
+{
+    const char* name;
+
+    void (*s16ToFloat)(const int16_t* in, float* out, size_t count);
+    void (*s32ToFloat)(const int32_t* in, float* out, size_t count);
+    void (*floatToS16)(const float* in, int16_t* out, size_t count);
+    void (*floatToS32)(const float* in, int32_t* out, size_t count);
+    void (*floatToS16Dither)(const float* in, int16_t* out, size_t count, DitherState& state);
+
+    // In-place gain, either constant or with one gain per sample
+    void (*scaleS16)(int16_t* data, size_t count, float gain);
+    void (*scaleS32)(int32_t* data, size_t count, float gain);
+    void (*scaleFloat)(float* data, size_t count, float gain);
+    void (*multiplyS16)(int16_t* data, const float* gains, size_t count);
+    void (*multiplyS32)(int32_t* data, const float* gains, size_t count);
+    void (*multiplyFloat)(float* data, const float* gains, size_t count);
+
+    // Adds @p in to @p data in place, saturating integer formats
+    void (*mixS16)(int16_t* data, const int16_t* in, size_t count);
+    void (*mixS32)(int32_t* data, const int32_t* in, size_t count);
+    void (*mixFloat)(float* data, const float* in, size_t count);
+};
+
+/** Returns the fastest kernels supported by the running CPU. */
+FYCORE_EXPORT const SampleKernels& sampleKernels();
+/** Returns the portable scalar kernels, used as the correctness reference. */
+FYCORE_EXPORT const SampleKernels& scalarSampleKernels();
+
+/*!
+ * A gain change from @c from to @c to spread over @c length frames.
+ * @c position tracks progress, so a single ramp can be applied across consecutive buffers.
+ * @c scale is a constant gain (e.g. ReplayGain) applied in the same pass, on top of the ramp.
+ */
+struct FYCORE_EXPORT GainRamp
+{
+    float from{1.0F};
+    float to{1.0F};
+    int length{0};
+    int position{0};
+    AudioBuffer::RampCurve curve{AudioBuffer::RampCurve::Linear};
+    float scale{1.0F};
+
+    [[nodiscard]] bool finished() const
+    {
+        return position >= length;
+    }
+
+    /** Returns the gain reached after @p frame frames of the ramp. */
+    [[nodiscard]] float gainAt(int frame) const;
+
+    [[nodiscard]] float current() const
+    {
+        return gainAt(position);
+    }
+};
+
+/** Multiplies @p frameCount frames of @p data by a constant @p gain. */
+FYCORE_EXPORT void applyGain(const AudioFormat& format, std::byte* data, int frameCount, float gain);
+/*!
+ * Applies the next @p frameCount frames of @p ramp to @p data and advances it.
+ * Frames beyond the end of the ramp are scaled by the final gain.
+ */
+FYCORE_EXPORT void applyRamp(const AudioFormat& format, std::byte* data, int frameCount, GainRamp& ramp);
+/** Adds @p frameCount frames of @p in to @p data, clipping integer formats at their limits. */
+FYCORE_EXPORT void mix(const AudioFormat& format, std::byte* data, const std::byte* in, int frameCount);
+} // namespace Fooyin::Audio
@@ -20,30 +20,59 @@
 #include "audioplaybackengine.h"
 
 #include "audioclock.h"
+#include "audiokernels.h"
 #include "audiorenderer.h"
-#include "engine/ffmpeg/ffmpegdecoder.h"
+#include "dspchain.h"
+#include "engine/ffmpeg/ffmpegresampler.h"
+#include "engine/segmentdecoder.h"
 #include "internalcoresettings.h"
+#include "tagging/replaygain.h"
+#include "threadpriority.h"
 
 #include <core/coresettings.h>
 #include <core/engine/audiobuffer.h>
 #include <core/engine/audiodecoder.h>
+#include <core/engine/enginecontroller.h>
 #include <core/track.h>
+#include <utils/metrics.h>
 #include <utils/settings/settingsmanager.h>
 
-#include <QBasicTimer>
+#include <QDebug>
 #include <QThread>
 #include <QTimer>
-#include <QTimerEvent>
+
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace std::chrono_literals;
 
-#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
-constexpr auto BufferInterval = 5ms;
-#else
-constexpr auto BufferInterval = 5;
-#endif
+// How long the decode thread sleeps once the read-ahead target has been reached
+constexpr auto DecodeInterval = 20ms;
 
 constexpr auto MaxDecodeLength = 1000;
+// Bounds of the adaptive read-ahead (in ms); the upper bound is a multiple of the configured buffer length
+constexpr auto MinReadAhead       = 1000;
+constexpr auto MaxReadAheadFactor = 4;
+// Read-ahead covers this many times the slowest recent decoder read
+constexpr auto StallHeadroom = 8;
+// Per read decay of the slowest read, so the read-ahead shrinks again once a source speeds up
+constexpr auto StallDecay = 0.98;
+// How long (in ms) before the current track finishes decoding to ask for the next one
+constexpr auto PreloadLength = 5000;
+// Audio (in ms) decoded up front when the next track is opened
+constexpr auto PrimeLength = 500;
+// Audio (in ms) decoded on the engine thread straight after a seek, before the decode thread takes over
+constexpr auto SeekPrimeLength = 200;
+// Position update rate when nothing displays it, which is still enough to count plays
+constexpr auto IdlePositionInterval = 1000ms;
+// Intervals shorter than this need a precise timer to look smooth
+constexpr auto PrecisePositionInterval = 100ms;
+// How far (in ms) the clock may drift from what the output reports is being heard before it's corrected
+constexpr auto ClockTolerance = 30;
+// Reports older than this are from before playback was paused, so say nothing about the current position
+constexpr auto MaxPresentationAge = 500ms;
 
 namespace Fooyin {
 struct AudioPlaybackEngine::Private
@@ -53,84 +82,783 @@ struct AudioPlaybackEngine::Private
     SettingsManager* settings;
 
     AudioClock clock;
+    // The renderer segment the clock was last synced to, and the track position (in ms) it started from
+    uint32_t clockSegment{0};
+    uint64_t clockBase{0};
     QTimer* positionUpdateTimer{nullptr};
+    std::chrono::milliseconds positionInterval{IdlePositionInterval};
 
     TrackStatus status{TrackStatus::NoTrack};
     PlaybackState state{PlaybackState::Stopped};
     AudioOutput::State outputState{AudioOutput::State::None};
     uint64_t lastPosition{0};
 
-    uint64_t totalBufferTime{0};
     uint64_t bufferLength{0};
 
-    uint64_t duration{0};
     double volume{1.0};
 
+    // Format sent to the output, which differs from the decoder's when resampling
     AudioFormat format;
 
-    std::unique_ptr<AudioDecoder> decoder;
+    Track currentTrack;
+    // The track being decoded, which runs ahead of currentTrack once the next track has been spliced in
+    Track decoderTrack;
+    std::unique_ptr<SegmentDecoder> decoder;
+    // Already decoded audio to queue before reading from the decoder
+    AudioBuffer pendingBuffer;
+    bool decoderAtEnd{false};
+    // Title last announced by an internet stream
+    QString streamTitle;
+
+    // Second decoder slot, holding the upcoming track opened ahead of time
+    std::unique_ptr<SegmentDecoder> nextDecoder;
+    Track nextTrack;
+    AudioBuffer nextBuffer;
+    // Handed to the decode thread to be opened
+    Track trackToPrepare;
+    uint64_t trackChanges{0};
+    bool nextTrackRequested{false};
+    // The decoder has moved on to the next track, but the engine hasn't been changed to it yet
+    bool splicePending{false};
+
     AudioRenderer* renderer;
 
-    QBasicTimer bufferTimer;
+    // Guards the decoders and the producer side of the renderer, which are shared with the decode thread
+    std::mutex decodeLock;
+    std::condition_variable decodeCond;
+    std::thread decodeThread;
+    bool decoding{false};
+    bool quitDecoding{false};
+    // Bumped before a seek waits for decodeLock, so the decode thread hands it over rather than reading on
+    std::atomic<uint64_t> seekRequests{0};
+    uint64_t seeksApplied{0};
+
+    double decoderStall{0.0};
+    std::atomic<uint64_t> readAhead{0};
+    std::atomic<uint64_t> bufferedTime{0};
+    // In µs
+    std::atomic<uint64_t> decodeTime{0};
+    std::atomic<uint64_t> maxDecodeTime{0};
 
     FadingIntervals fadeIntervals;
 
-    explicit Private(AudioEngine* self_, SettingsManager* settings_)
+    ReplayGainMode replayGainMode;
+    double replayGainPreAmp;
+
+    Resampler resampler;
+    int outputSampleRate;
+    ResampleQuality resampleQuality;
+
+    bool realtimePlayback;
+
+    // Passes audio through untouched, only converting it if the output can't take the source format
+    bool bitPerfect;
+    // The format used for sources in a format the output rejected in bit-perfect mode
+    AudioFormat forcedSource;
+    AudioFormat forcedOutput;
+    OutputPath outputPath;
+    // Set when the decode thread should reapply its scheduling priority
+    bool threadPriorityPending{true};
+
+    // While crossfading, nextDecoder holds the outgoing track, which is mixed into the start of the current one
+    bool crossfading{false};
+    bool fadeDecoderAtEnd{false};
+    Resampler fadeResampler;
+    // Outgoing audio already decoded but not yet mixed, reserved once so mixing doesn't allocate
+    std::vector<std::byte> fadeBuffer;
+    Audio::GainRamp fadeOutRamp;
+    Audio::GainRamp fadeInRamp;
+
+    // Run on converted audio in the output format, before it's queued
+    DspChain dspChain;
+
+    Private(AudioEngine* self_, SettingsManager* settings_, const DbConnectionPoolPtr& seekIndexPool)
         : self{self_}
         , settings{settings_}
         , bufferLength{static_cast<uint64_t>(settings->value<Settings::Core::BufferLength>())}
-        , decoder{std::make_unique<FFmpegDecoder>()}
+        , decoder{std::make_unique<SegmentDecoder>(seekIndexPool)}
+        , nextDecoder{std::make_unique<SegmentDecoder>(seekIndexPool)}
         , renderer{new AudioRenderer(self)}
         , fadeIntervals{settings->value<Settings::Core::Internal::FadingIntervals>().value<FadingIntervals>()}
+        , replayGainMode{static_cast<ReplayGainMode>(settings->value<Settings::Core::ReplayGainMode>())}
+        , replayGainPreAmp{settings->value<Settings::Core::ReplayGainPreAmp>()}
+        , outputSampleRate{settings->value<Settings::Core::OutputSampleRate>()}
+        , resampleQuality{static_cast<ResampleQuality>(settings->value<Settings::Core::ResampleQuality>())}
+        , realtimePlayback{settings->value<Settings::Core::RealtimePlayback>()}
+        , bitPerfect{settings->value<Settings::Core::BitPerfect>()}
     {
-        settings->subscribe<Settings::Core::BufferLength>(self, [this](int length) { bufferLength = length; });
+        readAhead.store(bufferLength, std::memory_order_relaxed);
+        updateBufferLength();
+
+        settings->subscribe<Settings::Core::BufferLength>(self, [this](int length) {
+            const std::scoped_lock lock{decodeLock};
+            bufferLength = length;
+            updateBufferLength();
+        });
         settings->subscribe<Settings::Core::Internal::FadingIntervals>(
             self, [this](const QVariant& fading) { fadeIntervals = fading.value<FadingIntervals>(); });
+        settings->subscribe<Settings::Core::ReplayGainMode>(self, [this](int mode) {
+            const std::scoped_lock lock{decodeLock};
+            replayGainMode = static_cast<ReplayGainMode>(mode);
+            renderer->queueReplayGain(replayGain(currentTrack));
+            updateOutputPath();
+        });
+        settings->subscribe<Settings::Core::ReplayGainPreAmp>(self, [this](double preAmp) {
+            const std::scoped_lock lock{decodeLock};
+            replayGainPreAmp = preAmp;
+            renderer->queueReplayGain(replayGain(currentTrack));
+        });
+        // Both take effect from the next track
+        settings->subscribe<Settings::Core::OutputSampleRate>(self, [this](int rate) {
+            const std::scoped_lock lock{decodeLock};
+            outputSampleRate = rate;
+        });
+        settings->subscribe<Settings::Core::ResampleQuality>(self, [this](int quality) {
+            const std::scoped_lock lock{decodeLock};
+            resampleQuality = static_cast<ResampleQuality>(quality);
+        });
+
+        settings->subscribe<Settings::Core::BitPerfect>(self, [this](bool enabled) {
+            const std::scoped_lock lock{decodeLock};
+            bitPerfect = enabled;
+            renderer->updateVolume(enabled ? 1.0 : volume);
+            renderer->queueReplayGain(replayGain(currentTrack));
+            updateOutputPath();
+        });
+        settings->subscribe<Settings::Core::RealtimePlayback>(self, [this](bool enabled) {
+            {
+                const std::scoped_lock lock{decodeLock};
+                realtimePlayback      = enabled;
+                threadPriorityPending = true;
+            }
+            decodeCond.notify_one();
+            applyThreadPriority(enabled, "engine");
+        });
+        // Runs once we've been moved to the engine thread, which also drives the renderer
+        QMetaObject::invokeMethod(
+            self, [this]() { applyThreadPriority(realtimePlayback, "engine"); }, Qt::QueuedConnection);
 
-        QObject::connect(renderer, &AudioRenderer::bufferProcessed, self,
-                         [this](const AudioBuffer& buffer) { totalBufferTime -= buffer.duration(); });
         QObject::connect(renderer, &AudioRenderer::finished, self, [this]() { onRendererFinished(); });
         QObject::connect(renderer, &AudioRenderer::outputStateChanged, self,
                          [this](AudioOutput::State outState) { handleOutputState(outState); });
+
+        decodeThread = std::thread{[this]() { decodeLoop(); }};
+    }
+
+    void updateBufferLength()
+    {
+        // The render buffer has to hold the largest read-ahead
+        renderer->setBufferLength(bufferLength * MaxReadAheadFactor);
+        readAhead.store(std::clamp(readAhead.load(std::memory_order_relaxed), minReadAhead(), maxReadAhead()),
+                        std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t minReadAhead() const
+    {
+        return std::min<uint64_t>(MinReadAhead, bufferLength);
+    }
+
+    [[nodiscard]] uint64_t maxReadAhead() const
+    {
+        return bufferLength * MaxReadAheadFactor;
+    }
+
+    static void applyThreadPriority(bool realtime, const char* thread)
+    {
+        if(!setCurrentThreadPriority(realtime ? ThreadPriority::Realtime : ThreadPriority::Normal) && realtime) {
+            qInfo() << "[Engine] Real-time scheduling isn't permitted for the" << thread << "thread";
+        }
+    }
+
+    void decodeLoop()
+    {
+        std::unique_lock lock{decodeLock};
+
+        while(!quitDecoding) {
+            if(std::exchange(threadPriorityPending, false)) {
+                applyThreadPriority(realtimePlayback, "decode");
+            }
+
+            // The next decoder is busy with the outgoing track until the crossfade finishes
+            if(trackToPrepare.isValid() && !crossfading) {
+                prepareNextTrack(lock);
+                continue;
+            }
+
+            if(!decoding) {
+                decodeCond.wait(lock);
+                continue;
+            }
+
+            if(readNextBuffer()) {
+                // Let the engine thread in between reads
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+            }
+            else {
+                decodeCond.wait_for(lock, DecodeInterval);
+            }
+        }
+    }
+
+    void stopDecodeThread()
+    {
+        {
+            const std::scoped_lock lock{decodeLock};
+            quitDecoding = true;
+        }
+        decodeCond.notify_one();
+
+        if(decodeThread.joinable()) {
+            decodeThread.join();
+        }
+    }
+
+    // decodeLock must be held
+    void startDecoding()
+    {
+        decoding = true;
+        decodeCond.notify_one();
+    }
+
+    void stopDecoding()
+    {
+        decoding = false;
+    }
+
+    void updateReadAhead(std::chrono::steady_clock::duration readTime)
+    {
+        // Grow straight away for a slow read, but only shrink gradually
+        const double readMs = std::chrono::duration<double, std::milli>(readTime).count();
+        decoderStall        = std::max(readMs, decoderStall * StallDecay);
+
+        const auto target = static_cast<uint64_t>(decoderStall * StallHeadroom);
+        readAhead.store(std::clamp(target, minReadAhead(), maxReadAhead()), std::memory_order_relaxed);
+    }
+
+    void recordDecodeTime(std::chrono::steady_clock::duration readTime)
+    {
+        // The sum over time is the share of a core spent decoding
+        static auto& bufferDecodeTime
+            = Metrics::histogram("fooyin_decode_buffer_seconds", "Time taken to decode a buffer of audio");
+        bufferDecodeTime.record(readTime);
+
+        const auto time
+            = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(readTime).count());
+        decodeTime.store(time, std::memory_order_relaxed);
+        // Only written from the decode thread
+        if(time > maxDecodeTime.load(std::memory_order_relaxed)) {
+            maxDecodeTime.store(time, std::memory_order_relaxed);
+        }
     }
 
     QTimer* positionTimer()
     {
         if(!positionUpdateTimer) {
             positionUpdateTimer = new QTimer(self);
-            positionUpdateTimer->setInterval(50ms);
-            positionUpdateTimer->setTimerType(Qt::PreciseTimer);
             QObject::connect(positionUpdateTimer, &QTimer::timeout, self, [this]() { updatePosition(); });
+            updatePositionTimer();
         }
         return positionUpdateTimer;
     }
 
-    void readNextBuffer()
+    void updatePositionTimer() const
     {
-        if(totalBufferTime >= bufferLength) {
-            return;
+        // Coarse timers let the system batch wakeups, which matters more than accuracy at slow rates
+        positionUpdateTimer->setTimerType(positionInterval < PrecisePositionInterval ? Qt::PreciseTimer
+                                                                                     : Qt::CoarseTimer);
+        // Restarts the timer if it's running
+        positionUpdateTimer->setInterval(positionInterval);
+    }
+
+    [[nodiscard]] bool seekWaiting() const
+    {
+        return seekRequests.load(std::memory_order_acquire) != seeksApplied;
+    }
+
+    // Runs on the decode thread. Returns true if it should be called again straight away.
+    bool readNextBuffer()
+    {
+        if(seekWaiting()) {
+            return false;
+        }
+
+        const uint64_t buffered = format.durationForBytes(static_cast<int>(renderer->bufferedBytes()));
+        bufferedTime.store(buffered, std::memory_order_relaxed);
+
+        const uint64_t target = readAhead.load(std::memory_order_relaxed);
+        if(buffered >= target) {
+            return false;
+        }
+
+        if(pendingBuffer.isValid()) {
+            if(renderer->freeBytes() < static_cast<size_t>(pendingBuffer.byteCount())) {
+                return false;
+            }
+            renderer->queueBuffer(std::exchange(pendingBuffer, {}));
+            return true;
+        }
+
+        // Sized in the decoder's format, as it can differ from the output's
+        const auto freeTime   = format.durationForBytes(static_cast<int>(renderer->freeBytes()));
+        const auto decodeTime = std::min({static_cast<uint64_t>(MaxDecodeLength), target - buffered, freeTime});
+        const auto bytes      = static_cast<size_t>(decoder->format().bytesForDuration(decodeTime));
+
+        if(bytes == 0) {
+            return false;
         }
 
-        const auto bytesLeft = static_cast<size_t>(format.bytesForDuration(bufferLength - totalBufferTime));
-        const auto maxBytes  = static_cast<size_t>(format.bytesForDuration(MaxDecodeLength));
+        const auto readStart = std::chrono::steady_clock::now();
+        const auto buffer    = decoder->readBuffer(bytes);
+        const auto readTime  = std::chrono::steady_clock::now() - readStart;
+        updateReadAhead(readTime);
+        recordDecodeTime(readTime);
+
+        // Audio from before the seek would only be discarded again once it's applied
+        if(seekWaiting()) {
+            return false;
+        }
 
-        const auto buffer = decoder->readBuffer(std::min(maxBytes, bytesLeft));
         if(buffer.isValid()) {
-            totalBufferTime += buffer.duration();
-            renderer->queueBuffer(buffer);
+            queueConverted(process(convert(buffer)));
+            updateStreamTitle();
+
+            const uint64_t length   = decoderTrack.duration();
+            const uint64_t position = buffer.startTime() + buffer.duration();
+            const uint64_t overlap  = crossfadeLength();
+            if(!splicePending && length > 0 && position + PreloadLength + overlap >= length) {
+                requestNextTrack();
+            }
+            if(overlap > 0 && !splicePending && length > 0 && position + overlap >= length) {
+                startCrossfade(length - std::min(position, length));
+            }
+            return true;
+        }
+
+        // An internet stream refilling its network buffer hasn't ended, it just has nothing to give yet
+        if(decoder->isStalled()) {
+            return false;
+        }
+
+        // Queue whatever is left in the resampler before the end of the track
+        if(const auto tail = resampler.flush(); tail.isValid()) {
+            pendingBuffer = process(tail);
+            return true;
+        }
+
+        // Nothing follows without a next track, so push out what the DSP chain is still holding back
+        if(!nextTrack.isValid() && !bitPerfect) {
+            if(auto tail = dspChain.flush(decoderTrack.duration()); tail.isValid()) {
+                pendingBuffer = std::move(tail);
+                return true;
+            }
+        }
+
+        stopCrossfade();
+        stopDecoding();
+        decoderAtEnd = true;
+
+        // The renderer only tracks a single end position, so a spliced track is marked once it becomes current
+        if(!splicePending) {
+            finishDecoding();
+        }
+        return false;
+    }
+
+    void updateStreamTitle()
+    {
+        QString title = decoder->streamTitle();
+        if(title == streamTitle) {
+            return;
+        }
+
+        streamTitle = title;
+        QMetaObject::invokeMethod(self, [this, title = std::move(title)]() { emit self->streamTitleChanged(title); });
+    }
+
+    // Returns the format sent to the output for audio decoded as @p input
+    [[nodiscard]] AudioFormat outputFormat(const AudioFormat& input) const
+    {
+        if(bitPerfect) {
+            return input == forcedSource ? forcedOutput : input;
+        }
+
+        if(outputSampleRate <= 0 || !input.isValid()) {
+            return input;
+        }
+
+        // Normalise to float as well, so differing bit depths don't reopen the output
+        return {SampleFormat::Float, outputSampleRate, input.channelCount()};
+    }
+
+    void setupResampler(const AudioFormat& input)
+    {
+        const AudioFormat output = outputFormat(input);
+        if(output == input) {
+            resampler.uninit();
+            return;
+        }
+
+        if(resampler.isInitialised() && resampler.inputFormat() == input && resampler.outputFormat() == output
+           && resampler.quality() == resampleQuality) {
+            resampler.reset();
+            return;
+        }
+
+        if(!resampler.init(input, output, resampleQuality)) {
+            qWarning() << "[Engine] Unable to create resampler for" << input.sampleRate() << "Hz to"
+                       << output.sampleRate() << "Hz";
+        }
+    }
+
+    AudioBuffer convert(const AudioBuffer& buffer)
+    {
+        return resampler.isInitialised() ? resampler.process(buffer) : buffer;
+    }
+
+    // Applies any crossfade and the DSP chain to converted audio
+    AudioBuffer process(AudioBuffer buffer)
+    {
+        if(bitPerfect) {
+            // Only finishes a crossfade which was already running when bit-perfect mode was enabled
+            return mixCrossfade(std::move(buffer));
+        }
+        return dspChain.process(mixCrossfade(std::move(buffer)));
+    }
+
+    void updateOutputPath()
+    {
+        OutputPath path;
+        if(decoder && decoder->format().isValid()) {
+            path.source = decoder->format();
+            path.output = format;
+        }
+        path.conversionForced = bitPerfect && path.source.isValid() && path.source == forcedSource;
+
+        if(!bitPerfect) {
+            path.processing = !dspChain.isEmpty() || replayGainMode != ReplayGainMode::Off || crossfadeLength() > 0
+                           || volume != 1.0;
+        }
+
+        if(std::exchange(outputPath, path) != path) {
+            emit self->outputPathChanged(path);
+        }
+    }
+
+    void queueConverted(const AudioBuffer& buffer)
+    {
+        if(!buffer.isValid()) {
+            return;
+        }
+
+        // Resampled audio may not line up exactly with the free space it was sized for
+        if(renderer->freeBytes() < static_cast<size_t>(buffer.byteCount())) {
+            pendingBuffer = buffer;
         }
         else {
-            bufferTimer.stop();
-            renderer->queueBuffer({});
+            renderer->queueBuffer(buffer);
+        }
+    }
+
+    // Returns how long (in ms) the end of each track overlaps the next, or 0 if crossfading is disabled
+    [[nodiscard]] uint64_t crossfadeLength() const
+    {
+        if(bitPerfect || !settings->value<Settings::Core::Internal::EngineCrossfading>()) {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::max(fadeIntervals.outChange, 0));
+    }
+
+    // Switches decoding to the next track, keeping the current one running to be faded out over @p remaining ms
+    void startCrossfade(uint64_t remaining)
+    {
+        // Tracks continuing in the same file (i.e. from a CUE sheet) are joined gaplessly instead
+        if(crossfading || !nextTrack.isValid() || state != PlaybackState::Playing || nextDecoder->sharesSession()
+           || outputFormat(nextDecoder->format()) != format) {
+            return;
+        }
+
+        const auto curve = static_cast<AudioBuffer::RampCurve>(
+            settings->value<Settings::Core::Internal::CrossfadeCurve>());
+
+        // The renderer applies the incoming track's ReplayGain from here on, so correct the outgoing audio for it
+        const float incomingGain = replayGain(nextTrack);
+        const float outgoingGain = incomingGain > 0.0F ? replayGain(decoderTrack) / incomingGain : 1.0F;
+
+        // The track change is reported once the output reaches the start of the overlap
+        renderer->queueEndOfTrack();
+
+        std::swap(decoder, nextDecoder);
+        std::swap(resampler, fadeResampler);
+        setupResampler(decoder->format());
+
+        fadeOutRamp = {1.0F, 0.0F, format.framesForDuration(remaining), 0, curve, outgoingGain};
+        fadeInRamp  = {0.0F, 1.0F, format.framesForDuration(static_cast<uint64_t>(std::max(fadeIntervals.inChange, 0))),
+                       0, curve};
+
+        fadeBuffer.clear();
+        fadeBuffer.reserve(static_cast<size_t>(format.bytesForDuration(2 * MaxDecodeLength)));
+        fadeDecoderAtEnd = false;
+        crossfading      = true;
+
+        decoderTrack       = std::exchange(nextTrack, {});
+        decoderAtEnd       = false;
+        nextTrackRequested = false;
+        splicePending      = true;
+
+        renderer->queueReplayGain(incomingGain);
+
+        queueConverted(process(convert(std::exchange(nextBuffer, {}))));
+    }
+
+    void stopCrossfade()
+    {
+        if(!std::exchange(crossfading, false)) {
+            return;
+        }
+
+        nextDecoder->stop();
+        fadeResampler.uninit();
+        fadeBuffer.clear();
+    }
+
+    // Decodes outgoing audio until at least @p frames are waiting to be mixed, or it runs out
+    void fillFadeBuffer(int frames)
+    {
+        const AudioFormat inputFormat = nextDecoder->format();
+
+        while(!fadeDecoderAtEnd && format.framesForBytes(static_cast<int>(fadeBuffer.size())) < frames) {
+            const int needed = frames - format.framesForBytes(static_cast<int>(fadeBuffer.size()));
+            const auto bytes = static_cast<size_t>(inputFormat.bytesForDuration(format.durationForFrames(needed) + 1));
+
+            AudioBuffer buffer = nextDecoder->readBuffer(bytes);
+            if(buffer.isValid()) {
+                buffer = fadeResampler.isInitialised() ? fadeResampler.process(buffer) : buffer;
+            }
+            else {
+                buffer           = fadeResampler.flush();
+                fadeDecoderAtEnd = !buffer.isValid();
+            }
+
+            if(buffer.isValid()) {
+                const auto data = buffer.constData();
+                fadeBuffer.insert(fadeBuffer.end(), data.begin(), data.end());
+            }
+        }
+    }
+
+    // Fades in @p buffer of the current track and mixes the outgoing track into it while a crossfade is running
+    AudioBuffer mixCrossfade(AudioBuffer buffer)
+    {
+        if(!buffer.isValid() || (!crossfading && fadeInRamp.finished())) {
+            return buffer;
+        }
+
+        const int frames = buffer.frameCount();
+        std::byte* data  = buffer.data();
+
+        if(!fadeInRamp.finished()) {
+            Audio::applyRamp(format, data, frames, fadeInRamp);
+        }
+
+        if(crossfading) {
+            fillFadeBuffer(frames);
+
+            const int mixFrames = std::min(frames, format.framesForBytes(static_cast<int>(fadeBuffer.size())));
+            const auto mixBytes = static_cast<std::ptrdiff_t>(format.bytesForFrames(mixFrames));
+
+            Audio::applyRamp(format, fadeBuffer.data(), mixFrames, fadeOutRamp);
+            Audio::mix(format, data, fadeBuffer.data(), mixFrames);
+            fadeBuffer.erase(fadeBuffer.begin(), fadeBuffer.begin() + mixBytes);
+
+            if((fadeDecoderAtEnd && fadeBuffer.empty()) || fadeOutRamp.finished()) {
+                stopCrossfade();
+            }
+        }
+
+        return buffer;
+    }
+
+    void requestNextTrack()
+    {
+        if(!std::exchange(nextTrackRequested, true)) {
             QMetaObject::invokeMethod(self, &AudioEngine::trackAboutToFinish);
         }
     }
 
+    void finishDecoding()
+    {
+        renderer->queueEndOfTrack();
+        requestNextTrack();
+        spliceNextTrack();
+    }
+
+    // Runs on the decode thread
+    void prepareNextTrack(std::unique_lock<std::mutex>& lock)
+    {
+        const Track track = std::exchange(trackToPrepare, {});
+        if(splicePending || (nextTrack.isValid() && nextTrack == track)) {
+            return;
+        }
+
+        nextTrack  = {};
+        nextBuffer = {};
+
+        // The next track of a CUE sheet may carry on from the current one, so there's nothing to open or prime
+        if(nextDecoder->continueFrom(*decoder, track)) {
+            nextTrack = track;
+            spliceNextTrack();
+            return;
+        }
+
+        auto preparing          = std::move(nextDecoder);
+        const uint64_t openedAt = trackChanges;
+
+        // Opening may be slow (e.g. on network shares), so don't hold up the engine thread meanwhile
+        lock.unlock();
+
+        preparing->stop();
+        const bool opened = preparing->init(track);
+
+        AudioBuffer primed;
+        if(opened) {
+            preparing->start();
+            primed = preparing->readBuffer(static_cast<size_t>(preparing->format().bytesForDuration(PrimeLength)));
+        }
+
+        lock.lock();
+        nextDecoder = std::move(preparing);
+
+        // Stale if the current track changed meanwhile, as it no longer follows it
+        if(opened && openedAt == trackChanges) {
+            nextTrack  = track;
+            nextBuffer = std::move(primed);
+            spliceNextTrack();
+        }
+    }
+
+    // Returns the linear gain for @p track, limited so its peak doesn't clip
+    [[nodiscard]] float replayGain(const Track& track) const
+    {
+        if(bitPerfect || replayGainMode == ReplayGainMode::Off || !track.isValid()) {
+            return 1.0F;
+        }
+
+        const auto info = ReplayGainInfo::fromTrack(track);
+
+        std::optional<double> gain{info.trackGain};
+        std::optional<double> peak{info.trackPeak};
+        if(replayGainMode == ReplayGainMode::Album && info.hasAlbumGain()) {
+            gain = info.albumGain;
+            peak = info.albumPeak;
+        }
+
+        if(!gain) {
+            return 1.0F;
+        }
+
+        double scale = std::pow(10.0, (gain.value() + replayGainPreAmp) / 20.0);
+        if(peak && peak.value() > 0.0) {
+            scale = std::min(scale, 1.0 / peak.value());
+        }
+        return static_cast<float>(scale);
+    }
+
+    // Continues decoding straight into the next track once the current one has been fully queued
+    bool spliceNextTrack()
+    {
+        if(!decoderAtEnd || splicePending || !nextTrack.isValid() || state != PlaybackState::Playing
+           || !settings->value<Settings::Core::GaplessPlayback>() || outputFormat(nextDecoder->format()) != format) {
+            return false;
+        }
+
+        decoder->stop();
+        std::swap(decoder, nextDecoder);
+
+        setupResampler(decoder->format());
+
+        decoderTrack       = std::exchange(nextTrack, {});
+        pendingBuffer      = process(convert(std::exchange(nextBuffer, {})));
+        decoderAtEnd       = false;
+        nextTrackRequested = false;
+        splicePending      = true;
+
+        renderer->queueReplayGain(replayGain(decoderTrack));
+        updateOutputPath();
+
+        startDecoding();
+        return true;
+    }
+
+    void cancelSplice()
+    {
+        // Any fade belongs to the audio being discarded
+        stopCrossfade();
+        fadeInRamp = {};
+
+        if(!std::exchange(splicePending, false)) {
+            return;
+        }
+
+        decoder->stop();
+        std::swap(decoder, nextDecoder);
+        decoder->start();
+        setupResampler(decoder->format());
+
+        decoderTrack       = currentTrack;
+        pendingBuffer      = {};
+        decoderAtEnd       = false;
+        nextTrackRequested = false;
+
+        renderer->queueReplayGain(replayGain(currentTrack));
+    }
+
+    // The renderer has reached the spliced track, so only the engine state needs to follow
+    void adoptSplicedTrack(const Track& track)
+    {
+        splicePending = false;
+        currentTrack  = track;
+
+        lastPosition = 0;
+        emit self->positionChanged(0);
+        syncClock(0);
+        clock.setPaused(state != PlaybackState::Playing);
+
+        changeTrackStatus(TrackStatus::LoadedTrack);
+        changeTrackStatus(TrackStatus::BufferedTrack);
+
+        if(decoderAtEnd) {
+            finishDecoding();
+        }
+    }
+
+    bool openTrack(const Track& track)
+    {
+        pendingBuffer = {};
+
+        if(nextTrack.isValid() && nextTrack == track) {
+            std::swap(decoder, nextDecoder);
+            pendingBuffer = std::exchange(nextBuffer, {});
+            nextTrack     = {};
+        }
+        else if(!decoder->init(track)) {
+            return false;
+        }
+
+        currentTrack = track;
+        decoderTrack = track;
+        streamTitle.clear();
+        ++trackChanges;
+        return true;
+    }
+
     void handleOutputState(AudioOutput::State outState)
     {
         outputState = outState;
         if(outputState == AudioOutput::State::Disconnected) {
-            self->pause();
+            // May be reported from within an output call made while decodeLock is held
+            QMetaObject::invokeMethod(self, [this]() { self->pause(); }, Qt::QueuedConnection);
         }
     }
 
@@ -145,6 +873,7 @@ struct AudioPlaybackEngine::Private
     void stop()
     {
         auto delayedStop = [this]() {
+            const std::scoped_lock lock{decodeLock};
             stopWorkers(true);
         };
 
@@ -167,6 +896,7 @@ struct AudioPlaybackEngine::Private
     void pause()
     {
         auto delayedPause = [this]() {
+            const std::scoped_lock lock{decodeLock};
             pauseOutput(true);
             updateState(PlaybackState::Paused);
             clock.setPaused(true);
@@ -218,13 +948,38 @@ struct AudioPlaybackEngine::Private
         return prevStatus;
     }
 
-    void startBufferTimer()
+    // Syncs the clock to @p position for audio queued in the renderer from now on
+    void syncClock(uint64_t position)
     {
-        bufferTimer.start(BufferInterval, self);
+        clock.sync(position);
+        clockSegment = renderer->segment();
+        clockBase    = position;
+    }
+
+    // Corrects the clock from the output's reported delay, once it has drifted from what is being heard
+    void alignClock()
+    {
+        const auto presented = renderer->presentation();
+        if(!presented || presented->segment != clockSegment || format.sampleRate() <= 0
+           || AudioClock::Clock::now() - presented->time > MaxPresentationAge) {
+            return;
+        }
+
+        const uint64_t heard     = clockBase + (presented->frames * 1000 / format.sampleRate());
+        const uint64_t estimated = clock.positionFromTime(presented->time);
+        const uint64_t drift     = heard > estimated ? heard - estimated : estimated - heard;
+
+        if(drift >= ClockTolerance) {
+            clock.sync(presented->time, heard);
+        }
     }
 
     void updatePosition()
     {
+        if(state == PlaybackState::Playing) {
+            alignClock();
+        }
+
         if(std::exchange(lastPosition, clock.currentPosition()) != lastPosition) {
             emit self->positionChanged(lastPosition);
         }
@@ -240,24 +995,50 @@ struct AudioPlaybackEngine::Private
         }
 
         if(!renderer->init(format)) {
-            format = {};
-            return false;
+            if(!bitPerfect || !forceConversion(nextFormat)) {
+                format = {};
+                return false;
+            }
         }
 
         return true;
     }
 
+    // Opens the output in the closest format to @p source which it accepts, converting to it through the resampler
+    bool forceConversion(const AudioFormat& source)
+    {
+        for(const int rate : {source.sampleRate(), 48000, 44100}) {
+            for(const auto sampleFormat : {SampleFormat::S32, SampleFormat::S16, SampleFormat::Float}) {
+                const AudioFormat fallback{sampleFormat, rate, source.channelCount()};
+                if(fallback == source || !renderer->init(fallback)) {
+                    continue;
+                }
+
+                qWarning() << "[Engine] Output doesn't support the source format, conversion has been forced from"
+                           << source.sampleRate() << "Hz" << source.bytesPerSample() * 8 << "bit to" << rate << "Hz"
+                           << fallback.bytesPerSample() * 8 << "bit";
+
+                format       = fallback;
+                forcedSource = source;
+                forcedOutput = fallback;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     void startPlayback()
     {
         decoder->start();
-        startBufferTimer();
+        startDecoding();
         renderer->start();
     }
 
     void onRendererFinished()
     {
         clock.setPaused(true);
-        clock.sync(duration);
+        clock.sync(currentTrack.duration());
 
         changeTrackStatus(TrackStatus::EndOfTrack);
     }
@@ -265,46 +1046,95 @@ struct AudioPlaybackEngine::Private
     void pauseOutput(bool pause)
     {
         if(pause) {
-            bufferTimer.stop();
+            stopDecoding();
         }
         else {
-            startBufferTimer();
+            startDecoding();
+        }
+    }
+
+    void seek(uint64_t pos)
+    {
+        // Seeking applies to the track being heard, not one already spliced in after it
+        cancelSplice();
+
+        if(!decoder->isSeekable()) {
+            return;
+        }
+
+        resetWorkers();
+
+        pendingBuffer      = {};
+        decoderAtEnd       = false;
+        nextTrackRequested = false;
+
+        decoder->seek(pos);
+        resampler.reset();
+        dspChain.reset();
+        syncClock(pos);
+
+        if(state == PlaybackState::Playing) {
+            primeAfterSeek();
+            clock.setPaused(false);
+            startDecoding();
+            renderer->start();
+        }
+
+        // Reported straight away from the clock, rather than waiting for the next position update
+        updatePosition();
+    }
+
+    // Decodes the start of the new position on the engine thread, so it's ready once the renderer starts
+    void primeAfterSeek()
+    {
+        const auto bytes = static_cast<size_t>(decoder->format().bytesForDuration(SeekPrimeLength));
+        if(bytes > 0) {
+            queueConverted(process(convert(decoder->readBuffer(bytes))));
         }
     }
 
     void resetWorkers()
     {
-        bufferTimer.stop();
+        stopDecoding();
         clock.setPaused(true);
         renderer->reset();
-        totalBufferTime = 0;
     }
 
     void stopWorkers(bool full = false)
     {
-        bufferTimer.stop();
+        stopDecoding();
         clock.setPaused(true);
-        clock.sync();
         renderer->stop();
+        syncClock(0);
         if(full) {
             renderer->closeOutput();
             outputState = AudioOutput::State::Disconnected;
         }
+        cancelSplice();
         decoder->stop();
-        totalBufferTime = 0;
+        dspChain.reset();
+
+        pendingBuffer      = {};
+        decoderAtEnd       = false;
+        nextTrackRequested = false;
     }
 };
 
-AudioPlaybackEngine::AudioPlaybackEngine(SettingsManager* settings, QObject* parent)
+AudioPlaybackEngine::AudioPlaybackEngine(SettingsManager* settings, DbConnectionPoolPtr seekIndexPool,
+                                         QObject* parent)
     : AudioEngine{parent}
-    , p{std::make_unique<Private>(this, settings)}
+    , p{std::make_unique<Private>(this, settings, seekIndexPool)}
 { }
 
 AudioPlaybackEngine::~AudioPlaybackEngine()
 {
     AudioPlaybackEngine::stop();
 
-    p->stopWorkers();
+    {
+        const std::scoped_lock lock{p->decodeLock};
+        p->stopWorkers();
+    }
+    p->stopDecodeThread();
 
     if(p->positionUpdateTimer) {
         p->positionUpdateTimer->deleteLater();
@@ -313,33 +1143,27 @@ AudioPlaybackEngine::~AudioPlaybackEngine()
 
 void AudioPlaybackEngine::seek(uint64_t pos)
 {
-    if(!p->decoder->isSeekable()) {
-        return;
-    }
-
-    p->resetWorkers();
-
-    p->decoder->seek(pos);
-    p->clock.sync(pos);
+    const uint64_t request = p->seekRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
 
-    if(p->state == PlaybackState::Playing) {
-        p->clock.setPaused(false);
-        p->startBufferTimer();
-        p->renderer->start();
-    }
-    else {
-        p->updatePosition();
-    }
+    const std::scoped_lock lock{p->decodeLock};
+    p->seeksApplied = request;
+    p->seek(pos);
 }
 
 void AudioPlaybackEngine::changeTrack(const Track& track)
 {
+    const std::scoped_lock lock{p->decodeLock};
+
+    if(p->splicePending && p->status == TrackStatus::EndOfTrack && track == p->decoderTrack) {
+        p->adoptSplicedTrack(track);
+        return;
+    }
+
     p->stopWorkers();
 
     emit positionChanged(0);
 
     p->clock.setPaused(true);
-    p->clock.sync();
 
     if(!track.isValid()) {
         p->changeTrackStatus(TrackStatus::InvalidTrack);
@@ -348,17 +1172,25 @@ void AudioPlaybackEngine::changeTrack(const Track& track)
 
     p->changeTrackStatus(TrackStatus::LoadingTrack);
 
-    if(!p->decoder->init(track.filepath())) {
+    if(!p->openTrack(track)) {
         p->changeTrackStatus(TrackStatus::InvalidTrack);
         return;
     }
 
-    if(!p->updateFormat(p->decoder->format())) {
+    if(!p->updateFormat(p->outputFormat(p->decoder->format()))) {
         p->enterErrorState();
         p->changeTrackStatus(TrackStatus::NoTrack);
         return;
     }
 
+    p->setupResampler(p->decoder->format());
+    p->dspChain.prepare(p->format);
+    p->pendingBuffer = p->process(p->convert(p->pendingBuffer));
+    p->updateOutputPath();
+    // Opening the output may have reset the renderer
+    p->syncClock(0);
+
+    p->renderer->queueReplayGain(p->replayGain(track));
     p->changeTrackStatus(TrackStatus::LoadedTrack);
 
     if(p->state == PlaybackState::Playing) {
@@ -366,14 +1198,27 @@ void AudioPlaybackEngine::changeTrack(const Track& track)
     }
 }
 
+void AudioPlaybackEngine::prepareNextTrack(const Track& track)
+{
+    if(!track.isValid()) {
+        return;
+    }
+
+    const std::scoped_lock lock{p->decodeLock};
+    p->trackToPrepare = track;
+    p->decodeCond.notify_one();
+}
+
 void AudioPlaybackEngine::play()
 {
+    const std::scoped_lock lock{p->decodeLock};
+
     if(p->status == TrackStatus::NoTrack || p->status == TrackStatus::InvalidTrack) {
         return;
     }
 
     if(p->status == TrackStatus::EndOfTrack && p->state == PlaybackState::Stopped) {
-        seek(0);
+        p->seek(0);
         emit positionChanged(0);
     }
 
@@ -382,12 +1227,14 @@ void AudioPlaybackEngine::play()
 
 void AudioPlaybackEngine::pause()
 {
+    const std::scoped_lock lock{p->decodeLock};
+
     if(p->status == TrackStatus::NoTrack || p->status == TrackStatus::InvalidTrack) {
         return;
     }
 
     if(p->status == TrackStatus::EndOfTrack && p->state == PlaybackState::Stopped) {
-        seek(0);
+        p->seek(0);
         emit positionChanged(0);
     }
     else {
@@ -397,17 +1244,38 @@ void AudioPlaybackEngine::pause()
 
 void AudioPlaybackEngine::stop()
 {
+    const std::scoped_lock lock{p->decodeLock};
     p->stop();
 }
 
 void AudioPlaybackEngine::setVolume(double volume)
 {
+    const std::scoped_lock lock{p->decodeLock};
+
     p->volume = volume;
-    p->renderer->updateVolume(volume);
+    // Software volume alters every sample, so it's left at unity for bit-perfect playback
+    p->renderer->updateVolume(p->bitPerfect ? 1.0 : volume);
+    p->updateOutputPath();
+}
+
+void AudioPlaybackEngine::setPositionInterval(int interval)
+{
+    const auto newInterval = interval > 0 ? std::chrono::milliseconds{interval} : IdlePositionInterval;
+    if(std::exchange(p->positionInterval, newInterval) == newInterval) {
+        return;
+    }
+
+    if(p->positionUpdateTimer) {
+        p->updatePositionTimer();
+    }
+    // Catch up straight away rather than after a full idle interval
+    p->updatePosition();
 }
 
 void AudioPlaybackEngine::setAudioOutput(const OutputCreator& output, const QString& device)
 {
+    const std::scoped_lock lock{p->decodeLock};
+
     const bool playing = p->state == PlaybackState::Playing;
 
     if(playing) {
@@ -435,6 +1303,8 @@ void AudioPlaybackEngine::setOutputDevice(const QString& device)
         return;
     }
 
+    const std::scoped_lock lock{p->decodeLock};
+
     const bool playing = p->state == PlaybackState::Playing;
 
     if(playing) {
@@ -456,13 +1326,44 @@ void AudioPlaybackEngine::setOutputDevice(const QString& device)
     }
 }
 
-void AudioPlaybackEngine::timerEvent(QTimerEvent* event)
+void AudioPlaybackEngine::setDsps(const DspCreators& dsps)
 {
-    if(event->timerId() == p->bufferTimer.timerId()) {
-        p->readNextBuffer();
+    std::vector<std::unique_ptr<DspNode>> nodes;
+    for(const auto& creator : dsps) {
+        if(auto node = creator()) {
+            nodes.push_back(std::move(node));
+        }
     }
 
-    QObject::timerEvent(event);
+    const std::scoped_lock lock{p->decodeLock};
+    p->dspChain.setNodes(std::move(nodes));
+    p->updateOutputPath();
+}
+
+BufferFillState AudioPlaybackEngine::bufferFill() const
+{
+    return {.buffered = p->bufferedTime.load(std::memory_order_relaxed),
+            .target   = p->readAhead.load(std::memory_order_relaxed)};
+}
+
+EngineStats AudioPlaybackEngine::stats() const
+{
+    EngineStats stats   = p->renderer->stats();
+    stats.decodeTime    = p->decodeTime.load(std::memory_order_relaxed);
+    stats.maxDecodeTime = p->maxDecodeTime.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+OutputPath AudioPlaybackEngine::outputPath() const
+{
+    const std::scoped_lock lock{p->decodeLock};
+    return p->outputPath;
+}
+
+const AnalysisTap* AudioPlaybackEngine::analysisTap() const
+{
+    return p->renderer->analysisTap();
 }
 } // namespace Fooyin
 
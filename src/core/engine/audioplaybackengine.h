@@ -20,6 +20,7 @@
 #pragma once
 
 #include <core/engine/audioengine.h>
+#include <utils/database/dbconnectionpool.h>
 
 namespace Fooyin {
 class SettingsManager;
@@ -29,25 +30,32 @@ class AudioPlaybackEngine : public AudioEngine
     Q_OBJECT
 
 public:
-    explicit AudioPlaybackEngine(SettingsManager* settings, QObject* parent = nullptr);
+    explicit AudioPlaybackEngine(SettingsManager* settings, DbConnectionPoolPtr seekIndexPool = {},
+                                 QObject* parent = nullptr);
     ~AudioPlaybackEngine() override;
 
+    [[nodiscard]] BufferFillState bufferFill() const override;
+    [[nodiscard]] EngineStats stats() const override;
+    [[nodiscard]] OutputPath outputPath() const override;
+    [[nodiscard]] const AnalysisTap* analysisTap() const override;
+
 public slots:
     void seek(uint64_t pos) override;
 
     void changeTrack(const Track& track) override;
+    void prepareNextTrack(const Track& track) override;
 
     void play() override;
     void pause() override;
     void stop() override;
 
     void setVolume(double volume) override;
+    void setPositionInterval(int interval) override;
 
     void setAudioOutput(const OutputCreator& output, const QString& device) override;
     void setOutputDevice(const QString& device) override;
 
-protected:
-    void timerEvent(QTimerEvent* event) override;
+    void setDsps(const DspCreators& dsps) override;
 
 private:
     struct Private;
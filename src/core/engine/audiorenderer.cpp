@@ -19,23 +19,32 @@
 
 #include "audiorenderer.h"
 
+#include "audiokernels.h"
+
+#include <core/engine/analysistap.h>
 #include <core/engine/audiobuffer.h>
 #include <core/engine/audiooutput.h>
-#include <utils/threadqueue.h>
+#include <utils/spscringbuffer.h>
+#include <utils/tracing.h>
 
 #include <QBasicTimer>
 #include <QDebug>
 #include <QTimer>
 #include <QTimerEvent>
 
+#include <atomic>
+#include <limits>
 #include <utility>
 
 using namespace std::chrono_literals;
 
 constexpr auto FadeInterval = 10;
+// Extra headroom on top of the engine buffer length so a full decode chunk always fits
+constexpr auto RingBufferPadding = 1000;
+constexpr auto NoEndOfTrack      = std::numeric_limits<size_t>::max();
 
 namespace Fooyin {
-struct AudioRenderer::Private
+struct AudioRenderer::Private : public AudioSource
 {
     AudioRenderer* self;
 
@@ -43,24 +52,65 @@ struct AudioRenderer::Private
     AudioFormat format;
     double volume{0.0};
     int bufferSize{0};
+    uint64_t bufferLength{0};
 
-    bool bufferPrefilled{false};
+    std::atomic<bool> bufferPrefilled{false};
+    bool pullMode{false};
 
-    ThreadQueue<AudioBuffer> bufferQueue{false};
+    SpscRingBuffer<std::byte> ringBuffer;
+    std::atomic<size_t> endOfTrackPos{NoEndOfTrack};
+    // In pull mode the ring can only be emptied from the consumer side
+    std::atomic<size_t> discardPos{0};
+    std::atomic<bool> pullActive{false};
     AudioBuffer tempBuffer;
     int totalSamplesWritten{0};
-    int currentBufferOffset{0};
 
     bool isRunning{false};
 
     QTimer* writeTimer;
 
     QBasicTimer fadeTimer;
-    int fadeLength{0};
-    int fadeSteps{0};
-    int currentFadeStep{0};
-    double volumeChange{0.0};
-    double initialVolume{0.0};
+    bool fadingOut{false};
+
+    // Fades are applied per sample by whichever thread consumes the ring buffer
+    std::atomic<float> fadeTarget{1.0F};
+    std::atomic<int> fadeFrames{0};
+    std::atomic<uint32_t> fadeRequest{0};
+    std::atomic<uint32_t> fadeCompleted{0};
+    // Consumer only
+    uint32_t fadeRequestSeen{0};
+    Audio::GainRamp fadeRamp;
+
+    // ReplayGain takes effect once the consumer reaches the write position it was queued at
+    std::atomic<float> pendingGain{1.0F};
+    std::atomic<size_t> pendingGainPos{0};
+    std::atomic<uint32_t> gainRequest{0};
+    // Consumer only
+    uint32_t gainRequestSeen{0};
+
+    // Written by whichever thread consumes the ring buffer
+    AnalysisTap analysisTap;
+
+    // Statistics, mostly written by whichever thread consumes the ring buffer. Durations in µs.
+    std::atomic<int> bytesPerFrame{0};
+    std::atomic<int> outputFreeSamples{0};
+    std::atomic<int> outputQueuedSamples{0};
+    std::atomic<uint64_t> outputLatency{0};
+    std::atomic<uint64_t> timerLateness{0};
+    std::atomic<uint64_t> maxTimerLateness{0};
+    std::atomic<uint64_t> underruns{0};
+    // Set once audio has reached the output, so running dry afterwards counts as an underrun
+    std::atomic<bool> outputFed{false};
+    std::chrono::steady_clock::time_point lastWrite;
+
+    // Segments are counted from segmentStart, the read position they began at
+    std::atomic<uint32_t> segment{0};
+    std::atomic<size_t> segmentStart{0};
+    // Published by the consumer, guarded by a sequence count which is odd while it's being written
+    std::atomic<uint32_t> presentSeq{0};
+    std::atomic<uint32_t> presentSegment{0};
+    std::atomic<uint64_t> presentFrames{0};
+    std::atomic<int64_t> presentTime{0};
 
     explicit Private(AudioRenderer* self_)
         : self{self_}
@@ -69,16 +119,51 @@ struct AudioRenderer::Private
         QObject::connect(writeTimer, &QTimer::timeout, self, [this]() { writeNext(); });
     }
 
-    void resetFade(int length)
+    void resetFade()
     {
         if(fadeTimer.isActive()) {
             fadeTimer.stop();
         }
 
-        volumeChange    = 0;
-        currentFadeStep = 0;
-        fadeLength      = length;
-        fadeSteps       = static_cast<int>(static_cast<double>(fadeLength) / FadeInterval);
+        fadingOut = false;
+        startFade(1.0F, 0);
+    }
+
+    void startFade(float target, int length)
+    {
+        fadeTarget.store(target, std::memory_order_relaxed);
+        fadeFrames.store(format.framesForDuration(length), std::memory_order_relaxed);
+        fadeRequest.fetch_add(1, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool fadeFinished() const
+    {
+        return fadeCompleted.load(std::memory_order_acquire) == fadeRequest.load(std::memory_order_relaxed)
+            || bufferedBytes() == 0;
+    }
+
+    void applyFade(std::byte* data, int frameCount)
+    {
+        const uint32_t gainChange = gainRequest.load(std::memory_order_acquire);
+        if(gainChange != gainRequestSeen && ringBuffer.totalRead() >= pendingGainPos.load(std::memory_order_relaxed)) {
+            gainRequestSeen = gainChange;
+            fadeRamp.scale  = pendingGain.load(std::memory_order_relaxed);
+        }
+
+        const uint32_t request = fadeRequest.load(std::memory_order_acquire);
+        if(request != fadeRequestSeen) {
+            // Start the new ramp from wherever the current one has reached
+            fadeRequestSeen = request;
+            fadeRamp        = {fadeRamp.current(), fadeTarget.load(std::memory_order_relaxed),
+                               fadeFrames.load(std::memory_order_relaxed), 0, AudioBuffer::RampCurve::EqualPower,
+                               fadeRamp.scale};
+        }
+
+        Audio::applyRamp(format, data, frameCount, fadeRamp);
+
+        if(fadeRamp.finished()) {
+            fadeCompleted.store(request, std::memory_order_release);
+        }
     }
 
     bool canWrite() const
@@ -94,25 +179,205 @@ struct AudioRenderer::Private
 
         audioOutput->setVolume(volume);
         bufferSize = audioOutput->bufferSize();
+        pullMode   = audioOutput->capabilities().testFlag(AudioOutput::PullMode);
         updateInterval();
 
+        bytesPerFrame.store(format.bytesPerFrame(), std::memory_order_relaxed);
+
+        if(pullMode) {
+            // Nothing is queued on our side, so the latency is just the output's own buffer
+            outputLatency.store(microseconds(static_cast<double>(bufferSize) / format.sampleRate()),
+                                std::memory_order_relaxed);
+            audioOutput->setSource(this);
+        }
+
         return true;
     }
 
+    void uninitOutput()
+    {
+        if(pullMode) {
+            pullActive.store(false, std::memory_order_release);
+            audioOutput->setSource(nullptr);
+        }
+        audioOutput->uninit();
+
+        // The output's callback has stopped, so any pending discard can be applied here
+        const size_t discard = discardPos.load(std::memory_order_acquire);
+        const size_t read    = ringBuffer.totalRead();
+        if(discard > read) {
+            ringBuffer.skip(discard - read);
+        }
+    }
+
+    void updateRingBuffer(const AudioFormat& prevFormat)
+    {
+        const auto required = static_cast<size_t>(format.bytesForDuration(bufferLength + RingBufferPadding));
+
+        if(prevFormat != format || ringBuffer.capacity() < required) {
+            ringBuffer.resize(required);
+            resetBuffer();
+        }
+
+        tempBuffer = {format, 0};
+        tempBuffer.reserve(static_cast<size_t>(format.bytesForFrames(bufferSize)));
+    }
+
+    void startSegment(size_t start)
+    {
+        segmentStart.store(start, std::memory_order_relaxed);
+        segment.fetch_add(1, std::memory_order_release);
+    }
+
+    // Records what is heard now, given the output's @p delay (in seconds) for audio read from here on
+    void publishPresentation(double delay)
+    {
+        const uint32_t current = segment.load(std::memory_order_acquire);
+        const size_t start     = segmentStart.load(std::memory_order_relaxed);
+        const size_t read      = ringBuffer.totalRead();
+        const auto stride      = static_cast<size_t>(format.bytesPerFrame());
+        if(stride == 0) {
+            return;
+        }
+
+        const uint64_t consumed = read > start ? (read - start) / stride : 0;
+        const auto delayFrames  = static_cast<uint64_t>(std::max(delay, 0.0) * format.sampleRate());
+        const uint64_t heard    = consumed > delayFrames ? consumed - delayFrames : 0;
+        const auto now          = std::chrono::steady_clock::now().time_since_epoch();
+
+        const uint32_t seq = presentSeq.load(std::memory_order_relaxed);
+        presentSeq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        presentSegment.store(current, std::memory_order_relaxed);
+        presentFrames.store(heard, std::memory_order_relaxed);
+        presentTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(),
+                          std::memory_order_relaxed);
+        presentSeq.store(seq + 2, std::memory_order_release);
+    }
+
     void resetBuffer()
     {
         bufferPrefilled     = false;
         totalSamplesWritten = 0;
-        currentBufferOffset = 0;
-        bufferQueue.clear();
-        tempBuffer.reset();
+        endOfTrackPos.store(NoEndOfTrack, std::memory_order_relaxed);
+        tempBuffer.clear();
+        analysisTap.clear();
+        outputFed.store(false, std::memory_order_relaxed);
+
+        if(pullMode) {
+            const size_t written = ringBuffer.totalWritten();
+            discardPos.store(written, std::memory_order_release);
+            startSegment(written);
+        }
+        else {
+            ringBuffer.clear();
+            discardPos.store(0, std::memory_order_relaxed);
+            pendingGainPos.store(0, std::memory_order_relaxed);
+            startSegment(0);
+        }
+    }
+
+    [[nodiscard]] size_t bufferedBytes() const
+    {
+        const size_t written = ringBuffer.totalWritten();
+        const size_t read    = std::max(ringBuffer.totalRead(), discardPos.load(std::memory_order_acquire));
+        return written > read ? written - read : 0;
+    }
+
+    void startPull()
+    {
+        pullActive.store(isRunning, std::memory_order_release);
+
+        if(canWrite() && !bufferPrefilled && bufferedBytes() > 0) {
+            bufferPrefilled = true;
+            audioOutput->start();
+        }
+    }
+
+    int readFrames(std::byte* data, int frameCount) override
+    {
+        if(!pullActive.load(std::memory_order_acquire)) {
+            return 0;
+        }
+
+        const size_t discard = discardPos.load(std::memory_order_acquire);
+        const size_t read    = ringBuffer.totalRead();
+        if(discard > read) {
+            ringBuffer.skip(discard - read);
+        }
+
+        // Without a reported delay, audio is heard once the output has played through its own buffer
+        double delay = audioOutput->latency();
+        if(delay < 0.0) {
+            delay = static_cast<double>(bufferSize) / format.sampleRate();
+        }
+        publishPresentation(delay);
+        outputLatency.store(microseconds(delay), std::memory_order_relaxed);
+
+        const auto stride  = static_cast<size_t>(format.bytesPerFrame());
+        const size_t bytes = std::min(static_cast<size_t>(frameCount) * stride, bytesUntilEndOfTrack());
+        const size_t count = ringBuffer.read(data, bytes - (bytes % stride));
+        const auto frames  = static_cast<int>(count / stride);
+
+        applyFade(data, frames);
+        analysisTap.write(format, data, frames, audibleAfter(delay));
+
+        if(frames > 0) {
+            outputFed.store(true, std::memory_order_relaxed);
+        }
+        if(!checkEndOfTrack() && frames < frameCount) {
+            countUnderrun();
+        }
+
+        return frames;
+    }
+
+    static AnalysisTap::TimePoint audibleAfter(double seconds)
+    {
+        const std::chrono::duration<double> delay{seconds};
+        return AnalysisTap::Clock::now() + std::chrono::duration_cast<AnalysisTap::Clock::duration>(delay);
+    }
+
+    static uint64_t microseconds(double seconds)
+    {
+        return seconds > 0.0 ? static_cast<uint64_t>(seconds * 1000000.0) : 0;
+    }
+
+    void countUnderrun()
+    {
+        // Only count the first empty read, not every one until audio arrives again
+        if(outputFed.exchange(false, std::memory_order_relaxed)) {
+            underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] size_t bytesUntilEndOfTrack() const
+    {
+        const size_t endPos = endOfTrackPos.load(std::memory_order_acquire);
+        if(endPos == NoEndOfTrack) {
+            return NoEndOfTrack;
+        }
+        return endPos - ringBuffer.totalRead();
+    }
+
+    bool checkEndOfTrack()
+    {
+        if(bytesUntilEndOfTrack() != 0) {
+            return false;
+        }
+
+        startSegment(endOfTrackPos.exchange(NoEndOfTrack, std::memory_order_acq_rel));
+        // The output running dry after the last track isn't an underrun
+        outputFed.store(false, std::memory_order_relaxed);
+        QMetaObject::invokeMethod(self, &AudioRenderer::finished);
+        return true;
     }
 
     void outputStateChanged(AudioOutput::State state)
     {
         if(state == AudioOutput::State::Disconnected) {
             emit self->outputStateChanged(state);
-            audioOutput->uninit();
+            uninitOutput();
             bufferPrefilled = false;
         }
     }
@@ -139,77 +404,107 @@ struct AudioRenderer::Private
         writeTimer->setInterval(interval);
     }
 
-    void writeNext()
+    void startWriteTimer()
     {
-        if(!canWrite() || bufferQueue.empty()) {
-            return;
-        }
+        lastWrite = {};
+        writeTimer->start();
+    }
 
-        const int samples = audioOutput->currentState().freeSamples;
+    void recordTimerLateness()
+    {
+        const auto now = std::chrono::steady_clock::now();
 
-        if((samples == 0 && totalSamplesWritten > 0) || (samples > 0 && renderAudio(samples) == samples)) {
-            if(canWrite() && !bufferPrefilled) {
-                bufferPrefilled = true;
-                audioOutput->start();
+        if(lastWrite != std::chrono::steady_clock::time_point{}) {
+            const auto elapsed  = std::chrono::duration_cast<std::chrono::microseconds>(now - lastWrite).count();
+            const auto interval = std::chrono::microseconds{writeTimer->intervalAsDuration()}.count();
+            const auto lateness = static_cast<uint64_t>(std::max<int64_t>(0, elapsed - interval));
+
+            timerLateness.store(lateness, std::memory_order_relaxed);
+            if(lateness > maxTimerLateness.load(std::memory_order_relaxed)) {
+                maxTimerLateness.store(lateness, std::memory_order_relaxed);
             }
         }
+
+        lastWrite = now;
     }
 
-    int writeAudioSamples(int samples)
+    void recordOutputState(const OutputState& state)
     {
-        tempBuffer.clear();
+        outputFreeSamples.store(state.freeSamples, std::memory_order_relaxed);
+        outputQueuedSamples.store(state.queuedSamples, std::memory_order_relaxed);
+        outputLatency.store(microseconds(state.delay), std::memory_order_relaxed);
 
-        int samplesBuffered{0};
+        if(bufferPrefilled && state.queuedSamples == 0) {
+            countUnderrun();
+        }
+    }
 
-        const int sstride = format.bytesPerFrame();
+    void writeNext()
+    {
+        FY_TRACE_SCOPE("AudioRenderer::writeNext");
+        recordTimerLateness();
 
-        while(isRunning && !bufferQueue.empty() && samplesBuffered < samples) {
-            const AudioBuffer& buffer = bufferQueue.front();
+        if(!canWrite()) {
+            return;
+        }
 
-            if(!buffer.isValid()) {
-                // End of file
-                currentBufferOffset = 0;
-                bufferQueue.dequeue();
-                QMetaObject::invokeMethod(self, &AudioRenderer::finished);
-                return samplesBuffered;
-            }
+        const OutputState state = audioOutput->currentState();
+        recordOutputState(state);
+        publishPresentation(state.delay);
 
-            const int bytesLeft = buffer.byteCount() - currentBufferOffset;
+        if(ringBuffer.empty()) {
+            checkEndOfTrack();
+            return;
+        }
 
-            if(bytesLeft <= 0) {
-                currentBufferOffset = 0;
-                emit self->bufferProcessed(buffer);
-                bufferQueue.dequeue();
-                continue;
-            }
+        const int samples = state.freeSamples;
 
-            const int sampleCount = std::min(bytesLeft / sstride, samples - samplesBuffered);
-            const int bytes       = sampleCount * sstride;
-            const auto fdata      = buffer.constData().subspan(currentBufferOffset, static_cast<size_t>(bytes));
+        // Audio written now is heard once everything already queued in the output has played
+        const auto audibleAt = audibleAfter(state.delay);
 
-            if(!tempBuffer.isValid()) {
-                tempBuffer = {fdata, buffer.format(), buffer.startTime()};
-            }
-            else {
-                tempBuffer.append(fdata);
+        if((samples == 0 && totalSamplesWritten > 0) || (samples > 0 && renderAudio(samples, audibleAt) == samples)) {
+            if(canWrite() && !bufferPrefilled) {
+                bufferPrefilled = true;
+                audioOutput->start();
             }
+        }
+    }
+
+    int writeAudioSamples(int samples, AnalysisTap::TimePoint audibleAt)
+    {
+        tempBuffer.clear();
 
-            samplesBuffered += sampleCount;
-            currentBufferOffset += bytes;
+        if(!isRunning || !tempBuffer.isValid()) {
+            return 0;
         }
 
-        tempBuffer.fillRemainingWithSilence();
+        const auto sstride = static_cast<size_t>(format.bytesPerFrame());
+        const size_t bytes = std::min(static_cast<size_t>(samples) * sstride, bytesUntilEndOfTrack());
+        const auto regions = ringBuffer.readRegions(bytes - (bytes % sstride));
 
-        if(!tempBuffer.isValid()) {
+        if(regions.empty()) {
+            checkEndOfTrack();
             return 0;
         }
 
-        return samplesBuffered;
+        tempBuffer.append(regions.first);
+        tempBuffer.append(regions.second);
+        ringBuffer.commitRead(regions.size());
+
+        const auto frames = static_cast<int>(regions.size() / sstride);
+        applyFade(tempBuffer.data(), frames);
+        analysisTap.write(format, tempBuffer.constData().data(), frames, audibleAt);
+
+        checkEndOfTrack();
+
+        tempBuffer.fillRemainingWithSilence();
+
+        return frames;
     }
 
-    int renderAudio(int samples)
+    int renderAudio(int samples, AnalysisTap::TimePoint audibleAt)
     {
-        if(writeAudioSamples(samples) == 0) {
+        if(writeAudioSamples(samples, audibleAt) == 0) {
             return 0;
         }
 
@@ -220,6 +515,10 @@ struct AudioRenderer::Private
         const int samplesWritten = audioOutput->write(tempBuffer);
         totalSamplesWritten += samplesWritten;
 
+        if(samplesWritten > 0) {
+            outputFed.store(true, std::memory_order_relaxed);
+        }
+
         return samplesWritten;
     }
 };
@@ -234,23 +533,29 @@ AudioRenderer::AudioRenderer(QObject* parent)
 AudioRenderer::~AudioRenderer()
 {
     if(p->audioOutput && p->audioOutput->initialised()) {
-        p->audioOutput->uninit();
+        p->uninitOutput();
     }
 }
 
 bool AudioRenderer::init(const AudioFormat& format)
 {
-    p->format = format;
+    const auto prevFormat = std::exchange(p->format, format);
 
     if(!p->audioOutput) {
         return false;
     }
 
     if(p->audioOutput->initialised()) {
-        p->audioOutput->uninit();
+        p->uninitOutput();
+    }
+
+    if(!p->initOutput()) {
+        return false;
     }
 
-    return p->initOutput();
+    p->updateRingBuffer(prevFormat);
+
+    return true;
 }
 
 void AudioRenderer::start()
@@ -259,22 +564,28 @@ void AudioRenderer::start()
         return;
     }
 
-    p->writeTimer->start();
+    if(p->pullMode) {
+        p->startPull();
+    }
+    else {
+        p->startWriteTimer();
+    }
 }
 
 void AudioRenderer::stop()
 {
     p->isRunning = false;
+    p->pullActive.store(false, std::memory_order_release);
     p->writeTimer->stop();
 
-    p->resetFade(0);
+    p->resetFade();
     p->resetBuffer();
 }
 
 void AudioRenderer::closeOutput()
 {
     if(p->audioOutput->initialised()) {
-        p->audioOutput->uninit();
+        p->uninitOutput();
     }
 }
 
@@ -284,7 +595,7 @@ void AudioRenderer::reset()
         p->audioOutput->reset();
     }
 
-    p->resetFade(0);
+    p->resetFade();
     p->resetBuffer();
 }
 
@@ -300,37 +611,135 @@ bool AudioRenderer::isFading() const
 
 void AudioRenderer::pause(bool paused, int fadeLength)
 {
-    p->resetFade(fadeLength);
+    if(p->fadeTimer.isActive()) {
+        p->fadeTimer.stop();
+    }
+
+    p->fadingOut = paused;
 
     if(paused) {
-        if(fadeLength == 0) {
-            p->volumeChange = -1.0;
-        }
-        else {
-            p->volumeChange = -(p->volume / p->fadeSteps);
-        }
+        p->startFade(0.0F, fadeLength);
     }
     else {
         p->pauseOutput(false);
 
         p->isRunning = true;
-        p->writeTimer->start();
-
-        if(fadeLength > 0) {
-            p->volumeChange = std::abs(p->initialVolume - p->volume) / p->fadeSteps;
+        if(p->pullMode) {
+            p->startPull();
         }
         else {
-            p->updateOutputVolume(p->initialVolume);
-            p->volumeChange = 1.0;
+            p->startWriteTimer();
         }
+
+        p->startFade(1.0F, fadeLength);
     }
 
     p->fadeTimer.start(FadeInterval, this);
 }
 
-void AudioRenderer::queueBuffer(const AudioBuffer& buffer)
+const AnalysisTap* AudioRenderer::analysisTap() const
 {
-    p->bufferQueue.enqueue(buffer);
+    return &p->analysisTap;
+}
+
+EngineStats AudioRenderer::stats() const
+{
+    EngineStats stats;
+
+    if(const int stride = p->bytesPerFrame.load(std::memory_order_relaxed); stride > 0) {
+        stats.queuedFrames = p->bufferedBytes() / static_cast<size_t>(stride);
+    }
+
+    stats.outputFreeSamples   = p->outputFreeSamples.load(std::memory_order_relaxed);
+    stats.outputQueuedSamples = p->outputQueuedSamples.load(std::memory_order_relaxed);
+    stats.outputLatency       = p->outputLatency.load(std::memory_order_relaxed);
+    stats.timerLateness       = p->timerLateness.load(std::memory_order_relaxed);
+    stats.maxTimerLateness    = p->maxTimerLateness.load(std::memory_order_relaxed);
+    stats.underruns           = p->underruns.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+uint32_t AudioRenderer::segment() const
+{
+    return p->segment.load(std::memory_order_acquire);
+}
+
+std::optional<AudioRenderer::Presentation> AudioRenderer::presentation() const
+{
+    using Clock = std::chrono::steady_clock;
+
+    while(true) {
+        const uint32_t seq = p->presentSeq.load(std::memory_order_acquire);
+        if(seq == 0) {
+            return {};
+        }
+        // Being written right now
+        if((seq & 1) != 0) {
+            continue;
+        }
+
+        Presentation presented;
+        presented.segment = p->presentSegment.load(std::memory_order_relaxed);
+        presented.frames  = p->presentFrames.load(std::memory_order_relaxed);
+
+        const std::chrono::nanoseconds time{p->presentTime.load(std::memory_order_relaxed)};
+        presented.time = Clock::time_point{std::chrono::duration_cast<Clock::duration>(time)};
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(p->presentSeq.load(std::memory_order_relaxed) == seq) {
+            return presented;
+        }
+    }
+}
+
+void AudioRenderer::setBufferLength(uint64_t length)
+{
+    p->bufferLength = length;
+}
+
+size_t AudioRenderer::bufferedBytes() const
+{
+    return p->bufferedBytes();
+}
+
+size_t AudioRenderer::freeBytes() const
+{
+    const auto stride = static_cast<size_t>(p->format.bytesPerFrame());
+    if(stride == 0) {
+        return 0;
+    }
+
+    const size_t available = p->ringBuffer.writeAvailable();
+    return available - (available % stride);
+}
+
+size_t AudioRenderer::queueBuffer(const AudioBuffer& buffer)
+{
+    if(!buffer.isValid()) {
+        return 0;
+    }
+
+    const size_t written = p->ringBuffer.write(buffer.constData());
+
+    // Called from the decode thread, so the output is started from ours
+    if(p->pullMode && (!p->pullActive.load(std::memory_order_acquire) || !p->bufferPrefilled)) {
+        QMetaObject::invokeMethod(this, [this]() { p->startPull(); }, Qt::QueuedConnection);
+    }
+
+    return written;
+}
+
+void AudioRenderer::queueEndOfTrack()
+{
+    p->endOfTrackPos.store(p->ringBuffer.totalWritten(), std::memory_order_release);
+}
+
+void AudioRenderer::queueReplayGain(float gain)
+{
+    p->pendingGain.store(gain, std::memory_order_relaxed);
+    p->pendingGainPos.store(p->ringBuffer.totalWritten(), std::memory_order_relaxed);
+    p->gainRequest.fetch_add(1, std::memory_order_release);
 }
 
 void AudioRenderer::updateOutput(const OutputCreator& output, const QString& device)
@@ -343,7 +752,7 @@ void AudioRenderer::updateOutput(const OutputCreator& output, const QString& dev
     const bool wasInitialised = p->audioOutput && p->audioOutput->initialised();
 
     if(wasInitialised) {
-        p->audioOutput->uninit();
+        p->uninitOutput();
         QObject::disconnect(p->audioOutput.get(), nullptr, this, nullptr);
     }
 
@@ -357,7 +766,7 @@ void AudioRenderer::updateOutput(const OutputCreator& output, const QString& dev
                      [this](const auto state) { p->outputStateChanged(state); });
 
     if(wasInitialised) {
-        p->audioOutput->init(p->format);
+        p->initOutput();
     }
 }
 
@@ -370,9 +779,9 @@ void AudioRenderer::updateDevice(const QString& device)
     p->bufferPrefilled = false;
 
     if(p->audioOutput && p->audioOutput->initialised()) {
-        p->audioOutput->uninit();
+        p->uninitOutput();
         p->audioOutput->setDevice(device);
-        p->audioOutput->init(p->format);
+        p->initOutput();
     }
     else {
         p->audioOutput->setDevice(device);
@@ -381,7 +790,6 @@ void AudioRenderer::updateDevice(const QString& device)
 
 void AudioRenderer::updateVolume(double volume)
 {
-    p->initialVolume = volume;
     p->updateOutputVolume(volume);
 }
 
@@ -391,13 +799,11 @@ void AudioRenderer::timerEvent(QTimerEvent* event)
         return;
     }
 
-    if(p->currentFadeStep <= p->fadeSteps) {
-        p->updateOutputVolume(std::clamp(p->volume + p->volumeChange, 0.0, 1.0));
-        p->currentFadeStep++;
+    if(!p->fadeFinished()) {
         return;
     }
 
-    if(p->volumeChange < 0.0) {
+    if(p->fadingOut) {
         if(p->audioOutput->currentState().queuedSamples > 0) {
             // Drain queued samples so we can fade in smoothly
             p->writeTimer->stop();
@@ -405,14 +811,12 @@ void AudioRenderer::timerEvent(QTimerEvent* event)
         }
         // Faded out
         p->isRunning = false;
+        p->outputFed.store(false, std::memory_order_relaxed);
+        p->pullActive.store(false, std::memory_order_release);
         p->writeTimer->stop();
         p->pauseOutput(true);
-        p->updateOutputVolume(0.0);
         emit paused();
     }
-    else {
-        p->updateOutputVolume(p->initialVolume);
-    }
 
     p->fadeTimer.stop();
 }
@@ -19,11 +19,16 @@
 
 #pragma once
 
+#include <core/engine/audioengine.h>
 #include <core/engine/audiooutput.h>
 
 #include <QObject>
 
+#include <chrono>
+#include <optional>
+
 namespace Fooyin {
+class AnalysisTap;
 class AudioBuffer;
 class AudioFormat;
 
@@ -32,6 +37,18 @@ class AudioRenderer : public QObject
     Q_OBJECT
 
 public:
+    /*!
+     * What the output was presenting at @c time, as reported by its delay.
+     * @c frames is the number of frames heard since the start of @c segment. A new segment starts whenever
+     * the render buffer is reset and when the output reaches the end of a track.
+     */
+    struct Presentation
+    {
+        uint32_t segment{0};
+        uint64_t frames{0};
+        std::chrono::steady_clock::time_point time;
+    };
+
     explicit AudioRenderer(QObject* parent = nullptr);
     ~AudioRenderer() override;
 
@@ -45,7 +62,40 @@ public:
     [[nodiscard]] bool isFading() const;
     void pause(bool paused, int fadeLength = 0);
 
-    void queueBuffer(const AudioBuffer& buffer);
+    /** Returns the tap holding the most recently rendered audio. */
+    [[nodiscard]] const AnalysisTap* analysisTap() const;
+
+    /*!
+     * Returns the renderer's share of the engine statistics, i.e. everything but decode times.
+     * @note this is thread-safe.
+     */
+    [[nodiscard]] EngineStats stats() const;
+
+    /** Returns the segment audio queued from now on belongs to. */
+    [[nodiscard]] uint32_t segment() const;
+    /*!
+     * Returns the most recent presentation reported by whichever thread consumes the render buffer.
+     * @note this is thread-safe.
+     */
+    [[nodiscard]] std::optional<Presentation> presentation() const;
+
+    /** Sets the length (in ms) of audio the engine will keep buffered ahead of the output. */
+    void setBufferLength(uint64_t length);
+
+    [[nodiscard]] size_t bufferedBytes() const;
+    [[nodiscard]] size_t freeBytes() const;
+
+    /*!
+     * Copies the PCM data contained in @p buffer into the render buffer.
+     * @note this and @fn queueEndOfTrack may be called from a separate decoding thread, but not concurrently
+     * with any other non-const method.
+     * @returns the number of bytes queued, which may be less than the buffer size if there isn't enough free space.
+     */
+    size_t queueBuffer(const AudioBuffer& buffer);
+    /** Marks the end of the current track at the current write position. */
+    void queueEndOfTrack();
+    /** Sets the linear ReplayGain applied to audio from the current write position onwards. */
+    void queueReplayGain(float gain);
 
     void updateOutput(const OutputCreator& output, const QString& device);
     void updateDevice(const QString& device);
@@ -54,7 +104,6 @@ public:
 signals:
     void paused();
     void outputStateChanged(AudioOutput::State state);
-    void bufferProcessed(const AudioBuffer& buffer);
     void finished();
 
 protected:
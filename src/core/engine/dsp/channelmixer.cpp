@@ -0,0 +1,70 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "channelmixer.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Fooyin {
+ChannelMixer::ChannelMixer(Mode mode)
+    : m_mode{mode}
+{ }
+
+QString ChannelMixer::name() const
+{
+    return QCoreApplication::translate("ChannelMixer", "Channel Mixer");
+}
+
+void ChannelMixer::prepare(const AudioFormat& format, int /*maxFrames*/)
+{
+    m_channels = format.channelCount();
+}
+
+void ChannelMixer::process(std::span<float> data, int frames)
+{
+    const auto channels = static_cast<size_t>(m_channels);
+    if(channels < 2) {
+        return;
+    }
+
+    const float scale = 1.0F / static_cast<float>(channels);
+
+    for(size_t frame{0}; frame < static_cast<size_t>(frames); ++frame) {
+        float* samples = data.data() + (frame * channels);
+
+        switch(m_mode) {
+            case(Mode::Mono):
+                std::fill_n(samples, channels, std::accumulate(samples, samples + channels, 0.0F) * scale);
+                break;
+            case(Mode::SwapLeftRight):
+                std::swap(samples[0], samples[1]);
+                break;
+            case(Mode::LeftOnly):
+                samples[1] = samples[0];
+                break;
+            case(Mode::RightOnly):
+                samples[0] = samples[1];
+                break;
+        }
+    }
+}
+} // namespace Fooyin
@@ -0,0 +1,54 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/dspnode.h>
+
+namespace Fooyin {
+/*!
+ * Remixes the channels of each frame, without changing the channel count.
+ * The stereo modes only affect the first two channels.
+ */
+class FYCORE_EXPORT ChannelMixer : public DspNode
+{
+public:
+    enum class Mode : uint8_t
+    {
+        // Every channel plays the average of all channels
+        Mono = 0,
+        SwapLeftRight,
+        LeftOnly,
+        RightOnly,
+    };
+
+    explicit ChannelMixer(Mode mode = Mode::Mono);
+
+    [[nodiscard]] QString name() const override;
+
+    void prepare(const AudioFormat& format, int maxFrames) override;
+    void process(std::span<float> data, int frames) override;
+
+private:
+    Mode m_mode;
+    int m_channels{0};
+};
+} // namespace Fooyin
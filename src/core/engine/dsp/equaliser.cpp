@@ -0,0 +1,113 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "equaliser.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+// One octave wide bands
+constexpr auto BandQ = 1.41;
+// Bands this close to the Nyquist frequency would be unstable
+constexpr auto MaxBandRatio = 0.45;
+// State values below this are flushed to zero, so silence doesn't decay into denormals
+constexpr auto DenormalLimit = 1e-15F;
+
+namespace Fooyin {
+Equaliser::Equaliser(const Gains& gains)
+    : m_gains{gains}
+{ }
+
+QString Equaliser::name() const
+{
+    return QCoreApplication::translate("Equaliser", "Equaliser");
+}
+
+void Equaliser::prepare(const AudioFormat& format, int /*maxFrames*/)
+{
+    m_channels = format.channelCount();
+    m_filters.clear();
+
+    const auto sampleRate = static_cast<double>(format.sampleRate());
+
+    for(size_t band{0}; band < BandCount; ++band) {
+        const double gain      = std::clamp(m_gains.at(band), MinGain, MaxGain);
+        const double frequency = Frequencies.at(band);
+        if(gain == 0.0 || frequency >= sampleRate * MaxBandRatio) {
+            continue;
+        }
+
+        // Peaking filter from the Audio EQ Cookbook
+        const double a     = std::pow(10.0, gain / 40.0);
+        const double w0    = 2.0 * std::numbers::pi * frequency / sampleRate;
+        const double alpha = std::sin(w0) / (2.0 * BandQ);
+        const double cosW0 = std::cos(w0);
+        const double a0    = 1.0 + (alpha / a);
+
+        Filter filter;
+        filter.b0 = static_cast<float>((1.0 + (alpha * a)) / a0);
+        filter.b1 = static_cast<float>((-2.0 * cosW0) / a0);
+        filter.b2 = static_cast<float>((1.0 - (alpha * a)) / a0);
+        filter.a1 = static_cast<float>((-2.0 * cosW0) / a0);
+        filter.a2 = static_cast<float>((1.0 - (alpha / a)) / a0);
+        m_filters.push_back(filter);
+    }
+
+    m_state.assign(m_filters.size() * static_cast<size_t>(m_channels) * 2, 0.0F);
+}
+
+void Equaliser::process(std::span<float> data, int frames)
+{
+    const auto channels = static_cast<size_t>(m_channels);
+
+    for(size_t i{0}; i < m_filters.size(); ++i) {
+        const Filter& filter = m_filters[i];
+        float* state         = m_state.data() + (i * channels * 2);
+
+        // Transposed direct form II
+        for(size_t frame{0}; frame < static_cast<size_t>(frames); ++frame) {
+            float* samples = data.data() + (frame * channels);
+            for(size_t ch{0}; ch < channels; ++ch) {
+                float& s1       = state[ch * 2];
+                float& s2       = state[(ch * 2) + 1];
+                const float in  = samples[ch];
+                const float out = (filter.b0 * in) + s1;
+
+                s1          = (filter.b1 * in) - (filter.a1 * out) + s2;
+                s2          = (filter.b2 * in) - (filter.a2 * out);
+                samples[ch] = out;
+            }
+        }
+
+        for(size_t j{0}; j < channels * 2; ++j) {
+            if(std::abs(state[j]) < DenormalLimit) {
+                state[j] = 0.0F;
+            }
+        }
+    }
+}
+
+void Equaliser::reset()
+{
+    std::ranges::fill(m_state, 0.0F);
+}
+} // namespace Fooyin
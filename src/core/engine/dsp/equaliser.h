@@ -0,0 +1,70 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/dspnode.h>
+
+#include <array>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A ten band graphic equaliser, built from one peaking filter per octave band.
+ * Bands left at 0 dB, or above the Nyquist frequency, cost nothing.
+ */
+class FYCORE_EXPORT Equaliser : public DspNode
+{
+public:
+    static constexpr size_t BandCount = 10;
+    static constexpr std::array<double, BandCount> Frequencies{31.0,   62.0,   125.0,  250.0,  500.0,
+                                                               1000.0, 2000.0, 4000.0, 8000.0, 16000.0};
+    // Limits of each band's gain in dB
+    static constexpr double MinGain = -12.0;
+    static constexpr double MaxGain = 12.0;
+
+    using Gains = std::array<double, BandCount>;
+
+    explicit Equaliser(const Gains& gains = {});
+
+    [[nodiscard]] QString name() const override;
+
+    void prepare(const AudioFormat& format, int maxFrames) override;
+    void process(std::span<float> data, int frames) override;
+    void reset() override;
+
+private:
+    struct Filter
+    {
+        float b0{1.0F};
+        float b1{0.0F};
+        float b2{0.0F};
+        float a1{0.0F};
+        float a2{0.0F};
+    };
+
+    Gains m_gains;
+    int m_channels{0};
+    std::vector<Filter> m_filters;
+    // Two state values per channel for each filter
+    std::vector<float> m_state;
+};
+} // namespace Fooyin
@@ -0,0 +1,71 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "limiter.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Fooyin {
+Limiter::Limiter(double threshold, int release)
+    : m_threshold{static_cast<float>(std::pow(10.0, std::min(threshold, 0.0) / 20.0))}
+    , m_release{std::max(release, 1)}
+{ }
+
+QString Limiter::name() const
+{
+    return QCoreApplication::translate("Limiter", "Limiter");
+}
+
+void Limiter::prepare(const AudioFormat& format, int /*maxFrames*/)
+{
+    m_channels     = format.channelCount();
+    m_releaseCoeff = static_cast<float>(std::exp(-1000.0 / (m_release * static_cast<double>(format.sampleRate()))));
+    m_gain         = 1.0F;
+}
+
+void Limiter::process(std::span<float> data, int frames)
+{
+    const auto channels = static_cast<size_t>(m_channels);
+
+    for(size_t frame{0}; frame < static_cast<size_t>(frames); ++frame) {
+        float* samples = data.data() + (frame * channels);
+
+        float peak{0.0F};
+        for(size_t ch{0}; ch < channels; ++ch) {
+            peak = std::max(peak, std::abs(samples[ch]));
+        }
+
+        const float target = peak > m_threshold ? m_threshold / peak : 1.0F;
+        // Attack instantly, so nothing gets past the threshold
+        m_gain = target < m_gain ? target : target + ((m_gain - target) * m_releaseCoeff);
+
+        for(size_t ch{0}; ch < channels; ++ch) {
+            samples[ch] *= m_gain;
+        }
+    }
+}
+
+void Limiter::reset()
+{
+    m_gain = 1.0F;
+}
+} // namespace Fooyin
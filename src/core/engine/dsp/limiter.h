@@ -0,0 +1,49 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/dspnode.h>
+
+namespace Fooyin {
+/*!
+ * Keeps peaks under a threshold by reducing the gain instantly, then releasing it gradually.
+ * Works without lookahead, so it adds no latency.
+ */
+class FYCORE_EXPORT Limiter : public DspNode
+{
+public:
+    explicit Limiter(double threshold = -1.0, int release = 100);
+
+    [[nodiscard]] QString name() const override;
+
+    void prepare(const AudioFormat& format, int maxFrames) override;
+    void process(std::span<float> data, int frames) override;
+    void reset() override;
+
+private:
+    float m_threshold;
+    int m_release;
+    int m_channels{0};
+    float m_releaseCoeff{0.0F};
+    float m_gain{1.0F};
+};
+} // namespace Fooyin
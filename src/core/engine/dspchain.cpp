@@ -0,0 +1,150 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dspchain.h"
+
+#include <core/engine/audioconverter.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace Fooyin {
+DspChain::DspChain() = default;
+
+DspChain::~DspChain() = default;
+
+void DspChain::setNodes(std::vector<std::unique_ptr<DspNode>> nodes)
+{
+    m_nodes   = std::move(nodes);
+    m_flushed = true;
+
+    if(m_floatFormat.isValid()) {
+        for(const auto& node : m_nodes) {
+            node->prepare(m_floatFormat, BlockFrames);
+        }
+    }
+}
+
+bool DspChain::isEmpty() const
+{
+    return m_nodes.empty();
+}
+
+void DspChain::prepare(const AudioFormat& format)
+{
+    if(format == m_format) {
+        return;
+    }
+
+    m_format      = format;
+    m_floatFormat = format;
+    m_floatFormat.setSampleFormat(SampleFormat::Float);
+    m_flushed = true;
+
+    if(!format.isValid()) {
+        m_block = {};
+        return;
+    }
+
+    m_block.assign(static_cast<size_t>(BlockFrames * format.channelCount()), 0.0F);
+
+    for(const auto& node : m_nodes) {
+        node->prepare(m_floatFormat, BlockFrames);
+    }
+}
+
+int DspChain::latency() const
+{
+    int total{0};
+    for(const auto& node : m_nodes) {
+        total += node->latency();
+    }
+    return total;
+}
+
+void DspChain::reset()
+{
+    m_flushed = true;
+
+    for(const auto& node : m_nodes) {
+        node->reset();
+    }
+}
+
+AudioBuffer DspChain::process(AudioBuffer buffer)
+{
+    if(m_nodes.empty() || !buffer.isValid() || buffer.format() != m_format) {
+        return buffer;
+    }
+
+    m_flushed = false;
+
+    const int frames = buffer.frameCount();
+    std::byte* data  = buffer.data();
+
+    for(int frame{0}; frame < frames; frame += BlockFrames) {
+        processBlock(data + m_format.bytesForFrames(frame), std::min(BlockFrames, frames - frame));
+    }
+
+    return buffer;
+}
+
+AudioBuffer DspChain::flush(uint64_t startTime)
+{
+    const int frames = latency();
+    if(std::exchange(m_flushed, true) || frames <= 0 || !m_format.isValid()) {
+        return {};
+    }
+
+    AudioBuffer buffer{m_format, startTime};
+    buffer.resize(static_cast<size_t>(m_format.bytesForFrames(frames)));
+    buffer.fillSilence();
+
+    std::byte* data = buffer.data();
+    for(int frame{0}; frame < frames; frame += BlockFrames) {
+        processBlock(data + m_format.bytesForFrames(frame), std::min(BlockFrames, frames - frame));
+    }
+
+    return buffer;
+}
+
+void DspChain::processBlock(std::byte* data, int frames)
+{
+    const auto samples = static_cast<size_t>(frames * m_format.channelCount());
+
+    if(m_format.sampleFormat() == SampleFormat::Float) {
+        const std::span<float> block{reinterpret_cast<float*>(data), samples};
+        for(const auto& node : m_nodes) {
+            node->process(block, frames);
+        }
+        return;
+    }
+
+    auto* block = reinterpret_cast<std::byte*>(m_block.data());
+    Audio::convert(m_format, data, m_floatFormat, block, frames);
+
+    const std::span<float> floatBlock{m_block.data(), samples};
+    for(const auto& node : m_nodes) {
+        node->process(floatBlock, frames);
+    }
+
+    // Dither when going back down to 16 bits, as the nodes will usually have changed the levels
+    Audio::convert(m_floatFormat, block, m_format, data, frames, m_format.sampleFormat() == SampleFormat::S16);
+}
+} // namespace Fooyin
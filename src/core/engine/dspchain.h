@@ -0,0 +1,76 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/engine/audiobuffer.h>
+#include <core/engine/dspnode.h>
+
+#include <memory>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Runs audio through a list of DspNodes in order.
+ * Audio in other sample formats is converted to float a block at a time, so nothing is allocated per buffer.
+ * @note not thread-safe; owned by the engine and used on the decode thread.
+ */
+class FYCORE_EXPORT DspChain
+{
+public:
+    // Largest number of frames passed to a node at once
+    static constexpr int BlockFrames = 1024;
+
+    DspChain();
+    ~DspChain();
+
+    DspChain(const DspChain& other)            = delete;
+    DspChain& operator=(const DspChain& other) = delete;
+
+    /** Replaces the current nodes, preparing them for the current format if there is one. */
+    void setNodes(std::vector<std::unique_ptr<DspNode>> nodes);
+    [[nodiscard]] bool isEmpty() const;
+
+    /** Prepares all nodes for audio in @p format. Does nothing if the format is unchanged. */
+    void prepare(const AudioFormat& format);
+    /** Returns the total latency of all nodes in frames. */
+    [[nodiscard]] int latency() const;
+    void reset();
+
+    /** Processes @p buffer in place, which must be in the format passed to @fn prepare. */
+    AudioBuffer process(AudioBuffer buffer);
+    /*!
+     * Pushes out the audio held back by the nodes' latency by feeding them silence.
+     * @returns an invalid buffer if there is nothing left to flush since the last call to @fn process.
+     */
+    AudioBuffer flush(uint64_t startTime);
+
+private:
+    void processBlock(std::byte* data, int frames);
+
+    AudioFormat m_format;
+    AudioFormat m_floatFormat;
+    std::vector<std::unique_ptr<DspNode>> m_nodes;
+    // Working block for formats other than float
+    std::vector<float> m_block;
+    bool m_flushed{true};
+};
+} // namespace Fooyin
@@ -19,19 +19,50 @@
 
 #include "enginehandler.h"
 
+#include "archive/archivecache.h"
+#include "audiobufferpool.h"
 #include "audioplaybackengine.h"
+#include "database/database.h"
+#include "database/seekindexdatabase.h"
+#include "engine/dsp/channelmixer.h"
+#include "engine/dsp/equaliser.h"
+#include "engine/dsp/limiter.h"
 #include "engine/ffmpeg/ffmpegdecoder.h"
+#include "filereader.h"
+#include "internalcoresettings.h"
 
 #include <core/coresettings.h>
 #include <core/engine/audioengine.h>
+#include <core/engine/dspplugin.h>
 #include <core/engine/outputplugin.h>
 #include <core/track.h>
 
 #include <core/player/playercontroller.h>
+#include <utils/async.h>
+#include <utils/database/dbconnectionhandler.h>
 #include <utils/settings/settingsmanager.h>
 
 #include <QThread>
 
+#include <set>
+
+constexpr auto EqualiserId    = "Fooyin.Dsp.Equaliser";
+constexpr auto LimiterId      = "Fooyin.Dsp.Limiter";
+constexpr auto ChannelMixerId = "Fooyin.Dsp.ChannelMixer";
+
+namespace {
+Fooyin::DbConnection::DbParams seekIndexParams(Fooyin::SettingsManager* settings)
+{
+    Fooyin::DbConnection::DbParams params;
+    params.type           = QStringLiteral("QSQLITE");
+    params.connectOptions = QStringLiteral("QSQLITE_OPEN_URI");
+    params.filePath       = Fooyin::SeekIndexDatabase::cachePath();
+    params.profile        = Fooyin::Database::profile(settings);
+
+    return params;
+}
+} // namespace
+
 namespace Fooyin {
 struct CurrentOutput
 {
@@ -46,18 +77,34 @@ struct EngineHandler::Private
     PlayerController* playerController;
     SettingsManager* settings;
 
+    DbConnectionPoolPtr seekIndexPool;
+
     QThread engineThread;
     AudioEngine* engine;
 
     std::map<QString, OutputCreator> outputs;
+    // Devices of each output as last enumerated, and the outputs being enumerated now
+    std::map<QString, OutputDevices> outputDevices;
+    std::set<QString> enumerating;
     CurrentOutput currentOutput;
+    // Underruns counted against outputs used earlier in the session
+    std::map<QString, uint64_t> outputUnderruns;
+    uint64_t underrunsAtOutputChange{0};
+
+    OutputPath outputPath;
+
+    // DSPs added by plugins
+    std::map<QString, DspBuilder> dsps;
 
     Private(EngineHandler* self_, PlayerController* playerController_, SettingsManager* settings_)
         : self{self_}
         , playerController{playerController_}
         , settings{settings_}
-        , engine{new AudioPlaybackEngine(settings)}
+        , seekIndexPool{DbConnectionPool::create(seekIndexParams(settings), QStringLiteral("seekindex"))}
+        , engine{new AudioPlaybackEngine(settings, seekIndexPool)}
     {
+        initSeekIndex();
+
         engine->moveToThread(&engineThread);
         engineThread.start();
 
@@ -67,12 +114,29 @@ struct EngineHandler::Private
         QObject::connect(engine, &AudioEngine::trackAboutToFinish, self, &EngineHandler::trackAboutToFinish);
         QObject::connect(engine, &AudioEngine::positionChanged, playerController,
                          &PlayerController::setCurrentPosition);
+        QObject::connect(playerController, &PlayerController::positionIntervalChanged, engine,
+                         &AudioEngine::setPositionInterval);
         QObject::connect(engine, &AudioEngine::stateChanged, self,
                          [this](PlaybackState state) { handleStateChange(state); });
         QObject::connect(engine, &AudioEngine::trackStatusChanged, self,
                          [this](TrackStatus status) { handleTrackStatus(status); });
+        QObject::connect(engine, &AudioEngine::outputPathChanged, self, [this](const OutputPath& path) {
+            outputPath = path;
+            emit self->outputPathChanged(path);
+        });
+        QObject::connect(engine, &AudioEngine::streamTitleChanged, playerController,
+                         &PlayerController::setStreamTitle);
 
         updateVolume(settings->value<Settings::Core::OutputVolume>());
+        updatePositionInterval(playerController->positionInterval());
+    }
+
+    void initSeekIndex() const
+    {
+        const DbConnectionHandler dbHandler{seekIndexPool};
+        SeekIndexDatabase indexDb;
+        indexDb.initialise(DbConnectionProvider{seekIndexPool});
+        indexDb.initialiseDatabase();
     }
 
     void handleStateChange(PlaybackState state) const
@@ -129,6 +193,31 @@ struct EngineHandler::Private
             Qt::QueuedConnection);
     }
 
+    // Enumerates the devices of @p output on a worker thread, as drivers may block for a while doing so
+    void refreshDevices(const QString& output)
+    {
+        const auto creatorIt = outputs.find(output);
+        if(creatorIt == outputs.cend() || !enumerating.emplace(output).second) {
+            return;
+        }
+
+        Utils::asyncExec([creator = creatorIt->second]() {
+            // A separate instance, so the one playing is left alone
+            if(auto out = creator()) {
+                return out->getAllDevices();
+            }
+            return OutputDevices{};
+        }).then(self, [this, output](const OutputDevices& devices) {
+            enumerating.erase(output);
+
+            auto& cached = outputDevices[output];
+            if(cached != devices) {
+                cached = devices;
+                emit self->outputDevicesChanged(output);
+            }
+        });
+    }
+
     void changeOutput(const QString& output)
     {
         if(output.isEmpty()) {
@@ -159,6 +248,7 @@ struct EngineHandler::Private
         }
 
         if(currentOutput.name != newName) {
+            recordUnderruns();
             currentOutput = {newName, device};
             emit self->outputChanged(newName, device);
         }
@@ -168,11 +258,79 @@ struct EngineHandler::Private
         }
     }
 
+    void recordUnderruns()
+    {
+        const uint64_t underruns = engine->stats().underruns;
+        if(!currentOutput.name.isEmpty()) {
+            outputUnderruns[currentOutput.name] += underruns - underrunsAtOutputChange;
+        }
+        underrunsAtOutputChange = underruns;
+    }
+
     void updateVolume(double volume)
     {
         QMetaObject::invokeMethod(
             engine, [this, volume]() { engine->setVolume(volume); }, Qt::QueuedConnection);
     }
+
+    void updatePositionInterval(int interval)
+    {
+        QMetaObject::invokeMethod(
+            engine, [this, interval]() { engine->setPositionInterval(interval); }, Qt::QueuedConnection);
+    }
+
+    [[nodiscard]] Equaliser::Gains equaliserGains() const
+    {
+        Equaliser::Gains gains{};
+
+        const auto values = settings->value<Settings::Core::Internal::EqualiserGains>().toList();
+        for(size_t i{0}; i < std::min(gains.size(), static_cast<size_t>(values.size())); ++i) {
+            gains.at(i) = values.at(static_cast<qsizetype>(i)).toDouble();
+        }
+
+        return gains;
+    }
+
+    // Built-in DSPs are created with the settings current at the time the chain is built
+    [[nodiscard]] DspCreator dspCreator(const QString& id) const
+    {
+        using namespace Settings::Core::Internal;
+
+        if(id == QLatin1String{EqualiserId}) {
+            return [gains = equaliserGains()]() { return std::make_unique<Equaliser>(gains); };
+        }
+        if(id == QLatin1String{LimiterId}) {
+            const double threshold = settings->value<LimiterThreshold>();
+            const int release      = settings->value<LimiterRelease>();
+            return [threshold, release]() { return std::make_unique<Limiter>(threshold, release); };
+        }
+        if(id == QLatin1String{ChannelMixerId}) {
+            const auto mode = static_cast<ChannelMixer::Mode>(settings->value<ChannelMixerMode>());
+            return [mode]() { return std::make_unique<ChannelMixer>(mode); };
+        }
+        if(dsps.contains(id)) {
+            return dsps.at(id).creator;
+        }
+        return {};
+    }
+
+    void updateDspChain()
+    {
+        DspCreators creators;
+
+        const QStringList chain = settings->value<Settings::Core::DspChain>();
+        for(const QString& id : chain) {
+            if(auto creator = dspCreator(id)) {
+                creators.push_back(std::move(creator));
+            }
+            else {
+                qWarning() << QStringLiteral("DSP (%1) hasn't been registered").arg(id);
+            }
+        }
+
+        QMetaObject::invokeMethod(
+            engine, [this, creators]() { engine->setDsps(creators); }, Qt::QueuedConnection);
+    }
 };
 
 EngineHandler::EngineHandler(PlayerController* playerController, SettingsManager* settings, QObject* parent)
@@ -194,6 +352,12 @@ EngineHandler::EngineHandler(PlayerController* playerController, SettingsManager
     p->settings->subscribe<Settings::Core::AudioOutput>(this,
                                                         [this](const QString& output) { p->changeOutput(output); });
     p->settings->subscribe<Settings::Core::OutputVolume>(this, [this](double volume) { p->updateVolume(volume); });
+
+    p->settings->subscribe<Settings::Core::DspChain>(this, [this]() { p->updateDspChain(); });
+    p->settings->subscribe<Settings::Core::Internal::EqualiserGains>(this, [this]() { p->updateDspChain(); });
+    p->settings->subscribe<Settings::Core::Internal::LimiterThreshold>(this, [this]() { p->updateDspChain(); });
+    p->settings->subscribe<Settings::Core::Internal::LimiterRelease>(this, [this]() { p->updateDspChain(); });
+    p->settings->subscribe<Settings::Core::Internal::ChannelMixerMode>(this, [this]() { p->updateDspChain(); });
 }
 
 EngineHandler::~EngineHandler()
@@ -205,6 +369,35 @@ EngineHandler::~EngineHandler()
 void EngineHandler::setup()
 {
     p->changeOutput(p->settings->value<Settings::Core::AudioOutput>());
+    p->updateDspChain();
+
+    // So device lists are ready by the time they're first shown
+    for(const auto& [name, output] : p->outputs) {
+        p->refreshDevices(name);
+    }
+}
+
+void EngineHandler::prepareNextTrack(const Track& track)
+{
+    QMetaObject::invokeMethod(
+        p->engine, [this, track]() { p->engine->prepareNextTrack(track); }, Qt::QueuedConnection);
+}
+
+void EngineHandler::prefetchTrack(const Track& track)
+{
+    if(!track.isValid()) {
+        return;
+    }
+
+    Utils::asyncExec([track]() {
+        if(track.isInArchive()) {
+            // Extracting is the slow part, and leaves the entry in the page cache as well
+            ArchiveCache::instance().file(track.filepath());
+        }
+        else {
+            FileReader::prefetch(track.filepath());
+        }
+    });
 }
 
 OutputNames EngineHandler::getAllOutputs() const
@@ -225,11 +418,11 @@ OutputDevices EngineHandler::getOutputDevices(const QString& output) const
         return {};
     }
 
-    if(auto out = p->outputs.at(output)()) {
-        return out->getAllDevices();
-    }
+    // Devices may have been plugged in or removed since the last call
+    p->refreshDevices(output);
 
-    return {};
+    const auto devicesIt = p->outputDevices.find(output);
+    return devicesIt != p->outputDevices.cend() ? devicesIt->second : OutputDevices{};
 }
 
 void EngineHandler::addOutput(const AudioOutputBuilder& output)
@@ -241,9 +434,63 @@ void EngineHandler::addOutput(const AudioOutputBuilder& output)
     p->outputs.emplace(output.name, output.creator);
 }
 
+DspInfos EngineHandler::getAllDsps() const
+{
+    DspInfos dsps{{QString::fromLatin1(EqualiserId), tr("Equaliser")},
+                  {QString::fromLatin1(LimiterId), tr("Limiter")},
+                  {QString::fromLatin1(ChannelMixerId), tr("Channel Mixer")}};
+
+    for(const auto& [id, dsp] : p->dsps) {
+        dsps.push_back({id, dsp.name});
+    }
+
+    return dsps;
+}
+
+void EngineHandler::addDsp(const DspBuilder& dsp)
+{
+    if(p->dsps.contains(dsp.id) || p->dspCreator(dsp.id)) {
+        qDebug() << QStringLiteral("DSP (%1) already registered").arg(dsp.id);
+        return;
+    }
+    p->dsps.emplace(dsp.id, dsp);
+}
+
 std::unique_ptr<AudioDecoder> EngineHandler::createDecoder()
 {
-    return std::make_unique<FFmpegDecoder>();
+    return std::make_unique<FFmpegDecoder>(p->seekIndexPool);
+}
+
+BufferPoolStats EngineHandler::bufferPoolStats() const
+{
+    return AudioBufferPool::instance().stats();
+}
+
+BufferFillState EngineHandler::bufferFill() const
+{
+    return p->engine->bufferFill();
+}
+
+EngineStats EngineHandler::engineStats() const
+{
+    EngineStats stats     = p->engine->stats();
+    stats.outputUnderruns = p->outputUnderruns;
+
+    if(!p->currentOutput.name.isEmpty()) {
+        stats.outputUnderruns[p->currentOutput.name] += stats.underruns - p->underrunsAtOutputChange;
+    }
+
+    return stats;
+}
+
+OutputPath EngineHandler::outputPath() const
+{
+    return p->outputPath;
+}
+
+const AnalysisTap* EngineHandler::analysisTap() const
+{
+    return p->engine->analysisTap();
 }
 } // namespace Fooyin
 
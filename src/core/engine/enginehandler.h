@@ -26,7 +26,9 @@
 namespace Fooyin {
 class SettingsManager;
 class PlayerController;
+class Track;
 struct AudioOutputBuilder;
+struct DspBuilder;
 
 using OutputNames = std::vector<QString>;
 
@@ -39,13 +41,26 @@ public:
     ~EngineHandler() override;
 
     void setup();
+    /** Opens @p track ahead of time so it can follow the current track without a gap. */
+    void prepareNextTrack(const Track& track);
+    /** Reads the file of @p track into the page cache in the background, so opening it later doesn't block. */
+    void prefetchTrack(const Track& track);
 
     [[nodiscard]] OutputNames getAllOutputs() const override;
     [[nodiscard]] OutputDevices getOutputDevices(const QString& output) const override;
     void addOutput(const AudioOutputBuilder& output) override;
 
+    [[nodiscard]] DspInfos getAllDsps() const override;
+    void addDsp(const DspBuilder& dsp) override;
+
     std::unique_ptr<AudioDecoder> createDecoder() override;
 
+    [[nodiscard]] BufferPoolStats bufferPoolStats() const override;
+    [[nodiscard]] BufferFillState bufferFill() const override;
+    [[nodiscard]] EngineStats engineStats() const override;
+    [[nodiscard]] OutputPath outputPath() const override;
+    [[nodiscard]] const AnalysisTap* analysisTap() const override;
+
 private:
     struct Private;
     std::unique_ptr<Private> p;
@@ -19,6 +19,50 @@
 
 #include "ffmpegcodec.h"
 
+#include "ffmpegutils.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Enough for the current and next track of each decoder, plus one spare
+constexpr size_t PooledContexts = 4;
+// Size of a FLAC STREAMINFO block, as stored by the demuxer as extradata
+constexpr int FlacStreamInfoSize = 34;
+
+namespace {
+bool sameExtradata(const AVCodecParameters* lhs, const AVCodecParameters* rhs)
+{
+    if(lhs->extradata_size != rhs->extradata_size) {
+        return false;
+    }
+    if(lhs->extradata_size == 0) {
+        return true;
+    }
+
+    // STREAMINFO ends with the track's length and MD5, which differ between every track of an album.
+    // The decoder only keeps the block sizes (along with the rate, channels and depth compared separately).
+    if(lhs->codec_id == AV_CODEC_ID_FLAC && lhs->extradata_size == FlacStreamInfoSize) {
+        return std::memcmp(lhs->extradata, rhs->extradata, 4) == 0;
+    }
+
+    return std::memcmp(lhs->extradata, rhs->extradata, static_cast<size_t>(lhs->extradata_size)) == 0;
+}
+
+bool sameParameters(const AVCodecParameters* lhs, const AVCodecParameters* rhs)
+{
+    return lhs->codec_type == rhs->codec_type && lhs->codec_id == rhs->codec_id && lhs->codec_tag == rhs->codec_tag
+        && lhs->format == rhs->format && lhs->sample_rate == rhs->sample_rate
+#if OLD_CHANNEL_LAYOUT
+        && lhs->channels == rhs->channels && lhs->channel_layout == rhs->channel_layout
+#else
+        && av_channel_layout_compare(&lhs->ch_layout, &rhs->ch_layout) == 0
+#endif
+        && lhs->bits_per_coded_sample == rhs->bits_per_coded_sample
+        && lhs->bits_per_raw_sample == rhs->bits_per_raw_sample && lhs->block_align == rhs->block_align
+        && lhs->frame_size == rhs->frame_size && lhs->profile == rhs->profile && sameExtradata(lhs, rhs);
+}
+} // namespace
+
 namespace Fooyin {
 Codec::Codec() = default;
 
@@ -58,4 +102,61 @@ int Codec::streamIndex() const
 {
     return m_stream ? m_stream->index : -1;
 }
+
+CodecContextPtr Codec::takeContext()
+{
+    m_stream = nullptr;
+    return std::move(m_context);
+}
+
+CodecContextPool& CodecContextPool::instance()
+{
+    static CodecContextPool pool;
+    return pool;
+}
+
+CodecContextPtr CodecContextPool::take(const AVCodecParameters* params)
+{
+    if(!params) {
+        return {};
+    }
+
+    CodecContextPtr context;
+    {
+        const std::scoped_lock lock{m_mutex};
+
+        auto entry = std::ranges::find_if(m_entries, [params](const Entry& candidate) {
+            return sameParameters(candidate.params.get(), params);
+        });
+        if(entry == m_entries.end()) {
+            return {};
+        }
+
+        context = std::move(entry->context);
+        m_entries.erase(entry);
+    }
+
+    // Also takes the decoder out of draining if it was left at the end of a track
+    avcodec_flush_buffers(context.get());
+    return context;
+}
+
+void CodecContextPool::give(CodecContextPtr context, const AVCodecParameters* params)
+{
+    if(!context || !params || !avcodec_is_open(context.get())) {
+        return;
+    }
+
+    CodecParametersPtr copy{avcodec_parameters_alloc()};
+    if(!copy || avcodec_parameters_copy(copy.get(), params) < 0) {
+        return;
+    }
+
+    const std::scoped_lock lock{m_mutex};
+
+    if(m_entries.size() >= PooledContexts) {
+        m_entries.erase(m_entries.begin());
+    }
+    m_entries.push_back({std::move(context), std::move(copy)});
+}
 } // namespace Fooyin
@@ -26,6 +26,8 @@ extern "C"
 }
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace Fooyin {
 struct CodecContextDeleter
@@ -57,8 +59,49 @@ public:
     [[nodiscard]] AVStream* stream() const;
     [[nodiscard]] int streamIndex() const;
 
+    /** Gives up ownership of the context, leaving this codec invalid. */
+    CodecContextPtr takeContext();
+
 private:
     CodecContextPtr m_context;
     AVStream* m_stream;
 };
+
+struct CodecParametersDeleter
+{
+    void operator()(AVCodecParameters* params) const
+    {
+        if(params) {
+            avcodec_parameters_free(&params);
+        }
+    }
+};
+using CodecParametersPtr = std::unique_ptr<AVCodecParameters, CodecParametersDeleter>;
+
+/*!
+ * Keeps the open codec contexts of recently closed decoders, so the next track of an album can carry on with
+ * one rather than opening the codec again. A context is only handed out for a stream with the same parameters
+ * it was opened with, and is flushed first.
+ * @note thread-safe; a context taken is owned by the caller alone.
+ */
+class CodecContextPool
+{
+public:
+    static CodecContextPool& instance();
+
+    /** Returns an open context for a stream with @p params, or null if none match. */
+    CodecContextPtr take(const AVCodecParameters* params);
+    /** Keeps @p context, opened for a stream with @p params, for reuse. */
+    void give(CodecContextPtr context, const AVCodecParameters* params);
+
+private:
+    struct Entry
+    {
+        CodecContextPtr context;
+        CodecParametersPtr params;
+    };
+
+    std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+};
 } // namespace Fooyin
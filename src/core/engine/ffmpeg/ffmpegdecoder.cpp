@@ -21,15 +21,28 @@
 
 #include "ffmpegcodec.h"
 #include "ffmpegframe.h"
+#include "ffmpegiocontext.h"
+#include "ffmpegnetworkstream.h"
 #include "ffmpegpacket.h"
 #include "ffmpegstream.h"
 #include "ffmpegutils.h"
 
+#include "archive/archivecache.h"
+#include "database/seekindexdatabase.h"
+#include "engine/seekindex.h"
+
 #include <core/engine/audiobuffer.h>
+#include <core/track.h>
+#include <utils/async.h>
+#include <utils/database/dbconnectionhandler.h>
 #include <utils/worker.h>
 
 #include <QDebug>
 
+#include <algorithm>
+#include <array>
+#include <string_view>
+
 #if defined(__GNUG__)
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 #elif defined(__clang__)
@@ -38,20 +51,33 @@
 
 using namespace std::chrono_literals;
 
+// Spacing between recorded seek points, which bounds how much is decoded and discarded after a seek
+constexpr auto SeekIndexInterval = 500;
+// Demuxers which read a complete description of the audio from the file's header, so the stream needn't be
+// probed by decoding packets before the codec is opened
+constexpr std::array<std::string_view, 8> HeaderDescribedFormats{"flac", "wav", "w64", "aiff",
+                                                                  "wv",   "ape", "tta", "dsf"};
+
 namespace {
-void interleaveSamples(uint8_t** in, Fooyin::AudioBuffer& buffer)
+template <typename T>
+void interleaveSamples(uint8_t** in, std::byte* out, int channels, int frames)
 {
-    const auto format  = buffer.format();
-    const int channels = format.channelCount();
-    const int samples  = buffer.frameCount();
-    const int bps      = format.bytesPerSample();
-    auto* out          = buffer.data();
+    auto* output = reinterpret_cast<T*>(out);
+
+    if(channels == 2) {
+        const auto* left  = reinterpret_cast<const T*>(in[0]);
+        const auto* right = reinterpret_cast<const T*>(in[1]);
+        for(int i{0}; i < frames; ++i) {
+            output[i * 2]     = left[i];
+            output[i * 2 + 1] = right[i];
+        }
+        return;
+    }
 
-    for(int i{0}; i < samples; ++i) {
-        for(int ch{0}; ch < channels; ++ch) {
-            const auto inOffset  = i * bps;
-            const auto outOffset = (i * channels + ch) * bps;
-            std::memmove(out + outOffset, in[ch] + inOffset, bps);
+    for(int ch{0}; ch < channels; ++ch) {
+        const auto* input = reinterpret_cast<const T*>(in[ch]);
+        for(int i{0}; i < frames; ++i) {
+            output[i * channels + ch] = input[i];
         }
     }
 }
@@ -62,8 +88,31 @@ void interleave(uint8_t** in, Fooyin::AudioBuffer& buffer)
         return;
     }
 
-    if(buffer.format().sampleFormat() != Fooyin::SampleFormat::Unknown) {
-        interleaveSamples(in, buffer);
+    const auto format  = buffer.format();
+    const int channels = format.channelCount();
+    const int frames   = buffer.frameCount();
+    auto* out          = buffer.data();
+
+    if(channels == 1) {
+        std::memcpy(out, in[0], buffer.byteCount());
+        return;
+    }
+
+    switch(format.bytesPerSample()) {
+        case(1):
+            interleaveSamples<uint8_t>(in, out, channels, frames);
+            break;
+        case(2):
+            interleaveSamples<uint16_t>(in, out, channels, frames);
+            break;
+        case(4):
+            interleaveSamples<uint32_t>(in, out, channels, frames);
+            break;
+        case(8):
+            interleaveSamples<uint64_t>(in, out, channels, frames);
+            break;
+        default:
+            break;
     }
 }
 
@@ -78,13 +127,55 @@ struct FormatContextDeleter
     }
 };
 using FormatContextPtr = std::unique_ptr<AVFormatContext, FormatContextDeleter>;
+
+bool headerDescribesStreams(const AVFormatContext* context)
+{
+    if(!context->iformat || (context->ctx_flags & AVFMTCTX_NOHEADER)
+       || std::ranges::find(HeaderDescribedFormats, std::string_view{context->iformat->name})
+              == HeaderDescribedFormats.cend()) {
+        return false;
+    }
+
+    bool hasAudio{false};
+
+    for(unsigned int i = 0; i < context->nb_streams; ++i) {
+        const AVCodecParameters* params = context->streams[i]->codecpar;
+        if(params->codec_type != AVMEDIA_TYPE_AUDIO) {
+            continue;
+        }
+#if OLD_CHANNEL_LAYOUT
+        const int channels = params->channels;
+#else
+        const int channels = params->ch_layout.nb_channels;
+#endif
+        if(params->codec_id == AV_CODEC_ID_NONE || params->sample_rate <= 0 || channels <= 0) {
+            return false;
+        }
+        hasAudio = true;
+    }
+
+    return hasAudio;
+}
+
+int indexEntryCount(AVStream* stream)
+{
+#if(LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100))
+    return avformat_index_get_entries_count(stream);
+#else
+    return stream->nb_index_entries;
+#endif
+}
 } // namespace
 
 namespace Fooyin {
 struct FFmpegDecoder::Private
 {
     FFmpegDecoder* self;
+    DbConnectionPoolPtr seekIndexPool;
 
+    // Declared before the format context so they are destroyed after it
+    std::unique_ptr<NetworkStream> network;
+    IOContext ioContext;
     FormatContextPtr context;
     Stream stream;
     Codec codec;
@@ -99,40 +190,179 @@ struct FFmpegDecoder::Private
     AudioBuffer buffer;
     int bufferPos{0};
     uint64_t currentPts{0};
+    // Decoded audio before this position is dropped after a seek
+    uint64_t seekTarget{0};
+
+    QString indexKey;
+    SeekIndex seekIndex;
+    int64_t indexInterval{0};
+    bool buildingIndex{false};
 
-    explicit Private(FFmpegDecoder* self_)
+    Private(FFmpegDecoder* self_, DbConnectionPoolPtr seekIndexPool_)
         : self{self_}
+        , seekIndexPool{std::move(seekIndexPool_)}
         , timeBase{0, 0}
     { }
 
+    ~Private()
+    {
+        releaseCodec();
+    }
+
+    // Hands the open codec to the pool, so the next track with the same parameters needn't open its own
+    void releaseCodec()
+    {
+        if(codec.isValid() && !network) {
+            const AVCodecParameters* params = codec.stream()->codecpar;
+            CodecContextPool::instance().give(codec.takeContext(), params);
+        }
+        codec = {};
+    }
+
     bool setup(const QString& source)
     {
+        // Before the format context, which owns the stream the codec was opened for
+        releaseCodec();
         context.reset();
+        ioContext.close();
+        network.reset();
         stream = {};
-        codec  = {};
         buffer = {};
 
         error = Error::NoError;
 
-        if(!createAVFormatContext(source)) {
+        // Tracks inside archives are played from an extracted copy, as decoding needs random access
+        const bool archived    = Track{source}.isInArchive();
+        const QString filepath = archived ? ArchiveCache::instance().file(source) : source;
+        if(filepath.isEmpty()) {
+            error = Error::ResourceError;
+            return false;
+        }
+
+        const bool streamed = NetworkStream::canStream(filepath);
+        if(!createAVFormatContext(filepath, streamed)) {
             return false;
         }
 
-        isSeekable = !(context->ctx_flags & AVFMTCTX_UNSEEKABLE);
+        isSeekable = !streamed && !(context->ctx_flags & AVFMTCTX_UNSEEKABLE);
 
         if(!findStream(context)) {
             return false;
         }
 
-        audioFormat = Utils::audioFormatFromCodec(stream.avStream()->codecpar);
+        if(!createCodec(stream.avStream())) {
+            return false;
+        }
+
+        // Taken from the codec, as headers alone don't give the sample format
+        audioFormat = Utils::audioFormatFromContext(codec.context());
 
-        return createCodec(stream.avStream());
+        loadSeekIndex(source, !archived && !streamed);
+        return true;
     }
 
-    bool createAVFormatContext(const QString& source)
+    void loadSeekIndex(const QString& source, bool indexable)
+    {
+        seekIndex.clear();
+        indexKey.clear();
+        buildingIndex = false;
+        seekTarget    = 0;
+        indexInterval = av_rescale_q(SeekIndexInterval, {1, 1000}, timeBase);
+
+        // Formats with a seek table or TOC are already indexed by the demuxer, and extracted copies of archived
+        // tracks are local files which get a new path each time
+        if(!indexable || !seekIndexPool || !isSeekable || !ioContext.isValid()
+           || indexEntryCount(stream.avStream()) > 0) {
+            return;
+        }
+
+        indexKey = SeekIndexDatabase::cacheKey(source);
+
+        const DbConnectionHandler dbHandler{seekIndexPool};
+        SeekIndexDatabase indexDb;
+        indexDb.initialise(DbConnectionProvider{seekIndexPool});
+
+        if(!indexDb.loadIndex(indexKey, seekIndex)) {
+            buildingIndex = true;
+            return;
+        }
+
+        // Lets the demuxer's own seeking jump straight to a known packet rather than scanning or bisecting
+        for(const auto& point : seekIndex.points()) {
+            av_add_index_entry(stream.avStream(), point.pos, point.timestamp, 0, 0, AVINDEX_KEYFRAME);
+        }
+    }
+
+    void recordSeekPoint(const AVPacket* packet)
+    {
+        if(packet->pos >= 0 && packet->pts != AV_NOPTS_VALUE && (packet->flags & AV_PKT_FLAG_KEY)) {
+            seekIndex.add(packet->pts, packet->pos, indexInterval);
+        }
+    }
+
+    void storeSeekIndex()
+    {
+        if(!buildingIndex) {
+            return;
+        }
+
+        buildingIndex = false;
+
+        if(seekIndex.empty()) {
+            return;
+        }
+
+        Utils::asyncExec([pool = seekIndexPool, key = indexKey, index = seekIndex]() {
+            const DbConnectionHandler dbHandler{pool};
+            SeekIndexDatabase indexDb;
+            indexDb.initialise(DbConnectionProvider{pool});
+
+            if(!indexDb.storeIndex(key, index)) {
+                qDebug() << "Unable to store seek index";
+            }
+        });
+    }
+
+    bool openNetworkStream(const QString& url)
+    {
+        network = std::make_unique<NetworkStream>();
+        if(network->open(url) && ioContext.open(network.get())) {
+            return true;
+        }
+
+        Utils::printError(QStringLiteral("Unable to open stream: ") + url);
+        network.reset();
+        error = Error::ResourceError;
+        return false;
+    }
+
+    // Returns false if the network buffer is refilling, so demuxing another packet would wait on the connection
+    bool canRead()
+    {
+        return !network || network->canRead();
+    }
+
+    bool createAVFormatContext(const QString& source, bool streamed)
     {
         AVFormatContext* avContext{nullptr};
 
+        if(streamed && !openNetworkStream(source)) {
+            return false;
+        }
+
+        // Local files are read through our own I/O layer and internet streams through their network buffer,
+        // anything else falls back to FFmpeg's protocols
+        if(streamed || ioContext.open(source)) {
+            avContext = avformat_alloc_context();
+            if(!avContext) {
+                ioContext.close();
+                error = Error::ResourceError;
+                return false;
+            }
+            avContext->pb = ioContext.avioContext();
+            avContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        }
+
         const int ret = avformat_open_input(&avContext, source.toUtf8().constData(), nullptr, nullptr);
         if(ret < 0) {
             if(ret == AVERROR(EACCES)) {
@@ -146,7 +376,7 @@ struct FFmpegDecoder::Private
             return false;
         }
 
-        if(avformat_find_stream_info(avContext, nullptr) < 0) {
+        if(!headerDescribesStreams(avContext) && avformat_find_stream_info(avContext, nullptr) < 0) {
             Utils::printError(QStringLiteral("Could not find stream info"));
             avformat_close_input(&avContext);
             error = Error::ResourceError;
@@ -184,6 +414,12 @@ struct FFmpegDecoder::Private
             return false;
         }
 
+        if(auto pooledContext = CodecContextPool::instance().take(avStream->codecpar)) {
+            pooledContext->pkt_timebase = timeBase;
+            codec                       = {std::move(pooledContext), avStream};
+            return true;
+        }
+
         const AVCodec* avCodec = avcodec_find_decoder(avStream->codecpar->codec_id);
         if(!avCodec) {
             Utils::printError(QStringLiteral("Could not find a decoder for stream"));
@@ -282,18 +518,37 @@ struct FFmpegDecoder::Private
 
         const Frame frame{std::move(avFrame), timeBase};
 
+        if(frame.avFrame()->pts < 0) {
+            // Without a timestamp there's no way to tell where the seek landed
+            seekTarget = 0;
+        }
+        else if(seekTarget > 0
+                && frame.ptsMs() + audioFormat.durationForFrames(frame.sampleCount()) <= seekTarget) {
+            readNext();
+            return;
+        }
+
         currentPts = frame.ptsMs();
 
-        const auto sampleCount = audioFormat.bytesPerFrame() * frame.sampleCount();
+        const auto byteCount = static_cast<size_t>(audioFormat.bytesPerFrame() * frame.sampleCount());
 
         if(av_sample_fmt_is_planar(frame.format())) {
             buffer = {audioFormat, frame.ptsMs()};
-            buffer.resize(static_cast<size_t>(sampleCount));
-            interleave(frame.avFrame()->data, buffer);
+            buffer.resize(byteCount);
+            interleave(frame.avFrame()->extended_data, buffer);
         }
         else {
-            buffer = {frame.avFrame()->data[0], static_cast<size_t>(sampleCount), audioFormat, frame.ptsMs()};
+            // Packed samples are already interleaved, so reference the frame instead of copying it
+            const std::span data{reinterpret_cast<const std::byte*>(frame.avFrame()->data[0]), byteCount};
+            buffer = {data, std::make_shared<const Frame>(frame), audioFormat, frame.ptsMs()};
+        }
+
+        if(seekTarget > frame.ptsMs()) {
+            const int offset = audioFormat.bytesForDuration(seekTarget - frame.ptsMs());
+            buffer           = buffer.slice(offset, buffer.byteCount() - offset);
+            currentPts       = seekTarget;
         }
+        seekTarget = 0;
     }
 
     void readNext()
@@ -309,6 +564,7 @@ struct FFmpegDecoder::Private
                 Utils::printError(readResult);
             }
             else if(!draining) {
+                storeSeekIndex();
                 draining = true;
                 decodeAudio(packet);
                 return;
@@ -321,29 +577,46 @@ struct FFmpegDecoder::Private
             return;
         }
 
+        if(buildingIndex) {
+            recordSeekPoint(packet.avPacket());
+        }
+
         decodeAudio(packet);
     }
 
-    void seek(uint64_t pos) const
+    void seek(uint64_t pos)
     {
         if(!context || !isSeekable || hasError()) {
             return;
         }
 
-        const int64_t timestamp = av_rescale_q(static_cast<int64_t>(pos), {1, 1000}, stream.avStream()->time_base);
+        int64_t timestamp = av_rescale_q(static_cast<int64_t>(pos), {1, 1000}, stream.avStream()->time_base);
+        int flags         = pos < currentPts ? AVSEEK_FLAG_BACKWARD : 0;
+
+        if(buildingIndex) {
+            // Jumping past the indexed range would leave a gap
+            if(timestamp > seekIndex.lastTimestamp() + indexInterval) {
+                buildingIndex = false;
+                seekIndex.clear();
+            }
+        }
+        else if(const auto* point = seekIndex.find(timestamp)) {
+            timestamp = point->timestamp;
+            flags     = AVSEEK_FLAG_BACKWARD;
+        }
 
-        const int flags = pos < currentPts ? AVSEEK_FLAG_BACKWARD : 0;
         if(av_seek_frame(context.get(), stream.index(), timestamp, flags) < 0) {
             qWarning() << "Could not seek to position: " << pos;
             return;
         }
 
         avcodec_flush_buffers(codec.context());
+        seekTarget = pos;
     }
 };
 
-FFmpegDecoder::FFmpegDecoder()
-    : p{std::make_unique<Private>(this)}
+FFmpegDecoder::FFmpegDecoder(DbConnectionPoolPtr seekIndexPool)
+    : p{std::make_unique<Private>(this, std::move(seekIndexPool))}
 { }
 
 FFmpegDecoder::~FFmpegDecoder() = default;
@@ -389,7 +662,7 @@ AudioBuffer FFmpegDecoder::readBuffer()
         return {};
     }
 
-    if(!p->buffer.isValid()) {
+    if(!p->buffer.isValid() && p->canRead()) {
         p->readNext();
     }
 
@@ -402,7 +675,7 @@ AudioBuffer FFmpegDecoder::readBuffer(size_t bytes)
         return {};
     }
 
-    if(!p->buffer.isValid()) {
+    if(!p->buffer.isValid() && p->canRead()) {
         p->readNext();
     }
 
@@ -412,28 +685,49 @@ AudioBuffer FFmpegDecoder::readBuffer(size_t bytes)
     int bytesWritten{0};
 
     while(p->buffer.isValid() && bytesWritten < bytesRequested) {
-        if(!buffer.isValid()) {
-            buffer = {p->buffer.format(), p->buffer.startTime()};
-        }
         const int remaining = bytesRequested - bytesWritten;
         const int count     = p->buffer.byteCount() - p->bufferPos;
+        const int size      = std::min(count, remaining);
+
+        if(!buffer.isValid()) {
+            // Shares the decoded frame if it covers the whole request
+            buffer = p->buffer.slice(p->bufferPos, size);
+        }
+        else {
+            if(buffer.isExternal()) {
+                buffer.reserve(bytes);
+            }
+            buffer.append(p->buffer.constData().subspan(p->bufferPos, size));
+        }
+
+        bytesWritten += size;
+
         if(count <= remaining) {
-            buffer.append(p->buffer.data() + p->bufferPos, count);
-            bytesWritten += count;
             p->buffer    = {};
             p->bufferPos = 0;
+            if(!p->canRead()) {
+                break;
+            }
             p->readNext();
         }
         else {
-            buffer.append(p->buffer.data() + p->bufferPos, remaining);
-            bytesWritten += remaining;
-            p->bufferPos += remaining;
+            p->bufferPos += size;
         }
     }
 
     return buffer;
 }
 
+bool FFmpegDecoder::isStalled() const
+{
+    return p->network && p->network->isBuffering();
+}
+
+QString FFmpegDecoder::streamTitle() const
+{
+    return p->network ? p->network->title() : QString{};
+}
+
 AudioDecoder::Error FFmpegDecoder::error() const
 {
     return p->error;
@@ -19,16 +19,23 @@
 
 #pragma once
 
+#include "fycore_export.h"
+
 #include <core/engine/audiodecoder.h>
+#include <utils/database/dbconnectionpool.h>
 
 namespace Fooyin {
 class AudioFormat;
 class AudioBuffer;
 
-class FFmpegDecoder : public AudioDecoder
+class FYCORE_EXPORT FFmpegDecoder : public AudioDecoder
 {
 public:
-    FFmpegDecoder();
+    /*!
+     * @p seekIndexPool is used to cache seek indexes for files the demuxer can't seek in efficiently.
+     * If null, indexes are only built for the current session by FFmpeg itself.
+     */
+    explicit FFmpegDecoder(DbConnectionPoolPtr seekIndexPool = {});
     ~FFmpegDecoder() override;
 
     bool init(const QString& source) override;
@@ -43,6 +50,14 @@ public:
     AudioBuffer readBuffer() override;
     AudioBuffer readBuffer(size_t bytes) override;
 
+    /*!
+     * Returns @c true if an internet stream is refilling its network buffer.
+     * Reads return little or nothing meanwhile, which doesn't mean the stream has ended.
+     */
+    [[nodiscard]] bool isStalled() const;
+    /** Returns the title currently announced by an internet stream, if any. */
+    [[nodiscard]] QString streamTitle() const;
+
     [[nodiscard]] Error error() const override;
 
 private:
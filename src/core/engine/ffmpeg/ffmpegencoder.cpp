@@ -0,0 +1,507 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ffmpegencoder.h"
+
+#include "ffmpegframe.h"
+#include "ffmpegpacket.h"
+#include "ffmpegutils.h"
+
+#include <core/engine/audiobuffer.h>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+#include <QDebug>
+
+#include <array>
+
+#define OLD_CODEC_CONFIG (LIBAVCODEC_VERSION_INT < AV_VERSION_INT(61, 13, 100))
+
+// Frames encoded at a time by encoders which take any number
+constexpr int DefaultFrameSize = 4096;
+
+namespace {
+using Codec = Fooyin::ConversionOptions::Codec;
+
+struct EncoderInfo
+{
+    // Encoders to try, best first
+    std::array<const char*, 2> encoders;
+    const char* muxer;
+    const char* extension;
+    bool lossless;
+};
+
+EncoderInfo encoderInfo(Codec codec)
+{
+    switch(codec) {
+        case(Codec::Vorbis):
+            return {{"libvorbis", "vorbis"}, "ogg", "ogg", false};
+        case(Codec::Mp3):
+            return {{"libmp3lame", nullptr}, "mp3", "mp3", false};
+        case(Codec::Aac):
+            return {{"libfdk_aac", "aac"}, "ipod", "m4a", false};
+        case(Codec::Flac):
+            return {{"flac", nullptr}, "flac", "flac", true};
+        case(Codec::Opus):
+        default:
+            return {{"libopus", "opus"}, "opus", "opus", false};
+    }
+}
+
+const AVCodec* findEncoder(const EncoderInfo& info)
+{
+    for(const char* name : info.encoders) {
+        if(name) {
+            if(const AVCodec* codec = avcodec_find_encoder_by_name(name)) {
+                return codec;
+            }
+        }
+    }
+    return nullptr;
+}
+
+const AVSampleFormat* supportedFormats(const AVCodec* codec)
+{
+#if OLD_CODEC_CONFIG
+    return codec->sample_fmts;
+#else
+    const void* formats{nullptr};
+    if(avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_FORMAT, 0, &formats, nullptr) < 0) {
+        return nullptr;
+    }
+    return static_cast<const AVSampleFormat*>(formats);
+#endif
+}
+
+const int* supportedRates(const AVCodec* codec)
+{
+#if OLD_CODEC_CONFIG
+    return codec->supported_samplerates;
+#else
+    const void* rates{nullptr};
+    if(avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_RATE, 0, &rates, nullptr) < 0) {
+        return nullptr;
+    }
+    return static_cast<const int*>(rates);
+#endif
+}
+
+// Prefers the input's own format, then its planar form, then float, then whatever the encoder takes first
+AVSampleFormat chooseSampleFormat(const AVCodec* codec, AVSampleFormat input)
+{
+    const AVSampleFormat* formats = supportedFormats(codec);
+    if(!formats) {
+        return input;
+    }
+
+    const std::array preferred{input, av_get_planar_sample_fmt(input), AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_FLTP};
+    for(const AVSampleFormat format : preferred) {
+        for(const AVSampleFormat* supported = formats; *supported != AV_SAMPLE_FMT_NONE; ++supported) {
+            if(*supported == format) {
+                return format;
+            }
+        }
+    }
+
+    return formats[0];
+}
+
+// Returns @p rate if supported, otherwise the lowest supported rate above it, or failing that the highest below it
+int chooseSampleRate(const AVCodec* codec, int rate)
+{
+    const int* rates = supportedRates(codec);
+    if(!rates) {
+        return rate;
+    }
+
+    int best{0};
+    for(const int* supported = rates; *supported != 0; ++supported) {
+        const int candidate = *supported;
+        if(candidate == rate) {
+            return rate;
+        }
+        if(candidate > rate ? (best < rate || candidate < best) : (best < rate && candidate > best)) {
+            best = candidate;
+        }
+    }
+
+    return best > 0 ? best : rate;
+}
+} // namespace
+
+namespace Fooyin {
+struct FFmpegEncoder::Private
+{
+    AVFormatContext* format{nullptr};
+    AVCodecContext* codec{nullptr};
+    AVStream* stream{nullptr};
+    SwrContext* converter{nullptr};
+    AVAudioFifo* fifo{nullptr};
+
+    AudioFormat input;
+    int channels{0};
+    int frameSize{0};
+    int64_t nextPts{0};
+
+    // Converted samples on their way into the fifo
+    uint8_t** converted{nullptr};
+    int convertedFrames{0};
+
+    bool createConverter(AVSampleFormat inputFormat)
+    {
+#if OLD_CHANNEL_LAYOUT
+        const auto layout = av_get_default_channel_layout(channels);
+        converter = swr_alloc_set_opts(nullptr, layout, codec->sample_fmt, codec->sample_rate, layout, inputFormat,
+                                       codec->sample_rate, 0, nullptr);
+        if(!converter) {
+            return false;
+        }
+#else
+        const int ret = swr_alloc_set_opts2(&converter, &codec->ch_layout, codec->sample_fmt, codec->sample_rate,
+                                            &codec->ch_layout, inputFormat, codec->sample_rate, 0, nullptr);
+        if(ret < 0) {
+            Utils::printError(ret);
+            return false;
+        }
+#endif
+        if(const int ret = swr_init(converter); ret < 0) {
+            Utils::printError(ret);
+            return false;
+        }
+        return true;
+    }
+
+    bool reserveConverted(int frames)
+    {
+        if(frames <= convertedFrames) {
+            return true;
+        }
+
+        freeConverted();
+
+        if(const int ret
+           = av_samples_alloc_array_and_samples(&converted, nullptr, channels, frames, codec->sample_fmt, 0);
+           ret < 0) {
+            Utils::printError(ret);
+            return false;
+        }
+        convertedFrames = frames;
+        return true;
+    }
+
+    void freeConverted()
+    {
+        if(converted) {
+            av_freep(&converted[0]);
+            av_freep(static_cast<void*>(&converted));
+        }
+        convertedFrames = 0;
+    }
+
+    // Converts @p frames of interleaved input into the fifo, or whatever the converter holds back if null
+    bool convert(const uint8_t* data, int frames)
+    {
+        const int maxFrames = swr_get_out_samples(converter, frames);
+        if(maxFrames <= 0) {
+            return true;
+        }
+        if(!reserveConverted(maxFrames)) {
+            return false;
+        }
+
+        const int count = swr_convert(converter, converted, maxFrames, data ? &data : nullptr, frames);
+        if(count < 0) {
+            Utils::printError(count);
+            return false;
+        }
+
+        return av_audio_fifo_write(fifo, reinterpret_cast<void**>(converted), count) == count;
+    }
+
+    // Encodes every whole frame in the fifo, and with @p final the partial one left at the end
+    bool encodeFrames(bool final)
+    {
+        while(av_audio_fifo_size(fifo) >= frameSize || (final && av_audio_fifo_size(fifo) > 0)) {
+            if(!encodeFrame(std::min(av_audio_fifo_size(fifo), frameSize))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool encodeFrame(int count)
+    {
+        const FramePtr frame{av_frame_alloc()};
+        if(!frame) {
+            return false;
+        }
+
+        // Only the last frame can be short, and only for encoders which accept that
+        const int shortFrames = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_VARIABLE_FRAME_SIZE;
+        const bool pad        = count < frameSize && !(codec->codec->capabilities & shortFrames);
+
+        frame->nb_samples  = pad ? frameSize : count;
+        frame->format      = codec->sample_fmt;
+        frame->sample_rate = codec->sample_rate;
+#if OLD_CHANNEL_LAYOUT
+        frame->channel_layout = codec->channel_layout;
+        frame->channels       = codec->channels;
+#else
+        av_channel_layout_copy(&frame->ch_layout, &codec->ch_layout);
+#endif
+
+        if(const int ret = av_frame_get_buffer(frame.get(), 0); ret < 0) {
+            Utils::printError(ret);
+            return false;
+        }
+
+        if(av_audio_fifo_read(fifo, reinterpret_cast<void**>(frame->extended_data), count) != count) {
+            return false;
+        }
+        if(pad) {
+            av_samples_set_silence(frame->extended_data, count, frameSize - count, channels, codec->sample_fmt);
+        }
+
+        frame->pts = nextPts;
+        nextPts += frame->nb_samples;
+
+        return send(frame.get());
+    }
+
+    // Sends @p frame to the encoder, or flushes it if null, and writes out the packets it returns
+    bool send(const AVFrame* frame)
+    {
+        if(const int ret = avcodec_send_frame(codec, frame); ret < 0) {
+            Utils::printError(ret);
+            return false;
+        }
+
+        const PacketPtr packet{av_packet_alloc()};
+        if(!packet) {
+            return false;
+        }
+
+        while(true) {
+            const int ret = avcodec_receive_packet(codec, packet.get());
+            if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return true;
+            }
+            if(ret < 0) {
+                Utils::printError(ret);
+                return false;
+            }
+
+            av_packet_rescale_ts(packet.get(), codec->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+
+            // Takes the packet's data, leaving it ready for the next one
+            if(const int writeRet = av_interleaved_write_frame(format, packet.get()); writeRet < 0) {
+                Utils::printError(writeRet);
+                return false;
+            }
+        }
+    }
+};
+
+FFmpegEncoder::FFmpegEncoder()
+    : p{std::make_unique<Private>()}
+{ }
+
+FFmpegEncoder::~FFmpegEncoder()
+{
+    close();
+}
+
+QString FFmpegEncoder::extension(ConversionOptions::Codec codec)
+{
+    return QString::fromLatin1(encoderInfo(codec).extension);
+}
+
+bool FFmpegEncoder::open(const QString& filepath, const AudioFormat& input, const ConversionOptions& options)
+{
+    close();
+
+    const auto fail = [this](int error) {
+        if(error < 0) {
+            Utils::printError(error);
+        }
+        close();
+        return false;
+    };
+
+    const EncoderInfo info = encoderInfo(options.codec);
+    const AVCodec* encoder = findEncoder(info);
+    if(!encoder) {
+        Utils::printError(QStringLiteral("No encoder available for .") + extension(options.codec));
+        return false;
+    }
+
+    const AVSampleFormat inputFormat = Utils::avSampleFormat(input.sampleFormat());
+    if(inputFormat == AV_SAMPLE_FMT_NONE || input.channelCount() <= 0) {
+        return false;
+    }
+
+    if(const int ret = avformat_alloc_output_context2(&p->format, nullptr, info.muxer, nullptr); ret < 0) {
+        return fail(ret);
+    }
+
+    p->codec = avcodec_alloc_context3(encoder);
+    if(!p->codec) {
+        return fail(0);
+    }
+
+    p->channels           = input.channelCount();
+    p->codec->sample_fmt  = chooseSampleFormat(encoder, inputFormat);
+    p->codec->sample_rate = chooseSampleRate(encoder, options.sampleRate > 0 ? options.sampleRate : input.sampleRate());
+    p->codec->time_base   = {1, p->codec->sample_rate};
+#if OLD_CHANNEL_LAYOUT
+    p->codec->channels       = p->channels;
+    p->codec->channel_layout = av_get_default_channel_layout(p->channels);
+#else
+    av_channel_layout_default(&p->codec->ch_layout, p->channels);
+#endif
+
+    if(info.lossless) {
+        // Keeps 24 bit sources at 24 bits rather than padding them out to 32
+        if(input.sampleFormat() == SampleFormat::S24) {
+            p->codec->bits_per_raw_sample = 24;
+        }
+    }
+    else {
+        p->codec->bit_rate = static_cast<int64_t>(options.bitrate) * 1000;
+    }
+
+    if(encoder->capabilities & AV_CODEC_CAP_EXPERIMENTAL) {
+        p->codec->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+    }
+    if(p->format->oformat->flags & AVFMT_GLOBALHEADER) {
+        p->codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    if(const int ret = avcodec_open2(p->codec, encoder, nullptr); ret < 0) {
+        return fail(ret);
+    }
+
+    p->stream = avformat_new_stream(p->format, nullptr);
+    if(!p->stream) {
+        return fail(0);
+    }
+    if(const int ret = avcodec_parameters_from_context(p->stream->codecpar, p->codec); ret < 0) {
+        return fail(ret);
+    }
+    p->stream->time_base = p->codec->time_base;
+
+    const bool anySize = (encoder->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) || p->codec->frame_size <= 0;
+    p->frameSize       = anySize ? DefaultFrameSize : p->codec->frame_size;
+
+    if(!p->createConverter(inputFormat)) {
+        return fail(0);
+    }
+
+    p->fifo = av_audio_fifo_alloc(p->codec->sample_fmt, p->channels, 2 * p->frameSize);
+    if(!p->fifo) {
+        return fail(0);
+    }
+
+    if(const int ret = avio_open(&p->format->pb, filepath.toUtf8().constData(), AVIO_FLAG_WRITE); ret < 0) {
+        return fail(ret);
+    }
+    if(const int ret = avformat_write_header(p->format, nullptr); ret < 0) {
+        return fail(ret);
+    }
+
+    p->input = input;
+    p->input.setSampleRate(p->codec->sample_rate);
+
+    return true;
+}
+
+AudioFormat FFmpegEncoder::inputFormat() const
+{
+    return p->input;
+}
+
+bool FFmpegEncoder::write(const AudioBuffer& buffer)
+{
+    if(!p->codec) {
+        return false;
+    }
+    if(!buffer.isValid()) {
+        return true;
+    }
+
+    const auto* data = reinterpret_cast<const uint8_t*>(buffer.constData().data());
+    return p->convert(data, buffer.frameCount()) && p->encodeFrames(false);
+}
+
+bool FFmpegEncoder::finish()
+{
+    if(!p->codec) {
+        return false;
+    }
+
+    bool finished = p->convert(nullptr, 0) && p->encodeFrames(true) && p->send(nullptr);
+    if(finished) {
+        if(const int ret = av_write_trailer(p->format); ret < 0) {
+            Utils::printError(ret);
+            finished = false;
+        }
+    }
+
+    close();
+    return finished;
+}
+
+void FFmpegEncoder::close()
+{
+    if(p->format) {
+        if(p->format->pb) {
+            avio_closep(&p->format->pb);
+        }
+        avformat_free_context(p->format);
+        p->format = nullptr;
+    }
+    if(p->codec) {
+        avcodec_free_context(&p->codec);
+    }
+    if(p->converter) {
+        swr_free(&p->converter);
+    }
+    if(p->fifo) {
+        av_audio_fifo_free(p->fifo);
+        p->fifo = nullptr;
+    }
+    p->freeConverted();
+
+    p->stream    = nullptr;
+    p->input     = {};
+    p->channels  = 0;
+    p->frameSize = 0;
+    p->nextPts   = 0;
+}
+} // namespace Fooyin
@@ -0,0 +1,65 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audioformat.h>
+#include <core/library/conversionoptions.h>
+
+#include <memory>
+
+namespace Fooyin {
+class AudioBuffer;
+
+/*!
+ * Encodes audio into a new file with FFmpeg, muxed into the usual container of the codec.
+ * Input is converted to the sample format the encoder takes, but never resampled: open() picks the sample rate,
+ * and inputFormat() reports it so the caller can resample to it first.
+ */
+class FFmpegEncoder
+{
+public:
+    FFmpegEncoder();
+    ~FFmpegEncoder();
+
+    FFmpegEncoder(const FFmpegEncoder& other)            = delete;
+    FFmpegEncoder& operator=(const FFmpegEncoder& other) = delete;
+
+    /** Returns the file extension of files encoded with @p codec, without the dot. */
+    static QString extension(ConversionOptions::Codec codec);
+
+    /*!
+     * Creates @p filepath to encode audio of @p input into.
+     * The sample rate is @c options.sampleRate, or that of @p input if 0, moved to the nearest the codec supports.
+     */
+    bool open(const QString& filepath, const AudioFormat& input, const ConversionOptions& options);
+    /** Returns the format write() takes, i.e. the one passed to open() at the sample rate picked. */
+    [[nodiscard]] AudioFormat inputFormat() const;
+
+    bool write(const AudioBuffer& buffer);
+    /** Encodes whatever is still held back and completes the file. */
+    bool finish();
+    /** Closes the file without completing it, e.g. when cancelled. */
+    void close();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,170 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ffmpegiocontext.h"
+
+#include "ffmpegnetworkstream.h"
+#include "filereader.h"
+
+extern "C"
+{
+#include <libavformat/avio.h>
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+}
+
+#include <cstdio>
+
+// Size of FFmpeg's own buffer in front of the reader
+constexpr int IOBufferSize = 64 * 1024;
+
+namespace {
+int readPacket(void* opaque, uint8_t* buf, int bufSize)
+{
+    auto* reader       = static_cast<Fooyin::FileReader*>(opaque);
+    const int64_t read = reader->read(reinterpret_cast<std::byte*>(buf), bufSize);
+
+    if(read < 0) {
+        return AVERROR(EIO);
+    }
+    if(read == 0) {
+        return AVERROR_EOF;
+    }
+    return static_cast<int>(read);
+}
+
+int readStreamPacket(void* opaque, uint8_t* buf, int bufSize)
+{
+    auto* stream       = static_cast<Fooyin::NetworkStream*>(opaque);
+    const int64_t read = stream->read(reinterpret_cast<std::byte*>(buf), bufSize);
+
+    if(read < 0) {
+        return AVERROR(EIO);
+    }
+    if(read == 0) {
+        return AVERROR_EOF;
+    }
+    return static_cast<int>(read);
+}
+
+int64_t seekPacket(void* opaque, int64_t offset, int whence)
+{
+    auto* reader = static_cast<Fooyin::FileReader*>(opaque);
+
+    switch(whence & ~AVSEEK_FORCE) {
+        case(AVSEEK_SIZE):
+            return reader->size();
+        case(SEEK_SET):
+            break;
+        case(SEEK_CUR):
+            offset += reader->pos();
+            break;
+        case(SEEK_END):
+            offset += reader->size();
+            break;
+        default:
+            return AVERROR(EINVAL);
+    }
+
+    if(!reader->seek(offset)) {
+        return AVERROR(EINVAL);
+    }
+    return offset;
+}
+} // namespace
+
+namespace Fooyin {
+struct IOContext::Private
+{
+    FileReader reader;
+    AVIOContext* context{nullptr};
+};
+
+IOContext::IOContext()
+    : p{std::make_unique<Private>()}
+{ }
+
+IOContext::~IOContext()
+{
+    close();
+}
+
+bool IOContext::open(const QString& filepath)
+{
+    close();
+
+    if(!p->reader.open(filepath)) {
+        return false;
+    }
+
+    auto* buffer = static_cast<unsigned char*>(av_malloc(IOBufferSize));
+    if(!buffer) {
+        p->reader.close();
+        return false;
+    }
+
+    p->context = avio_alloc_context(buffer, IOBufferSize, 0, &p->reader, readPacket, nullptr, seekPacket);
+    if(!p->context) {
+        av_free(buffer);
+        p->reader.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool IOContext::open(NetworkStream* stream)
+{
+    close();
+
+    auto* buffer = static_cast<unsigned char*>(av_malloc(IOBufferSize));
+    if(!buffer) {
+        return false;
+    }
+
+    p->context = avio_alloc_context(buffer, IOBufferSize, 0, stream, readStreamPacket, nullptr, nullptr);
+    if(!p->context) {
+        av_free(buffer);
+        return false;
+    }
+
+    p->context->seekable = 0;
+    return true;
+}
+
+void IOContext::close()
+{
+    if(p->context) {
+        // The buffer may have been reallocated by FFmpeg, so free the one the context currently owns
+        av_freep(&p->context->buffer);
+        avio_context_free(&p->context);
+    }
+    p->reader.close();
+}
+
+bool IOContext::isValid() const
+{
+    return !!p->context;
+}
+
+AVIOContext* IOContext::avioContext() const
+{
+    return p->context;
+}
+} // namespace Fooyin
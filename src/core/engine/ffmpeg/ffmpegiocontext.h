@@ -0,0 +1,57 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <memory>
+
+struct AVIOContext;
+
+namespace Fooyin {
+class NetworkStream;
+
+/*!
+ * An AVIOContext which reads through a FileReader rather than FFmpeg's file protocol,
+ * or from the buffer of a NetworkStream.
+ * Must outlive any AVFormatContext it is attached to.
+ */
+class IOContext
+{
+public:
+    IOContext();
+    ~IOContext();
+
+    IOContext(const IOContext& other)            = delete;
+    IOContext& operator=(const IOContext& other) = delete;
+
+    bool open(const QString& filepath);
+    /** Reads from @p stream, which must outlive this context. Streams can't be seeked. */
+    bool open(NetworkStream* stream);
+    void close();
+
+    [[nodiscard]] bool isValid() const;
+    [[nodiscard]] AVIOContext* avioContext() const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,461 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ffmpegnetworkstream.h"
+
+#include "ffmpegutils.h"
+#include "version.h"
+
+#include <utils/spscringbuffer.h>
+
+#include <QDebug>
+#include <QStringDecoder>
+#include <QUrl>
+
+extern "C"
+{
+#include <libavformat/avio.h>
+#include <libavutil/dict.h>
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+#include <libavutil/opt.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// Around four minutes of a 128 kbps stream, so a paused stream can be picked up again where it was left
+constexpr size_t BufferSize = 4 * 1024 * 1024;
+// Most read from the connection at a time
+constexpr int ChunkSize = 16 * 1024;
+// Enough for several packets of any codec used for radio, so demuxing one never waits on the network
+constexpr size_t MinReadBytes = 16 * 1024;
+// Assumed rate of a stream until its throughput has been measured, i.e. 128 kbps
+constexpr double DefaultByteRate = 16000.0;
+// Bounds of the preroll, in seconds of the stream's throughput
+constexpr double MinPreroll = 1.0;
+constexpr double MaxPreroll = 10.0;
+// The preroll covers this many times the longest recent wait for data
+constexpr double JitterHeadroom = 4.0;
+// Per read decay of the longest wait, so the preroll shrinks again once a connection settles
+constexpr double JitterDecay = 0.98;
+// Throughput is measured over windows of at least this many seconds, blended in with this weight
+constexpr double ThroughputWindow = 1.0;
+constexpr double ThroughputWeight = 0.25;
+// How long a single network operation may take before the connection counts as dropped, in microseconds
+constexpr int64_t NetworkTimeout = 10'000'000;
+// How long opening waits for the first preroll, and reading waits when nothing at all is buffered
+constexpr auto OpenTimeout = 10s;
+constexpr auto ReadTimeout = 10s;
+// Delay before reconnecting, doubled after each failed attempt
+constexpr auto MinReconnectDelay = 500ms;
+constexpr auto MaxReconnectDelay = 8s;
+// Failed reconnections in a row before giving up on the stream
+constexpr int MaxReconnects = 8;
+
+namespace Fooyin {
+struct NetworkStream::Private
+{
+    QString url;
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+
+    // Guards the members below, which are shared with the reader
+    mutable std::mutex mutex;
+    std::condition_variable dataCond;
+    std::condition_variable spaceCond;
+    SpscRingBuffer<std::byte> buffer;
+    bool buffering{true};
+    bool finished{false};
+    QString title;
+    QString name;
+
+    // Only used by the network thread
+    std::vector<uint8_t> chunk;
+    int64_t received{0};
+    // Total size of a download, or <= 0 for a live stream or unknown length
+    int64_t streamSize{0};
+    // The server sent ICY headers, so the stream runs until closed and the end of a response is a dropped connection
+    bool live{false};
+    QByteArray lastMetadata;
+    // Bytes per second, and the longest recent wait for data in seconds
+    double throughput{0.0};
+    double jitter{0.0};
+    int64_t windowBytes{0};
+    double windowTime{0.0};
+
+    static int interrupted(void* opaque)
+    {
+        return static_cast<Private*>(opaque)->stopping.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+
+    void reset()
+    {
+        buffer.resize(BufferSize);
+        buffer.clear();
+        chunk.resize(ChunkSize);
+
+        stopping  = false;
+        buffering = true;
+        finished  = false;
+        title.clear();
+        name.clear();
+
+        received   = 0;
+        streamSize = 0;
+        live       = false;
+        lastMetadata.clear();
+        throughput  = 0.0;
+        jitter      = 0.0;
+        windowBytes = 0;
+        windowTime  = 0.0;
+    }
+
+    void run()
+    {
+        auto delay = MinReconnectDelay;
+        int failures{0};
+
+        while(!stopping) {
+            // Downloads carry on from where the connection dropped, live streams just join again
+            const bool resume = streamSize > 0 && received > 0;
+            if(AVIOContext* io = connect(resume)) {
+                if(!resume) {
+                    streamSize = avio_size(io);
+                }
+
+                const int64_t before = received;
+                const bool complete  = receive(io);
+                avio_closep(&io);
+
+                if(complete) {
+                    break;
+                }
+                if(received > before) {
+                    failures = 0;
+                    delay    = MinReconnectDelay;
+                }
+            }
+
+            if(stopping || received == 0 || ++failures > MaxReconnects) {
+                break;
+            }
+
+            qDebug() << "[NetworkStream] Connection lost, reconnecting to" << url;
+
+            std::unique_lock lock{mutex};
+            spaceCond.wait_for(lock, delay, [this]() { return stopping.load(); });
+            delay = std::min(delay * 2, std::chrono::milliseconds{MaxReconnectDelay});
+        }
+
+        const std::scoped_lock lock{mutex};
+        finished  = true;
+        buffering = false;
+        dataCond.notify_all();
+    }
+
+    AVIOContext* connect(bool resume)
+    {
+        AVDictionary* options{nullptr};
+        av_dict_set(&options, "icy", "1", 0);
+        av_dict_set(&options, "user_agent", "fooyin/" VERSION, 0);
+        av_dict_set_int(&options, "rw_timeout", NetworkTimeout, 0);
+        if(resume) {
+            av_dict_set_int(&options, "offset", received, 0);
+        }
+
+        const AVIOInterruptCB interrupt{interrupted, this};
+        AVIOContext* io{nullptr};
+
+        const int ret = avio_open2(&io, url.toUtf8().constData(), AVIO_FLAG_READ, &interrupt, &options);
+        av_dict_free(&options);
+
+        if(ret < 0) {
+            if(!stopping) {
+                Utils::printError(ret);
+            }
+            return nullptr;
+        }
+
+        readHeaders(io);
+        return io;
+    }
+
+    // Returns true once the whole stream has arrived, false if the connection dropped or the stream was closed
+    bool receive(AVIOContext* io)
+    {
+        auto last = std::chrono::steady_clock::now();
+
+        while(!stopping) {
+            const int count = avio_read_partial(io, chunk.data(), ChunkSize);
+            if(count == AVERROR_EOF || count == 0) {
+                return !live && (streamSize <= 0 || received >= streamSize);
+            }
+            if(count < 0) {
+                if(!stopping) {
+                    Utils::printError(count);
+                }
+                return false;
+            }
+
+            const std::chrono::duration<double> wait = std::chrono::steady_clock::now() - last;
+            measure(count, wait.count());
+            received += count;
+            readMetadata(io);
+
+            if(!store(chunk.data(), static_cast<size_t>(count))) {
+                return false;
+            }
+            // Time spent waiting for the reader to make space says nothing about the connection
+            last = std::chrono::steady_clock::now();
+        }
+
+        return false;
+    }
+
+    void measure(int bytes, double seconds)
+    {
+        jitter = std::max(seconds, jitter * JitterDecay);
+
+        windowBytes += bytes;
+        windowTime += seconds;
+
+        if(windowTime >= ThroughputWindow) {
+            const double rate = static_cast<double>(windowBytes) / windowTime;
+            throughput        = throughput > 0.0 ? throughput + (ThroughputWeight * (rate - throughput)) : rate;
+            windowBytes       = 0;
+            windowTime        = 0.0;
+        }
+    }
+
+    [[nodiscard]] size_t prerollBytes() const
+    {
+        const double seconds = std::clamp(MinPreroll + (JitterHeadroom * jitter), MinPreroll, MaxPreroll);
+        const double rate    = throughput > 0.0 ? throughput : DefaultByteRate;
+        return std::clamp(static_cast<size_t>(rate * seconds), 2 * MinReadBytes, buffer.capacity() / 2);
+    }
+
+    bool store(const uint8_t* data, size_t count)
+    {
+        const auto* bytes = reinterpret_cast<const std::byte*>(data);
+
+        std::unique_lock lock{mutex};
+        while(count > 0) {
+            spaceCond.wait(lock, [this]() { return stopping || buffer.writeAvailable() > 0; });
+            if(stopping) {
+                return false;
+            }
+
+            const size_t written = buffer.write(bytes, count);
+            bytes += written;
+            count -= written;
+
+            if(buffering && buffer.readAvailable() >= prerollBytes()) {
+                buffering = false;
+            }
+            dataCond.notify_all();
+        }
+
+        return true;
+    }
+
+    void readHeaders(AVIOContext* io)
+    {
+        uint8_t* headers{nullptr};
+        if(av_opt_get(io, "icy_metadata_headers", AV_OPT_SEARCH_CHILDREN, &headers) < 0 || !headers) {
+            return;
+        }
+
+        const QString text = QString::fromUtf8(reinterpret_cast<const char*>(headers));
+        av_free(headers);
+
+        if(text.isEmpty()) {
+            return;
+        }
+
+        live = true;
+
+        static const QString NameHeader = QStringLiteral("icy-name:");
+        const QStringList lines         = text.split(u'\n', Qt::SkipEmptyParts);
+        for(const QString& line : lines) {
+            if(line.startsWith(NameHeader, Qt::CaseInsensitive)) {
+                const std::scoped_lock lock{mutex};
+                name = line.mid(NameHeader.size()).trimmed();
+            }
+        }
+    }
+
+    void readMetadata(AVIOContext* io)
+    {
+        uint8_t* packet{nullptr};
+        if(av_opt_get(io, "icy_metadata_packet", AV_OPT_SEARCH_CHILDREN, &packet) < 0 || !packet) {
+            return;
+        }
+
+        const QByteArray metadata{reinterpret_cast<const char*>(packet)};
+        av_free(packet);
+
+        // The last packet is kept until the next arrives, so only parse it once
+        if(metadata.isEmpty() || metadata == lastMetadata) {
+            return;
+        }
+        lastMetadata = metadata;
+
+        const QString newTitle = icyTitle(metadata);
+        const std::scoped_lock lock{mutex};
+        title = newTitle;
+    }
+};
+
+NetworkStream::NetworkStream()
+    : p{std::make_unique<Private>()}
+{ }
+
+NetworkStream::~NetworkStream()
+{
+    close();
+}
+
+bool NetworkStream::canStream(const QString& source)
+{
+    const QUrl url{source};
+    const QString scheme = url.scheme().toLower();
+    if(scheme != u"http" && scheme != u"https") {
+        return false;
+    }
+    return !url.path().endsWith(u".m3u8", Qt::CaseInsensitive);
+}
+
+QString NetworkStream::icyTitle(const QByteArray& metadata)
+{
+    static constexpr QByteArrayView Key{"StreamTitle='"};
+
+    const qsizetype keyPos = metadata.indexOf(Key);
+    if(keyPos < 0) {
+        return {};
+    }
+
+    // Titles can contain quotes themselves, so the value ends at a quote followed by a semicolon
+    const qsizetype start = keyPos + Key.size();
+    qsizetype end         = metadata.indexOf("';", start);
+    if(end < 0) {
+        end = metadata.lastIndexOf('\'');
+    }
+    if(end < start) {
+        return {};
+    }
+
+    const QByteArray value = metadata.mid(start, end - start);
+
+    // Plenty of stations still send Latin-1, so only trust UTF-8 if it decodes cleanly
+    QStringDecoder decoder{QStringDecoder::Utf8};
+    const QString text = decoder(value);
+    return (decoder.hasError() ? QString::fromLatin1(value) : text).trimmed();
+}
+
+bool NetworkStream::open(const QString& url)
+{
+    close();
+
+    p->reset();
+    p->url    = url;
+    p->thread = std::thread{[this]() { p->run(); }};
+
+    std::unique_lock lock{p->mutex};
+    const bool ready = p->dataCond.wait_for(lock, OpenTimeout, [this]() { return !p->buffering || p->finished; });
+    if(ready && !p->buffer.empty()) {
+        return true;
+    }
+
+    lock.unlock();
+    close();
+    return false;
+}
+
+void NetworkStream::close()
+{
+    {
+        const std::scoped_lock lock{p->mutex};
+        p->stopping = true;
+    }
+    p->dataCond.notify_all();
+    p->spaceCond.notify_all();
+
+    if(p->thread.joinable()) {
+        p->thread.join();
+    }
+}
+
+int64_t NetworkStream::read(std::byte* data, int64_t size)
+{
+    if(size <= 0) {
+        return 0;
+    }
+
+    std::unique_lock lock{p->mutex};
+    p->dataCond.wait_for(lock, ReadTimeout, [this]() { return p->stopping || p->finished || !p->buffer.empty(); });
+
+    if(p->buffer.empty()) {
+        return p->finished ? 0 : -1;
+    }
+
+    const size_t count = p->buffer.read(data, static_cast<size_t>(size));
+    p->spaceCond.notify_one();
+    return static_cast<int64_t>(count);
+}
+
+bool NetworkStream::canRead()
+{
+    const std::scoped_lock lock{p->mutex};
+
+    if(p->finished) {
+        return true;
+    }
+    // Running low, so wait for a whole preroll rather than trickling along a packet at a time
+    if(!p->buffering && p->buffer.readAvailable() < MinReadBytes) {
+        p->buffering = true;
+    }
+    return !p->buffering;
+}
+
+bool NetworkStream::isBuffering() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->buffering && !p->finished;
+}
+
+QString NetworkStream::title() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->title;
+}
+
+QString NetworkStream::name() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->name;
+}
+} // namespace Fooyin
@@ -0,0 +1,86 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * Receives an HTTP(S) stream, e.g. internet radio, on its own thread into a network buffer which the
+ * decoder reads from, so a slow or stalled connection never holds up decoding.
+ *
+ * Dropped connections are reopened after a growing delay. Reading waits for a preroll after connecting and
+ * whenever the buffer runs dry, sized from the measured throughput and jitter of the connection.
+ * ICY (Shoutcast/Icecast) metadata is stripped from the audio as it arrives and exposed through title().
+ */
+class FYCORE_EXPORT NetworkStream
+{
+public:
+    NetworkStream();
+    ~NetworkStream();
+
+    NetworkStream(const NetworkStream& other)            = delete;
+    NetworkStream& operator=(const NetworkStream& other) = delete;
+
+    /*!
+     * Returns @c true if @p source is a URL to stream through this class.
+     * HLS playlists are excluded, as FFmpeg's demuxer fetches their segments itself.
+     */
+    static bool canStream(const QString& source);
+    /** Returns the StreamTitle of an ICY metadata block, e.g. "StreamTitle='Artist - Title';". */
+    static QString icyTitle(const QByteArray& metadata);
+
+    /*!
+     * Connects to @p url and waits for the first preroll, so the format can be probed straight away.
+     * @returns false if the connection failed or no data arrived in time.
+     */
+    bool open(const QString& url);
+    void close();
+
+    /*!
+     * Copies up to @p size buffered bytes into @p data, only waiting for the network if nothing is buffered.
+     * @returns the number of bytes copied, 0 at the end of the stream, or -1 on error.
+     */
+    int64_t read(std::byte* data, int64_t size);
+
+    /*!
+     * Returns @c true if enough is buffered to demux another packet without waiting.
+     * Once the buffer runs low, this returns false until a full preroll has arrived again.
+     */
+    bool canRead();
+    /** Returns @c true while refilling to the preroll, i.e. playback is waiting on the network. */
+    [[nodiscard]] bool isBuffering() const;
+
+    /** Returns the title from the most recent ICY metadata, usually the artist and title of the current song. */
+    [[nodiscard]] QString title() const;
+    /** Returns the station name sent in the ICY headers. */
+    [[nodiscard]] QString name() const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,242 @@
+/*
+ * Fooyin
+ * Copyright © 2023, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ffmpegresampler.h"
+
+#include "ffmpegutils.h"
+
+extern "C"
+{
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+#include <libswresample/swresample.h>
+}
+
+#include <QDebug>
+
+namespace {
+struct SwrContextDeleter
+{
+    void operator()(SwrContext* context) const
+    {
+        if(context) {
+            swr_free(&context);
+        }
+    }
+};
+using SwrContextPtr = std::unique_ptr<SwrContext, SwrContextDeleter>;
+
+struct QualityPreset
+{
+    int filterSize;
+    int phaseShift;
+    bool linearInterp;
+    double cutoff;
+};
+
+QualityPreset qualityPreset(Fooyin::ResampleQuality quality)
+{
+    switch(quality) {
+        case(Fooyin::ResampleQuality::Fast):
+            return {8, 6, true, 0.90};
+        case(Fooyin::ResampleQuality::High):
+            return {64, 12, false, 0.98};
+        case(Fooyin::ResampleQuality::Medium):
+        default:
+            // libswresample's defaults
+            return {32, 10, false, 0.97};
+    }
+}
+
+SwrContextPtr createContext(const Fooyin::AudioFormat& input, const Fooyin::AudioFormat& output)
+{
+    SwrContext* context{nullptr};
+
+    const AVSampleFormat inFormat  = Fooyin::Utils::avSampleFormat(input.sampleFormat());
+    const AVSampleFormat outFormat = Fooyin::Utils::avSampleFormat(output.sampleFormat());
+
+#if OLD_CHANNEL_LAYOUT
+    context = swr_alloc_set_opts(nullptr, av_get_default_channel_layout(output.channelCount()), outFormat,
+                                 output.sampleRate(), av_get_default_channel_layout(input.channelCount()), inFormat,
+                                 input.sampleRate(), 0, nullptr);
+#else
+    AVChannelLayout inLayout;
+    AVChannelLayout outLayout;
+    av_channel_layout_default(&inLayout, input.channelCount());
+    av_channel_layout_default(&outLayout, output.channelCount());
+
+    const int ret = swr_alloc_set_opts2(&context, &outLayout, outFormat, output.sampleRate(), &inLayout, inFormat,
+                                        input.sampleRate(), 0, nullptr);
+    av_channel_layout_uninit(&inLayout);
+    av_channel_layout_uninit(&outLayout);
+
+    if(ret < 0) {
+        Fooyin::Utils::printError(ret);
+        return {};
+    }
+#endif
+
+    return SwrContextPtr{context};
+}
+} // namespace
+
+namespace Fooyin {
+struct Resampler::Private
+{
+    SwrContextPtr context;
+    AudioFormat inputFormat;
+    AudioFormat outputFormat;
+    ResampleQuality quality{ResampleQuality::Medium};
+
+    // Start time of the next output buffer
+    uint64_t nextStartTime{0};
+
+    AudioBuffer convert(const uint8_t* input, int inputFrames)
+    {
+        const int maxFrames = swr_get_out_samples(context.get(), inputFrames);
+        if(maxFrames <= 0) {
+            return {};
+        }
+
+        AudioBuffer output{outputFormat, nextStartTime};
+        output.resize(static_cast<size_t>(outputFormat.bytesForFrames(maxFrames)));
+
+        auto* outData       = reinterpret_cast<uint8_t*>(output.data());
+        const int converted = swr_convert(context.get(), &outData, maxFrames, input ? &input : nullptr, inputFrames);
+        if(converted < 0) {
+            Utils::printError(converted);
+            return {};
+        }
+        if(converted == 0) {
+            return {};
+        }
+
+        output.resize(static_cast<size_t>(outputFormat.bytesForFrames(converted)));
+        nextStartTime += outputFormat.durationForFrames(converted);
+        return output;
+    }
+};
+
+Resampler::Resampler()
+    : p{std::make_unique<Private>()}
+{ }
+
+Resampler::~Resampler() = default;
+
+Resampler::Resampler(Resampler&& other) noexcept            = default;
+Resampler& Resampler::operator=(Resampler&& other) noexcept = default;
+
+bool Resampler::init(const AudioFormat& inputFormat, const AudioFormat& outputFormat, ResampleQuality quality)
+{
+    uninit();
+
+    if(!inputFormat.isValid() || !outputFormat.isValid()) {
+        return false;
+    }
+
+    auto context = createContext(inputFormat, outputFormat);
+    if(!context) {
+        return false;
+    }
+
+    const auto preset = qualityPreset(quality);
+    av_opt_set_int(context.get(), "filter_size", preset.filterSize, 0);
+    av_opt_set_int(context.get(), "phase_shift", preset.phaseShift, 0);
+    av_opt_set_int(context.get(), "linear_interp", preset.linearInterp ? 1 : 0, 0);
+    av_opt_set_double(context.get(), "cutoff", preset.cutoff, 0);
+
+    if(const int ret = swr_init(context.get()); ret < 0) {
+        Utils::printError(ret);
+        return false;
+    }
+
+    p->context      = std::move(context);
+    p->inputFormat  = inputFormat;
+    p->outputFormat = outputFormat;
+    p->quality      = quality;
+
+    return true;
+}
+
+void Resampler::uninit()
+{
+    p->context.reset();
+    p->inputFormat   = {};
+    p->outputFormat  = {};
+    p->nextStartTime = 0;
+}
+
+bool Resampler::isInitialised() const
+{
+    return p->context != nullptr;
+}
+
+AudioFormat Resampler::inputFormat() const
+{
+    return p->inputFormat;
+}
+
+AudioFormat Resampler::outputFormat() const
+{
+    return p->outputFormat;
+}
+
+ResampleQuality Resampler::quality() const
+{
+    return p->quality;
+}
+
+AudioBuffer Resampler::process(const AudioBuffer& buffer)
+{
+    if(!isInitialised() || !buffer.isValid()) {
+        return {};
+    }
+
+    if(swr_get_delay(p->context.get(), p->inputFormat.sampleRate()) == 0) {
+        p->nextStartTime = buffer.startTime();
+    }
+
+    const auto* input = reinterpret_cast<const uint8_t*>(buffer.constData().data());
+    return p->convert(input, buffer.frameCount());
+}
+
+AudioBuffer Resampler::flush()
+{
+    if(!isInitialised()) {
+        return {};
+    }
+
+    return p->convert(nullptr, 0);
+}
+
+void Resampler::reset()
+{
+    if(!isInitialised()) {
+        return;
+    }
+
+    // Reinitialising keeps the options but clears the delay line
+    swr_close(p->context.get());
+    if(const int ret = swr_init(p->context.get()); ret < 0) {
+        Utils::printError(ret);
+        p->context.reset();
+    }
+    p->nextStartTime = 0;
+}
+} // namespace Fooyin
@@ -0,0 +1,66 @@
+/*
+ * Fooyin
+ * Copyright © 2023, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audiobuffer.h>
+#include <core/engine/enginecontroller.h>
+
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * Converts decoded audio to a different sample rate and sample format using libswresample.
+ * Whole buffers are processed at a time; the filter's delay line is carried across calls
+ * until @fn flush or @fn reset.
+ */
+class Resampler
+{
+public:
+    Resampler();
+    ~Resampler();
+
+    Resampler(const Resampler& other)            = delete;
+    Resampler& operator=(const Resampler& other) = delete;
+    Resampler(Resampler&& other) noexcept;
+    Resampler& operator=(Resampler&& other) noexcept;
+
+    bool init(const AudioFormat& inputFormat, const AudioFormat& outputFormat, ResampleQuality quality);
+    void uninit();
+
+    [[nodiscard]] bool isInitialised() const;
+    [[nodiscard]] AudioFormat inputFormat() const;
+    [[nodiscard]] AudioFormat outputFormat() const;
+    [[nodiscard]] ResampleQuality quality() const;
+
+    /*!
+     * Converts @p buffer to the output format.
+     * @returns the converted audio, which may be empty while the filter fills.
+     */
+    AudioBuffer process(const AudioBuffer& buffer);
+    /** Returns the audio still held in the filter at the end of a stream. */
+    AudioBuffer flush();
+    /** Drops any audio held in the filter, e.g. after seeking. */
+    void reset();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -79,4 +79,37 @@ AudioFormat audioFormatFromCodec(AVCodecParameters* codec)
 
     return format;
 }
+
+AudioFormat audioFormatFromContext(const AVCodecContext* context)
+{
+    AudioFormat format;
+
+    format.setSampleFormat(sampleFormat(context->sample_fmt, context->bits_per_raw_sample));
+    format.setSampleRate(context->sample_rate);
+#if OLD_CHANNEL_LAYOUT
+    format.setChannelCount(context->channels);
+#else
+    format.setChannelCount(context->ch_layout.nb_channels);
+#endif
+
+    return format;
+}
+
+AVSampleFormat avSampleFormat(SampleFormat format)
+{
+    switch(format) {
+        case(SampleFormat::U8):
+            return AV_SAMPLE_FMT_U8;
+        case(SampleFormat::S16):
+            return AV_SAMPLE_FMT_S16;
+        case(SampleFormat::S24):
+        case(SampleFormat::S32):
+            return AV_SAMPLE_FMT_S32;
+        case(SampleFormat::Float):
+            return AV_SAMPLE_FMT_FLT;
+        case(SampleFormat::Unknown):
+        default:
+            return AV_SAMPLE_FMT_NONE;
+    }
+}
 } // namespace Fooyin::Utils
@@ -36,4 +36,8 @@ namespace Fooyin::Utils {
 void printError(int error);
 void printError(const QString& error);
 AudioFormat audioFormatFromCodec(AVCodecParameters* codec);
+/** Returns the format decoded by the open codec @p context. */
+AudioFormat audioFormatFromContext(const AVCodecContext* context);
+/** Returns the packed FFmpeg sample format holding samples of @p format, with S24 held in 32 bits. */
+AVSampleFormat avSampleFormat(SampleFormat format);
 } // namespace Fooyin::Utils
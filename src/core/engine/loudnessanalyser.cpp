@@ -0,0 +1,211 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "loudnessanalyser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+// Gating thresholds from BS.1770-4
+constexpr auto AbsoluteGate = -70.0;
+constexpr auto RelativeGate = -10.0;
+// Offset which makes the K-weighted response read 0dB at 1kHz
+constexpr auto LoudnessOffset = -0.691;
+
+namespace {
+double energyToLoudness(double energy)
+{
+    return LoudnessOffset + (10.0 * std::log10(energy));
+}
+
+double loudnessToEnergy(double loudness)
+{
+    return std::pow(10.0, (loudness - LoudnessOffset) / 10.0);
+}
+
+std::optional<double> gatedLoudness(const std::vector<const std::vector<double>*>& blocks)
+{
+    const double absoluteThreshold = loudnessToEnergy(AbsoluteGate);
+
+    double sum{0.0};
+    size_t count{0};
+    for(const auto* energies : blocks) {
+        for(const double energy : *energies) {
+            if(energy >= absoluteThreshold) {
+                sum += energy;
+                ++count;
+            }
+        }
+    }
+
+    if(count == 0) {
+        return {};
+    }
+
+    const double ungated           = energyToLoudness(sum / static_cast<double>(count));
+    const double relativeThreshold = loudnessToEnergy(ungated + RelativeGate);
+
+    sum   = 0.0;
+    count = 0;
+    for(const auto* energies : blocks) {
+        for(const double energy : *energies) {
+            if(energy >= absoluteThreshold && energy >= relativeThreshold) {
+                sum += energy;
+                ++count;
+            }
+        }
+    }
+
+    if(count == 0) {
+        return {};
+    }
+
+    return energyToLoudness(sum / static_cast<double>(count));
+}
+
+double process(double input, const auto& filter, std::array<double, 2>& state)
+{
+    // Transposed direct form II
+    const double output = (filter.b0 * input) + state[0];
+    state[0]            = (filter.b1 * input) - (filter.a1 * output) + state[1];
+    state[1]            = (filter.b2 * input) - (filter.a2 * output);
+    return output;
+}
+} // namespace
+
+namespace Fooyin {
+LoudnessAnalyser::LoudnessAnalyser(int sampleRate, int channels)
+    : m_sampleRate{std::max(sampleRate, 1)}
+    , m_channels{std::max(channels, 1)}
+    , m_state(static_cast<size_t>(m_channels))
+    , m_segmentLength{std::max(m_sampleRate / 10, 1)}
+{
+    const double rate = m_sampleRate;
+
+    // Stage 1: high shelf modelling the acoustic effect of the head
+    {
+        const double f0   = 1681.974450955533;
+        const double gain = 3.999843853973347;
+        const double q    = 0.7071752369554196;
+
+        const double k  = std::tan(std::numbers::pi * f0 / rate);
+        const double vh = std::pow(10.0, gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + (k / q) + (k * k);
+
+        m_shelf.b0 = (vh + (vb * k / q) + (k * k)) / a0;
+        m_shelf.b1 = 2.0 * ((k * k) - vh) / a0;
+        m_shelf.b2 = (vh - (vb * k / q) + (k * k)) / a0;
+        m_shelf.a1 = 2.0 * ((k * k) - 1.0) / a0;
+        m_shelf.a2 = (1.0 - (k / q) + (k * k)) / a0;
+    }
+
+    // Stage 2: RLB high-pass
+    {
+        const double f0 = 38.13547087602444;
+        const double q  = 0.5003270373238773;
+
+        const double k  = std::tan(std::numbers::pi * f0 / rate);
+        const double a0 = 1.0 + (k / q) + (k * k);
+
+        m_highPass.b0 = 1.0;
+        m_highPass.b1 = -2.0;
+        m_highPass.b2 = 1.0;
+        m_highPass.a1 = 2.0 * ((k * k) - 1.0) / a0;
+        m_highPass.a2 = (1.0 - (k / q) + (k * k)) / a0;
+    }
+
+    // Assume the usual 5.1 order (FL, FR, FC, LFE, BL, BR): LFE is ignored and surrounds weighted up
+    if(m_channels == 6) {
+        m_state[3].weight = 0.0;
+        m_state[4].weight = 1.41;
+        m_state[5].weight = 1.41;
+    }
+}
+
+int LoudnessAnalyser::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int LoudnessAnalyser::channelCount() const
+{
+    return m_channels;
+}
+
+void LoudnessAnalyser::addFrames(const float* data, int frameCount)
+{
+    for(int frame{0}; frame < frameCount; ++frame) {
+        double energy{0.0};
+
+        for(int ch{0}; ch < m_channels; ++ch) {
+            const float sample = data[(frame * m_channels) + ch];
+            m_peak             = std::max(m_peak, std::abs(sample));
+
+            auto& state           = m_state[static_cast<size_t>(ch)];
+            const double weighted = process(process(sample, m_shelf, state.shelf), m_highPass, state.highPass);
+            energy += state.weight * weighted * weighted;
+        }
+
+        m_segmentEnergy += energy;
+
+        if(++m_segmentFrames == m_segmentLength) {
+            finishSegment();
+        }
+    }
+}
+
+std::optional<double> LoudnessAnalyser::integratedLoudness() const
+{
+    return gatedLoudness({&m_blockEnergies});
+}
+
+float LoudnessAnalyser::peak() const
+{
+    return m_peak;
+}
+
+std::optional<double> LoudnessAnalyser::integratedLoudness(const std::vector<const LoudnessAnalyser*>& analysers)
+{
+    std::vector<const std::vector<double>*> blocks;
+    blocks.reserve(analysers.size());
+
+    for(const auto* analyser : analysers) {
+        blocks.push_back(&analyser->m_blockEnergies);
+    }
+
+    return gatedLoudness(blocks);
+}
+
+void LoudnessAnalyser::finishSegment()
+{
+    std::ranges::rotate(m_segments, m_segments.begin() + 1);
+    m_segments.back() = m_segmentEnergy / static_cast<double>(m_segmentLength);
+
+    m_segmentEnergy = 0.0;
+    m_segmentFrames = 0;
+
+    if(++m_segmentCount >= static_cast<int>(m_segments.size())) {
+        m_blockEnergies.push_back(std::accumulate(m_segments.cbegin(), m_segments.cend(), 0.0)
+                                  / static_cast<double>(m_segments.size()));
+    }
+}
+} // namespace Fooyin
@@ -0,0 +1,91 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Measures integrated loudness and sample peak following EBU R128 / ITU-R BS.1770.
+ * Feed it interleaved float samples with addFrames, then query the results.
+ * Loudness is in LUFS; ReplayGain 2 gains are relative to a -18 LUFS reference.
+ */
+class FYCORE_EXPORT LoudnessAnalyser
+{
+public:
+    static constexpr double ReferenceLoudness = -18.0;
+
+    LoudnessAnalyser(int sampleRate, int channels);
+
+    [[nodiscard]] int sampleRate() const;
+    [[nodiscard]] int channelCount() const;
+
+    void addFrames(const float* data, int frameCount);
+
+    /** Gated loudness of everything added so far, or nullopt if it is all below the absolute gate. */
+    [[nodiscard]] std::optional<double> integratedLoudness() const;
+    /** Highest absolute sample value seen, where 1.0 is full scale. */
+    [[nodiscard]] float peak() const;
+
+    /** Gated loudness of all of @p analysers measured as one programme, e.g. for album gain. */
+    static std::optional<double> integratedLoudness(const std::vector<const LoudnessAnalyser*>& analysers);
+
+private:
+    struct Biquad
+    {
+        double b0{1.0};
+        double b1{0.0};
+        double b2{0.0};
+        double a1{0.0};
+        double a2{0.0};
+    };
+
+    struct ChannelState
+    {
+        double weight{1.0};
+        // Filter state for the two K-weighting stages
+        std::array<double, 2> shelf{};
+        std::array<double, 2> highPass{};
+    };
+
+    void finishSegment();
+
+    int m_sampleRate;
+    int m_channels;
+
+    Biquad m_shelf;
+    Biquad m_highPass;
+    std::vector<ChannelState> m_state;
+
+    // Blocks are 400ms long with 75% overlap, so they're built from four 100ms segments
+    int m_segmentLength;
+    int m_segmentFrames{0};
+    double m_segmentEnergy{0.0};
+    std::array<double, 4> m_segments{};
+    int m_segmentCount{0};
+
+    std::vector<double> m_blockEnergies;
+    float m_peak{0.0F};
+};
+} // namespace Fooyin
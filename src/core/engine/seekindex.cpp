@@ -0,0 +1,66 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "seekindex.h"
+
+#include <algorithm>
+
+namespace Fooyin {
+bool SeekIndex::empty() const
+{
+    return m_points.empty();
+}
+
+const std::vector<SeekIndex::Point>& SeekIndex::points() const
+{
+    return m_points;
+}
+
+int64_t SeekIndex::lastTimestamp() const
+{
+    return m_points.empty() ? -1 : m_points.back().timestamp;
+}
+
+void SeekIndex::add(int64_t timestamp, int64_t pos, int64_t interval)
+{
+    if(m_points.empty() || timestamp >= m_points.back().timestamp + interval) {
+        m_points.push_back({timestamp, pos});
+    }
+}
+
+void SeekIndex::setPoints(std::vector<Point> points)
+{
+    m_points = std::move(points);
+    std::ranges::sort(m_points, {}, &Point::timestamp);
+}
+
+void SeekIndex::clear()
+{
+    m_points.clear();
+}
+
+const SeekIndex::Point* SeekIndex::find(int64_t timestamp) const
+{
+    auto it = std::ranges::upper_bound(m_points, timestamp, {}, &Point::timestamp);
+    if(it == m_points.begin()) {
+        return nullptr;
+    }
+    return &*std::prev(it);
+}
+} // namespace Fooyin
@@ -0,0 +1,55 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A sorted table of timestamp to byte offset mappings, recorded while a file is decoded.
+ * Timestamps are in the decoder's own time base.
+ */
+class SeekIndex
+{
+public:
+    struct Point
+    {
+        int64_t timestamp{0};
+        int64_t pos{0};
+    };
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] const std::vector<Point>& points() const;
+    /** Timestamp of the last point, or -1 if the index is empty. */
+    [[nodiscard]] int64_t lastTimestamp() const;
+
+    /** Appends a point if it is at least @p interval after the last one. */
+    void add(int64_t timestamp, int64_t pos, int64_t interval);
+    void setPoints(std::vector<Point> points);
+    void clear();
+
+    /** Returns the last point at or before @p timestamp, or nullptr if there is none. */
+    [[nodiscard]] const Point* find(int64_t timestamp) const;
+
+private:
+    std::vector<Point> m_points;
+};
+} // namespace Fooyin
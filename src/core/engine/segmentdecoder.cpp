@@ -0,0 +1,285 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "segmentdecoder.h"
+
+#include "ffmpeg/ffmpegdecoder.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+struct Session
+{
+    explicit Session(Fooyin::DbConnectionPoolPtr seekIndexPool)
+        : decoder{std::move(seekIndexPool)}
+    { }
+
+    Fooyin::FFmpegDecoder decoder;
+    QString filepath;
+    // Decoded past the end of the last track read, so belongs to the one following it
+    Fooyin::AudioBuffer carry;
+    // Position (in ms) within the file of the next audio to be read
+    uint64_t position{0};
+};
+} // namespace
+
+namespace Fooyin {
+struct SegmentDecoder::Private
+{
+    DbConnectionPoolPtr seekIndexPool;
+    std::shared_ptr<Session> session;
+
+    // Bounds of the track within the file, with an end of 0 reading up to the end of the file
+    uint64_t start{0};
+    uint64_t end{0};
+    // Position (in ms) within the file of the next audio this decoder returns
+    uint64_t position{0};
+
+    explicit Private(DbConnectionPoolPtr seekIndexPool_)
+        : seekIndexPool{std::move(seekIndexPool_)}
+    { }
+
+    bool open(const QString& filepath)
+    {
+        // Leave a shared session to the decoder still using it
+        if(!session || session.use_count() > 1) {
+            session = std::make_shared<Session>(seekIndexPool);
+        }
+
+        session->carry    = {};
+        session->position = 0;
+        session->filepath = filepath;
+
+        if(!session->decoder.init(filepath)) {
+            session->filepath.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Another decoder may have read from the session meanwhile, or this one may not have started yet
+    void sync()
+    {
+        if(session->position != position) {
+            session->decoder.seek(position);
+            session->carry    = {};
+            session->position = position;
+        }
+    }
+
+    AudioBuffer takeCarry(size_t bytes)
+    {
+        AudioBuffer& carry = session->carry;
+        const auto count   = static_cast<size_t>(carry.byteCount());
+
+        if(bytes == 0 || count <= bytes) {
+            return std::exchange(carry, {});
+        }
+
+        AudioBuffer buffer = carry.slice(0, static_cast<int>(bytes));
+        carry              = carry.slice(static_cast<int>(bytes), static_cast<int>(count - bytes));
+        return buffer;
+    }
+
+    // Reads up to @p bytes, or the next decoded frame if 0
+    AudioBuffer read(size_t bytes)
+    {
+        if(!session) {
+            return {};
+        }
+
+        sync();
+
+        AudioBuffer buffer;
+        if(session->carry.isValid()) {
+            buffer = takeCarry(bytes);
+
+            const auto count = static_cast<size_t>(buffer.byteCount());
+            if(count < bytes) {
+                const AudioBuffer more = session->decoder.readBuffer(bytes - count);
+                if(more.isValid()) {
+                    if(buffer.isExternal()) {
+                        buffer.reserve(bytes);
+                    }
+                    buffer.append(more.constData());
+                }
+            }
+        }
+        else {
+            buffer = bytes > 0 ? session->decoder.readBuffer(bytes) : session->decoder.readBuffer();
+        }
+
+        if(!buffer.isValid()) {
+            return {};
+        }
+
+        const uint64_t bufferStart = buffer.startTime();
+        const uint64_t bufferEnd   = bufferStart + buffer.duration();
+
+        if(end > 0 && bufferEnd > end) {
+            // The rest is the start of the next track
+            const int size = buffer.byteCount();
+            const int keep = bufferStart >= end
+                               ? 0
+                               : std::clamp(buffer.format().bytesForDuration(end - bufferStart), 0, size);
+
+            if(keep < size) {
+                session->carry = buffer.slice(keep, size - keep);
+            }
+            buffer = keep > 0 ? buffer.slice(0, keep) : AudioBuffer{};
+
+            position = end;
+        }
+        else {
+            position = bufferEnd;
+        }
+
+        session->position = position;
+
+        if(buffer.isValid()) {
+            buffer.setStartTime(bufferStart - std::min(bufferStart, start));
+        }
+
+        return buffer;
+    }
+};
+
+SegmentDecoder::SegmentDecoder(DbConnectionPoolPtr seekIndexPool)
+    : p{std::make_unique<Private>(std::move(seekIndexPool))}
+{ }
+
+SegmentDecoder::~SegmentDecoder() = default;
+
+bool SegmentDecoder::init(const Track& track)
+{
+    if(!p->open(track.filepath())) {
+        return false;
+    }
+
+    p->start    = track.hasCue() ? track.offset() : 0;
+    p->end      = track.hasCue() ? track.offset() + track.duration() : 0;
+    p->position = p->start;
+
+    return true;
+}
+
+bool SegmentDecoder::init(const QString& source)
+{
+    if(!p->open(source)) {
+        return false;
+    }
+
+    p->start    = 0;
+    p->end      = 0;
+    p->position = 0;
+
+    return true;
+}
+
+bool SegmentDecoder::continueFrom(const SegmentDecoder& previous, const Track& track)
+{
+    const Private& other = *previous.p;
+
+    if(&previous == this || !other.session || other.end == 0 || !track.hasCue() || track.offset() != other.end
+       || other.session->filepath != track.filepath()) {
+        return false;
+    }
+
+    p->session  = other.session;
+    p->start    = track.offset();
+    p->end      = track.offset() + track.duration();
+    p->position = p->start;
+
+    return true;
+}
+
+bool SegmentDecoder::sharesSession() const
+{
+    return p->session && p->session.use_count() > 1;
+}
+
+void SegmentDecoder::start()
+{
+    if(p->session) {
+        p->session->decoder.start();
+    }
+}
+
+void SegmentDecoder::stop()
+{
+    if(!p->session) {
+        return;
+    }
+
+    if(!sharesSession()) {
+        p->session->decoder.stop();
+        p->session->carry    = {};
+        p->session->position = 0;
+    }
+
+    p->position = p->start;
+}
+
+AudioFormat SegmentDecoder::format() const
+{
+    return p->session ? p->session->decoder.format() : AudioFormat{};
+}
+
+bool SegmentDecoder::isSeekable() const
+{
+    return p->session && p->session->decoder.isSeekable();
+}
+
+void SegmentDecoder::seek(uint64_t pos)
+{
+    if(!p->session) {
+        return;
+    }
+
+    p->position = p->start + pos;
+    p->sync();
+}
+
+AudioBuffer SegmentDecoder::readBuffer()
+{
+    return p->read(0);
+}
+
+AudioBuffer SegmentDecoder::readBuffer(size_t bytes)
+{
+    return p->read(bytes);
+}
+
+bool SegmentDecoder::isStalled() const
+{
+    return p->session && p->session->decoder.isStalled();
+}
+
+QString SegmentDecoder::streamTitle() const
+{
+    return p->session ? p->session->decoder.streamTitle() : QString{};
+}
+
+AudioDecoder::Error SegmentDecoder::error() const
+{
+    return p->session ? p->session->decoder.error() : ResourceError;
+}
+} // namespace Fooyin
@@ -0,0 +1,75 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/audiodecoder.h>
+#include <core/track.h>
+#include <utils/database/dbconnectionpool.h>
+
+namespace Fooyin {
+/*!
+ * Decodes a track which may only cover part of its file, as with CUE sheet tracks.
+ * Seek positions and buffer start times are relative to the start of the track, and decoding stops at its end.
+ *
+ * A decoder can carry on from another one when its track starts where the other's ends in the same file.
+ * Both then share one underlying decoder, so the file stays open and no seek is needed at the boundary.
+ */
+class SegmentDecoder : public AudioDecoder
+{
+public:
+    explicit SegmentDecoder(DbConnectionPoolPtr seekIndexPool = {});
+    ~SegmentDecoder() override;
+
+    /** Opens the file of @p track, positioned at the start of the track. */
+    bool init(const Track& track);
+    /** Opens @p source as a whole. */
+    bool init(const QString& source) override;
+    /*!
+     * Continues decoding from where @p previous will finish, without opening the file again.
+     * Audio is only read once @p previous has reached its end; reading earlier seeks the shared decoder.
+     * @returns false if @p track doesn't start where the track of @p previous ends, leaving this decoder unchanged.
+     */
+    bool continueFrom(const SegmentDecoder& previous, const Track& track);
+    /** Returns true if the underlying decoder is shared with another, i.e. following continueFrom. */
+    [[nodiscard]] bool sharesSession() const;
+
+    void start() override;
+    /** Stops decoding, unless the underlying decoder is still in use by another. */
+    void stop() override;
+
+    [[nodiscard]] AudioFormat format() const override;
+    [[nodiscard]] bool isSeekable() const override;
+    void seek(uint64_t pos) override;
+
+    AudioBuffer readBuffer() override;
+    AudioBuffer readBuffer(size_t bytes) override;
+
+    /** Returns true if an internet stream is waiting on the network, rather than at its end. */
+    [[nodiscard]] bool isStalled() const;
+    /** Returns the title currently announced by an internet stream, if any. */
+    [[nodiscard]] QString streamTitle() const;
+
+    [[nodiscard]] Error error() const override;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
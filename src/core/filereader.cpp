@@ -0,0 +1,299 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filereader.h"
+
+#include <utils/fileutils.h>
+
+#include <QDebug>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+constexpr int64_t BlockSize       = 1024 * 1024;
+constexpr int64_t SparseBlockSize = 64 * 1024;
+// A network round trip costs far more than the extra bytes, so remote files are read in larger pieces
+constexpr int64_t RemoteSparseBlockSize = 256 * 1024;
+
+namespace {
+thread_local uint64_t bytesRead{0};
+
+uint64_t modifiedMSecs(const struct stat& info)
+{
+    return (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000)
+         + (static_cast<uint64_t>(info.st_mtim.tv_nsec) / 1000000);
+}
+} // namespace
+
+namespace Fooyin {
+struct FileReader::Private
+{
+    // A contiguous part of the file held in memory
+    struct Region
+    {
+        std::vector<std::byte> data;
+        int64_t start{0};
+        int64_t length{0};
+
+        [[nodiscard]] bool contains(int64_t offset) const
+        {
+            return offset >= start && offset < start + length;
+        }
+    };
+
+    QString filepath;
+    int fd{-1};
+    int64_t size{0};
+    int64_t pos{0};
+    uint64_t modifiedTime{0};
+    bool remote{false};
+    Access access{Access::Sequential};
+
+    // The block last read. For sparse access, the head and tail of the file are kept as well,
+    // as that's where tags are, so seeking between them and the audio doesn't read them again.
+    Region block;
+    Region head;
+    Region tail;
+
+    bool fillRegion(Region& region, int64_t start, int64_t length) const
+    {
+        region.data.resize(static_cast<size_t>(length));
+
+        int64_t filled{0};
+        while(filled < length) {
+            const auto result
+                = ::pread(fd, region.data.data() + filled, static_cast<size_t>(length - filled), start + filled);
+            if(result < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                qWarning() << "[FileReader] Read failed:" << filepath << std::strerror(errno);
+                region.length = 0;
+                return false;
+            }
+            if(result == 0) {
+                break;
+            }
+            filled += result;
+        }
+
+        region.start  = start;
+        region.length = filled;
+        bytesRead += static_cast<uint64_t>(filled);
+        return true;
+    }
+
+    // Returns the region holding @p offset, reading it first if needed
+    const Region* regionAt(int64_t offset)
+    {
+        if(access == Access::Sequential) {
+            // Short files are held in full, otherwise a block at a time
+            if(!block.contains(offset)) {
+                const bool whole    = size <= PrefetchLimit;
+                const int64_t start = whole ? 0 : offset - (offset % BlockSize);
+                if(!fillRegion(block, start, whole ? size : std::min(BlockSize, size - start))) {
+                    return nullptr;
+                }
+            }
+            return &block;
+        }
+
+        for(const Region* region : {&head, &tail, &block}) {
+            if(region->contains(offset)) {
+                return region;
+            }
+        }
+
+        const int64_t blockSize = remote ? RemoteSparseBlockSize : SparseBlockSize;
+
+        if(offset < blockSize) {
+            return fillRegion(head, 0, std::min(blockSize, size)) ? &head : nullptr;
+        }
+        if(offset >= size - blockSize) {
+            return fillRegion(tail, size - blockSize, blockSize) ? &tail : nullptr;
+        }
+
+        const int64_t start = offset - (offset % blockSize);
+        return fillRegion(block, start, std::min(blockSize, size - start)) ? &block : nullptr;
+    }
+};
+
+FileReader::FileReader()
+    : p{std::make_unique<Private>()}
+{ }
+
+FileReader::~FileReader()
+{
+    close();
+}
+
+bool FileReader::prefetch(const QString& filepath)
+{
+    const int fd = ::open(filepath.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if(::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+#if defined(POSIX_FADV_WILLNEED)
+    const auto length = std::min(static_cast<int64_t>(info.st_size), PrefetchLimit);
+    ::posix_fadvise(fd, 0, static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#endif
+
+    ::close(fd);
+    return true;
+}
+
+uint64_t FileReader::threadBytesRead()
+{
+    return bytesRead;
+}
+
+bool FileReader::open(const QString& filepath, Access access)
+{
+    close();
+
+    const int fd = ::open(filepath.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if(::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    p->filepath     = filepath;
+    p->fd           = fd;
+    p->size         = static_cast<int64_t>(info.st_size);
+    p->pos          = 0;
+    p->modifiedTime = modifiedMSecs(info);
+    p->remote       = Utils::File::isNetworkFilesystem(fd);
+    p->access       = access;
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    if(access == Access::Sequential) {
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    return true;
+}
+
+void FileReader::close()
+{
+    if(p->fd >= 0) {
+        ::close(p->fd);
+        p->fd = -1;
+    }
+
+    p->filepath.clear();
+    p->size         = 0;
+    p->pos          = 0;
+    p->modifiedTime = 0;
+    p->remote       = false;
+    p->block        = {};
+    p->head         = {};
+    p->tail         = {};
+}
+
+bool FileReader::isOpen() const
+{
+    return p->fd >= 0;
+}
+
+bool FileReader::isRemote() const
+{
+    return p->remote;
+}
+
+QString FileReader::filepath() const
+{
+    return p->filepath;
+}
+
+int64_t FileReader::size() const
+{
+    return p->size;
+}
+
+int64_t FileReader::pos() const
+{
+    return p->pos;
+}
+
+uint64_t FileReader::modifiedTime() const
+{
+    return p->modifiedTime;
+}
+
+bool FileReader::seek(int64_t pos)
+{
+    if(!isOpen() || pos < 0 || pos > p->size) {
+        return false;
+    }
+
+    p->pos = pos;
+    return true;
+}
+
+int64_t FileReader::read(std::byte* data, int64_t size)
+{
+    if(!isOpen() || size < 0) {
+        return -1;
+    }
+
+    size = std::min(size, p->size - p->pos);
+    if(size <= 0) {
+        return 0;
+    }
+
+    int64_t total{0};
+    while(total < size) {
+        const auto* region = p->regionAt(p->pos);
+        if(!region || region->length == 0) {
+            return total > 0 ? total : -1;
+        }
+
+        const int64_t offset = p->pos - region->start;
+        const int64_t count  = std::min(size - total, region->length - offset);
+        if(count <= 0) {
+            break;
+        }
+
+        std::memcpy(data + total, region->data.data() + offset, static_cast<size_t>(count));
+        total += count;
+        p->pos += count;
+    }
+
+    return total;
+}
+} // namespace Fooyin
@@ -0,0 +1,97 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * Read-only access to a local file in large aligned blocks.
+ * Used by the decoder and the tag reader, so a full pass over a file costs a handful of large reads
+ * instead of thousands of small ones.
+ * Files on network filesystems are read in larger pieces, so reading tags costs a few round trips.
+ * Files aren't memory mapped, as a file truncated while mapped (e.g. by saving its tags) raises SIGBUS on
+ * access; reads of a shrunk file just come up short.
+ * @note not thread-safe.
+ */
+class FYCORE_EXPORT FileReader
+{
+public:
+    enum class Access : uint8_t
+    {
+        // The whole file will be read front to back, e.g. when decoding
+        Sequential,
+        // Only small parts of the file will be read, e.g. when reading tags
+        Sparse,
+    };
+
+    // Files up to this size are read ahead in full when opened for sequential access
+    static constexpr int64_t PrefetchLimit = 32 * 1024 * 1024;
+
+    FileReader();
+    ~FileReader();
+
+    FileReader(const FileReader& other)            = delete;
+    FileReader& operator=(const FileReader& other) = delete;
+
+    /*!
+     * Asks the kernel to read the start of @p filepath, up to PrefetchLimit bytes, into the page cache
+     * without waiting for it, so a later open and read is served from memory.
+     * @returns false if the file could not be opened.
+     */
+    static bool prefetch(const QString& filepath);
+    /*!
+     * Returns the bytes read by every FileReader on the calling thread so far, e.g. for scan metrics.
+     * Reads are counted whether or not they were served from the page cache.
+     */
+    static uint64_t threadBytesRead();
+
+    bool open(const QString& filepath, Access access = Access::Sequential);
+    void close();
+
+    [[nodiscard]] bool isOpen() const;
+    /** Returns @c true if the file is on a network filesystem such as NFS or SMB. */
+    [[nodiscard]] bool isRemote() const;
+    [[nodiscard]] QString filepath() const;
+
+    [[nodiscard]] int64_t size() const;
+    [[nodiscard]] int64_t pos() const;
+    /** Returns the time the file was last modified in milliseconds since epoch, as read when opened. */
+    [[nodiscard]] uint64_t modifiedTime() const;
+    /** Moves to @p pos, which must be within [0, size()]. */
+    bool seek(int64_t pos);
+
+    /*!
+     * Reads up to @p size bytes into @p data.
+     * @returns the number of bytes read, which is 0 at the end of the file, or -1 on error.
+     */
+    int64_t read(std::byte* data, int64_t size);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
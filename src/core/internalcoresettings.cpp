@@ -20,9 +20,11 @@
 #include "internalcoresettings.h"
 
 #include "corepaths.h"
+#include "tagging/tagwriter.h"
 #include "version.h"
 
 #include <core/coresettings.h>
+#include <core/engine/audiobuffer.h>
 #include <utils/settings/settingsmanager.h>
 
 #include <QFileInfo>
@@ -49,6 +51,14 @@ CoreSettings::CoreSettings(SettingsManager* settingsManager)
     m_settings->createSetting<GaplessPlayback>(true, QStringLiteral("Engine/GaplessPlayback"));
     m_settings->createSetting<Language>(QStringLiteral(""), QStringLiteral("Language"));
     m_settings->createSetting<BufferLength>(4000, QStringLiteral("Engine/BufferLength"));
+    m_settings->createSetting<ReplayGainMode>(0, QStringLiteral("Engine/ReplayGainMode"));
+    m_settings->createSetting<ReplayGainPreAmp>(0.0, QStringLiteral("Engine/ReplayGainPreAmp"));
+    m_settings->createSetting<OutputSampleRate>(0, QStringLiteral("Engine/OutputSampleRate"));
+    m_settings->createSetting<ResampleQuality>(1, QStringLiteral("Engine/ResampleQuality"));
+    m_settings->createSetting<DspChain>(QStringList{}, QStringLiteral("Engine/DspChain"));
+    m_settings->createSetting<RealtimePlayback>(false, QStringLiteral("Engine/RealtimePlayback"));
+    m_settings->createSetting<BitPerfect>(false, QStringLiteral("Engine/BitPerfect"));
+    m_settings->createSetting<PerPlaylistQueue>(false, QStringLiteral("Player/PerPlaylistQueue"));
 
     m_settings->createSetting<Internal::MonitorLibraries>(true, QStringLiteral("Library/MonitorLibraries"));
     m_settings->createTempSetting<Internal::MuteVolume>(m_settings->value<OutputVolume>());
@@ -57,6 +67,19 @@ CoreSettings::CoreSettings(SettingsManager* settingsManager)
     m_settings->createSetting<Internal::EngineFading>(false, QStringLiteral("Engine/Fading"));
     m_settings->createSetting<Internal::FadingIntervals>(QVariant::fromValue(FadingIntervals{}),
                                                          QStringLiteral("Engine/FadingIntervals"));
+    m_settings->createSetting<Internal::EngineCrossfading>(false, QStringLiteral("Engine/Crossfading"));
+    m_settings->createSetting<Internal::CrossfadeCurve>(static_cast<int>(AudioBuffer::RampCurve::EqualPower),
+                                                        QStringLiteral("Engine/CrossfadeCurve"));
+    m_settings->createSetting<Internal::EqualiserGains>(QVariantList{}, QStringLiteral("Engine/EqualiserGains"));
+    m_settings->createSetting<Internal::LimiterThreshold>(-1.0, QStringLiteral("Engine/LimiterThreshold"));
+    m_settings->createSetting<Internal::LimiterRelease>(100, QStringLiteral("Engine/LimiterRelease"));
+    m_settings->createSetting<Internal::ChannelMixerMode>(0, QStringLiteral("Engine/ChannelMixerMode"));
+    m_settings->createSetting<Internal::DatabaseTuning>(true, QStringLiteral("Library/DatabaseTuning"));
+    m_settings->createSetting<Internal::TagPadding>(Tagging::DefaultTagPadding, QStringLiteral("Library/TagPadding"));
+    m_settings->createSetting<Internal::AudioFingerprints>(false, QStringLiteral("Library/AudioFingerprints"));
+    m_settings->createSetting<Internal::ExtractCovers>(false, QStringLiteral("Library/ExtractCovers"));
+    m_settings->createSetting<Internal::ScriptCache>(false, QStringLiteral("Library/ScriptCache"));
+    m_settings->createSetting<Internal::ThrottleIdleWork>(true, QStringLiteral("Library/ThrottleIdleWork"));
 
     m_settings->set<FirstRun>(!QFileInfo::exists(Core::settingsPath()));
 }
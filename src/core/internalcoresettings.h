@@ -32,6 +32,7 @@ struct FadingIntervals
     int outPauseStop{100};
     int inSeek{100};
     int outSeek{100};
+    // Crossfade lengths when changing track
     int inChange{100};
     int outChange{100};
 
@@ -68,7 +69,19 @@ enum CoreInternalSettings : uint32_t
     DisabledPlugins   = 2 | Settings::StringList,
     SavePlaybackState = 3 | Settings::Bool,
     EngineFading      = 4 | Type::Bool,
-    FadingIntervals   = 5 | Type::Variant
+    FadingIntervals   = 5 | Type::Variant,
+    EngineCrossfading = 6 | Type::Bool,
+    CrossfadeCurve    = 7 | Type::Int,
+    EqualiserGains    = 8 | Type::Variant,
+    LimiterThreshold  = 9 | Type::Double,
+    LimiterRelease    = 10 | Type::Int,
+    ChannelMixerMode  = 11 | Type::Int,
+    DatabaseTuning    = 12 | Type::Bool,
+    TagPadding        = 13 | Type::Int,
+    AudioFingerprints = 14 | Type::Bool,
+    ExtractCovers     = 15 | Type::Bool,
+    ScriptCache       = 16 | Type::Bool,
+    ThrottleIdleWork  = 17 | Type::Bool,
 };
 Q_ENUM_NS(CoreInternalSettings)
 } // namespace Settings::Core::Internal
@@ -0,0 +1,417 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "conversionjob.h"
+
+#include "engine/ffmpeg/ffmpegencoder.h"
+#include "engine/ffmpeg/ffmpegresampler.h"
+#include "engine/segmentdecoder.h"
+#include "tagging/tagreadservice.h"
+#include "tagging/tagwriter.h"
+#include "threadpriority.h"
+
+#include <core/track.h>
+#include <utils/fileutils.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// Concurrent conversions reading from a single spinning disk
+constexpr auto RotationalEncoders = 2;
+// How often a conversion held off during playback checks whether it was stopped
+constexpr auto PauseCheckInterval = 500ms;
+
+namespace {
+// Indexes of tracks converted one after another by the same encoder
+using ConversionLane = std::vector<size_t>;
+
+enum class Result : uint8_t
+{
+    Failed = 0,
+    Skipped,
+    Converted,
+};
+
+int encoderCount()
+{
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+QString sourceFile(const Fooyin::Track& track)
+{
+    return track.isInArchive() ? track.archivePath() : track.filepath();
+}
+
+std::vector<ConversionLane> groupLanes(const Fooyin::TrackList& tracks)
+{
+    // Tracks sharing a file (CUE sheets, archives) go to the same encoder, so it's read from start to end once
+    std::map<int64_t, std::map<QString, ConversionLane>> deviceFiles;
+    std::map<int64_t, bool> rotational;
+
+    for(size_t i{0}; i < tracks.size(); ++i) {
+        const QString filepath = sourceFile(tracks.at(i));
+        const auto device      = Fooyin::Utils::File::storageDevice(filepath);
+        deviceFiles[device.id][filepath].push_back(i);
+        rotational[device.id] = device.rotational;
+    }
+
+    std::vector<ConversionLane> lanes;
+
+    for(const auto& [device, files] : deviceFiles) {
+        // Encoding is bound by the CPU rather than reads, except on spinning disks which slow down seeking
+        const int encoders = rotational.at(device) ? RotationalEncoders : encoderCount();
+        const auto count   = std::min(static_cast<size_t>(encoders), files.size());
+        const size_t first = lanes.size();
+        lanes.resize(first + count);
+
+        size_t file{0};
+        for(const auto& [filepath, indexes] : files) {
+            auto& lane = lanes.at(first + (file++ % count));
+            lane.insert(lane.end(), indexes.cbegin(), indexes.cend());
+        }
+    }
+
+    return lanes;
+}
+
+QString safeFilename(QString name)
+{
+    static const QString invalid = QStringLiteral(R"(/\:*?"<>|)");
+    for(QChar& c : name) {
+        if(invalid.contains(c) || c.unicode() < 0x20) {
+            c = u'_';
+        }
+    }
+    return name.trimmed();
+}
+
+bool containsPath(const QString& dir, const QString& path)
+{
+    return path == dir || path.startsWith(dir.endsWith(u'/') ? dir : dir + u'/');
+}
+
+QString partialPath(const QString& filepath)
+{
+    const QFileInfo info{filepath};
+    return info.dir().filePath(info.completeBaseName() + QStringLiteral(".part.") + info.suffix());
+}
+} // namespace
+
+namespace Fooyin {
+struct ConversionJob::Private
+{
+    ConversionJob* self;
+
+    QThreadPool encoders;
+    std::atomic<int> tracksDone{0};
+    int tracksTotal{0};
+    std::atomic<int> lastProgress{-1};
+
+    std::mutex pauseMutex;
+    std::condition_variable pauseChanged;
+    bool playbackActive{false};
+
+    explicit Private(ConversionJob* self_)
+        : self{self_}
+    {
+        encoders.setMaxThreadCount(encoderCount());
+    }
+
+    void updateProgress()
+    {
+        const int done    = tracksDone.fetch_add(1, std::memory_order_relaxed) + 1;
+        const int percent = static_cast<int>(std::floor(static_cast<double>(done) / tracksTotal * 100));
+
+        // Emitted from the pool threads, so only report each step once
+        int last = lastProgress.load(std::memory_order_relaxed);
+        while(percent > last) {
+            if(lastProgress.compare_exchange_weak(last, percent, std::memory_order_relaxed)) {
+                emit self->progressChanged(percent);
+                break;
+            }
+        }
+    }
+
+    void waitForPlayback(const ConversionOptions& options)
+    {
+        if(!options.pauseDuringPlayback) {
+            return;
+        }
+
+        std::unique_lock lock{pauseMutex};
+        while(playbackActive && self->mayRun()) {
+            pauseChanged.wait_for(lock, PauseCheckInterval);
+        }
+    }
+
+    bool encode(const Track& track, const QString& filepath, const ConversionOptions& options) const
+    {
+        // Only covers the track's part of the file for CUE sheet tracks
+        SegmentDecoder decoder;
+        if(!decoder.init(track)) {
+            qWarning() << "[Conversion] Unable to open" << track.filepath();
+            return false;
+        }
+
+        FFmpegEncoder encoder;
+        if(!encoder.open(filepath, decoder.format(), options)) {
+            return false;
+        }
+
+        Resampler resampler;
+        if(encoder.inputFormat().sampleRate() != decoder.format().sampleRate()
+           && !resampler.init(decoder.format(), encoder.inputFormat(), ResampleQuality::High)) {
+            qWarning() << "[Conversion] Unable to resample" << track.filepath();
+            return false;
+        }
+
+        decoder.start();
+
+        while(self->mayRun()) {
+            const AudioBuffer buffer = decoder.readBuffer();
+            if(!buffer.isValid()) {
+                decoder.stop();
+                if(resampler.isInitialised()) {
+                    const AudioBuffer remaining = resampler.flush();
+                    if(remaining.isValid() && !encoder.write(remaining)) {
+                        return false;
+                    }
+                }
+                return encoder.finish();
+            }
+
+            const AudioBuffer output = resampler.isInitialised() ? resampler.process(buffer) : buffer;
+            if(output.isValid() && !encoder.write(output)) {
+                decoder.stop();
+                return false;
+            }
+        }
+
+        decoder.stop();
+        return false;
+    }
+
+    bool copyTags(const Track& track, const QString& filepath) const
+    {
+        // Written as a track covering the whole of the new file
+        Track converted{track};
+        converted.setFilePath(filepath);
+        converted.setCuePath({});
+        converted.setOffset(0);
+
+        Tagging::WriteOptions options;
+        options.frontCover = TagReadService::instance().readCover(track);
+
+        return Tagging::writeMetaData(converted, options) != Tagging::WriteResult::Failed;
+    }
+
+    Result convertTrack(const Track& track, const QString& filepath, const ConversionOptions& options) const
+    {
+        if(!options.overwrite && QFileInfo::exists(filepath)) {
+            return Result::Skipped;
+        }
+
+        if(!QDir{}.mkpath(QFileInfo{filepath}.absolutePath())) {
+            qWarning() << "[Conversion] Unable to create folder for" << filepath;
+            return Result::Failed;
+        }
+
+        // Encoded under a temporary name, so a file with the final name is always complete
+        const QString partial = partialPath(filepath);
+
+        if(!encode(track, partial, options)) {
+            QFile::remove(partial);
+            return Result::Failed;
+        }
+
+        if(options.copyTags && !copyTags(track, partial)) {
+            qWarning() << "[Conversion] Unable to copy tags to" << filepath;
+        }
+
+        if(options.overwrite) {
+            QFile::remove(filepath);
+        }
+        if(!QFile::rename(partial, filepath)) {
+            qWarning() << "[Conversion] Unable to rename" << partial << "to" << filepath;
+            QFile::remove(partial);
+            return Result::Failed;
+        }
+
+        return Result::Converted;
+    }
+};
+
+ConversionJob::ConversionJob(QObject* parent)
+    : Worker{parent}
+    , p{std::make_unique<Private>(this)}
+{ }
+
+ConversionJob::~ConversionJob() = default;
+
+void ConversionJob::stopThread()
+{
+    if(state() == Running) {
+        emit progressChanged(100);
+    }
+
+    setState(Idle);
+    p->pauseChanged.notify_all();
+}
+
+void ConversionJob::setPlaybackActive(bool active)
+{
+    {
+        const std::scoped_lock lock{p->pauseMutex};
+        p->playbackActive = active;
+    }
+    p->pauseChanged.notify_all();
+}
+
+QString ConversionJob::commonRoot(const TrackList& tracks)
+{
+    QString root;
+
+    for(const Track& track : tracks) {
+        const QString dir = track.path();
+        if(root.isNull()) {
+            root = dir;
+            continue;
+        }
+
+        while(!root.isEmpty() && !containsPath(root, dir)) {
+            const qsizetype separator = root.lastIndexOf(u'/');
+            if(separator > 0) {
+                root = root.first(separator);
+            }
+            else {
+                // Down to the filesystem root, or nothing for paths which aren't absolute
+                root = separator == 0 && root.size() > 1 ? QStringLiteral("/") : QString{};
+            }
+        }
+    }
+
+    return root;
+}
+
+QString ConversionJob::outputPath(const Track& track, const QString& root, const ConversionOptions& options)
+{
+    const QString dir      = track.path();
+    const QString relative = root.isEmpty() ? QString{} : QDir{root}.relativeFilePath(dir);
+    QString base;
+
+    if(track.hasCue()) {
+        // Each track of the sheet gets a file of its own
+        base = safeFilename(QStringLiteral("%1 - %2").arg(track.trackNumber(), 2, 10, QLatin1Char{'0'})
+                                .arg(track.title().isEmpty() ? QFileInfo{track.filepath()}.completeBaseName()
+                                                             : track.title()));
+    }
+    else if(track.isInArchive()) {
+        // Kept in a folder named after the archive, with the layout inside it
+        const QString inner = track.pathInArchive();
+        const QFileInfo innerInfo{inner};
+        const QString innerDir = innerInfo.path() == u"." ? QString{} : innerInfo.path() + u'/';
+        base = QFileInfo{track.archivePath()}.completeBaseName() + u'/' + innerDir + innerInfo.completeBaseName();
+    }
+    else {
+        base = QFileInfo{track.filepath()}.completeBaseName();
+    }
+
+    const QString name = relative.isEmpty() || relative == u"." ? base : relative + u'/' + base;
+    const QString extension = FFmpegEncoder::extension(options.codec);
+    return QDir::cleanPath(QDir{options.outputDirectory}.filePath(name) + u'.' + extension);
+}
+
+void ConversionJob::convert(const TrackList& tracks, const ConversionOptions& options)
+{
+    setState(Running);
+
+    const QString root = commonRoot(tracks);
+
+    // Tracks which would end up as the same file, e.g. two with the same name in an archive, are numbered
+    std::vector<QString> outputs;
+    outputs.reserve(tracks.size());
+    std::set<QString> taken;
+
+    for(const Track& track : tracks) {
+        const QString filepath = outputPath(track, root, options);
+        QString output{filepath};
+        const QFileInfo info{filepath};
+        for(int n{2}; taken.contains(output); ++n) {
+            const QString name = QStringLiteral("%1 (%2).%3").arg(info.completeBaseName()).arg(n).arg(info.suffix());
+            output             = info.dir().filePath(name);
+        }
+        taken.emplace(output);
+        outputs.push_back(output);
+    }
+
+    std::vector<Result> results(tracks.size(), Result::Failed);
+    std::vector<ConversionLane> lanes = groupLanes(tracks);
+
+    p->tracksDone   = 0;
+    p->lastProgress = -1;
+    p->tracksTotal  = static_cast<int>(tracks.size());
+
+    if(p->tracksTotal > 0) {
+        const auto convertLane = [this, &tracks, &outputs, &results, &options](const ConversionLane& lane) {
+            setCurrentThreadPriority(ThreadPriority::Background);
+
+            for(const size_t index : lane) {
+                p->waitForPlayback(options);
+                if(!mayRun()) {
+                    return;
+                }
+                results[index] = p->convertTrack(tracks.at(index), outputs.at(index), options);
+                p->updateProgress();
+            }
+        };
+        QtConcurrent::blockingMap(&p->encoders, lanes, convertLane);
+    }
+
+    const auto count = [&results](Result result) {
+        return std::ranges::count(results, result);
+    };
+    qInfo() << "[Conversion] Converted" << count(Result::Converted) << "tracks to" << options.outputDirectory << "("
+            << count(Result::Skipped) << "already converted," << count(Result::Failed) << "failed or stopped)";
+
+    if(mayRun()) {
+        emit progressChanged(100);
+        setState(Idle);
+    }
+
+    emit finished();
+}
+} // namespace Fooyin
+
+#include "moc_conversionjob.cpp"
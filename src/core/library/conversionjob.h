@@ -0,0 +1,69 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/library/conversionoptions.h>
+#include <core/trackfwd.h>
+#include <utils/worker.h>
+
+namespace Fooyin {
+/*!
+ * Converts a TrackList into new files, decoding, resampling and encoding several tracks at once across the cores.
+ * Tracks are grouped by the device they're read from, and spinning disks are given only a couple of readers
+ * so they don't seek back and forth between files. Encoding runs at background priority, and can be held off
+ * entirely while something is playing.
+ *
+ * Each file is written under a temporary name and only renamed once complete, so outputs which exist are always
+ * finished. Those are skipped, which lets a stopped conversion be resumed by running the same request again.
+ */
+class FYCORE_EXPORT ConversionJob : public Worker
+{
+    Q_OBJECT
+
+public:
+    explicit ConversionJob(QObject* parent = nullptr);
+    ~ConversionJob() override;
+
+    void stopThread() override;
+
+    /*!
+     * Sets whether something is playing, which holds off jobs converting with @c pauseDuringPlayback.
+     * @note this is thread-safe.
+     */
+    void setPlaybackActive(bool active);
+
+    /** Returns the deepest folder holding every track of @p tracks. */
+    static QString commonRoot(const TrackList& tracks);
+    /** Returns the file @p track is converted to with @p options, keeping its place relative to @p root. */
+    static QString outputPath(const Track& track, const QString& root, const ConversionOptions& options);
+
+signals:
+    void progressChanged(int percent);
+
+public slots:
+    void convert(const TrackList& tracks, const ConversionOptions& options);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
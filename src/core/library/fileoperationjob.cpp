@@ -0,0 +1,419 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fileoperationjob.h"
+
+#include "database/trackdatabase.h"
+
+#include <core/scripting/scriptparser.h>
+#include <core/track.h>
+#include <utils/database/dbconnectionhandler.h>
+#include <utils/database/dbconnectionprovider.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ranges>
+#include <set>
+#include <unordered_set>
+
+// Hidden files count, as they'd stop the folder being removed
+constexpr auto EmptyFilters = QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot;
+
+namespace {
+struct FileMove
+{
+    size_t index;
+    QString from;
+    QString to;
+};
+
+bool isBelow(const QString& path, const QString& dir)
+{
+    return path.size() > dir.size() && path.startsWith(dir) && (dir.endsWith(u'/') || path.at(dir.size()) == u'/');
+}
+
+QString safeName(QString name)
+{
+    static const QString invalid = QStringLiteral(R"(\:*?"<>|)");
+    for(QChar& c : name) {
+        if(invalid.contains(c) || c.unicode() < 0x20) {
+            c = u'_';
+        }
+    }
+
+    name = name.trimmed();
+    // Trailing dots are dropped by some filesystems, so the file wouldn't end up where expected
+    while(name.endsWith(u'.')) {
+        name.chop(1);
+    }
+    return name;
+}
+
+QString numberedPath(const QString& filepath, int number)
+{
+    const QFileInfo info{filepath};
+    const QString suffix = info.suffix().isEmpty() ? QString{} : u'.' + info.suffix();
+    return info.dir().filePath(QStringLiteral("%1 (%2)%3").arg(info.completeBaseName()).arg(number).arg(suffix));
+}
+
+// Returns the library holding @p filepath, or nullptr if it isn't in one
+const Fooyin::LibraryInfo* libraryAt(const QString& filepath, const Fooyin::LibraryInfoMap& libraries)
+{
+    const Fooyin::LibraryInfo* found{nullptr};
+    for(const auto& library : libraries | std::views::values) {
+        // Libraries may be nested, so take the deepest
+        if(isBelow(filepath, library.path) && (!found || library.path.size() > found->path.size())) {
+            found = &library;
+        }
+    }
+    return found;
+}
+
+bool transferFile(const QString& from, const QString& to, bool copy)
+{
+    if(!copy) {
+        // Only the directory entries change, however large the file
+        if(::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0) {
+            return true;
+        }
+        if(errno != EXDEV) {
+            qWarning() << "[FileOperation] Unable to move" << from << "to" << to << std::strerror(errno);
+            return false;
+        }
+    }
+
+    // Copied, or moved across filesystems
+    if(!QFile::copy(from, to)) {
+        qWarning() << "[FileOperation] Unable to copy" << from << "to" << to;
+        return false;
+    }
+
+    // Keep the modified time, so the library doesn't take the file as changed and read it again
+    QFile target{to};
+    if(target.open(QIODevice::ReadWrite)) {
+        target.setFileTime(QFileInfo{from}.lastModified(), QFileDevice::FileModificationTime);
+        target.close();
+    }
+
+    if(!copy && !QFile::remove(from)) {
+        qWarning() << "[FileOperation] Unable to remove" << from << "after copying it to" << to;
+        QFile::remove(to);
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+namespace Fooyin {
+struct FileOperationJob::Private
+{
+    FileOperationJob* self;
+
+    DbConnectionPoolPtr dbPool;
+    std::unique_ptr<DbConnectionHandler> dbHandler;
+    TrackDatabase trackDatabase;
+
+    int lastProgress{-1};
+
+    Private(FileOperationJob* self_, DbConnectionPoolPtr dbPool_)
+        : self{self_}
+        , dbPool{std::move(dbPool_)}
+    { }
+
+    std::vector<FileMove> plan(const TrackList& tracks, const FileOperationOptions& options,
+                               const LibraryInfoMap& libraries) const
+    {
+        ScriptParser parser;
+        const ParsedScript script = parser.parse(options.naming);
+        if(options.naming.trimmed().isEmpty() || !script.isValid()) {
+            qWarning() << "[FileOperation] Invalid naming script:" << options.naming;
+            return {};
+        }
+
+        const std::vector<QString> names = ScriptParser::evaluateEach(script, tracks);
+
+        std::vector<FileMove> moves;
+        std::unordered_set<QString> sources;
+        std::unordered_set<QString> targets;
+        int skipped{0};
+
+        for(size_t i{0}; i < tracks.size(); ++i) {
+            const Track& track = tracks.at(i);
+
+            // Sheets and archives hold several tracks, which can only move together with the file
+            if(track.hasCue() || track.isInArchive() || !sources.emplace(track.filepath()).second) {
+                ++skipped;
+                continue;
+            }
+
+            QString root = options.destination;
+            if(root.isEmpty()) {
+                const auto libraryIt = libraries.find(track.libraryId());
+                if(libraryIt == libraries.cend()) {
+                    ++skipped;
+                    continue;
+                }
+                root = libraryIt->second.path;
+            }
+
+            const QString target = targetPath(names.at(i), root, track.extension());
+            if(target.isEmpty()) {
+                ++skipped;
+                continue;
+            }
+
+            // Numbered rather than replacing another track, or a file which isn't being moved
+            QString to{target};
+            for(int n{2}; to != track.filepath() && (targets.contains(to) || QFileInfo::exists(to)); ++n) {
+                to = numberedPath(target, n);
+            }
+
+            if(to == track.filepath()) {
+                continue;
+            }
+
+            targets.emplace(to);
+            moves.emplace_back(i, track.filepath(), to);
+        }
+
+        if(skipped > 0) {
+            qInfo() << "[FileOperation] Skipped" << skipped
+                    << "tracks which are in a CUE sheet, archive or outside of a library, or have no name";
+        }
+
+        return moves;
+    }
+
+    void reportProgress(size_t done, size_t total)
+    {
+        const auto percent = static_cast<int>(done * 100 / total);
+        if(percent > lastProgress) {
+            lastProgress = percent;
+            emit self->progressChanged(percent);
+        }
+    }
+
+    static void undo(const std::vector<const FileMove*>& done, const QStringList& createdDirs, bool copy)
+    {
+        for(const FileMove* move : done | std::views::reverse) {
+            if(copy) {
+                QFile::remove(move->to);
+            }
+            else if(!transferFile(move->to, move->from, false)) {
+                qWarning() << "[FileOperation] Unable to move" << move->to << "back to" << move->from;
+            }
+        }
+
+        // Deepest first, and only if nothing else has been put in them
+        for(const QString& dir : createdDirs | std::views::reverse) {
+            QDir{}.rmdir(dir);
+        }
+    }
+
+    void removeEmptyFolders(const std::vector<FileMove>& moves, const LibraryInfoMap& libraries) const
+    {
+        std::set<QString> dirs;
+        for(const FileMove& move : moves) {
+            dirs.emplace(QFileInfo{move.from}.absolutePath());
+        }
+
+        // Children sort after their parents, so are removed first
+        for(const QString& start : dirs | std::views::reverse) {
+            const LibraryInfo* library = libraryAt(start, libraries);
+            if(!library) {
+                continue;
+            }
+
+            // Never the library folder itself
+            QString dir{start};
+            while(isBelow(dir, library->path) && QDir{dir}.isEmpty(EmptyFilters)) {
+                emit self->changingPaths({dir});
+                if(!QDir{}.rmdir(dir)) {
+                    break;
+                }
+                dir = QFileInfo{dir}.absolutePath();
+            }
+        }
+    }
+};
+
+FileOperationJob::FileOperationJob(DbConnectionPoolPtr dbPool, QObject* parent)
+    : Worker{parent}
+    , p{std::make_unique<Private>(this, std::move(dbPool))}
+{ }
+
+FileOperationJob::~FileOperationJob() = default;
+
+void FileOperationJob::initialiseThread()
+{
+    Worker::initialiseThread();
+
+    p->dbHandler = std::make_unique<DbConnectionHandler>(p->dbPool);
+    p->trackDatabase.initialise(DbConnectionProvider{p->dbPool});
+}
+
+void FileOperationJob::stopThread()
+{
+    if(state() == Running) {
+        emit progressChanged(100);
+    }
+
+    setState(Idle);
+}
+
+QString FileOperationJob::targetPath(const QString& name, const QString& root, const QString& extension)
+{
+    QStringList parts;
+    for(const QString& part : name.split(u'/', Qt::SkipEmptyParts)) {
+        // Dots are trimmed from the end, so this also drops "." and "..", which would lead out of the root
+        const QString safe = safeName(part);
+        if(!safe.isEmpty()) {
+            parts.push_back(safe);
+        }
+    }
+
+    if(parts.empty()) {
+        return {};
+    }
+
+    QString path = QDir::cleanPath(root + u'/' + parts.join(u'/'));
+    if(!extension.isEmpty()) {
+        path += u'.' + extension;
+    }
+    return path;
+}
+
+void FileOperationJob::run(const TrackList& tracks, const FileOperationOptions& options,
+                           const LibraryInfoMap& libraries)
+{
+    setState(Running);
+
+    p->lastProgress = -1;
+
+    const bool copy                   = options.type == FileOperationOptions::Type::Copy;
+    const std::vector<FileMove> moves = p->plan(tracks, options, libraries);
+
+    // Folders which don't exist yet, parents first
+    QStringList createdDirs;
+    std::unordered_set<QString> missingDirs;
+    for(const FileMove& move : moves) {
+        QStringList missing;
+        QString dir = QFileInfo{move.to}.absolutePath();
+        while(!QFileInfo::exists(dir) && !missingDirs.contains(dir)) {
+            missing.prepend(dir);
+            dir = QFileInfo{dir}.absolutePath();
+        }
+        for(const QString& dir : missing) {
+            missingDirs.emplace(dir);
+            createdDirs.push_back(dir);
+        }
+    }
+
+    // Copies are new files, which the library should find as it would any other
+    if(!copy && !moves.empty()) {
+        QStringList paths{createdDirs};
+        for(const FileMove& move : moves) {
+            paths.push_back(move.from);
+            paths.push_back(move.to);
+        }
+        emit changingPaths(paths);
+    }
+
+    std::vector<const FileMove*> done;
+    done.reserve(moves.size());
+    bool succeeded{true};
+
+    for(const FileMove& move : moves) {
+        if(!mayRun()) {
+            succeeded = false;
+            break;
+        }
+
+        if(!QDir{}.mkpath(QFileInfo{move.to}.absolutePath())) {
+            qWarning() << "[FileOperation] Unable to create folder for" << move.to;
+            succeeded = false;
+            break;
+        }
+        // Another file may have been put there since the paths were chosen
+        if(QFileInfo::exists(move.to) || !transferFile(move.from, move.to, copy)) {
+            succeeded = false;
+            break;
+        }
+
+        done.push_back(&move);
+        p->reportProgress(done.size(), moves.size());
+    }
+
+    TrackList moved;
+
+    if(succeeded && !copy) {
+        for(const FileMove& move : moves) {
+            Track track = tracks.at(move.index);
+            track.setFilePath(move.to);
+
+            if(const LibraryInfo* library = libraryAt(move.to, libraries)) {
+                track.setLibraryId(library->id);
+                track.setRelativePath(QDir{library->path}.relativeFilePath(move.to));
+            }
+            else {
+                track.setLibraryId(-1);
+                track.setRelativePath({});
+            }
+            moved.push_back(track);
+        }
+
+        if(!p->trackDatabase.updateTrackPaths(moved)) {
+            qWarning() << "[FileOperation] Unable to update the paths of" << moved.size() << "tracks";
+            moved.clear();
+            succeeded = false;
+        }
+    }
+
+    if(succeeded) {
+        if(!copy && options.removeEmptyFolders) {
+            p->removeEmptyFolders(moves, libraries);
+        }
+        qInfo() << "[FileOperation]" << (copy ? "Copied" : "Moved") << moves.size() << "files";
+    }
+    else {
+        qWarning() << "[FileOperation] Undoing" << done.size() << "of" << moves.size() << "files";
+        Private::undo(done, createdDirs, copy);
+    }
+
+    if(!moved.empty()) {
+        emit movedTracks(moved);
+    }
+
+    if(mayRun()) {
+        emit progressChanged(100);
+        setState(Idle);
+    }
+
+    emit finished();
+}
+} // namespace Fooyin
+
+#include "moc_fileoperationjob.cpp"
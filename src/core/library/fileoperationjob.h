@@ -0,0 +1,75 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include "library/libraryinfo.h"
+
+#include <core/library/fileoperationoptions.h>
+#include <core/trackfwd.h>
+#include <utils/database/dbconnectionpool.h>
+#include <utils/worker.h>
+
+namespace Fooyin {
+/*!
+ * Renames, moves or copies the files of a TrackList to paths given by a naming script, as a single transaction.
+ *
+ * Every new path is worked out before any file is touched, evaluating the script in parallel. Moves within a
+ * filesystem are plain renames and only fall back to copying across filesystems. Moved tracks are then updated
+ * in the database in one transaction. If a file can't be moved, the transaction fails or the job is stopped,
+ * everything done so far is undone, so the files and database never disagree.
+ *
+ * The paths about to change are reported through changingPaths first, so the library watchers can ignore the
+ * events they cause rather than scanning the files again.
+ */
+class FYCORE_EXPORT FileOperationJob : public Worker
+{
+    Q_OBJECT
+
+public:
+    explicit FileOperationJob(DbConnectionPoolPtr dbPool, QObject* parent = nullptr);
+    ~FileOperationJob() override;
+
+    void initialiseThread() override;
+    void stopThread() override;
+
+    /*!
+     * Returns the path for a track with extension @p extension from @p name, the result of the naming script.
+     * Each folder of @p name is made safe to use as a filename, and the path is kept below @p root.
+     * @returns an empty string if nothing is left of @p name.
+     */
+    static QString targetPath(const QString& name, const QString& root, const QString& extension);
+
+signals:
+    void progressChanged(int percent);
+    /** Emitted with files and folders before they're created, moved or removed. */
+    void changingPaths(const QStringList& paths);
+    /** Emitted once per job with the moved tracks, after they've been updated in the database. */
+    void movedTracks(const TrackList& tracks);
+
+public slots:
+    void run(const TrackList& tracks, const FileOperationOptions& options, const LibraryInfoMap& libraries);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,145 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fingerprintindex.h"
+
+#include <numeric>
+#include <ranges>
+
+namespace Fooyin {
+void FingerprintIndex::add(const Track& track, AudioFingerprint fingerprint)
+{
+    if(fingerprint.empty()) {
+        return;
+    }
+
+    m_entries.emplace(track.duration(), Entry{track, std::move(fingerprint)});
+}
+
+void FingerprintIndex::remove(const Track& track)
+{
+    auto [it, end] = m_entries.equal_range(track.duration());
+    for(; it != end; ++it) {
+        if(it->second.track.id() == track.id()) {
+            m_entries.erase(it);
+            return;
+        }
+    }
+}
+
+bool FingerprintIndex::empty() const
+{
+    return m_entries.empty();
+}
+
+size_t FingerprintIndex::size() const
+{
+    return m_entries.size();
+}
+
+Track FingerprintIndex::match(uint64_t duration, const AudioFingerprint& fingerprint) const
+{
+    const auto it = closest(duration, fingerprint);
+    return it != m_entries.cend() ? it->second.track : Track{};
+}
+
+Track FingerprintIndex::take(uint64_t duration, const AudioFingerprint& fingerprint)
+{
+    const auto it = closest(duration, fingerprint);
+    if(it == m_entries.cend()) {
+        return {};
+    }
+
+    Track track = it->second.track;
+    m_entries.erase(it);
+    return track;
+}
+
+std::vector<TrackList> FingerprintIndex::duplicates() const
+{
+    std::vector<const Entry*> entries;
+    entries.reserve(m_entries.size());
+    for(const auto& [duration, entry] : m_entries) {
+        entries.push_back(&entry);
+    }
+
+    // Union-find over matching pairs, so a group holds every track reachable through a match
+    std::vector<size_t> parents(entries.size());
+    std::iota(parents.begin(), parents.end(), 0);
+
+    auto root = [&parents](size_t index) {
+        while(parents[index] != index) {
+            parents[index] = parents[parents[index]];
+            index          = parents[index];
+        }
+        return index;
+    };
+
+    size_t index{0};
+    for(auto it = m_entries.cbegin(); it != m_entries.cend(); ++it, ++index) {
+        const uint64_t maxDuration = it->first + DurationTolerance;
+
+        // Entries are in order of duration, so only those after this one within the tolerance need checking
+        size_t other{index + 1};
+        for(auto next = std::next(it); next != m_entries.cend() && next->first <= maxDuration; ++next, ++other) {
+            if(AudioFingerprinter::distance(it->second.fingerprint, next->second.fingerprint) < MatchThreshold) {
+                parents[root(other)] = root(index);
+            }
+        }
+    }
+
+    std::map<size_t, TrackList> groups;
+    for(size_t i{0}; i < entries.size(); ++i) {
+        groups[root(i)].push_back(entries.at(i)->track);
+    }
+
+    std::vector<TrackList> result;
+    for(auto& group : groups | std::views::values) {
+        if(group.size() > 1) {
+            result.push_back(std::move(group));
+        }
+    }
+
+    return result;
+}
+
+FingerprintIndex::EntryMap::const_iterator FingerprintIndex::closest(uint64_t duration,
+                                                                     const AudioFingerprint& fingerprint) const
+{
+    if(fingerprint.empty()) {
+        return m_entries.cend();
+    }
+
+    const uint64_t minDuration = duration > DurationTolerance ? duration - DurationTolerance : 0;
+    const uint64_t maxDuration = duration + DurationTolerance;
+
+    auto best = m_entries.cend();
+    double bestDistance{MatchThreshold};
+
+    for(auto it = m_entries.lower_bound(minDuration); it != m_entries.cend() && it->first <= maxDuration; ++it) {
+        const double distance = AudioFingerprinter::distance(fingerprint, it->second.fingerprint);
+        if(distance < bestDistance) {
+            bestDistance = distance;
+            best         = it;
+        }
+    }
+
+    return best;
+}
+} // namespace Fooyin
@@ -0,0 +1,73 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include "engine/audiofingerprint.h"
+
+#include <core/track.h>
+
+#include <map>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Finds tracks with the same audio as another by their acoustic fingerprints.
+ * Tracks are kept in order of duration, so a lookup only compares the fingerprints of tracks of
+ * about the same length, which is O(log n) for a library of varied tracks.
+ */
+class FYCORE_EXPORT FingerprintIndex
+{
+public:
+    // Copies of a recording can differ in length, e.g. from encoder delay and padding
+    static constexpr uint64_t DurationTolerance = 2000;
+    // Bit error rate below which two fingerprints are treated as the same recording
+    static constexpr double MatchThreshold = 0.3;
+
+    /** Adds @p track with @p fingerprint. Tracks with an empty fingerprint are ignored. */
+    void add(const Track& track, AudioFingerprint fingerprint);
+    /** Removes the track with the id of @p track, if present. */
+    void remove(const Track& track);
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+
+    /** Returns the closest track to one with @p duration and @p fingerprint, or an invalid track if none match. */
+    [[nodiscard]] Track match(uint64_t duration, const AudioFingerprint& fingerprint) const;
+    /** As @fn match, but also removes the matched track so it can't be matched again. */
+    Track take(uint64_t duration, const AudioFingerprint& fingerprint);
+
+    /** Returns each group of two or more tracks which match one another, e.g. for finding duplicates. */
+    [[nodiscard]] std::vector<TrackList> duplicates() const;
+
+private:
+    struct Entry
+    {
+        Track track;
+        AudioFingerprint fingerprint;
+    };
+    using EntryMap = std::multimap<uint64_t, Entry>;
+
+    [[nodiscard]] EntryMap::const_iterator closest(uint64_t duration, const AudioFingerprint& fingerprint) const;
+
+    EntryMap m_entries;
+};
+} // namespace Fooyin
@@ -0,0 +1,293 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <core/library/groupingcache.h>
+
+#include "database/scriptcachedatabase.h"
+
+#include <core/scripting/scriptparser.h>
+#include <core/scripting/scriptregistry.h>
+#include <core/track.h>
+#include <utils/async.h>
+#include <utils/database/dbconnectionhandler.h>
+#include <utils/database/dbconnectionprovider.h>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+// Scripts which haven't been used for the longest are dropped beyond this
+constexpr size_t MaxScripts = 16;
+// Persisted values of scripts which haven't been used for this long are removed
+constexpr int UnusedScriptDays = 28;
+
+namespace {
+struct CachedValues
+{
+    // The track the values were evaluated for, to tell if it has changed since
+    Fooyin::Track track;
+    QStringList values;
+};
+
+struct ScriptValues
+{
+    // Held while evaluating, so concurrent requests for the script wait rather than repeating the work
+    std::mutex evaluateMutex;
+
+    bool parsed{false};
+    Fooyin::ParsedScript script;
+    // Set once parsed, guarded by the cache's mutex rather than evaluateMutex
+    bool readsStats{true};
+    // Whether the values only depend on the track's file, so can be kept on disk
+    bool persistent{false};
+    uint64_t hash{0};
+
+    std::unordered_map<int, CachedValues> values;
+    uint64_t lastUsed{0};
+
+    // Values read from the persistent store, moved to values as they're used
+    bool loaded{false};
+    Fooyin::ScriptCacheDatabase::ValueMap stored;
+};
+
+// Runs @p func on another thread with the script cache database of @p pool
+template <typename Func>
+void withStore(const std::shared_ptr<Fooyin::DbConnectionPool>& pool, Func func)
+{
+    Fooyin::Utils::asyncExec([pool, func = std::move(func)]() {
+        const Fooyin::DbConnectionHandler dbHandler{pool};
+        Fooyin::ScriptCacheDatabase cacheDb;
+        cacheDb.initialise(Fooyin::DbConnectionProvider{pool});
+        func(cacheDb);
+    });
+}
+} // namespace
+
+namespace Fooyin {
+struct GroupingCache::Private
+{
+    // Only read from while evaluating
+    ScriptRegistry registry;
+
+    // Guards scripts, the values of each and their usage
+    mutable std::mutex mutex;
+    std::unordered_map<QString, std::shared_ptr<ScriptValues>> scripts;
+    uint64_t usage{0};
+    std::shared_ptr<DbConnectionPool> store;
+
+    std::shared_ptr<ScriptValues> entry(const QString& script)
+    {
+        const std::scoped_lock lock{mutex};
+
+        auto& values = scripts[script];
+        if(!values) {
+            values = std::make_shared<ScriptValues>();
+            removeLeastUsed();
+        }
+        values->lastUsed = ++usage;
+
+        return values;
+    }
+
+    void removeLeastUsed()
+    {
+        while(scripts.size() > MaxScripts) {
+            const auto leastUsed = std::ranges::min_element(
+                scripts, [](const auto& lhs, const auto& rhs) { return lhs.second->lastUsed < rhs.second->lastUsed; });
+            scripts.erase(leastUsed);
+        }
+    }
+};
+
+GroupingCache::GroupingCache()
+    : p{std::make_unique<Private>()}
+{ }
+
+GroupingCache::~GroupingCache() = default;
+
+std::vector<QStringList> GroupingCache::values(const QString& script, const TrackList& tracks) const
+{
+    const auto entry = p->entry(script);
+
+    const std::scoped_lock evaluateLock{entry->evaluateMutex};
+
+    if(!entry->parsed) {
+        ScriptParser parser{&p->registry};
+        entry->script = parser.parse(script);
+        entry->parsed = true;
+
+        const auto& dependencies = entry->script.dependencies;
+        const bool readsStats    = dependencies.dependsOnStats();
+
+        const std::scoped_lock lock{p->mutex};
+        entry->readsStats = readsStats;
+        entry->persistent = entry->script.isValid() && !dependencies.playback && !dependencies.context && !readsStats;
+        entry->hash       = ScriptCacheDatabase::scriptHash(script);
+    }
+
+    std::shared_ptr<DbConnectionPool> store;
+    bool load{false};
+    {
+        const std::scoped_lock lock{p->mutex};
+        if(entry->persistent) {
+            store = p->store;
+            load  = store && !entry->loaded;
+        }
+    }
+
+    if(load) {
+        // Read once per script, on the thread waiting for the values
+        const DbConnectionHandler dbHandler{store};
+        ScriptCacheDatabase cacheDb;
+        cacheDb.initialise(DbConnectionProvider{store});
+        auto stored = cacheDb.loadValues(entry->hash);
+
+        const std::scoped_lock lock{p->mutex};
+        entry->stored = std::move(stored);
+        entry->loaded = true;
+    }
+
+    std::vector<QStringList> result(tracks.size());
+    TrackList missingTracks;
+    std::vector<size_t> missingRows;
+
+    {
+        const std::scoped_lock lock{p->mutex};
+
+        for(size_t i{0}; i < tracks.size(); ++i) {
+            const Track& track = tracks.at(i);
+
+            const auto cached = entry->values.find(track.id());
+            if(cached != entry->values.cend() && cached->second.track.isSharedWith(track)) {
+                result[i] = cached->second.values;
+                continue;
+            }
+
+            const auto stored = entry->stored.find(track.id());
+            if(stored != entry->stored.end() && stored->second.modifiedTime == track.modifiedTime()) {
+                result[i] = stored->second.values;
+                entry->values.insert_or_assign(track.id(), CachedValues{track, std::move(stored->second.values)});
+                entry->stored.erase(stored);
+            }
+            else {
+                missingTracks.push_back(track);
+                missingRows.push_back(i);
+            }
+        }
+    }
+
+    if(missingTracks.empty()) {
+        return result;
+    }
+
+    std::vector<QStringList> evaluated = ScriptParser::evaluateEachValues(entry->script, missingTracks, &p->registry);
+
+    ScriptCacheDatabase::ValueMap toStore;
+
+    const std::scoped_lock lock{p->mutex};
+
+    for(size_t i{0}; i < missingTracks.size(); ++i) {
+        const Track& track = missingTracks.at(i);
+        result[missingRows.at(i)] = evaluated.at(i);
+        if(store && track.isInDatabase()) {
+            toStore.emplace(track.id(), ScriptCacheDatabase::StoredValues{track.modifiedTime(), evaluated.at(i)});
+        }
+        entry->values.insert_or_assign(track.id(), CachedValues{track, std::move(evaluated[i])});
+    }
+
+    if(!toStore.empty()) {
+        withStore(store, [hash = entry->hash, values = std::move(toStore)](const ScriptCacheDatabase& cacheDb) {
+            cacheDb.storeValues(hash, values);
+        });
+    }
+
+    return result;
+}
+
+void GroupingCache::setPersistentStore(std::shared_ptr<DbConnectionPool> pool)
+{
+    const std::scoped_lock lock{p->mutex};
+
+    p->store = std::move(pool);
+
+    // Read again from the new store when next used
+    for(auto& [_, entry] : p->scripts) {
+        entry->loaded = false;
+        entry->stored.clear();
+    }
+
+    if(p->store) {
+        withStore(p->store, [](const ScriptCacheDatabase& cacheDb) {
+            cacheDb.initialiseDatabase();
+            cacheDb.removeUnusedScripts(UnusedScriptDays);
+        });
+    }
+}
+
+void GroupingCache::invalidate(const TrackList& tracks)
+{
+    const std::scoped_lock lock{p->mutex};
+
+    for(auto& [_, entry] : p->scripts) {
+        for(const Track& track : tracks) {
+            entry->values.erase(track.id());
+            entry->stored.erase(track.id());
+        }
+    }
+
+    if(p->store) {
+        std::vector<int> trackIds;
+        for(const Track& track : tracks) {
+            if(track.isInDatabase()) {
+                trackIds.push_back(track.id());
+            }
+        }
+        withStore(p->store, [trackIds = std::move(trackIds)](const ScriptCacheDatabase& cacheDb) {
+            cacheDb.removeTracks(trackIds);
+        });
+    }
+}
+
+void GroupingCache::invalidateStats(const TrackList& tracks)
+{
+    const std::scoped_lock lock{p->mutex};
+
+    for(auto& [_, entry] : p->scripts) {
+        if(!entry->readsStats) {
+            continue;
+        }
+        for(const Track& track : tracks) {
+            entry->values.erase(track.id());
+        }
+    }
+}
+
+void GroupingCache::clear()
+{
+    const std::scoped_lock lock{p->mutex};
+    p->scripts.clear();
+}
+
+int GroupingCache::scriptCount() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return static_cast<int>(p->scripts.size());
+}
+} // namespace Fooyin
@@ -0,0 +1,108 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <core/library/librarydelta.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace Fooyin {
+LibraryDelta LibraryDelta::removal(int libraryId, TrackIds removedIds)
+{
+    LibraryDelta delta;
+    delta.type       = Type::Removed;
+    delta.libraryId  = libraryId;
+    delta.removedIds = std::move(removedIds);
+    std::ranges::sort(delta.removedIds);
+    return delta;
+}
+
+LibraryDelta LibraryDelta::relocation(int libraryId, const QString& oldPath, const QString& newPath)
+{
+    LibraryDelta delta;
+    delta.type      = Type::Relocated;
+    delta.libraryId = libraryId;
+    delta.oldPath   = oldPath;
+    delta.newPath   = newPath;
+    return delta;
+}
+
+bool LibraryDelta::affects(const Track& track) const
+{
+    return libraryId >= 0 && track.libraryId() == libraryId;
+}
+
+bool LibraryDelta::removes(const Track& track) const
+{
+    return affects(track) && std::ranges::binary_search(removedIds, track.id());
+}
+
+bool LibraryDelta::apply(Track& track) const
+{
+    if(!affects(track)) {
+        return false;
+    }
+
+    switch(type) {
+        case(Type::Removed):
+            track.setLibraryId(-1);
+            return true;
+        case(Type::Relocated): {
+            const QString filepath = track.isInArchive()
+                                       ? Track::archiveFilepath(relocatedPath(track.archivePath()),
+                                                                track.pathInArchive())
+                                       : relocatedPath(track.filepath());
+            const QString cuePath = relocatedPath(track.cuePath());
+            if(filepath == track.filepath() && cuePath == track.cuePath()) {
+                return false;
+            }
+
+            track.setFilePath(filepath);
+            track.setCuePath(cuePath);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QString LibraryDelta::relocatedPath(const QString& path) const
+{
+    if(oldPath.isEmpty() || path.size() <= oldPath.size() || !path.startsWith(oldPath)) {
+        return path;
+    }
+
+    // Only whole directories match, so /music doesn't take /music2 along with it
+    const bool rootEndsPath = oldPath.endsWith(u'/');
+    if(!rootEndsPath && path.at(oldPath.size()) != u'/') {
+        return path;
+    }
+
+    QString root = newPath;
+    if(rootEndsPath && !root.endsWith(u'/')) {
+        root += u'/';
+    }
+    else if(!rootEndsPath && root.endsWith(u'/')) {
+        root.chop(1);
+    }
+
+    return root + path.sliced(oldPath.size());
+}
+} // namespace Fooyin
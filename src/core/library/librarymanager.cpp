@@ -27,6 +27,7 @@
 #include <utils/database/dbconnectionprovider.h>
 #include <utils/fileutils.h>
 #include <utils/helpers.h>
+#include <utils/metrics.h>
 
 #include <utility>
 
@@ -38,8 +39,8 @@ bool checkNewPath(const QString& path, const LibraryInfoMap& libraries, int libr
     }
 
     return std::ranges::all_of(std::as_const(libraries), [libraryId, path](const auto& info) {
-        return (info.second.id != libraryId && !Utils::File::isSamePath(info.second.path, path)
-                && !Utils::File::isSubdir(path, info.second.path));
+        return info.second.id == libraryId
+            || (!Utils::File::isSamePath(info.second.path, path) && !Utils::File::isSubdir(path, info.second.path));
     });
 }
 
@@ -57,6 +58,7 @@ struct LibraryManager::Private
     LibraryDatabase libraryConnector;
     TrackDatabase trackConnector;
     LibraryInfoMap libraries;
+    std::optional<ScanMetrics> lastScanMetrics;
 
     explicit Private(DbConnectionPoolPtr dbPool_, SettingsManager* settings_)
         : dbPool{std::move(dbPool_)}
@@ -149,6 +151,28 @@ bool LibraryManager::renameLibrary(int id, const QString& name)
     return false;
 }
 
+bool LibraryManager::relocateLibrary(int id, const QString& path)
+{
+    if(!hasLibrary(id) || !checkNewPath(path, p->libraries, id)) {
+        return false;
+    }
+
+    LibraryInfo& info     = p->libraries.at(id);
+    const QString oldPath = info.path;
+    if(oldPath == path) {
+        return false;
+    }
+
+    if(!p->trackConnector.relocateLibraryTracks(id, oldPath, path)
+       || !p->libraryConnector.relocateLibrary(id, oldPath, path)) {
+        return false;
+    }
+
+    info.path = path;
+    emit libraryRelocated(info, oldPath);
+    return true;
+}
+
 void LibraryManager::updateLibraryStatus(const LibraryInfo& library)
 {
     if(!hasLibrary(library.id)) {
@@ -158,6 +182,27 @@ void LibraryManager::updateLibraryStatus(const LibraryInfo& library)
     emit libraryStatusChanged(library);
 }
 
+void LibraryManager::updateScanMetrics(const ScanMetrics& metrics)
+{
+    if(!hasLibrary(metrics.libraryId)) {
+        return;
+    }
+
+    static auto& scans  = Metrics::histogram("fooyin_scan_seconds", "Time taken to scan a library");
+    static auto& files  = Metrics::counter("fooyin_scan_files", "Files found by library scans");
+    static auto& tracks = Metrics::counter("fooyin_scan_tracks", "Tracks read by library scans");
+    static auto& bytes  = Metrics::counter("fooyin_scan_read_bytes", "Bytes read from files by library scans");
+    static auto& errors = Metrics::counter("fooyin_scan_errors", "Files library scans failed to read");
+    scans.record(metrics.elapsed);
+    files.add(metrics.filesDiscovered);
+    tracks.add(metrics.tracksRead);
+    bytes.add(metrics.bytesRead);
+    errors.add(metrics.errorCount());
+
+    p->lastScanMetrics = metrics;
+    emit scanMetricsChanged(metrics);
+}
+
 bool LibraryManager::hasLibrary() const
 {
     return !p->libraries.empty();
@@ -185,6 +230,11 @@ std::optional<LibraryInfo> LibraryManager::libraryInfo(int id) const
     }
     return {};
 }
+
+std::optional<ScanMetrics> LibraryManager::lastScanMetrics() const
+{
+    return p->lastScanMetrics;
+}
 } // namespace Fooyin
 
 #include "moc_librarymanager.cpp"
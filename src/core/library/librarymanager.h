@@ -22,6 +22,7 @@
 #include "fycore_export.h"
 
 #include "libraryinfo.h"
+#include "scanmetrics.h"
 
 #include <utils/database/dbconnectionpool.h>
 
@@ -47,20 +48,30 @@ public:
     int addLibrary(const QString& path, const QString& name);
     bool removeLibrary(int id);
     bool renameLibrary(int id, const QString& name);
+    /*!
+     * Moves library @p id to @p path, e.g. after its files were copied to a new drive, keeping its tracks
+     * as they are rather than scanning them again.
+     */
+    bool relocateLibrary(int id, const QString& path);
     void updateLibraryStatus(const LibraryInfo& library);
+    void updateScanMetrics(const ScanMetrics& metrics);
 
     [[nodiscard]] bool hasLibrary() const;
     [[nodiscard]] bool hasLibrary(int id) const;
 
     [[nodiscard]] std::optional<LibraryInfo> findLibraryByPath(const QString& path) const;
     [[nodiscard]] std::optional<LibraryInfo> libraryInfo(int id) const;
+    /** Returns the metrics of the most recently finished scan of any library, if there has been one. */
+    [[nodiscard]] std::optional<ScanMetrics> lastScanMetrics() const;
 
 signals:
     void libraryAdded(const LibraryInfo& library);
     void removingLibraryTracks(int id);
     void libraryRemoved(int id, const std::set<int> tracksRemoved);
     void libraryRenamed(int id, const QString& name);
+    void libraryRelocated(const Fooyin::LibraryInfo& library, const QString& oldPath);
     void libraryStatusChanged(const LibraryInfo& info);
+    void scanMetricsChanged(const Fooyin::ScanMetrics& metrics);
 
 private:
     struct Private;
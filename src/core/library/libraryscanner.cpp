@@ -19,30 +19,60 @@
 
 #include "libraryscanner.h"
 
+#include "archive/archivereader.h"
 #include "database/database.h"
+#include "database/librarydatabase.h"
 #include "database/trackdatabase.h"
+#include "filereader.h"
 #include "internalcoresettings.h"
+#include "library/fingerprintindex.h"
 #include "library/libraryinfo.h"
-#include "librarywatcher.h"
+#include "library/scanmetrics.h"
+#include "tagging/cueparser.h"
+#include "tagging/embeddedcoverstore.h"
 #include "tagging/tagreader.h"
+#include "threadpriority.h"
 
 #include <core/track.h>
+#include <utils/boundedqueue.h>
+#include <utils/crossthreadstats.h>
 #include <utils/fileutils.h>
 #include <utils/settings/settingsmanager.h>
+#include <utils/taskscheduler.h>
+#include <utils/tracing.h>
 
+#include <QDateTime>
 #include <QDir>
-#include <QFileSystemWatcher>
-
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 
 constexpr auto BatchSize = 250;
+// Tag reading is mostly waiting on I/O, so a few readers help even on small machines
+constexpr auto MinReaders = 2;
+constexpr auto MaxReaders = 8;
+// Files held between each stage of a scan
+constexpr auto QueueSize = 512;
+// Results taken by the storing thread at once, most of which are unchanged files needing little work
+constexpr auto ResultBatchSize = 64;
+// Tracks given an accurate duration between each check for other work, as each reads its whole file
+constexpr auto DurationBatchSize = 8;
 
 namespace {
-Fooyin::Track matchMissingTrack(const Fooyin::TrackFieldMap& missingFiles, const Fooyin::TrackFieldMap& missingHashes,
+Fooyin::Track matchMissingTrack(const Fooyin::TrackFieldMap& missingFiles, const Fooyin::TrackHashMap& missingHashes,
                                 Fooyin::Track& track)
 {
     const QString filename = track.filename();
-    const QString hash     = track.hash();
+    const uint64_t hash    = track.hash();
 
     if(missingFiles.contains(filename) && missingFiles.at(filename).duration() == track.duration()) {
         return missingFiles.at(filename);
@@ -54,6 +84,160 @@ Fooyin::Track matchMissingTrack(const Fooyin::TrackFieldMap& missingFiles, const
 
     return {};
 };
+
+void recordScanUpdate(const Fooyin::ScanResult& result)
+{
+    Fooyin::CrossThreadStats::recordCopy("LibraryScanner::scanUpdate", result.addedTracks);
+    Fooyin::CrossThreadStats::recordCopy("LibraryScanner::scanUpdate", result.updatedTracks);
+}
+
+struct ScanJob
+{
+    enum class Type : uint8_t
+    {
+        // Already in the library and unmodified, so there's nothing to read
+        Unchanged,
+        Existing,
+        New,
+        // A CUE sheet, with track holding the sheet itself
+        Cue,
+        // An archive, with track holding the archive itself
+        Archive,
+    };
+
+    Type type;
+    Fooyin::Track track;
+    bool read{false};
+    // The duration read is only an estimate, so is worked out exactly once the scan is over
+    bool estimatedDuration{false};
+    // Tracks of a CUE sheet or archive
+    Fooyin::TrackList tracks;
+};
+
+int readerCount(const QString& path)
+{
+    const auto device = Fooyin::Utils::File::storageDevice(path);
+    // More readers on a spinning disk only make it seek between their files
+    if(device.rotational) {
+        return MinReaders;
+    }
+    // Reads of a network share spend nearly all their time waiting on round trips, not the CPU
+    if(device.network) {
+        return MaxReaders;
+    }
+    return std::clamp(static_cast<int>(std::thread::hardware_concurrency()), MinReaders, MaxReaders);
+}
+
+QString parentPath(const QString& filepath)
+{
+    return filepath.left(filepath.lastIndexOf(u'/'));
+}
+
+bool isBelow(const QString& filepath, const QString& dir)
+{
+    return filepath.size() > dir.size() && filepath.startsWith(dir) && filepath.at(dir.size()) == u'/';
+}
+
+bool isCueSheet(const QString& filepath)
+{
+    return filepath.endsWith(QLatin1String(".cue"), Qt::CaseInsensitive);
+}
+
+// Tracks of a CUE sheet belong to the directory of the sheet, and those of an archive to that of the archive
+QString trackLocation(const Fooyin::Track& track)
+{
+    if(track.hasCue()) {
+        return track.cuePath();
+    }
+    if(track.isInArchive()) {
+        return track.archivePath();
+    }
+    return track.filepath();
+}
+
+// Several tracks share the file of a CUE sheet or archive, so they can't be matched up by filename or hash
+bool sharesFile(const Fooyin::Track& track)
+{
+    return track.hasCue() || track.isInArchive();
+}
+
+// Archived tracks are placed below their archive, as if it were a directory
+QString relativeTrackPath(const QDir& dir, const Fooyin::Track& track)
+{
+    if(track.isInArchive()) {
+        return dir.relativeFilePath(track.archivePath()) + u'/' + track.pathInArchive();
+    }
+    return dir.relativeFilePath(track.filepath());
+}
+
+/*!
+ * Reads tracks, storing the embedded front cover of each album in the EmbeddedCoverStore along the way.
+ * An album's cover is only taken from the first of its files read during a scan which holds one.
+ * @note thread-safe.
+ */
+class CoverExtractor
+{
+public:
+    explicit CoverExtractor(bool enabled)
+        : m_enabled{enabled}
+    { }
+
+    bool readMetaData(Fooyin::Track& track)
+    {
+        if(!m_enabled) {
+            return Fooyin::Tagging::readMetaData(track);
+        }
+
+        bool claimed{false};
+        QByteArray cover;
+
+        const bool read = Fooyin::Tagging::readMetaData(track, cover, [this, &claimed](const Fooyin::Track& readTrack) {
+            claimed = claim(readTrack.albumHash());
+            return claimed;
+        });
+
+        // Storing an empty cover drops the one this file used to hold
+        if(read && claimed && (!Fooyin::EmbeddedCoverStore::instance().store(track, cover) || cover.isEmpty())) {
+            // Let another file of the album provide it
+            release(track.albumHash());
+        }
+
+        return read;
+    }
+
+private:
+    bool claim(const QString& albumHash)
+    {
+        const std::scoped_lock lock{m_mutex};
+        return m_albums.emplace(albumHash).second;
+    }
+
+    void release(const QString& albumHash)
+    {
+        const std::scoped_lock lock{m_mutex};
+        m_albums.erase(albumHash);
+    }
+
+    bool m_enabled;
+    std::mutex m_mutex;
+    std::unordered_set<QString> m_albums;
+};
+
+uint64_t microsSince(std::chrono::steady_clock::time_point start)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+std::optional<uint64_t> fileModifiedTime(const QString& filepath)
+{
+    const QFileInfo info{filepath};
+    if(!info.exists()) {
+        return {};
+    }
+    const QDateTime modified = info.lastModified();
+    return modified.isValid() ? static_cast<uint64_t>(modified.toMSecsSinceEpoch()) : 0;
+}
 } // namespace
 
 namespace Fooyin {
@@ -68,13 +252,24 @@ struct LibraryScanner::Private
 
     LibraryInfo currentLibrary;
     TrackDatabase trackDatabase;
+    LibraryDatabase libraryDatabase;
 
     int tracksProcessed{0};
     double totalTracks{0};
     int currentProgress{-1};
 
+    // Reader threads merge theirs in once finished
+    ScanMetrics metrics;
+    std::mutex metricsMutex;
+    std::chrono::steady_clock::time_point scanStart;
+
     std::unordered_map<int, LibraryWatcher> watchers;
 
+    // Files read by the running scan with an estimated duration, and the stored tracks of those still to refine
+    std::unordered_set<QString> estimatedPaths;
+    std::deque<Track> estimatedTracks;
+    bool refiningDurations{false};
+
     Private(LibraryScanner* self_, DbConnectionPoolPtr dbPool_, SettingsManager* settings_)
         : self{self_}
         , dbPool{std::move(dbPool_)}
@@ -83,25 +278,25 @@ struct LibraryScanner::Private
 
     void addWatcher(const Fooyin::LibraryInfo& library)
     {
-        auto watchPaths = [this, library](const QString& path) {
-            QStringList dirs = Utils::File::getAllSubdirectories(path);
-            dirs.append(path);
-            watchers[library.id].addPaths(dirs);
-        };
-
-        watchPaths(library.path);
-
-        QObject::connect(&watchers.at(library.id), &LibraryWatcher::libraryDirChanged, self,
-                         [this, watchPaths, library](const QString& dir) {
-                             watchPaths(dir);
-                             emit self->directoryChanged(library, dir);
-                         });
+        auto& watcher = watchers[library.id];
+        watcher.watchLibrary(library.path);
+
+        QObject::connect(&watcher, &LibraryWatcher::libraryDirChanged, self,
+                         [this, library](const QString& dir) { emit self->directoryChanged(library, dir); });
+        QObject::connect(
+            &watcher, &LibraryWatcher::libraryChanged, self,
+            [this, library](const LibraryChanges& changes) { emit self->libraryChanged(library, changes); });
     }
 
     void reportProgress()
     {
-        const int progress = static_cast<int>((tracksProcessed / totalTracks) * 100);
-        if(currentProgress != progress) {
+        if(totalTracks <= 0) {
+            return;
+        }
+
+        const int progress = std::min(100, static_cast<int>((tracksProcessed / totalTracks) * 100));
+        // The total may be an estimate, so never step backwards when it grows
+        if(progress > currentProgress) {
             currentProgress = progress;
             emit self->progressChanged(currentProgress);
         }
@@ -109,123 +304,885 @@ struct LibraryScanner::Private
 
     void storeTracks(TrackList& tracks)
     {
-        if(!self->mayRun()) {
+        FY_TRACE_SCOPE("LibraryScanner::storeTracks");
+        if(!self->mayRun() || tracks.empty()) {
             return;
         }
 
-        trackDatabase.storeTracks(tracks);
+        const auto start = std::chrono::steady_clock::now();
+        if(!trackDatabase.storeTracks(tracks)) {
+            metrics.addError(ScanMetrics::Error::Database);
+        }
+        metrics.databaseWriteTime.add(microsSince(start));
+
+        // Only refined once stored, as that's when new tracks get their id
+        if(!estimatedPaths.empty()) {
+            for(const Track& track : tracks) {
+                if(track.isInDatabase() && estimatedPaths.erase(track.filepath()) > 0) {
+                    estimatedTracks.push_back(track);
+                }
+            }
+        }
+    }
+
+    void refineDurationsLater()
+    {
+        if(refiningDurations || estimatedTracks.empty()) {
+            return;
+        }
+
+        // Queued, so scans requested in the meantime run first
+        refiningDurations = true;
+        QMetaObject::invokeMethod(self, [this]() { refineDurations(); }, Qt::QueuedConnection);
+    }
+
+    // Works out the exact duration of a batch of tracks whose duration was estimated when scanned
+    void refineDurations()
+    {
+        FY_TRACE_SCOPE("LibraryScanner::refineDurations");
+        refiningDurations = false;
+
+        if(self->closing()) {
+            estimatedTracks.clear();
+            return;
+        }
+        // Picked up again once the paused scan finishes
+        if(self->state() != Idle) {
+            return;
+        }
+
+        TrackList tracks;
+        while(!estimatedTracks.empty() && std::cmp_less(tracks.size(), DurationBatchSize)) {
+            tracks.push_back(std::move(estimatedTracks.front()));
+            estimatedTracks.pop_front();
+        }
+
+        // A scan since may have changed them
+        trackDatabase.reloadTracks(tracks);
+
+        TrackList updatedTracks;
+        for(Track& track : tracks) {
+            const uint64_t duration = Tagging::readAccurateDuration(track);
+            if(duration > 0 && duration != track.duration()) {
+                track.setDuration(duration);
+                updatedTracks.push_back(track);
+            }
+        }
+
+        if(!updatedTracks.empty() && trackDatabase.updateTracks(updatedTracks)) {
+            const ScanResult scanResult{.addedTracks = {}, .updatedTracks = updatedTracks};
+            recordScanUpdate(scanResult);
+            emit self->scanUpdate(scanResult);
+        }
+
+        refineDurationsLater();
+    }
+
+    void startMetrics()
+    {
+        metrics             = {};
+        metrics.libraryId   = currentLibrary.id;
+        metrics.libraryName = currentLibrary.name;
+        scanStart           = std::chrono::steady_clock::now();
+    }
+
+    void finishMetrics()
+    {
+        metrics.elapsed = microsSince(scanStart);
+        metrics.log();
+        emit self->scanMetricsReady(metrics);
+    }
+
+    // Reads the file(s) of @p job, recording how long that took and anything that went wrong
+    static void readJob(ScanJob& job, CoverExtractor& coverExtractor, ScanMetrics& readerMetrics)
+    {
+        FY_TRACE_SCOPE("LibraryScanner::readJob");
+        const auto start         = std::chrono::steady_clock::now();
+        const uint64_t bytesRead = FileReader::threadBytesRead();
+        const uint64_t estimated = Tagging::threadEstimatedDurations();
+
+        if(job.type == ScanJob::Type::Cue) {
+            Tagging::readCueTracks(job.tracks);
+            job.read = !job.tracks.empty();
+        }
+        else if(job.type == ScanJob::Type::Archive) {
+            job.read = Tagging::readArchiveTracks(job.track.filepath(), job.tracks);
+        }
+        else {
+            job.read              = coverExtractor.readMetaData(job.track);
+            job.estimatedDuration = Tagging::threadEstimatedDurations() != estimated;
+        }
+
+        readerMetrics.addRead(job.track.extension().toLower(), microsSince(start));
+        readerMetrics.bytesRead += FileReader::threadBytesRead() - bytesRead;
+
+        if(!job.read) {
+            readerMetrics.addError(job.type == ScanJob::Type::Cue       ? ScanMetrics::Error::CueSheet
+                                   : job.type == ScanJob::Type::Archive ? ScanMetrics::Error::Archive
+                                                                        : ScanMetrics::Error::Unreadable);
+        }
+        else if(job.type != ScanJob::Type::Cue && job.type != ScanJob::Type::Archive
+                && job.track.type() == Track::Type::Unknown) {
+            readerMetrics.addError(ScanMetrics::Error::Unsupported);
+        }
     }
 
     bool getAndSaveAllTracks(const QString& path, const TrackList& tracks, bool onlyModified)
     {
+        startMetrics();
+        estimatedPaths.clear();
+
         const QDir dir{path};
+        const QString root = dir.absolutePath();
 
         TrackList tracksToStore;
         TrackList tracksToUpdate;
 
         TrackFieldMap trackPaths;
         TrackFieldMap missingFiles;
-        TrackFieldMap missingHashes;
+        TrackHashMap missingHashes;
+        TrackList missingSharedTracks;
+
+        // Tracks below root are found missing by discovery, so only the rest need to be checked here
+        std::unordered_map<QString, TrackList> directoryTracks;
+        std::unordered_map<QString, TrackList> archiveTracks;
+        std::unordered_map<QString, TrackList> otherTracks;
 
         for(const Track& track : tracks) {
-            trackPaths.emplace(track.filepath(), track);
+            trackPaths.emplace(track.uniqueFilepath(), track);
+
+            if(track.isInArchive()) {
+                archiveTracks[track.archivePath()].push_back(track);
+            }
 
-            if(!QFileInfo::exists(track.filepath())) {
-                missingFiles.emplace(track.filename(), track);
-                missingHashes.emplace(track.hash(), track);
+            const QString location = trackLocation(track);
+            if(isBelow(location, root)) {
+                directoryTracks[parentPath(location)].push_back(track);
+            }
+            else {
+                otherTracks[parentPath(location)].push_back(track);
             }
         }
 
-        const QStringList files = Utils::File::getFilesInDirRecursive(dir, Track::supportedFileExtensions());
+        for(const auto& [directory, locatedTracks] : otherTracks) {
+            // Listing a directory costs about the same as a single stat, which matters on network shares
+            std::unordered_set<QString> files;
+            const bool listed = locatedTracks.size() > 1 && !directory.isEmpty();
+            if(listed) {
+                const QStringList entries = QDir{directory}.entryList(QDir::Files | QDir::Hidden, QDir::Unsorted);
+                for(const QString& entry : entries) {
+                    files.emplace(directory + u'/' + entry);
+                }
+            }
+
+            for(const Track& track : locatedTracks) {
+                const QString location = trackLocation(track);
+                if(listed ? files.contains(location) : QFileInfo::exists(location)) {
+                    continue;
+                }
+
+                if(sharesFile(track)) {
+                    missingSharedTracks.push_back(track);
+                }
+                else {
+                    missingFiles.emplace(track.filename(), track);
+                    missingHashes.emplace(track.hash(), track);
+                }
+            }
+        }
+
+        LibraryDirectoryMap storedDirectories;
+        if(onlyModified) {
+            libraryDatabase.getDirectories(currentLibrary.id, storedDirectories);
+        }
 
         tracksProcessed = 0;
-        totalTracks     = static_cast<double>(files.size());
         currentProgress = -1;
 
-        for(const auto& filepath : files) {
+        // Files are checked against the library on one thread, read by a pool of readers,
+        // then matched and stored here, as this thread owns the database connection
+        BoundedQueue<ScanJob> jobs{QueueSize};
+        BoundedQueue<ScanJob> results{QueueSize};
+
+        const int libraryId = currentLibrary.id;
+
+        // The total isn't known until discovery finishes, so progress is based on the size of the library
+        // until more files than that have been found
+        const auto estimatedTotal = static_cast<double>(tracks.size());
+        std::atomic<int> filesFound{0};
+        std::atomic<bool> discoveryFinished{false};
+
+        // Owned by the discovery thread until discoveryFinished is set
+        std::unordered_set<QString> foundPaths;
+        LibraryDirectoryMap scannedDirectories;
+        // Files of the directory being discovered, held until all are known so those of its CUE sheets can be skipped
+        std::vector<Utils::File::FileEntry> directoryFiles;
+        std::unordered_set<QString> cueFiles;
+
+        auto checkTrack = [&](const Track& libraryTrack, uint64_t modifiedTime) {
+            if(!libraryTrack.isEnabled() || libraryTrack.libraryId() != libraryId
+               || libraryTrack.modifiedTime() != modifiedTime || !onlyModified) {
+                return jobs.push({ScanJob::Type::Existing, Track{libraryTrack}});
+            }
+            // Still counted towards progress
+            return results.push({ScanJob::Type::Unchanged, {}});
+        };
+
+        // A sheet is only read again if it or any of its files have changed
+        auto checkCue = [&](const QString& cuePath) {
+            filesFound.fetch_add(1, std::memory_order_relaxed);
+
+            const uint64_t sheetTime = fileModifiedTime(cuePath).value_or(0);
+            std::unordered_map<QString, std::optional<uint64_t>> fileTimes;
+
+            TrackList cueTracks = Tagging::parseCueSheet(cuePath);
+            std::erase_if(cueTracks, [&fileTimes](const Track& track) {
+                auto timeIt = fileTimes.find(track.filepath());
+                if(timeIt == fileTimes.end()) {
+                    timeIt = fileTimes.emplace(track.filepath(), fileModifiedTime(track.filepath())).first;
+                }
+                return !timeIt->second.has_value();
+            });
+
+            bool unchanged{onlyModified && !cueTracks.empty()};
+
+            for(const Track& track : cueTracks) {
+                cueFiles.emplace(track.filepath());
+                foundPaths.emplace(track.uniqueFilepath());
+
+                const auto trackIt = trackPaths.find(track.uniqueFilepath());
+                if(trackIt == trackPaths.end()) {
+                    unchanged = false;
+                    continue;
+                }
+
+                const Track& libraryTrack   = trackIt->second;
+                const uint64_t modifiedTime = std::max(sheetTime, fileTimes.at(track.filepath()).value_or(0));
+                if(!libraryTrack.isEnabled() || libraryTrack.libraryId() != libraryId
+                   || libraryTrack.modifiedTime() != modifiedTime) {
+                    unchanged = false;
+                }
+            }
+
+            if(unchanged || cueTracks.empty()) {
+                return results.push({ScanJob::Type::Unchanged, {}});
+            }
+
+            ScanJob job{ScanJob::Type::Cue, Track{cuePath}};
+            job.tracks = std::move(cueTracks);
+            return jobs.push(std::move(job));
+        };
+
+        // An archive is only read again if it has changed, and then all of it in one pass
+        auto checkArchive = [&](const QString& archivePath, uint64_t modifiedTime) {
+            filesFound.fetch_add(1, std::memory_order_relaxed);
+
+            const auto tracksIt = archiveTracks.find(archivePath);
+            bool unchanged{onlyModified && tracksIt != archiveTracks.end()};
+
+            if(tracksIt != archiveTracks.end()) {
+                for(const Track& libraryTrack : tracksIt->second) {
+                    // Those no longer in the archive are only known once it has been read
+                    foundPaths.emplace(libraryTrack.uniqueFilepath());
+
+                    if(!libraryTrack.isEnabled() || libraryTrack.libraryId() != libraryId
+                       || libraryTrack.modifiedTime() != modifiedTime) {
+                        unchanged = false;
+                    }
+                }
+            }
+
+            if(unchanged) {
+                return results.push({ScanJob::Type::Unchanged, {}});
+            }
+            return jobs.push({ScanJob::Type::Archive, Track{archivePath}});
+        };
+
+        auto checkFile = [&](const Utils::File::FileEntry& file) {
+            foundPaths.emplace(file.path);
+            filesFound.fetch_add(1, std::memory_order_relaxed);
+
+            const auto trackIt = trackPaths.find(file.path);
+            if(trackIt == trackPaths.end()) {
+                return jobs.push({ScanJob::Type::New, Track{file.path}});
+            }
+
+            return checkTrack(trackIt->second, file.modifiedTime);
+        };
+
+        auto checkDirectoryFiles = [&]() {
+            const auto files = std::exchange(directoryFiles, {});
+
+            // Sheets go first, so the files they cover are known
+            for(const auto& file : files) {
+                if(isCueSheet(file.path) && !checkCue(file.path)) {
+                    return false;
+                }
+            }
+            for(const auto& file : files) {
+                if(isCueSheet(file.path) || cueFiles.contains(file.path)) {
+                    continue;
+                }
+                const bool checked = ArchiveReader::isArchive(file.path) ? checkArchive(file.path, file.modifiedTime)
+                                                                         : checkFile(file);
+                if(!checked) {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        auto checkDirectory = [&](const Utils::File::DirectoryEntry& directory) {
+            using Utils::File::DirectoryAction;
+
+            if(!self->mayRun() || !checkDirectoryFiles()) {
+                return DirectoryAction::Stop;
+            }
+
+            const LibraryDirectory state{directory.modifiedTime, directory.entryCount};
+            scannedDirectories.emplace(directory.path, state);
+
+            const auto storedIt = storedDirectories.find(directory.path);
+            if(storedIt == storedDirectories.end() || storedIt->second != state) {
+                return DirectoryAction::Visit;
+            }
+
+            // Nothing has been added, removed or renamed since the last scan, so its tracks are all still here
+            const auto tracksIt = directoryTracks.find(directory.path);
+            if(tracksIt != directoryTracks.end()) {
+                std::unordered_set<QString> sharedFiles;
+
+                for(const Track& libraryTrack : tracksIt->second) {
+                    if(libraryTrack.hasCue()) {
+                        if(sharedFiles.emplace(libraryTrack.cuePath()).second && !checkCue(libraryTrack.cuePath())) {
+                            return DirectoryAction::Stop;
+                        }
+                        continue;
+                    }
+                    if(libraryTrack.isInArchive()) {
+                        if(sharedFiles.emplace(libraryTrack.archivePath()).second
+                           && !checkArchive(libraryTrack.archivePath(), libraryTrack.modifiedTime())) {
+                            return DirectoryAction::Stop;
+                        }
+                        continue;
+                    }
+
+                    foundPaths.emplace(libraryTrack.filepath());
+                    filesFound.fetch_add(1, std::memory_order_relaxed);
+
+                    if(!checkTrack(libraryTrack, libraryTrack.modifiedTime())) {
+                        return DirectoryAction::Stop;
+                    }
+                }
+            }
+
+            return DirectoryAction::SkipFiles;
+        };
+
+        auto addFile = [&](const Utils::File::FileEntry& file) {
             if(!self->mayRun()) {
                 return false;
             }
 
-            ++tracksProcessed;
+            directoryFiles.push_back(file);
+            return true;
+        };
+
+        uint64_t discoveryTime{0};
+
+        std::thread discovery{[&]() {
+            setCurrentThreadPriority(ThreadPriority::Background);
+
+            const auto start = std::chrono::steady_clock::now();
+            if(Utils::File::findFilesRecursive(root, Track::supportedFileExtensions(), addFile, checkDirectory)) {
+                checkDirectoryFiles();
+            }
+            discoveryTime = microsSince(start);
+
+            discoveryFinished.store(true, std::memory_order_release);
+            jobs.close();
+        }};
+
+        auto refineTotal = [&]() {
+            const bool finished = discoveryFinished.load(std::memory_order_acquire);
+            const auto found    = static_cast<double>(filesFound.load(std::memory_order_relaxed));
+
+            // Leave room for files still to be found
+            totalTracks = finished ? found : std::max(estimatedTotal, found + 1);
+        };
+
+        CoverExtractor coverExtractor{settings->value<Settings::Core::Internal::ExtractCovers>()};
+
+        const int readers = readerCount(root);
+        std::atomic<int> activeReaders{readers};
+        std::vector<std::thread> readerThreads;
+        // Fewer readers run at once while idle work is throttled, e.g. during playback on battery,
+        // unless the scan was started by the user
+        IdleGate idleGate;
+
+        for(int i{0}; i < readers; ++i) {
+            readerThreads.emplace_back([this, &jobs, &results, &activeReaders, &coverExtractor, &idleGate]() {
+                setCurrentThreadPriority(ThreadPriority::Background);
+
+                ScanMetrics readerMetrics;
+                const auto cancelled = [this]() {
+                    return !self->mayRun();
+                };
+
+                while(auto job = jobs.pop()) {
+                    if(self->mayRun() && idleGate.acquire(cancelled)) {
+                        readJob(*job, coverExtractor, readerMetrics);
+                        idleGate.release();
+                    }
+                    if(!results.push(std::move(job.value()))) {
+                        break;
+                    }
+                }
+
+                {
+                    const std::scoped_lock lock{metricsMutex};
+                    metrics.merge(readerMetrics);
+                }
+
+                if(activeReaders.fetch_sub(1) == 1) {
+                    results.close();
+                }
+            });
+        }
 
-            const QFileInfo info{filepath};
-            const QDateTime lastModifiedTime{info.lastModified()};
-            uint64_t lastModified{0};
+        auto setTrackProps = [this, &dir](Track& track, const QString& filepath) {
+            track.setFilePath(filepath);
+            track.setLibraryId(currentLibrary.id);
+            track.setRelativePath(relativeTrackPath(dir, track));
+            track.setIsEnabled(true);
+        };
 
-            if(lastModifiedTime.isValid()) {
-                lastModified = static_cast<uint64_t>(lastModifiedTime.toMSecsSinceEpoch());
+        auto storeBatch = [&]() {
+            if(tracksToStore.size() >= BatchSize) {
+                storeTracks(tracksToStore);
+                const ScanResult scanResult{.addedTracks = tracksToStore, .updatedTracks = {}};
+                recordScanUpdate(scanResult);
+                emit self->scanUpdate(scanResult);
+                tracksToStore.clear();
             }
+        };
 
-            auto setTrackProps = [this, &filepath, &dir](Track& track) {
-                track.setFilePath(filepath);
-                track.setLibraryId(currentLibrary.id);
-                track.setRelativePath(dir.relativeFilePath(filepath));
-                track.setIsEnabled(true);
-            };
+        // Built from the stored fingerprints of missing tracks once a new file can't be matched by its tags
+        const bool useFingerprints = settings->value<Settings::Core::Internal::AudioFingerprints>();
+        std::optional<FingerprintIndex> fingerprintIndex;
 
-            if(trackPaths.contains(filepath)) {
-                const Track& libraryTrack = trackPaths.at(filepath);
+        auto matchFingerprint = [&](const Track& track) -> Track {
+            if(!useFingerprints || missingFiles.empty()) {
+                return {};
+            }
 
-                if(!libraryTrack.isEnabled() || libraryTrack.libraryId() != currentLibrary.id
-                   || libraryTrack.modifiedTime() != lastModified || !onlyModified) {
-                    Track changedTrack{libraryTrack};
-                    if(Tagging::readMetaData(changedTrack)) {
-                        setTrackProps(changedTrack);
+            if(!fingerprintIndex) {
+                fingerprintIndex.emplace();
 
-                        tracksToUpdate.push_back(changedTrack);
-                        missingHashes.erase(changedTrack.hash());
-                        missingFiles.erase(changedTrack.filename());
+                std::vector<int> missingIds;
+                for(const Track& missingTrack : missingFiles | std::views::values) {
+                    missingIds.push_back(missingTrack.id());
+                }
+
+                auto fingerprints = trackDatabase.fingerprints(missingIds);
+                for(const Track& missingTrack : missingFiles | std::views::values) {
+                    if(auto it = fingerprints.find(missingTrack.id()); it != fingerprints.end()) {
+                        fingerprintIndex->add(missingTrack, std::move(it->second));
                     }
                 }
             }
+
+            if(fingerprintIndex->empty()) {
+                return {};
+            }
+
+            return fingerprintIndex->take(track.duration(), AudioFingerprinter::fromTrack(track));
+        };
+
+        auto forgetMissing = [&](const Track& track) {
+            missingHashes.erase(track.hash());
+            missingFiles.erase(track.filename());
+            if(fingerprintIndex) {
+                fingerprintIndex->remove(track);
+            }
+        };
+
+        // Keeps the id and what only the library knows, such as playback stats, when a file replaces a track
+        auto carryOver = [](Track& track, const Track& libraryTrack) {
+            track.setId(libraryTrack.id());
+            track.setAddedTime(libraryTrack.addedTime());
+            track.setFirstPlayed(libraryTrack.firstPlayed());
+            track.setLastPlayed(libraryTrack.lastPlayed());
+            track.setPlayCount(libraryTrack.playCount());
+            track.setRating(libraryTrack.rating());
+        };
+
+        auto addNewTrack = [&](Track& track) {
+            Track refoundTrack = matchMissingTrack(missingFiles, missingHashes, track);
+
+            if(refoundTrack.isInLibrary() || refoundTrack.isInDatabase()) {
+                forgetMissing(refoundTrack);
+
+                setTrackProps(refoundTrack, track.filepath());
+                tracksToUpdate.push_back(refoundTrack);
+            }
+            else if(const Track movedTrack = matchFingerprint(track); movedTrack.isInDatabase()) {
+                // The file may have been retagged as well as moved, so its new tags are kept
+                forgetMissing(movedTrack);
+
+                carryOver(track, movedTrack);
+                setTrackProps(track, track.filepath());
+                tracksToUpdate.push_back(track);
+            }
             else {
-                Track track{filepath};
+                setTrackProps(track, track.filepath());
+                tracksToStore.push_back(track);
+            }
+
+            storeBatch();
+        };
 
-                if(Tagging::readMetaData(track)) {
-                    Track refoundTrack = matchMissingTrack(missingFiles, missingHashes, track);
+        // Tracks of sheets and archives are read from scratch, so carry over what only the library knows
+        auto addSharedTrack = [&](Track& track) {
+            setTrackProps(track, track.filepath());
 
-                    if(refoundTrack.isInLibrary() || refoundTrack.isInDatabase()) {
-                        missingHashes.erase(refoundTrack.hash());
-                        missingFiles.erase(refoundTrack.filename());
+            const auto trackIt = trackPaths.find(track.uniqueFilepath());
+            if(trackIt == trackPaths.end()) {
+                tracksToStore.push_back(track);
+                storeBatch();
+                return;
+            }
 
-                        setTrackProps(refoundTrack);
-                        tracksToUpdate.push_back(refoundTrack);
+            carryOver(track, trackIt->second);
+            tracksToUpdate.push_back(track);
+        };
+
+        auto findRemovedArchiveTracks = [&](const QString& archivePath, const TrackList& archivedTracks) {
+            const auto tracksIt = archiveTracks.find(archivePath);
+            if(tracksIt == archiveTracks.end()) {
+                return;
+            }
+
+            std::unordered_set<QString> readPaths;
+            for(const Track& track : archivedTracks) {
+                readPaths.emplace(track.filepath());
+            }
+            for(const Track& libraryTrack : tracksIt->second) {
+                if(!readPaths.contains(libraryTrack.filepath())) {
+                    missingSharedTracks.push_back(libraryTrack);
+                }
+            }
+        };
+
+        // New tracks may have been moved from elsewhere in the library, which can't be known until every
+        // file has been found, so they are held back until then
+        bool missingKnown{directoryTracks.empty()};
+        TrackList pendingTracks;
+
+        auto findMissing = [&]() {
+            missingKnown = true;
+
+            for(const auto& directory : directoryTracks | std::views::values) {
+                for(const Track& track : directory) {
+                    if(foundPaths.contains(track.uniqueFilepath())) {
+                        continue;
+                    }
+                    if(sharesFile(track)) {
+                        missingSharedTracks.push_back(track);
                     }
                     else {
-                        setTrackProps(track);
-                        tracksToStore.push_back(track);
+                        missingFiles.emplace(track.filename(), track);
+                        missingHashes.emplace(track.hash(), track);
+                    }
+                }
+            }
+
+            for(Track& track : pendingTracks) {
+                addNewTrack(track);
+            }
+            pendingTracks.clear();
+        };
+
+        // Directories with unreadable files are scanned again next time
+        std::unordered_set<QString> failedDirectories;
+
+        for(auto batch = results.popBatch(ResultBatchSize); !batch.empty() && self->mayRun();
+            batch = results.popBatch(ResultBatchSize)) {
+            for(ScanJob& result : batch) {
+                ++tracksProcessed;
+
+                if(!missingKnown && discoveryFinished.load(std::memory_order_acquire)) {
+                    findMissing();
+                }
+
+                if(result.read && (result.type == ScanJob::Type::Cue || result.type == ScanJob::Type::Archive)) {
+                    for(Track& track : result.tracks) {
+                        addSharedTrack(track);
+                    }
+                    if(result.type == ScanJob::Type::Archive) {
+                        findRemovedArchiveTracks(result.track.filepath(), result.tracks);
                     }
+                }
+                else if(result.read) {
+                    Track& track = result.track;
+                    if(result.estimatedDuration) {
+                        estimatedPaths.emplace(track.filepath());
+                    }
+
+                    if(result.type == ScanJob::Type::Existing) {
+                        setTrackProps(track, track.filepath());
 
-                    if(tracksToStore.size() >= BatchSize) {
-                        storeTracks(tracksToStore);
-                        emit self->scanUpdate({.addedTracks = tracksToStore, .updatedTracks = {}});
-                        tracksToStore.clear();
+                        tracksToUpdate.push_back(track);
+                        forgetMissing(track);
                     }
+                    else if(missingKnown) {
+                        addNewTrack(track);
+                    }
+                    else {
+                        pendingTracks.push_back(track);
+                    }
+                }
+                else if(result.type != ScanJob::Type::Unchanged) {
+                    failedDirectories.emplace(parentPath(result.track.filepath()));
                 }
             }
 
+            refineTotal();
             reportProgress();
         }
 
-        for(auto& track : missingFiles | std::views::values) {
+        const bool cancelled = !self->mayRun();
+        if(cancelled) {
+            // Unblocks every stage so the threads can be joined
+            jobs.cancel();
+            results.cancel();
+        }
+
+        discovery.join();
+        for(auto& thread : readerThreads) {
+            thread.join();
+        }
+
+        if(cancelled) {
+            return false;
+        }
+
+        if(!missingKnown) {
+            findMissing();
+        }
+
+        for(const QString& directory : failedDirectories) {
+            scannedDirectories.erase(directory);
+        }
+
+        const auto directoriesStart = std::chrono::steady_clock::now();
+        if(!libraryDatabase.storeDirectories(libraryId, root, scannedDirectories)) {
+            metrics.addError(ScanMetrics::Error::Database);
+        }
+        metrics.databaseWriteTime.add(microsSince(directoriesStart));
+
+        auto removeTrack = [&tracksToUpdate](Track& track) {
             if(track.isInLibrary() || track.isEnabled()) {
                 track.setLibraryId(-1);
                 track.setIsEnabled(false);
                 tracksToUpdate.push_back(track);
             }
+        };
+
+        for(auto& track : missingFiles | std::views::values) {
+            removeTrack(track);
+        }
+        for(auto& track : missingSharedTracks) {
+            removeTrack(track);
         }
 
         storeTracks(tracksToStore);
         storeTracks(tracksToUpdate);
 
         if(!tracksToStore.empty() || !tracksToUpdate.empty()) {
-            emit self->scanUpdate({tracksToStore, tracksToUpdate});
+            const ScanResult scanResult{tracksToStore, tracksToUpdate};
+            recordScanUpdate(scanResult);
+            emit self->scanUpdate(scanResult);
         }
 
+        metrics.discoveryTime   = discoveryTime;
+        metrics.filesDiscovered = static_cast<uint64_t>(filesFound.load(std::memory_order_relaxed));
+        finishMetrics();
+
         return true;
     }
 
+    void saveChanges(const LibraryChanges& changes, const TrackList& tracks)
+    {
+        const QDir dir{currentLibrary.path};
+        const QStringList extensions = Track::supportedFileExtensions();
+
+        TrackFieldMap trackPaths;
+        // Sheets, archives and the files of their tracks, which are handled by scanning their directory again
+        std::unordered_set<QString> sharedFiles;
+
+        for(const Track& track : tracks) {
+            if(track.hasCue()) {
+                sharedFiles.emplace(track.filepath());
+                sharedFiles.emplace(track.cuePath());
+            }
+            else if(track.isInArchive()) {
+                sharedFiles.emplace(track.archivePath());
+            }
+            else {
+                trackPaths.emplace(track.filepath(), track);
+            }
+        }
+
+        std::unordered_set<QString> changedDirectories;
+        auto rescan = [this, &changedDirectories](const QString& directory) {
+            if(changedDirectories.emplace(directory).second) {
+                emit self->directoryChanged(currentLibrary, directory);
+            }
+        };
+
+        auto isSharedFile = [&sharedFiles](const QString& path) {
+            return isCueSheet(path) || ArchiveReader::isArchive(path) || sharedFiles.contains(path);
+        };
+        auto hasSharedFilesBelow = [&sharedFiles](const QString& path) {
+            return std::ranges::any_of(sharedFiles, [&path](const QString& file) { return isBelow(file, path); });
+        };
+
+        TrackList tracksToStore;
+        TrackList tracksToUpdate;
+
+        auto setTrackProps = [this, &dir](Track& track, const QString& filepath) {
+            track.setFilePath(filepath);
+            track.setLibraryId(currentLibrary.id);
+            track.setRelativePath(relativeTrackPath(dir, track));
+            track.setIsEnabled(true);
+        };
+
+        // Paths may be files or directories, and only a directory needs a search through the library
+        auto tracksAt = [&trackPaths](const QString& path) {
+            TrackList found;
+            if(const auto trackIt = trackPaths.find(path); trackIt != trackPaths.end()) {
+                found.push_back(trackIt->second);
+                return found;
+            }
+            for(const auto& [filepath, track] : trackPaths) {
+                if(isBelow(filepath, path)) {
+                    found.push_back(track);
+                }
+            }
+            return found;
+        };
+
+        auto removeTrack = [&tracksToUpdate](Track& track) {
+            if(track.isInLibrary() || track.isEnabled()) {
+                track.setLibraryId(-1);
+                track.setIsEnabled(false);
+                tracksToUpdate.push_back(track);
+            }
+        };
+
+        QStringList filesToRead;
+
+        for(const QString& path : changes.removed) {
+            if(isSharedFile(path)) {
+                rescan(parentPath(path));
+                continue;
+            }
+            if(hasSharedFilesBelow(path)) {
+                rescan(path);
+            }
+
+            for(Track& track : tracksAt(path)) {
+                trackPaths.erase(track.filepath());
+                removeTrack(track);
+            }
+        }
+
+        for(const auto& [from, to] : changes.renamed) {
+            if(isSharedFile(from) || isSharedFile(to)) {
+                rescan(parentPath(from));
+                rescan(parentPath(to));
+                continue;
+            }
+            if(hasSharedFilesBelow(from)) {
+                rescan(to);
+            }
+
+            TrackList renamedTracks = tracksAt(from);
+            if(renamedTracks.empty()) {
+                // Most likely a temporary file moved over a track, or a directory of files we didn't know about
+                if(QFileInfo{to}.isDir()) {
+                    emit self->directoryChanged(currentLibrary, to);
+                }
+                else {
+                    filesToRead.append(to);
+                }
+                continue;
+            }
+
+            for(Track& track : renamedTracks) {
+                const QString newPath = to + track.filepath().sliced(from.size());
+
+                // Replaced whatever was there before
+                if(const auto replacedIt = trackPaths.find(newPath); replacedIt != trackPaths.end()) {
+                    Track replaced = replacedIt->second;
+                    trackPaths.erase(replacedIt);
+                    removeTrack(replaced);
+                }
+
+                trackPaths.erase(track.filepath());
+                setTrackProps(track, newPath);
+                trackPaths.emplace(newPath, track);
+                tracksToUpdate.push_back(track);
+            }
+        }
+
+        filesToRead.append(changes.modified);
+
+        CoverExtractor coverExtractor{settings->value<Settings::Core::Internal::ExtractCovers>()};
+
+        for(const QString& filepath : std::as_const(filesToRead)) {
+            if(!self->mayRun()) {
+                return;
+            }
+
+            if(!QDir::match(extensions, filepath.sliced(filepath.lastIndexOf(u'/') + 1))) {
+                continue;
+            }
+
+            if(isSharedFile(filepath)) {
+                rescan(parentPath(filepath));
+                continue;
+            }
+
+            const auto trackIt = trackPaths.find(filepath);
+            const bool isNew   = trackIt == trackPaths.end();
+
+            Track track{isNew ? Track{filepath} : trackIt->second};
+            if(!coverExtractor.readMetaData(track)) {
+                continue;
+            }
+
+            setTrackProps(track, filepath);
+            if(isNew) {
+                tracksToStore.push_back(track);
+            }
+            else {
+                tracksToUpdate.push_back(track);
+            }
+        }
+
+        storeTracks(tracksToStore);
+        storeTracks(tracksToUpdate);
+
+        if(!tracksToStore.empty() || !tracksToUpdate.empty()) {
+            const ScanResult scanResult{tracksToStore, tracksToUpdate};
+            recordScanUpdate(scanResult);
+            emit self->scanUpdate(scanResult);
+        }
+    }
+
     void changeLibraryStatus(LibraryInfo::Status status)
     {
         currentLibrary.status = status;
@@ -246,6 +1203,7 @@ void LibraryScanner::initialiseThread()
 
     p->dbHandler = std::make_unique<DbConnectionHandler>(p->dbPool);
     p->trackDatabase.initialise(DbConnectionProvider{p->dbPool});
+    p->libraryDatabase.initialise(DbConnectionProvider{p->dbPool});
 }
 
 void LibraryScanner::stopThread()
@@ -280,10 +1238,23 @@ void LibraryScanner::setupWatchers(const LibraryInfoMap& libraries, bool enabled
     }
 }
 
-void LibraryScanner::scanLibrary(const LibraryInfo& library, const TrackList& tracks, bool onlyModified)
+void LibraryScanner::removeWatcher(int libraryId)
+{
+    p->watchers.erase(libraryId);
+}
+
+void LibraryScanner::scanLibrary(const LibraryInfo& library, const TrackList& tracks, bool onlyModified,
+                                 bool automatic)
 {
+    FY_TRACE_SCOPE("LibraryScanner::scanLibrary");
     setState(Running);
 
+    // The user is waiting on the scan, so it isn't held back by playback or load
+    std::optional<TaskScheduler::Unthrottle> unthrottle;
+    if(!automatic) {
+        unthrottle.emplace(TaskScheduler::instance());
+    }
+
     p->currentLibrary = library;
 
     p->changeLibraryStatus(LibraryInfo::Status::Scanning);
@@ -304,11 +1275,13 @@ void LibraryScanner::scanLibrary(const LibraryInfo& library, const TrackList& tr
                                    : LibraryInfo::Status::Idle);
         setState(Idle);
         emit finished();
+        p->refineDurationsLater();
     }
 }
 
 void LibraryScanner::scanLibraryDirectory(const LibraryInfo& library, const QString& dir, const TrackList& tracks)
 {
+    FY_TRACE_SCOPE("LibraryScanner::scanLibraryDirectory");
     setState(Running);
 
     p->currentLibrary = library;
@@ -317,6 +1290,31 @@ void LibraryScanner::scanLibraryDirectory(const LibraryInfo& library, const QStr
 
     p->getAndSaveAllTracks(dir, tracks, true);
 
+    if(state() == Paused) {
+        p->changeLibraryStatus(LibraryInfo::Status::Pending);
+    }
+    else {
+        p->changeLibraryStatus(p->settings->value<Settings::Core::Internal::MonitorLibraries>()
+                                   ? LibraryInfo::Status::Monitoring
+                                   : LibraryInfo::Status::Idle);
+        setState(Idle);
+        emit finished();
+        p->refineDurationsLater();
+    }
+}
+
+void LibraryScanner::scanLibraryChanges(const LibraryInfo& library, const LibraryChanges& changes,
+                                        const TrackList& tracks)
+{
+    FY_TRACE_SCOPE("LibraryScanner::scanLibraryChanges");
+    setState(Running);
+
+    p->currentLibrary = library;
+
+    p->changeLibraryStatus(LibraryInfo::Status::Scanning);
+
+    p->saveChanges(changes, tracks);
+
     if(state() == Paused) {
         p->changeLibraryStatus(LibraryInfo::Status::Pending);
     }
@@ -331,6 +1329,7 @@ void LibraryScanner::scanLibraryDirectory(const LibraryInfo& library, const QStr
 
 void LibraryScanner::scanTracks(const TrackList& libraryTracks, const TrackList& tracks)
 {
+    FY_TRACE_SCOPE("LibraryScanner::scanTracks");
     setState(Running);
 
     TrackList tracksScanned;
@@ -338,7 +1337,7 @@ void LibraryScanner::scanTracks(const TrackList& libraryTracks, const TrackList&
 
     TrackFieldMap trackMap;
     std::ranges::transform(libraryTracks, std::inserter(trackMap, trackMap.end()),
-                           [](const Track& track) { return std::make_pair(track.filepath(), track); });
+                           [](const Track& track) { return std::make_pair(track.uniqueFilepath(), track); });
 
     p->tracksProcessed = 0;
     p->totalTracks     = static_cast<double>(tracks.size());
@@ -351,23 +1350,100 @@ void LibraryScanner::scanTracks(const TrackList& libraryTracks, const TrackList&
         }
     };
 
-    for(const Track& pendingTrack : tracks) {
+    // Sheets and archives are replaced by their tracks, and the files sheets cover aren't added on their own
+    TrackList cueTracks;
+    std::unordered_set<QString> cueFiles;
+    QStringList archives;
+
+    for(const Track& track : tracks) {
+        if(isCueSheet(track.filepath())) {
+            const TrackList sheetTracks = Tagging::parseCueSheet(track.filepath());
+            for(const Track& cueTrack : sheetTracks) {
+                cueFiles.emplace(cueTrack.filepath());
+                cueTracks.push_back(cueTrack);
+            }
+        }
+        else if(ArchiveReader::isArchive(track.filepath())) {
+            archives.append(track.filepath());
+        }
+    }
+
+    TrackList tracksToRead;
+    TrackList cueTracksToRead;
+
+    for(const Track& track : cueTracks) {
+        if(const auto trackIt = trackMap.find(track.uniqueFilepath()); trackIt != trackMap.end()) {
+            tracksScanned.push_back(trackIt->second);
+        }
+        else {
+            cueTracksToRead.push_back(track);
+        }
+    }
+
+    for(const Track& track : tracks) {
+        if(isCueSheet(track.filepath()) || cueFiles.contains(track.filepath())
+           || ArchiveReader::isArchive(track.filepath())) {
+            continue;
+        }
+        if(const auto trackIt = trackMap.find(track.filepath()); trackIt != trackMap.end()) {
+            tracksScanned.push_back(trackIt->second);
+            ++p->tracksProcessed;
+        }
+        else {
+            tracksToRead.push_back(track);
+        }
+    }
+    p->reportProgress();
+
+    // Files not in the library are read in parallel, a batch at a time so cancelling stays responsive
+    std::vector<uint8_t> readTracks(tracksToRead.size(), 0);
+    const auto total = static_cast<int>(tracksToRead.size());
+
+    for(int start{0}; start < total; start += BatchSize) {
         if(!mayRun()) {
             handleFinished();
             return;
         }
 
-        Track track{pendingTrack};
+        const int end = std::min(start + BatchSize, total);
+        QtConcurrent::blockingMap(tracksToRead.begin() + start, tracksToRead.begin() + end,
+                                  [&tracksToRead, &readTracks](Track& track) {
+                                      const auto index = static_cast<size_t>(&track - tracksToRead.data());
+                                      readTracks[index] = Tagging::readMetaData(track) ? 1 : 0;
+                                  });
 
-        ++p->tracksProcessed;
+        p->tracksProcessed += end - start;
+        p->reportProgress();
+    }
 
-        if(trackMap.contains(track.filepath())) {
-            tracksScanned.push_back(trackMap.at(track.filepath()));
+    for(size_t i{0}; i < tracksToRead.size(); ++i) {
+        if(readTracks[i]) {
+            tracksToStore.push_back(tracksToRead[i]);
         }
-        else if(Tagging::readMetaData(track)) {
-            tracksToStore.push_back(track);
+    }
+
+    Tagging::readCueTracks(cueTracksToRead);
+    std::ranges::copy(cueTracksToRead, std::back_inserter(tracksToStore));
+
+    for(const QString& archive : std::as_const(archives)) {
+        if(!mayRun()) {
+            handleFinished();
+            return;
         }
 
+        TrackList archivedTracks;
+        Tagging::readArchiveTracks(archive, archivedTracks);
+
+        for(const Track& track : archivedTracks) {
+            if(const auto trackIt = trackMap.find(track.filepath()); trackIt != trackMap.end()) {
+                tracksScanned.push_back(trackIt->second);
+            }
+            else {
+                tracksToStore.push_back(track);
+            }
+        }
+
+        ++p->tracksProcessed;
         p->reportProgress();
     }
 
@@ -375,6 +1451,7 @@ void LibraryScanner::scanTracks(const TrackList& libraryTracks, const TrackList&
 
     std::ranges::copy(tracksToStore, std::back_inserter(tracksScanned));
 
+    CrossThreadStats::recordCopy("LibraryScanner::scannedTracks", tracksScanned);
     emit scannedTracks(tracksScanned);
 
     handleFinished();
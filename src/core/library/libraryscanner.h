@@ -19,7 +19,11 @@
 
 #pragma once
 
+#include "fycore_export.h"
+
 #include "library/libraryinfo.h"
+#include "library/librarywatcher.h"
+#include "library/scanmetrics.h"
 
 #include <core/trackfwd.h>
 #include <utils/database/dbconnectionpool.h>
@@ -35,7 +39,7 @@ struct ScanResult
     TrackList updatedTracks;
 };
 
-class LibraryScanner : public Worker
+class FYCORE_EXPORT LibraryScanner : public Worker
 {
     Q_OBJECT
 
@@ -52,11 +56,20 @@ signals:
     void scanUpdate(const ScanResult& result);
     void scannedTracks(const TrackList& tracks);
     void directoryChanged(const LibraryInfo& library, const QString& dir);
+    void libraryChanged(const LibraryInfo& library, const LibraryChanges& changes);
+    /** Emitted once a scan of a library or one of its directories finishes. */
+    void scanMetricsReady(const Fooyin::ScanMetrics& metrics);
 
 public slots:
     void setupWatchers(const LibraryInfoMap& libraries, bool enabled);
-    void scanLibrary(const LibraryInfo& library, const TrackList& tracks, bool onlyModified);
+    void removeWatcher(int libraryId);
+    /*!
+     * Scans @p library for new and changed files. Only @p automatic scans, e.g. the refresh at startup,
+     * are held back while idle work is throttled; those the user asks for run at full speed.
+     */
+    void scanLibrary(const LibraryInfo& library, const TrackList& tracks, bool onlyModified, bool automatic);
     void scanLibraryDirectory(const LibraryInfo& library, const QString& dir, const TrackList& tracks);
+    void scanLibraryChanges(const LibraryInfo& library, const LibraryChanges& changes, const TrackList& tracks);
     void scanTracks(const TrackList& libraryTracks, const TrackList& tracks);
 
 private:
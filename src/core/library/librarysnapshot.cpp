@@ -0,0 +1,451 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "librarysnapshot.h"
+
+#include <utils/paths.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+constexpr std::array<char, 4> Magic{'F', 'Y', 'L', 'S'};
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr size_t Alignment       = 8;
+
+namespace {
+struct Header
+{
+    std::array<char, 4> magic{Magic};
+    uint32_t version{Fooyin::LibrarySnapshot::Version};
+    // Snapshots are only meant for the machine which wrote them, so aren't converted between byte orders
+    uint32_t byteOrder{ByteOrderMark};
+    uint32_t sortScript{0};
+    uint32_t trackCount{0};
+    uint32_t stringCount{0};
+    uint32_t listCount{0};
+    uint32_t reserved{0};
+    uint64_t recordsOffset{0};
+    uint64_t listsOffset{0};
+    uint64_t stringOffsetsOffset{0};
+    uint64_t stringsOffset{0};
+    uint64_t size{0};
+};
+
+// A run of string indexes in the list table
+struct StringRun
+{
+    uint32_t first{0};
+    uint32_t count{0};
+};
+
+struct TrackRecord
+{
+    int32_t id{-1};
+    int32_t libraryId{-1};
+    int32_t albumId{-1};
+    int32_t type{0};
+    int32_t trackNumber{0};
+    int32_t trackTotal{0};
+    int32_t discNumber{0};
+    int32_t discTotal{0};
+    int32_t bitrate{0};
+    int32_t sampleRate{0};
+    int32_t channels{0};
+    int32_t bitDepth{0};
+    int32_t playCount{0};
+    float rating{0};
+    uint32_t enabled{1};
+    uint32_t reserved{0};
+
+    uint64_t duration{0};
+    uint64_t fileSize{0};
+    uint64_t addedTime{0};
+    uint64_t modifiedTime{0};
+    uint64_t firstPlayed{0};
+    uint64_t lastPlayed{0};
+    uint64_t offset{0};
+    uint64_t hash{0};
+
+    // Indexes into the string table
+    uint32_t filepath{0};
+    uint32_t relativePath{0};
+    uint32_t title{0};
+    uint32_t album{0};
+    uint32_t date{0};
+    uint32_t composer{0};
+    uint32_t performer{0};
+    uint32_t sort{0};
+    uint32_t cuePath{0};
+
+    StringRun artists;
+    StringRun albumArtists;
+    StringRun genres;
+};
+
+static_assert(std::is_trivially_copyable_v<Header>);
+static_assert(std::is_trivially_copyable_v<TrackRecord>);
+
+uint64_t align(uint64_t offset)
+{
+    return (offset + Alignment - 1) & ~static_cast<uint64_t>(Alignment - 1);
+}
+
+class StringTable
+{
+public:
+    uint32_t intern(const QString& str)
+    {
+        const auto [it, inserted] = m_ids.try_emplace(str, static_cast<uint32_t>(m_strings.size()));
+        if(inserted) {
+            m_strings.push_back(str);
+        }
+        return it.value();
+    }
+
+    StringRun internList(const QStringList& list)
+    {
+        const StringRun run{static_cast<uint32_t>(m_lists.size()), static_cast<uint32_t>(list.size())};
+        for(const QString& str : list) {
+            m_lists.push_back(intern(str));
+        }
+        return run;
+    }
+
+    [[nodiscard]] const std::vector<QString>& strings() const
+    {
+        return m_strings;
+    }
+
+    [[nodiscard]] const std::vector<uint32_t>& lists() const
+    {
+        return m_lists;
+    }
+
+private:
+    QHash<QString, uint32_t> m_ids;
+    std::vector<QString> m_strings;
+    std::vector<uint32_t> m_lists;
+};
+
+template <typename T>
+void append(QByteArray& data, const T& value)
+{
+    data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void pad(QByteArray& data)
+{
+    data.append(static_cast<qsizetype>(align(data.size()) - data.size()), '\0');
+}
+
+class Reader
+{
+public:
+    Reader(const uchar* data, uint64_t size)
+        : m_data{data}
+        , m_size{size}
+    { }
+
+    template <typename T>
+    bool read(uint64_t offset, T& value) const
+    {
+        if(offset > m_size || m_size - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, m_data + offset, sizeof(T));
+        return true;
+    }
+
+    [[nodiscard]] const uchar* at(uint64_t offset) const
+    {
+        return m_data + offset;
+    }
+
+    [[nodiscard]] bool contains(uint64_t offset, uint64_t count, uint64_t itemSize) const
+    {
+        return offset <= m_size && (itemSize == 0 || count <= (m_size - offset) / itemSize);
+    }
+
+private:
+    const uchar* m_data;
+    uint64_t m_size;
+};
+
+bool readStrings(const Reader& reader, const Header& header, std::vector<QString>& strings)
+{
+    if(!reader.contains(header.stringOffsetsOffset, header.stringCount, sizeof(uint64_t))) {
+        return false;
+    }
+
+    strings.reserve(header.stringCount);
+
+    for(uint32_t i{0}; i < header.stringCount; ++i) {
+        uint64_t offset{0};
+        uint32_t size{0};
+        if(!reader.read(header.stringOffsetsOffset + (i * sizeof(uint64_t)), offset)
+           || !reader.read(header.stringsOffset + offset, size)) {
+            return false;
+        }
+
+        // Strings start 4 bytes past an 8 byte boundary, so are suitably aligned for QChar
+        const uint64_t start = header.stringsOffset + offset + sizeof(uint32_t);
+        if(!reader.contains(start, size, sizeof(QChar))) {
+            return false;
+        }
+        strings.emplace_back(reinterpret_cast<const QChar*>(reader.at(start)), static_cast<qsizetype>(size));
+    }
+
+    return true;
+}
+} // namespace
+
+namespace Fooyin {
+QString LibrarySnapshot::path()
+{
+    return Utils::cachePath() + QStringLiteral("/library.snapshot");
+}
+
+bool LibrarySnapshot::write(const QString& filepath, const TrackList& tracks, const QString& sortScript)
+{
+    StringTable table;
+
+    Header header;
+    header.sortScript = table.intern(sortScript);
+    header.trackCount = static_cast<uint32_t>(tracks.size());
+
+    std::vector<TrackRecord> records;
+    records.reserve(tracks.size());
+
+    for(const Track& track : tracks) {
+        TrackRecord& record = records.emplace_back();
+
+        record.id           = track.id();
+        record.libraryId    = track.libraryId();
+        record.albumId      = track.albumId();
+        record.type         = static_cast<int32_t>(track.type());
+        record.trackNumber  = track.trackNumber();
+        record.trackTotal   = track.trackTotal();
+        record.discNumber   = track.discNumber();
+        record.discTotal    = track.discTotal();
+        record.bitrate      = track.bitrate();
+        record.sampleRate   = track.sampleRate();
+        record.channels     = track.channels();
+        record.bitDepth     = track.bitDepth();
+        record.playCount    = track.playCount();
+        record.rating       = track.rating();
+        record.enabled      = track.isEnabled() ? 1 : 0;
+        record.duration     = track.duration();
+        record.fileSize     = track.fileSize();
+        record.addedTime    = track.addedTime();
+        record.modifiedTime = track.modifiedTime();
+        record.firstPlayed  = track.firstPlayed();
+        record.lastPlayed   = track.lastPlayed();
+        record.offset       = track.offset();
+        record.filepath     = table.intern(track.filepath());
+        record.relativePath = table.intern(track.relativePath());
+        record.title        = table.intern(track.title());
+        record.album        = table.intern(track.album());
+        record.date         = table.intern(track.date());
+        record.composer     = table.intern(track.composer());
+        record.performer    = table.intern(track.performer());
+        record.hash         = track.hash();
+        record.sort         = table.intern(track.sort());
+        record.cuePath      = table.intern(track.cuePath());
+        record.artists      = table.internList(track.artists());
+        record.albumArtists = table.internList(track.albumArtists());
+        record.genres       = table.internList(track.genres());
+    }
+
+    const auto& strings = table.strings();
+    const auto& lists   = table.lists();
+
+    header.stringCount = static_cast<uint32_t>(strings.size());
+    header.listCount   = static_cast<uint32_t>(lists.size());
+
+    QByteArray data;
+    data.reserve(static_cast<qsizetype>(sizeof(Header) + (records.size() * sizeof(TrackRecord))));
+    data.append(static_cast<qsizetype>(sizeof(Header)), '\0');
+    pad(data);
+
+    header.recordsOffset = data.size();
+    data.append(reinterpret_cast<const char*>(records.data()),
+                static_cast<qsizetype>(records.size() * sizeof(TrackRecord)));
+    pad(data);
+
+    header.listsOffset = data.size();
+    data.append(reinterpret_cast<const char*>(lists.data()), static_cast<qsizetype>(lists.size() * sizeof(uint32_t)));
+    pad(data);
+
+    // Offsets are filled in once the strings have been written
+    header.stringOffsetsOffset = data.size();
+    data.append(static_cast<qsizetype>(strings.size() * sizeof(uint64_t)), '\0');
+    pad(data);
+
+    header.stringsOffset = data.size();
+    for(size_t i{0}; i < strings.size(); ++i) {
+        const uint64_t offset = data.size() - header.stringsOffset;
+        std::memcpy(data.data() + header.stringOffsetsOffset + (i * sizeof(uint64_t)), &offset, sizeof(uint64_t));
+
+        const QString& str = strings.at(i);
+        append(data, static_cast<uint32_t>(str.size()));
+        data.append(reinterpret_cast<const char*>(str.utf16()), str.size() * static_cast<qsizetype>(sizeof(char16_t)));
+        pad(data);
+    }
+
+    header.size = data.size();
+    std::memcpy(data.data(), &header, sizeof(Header));
+
+    QSaveFile file{filepath};
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[Snapshot] Failed to open" << filepath << file.errorString();
+        return false;
+    }
+    if(file.write(data) != data.size()) {
+        qWarning() << "[Snapshot] Failed to write" << filepath << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+TrackList LibrarySnapshot::read(const QString& filepath, const QString& sortScript)
+{
+    QFile file{filepath};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    const auto fileSize = static_cast<uint64_t>(file.size());
+    const uchar* data   = file.map(0, file.size());
+    if(!data) {
+        return {};
+    }
+
+    const Reader reader{data, fileSize};
+
+    Header header;
+    if(!reader.read(0, header) || header.magic != Magic || header.version != Version
+       || header.byteOrder != ByteOrderMark || header.size != fileSize) {
+        qDebug() << "[Snapshot] Ignoring incompatible snapshot" << filepath;
+        return {};
+    }
+
+    std::vector<QString> strings;
+    if(!readStrings(reader, header, strings) || header.sortScript >= strings.size()) {
+        qWarning() << "[Snapshot] Invalid string table in" << filepath;
+        return {};
+    }
+    if(strings.at(header.sortScript) != sortScript) {
+        return {};
+    }
+
+    if(!reader.contains(header.recordsOffset, header.trackCount, sizeof(TrackRecord))
+       || !reader.contains(header.listsOffset, header.listCount, sizeof(uint32_t))) {
+        qWarning() << "[Snapshot] Invalid records in" << filepath;
+        return {};
+    }
+
+    bool valid{true};
+
+    const auto string = [&strings, &valid](uint32_t index) -> QString {
+        if(index >= strings.size()) {
+            valid = false;
+            return {};
+        }
+        return strings.at(index);
+    };
+
+    const auto stringList = [&](const StringRun& run) -> QStringList {
+        if(run.first > header.listCount || run.count > header.listCount - run.first) {
+            valid = false;
+            return {};
+        }
+        QStringList list;
+        list.reserve(run.count);
+        for(uint32_t i{0}; i < run.count; ++i) {
+            uint32_t index{0};
+            reader.read(header.listsOffset + ((run.first + i) * sizeof(uint32_t)), index);
+            list.append(string(index));
+        }
+        return list;
+    };
+
+    TrackList tracks;
+    tracks.reserve(header.trackCount);
+
+    for(uint32_t i{0}; i < header.trackCount && valid; ++i) {
+        TrackRecord record;
+        reader.read(header.recordsOffset + (i * sizeof(TrackRecord)), record);
+
+        Track& track = tracks.emplace_back(string(record.filepath));
+
+        track.setId(record.id);
+        track.setLibraryId(record.libraryId);
+        track.setType(static_cast<Track::Type>(record.type));
+        track.setTrackNumber(record.trackNumber);
+        track.setTrackTotal(record.trackTotal);
+        track.setDiscNumber(record.discNumber);
+        track.setDiscTotal(record.discTotal);
+        track.setBitrate(record.bitrate);
+        track.setSampleRate(record.sampleRate);
+        track.setChannels(record.channels);
+        track.setBitDepth(record.bitDepth);
+        track.setPlayCount(record.playCount);
+        track.setRating(record.rating);
+        track.setIsEnabled(record.enabled != 0);
+        track.setDuration(record.duration);
+        track.setFileSize(record.fileSize);
+        track.setAddedTime(record.addedTime);
+        track.setModifiedTime(record.modifiedTime);
+        track.setFirstPlayed(record.firstPlayed);
+        track.setLastPlayed(record.lastPlayed);
+        track.setOffset(record.offset);
+        track.setRelativePath(string(record.relativePath));
+        track.setTitle(string(record.title));
+        track.setAlbum(string(record.album));
+        track.setDate(string(record.date));
+        track.setComposer(string(record.composer));
+        track.setPerformer(string(record.performer));
+        track.setSort(string(record.sort));
+        track.setCuePath(string(record.cuePath));
+        track.setArtists(stringList(record.artists));
+        track.setAlbumArtists(stringList(record.albumArtists));
+        track.setGenres(stringList(record.genres));
+        // Set after the fields making up the album, which reset it
+        track.setAlbumId(record.albumId);
+        // Set last, as changing the fields it's generated from would otherwise regenerate it
+        track.setHash(record.hash);
+    }
+
+    if(!valid) {
+        qWarning() << "[Snapshot] Invalid string index in" << filepath;
+        return {};
+    }
+
+    return tracks;
+}
+} // namespace Fooyin
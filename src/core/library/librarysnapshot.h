@@ -0,0 +1,55 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/track.h>
+
+namespace Fooyin {
+/*!
+ * A binary copy of the sorted library, read at startup so views can be populated before the database is.
+ *
+ * Tracks are stored as fixed-size records, with every string interned in a single table and
+ * string lists as runs of indexes into it. The file is memory mapped when read.
+ * Only the fields of a light track (see TrackDatabase::Projection) are stored, along with each track's sort key.
+ */
+class FYCORE_EXPORT LibrarySnapshot
+{
+public:
+    static constexpr uint32_t Version = 4;
+
+    /** Returns the default location of the snapshot. */
+    static QString path();
+
+    /*!
+     * Writes @p tracks, sorted by @p sortScript, to @p filepath, replacing any existing snapshot.
+     * @returns @c true once the complete file is in place.
+     */
+    static bool write(const QString& filepath, const TrackList& tracks, const QString& sortScript);
+
+    /*!
+     * Reads the snapshot at @p filepath.
+     * @returns the tracks, or an empty list if the file is missing, invalid, from another version,
+     * or wasn't sorted by @p sortScript.
+     */
+    static TrackList read(const QString& filepath, const QString& sortScript);
+};
+} // namespace Fooyin
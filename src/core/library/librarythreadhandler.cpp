@@ -19,16 +19,34 @@
 
 #include "librarythreadhandler.h"
 
+#include "conversionjob.h"
+#include "fileoperationjob.h"
+#include "internalcoresettings.h"
 #include "library/libraryinfo.h"
 #include "libraryscanner.h"
+#include "replaygainscanner.h"
+#include "tagwritejob.h"
+#include "threadpriority.h"
 #include "trackdatabasemanager.h"
 
 #include <core/library/musiclibrary.h>
+#include <utils/fileutils.h>
 #include <utils/settings/settingsmanager.h>
 
 #include <QThread>
+#include <QTimer>
 
 #include <deque>
+#include <map>
+#include <ranges>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std::chrono_literals;
+
+// How long the events of a finished file operation may still arrive from the watchers
+constexpr auto FileOperationSettleTime = 2s;
 
 namespace {
 int nextRequestId()
@@ -47,6 +65,61 @@ struct LibraryScanRequest
     QString dir;
     TrackList tracks;
     bool onlyModified{true};
+    LibraryChanges changes;
+    // Started by a watcher or the refresh at startup rather than the user
+    bool automatic{false};
+};
+
+struct ReplayGainRequest
+{
+    int id;
+    TrackList tracks;
+    bool recalculate{false};
+};
+
+struct TagWriteRequest
+{
+    int id;
+    TrackList tracks;
+};
+
+struct FileOperationRequest
+{
+    int id;
+    TrackList tracks;
+    FileOperationOptions options;
+    LibraryInfoMap libraries;
+};
+
+struct ConversionRequest
+{
+    int id;
+    TrackList tracks;
+    ConversionOptions options;
+};
+
+// Scans the libraries of one device, one request at a time
+struct DeviceScanner
+{
+    QThread thread;
+    LibraryScanner scanner;
+    int requestId{-1};
+    // Paused for scans of added files, and restarted once they're done
+    bool paused{false};
+
+    DeviceScanner(DbConnectionPoolPtr dbPool, SettingsManager* settings)
+        : scanner{std::move(dbPool), settings}
+    {
+        scanner.moveToThread(&thread);
+        thread.start();
+    }
+
+    ~DeviceScanner()
+    {
+        scanner.stopThread();
+        thread.quit();
+        thread.wait();
+    }
 };
 
 struct LibraryThreadHandler::Private
@@ -58,11 +131,45 @@ struct LibraryThreadHandler::Private
     SettingsManager* settings;
 
     QThread thread;
-    LibraryScanner scanner;
+    // Scans files added outside of a library, which run before any library scan
+    LibraryScanner trackScanner;
     TrackDatabaseManager trackDatabaseManager;
 
     std::deque<LibraryScanRequest> scanRequests;
-    int currentRequestId{-1};
+    int currentTrackRequestId{-1};
+    // Later requests wait for the library to add the tracks found, so they don't add them again
+    bool awaitingScannedTracks{false};
+
+    // Libraries on different devices are scanned in parallel, while those sharing a device are scanned
+    // one after another so they don't compete for the same disk
+    std::map<int64_t, std::unique_ptr<DeviceScanner>> deviceScanners;
+    std::unordered_map<QString, int64_t> libraryDevices;
+
+    // ReplayGain calculation decodes whole files, so it runs separately to avoid holding up library scans
+    QThread replayGainThread;
+    ReplayGainScanner replayGainScanner;
+    std::deque<ReplayGainRequest> replayGainRequests;
+    int currentReplayGainId{-1};
+
+    // Tag writes wait on file IO, so they don't hold up database access while running
+    QThread tagWriteThread;
+    TagWriteJob tagWriter;
+    std::deque<TagWriteRequest> tagWriteRequests;
+    int currentTagWriteId{-1};
+
+    // Runs on the tag writing thread, so a file is never moved while its tags are written
+    FileOperationJob fileOperations;
+    std::deque<FileOperationRequest> fileOperationRequests;
+    int currentFileOperationId{-1};
+    // Paths changed by file operations, whose watcher events are dropped rather than scanned again
+    std::unordered_set<QString> changedPaths;
+    QTimer changedPathsTimer;
+
+    // Conversions can run for hours, so they're kept apart from everything else
+    QThread conversionThread;
+    ConversionJob converter;
+    std::deque<ConversionRequest> conversionRequests;
+    int currentConversionId{-1};
 
     Private(LibraryThreadHandler* self_, DbConnectionPoolPtr dbPool_, MusicLibrary* library_,
             SettingsManager* settings_)
@@ -70,42 +177,145 @@ struct LibraryThreadHandler::Private
         , dbPool{std::move(dbPool_)}
         , library{library_}
         , settings{settings_}
-        , scanner{dbPool, settings}
+        , trackScanner{dbPool, settings}
         , trackDatabaseManager{dbPool}
+        , fileOperations{dbPool}
+        , replayGainScanner{settings}
     {
-        scanner.moveToThread(&thread);
+        trackScanner.moveToThread(&thread);
         trackDatabaseManager.moveToThread(&thread);
-
-        QObject::connect(library, &MusicLibrary::tracksScanned, self, [this]() {
-            if(!scanRequests.empty()) {
-                execNextRequest();
+        replayGainScanner.moveToThread(&replayGainThread);
+        tagWriter.moveToThread(&tagWriteThread);
+        fileOperations.moveToThread(&tagWriteThread);
+        converter.moveToThread(&conversionThread);
+
+        QObject::connect(library, &MusicLibrary::tracksScanned, self, [this](int id) {
+            if(awaitingScannedTracks && id == currentTrackRequestId) {
+                awaitingScannedTracks = false;
+                currentTrackRequestId = -1;
+                execNextRequests();
             }
         });
 
         thread.start();
+        replayGainThread.start();
+        tagWriteThread.start();
+        conversionThread.start();
+
+        // Scanning shouldn't compete with playback or the UI
+        const auto lowerPriority = []() { setCurrentThreadPriority(ThreadPriority::Background); };
+        QMetaObject::invokeMethod(&trackScanner, lowerPriority);
+        QMetaObject::invokeMethod(&replayGainScanner, lowerPriority);
+    }
+
+    void connectScanner(LibraryScanner* scanner)
+    {
+        QObject::connect(scanner, &LibraryScanner::statusChanged, self, &LibraryThreadHandler::statusChanged);
+        QObject::connect(scanner, &LibraryScanner::scanUpdate, self, &LibraryThreadHandler::scanUpdate);
+        QObject::connect(scanner, &LibraryScanner::scanMetricsReady, self, &LibraryThreadHandler::scanMetricsReady);
+        QObject::connect(scanner, &LibraryScanner::directoryChanged, self,
+                         [this](const LibraryInfo& libraryInfo, const QString& dir) {
+                             if(!isFileOperationChange(libraryInfo, dir)) {
+                                 addDirectoryScanRequest(libraryInfo, dir);
+                             }
+                         });
+        QObject::connect(scanner, &LibraryScanner::libraryChanged, self,
+                         [this](const LibraryInfo& libraryInfo, const LibraryChanges& changes) {
+                             const LibraryChanges remaining = withoutFileOperationChanges(changes);
+                             if(!remaining.empty()) {
+                                 addChangesScanRequest(libraryInfo, remaining);
+                             }
+                         });
+    }
+
+    [[nodiscard]] bool isFileOperationChange(const LibraryInfo& libraryInfo, const QString& dir) const
+    {
+        // The watcher falls back to scanning the whole library if it drops events, which thousands of moves can
+        // easily cause, so those are put down to the operation as well
+        return changedPaths.contains(dir) || (!changedPaths.empty() && dir == libraryInfo.path);
     }
 
-    void scanLibrary(const LibraryScanRequest& request)
+    [[nodiscard]] LibraryChanges withoutFileOperationChanges(LibraryChanges changes) const
     {
-        QMetaObject::invokeMethod(&scanner, [this, request]() {
-            scanner.scanLibrary(request.library, library->tracks(), request.onlyModified);
+        if(changedPaths.empty()) {
+            return changes;
+        }
+
+        const auto isChanged = [this](const QString& path) {
+            return changedPaths.contains(path);
+        };
+
+        changes.modified.removeIf(isChanged);
+        changes.removed.removeIf(isChanged);
+        std::erase_if(changes.renamed, [&isChanged](const auto& rename) {
+            return isChanged(rename.first) || isChanged(rename.second);
         });
+
+        return changes;
+    }
+
+    int64_t libraryDevice(const LibraryInfo& libraryInfo)
+    {
+        if(const auto it = libraryDevices.find(libraryInfo.path); it != libraryDevices.cend()) {
+            return it->second;
+        }
+
+        // Looked up once per library, as stat can be slow on network shares.
+        // Paths which can't be read aren't kept, as their share may not be mounted yet.
+        const int64_t device = Utils::File::storageDevice(libraryInfo.path).id;
+        if(device >= 0) {
+            libraryDevices.emplace(libraryInfo.path, device);
+        }
+        return device;
+    }
+
+    DeviceScanner* scannerForDevice(int64_t device)
+    {
+        auto& deviceScanner = deviceScanners[device];
+        if(deviceScanner) {
+            return deviceScanner.get();
+        }
+
+        deviceScanner           = std::make_unique<DeviceScanner>(dbPool, settings);
+        LibraryScanner* scanner = &deviceScanner->scanner;
+        DeviceScanner* current  = deviceScanner.get();
+
+        connectScanner(scanner);
+        QObject::connect(scanner, &Worker::finished, self, [this, current]() { finishScanRequest(current); });
+        QObject::connect(scanner, &LibraryScanner::progressChanged, self,
+                         [this, current](int percent) { emit self->progressChanged(current->requestId, percent); });
+
+        QMetaObject::invokeMethod(scanner, &Worker::initialiseThread);
+        QMetaObject::invokeMethod(scanner, []() { setCurrentThreadPriority(ThreadPriority::Background); });
+
+        return current;
     }
 
     void scanTracks(const LibraryScanRequest& request)
     {
-        QMetaObject::invokeMethod(&scanner,
-                                  [this, request]() { scanner.scanTracks(library->tracks(), request.tracks); });
+        QMetaObject::invokeMethod(&trackScanner, [this, request]() {
+            trackScanner.scanTracks(library->snapshot().tracks(), request.tracks);
+        });
     }
 
-    void scanDirectory(const LibraryScanRequest& request)
+    void scanLibrary(LibraryScanner* scanner, const LibraryScanRequest& request)
     {
-        QMetaObject::invokeMethod(&scanner, [this, request]() {
-            scanner.scanLibraryDirectory(request.library, request.dir, library->tracks());
+        QMetaObject::invokeMethod(scanner, [this, scanner, request]() {
+            const TrackList tracks = library->snapshot().tracks();
+
+            if(!request.changes.empty()) {
+                scanner->scanLibraryChanges(request.library, request.changes, tracks);
+            }
+            else if(!request.dir.isEmpty()) {
+                scanner->scanLibraryDirectory(request.library, request.dir, tracks);
+            }
+            else {
+                scanner->scanLibrary(request.library, tracks, request.onlyModified, request.automatic);
+            }
         });
     }
 
-    ScanRequest addLibraryScanRequest(const LibraryInfo& libraryInfo, bool onlyModified)
+    ScanRequest addLibraryScanRequest(const LibraryInfo& libraryInfo, bool onlyModified, bool automatic)
     {
         const int id = nextRequestId();
 
@@ -113,11 +323,10 @@ struct LibraryThreadHandler::Private
                                 cancelScanRequest(id);
                             }};
 
-        scanRequests.emplace_back(id, ScanRequest::Library, libraryInfo, QStringLiteral(""), TrackList{}, onlyModified);
+        scanRequests.emplace_back(id, ScanRequest::Library, libraryInfo, QStringLiteral(""), TrackList{}, onlyModified,
+                                  LibraryChanges{}, automatic);
 
-        if(scanRequests.size() == 1) {
-            execNextRequest();
-        }
+        execNextRequests();
 
         return request;
     }
@@ -130,18 +339,21 @@ struct LibraryThreadHandler::Private
                                 cancelScanRequest(id);
                             }};
 
-        scanRequests.emplace_front(id, ScanRequest::Tracks, LibraryInfo{}, QStringLiteral(""), tracks);
+        // Track scans are usually of files just dropped or added, so they come before library scans,
+        // which are restarted once they're done
+        const auto firstLibraryRequest = std::ranges::find_if(
+            scanRequests, [](const auto& request) { return request.type != ScanRequest::Tracks; });
+        scanRequests.emplace(firstLibraryRequest, id, ScanRequest::Tracks, LibraryInfo{}, QStringLiteral(""), tracks);
 
-        // Track scans take precedence
-        const auto currRequest = currentRequest();
-        if(currRequest && currRequest->type == ScanRequest::Library) {
-            scanner.pauseThread();
-            execNextRequest();
-        }
-        else if(scanRequests.size() == 1) {
-            execNextRequest();
+        for(auto& deviceScanner : deviceScanners | std::views::values) {
+            if(deviceScanner->requestId >= 0 && !deviceScanner->paused) {
+                deviceScanner->paused = true;
+                deviceScanner->scanner.pauseThread();
+            }
         }
 
+        execNextRequests();
+
         return request;
     }
 
@@ -153,72 +365,325 @@ struct LibraryThreadHandler::Private
                                 cancelScanRequest(id);
                             }};
 
-        scanRequests.emplace_back(id, ScanRequest::Library, libraryInfo, dir, TrackList{});
+        scanRequests.emplace_back(id, ScanRequest::Library, libraryInfo, dir, TrackList{}, true, LibraryChanges{},
+                                  true);
+
+        execNextRequests();
+
+        return request;
+    }
+
+    ScanRequest addChangesScanRequest(const LibraryInfo& libraryInfo, const LibraryChanges& changes)
+    {
+        const int id = nextRequestId();
+
+        ScanRequest request{.type = ScanRequest::Library, .id = id, .cancel = [this, id]() {
+                                cancelScanRequest(id);
+                            }};
+
+        scanRequests.emplace_back(id, ScanRequest::Library, libraryInfo, QString{}, TrackList{}, true, changes, true);
+
+        execNextRequests();
+
+        return request;
+    }
+
+    ScanRequest addReplayGainRequest(const TrackList& tracks, bool recalculate)
+    {
+        const int id = nextRequestId();
+
+        ScanRequest request{.type = ScanRequest::ReplayGain, .id = id, .cancel = [this, id]() {
+                                cancelReplayGainRequest(id);
+                            }};
 
-        if(scanRequests.size() == 1) {
-            execNextRequest();
+        replayGainRequests.emplace_back(id, tracks, recalculate);
+
+        if(replayGainRequests.size() == 1) {
+            execNextReplayGainRequest();
         }
 
         return request;
     }
 
-    std::optional<LibraryScanRequest> currentRequest() const
+    void execNextReplayGainRequest()
+    {
+        if(replayGainRequests.empty()) {
+            currentReplayGainId = -1;
+            return;
+        }
+
+        const auto& request = replayGainRequests.front();
+        currentReplayGainId = request.id;
+
+        QMetaObject::invokeMethod(&replayGainScanner, [this, request]() {
+            replayGainScanner.calculate(request.tracks, request.recalculate);
+        });
+    }
+
+    void finishReplayGainRequest()
+    {
+        std::erase_if(replayGainRequests, [this](const auto& request) { return request.id == currentReplayGainId; });
+        execNextReplayGainRequest();
+    }
+
+    void cancelReplayGainRequest(int id)
+    {
+        if(currentReplayGainId == id) {
+            // Will be removed in finishReplayGainRequest
+            replayGainScanner.stopThread();
+        }
+        else {
+            std::erase_if(replayGainRequests, [id](const auto& request) { return request.id == id; });
+        }
+    }
+
+    ScanRequest addTagWriteRequest(const TrackList& tracks)
     {
-        const auto requestIt = std::ranges::find_if(
-            scanRequests, [this](const auto& request) { return request.id == currentRequestId; });
-        if(requestIt != scanRequests.cend()) {
-            return *requestIt;
+        const int id = nextRequestId();
+
+        ScanRequest request{.type = ScanRequest::Metadata, .id = id, .cancel = [this, id]() {
+                                cancelTagWriteRequest(id);
+                            }};
+
+        tagWriteRequests.emplace_back(id, tracks);
+
+        if(tagWriteRequests.size() == 1) {
+            execNextTagWriteRequest();
         }
-        return {};
+
+        return request;
     }
 
-    void execNextRequest()
+    void execNextTagWriteRequest()
     {
-        if(scanRequests.empty()) {
+        if(tagWriteRequests.empty()) {
+            currentTagWriteId = -1;
             return;
         }
 
-        const auto& request = scanRequests.front();
-        currentRequestId    = request.id;
+        const auto& request = tagWriteRequests.front();
+        currentTagWriteId   = request.id;
 
-        if(request.type == ScanRequest::Tracks) {
-            scanTracks(request);
+        Tagging::WriteOptions options;
+        options.padding = settings->value<Settings::Core::Internal::TagPadding>();
+
+        QMetaObject::invokeMethod(&tagWriter,
+                                  [this, request, options]() { tagWriter.write(request.tracks, options); });
+    }
+
+    void finishTagWriteRequest()
+    {
+        std::erase_if(tagWriteRequests, [this](const auto& request) { return request.id == currentTagWriteId; });
+        execNextTagWriteRequest();
+    }
+
+    void cancelTagWriteRequest(int id)
+    {
+        if(currentTagWriteId == id) {
+            // Will be removed in finishTagWriteRequest
+            tagWriter.stopThread();
+        }
+        else {
+            std::erase_if(tagWriteRequests, [id](const auto& request) { return request.id == id; });
+        }
+    }
+
+    ScanRequest addFileOperationRequest(const TrackList& tracks, const FileOperationOptions& options,
+                                        const LibraryInfoMap& libraries)
+    {
+        const int id = nextRequestId();
+
+        ScanRequest request{.type = ScanRequest::FileOperation, .id = id, .cancel = [this, id]() {
+                                cancelFileOperationRequest(id);
+                            }};
+
+        fileOperationRequests.emplace_back(id, tracks, options, libraries);
+
+        if(fileOperationRequests.size() == 1) {
+            execNextFileOperationRequest();
+        }
+
+        return request;
+    }
+
+    void execNextFileOperationRequest()
+    {
+        if(fileOperationRequests.empty()) {
+            currentFileOperationId = -1;
+            // Kept a little longer, as the events of the last moves may still be on their way
+            changedPathsTimer.start();
+            return;
+        }
+
+        const auto& request    = fileOperationRequests.front();
+        currentFileOperationId = request.id;
+        changedPathsTimer.stop();
+
+        QMetaObject::invokeMethod(&fileOperations, [this, request]() {
+            fileOperations.run(request.tracks, request.options, request.libraries);
+        });
+    }
+
+    void finishFileOperationRequest()
+    {
+        std::erase_if(fileOperationRequests,
+                      [this](const auto& request) { return request.id == currentFileOperationId; });
+        execNextFileOperationRequest();
+    }
+
+    void cancelFileOperationRequest(int id)
+    {
+        if(currentFileOperationId == id) {
+            // Will be removed in finishFileOperationRequest
+            fileOperations.stopThread();
         }
         else {
-            if(request.dir.isEmpty()) {
-                scanLibrary(request);
+            std::erase_if(fileOperationRequests, [id](const auto& request) { return request.id == id; });
+        }
+    }
+
+    ScanRequest addConversionRequest(const TrackList& tracks, const ConversionOptions& options)
+    {
+        const int id = nextRequestId();
+
+        ScanRequest request{.type = ScanRequest::Conversion, .id = id, .cancel = [this, id]() {
+                                cancelConversionRequest(id);
+                            }};
+
+        conversionRequests.emplace_back(id, tracks, options);
+
+        if(conversionRequests.size() == 1) {
+            execNextConversionRequest();
+        }
+
+        return request;
+    }
+
+    void execNextConversionRequest()
+    {
+        if(conversionRequests.empty()) {
+            currentConversionId = -1;
+            return;
+        }
+
+        const auto& request = conversionRequests.front();
+        currentConversionId = request.id;
+
+        QMetaObject::invokeMethod(&converter,
+                                  [this, request]() { converter.convert(request.tracks, request.options); });
+    }
+
+    void finishConversionRequest()
+    {
+        std::erase_if(conversionRequests, [this](const auto& request) { return request.id == currentConversionId; });
+        execNextConversionRequest();
+    }
+
+    void cancelConversionRequest(int id)
+    {
+        if(currentConversionId == id) {
+            // Will be removed in finishConversionRequest
+            converter.stopThread();
+        }
+        else {
+            std::erase_if(conversionRequests, [id](const auto& request) { return request.id == id; });
+        }
+    }
+
+    LibraryScanRequest* findRequest(int id)
+    {
+        const auto requestIt
+            = std::ranges::find_if(scanRequests, [id](const auto& request) { return request.id == id; });
+        return requestIt != scanRequests.end() ? &*requestIt : nullptr;
+    }
+
+    void execNextRequests()
+    {
+        if(scanRequests.empty() || currentTrackRequestId >= 0) {
+            return;
+        }
+
+        if(const auto& request = scanRequests.front(); request.type == ScanRequest::Tracks) {
+            currentTrackRequestId = request.id;
+            scanTracks(request);
+            return;
+        }
+
+        for(auto& deviceScanner : deviceScanners | std::views::values) {
+            if(deviceScanner->paused) {
+                deviceScanner->paused = false;
+                if(const auto* request = findRequest(deviceScanner->requestId)) {
+                    scanLibrary(&deviceScanner->scanner, *request);
+                }
+                else {
+                    deviceScanner->requestId = -1;
+                }
             }
-            else {
-                scanDirectory(request);
+        }
+
+        // Requests of a device are started in the order they were made
+        std::set<int64_t> seenDevices;
+
+        for(const auto& request : scanRequests) {
+            const int64_t device = libraryDevice(request.library);
+            if(!seenDevices.emplace(device).second) {
+                continue;
+            }
+
+            DeviceScanner* deviceScanner = scannerForDevice(device);
+            if(deviceScanner->requestId < 0) {
+                deviceScanner->requestId = request.id;
+                scanLibrary(&deviceScanner->scanner, request);
             }
         }
     }
 
-    void finishScanRequest()
+    void finishTrackRequest()
     {
-        if(const auto request = currentRequest()) {
-            std::erase_if(scanRequests,
-                          [this](const auto& pendingRequest) { return pendingRequest.id == currentRequestId; });
+        std::erase_if(scanRequests, [this](const auto& request) { return request.id == currentTrackRequestId; });
 
-            if(request->type == ScanRequest::Tracks) {
-                // Next request (if any) will be started after tracksScanned is emitted from MusicLibrary
-                return;
-            }
+        if(awaitingScannedTracks) {
+            // Next requests (if any) will be started after tracksScanned is emitted from MusicLibrary
+            return;
         }
 
-        currentRequestId = -1;
-        execNextRequest();
+        currentTrackRequestId = -1;
+        execNextRequests();
+    }
+
+    void finishScanRequest(DeviceScanner* deviceScanner)
+    {
+        const int id = std::exchange(deviceScanner->requestId, -1);
+        deviceScanner->paused = false;
+
+        std::erase_if(scanRequests, [id](const auto& request) { return request.id == id; });
+        execNextRequests();
     }
 
     void cancelScanRequest(int id)
     {
-        if(currentRequestId == id) {
-            // Will be removed in finishScanRequest
-            scanner.stopThread();
+        if(id == currentTrackRequestId) {
+            // Will be removed in finishTrackRequest
+            trackScanner.stopThread();
+            return;
         }
-        else {
-            std::erase_if(scanRequests, [id](const auto& request) { return request.id == id; });
+
+        for(auto& deviceScanner : deviceScanners | std::views::values) {
+            if(deviceScanner->requestId != id) {
+                continue;
+            }
+            if(deviceScanner->paused) {
+                // Not running, so there's nothing to wait for
+                finishScanRequest(deviceScanner.get());
+            }
+            else {
+                // Will be removed in finishScanRequest
+                deviceScanner->scanner.stopThread();
+            }
+            return;
         }
+
+        std::erase_if(scanRequests, [id](const auto& request) { return request.id == id; });
     }
 };
 
@@ -229,28 +694,78 @@ LibraryThreadHandler::LibraryThreadHandler(DbConnectionPoolPtr dbPool, MusicLibr
 {
     QObject::connect(&p->trackDatabaseManager, &TrackDatabaseManager::gotTracks, this,
                      &LibraryThreadHandler::gotTracks);
+    QObject::connect(&p->trackDatabaseManager, &TrackDatabaseManager::hydratedTracks, this,
+                     &LibraryThreadHandler::hydratedTracks);
     QObject::connect(&p->trackDatabaseManager, &TrackDatabaseManager::updatedTracks, this,
                      &LibraryThreadHandler::tracksUpdated);
-    QObject::connect(&p->scanner, &Worker::finished, this, [this]() { p->finishScanRequest(); });
-    QObject::connect(&p->scanner, &LibraryScanner::progressChanged, this,
-                     [this](int percent) { emit progressChanged(p->currentRequestId, percent); });
-    QObject::connect(&p->scanner, &LibraryScanner::scannedTracks, this,
-                     [this](const TrackList& tracks) { emit scannedTracks(p->currentRequestId, tracks); });
-    QObject::connect(&p->scanner, &LibraryScanner::statusChanged, this, &LibraryThreadHandler::statusChanged);
-    QObject::connect(&p->scanner, &LibraryScanner::scanUpdate, this, &LibraryThreadHandler::scanUpdate);
-    QObject::connect(
-        &p->scanner, &LibraryScanner::directoryChanged, this,
-        [this](const LibraryInfo& libraryInfo, const QString& dir) { p->addDirectoryScanRequest(libraryInfo, dir); });
-
-    QMetaObject::invokeMethod(&p->scanner, &Worker::initialiseThread);
+    p->connectScanner(&p->trackScanner);
+    QObject::connect(&p->trackScanner, &Worker::finished, this, [this]() { p->finishTrackRequest(); });
+    QObject::connect(&p->trackScanner, &LibraryScanner::progressChanged, this,
+                     [this](int percent) { emit progressChanged(p->currentTrackRequestId, percent); });
+    QObject::connect(&p->trackScanner, &LibraryScanner::scannedTracks, this, [this](const TrackList& tracks) {
+        p->awaitingScannedTracks = true;
+        emit scannedTracks(p->currentTrackRequestId, tracks);
+    });
+
+    QObject::connect(&p->replayGainScanner, &Worker::finished, this, [this]() { p->finishReplayGainRequest(); });
+    QObject::connect(&p->replayGainScanner, &ReplayGainScanner::progressChanged, this,
+                     [this](int percent) { emit progressChanged(p->currentReplayGainId, percent); });
+    QObject::connect(&p->replayGainScanner, &ReplayGainScanner::calculatedTracks, this,
+                     [this](const TrackList& tracks) { saveUpdatedTracks(tracks); });
+    QObject::connect(&p->replayGainScanner, &ReplayGainScanner::calculatedFingerprints, this,
+                     [this](const TrackFingerprintMap& fingerprints) {
+                         QMetaObject::invokeMethod(&p->trackDatabaseManager, [this, fingerprints]() {
+                             p->trackDatabaseManager.storeFingerprints(fingerprints);
+                         });
+                     });
+
+    QObject::connect(&p->tagWriter, &Worker::finished, this, [this]() { p->finishTagWriteRequest(); });
+    QObject::connect(&p->tagWriter, &TagWriteJob::progressChanged, this,
+                     [this](int percent) { emit progressChanged(p->currentTagWriteId, percent); });
+    // All tracks of a request are updated together, so the library only changes once
+    QObject::connect(&p->tagWriter, &TagWriteJob::writtenTracks, this, [this](const TrackList& tracks) {
+        QMetaObject::invokeMethod(&p->trackDatabaseManager,
+                                  [this, tracks]() { p->trackDatabaseManager.updateTracks(tracks); });
+    });
+
+    p->changedPathsTimer.setSingleShot(true);
+    p->changedPathsTimer.setInterval(FileOperationSettleTime);
+    QObject::connect(&p->changedPathsTimer, &QTimer::timeout, this, [this]() { p->changedPaths.clear(); });
+
+    QObject::connect(&p->fileOperations, &Worker::finished, this, [this]() { p->finishFileOperationRequest(); });
+    QObject::connect(&p->fileOperations, &FileOperationJob::progressChanged, this,
+                     [this](int percent) { emit progressChanged(p->currentFileOperationId, percent); });
+    QObject::connect(&p->fileOperations, &FileOperationJob::changingPaths, this,
+                     [this](const QStringList& paths) { p->changedPaths.insert(paths.cbegin(), paths.cend()); });
+    // Already updated in the database, so the library only needs to follow
+    QObject::connect(&p->fileOperations, &FileOperationJob::movedTracks, this, &LibraryThreadHandler::tracksUpdated);
+
+    QObject::connect(&p->converter, &Worker::finished, this, [this]() { p->finishConversionRequest(); });
+    QObject::connect(&p->converter, &ConversionJob::progressChanged, this,
+                     [this](int percent) { emit progressChanged(p->currentConversionId, percent); });
+
+    QMetaObject::invokeMethod(&p->trackScanner, &Worker::initialiseThread);
+    QMetaObject::invokeMethod(&p->replayGainScanner, &Worker::initialiseThread);
     QMetaObject::invokeMethod(&p->trackDatabaseManager, &Worker::initialiseThread);
+    QMetaObject::invokeMethod(&p->fileOperations, &Worker::initialiseThread);
 }
 
 LibraryThreadHandler::~LibraryThreadHandler()
 {
-    p->scanner.stopThread();
+    p->deviceScanners.clear();
+    p->trackScanner.stopThread();
+    p->replayGainScanner.stopThread();
+    p->tagWriter.stopThread();
+    p->fileOperations.stopThread();
+    p->converter.stopThread();
     p->trackDatabaseManager.stopThread();
 
+    p->replayGainThread.quit();
+    p->replayGainThread.wait();
+    p->tagWriteThread.quit();
+    p->tagWriteThread.wait();
+    p->conversionThread.quit();
+    p->conversionThread.wait();
     p->thread.quit();
     p->thread.wait();
 }
@@ -260,20 +775,41 @@ void LibraryThreadHandler::getAllTracks()
     QMetaObject::invokeMethod(&p->trackDatabaseManager, &TrackDatabaseManager::getAllTracks);
 }
 
+void LibraryThreadHandler::hydrateAllTracks()
+{
+    QMetaObject::invokeMethod(&p->trackDatabaseManager, &TrackDatabaseManager::hydrateAllTracks);
+}
+
 void LibraryThreadHandler::setupWatchers(const LibraryInfoMap& libraries, bool enabled)
 {
-    QMetaObject::invokeMethod(&p->scanner,
-                              [this, libraries, enabled]() { p->scanner.setupWatchers(libraries, enabled); });
+    // Libraries are watched by the scanner of their device, which also adds watchers for the libraries it scans
+    std::map<int64_t, LibraryInfoMap> deviceLibraries;
+    for(const auto& [id, library] : libraries) {
+        deviceLibraries[p->libraryDevice(library)].emplace(id, library);
+    }
+    if(!enabled) {
+        // Every scanner clears its watchers, even those without any of these libraries
+        for(const int64_t device : p->deviceScanners | std::views::keys) {
+            deviceLibraries.try_emplace(device);
+        }
+    }
+
+    for(const auto& [device, deviceLibraryMap] : deviceLibraries) {
+        LibraryScanner* scanner = &p->scannerForDevice(device)->scanner;
+        QMetaObject::invokeMethod(scanner, [scanner, deviceLibraryMap, enabled]() {
+            scanner->setupWatchers(deviceLibraryMap, enabled);
+        });
+    }
 }
 
-ScanRequest LibraryThreadHandler::refreshLibrary(const LibraryInfo& library)
+ScanRequest LibraryThreadHandler::refreshLibrary(const LibraryInfo& library, bool automatic)
 {
-    return p->addLibraryScanRequest(library, true);
+    return p->addLibraryScanRequest(library, true, automatic);
 }
 
 ScanRequest LibraryThreadHandler::scanLibrary(const LibraryInfo& library)
 {
-    return p->addLibraryScanRequest(library, false);
+    return p->addLibraryScanRequest(library, false, false);
 }
 
 ScanRequest LibraryThreadHandler::scanTracks(const TrackList& tracks)
@@ -281,25 +817,59 @@ ScanRequest LibraryThreadHandler::scanTracks(const TrackList& tracks)
     return p->addTracksScanRequest(tracks);
 }
 
+ScanRequest LibraryThreadHandler::calculateReplayGain(const TrackList& tracks, bool recalculate)
+{
+    return p->addReplayGainRequest(tracks, recalculate);
+}
+
+ScanRequest LibraryThreadHandler::convertTracks(const TrackList& tracks, const ConversionOptions& options)
+{
+    return p->addConversionRequest(tracks, options);
+}
+
+ScanRequest LibraryThreadHandler::organiseFiles(const TrackList& tracks, const FileOperationOptions& options,
+                                                const LibraryInfoMap& libraries)
+{
+    return p->addFileOperationRequest(tracks, options, libraries);
+}
+
+void LibraryThreadHandler::setPlaybackActive(bool active)
+{
+    p->converter.setPlaybackActive(active);
+}
+
 void LibraryThreadHandler::libraryRemoved(int id)
 {
-    if(p->scanRequests.empty()) {
-        return;
+    std::vector<int> requestIds;
+    for(const auto& request : p->scanRequests) {
+        if(request.type == ScanRequest::Library && request.library.id == id) {
+            requestIds.push_back(request.id);
+        }
     }
 
-    const auto request = p->currentRequest();
-    if(request && request->type == ScanRequest::Library && request->library.id == id) {
-        p->scanner.stopThread();
+    for(const int requestId : requestIds) {
+        p->cancelScanRequest(requestId);
     }
-    else {
-        std::erase_if(p->scanRequests, [id](const auto& pendingRequest) { return pendingRequest.library.id == id; });
+
+    for(auto& deviceScanner : p->deviceScanners | std::views::values) {
+        LibraryScanner* scanner = &deviceScanner->scanner;
+        QMetaObject::invokeMethod(scanner, [scanner, id]() { scanner->removeWatcher(id); });
     }
 }
 
-void LibraryThreadHandler::saveUpdatedTracks(const TrackList& tracks)
+void LibraryThreadHandler::libraryRelocated(const LibraryInfo& library, bool monitor)
 {
-    QMetaObject::invokeMethod(&p->trackDatabaseManager,
-                              [this, tracks]() { p->trackDatabaseManager.updateTracks(tracks); });
+    // Pending scans and watchers still refer to the old path, and it may be on another device
+    libraryRemoved(library.id);
+
+    if(monitor) {
+        setupWatchers({{library.id, library}}, true);
+    }
+}
+
+ScanRequest LibraryThreadHandler::saveUpdatedTracks(const TrackList& tracks)
+{
+    return p->addTagWriteRequest(tracks);
 }
 
 void LibraryThreadHandler::saveUpdatedTrackStats(const TrackList& track)
@@ -29,6 +29,8 @@
 namespace Fooyin {
 class SettingsManager;
 class MusicLibrary;
+struct ConversionOptions;
+struct FileOperationOptions;
 struct ScanResult;
 struct ScanRequest;
 
@@ -42,27 +44,44 @@ public:
     ~LibraryThreadHandler() override;
 
     void getAllTracks();
+    void hydrateAllTracks();
 
     void setupWatchers(const LibraryInfoMap& libraries, bool enabled);
 
-    ScanRequest refreshLibrary(const LibraryInfo& library);
+    /** Scans @p library for changed files, held back while idle work is throttled if @p automatic. */
+    ScanRequest refreshLibrary(const LibraryInfo& library, bool automatic = false);
     ScanRequest scanLibrary(const LibraryInfo& library);
     ScanRequest scanTracks(const TrackList& tracks);
+    ScanRequest calculateReplayGain(const TrackList& tracks, bool recalculate);
+    ScanRequest convertTracks(const TrackList& tracks, const ConversionOptions& options);
+    /*!
+     * Moves or copies the files of @p tracks as set out by @p options, with @p libraries giving their folders.
+     * The watcher events caused by the operation are dropped, as the database is updated directly.
+     */
+    ScanRequest organiseFiles(const TrackList& tracks, const FileOperationOptions& options,
+                              const LibraryInfoMap& libraries);
+    /** Holds off conversions set to pause during playback while @p active is @c true. */
+    void setPlaybackActive(bool active);
 
-    void saveUpdatedTracks(const TrackList& tracks);
+    /** Writes the metadata of @p tracks to their files, then updates them in the database. */
+    ScanRequest saveUpdatedTracks(const TrackList& tracks);
     void saveUpdatedTrackStats(const TrackList& track);
     void cleanupTracks();
 
     void libraryRemoved(int id);
+    /** Drops the scans and watchers of @p library at its old path, watching its new one if @p monitor is set. */
+    void libraryRelocated(const LibraryInfo& library, bool monitor);
 
 signals:
     void progressChanged(int id, int percent);
     void scannedTracks(int id, const TrackList& tracks);
     void statusChanged(const LibraryInfo& library);
+    void scanMetricsReady(const Fooyin::ScanMetrics& metrics);
     void scanUpdate(const ScanResult& result);
     void tracksUpdated(const TrackList& tracks);
 
-    void gotTracks(const TrackList& result);
+    void gotTracks(const TrackListPtr& result, bool last);
+    void hydratedTracks(const TrackListPtr& result, bool last);
 
 private:
     struct Private;
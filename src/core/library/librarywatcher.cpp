@@ -19,33 +19,333 @@
 
 #include "librarywatcher.h"
 
+#include <utils/fileutils.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
 #include <QTimer>
 
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ranges>
+#include <unordered_map>
+#include <utility>
+#endif
+
 using namespace std::chrono_literals;
 
 constexpr auto Interval = 15ms;
+// Long enough to pair up both halves of a move, and for editors that save through a temporary file
+constexpr auto ChangeInterval = 250ms;
+
+#if defined(__linux__)
+namespace {
+bool isBelow(const QString& path, const QString& dir)
+{
+    return path.size() > dir.size() && path.startsWith(dir) && path.at(dir.size()) == u'/';
+}
+} // namespace
+#endif
 
 namespace Fooyin {
+struct LibraryWatcher::Private
+{
+    LibraryWatcher* self;
+
+    QTimer timer;
+
+    QFileSystemWatcher* fallback{nullptr};
+    QString pendingDir;
+
+#if defined(__linux__)
+    static constexpr uint32_t WatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                        | IN_DELETE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+    int fd{-1};
+    std::unique_ptr<QSocketNotifier> notifier;
+    std::unordered_map<int, QString> watchPaths;
+    QStringList roots;
+    bool limitReached{false};
+
+    // Keyed by cookie, until the matching IN_MOVED_TO arrives
+    std::unordered_map<uint32_t, QString> movedFrom;
+    LibraryChanges changes;
+    QStringList changedDirs;
+#endif
+
+    explicit Private(LibraryWatcher* self_)
+        : self{self_}
+    {
+        timer.setSingleShot(true);
+
+#if defined(__linux__)
+        if(setupInotify()) {
+            return;
+        }
+#endif
+        setupFallback();
+    }
+
+    ~Private()
+    {
+#if defined(__linux__)
+        notifier.reset();
+        if(fd >= 0) {
+            ::close(fd);
+        }
+#endif
+    }
+
+    Private(const Private&)            = delete;
+    Private& operator=(const Private&) = delete;
+
+    void setupFallback()
+    {
+        fallback = new QFileSystemWatcher(self);
+        timer.setInterval(Interval);
+
+        QObject::connect(fallback, &QFileSystemWatcher::directoryChanged, self, [this](const QString& path) {
+            if(!pendingDir.isEmpty() && path != pendingDir) {
+                timer.stop();
+                fallbackDirChanged(pendingDir);
+            }
+            pendingDir = path;
+            timer.start();
+        });
+
+        QObject::connect(&timer, &QTimer::timeout, self, [this]() {
+            fallbackDirChanged(pendingDir);
+            pendingDir.clear();
+        });
+    }
+
+    void addFallbackPaths(const QString& path) const
+    {
+        QStringList dirs = Utils::File::getAllSubdirectories(path);
+        dirs.append(path);
+        fallback->addPaths(dirs);
+    }
+
+    void fallbackDirChanged(const QString& dir)
+    {
+        // Pick up any new subdirectories
+        addFallbackPaths(dir);
+        emit self->libraryDirChanged(dir);
+    }
+
+#if defined(__linux__)
+    bool setupInotify()
+    {
+        fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(fd < 0) {
+            qWarning() << "[LibraryWatcher] Failed to initialise inotify:" << std::strerror(errno);
+            return false;
+        }
+
+        notifier = std::make_unique<QSocketNotifier>(fd, QSocketNotifier::Read);
+        QObject::connect(notifier.get(), &QSocketNotifier::activated, self, [this]() { readEvents(); });
+
+        timer.setInterval(ChangeInterval);
+        QObject::connect(&timer, &QTimer::timeout, self, [this]() { flushChanges(); });
+
+        return true;
+    }
+
+    void addWatch(const QString& path)
+    {
+        if(limitReached) {
+            return;
+        }
+
+        const int wd = ::inotify_add_watch(fd, QFile::encodeName(path).constData(), WatchMask);
+        if(wd < 0) {
+            if(errno == ENOSPC) {
+                limitReached = true;
+                qWarning() << "[LibraryWatcher] Reached the inotify watch limit (fs.inotify.max_user_watches), "
+                              "some directories won't be monitored";
+            }
+            return;
+        }
+
+        watchPaths[wd] = path;
+    }
+
+    void addTree(const QString& path)
+    {
+        addWatch(path);
+
+        const QStringList subdirs = Utils::File::getAllSubdirectories(path);
+        for(const QString& subdir : subdirs) {
+            addWatch(subdir);
+        }
+    }
+
+    void renameWatches(const QString& from, const QString& to)
+    {
+        for(auto& path : watchPaths | std::views::values) {
+            if(path == from || isBelow(path, from)) {
+                path = to + path.sliced(from.size());
+            }
+        }
+    }
+
+    void addModified(const QString& path)
+    {
+        changes.removed.removeOne(path);
+        if(!changes.modified.contains(path)) {
+            changes.modified.append(path);
+        }
+    }
+
+    void addRemoved(const QString& path)
+    {
+        changes.modified.removeOne(path);
+        changes.removed.append(path);
+    }
+
+    void addRenamed(const QString& from, const QString& to)
+    {
+        if(changes.modified.removeOne(from)) {
+            // Written and moved into place since the last flush, e.g. a safe save
+            addModified(to);
+            return;
+        }
+        changes.renamed.emplace_back(from, to);
+    }
+
+    void addDirectory(const QString& path)
+    {
+        // Files may have been written before the watch was in place
+        addTree(path);
+        changedDirs.append(path);
+    }
+
+    void handleEvent(const inotify_event& event)
+    {
+        if(event.mask & IN_Q_OVERFLOW) {
+            // Events were dropped, so we can no longer say exactly what changed
+            changedDirs.append(roots);
+            return;
+        }
+
+        if(event.mask & IN_IGNORED) {
+            watchPaths.erase(event.wd);
+            return;
+        }
+
+        const auto watchIt = watchPaths.find(event.wd);
+        if(watchIt == watchPaths.end() || event.len == 0) {
+            return;
+        }
+
+        const QString name  = QFile::decodeName(event.name);
+        const QString path  = watchIt->second + u'/' + name;
+        const bool isDir    = (event.mask & IN_ISDIR) != 0;
+        const bool isHidden = name.startsWith(u'.');
+
+        if(event.mask & IN_MOVED_FROM) {
+            movedFrom[event.cookie] = path;
+        }
+        else if(event.mask & IN_MOVED_TO) {
+            const auto fromIt = movedFrom.find(event.cookie);
+            if(fromIt != movedFrom.end()) {
+                const QString from = fromIt->second;
+                movedFrom.erase(fromIt);
+
+                if(isDir) {
+                    renameWatches(from, path);
+                }
+                addRenamed(from, path);
+            }
+            // Moved in from outside the library
+            else if(isDir) {
+                if(!isHidden) {
+                    addDirectory(path);
+                }
+            }
+            else {
+                addModified(path);
+            }
+        }
+        else if(event.mask & IN_CREATE) {
+            // New files are picked up once they're closed
+            if(isDir && !isHidden) {
+                addDirectory(path);
+            }
+        }
+        else if(event.mask & IN_CLOSE_WRITE) {
+            addModified(path);
+        }
+        else if(event.mask & IN_DELETE) {
+            addRemoved(path);
+        }
+    }
+
+    void readEvents()
+    {
+        alignas(inotify_event) std::array<char, 16384> buffer;
+
+        while(true) {
+            const auto length = ::read(fd, buffer.data(), buffer.size());
+            if(length <= 0) {
+                break;
+            }
+
+            for(ssize_t offset{0}; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                handleEvent(*event);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+
+        timer.start();
+    }
+
+    void flushChanges()
+    {
+        // The other half of these moves is outside the library
+        for(const QString& path : movedFrom | std::views::values) {
+            addRemoved(path);
+        }
+        movedFrom.clear();
+
+        if(!changes.empty()) {
+            emit self->libraryChanged(std::exchange(changes, {}));
+        }
+
+        QStringList dirs = std::exchange(changedDirs, {});
+        dirs.removeDuplicates();
+        for(const QString& dir : dirs) {
+            emit self->libraryDirChanged(dir);
+        }
+    }
+#endif
+};
+
 LibraryWatcher::LibraryWatcher(QObject* parent)
-    : QFileSystemWatcher{parent}
-    , m_timer{new QTimer(this)}
+    : QObject{parent}
+    , p{std::make_unique<Private>(this)}
+{ }
+
+LibraryWatcher::~LibraryWatcher() = default;
+
+void LibraryWatcher::watchLibrary(const QString& path)
 {
-    m_timer->setSingleShot(true);
-    m_timer->setInterval(Interval);
-
-    QObject::connect(this, &QFileSystemWatcher::directoryChanged, this, [this](const QString& path) {
-        if(!m_dir.isEmpty() && path != m_dir) {
-            m_timer->stop();
-            emit libraryDirChanged(m_dir);
-        }
-        m_dir = path;
-        m_timer->start();
-    });
-
-    QObject::connect(m_timer, &QTimer::timeout, this, [this]() {
-        emit libraryDirChanged(m_dir);
-        m_dir.clear();
-    });
+#if defined(__linux__)
+    if(p->fd >= 0) {
+        p->roots.append(path);
+        p->addTree(path);
+        return;
+    }
+#endif
+    p->addFallbackPaths(path);
 }
 } // namespace Fooyin
 
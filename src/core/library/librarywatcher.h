@@ -19,23 +19,54 @@
 
 #pragma once
 
-#include <QFileSystemWatcher>
+#include <QObject>
+#include <QStringList>
 
-class QTimer;
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace Fooyin {
-class LibraryWatcher : public QFileSystemWatcher
+/*!
+ * File-level changes below a watched library.
+ * Paths in @c removed and @c renamed may be directories, in which case everything below them is affected.
+ */
+struct LibraryChanges
+{
+    // Files which were created or rewritten
+    QStringList modified;
+    QStringList removed;
+    std::vector<std::pair<QString, QString>> renamed;
+
+    [[nodiscard]] bool empty() const
+    {
+        return modified.empty() && removed.empty() && renamed.empty();
+    }
+};
+
+/*!
+ * Watches a library directory and everything below it.
+ * On Linux, inotify is used directly so individual file changes can be reported through @fn libraryChanged.
+ * Elsewhere, or if inotify is unavailable, QFileSystemWatcher is used and only @fn libraryDirChanged is emitted.
+ */
+class LibraryWatcher : public QObject
 {
     Q_OBJECT
 
 public:
     explicit LibraryWatcher(QObject* parent = nullptr);
+    ~LibraryWatcher() override;
+
+    /** Starts watching @p path and all of its subdirectories. */
+    void watchLibrary(const QString& path);
 
 signals:
+    /** Emitted when the contents of @p path need to be rescanned, as the exact changes aren't known. */
     void libraryDirChanged(const QString& path);
+    void libraryChanged(const LibraryChanges& changes);
 
 private:
-    QTimer* m_timer;
-    QString m_dir;
+    struct Private;
+    std::unique_ptr<Private> p;
 };
 } // namespace Fooyin
@@ -0,0 +1,278 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "replaygainscanner.h"
+
+#include "engine/loudnessanalyser.h"
+#include "engine/segmentdecoder.h"
+#include "internalcoresettings.h"
+#include "tagging/replaygain.h"
+
+#include <core/engine/audioconverter.h>
+#include <core/track.h>
+#include <utils/settings/settingsmanager.h>
+#include <utils/taskscheduler.h>
+
+#include <QDebug>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+using AlbumTracks = std::vector<Fooyin::Track>;
+
+struct TrackAnalysis
+{
+    Fooyin::LoudnessAnalyser loudness;
+    Fooyin::AudioFingerprint fingerprint;
+};
+
+QString albumKey(const Fooyin::Track& track)
+{
+    if(track.album().isEmpty()) {
+        // Treat tracks without an album as singles
+        return track.filepath();
+    }
+    return track.path() + QStringLiteral("|") + track.albumArtist() + QStringLiteral("|") + track.album();
+}
+
+std::vector<AlbumTracks> groupAlbums(const Fooyin::TrackList& tracks, bool recalculate)
+{
+    std::vector<AlbumTracks> albums;
+    std::unordered_map<QString, size_t> albumIndexes;
+
+    for(const Fooyin::Track& track : tracks) {
+        if(!track.isValid()) {
+            continue;
+        }
+
+        const QString key = albumKey(track);
+        if(const auto it = albumIndexes.find(key); it != albumIndexes.cend()) {
+            albums[it->second].push_back(track);
+        }
+        else {
+            albumIndexes.emplace(key, albums.size());
+            albums.push_back({track});
+        }
+    }
+
+    if(!recalculate) {
+        std::erase_if(albums, [](const AlbumTracks& album) {
+            return std::ranges::all_of(album, [](const Fooyin::Track& track) {
+                const auto info = Fooyin::ReplayGainInfo::fromTrack(track);
+                return info.hasTrackGain() && info.hasAlbumGain();
+            });
+        });
+    }
+
+    return albums;
+}
+} // namespace
+
+namespace Fooyin {
+struct ReplayGainScanner::Private
+{
+    ReplayGainScanner* self;
+    SettingsManager* settings;
+
+    bool fingerprints{false};
+    std::atomic<int> tracksDone{0};
+    int tracksTotal{0};
+    std::atomic<int> lastProgress{-1};
+    // Analysis is held back along with other idle work, e.g. while playing on battery
+    IdleGate idleGate;
+
+    Private(ReplayGainScanner* self_, SettingsManager* settings_)
+        : self{self_}
+        , settings{settings_}
+    { }
+
+    std::optional<TrackAnalysis> analyseTrack(const Track& track) const
+    {
+        // Only covers the track's part of the file for CUE sheet tracks
+        SegmentDecoder decoder;
+        if(!decoder.init(track)) {
+            qWarning() << "[ReplayGain] Unable to open" << track.filepath();
+            return {};
+        }
+
+        AudioFormat floatFormat{decoder.format()};
+        floatFormat.setSampleFormat(SampleFormat::Float);
+
+        LoudnessAnalyser analyser{floatFormat.sampleRate(), floatFormat.channelCount()};
+        std::optional<AudioFingerprinter> fingerprinter;
+        if(fingerprints) {
+            fingerprinter.emplace(floatFormat.sampleRate(), floatFormat.channelCount());
+        }
+
+        decoder.start();
+
+        while(self->mayRun()) {
+            AudioBuffer buffer = decoder.readBuffer();
+            if(!buffer.isValid()) {
+                decoder.stop();
+                return TrackAnalysis{analyser, fingerprinter ? fingerprinter->fingerprint() : AudioFingerprint{}};
+            }
+
+            if(buffer.format().sampleFormat() != SampleFormat::Float) {
+                buffer = Audio::convert(buffer, floatFormat);
+            }
+
+            const auto* frames = reinterpret_cast<const float*>(buffer.constData().data());
+            analyser.addFrames(frames, buffer.frameCount());
+            if(fingerprinter) {
+                fingerprinter->addFrames(frames, buffer.frameCount());
+            }
+        }
+
+        decoder.stop();
+        return {};
+    }
+
+    void analyseAlbum(AlbumTracks& album)
+    {
+        std::vector<std::optional<TrackAnalysis>> results;
+        results.reserve(album.size());
+
+        const auto cancelled = [this]() {
+            return !self->mayRun();
+        };
+
+        for(const Track& track : album) {
+            if(!self->mayRun() || !idleGate.acquire(cancelled)) {
+                return;
+            }
+            results.push_back(analyseTrack(track));
+            idleGate.release();
+            updateProgress();
+        }
+
+        std::vector<const LoudnessAnalyser*> measured;
+        float albumPeak{0.0F};
+        for(const auto& result : results) {
+            if(result) {
+                measured.push_back(&result->loudness);
+                albumPeak = std::max(albumPeak, result->loudness.peak());
+            }
+        }
+
+        const auto albumLoudness = LoudnessAnalyser::integratedLoudness(measured);
+
+        TrackList updatedTracks;
+        TrackFingerprintMap albumFingerprints;
+        for(size_t i{0}; i < album.size(); ++i) {
+            auto& result = results.at(i);
+            if(!result) {
+                continue;
+            }
+
+            ReplayGainInfo info;
+            if(const auto loudness = result->loudness.integratedLoudness()) {
+                info.trackGain = LoudnessAnalyser::ReferenceLoudness - loudness.value();
+            }
+            info.trackPeak = result->loudness.peak();
+            if(albumLoudness) {
+                info.albumGain = LoudnessAnalyser::ReferenceLoudness - albumLoudness.value();
+            }
+            info.albumPeak = albumPeak;
+
+            Track& track = album.at(i);
+            info.applyTo(track);
+            updatedTracks.push_back(track);
+
+            if(!result->fingerprint.empty() && track.isInDatabase()) {
+                albumFingerprints.emplace(track.id(), std::move(result->fingerprint));
+            }
+        }
+
+        if(!updatedTracks.empty()) {
+            emit self->calculatedTracks(updatedTracks);
+        }
+        if(!albumFingerprints.empty()) {
+            emit self->calculatedFingerprints(albumFingerprints);
+        }
+    }
+
+    void updateProgress()
+    {
+        const int done    = tracksDone.fetch_add(1, std::memory_order_relaxed) + 1;
+        const int percent = static_cast<int>(std::floor(static_cast<double>(done) / tracksTotal * 100));
+
+        // Emitted from the pool threads, so only report each step once
+        int last = lastProgress.load(std::memory_order_relaxed);
+        while(percent > last) {
+            if(lastProgress.compare_exchange_weak(last, percent, std::memory_order_relaxed)) {
+                emit self->progressChanged(percent);
+                break;
+            }
+        }
+    }
+};
+
+ReplayGainScanner::ReplayGainScanner(SettingsManager* settings, QObject* parent)
+    : Worker{parent}
+    , p{std::make_unique<Private>(this, settings)}
+{ }
+
+ReplayGainScanner::~ReplayGainScanner() = default;
+
+void ReplayGainScanner::stopThread()
+{
+    if(state() == Running) {
+        emit progressChanged(100);
+    }
+
+    setState(Idle);
+}
+
+void ReplayGainScanner::calculate(const TrackList& tracks, bool recalculate)
+{
+    setState(Running);
+
+    auto albums = groupAlbums(tracks, recalculate);
+
+    p->fingerprints = p->settings->value<Settings::Core::Internal::AudioFingerprints>();
+
+    p->tracksDone   = 0;
+    p->lastProgress = -1;
+    p->tracksTotal  = 0;
+    for(const auto& album : albums) {
+        p->tracksTotal += static_cast<int>(album.size());
+    }
+
+    if(p->tracksTotal > 0) {
+        // Whole albums are the unit of work, as album gain needs every track of the album
+        QtConcurrent::blockingMap(QThreadPool::globalInstance(), albums,
+                                  [this](AlbumTracks& album) { p->analyseAlbum(album); });
+    }
+
+    if(mayRun()) {
+        emit progressChanged(100);
+        setState(Idle);
+    }
+
+    emit finished();
+}
+} // namespace Fooyin
+
+#include "moc_replaygainscanner.cpp"
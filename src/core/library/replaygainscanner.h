@@ -0,0 +1,65 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "engine/audiofingerprint.h"
+
+#include <core/trackfwd.h>
+#include <utils/worker.h>
+
+namespace Fooyin {
+class SettingsManager;
+
+/*!
+ * Calculates ReplayGain 2.0 track and album values (EBU R128 loudness relative to -18 LUFS).
+ * Albums are analysed concurrently across the global thread pool, and each one is reported through
+ * calculatedTracks as soon as it completes, so an interrupted scan keeps what it finished.
+ * If enabled, each track's acoustic fingerprint is calculated from the same decoded audio.
+ */
+class ReplayGainScanner : public Worker
+{
+    Q_OBJECT
+
+public:
+    explicit ReplayGainScanner(SettingsManager* settings, QObject* parent = nullptr);
+    ~ReplayGainScanner() override;
+
+    void stopThread() override;
+
+signals:
+    void progressChanged(int percent);
+    /** Emitted once per album with the tracks' ReplayGain tags updated. */
+    void calculatedTracks(const TrackList& tracks);
+    /** Emitted once per album with the fingerprints of its tracks, if fingerprinting is enabled. */
+    void calculatedFingerprints(const TrackFingerprintMap& fingerprints);
+
+public slots:
+    /*!
+     * Calculates ReplayGain for @p tracks.
+     * Albums whose tracks all have track and album values are skipped unless @p recalculate is true,
+     * which makes it cheap to resume a scan over the same tracks.
+     */
+    void calculate(const TrackList& tracks, bool recalculate);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -0,0 +1,182 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scanmetrics.h"
+
+#include <QDebug>
+
+#include <numeric>
+#include <ranges>
+
+constexpr double MicrosPerSecond  = 1000000.0;
+constexpr double MicrosPerMilli   = 1000.0;
+constexpr double BytesPerMegabyte = 1024.0 * 1024.0;
+
+namespace {
+using Fooyin::ScanMetrics;
+
+constexpr std::array<const char*, ScanMetrics::ErrorCount> ErrorNames{"unreadable", "unsupported", "cue", "archive",
+                                                                      "database"};
+
+double perSecond(uint64_t count, uint64_t micros)
+{
+    return micros > 0 ? static_cast<double>(count) * MicrosPerSecond / static_cast<double>(micros) : 0.0;
+}
+
+QString millis(double micros)
+{
+    return QString::number(micros / MicrosPerMilli, 'f', 2);
+}
+
+QString formatTimes(const Fooyin::Histogram& histogram)
+{
+    return QStringLiteral("%1 ms mean, p99 %2 ms (%3)")
+        .arg(millis(histogram.mean()), millis(static_cast<double>(histogram.percentile(99))))
+        .arg(histogram.count());
+}
+
+QString keyValues(const QString& key, const Fooyin::Histogram& histogram)
+{
+    return QStringLiteral("%1_count=%2 %1_mean_us=%3 %1_p99_us=%4")
+        .arg(key)
+        .arg(histogram.count())
+        .arg(histogram.mean(), 0, 'f', 0)
+        .arg(histogram.percentile(99));
+}
+} // namespace
+
+namespace Fooyin {
+void ScanMetrics::addRead(const QString& extension, uint64_t time)
+{
+    readTimes[extension].add(time);
+    ++tracksRead;
+}
+
+void ScanMetrics::addError(Error error)
+{
+    ++errors.at(static_cast<size_t>(error));
+}
+
+void ScanMetrics::merge(const ScanMetrics& other)
+{
+    for(const auto& [extension, times] : other.readTimes) {
+        readTimes[extension].merge(times);
+    }
+    databaseWriteTime.merge(other.databaseWriteTime);
+
+    tracksRead += other.tracksRead;
+    bytesRead += other.bytesRead;
+
+    for(size_t i{0}; i < ErrorCount; ++i) {
+        errors.at(i) += other.errors.at(i);
+    }
+}
+
+uint64_t ScanMetrics::errorCount() const
+{
+    return std::accumulate(errors.cbegin(), errors.cend(), uint64_t{0});
+}
+
+uint64_t ScanMetrics::errorCount(Error error) const
+{
+    return errors.at(static_cast<size_t>(error));
+}
+
+Histogram ScanMetrics::totalReadTime() const
+{
+    Histogram total;
+    for(const auto& times : readTimes | std::views::values) {
+        total.merge(times);
+    }
+    return total;
+}
+
+double ScanMetrics::filesPerSecond() const
+{
+    return perSecond(filesDiscovered, discoveryTime);
+}
+
+double ScanMetrics::tracksPerSecond() const
+{
+    return perSecond(tracksRead, elapsed);
+}
+
+QStringList ScanMetrics::summary() const
+{
+    QStringList lines;
+
+    lines.append(QStringLiteral("Found %1 files in %2 s (%3/s), read %4 in %5 s (%6/s), %7 MB read")
+                     .arg(filesDiscovered)
+                     .arg(static_cast<double>(discoveryTime) / MicrosPerSecond, 0, 'f', 1)
+                     .arg(filesPerSecond(), 0, 'f', 0)
+                     .arg(tracksRead)
+                     .arg(static_cast<double>(elapsed) / MicrosPerSecond, 0, 'f', 1)
+                     .arg(tracksPerSecond(), 0, 'f', 0)
+                     .arg(static_cast<double>(bytesRead) / BytesPerMegabyte, 0, 'f', 1));
+
+    if(!readTimes.empty()) {
+        QStringList formats;
+        for(const auto& [extension, times] : readTimes) {
+            formats.append(extension + QStringLiteral(" ") + formatTimes(times));
+        }
+        lines.append(QStringLiteral("Tag reads: %1; %2").arg(formatTimes(totalReadTime()), formats.join(u", ")));
+    }
+
+    if(databaseWriteTime.count() > 0) {
+        lines.append(QStringLiteral("Database writes: %1").arg(formatTimes(databaseWriteTime)));
+    }
+
+    QStringList errorCounts;
+    for(size_t i{0}; i < ErrorCount; ++i) {
+        if(errors.at(i) > 0) {
+            errorCounts.append(QStringLiteral("%1 %2").arg(errors.at(i)).arg(QString::fromLatin1(ErrorNames.at(i))));
+        }
+    }
+    lines.append(QStringLiteral("Errors: %1")
+                     .arg(errorCounts.empty() ? QStringLiteral("none") : errorCounts.join(QStringLiteral(", "))));
+
+    return lines;
+}
+
+void ScanMetrics::log() const
+{
+    QStringList fields{
+        QStringLiteral("library=\"%1\"").arg(libraryName),
+        QStringLiteral("elapsed_us=%1").arg(elapsed),
+        QStringLiteral("discovery_us=%1").arg(discoveryTime),
+        QStringLiteral("files=%1").arg(filesDiscovered),
+        QStringLiteral("files_per_s=%1").arg(filesPerSecond(), 0, 'f', 1),
+        QStringLiteral("tracks=%1").arg(tracksRead),
+        QStringLiteral("tracks_per_s=%1").arg(tracksPerSecond(), 0, 'f', 1),
+        QStringLiteral("bytes=%1").arg(bytesRead),
+        keyValues(QStringLiteral("read"), totalReadTime()),
+    };
+
+    for(const auto& [extension, times] : readTimes) {
+        fields.append(keyValues(QStringLiteral("read_") + extension, times));
+    }
+    fields.append(keyValues(QStringLiteral("db_write"), databaseWriteTime));
+
+    for(size_t i{0}; i < ErrorCount; ++i) {
+        fields.append(QStringLiteral("errors_%1=%2").arg(QString::fromLatin1(ErrorNames.at(i))).arg(errors.at(i)));
+    }
+
+    qInfo().noquote() << "[LibraryScanner] Scan finished:" << fields.join(u' ');
+}
+} // namespace Fooyin
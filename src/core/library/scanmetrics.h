@@ -0,0 +1,89 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <utils/histogram.h>
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+#include <array>
+#include <cstdint>
+#include <map>
+
+namespace Fooyin {
+/*!
+ * Throughput and health of a single library scan, to tell whether a slow scan is waiting on the disk,
+ * on parsing tags or on the database.
+ * All times are in microseconds.
+ */
+struct FYCORE_EXPORT ScanMetrics
+{
+    enum class Error : uint8_t
+    {
+        // The file couldn't be opened or read
+        Unreadable = 0,
+        // The file was read, but isn't in a format we can read tags from
+        Unsupported,
+        CueSheet,
+        Archive,
+        Database,
+    };
+    static constexpr size_t ErrorCount = 5;
+
+    int libraryId{-1};
+    QString libraryName;
+
+    uint64_t elapsed{0};
+    // Time spent finding files, which overlaps with reading them
+    uint64_t discoveryTime{0};
+    uint64_t filesDiscovered{0};
+    uint64_t tracksRead{0};
+    // Bytes read from track files, not counting archives
+    uint64_t bytesRead{0};
+
+    // Time taken to read a file's metadata, by lowercase file extension
+    std::map<QString, Histogram> readTimes;
+    Histogram databaseWriteTime;
+    std::array<uint64_t, ErrorCount> errors{};
+
+    void addRead(const QString& extension, uint64_t time);
+    void addError(Error error);
+    /** Adds the reads, bytes and errors counted by @p other, e.g. those of a reader thread. */
+    void merge(const ScanMetrics& other);
+
+    [[nodiscard]] uint64_t errorCount() const;
+    [[nodiscard]] uint64_t errorCount(Error error) const;
+    [[nodiscard]] Histogram totalReadTime() const;
+
+    [[nodiscard]] double filesPerSecond() const;
+    [[nodiscard]] double tracksPerSecond() const;
+
+    /** Returns a human readable line for each group of metrics. */
+    [[nodiscard]] QStringList summary() const;
+    /** Logs the metrics as a single line of space-separated key=value pairs. */
+    void log() const;
+};
+} // namespace Fooyin
+
+Q_DECLARE_METATYPE(Fooyin::ScanMetrics)
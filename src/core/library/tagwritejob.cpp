@@ -0,0 +1,210 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tagwritejob.h"
+
+#include <core/track.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/sysmacros.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+
+// Concurrent writers for a single spinning disk
+constexpr auto RotationalWriters = 1;
+// Concurrent writers for a single solid state drive
+constexpr auto SolidStateWriters = 4;
+// Concurrent writers where the type of device isn't known, e.g. network filesystems
+constexpr auto DefaultWriters = 2;
+// Concurrent writers across all devices
+constexpr auto MaxWriters = 8;
+
+namespace {
+// Indexes of tracks written one after another by the same writer
+using WriteLane = std::vector<size_t>;
+
+int deviceWriters([[maybe_unused]] dev_t device)
+{
+#if defined(__linux__)
+    const QString devicePath
+        = QFileInfo{QStringLiteral("/sys/dev/block/%1:%2").arg(major(device)).arg(minor(device))}.canonicalFilePath();
+    if(devicePath.isEmpty()) {
+        return DefaultWriters;
+    }
+
+    // Partitions don't have a queue of their own, so fall back to the disk they're on
+    for(const QString& path : {devicePath, QFileInfo{devicePath}.path()}) {
+        QFile rotational{path + QStringLiteral("/queue/rotational")};
+        if(rotational.open(QIODevice::ReadOnly)) {
+            return rotational.readAll().trimmed() == "1" ? RotationalWriters : SolidStateWriters;
+        }
+    }
+#endif
+    return DefaultWriters;
+}
+
+std::vector<WriteLane> groupLanes(const Fooyin::TrackList& tracks)
+{
+    // Tracks sharing a file always go to the same writer, so a file is never written by two at once
+    std::map<dev_t, std::map<QString, WriteLane>> deviceFiles;
+
+    for(size_t i{0}; i < tracks.size(); ++i) {
+        const QString filepath = tracks.at(i).filepath();
+
+        struct stat info;
+        const dev_t device = ::stat(filepath.toLocal8Bit().constData(), &info) == 0 ? info.st_dev : 0;
+        deviceFiles[device][filepath].push_back(i);
+    }
+
+    std::vector<WriteLane> lanes;
+
+    for(const auto& [device, files] : deviceFiles) {
+        const auto writers = std::min(static_cast<size_t>(deviceWriters(device)), files.size());
+        const size_t first = lanes.size();
+        lanes.resize(first + writers);
+
+        size_t file{0};
+        for(const auto& [filepath, indexes] : files) {
+            auto& lane = lanes.at(first + (file++ % writers));
+            lane.insert(lane.end(), indexes.cbegin(), indexes.cend());
+        }
+    }
+
+    return lanes;
+}
+} // namespace
+
+namespace Fooyin {
+struct TagWriteJob::Private
+{
+    TagWriteJob* self;
+
+    QThreadPool writers;
+    std::atomic<int> tracksDone{0};
+    int tracksTotal{0};
+    std::atomic<int> lastProgress{-1};
+
+    explicit Private(TagWriteJob* self_)
+        : self{self_}
+    {
+        writers.setMaxThreadCount(MaxWriters);
+    }
+
+    void updateProgress()
+    {
+        const int done    = tracksDone.fetch_add(1, std::memory_order_relaxed) + 1;
+        const int percent = static_cast<int>(std::floor(static_cast<double>(done) / tracksTotal * 100));
+
+        // Emitted from the pool threads, so only report each step once
+        int last = lastProgress.load(std::memory_order_relaxed);
+        while(percent > last) {
+            if(lastProgress.compare_exchange_weak(last, percent, std::memory_order_relaxed)) {
+                emit self->progressChanged(percent);
+                break;
+            }
+        }
+    }
+};
+
+TagWriteJob::TagWriteJob(QObject* parent)
+    : Worker{parent}
+    , p{std::make_unique<Private>(this)}
+{ }
+
+TagWriteJob::~TagWriteJob() = default;
+
+void TagWriteJob::stopThread()
+{
+    if(state() == Running) {
+        emit progressChanged(100);
+    }
+
+    setState(Idle);
+}
+
+void TagWriteJob::write(const TrackList& tracks, const Tagging::WriteOptions& options)
+{
+    setState(Running);
+
+    TrackList tracksToWrite{tracks};
+    std::vector<Tagging::WriteResult> results(tracksToWrite.size(), Tagging::WriteResult::Failed);
+    std::vector<WriteLane> lanes = groupLanes(tracksToWrite);
+
+    p->tracksDone   = 0;
+    p->lastProgress = -1;
+    p->tracksTotal  = static_cast<int>(tracksToWrite.size());
+
+    if(p->tracksTotal > 0) {
+        const auto writeLane = [this, &tracksToWrite, &results, &options](const WriteLane& lane) {
+            for(const size_t index : lane) {
+                if(!mayRun()) {
+                    return;
+                }
+                results[index] = Tagging::writeMetaData(tracksToWrite[index], options);
+                p->updateProgress();
+            }
+        };
+        QtConcurrent::blockingMap(&p->writers, lanes, writeLane);
+    }
+
+    TrackList written;
+    QStringList rewritten;
+
+    for(size_t i{0}; i < tracksToWrite.size(); ++i) {
+        const auto result = results.at(i);
+        if(result != Tagging::WriteResult::Failed) {
+            written.push_back(tracksToWrite.at(i));
+        }
+        if(result == Tagging::WriteResult::Rewritten) {
+            rewritten.push_back(tracksToWrite.at(i).filepath());
+        }
+    }
+
+    if(!rewritten.empty()) {
+        qInfo() << "[TagWriter]" << rewritten.size() << "of" << written.size()
+                << "writes didn't fit in the existing tags and rewrote the whole file:" << rewritten;
+    }
+
+    // Files already written are reported even if stopped, so the database doesn't fall behind them
+    if(!written.empty()) {
+        emit writtenTracks(written);
+    }
+
+    if(mayRun()) {
+        emit progressChanged(100);
+        setState(Idle);
+    }
+
+    emit finished();
+}
+} // namespace Fooyin
+
+#include "moc_tagwritejob.cpp"
@@ -0,0 +1,59 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include "tagging/tagwriter.h"
+
+#include <core/trackfwd.h>
+#include <utils/worker.h>
+
+namespace Fooyin {
+/*!
+ * Writes the metadata of a TrackList to their files in parallel.
+ * Files are grouped by the device they're stored on, and each device is given a bounded number of writers:
+ * a single one for spinning disks, so writes don't fight over the heads, and several for solid state drives.
+ * The tracks written are reported together once the job ends, so the database can be updated in one transaction.
+ * Writes which had to rewrite the whole file rather than just its tags are logged at the end of each job.
+ */
+class FYCORE_EXPORT TagWriteJob : public Worker
+{
+    Q_OBJECT
+
+public:
+    explicit TagWriteJob(QObject* parent = nullptr);
+    ~TagWriteJob() override;
+
+    void stopThread() override;
+
+signals:
+    void progressChanged(int percent);
+    /** Emitted once per job with the tracks whose files were written, including when stopped early. */
+    void writtenTracks(const TrackList& tracks);
+
+public slots:
+    void write(const TrackList& tracks, const Tagging::WriteOptions& options = {});
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
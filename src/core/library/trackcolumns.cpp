@@ -0,0 +1,254 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/library/trackcolumns.h>
+
+#include <core/track.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+// Rows selected per word of the output
+constexpr size_t BlockRows = 64;
+// Bits sorted per radix sort pass
+constexpr int RadixBits = 8;
+constexpr size_t Buckets = size_t{1} << RadixBits;
+constexpr int Passes     = 64 / RadixBits;
+
+namespace {
+using Fooyin::TrackQuery;
+using Field = TrackQuery::Field;
+
+// Calls @p hit for each row so each 64 become a word of @p words, with no branch on the result
+template <typename Hit>
+void selectRows(size_t count, std::span<uint64_t> words, Hit hit)
+{
+    const size_t fullWords = count / BlockRows;
+
+    for(size_t word{0}; word < fullWords; ++word) {
+        const size_t base = word * BlockRows;
+        uint64_t bits{0};
+        for(size_t bit{0}; bit < BlockRows; ++bit) {
+            bits |= static_cast<uint64_t>(hit(base + bit)) << bit;
+        }
+        words[word] = bits;
+    }
+
+    if(const size_t remaining = count % BlockRows; remaining > 0) {
+        const size_t base = fullWords * BlockRows;
+        uint64_t bits{0};
+        for(size_t bit{0}; bit < remaining; ++bit) {
+            bits |= static_cast<uint64_t>(hit(base + bit)) << bit;
+        }
+        words[fullWords] = bits;
+    }
+}
+
+// Maps a double to an unsigned key with the same order, with NaN lowest
+uint64_t orderedKey(double value)
+{
+    if(std::isnan(value)) {
+        return 0;
+    }
+    // -0 and +0 are equal
+    const auto bits = std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value);
+    constexpr uint64_t SignBit = uint64_t{1} << 63;
+    return (bits & SignBit) ? ~bits : bits | SignBit;
+}
+} // namespace
+
+namespace Fooyin {
+bool TrackColumns::isNumericColumn(Field field)
+{
+    return TrackQuery::isNumeric(field) || TrackQuery::isTime(field);
+}
+
+bool TrackColumns::isDictionaryColumn(Field field)
+{
+    return field == Field::Genre || field == Field::Extension;
+}
+
+void TrackColumns::build(const TrackList& tracks)
+{
+    clear();
+
+    m_size = tracks.size();
+
+    for(size_t i{0}; i < FieldCount; ++i) {
+        const auto field = static_cast<Field>(i);
+
+        if(isNumericColumn(field)) {
+            auto& column = m_numeric.at(i);
+            column.reserve(tracks.size());
+            for(const Track& track : tracks) {
+                column.push_back(
+                    TrackQuery::numericValue(track, field).value_or(std::numeric_limits<double>::quiet_NaN()));
+            }
+        }
+        else if(isDictionaryColumn(field)) {
+            DictionaryColumn& column = m_text.at(i);
+            column.offsets.reserve(tracks.size() + 1);
+            column.codes.reserve(tracks.size());
+            column.offsets.push_back(0);
+
+            std::unordered_map<QString, uint32_t> codes;
+            for(const Track& track : tracks) {
+                QStringList values = TrackQuery::textValues(track, field);
+                values.removeDuplicates();
+                for(const QString& value : values) {
+                    const auto [it, inserted] = codes.try_emplace(value, static_cast<uint32_t>(codes.size()));
+                    if(inserted) {
+                        column.dictionary.push_back(value);
+                    }
+                    column.codes.push_back(it->second);
+                }
+                column.offsets.push_back(static_cast<uint32_t>(column.codes.size()));
+            }
+        }
+    }
+}
+
+void TrackColumns::clear()
+{
+    m_size = 0;
+    for(auto& column : m_numeric) {
+        column.clear();
+    }
+    for(auto& column : m_text) {
+        column = {};
+    }
+}
+
+size_t TrackColumns::size() const
+{
+    return m_size;
+}
+
+std::span<const double> TrackColumns::values(Field field) const
+{
+    return m_numeric.at(static_cast<size_t>(field));
+}
+
+std::span<const QString> TrackColumns::dictionary(Field field) const
+{
+    return m_text.at(static_cast<size_t>(field)).dictionary;
+}
+
+void TrackColumns::selectRange(Field field, const TrackQuery::Range& range, std::span<uint64_t> words) const
+{
+    const std::vector<double>& column = m_numeric.at(static_cast<size_t>(field));
+    if(column.size() != m_size) {
+        std::ranges::fill(words, 0);
+        return;
+    }
+
+    // Exclusive bounds become inclusive ones, so each row is two comparisons, both false for NaN
+    constexpr double Infinity = std::numeric_limits<double>::infinity();
+    const double low          = range.lowExclusive ? std::nextafter(range.low, Infinity) : range.low;
+    const double high         = range.highExclusive ? std::nextafter(range.high, -Infinity) : range.high;
+
+    const double* values = column.data();
+    selectRows(m_size, words, [values, low, high](size_t row) { return (values[row] >= low) & (values[row] <= high); });
+}
+
+void TrackColumns::selectCodes(Field field, const std::vector<bool>& codes, std::span<uint64_t> words) const
+{
+    const DictionaryColumn& column = m_text.at(static_cast<size_t>(field));
+    if(column.offsets.size() != m_size + 1) {
+        std::ranges::fill(words, 0);
+        return;
+    }
+
+    // Bytes rather than bits, as the lookup is made for every value
+    std::vector<uint8_t> marked(column.dictionary.size(), 0);
+    for(size_t code{0}; code < marked.size() && code < codes.size(); ++code) {
+        marked[code] = codes[code] ? 1 : 0;
+    }
+
+    const uint32_t* offsets = column.offsets.data();
+    const uint32_t* values  = column.codes.data();
+    selectRows(m_size, words, [offsets, values, &marked](size_t row) {
+        uint8_t hit{0};
+        for(uint32_t i{offsets[row]}; i < offsets[row + 1]; ++i) {
+            hit |= marked[values[i]];
+        }
+        return hit;
+    });
+}
+
+std::vector<uint32_t> TrackColumns::radixSort(std::span<const double> keys, Qt::SortOrder order)
+{
+    const size_t count = keys.size();
+
+    std::vector<uint32_t> rows(count);
+    std::iota(rows.begin(), rows.end(), 0);
+    if(count < 2) {
+        return rows;
+    }
+
+    // Inverting the keys reverses their order while equal keys stay in place, keeping the sort stable
+    const uint64_t flip = order == Qt::DescendingOrder ? ~uint64_t{0} : 0;
+
+    std::vector<uint64_t> sortKeys(count);
+    std::array<std::array<uint32_t, Buckets>, Passes> counts{};
+    for(size_t i{0}; i < count; ++i) {
+        const uint64_t key = orderedKey(keys[i]) ^ flip;
+        sortKeys[i]        = key;
+        for(int pass{0}; pass < Passes; ++pass) {
+            ++counts[pass][(key >> (pass * RadixBits)) & (Buckets - 1)];
+        }
+    }
+
+    std::vector<uint64_t> nextKeys(count);
+    std::vector<uint32_t> nextRows(count);
+
+    for(int pass{0}; pass < Passes; ++pass) {
+        auto& buckets    = counts[pass];
+        const int shift  = pass * RadixBits;
+        const auto first = (sortKeys.front() >> shift) & (Buckets - 1);
+
+        // Every key has the same digit, so this pass wouldn't move anything
+        if(buckets[first] == count) {
+            continue;
+        }
+
+        uint32_t offset{0};
+        for(uint32_t& bucket : buckets) {
+            const uint32_t size = bucket;
+            bucket              = offset;
+            offset += size;
+        }
+
+        for(size_t i{0}; i < count; ++i) {
+            const uint32_t position = buckets[(sortKeys[i] >> shift) & (Buckets - 1)]++;
+            nextKeys[position]      = sortKeys[i];
+            nextRows[position]      = rows[i];
+        }
+
+        sortKeys.swap(nextKeys);
+        rows.swap(nextRows);
+    }
+
+    return rows;
+}
+} // namespace Fooyin
@@ -19,11 +19,15 @@
 
 #include "trackdatabasemanager.h"
 
+#include "database/databasemaintenance.h"
 #include "database/trackdatabase.h"
-#include "tagging/tagwriter.h"
 
 #include <core/track.h>
+#include <utils/crossthreadstats.h>
 #include <utils/database/dbconnectionhandler.h>
+#include <utils/startuptrace.h>
+
+#include <QElapsedTimer>
 
 namespace Fooyin {
 TrackDatabaseManager::TrackDatabaseManager(DbConnectionPoolPtr dbPool, QObject* parent)
@@ -41,24 +45,60 @@ void TrackDatabaseManager::initialiseThread()
 
 void TrackDatabaseManager::getAllTracks()
 {
-    const TrackList tracks = m_trackDatabase.getAllTracks();
-    emit gotTracks(tracks);
+    StartupTrace::Scope trace{"TrackDatabaseManager::getAllTracks"};
+
+    QElapsedTimer timer;
+    timer.start();
+
+    size_t count{0};
+
+    auto cursor = m_trackDatabase.cursor(TrackDatabase::Projection::Light);
+    do {
+        auto tracks = std::make_shared<const TrackList>(cursor.nextPage());
+        count += tracks->size();
+        emit gotTracks(tracks, cursor.atEnd());
+    } while(!cursor.atEnd() && !closing());
+
+    qDebug() << "[DB] Loaded" << count << "tracks in" << timer.elapsed() << "ms";
+    trace.end();
+
+    hydrateAllTracks();
 }
 
-void TrackDatabaseManager::updateTracks(const TrackList& tracks)
+void TrackDatabaseManager::hydrateAllTracks()
 {
-    TrackList tracksUpdated;
+    const StartupTrace::Scope trace{"TrackDatabaseManager::hydrateAllTracks"};
+
+    QElapsedTimer timer;
+    timer.start();
 
-    for(const Track& track : tracks) {
-        Track updatedTrack{track};
-        if(Tagging::writeMetaData(updatedTrack) && m_trackDatabase.updateTrack(updatedTrack)) {
-            tracksUpdated.emplace_back(updatedTrack);
-        }
+    size_t count{0};
+
+    auto cursor = m_trackDatabase.cursor(TrackDatabase::Projection::Full);
+    while(!cursor.atEnd() && !closing()) {
+        auto tracks = std::make_shared<const TrackList>(cursor.nextPage());
+        count += tracks->size();
+        emit hydratedTracks(tracks, cursor.atEnd());
     }
 
-    if(!tracksUpdated.empty()) {
-        emit updatedTracks(tracksUpdated);
+    qDebug() << "[DB] Hydrated" << count << "tracks in" << timer.elapsed() << "ms";
+}
+
+void TrackDatabaseManager::updateTracks(const TrackList& tracks)
+{
+    if(tracks.empty()) {
+        return;
+    }
+
+    // Album ids are reassigned as the tracks are stored
+    TrackList stored{tracks};
+    if(!m_trackDatabase.updateTracks(stored)) {
+        qWarning() << "[DB] Unable to update" << stored.size() << "tracks";
+        return;
     }
+
+    CrossThreadStats::recordCopy("TrackDatabaseManager::updatedTracks", stored);
+    emit updatedTracks(stored);
 }
 
 void TrackDatabaseManager::updateTrackStats(const TrackList& tracks)
@@ -66,9 +106,17 @@ void TrackDatabaseManager::updateTrackStats(const TrackList& tracks)
     m_trackDatabase.updateTrackStats(tracks);
 }
 
+void TrackDatabaseManager::storeFingerprints(const TrackFingerprintMap& fingerprints)
+{
+    m_trackDatabase.storeFingerprints(fingerprints);
+}
+
 void TrackDatabaseManager::cleanupTracks()
 {
-    m_trackDatabase.cleanupTracks();
+    using Job = DatabaseMaintenance::Job;
+    DatabaseMaintenance::run(DbConnectionProvider{m_dbPool},
+                             {Job::RemoveUnmanagedTracks, Job::MarkUnusedStats, Job::DeleteExpiredStats,
+                              Job::DeleteUnusedValues, Job::EnableIncrementalVacuum, Job::IncrementalVacuum});
 }
 } // namespace Fooyin
 
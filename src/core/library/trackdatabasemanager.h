@@ -37,13 +37,24 @@ public:
     void initialiseThread() override;
 
 signals:
-    void gotTracks(const TrackList& tracks);
+    /** Emitted for each page of light tracks read by getAllTracks, with @p last set for the final one. */
+    void gotTracks(const TrackListPtr& tracks, bool last);
+    /** Emitted for each page of full tracks read once all light tracks have been sent. */
+    void hydratedTracks(const TrackListPtr& tracks, bool last);
     void updatedTracks(const TrackList& tracks);
 
 public slots:
+    /*!
+     * Reads all tracks, first with only the fields views need so they can be shown as soon as possible,
+     * then again in full.
+     */
     void getAllTracks();
+    /** Reads all tracks in full, emitting hydratedTracks for each page. */
+    void hydrateAllTracks();
+    /** Updates @p tracks, whose files have already been written, in a single transaction. */
     void updateTracks(const TrackList& tracks);
     void updateTrackStats(const TrackList& track);
+    void storeFingerprints(const TrackFingerprintMap& fingerprints);
     void cleanupTracks();
 
 private:
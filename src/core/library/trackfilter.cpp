@@ -19,31 +19,29 @@
 
 #include <core/library/trackfilter.h>
 
+#include <core/library/tracksearchindex.h>
 #include <core/track.h>
 #include <utils/helpers.h>
 
-namespace {
-bool containsSearch(const QString& text, const QString& search)
-{
-    return text.contains(search, Qt::CaseInsensitive);
-}
+#include <QStringMatcher>
 
+namespace Fooyin::Filter {
 // TODO: Use user-defined search script
-bool matchSearch(const Fooyin::Track& track, const QString& search)
+TrackList filterTracks(const TrackList& tracks, const QString& search)
 {
     if(search.isEmpty()) {
-        return true;
+        return tracks;
     }
 
-    return containsSearch(track.artist(), search) || containsSearch(track.title(), search)
-        || containsSearch(track.album(), search) || containsSearch(track.albumArtist(), search)
-        || containsSearch(track.filename(), search);
+    const QStringMatcher matcher{TrackSearchIndex::searchKey(search)};
+
+    return Fooyin::Utils::filter(tracks, [&matcher](const Fooyin::Track& track) {
+        return matcher.indexIn(TrackSearchIndex::searchText(track)) >= 0;
+    });
 }
-} // namespace
 
-namespace Fooyin::Filter {
-TrackList filterTracks(const TrackList& tracks, const QString& search)
+TrackList filterTracks(const TrackList& tracks, const QString& search, const TrackSearchIndex& index)
 {
-    return Fooyin::Utils::filter(tracks, [search](const Fooyin::Track& track) { return matchSearch(track, search); });
+    return index.filter(tracks, search);
 }
 } // namespace Fooyin::Filter
@@ -0,0 +1,63 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/library/tracklistdiff.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace Fooyin {
+std::optional<TrackListDiff> diffTracks(const TrackList& from, const TrackList& to)
+{
+    const auto inDatabase = [](const Track& track) {
+        return track.isInDatabase();
+    };
+    if(!std::ranges::all_of(from, inDatabase) || !std::ranges::all_of(to, inDatabase)) {
+        return {};
+    }
+
+    // Tracks of @p from not yet matched, by id
+    std::unordered_multimap<int, const Track*> unmatched;
+    unmatched.reserve(from.size());
+    for(const Track& track : from) {
+        unmatched.emplace(track.id(), &track);
+    }
+
+    TrackListDiff diff;
+
+    for(const Track& track : to) {
+        const auto [begin, end] = unmatched.equal_range(track.id());
+        const auto matchIt
+            = std::find_if(begin, end, [&track](const auto& entry) { return entry.second->isSharedWith(track); });
+        if(matchIt != end) {
+            unmatched.erase(matchIt);
+        }
+        else {
+            diff.added.push_back(track);
+        }
+    }
+
+    diff.removed.reserve(unmatched.size());
+    for(const auto& [_, track] : unmatched) {
+        diff.removed.push_back(*track);
+    }
+
+    return diff;
+}
+} // namespace Fooyin
@@ -0,0 +1,818 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <core/library/trackquery.h>
+
+#include <core/library/tracksearchindex.h>
+#include <core/track.h>
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <unordered_map>
+
+// Lengths of age units in ms
+constexpr double HourMs = 60.0 * 60.0 * 1000.0;
+constexpr double DayMs  = 24.0 * HourMs;
+
+namespace {
+using Fooyin::TrackQuery;
+using Field = TrackQuery::Field;
+using Op    = TrackQuery::Op;
+using Node  = TrackQuery::Node;
+
+struct Token
+{
+    enum class Kind : uint8_t
+    {
+        Word = 0,
+        String,
+        Operator,
+        Open,
+        Close,
+    };
+
+    Kind kind{Kind::Word};
+    QString text;
+    Op op{Op::Contains};
+};
+
+bool isFieldChar(QChar ch)
+{
+    return ch.isLetter() || ch == u'_';
+}
+
+bool tokenise(const QString& query, std::vector<Token>& tokens, QString& error)
+{
+    const auto length = query.size();
+    qsizetype pos{0};
+
+    while(pos < length) {
+        const QChar ch = query.at(pos);
+
+        if(ch.isSpace()) {
+            ++pos;
+            continue;
+        }
+        if(ch == u'(' || ch == u')') {
+            tokens.push_back({ch == u'(' ? Token::Kind::Open : Token::Kind::Close, ch, {}});
+            ++pos;
+            continue;
+        }
+        if(ch == u'"') {
+            QString text;
+            ++pos;
+            while(pos < length && query.at(pos) != u'"') {
+                if(query.at(pos) == u'\\' && pos + 1 < length) {
+                    ++pos;
+                }
+                text.append(query.at(pos++));
+            }
+            if(pos >= length) {
+                error = QStringLiteral("Missing closing quote");
+                return false;
+            }
+            ++pos;
+            tokens.push_back({Token::Kind::String, text, {}});
+            continue;
+        }
+
+        const QStringView rest = QStringView{query}.mid(pos);
+        static const std::array<std::pair<QStringView, Op>, 8> operators{{{u"!=", Op::NotEqual},
+                                                                          {u"<=", Op::LessEqual},
+                                                                          {u">=", Op::GreaterEqual},
+                                                                          {u"==", Op::Equal},
+                                                                          {u"=", Op::Equal},
+                                                                          {u"<", Op::Less},
+                                                                          {u">", Op::Greater},
+                                                                          {u":", Op::Contains}}};
+        const auto opIt = std::ranges::find_if(
+            operators, [&rest](const auto& candidate) { return rest.startsWith(candidate.first); });
+        if(opIt != operators.cend()) {
+            tokens.push_back({Token::Kind::Operator, opIt->first.toString(), opIt->second});
+            pos += opIt->first.size();
+            continue;
+        }
+
+        QString word;
+        while(pos < length) {
+            const QChar wordCh = query.at(pos);
+            const bool notEqual = wordCh == u'!' && pos + 1 < length && query.at(pos + 1) == u'=';
+            if(wordCh.isSpace() || wordCh == u'(' || wordCh == u')' || wordCh == u'"' || wordCh == u'<'
+               || wordCh == u'>' || wordCh == u'=' || notEqual) {
+                break;
+            }
+            // Colons separate a field name from its value, but are kept in values such as 3:30
+            if(wordCh == u':' && std::ranges::all_of(word, isFieldChar)) {
+                break;
+            }
+            word.append(wordCh);
+            ++pos;
+        }
+        tokens.push_back({Token::Kind::Word, word, {}});
+    }
+
+    return true;
+}
+
+Field fieldFromName(const QString& name)
+{
+    static const std::unordered_map<QString, Field> fields{
+        {QStringLiteral("title"), Field::Title},
+        {QStringLiteral("artist"), Field::Artist},
+        {QStringLiteral("album"), Field::Album},
+        {QStringLiteral("albumartist"), Field::AlbumArtist},
+        {QStringLiteral("genre"), Field::Genre},
+        {QStringLiteral("composer"), Field::Composer},
+        {QStringLiteral("performer"), Field::Performer},
+        {QStringLiteral("comment"), Field::Comment},
+        {QStringLiteral("filename"), Field::Filename},
+        {QStringLiteral("path"), Field::Path},
+        {QStringLiteral("extension"), Field::Extension},
+        {QStringLiteral("year"), Field::Year},
+        {QStringLiteral("track"), Field::TrackNumber},
+        {QStringLiteral("tracknumber"), Field::TrackNumber},
+        {QStringLiteral("disc"), Field::DiscNumber},
+        {QStringLiteral("discnumber"), Field::DiscNumber},
+        {QStringLiteral("duration"), Field::Duration},
+        {QStringLiteral("length"), Field::Duration},
+        {QStringLiteral("bitrate"), Field::Bitrate},
+        {QStringLiteral("samplerate"), Field::SampleRate},
+        {QStringLiteral("channels"), Field::Channels},
+        {QStringLiteral("bitdepth"), Field::BitDepth},
+        {QStringLiteral("filesize"), Field::FileSize},
+        {QStringLiteral("playcount"), Field::PlayCount},
+        {QStringLiteral("plays"), Field::PlayCount},
+        {QStringLiteral("rating"), Field::Rating},
+        {QStringLiteral("added"), Field::Added},
+        {QStringLiteral("modified"), Field::Modified},
+        {QStringLiteral("firstplayed"), Field::FirstPlayed},
+        {QStringLiteral("lastplayed"), Field::LastPlayed},
+    };
+
+    const auto fieldIt = fields.find(name.toLower());
+    return fieldIt != fields.cend() ? fieldIt->second : Field::Tag;
+}
+
+// Returns the length of an age unit in ms, or 0 if @p unit isn't one
+double unitLength(const QString& unit)
+{
+    static const std::unordered_map<QString, double> units{
+        {QStringLiteral("h"), HourMs},
+        {QStringLiteral("hour"), HourMs},
+        {QStringLiteral("hours"), HourMs},
+        {QStringLiteral("d"), DayMs},
+        {QStringLiteral("day"), DayMs},
+        {QStringLiteral("days"), DayMs},
+        {QStringLiteral("w"), 7 * DayMs},
+        {QStringLiteral("week"), 7 * DayMs},
+        {QStringLiteral("weeks"), 7 * DayMs},
+        {QStringLiteral("month"), 30 * DayMs},
+        {QStringLiteral("months"), 30 * DayMs},
+        {QStringLiteral("y"), 365 * DayMs},
+        {QStringLiteral("year"), 365 * DayMs},
+        {QStringLiteral("years"), 365 * DayMs},
+    };
+
+    const auto unitIt = units.find(unit.toLower());
+    return unitIt != units.cend() ? unitIt->second : 0.0;
+}
+
+std::optional<double> parseDuration(const QString& value)
+{
+    // Either seconds, m:ss or h:mm:ss
+    const QStringList parts = value.split(u':');
+    if(parts.size() > 3) {
+        return {};
+    }
+
+    double seconds{0};
+    for(const QString& part : parts) {
+        bool ok{false};
+        const double number = part.toDouble(&ok);
+        if(!ok) {
+            return {};
+        }
+        seconds = (seconds * 60) + number;
+    }
+    return seconds * 1000;
+}
+
+class Parser
+{
+public:
+    explicit Parser(std::vector<Token> tokens)
+        : m_tokens{std::move(tokens)}
+    { }
+
+    bool parse(Node& root)
+    {
+        root = parseOr();
+        if(m_error.isEmpty() && !atEnd()) {
+            fail(QStringLiteral("Unexpected '%1'").arg(peek().text));
+        }
+        return m_error.isEmpty();
+    }
+
+    [[nodiscard]] QString error() const
+    {
+        return m_error;
+    }
+
+private:
+    [[nodiscard]] bool atEnd() const
+    {
+        return m_pos >= m_tokens.size();
+    }
+
+    [[nodiscard]] const Token& peek(size_t offset = 0) const
+    {
+        static const Token end{};
+        return m_pos + offset < m_tokens.size() ? m_tokens[m_pos + offset] : end;
+    }
+
+    [[nodiscard]] bool isKeyword(const char16_t* keyword, size_t offset = 0) const
+    {
+        return m_pos + offset < m_tokens.size() && peek(offset).kind == Token::Kind::Word
+            && peek(offset).text == QStringView{keyword};
+    }
+
+    void fail(const QString& error)
+    {
+        if(m_error.isEmpty()) {
+            m_error = error;
+        }
+        m_pos = m_tokens.size();
+    }
+
+    static void append(Node& parent, Node child)
+    {
+        // Flatten nested groups of the same type so evaluation can order all terms together
+        if(child.type == parent.type && child.type != Node::Type::Not && child.type != Node::Type::Predicate) {
+            std::ranges::move(child.children, std::back_inserter(parent.children));
+        }
+        else {
+            parent.children.push_back(std::move(child));
+        }
+    }
+
+    Node parseOr()
+    {
+        Node left = parseAnd();
+
+        if(!isKeyword(u"OR")) {
+            return left;
+        }
+
+        Node node;
+        node.type = Node::Type::Or;
+        append(node, std::move(left));
+
+        while(isKeyword(u"OR")) {
+            ++m_pos;
+            append(node, parseAnd());
+        }
+
+        return node;
+    }
+
+    Node parseAnd()
+    {
+        Node node;
+        node.type = Node::Type::And;
+
+        while(!atEnd() && peek().kind != Token::Kind::Close && !isKeyword(u"OR")) {
+            if(isKeyword(u"AND")) {
+                ++m_pos;
+                if(atEnd() || peek().kind == Token::Kind::Close || isKeyword(u"OR")) {
+                    fail(QStringLiteral("Expected a term after AND"));
+                }
+                continue;
+            }
+            append(node, parseNot());
+        }
+
+        if(node.children.size() == 1) {
+            return std::move(node.children.front());
+        }
+        return node;
+    }
+
+    Node parseNot()
+    {
+        if(!isKeyword(u"NOT")) {
+            return parsePrimary();
+        }
+
+        ++m_pos;
+        if(atEnd()) {
+            fail(QStringLiteral("Expected a term after NOT"));
+            return {};
+        }
+
+        Node node;
+        node.type = Node::Type::Not;
+        node.children.push_back(parseNot());
+        return node;
+    }
+
+    Node parsePrimary()
+    {
+        const Token& token = peek();
+
+        switch(token.kind) {
+            case(Token::Kind::Open): {
+                ++m_pos;
+                Node node = parseOr();
+                if(peek().kind != Token::Kind::Close || atEnd()) {
+                    fail(QStringLiteral("Missing closing bracket"));
+                }
+                ++m_pos;
+                return node;
+            }
+            case(Token::Kind::Close):
+            case(Token::Kind::Operator):
+                fail(QStringLiteral("Unexpected '%1'").arg(token.text));
+                return {};
+            case(Token::Kind::Word):
+                if(peek(1).kind == Token::Kind::Operator && m_pos + 1 < m_tokens.size()) {
+                    return parseComparison();
+                }
+                [[fallthrough]];
+            case(Token::Kind::String): {
+                ++m_pos;
+                Node node;
+                node.type           = Node::Type::Predicate;
+                node.predicate.text = TrackSearchIndex::searchKey(token.text);
+                return node;
+            }
+        }
+
+        return {};
+    }
+
+    Node parseComparison()
+    {
+        const QString name = peek().text;
+        const Op op        = peek(1).op;
+        m_pos += 2;
+
+        if(atEnd() || (peek().kind != Token::Kind::Word && peek().kind != Token::Kind::String)) {
+            fail(QStringLiteral("Missing value for '%1'").arg(name));
+            return {};
+        }
+
+        const QString value = peek().text;
+        ++m_pos;
+
+        Node node;
+        node.type = Node::Type::Predicate;
+
+        TrackQuery::Predicate& predicate = node.predicate;
+        predicate.field                  = fieldFromName(name);
+        predicate.op                     = op;
+        predicate.text                   = value.toCaseFolded();
+        predicate.number                 = value.toDouble();
+
+        if(predicate.field == Field::Tag) {
+            predicate.tag = name.toUpper();
+        }
+        else if(TrackQuery::isTime(predicate.field)) {
+            if(!parseTime(predicate, value)) {
+                fail(QStringLiteral("Expected a date or age for '%1'").arg(name));
+                return {};
+            }
+        }
+        else if(TrackQuery::isNumeric(predicate.field)) {
+            const auto number
+                = predicate.field == Field::Duration ? parseDuration(value) : std::optional<double>{[&value]() {
+                      bool ok{false};
+                      const double result = value.toDouble(&ok);
+                      return ok ? result : std::numeric_limits<double>::quiet_NaN();
+                  }()};
+            if(!number || std::isnan(*number)) {
+                fail(QStringLiteral("Expected a number for '%1'").arg(name));
+                return {};
+            }
+            predicate.number = *number;
+            if(predicate.op == Op::Contains) {
+                predicate.op = Op::Equal;
+            }
+        }
+
+        if(predicate.op == Op::NotEqual) {
+            predicate.op = Op::Equal;
+            Node notNode;
+            notNode.type = Node::Type::Not;
+            notNode.children.push_back(std::move(node));
+            return notNode;
+        }
+
+        return node;
+    }
+
+    bool parseTime(TrackQuery::Predicate& predicate, const QString& value)
+    {
+        const QDate date = QDate::fromString(value, Qt::ISODate);
+        if(date.isValid()) {
+            predicate.number = static_cast<double>(date.startOfDay().toMSecsSinceEpoch());
+            if(predicate.op == Op::Contains) {
+                predicate.op = Op::Equal;
+            }
+            return true;
+        }
+
+        // An age, either with the unit attached (30d) or following (30 days), in days if there isn't one
+        qsizetype unitStart{0};
+        while(unitStart < value.size() && (value.at(unitStart).isDigit() || value.at(unitStart) == u'.')) {
+            ++unitStart;
+        }
+
+        bool ok{false};
+        const double amount = value.first(unitStart).toDouble(&ok);
+        if(!ok) {
+            return false;
+        }
+
+        double unit{DayMs};
+        if(unitStart < value.size()) {
+            unit = unitLength(value.sliced(unitStart));
+        }
+        else if(!atEnd() && peek().kind == Token::Kind::Word && unitLength(peek().text) > 0) {
+            unit = unitLength(peek().text);
+            ++m_pos;
+        }
+        if(unit <= 0) {
+            return false;
+        }
+
+        predicate.number = amount * unit;
+        predicate.age    = true;
+        if(predicate.op == Op::Contains) {
+            predicate.op = Op::Equal;
+        }
+        return true;
+    }
+
+    std::vector<Token> m_tokens;
+    size_t m_pos{0};
+    QString m_error;
+};
+
+bool compareText(const QString& value, const TrackQuery::Predicate& predicate)
+{
+    switch(predicate.op) {
+        case(Op::Contains):
+            return value.contains(predicate.text);
+        case(Op::Equal):
+        case(Op::NotEqual):
+            return value == predicate.text;
+        case(Op::Less):
+            return value < predicate.text;
+        case(Op::LessEqual):
+            return value <= predicate.text;
+        case(Op::Greater):
+            return value > predicate.text;
+        case(Op::GreaterEqual):
+            return value >= predicate.text;
+    }
+    return false;
+}
+} // namespace
+
+namespace Fooyin {
+TrackQuery::Range TrackQuery::Predicate::range(uint64_t now) const
+{
+    Range range;
+
+    if(age) {
+        // Younger than the age means a later time
+        const double time = static_cast<double>(now) - number;
+        switch(op) {
+            case(Op::Less):
+                range.low          = time;
+                range.lowExclusive = true;
+                break;
+            case(Op::LessEqual):
+                range.low = time;
+                break;
+            case(Op::Greater):
+                range.high          = time;
+                range.highExclusive = true;
+                break;
+            case(Op::GreaterEqual):
+                range.high = time;
+                break;
+            case(Op::Contains):
+            case(Op::Equal):
+            case(Op::NotEqual):
+                range.low          = time - DayMs;
+                range.lowExclusive = true;
+                range.high         = time;
+                break;
+        }
+        return range;
+    }
+
+    // Dates cover the whole day
+    const double span = isTime(field) ? DayMs : 0.0;
+
+    switch(op) {
+        case(Op::Less):
+            range.high          = number;
+            range.highExclusive = true;
+            break;
+        case(Op::LessEqual):
+            range.high          = number + span;
+            range.highExclusive = span > 0;
+            break;
+        case(Op::Greater):
+            range.low          = number + span;
+            range.lowExclusive = span == 0;
+            break;
+        case(Op::GreaterEqual):
+            range.low = number;
+            break;
+        case(Op::Contains):
+        case(Op::Equal):
+        case(Op::NotEqual):
+            range.low           = number;
+            range.high          = number + span;
+            range.highExclusive = span > 0;
+            break;
+    }
+
+    return range;
+}
+
+TrackQuery::TrackQuery() = default;
+
+TrackQuery TrackQuery::parse(const QString& query)
+{
+    TrackQuery result;
+
+    std::vector<Token> tokens;
+    if(!tokenise(query, tokens, result.m_error)) {
+        return result;
+    }
+
+    Parser parser{std::move(tokens)};
+    if(!parser.parse(result.m_root)) {
+        result.m_error = parser.error();
+        result.m_root  = {};
+    }
+
+    return result;
+}
+
+bool TrackQuery::isValid() const
+{
+    return m_error.isEmpty();
+}
+
+bool TrackQuery::isEmpty() const
+{
+    return m_root.type == Node::Type::And && m_root.children.empty();
+}
+
+QString TrackQuery::error() const
+{
+    return m_error;
+}
+
+const TrackQuery::Node& TrackQuery::root() const
+{
+    return m_root;
+}
+
+bool TrackQuery::usesField(Field field) const
+{
+    const bool isText = field != Field::Tag && !isNumeric(field) && !isTime(field);
+
+    auto uses = [field, isText](const auto& self, const Node& node) -> bool {
+        if(node.type == Node::Type::Predicate) {
+            return node.predicate.field == field || (node.predicate.field == Field::Any && isText);
+        }
+        return std::ranges::any_of(node.children, [&self](const Node& child) { return self(self, child); });
+    };
+
+    return uses(uses, m_root);
+}
+
+bool TrackQuery::isTimeRelative() const
+{
+    auto relative = [](const auto& self, const Node& node) -> bool {
+        if(node.type == Node::Type::Predicate) {
+            return node.predicate.age;
+        }
+        return std::ranges::any_of(node.children, [&self](const Node& child) { return self(self, child); });
+    };
+
+    return relative(relative, m_root);
+}
+
+bool TrackQuery::matches(const Track& track, uint64_t now) const
+{
+    return isValid() && matches(m_root, track, now);
+}
+
+bool TrackQuery::matches(const Node& node, const Track& track, uint64_t now)
+{
+    switch(node.type) {
+        case(Node::Type::And):
+            return std::ranges::all_of(node.children,
+                                       [&track, now](const Node& child) { return matches(child, track, now); });
+        case(Node::Type::Or):
+            return std::ranges::any_of(node.children,
+                                       [&track, now](const Node& child) { return matches(child, track, now); });
+        case(Node::Type::Not):
+            return !node.children.empty() && !matches(node.children.front(), track, now);
+        case(Node::Type::Predicate):
+            return matches(node.predicate, track, now);
+    }
+    return false;
+}
+
+bool TrackQuery::matches(const Predicate& predicate, const Track& track, uint64_t now)
+{
+    if(predicate.field == Field::Any) {
+        return TrackSearchIndex::searchText(track).contains(predicate.text);
+    }
+
+    if(isNumeric(predicate.field) || isTime(predicate.field)) {
+        const auto value = numericValue(track, predicate.field);
+        return value && predicate.range(now).contains(*value);
+    }
+
+    const QStringList values = textValues(track, predicate.field, predicate.tag);
+    return std::ranges::any_of(values,
+                               [&predicate, now](const QString& value) { return matchesText(predicate, value, now); });
+}
+
+bool TrackQuery::matchesText(const Predicate& predicate, const QString& value, uint64_t now)
+{
+    // Values holding numbers order numerically
+    const bool ordered = predicate.op != Op::Contains && predicate.op != Op::Equal && predicate.op != Op::NotEqual;
+    if(ordered) {
+        bool isNumber{false};
+        predicate.text.toDouble(&isNumber);
+        if(isNumber) {
+            bool ok{false};
+            const double number = value.toDouble(&ok);
+            return ok && predicate.range(now).contains(number);
+        }
+    }
+    return compareText(value, predicate);
+}
+
+bool TrackQuery::isNumeric(Field field)
+{
+    switch(field) {
+        case(Field::Year):
+        case(Field::TrackNumber):
+        case(Field::DiscNumber):
+        case(Field::Duration):
+        case(Field::Bitrate):
+        case(Field::SampleRate):
+        case(Field::Channels):
+        case(Field::BitDepth):
+        case(Field::FileSize):
+        case(Field::PlayCount):
+        case(Field::Rating):
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool TrackQuery::isTime(Field field)
+{
+    switch(field) {
+        case(Field::Added):
+        case(Field::Modified):
+        case(Field::FirstPlayed):
+        case(Field::LastPlayed):
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::optional<double> TrackQuery::numericValue(const Track& track, Field field)
+{
+    // Zero means unknown for tag numbers and times
+    auto known = [](auto value) -> std::optional<double> {
+        if(value > 0) {
+            return static_cast<double>(value);
+        }
+        return {};
+    };
+
+    switch(field) {
+        case(Field::Year):
+            return known(track.year());
+        case(Field::TrackNumber):
+            return known(track.trackNumber());
+        case(Field::DiscNumber):
+            return known(track.discNumber());
+        case(Field::Duration):
+            return static_cast<double>(track.duration());
+        case(Field::Bitrate):
+            return static_cast<double>(track.bitrate());
+        case(Field::SampleRate):
+            return static_cast<double>(track.sampleRate());
+        case(Field::Channels):
+            return static_cast<double>(track.channels());
+        case(Field::BitDepth):
+            return static_cast<double>(track.bitDepth());
+        case(Field::FileSize):
+            return static_cast<double>(track.fileSize());
+        case(Field::PlayCount):
+            return static_cast<double>(track.playCount());
+        case(Field::Rating):
+            return static_cast<double>(track.ratingStars());
+        case(Field::Added):
+            return known(track.addedTime());
+        case(Field::Modified):
+            return known(track.modifiedTime());
+        case(Field::FirstPlayed):
+            return known(track.firstPlayed());
+        case(Field::LastPlayed):
+            return known(track.lastPlayed());
+        default:
+            return {};
+    }
+}
+
+QStringList TrackQuery::textValues(const Track& track, Field field, const QString& tag)
+{
+    QStringList values;
+
+    switch(field) {
+        case(Field::Title):
+            values = {track.title()};
+            break;
+        case(Field::Artist):
+            values = track.artists();
+            break;
+        case(Field::Album):
+            values = {track.album()};
+            break;
+        case(Field::AlbumArtist):
+            values = track.albumArtists();
+            break;
+        case(Field::Genre):
+            values = track.genres();
+            break;
+        case(Field::Composer):
+            values = {track.composer()};
+            break;
+        case(Field::Performer):
+            values = {track.performer()};
+            break;
+        case(Field::Comment):
+            values = {track.comment()};
+            break;
+        case(Field::Filename):
+            values = {track.filenameExt()};
+            break;
+        case(Field::Path):
+            values = {track.filepath()};
+            break;
+        case(Field::Extension):
+            values = {track.extension()};
+            break;
+        case(Field::Tag):
+            values = track.metaValue(tag).split(u'\037');
+            break;
+        default:
+            break;
+    }
+
+    values.removeAll(QString{});
+    for(QString& value : values) {
+        value = value.toCaseFolded();
+    }
+    return values;
+}
+} // namespace Fooyin
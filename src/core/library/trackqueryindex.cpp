@@ -0,0 +1,369 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <core/library/trackqueryindex.h>
+
+#include <core/library/trackcolumns.h>
+#include <core/library/tracksearchindex.h>
+#include <core/track.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+using Fooyin::TrackQuery;
+using Field     = TrackQuery::Field;
+using Node      = TrackQuery::Node;
+using Predicate = TrackQuery::Predicate;
+
+constexpr auto FieldCount = static_cast<size_t>(Field::Tag) + 1;
+
+// A set of rows of the index, one bit per track
+class RowSet
+{
+public:
+    RowSet() = default;
+
+    explicit RowSet(size_t size, bool filled = false)
+        : m_size{size}
+        , m_words((size + 63) / 64, filled ? ~uint64_t{0} : 0)
+    {
+        trim();
+    }
+
+    void insert(uint32_t row)
+    {
+        m_words[row / 64] |= uint64_t{1} << (row % 64);
+    }
+
+    [[nodiscard]] bool contains(uint32_t row) const
+    {
+        return (m_words[row / 64] >> (row % 64)) & 1;
+    }
+
+    // For filling directly, one bit per row
+    [[nodiscard]] std::span<uint64_t> words()
+    {
+        return m_words;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return std::ranges::all_of(m_words, [](uint64_t word) { return word == 0; });
+    }
+
+    RowSet& operator&=(const RowSet& other)
+    {
+        for(size_t i{0}; i < m_words.size(); ++i) {
+            m_words[i] &= other.m_words[i];
+        }
+        return *this;
+    }
+
+    RowSet& operator|=(const RowSet& other)
+    {
+        for(size_t i{0}; i < m_words.size(); ++i) {
+            m_words[i] |= other.m_words[i];
+        }
+        return *this;
+    }
+
+    // Removes the rows in other
+    RowSet& subtract(const RowSet& other)
+    {
+        for(size_t i{0}; i < m_words.size(); ++i) {
+            m_words[i] &= ~other.m_words[i];
+        }
+        return *this;
+    }
+
+    template <typename Func>
+    void forEach(Func&& func) const
+    {
+        for(size_t i{0}; i < m_words.size(); ++i) {
+            uint64_t word = m_words[i];
+            while(word != 0) {
+                const auto bit = static_cast<uint32_t>(std::countr_zero(word));
+                func(static_cast<uint32_t>((i * 64) + bit));
+                word &= word - 1;
+            }
+        }
+    }
+
+private:
+    void trim()
+    {
+        if(m_size % 64 != 0 && !m_words.empty()) {
+            m_words.back() &= (uint64_t{1} << (m_size % 64)) - 1;
+        }
+    }
+
+    size_t m_size{0};
+    std::vector<uint64_t> m_words;
+};
+
+bool isIndexed(const Predicate& predicate, const Fooyin::TrackSearchIndex* searchIndex)
+{
+    if(predicate.field == Field::Any) {
+        return searchIndex != nullptr;
+    }
+    return predicate.field != Field::Tag;
+}
+
+// Whether a node can be resolved from the indexes alone, without testing each track
+bool isIndexed(const Node& node, const Fooyin::TrackSearchIndex* searchIndex)
+{
+    if(node.type == Node::Type::Predicate) {
+        return isIndexed(node.predicate, searchIndex);
+    }
+    return std::ranges::all_of(node.children,
+                               [searchIndex](const Node& child) { return isIndexed(child, searchIndex); });
+}
+} // namespace
+
+namespace Fooyin {
+struct TrackQueryIndex::Private
+{
+    using TextIndex = std::unordered_map<QString, std::vector<uint32_t>>;
+
+    TrackList tracks;
+    TrackColumns columns;
+    std::array<TextIndex, FieldCount> text;
+
+    [[nodiscard]] RowSet numericRows(const Predicate& predicate, uint64_t now) const
+    {
+        RowSet rows{tracks.size()};
+        columns.selectRange(predicate.field, predicate.range(now), rows.words());
+        return rows;
+    }
+
+    [[nodiscard]] RowSet dictionaryRows(const Predicate& predicate, uint64_t now) const
+    {
+        RowSet rows{tracks.size()};
+
+        const auto dictionary = columns.dictionary(predicate.field);
+
+        std::vector<bool> codes(dictionary.size());
+        for(size_t code{0}; code < dictionary.size(); ++code) {
+            codes[code] = TrackQuery::matchesText(predicate, dictionary[code], now);
+        }
+
+        columns.selectCodes(predicate.field, codes, rows.words());
+        return rows;
+    }
+
+    [[nodiscard]] RowSet textRows(const Predicate& predicate, uint64_t now) const
+    {
+        RowSet rows{tracks.size()};
+
+        const TextIndex& index = text.at(static_cast<size_t>(predicate.field));
+
+        auto insertAll = [&rows](const std::vector<uint32_t>& list) {
+            for(const uint32_t row : list) {
+                rows.insert(row);
+            }
+        };
+
+        if(predicate.op == TrackQuery::Op::Equal) {
+            if(const auto valueIt = index.find(predicate.text); valueIt != index.cend()) {
+                insertAll(valueIt->second);
+            }
+            return rows;
+        }
+
+        // Far fewer distinct values than tracks for most fields
+        for(const auto& [value, list] : index) {
+            if(TrackQuery::matchesText(predicate, value, now)) {
+                insertAll(list);
+            }
+        }
+
+        return rows;
+    }
+
+    [[nodiscard]] RowSet searchRows(const Predicate& predicate, const TrackSearchIndex* searchIndex,
+                                    const RowSet& candidates) const
+    {
+        RowSet rows{tracks.size()};
+
+        TrackList candidateTracks;
+        std::vector<uint32_t> candidateRows;
+        candidates.forEach([this, &candidateTracks, &candidateRows](uint32_t row) {
+            candidateTracks.push_back(tracks.at(row));
+            candidateRows.push_back(row);
+        });
+
+        // Results keep the order of the candidates
+        const TrackList matched = searchIndex->filter(candidateTracks, predicate.text);
+
+        size_t candidate{0};
+        for(const Track& track : matched) {
+            while(candidate < candidateTracks.size() && !(candidateTracks.at(candidate) == track)) {
+                ++candidate;
+            }
+            if(candidate < candidateTracks.size()) {
+                rows.insert(candidateRows.at(candidate++));
+            }
+        }
+
+        return rows;
+    }
+
+    [[nodiscard]] RowSet scanRows(const Predicate& predicate, uint64_t now, const RowSet& candidates) const
+    {
+        RowSet rows{tracks.size()};
+        candidates.forEach([this, &predicate, now, &rows](uint32_t row) {
+            if(TrackQuery::matches(predicate, tracks.at(row), now)) {
+                rows.insert(row);
+            }
+        });
+        return rows;
+    }
+
+    [[nodiscard]] RowSet evaluate(const Node& node, uint64_t now, const TrackSearchIndex* searchIndex,
+                                  const RowSet& candidates) const
+    {
+        switch(node.type) {
+            case(Node::Type::Predicate): {
+                const Predicate& predicate = node.predicate;
+                RowSet rows;
+                if(predicate.field == Field::Any) {
+                    rows = searchIndex ? searchRows(predicate, searchIndex, candidates)
+                                       : scanRows(predicate, now, candidates);
+                }
+                else if(predicate.field == Field::Tag) {
+                    rows = scanRows(predicate, now, candidates);
+                }
+                else if(TrackColumns::isNumericColumn(predicate.field)) {
+                    rows = numericRows(predicate, now);
+                }
+                else if(TrackColumns::isDictionaryColumn(predicate.field)) {
+                    rows = dictionaryRows(predicate, now);
+                }
+                else {
+                    rows = textRows(predicate, now);
+                }
+                rows &= candidates;
+                return rows;
+            }
+            case(Node::Type::And): {
+                // Resolve indexed terms first so the rest are only tested against the tracks still matching
+                std::vector<const Node*> children;
+                children.reserve(node.children.size());
+                for(const Node& child : node.children) {
+                    children.push_back(&child);
+                }
+                std::ranges::stable_partition(
+                    children, [searchIndex](const Node* child) { return isIndexed(*child, searchIndex); });
+
+                RowSet rows{candidates};
+                for(const Node* child : children) {
+                    if(rows.empty()) {
+                        break;
+                    }
+                    rows &= evaluate(*child, now, searchIndex, rows);
+                }
+                return rows;
+            }
+            case(Node::Type::Or): {
+                RowSet rows{tracks.size()};
+                for(const Node& child : node.children) {
+                    rows |= evaluate(child, now, searchIndex, candidates);
+                }
+                return rows;
+            }
+            case(Node::Type::Not): {
+                RowSet rows{candidates};
+                if(!node.children.empty()) {
+                    rows.subtract(evaluate(node.children.front(), now, searchIndex, candidates));
+                }
+                return rows;
+            }
+        }
+
+        return RowSet{tracks.size()};
+    }
+};
+
+TrackQueryIndex::TrackQueryIndex()
+    : p{std::make_unique<Private>()}
+{ }
+
+TrackQueryIndex::~TrackQueryIndex() = default;
+
+void TrackQueryIndex::build(const TrackList& tracks)
+{
+    clear();
+
+    p->tracks = tracks;
+    p->columns.build(tracks);
+
+    for(size_t i{0}; i < FieldCount; ++i) {
+        const auto field = static_cast<Field>(i);
+        if(field == Field::Any || field == Field::Tag || TrackColumns::isNumericColumn(field)
+           || TrackColumns::isDictionaryColumn(field)) {
+            continue;
+        }
+
+        for(uint32_t row{0}; row < static_cast<uint32_t>(tracks.size()); ++row) {
+            QStringList values = TrackQuery::textValues(tracks.at(row), field);
+            values.removeDuplicates();
+            for(const QString& value : values) {
+                p->text.at(i)[value].push_back(row);
+            }
+        }
+    }
+}
+
+void TrackQueryIndex::clear()
+{
+    p->tracks.clear();
+    p->columns.clear();
+    for(auto& index : p->text) {
+        index.clear();
+    }
+}
+
+int TrackQueryIndex::size() const
+{
+    return static_cast<int>(p->tracks.size());
+}
+
+TrackList TrackQueryIndex::evaluate(const TrackQuery& query, uint64_t now, const TrackSearchIndex* searchIndex) const
+{
+    if(!query.isValid()) {
+        return {};
+    }
+    if(query.isEmpty()) {
+        return p->tracks;
+    }
+
+    const RowSet all{p->tracks.size(), true};
+    const RowSet rows = p->evaluate(query.root(), now, searchIndex, all);
+
+    TrackList result;
+    rows.forEach([this, &result](uint32_t row) { result.push_back(p->tracks.at(row)); });
+    return result;
+}
+} // namespace Fooyin
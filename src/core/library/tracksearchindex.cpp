@@ -0,0 +1,396 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/library/tracksearchindex.h>
+
+#include <core/track.h>
+#include <utils/lrucache.h>
+
+#include <QStringMatcher>
+
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+constexpr char16_t FieldSeparator = 0x1F;
+// Removed rows are only reclaimed once they make up half of the index
+constexpr size_t MinCompactRows = 1024;
+// Bytes of normalised text kept for tracks searched without the index
+constexpr size_t SearchTextCacheBudget = 32 * 1024 * 1024;
+
+namespace {
+// The searched fields of @p track, before they're normalised
+QString fieldText(const Fooyin::Track& track)
+{
+    const QChar separator{FieldSeparator};
+
+    QString text;
+    text.append(track.artist());
+    text.append(separator);
+    text.append(track.title());
+    text.append(separator);
+    text.append(track.album());
+    text.append(separator);
+    text.append(track.albumArtist());
+    text.append(separator);
+    text.append(track.filename());
+
+    return text;
+}
+
+/*!
+ * The normalised search text of tracks, by the text it was normalised from.
+ * Normalising costs far more than gathering the fields, so tracks which are searched without the index,
+ * i.e. by Filter::filterTracks or a TrackQuery, are only normalised once rather than on every search.
+ */
+class SearchTextCache
+{
+public:
+    QString searchKey(const QString& text)
+    {
+        {
+            const std::scoped_lock lock{m_mutex};
+            if(const QString* key = m_keys.find(text)) {
+                return *key;
+            }
+        }
+
+        QString key = Fooyin::TrackSearchIndex::searchKey(text);
+
+        const std::scoped_lock lock{m_mutex};
+        m_keys.insert(text, key, static_cast<size_t>(text.size() + key.size()) * sizeof(QChar));
+        return key;
+    }
+
+private:
+    std::mutex m_mutex;
+    Fooyin::LruCache<QString, QString> m_keys{SearchTextCacheBudget};
+};
+
+using Trigram = uint64_t;
+
+std::vector<Trigram> uniqueTrigrams(QStringView text)
+{
+    std::vector<Trigram> trigrams;
+    if(text.size() < 3) {
+        return trigrams;
+    }
+
+    trigrams.reserve(static_cast<size_t>(text.size()) - 2);
+
+    for(qsizetype i{0}; i + 2 < text.size(); ++i) {
+        const char16_t first  = text.at(i).unicode();
+        const char16_t second = text.at(i + 1).unicode();
+        const char16_t third  = text.at(i + 2).unicode();
+
+        // Searches never span fields
+        if(first == FieldSeparator || second == FieldSeparator || third == FieldSeparator) {
+            continue;
+        }
+
+        trigrams.push_back((Trigram{first} << 32) | (Trigram{second} << 16) | Trigram{third});
+    }
+
+    std::ranges::sort(trigrams);
+    const auto duplicates = std::ranges::unique(trigrams);
+    trigrams.erase(duplicates.begin(), duplicates.end());
+
+    return trigrams;
+}
+
+struct IndexData
+{
+    // Search text and track id of each row, cleared for rows which have been removed
+    std::vector<QString> texts;
+    std::vector<int> ids;
+    std::unordered_map<int, int> rows;
+    // Rows containing each trigram, in ascending order
+    std::unordered_map<Trigram, std::vector<int>> postings;
+    size_t removed{0};
+
+    void append(int id, QString text)
+    {
+        const auto row = static_cast<int>(texts.size());
+        for(const Trigram trigram : uniqueTrigrams(text)) {
+            postings[trigram].push_back(row);
+        }
+
+        rows[id] = row;
+        ids.push_back(id);
+        texts.push_back(std::move(text));
+    }
+
+    void remove(int id)
+    {
+        const auto rowIt = rows.find(id);
+        if(rowIt == rows.end()) {
+            return;
+        }
+
+        const auto row = static_cast<size_t>(rowIt->second);
+        texts[row].clear();
+        ids[row] = -1;
+        rows.erase(rowIt);
+        ++removed;
+    }
+
+    void update(const Track& track)
+    {
+        if(track.id() < 0) {
+            return;
+        }
+
+        // Not cached, as the index holds the text itself
+        QString text = Fooyin::TrackSearchIndex::searchKey(fieldText(track));
+
+        if(const auto rowIt = rows.find(track.id()); rowIt != rows.end()) {
+            if(texts[static_cast<size_t>(rowIt->second)] == text) {
+                return;
+            }
+            remove(track.id());
+        }
+
+        append(track.id(), std::move(text));
+    }
+
+    void compact()
+    {
+        if(removed < MinCompactRows || removed * 2 < texts.size()) {
+            return;
+        }
+
+        IndexData compacted;
+        compacted.texts.reserve(rows.size());
+        compacted.ids.reserve(rows.size());
+
+        for(size_t row{0}; row < texts.size(); ++row) {
+            if(ids[row] >= 0) {
+                compacted.append(ids[row], std::move(texts[row]));
+            }
+        }
+
+        *this = std::move(compacted);
+    }
+};
+
+struct Change
+{
+    Fooyin::Track track;
+    bool removed{false};
+};
+} // namespace
+
+namespace Fooyin {
+struct TrackSearchIndex::Private
+{
+    mutable std::shared_mutex mutex;
+    IndexData data;
+
+    // Changes made while a build is running, applied to its result
+    std::vector<Change> pending;
+    int building{0};
+    uint64_t generation{0};
+};
+
+TrackSearchIndex::TrackSearchIndex()
+    : p{std::make_unique<Private>()}
+{ }
+
+TrackSearchIndex::~TrackSearchIndex() = default;
+
+void TrackSearchIndex::build(const TrackList& tracks)
+{
+    uint64_t generation{0};
+    {
+        const std::unique_lock lock{p->mutex};
+        generation = ++p->generation;
+        ++p->building;
+    }
+
+    IndexData data;
+    data.texts.reserve(tracks.size());
+    data.ids.reserve(tracks.size());
+    data.rows.reserve(tracks.size());
+
+    for(const Track& track : tracks) {
+        data.update(track);
+    }
+
+    // The replaced index is freed after the lock is released
+    IndexData previous;
+    {
+        const std::unique_lock lock{p->mutex};
+
+        // A newer build or a clear supersedes this one
+        if(generation == p->generation) {
+            for(const auto& [track, removed] : p->pending) {
+                if(removed) {
+                    data.remove(track.id());
+                }
+                else {
+                    data.update(track);
+                }
+            }
+            previous = std::exchange(p->data, std::move(data));
+        }
+
+        if(--p->building == 0) {
+            p->pending.clear();
+        }
+    }
+}
+
+void TrackSearchIndex::update(const TrackList& tracks)
+{
+    const std::unique_lock lock{p->mutex};
+
+    for(const Track& track : tracks) {
+        p->data.update(track);
+        if(p->building > 0) {
+            p->pending.push_back({track, false});
+        }
+    }
+
+    p->data.compact();
+}
+
+void TrackSearchIndex::remove(const TrackList& tracks)
+{
+    const std::unique_lock lock{p->mutex};
+
+    for(const Track& track : tracks) {
+        p->data.remove(track.id());
+        if(p->building > 0) {
+            p->pending.push_back({track, true});
+        }
+    }
+
+    p->data.compact();
+}
+
+void TrackSearchIndex::clear()
+{
+    IndexData previous;
+    {
+        const std::unique_lock lock{p->mutex};
+        ++p->generation;
+        p->pending.clear();
+        previous = std::exchange(p->data, {});
+    }
+}
+
+int TrackSearchIndex::size() const
+{
+    const std::shared_lock lock{p->mutex};
+    return static_cast<int>(p->data.rows.size());
+}
+
+TrackList TrackSearchIndex::filter(const TrackList& tracks, const QString& search) const
+{
+    if(search.isEmpty()) {
+        return tracks;
+    }
+
+    const QString foldedSearch = searchKey(search);
+    // Built once, so each comparison doesn't prepare the search again
+    const QStringMatcher matcher{foldedSearch};
+
+    const std::shared_lock lock{p->mutex};
+    const IndexData& data = p->data;
+
+    // Shorter searches have no trigrams, so every indexed track is a candidate
+    const auto trigrams      = uniqueTrigrams(foldedSearch);
+    const bool useCandidates = !trigrams.empty();
+
+    std::vector<int> candidates;
+    if(useCandidates) {
+        std::vector<const std::vector<int>*> lists;
+        lists.reserve(trigrams.size());
+
+        for(const Trigram trigram : trigrams) {
+            const auto postingIt = data.postings.find(trigram);
+            if(postingIt == data.postings.end()) {
+                lists.clear();
+                break;
+            }
+            lists.push_back(&postingIt->second);
+        }
+
+        std::ranges::sort(lists, {}, [](const auto* list) { return list->size(); });
+
+        if(!lists.empty()) {
+            candidates = *lists.front();
+        }
+
+        std::vector<int> intersection;
+        for(auto listIt = std::next(lists.cbegin()); listIt < lists.cend() && !candidates.empty(); ++listIt) {
+            intersection.clear();
+            std::ranges::set_intersection(candidates, **listIt, std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+
+    TrackList result;
+
+    for(const Track& track : tracks) {
+        const auto rowIt = data.rows.find(track.id());
+        if(rowIt == data.rows.end()) {
+            if(matcher.indexIn(searchText(track)) >= 0) {
+                result.push_back(track);
+            }
+            continue;
+        }
+
+        const int row = rowIt->second;
+        if(useCandidates && !std::ranges::binary_search(candidates, row)) {
+            continue;
+        }
+        if(matcher.indexIn(data.texts[static_cast<size_t>(row)]) >= 0) {
+            result.push_back(track);
+        }
+    }
+
+    return result;
+}
+
+QString TrackSearchIndex::searchText(const Track& track)
+{
+    static SearchTextCache cache;
+    return cache.searchKey(fieldText(track));
+}
+
+QString TrackSearchIndex::searchKey(const QString& text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString key;
+    key.reserve(decomposed.size());
+
+    for(const QChar ch : decomposed) {
+        // Accents are separate combining marks once decomposed
+        if(ch.category() != QChar::Mark_NonSpacing) {
+            key.append(ch);
+        }
+    }
+
+    return key.toCaseFolded();
+}
+} // namespace Fooyin
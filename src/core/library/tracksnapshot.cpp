@@ -0,0 +1,163 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/library/tracksnapshot.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace Fooyin {
+using TrackIndexes = std::unordered_map<int, size_t>;
+using PathIndexes  = std::unordered_map<QString, size_t>;
+
+struct TrackSnapshot::Data
+{
+    TrackList tracks;
+    std::shared_ptr<const TrackIndexes> indexes;
+    // Built on first lookup, as most snapshots are never searched by path
+    mutable std::once_flag pathsIndexed;
+    mutable PathIndexes paths;
+};
+
+namespace {
+std::shared_ptr<const TrackIndexes> indexTracks(const TrackList& tracks)
+{
+    auto indexes = std::make_shared<TrackIndexes>();
+    indexes->reserve(tracks.size());
+
+    for(size_t i{0}; i < tracks.size(); ++i) {
+        indexes->emplace(tracks.at(i).id(), i);
+    }
+
+    return indexes;
+}
+} // namespace
+
+TrackSnapshot::TrackSnapshot()
+{
+    // Shared by every empty snapshot
+    static const auto empty = []() {
+        auto data     = std::make_shared<Data>();
+        data->indexes = std::make_shared<TrackIndexes>();
+        return std::shared_ptr<const Data>{std::move(data)};
+    }();
+    m_data = empty;
+}
+
+TrackSnapshot::TrackSnapshot(TrackList tracks)
+{
+    auto data     = std::make_shared<Data>();
+    data->indexes = indexTracks(tracks);
+    data->tracks  = std::move(tracks);
+    m_data        = std::move(data);
+}
+
+TrackSnapshot::TrackSnapshot(std::shared_ptr<const Data> data)
+    : m_data{std::move(data)}
+{ }
+
+bool TrackSnapshot::empty() const
+{
+    return m_data->tracks.empty();
+}
+
+size_t TrackSnapshot::size() const
+{
+    return m_data->tracks.size();
+}
+
+const TrackList& TrackSnapshot::tracks() const
+{
+    return m_data->tracks;
+}
+
+TrackList::const_iterator TrackSnapshot::begin() const
+{
+    return m_data->tracks.cbegin();
+}
+
+TrackList::const_iterator TrackSnapshot::end() const
+{
+    return m_data->tracks.cend();
+}
+
+bool TrackSnapshot::contains(int id) const
+{
+    return m_data->indexes->contains(id);
+}
+
+const Track* TrackSnapshot::track(int id) const
+{
+    if(const auto indexIt = m_data->indexes->find(id); indexIt != m_data->indexes->cend()) {
+        return &m_data->tracks.at(indexIt->second);
+    }
+    return nullptr;
+}
+
+TrackList TrackSnapshot::tracksForIds(const TrackIds& ids) const
+{
+    TrackList tracks;
+    tracks.reserve(ids.size());
+
+    for(const int id : ids) {
+        if(const Track* track = this->track(id)) {
+            tracks.push_back(*track);
+        }
+    }
+
+    return tracks;
+}
+
+const Track* TrackSnapshot::trackForPath(const QString& filepath) const
+{
+    std::call_once(m_data->pathsIndexed, [this]() {
+        auto& paths = m_data->paths;
+        paths.reserve(m_data->tracks.size());
+        for(size_t i{0}; i < m_data->tracks.size(); ++i) {
+            if(const Track& track = m_data->tracks.at(i); !track.hasCue()) {
+                paths.emplace(track.filepath(), i);
+            }
+        }
+    });
+
+    if(const auto pathIt = m_data->paths.find(filepath); pathIt != m_data->paths.cend()) {
+        return &m_data->tracks.at(pathIt->second);
+    }
+    return nullptr;
+}
+
+TrackSnapshot TrackSnapshot::updated(const TrackList& tracks) const
+{
+    if(tracks.empty()) {
+        return *this;
+    }
+
+    auto data     = std::make_shared<Data>();
+    data->tracks  = m_data->tracks;
+    data->indexes = m_data->indexes;
+
+    for(const Track& track : tracks) {
+        if(const auto indexIt = data->indexes->find(track.id()); indexIt != data->indexes->cend()) {
+            data->tracks[indexIt->second] = track;
+        }
+    }
+
+    return TrackSnapshot{std::shared_ptr<const Data>{std::move(data)}};
+}
+} // namespace Fooyin
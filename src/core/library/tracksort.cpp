@@ -19,47 +19,161 @@
 
 #include <core/library/tracksort.h>
 
+#include <core/constants.h>
+#include <core/library/trackcolumns.h>
 #include <core/scripting/scriptparser.h>
 #include <core/track.h>
 
+#include <QCollator>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <optional>
 #include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
-#include <QCollator>
+// Keys collated and sorted by each thread, as spreading fewer over threads costs more than it saves
+constexpr size_t SortChunkSize = 16384;
 
 namespace {
-Fooyin::ParsedScript parseScript(const QString& sort)
+// A range of indexes, [first, second)
+using Chunk = std::pair<size_t, size_t>;
+
+std::vector<Chunk> splitChunks(size_t count)
 {
-    static Fooyin::ScriptParser parser;
+    std::vector<Chunk> chunks;
+    for(size_t start{0}; start < count; start += SortChunkSize) {
+        chunks.emplace_back(start, std::min(count, start + SortChunkSize));
+    }
+    return chunks;
+}
 
-    return parser.parse(sort);
+// Calls @p func with each of 0..count-1, on the global thread pool if there's more than one
+template <typename Func>
+void runParallel(size_t count, const Func& func)
+{
+    if(count == 1) {
+        func(0);
+        return;
+    }
+
+    std::vector<size_t> items(count);
+    std::iota(items.begin(), items.end(), 0);
+    QtConcurrent::blockingMap(QThreadPool::globalInstance(), items, [&func](size_t item) { func(item); });
 }
-} // namespace
 
-namespace Fooyin::Sorting {
-TrackList calcSortFields(const QString& sort, const TrackList& tracks)
+// Stable sorts each chunk of @p indexes in parallel, then merges the sorted runs in pairs until one is left
+template <typename Compare>
+void mergeSort(std::vector<int>& indexes, const std::vector<Chunk>& chunks, const Compare& compare)
 {
-    return calcSortFields(parseScript(sort), tracks);
+    runParallel(chunks.size(), [&indexes, &chunks, &compare](size_t chunk) {
+        const auto begin = indexes.begin();
+        std::stable_sort(begin + static_cast<ptrdiff_t>(chunks[chunk].first),
+                         begin + static_cast<ptrdiff_t>(chunks[chunk].second), compare);
+    });
+
+    std::vector<Chunk> runs{chunks};
+    std::vector<int> buffer(indexes.size());
+
+    while(runs.size() > 1) {
+        std::vector<Chunk> merged((runs.size() + 1) / 2);
+
+        runParallel(merged.size(), [&indexes, &buffer, &runs, &merged, &compare](size_t pair) {
+            const Chunk& left = runs[pair * 2];
+            const auto from   = indexes.cbegin();
+            const auto to     = buffer.begin() + static_cast<ptrdiff_t>(left.first);
+
+            if((pair * 2) + 1 == runs.size()) {
+                std::copy(from + static_cast<ptrdiff_t>(left.first), from + static_cast<ptrdiff_t>(left.second), to);
+                merged[pair] = left;
+                return;
+            }
+
+            // Ties are taken from the left run first, so the merge stays stable
+            const Chunk& right = runs[(pair * 2) + 1];
+            std::merge(from + static_cast<ptrdiff_t>(left.first), from + static_cast<ptrdiff_t>(left.second),
+                       from + static_cast<ptrdiff_t>(right.first), from + static_cast<ptrdiff_t>(right.second), to,
+                       compare);
+            merged[pair] = {left.first, right.second};
+        });
+
+        indexes.swap(buffer);
+        runs = std::move(merged);
+    }
 }
 
-TrackList calcSortFields(const ParsedScript& sortScript, const TrackList& tracks)
+Fooyin::ParsedScript parseScript(const QString& sort)
 {
-    static ScriptParser parser;
+    // Not shared, as sorts run concurrently from several threads
+    Fooyin::ScriptParser parser;
+    return parser.parse(sort);
+}
 
-    TrackList calcTracks{tracks};
-    for(Track& track : calcTracks) {
-        track.setSort(parser.evaluate(sortScript, track));
+// Returns the field of a sort made of a single numeric variable (e.g. %duration%), so it can be sorted on
+// the numbers themselves rather than their formatted text
+std::optional<Fooyin::TrackQuery::Field> numericSortField(const Fooyin::ParsedScript& sortScript)
+{
+    using Field = Fooyin::TrackQuery::Field;
+    namespace MetaData = Fooyin::Constants::MetaData;
+
+    if(sortScript.expressions.size() != 1 || sortScript.expressions.front().type != Fooyin::Expr::Variable) {
+        return {};
     }
-    return calcTracks;
+    const auto* variable = std::get_if<QString>(&sortScript.expressions.front().value);
+    if(!variable) {
+        return {};
+    }
+
+    static const std::unordered_map<QString, Field> fields{
+        {QString::fromLatin1(MetaData::Duration), Field::Duration},
+        {QString::fromLatin1(MetaData::Year), Field::Year},
+        {QString::fromLatin1(MetaData::FileSize), Field::FileSize},
+        {QString::fromLatin1(MetaData::Bitrate), Field::Bitrate},
+        {QString::fromLatin1(MetaData::SampleRate), Field::SampleRate},
+        {QString::fromLatin1(MetaData::PlayCount), Field::PlayCount},
+        {QString::fromLatin1(MetaData::Rating), Field::Rating},
+        {QString::fromLatin1(MetaData::BitDepth), Field::BitDepth},
+        {QString::fromLatin1(MetaData::AddedTime), Field::Added},
+        {QString::fromLatin1(MetaData::LastModified), Field::Modified},
+    };
+
+    if(const auto fieldIt = fields.find(*variable); fieldIt != fields.cend()) {
+        return fieldIt->second;
+    }
+    return {};
 }
 
-TrackList sortTracks(const TrackList& tracks, Qt::SortOrder order)
+// Returns the sorted order of @p tracks, using a radix sort of the values when sorting by a numeric field
+std::vector<int> sortedOrder(const Fooyin::ParsedScript& sortScript, const Fooyin::TrackList& tracks,
+                             Qt::SortOrder order)
 {
-    TrackList sortedTracks{tracks};
+    const auto field = numericSortField(sortScript);
+    if(!field) {
+        return Fooyin::Sorting::sortIndexes(Fooyin::Sorting::calcSortKeys(sortScript, tracks), order);
+    }
 
+    std::vector<double> keys;
+    keys.reserve(tracks.size());
+    for(const Fooyin::Track& track : tracks) {
+        keys.push_back(
+            Fooyin::TrackQuery::numericValue(track, *field).value_or(std::numeric_limits<double>::quiet_NaN()));
+    }
+
+    const std::vector<uint32_t> rows = Fooyin::TrackColumns::radixSort(keys, order);
+    return {rows.cbegin(), rows.cend()};
+}
+
+auto sortComparator(Qt::SortOrder order)
+{
     QCollator collator;
     collator.setNumericMode(true);
 
-    std::ranges::stable_sort(sortedTracks, [order, collator](const Track& lhs, const Track& rhs) {
+    return [order, collator](const Fooyin::Track& lhs, const Fooyin::Track& rhs) {
         const auto cmp = collator.compare(lhs.sort(), rhs.sort());
 
         if(cmp == 0) {
@@ -69,7 +183,191 @@ TrackList sortTracks(const TrackList& tracks, Qt::SortOrder order)
             return cmp < 0;
         }
         return cmp > 0;
+    };
+}
+} // namespace
+
+namespace Fooyin::Sorting {
+TrackList calcSortFields(const QString& sort, const TrackList& tracks)
+{
+    return calcSortFields(parseScript(sort), tracks);
+}
+
+TrackList calcSortFields(const ParsedScript& sortScript, const TrackList& tracks)
+{
+    const std::vector<QString> keys = calcSortKeys(sortScript, tracks);
+
+    TrackList calcTracks{tracks};
+    for(size_t i{0}; i < calcTracks.size(); ++i) {
+        calcTracks[i].setSort(keys[i]);
+    }
+    return calcTracks;
+}
+
+std::vector<QString> calcSortKeys(const QString& sort, const TrackList& tracks)
+{
+    return calcSortKeys(parseScript(sort), tracks);
+}
+
+std::vector<QString> calcSortKeys(const ParsedScript& sortScript, const TrackList& tracks)
+{
+    return ScriptParser::evaluateEach(sortScript, tracks);
+}
+
+std::vector<int> sortIndexes(const std::vector<QString>& keys, Qt::SortOrder order)
+{
+    std::vector<int> indexes(keys.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    if(keys.size() < 2) {
+        return indexes;
+    }
+
+    const std::vector<Chunk> chunks = splitChunks(keys.size());
+
+    // Collating once per key up front makes each comparison a plain comparison of binary keys.
+    // Collators aren't safe to share between threads, so each chunk uses its own.
+    std::vector<std::vector<QCollatorSortKey>> chunkKeys(chunks.size());
+    runParallel(chunks.size(), [&keys, &chunks, &chunkKeys](size_t chunk) {
+        QCollator collator;
+        collator.setNumericMode(true);
+
+        auto& collated = chunkKeys[chunk];
+        collated.reserve(chunks[chunk].second - chunks[chunk].first);
+        for(size_t i{chunks[chunk].first}; i < chunks[chunk].second; ++i) {
+            collated.push_back(collator.sortKey(keys[i]));
+        }
     });
+
+    std::vector<QCollatorSortKey> collationKeys;
+    collationKeys.reserve(keys.size());
+    for(auto& collated : chunkKeys) {
+        std::ranges::move(collated, std::back_inserter(collationKeys));
+    }
+
+    const auto compare = [order, &collationKeys](int lhs, int rhs) {
+        const int cmp = collationKeys[lhs].compare(collationKeys[rhs]);
+        return order == Qt::AscendingOrder ? cmp < 0 : cmp > 0;
+    };
+
+    mergeSort(indexes, chunks, compare);
+
+    return indexes;
+}
+
+std::vector<int> sortIndexes(const std::vector<QString>& keys, const std::vector<int>& indexes, Qt::SortOrder order)
+{
+    std::vector<int> sortOrder(keys.size());
+    std::iota(sortOrder.begin(), sortOrder.end(), 0);
+
+    std::vector<int> validIndexes;
+    std::vector<QString> selectedKeys;
+    for(const int index : indexes) {
+        if(index >= 0 && std::cmp_less(index, keys.size())) {
+            validIndexes.push_back(index);
+            selectedKeys.push_back(keys[index]);
+        }
+    }
+
+    for(auto i{0}; const int sortedIndex : sortIndexes(selectedKeys, order)) {
+        sortOrder[validIndexes[i++]] = validIndexes[sortedIndex];
+    }
+
+    return sortOrder;
+}
+
+TrackList sortTracks(const TrackList& tracks, Qt::SortOrder order)
+{
+    std::vector<QString> keys;
+    keys.reserve(tracks.size());
+    std::ranges::transform(tracks, std::back_inserter(keys), [](const Track& track) { return track.sort(); });
+
+    return applySortOrder(tracks, sortIndexes(keys, order));
+}
+
+TrackList mergeTracks(const TrackList& tracks, const TrackList& changes, Qt::SortOrder order)
+{
+    if(changes.empty()) {
+        return tracks;
+    }
+
+    const auto compare            = sortComparator(order);
+    const TrackList sortedChanges = sortTracks(changes, order);
+
+    std::unordered_set<int> changedIds;
+    for(const Track& track : changes) {
+        if(track.isInDatabase()) {
+            changedIds.emplace(track.id());
+        }
+    }
+
+    TrackList unchanged;
+    unchanged.reserve(tracks.size());
+    std::ranges::copy_if(tracks, std::back_inserter(unchanged),
+                         [&changedIds](const Track& track) { return !changedIds.contains(track.id()); });
+
+    TrackList mergedTracks;
+    mergedTracks.reserve(unchanged.size() + sortedChanges.size());
+
+    // Changes are sorted, so each one's position is found by searching after the previous one
+    auto unchangedIt = unchanged.cbegin();
+    for(const Track& track : sortedChanges) {
+        const auto position = std::upper_bound(unchangedIt, unchanged.cend(), track, compare);
+        mergedTracks.insert(mergedTracks.end(), unchangedIt, position);
+        mergedTracks.push_back(track);
+        unchangedIt = position;
+    }
+    mergedTracks.insert(mergedTracks.end(), unchangedIt, unchanged.cend());
+
+    return mergedTracks;
+}
+
+std::vector<int> calcSortOrder(const QString& sort, const TrackList& tracks, Qt::SortOrder order)
+{
+    return calcSortOrder(parseScript(sort), tracks, order);
+}
+
+std::vector<int> calcSortOrder(const QString& sort, const TrackList& tracks, const std::vector<int>& indexes,
+                               Qt::SortOrder order)
+{
+    return calcSortOrder(parseScript(sort), tracks, indexes, order);
+}
+
+std::vector<int> calcSortOrder(const ParsedScript& sortScript, const TrackList& tracks, Qt::SortOrder order)
+{
+    return sortedOrder(sortScript, tracks, order);
+}
+
+std::vector<int> calcSortOrder(const ParsedScript& sortScript, const TrackList& tracks,
+                               const std::vector<int>& indexes, Qt::SortOrder order)
+{
+    std::vector<int> sortOrder(tracks.size());
+    std::iota(sortOrder.begin(), sortOrder.end(), 0);
+
+    std::vector<int> validIndexes;
+    TrackList tracksToSort;
+    for(const int index : indexes) {
+        if(index >= 0 && std::cmp_less(index, tracks.size())) {
+            validIndexes.push_back(index);
+            tracksToSort.push_back(tracks.at(index));
+        }
+    }
+
+    for(auto i{0}; const int sortedIndex : sortedOrder(sortScript, tracksToSort, order)) {
+        sortOrder[validIndexes[i++]] = validIndexes[sortedIndex];
+    }
+
+    return sortOrder;
+}
+
+TrackList applySortOrder(const TrackList& tracks, const std::vector<int>& sortOrder)
+{
+    TrackList sortedTracks;
+    sortedTracks.reserve(sortOrder.size());
+    for(const int index : sortOrder) {
+        sortedTracks.push_back(tracks.at(index));
+    }
+
     return sortedTracks;
 }
 
@@ -86,31 +384,12 @@ TrackList calcSortTracks(const QString& sort, const TrackList& tracks, const std
 
 TrackList calcSortTracks(const ParsedScript& sortScript, const TrackList& tracks, Qt::SortOrder order)
 {
-    const TrackList calcTracks = calcSortFields(sortScript, tracks);
-    return sortTracks(calcTracks, order);
+    return applySortOrder(tracks, calcSortOrder(sortScript, tracks, order));
 }
 
 TrackList calcSortTracks(const ParsedScript& sortScript, const TrackList& tracks, const std::vector<int>& indexes,
                          Qt::SortOrder order)
 {
-    TrackList sortedTracks{tracks};
-    TrackList tracksToSort;
-
-    auto validIndexes = indexes | std::views::filter([&tracks](int index) {
-                            return (index >= 0 && index < static_cast<int>(tracks.size()));
-                        });
-
-    for(const int index : validIndexes) {
-        tracksToSort.push_back(tracks.at(index));
-    }
-
-    const TrackList calcTracks      = calcSortFields(sortScript, tracksToSort);
-    const TrackList sortedSubTracks = sortTracks(calcTracks, order);
-
-    for(auto i{0}; const int index : validIndexes) {
-        sortedTracks[index] = sortedSubTracks.at(i++);
-    }
-
-    return sortedTracks;
+    return applySortOrder(tracks, calcSortOrder(sortScript, tracks, indexes, order));
 }
 } // namespace Fooyin::Sorting
@@ -19,29 +19,57 @@
 
 #include "unifiedmusiclibrary.h"
 
+#include "database/database.h"
+#include "database/scriptcachedatabase.h"
 #include "internalcoresettings.h"
 #include "library/libraryinfo.h"
 #include "library/librarymanager.h"
+#include "librarysnapshot.h"
 #include "librarythreadhandler.h"
 
 #include <core/coresettings.h>
+#include <core/library/groupingcache.h>
+#include <core/library/tracksearchindex.h>
 #include <core/library/tracksort.h>
+#include <core/scripting/scriptparser.h>
 #include <utils/async.h>
+#include <utils/database/dbconnectionpool.h>
 #include <utils/settings/settingsmanager.h>
+#include <utils/startuptrace.h>
 
+#include <QBasicTimer>
+#include <QTimerEvent>
+
+#include <mutex>
 #include <ranges>
+#include <unordered_set>
+#include <utility>
 
 using namespace std::chrono_literals;
 
+constexpr auto SnapshotDelay     = 2000;
+constexpr auto StatsSaveInterval = 30000;
+
 namespace {
+// The library keeps each track's sort key on the track, as merges and the snapshot file need it later
+Fooyin::TrackList calcSortTracks(const QString& sort, const Fooyin::TrackList& tracks)
+{
+    return Fooyin::Sorting::sortTracks(Fooyin::Sorting::calcSortFields(sort, tracks));
+}
+
 QFuture<Fooyin::TrackList> recalSortTracks(const QString& sort, const Fooyin::TrackList& tracks)
 {
-    return Fooyin::Utils::asyncExec([sort, tracks]() { return Fooyin::Sorting::calcSortTracks(sort, tracks); });
+    return Fooyin::Utils::asyncExec([sort, tracks]() { return calcSortTracks(sort, tracks); });
+}
+
+QFuture<Fooyin::TrackList> recalSortTracks(const QString& sort, const Fooyin::TrackSnapshot& tracks)
+{
+    return Fooyin::Utils::asyncExec([sort, tracks]() { return calcSortTracks(sort, tracks.tracks()); });
 }
 
-QFuture<Fooyin::TrackList> resortTracks(const Fooyin::TrackList& tracks)
+QFuture<Fooyin::TrackList> resortTracks(const Fooyin::TrackSnapshot& tracks)
 {
-    return Fooyin::Utils::asyncExec([tracks]() { return Fooyin::Sorting::sortTracks(tracks); });
+    return Fooyin::Utils::asyncExec([tracks]() { return Fooyin::Sorting::sortTracks(tracks.tracks()); });
 }
 } // namespace
 
@@ -56,8 +84,35 @@ struct UnifiedMusicLibrary::Private
 
     LibraryThreadHandler threadHandler;
 
-    TrackList tracks;
-    std::unordered_map<QString, Track> pendingStatUpdates;
+    // Only replaced on the main thread, under the lock as scanner threads also take snapshots
+    TrackSnapshot tracks;
+    mutable std::mutex tracksMutex;
+    // Stat changes waiting to be written, by track hash
+    TrackHashMap pendingStatUpdates;
+    QBasicTimer statsTimer;
+    // Only used to find what the sort script depends on
+    ScriptParser sortParser;
+
+    // Pages of light tracks received while loading, see TrackDatabaseManager::getAllTracks
+    TrackList loadedTracks;
+    int pendingPages{0};
+    bool allPagesReceived{false};
+    bool loading{false};
+    std::vector<std::pair<TrackList, bool>> pendingHydration;
+    // Tracks which haven't been hydrated yet, and metadata changes to them waiting until they have
+    std::unordered_set<int> lightTracks;
+    TrackList pendingMetadataUpdates;
+    // Tracks in the database which weren't in the snapshot
+    TrackList missingTracks;
+    // Startup trace phases for the initial load, ended by setLoadedTracks and finishHydrating
+    uint64_t loadTrace{0};
+    uint64_t hydrateTrace{0};
+
+    QBasicTimer snapshotTimer;
+
+    // Shared with the thread building it, which may outlive the library
+    std::shared_ptr<TrackSearchIndex> searchIndex{std::make_shared<TrackSearchIndex>()};
+    GroupingCache groupingCache;
 
     Private(UnifiedMusicLibrary* self_, LibraryManager* libraryManager_, DbConnectionPoolPtr dbPool_,
             SettingsManager* settings_)
@@ -68,45 +123,270 @@ struct UnifiedMusicLibrary::Private
         , threadHandler{dbPool, self, settings}
     { }
 
-    void loadTracks(const TrackList& trackToLoad)
+    [[nodiscard]] TrackSnapshot snapshot() const
+    {
+        const std::scoped_lock lock{tracksMutex};
+        return tracks;
+    }
+
+    void setTracks(TrackSnapshot snapshot)
     {
-        if(trackToLoad.empty()) {
-            emit self->tracksLoaded({});
+        const std::scoped_lock lock{tracksMutex};
+        tracks = std::move(snapshot);
+    }
+
+    void updateScriptCache(bool enabled)
+    {
+        if(!enabled) {
+            groupingCache.setPersistentStore(nullptr);
             return;
         }
 
-        auto sortTracks = recalSortTracks(settings->value<Settings::Core::LibrarySortScript>(), trackToLoad);
+        DbConnection::DbParams params;
+        params.type           = QStringLiteral("QSQLITE");
+        params.connectOptions = QStringLiteral("QSQLITE_OPEN_URI");
+        params.filePath       = ScriptCacheDatabase::cachePath();
+        params.profile        = Database::profile(settings);
+
+        groupingCache.setPersistentStore(DbConnectionPool::create(params, QStringLiteral("scriptcache")));
+    }
+
+    void buildSearchIndex(const TrackSnapshot& tracksToIndex) const
+    {
+        Utils::asyncExec([index = searchIndex, tracksToIndex]() { index->build(tracksToIndex.tracks()); });
+    }
+
+    void startLoading()
+    {
+        loadedTracks.clear();
+        pendingPages     = 0;
+        allPagesReceived = false;
+        loading          = true;
+        pendingHydration.clear();
+        missingTracks.clear();
+    }
+
+    void loadTracks(const TrackList& page, bool last)
+    {
+        ++pendingPages;
+        allPagesReceived = allPagesReceived || last;
+
+        // Sort keys are calculated for each page while the next one is read
+        auto sortTracks = recalSortTracks(settings->value<Settings::Core::LibrarySortScript>(), page);
 
         sortTracks.then(self, [this](const TrackList& sortedTracks) {
-            tracks = sortedTracks;
-            emit self->tracksLoaded(tracks);
+            std::ranges::copy(sortedTracks, std::back_inserter(loadedTracks));
+            if(--pendingPages == 0 && allPagesReceived) {
+                finishLoading();
+            }
+        });
+    }
+
+    void finishLoading()
+    {
+        resortTracks(TrackSnapshot{std::exchange(loadedTracks, {})}).then(self, [this](const TrackList& sortedTracks) {
+            setLoadedTracks(sortedTracks);
         });
     }
 
+    void loadSnapshot()
+    {
+        const QString sort = settings->value<Settings::Core::LibrarySortScript>();
+
+        Utils::asyncExec([sort]() {
+            const StartupTrace::Scope trace{"LibrarySnapshot::read"};
+            return LibrarySnapshot::read(LibrarySnapshot::path(), sort);
+        })
+            .then(self, [this](const TrackList& snapshotTracks) {
+                if(snapshotTracks.empty()) {
+                    threadHandler.getAllTracks();
+                    return;
+                }
+
+                qDebug() << "[Library] Loaded" << snapshotTracks.size() << "tracks from snapshot";
+
+                // Hydrating also brings the snapshot back in line with the database if they differ
+                setLoadedTracks(snapshotTracks);
+                threadHandler.hydrateAllTracks();
+            });
+    }
+
+    void setLoadedTracks(const TrackList& sortedTracks)
+    {
+        setTracks(TrackSnapshot{sortedTracks});
+        loading = false;
+
+        lightTracks.clear();
+        for(const Track& track : tracks) {
+            lightTracks.emplace(track.id());
+        }
+
+        StartupTrace::endAsync(std::exchange(loadTrace, 0));
+        emit self->tracksLoaded(tracks.tracks());
+
+        for(const auto& [page, last] : std::exchange(pendingHydration, {})) {
+            hydrateTracks(page, last);
+        }
+    }
+
+    void hydrateTracks(const TrackList& page, bool last)
+    {
+        if(loading) {
+            pendingHydration.emplace_back(page, last);
+            return;
+        }
+
+        auto sortTracks = recalSortTracks(settings->value<Settings::Core::LibrarySortScript>(), page);
+
+        sortTracks.then(self, [this, last](const TrackList& sortedTracks) {
+            // Tracks updated by a scan in the meantime are already complete, and newer
+            std::unordered_map<int, Track> hydrated;
+            TrackList hydratedTracks;
+            for(const Track& track : sortedTracks) {
+                if(lightTracks.erase(track.id()) > 0) {
+                    hydrated.emplace(track.id(), track);
+                    if(tracks.contains(track.id())) {
+                        applyPendingStats(hydratedTracks.emplace_back(track));
+                    }
+                }
+                else if(!tracks.contains(track.id())) {
+                    // Missing from the snapshot
+                    missingTracks.push_back(track);
+                }
+            }
+
+            setTracks(tracks.updated(hydratedTracks));
+
+            savePendingMetadata(hydrated);
+
+            if(!hydratedTracks.empty()) {
+                emit self->tracksUpdated(hydratedTracks);
+            }
+            if(last) {
+                finishHydrating();
+            }
+        });
+    }
+
+    void finishHydrating()
+    {
+        StartupTrace::endAsync(std::exchange(hydrateTrace, 0));
+
+        // Anything still light is no longer in the database
+        TrackList removedTracks;
+        if(!lightTracks.empty()) {
+            TrackList remainingTracks;
+            remainingTracks.reserve(tracks.size());
+            for(const Track& track : tracks) {
+                if(lightTracks.contains(track.id())) {
+                    removedTracks.push_back(track);
+                }
+                else {
+                    remainingTracks.push_back(track);
+                }
+            }
+            setTracks(TrackSnapshot{std::move(remainingTracks)});
+            lightTracks.clear();
+            pendingMetadataUpdates.clear();
+        }
+
+        if(!removedTracks.empty()) {
+            emit self->tracksDeleted(removedTracks);
+        }
+
+        if(!missingTracks.empty()) {
+            addTracks(std::exchange(missingTracks, {}));
+        }
+        else {
+            resortTracks(tracks).then(self, [this](const TrackList& sortedLibraryTracks) {
+                setTracks(TrackSnapshot{sortedLibraryTracks});
+            });
+        }
+    }
+
+    void scheduleSnapshot()
+    {
+        if(!loading) {
+            snapshotTimer.start(SnapshotDelay, self);
+        }
+    }
+
+    void writeSnapshot(bool wait)
+    {
+        snapshotTimer.stop();
+
+        auto write = [sortedTracks = tracks, sort = settings->value<Settings::Core::LibrarySortScript>()]() {
+            LibrarySnapshot::write(LibrarySnapshot::path(), sortedTracks.tracks(), sort);
+        };
+
+        if(wait) {
+            write();
+        }
+        else {
+            Utils::asyncExec(write);
+        }
+    }
+
+    void savePendingMetadata(const std::unordered_map<int, Track>& hydrated)
+    {
+        TrackList tracksToSave;
+        TrackList stillPending;
+
+        for(Track& track : pendingMetadataUpdates) {
+            const auto trackIt = hydrated.find(track.id());
+            if(trackIt == hydrated.cend()) {
+                stillPending.push_back(track);
+                continue;
+            }
+
+            // The comment and extra tags weren't loaded, so keep the ones in the database unless they were edited
+            if(track.comment().isEmpty()) {
+                track.setComment(trackIt->second.comment());
+            }
+            if(track.extraTags().empty()) {
+                track.storeExtraTags(trackIt->second.serialiseExtrasTags());
+            }
+            tracksToSave.push_back(track);
+        }
+
+        pendingMetadataUpdates = stillPending;
+
+        if(!tracksToSave.empty()) {
+            threadHandler.saveUpdatedTracks(tracksToSave);
+            threadHandler.saveUpdatedTrackStats(tracksToSave);
+        }
+    }
+
     QFuture<void> addTracks(const TrackList& newTracks)
     {
         auto sortTracks = recalSortTracks(settings->value<Settings::Core::LibrarySortScript>(), newTracks);
 
         return sortTracks.then(self, [this](const TrackList& sortedTracks) {
-            std::ranges::copy(sortedTracks, std::back_inserter(tracks));
-
-            resortTracks(tracks).then(self, [this, sortedTracks](const TrackList& sortedLibraryTracks) {
-                tracks = sortedLibraryTracks;
-                emit self->tracksAdded(sortedTracks);
-            });
+            setTracks(TrackSnapshot{Sorting::mergeTracks(tracks.tracks(), sortedTracks)});
+            emit self->tracksAdded(sortedTracks);
         });
     }
 
     void updateLibraryTracks(const TrackList& updatedTracks)
     {
-        for(const auto& track : updatedTracks) {
-            auto trackIt
-                = std::ranges::find_if(tracks, [&track](const Track& oldTrack) { return oldTrack.id() == track.id(); });
-            if(trackIt != tracks.end()) {
-                *trackIt = track;
-                trackIt->clearWasModified();
+        TrackList libraryTracks{updatedTracks};
+        for(Track& track : libraryTracks) {
+            track.clearWasModified();
+        }
+        setTracks(tracks.updated(libraryTracks));
+    }
+
+    // Moves tracks whose sort keys may have changed to their new positions, rather than resorting the library
+    void mergeLibraryTracks(const TrackList& updatedTracks)
+    {
+        TrackList libraryTracks;
+        for(const Track& track : updatedTracks) {
+            if(tracks.contains(track.id())) {
+                libraryTracks.push_back(track);
+                libraryTracks.back().clearWasModified();
             }
         }
+        setTracks(TrackSnapshot{Sorting::mergeTracks(tracks.tracks(), libraryTracks)});
     }
 
     QFuture<void> updateTracks(const TrackList& tracksToUpdate)
@@ -114,29 +394,70 @@ struct UnifiedMusicLibrary::Private
         auto sortTracks = recalSortTracks(settings->value<Settings::Core::LibrarySortScript>(), tracksToUpdate);
 
         return sortTracks.then(self, [this](const TrackList& sortedTracks) {
-            updateLibraryTracks(sortedTracks);
-
-            resortTracks(tracks).then(self, [this, sortedTracks](const TrackList& sortedLibraryTracks) {
-                tracks = sortedLibraryTracks;
-                emit self->tracksUpdated(sortedTracks);
-            });
+            // These come from the database or a scan, so are complete
+            for(const Track& track : sortedTracks) {
+                lightTracks.erase(track.id());
+            }
+            mergeLibraryTracks(sortedTracks);
+            emit self->tracksUpdated(sortedTracks);
         });
     }
 
-    QFuture<void> updatePlayedTracks(const TrackList& tracksToUpdate)
+    void updatePlayedTracks(const TrackList& tracksToUpdate)
     {
-        auto sortTracks = recalSortTracks(settings->value<Settings::Core::LibrarySortScript>(), tracksToUpdate);
+        const QString sort = settings->value<Settings::Core::LibrarySortScript>();
 
-        return sortTracks.then(self, [this](const TrackList& sortedTracks) {
-            updateLibraryTracks(sortedTracks);
+        if(!sortParser.parse(sort).dependencies.dependsOnStats()) {
+            // Sort keys can't have changed, so the tracks are replaced where they are
+            updateLibraryTracks(tracksToUpdate);
+            emit self->tracksPlayed(tracksToUpdate);
+            return;
+        }
 
-            resortTracks(tracks).then(self, [this, sortedTracks](const TrackList& sortedLibraryTracks) {
-                tracks = sortedLibraryTracks;
-                emit self->tracksPlayed(sortedTracks);
-            });
+        recalSortTracks(sort, tracksToUpdate).then(self, [this](const TrackList& sortedTracks) {
+            mergeLibraryTracks(sortedTracks);
+            emit self->tracksPlayed(sortedTracks);
         });
     }
 
+    void addStatUpdate(const Track& track)
+    {
+        pendingStatUpdates.insert_or_assign(track.hash(), track);
+        if(!statsTimer.isActive()) {
+            statsTimer.start(StatsSaveInterval, self);
+        }
+    }
+
+    // Keeps stats which haven't been written yet when a track is reread from the database
+    void applyPendingStats(Track& track) const
+    {
+        if(const auto statsIt = pendingStatUpdates.find(track.hash()); statsIt != pendingStatUpdates.cend()) {
+            const Track& stats = statsIt->second;
+            track.setPlayCount(stats.playCount());
+            track.setFirstPlayed(stats.firstPlayed());
+            track.setLastPlayed(stats.lastPlayed());
+            track.setRating(stats.rating());
+        }
+    }
+
+    void saveStatUpdates()
+    {
+        statsTimer.stop();
+
+        if(pendingStatUpdates.empty()) {
+            return;
+        }
+
+        TrackList tracksToUpdate;
+        tracksToUpdate.reserve(pendingStatUpdates.size());
+        for(const Track& track : pendingStatUpdates | std::views::values) {
+            tracksToUpdate.emplace_back(track);
+        }
+        pendingStatUpdates.clear();
+
+        threadHandler.saveUpdatedTrackStats(tracksToUpdate);
+    }
+
     void handleScanResult(const ScanResult& result)
     {
         if(!result.addedTracks.empty()) {
@@ -168,29 +489,33 @@ struct UnifiedMusicLibrary::Private
             return;
         }
 
+        applyDelta(LibraryDelta::removal(id, {tracksRemoved.cbegin(), tracksRemoved.cend()}));
+        threadHandler.libraryRemoved(id);
+    }
+
+    void relocateLibrary(const LibraryInfo& library, const QString& oldPath)
+    {
+        applyDelta(LibraryDelta::relocation(library.id, oldPath, library.path));
+        threadHandler.libraryRelocated(library, settings->value<Settings::Core::Internal::MonitorLibraries>());
+    }
+
+    // Patches the library's tracks in one pass, rather than emitting every one of them as updated or deleted
+    void applyDelta(const LibraryDelta& delta)
+    {
         TrackList newTracks;
-        TrackList removedTracks;
-        TrackList updatedTracks;
+        newTracks.reserve(tracks.size());
 
-        for(auto& track : tracks) {
-            if(track.libraryId() == id) {
-                if(tracksRemoved.contains(track.id())) {
-                    removedTracks.push_back(track);
-                    continue;
-                }
-                track.setLibraryId(-1);
-                updatedTracks.push_back(track);
-                newTracks.push_back(track);
+        for(Track track : tracks) {
+            if(delta.removes(track)) {
+                continue;
             }
+            delta.apply(track);
             newTracks.push_back(track);
         }
 
-        tracks = newTracks;
-
-        threadHandler.libraryRemoved(id);
+        setTracks(TrackSnapshot{std::move(newTracks)});
 
-        emit self->tracksDeleted(removedTracks);
-        emit self->tracksUpdated(updatedTracks);
+        emit self->libraryChanged(delta);
     }
 
     void libraryStatusChanged(const LibraryInfo& library) const
@@ -201,8 +526,8 @@ struct UnifiedMusicLibrary::Private
     void changeSort(const QString& sort)
     {
         recalSortTracks(sort, tracks).then(self, [this](const TrackList& sortedTracks) {
-            tracks = sortedTracks;
-            emit self->tracksSorted(tracks);
+            setTracks(TrackSnapshot{sortedTracks});
+            emit self->tracksSorted(tracks.tracks());
         });
     }
 };
@@ -212,14 +537,40 @@ UnifiedMusicLibrary::UnifiedMusicLibrary(LibraryManager* libraryManager, DbConne
     : MusicLibrary{parent}
     , p{std::make_unique<Private>(this, libraryManager, std::move(dbPool), settings)}
 {
+    // Connected first so the index is current for anything filtering in response to these signals
+    connect(this, &MusicLibrary::tracksLoaded, this, [this]() {
+        p->buildSearchIndex(p->tracks);
+        p->groupingCache.clear();
+    });
+    connect(this, &MusicLibrary::tracksAdded, this,
+            [this](const TrackList& tracks) { p->searchIndex->update(tracks); });
+    connect(this, &MusicLibrary::tracksUpdated, this, [this](const TrackList& tracks) {
+        p->searchIndex->update(tracks);
+        p->groupingCache.invalidate(tracks);
+    });
+    connect(this, &MusicLibrary::tracksPlayed, this,
+            [this](const TrackList& tracks) { p->groupingCache.invalidateStats(tracks); });
+    connect(this, &MusicLibrary::tracksDeleted, this, [this](const TrackList& tracks) {
+        p->searchIndex->remove(tracks);
+        p->groupingCache.invalidate(tracks);
+    });
+    connect(this, &MusicLibrary::libraryChanged, this, [this]() {
+        p->buildSearchIndex(p->tracks);
+        p->groupingCache.clear();
+    });
+
     connect(p->libraryManager, &LibraryManager::libraryAdded, this, &MusicLibrary::rescan);
     connect(p->libraryManager, &LibraryManager::libraryRemoved, this,
             [this](int id, const std::set<int>& tracksRemoved) { p->removeLibrary(id, tracksRemoved); });
+    connect(p->libraryManager, &LibraryManager::libraryRelocated, this,
+            [this](const LibraryInfo& library, const QString& oldPath) { p->relocateLibrary(library, oldPath); });
 
     connect(&p->threadHandler, &LibraryThreadHandler::progressChanged, this, &UnifiedMusicLibrary::scanProgress);
 
     connect(&p->threadHandler, &LibraryThreadHandler::statusChanged, this,
             [this](const LibraryInfo& library) { p->libraryStatusChanged(library); });
+    connect(&p->threadHandler, &LibraryThreadHandler::scanMetricsReady, p->libraryManager,
+            &LibraryManager::updateScanMetrics);
     connect(&p->threadHandler, &LibraryThreadHandler::scanUpdate, this,
             [this](const ScanResult& result) { p->handleScanResult(result); });
     connect(&p->threadHandler, &LibraryThreadHandler::scannedTracks, this,
@@ -227,7 +578,9 @@ UnifiedMusicLibrary::UnifiedMusicLibrary(LibraryManager* libraryManager, DbConne
     connect(&p->threadHandler, &LibraryThreadHandler::tracksUpdated, this,
             [this](const TrackList& tracks) { p->updateTracks(tracks); });
     connect(&p->threadHandler, &LibraryThreadHandler::gotTracks, this,
-            [this](const TrackList& tracks) { p->loadTracks(tracks); });
+            [this](const TrackListPtr& tracks, bool last) { p->loadTracks(*tracks, last); });
+    connect(&p->threadHandler, &LibraryThreadHandler::hydratedTracks, this,
+            [this](const TrackListPtr& tracks, bool last) { p->hydrateTracks(*tracks, last); });
 
     p->settings->subscribe<Settings::Core::LibrarySortScript>(this,
                                                               [this](const QString& sort) { p->changeSort(sort); });
@@ -238,29 +591,46 @@ UnifiedMusicLibrary::UnifiedMusicLibrary(LibraryManager* libraryManager, DbConne
             p->threadHandler.setupWatchers(p->libraryManager->allLibraries(),
                                            p->settings->value<Settings::Core::Internal::MonitorLibraries>());
             if(p->settings->value<Settings::Core::AutoRefresh>()) {
-                refreshAll();
+                for(const auto& library : p->libraryManager->allLibraries() | std::views::values) {
+                    p->threadHandler.refreshLibrary(library, true);
+                }
             }
         },
         Qt::QueuedConnection);
 
     p->settings->subscribe<Settings::Core::Internal::MonitorLibraries>(
         this, [this](bool enabled) { p->threadHandler.setupWatchers(p->libraryManager->allLibraries(), enabled); });
+
+    p->updateScriptCache(p->settings->value<Settings::Core::Internal::ScriptCache>());
+    p->settings->subscribe<Settings::Core::Internal::ScriptCache>(
+        this, [this](bool enabled) { p->updateScriptCache(enabled); });
+
+    const auto scheduleSnapshot = [this]() { p->scheduleSnapshot(); };
+    connect(this, &MusicLibrary::tracksLoaded, this, scheduleSnapshot);
+    connect(this, &MusicLibrary::tracksAdded, this, scheduleSnapshot);
+    connect(this, &MusicLibrary::tracksUpdated, this, scheduleSnapshot);
+    connect(this, &MusicLibrary::tracksPlayed, this, scheduleSnapshot);
+    connect(this, &MusicLibrary::tracksDeleted, this, scheduleSnapshot);
+    connect(this, &MusicLibrary::tracksSorted, this, scheduleSnapshot);
+    connect(this, &MusicLibrary::libraryChanged, this, scheduleSnapshot);
 }
 
 UnifiedMusicLibrary::~UnifiedMusicLibrary()
 {
-    if(!p->pendingStatUpdates.empty()) {
-        TrackList tracksToUpdate;
-        for(const Track& track : p->pendingStatUpdates | std::views::values) {
-            tracksToUpdate.emplace_back(track);
-        }
-        p->threadHandler.saveUpdatedTrackStats(tracksToUpdate);
+    p->saveStatUpdates();
+
+    if(p->snapshotTimer.isActive()) {
+        p->writeSnapshot(true);
     }
 }
 
 void UnifiedMusicLibrary::loadAllTracks()
 {
-    p->threadHandler.getAllTracks();
+    p->loadTrace    = StartupTrace::beginAsync("Library::loadAllTracks");
+    p->hydrateTrace = StartupTrace::beginAsync("Library::hydrateTracks");
+
+    p->startLoading();
+    p->loadSnapshot();
 }
 
 void UnifiedMusicLibrary::refreshAll()
@@ -294,6 +664,21 @@ ScanRequest UnifiedMusicLibrary::scanTracks(const TrackList& tracks)
     return p->threadHandler.scanTracks(tracks);
 }
 
+ScanRequest UnifiedMusicLibrary::calculateReplayGain(const TrackList& tracks, bool recalculate)
+{
+    return p->threadHandler.calculateReplayGain(tracks, recalculate);
+}
+
+ScanRequest UnifiedMusicLibrary::convertTracks(const TrackList& tracks, const ConversionOptions& options)
+{
+    return p->threadHandler.convertTracks(tracks, options);
+}
+
+ScanRequest UnifiedMusicLibrary::organiseFiles(const TrackList& tracks, const FileOperationOptions& options)
+{
+    return p->threadHandler.organiseFiles(tracks, options, p->libraryManager->allLibraries());
+}
+
 bool UnifiedMusicLibrary::hasLibrary() const
 {
     return p->libraryManager->hasLibrary();
@@ -306,39 +691,62 @@ bool UnifiedMusicLibrary::isEmpty() const
 
 TrackList UnifiedMusicLibrary::tracks() const
 {
-    return p->tracks;
+    return p->snapshot().tracks();
+}
+
+TrackSnapshot UnifiedMusicLibrary::snapshot() const
+{
+    return p->snapshot();
+}
+
+const TrackSearchIndex& UnifiedMusicLibrary::searchIndex() const
+{
+    return *p->searchIndex;
+}
+
+const GroupingCache& UnifiedMusicLibrary::groupingCache() const
+{
+    return p->groupingCache;
 }
 
 TrackList UnifiedMusicLibrary::tracksForIds(const TrackIds& ids) const
 {
-    TrackList tracks;
-    tracks.reserve(ids.size());
-
-    for(const int id : ids) {
-        auto trackIt
-            = std::ranges::find_if(std::as_const(p->tracks), [id](const Track& track) { return track.id() == id; });
-        if(trackIt != p->tracks.cend()) {
-            tracks.push_back(*trackIt);
+    return p->snapshot().tracksForIds(ids);
+}
+
+ScanRequest UnifiedMusicLibrary::updateTrackMetadata(const TrackList& tracks)
+{
+    TrackList tracksToSave;
+    for(const Track& track : tracks) {
+        if(p->lightTracks.contains(track.id())) {
+            p->pendingMetadataUpdates.push_back(track);
+        }
+        else {
+            tracksToSave.push_back(track);
         }
     }
 
-    return tracks;
+    if(tracksToSave.empty()) {
+        return {.type = ScanRequest::Metadata, .id = -1, .cancel = []() { }};
+    }
+
+    p->threadHandler.saveUpdatedTrackStats(tracksToSave);
+    return p->threadHandler.saveUpdatedTracks(tracksToSave);
 }
 
-void UnifiedMusicLibrary::updateTrackMetadata(const TrackList& tracks)
+void UnifiedMusicLibrary::updateTrackStats(const Track& track)
 {
-    p->threadHandler.saveUpdatedTracks(tracks);
-    p->threadHandler.saveUpdatedTrackStats(tracks);
+    p->addStatUpdate(track);
 }
 
-void UnifiedMusicLibrary::updateTrackStats(const Track& track)
+void UnifiedMusicLibrary::updatePlayState(PlayState state)
 {
-    p->threadHandler.saveUpdatedTrackStats({track});
+    p->threadHandler.setPlaybackActive(state == PlayState::Playing);
 }
 
 void UnifiedMusicLibrary::trackWasPlayed(const Track& track)
 {
-    const QString hash  = track.hash();
+    const uint64_t hash = track.hash();
     const auto currTime = QDateTime::currentMSecsSinceEpoch();
     int playCount       = track.playCount();
 
@@ -354,7 +762,7 @@ void UnifiedMusicLibrary::trackWasPlayed(const Track& track)
         updatedTrack.setPlayCount(track.playCount() + 1);
 
         playCount = updatedTrack.playCount();
-        p->pendingStatUpdates.emplace(hash, updatedTrack);
+        p->addStatUpdate(updatedTrack);
         isPending = true;
     }
 
@@ -368,7 +776,7 @@ void UnifiedMusicLibrary::trackWasPlayed(const Track& track)
 
             tracksToUpdate.emplace_back(sameHashTrack);
             if(!isPending) {
-                p->pendingStatUpdates.emplace(hash, sameHashTrack);
+                p->addStatUpdate(sameHashTrack);
                 isPending = true;
             }
         }
@@ -377,6 +785,17 @@ void UnifiedMusicLibrary::trackWasPlayed(const Track& track)
     p->updatePlayedTracks(tracksToUpdate);
 }
 
+void UnifiedMusicLibrary::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == p->snapshotTimer.timerId()) {
+        p->writeSnapshot(false);
+    }
+    else if(event->timerId() == p->statsTimer.timerId()) {
+        p->saveStatUpdates();
+    }
+    MusicLibrary::timerEvent(event);
+}
+
 void UnifiedMusicLibrary::cleanupTracks()
 {
     p->threadHandler.cleanupTracks();
@@ -22,6 +22,7 @@
 #include "libraryscanner.h"
 
 #include <core/library/musiclibrary.h>
+#include <core/player/playerdefs.h>
 
 namespace Fooyin {
 class SettingsManager;
@@ -43,19 +44,30 @@ public:
     ScanRequest refresh(const LibraryInfo& library) override;
     ScanRequest rescan(const LibraryInfo& library) override;
     ScanRequest scanTracks(const TrackList& tracks) override;
+    ScanRequest calculateReplayGain(const TrackList& tracks, bool recalculate) override;
+    ScanRequest convertTracks(const TrackList& tracks, const ConversionOptions& options) override;
+    ScanRequest organiseFiles(const TrackList& tracks, const FileOperationOptions& options) override;
 
     [[nodiscard]] bool hasLibrary() const override;
     [[nodiscard]] bool isEmpty() const override;
 
     [[nodiscard]] TrackList tracks() const override;
+    [[nodiscard]] TrackSnapshot snapshot() const override;
     [[nodiscard]] TrackList tracksForIds(const TrackIds& ids) const override;
+    [[nodiscard]] const TrackSearchIndex& searchIndex() const override;
+    [[nodiscard]] const GroupingCache& groupingCache() const override;
 
-    void updateTrackMetadata(const TrackList& tracks) override;
+    ScanRequest updateTrackMetadata(const TrackList& tracks) override;
     void updateTrackStats(const Track& track) override;
 
     void trackWasPlayed(const Track& track);
+    /** Holds off conversions set to pause during playback while @p state is PlayState::Playing. */
+    void updatePlayState(PlayState state);
     void cleanupTracks();
 
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
 private:
     struct Private;
     std::unique_ptr<Private> p;
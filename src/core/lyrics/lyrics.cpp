@@ -0,0 +1,278 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/lyrics/lyrics.h>
+
+#include <QStringList>
+
+#include <algorithm>
+#include <optional>
+
+namespace {
+// Parses "mm:ss", "mm:ss.xx" or "mm:ss:xx" into milliseconds
+std::optional<uint64_t> parseTimestamp(QStringView text)
+{
+    const auto colon = text.indexOf(u':');
+    if(colon <= 0) {
+        return {};
+    }
+
+    bool ok{false};
+    const uint64_t minutes = text.left(colon).toULongLong(&ok);
+    if(!ok) {
+        return {};
+    }
+
+    const QStringView rest = text.sliced(colon + 1);
+    auto fractionStart     = rest.indexOf(u'.');
+    if(fractionStart < 0) {
+        fractionStart = rest.indexOf(u':');
+    }
+
+    const QStringView secondsText = fractionStart < 0 ? rest : rest.left(fractionStart);
+    const uint64_t seconds        = secondsText.toULongLong(&ok);
+    if(!ok || secondsText.size() > 2 || seconds > 59) {
+        return {};
+    }
+
+    uint64_t milliseconds{0};
+    if(fractionStart >= 0) {
+        const QStringView fraction = rest.sliced(fractionStart + 1);
+        if(fraction.isEmpty() || fraction.size() > 3) {
+            return {};
+        }
+        milliseconds = fraction.toULongLong(&ok);
+        if(!ok) {
+            return {};
+        }
+        for(auto digits = fraction.size(); digits < 3; ++digits) {
+            milliseconds *= 10;
+        }
+    }
+
+    return ((minutes * 60) + seconds) * 1000 + milliseconds;
+}
+
+uint64_t shifted(uint64_t timestamp, int64_t delta)
+{
+    const int64_t result = static_cast<int64_t>(timestamp) + delta;
+    return result > 0 ? static_cast<uint64_t>(result) : 0;
+}
+
+struct LineText
+{
+    QString text;
+    std::vector<Fooyin::Lyrics::Word> words;
+};
+
+// Splits the text of a line into its enhanced LRC words, e.g. "<00:01.00>Hello <00:01.50>world"
+LineText parseWords(QStringView line)
+{
+    LineText result;
+
+    qsizetype pos{0};
+    while(pos < line.size()) {
+        const auto open           = line.indexOf(u'<', pos);
+        const QStringView segment = line.sliced(pos, (open < 0 ? line.size() : open) - pos);
+
+        result.text += segment;
+        if(!result.words.empty()) {
+            result.words.back().text += segment;
+        }
+
+        if(open < 0) {
+            break;
+        }
+
+        const auto close = line.indexOf(u'>', open);
+        const auto timestamp
+            = close < 0 ? std::nullopt : parseTimestamp(line.sliced(open + 1, close - open - 1));
+
+        if(!timestamp) {
+            // Not a word timestamp, so it's part of the text
+            result.text += u'<';
+            if(!result.words.empty()) {
+                result.words.back().text += u'<';
+            }
+            pos = open + 1;
+            continue;
+        }
+
+        result.words.push_back({*timestamp, {}});
+        pos = close + 1;
+    }
+
+    if(result.words.empty()) {
+        result.text = result.text.trimmed();
+    }
+    else {
+        // The timestamp that only marks where the last word ends has no text of its own
+        std::erase_if(result.words, [](const Fooyin::Lyrics::Word& word) { return word.text.trimmed().isEmpty(); });
+        result.text = result.text.simplified();
+    }
+
+    return result;
+}
+} // namespace
+
+namespace Fooyin {
+Lyrics Lyrics::parse(const QString& text)
+{
+    Lyrics lyrics;
+    std::vector<Line> plainLines;
+
+    const auto rawLines = QStringView{text}.split(u'\n');
+    for(const QStringView rawLine : rawLines) {
+        QStringView line = rawLine.trimmed();
+
+        std::vector<uint64_t> timestamps;
+        bool hadTags{false};
+
+        while(line.startsWith(u'[')) {
+            const auto close = line.indexOf(u']');
+            if(close < 0) {
+                break;
+            }
+
+            const QStringView content = line.sliced(1, close - 1);
+            if(const auto timestamp = parseTimestamp(content)) {
+                timestamps.push_back(*timestamp);
+            }
+            else if(const auto colon = content.indexOf(u':'); timestamps.empty() && colon > 0) {
+                const QString key  = content.left(colon).trimmed().toString().toLower();
+                lyrics.m_tags[key] = content.sliced(colon + 1).trimmed().toString();
+                hadTags            = true;
+            }
+            else {
+                break;
+            }
+
+            line = line.sliced(close + 1);
+        }
+
+        if(timestamps.empty()) {
+            if(!hadTags) {
+                plainLines.push_back({0, rawLine.trimmed().toString(), {}});
+            }
+            continue;
+        }
+
+        const LineText lineText = parseWords(line);
+
+        for(const uint64_t timestamp : timestamps) {
+            Line parsedLine{timestamp, lineText.text, lineText.words};
+
+            // Repeated lines share their words, which are timed relative to the first timestamp
+            const auto delta = static_cast<int64_t>(timestamp) - static_cast<int64_t>(timestamps.front());
+            for(Word& word : parsedLine.words) {
+                word.timestamp = shifted(word.timestamp, delta);
+            }
+
+            lyrics.m_lines.push_back(std::move(parsedLine));
+        }
+    }
+
+    if(lyrics.m_lines.empty()) {
+        // Plain lyrics, without the blank lines around them
+        while(!plainLines.empty() && plainLines.back().text.isEmpty()) {
+            plainLines.pop_back();
+        }
+        const auto firstLine = std::ranges::find_if(plainLines, [](const Line& line) { return !line.text.isEmpty(); });
+        plainLines.erase(plainLines.begin(), firstLine);
+
+        lyrics.m_lines = std::move(plainLines);
+        return lyrics;
+    }
+
+    lyrics.m_synced = true;
+
+    // A positive offset shows lyrics earlier
+    if(const QString offsetTag = lyrics.tag(QStringLiteral("offset")); !offsetTag.isEmpty()) {
+        bool ok{false};
+        const int64_t offset = offsetTag.toLongLong(&ok);
+        if(ok && offset != 0) {
+            for(Line& line : lyrics.m_lines) {
+                line.timestamp = shifted(line.timestamp, -offset);
+                for(Word& word : line.words) {
+                    word.timestamp = shifted(word.timestamp, -offset);
+                }
+            }
+        }
+    }
+
+    std::ranges::stable_sort(lyrics.m_lines, {}, &Line::timestamp);
+
+    return lyrics;
+}
+
+bool Lyrics::empty() const
+{
+    return m_lines.empty();
+}
+
+bool Lyrics::isSynced() const
+{
+    return m_synced;
+}
+
+const std::vector<Lyrics::Line>& Lyrics::lines() const
+{
+    return m_lines;
+}
+
+QString Lyrics::tag(const QString& key) const
+{
+    const auto it = m_tags.find(key);
+    return it != m_tags.cend() ? it->second : QString{};
+}
+
+int Lyrics::lineAt(uint64_t position, int hint) const
+{
+    if(!m_synced || m_lines.empty()) {
+        return -1;
+    }
+
+    const auto count       = static_cast<int>(m_lines.size());
+    const auto beforeStart = [this, position, count](int index) {
+        return index >= count || m_lines.at(index).timestamp > position;
+    };
+
+    if(hint >= 0 && hint < count && m_lines.at(hint).timestamp <= position) {
+        if(beforeStart(hint + 1)) {
+            return hint;
+        }
+        if(beforeStart(hint + 2)) {
+            return hint + 1;
+        }
+    }
+
+    const auto it = std::ranges::upper_bound(m_lines, position, {}, &Line::timestamp);
+    return static_cast<int>(std::distance(m_lines.cbegin(), it)) - 1;
+}
+
+size_t Lyrics::cost() const
+{
+    size_t cost{sizeof(Lyrics)};
+    for(const Line& line : m_lines) {
+        cost += sizeof(Line) + (static_cast<size_t>(line.text.size()) * sizeof(QChar));
+        cost += line.words.size() * sizeof(Word);
+    }
+    return cost;
+}
+} // namespace Fooyin
@@ -21,6 +21,7 @@
 
 #include <core/track.h>
 
+#include <algorithm>
 #include <ranges>
 
 namespace Fooyin {
@@ -31,7 +32,7 @@ bool PlaybackQueue::empty() const
 
 QueueTracks PlaybackQueue::tracks() const
 {
-    return m_tracks;
+    return {m_tracks.cbegin(), m_tracks.cend()};
 }
 
 PlaylistTrack PlaybackQueue::track(int index) const
@@ -50,31 +51,98 @@ int PlaybackQueue::trackCount() const
 
 PlaylistIndexes PlaybackQueue::indexesForPlaylist(const Id& id) const
 {
-    PlaylistIndexes indexes;
+    updateIndexes();
 
-    for(auto i{0}; const auto& track : m_tracks) {
-        if(track.playlistId == id) {
-            indexes[track.indexInPlaylist].emplace_back(i);
+    const auto playlistIt = m_playlistIndexes.find(id);
+    if(playlistIt == m_playlistIndexes.cend()) {
+        return {};
+    }
+
+    PlaylistIndexes indexes{playlistIt->second};
+    if(m_indexOffset > 0) {
+        for(auto& [index, positions] : indexes) {
+            std::ranges::transform(positions, positions.begin(),
+                                   [this](int position) { return position - m_indexOffset; });
         }
-        ++i;
     }
 
     return indexes;
 }
 
+int PlaybackQueue::nextIndex(const Id& playlistId) const
+{
+    if(m_tracks.empty()) {
+        return -1;
+    }
+    if(!playlistId.isValid()) {
+        return 0;
+    }
+
+    const auto trackIt = std::ranges::find_if(m_tracks, [&playlistId](const PlaylistTrack& track) {
+        return !track.isInPlaylist() || track.playlistId == playlistId;
+    });
+
+    return trackIt != m_tracks.cend() ? static_cast<int>(std::distance(m_tracks.cbegin(), trackIt)) : -1;
+}
+
 PlaylistTrack PlaybackQueue::nextTrack()
 {
     if(m_tracks.empty()) {
         return {};
     }
 
-    auto track = m_tracks.front();
-    m_tracks.erase(m_tracks.begin());
+    auto track = std::move(m_tracks.front());
+    m_tracks.pop_front();
+
+    if(m_indexesValid) {
+        // The front is always the lowest position indexed for its playlist
+        auto playlistIt = m_playlistIndexes.find(track.playlistId);
+        if(playlistIt != m_playlistIndexes.end()) {
+            auto indexIt = playlistIt->second.find(track.indexInPlaylist);
+            if(indexIt != playlistIt->second.end()) {
+                std::erase(indexIt->second, m_indexOffset);
+                if(indexIt->second.empty()) {
+                    playlistIt->second.erase(indexIt);
+                }
+            }
+            if(playlistIt->second.empty()) {
+                m_playlistIndexes.erase(playlistIt);
+            }
+        }
+        ++m_indexOffset;
+    }
+
+    return track;
+}
+
+PlaylistTrack PlaybackQueue::takeTrack(int index)
+{
+    if(index == 0) {
+        return nextTrack();
+    }
+    if(index < 0 || index >= trackCount()) {
+        return {};
+    }
+
+    auto track = std::move(m_tracks.at(index));
+    m_tracks.erase(m_tracks.begin() + index);
+    m_indexesValid = false;
+
     return track;
 }
 
 void PlaybackQueue::addTracks(const QueueTracks& tracks)
 {
+    if(m_indexesValid) {
+        int position = trackCount() + m_indexOffset;
+        for(const auto& track : tracks) {
+            if(track.isInPlaylist()) {
+                m_playlistIndexes[track.playlistId][track.indexInPlaylist].push_back(position);
+            }
+            ++position;
+        }
+    }
+
     m_tracks.insert(m_tracks.end(), tracks.cbegin(), tracks.cend());
 }
 
@@ -89,7 +157,10 @@ QueueTracks PlaybackQueue::removeTracks(const QueueTracks& tracks)
     };
 
     std::ranges::copy_if(m_tracks, std::back_inserter(removedTracks), matchingTrack);
-    std::erase_if(m_tracks, matchingTrack);
+    if(!removedTracks.empty()) {
+        std::erase_if(m_tracks, matchingTrack);
+        m_indexesValid = false;
+    }
 
     return removedTracks;
 }
@@ -104,11 +175,37 @@ QueueTracks PlaybackQueue::removePlaylistTracks(const Id& playlistId)
     removedTracks.insert(removedTracks.end(), std::make_move_iterator(it), std::make_move_iterator(m_tracks.end()));
     m_tracks.erase(it, m_tracks.end());
 
+    if(!removedTracks.empty()) {
+        m_indexesValid = false;
+    }
+
     return removedTracks;
 }
 
 void PlaybackQueue::clear()
 {
     m_tracks.clear();
+    m_playlistIndexes.clear();
+    m_indexesValid = true;
+    m_indexOffset  = 0;
+}
+
+void PlaybackQueue::updateIndexes() const
+{
+    if(m_indexesValid) {
+        return;
+    }
+
+    m_playlistIndexes.clear();
+    m_indexOffset = 0;
+
+    for(int i{0}; const auto& track : m_tracks) {
+        if(track.isInPlaylist()) {
+            m_playlistIndexes[track.playlistId][track.indexInPlaylist].push_back(i);
+        }
+        ++i;
+    }
+
+    m_indexesValid = true;
 }
 } // namespace Fooyin
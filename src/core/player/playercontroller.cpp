@@ -25,6 +25,12 @@
 #include <core/track.h>
 #include <utils/settings/settingsmanager.h>
 
+#include <algorithm>
+#include <map>
+
+// How long before the end of a track its successor is announced, so caches can be warmed for it
+constexpr uint64_t PrefetchLength = 20000;
+
 namespace Fooyin {
 struct PlayerController::Private
 {
@@ -37,16 +43,40 @@ struct PlayerController::Private
     PlayState playStatus{PlayState::Stopped};
     Playlist::PlayModes playMode;
     uint64_t position{0};
+    QString streamTitle;
     bool counted{false};
+    bool nearingEnd{false};
     bool isQueueTrack{false};
 
     PlaybackQueue queue;
+    bool perPlaylistQueue{false};
+
+    std::map<QObject*, int> positionListeners;
+    int positionInterval{0};
 
     Private(PlayerController* self_, SettingsManager* settings_)
         : self{self_}
         , settings{settings_}
         , playMode{static_cast<Playlist::PlayModes>(settings->value<Settings::Core::PlayMode>())}
+        , perPlaylistQueue{settings->value<Settings::Core::PerPlaylistQueue>()}
     { }
+
+    [[nodiscard]] int nextQueueIndex() const
+    {
+        return queue.nextIndex(perPlaylistQueue ? currentTrack.playlistId : Id{});
+    }
+
+    void updatePositionInterval()
+    {
+        int interval{0};
+        for(const auto& [listener, listenerInterval] : positionListeners) {
+            interval = interval == 0 ? listenerInterval : std::min(interval, listenerInterval);
+        }
+
+        if(std::exchange(positionInterval, interval) != interval) {
+            emit self->positionIntervalChanged(interval);
+        }
+    }
 };
 
 PlayerController::PlayerController(SettingsManager* settings, QObject* parent)
@@ -59,6 +89,8 @@ PlayerController::PlayerController(SettingsManager* settings, QObject* parent)
             emit playModeChanged(mode);
         }
     });
+    settings->subscribe<Settings::Core::PerPlaylistQueue>(this,
+                                                         [this](bool enabled) { p->perPlaylistQueue = enabled; });
 }
 
 PlayerController::~PlayerController() = default;
@@ -71,9 +103,12 @@ void PlayerController::reset()
 
 void PlayerController::play()
 {
-    if(!p->currentTrack.isValid() && !p->queue.empty()) {
-        changeCurrentTrack(p->queue.nextTrack());
-        emit tracksDequeued({p->currentTrack});
+    if(!p->currentTrack.isValid()) {
+        const int queueIndex = p->nextQueueIndex();
+        if(queueIndex >= 0) {
+            changeCurrentTrack(p->queue.takeTrack(queueIndex));
+            emit tracksDequeued({p->currentTrack});
+        }
     }
 
     if(p->currentTrack.isValid() && p->playStatus != PlayState::Playing) {
@@ -111,13 +146,15 @@ void PlayerController::previous()
 
 void PlayerController::next()
 {
-    if(p->queue.empty()) {
+    const int queueIndex = p->nextQueueIndex();
+    if(queueIndex < 0) {
         p->isQueueTrack = false;
         emit nextTrack();
     }
     else {
-        p->currentTrack = {};
         p->isQueueTrack = true;
+        changeCurrentTrack(p->queue.takeTrack(queueIndex));
+        emit tracksDequeued({p->currentTrack});
         play();
     }
 }
@@ -140,6 +177,10 @@ void PlayerController::setCurrentPosition(uint64_t ms)
             emit trackPlayed(p->currentTrack.track);
         }
     }
+    if(!p->nearingEnd && p->totalDuration > 0 && ms + PrefetchLength >= p->totalDuration) {
+        p->nearingEnd = true;
+        emit trackNearingEnd();
+    }
     emit positionChanged(ms);
 }
 
@@ -154,9 +195,12 @@ void PlayerController::changeCurrentTrack(const PlaylistTrack& track)
     p->totalDuration = p->currentTrack.track.duration();
     p->position      = 0;
     p->counted       = false;
+    p->nearingEnd    = false;
 
     emit currentTrackChanged(p->currentTrack.track);
     emit playlistTrackChanged(p->currentTrack);
+
+    setStreamTitle({});
 }
 
 void PlayerController::updateCurrentTrackPlaylist(const Id& playlistId)
@@ -173,11 +217,51 @@ void PlayerController::updateCurrentTrackIndex(int index)
     }
 }
 
-PlaybackQueue PlayerController::playbackQueue() const
+void PlayerController::setStreamTitle(const QString& title)
+{
+    if(std::exchange(p->streamTitle, title) != title) {
+        emit streamTitleChanged(title);
+    }
+}
+
+void PlayerController::requestPositionUpdates(QObject* listener, int interval)
+{
+    if(!listener || interval <= 0) {
+        return;
+    }
+
+    if(!p->positionListeners.contains(listener)) {
+        QObject::connect(listener, &QObject::destroyed, this,
+                         [this](QObject* object) { releasePositionUpdates(object); });
+    }
+
+    p->positionListeners[listener] = interval;
+    p->updatePositionInterval();
+}
+
+void PlayerController::releasePositionUpdates(QObject* listener)
+{
+    if(p->positionListeners.erase(listener) > 0) {
+        QObject::disconnect(listener, &QObject::destroyed, this, nullptr);
+        p->updatePositionInterval();
+    }
+}
+
+int PlayerController::positionInterval() const
+{
+    return p->positionInterval;
+}
+
+const PlaybackQueue& PlayerController::playbackQueue() const
 {
     return p->queue;
 }
 
+PlaylistTrack PlayerController::nextQueuedTrack() const
+{
+    return p->queue.track(p->nextQueueIndex());
+}
+
 void PlayerController::setPlayMode(Playlist::PlayModes mode)
 {
     p->settings->set<Settings::Core::PlayMode>(static_cast<int>(mode));
@@ -249,6 +333,11 @@ PlaylistTrack PlayerController::currentPlaylistTrack() const
     return p->currentTrack;
 }
 
+QString PlayerController::streamTitle() const
+{
+    return p->streamTitle;
+}
+
 void PlayerController::queueTrack(const Track& track)
 {
     queueTrack(PlaylistTrack{track, {}});
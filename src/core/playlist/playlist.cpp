@@ -19,14 +19,17 @@
 
 #include <core/playlist/playlist.h>
 
-#include "tagging/tagreader.h"
+#include "tagging/tagreadservice.h"
 
+#include <core/library/librarydelta.h>
 #include <core/track.h>
 #include <utils/crypto.h>
 
+#include <numeric>
 #include <random>
 #include <ranges>
 #include <set>
+#include <unordered_map>
 
 namespace Fooyin {
 struct Playlist::PrivateKey
@@ -43,15 +46,31 @@ struct Playlist::Private
     int index{-1};
     TrackList tracks;
 
+    // Set for restored playlists until their tracks are first needed
+    std::function<TrackList()> loader;
+    int pendingCount{0};
+    uint64_t pendingDuration{0};
+
     int currentTrackIndex{0};
     int nextTrackIndex{-1};
 
     int shuffleIndex{-1};
     std::vector<int> shuffleOrder;
+    // Position of each track in shuffleOrder
+    std::vector<int> shufflePositions;
+    // Whether shuffleOrder keeps the tracks of each album together
+    bool shuffleAlbums{false};
+    // Incremented whenever shuffleOrder is created from scratch
+    int shuffleGeneration{0};
+
+    // Indexes of each library track by id, built on first lookup and dropped when tracks are added or removed
+    std::unordered_map<int, std::vector<int>> idIndexes;
+    bool idIndexesValid{false};
 
     bool isTemporary{false};
     bool modified{false};
     bool tracksModified{false};
+    uint64_t revision{0};
 
     explicit Private(QString name_)
         : id{Utils::generateUniqueHash()}
@@ -66,6 +85,128 @@ struct Playlist::Private
         , index{index_}
     { }
 
+    void load()
+    {
+        if(loader) {
+            tracks = std::exchange(loader, {})();
+            invalidateIndexes();
+        }
+    }
+
+    const std::unordered_map<int, std::vector<int>>& indexesById()
+    {
+        if(!idIndexesValid) {
+            idIndexes.clear();
+            for(int i{0}; const Track& track : tracks) {
+                if(track.isInDatabase()) {
+                    idIndexes[track.id()].push_back(i);
+                }
+                ++i;
+            }
+            idIndexesValid = true;
+        }
+        return idIndexes;
+    }
+
+    void invalidateIndexes()
+    {
+        idIndexesValid = false;
+        idIndexes.clear();
+    }
+
+    // Points the shuffle order, current and scheduled indexes at the new positions given by @p mapping
+    void remapIndexes(const std::vector<int>& mapping)
+    {
+        auto remap = [&mapping](int index) {
+            return index >= 0 && std::cmp_less(index, mapping.size()) ? mapping.at(index) : index;
+        };
+
+        std::ranges::transform(shuffleOrder, shuffleOrder.begin(), remap);
+        currentTrackIndex = remap(currentTrackIndex);
+        nextTrackIndex    = remap(nextTrackIndex);
+        updateShufflePositions();
+    }
+
+    // Adds newly inserted indexes to the part of the shuffle order which hasn't been played yet
+    void addToShuffleOrder(int first, int count)
+    {
+        if(shuffleOrder.empty()) {
+            return;
+        }
+
+        std::mt19937 gen{std::random_device{}()};
+        const int start = std::clamp(shuffleIndex + 1, 0, static_cast<int>(shuffleOrder.size()));
+
+        if(shuffleAlbums) {
+            // Kept together, between two albums
+            std::uniform_int_distribution<int> dist{start, static_cast<int>(shuffleOrder.size())};
+            int pos = dist(gen);
+            while(pos > start && pos < static_cast<int>(shuffleOrder.size())
+                  && sameAlbum(tracks.at(shuffleOrder.at(pos - 1)), tracks.at(shuffleOrder.at(pos)))) {
+                ++pos;
+            }
+            std::vector<int> inserted(count);
+            std::iota(inserted.begin(), inserted.end(), first);
+            shuffleOrder.insert(shuffleOrder.begin() + pos, inserted.cbegin(), inserted.cend());
+        }
+        else {
+            for(int index{first}; index < first + count; ++index) {
+                std::uniform_int_distribution<int> dist{start, static_cast<int>(shuffleOrder.size())};
+                shuffleOrder.insert(shuffleOrder.begin() + dist(gen), index);
+            }
+        }
+
+        updateShufflePositions();
+    }
+
+    // Removes the indexes which map to -1 in @p mapping and remaps the rest, keeping the played history
+    void removeFromShuffleOrder(const std::vector<int>& mapping)
+    {
+        int newShuffleIndex{shuffleIndex};
+        std::vector<int> order;
+        order.reserve(shuffleOrder.size());
+
+        for(int pos{0}; const int index : shuffleOrder) {
+            const int newIndex = index >= 0 && std::cmp_less(index, mapping.size()) ? mapping.at(index) : -1;
+            if(newIndex >= 0) {
+                order.push_back(newIndex);
+            }
+            else if(pos <= shuffleIndex) {
+                --newShuffleIndex;
+            }
+            ++pos;
+        }
+
+        shuffleOrder = std::move(order);
+        shuffleIndex = newShuffleIndex;
+        updateShufflePositions();
+    }
+
+    void updateShufflePositions()
+    {
+        shufflePositions.assign(tracks.size(), -1);
+        for(int pos{0}; const int index : shuffleOrder) {
+            if(index >= 0 && std::cmp_less(index, shufflePositions.size())) {
+                shufflePositions[index] = pos;
+            }
+            ++pos;
+        }
+    }
+
+    void clearShuffleOrder()
+    {
+        shuffleOrder.clear();
+        shufflePositions.clear();
+    }
+
+    static bool sameAlbum(const Track& first, const Track& second)
+    {
+        if(first.album().isEmpty() || second.album().isEmpty()) {
+            return first.album().isEmpty() && second.album().isEmpty() && first.path() == second.path();
+        }
+        return first.album() == second.album() && first.albumArtist() == second.albumArtist();
+    }
+
     void readTrack(int trackIndex)
     {
         if(trackIndex < 0 || std::cmp_greater_equal(trackIndex, tracks.size())) {
@@ -74,32 +215,71 @@ struct Playlist::Private
 
         Track& track = tracks.at(trackIndex);
         if(!track.metadataWasRead()) {
-            Tagging::readMetaData(track);
+            TagReadService::instance().readMetaData(track);
         }
     }
 
-    void createShuffleOrder()
+    void createShuffleOrder(bool albums)
     {
+        std::mt19937 gen{std::random_device{}()};
+
+        const int count = static_cast<int>(tracks.size());
+        const int current = currentTrackIndex >= 0 && currentTrackIndex < count ? currentTrackIndex : 0;
+
         shuffleOrder.resize(tracks.size());
-        std::iota(shuffleOrder.begin(), shuffleOrder.end(), 0);
-        std::ranges::shuffle(shuffleOrder, std::mt19937{std::random_device{}()});
+        shuffleAlbums = albums;
+        ++shuffleGeneration;
+
+        if(!albums) {
+            // Start at the current track
+            std::iota(shuffleOrder.begin(), shuffleOrder.end(), 0);
+            if(count > 0) {
+                std::swap(shuffleOrder.front(), shuffleOrder.at(current));
+                std::shuffle(shuffleOrder.begin() + 1, shuffleOrder.end(), gen);
+            }
+            updateShufflePositions();
+            return;
+        }
+
+        // Runs of consecutive tracks from the same album, played in order
+        std::vector<std::pair<int, int>> albumRanges;
+        for(int index{0}; index < count; ++index) {
+            if(albumRanges.empty() || !sameAlbum(tracks.at(index - 1), tracks.at(index))) {
+                albumRanges.emplace_back(index, index);
+            }
+            albumRanges.back().second = index + 1;
+        }
 
-        // Move current track to start
-        auto it = std::ranges::find(shuffleOrder, currentTrackIndex);
-        if(it != shuffleOrder.end()) {
-            std::rotate(shuffleOrder.begin(), it, it + 1);
+        // Start with the album of the current track
+        const auto currentIt = std::ranges::find_if(
+            albumRanges, [current](const auto& range) { return current >= range.first && current < range.second; });
+        if(currentIt != albumRanges.end()) {
+            std::iter_swap(albumRanges.begin(), currentIt);
+            std::shuffle(albumRanges.begin() + 1, albumRanges.end(), gen);
         }
+
+        auto orderIt = shuffleOrder.begin();
+        for(const auto& [first, last] : albumRanges) {
+            orderIt = std::ranges::copy(std::views::iota(first, last), orderIt).out;
+        }
+
+        updateShufflePositions();
     }
 
     int getRandomIndex(PlayModes mode)
     {
-        if(shuffleOrder.empty()) {
-            createShuffleOrder();
+        const bool albums = mode & ShuffleAlbums;
+
+        if(shuffleOrder.empty() || albums != shuffleAlbums) {
+            createShuffleOrder(albums);
 
-            shuffleIndex = (mode & RepeatTrack) ? 0 : 1;
+            const int currentPos = currentTrackIndex >= 0 && std::cmp_less(currentTrackIndex, shufflePositions.size())
+                                     ? shufflePositions.at(currentTrackIndex)
+                                     : 0;
+            shuffleIndex         = currentPos + ((mode & RepeatTrack) ? 0 : 1);
         }
 
-        else if(mode & RepeatPlaylist) {
+        if(mode & RepeatPlaylist) {
             if(shuffleIndex > static_cast<int>(shuffleOrder.size() - 1)) {
                 shuffleIndex = 0;
             }
@@ -130,7 +310,7 @@ struct Playlist::Private
         else {
             const int count = static_cast<int>(tracks.size());
 
-            if(mode & ShuffleTracks) {
+            if(mode & (ShuffleTracks | ShuffleAlbums)) {
                 if(!(mode & RepeatTrack)) {
                     shuffleIndex += delta;
                 }
@@ -155,6 +335,27 @@ struct Playlist::Private
 
         return nextIndex;
     }
+
+    // As above, but leaves the scheduled index and shuffle position as they were
+    int peekNextIndex(int delta, PlayModes mode)
+    {
+        const int scheduledIndex   = nextTrackIndex;
+        const int prevShuffleIndex = shuffleIndex;
+        const int generation       = shuffleGeneration;
+
+        const int nextIndex = getNextIndex(delta, mode);
+
+        nextTrackIndex = scheduledIndex;
+        if(shuffleGeneration == generation) {
+            shuffleIndex = prevShuffleIndex;
+        }
+        else if(!(mode & RepeatTrack)) {
+            // Keep the new shuffle order, positioned so the next change lands on the same track
+            shuffleIndex -= delta;
+        }
+
+        return nextIndex;
+    }
 };
 
 Playlist::Playlist(PrivateKey /*key*/, QString name)
@@ -187,13 +388,16 @@ int Playlist::index() const
     return p->index;
 }
 
-TrackList Playlist::tracks() const
+const TrackList& Playlist::tracks() const
 {
+    p->load();
     return p->tracks;
 }
 
 Track Playlist::track(int index) const
 {
+    p->load();
+
     if(p->tracks.empty() || index < 0 || index >= trackCount()) {
         return {};
     }
@@ -203,9 +407,26 @@ Track Playlist::track(int index) const
 
 int Playlist::trackCount() const
 {
+    if(p->loader) {
+        return p->pendingCount;
+    }
     return static_cast<int>(p->tracks.size());
 }
 
+uint64_t Playlist::duration() const
+{
+    if(p->loader) {
+        return p->pendingDuration;
+    }
+    return std::accumulate(p->tracks.cbegin(), p->tracks.cend(), uint64_t{0},
+                           [](uint64_t total, const Track& track) { return total + track.duration(); });
+}
+
+bool Playlist::isLoaded() const
+{
+    return !p->loader;
+}
+
 int Playlist::currentTrackIndex() const
 {
     return p->currentTrackIndex;
@@ -213,6 +434,8 @@ int Playlist::currentTrackIndex() const
 
 Track Playlist::currentTrack() const
 {
+    p->load();
+
     if(p->nextTrackIndex >= 0 && p->nextTrackIndex < trackCount()) {
         return p->tracks.at(p->nextTrackIndex);
     }
@@ -234,6 +457,11 @@ bool Playlist::tracksModified() const
     return p->tracksModified;
 }
 
+uint64_t Playlist::revision() const
+{
+    return p->revision;
+}
+
 bool Playlist::isTemporary() const
 {
     return p->isTemporary;
@@ -241,6 +469,8 @@ bool Playlist::isTemporary() const
 
 void Playlist::scheduleNextIndex(int index)
 {
+    p->load();
+
     if(index >= 0 && index < trackCount()) {
         p->nextTrackIndex = index;
     }
@@ -248,7 +478,9 @@ void Playlist::scheduleNextIndex(int index)
 
 Track Playlist::nextTrack(int delta, PlayModes mode)
 {
-    const int index = p->getNextIndex(delta, mode);
+    p->load();
+
+    const int index = p->peekNextIndex(delta, mode);
 
     if(index < 0) {
         return {};
@@ -261,6 +493,8 @@ Track Playlist::nextTrack(int delta, PlayModes mode)
 
 Track Playlist::nextTrackChange(int delta, PlayModes mode)
 {
+    p->load();
+
     const int index = p->getNextIndex(delta, mode);
 
     if(index < 0) {
@@ -274,13 +508,14 @@ Track Playlist::nextTrackChange(int delta, PlayModes mode)
 
 void Playlist::changeCurrentIndex(int index)
 {
+    p->load();
     p->currentTrackIndex = index;
     p->readTrack(index);
 }
 
 void Playlist::reset()
 {
-    p->shuffleOrder.clear();
+    p->clearShuffleOrder();
 }
 
 void Playlist::resetFlags()
@@ -323,12 +558,25 @@ void Playlist::setTracksModified(bool modified)
     p->tracksModified = modified;
 }
 
+void Playlist::setLoader(int trackCount, uint64_t duration, std::function<TrackList()> loader)
+{
+    p->loader          = std::move(loader);
+    p->pendingCount    = trackCount;
+    p->pendingDuration = duration;
+}
+
 void Playlist::replaceTracks(const TrackList& tracks)
 {
-    if(std::exchange(p->tracks, tracks) != tracks) {
+    // Compared first so replacing with the same tracks (e.g. from a model round trip) doesn't copy.
+    // Unloaded tracks are replaced without being loaded, as they'll never be needed.
+    if(p->loader || p->tracks != tracks) {
+        p->loader         = {};
+        p->tracks         = tracks;
         p->tracksModified = true;
-        p->shuffleOrder.clear();
+        p->clearShuffleOrder();
         p->nextTrackIndex = -1;
+        p->invalidateIndexes();
+        ++p->revision;
     }
 }
 
@@ -338,23 +586,16 @@ void Playlist::appendTracks(const TrackList& tracks)
         return;
     }
 
-    std::ranges::copy(tracks, std::back_inserter(p->tracks));
-    p->tracksModified = true;
-    p->shuffleOrder.clear();
+    insertTracks(-1, tracks);
 }
 
 std::vector<int> Playlist::removeTracks(const std::vector<int>& indexes)
 {
+    p->load();
+
     std::vector<int> removedIndexes;
 
-    std::set<int> indexesToRemove{indexes.cbegin(), indexes.cend()};
-
-    auto prevHistory = p->shuffleOrder | std::views::take(p->shuffleIndex + 1);
-    for(const int index : prevHistory) {
-        if(indexesToRemove.contains(index)) {
-            p->shuffleIndex -= 1;
-        }
-    }
+    const std::set<int> indexesToRemove{indexes.cbegin(), indexes.cend()};
 
     int adjustedTrackIndex = currentTrackIndex();
 
@@ -362,36 +603,294 @@ std::vector<int> Playlist::removeTracks(const std::vector<int>& indexes)
         if(index <= currentTrackIndex()) {
             adjustedTrackIndex = std::max(adjustedTrackIndex - 1, 0);
         }
-
         if(index >= 0 && std::cmp_less(index, p->tracks.size())) {
-            p->tracks.erase(p->tracks.begin() + index);
             removedIndexes.emplace_back(index);
+        }
+    }
 
-            std::erase_if(p->shuffleOrder, [index](int num) { return num == index; });
-            std::ranges::transform(p->shuffleOrder, p->shuffleOrder.begin(),
-                                   [index](int num) { return num > index ? num - 1 : num; });
+    if(removedIndexes.empty()) {
+        return removedIndexes;
+    }
+
+    // Removed in a single pass, mapping every old index to its new one (or -1 if removed)
+    std::vector<int> mapping(p->tracks.size());
+    TrackList tracks;
+    tracks.reserve(p->tracks.size() - removedIndexes.size());
+
+    for(int index{0}; index < trackCount(); ++index) {
+        if(indexesToRemove.contains(index)) {
+            mapping[index] = -1;
+        }
+        else {
+            mapping[index] = static_cast<int>(tracks.size());
+            tracks.push_back(std::move(p->tracks[index]));
         }
     }
 
-    std::erase_if(p->shuffleOrder, [](int num) { return num < 0; });
+    const bool hasNext  = p->nextTrackIndex >= 0 && p->nextTrackIndex < trackCount();
+    const int nextIndex = hasNext ? mapping.at(p->nextTrackIndex) : -1;
+
+    p->tracks = std::move(tracks);
+    p->removeFromShuffleOrder(mapping);
+    p->nextTrackIndex = nextIndex;
 
     changeCurrentIndex(adjustedTrackIndex);
 
-    if(indexesToRemove.contains(p->nextTrackIndex)) {
-        p->nextTrackIndex = -1;
+    p->tracksModified = true;
+    p->invalidateIndexes();
+    ++p->revision;
+
+    return removedIndexes;
+}
+
+int Playlist::insertTracks(int index, const TrackList& tracks)
+{
+    p->load();
+
+    if(tracks.empty()) {
+        return trackCount();
+    }
+
+    const int count = static_cast<int>(tracks.size());
+    if(index < 0 || index > trackCount()) {
+        index = trackCount();
+    }
+
+    if(index < trackCount()) {
+        std::vector<int> mapping(p->tracks.size());
+        for(int oldIndex{0}; oldIndex < trackCount(); ++oldIndex) {
+            mapping[oldIndex] = oldIndex < index ? oldIndex : oldIndex + count;
+        }
+        p->remapIndexes(mapping);
     }
 
+    p->tracks.insert(p->tracks.begin() + index, tracks.cbegin(), tracks.cend());
+    p->addToShuffleOrder(index, count);
+
     p->tracksModified = true;
+    p->invalidateIndexes();
+    ++p->revision;
 
-    return removedIndexes;
+    return index;
+}
+
+bool Playlist::updateTracksAt(const std::vector<int>& indexes, const TrackList& tracks)
+{
+    p->load();
+
+    if(indexes.size() != tracks.size()
+       || std::ranges::any_of(indexes, [this](int index) { return index < 0 || index >= trackCount(); })) {
+        return false;
+    }
+
+    bool idsChanged{false};
+
+    for(size_t i{0}; i < indexes.size(); ++i) {
+        Track& track = p->tracks[indexes.at(i)];
+        if(track.id() != tracks.at(i).id()) {
+            idsChanged = true;
+        }
+        track = tracks.at(i);
+    }
+    ++p->revision;
+
+    // Metadata changes alone don't change what is saved
+    if(idsChanged) {
+        p->tracksModified = true;
+        p->invalidateIndexes();
+    }
+
+    return true;
+}
+
+std::vector<int> Playlist::moveTracks(const std::vector<int>& indexes, int to)
+{
+    p->load();
+
+    std::set<int> moving;
+    for(const int index : indexes) {
+        if(index >= 0 && index < trackCount()) {
+            moving.emplace(index);
+        }
+    }
+
+    if(moving.empty()) {
+        return {};
+    }
+
+    to = std::clamp(to, 0, trackCount());
+
+    // The new order, as indexes into the old one
+    std::vector<int> order;
+    order.reserve(p->tracks.size());
+    auto appendUnmoved = [&order, &moving](int first, int last) {
+        for(int index{first}; index < last; ++index) {
+            if(!moving.contains(index)) {
+                order.push_back(index);
+            }
+        }
+    };
+
+    appendUnmoved(0, to);
+    const auto firstMoved = static_cast<int>(order.size());
+    std::ranges::copy(moving, std::back_inserter(order));
+    appendUnmoved(to, trackCount());
+
+    std::vector<int> mapping(order.size());
+    TrackList tracks;
+    tracks.reserve(order.size());
+    for(int newIndex{0}; const int oldIndex : order) {
+        mapping[oldIndex] = newIndex++;
+        tracks.push_back(std::move(p->tracks[oldIndex]));
+    }
+
+    p->tracks = std::move(tracks);
+    p->remapIndexes(mapping);
+
+    std::vector<int> movedIndexes(moving.size());
+    std::iota(movedIndexes.begin(), movedIndexes.end(), firstMoved);
+
+    if(!std::ranges::is_sorted(order)) {
+        p->tracksModified = true;
+        ++p->revision;
+    }
+    p->invalidateIndexes();
+
+    return movedIndexes;
+}
+
+std::vector<int> Playlist::reorderTracks(const std::vector<int>& order)
+{
+    p->load();
+
+    if(std::cmp_not_equal(order.size(), p->tracks.size())) {
+        return {};
+    }
+
+    std::vector<int> mapping(order.size(), -1);
+    for(int newIndex{0}; const int oldIndex : order) {
+        if(oldIndex < 0 || oldIndex >= trackCount() || mapping[oldIndex] >= 0) {
+            return {};
+        }
+        mapping[oldIndex] = newIndex++;
+    }
+
+    TrackList tracks;
+    tracks.reserve(order.size());
+    for(const int oldIndex : order) {
+        tracks.push_back(std::move(p->tracks[oldIndex]));
+    }
+
+    p->tracks = std::move(tracks);
+    p->remapIndexes(mapping);
+
+    if(!std::ranges::is_sorted(order)) {
+        p->tracksModified = true;
+        ++p->revision;
+    }
+    p->invalidateIndexes();
+
+    return mapping;
+}
+
+std::vector<int> Playlist::updateTracks(const TrackList& tracks)
+{
+    std::vector<int> indexes;
+
+    // Unloaded tracks will be current once loaded
+    if(p->loader) {
+        return indexes;
+    }
+
+    const auto& idIndexes = p->indexesById();
+    if(idIndexes.empty()) {
+        return indexes;
+    }
+
+    for(const Track& track : tracks) {
+        if(!track.isInDatabase()) {
+            continue;
+        }
+        if(const auto indexIt = idIndexes.find(track.id()); indexIt != idIndexes.cend()) {
+            for(const int index : indexIt->second) {
+                p->tracks[index] = track;
+                indexes.push_back(index);
+            }
+        }
+    }
+
+    // Positions and ids are unchanged, so the index and shuffle order remain valid and nothing needs saving
+    if(!indexes.empty()) {
+        std::ranges::sort(indexes);
+        indexes.erase(std::ranges::unique(indexes).begin(), indexes.end());
+        ++p->revision;
+    }
+
+    return indexes;
+}
+
+std::vector<int> Playlist::applyLibraryDelta(const LibraryDelta& delta)
+{
+    std::vector<int> indexes;
+
+    // Unloaded tracks will be current once loaded
+    if(p->loader) {
+        return indexes;
+    }
+
+    for(int i{0}; Track& track : p->tracks) {
+        if(delta.apply(track)) {
+            indexes.push_back(i);
+        }
+        ++i;
+    }
+
+    // As with updateTracks, ids and positions are unchanged
+    if(!indexes.empty()) {
+        ++p->revision;
+    }
+
+    return indexes;
+}
+
+std::vector<int> Playlist::indexesOf(const TrackList& tracks)
+{
+    std::vector<int> indexes;
+
+    // Removed tracks won't be loaded, so there's nothing to find
+    if(p->loader) {
+        return indexes;
+    }
+
+    const auto& idIndexes = p->indexesById();
+    if(idIndexes.empty()) {
+        return indexes;
+    }
+
+    for(const Track& track : tracks) {
+        if(!track.isInDatabase()) {
+            continue;
+        }
+        if(const auto indexIt = idIndexes.find(track.id()); indexIt != idIndexes.cend()) {
+            indexes.insert(indexes.end(), indexIt->second.cbegin(), indexIt->second.cend());
+        }
+    }
+
+    std::ranges::sort(indexes);
+    indexes.erase(std::ranges::unique(indexes).begin(), indexes.end());
+
+    return indexes;
 }
 
 void Playlist::clear()
 {
-    if(!p->tracks.empty()) {
+    if(p->loader || !p->tracks.empty()) {
+        p->loader = {};
         p->tracks.clear();
         p->tracksModified = true;
-        p->shuffleOrder.clear();
+        p->clearShuffleOrder();
+        p->invalidateIndexes();
+        ++p->revision;
     }
 }
 } // namespace Fooyin
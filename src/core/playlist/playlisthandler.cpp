@@ -23,51 +23,20 @@
 #include "internalcoresettings.h"
 
 #include <core/coresettings.h>
+#include <core/library/librarydelta.h>
 #include <core/player/playercontroller.h>
 #include <core/playlist/playlist.h>
 #include <utils/helpers.h>
 #include <utils/settings/settingsmanager.h>
+#include <utils/startuptrace.h>
 
+#include <functional>
+#include <numeric>
 #include <ranges>
 #include <utility>
 
 constexpr auto ActiveIndex = "Player/ActivePlaylistIndex";
 
-namespace {
-enum class CommonOperation : uint8_t
-{
-    Update = 0,
-    Remove
-};
-
-std::vector<int> updateCommonTracks(Fooyin::TrackList& tracks, const Fooyin::TrackList& updatedTracks,
-                                    CommonOperation operation)
-{
-    std::vector<int> indexes;
-
-    Fooyin::TrackList result;
-    result.reserve(tracks.size());
-
-    for(auto trackIt{tracks.begin()}; trackIt != tracks.end(); ++trackIt) {
-        auto updatedIt = std::ranges::find_if(updatedTracks, [&trackIt](const Fooyin::Track& updatedTrack) {
-            return updatedTrack.isInDatabase() && trackIt->id() == updatedTrack.id();
-        });
-        if(updatedIt != updatedTracks.end()) {
-            indexes.push_back(static_cast<int>(std::distance(tracks.begin(), trackIt)));
-            if(operation == CommonOperation::Update) {
-                result.push_back(*updatedIt);
-            }
-        }
-        else {
-            result.push_back(*trackIt);
-        }
-    }
-
-    tracks = result;
-    return indexes;
-}
-} // namespace
-
 namespace Fooyin {
 struct PlaylistHandler::Private
 {
@@ -77,15 +46,19 @@ struct PlaylistHandler::Private
     PlayerController* playerController;
     SettingsManager* settings;
     PlaylistDatabase playlistConnector;
+    PlaylistDatabase playlistReader;
 
     std::vector<std::unique_ptr<Playlist>> playlists;
     std::vector<std::unique_ptr<Playlist>> removedPlaylists;
+    // Summaries of the restored playlists, used to defer loading their tracks
+    std::vector<PlaylistInfo> restoredInfos;
+    std::function<TrackSnapshot()> trackSource;
 
     Playlist* activePlaylist{nullptr};
     Playlist* scheduledPlaylist{nullptr};
 
-    Private(PlaylistHandler* self_, DbConnectionPoolPtr dbPool_, PlayerController* playerController_,
-            SettingsManager* settings_)
+    Private(PlaylistHandler* self_, DbConnectionPoolPtr dbPool_, const DbConnectionPoolPtr& readPool,
+            PlayerController* playerController_, SettingsManager* settings_)
         : self{self_}
         , dbPool{std::move(dbPool_)}
         , playerController{playerController_}
@@ -93,17 +66,46 @@ struct PlaylistHandler::Private
     {
         const DbConnectionProvider dbProvider{dbPool};
         playlistConnector.initialise(dbProvider);
+        playlistReader.initialise(readPool && readPool->hasThreadConnection() ? DbConnectionProvider{readPool}
+                                                                               : dbProvider);
     }
 
     void reloadPlaylists()
     {
-        const std::vector<PlaylistInfo> infos = playlistConnector.getAllPlaylists();
+        restoredInfos = playlistReader.getAllPlaylists();
 
-        for(const auto& info : infos) {
+        for(const auto& info : restoredInfos) {
             playlists.emplace_back(Playlist::create(info.dbId, info.name, info.index));
         }
     }
 
+    void deferPlaylistLoading()
+    {
+        for(const auto& info : restoredInfos) {
+            auto* playlist = self->playlistByDbId(info.dbId);
+            // Skip playlists changed before the library finished loading
+            if(!playlist || playlist->tracksModified()) {
+                continue;
+            }
+
+            auto loader = [this, playlist]() {
+                const StartupTrace::Scope trace{"PlaylistHandler::loadPlaylist"};
+                return playlistReader.getPlaylistTracks(*playlist, trackSource());
+            };
+
+            if(info.trackCount < 0) {
+                // Saved before summaries were stored, so load now and save one
+                playlist->replaceTracks(loader());
+                playlist->setTracksModified(true);
+            }
+            else {
+                playlist->setLoader(info.trackCount, info.duration, loader);
+            }
+        }
+
+        restoredInfos.clear();
+    }
+
     bool noConcretePlaylists()
     {
         return playlists.empty()
@@ -154,6 +156,23 @@ struct PlaylistHandler::Private
         return activePlaylist->nextTrack(delta, playerController->playMode());
     }
 
+    // Returns the track expected to play after the current one, without changing any playback state
+    [[nodiscard]] Track peekNextTrack() const
+    {
+        const PlaylistTrack queuedTrack = playerController->nextQueuedTrack();
+        if(queuedTrack.isValid()) {
+            return queuedTrack.track;
+        }
+
+        // Stopping is left to the actual track change
+        auto* playlist = scheduledPlaylist ? scheduledPlaylist : activePlaylist;
+        if(!playlist) {
+            return {};
+        }
+
+        return playlist->nextTrack(1, playerController->playMode());
+    }
+
     void next()
     {
         nextTrackChange(1);
@@ -280,10 +299,10 @@ struct PlaylistHandler::Private
     }
 };
 
-PlaylistHandler::PlaylistHandler(DbConnectionPoolPtr dbPool, PlayerController* playerController,
-                                 SettingsManager* settings, QObject* parent)
+PlaylistHandler::PlaylistHandler(DbConnectionPoolPtr dbPool, const DbConnectionPoolPtr& readPool,
+                                 PlayerController* playerController, SettingsManager* settings, QObject* parent)
     : QObject{parent}
-    , p{std::make_unique<Private>(this, std::move(dbPool), playerController, settings)}
+    , p{std::make_unique<Private>(this, std::move(dbPool), readPool, playerController, settings)}
 {
     p->reloadPlaylists();
 
@@ -293,6 +312,12 @@ PlaylistHandler::PlaylistHandler(DbConnectionPoolPtr dbPool, PlayerController* p
 
     QObject::connect(p->playerController, &PlayerController::nextTrack, this, [this]() { p->next(); });
     QObject::connect(p->playerController, &PlayerController::previousTrack, this, [this]() { p->previous(); });
+    QObject::connect(p->playerController, &PlayerController::trackNearingEnd, this, [this]() {
+        const Track track = p->peekNextTrack();
+        if(track.isValid()) {
+            emit upcomingTrack(track);
+        }
+    });
 }
 
 PlaylistHandler::~PlaylistHandler()
@@ -428,12 +453,100 @@ Playlist* PlaylistHandler::createTempPlaylist(const QString& name, const TrackLi
 void PlaylistHandler::appendToPlaylist(const Id& id, const TrackList& tracks)
 {
     if(auto* playlist = playlistById(id)) {
-        const int index = playlist->trackCount();
-        playlist->appendTracks(tracks);
+        const int index = playlist->insertTracks(-1, tracks);
         emit playlistTracksAdded(playlist, tracks, index);
     }
 }
 
+void PlaylistHandler::insertPlaylistTracks(const Id& id, int index, const TrackList& tracks)
+{
+    if(auto* playlist = playlistById(id)) {
+        const int insertedIndex = playlist->insertTracks(index, tracks);
+        emit playlistTracksAdded(playlist, tracks, insertedIndex);
+    }
+}
+
+void PlaylistHandler::updatePlaylistTracks(const Id& id, const std::vector<int>& indexes, const TrackList& tracks)
+{
+    if(auto* playlist = playlistById(id)) {
+        if(playlist->updateTracksAt(indexes, tracks)) {
+            emit playlistTracksChanged(playlist, indexes);
+        }
+    }
+}
+
+void PlaylistHandler::reorderPlaylistTracks(const Id& id, const std::vector<int>& indexes, int to)
+{
+    if(auto* playlist = playlistById(id)) {
+        const auto movedIndexes = playlist->moveTracks(indexes, to);
+        if(movedIndexes.empty()) {
+            return;
+        }
+
+        // Every track between the first and last position touched has shifted
+        const auto [minIt, maxIt] = std::ranges::minmax_element(indexes);
+        const int first           = std::min(*minIt, movedIndexes.front());
+        const int last            = std::max(*maxIt, movedIndexes.back());
+
+        std::vector<int> changedIndexes(last - first + 1);
+        std::iota(changedIndexes.begin(), changedIndexes.end(), first);
+
+        emit playlistTracksChanged(playlist, changedIndexes);
+    }
+}
+
+void PlaylistHandler::sortPlaylistTracks(const Id& id, const std::vector<int>& order)
+{
+    auto* playlist = playlistById(id);
+    if(!playlist) {
+        return;
+    }
+
+    const auto mapping = playlist->reorderTracks(order);
+    if(mapping.empty()) {
+        return;
+    }
+
+    auto remap = [&mapping](int index) {
+        return index >= 0 && std::cmp_less(index, mapping.size()) ? mapping.at(index) : index;
+    };
+
+    const PlaylistTrack currentTrack = p->playerController->currentPlaylistTrack();
+    if(currentTrack.playlistId == id) {
+        p->playerController->updateCurrentTrackIndex(remap(currentTrack.indexInPlaylist));
+    }
+
+    auto queueTracks = p->playerController->playbackQueue().tracks();
+    bool queueChanged{false};
+    for(auto& track : queueTracks) {
+        if(track.playlistId == id) {
+            const int index = std::exchange(track.indexInPlaylist, remap(track.indexInPlaylist));
+            queueChanged |= index != track.indexInPlaylist;
+        }
+    }
+    if(queueChanged) {
+        p->playerController->replaceTracks(queueTracks);
+    }
+
+    // Every track between the first and last one which moved has changed position
+    int first{-1};
+    int last{-1};
+    for(int index{0}; std::cmp_less(index, order.size()); ++index) {
+        if(order.at(index) != index) {
+            first = first < 0 ? index : first;
+            last  = index;
+        }
+    }
+    if(first < 0) {
+        return;
+    }
+
+    std::vector<int> changedIndexes(last - first + 1);
+    std::iota(changedIndexes.begin(), changedIndexes.end(), first);
+
+    emit playlistTracksReordered(playlist, changedIndexes);
+}
+
 void PlaylistHandler::replacePlaylistTracks(const Id& id, const TrackList& tracks)
 {
     if(auto* playlist = playlistById(id)) {
@@ -676,18 +789,20 @@ void PlaylistHandler::startPlayback(Playlist* playlist)
     p->startNextTrack(playlist->currentTrack(), playlist->currentTrackIndex());
 }
 
-void PlaylistHandler::populatePlaylists(const TrackList& tracks)
+void PlaylistHandler::setTrackSource(std::function<TrackSnapshot()> source)
 {
-    TrackIdMap idTracks;
-    for(const Track& track : tracks) {
-        idTracks.emplace(track.id(), track);
-    }
+    p->trackSource = std::move(source);
+}
 
-    for(const auto& playlist : p->playlists) {
-        const TrackList playlistTracks = p->playlistConnector.getPlaylistTracks(*playlist, idTracks);
-        playlist->replaceTracks(playlistTracks);
+void PlaylistHandler::populatePlaylists(const TrackSnapshot& tracks)
+{
+    const StartupTrace::Scope trace{"PlaylistHandler::populatePlaylists"};
+
+    if(!p->trackSource) {
+        p->trackSource = [tracks]() { return tracks; };
     }
 
+    p->deferPlaylistLoading();
     p->restoreActivePlaylist();
 
     emit playlistsPopulated();
@@ -696,11 +811,8 @@ void PlaylistHandler::populatePlaylists(const TrackList& tracks)
 void PlaylistHandler::tracksUpdated(const TrackList& tracks)
 {
     for(auto& playlist : p->playlists) {
-        TrackList playlistTracks  = playlist->tracks();
-        const auto updatedIndexes = updateCommonTracks(playlistTracks, tracks, CommonOperation::Update);
-
+        const auto updatedIndexes = playlist->updateTracks(tracks);
         if(!updatedIndexes.empty()) {
-            playlist->replaceTracks(playlistTracks);
             emit playlistTracksChanged(playlist.get(), updatedIndexes);
         }
     }
@@ -709,11 +821,8 @@ void PlaylistHandler::tracksUpdated(const TrackList& tracks)
 void PlaylistHandler::tracksPlayed(const TrackList& tracks)
 {
     for(auto& playlist : p->playlists) {
-        TrackList playlistTracks  = playlist->tracks();
-        const auto updatedIndexes = updateCommonTracks(playlistTracks, tracks, CommonOperation::Update);
-
+        const auto updatedIndexes = playlist->updateTracks(tracks);
         if(!updatedIndexes.empty()) {
-            playlist->replaceTracks(playlistTracks);
             emit playlistTracksPlayed(playlist.get(), updatedIndexes);
         }
     }
@@ -722,11 +831,19 @@ void PlaylistHandler::tracksPlayed(const TrackList& tracks)
 void PlaylistHandler::tracksRemoved(const TrackList& tracks)
 {
     for(auto& playlist : p->playlists) {
-        TrackList playlistTracks  = playlist->tracks();
-        const auto updatedIndexes = updateCommonTracks(playlistTracks, tracks, CommonOperation::Remove);
+        const auto removedIndexes = playlist->indexesOf(tracks);
+        if(!removedIndexes.empty()) {
+            playlist->removeTracks(removedIndexes);
+            emit playlistTracksChanged(playlist.get(), removedIndexes);
+        }
+    }
+}
 
+void PlaylistHandler::libraryChanged(const LibraryDelta& delta)
+{
+    for(auto& playlist : p->playlists) {
+        const auto updatedIndexes = playlist->applyLibraryDelta(delta);
         if(!updatedIndexes.empty()) {
-            playlist->replaceTracks(playlistTracks);
             emit playlistTracksChanged(playlist.get(), updatedIndexes);
         }
     }
@@ -734,7 +851,10 @@ void PlaylistHandler::tracksRemoved(const TrackList& tracks)
 
 void PlaylistHandler::trackAboutToFinish()
 {
-    p->nextTrack(1);
+    const Track track = p->peekNextTrack();
+    if(track.isValid()) {
+        emit nextTrackReady(track);
+    }
 }
 } // namespace Fooyin
 
@@ -0,0 +1,466 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <core/playlist/playlistparser.h>
+
+#include <core/track.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringDecoder>
+#include <QUrl>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+constexpr auto XspfNamespace = "http://xspf.org/ns/0/";
+
+namespace {
+using Fooyin::PlaylistParser::Entry;
+using Fooyin::PlaylistParser::EntryCallback;
+using Fooyin::PlaylistParser::Format;
+
+QString decodeLine(const QByteArray& line, Format format)
+{
+    if(format == Format::M3u) {
+        // Plain .m3u files are often in the system encoding, so only trust UTF-8 if it decodes cleanly
+        QStringDecoder decoder{QStringDecoder::Utf8};
+        QString text = decoder(line);
+        return decoder.hasError() ? QString::fromLocal8Bit(line) : text;
+    }
+    return QString::fromUtf8(line);
+}
+
+QString resolvePath(QString path, const QDir& dir)
+{
+    if(path.startsWith(QLatin1String("file:"), Qt::CaseInsensitive)) {
+        const QUrl url{path};
+        if(!url.isLocalFile()) {
+            return {};
+        }
+        path = url.toLocalFile();
+    }
+    else if(path.contains(QLatin1String("://"))) {
+        // Streams aren't supported
+        return {};
+    }
+
+    // Playlists written on Windows
+    path.replace(u'\\', u'/');
+
+    return QDir::cleanPath(dir.absoluteFilePath(path));
+}
+
+QString resolveUrl(const QString& location, const QDir& dir)
+{
+    QUrl url{location};
+    if(url.isRelative()) {
+        url = QUrl::fromLocalFile(dir.absolutePath() + u'/').resolved(url);
+    }
+    if(!url.isLocalFile()) {
+        return {};
+    }
+    return QDir::cleanPath(url.toLocalFile());
+}
+
+uint64_t secondsToMs(QStringView seconds)
+{
+    bool ok{false};
+    const double value = seconds.trimmed().toDouble(&ok);
+    return ok && value > 0 ? static_cast<uint64_t>(value * 1000) : 0;
+}
+
+bool readM3u(QIODevice* device, Format format, const QDir& dir, const EntryCallback& callback)
+{
+    Entry entry;
+    bool firstLine{true};
+
+    while(!device->atEnd()) {
+        QByteArray bytes = device->readLine();
+        if(firstLine) {
+            if(bytes.startsWith("\xEF\xBB\xBF")) {
+                bytes.remove(0, 3);
+                format = Format::M3u8;
+            }
+            firstLine = false;
+        }
+
+        const QString line = decodeLine(bytes, format).trimmed();
+        if(line.isEmpty()) {
+            continue;
+        }
+
+        if(line.startsWith(u'#')) {
+            if(line.startsWith(QLatin1String("#EXTINF:"))) {
+                // #EXTINF:<seconds> [attributes],<title>
+                const QStringView info = QStringView{line}.mid(8);
+                const auto comma       = info.indexOf(u',');
+                const QStringView time = info.left(comma).split(u' ').front();
+
+                entry.duration = secondsToMs(time);
+                entry.title    = comma >= 0 ? info.mid(comma + 1).trimmed().toString() : QString{};
+            }
+            continue;
+        }
+
+        entry.filepath = resolvePath(line, dir);
+        if(!entry.filepath.isEmpty() && !callback(entry)) {
+            return true;
+        }
+        entry = {};
+    }
+
+    return true;
+}
+
+bool readPls(QIODevice* device, const QDir& dir, const EntryCallback& callback, QString* error)
+{
+    // Keys are grouped by entry number (File1, Title1, Length1...), so only the current entry is kept
+    Entry entry;
+    int current{-1};
+    bool foundHeader{false};
+
+    auto flush = [&]() {
+        const bool keepReading = entry.filepath.isEmpty() || callback(entry);
+        entry                  = {};
+        return keepReading;
+    };
+
+    while(!device->atEnd()) {
+        const QString line = QString::fromUtf8(device->readLine()).trimmed();
+        if(line.isEmpty() || line.startsWith(u';')) {
+            continue;
+        }
+
+        if(line.startsWith(u'[')) {
+            foundHeader |= line.compare(QLatin1String("[playlist]"), Qt::CaseInsensitive) == 0;
+            continue;
+        }
+
+        const auto equals = line.indexOf(u'=');
+        if(equals < 0) {
+            continue;
+        }
+
+        const QStringView key   = QStringView{line}.left(equals).trimmed();
+        const QStringView value = QStringView{line}.mid(equals + 1).trimmed();
+
+        QStringView field;
+        for(const auto name : {QLatin1String("File"), QLatin1String("Title"), QLatin1String("Length")}) {
+            if(key.startsWith(name, Qt::CaseInsensitive)) {
+                field = key.left(name.size());
+                break;
+            }
+        }
+        if(field.isEmpty()) {
+            continue;
+        }
+
+        bool ok{false};
+        const int number = key.mid(field.size()).toInt(&ok);
+        if(!ok) {
+            continue;
+        }
+
+        if(number != current) {
+            if(!flush()) {
+                return true;
+            }
+            current = number;
+        }
+
+        if(field.compare(QLatin1String("File"), Qt::CaseInsensitive) == 0) {
+            entry.filepath = resolvePath(value.toString(), dir);
+        }
+        else if(field.compare(QLatin1String("Title"), Qt::CaseInsensitive) == 0) {
+            entry.title = value.toString();
+        }
+        else {
+            entry.duration = secondsToMs(value);
+        }
+    }
+
+    flush();
+
+    if(!foundHeader) {
+        if(error) {
+            *error = QStringLiteral("Missing [playlist] section");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool readXspf(QIODevice* device, const QDir& dir, const EntryCallback& callback, QString* error)
+{
+    QXmlStreamReader xml{device};
+
+    while(!xml.atEnd()) {
+        xml.readNext();
+        if(!xml.isStartElement() || xml.name() != QLatin1String("track")) {
+            continue;
+        }
+
+        Entry entry;
+        while(xml.readNextStartElement()) {
+            const auto name = xml.name();
+            if(name == QLatin1String("location") && entry.filepath.isEmpty()) {
+                entry.filepath = resolveUrl(xml.readElementText().trimmed(), dir);
+            }
+            else if(name == QLatin1String("title")) {
+                entry.title = xml.readElementText().trimmed();
+            }
+            else if(name == QLatin1String("duration")) {
+                entry.duration = xml.readElementText().trimmed().toULongLong();
+            }
+            else {
+                xml.skipCurrentElement();
+            }
+        }
+
+        if(!entry.filepath.isEmpty() && !callback(entry)) {
+            return true;
+        }
+    }
+
+    if(xml.hasError()) {
+        if(error) {
+            *error = xml.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+QString entryPath(const Fooyin::Track& track, const QDir& dir, bool relativePaths)
+{
+    const QString filepath = track.filepath();
+    if(relativePaths && filepath.startsWith(dir.absolutePath() + u'/')) {
+        return dir.relativeFilePath(filepath);
+    }
+    return filepath;
+}
+
+QString entryTitle(const Fooyin::Track& track)
+{
+    const QString title = track.title().isEmpty() ? track.filename() : track.title();
+    const QString artist = track.artist();
+    return artist.isEmpty() ? title : artist + QLatin1String(" - ") + title;
+}
+
+bool writeM3u(QIODevice* device, Format format, const Fooyin::TrackList& tracks, const QDir& dir,
+              bool relativePaths)
+{
+    const auto encode = [format](const QString& text) {
+        return format == Format::M3u8 ? text.toUtf8() : text.toLocal8Bit();
+    };
+
+    if(device->write("#EXTM3U\n") < 0) {
+        return false;
+    }
+
+    for(const Fooyin::Track& track : tracks) {
+        const auto seconds = track.duration() > 0 ? static_cast<int64_t>(track.duration() / 1000) : -1;
+
+        QByteArray lines = "#EXTINF:" + QByteArray::number(seconds) + ',' + encode(entryTitle(track)) + '\n';
+        lines += encode(entryPath(track, dir, relativePaths)) + '\n';
+
+        if(device->write(lines) < 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool writePls(QIODevice* device, const Fooyin::TrackList& tracks, const QDir& dir, bool relativePaths)
+{
+    if(device->write("[playlist]\n") < 0) {
+        return false;
+    }
+
+    // The entry count is written last, so the tracks don't need to be counted up front
+    int number{0};
+    for(const Fooyin::Track& track : tracks) {
+        const QByteArray index = QByteArray::number(++number);
+
+        QByteArray lines = "File" + index + '=' + entryPath(track, dir, relativePaths).toUtf8() + '\n';
+        lines += "Title" + index + '=' + entryTitle(track).toUtf8() + '\n';
+        if(track.duration() > 0) {
+            lines += "Length" + index + '=' + QByteArray::number(track.duration() / 1000) + '\n';
+        }
+
+        if(device->write(lines) < 0) {
+            return false;
+        }
+    }
+
+    return device->write("NumberOfEntries=" + QByteArray::number(number) + "\nVersion=2\n") >= 0;
+}
+
+bool writeXspf(QIODevice* device, const Fooyin::TrackList& tracks, const QDir& dir, bool relativePaths)
+{
+    QXmlStreamWriter xml{device};
+    xml.setAutoFormatting(true);
+
+    xml.writeStartDocument();
+    xml.writeStartElement(QLatin1String("playlist"));
+    xml.writeAttribute(QLatin1String("version"), QLatin1String("1"));
+    xml.writeDefaultNamespace(QString::fromLatin1(XspfNamespace));
+    xml.writeStartElement(QLatin1String("trackList"));
+
+    for(const Fooyin::Track& track : tracks) {
+        const QString path = entryPath(track, dir, relativePaths);
+        const QString location
+            = QDir::isRelativePath(path) ? QString::fromUtf8(QUrl::toPercentEncoding(path, "/"))
+                                         : QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded);
+
+        xml.writeStartElement(QLatin1String("track"));
+        xml.writeTextElement(QLatin1String("location"), location);
+        if(!track.title().isEmpty()) {
+            xml.writeTextElement(QLatin1String("title"), track.title());
+        }
+        if(!track.artist().isEmpty()) {
+            xml.writeTextElement(QLatin1String("creator"), track.artist());
+        }
+        if(!track.album().isEmpty()) {
+            xml.writeTextElement(QLatin1String("album"), track.album());
+        }
+        if(track.duration() > 0) {
+            xml.writeTextElement(QLatin1String("duration"), QString::number(track.duration()));
+        }
+        xml.writeEndElement();
+
+        if(xml.hasError()) {
+            return false;
+        }
+    }
+
+    xml.writeEndDocument();
+
+    return !xml.hasError();
+}
+} // namespace
+
+namespace Fooyin::PlaylistParser {
+QStringList supportedExtensions()
+{
+    static const QStringList extensions{QStringLiteral("m3u"), QStringLiteral("m3u8"), QStringLiteral("pls"),
+                                        QStringLiteral("xspf")};
+    return extensions;
+}
+
+Format formatForFile(const QString& filepath)
+{
+    const QString suffix = QFileInfo{filepath}.suffix().toLower();
+
+    if(suffix == QLatin1String("m3u")) {
+        return Format::M3u;
+    }
+    if(suffix == QLatin1String("m3u8")) {
+        return Format::M3u8;
+    }
+    if(suffix == QLatin1String("pls")) {
+        return Format::Pls;
+    }
+    if(suffix == QLatin1String("xspf")) {
+        return Format::Xspf;
+    }
+
+    return Format::Unknown;
+}
+
+bool read(QIODevice* device, Format format, const QString& dir, const EntryCallback& callback, QString* error)
+{
+    const QDir baseDir{dir};
+
+    switch(format) {
+        case(Format::M3u):
+        case(Format::M3u8):
+            return readM3u(device, format, baseDir, callback);
+        case(Format::Pls):
+            return readPls(device, baseDir, callback, error);
+        case(Format::Xspf):
+            return readXspf(device, baseDir, callback, error);
+        case(Format::Unknown):
+            break;
+    }
+
+    if(error) {
+        *error = QStringLiteral("Unsupported playlist format");
+    }
+    return false;
+}
+
+bool read(const QString& filepath, const EntryCallback& callback, QString* error)
+{
+    QFile file{filepath};
+    if(!file.open(QIODevice::ReadOnly)) {
+        if(error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    return read(&file, formatForFile(filepath), QFileInfo{filepath}.absolutePath(), callback, error);
+}
+
+bool write(QIODevice* device, Format format, const TrackList& tracks, const QString& dir, bool relativePaths)
+{
+    const QDir baseDir{dir};
+
+    switch(format) {
+        case(Format::M3u):
+        case(Format::M3u8):
+            return writeM3u(device, format, tracks, baseDir, relativePaths);
+        case(Format::Pls):
+            return writePls(device, tracks, baseDir, relativePaths);
+        case(Format::Xspf):
+            return writeXspf(device, tracks, baseDir, relativePaths);
+        case(Format::Unknown):
+            break;
+    }
+
+    return false;
+}
+
+bool write(const QString& filepath, const TrackList& tracks, bool relativePaths)
+{
+    const Format format = formatForFile(filepath);
+    if(format == Format::Unknown) {
+        return false;
+    }
+
+    QSaveFile file{filepath};
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    if(!write(&file, format, tracks, QFileInfo{filepath}.absolutePath(), relativePaths)) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+} // namespace Fooyin::PlaylistParser
@@ -0,0 +1,404 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <core/playlist/smartplaylistmanager.h>
+
+#include <core/library/musiclibrary.h>
+#include <core/library/trackquery.h>
+#include <core/library/trackqueryindex.h>
+#include <core/playlist/playlist.h>
+#include <core/playlist/playlisthandler.h>
+#include <core/track.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QBasicTimer>
+#include <QDateTime>
+#include <QTimerEvent>
+
+#include <unordered_set>
+
+using namespace std::chrono_literals;
+
+constexpr auto SmartPlaylistsKey = "Playlist/SmartPlaylists";
+
+// How often queries comparing against an age are re-evaluated
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+constexpr auto TimeRelativeRefreshInterval = 1h;
+#else
+constexpr auto TimeRelativeRefreshInterval = 3600000;
+#endif
+
+namespace {
+uint64_t currentTime()
+{
+    return static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch());
+}
+} // namespace
+
+namespace Fooyin {
+struct SmartPlaylistManager::Private
+{
+    SmartPlaylistManager* self;
+
+    MusicLibrary* library;
+    PlaylistHandler* playlistHandler;
+    SettingsManager* settings;
+
+    struct Entry
+    {
+        int dbId{-1};
+        QString queryString;
+        TrackQuery query;
+        // Ids of the library tracks currently matching
+        std::unordered_set<int> members;
+        // Whether play count changes can change the result
+        bool dependsOnPlays{false};
+    };
+    std::vector<Entry> entries;
+
+    bool populated{false};
+    QBasicTimer refreshTimer;
+
+    Private(SmartPlaylistManager* self_, MusicLibrary* library_, PlaylistHandler* playlistHandler_,
+            SettingsManager* settings_)
+        : self{self_}
+        , library{library_}
+        , playlistHandler{playlistHandler_}
+        , settings{settings_}
+    {
+        load();
+    }
+
+    static Entry makeEntry(int dbId, const QString& queryString, TrackQuery query)
+    {
+        Entry entry;
+        entry.dbId        = dbId;
+        entry.queryString = queryString;
+        entry.query       = std::move(query);
+
+        using Field          = TrackQuery::Field;
+        entry.dependsOnPlays = entry.query.usesField(Field::PlayCount) || entry.query.usesField(Field::FirstPlayed)
+                            || entry.query.usesField(Field::LastPlayed) || entry.query.usesField(Field::Tag);
+        return entry;
+    }
+
+    void load()
+    {
+        const QVariantMap saved = settings->fileValue(QString::fromLatin1(SmartPlaylistsKey)).toMap();
+
+        for(const auto& [dbId, query] : saved.asKeyValueRange()) {
+            const QString queryString = query.toString();
+            TrackQuery parsed         = TrackQuery::parse(queryString);
+            if(parsed.isValid()) {
+                entries.push_back(makeEntry(dbId.toInt(), queryString, std::move(parsed)));
+            }
+        }
+    }
+
+    void save() const
+    {
+        if(entries.empty()) {
+            settings->fileRemove(QString::fromLatin1(SmartPlaylistsKey));
+            return;
+        }
+
+        QVariantMap saved;
+        for(const Entry& entry : entries) {
+            saved.insert(QString::number(entry.dbId), entry.queryString);
+        }
+        settings->fileSet(QString::fromLatin1(SmartPlaylistsKey), saved);
+    }
+
+    void updateRefreshTimer()
+    {
+        const bool timeRelative
+            = std::ranges::any_of(entries, [](const Entry& entry) { return entry.query.isTimeRelative(); });
+
+        if(timeRelative && populated) {
+            if(!refreshTimer.isActive()) {
+                refreshTimer.start(TimeRelativeRefreshInterval, self);
+            }
+        }
+        else {
+            refreshTimer.stop();
+        }
+    }
+
+    [[nodiscard]] Entry* entryFor(const Id& playlistId)
+    {
+        const auto* playlist = playlistHandler->playlistById(playlistId);
+        if(!playlist) {
+            return nullptr;
+        }
+
+        auto entryIt = std::ranges::find(entries, playlist->dbId(), &Entry::dbId);
+        return entryIt != entries.end() ? &*entryIt : nullptr;
+    }
+
+    // Evaluates the entries accepted by @p filter against the whole library, sharing a single index
+    template <typename Filter>
+    void evaluate(Filter&& filter)
+    {
+        if(!populated) {
+            return;
+        }
+
+        std::vector<Entry*> toEvaluate;
+        for(Entry& entry : entries) {
+            if(filter(entry)) {
+                toEvaluate.push_back(&entry);
+            }
+        }
+        if(toEvaluate.empty()) {
+            return;
+        }
+
+        TrackQueryIndex index;
+        index.build(library->snapshot().tracks());
+
+        const uint64_t now = currentTime();
+        for(Entry* entry : toEvaluate) {
+            apply(*entry, index.evaluate(entry->query, now, &library->searchIndex()));
+        }
+    }
+
+    void apply(Entry& entry, const TrackList& tracks)
+    {
+        entry.members.clear();
+        for(const Track& track : tracks) {
+            entry.members.emplace(track.id());
+        }
+
+        if(auto* playlist = playlistHandler->playlistByDbId(entry.dbId)) {
+            if(playlist->tracks() != tracks) {
+                playlistHandler->replacePlaylistTracks(playlist->id(), tracks);
+            }
+        }
+    }
+
+    // Tests only @p tracks against each entry accepted by @p filter, adding and removing them as needed
+    template <typename Filter>
+    void updateMembers(const TrackList& tracks, Filter&& filter)
+    {
+        if(!populated || tracks.empty()) {
+            return;
+        }
+
+        const uint64_t now = currentTime();
+
+        for(Entry& entry : entries) {
+            if(!filter(entry)) {
+                continue;
+            }
+
+            TrackList added;
+            std::unordered_set<int> removed;
+
+            for(const Track& track : tracks) {
+                const bool isMember = entry.members.contains(track.id());
+                const bool matches  = entry.query.matches(track, now);
+
+                if(matches && !isMember) {
+                    added.push_back(track);
+                    entry.members.emplace(track.id());
+                }
+                else if(!matches && isMember) {
+                    removed.emplace(track.id());
+                    entry.members.erase(track.id());
+                }
+            }
+
+            auto* playlist = playlistHandler->playlistByDbId(entry.dbId);
+            if(!playlist) {
+                continue;
+            }
+
+            if(!removed.empty()) {
+                removeFromPlaylist(playlist, removed);
+            }
+            if(!added.empty()) {
+                playlistHandler->appendToPlaylist(playlist->id(), added);
+            }
+        }
+    }
+
+    void removeFromPlaylist(Playlist* playlist, const std::unordered_set<int>& ids) const
+    {
+        std::vector<int> indexes;
+        for(int i{0}; const Track& track : playlist->tracks()) {
+            if(ids.contains(track.id())) {
+                indexes.push_back(i);
+            }
+            ++i;
+        }
+
+        if(!indexes.empty()) {
+            playlistHandler->removePlaylistTracks(playlist->id(), indexes);
+        }
+    }
+
+    void tracksRemoved(const TrackList& tracks)
+    {
+        if(!populated) {
+            return;
+        }
+
+        for(Entry& entry : entries) {
+            std::unordered_set<int> removed;
+            for(const Track& track : tracks) {
+                if(entry.members.erase(track.id()) > 0) {
+                    removed.emplace(track.id());
+                }
+            }
+
+            if(!removed.empty()) {
+                if(auto* playlist = playlistHandler->playlistByDbId(entry.dbId)) {
+                    removeFromPlaylist(playlist, removed);
+                }
+            }
+        }
+    }
+
+    void playlistRemoved(const Playlist* playlist)
+    {
+        if(std::erase_if(entries, [playlist](const Entry& entry) { return entry.dbId == playlist->dbId(); }) > 0) {
+            save();
+            updateRefreshTimer();
+            emit self->smartPlaylistsChanged();
+        }
+    }
+};
+
+SmartPlaylistManager::SmartPlaylistManager(MusicLibrary* library, PlaylistHandler* playlistHandler,
+                                           SettingsManager* settings, QObject* parent)
+    : QObject{parent}
+    , p{std::make_unique<Private>(this, library, playlistHandler, settings)}
+{
+    QObject::connect(playlistHandler, &PlaylistHandler::playlistsPopulated, this, [this]() {
+        p->populated = true;
+        refresh();
+        p->updateRefreshTimer();
+    });
+    QObject::connect(playlistHandler, &PlaylistHandler::playlistRemoved, this,
+                     [this](Playlist* playlist) { p->playlistRemoved(playlist); });
+
+    QObject::connect(library, &MusicLibrary::tracksAdded, this, [this](const TrackList& tracks) {
+        p->updateMembers(tracks, [](const auto& /*entry*/) { return true; });
+    });
+    QObject::connect(library, &MusicLibrary::tracksUpdated, this, [this](const TrackList& tracks) {
+        p->updateMembers(tracks, [](const auto& /*entry*/) { return true; });
+    });
+    QObject::connect(library, &MusicLibrary::tracksPlayed, this, [this](const TrackList& tracks) {
+        p->updateMembers(tracks, [](const auto& entry) { return entry.dependsOnPlays; });
+    });
+    QObject::connect(library, &MusicLibrary::tracksDeleted, this,
+                     [this](const TrackList& tracks) { p->tracksRemoved(tracks); });
+    // Any of the library's tracks may have changed, so they're tested together against one index
+    QObject::connect(library, &MusicLibrary::libraryChanged, this,
+                     [this]() { p->evaluate([](const auto& /*entry*/) { return true; }); });
+}
+
+SmartPlaylistManager::~SmartPlaylistManager() = default;
+
+std::vector<SmartPlaylistManager::SmartPlaylist> SmartPlaylistManager::smartPlaylists() const
+{
+    std::vector<SmartPlaylist> smartPlaylists;
+
+    for(const auto& entry : p->entries) {
+        if(const auto* playlist = p->playlistHandler->playlistByDbId(entry.dbId)) {
+            smartPlaylists.push_back({playlist->id(), playlist->name(), entry.queryString});
+        }
+    }
+
+    return smartPlaylists;
+}
+
+bool SmartPlaylistManager::isSmartPlaylist(const Id& playlistId) const
+{
+    return p->entryFor(playlistId) != nullptr;
+}
+
+QString SmartPlaylistManager::query(const Id& playlistId) const
+{
+    if(const auto* entry = p->entryFor(playlistId)) {
+        return entry->queryString;
+    }
+    return {};
+}
+
+Playlist* SmartPlaylistManager::setSmartPlaylist(const QString& name, const QString& query, QString* error)
+{
+    TrackQuery parsed = TrackQuery::parse(query);
+    if(!parsed.isValid()) {
+        if(error) {
+            *error = parsed.error();
+        }
+        return nullptr;
+    }
+
+    auto* playlist = p->playlistHandler->createPlaylist(name);
+    if(!playlist || playlist->isTemporary()) {
+        if(error) {
+            *error = tr("Unable to create playlist");
+        }
+        return nullptr;
+    }
+
+    auto entryIt = std::ranges::find(p->entries, playlist->dbId(), &Private::Entry::dbId);
+    if(entryIt != p->entries.end()) {
+        *entryIt = Private::makeEntry(playlist->dbId(), query, std::move(parsed));
+    }
+    else {
+        entryIt = p->entries.insert(p->entries.end(), Private::makeEntry(playlist->dbId(), query, std::move(parsed)));
+    }
+
+    const int dbId = playlist->dbId();
+    p->evaluate([dbId](const auto& entry) { return entry.dbId == dbId; });
+
+    p->save();
+    p->updateRefreshTimer();
+    emit smartPlaylistsChanged();
+
+    return playlist;
+}
+
+void SmartPlaylistManager::removeSmartPlaylist(const Id& playlistId)
+{
+    if(auto* playlist = p->playlistHandler->playlistById(playlistId)) {
+        p->playlistRemoved(playlist);
+    }
+}
+
+void SmartPlaylistManager::refresh()
+{
+    p->evaluate([](const auto& /*entry*/) { return true; });
+}
+
+void SmartPlaylistManager::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == p->refreshTimer.timerId()) {
+        p->evaluate([](const auto& entry) { return entry.query.isTimeRelative(); });
+    }
+
+    QObject::timerEvent(event);
+}
+} // namespace Fooyin
+
+#include "core/playlist/moc_smartplaylistmanager.cpp"
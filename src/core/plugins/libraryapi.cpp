@@ -0,0 +1,180 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/plugins/libraryapi.h>
+
+#include <core/library/groupingcache.h>
+#include <core/library/musiclibrary.h>
+#include <core/library/trackqueryindex.h>
+#include <core/library/tracksearchindex.h>
+
+#include <QDateTime>
+
+#include <mutex>
+#include <unordered_set>
+
+namespace Fooyin {
+struct LibraryApi::Private
+{
+    std::function<TrackSnapshot()> snapshot;
+    const TrackSearchIndex* searchIndex;
+    const GroupingCache* groupingCache;
+
+    // The query index of the snapshot it was built from, which is kept so it can be compared with later ones
+    std::mutex queryMutex;
+    TrackSnapshot querySnapshot;
+    std::shared_ptr<const TrackQueryIndex> queryIndex;
+
+    Private(std::function<TrackSnapshot()> snapshot_, const TrackSearchIndex* searchIndex_,
+            const GroupingCache* groupingCache_)
+        : snapshot{std::move(snapshot_)}
+        , searchIndex{searchIndex_}
+        , groupingCache{groupingCache_}
+    { }
+
+    std::shared_ptr<const TrackQueryIndex> queryIndexFor(const TrackSnapshot& current)
+    {
+        const std::scoped_lock lock{queryMutex};
+
+        // Snapshots never change, so sharing the same tracks means nothing has changed since the last build
+        if(!queryIndex || &querySnapshot.tracks() != &current.tracks()) {
+            auto index = std::make_shared<TrackQueryIndex>();
+            index->build(current.tracks());
+            queryIndex    = std::move(index);
+            querySnapshot = current;
+        }
+
+        return queryIndex;
+    }
+};
+
+LibraryApi::LibraryApi(MusicLibrary* library)
+    : LibraryApi{[library]() { return library->snapshot(); }, &library->searchIndex(), &library->groupingCache()}
+{ }
+
+LibraryApi::LibraryApi(std::function<TrackSnapshot()> snapshot, const TrackSearchIndex* searchIndex,
+                       const GroupingCache* groupingCache)
+    : p{std::make_unique<Private>(std::move(snapshot), searchIndex, groupingCache)}
+{ }
+
+LibraryApi::~LibraryApi() = default;
+
+int LibraryApi::version()
+{
+    return Version;
+}
+
+TrackSnapshot LibraryApi::snapshot() const
+{
+    return p->snapshot();
+}
+
+std::optional<Track> LibraryApi::trackForId(int id) const
+{
+    const TrackSnapshot current = p->snapshot();
+    if(const Track* track = current.track(id)) {
+        return *track;
+    }
+    return {};
+}
+
+TrackList LibraryApi::tracksForIds(const TrackIds& ids) const
+{
+    return p->snapshot().tracksForIds(ids);
+}
+
+std::optional<Track> LibraryApi::trackForPath(const QString& filepath) const
+{
+    const TrackSnapshot current = p->snapshot();
+    if(const Track* track = current.trackForPath(filepath)) {
+        return *track;
+    }
+    return {};
+}
+
+std::vector<QStringList> LibraryApi::groupValues(const QString& script, const TrackList& tracks) const
+{
+    return p->groupingCache->values(script, tracks);
+}
+
+QStringList LibraryApi::groups(const QString& script) const
+{
+    const TrackSnapshot current = p->snapshot();
+    const auto values           = p->groupingCache->values(script, current.tracks());
+
+    QStringList groups;
+    std::unordered_set<QString> seen;
+
+    for(const QStringList& trackValues : values) {
+        for(const QString& value : trackValues) {
+            if(seen.emplace(value).second) {
+                groups.push_back(value);
+            }
+        }
+    }
+
+    return groups;
+}
+
+TrackList LibraryApi::tracksInGroup(const QString& script, const QString& group) const
+{
+    const TrackSnapshot current = p->snapshot();
+    const TrackList& tracks     = current.tracks();
+    const auto values           = p->groupingCache->values(script, tracks);
+
+    TrackList grouped;
+    for(size_t i{0}; i < values.size(); ++i) {
+        if(values.at(i).contains(group)) {
+            grouped.push_back(tracks.at(i));
+        }
+    }
+
+    return grouped;
+}
+
+TrackList LibraryApi::tracksMatching(const QString& query, QString* error) const
+{
+    const TrackQuery parsed = TrackQuery::parse(query);
+    if(!parsed.isValid()) {
+        if(error) {
+            *error = parsed.error();
+        }
+        return {};
+    }
+
+    return tracksMatching(parsed);
+}
+
+TrackList LibraryApi::tracksMatching(const TrackQuery& query) const
+{
+    if(!query.isValid()) {
+        return {};
+    }
+
+    const TrackSnapshot current = p->snapshot();
+    if(query.isEmpty()) {
+        return current.tracks();
+    }
+
+    const auto index   = p->queryIndexFor(current);
+    const uint64_t now = static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch());
+
+    return index->evaluate(query, now, p->searchIndex);
+}
+} // namespace Fooyin
@@ -21,7 +21,9 @@
 
 #include <core/plugins/plugin.h>
 
+#include <QJsonArray>
 #include <QPluginLoader>
+
 #include <utility>
 
 namespace Fooyin {
@@ -37,6 +39,8 @@ PluginInfo::PluginInfo(QString name, const QString& filename, const QJsonObject&
     , m_description{m_metadata.value(QStringLiteral("Description")).toString()}
     , m_url{m_metadata.value(QStringLiteral("Url")).toString()}
     , m_isRequired{false}
+    , m_isLazy{m_metadata.value(QStringLiteral("Lazy")).toBool()}
+    , m_canInitInParallel{m_metadata.value(QStringLiteral("CanInitInParallel")).toBool()}
     , m_isLoaded{false}
     , m_isDisabled{false}
     , m_status{Status::Read}
@@ -46,6 +50,11 @@ PluginInfo::PluginInfo(QString name, const QString& filename, const QJsonObject&
     m_loader.setFileName(filename);
 }
 
+bool PluginInfo::loadLibrary()
+{
+    return !m_loader.fileName().isEmpty() && m_loader.load();
+}
+
 void PluginInfo::load()
 {
     if(m_loader.fileName().isEmpty()) {
@@ -192,4 +201,30 @@ QString PluginInfo::url() const
 {
     return m_url;
 }
+
+bool PluginInfo::isLazy() const
+{
+    return m_isLazy;
+}
+
+bool PluginInfo::canInitInParallel() const
+{
+    return m_canInitInParallel;
+}
+
+std::vector<PluginInfo::Widget> PluginInfo::widgets() const
+{
+    std::vector<Widget> widgets;
+
+    const QJsonArray widgetArray = m_metadata.value(QStringLiteral("Widgets")).toArray();
+    for(const auto& value : widgetArray) {
+        const QJsonObject widget = value.toObject();
+        const QString key        = widget.value(QStringLiteral("Key")).toString();
+        if(!key.isEmpty()) {
+            widgets.push_back({key, widget.value(QStringLiteral("Name")).toString()});
+        }
+    }
+
+    return widgets;
+}
 } // namespace Fooyin
@@ -25,6 +25,8 @@
 #include <QPluginLoader>
 #include <QString>
 
+#include <vector>
+
 namespace Fooyin {
 class PluginManager;
 class Plugin;
@@ -44,8 +46,20 @@ public:
     };
     Q_ENUM(Status)
 
+    /** A widget provided by a lazy plugin, listed in its metadata so it can be offered before loading. */
+    struct Widget
+    {
+        QString key;
+        QString name;
+    };
+
     PluginInfo(QString name, const QString& filename, const QJsonObject& metadata);
 
+    /*!
+     * Loads the plugin's library without creating its instance.
+     * Unlike load, this is safe to call from any thread.
+     */
+    bool loadLibrary();
     void load();
     void unload();
     void initialise();
@@ -63,6 +77,11 @@ public:
     [[nodiscard]] QString copyright() const;
     [[nodiscard]] QString description() const;
     [[nodiscard]] QString url() const;
+    /** Returns @c true if the plugin is only loaded once first used, or after the main window has been shown. */
+    [[nodiscard]] bool isLazy() const;
+    /** Returns @c true if the plugin's library can be loaded concurrently with other plugins. */
+    [[nodiscard]] bool canInitInParallel() const;
+    [[nodiscard]] std::vector<Widget> widgets() const;
     [[nodiscard]] bool isLoaded() const;
     [[nodiscard]] bool isDisabled() const;
     [[nodiscard]] Status status() const;
@@ -88,6 +107,8 @@ private:
     QString m_description;
     QString m_url;
     bool m_isRequired;
+    bool m_isLazy;
+    bool m_canInitInParallel;
     bool m_isLoaded;
     bool m_isDisabled;
     Status m_status;
@@ -23,9 +23,11 @@
 #include "internalcoresettings.h"
 
 #include <utils/settings/settingsmanager.h>
+#include <utils/startuptrace.h>
 
 #include <QDir>
 #include <QLibrary>
+#include <QtConcurrentMap>
 
 namespace Fooyin {
 PluginManager::PluginManager(SettingsManager* settings)
@@ -92,11 +94,63 @@ void PluginManager::findPlugins(const QStringList& pluginDirs)
 
 void PluginManager::loadPlugins()
 {
+    std::vector<PluginInfo*> parallelPlugins;
+    std::vector<PluginInfo*> serialPlugins;
+
     for(const auto& [name, plugin] : m_plugins) {
-        loadPlugin(plugin.get());
-        if(!plugin->isLoaded()) {
+        if(plugin->isDisabled() || plugin->isLazy()) {
             continue;
         }
+        if(plugin->canInitInParallel()) {
+            parallelPlugins.push_back(plugin.get());
+        }
+        else {
+            serialPlugins.push_back(plugin.get());
+        }
+    }
+
+    // Instances are created here so they belong to this thread, the libraries are already loaded by then
+    auto loading = QtConcurrent::map(parallelPlugins, [](PluginInfo* plugin) { plugin->loadLibrary(); });
+
+    for(PluginInfo* plugin : serialPlugins) {
+        loadPlugin(plugin);
+    }
+
+    loading.waitForFinished();
+
+    for(PluginInfo* plugin : parallelPlugins) {
+        loadPlugin(plugin);
+    }
+}
+
+bool PluginManager::initialiseLazyPlugin(PluginInfo* plugin)
+{
+    if(!plugin || plugin->isDisabled() || plugin->status() == PluginInfo::Status::Invalid) {
+        return false;
+    }
+
+    if(!plugin->isLoaded()) {
+        loadPlugin(plugin);
+        if(!plugin->isLoaded()) {
+            return false;
+        }
+
+        for(const auto& initialiser : m_initialisers) {
+            initialiser(plugin);
+        }
+    }
+
+    return true;
+}
+
+void PluginManager::initialiseLazyPlugins()
+{
+    const StartupTrace::Scope trace{"PluginManager::initialiseLazyPlugins"};
+
+    for(const auto& [name, plugin] : m_plugins) {
+        if(plugin->isLazy()) {
+            initialiseLazyPlugin(plugin.get());
+        }
     }
 }
 
@@ -123,6 +177,7 @@ void PluginManager::unloadPlugins()
         plugin->unload();
     }
     m_plugins.clear();
+    m_initialisers.clear();
 }
 
 void PluginManager::shutdown()
@@ -23,6 +23,9 @@
 
 #include "plugininfo.h"
 
+#include <functional>
+#include <vector>
+
 namespace Fooyin {
 class SettingsManager;
 
@@ -39,20 +42,47 @@ public:
     const PluginInfoMap& allPluginInfo() const;
     PluginInfo* pluginInfo(const QString& name) const;
 
+    /*!
+     * Reads the metadata of each plugin in @p pluginDirs.
+     * Plugin libraries aren't loaded; QPluginLoader reads the metadata embedded in the file.
+     */
     void findPlugins(const QStringList& pluginDirs);
+    /*!
+     * Loads every enabled plugin which isn't lazy.
+     * Libraries of plugins which can be initialised in parallel are loaded concurrently on the thread pool,
+     * but every instance is created on the calling thread.
+     */
     void loadPlugins();
 
+    /*!
+     * Calls @p function for each loaded plugin implementing @p T.
+     * @p function is kept and also called for lazy plugins once they're initialised.
+     */
     template <typename T, typename Function>
     void initialisePlugins(Function function)
     {
-        for(auto& [name, plugin] : m_plugins) {
+        const auto initialiser = [function](PluginInfo* plugin) {
             if(const auto& pluginInstance = qobject_cast<T*>(plugin->root())) {
                 function(pluginInstance);
                 plugin->initialise();
             }
+        };
+
+        for(auto& [name, plugin] : m_plugins) {
+            initialiser(plugin.get());
         }
+
+        m_initialisers.emplace_back(initialiser);
     }
 
+    /*!
+     * Loads the lazy @p plugin, if it hasn't been already, and passes it to every initialiser so far.
+     * @returns true if the plugin is loaded.
+     */
+    bool initialiseLazyPlugin(PluginInfo* plugin);
+    /** Initialises all lazy plugins not yet used. */
+    void initialiseLazyPlugins();
+
     bool installPlugin(const QString& filepath);
     void loadPlugin(PluginInfo* plugin);
     void unloadPlugins();
@@ -62,5 +92,6 @@ public:
 private:
     SettingsManager* m_settings;
     PluginInfoMap m_plugins;
+    std::vector<std::function<void(PluginInfo*)>> m_initialisers;
 };
 } // namespace Fooyin
@@ -0,0 +1,116 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "schedulingpolicy.h"
+
+#include "internalcoresettings.h"
+
+#include <core/player/playercontroller.h>
+#include <utils/settings/settingsmanager.h>
+#include <utils/systemload.h>
+
+#include <QTimerEvent>
+
+// How often the state of the system is checked
+constexpr auto UpdateInterval = 5000; // ms
+// Idle work held back for this long then runs reduced for a while, so it still makes progress
+constexpr auto MaxDeferral = 2 * 60 * 1000; // ms
+constexpr auto ResumeTime  = 30 * 1000;     // ms
+// Load per core above which idle work is reduced, and above which it's held back
+constexpr auto ModerateLoad = 0.75;
+constexpr auto HighLoad     = 1.25;
+// Percentage of time something was stalled on I/O above which idle work is reduced, and above which it's held back
+constexpr auto ModerateIoPressure = 10.0;
+constexpr auto HighIoPressure     = 30.0;
+
+namespace Fooyin {
+SchedulingPolicy::SchedulingPolicy(PlayerController* playerController, SettingsManager* settings, QObject* parent)
+    : QObject{parent}
+    , m_playerController{playerController}
+    , m_settings{settings}
+{
+    QObject::connect(m_playerController, &PlayerController::playStateChanged, this, &SchedulingPolicy::update);
+    m_settings->subscribe<Settings::Core::Internal::ThrottleIdleWork>(this, &SchedulingPolicy::update);
+
+    update();
+    m_timer.start(UpdateInterval, this);
+}
+
+SchedulingPolicy::~SchedulingPolicy()
+{
+    TaskScheduler::instance()->setThrottle(TaskScheduler::Throttle::None);
+}
+
+void SchedulingPolicy::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == m_timer.timerId()) {
+        update();
+    }
+    QObject::timerEvent(event);
+}
+
+TaskScheduler::Throttle SchedulingPolicy::currentThrottle() const
+{
+    using Throttle = TaskScheduler::Throttle;
+
+    if(!m_settings->value<Settings::Core::Internal::ThrottleIdleWork>()) {
+        return Throttle::None;
+    }
+
+    const auto load      = SystemLoad::loadPerCore();
+    const auto ioStalled = SystemLoad::ioPressure();
+    const bool playing   = m_playerController->playState() == PlayState::Playing;
+    const bool battery   = SystemLoad::onBattery();
+
+    if((load && *load > HighLoad) || (ioStalled && *ioStalled > HighIoPressure) || (playing && battery)) {
+        return Throttle::Paused;
+    }
+
+    if((load && *load > ModerateLoad) || (ioStalled && *ioStalled > ModerateIoPressure) || playing || battery) {
+        return Throttle::Reduced;
+    }
+
+    return Throttle::None;
+}
+
+void SchedulingPolicy::update()
+{
+    auto throttle = currentThrottle();
+
+    if(throttle == TaskScheduler::Throttle::Paused) {
+        if(!m_paused.isValid()) {
+            m_paused.start();
+        }
+        if(m_paused.hasExpired(MaxDeferral)) {
+            throttle = TaskScheduler::Throttle::Reduced;
+            if(m_paused.hasExpired(MaxDeferral + ResumeTime)) {
+                m_paused.restart();
+            }
+        }
+    }
+    else {
+        m_paused.invalidate();
+    }
+
+    TaskScheduler::instance()->setThrottle(throttle);
+}
+} // namespace Fooyin
+
+#include "moc_schedulingpolicy.cpp"
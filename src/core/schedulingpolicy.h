@@ -0,0 +1,63 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <utils/taskscheduler.h>
+
+namespace Fooyin {
+class PlayerController;
+class SettingsManager;
+
+/*!
+ * Throttles idle work, e.g. library scans, ReplayGain analysis and waveform generation, based on the
+ * state of the system.
+ *
+ * Idle work is limited to a single thread during playback, on battery or under moderate load or I/O
+ * pressure, and held back entirely during playback on battery or under heavy load. It's never held back
+ * for longer than a couple of minutes at a time, so it still finishes on a system which is always busy.
+ * Interactive work and playback are never throttled.
+ */
+class SchedulingPolicy : public QObject
+{
+    Q_OBJECT
+
+public:
+    SchedulingPolicy(PlayerController* playerController, SettingsManager* settings, QObject* parent = nullptr);
+    ~SchedulingPolicy() override;
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    [[nodiscard]] TaskScheduler::Throttle currentThrottle() const;
+    void update();
+
+    PlayerController* m_playerController;
+    SettingsManager* m_settings;
+    QBasicTimer m_timer;
+    // How long idle work has been held back for
+    QElapsedTimer m_paused;
+};
+} // namespace Fooyin
@@ -19,6 +19,7 @@
 
 #include "tracklistfuncs.h"
 
+#include <core/scripting/tracklistaggregate.h>
 #include <core/track.h>
 #include <utils/utils.h>
 
@@ -52,4 +53,24 @@ QString genres(const TrackList& tracks)
 
     return genreList.join(QStringLiteral(" / "));
 }
+
+int trackCount(const TrackListAggregate& aggregate)
+{
+    return aggregate.trackCount();
+}
+
+QString playtime(const TrackListAggregate& aggregate)
+{
+    return Utils::msToString(aggregate.duration());
+}
+
+QString genres(const TrackListAggregate& aggregate)
+{
+    QStringList genreList;
+    for(const auto& [genre, count] : aggregate.genres()) {
+        genreList.push_back(genre);
+    }
+
+    return genreList.join(QStringLiteral(" / "));
+}
 } // namespace Fooyin::Scripting
@@ -23,8 +23,17 @@
 
 #include <QString>
 
-namespace Fooyin::Scripting {
+namespace Fooyin {
+class TrackListAggregate;
+
+namespace Scripting {
 int trackCount(const TrackList& tracks);
 QString playtime(const TrackList& tracks);
 QString genres(const TrackList& tracks);
+
+// As above, read from totals kept for the tracks
+int trackCount(const TrackListAggregate& aggregate);
+QString playtime(const TrackListAggregate& aggregate);
+QString genres(const TrackListAggregate& aggregate);
+} // namespace Scripting
 } // namespace Fooyin
@@ -19,31 +19,67 @@
 
 #include <core/scripting/scriptparser.h>
 
+#include "scriptprogram.h"
+
 #include <core/constants.h>
 #include <core/scripting/scriptscanner.h>
 #include <core/track.h>
+#include <utils/tracing.h>
 
 #include <QDebug>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <span>
+#include <type_traits>
 
 using TokenType = Fooyin::ScriptScanner::TokenType;
 
+// Below this many tracks, spreading the work over threads costs more than it saves
+constexpr size_t EvaluateChunkSize = 1000;
+
 namespace {
-QStringList evalStringList(const Fooyin::ScriptResult& evalExpr, const QStringList& result)
+template <typename Result, typename Evaluate>
+std::vector<Result> evaluateInChunks(const Fooyin::TrackList& tracks, Fooyin::ScriptRegistry* registry,
+                                     const Evaluate& evaluate)
 {
-    QStringList listResult;
-    const QStringList values = evalExpr.value.split(QStringLiteral("\037"));
-    const bool isEmpty       = result.empty();
+    std::vector<Result> results(tracks.size());
 
-    for(const QString& value : values) {
-        if(isEmpty) {
-            listResult.append(value);
-        }
-        else {
-            std::ranges::transform(result, std::back_inserter(listResult),
-                                   [&](const QString& retValue) -> QString { return retValue + value; });
-        }
+    if(tracks.empty()) {
+        return results;
+    }
+
+    if(!registry) {
+        static Fooyin::ScriptRegistry defaultRegistry;
+        registry = &defaultRegistry;
+    }
+
+    const std::span<const Fooyin::Track> allTracks{tracks};
+    const std::span<Result> allResults{results};
+
+    std::vector<std::pair<size_t, size_t>> chunks;
+    for(size_t start{0}; start < tracks.size(); start += EvaluateChunkSize) {
+        chunks.emplace_back(start, std::min(tracks.size(), start + EvaluateChunkSize));
+    }
+
+    // Parsers hold state while evaluating, so each chunk uses its own
+    const auto evaluateChunk = [&allTracks, &allResults, &evaluate, registry](const std::pair<size_t, size_t>& chunk) {
+        Fooyin::ScriptParser parser{registry};
+        const size_t count = chunk.second - chunk.first;
+        evaluate(parser, allTracks.subspan(chunk.first, count), allResults.subspan(chunk.first, count));
+    };
+
+    if(chunks.size() == 1) {
+        evaluateChunk(chunks.front());
     }
-    return listResult;
+    else {
+        QtConcurrent::blockingMap(QThreadPool::globalInstance(), chunks, evaluateChunk);
+    }
+
+    return results;
 }
 } // namespace
 
@@ -61,17 +97,20 @@ struct ScriptParser::Private
 
     QString currentInput;
     std::unordered_map<QString, ParsedScript> parsedScripts;
-    QStringList currentResult;
+
+    ScriptMachine machine;
 
     explicit Private(ScriptParser* self_)
         : self{self_}
         , defaultRegistry{std::make_unique<ScriptRegistry>()}
         , registry{defaultRegistry.get()}
+        , machine{registry}
     { }
 
     explicit Private(ScriptParser* self_, ScriptRegistry* registry_)
         : self{self_}
         , registry{registry_}
+        , machine{registry}
     { }
 
     void advance()
@@ -292,161 +331,97 @@ struct ScriptParser::Private
         return expr;
     }
 
-    ScriptResult evalExpression(const Expression& exp, const auto& tracks) const
+    ParsedScript parse(const QString& input, const auto& tracks)
     {
-        switch(exp.type) {
-            case(Expr::Literal):
-                return evalLiteral(exp);
-            case(Expr::Variable):
-                return evalVariable(exp, tracks);
-            case(Expr::VariableList):
-                return evalVariableList(exp, tracks);
-            case(Expr::Function):
-                return evalFunction(exp, tracks);
-            case(Expr::FunctionArg):
-                return evalFunctionArg(exp, tracks);
-            case(Expr::Conditional):
-                return evalConditional(exp, tracks);
-            case(Expr::Null):
-            default:
-                return {};
+        if(input.isEmpty() || !registry) {
+            return {};
         }
-    }
 
-    ScriptResult evalLiteral(const Expression& exp) const
-    {
-        ScriptResult result;
-        result.value = std::get<QString>(exp.value);
-        result.cond  = true;
-        return result;
-    }
+        if(parsedScripts.contains(input)) {
+            return parsedScripts.at(input);
+        }
 
-    ScriptResult evalVariable(const Expression& exp, const auto& tracks) const
-    {
-        const QString var   = std::get<QString>(exp.value);
-        ScriptResult result = registry->value(var, tracks);
+        currentInput = input;
+        auto& script = parsedScripts[input];
+        script.input = input;
 
-        if(!result.cond) {
-            return {};
-        }
+        scanner.setup(input);
 
-        if(result.value.contains(u"\037")) {
-            result.value = result.value.replace(QStringLiteral("\037"), QStringLiteral(", "));
+        advance();
+        while(current.type != TokenType::TokEos) {
+            script.expressions.emplace_back(expression(tracks));
         }
 
-        return result;
-    }
+        consume(TokenType::TokEos, QStringLiteral("Expected end of expression"));
 
-    ScriptResult evalVariableList(const Expression& exp, const auto& tracks) const
-    {
-        const QString var = std::get<QString>(exp.value);
-        return registry->value(var, tracks);
-    }
+        script.program      = ScriptProgram::compile(script.expressions, registry);
+        script.dependencies = dependencies(script.expressions);
 
-    ScriptResult evalFunction(const Expression& exp, const auto& tracks) const
-    {
-        auto func = std::get<FuncValue>(exp.value);
-        ScriptValueList args;
-        std::ranges::transform(func.args, std::back_inserter(args),
-                               [this, &tracks](const Expression& arg) { return evalExpression(arg, tracks); });
-        return registry->function(func.name, args, tracks);
+        return script;
     }
 
-    ScriptResult evalFunctionArg(const Expression& exp, const auto& tracks) const
+    [[nodiscard]] ScriptDependencies dependencies(const ExpressionList& expressions) const
     {
-        ScriptResult result;
-        bool allPassed{true};
-
-        auto arg = std::get<ExpressionList>(exp.value);
-        for(const Expression& subArg : arg) {
-            const auto subExpr = evalExpression(subArg, tracks);
-            if(!subExpr.cond) {
-                allPassed = false;
-            }
-            if(subExpr.value.contains(u"\037")) {
-                QStringList newResult;
-                const auto values = subExpr.value.split(QStringLiteral("\037"));
-                std::ranges::transform(values, std::back_inserter(newResult),
-                                       [&](const auto& value) { return result.value + value; });
-                result.value = newResult.join(u"\037");
-            }
-            else {
-                result.value = result.value + subExpr.value;
-            }
+        ScriptDependencies deps;
+        for(const Expression& expr : expressions) {
+            addDependencies(expr, deps);
         }
-        result.cond = allPassed;
-        return result;
+
+        deps.variables.sort();
+        deps.variables.removeDuplicates();
+        return deps;
     }
 
-    ScriptResult evalConditional(const Expression& exp, const auto& tracks) const
+    void addDependencies(const Expression& expr, ScriptDependencies& deps) const
     {
-        ScriptResult result;
-        QStringList exprResult;
-        result.cond = true;
-
-        auto arg = std::get<ExpressionList>(exp.value);
-        for(const Expression& subArg : arg) {
-            const auto subExpr = evalExpression(subArg, tracks);
-
-            // Literals return false
-            if(subArg.type != Expr::Literal) {
-                if(!subExpr.cond || subExpr.value.isEmpty()) {
-                    // No need to evaluate rest
-                    result.value.clear();
-                    result.cond = false;
-                    return result;
+        switch(expr.type) {
+            case(Expr::Variable):
+            case(Expr::VariableList): {
+                const auto& var = std::get<QString>(expr.value);
+                deps.variables.push_back(var);
+
+                const auto binding = registry->bindVariable(var);
+                if(binding.playback >= 0) {
+                    deps.playback = true;
                 }
-            }
-            if(subExpr.value.contains(u"\037")) {
-                const QStringList evalList = evalStringList(subExpr, exprResult);
-                if(!evalList.empty()) {
-                    exprResult = evalList;
+                else if(binding.custom >= 0) {
+                    deps.context = true;
                 }
+                break;
             }
-            else {
-                if(exprResult.empty()) {
-                    exprResult.append(subExpr.value);
+            case(Expr::Function): {
+                const auto& func   = std::get<FuncValue>(expr.value);
+                const auto binding = registry->bindFunction(func.name);
+                if(binding.function >= 0 && !registry->isConstantFunction(binding)) {
+                    // Reads the track directly
+                    deps.allFields = true;
                 }
-                else {
-                    std::ranges::transform(exprResult, exprResult.begin(), [&](const QString& retValue) -> QString {
-                        return retValue + subExpr.value;
-                    });
+                for(const Expression& arg : func.args) {
+                    addDependencies(arg, deps);
                 }
+                break;
             }
+            case(Expr::FunctionArg):
+            case(Expr::Conditional):
+                for(const Expression& subExpr : std::get<ExpressionList>(expr.value)) {
+                    addDependencies(subExpr, deps);
+                }
+                break;
+            case(Expr::Literal):
+            case(Expr::Null):
+            default:
+                break;
         }
-        if(exprResult.size() == 1) {
-            result.value = exprResult.constFirst();
-        }
-        else if(exprResult.size() > 1) {
-            result.value = exprResult.join(u"\037");
-        }
-        return result;
     }
 
-    ParsedScript parse(const QString& input, const auto& tracks)
+    [[nodiscard]] std::shared_ptr<const ScriptProgram> program(const ParsedScript& input) const
     {
-        if(input.isEmpty() || !registry) {
-            return {};
-        }
-
-        if(parsedScripts.contains(input)) {
-            return parsedScripts.at(input);
+        if(input.program) {
+            return input.program;
         }
 
-        currentInput = input;
-        auto& script = parsedScripts[input];
-        script.input = input;
-
-        scanner.setup(input);
-
-        advance();
-        while(current.type != TokenType::TokEos) {
-            script.expressions.emplace_back(expression(tracks));
-        }
-
-        consume(TokenType::TokEos, QStringLiteral("Expected end of expression"));
-
-        return script;
+        // Built by hand rather than parsed
+        return ScriptProgram::compile(input.expressions, registry);
     }
 
     QString evaluate(const ParsedScript& input, const auto& tracks)
@@ -455,47 +430,48 @@ struct ScriptParser::Private
             return {};
         }
 
-        currentResult.clear();
+        return machine.run(program(input), tracks);
+    }
 
-        const ExpressionList expressions = input.expressions;
-        for(const auto& expr : expressions) {
-            const auto evalExpr = evalExpression(expr, tracks);
+    template <typename Result>
+    void evaluateBatch(const ParsedScript& input, std::span<const Track> tracks, std::span<Result> out)
+    {
+        if(!input.isValid() || !registry) {
+            std::ranges::fill(out.first(tracks.size()), Result{});
+            return;
+        }
 
-            if(evalExpr.value.isNull()) {
-                continue;
-            }
+        // Resolved once, rather than for every track
+        const auto script = program(input);
 
-            if(evalExpr.value.contains(u"\037")) {
-                const QStringList evalList = evalStringList(evalExpr, currentResult);
-                if(!evalList.empty()) {
-                    currentResult = evalList;
-                }
+        for(size_t i{0}; i < tracks.size(); ++i) {
+            if constexpr(std::is_same_v<Result, QStringList>) {
+                out[i] = machine.runValues(script, tracks[i]);
             }
             else {
-                if(currentResult.empty()) {
-                    currentResult.push_back(evalExpr.value);
-                }
-                else {
-                    std::ranges::transform(
-                        currentResult, currentResult.begin(),
-                        [&](const QString& retValue) -> QString { return retValue + evalExpr.value; });
-                }
+                out[i] = machine.run(script, tracks[i]);
             }
         }
+    }
+};
 
-        if(currentResult.size() == 1) {
-            // Calling join on a QStringList with a single empty string will return a null QString, so return the first
-            // result.
-            return currentResult.constFirst();
-        }
+bool ScriptDependencies::dependsOn(const QStringList& fields) const
+{
+    if(allFields) {
+        return true;
+    }
 
-        if(currentResult.size() > 1) {
-            return currentResult.join(u"\037");
-        }
+    return std::ranges::any_of(fields, [this](const QString& field) {
+        return std::ranges::binary_search(variables, field);
+    });
+}
 
-        return {};
-    }
-};
+bool ScriptDependencies::dependsOnStats() const
+{
+    static const QStringList statFields{QString::fromLatin1(Constants::MetaData::PlayCount),
+                                        QString::fromLatin1(Constants::MetaData::Rating)};
+    return dependsOn(statFields);
+}
 
 ScriptParser::ScriptParser()
     : p{std::make_unique<Private>(this)}
@@ -552,6 +528,7 @@ QString ScriptParser::evaluate(const QString& input, const Track& track)
 
 QString ScriptParser::evaluate(const ParsedScript& input, const Track& track)
 {
+    FY_TRACE_SCOPE("ScriptParser::evaluate");
     if(!input.isValid()) {
         return {};
     }
@@ -571,6 +548,7 @@ QString ScriptParser::evaluate(const QString& input, const TrackList& tracks)
 
 QString ScriptParser::evaluate(const ParsedScript& input, const TrackList& tracks)
 {
+    FY_TRACE_SCOPE("ScriptParser::evaluate");
     if(!input.isValid()) {
         return {};
     }
@@ -582,4 +560,100 @@ void ScriptParser::clearCache()
 {
     p->parsedScripts.clear();
 }
+
+void ScriptParser::setTrackCacheEnabled(bool enabled)
+{
+    p->machine.setCacheEnabled(enabled);
+}
+
+ScriptProfile ScriptParser::profile(const ParsedScript& script, const TrackList& tracks)
+{
+    ScriptProfile profile;
+
+    if(!script.isValid() || !p->registry) {
+        return profile;
+    }
+
+    const auto program = p->program(script);
+
+    std::vector<ScriptProfileEntry> symbols;
+    symbols.reserve(program->symbols.size());
+    for(const auto& symbol : program->symbols) {
+        symbols.push_back({.name = symbol.name, .function = symbol.function});
+    }
+
+    p->machine.setProfile(&symbols);
+
+    const auto start = std::chrono::steady_clock::now();
+    for(const Track& track : tracks) {
+        p->machine.run(program, track);
+    }
+    profile.total       = std::chrono::steady_clock::now() - start;
+    profile.evaluations = static_cast<int>(tracks.size());
+
+    p->machine.setProfile(nullptr);
+
+    // A name used several times has a symbol for each use
+    for(ScriptProfileEntry& symbol : symbols) {
+        if(symbol.calls == 0) {
+            continue;
+        }
+
+        auto entry = std::ranges::find_if(profile.entries, [&symbol](const ScriptProfileEntry& existing) {
+            return existing.name == symbol.name && existing.function == symbol.function;
+        });
+        if(entry == profile.entries.end()) {
+            profile.entries.push_back(std::move(symbol));
+        }
+        else {
+            entry->calls += symbol.calls;
+            entry->time += symbol.time;
+        }
+    }
+
+    std::ranges::sort(profile.entries, std::greater{}, &ScriptProfileEntry::time);
+
+    return profile;
+}
+
+void ScriptParser::evaluateBatch(const ParsedScript& script, std::span<const Track> tracks, std::span<QString> out)
+{
+    FY_TRACE_SCOPE("ScriptParser::evaluateBatch");
+    Q_ASSERT(out.size() >= tracks.size());
+    p->evaluateBatch(script, tracks, out);
+}
+
+void ScriptParser::evaluateBatch(const ParsedScript& script, std::span<const Track> tracks,
+                                 std::span<QStringList> out)
+{
+    FY_TRACE_SCOPE("ScriptParser::evaluateBatch");
+    Q_ASSERT(out.size() >= tracks.size());
+    p->evaluateBatch(script, tracks, out);
+}
+
+std::vector<QString> ScriptParser::evaluateEach(const ParsedScript& script, const TrackList& tracks,
+                                                ScriptRegistry* registry)
+{
+    if(!script.isValid()) {
+        return std::vector<QString>(tracks.size());
+    }
+
+    return evaluateInChunks<QString>(
+        tracks, registry, [&script](ScriptParser& parser, std::span<const Track> chunk, std::span<QString> out) {
+            parser.evaluateBatch(script, chunk, out);
+        });
+}
+
+std::vector<QStringList> ScriptParser::evaluateEachValues(const ParsedScript& script, const TrackList& tracks,
+                                                          ScriptRegistry* registry)
+{
+    if(!script.isValid()) {
+        return std::vector<QStringList>(tracks.size());
+    }
+
+    return evaluateInChunks<QStringList>(
+        tracks, registry, [&script](ScriptParser& parser, std::span<const Track> chunk, std::span<QStringList> out) {
+            parser.evaluateBatch(script, chunk, out);
+        });
+}
 } // namespace Fooyin
@@ -0,0 +1,587 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scriptprogram.h"
+
+#include <core/scripting/scriptregistry.h>
+#include <core/track.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+using Fooyin::ScriptProgram;
+using Op = ScriptProgram::Op;
+
+constexpr auto Separator = u'\037';
+
+// Adds the time until it's destroyed to entry @p symbol of @p profile, if profiling
+class ProfileTimer
+{
+public:
+    ProfileTimer(std::vector<Fooyin::ScriptProfileEntry>* profile, int symbol)
+        : m_profile{profile}
+        , m_symbol{static_cast<size_t>(symbol)}
+    {
+        if(m_profile) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ProfileTimer()
+    {
+        if(m_profile && m_symbol < m_profile->size()) {
+            auto& entry = m_profile->at(m_symbol);
+            ++entry.calls;
+            entry.time += std::chrono::steady_clock::now() - m_start;
+        }
+    }
+
+    ProfileTimer(const ProfileTimer&)            = delete;
+    ProfileTimer& operator=(const ProfileTimer&) = delete;
+
+private:
+    std::vector<Fooyin::ScriptProfileEntry>* m_profile;
+    size_t m_symbol;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Appends @p value to each of @p result, or each of its values to each of @p result if it has several
+void appendValue(QStringList& result, const Fooyin::ScriptResult& value)
+{
+    if(value.isMultiValue()) {
+        if(result.empty()) {
+            result = value.values;
+            return;
+        }
+
+        QStringList listResult;
+        listResult.reserve(result.size() * value.values.size());
+        for(const QString& subValue : value.values) {
+            for(const QString& retValue : std::as_const(result)) {
+                listResult.append(retValue + subValue);
+            }
+        }
+        result = std::move(listResult);
+    }
+    else if(result.empty()) {
+        result.push_back(value.value);
+    }
+    else {
+        for(QString& retValue : result) {
+            retValue += value.value;
+        }
+    }
+}
+
+QString joinValues(const QStringList& values)
+{
+    if(values.size() == 1) {
+        // Calling join on a QStringList with a single empty string will return a null QString
+        return values.constFirst();
+    }
+    if(values.size() > 1) {
+        return values.join(Separator);
+    }
+    return {};
+}
+
+// Functions work on joined strings, so results from them are split once here rather than wherever they're used
+Fooyin::ScriptResult splitValues(Fooyin::ScriptResult result)
+{
+    if(result.isMultiValue() || !result.value.contains(Separator)) {
+        return result;
+    }
+
+    result.values = result.value.split(Separator);
+    result.value.clear();
+    return result;
+}
+
+// Gives each distinct cacheable expression its own slot, shared by every program
+int cacheSlot(const QString& key)
+{
+    static std::mutex mutex;
+    static std::unordered_map<QString, int> slots;
+
+    const std::scoped_lock lock{mutex};
+    return slots.try_emplace(key, static_cast<int>(slots.size())).first->second;
+}
+
+// Identifies an expression by its contents, so the same call in two scripts shares a cache slot
+QString cacheKey(const Fooyin::Expression& expr)
+{
+    const auto subKeys = [](const Fooyin::ExpressionList& exprs) {
+        QString key;
+        for(const Fooyin::Expression& subExpr : exprs) {
+            key += cacheKey(subExpr);
+        }
+        return key;
+    };
+
+    switch(expr.type) {
+        case(Fooyin::Expr::Literal): {
+            const auto& literal = std::get<QString>(expr.value);
+            return QString::number(literal.size()) + u'"' + literal;
+        }
+        case(Fooyin::Expr::Variable):
+            return u'%' + std::get<QString>(expr.value) + u'%';
+        case(Fooyin::Expr::VariableList):
+            return QStringLiteral("%<") + std::get<QString>(expr.value) + QStringLiteral(">%");
+        case(Fooyin::Expr::Function): {
+            const auto& func = std::get<Fooyin::FuncValue>(expr.value);
+            QString key      = u'$' + func.name + u'(';
+            for(const Fooyin::Expression& arg : func.args) {
+                key += cacheKey(arg) + u',';
+            }
+            return key + u')';
+        }
+        case(Fooyin::Expr::FunctionArg):
+            return subKeys(std::get<Fooyin::ExpressionList>(expr.value));
+        case(Fooyin::Expr::Conditional):
+            return u'[' + subKeys(std::get<Fooyin::ExpressionList>(expr.value)) + u']';
+        case(Fooyin::Expr::Null):
+        default:
+            return QStringLiteral("~");
+    }
+}
+
+class Compiler
+{
+public:
+    Compiler(ScriptProgram& program, const Fooyin::ScriptRegistry* registry)
+        : m_program{program}
+        , m_registry{registry}
+    { }
+
+    void compile(const Fooyin::Expression& expr)
+    {
+        switch(expr.type) {
+            case(Fooyin::Expr::Literal):
+                add(Op::Literal, addString(std::get<QString>(expr.value)));
+                break;
+            case(Fooyin::Expr::Variable):
+                add(Op::Variable, addSymbol(std::get<QString>(expr.value), false));
+                break;
+            case(Fooyin::Expr::VariableList):
+                add(Op::VariableList, addSymbol(std::get<QString>(expr.value), false));
+                break;
+            case(Fooyin::Expr::Function): {
+                const auto& func = std::get<Fooyin::FuncValue>(expr.value);
+                if(isConstant(expr)) {
+                    add(Op::Constant, addConstant(fold(func)));
+                }
+                else if(isTrackValue(expr)) {
+                    const int slot      = cacheSlot(cacheKey(expr));
+                    const size_t lookup = add(Op::CacheLookup, slot);
+                    compileCall(func);
+                    m_program.instructions[lookup].count = static_cast<int>(add(Op::CacheStore, slot));
+                }
+                else {
+                    compileCall(func);
+                }
+                break;
+            }
+            case(Fooyin::Expr::FunctionArg):
+                add(Op::ArgBegin);
+                for(const Fooyin::Expression& subExpr : std::get<Fooyin::ExpressionList>(expr.value)) {
+                    compile(subExpr);
+                    add(Op::ArgAppend);
+                }
+                add(Op::ArgEnd);
+                break;
+            case(Fooyin::Expr::Conditional): {
+                add(Op::CondBegin);
+                std::vector<size_t> jumps;
+                for(const Fooyin::Expression& subExpr : std::get<Fooyin::ExpressionList>(expr.value)) {
+                    compile(subExpr);
+                    // Literals never cause a conditional to fail
+                    const bool literal = subExpr.type == Fooyin::Expr::Literal;
+                    jumps.push_back(add(literal ? Op::CondAppendLiteral : Op::CondAppend));
+                }
+                const auto end = static_cast<int>(add(Op::CondEnd));
+                for(const size_t jump : jumps) {
+                    m_program.instructions[jump].count = end;
+                }
+                break;
+            }
+            case(Fooyin::Expr::Null):
+            default:
+                add(Op::Null);
+                break;
+        }
+    }
+
+    void compileCall(const Fooyin::FuncValue& func)
+    {
+        for(const Fooyin::Expression& arg : func.args) {
+            compile(arg);
+        }
+        add(Op::Call, addSymbol(func.name, true), static_cast<int>(func.args.size()));
+    }
+
+    size_t add(Op op, int operand = 0, int count = 0)
+    {
+        m_program.instructions.push_back({op, operand, count});
+        return m_program.instructions.size() - 1;
+    }
+
+private:
+    // Whether the expression gives the same result wherever it's evaluated
+    [[nodiscard]] bool isConstant(const Fooyin::Expression& expr) const
+    {
+        const auto allConstant = [this](const Fooyin::ExpressionList& exprs) {
+            return std::ranges::all_of(exprs,
+                                       [this](const Fooyin::Expression& subExpr) { return isConstant(subExpr); });
+        };
+
+        switch(expr.type) {
+            case(Fooyin::Expr::Literal):
+            case(Fooyin::Expr::Null):
+                return true;
+            case(Fooyin::Expr::Function): {
+                const auto& func = std::get<Fooyin::FuncValue>(expr.value);
+                return m_registry->isConstantFunction(m_registry->bindFunction(func.name)) && allConstant(func.args);
+            }
+            case(Fooyin::Expr::FunctionArg):
+            case(Fooyin::Expr::Conditional):
+                return allConstant(std::get<Fooyin::ExpressionList>(expr.value));
+            default:
+                return false;
+        }
+    }
+
+    // Whether the expression's result depends on nothing but the track
+    [[nodiscard]] bool isTrackValue(const Fooyin::Expression& expr) const
+    {
+        const auto allTrackValues = [this](const Fooyin::ExpressionList& exprs) {
+            return std::ranges::all_of(exprs,
+                                       [this](const Fooyin::Expression& subExpr) { return isTrackValue(subExpr); });
+        };
+
+        switch(expr.type) {
+            case(Fooyin::Expr::Literal):
+            case(Fooyin::Expr::Null):
+                return true;
+            case(Fooyin::Expr::Variable):
+            case(Fooyin::Expr::VariableList):
+                return m_registry->bindVariable(std::get<QString>(expr.value)).isTrackValue();
+            case(Fooyin::Expr::Function): {
+                const auto& func = std::get<Fooyin::FuncValue>(expr.value);
+                return m_registry->bindFunction(func.name).function >= 0 && allTrackValues(func.args);
+            }
+            case(Fooyin::Expr::FunctionArg):
+            case(Fooyin::Expr::Conditional):
+                return allTrackValues(std::get<Fooyin::ExpressionList>(expr.value));
+            default:
+                return false;
+        }
+    }
+
+    // Evaluates a call with constant arguments once, when compiling
+    [[nodiscard]] Fooyin::ScriptResult fold(const Fooyin::FuncValue& func) const
+    {
+        auto call = std::make_shared<ScriptProgram>();
+        Compiler{*call, m_registry}.compileCall(func);
+        call->registry = m_registry;
+        call->bindings = call->bind(m_registry);
+
+        Fooyin::ScriptMachine machine{m_registry};
+        return machine.runExpression(call, {});
+    }
+
+    int addString(const QString& string)
+    {
+        m_program.strings.push_back(string);
+        return static_cast<int>(m_program.strings.size() - 1);
+    }
+
+    int addConstant(Fooyin::ScriptResult constant)
+    {
+        m_program.constants.push_back(std::move(constant));
+        return static_cast<int>(m_program.constants.size() - 1);
+    }
+
+    int addSymbol(const QString& name, bool function)
+    {
+        m_program.symbols.push_back({name, function});
+        return static_cast<int>(m_program.symbols.size() - 1);
+    }
+
+    ScriptProgram& m_program;
+    const Fooyin::ScriptRegistry* m_registry;
+};
+} // namespace
+
+namespace Fooyin {
+std::vector<ScriptRegistry::Binding> ScriptProgram::bind(const ScriptRegistry* registry) const
+{
+    std::vector<ScriptRegistry::Binding> symbolBindings;
+    symbolBindings.reserve(symbols.size());
+
+    for(const Symbol& symbol : symbols) {
+        symbolBindings.push_back(symbol.function ? registry->bindFunction(symbol.name)
+                                                 : registry->bindVariable(symbol.name));
+    }
+
+    return symbolBindings;
+}
+
+std::shared_ptr<const ScriptProgram> ScriptProgram::compile(const ExpressionList& expressions,
+                                                            const ScriptRegistry* registry)
+{
+    auto program = std::make_shared<ScriptProgram>();
+    Compiler compiler{*program, registry};
+
+    for(const Expression& expr : expressions) {
+        compiler.compile(expr);
+        compiler.add(Op::Emit);
+    }
+
+    program->registry = registry;
+    program->bindings = program->bind(registry);
+
+    return program;
+}
+
+ScriptMachine::ScriptMachine(const ScriptRegistry* registry)
+    : m_registry{registry}
+{ }
+
+QString ScriptMachine::run(const std::shared_ptr<const ScriptProgram>& program, const Track& track)
+{
+    execute(program, track);
+    return joinValues(m_result);
+}
+
+QString ScriptMachine::run(const std::shared_ptr<const ScriptProgram>& program, const TrackList& tracks)
+{
+    execute(program, tracks);
+    return joinValues(m_result);
+}
+
+QStringList ScriptMachine::runValues(const std::shared_ptr<const ScriptProgram>& program, const Track& track)
+{
+    execute(program, track);
+    return m_result;
+}
+
+ScriptResult ScriptMachine::runExpression(const std::shared_ptr<const ScriptProgram>& program, const Track& track)
+{
+    execute(program, track);
+    return m_stack.empty() ? ScriptResult{} : m_stack.back();
+}
+
+void ScriptMachine::setCacheEnabled(bool enabled)
+{
+    m_cacheEnabled = enabled;
+    ++m_cacheGeneration;
+
+    if(!enabled) {
+        m_cache        = {};
+        m_cacheTrackId = -1;
+        m_cacheTrackPath.clear();
+    }
+}
+
+void ScriptMachine::setProfile(std::vector<ScriptProfileEntry>* profile)
+{
+    m_profile = profile;
+}
+
+void ScriptMachine::updateCacheTrack(const Track& track)
+{
+    if(track.id() != m_cacheTrackId || track.filepath() != m_cacheTrackPath) {
+        ++m_cacheGeneration;
+        m_cacheTrackId   = track.id();
+        m_cacheTrackPath = track.filepath();
+    }
+}
+
+const std::vector<ScriptRegistry::Binding>&
+ScriptMachine::bindings(const std::shared_ptr<const ScriptProgram>& program)
+{
+    if(program->registry == m_registry) {
+        return program->bindings;
+    }
+
+    // Compiled for another registry, so bind its symbols again (once) for ours
+    if(m_reboundProgram != program) {
+        m_bindings       = program->bind(m_registry);
+        m_reboundProgram = program;
+    }
+
+    return m_bindings;
+}
+
+void ScriptMachine::execute(const std::shared_ptr<const ScriptProgram>& script, const auto& tracks)
+{
+    m_stack.clear();
+    m_frames.clear();
+    m_result.clear();
+
+    const ScriptProgram& program = *script;
+    const auto& symbolBindings   = bindings(script);
+    const auto& instructions     = program.instructions;
+
+    bool caching{false};
+    if constexpr(std::is_same_v<std::decay_t<decltype(tracks)>, Track>) {
+        // Only programs bound to our registry agree with it on which calls depend on the track alone
+        caching = m_cacheEnabled && script->registry == m_registry;
+        if(caching) {
+            updateCacheTrack(tracks);
+        }
+    }
+    const auto count = instructions.size();
+
+    for(size_t pc{0}; pc < count; ++pc) {
+        const Instruction& instruction = instructions[pc];
+
+        switch(instruction.op) {
+            case(Op::Null):
+                m_stack.emplace_back();
+                break;
+            case(Op::Literal):
+                m_stack.push_back({program.strings[instruction.operand], true});
+                break;
+            case(Op::Constant):
+                m_stack.push_back(program.constants[instruction.operand]);
+                break;
+            case(Op::Variable): {
+                const ProfileTimer timer{m_profile, instruction.operand};
+                ScriptResult result = m_registry->value(symbolBindings[instruction.operand], tracks);
+                if(!result.cond) {
+                    result = {};
+                }
+                else if(result.isMultiValue()) {
+                    result.value = result.values.join(QStringLiteral(", "));
+                    result.values.clear();
+                }
+                m_stack.push_back(std::move(result));
+                break;
+            }
+            case(Op::VariableList): {
+                const ProfileTimer timer{m_profile, instruction.operand};
+                m_stack.push_back(m_registry->value(symbolBindings[instruction.operand], tracks));
+                break;
+            }
+            case(Op::Call): {
+                const ProfileTimer timer{m_profile, instruction.operand};
+                const auto first = m_stack.end() - instruction.count;
+                ScriptValueList args{std::make_move_iterator(first), std::make_move_iterator(m_stack.end())};
+                m_stack.erase(first, m_stack.end());
+                ScriptResult result = m_registry->function(symbolBindings[instruction.operand], args, tracks);
+                m_stack.push_back(splitValues(std::move(result)));
+                break;
+            }
+            case(Op::ArgBegin):
+                m_frames.emplace_back();
+                break;
+            case(Op::ArgAppend): {
+                const ScriptResult value = std::move(m_stack.back());
+                m_stack.pop_back();
+
+                Frame& frame = m_frames.back();
+                if(!value.cond) {
+                    frame.cond = false;
+                }
+                if(value.isMultiValue()) {
+                    QStringList newResult;
+                    for(const QString& subValue : value.values) {
+                        newResult.push_back(frame.value + subValue);
+                    }
+                    frame.value = newResult.join(Separator);
+                }
+                else {
+                    frame.value += value.value;
+                }
+                break;
+            }
+            case(Op::ArgEnd):
+                m_stack.push_back({std::move(m_frames.back().value), m_frames.back().cond});
+                m_frames.pop_back();
+                break;
+            case(Op::CondBegin):
+                m_frames.emplace_back();
+                break;
+            case(Op::CondAppend):
+            case(Op::CondAppendLiteral): {
+                const ScriptResult value = std::move(m_stack.back());
+                m_stack.pop_back();
+
+                if(instruction.op == Op::CondAppend
+                   && (!value.cond || (!value.isMultiValue() && value.value.isEmpty()))) {
+                    // No need to evaluate the rest
+                    m_frames.pop_back();
+                    m_stack.emplace_back();
+                    pc = static_cast<size_t>(instruction.count);
+                    break;
+                }
+                appendValue(m_frames.back().values, value);
+                break;
+            }
+            case(Op::CondEnd): {
+                QStringList& values = m_frames.back().values;
+                ScriptResult result{.cond = true};
+                if(values.size() > 1) {
+                    result.values = std::move(values);
+                }
+                else if(!values.empty()) {
+                    result.value = std::move(values.front());
+                }
+                m_stack.push_back(std::move(result));
+                m_frames.pop_back();
+                break;
+            }
+            case(Op::Emit): {
+                const ScriptResult value = std::move(m_stack.back());
+                m_stack.pop_back();
+
+                if(value.isMultiValue() || !value.value.isNull()) {
+                    appendValue(m_result, value);
+                }
+                break;
+            }
+            case(Op::CacheLookup): {
+                const auto slot = static_cast<size_t>(instruction.operand);
+                if(caching && slot < m_cache.size() && m_cache[slot].generation == m_cacheGeneration) {
+                    m_stack.push_back(m_cache[slot].result);
+                    pc = static_cast<size_t>(instruction.count);
+                }
+                break;
+            }
+            case(Op::CacheStore): {
+                if(!caching) {
+                    break;
+                }
+                const auto slot = static_cast<size_t>(instruction.operand);
+                if(slot >= m_cache.size()) {
+                    m_cache.resize(slot + 1);
+                }
+                m_cache[slot] = {m_cacheGeneration, m_stack.back()};
+                break;
+            }
+        }
+    }
+}
+} // namespace Fooyin
@@ -0,0 +1,176 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/scripting/expression.h>
+#include <core/scripting/scriptparser.h>
+#include <core/scripting/scriptregistry.h>
+#include <core/scripting/scriptvalue.h>
+#include <core/trackfwd.h>
+
+#include <QStringList>
+
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * A parsed script compiled to a flat list of instructions for ScriptMachine.
+ * Running it gives the same result as interpreting the expression tree, without recursing
+ * into (and copying) subexpressions for every evaluation.
+ * Variables and functions are bound to the registry it was compiled for, so running it doesn't look them up by name.
+ * Function calls with only literal arguments are evaluated once when compiling, and calls which only depend on
+ * the track can be cached between scripts (see ScriptMachine::setCacheEnabled).
+ */
+struct ScriptProgram
+{
+    enum class Op : uint8_t
+    {
+        // Pushes an empty, failed result
+        Null,
+        // Pushes strings[operand]
+        Literal,
+        // Pushes constants[operand], the result of a function call folded when compiling
+        Constant,
+        // Pushes the value of the variable symbols[operand], with lists joined by ", "
+        Variable,
+        // Pushes the value of the variable symbols[operand]
+        VariableList,
+        // Pops count arguments and pushes the result of the function symbols[operand]
+        Call,
+        // Starts a function argument, which the following ArgAppends add to
+        ArgBegin,
+        ArgAppend,
+        // Pushes the argument started by the matching ArgBegin
+        ArgEnd,
+        // Starts a conditional, which the following CondAppends add to
+        CondBegin,
+        // Pops a value and adds it to the conditional. If the value failed, the conditional is
+        // abandoned and execution continues after the CondEnd at count.
+        CondAppend,
+        // As CondAppend, for literals, which never fail
+        CondAppendLiteral,
+        // Pushes the conditional started by the matching CondBegin
+        CondEnd,
+        // Pops a value and adds it to the final result
+        Emit,
+        // If the result for cache slot operand is cached for the current track, pushes it and continues
+        // after the CacheStore at count
+        CacheLookup,
+        // Caches the value on top of the stack in slot operand
+        CacheStore,
+    };
+
+    struct Instruction
+    {
+        Op op;
+        int operand{0};
+        int count{0};
+    };
+
+    // A variable or function name
+    struct Symbol
+    {
+        QString name;
+        bool function{false};
+    };
+
+    std::vector<Instruction> instructions;
+    std::vector<QString> strings;
+    std::vector<ScriptResult> constants;
+    std::vector<Symbol> symbols;
+
+    // The registry symbols are bound to, with one binding per symbol
+    const ScriptRegistry* registry{nullptr};
+    std::vector<ScriptRegistry::Binding> bindings;
+
+    /** Resolves each of the symbols using @p registry. */
+    [[nodiscard]] std::vector<ScriptRegistry::Binding> bind(const ScriptRegistry* registry) const;
+
+    static std::shared_ptr<const ScriptProgram> compile(const ExpressionList& expressions,
+                                                        const ScriptRegistry* registry);
+};
+
+/*!
+ * Runs ScriptPrograms against a track or list of tracks.
+ * Its stacks are kept between runs, so once they've grown, evaluating doesn't allocate for them again.
+ * @note not thread-safe, each thread should use its own machine.
+ */
+class ScriptMachine
+{
+public:
+    explicit ScriptMachine(const ScriptRegistry* registry);
+
+    QString run(const std::shared_ptr<const ScriptProgram>& program, const Track& track);
+    QString run(const std::shared_ptr<const ScriptProgram>& program, const TrackList& tracks);
+    /** Runs @p program against @p track, returning each of the values of a multi-value result separately. */
+    QStringList runValues(const std::shared_ptr<const ScriptProgram>& program, const Track& track);
+    /** Runs a program compiled from a single expression, without an Emit, and returns its value. */
+    ScriptResult runExpression(const std::shared_ptr<const ScriptProgram>& program, const Track& track);
+
+    /*!
+     * While enabled, results of function calls which only depend on the track are kept and reused by
+     * any program run for the same track, until one is run for a different track.
+     * Tracks are compared by id and filepath, so changes to a track's metadata aren't noticed;
+     * only enable it for the duration of a pass over a set of tracks.
+     */
+    void setCacheEnabled(bool enabled);
+    /*!
+     * While set, the time spent in each variable and function is added to the entry of @p profile
+     * at the index of its symbol, so @p profile must have an entry for each symbol of the programs run.
+     */
+    void setProfile(std::vector<ScriptProfileEntry>* profile);
+
+private:
+    // The state of a function argument or conditional being built
+    struct Frame
+    {
+        QString value;
+        QStringList values;
+        bool cond{true};
+    };
+
+    void execute(const std::shared_ptr<const ScriptProgram>& script, const auto& tracks);
+    const std::vector<ScriptRegistry::Binding>& bindings(const std::shared_ptr<const ScriptProgram>& program);
+    void updateCacheTrack(const Track& track);
+
+    struct CacheEntry
+    {
+        uint64_t generation{0};
+        ScriptResult result;
+    };
+
+    const ScriptRegistry* m_registry;
+    // A program compiled for another registry, and its symbols bound to this one
+    std::shared_ptr<const ScriptProgram> m_reboundProgram;
+    std::vector<ScriptRegistry::Binding> m_bindings;
+    std::vector<ScriptResult> m_stack;
+    std::vector<Frame> m_frames;
+    QStringList m_result;
+
+    bool m_cacheEnabled{false};
+    // Bumped when the track changes, which invalidates every entry at once
+    uint64_t m_cacheGeneration{1};
+    int m_cacheTrackId{-1};
+    QString m_cacheTrackPath;
+    std::vector<CacheEntry> m_cache;
+
+    std::vector<ScriptProfileEntry>* m_profile{nullptr};
+};
+} // namespace Fooyin
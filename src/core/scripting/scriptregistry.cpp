@@ -27,9 +27,12 @@
 
 #include <core/constants.h>
 #include <core/player/playercontroller.h>
+#include <core/scripting/tracklistaggregate.h>
 #include <core/track.h>
 #include <utils/utils.h>
 
+#include <utility>
+
 namespace {
 using NativeFunc      = std::function<QString(const QStringList&)>;
 using NativeVoidFunc  = std::function<QString()>;
@@ -41,6 +44,61 @@ using Func            = std::variant<NativeFunc, NativeVoidFunc, NativeTrackFunc
 using TrackFunc     = std::function<Fooyin::ScriptRegistry::FuncRet(const Fooyin::Track&)>;
 using TrackSetFunc  = std::function<void(Fooyin::Track&, const Fooyin::ScriptRegistry::FuncRet&)>;
 using TrackListFunc = std::function<Fooyin::ScriptRegistry::FuncRet(const Fooyin::TrackList&)>;
+using AggregateFunc = std::function<Fooyin::ScriptRegistry::FuncRet(const Fooyin::TrackListAggregate&)>;
+
+// A list property, computed from the tracks or read from totals already kept for them
+struct ListProperty
+{
+    TrackListFunc compute;
+    AggregateFunc fromAggregate;
+};
+
+template <typename Ret>
+ListProperty listProperty(Ret (*compute)(const Fooyin::TrackList&),
+                          Ret (*fromAggregate)(const Fooyin::TrackListAggregate&))
+{
+    return {compute, fromAggregate};
+}
+
+// Functions stored by index, so they can be called through a ScriptRegistry::Binding without a lookup
+template <typename FuncType>
+class FuncTable
+{
+public:
+    FuncType& operator[](const QString& name)
+    {
+        const auto [it, inserted] = m_indexes.try_emplace(name, static_cast<int>(m_funcs.size()));
+        if(inserted) {
+            m_funcs.emplace_back();
+        }
+        return m_funcs.at(it->second);
+    }
+
+    void emplace(const QString& name, FuncType func)
+    {
+        (*this)[name] = std::move(func);
+    }
+
+    [[nodiscard]] bool contains(const QString& name) const
+    {
+        return m_indexes.contains(name);
+    }
+
+    [[nodiscard]] int indexOf(const QString& name) const
+    {
+        const auto it = m_indexes.find(name);
+        return it != m_indexes.cend() ? it->second : -1;
+    }
+
+    [[nodiscard]] const FuncType& at(int index) const
+    {
+        return m_funcs.at(index);
+    }
+
+private:
+    std::vector<FuncType> m_funcs;
+    std::unordered_map<QString, int> m_indexes;
+};
 
 template <typename FuncType>
 auto generateSetFunc(FuncType func)
@@ -111,13 +169,14 @@ QString trackTitle(const Fooyin::Track& track)
     return !track.title().isEmpty() ? track.title() : track.filename();
 }
 
-QString trackArtist(const Fooyin::Track& track)
+// Artists are returned as lists rather than joined strings, so they stay separate values when evaluated
+Fooyin::ScriptRegistry::FuncRet trackArtist(const Fooyin::Track& track)
 {
     if(!track.artists().empty()) {
-        return track.artist();
+        return track.artists();
     }
     if(!track.albumArtists().empty()) {
-        return track.albumArtist();
+        return track.albumArtists();
     }
     if(!track.composer().isEmpty()) {
         return track.composer();
@@ -125,13 +184,13 @@ QString trackArtist(const Fooyin::Track& track)
     return track.performer();
 }
 
-QString trackAlbumArtist(const Fooyin::Track& track)
+Fooyin::ScriptRegistry::FuncRet trackAlbumArtist(const Fooyin::Track& track)
 {
     if(!track.albumArtists().empty()) {
-        return track.albumArtist();
+        return track.albumArtists();
     }
     if(!track.artists().empty()) {
-        return track.artist();
+        return track.artists();
     }
     if(!track.composer().isEmpty()) {
         return track.composer();
@@ -157,11 +216,12 @@ struct ScriptRegistry::Private
 {
     PlayerController* playerController{nullptr};
 
-    std::unordered_map<QString, TrackFunc> metadata;
+    FuncTable<TrackFunc> metadata;
     std::unordered_map<QString, TrackSetFunc> setMetadata;
-    std::unordered_map<QString, TrackListFunc> listProperties;
-    std::unordered_map<QString, Func> funcs;
-    std::unordered_map<QString, NativeVoidFunc> playbackVars;
+    FuncTable<ListProperty> listProperties;
+    const TrackListAggregate* listAggregate{nullptr};
+    FuncTable<Func> funcs;
+    FuncTable<NativeVoidFunc> playbackVars;
 
     explicit Private(PlayerController* playerController_)
         : playerController{playerController_}
@@ -194,6 +254,9 @@ struct ScriptRegistry::Private
             return QString::number((playerController->currentTrack().duration() - playerController->currentPosition())
                                    / 1000);
         };
+        playbackVars[QStringLiteral("stream_title")] = [this]() {
+            return playerController->streamTitle();
+        };
     }
 
     void addDefaultFunctions()
@@ -249,9 +312,11 @@ struct ScriptRegistry::Private
 
     void addDefaultListFuncs()
     {
-        listProperties[QStringLiteral("trackcount")] = Fooyin::Scripting::trackCount;
-        listProperties[QStringLiteral("playtime")]   = Fooyin::Scripting::playtime;
-        listProperties[QStringLiteral("genres")]     = Fooyin::Scripting::genres;
+        using namespace Fooyin::Scripting;
+
+        listProperties[QStringLiteral("trackcount")] = listProperty<int>(trackCount, trackCount);
+        listProperties[QStringLiteral("playtime")]   = listProperty<QString>(playtime, playtime);
+        listProperties[QStringLiteral("genres")]     = listProperty<QString>(genres, genres);
     }
 
     void addDefaultMetadata()
@@ -344,84 +409,142 @@ bool ScriptRegistry::isFunction(const QString& func) const
     return p->funcs.contains(func);
 }
 
-ScriptResult ScriptRegistry::value(const QString& var, const Track& track) const
+ScriptRegistry::Binding ScriptRegistry::bindVariable(const QString& var) const
 {
-    if(var.isEmpty() || !isVariable(var, track)) {
-        return {};
+    Binding binding;
+
+    if(var.isEmpty()) {
+        return binding;
     }
 
-    if(p->metadata.contains(var)) {
-        return calculateResult(p->metadata.at(var)(track));
+    binding.metadata = p->metadata.indexOf(var);
+    binding.playback = p->playbackVars.indexOf(var);
+    binding.list     = p->listProperties.indexOf(var);
+    binding.tag      = var.toUpper();
+
+    return binding;
+}
+
+ScriptRegistry::Binding ScriptRegistry::bindFunction(const QString& func) const
+{
+    Binding binding;
+    binding.function = p->funcs.indexOf(func);
+    return binding;
+}
+
+bool ScriptRegistry::isConstantFunction(const Binding& func) const
+{
+    return func.function >= 0 && !std::holds_alternative<NativeTrackFunc>(p->funcs.at(func.function));
+}
+
+ScriptResult ScriptRegistry::value(const QString& var, const Track& track) const
+{
+    return value(bindVariable(var), track);
+}
+
+ScriptResult ScriptRegistry::value(const QString& var, const TrackList& tracks) const
+{
+    return value(bindVariable(var), tracks);
+}
+
+ScriptResult ScriptRegistry::value(const Binding& var, const Track& track) const
+{
+    if(var.metadata >= 0) {
+        return calculateResult(p->metadata.at(var.metadata)(track));
     }
-    if(p->playbackVars.contains(var)) {
-        return calculateResult(p->playbackVars.at(var)());
+    if(var.playback >= 0) {
+        return calculateResult(p->playbackVars.at(var.playback)());
     }
 
-    return calculateResult(track.extraTag(var.toUpper()));
+    if(var.tag.isEmpty() || !track.hasExtraTag(var.tag)) {
+        return {};
+    }
+
+    return calculateResult(track.extraTag(var.tag));
 }
 
-ScriptResult ScriptRegistry::value(const QString& var, const TrackList& tracks) const
+ScriptResult ScriptRegistry::value(const Binding& var, const TrackList& tracks) const
 {
-    if(var.isEmpty() || !isVariable(var, tracks)) {
+    if(var.list >= 0) {
+        const ListProperty& property = p->listProperties.at(var.list);
+        if(p->listAggregate && std::cmp_equal(p->listAggregate->trackCount(), tracks.size())) {
+            return calculateResult(property.fromAggregate(*p->listAggregate));
+        }
+        return calculateResult(property.compute(tracks));
+    }
+
+    if(tracks.empty()) {
         return {};
     }
 
-    if(p->listProperties.contains(var)) {
-        return calculateResult(p->listProperties.at(var)(tracks));
+    const Track& track = tracks.front();
+
+    if(var.metadata >= 0) {
+        return calculateResult(p->metadata.at(var.metadata)(track));
     }
 
-    if(!tracks.empty()) {
-        if(p->metadata.contains(var)) {
-            return calculateResult(p->metadata.at(var)(tracks.front()));
-        }
-        return calculateResult(tracks.front().extraTag(var.toUpper()));
+    // Playback variables aren't evaluated for lists, but still count as found
+    if(var.tag.isEmpty() || (var.playback < 0 && !track.hasExtraTag(var.tag))) {
+        return {};
     }
 
-    return {};
+    return calculateResult(track.extraTag(var.tag));
 }
 
 ScriptResult ScriptRegistry::function(const QString& func, const ScriptValueList& args, const Track& track) const
 {
-    if(func.isEmpty() || !p->funcs.contains(func)) {
+    return function(bindFunction(func), args, track);
+}
+
+ScriptResult ScriptRegistry::function(const QString& func, const ScriptValueList& args, const TrackList& tracks) const
+{
+    return function(bindFunction(func), args, tracks);
+}
+
+ScriptResult ScriptRegistry::function(const Binding& func, const ScriptValueList& args, const Track& track) const
+{
+    if(func.function < 0) {
         return {};
     }
 
-    const auto scriptFunc = p->funcs.at(func);
-    if(std::holds_alternative<NativeFunc>(scriptFunc)) {
-        const QString value = std::get<NativeFunc>(scriptFunc)(containerCast<QStringList>(args));
+    const Func& scriptFunc = p->funcs.at(func.function);
+    if(const auto* nativeFunc = std::get_if<NativeFunc>(&scriptFunc)) {
+        const QString value = (*nativeFunc)(containerCast<QStringList>(args));
         return {.value = value, .cond = !value.isEmpty()};
     }
-    if(std::holds_alternative<NativeVoidFunc>(scriptFunc)) {
-        const QString value = std::get<NativeVoidFunc>(scriptFunc)();
+    if(const auto* voidFunc = std::get_if<NativeVoidFunc>(&scriptFunc)) {
+        const QString value = (*voidFunc)();
         return {.value = value, .cond = !value.isEmpty()};
     }
-    if(std::holds_alternative<NativeTrackFunc>(scriptFunc)) {
-        const QString value = std::get<NativeTrackFunc>(scriptFunc)(track, containerCast<QStringList>(args));
+    if(const auto* trackFunc = std::get_if<NativeTrackFunc>(&scriptFunc)) {
+        const QString value = (*trackFunc)(track, containerCast<QStringList>(args));
         return {.value = value, .cond = !value.isEmpty()};
     }
-    if(std::holds_alternative<NativeBoolFunc>(scriptFunc)) {
-        return std::get<NativeBoolFunc>(scriptFunc)(containerCast<QStringList>(args));
+    if(const auto* boolFunc = std::get_if<NativeBoolFunc>(&scriptFunc)) {
+        return (*boolFunc)(containerCast<QStringList>(args));
     }
-    if(std::holds_alternative<NativeCondFunc>(scriptFunc)) {
-        return std::get<NativeCondFunc>(scriptFunc)(args);
+    if(const auto* condFunc = std::get_if<NativeCondFunc>(&scriptFunc)) {
+        return (*condFunc)(args);
     }
 
     return {};
 }
 
-ScriptResult ScriptRegistry::function(const QString& func, const ScriptValueList& args, const TrackList& tracks) const
+ScriptResult ScriptRegistry::function(const Binding& func, const ScriptValueList& args,
+                                      const TrackList& tracks) const
 {
-    if(func.isEmpty() || !p->funcs.contains(func)) {
-        return {};
-    }
-
-    if(tracks.empty()) {
+    if(func.function < 0 || tracks.empty()) {
         return {};
     }
 
     return function(func, args, tracks.front());
 }
 
+void ScriptRegistry::setListAggregate(const TrackListAggregate* aggregate)
+{
+    p->listAggregate = aggregate;
+}
+
 void ScriptRegistry::setValue(const QString& var, const FuncRet& value, Track& track)
 {
     if(var.isEmpty()) {
@@ -455,8 +578,14 @@ ScriptResult ScriptRegistry::calculateResult(ScriptRegistry::FuncRet funcRet)
         result.cond  = !result.value.isEmpty();
     }
     else if(auto* strListVal = std::get_if<QStringList>(&funcRet)) {
-        result.value = strListVal->empty() ? QStringLiteral("") : strListVal->join(u"\037");
-        result.cond  = !result.value.isEmpty();
+        if(strListVal->size() > 1) {
+            result.values = std::move(*strListVal);
+            result.cond   = true;
+        }
+        else {
+            result.value = strListVal->empty() ? QStringLiteral("") : strListVal->constFirst();
+            result.cond  = !result.value.isEmpty();
+        }
     }
 
     return result;
@@ -0,0 +1,110 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/scripting/tracklistaggregate.h>
+
+#include <core/track.h>
+
+#include <algorithm>
+
+namespace {
+// Calls @p func once for each distinct genre of @p track
+template <typename Func>
+void forEachGenre(const Fooyin::Track& track, Func&& func)
+{
+    const QStringList genres = track.genres();
+    for(auto it = genres.cbegin(); it != genres.cend(); ++it) {
+        if(std::find(genres.cbegin(), it, *it) == it) {
+            func(*it);
+        }
+    }
+}
+} // namespace
+
+namespace Fooyin {
+TrackListAggregate::TrackListAggregate(const TrackList& tracks)
+{
+    add(tracks);
+}
+
+void TrackListAggregate::add(const Track& track)
+{
+    ++m_trackCount;
+    m_duration += track.duration();
+    m_fileSize += track.fileSize();
+    forEachGenre(track, [this](const QString& genre) { ++m_genres[genre]; });
+}
+
+void TrackListAggregate::add(const TrackList& tracks)
+{
+    for(const Track& track : tracks) {
+        add(track);
+    }
+}
+
+void TrackListAggregate::merge(const TrackListAggregate& other)
+{
+    m_trackCount += other.m_trackCount;
+    m_duration += other.m_duration;
+    m_fileSize += other.m_fileSize;
+    for(const auto& [genre, count] : other.m_genres) {
+        m_genres[genre] += count;
+    }
+}
+
+void TrackListAggregate::remove(const Track& track)
+{
+    m_trackCount = std::max(m_trackCount - 1, 0);
+    m_duration -= std::min(m_duration, track.duration());
+    m_fileSize -= std::min(m_fileSize, track.fileSize());
+    forEachGenre(track, [this](const QString& genre) {
+        if(auto it = m_genres.find(genre); it != m_genres.end() && --it->second <= 0) {
+            m_genres.erase(it);
+        }
+    });
+}
+
+void TrackListAggregate::clear()
+{
+    m_trackCount = 0;
+    m_duration   = 0;
+    m_fileSize   = 0;
+    m_genres.clear();
+}
+
+int TrackListAggregate::trackCount() const
+{
+    return m_trackCount;
+}
+
+uint64_t TrackListAggregate::duration() const
+{
+    return m_duration;
+}
+
+uint64_t TrackListAggregate::fileSize() const
+{
+    return m_fileSize;
+}
+
+const std::map<QString, int>& TrackListAggregate::genres() const
+{
+    return m_genres;
+}
+} // namespace Fooyin
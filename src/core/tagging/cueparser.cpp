@@ -0,0 +1,400 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cueparser.h"
+
+#include "archive/archivereader.h"
+#include "tagreader.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringDecoder>
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+// CUE sheet times are in minutes, seconds and CD frames
+constexpr uint64_t FramesPerSecond = 75;
+
+namespace {
+enum class Section : uint8_t
+{
+    Album = 0,
+    Track,
+    Ignored, // A non-audio track
+};
+
+QString decodeSheet(const QByteArray& data)
+{
+    if(const auto encoding = QStringConverter::encodingForData(data)) {
+        QStringDecoder decoder{*encoding};
+        return decoder(data);
+    }
+
+    // Sheets without a BOM are often in the system encoding, so only trust UTF-8 if it decodes cleanly
+    QStringDecoder decoder{QStringDecoder::Utf8};
+    QString text = decoder(data);
+    return decoder.hasError() ? QString::fromLocal8Bit(data) : text;
+}
+
+// Splits a line into its command and arguments, keeping quoted arguments whole
+QStringList splitLine(QStringView line)
+{
+    QStringList tokens;
+
+    qsizetype pos{0};
+    while(pos < line.size()) {
+        if(line.at(pos).isSpace()) {
+            ++pos;
+            continue;
+        }
+
+        if(line.at(pos) == u'"') {
+            qsizetype end = line.indexOf(u'"', pos + 1);
+            if(end < 0) {
+                end = line.size();
+            }
+            tokens.append(line.sliced(pos + 1, end - pos - 1).toString());
+            pos = end + 1;
+            continue;
+        }
+
+        qsizetype end{pos};
+        while(end < line.size() && !line.at(end).isSpace()) {
+            ++end;
+        }
+        tokens.append(line.sliced(pos, end - pos).toString());
+        pos = end;
+    }
+
+    return tokens;
+}
+
+// Parses mm:ss:ff into ms
+std::optional<uint64_t> parseTime(const QString& time)
+{
+    const QStringList parts = time.split(u':');
+    if(parts.size() != 3) {
+        return {};
+    }
+
+    bool minOk{false};
+    bool secOk{false};
+    bool frameOk{false};
+
+    const uint64_t minutes = parts.at(0).toULongLong(&minOk);
+    const uint64_t seconds = parts.at(1).toULongLong(&secOk);
+    const uint64_t frames  = parts.at(2).toULongLong(&frameOk);
+
+    if(!minOk || !secOk || !frameOk || seconds >= 60 || frames >= FramesPerSecond) {
+        return {};
+    }
+
+    return (((minutes * 60) + seconds) * 1000) + (frames * 1000 / FramesPerSecond);
+}
+
+QString resolveFile(const QDir& dir, QString name)
+{
+    name.replace(u'\\', u'/');
+    const QString path = QDir::cleanPath(dir.absoluteFilePath(name));
+    if(QFileInfo::exists(path)) {
+        return path;
+    }
+
+    // Sheets often outlive a conversion of their file, e.g. from WAV to FLAC
+    const QFileInfo info{path};
+    const QString base = info.absoluteDir().absoluteFilePath(info.completeBaseName());
+
+    const QStringList extensions = Fooyin::Track::supportedFileExtensions();
+    for(const QString& extension : extensions) {
+        const QString candidate = base + extension.mid(1);
+        if(extension == QLatin1String("*.cue") || Fooyin::ArchiveReader::isArchive(candidate)) {
+            continue;
+        }
+        if(QFileInfo::exists(candidate)) {
+            return candidate;
+        }
+    }
+
+    return path;
+}
+} // namespace
+
+namespace Fooyin::Tagging {
+TrackList parseCueSheet(const QString& cuePath)
+{
+    QFile file{cuePath};
+    if(!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[CUE] Unable to open" << cuePath << file.errorString();
+        return {};
+    }
+
+    return parseCueSheet(&file, cuePath);
+}
+
+TrackList parseCueSheet(QIODevice* device, const QString& cuePath)
+{
+    const QString text = decodeSheet(device->readAll());
+    const QDir dir     = QFileInfo{cuePath}.absoluteDir();
+
+    QString album;
+    QString albumArtist;
+    QString albumComposer;
+    QString genre;
+    QString date;
+    QString comment;
+    int discNumber{0};
+    int discTotal{0};
+
+    QString currentFile;
+    Section section{Section::Album};
+    Track pending;
+    bool hasIndex{false};
+
+    TrackList tracks;
+
+    const auto commit = [&]() {
+        if(section == Section::Track && hasIndex) {
+            tracks.push_back(pending);
+        }
+        hasIndex = false;
+    };
+
+    const QStringList lines = text.split(u'\n');
+    for(const QString& line : lines) {
+        const QStringList tokens = splitLine(line);
+        if(tokens.size() < 2) {
+            continue;
+        }
+
+        const QString command = tokens.at(0).toUpper();
+        const QString& value  = tokens.at(1);
+
+        if(command == QLatin1String("FILE")) {
+            currentFile = resolveFile(dir, value);
+        }
+        else if(command == QLatin1String("TRACK")) {
+            commit();
+            if(tokens.size() > 2 && tokens.at(2).compare(QLatin1String("AUDIO"), Qt::CaseInsensitive) == 0) {
+                section = Section::Track;
+                pending = Track{};
+                pending.setTrackNumber(value.toInt());
+            }
+            else {
+                section = Section::Ignored;
+            }
+        }
+        else if(command == QLatin1String("INDEX")) {
+            // Index 00 is the pregap, which belongs to the end of the previous track
+            if(section == Section::Track && value.toInt() == 1 && tokens.size() > 2 && !currentFile.isEmpty()) {
+                if(const auto offset = parseTime(tokens.at(2))) {
+                    pending.setFilePath(currentFile);
+                    pending.setOffset(offset.value());
+                    hasIndex = true;
+                }
+            }
+        }
+        else if(command == QLatin1String("TITLE")) {
+            if(section == Section::Track) {
+                pending.setTitle(value);
+            }
+            else if(section == Section::Album) {
+                album = value;
+            }
+        }
+        else if(command == QLatin1String("PERFORMER")) {
+            if(section == Section::Track) {
+                pending.setArtists({value});
+            }
+            else if(section == Section::Album) {
+                albumArtist = value;
+            }
+        }
+        else if(command == QLatin1String("SONGWRITER")) {
+            if(section == Section::Track) {
+                pending.setComposer(value);
+            }
+            else if(section == Section::Album) {
+                albumComposer = value;
+            }
+        }
+        else if(command == QLatin1String("REM") && tokens.size() > 2) {
+            const QString field     = value.toUpper();
+            const QString& remValue = tokens.at(2);
+
+            if(field == QLatin1String("GENRE")) {
+                if(section == Section::Track) {
+                    pending.setGenres({remValue});
+                }
+                else {
+                    genre = remValue;
+                }
+            }
+            else if(field == QLatin1String("DATE")) {
+                if(section == Section::Track) {
+                    pending.setDate(remValue);
+                }
+                else {
+                    date = remValue;
+                }
+            }
+            else if(field == QLatin1String("COMMENT")) {
+                if(section == Section::Track) {
+                    pending.setComment(remValue);
+                }
+                else {
+                    comment = remValue;
+                }
+            }
+            else if(field == QLatin1String("DISCNUMBER")) {
+                discNumber = remValue.toInt();
+            }
+            else if(field == QLatin1String("TOTALDISCS")) {
+                discTotal = remValue.toInt();
+            }
+        }
+    }
+
+    commit();
+
+    const auto trackTotal = static_cast<int>(tracks.size());
+
+    for(size_t i{0}; i < tracks.size(); ++i) {
+        Track& track = tracks.at(i);
+
+        track.setCuePath(cuePath);
+        track.setAlbum(album);
+        track.setTrackTotal(trackTotal);
+        track.setDiscNumber(discNumber);
+        track.setDiscTotal(discTotal);
+
+        if(!albumArtist.isEmpty()) {
+            track.setAlbumArtists({albumArtist});
+            if(track.artists().empty()) {
+                track.setArtists({albumArtist});
+            }
+        }
+        if(track.composer().isEmpty()) {
+            track.setComposer(albumComposer);
+        }
+        if(track.genres().empty() && !genre.isEmpty()) {
+            track.setGenres({genre});
+        }
+        if(track.date().isEmpty()) {
+            track.setDate(date);
+        }
+        if(track.comment().isEmpty()) {
+            track.setComment(comment);
+        }
+
+        // Each track ends where the next one in the same file starts
+        if(i + 1 < tracks.size()) {
+            const Track& next = tracks.at(i + 1);
+            if(next.filepath() == track.filepath() && next.offset() > track.offset()) {
+                track.setDuration(next.offset() - track.offset());
+            }
+        }
+    }
+
+    return tracks;
+}
+
+void readCueTracks(TrackList& tracks)
+{
+    struct File
+    {
+        Track track;
+        bool readable{false};
+    };
+
+    std::unordered_map<QString, File> files;
+    std::unordered_map<QString, uint64_t> sheetTimes;
+
+    TrackList readTracks;
+    readTracks.reserve(tracks.size());
+
+    for(Track& track : tracks) {
+        auto fileIt = files.find(track.filepath());
+        if(fileIt == files.end()) {
+            File file;
+            file.track    = Track{track.filepath()};
+            file.readable = readMetaData(file.track);
+            fileIt        = files.emplace(track.filepath(), file).first;
+        }
+
+        const File& file = fileIt->second;
+        if(!file.readable) {
+            continue;
+        }
+
+        const Track& audio = file.track;
+
+        track.setType(audio.type());
+        track.setFileSize(audio.fileSize());
+        track.setBitrate(audio.bitrate());
+        track.setSampleRate(audio.sampleRate());
+        track.setChannels(audio.channels());
+        track.setBitDepth(audio.bitDepth());
+        track.setAddedTime(audio.addedTime());
+
+        if(track.duration() == 0) {
+            if(audio.duration() <= track.offset()) {
+                qDebug() << "[CUE] Track" << track.trackNumber() << "starts past the end of" << track.filepath();
+                continue;
+            }
+            track.setDuration(audio.duration() - track.offset());
+        }
+
+        // Either file changing should cause the track to be read again
+        auto timeIt = sheetTimes.find(track.cuePath());
+        if(timeIt == sheetTimes.end()) {
+            const QDateTime modified = QFileInfo{track.cuePath()}.lastModified();
+            const uint64_t time      = modified.isValid() ? static_cast<uint64_t>(modified.toMSecsSinceEpoch()) : 0;
+            timeIt                   = sheetTimes.emplace(track.cuePath(), time).first;
+        }
+        track.setModifiedTime(std::max(audio.modifiedTime(), timeIt->second));
+
+        if(track.album().isEmpty()) {
+            track.setAlbum(audio.album());
+        }
+        if(track.artists().empty()) {
+            track.setArtists(audio.artists());
+        }
+        if(track.albumArtists().empty()) {
+            track.setAlbumArtists(audio.albumArtists());
+        }
+        if(track.genres().empty()) {
+            track.setGenres(audio.genres());
+        }
+        if(track.date().isEmpty()) {
+            track.setDate(audio.date());
+        }
+
+        track.generateHash();
+        readTracks.push_back(track);
+    }
+
+    tracks = std::move(readTracks);
+}
+} // namespace Fooyin::Tagging
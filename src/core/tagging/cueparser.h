@@ -0,0 +1,45 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/track.h>
+
+class QIODevice;
+
+namespace Fooyin::Tagging {
+/*!
+ * Parses the CUE sheet at @p cuePath into a track for each of its audio tracks.
+ * Only the sheet is read: tracks hold their file, offset and the metadata from the sheet, and the duration of
+ * the last track of each file is left as 0. Use readCueTracks to complete them from their files.
+ * @note a FILE which doesn't exist is replaced by a file of the same name with a supported extension, if any.
+ */
+FYCORE_EXPORT TrackList parseCueSheet(const QString& cuePath);
+/** Parses a CUE sheet from @p device, resolving files relative to @p cuePath. */
+FYCORE_EXPORT TrackList parseCueSheet(QIODevice* device, const QString& cuePath);
+
+/*!
+ * Reads the audio properties of tracks returned by parseCueSheet, opening each referenced file only once.
+ * Metadata missing from the sheet is taken from the file's own tags.
+ * Tracks whose file can't be read are removed from @p tracks.
+ */
+FYCORE_EXPORT void readCueTracks(TrackList& tracks);
+} // namespace Fooyin::Tagging
@@ -0,0 +1,195 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "embeddedcoverstore.h"
+
+#include <core/track.h>
+#include <utils/crypto.h>
+#include <utils/packfile.h>
+#include <utils/paths.h>
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QImageReader>
+
+constexpr auto PackName         = "embeddedcovers.pack";
+// Covers a default-sized thumbnail at a 2x pixel ratio
+constexpr auto ThumbnailSize    = 400;
+constexpr auto ThumbnailQuality = 85;
+constexpr auto AlbumPrefix      = "album/";
+constexpr auto ImagePrefix      = "image/";
+
+namespace {
+QString albumKey(const QString& albumHash)
+{
+    return QString::fromLatin1(AlbumPrefix) + albumHash;
+}
+
+QString imageKey(const QString& contentHash)
+{
+    return QString::fromLatin1(ImagePrefix) + contentHash;
+}
+
+struct AlbumRecord
+{
+    QString contentHash;
+    QString origin;
+    bool scaled{false};
+
+    [[nodiscard]] QByteArray serialise() const
+    {
+        QByteArray data;
+        QDataStream stream{&data, QIODevice::WriteOnly};
+        stream << contentHash << origin << scaled;
+        return data;
+    }
+
+    static AlbumRecord deserialise(const QByteArray& data)
+    {
+        AlbumRecord record;
+        QDataStream stream{data};
+        stream >> record.contentHash >> record.origin >> record.scaled;
+        if(stream.status() != QDataStream::Ok) {
+            return {};
+        }
+        return record;
+    }
+};
+} // namespace
+
+namespace Fooyin {
+struct EmbeddedCoverStore::Private
+{
+    mutable PackFile pack;
+
+    explicit Private(const QString& filepath)
+        : pack{filepath}
+    { }
+
+    bool openPack() const
+    {
+        return pack.isOpen() || pack.open();
+    }
+
+    [[nodiscard]] AlbumRecord album(const QString& albumHash) const
+    {
+        const QByteArray data = pack.value(albumKey(albumHash));
+        return data.isEmpty() ? AlbumRecord{} : AlbumRecord::deserialise(data);
+    }
+};
+
+EmbeddedCoverStore::EmbeddedCoverStore(const QString& filepath)
+    : p{std::make_unique<Private>(filepath)}
+{ }
+
+EmbeddedCoverStore::~EmbeddedCoverStore() = default;
+
+EmbeddedCoverStore& EmbeddedCoverStore::instance()
+{
+    static EmbeddedCoverStore store{Utils::cachePath() + QStringLiteral("/") + QString::fromLatin1(PackName)};
+    return store;
+}
+
+bool EmbeddedCoverStore::contains(const QString& albumHash) const
+{
+    return p->openPack() && p->pack.contains(albumKey(albumHash));
+}
+
+EmbeddedCoverStore::Cover EmbeddedCoverStore::find(const QString& albumHash) const
+{
+    if(!p->openPack()) {
+        return {};
+    }
+
+    const AlbumRecord record = p->album(albumHash);
+    if(record.contentHash.isEmpty()) {
+        return {};
+    }
+
+    Cover cover;
+    cover.thumbnail.loadFromData(p->pack.value(imageKey(record.contentHash)));
+    cover.origin = record.origin;
+    cover.scaled = record.scaled;
+    return cover;
+}
+
+bool EmbeddedCoverStore::store(const Track& track, const QByteArray& cover)
+{
+    if(!p->openPack()) {
+        return false;
+    }
+
+    const QString albumHash = track.albumHash();
+
+    if(cover.isEmpty()) {
+        if(p->album(albumHash).origin == track.filepath()) {
+            p->pack.remove(albumKey(albumHash));
+        }
+        return true;
+    }
+
+    // Identical artwork is usually byte-for-byte identical too, as it's copied between files by taggers
+    const uint64_t contentHash = Utils::hash64(cover.constData(), static_cast<size_t>(cover.size()));
+    const QString imageHash    = QString::number(contentHash, 16);
+
+    QByteArray coverData{cover};
+    QBuffer buffer{&coverData};
+    QImageReader reader{&buffer};
+
+    // Only the header is read here, which is all that's needed if the image is already stored
+    const QSize size  = reader.size();
+    const bool scaled = size.isValid() && (size.width() > ThumbnailSize || size.height() > ThumbnailSize);
+
+    if(!p->pack.contains(imageKey(imageHash))) {
+        if(scaled) {
+            // Let the decoder downscale large JPEGs, rather than decoding them at full size first
+            reader.setScaledSize(size.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio));
+        }
+
+        const QImage image = reader.read();
+        if(image.isNull()) {
+            return false;
+        }
+
+        QByteArray data;
+        QBuffer output{&data};
+        output.open(QIODevice::WriteOnly);
+        if(!image.save(&output, "JPG", ThumbnailQuality) || !p->pack.insert(imageKey(imageHash), data)) {
+            return false;
+        }
+    }
+
+    const AlbumRecord record{.contentHash = imageHash, .origin = track.filepath(), .scaled = scaled};
+    return p->pack.insert(albumKey(albumHash), record.serialise());
+}
+
+void EmbeddedCoverStore::remove(const QString& albumHash)
+{
+    if(p->openPack()) {
+        p->pack.remove(albumKey(albumHash));
+    }
+}
+
+void EmbeddedCoverStore::clear()
+{
+    if(p->openPack()) {
+        p->pack.clear();
+    }
+}
+} // namespace Fooyin
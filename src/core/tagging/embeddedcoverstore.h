@@ -0,0 +1,85 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <QImage>
+#include <QString>
+
+#include <memory>
+
+namespace Fooyin {
+class Track;
+
+/*!
+ * Thumbnails of embedded front covers, extracted while scanning so covers can be shown without reading every
+ * file again.
+ *
+ * Each album points to a thumbnail and the file it came from, so a full-size cover can be read from a file
+ * known to hold one. Thumbnails are stored once per distinct image, so albums sharing artwork (e.g. every disc
+ * of a set) share a single copy.
+ * @note thread-safe.
+ */
+class FYCORE_EXPORT EmbeddedCoverStore
+{
+public:
+    struct Cover
+    {
+        QImage thumbnail;
+        // The track the cover was extracted from
+        QString origin;
+        // Whether the thumbnail is smaller than the embedded cover
+        bool scaled{false};
+
+        [[nodiscard]] bool isValid() const
+        {
+            return !thumbnail.isNull();
+        }
+    };
+
+    /** Creates a store held in the pack file at @p filepath. */
+    explicit EmbeddedCoverStore(const QString& filepath);
+    ~EmbeddedCoverStore();
+
+    EmbeddedCoverStore(const EmbeddedCoverStore&)            = delete;
+    EmbeddedCoverStore& operator=(const EmbeddedCoverStore&) = delete;
+
+    /** Returns the store shared by the library scanner and cover loader. */
+    static EmbeddedCoverStore& instance();
+
+    [[nodiscard]] bool contains(const QString& albumHash) const;
+    /** Returns the cover stored for the album with @p albumHash, or an invalid cover if there is none. */
+    [[nodiscard]] Cover find(const QString& albumHash) const;
+
+    /*!
+     * Stores @p cover, the encoded front cover read from @p track, as the cover of its album.
+     * An empty @p cover removes the album's cover if it came from @p track, as the file no longer holds one.
+     * @returns @c false if @p cover couldn't be decoded.
+     */
+    bool store(const Track& track, const QByteArray& cover);
+    void remove(const QString& albumHash);
+    void clear();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
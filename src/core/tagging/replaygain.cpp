@@ -0,0 +1,78 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "replaygain.h"
+
+#include "tagdefs.h"
+
+#include <core/track.h>
+
+#include <QRegularExpression>
+
+namespace {
+std::optional<double> readValue(const Fooyin::Track& track, const QString& tag)
+{
+    const QStringList values = track.extraTag(tag);
+    if(values.empty()) {
+        return {};
+    }
+
+    // Gains are usually written as "-6.52 dB", but the suffix isn't always present
+    static const QRegularExpression suffix{QStringLiteral("\\s*dB\\s*$"), QRegularExpression::CaseInsensitiveOption};
+
+    QString value = values.constFirst().trimmed();
+    value.remove(suffix);
+
+    bool ok{false};
+    const double result = value.toDouble(&ok);
+    return ok ? std::optional{result} : std::nullopt;
+}
+
+void writeValue(Fooyin::Track& track, const QString& tag, const std::optional<double>& value, bool isGain)
+{
+    if(!value) {
+        track.removeExtraTag(tag);
+        return;
+    }
+
+    const QString text = isGain ? QString::number(value.value(), 'f', 2) + QStringLiteral(" dB")
+                                : QString::number(value.value(), 'f', 6);
+    track.replaceExtraTag(tag, text);
+}
+} // namespace
+
+namespace Fooyin {
+ReplayGainInfo ReplayGainInfo::fromTrack(const Track& track)
+{
+    ReplayGainInfo info;
+    info.trackGain = readValue(track, QString::fromLatin1(Tag::ReplayGain::TrackGain));
+    info.trackPeak = readValue(track, QString::fromLatin1(Tag::ReplayGain::TrackPeak));
+    info.albumGain = readValue(track, QString::fromLatin1(Tag::ReplayGain::AlbumGain));
+    info.albumPeak = readValue(track, QString::fromLatin1(Tag::ReplayGain::AlbumPeak));
+    return info;
+}
+
+void ReplayGainInfo::applyTo(Track& track) const
+{
+    writeValue(track, QString::fromLatin1(Tag::ReplayGain::TrackGain), trackGain, true);
+    writeValue(track, QString::fromLatin1(Tag::ReplayGain::TrackPeak), trackPeak, false);
+    writeValue(track, QString::fromLatin1(Tag::ReplayGain::AlbumGain), albumGain, true);
+    writeValue(track, QString::fromLatin1(Tag::ReplayGain::AlbumPeak), albumPeak, false);
+}
+} // namespace Fooyin
@@ -0,0 +1,52 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <optional>
+
+namespace Fooyin {
+class Track;
+
+/*!
+ * ReplayGain values of a track, as stored in its REPLAYGAIN_* tags.
+ * Gains are in dB, peaks are linear with 1.0 being full scale.
+ */
+struct ReplayGainInfo
+{
+    std::optional<double> trackGain;
+    std::optional<double> trackPeak;
+    std::optional<double> albumGain;
+    std::optional<double> albumPeak;
+
+    [[nodiscard]] bool hasTrackGain() const
+    {
+        return trackGain.has_value();
+    }
+
+    [[nodiscard]] bool hasAlbumGain() const
+    {
+        return albumGain.has_value();
+    }
+
+    static ReplayGainInfo fromTrack(const Track& track);
+    /** Replaces the REPLAYGAIN_* tags of @p track, removing any which are unset. */
+    void applyTo(Track& track) const;
+};
+} // namespace Fooyin
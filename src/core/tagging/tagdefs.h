@@ -35,6 +35,13 @@ constexpr auto TrackNumber = "TRACKNUMBER";
 constexpr auto TrackTotal  = "TRACKTOTAL";
 constexpr auto DiscNumber  = "DISCNUMBER";
 constexpr auto DiscTotal   = "DISCTOTAL";
+
+namespace ReplayGain {
+constexpr auto TrackGain = "REPLAYGAIN_TRACK_GAIN";
+constexpr auto TrackPeak = "REPLAYGAIN_TRACK_PEAK";
+constexpr auto AlbumGain = "REPLAYGAIN_ALBUM_GAIN";
+constexpr auto AlbumPeak = "REPLAYGAIN_ALBUM_PEAK";
+} // namespace ReplayGain
 } // namespace Tag
 
 namespace Mp4 {
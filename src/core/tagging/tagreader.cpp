@@ -19,6 +19,9 @@
 
 #include "tagreader.h"
 
+#include "archive/archivecache.h"
+#include "archive/archivereader.h"
+#include "filereader.h"
 #include "tagdefs.h"
 
 #include <core/constants.h>
@@ -43,19 +46,27 @@
 #include <taglib/opusfile.h>
 #include <taglib/popularimeterframe.h>
 #include <taglib/tag.h>
-#include <taglib/tfilestream.h>
+#include <taglib/tbytevectorstream.h>
+#include <taglib/tiostream.h>
 #include <taglib/tpropertymap.h>
 #include <taglib/vorbisfile.h>
 #include <taglib/wavfile.h>
 #include <taglib/wavpackfile.h>
 
+#include <QBuffer>
 #include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
+#include <QImageReader>
 #include <QMimeDatabase>
 #include <QPixmap>
 
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <unordered_map>
 
 namespace {
 constexpr std::array supportedMp4Tags{
@@ -247,9 +258,28 @@ Fooyin::Track::Type typeForMime(const QString& mimeType)
     return Fooyin::Track::Type::Unknown;
 }
 
-TagLib::AudioProperties::ReadStyle readStyle(Fooyin::Tagging::Quality quality)
+thread_local uint64_t estimatedDurations{0};
+
+TagLib::AudioProperties::ReadStyle readStyle(Fooyin::Tagging::Quality quality, Fooyin::Track::Type type)
 {
+    using Fooyin::Track;
+
     switch(quality) {
+        case(Fooyin::Tagging::Quality::Auto):
+            switch(type) {
+                // The duration is in a header, so reading more of the file gains nothing
+                case(Track::Type::FLAC):
+                case(Track::Type::MP4):
+                case(Track::Type::WAV):
+                case(Track::Type::AIFF):
+                case(Track::Type::APE):
+                case(Track::Type::MPC):
+                case(Track::Type::ASF):
+                    return TagLib::AudioProperties::Fast;
+                // MPEG needs its Xing/VBRI header, and Ogg and WavPack may need their last page or block
+                default:
+                    return TagLib::AudioProperties::Average;
+            }
         case(Fooyin::Tagging::Quality::Fast):
             return TagLib::AudioProperties::Fast;
         case(Fooyin::Tagging::Quality::Average):
@@ -423,7 +453,70 @@ void readId3Tags(const TagLib::ID3v2::Tag* id3Tags, Fooyin::Track& track)
     }
 }
 
-QByteArray readId3Cover(const TagLib::ID3v2::Tag* id3Tags, Fooyin::Track::Cover cover)
+/*!
+ * Chooses between several embedded pictures of the same type.
+ * With no minimum size the last picture wins, otherwise the smallest picture at least that size
+ * is chosen (or the largest if none are), so thumbnails don't decode a full-size scan.
+ */
+class CoverPicker
+{
+public:
+    explicit CoverPicker(const QSize& minimumSize)
+        : m_minimumSize{minimumSize}
+    { }
+
+    void add(const TagLib::ByteVector& data, int width = 0, int height = 0)
+    {
+        if(data.isEmpty()) {
+            return;
+        }
+
+        if(!m_minimumSize.isValid()) {
+            m_picture = data;
+            return;
+        }
+
+        if(width <= 0 || height <= 0) {
+            // Only the image header is read
+            QByteArray bytes = QByteArray::fromRawData(data.data(), static_cast<qsizetype>(data.size()));
+            QBuffer buffer{&bytes};
+            const QSize size = QImageReader{&buffer}.size();
+            width            = size.width();
+            height           = size.height();
+        }
+
+        const int64_t area = static_cast<int64_t>(width) * height;
+        const bool large   = width >= m_minimumSize.width() && height >= m_minimumSize.height();
+
+        bool better{m_picture.isEmpty()};
+        if(!better) {
+            // Any picture large enough beats one which isn't, then the closest to the minimum wins
+            better = large ? (!m_large || area < m_area) : (!m_large && area > m_area);
+        }
+
+        if(better) {
+            m_picture = data;
+            m_area    = area;
+            m_large   = large;
+        }
+    }
+
+    [[nodiscard]] QByteArray picture() const
+    {
+        if(m_picture.isEmpty()) {
+            return {};
+        }
+        return {m_picture.data(), static_cast<qsizetype>(m_picture.size())};
+    }
+
+private:
+    QSize m_minimumSize;
+    TagLib::ByteVector m_picture;
+    int64_t m_area{0};
+    bool m_large{false};
+};
+
+QByteArray readId3Cover(const TagLib::ID3v2::Tag* id3Tags, Fooyin::Track::Cover cover, const QSize& minimumSize)
 {
     if(id3Tags->isEmpty()) {
         return {};
@@ -433,28 +526,24 @@ QByteArray readId3Cover(const TagLib::ID3v2::Tag* id3Tags, Fooyin::Track::Cover
 
     using PictureFrame = TagLib::ID3v2::AttachedPictureFrame;
 
-    TagLib::ByteVector picture;
+    CoverPicker picker{minimumSize};
 
     for(const auto& frame : std::as_const(frames)) {
         const auto* coverFrame        = static_cast<PictureFrame*>(frame);
         const PictureFrame::Type type = coverFrame->type();
 
         if(cover == Fooyin::Track::Cover::Front && (type == PictureFrame::FrontCover || type == PictureFrame::Other)) {
-            picture = coverFrame->picture();
+            picker.add(coverFrame->picture());
         }
         else if(cover == Fooyin::Track::Cover::Back && type == PictureFrame::BackCover) {
-            picture = coverFrame->picture();
+            picker.add(coverFrame->picture());
         }
         else if(cover == Fooyin::Track::Cover::Artist && type == PictureFrame::Artist) {
-            picture = coverFrame->picture();
+            picker.add(coverFrame->picture());
         }
     }
 
-    if(picture.isEmpty()) {
-        return {};
-    }
-
-    return {picture.data(), static_cast<qsizetype>(picture.size())};
+    return picker.picture();
 }
 
 void readApeTags(const TagLib::APE::Tag* apeTags, Fooyin::Track& track)
@@ -623,7 +712,7 @@ void readMp4Tags(const TagLib::MP4::Tag* mp4Tags, Fooyin::Track& track, bool ski
     }
 }
 
-QByteArray readMp4Cover(const TagLib::MP4::Tag* mp4Tags, Fooyin::Track::Cover /*cover*/)
+QByteArray readMp4Cover(const TagLib::MP4::Tag* mp4Tags, Fooyin::Track::Cover /*cover*/, const QSize& minimumSize)
 {
     const TagLib::MP4::Item coverArtItem = mp4Tags->item(Fooyin::Mp4::Cover);
     if(!coverArtItem.isValid()) {
@@ -632,11 +721,20 @@ QByteArray readMp4Cover(const TagLib::MP4::Tag* mp4Tags, Fooyin::Track::Cover /*
 
     const TagLib::MP4::CoverArtList coverArtList = coverArtItem.toCoverArtList();
 
-    if(!coverArtList.isEmpty()) {
+    if(coverArtList.isEmpty()) {
+        return {};
+    }
+
+    if(!minimumSize.isValid()) {
         const TagLib::MP4::CoverArt& coverArt = coverArtList.front();
         return {coverArt.data().data(), coverArt.data().size()};
     }
-    return {};
+
+    CoverPicker picker{minimumSize};
+    for(const auto& coverArt : coverArtList) {
+        picker.add(coverArt.data());
+    }
+    return picker.picture();
 }
 
 void readXiphComment(const TagLib::Ogg::XiphComment* xiphTags, Fooyin::Track& track)
@@ -686,34 +784,31 @@ void readXiphComment(const TagLib::Ogg::XiphComment* xiphTags, Fooyin::Track& tr
     }
 }
 
-QByteArray readFlacCover(const TagLib::List<TagLib::FLAC::Picture*>& pictures, Fooyin::Track::Cover cover)
+QByteArray readFlacCover(const TagLib::List<TagLib::FLAC::Picture*>& pictures, Fooyin::Track::Cover cover,
+                         const QSize& minimumSize)
 {
     if(pictures.isEmpty()) {
         return {};
     }
 
-    TagLib::ByteVector picture;
+    CoverPicker picker{minimumSize};
 
     using FlacPicture = TagLib::FLAC::Picture;
     for(const auto& pic : pictures) {
         const auto type = pic->type();
 
         if(cover == Fooyin::Track::Cover::Front && (type == FlacPicture::FrontCover || type == FlacPicture::Other)) {
-            picture = pic->data();
+            picker.add(pic->data(), pic->width(), pic->height());
         }
         else if(cover == Fooyin::Track::Cover::Back && type == FlacPicture::BackCover) {
-            picture = pic->data();
+            picker.add(pic->data(), pic->width(), pic->height());
         }
         else if(cover == Fooyin::Track::Cover::Artist && type == FlacPicture::Artist) {
-            picture = pic->data();
+            picker.add(pic->data(), pic->width(), pic->height());
         }
     }
 
-    if(!picture.isEmpty()) {
-        return {picture.data(), static_cast<qsizetype>(picture.size())};
-    }
-
-    return {};
+    return picker.picture();
 }
 
 void readAsfTags(const TagLib::ASF::Tag* asfTags, Fooyin::Track& track)
@@ -785,7 +880,7 @@ void readAsfTags(const TagLib::ASF::Tag* asfTags, Fooyin::Track& track)
     }
 }
 
-QByteArray readAsfCover(const TagLib::ASF::Tag* asfTags, Fooyin::Track::Cover cover)
+QByteArray readAsfCover(const TagLib::ASF::Tag* asfTags, Fooyin::Track::Cover cover, const QSize& minimumSize)
 {
     if(asfTags->isEmpty()) {
         return {};
@@ -793,7 +888,7 @@ QByteArray readAsfCover(const TagLib::ASF::Tag* asfTags, Fooyin::Track::Cover co
 
     const TagLib::ASF::AttributeList pictures = asfTags->attribute("WM/Picture");
 
-    TagLib::ByteVector picture;
+    CoverPicker picker{minimumSize};
 
     using Picture = TagLib::ASF::Picture;
     for(const auto& attribute : pictures) {
@@ -801,62 +896,225 @@ QByteArray readAsfCover(const TagLib::ASF::Tag* asfTags, Fooyin::Track::Cover co
         const auto type   = pic.type();
 
         if(cover == Fooyin::Track::Cover::Front && (type == Picture::FrontCover || type == Picture::Other)) {
-            picture = pic.picture();
+            picker.add(pic.picture());
         }
         else if(cover == Fooyin::Track::Cover::Back && type == Picture::BackCover) {
-            picture = pic.picture();
+            picker.add(pic.picture());
         }
         else if(cover == Fooyin::Track::Cover::Artist && type == Picture::Artist) {
-            picture = pic.picture();
+            picker.add(pic.picture());
         }
     }
 
-    if(!picture.isEmpty()) {
-        return {picture.data(), static_cast<qsizetype>(picture.size())};
+    return picker.picture();
+}
+
+#if(TAGLIB_MAJOR_VERSION >= 2)
+using StreamOffset = TagLib::offset_t;
+using StreamSize   = size_t;
+#else
+using StreamOffset = long;
+using StreamSize   = unsigned long;
+#endif
+
+/*!
+ * A read-only TagLib stream backed by a FileReader.
+ * TagLib's own FileStream issues many small reads, which are costly on cold caches and network shares.
+ */
+class ReaderStream : public TagLib::IOStream
+{
+public:
+    explicit ReaderStream(const QString& filepath)
+        : m_name{filepath.toUtf8()}
+    {
+        m_reader.open(filepath, Fooyin::FileReader::Access::Sparse);
+    }
+
+    [[nodiscard]] TagLib::FileName name() const override
+    {
+        return m_name.constData();
     }
 
-    return {};
+    TagLib::ByteVector readBlock(StreamSize length) override
+    {
+        const int64_t count = std::min(static_cast<int64_t>(length), m_reader.size() - m_reader.pos());
+        if(count <= 0) {
+            return {};
+        }
+
+        TagLib::ByteVector data(static_cast<unsigned int>(count), 0);
+        const int64_t read = m_reader.read(reinterpret_cast<std::byte*>(data.data()), count);
+        if(read <= 0) {
+            return {};
+        }
+        if(read < count) {
+            data.resize(static_cast<unsigned int>(read));
+        }
+        return data;
+    }
+
+    void writeBlock(const TagLib::ByteVector& /*data*/) override { }
+    void insert(const TagLib::ByteVector& /*data*/, StreamOffset /*start*/, StreamSize /*replace*/) override { }
+    void removeBlock(StreamOffset /*start*/, StreamSize /*length*/) override { }
+
+    [[nodiscard]] bool readOnly() const override
+    {
+        return true;
+    }
+
+    [[nodiscard]] bool isOpen() const override
+    {
+        return m_reader.isOpen();
+    }
+
+    [[nodiscard]] uint64_t modifiedTime() const
+    {
+        return m_reader.modifiedTime();
+    }
+
+    void seek(StreamOffset offset, Position p) override
+    {
+        auto pos = static_cast<int64_t>(offset);
+        if(p == Current) {
+            pos += m_reader.pos();
+        }
+        else if(p == End) {
+            pos += m_reader.size();
+        }
+        m_reader.seek(std::clamp(pos, int64_t{0}, m_reader.size()));
+    }
+
+    void clear() override { }
+
+    [[nodiscard]] StreamOffset tell() const override
+    {
+        return static_cast<StreamOffset>(m_reader.pos());
+    }
+
+    StreamOffset length() override
+    {
+        return static_cast<StreamOffset>(m_reader.size());
+    }
+
+    void truncate(StreamOffset /*length*/) override { }
+
+private:
+    QByteArray m_name;
+    Fooyin::FileReader m_reader;
+};
+
+// An Ogg page header followed by the largest identification packet we check for
+constexpr auto OggHeaderSize = 27 + 255 + 8;
+// Enough for QMimeDatabase to recognise any of the formats we support
+constexpr auto SniffSize = 4096;
+
+TagLib::ByteVector readHeader(TagLib::IOStream& stream, StreamSize size)
+{
+    stream.seek(0, TagLib::IOStream::Beginning);
+    TagLib::ByteVector header = stream.readBlock(size);
+    stream.seek(0, TagLib::IOStream::Beginning);
+    return header;
 }
-} // namespace
 
-namespace Fooyin::Tagging {
-// TODO: Implement a file/mime type resolver
-bool readMetaData(Track& track, Quality quality)
+Fooyin::Track::Type sniffOgg(TagLib::IOStream& stream)
 {
-    const auto filepath = track.filepath();
-    const QFileInfo fileInfo{filepath};
+    const TagLib::ByteVector header = readHeader(stream, OggHeaderSize);
+    if(header.size() < 28 || !header.startsWith("OggS")) {
+        return Fooyin::Track::Type::Unknown;
+    }
 
-    if(fileInfo.size() <= 0) {
-        return false;
+    // The first packet is the codec's identification header, directly after the segment table
+    const unsigned int packet = 27 + static_cast<unsigned char>(header[26]);
+
+    if(header.containsAt("OpusHead", packet)) {
+        return Fooyin::Track::Type::OggOpus;
+    }
+    if(header.containsAt("\x01vorbis", packet)) {
+        return Fooyin::Track::Type::OggVorbis;
     }
 
-    track.setFileSize(fileInfo.size());
+    return Fooyin::Track::Type::Unknown;
+}
 
-    track.setAddedTime(QDateTime::currentMSecsSinceEpoch());
-    const QDateTime modifiedTime = fileInfo.lastModified();
-    track.setModifiedTime(modifiedTime.isValid() ? modifiedTime.toMSecsSinceEpoch() : 0);
+/*!
+ * Resolves which TagLib file type to use for @p filepath.
+ * Most extensions map directly to a type. Ogg containers are told apart by their first packet,
+ * and anything else goes through QMimeDatabase, with the extension's result cached.
+ */
+Fooyin::Track::Type resolveFileType(const QString& filepath, TagLib::IOStream& stream)
+{
+    using Fooyin::Track;
 
-    TagLib::FileStream stream(filepath.toUtf8().constData(), true);
-    if(!stream.isOpen()) {
-        qWarning() << "Unable to open file readonly: " << filepath;
-        return false;
+    static const std::unordered_map<QString, Track::Type> extensionTypes{
+        {QStringLiteral("mp3"), Track::Type::MPEG},     {QStringLiteral("mp2"), Track::Type::MPEG},
+        {QStringLiteral("aiff"), Track::Type::AIFF},    {QStringLiteral("aif"), Track::Type::AIFF},
+        {QStringLiteral("aifc"), Track::Type::AIFF},    {QStringLiteral("wav"), Track::Type::WAV},
+        {QStringLiteral("mpc"), Track::Type::MPC},      {QStringLiteral("ape"), Track::Type::APE},
+        {QStringLiteral("wv"), Track::Type::WavPack},   {QStringLiteral("m4a"), Track::Type::MP4},
+        {QStringLiteral("m4b"), Track::Type::MP4},      {QStringLiteral("mp4"), Track::Type::MP4},
+        {QStringLiteral("aax"), Track::Type::MP4},      {QStringLiteral("flac"), Track::Type::FLAC},
+        {QStringLiteral("opus"), Track::Type::OggOpus}, {QStringLiteral("wma"), Track::Type::ASF},
+        {QStringLiteral("asf"), Track::Type::ASF}};
+
+    const auto dot   = filepath.lastIndexOf(u'.');
+    const auto slash = filepath.lastIndexOf(u'/');
+    const QString extension{dot > slash ? filepath.sliced(dot + 1).toLower() : QString{}};
+
+    if(extension == u"ogg" || extension == u"oga") {
+        // Can hold either Vorbis or Opus
+        return sniffOgg(stream);
+    }
+
+    if(const auto typeIt = extensionTypes.find(extension); typeIt != extensionTypes.end()) {
+        return typeIt->second;
     }
 
+    static std::mutex cacheMutex;
+    static std::unordered_map<QString, Track::Type> cachedTypes;
+
     const QMimeDatabase mimeDb;
-    QString mimeType = mimeDb.mimeTypeForFile(filepath).name();
-    const auto style = readStyle(quality);
+
+    Track::Type type{Track::Type::Unknown};
+    {
+        const std::scoped_lock lock{cacheMutex};
+        if(const auto cachedIt = cachedTypes.find(extension); cachedIt != cachedTypes.end()) {
+            type = cachedIt->second;
+        }
+        else {
+            type = typeForMime(mimeDb.mimeTypeForFile(filepath, QMimeDatabase::MatchExtension).name());
+            cachedTypes.emplace(extension, type);
+        }
+    }
+
+    if(type == Track::Type::Unknown) {
+        // Unrecognised extension, so only the contents can tell us
+        const TagLib::ByteVector header = readHeader(stream, SniffSize);
+        type = typeForMime(mimeDb.mimeTypeForData(QByteArray{header.data(), static_cast<qsizetype>(header.size())})
+                               .name());
+        if(type == Track::Type::OggVorbis) {
+            type = sniffOgg(stream);
+        }
+    }
+
+    return type;
+}
+} // namespace
+
+namespace Fooyin::Tagging {
+namespace {
+bool readStreamMetaData(Track& track, TagLib::IOStream& stream, Quality quality)
+{
+    const QString filepath = track.filepath();
+
+    const Track::Type type = resolveFileType(filepath, stream);
+    const auto style       = readStyle(quality, type);
 
     const auto readProperties = [&track](const TagLib::File& file, bool skipExtra = false) {
         readAudioProperties(file, track);
         readGeneralProperties(file.properties(), track, skipExtra);
     };
 
-    if(mimeType == QStringLiteral("audio/ogg") || mimeType == QStringLiteral("audio/x-vorbis+ogg")) {
-        // Workaround for opus files with ogg suffix returning incorrect type
-        mimeType = mimeDb.mimeTypeForFile(filepath, QMimeDatabase::MatchContent).name();
-    }
-    if(mimeType == QStringLiteral("audio/mpeg") || mimeType == QStringLiteral("audio/mpeg3")
-       || mimeType == QStringLiteral("audio/x-mpeg")) {
+    if(type == Track::Type::MPEG) {
 #if(TAGLIB_MAJOR_VERSION >= 2)
         TagLib::MPEG::File file(&stream, true, style, TagLib::ID3v2::FrameFactory::instance());
 #else
@@ -867,9 +1125,14 @@ bool readMetaData(Track& track, Quality quality)
             if(file.hasID3v2Tag()) {
                 readId3Tags(file.ID3v2Tag(), track);
             }
+            // Without one, the duration is worked out from the bitrate of the first frame, which is only
+            // right for CBR
+            if(file.audioProperties() && !file.audioProperties()->xingHeader()) {
+                ++estimatedDurations;
+            }
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-aiff") || mimeType == QStringLiteral("audio/x-aifc")) {
+    else if(type == Track::Type::AIFF) {
         const TagLib::RIFF::AIFF::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -881,8 +1144,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/vnd.wave") || mimeType == QStringLiteral("audio/wav")
-            || mimeType == QStringLiteral("audio/x-wav")) {
+    else if(type == Track::Type::WAV) {
         const TagLib::RIFF::WAV::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -894,7 +1156,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-musepack")) {
+    else if(type == Track::Type::MPC) {
         TagLib::MPC::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -903,7 +1165,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-ape")) {
+    else if(type == Track::Type::APE) {
         TagLib::APE::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -915,7 +1177,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-wavpack")) {
+    else if(type == Track::Type::WavPack) {
         TagLib::WavPack::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -927,7 +1189,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/mp4") || mimeType == QStringLiteral("audio/vnd.audible.aax")) {
+    else if(type == Track::Type::MP4) {
         const TagLib::MP4::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file, true);
@@ -939,7 +1201,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/flac")) {
+    else if(type == Track::Type::FLAC) {
 #if(TAGLIB_MAJOR_VERSION >= 2)
         TagLib::FLAC::File file(&stream, true, style, TagLib::ID3v2::FrameFactory::instance());
 #else
@@ -955,7 +1217,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/ogg") || mimeType == QStringLiteral("audio/x-vorbis+ogg")) {
+    else if(type == Track::Type::OggVorbis) {
         const TagLib::Ogg::Vorbis::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -964,7 +1226,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/opus") || mimeType == QStringLiteral("audio/x-opus+ogg")) {
+    else if(type == Track::Type::OggOpus) {
         const TagLib::Ogg::Opus::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -973,7 +1235,7 @@ bool readMetaData(Track& track, Quality quality)
             }
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-ms-wma")) {
+    else if(type == Track::Type::ASF) {
         const TagLib::ASF::File file(&stream, true, style);
         if(file.isValid()) {
             readProperties(file);
@@ -986,115 +1248,383 @@ bool readMetaData(Track& track, Quality quality)
         }
     }
     else {
-        qDebug() << "Unsupported mime type: " << mimeType;
+        qDebug() << "Unsupported file type: " << filepath;
     }
 
-    track.setType(typeForMime(mimeType));
+    track.setType(type);
     track.generateHash();
 
     return true;
 }
 
-QByteArray readCover(const Track& track, Track::Cover cover)
+QByteArray readStreamCover(const Track& track, TagLib::IOStream& stream, Track::Cover cover, const QSize& minimumSize)
 {
-    const auto filepath = track.filepath();
-    const QFileInfo fileInfo{filepath};
-
-    if(fileInfo.size() <= 0) {
-        return {};
-    }
-
-    TagLib::FileStream stream(filepath.toUtf8().constData(), true);
-    if(!stream.isOpen()) {
-        qWarning() << "Unable to open file readonly: " << filepath;
-        return {};
-    }
+    const QString filepath = track.filepath();
 
-    const QMimeDatabase mimeDb;
-    QString mimeType = mimeDb.mimeTypeForFile(filepath).name();
-    const auto style = TagLib::AudioProperties::Average;
+    const Track::Type type = resolveFileType(filepath, stream);
+    const auto style       = TagLib::AudioProperties::Average;
 
-    if(mimeType == QStringLiteral("audio/ogg") || mimeType == QStringLiteral("audio/x-vorbis+ogg")) {
-        // Workaround for opus files with ogg suffix returning incorrect type
-        mimeType = mimeDb.mimeTypeForFile(filepath, QMimeDatabase::MatchContent).name();
-    }
-    if(mimeType == QStringLiteral("audio/mpeg") || mimeType == QStringLiteral("audio/mpeg3")
-       || mimeType == QStringLiteral("audio/x-mpeg")) {
+    if(type == Track::Type::MPEG) {
 #if(TAGLIB_MAJOR_VERSION >= 2)
         TagLib::MPEG::File file(&stream, true, style, TagLib::ID3v2::FrameFactory::instance());
 #else
         TagLib::MPEG::File file(&stream, TagLib::ID3v2::FrameFactory::instance(), true, style);
 #endif
         if(file.isValid() && file.hasID3v2Tag()) {
-            return readId3Cover(file.ID3v2Tag(), cover);
+            return readId3Cover(file.ID3v2Tag(), cover, minimumSize);
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-aiff") || mimeType == QStringLiteral("audio/x-aifc")) {
+    else if(type == Track::Type::AIFF) {
         const TagLib::RIFF::AIFF::File file(&stream, true);
         if(file.isValid() && file.hasID3v2Tag()) {
-            return readId3Cover(file.tag(), cover);
+            return readId3Cover(file.tag(), cover, minimumSize);
         }
     }
-    else if(mimeType == QStringLiteral("audio/vnd.wave") || mimeType == QStringLiteral("audio/wav")
-            || mimeType == QStringLiteral("audio/x-wav")) {
+    else if(type == Track::Type::WAV) {
         const TagLib::RIFF::WAV::File file(&stream, true);
         if(file.isValid() && file.hasID3v2Tag()) {
-            return readId3Cover(file.ID3v2Tag(), cover);
+            return readId3Cover(file.ID3v2Tag(), cover, minimumSize);
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-musepack")) {
+    else if(type == Track::Type::MPC) {
         TagLib::MPC::File file(&stream, true);
         if(file.isValid() && file.APETag()) {
             return readApeCover(file.APETag(), cover);
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-ape")) {
+    else if(type == Track::Type::APE) {
         TagLib::APE::File file(&stream, true);
         if(file.isValid() && file.APETag()) {
             return readApeCover(file.APETag(), cover);
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-wavpack")) {
+    else if(type == Track::Type::WavPack) {
         TagLib::WavPack::File file(&stream, true);
         if(file.isValid() && file.APETag()) {
             return readApeCover(file.APETag(), cover);
         }
     }
-    else if(mimeType == QStringLiteral("audio/mp4") || mimeType == QStringLiteral("audio/vnd.audible.aax")) {
+    else if(type == Track::Type::MP4) {
         const TagLib::MP4::File file(&stream, true);
         if(file.isValid() && file.tag()) {
-            return readMp4Cover(file.tag(), cover);
+            return readMp4Cover(file.tag(), cover, minimumSize);
         }
     }
-    else if(mimeType == QStringLiteral("audio/flac")) {
+    else if(type == Track::Type::FLAC) {
 #if(TAGLIB_MAJOR_VERSION >= 2)
         TagLib::FLAC::File file(&stream, true, style, TagLib::ID3v2::FrameFactory::instance());
 #else
         TagLib::FLAC::File file(&stream, TagLib::ID3v2::FrameFactory::instance(), true, style);
 #endif
         if(file.isValid()) {
-            return readFlacCover(file.pictureList(), cover);
+            return readFlacCover(file.pictureList(), cover, minimumSize);
         }
     }
-    else if(mimeType == QStringLiteral("audio/ogg") || mimeType == QStringLiteral("audio/x-vorbis+ogg")) {
+    else if(type == Track::Type::OggVorbis) {
         const TagLib::Ogg::Vorbis::File file(&stream, true);
         if(file.isValid() && file.tag()) {
-            return readFlacCover(file.tag()->pictureList(), cover);
+            return readFlacCover(file.tag()->pictureList(), cover, minimumSize);
         }
     }
-    else if(mimeType == QStringLiteral("audio/opus") || mimeType == QStringLiteral("audio/x-opus+ogg")) {
+    else if(type == Track::Type::OggOpus) {
         const TagLib::Ogg::Opus::File file(&stream, true);
         if(file.isValid() && file.tag()) {
-            return readFlacCover(file.tag()->pictureList(), cover);
+            return readFlacCover(file.tag()->pictureList(), cover, minimumSize);
         }
     }
-    else if(mimeType == QStringLiteral("audio/x-ms-wma")) {
+    else if(type == Track::Type::ASF) {
         const TagLib::ASF::File file(&stream, true);
         if(file.isValid() && file.tag()) {
-            return readAsfCover(file.tag(), cover);
+            return readAsfCover(file.tag(), cover, minimumSize);
         }
     }
 
     return {};
 }
+
+// The modified time of an archived track is that of its archive, so it's only read again when that changes
+uint64_t modifiedTime(const Track& track, uint64_t fileModified)
+{
+    if(!track.isInArchive()) {
+        return fileModified;
+    }
+    const QDateTime modified = QFileInfo{track.archivePath()}.lastModified();
+    return modified.isValid() ? modified.toMSecsSinceEpoch() : 0;
+}
+
+// Reads a file of an archive into memory without going through the cache, e.g. for its cover
+TagLib::ByteVector readArchivedFile(const Track& track)
+{
+    ArchiveReader reader;
+    if(!reader.open(track.archivePath())) {
+        return {};
+    }
+
+    const QString entryPath = track.pathInArchive();
+
+    ArchiveReader::Entry entry;
+    while(reader.nextEntry(entry)) {
+        if(entry.path == entryPath) {
+            const QByteArray data = reader.readAll();
+            return {data.constData(), static_cast<unsigned int>(data.size())};
+        }
+    }
+
+    return {};
+}
+
+// An MPEG audio frame header, as far as needed to step from one frame to the next
+struct MpegFrame
+{
+    int version{0};
+    int layer{0};
+    int sampleRate{0};
+    int length{0};
+    int samples{0};
+
+    [[nodiscard]] bool sameStream(const MpegFrame& other) const
+    {
+        return version == other.version && layer == other.layer && sampleRate == other.sampleRate;
+    }
+};
+
+std::optional<MpegFrame> parseMpegFrame(const std::array<uint8_t, 4>& header)
+{
+    // In kbps, indexed by [MPEG-1][layer - 1]
+    static constexpr std::array<std::array<std::array<int, 15>, 3>, 2> Bitrates{{
+        {{{0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+          {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+          {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160}}},
+        {{{0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+          {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+          {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320}}},
+    }};
+    static constexpr std::array SampleRates{44100, 48000, 32000};
+
+    if(header[0] != 0xFF || (header[1] & 0xE0) != 0xE0) {
+        return {};
+    }
+
+    const int versionBits = (header[1] >> 3) & 0x03;
+    const int layerBits   = (header[1] >> 1) & 0x03;
+    const int bitrateBits = header[2] >> 4;
+    const int rateBits    = (header[2] >> 2) & 0x03;
+    const int padding     = (header[2] >> 1) & 0x01;
+
+    // Free format frames have no fixed length, so can't be stepped over
+    if(versionBits == 1 || layerBits == 0 || bitrateBits == 0 || bitrateBits == 15 || rateBits == 3) {
+        return {};
+    }
+
+    MpegFrame frame;
+    frame.version = versionBits;
+    frame.layer   = 4 - layerBits;
+
+    const bool mpeg1  = versionBits == 3;
+    frame.sampleRate  = SampleRates.at(rateBits) >> (mpeg1 ? 0 : (versionBits == 2 ? 1 : 2));
+    const int bitrate = Bitrates.at(mpeg1 ? 1 : 0).at(frame.layer - 1).at(bitrateBits) * 1000;
+
+    if(frame.layer == 1) {
+        frame.samples = 384;
+        frame.length  = ((12 * bitrate / frame.sampleRate) + padding) * 4;
+    }
+    else {
+        // MPEG-2 and 2.5 layer III frames hold half the samples
+        frame.samples = frame.layer == 3 && !mpeg1 ? 576 : 1152;
+        frame.length  = (frame.samples / 8 * bitrate / frame.sampleRate) + padding;
+    }
+
+    return frame;
+}
+} // namespace
+
+uint64_t threadEstimatedDurations()
+{
+    return estimatedDurations;
+}
+
+uint64_t readAccurateDuration(const Track& track)
+{
+    if(track.type() != Track::Type::MPEG || track.isInArchive() || track.hasCue()) {
+        return 0;
+    }
+
+    StreamOffset firstFrame{-1};
+    StreamOffset lastFrame{-1};
+    {
+        ReaderStream stream{track.filepath()};
+        if(!stream.isOpen()) {
+            return 0;
+        }
+#if(TAGLIB_MAJOR_VERSION >= 2)
+        TagLib::MPEG::File file(&stream, false, TagLib::AudioProperties::Fast, TagLib::ID3v2::FrameFactory::instance());
+#else
+        TagLib::MPEG::File file(&stream, TagLib::ID3v2::FrameFactory::instance(), false);
+#endif
+        if(!file.isValid()) {
+            return 0;
+        }
+        firstFrame = file.firstFrameOffset();
+        lastFrame  = file.lastFrameOffset();
+    }
+
+    if(firstFrame < 0 || lastFrame < firstFrame) {
+        return 0;
+    }
+
+    FileReader reader;
+    if(!reader.open(track.filepath(), FileReader::Access::Sequential)) {
+        return 0;
+    }
+
+    std::optional<MpegFrame> first;
+    uint64_t samples{0};
+    auto pos       = static_cast<int64_t>(firstFrame);
+    const auto end = std::min(static_cast<int64_t>(lastFrame), reader.size() - 4);
+
+    std::array<uint8_t, 4> header{};
+    while(pos <= end) {
+        if(!reader.seek(pos) || reader.read(reinterpret_cast<std::byte*>(header.data()), 4) != 4) {
+            break;
+        }
+
+        const auto frame = parseMpegFrame(header);
+        if(!frame || (first && !frame->sameStream(*first))) {
+            // Skip over anything corrupt until the stream picks up again
+            ++pos;
+            continue;
+        }
+
+        if(!first) {
+            first = frame;
+        }
+        samples += static_cast<uint64_t>(frame->samples);
+        pos += frame->length;
+    }
+
+    if(!first || samples == 0) {
+        return 0;
+    }
+
+    return samples * 1000 / static_cast<uint64_t>(first->sampleRate);
+}
+
+bool readMetaData(Track& track, Quality quality)
+{
+    QByteArray cover;
+    return readMetaData(track, cover, {}, quality);
+}
+
+bool readMetaData(Track& track, QByteArray& cover, const std::function<bool(const Track&)>& wantCover,
+                  Quality quality)
+{
+    // Archived tracks are read from a local copy, as reading tags needs random access
+    const QString filepath
+        = track.isInArchive() ? ArchiveCache::instance().file(track.filepath()) : track.filepath();
+    if(filepath.isEmpty()) {
+        return false;
+    }
+
+    // The size and modified time come from the reader's own stat, as each stat is a round trip on network shares
+    ReaderStream stream{filepath};
+    if(!stream.isOpen()) {
+        if(QFileInfo::exists(filepath)) {
+            qWarning() << "Unable to open file readonly: " << filepath;
+        }
+        return false;
+    }
+    if(stream.length() <= 0) {
+        return false;
+    }
+
+    track.setFileSize(static_cast<uint64_t>(stream.length()));
+
+    track.setAddedTime(QDateTime::currentMSecsSinceEpoch());
+    track.setModifiedTime(modifiedTime(track, stream.modifiedTime()));
+
+    if(!readStreamMetaData(track, stream, quality)) {
+        return false;
+    }
+
+    if(wantCover && wantCover(track)) {
+        // Tags sit in the head and tail regions the reader has just cached, so this rarely reads the file again
+        cover = readStreamCover(track, stream, Track::Cover::Front, {});
+    }
+
+    return true;
+}
+
+bool readArchiveTracks(const QString& archivePath, TrackList& tracks, Quality quality)
+{
+    ArchiveReader reader;
+    if(!reader.open(archivePath)) {
+        return false;
+    }
+
+    const auto addedTime = static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch());
+
+    ArchiveReader::Entry entry;
+    while(reader.nextEntry(entry)) {
+        if(!ArchiveReader::isTrackFile(entry.path)) {
+            continue;
+        }
+
+        TagLib::ByteVector data;
+        {
+            const QByteArray contents = reader.readAll();
+            if(contents.isEmpty()) {
+                continue;
+            }
+            data.setData(contents.constData(), static_cast<unsigned int>(contents.size()));
+        }
+
+        Track track{Track::archiveFilepath(archivePath, entry.path)};
+        track.setFileSize(data.size());
+        track.setAddedTime(addedTime);
+        track.setModifiedTime(modifiedTime(track, 0));
+
+        TagLib::ByteVectorStream stream{data};
+        if(readStreamMetaData(track, stream, quality)) {
+            tracks.push_back(track);
+        }
+    }
+
+    return true;
+}
+
+QByteArray readCover(const Track& track, Track::Cover cover, const QSize& minimumSize)
+{
+    if(track.isInArchive()) {
+        // Not worth extracting to disk for, unless it's already there for playback
+        if(ArchiveCache::instance().contains(track.filepath())) {
+            ReaderStream stream{ArchiveCache::instance().file(track.filepath())};
+            if(stream.isOpen()) {
+                return readStreamCover(track, stream, cover, minimumSize);
+            }
+        }
+
+        TagLib::ByteVector data = readArchivedFile(track);
+        if(data.isEmpty()) {
+            return {};
+        }
+
+        TagLib::ByteVectorStream stream{data};
+        return readStreamCover(track, stream, cover, minimumSize);
+    }
+
+    const auto filepath = track.filepath();
+
+    ReaderStream stream{filepath};
+    if(!stream.isOpen()) {
+        if(QFileInfo::exists(filepath)) {
+            qWarning() << "Unable to open file readonly: " << filepath;
+        }
+        return {};
+    }
+    if(stream.length() <= 0) {
+        return {};
+    }
+
+    return readStreamCover(track, stream, cover, minimumSize);
+}
 } // namespace Fooyin::Tagging
@@ -25,8 +25,11 @@
 
 #include <taglib/audioproperties.h>
 
+#include <QSize>
 #include <QString>
 
+#include <functional>
+
 class QPixmap;
 
 namespace Fooyin::Tagging {
@@ -35,8 +38,40 @@ enum class Quality : uint8_t
     Fast = 0,
     Average,
     Accurate,
+    // Fast for formats which store their duration in a header, Average for the rest
+    Auto,
 };
 
-FYCORE_EXPORT bool readMetaData(Track& track, Quality quality = Quality::Average);
-FYCORE_EXPORT QByteArray readCover(const Track& track, Track::Cover cover = Track::Cover::Front);
+FYCORE_EXPORT bool readMetaData(Track& track, Quality quality = Quality::Auto);
+/*!
+ * Reads the metadata of @p track, then its embedded front cover into @p cover if @p wantCover returns
+ * @c true for the track read. The cover is read through the same open file, so it costs no extra round trips.
+ */
+FYCORE_EXPORT bool readMetaData(Track& track, QByteArray& cover, const std::function<bool(const Track&)>& wantCover,
+                                Quality quality = Quality::Auto);
+/*!
+ * Reads every track stored in the archive at @p archivePath into @p tracks, in a single pass over it.
+ * Files are read into memory one at a time, rather than extracted to disk.
+ * @returns false if the archive couldn't be opened.
+ */
+FYCORE_EXPORT bool readArchiveTracks(const QString& archivePath, TrackList& tracks,
+                                     Quality quality = Quality::Auto);
+/*!
+ * Returns the number of tracks read by the calling thread whose duration is only an estimate,
+ * e.g. VBR MP3s without a Xing or VBRI header. Compare before and after a read to check a single track.
+ */
+FYCORE_EXPORT uint64_t threadEstimatedDurations();
+/*!
+ * Works out the exact duration of @p track by walking every frame of its audio.
+ * This reads the whole file, so is only worth doing for tracks whose duration was estimated.
+ * @returns the duration in milliseconds, or 0 if it couldn't be determined.
+ */
+FYCORE_EXPORT uint64_t readAccurateDuration(const Track& track);
+/*!
+ * Reads the embedded picture of type @p cover.
+ * If the file holds several and @p minimumSize is valid, the smallest picture at least that size is returned,
+ * or the largest if none are.
+ */
+FYCORE_EXPORT QByteArray readCover(const Track& track, Track::Cover cover = Track::Cover::Front,
+                                   const QSize& minimumSize = {});
 } // namespace Fooyin::Tagging
@@ -0,0 +1,244 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tagreadservice.h"
+
+#include "tagreader.h"
+
+#include <utils/lrucache.h>
+#include <utils/taskscheduler.h>
+
+#include <QFileInfo>
+#include <QPromise>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// Parsed tags are small, so the track budget holds a few thousand; covers need far more room
+constexpr size_t TrackCacheBudget = 4 * 1024 * 1024;
+constexpr size_t CoverCacheBudget = 32 * 1024 * 1024;
+
+namespace {
+// Identifies the data held by @p track's file as it is now, or returns an empty key if the file can't be found
+QString fileKey(const Fooyin::Track& track)
+{
+    const QFileInfo info{track.isInArchive() ? track.archivePath() : track.filepath()};
+    if(!info.exists()) {
+        return {};
+    }
+    return track.uniqueFilepath() + u'\037' + QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+template <typename Value>
+struct Store
+{
+    struct Pending
+    {
+        bool done{false};
+        std::optional<Value> value;
+    };
+
+    explicit Store(size_t budget)
+        : cache{budget}
+    { }
+
+    Fooyin::LruCache<QString, Value> cache;
+    // Reads in progress, which requests for the same key wait on rather than reading again
+    std::unordered_map<QString, std::shared_ptr<Pending>> pending;
+};
+} // namespace
+
+namespace Fooyin {
+struct TagReadService::Private
+{
+    int readLimit;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    int activeReads{0};
+    Stats stats;
+
+    Store<Track> tracks{TrackCacheBudget};
+    Store<QByteArray> covers{CoverCacheBudget};
+
+    explicit Private(int limit)
+        : readLimit{limit > 0 ? limit : TaskScheduler::instance()->laneLimit(TaskScheduler::Lane::IO)}
+    {
+        readLimit = std::max(readLimit, 1);
+    }
+
+    // Runs @p read once a read slot is free. Expects @p lock to be held, and holds it again on return.
+    template <typename Read>
+    auto limited(std::unique_lock<std::mutex>& lock, Read&& read)
+    {
+        changed.wait(lock, [this]() { return activeReads < readLimit; });
+        ++activeReads;
+        ++stats.reads;
+        lock.unlock();
+
+        auto result = read();
+
+        lock.lock();
+        --activeReads;
+        changed.notify_all();
+        return result;
+    }
+
+    // Returns the cached value for @p key, waits for a read of it in progress, or reads it with @p read
+    template <typename Value, typename Read, typename Cost>
+    std::optional<Value> fetch(Store<Value>& store, const QString& key, Read&& read, Cost&& cost)
+    {
+        std::unique_lock lock{mutex};
+
+        if(const Value* cached = store.cache.find(key)) {
+            ++stats.cacheHits;
+            return *cached;
+        }
+
+        if(const auto it = store.pending.find(key); it != store.pending.cend()) {
+            const auto request = it->second;
+            ++stats.shared;
+            changed.wait(lock, [&request]() { return request->done; });
+            return request->value;
+        }
+
+        const auto request = std::make_shared<typename Store<Value>::Pending>();
+        store.pending.emplace(key, request);
+
+        std::optional<Value> value = limited(lock, std::forward<Read>(read));
+
+        request->value = value;
+        request->done  = true;
+        store.pending.erase(key);
+        if(value) {
+            store.cache.insert(key, *value, cost(*value));
+        }
+        changed.notify_all();
+
+        return value;
+    }
+};
+
+TagReadService::TagReadService(int readLimit)
+    : p{std::make_unique<Private>(readLimit)}
+{ }
+
+TagReadService::~TagReadService() = default;
+
+TagReadService& TagReadService::instance()
+{
+    static TagReadService service;
+    return service;
+}
+
+bool TagReadService::readMetaData(Track& track)
+{
+    const auto read = [track]() -> std::optional<Track> {
+        Track readTrack{track};
+        if(Tagging::readMetaData(readTrack)) {
+            return readTrack;
+        }
+        return {};
+    };
+
+    const QString key = track.isInDatabase() ? QString{} : fileKey(track);
+
+    std::optional<Track> result;
+    if(key.isEmpty()) {
+        std::unique_lock lock{p->mutex};
+        result = p->limited(lock, read);
+    }
+    else {
+        result = p->fetch(p->tracks, key, read, [](const Track& readTrack) { return readTrack.memoryUsage(); });
+    }
+
+    if(!result) {
+        return false;
+    }
+
+    track = *result;
+    return true;
+}
+
+QByteArray TagReadService::readCover(const Track& track, Track::Cover cover, const QSize& minimumSize)
+{
+    const auto read = [track, cover, minimumSize]() -> std::optional<QByteArray> {
+        return Tagging::readCover(track, cover, minimumSize);
+    };
+
+    QString key = fileKey(track);
+    if(key.isEmpty()) {
+        std::unique_lock lock{p->mutex};
+        return p->limited(lock, read).value_or(QByteArray{});
+    }
+
+    key += u'\037' + QString::number(static_cast<int>(cover)) + u'\037' + QString::number(minimumSize.width())
+         + u'x' + QString::number(minimumSize.height());
+
+    // Files without a cover are cached too, so they aren't read again for each view asking
+    const auto result = p->fetch(p->covers, key, read, [](const QByteArray& data) {
+        return std::max(static_cast<size_t>(data.size()), sizeof(QByteArray));
+    });
+    return result.value_or(QByteArray{});
+}
+
+QFuture<Track> TagReadService::requestMetaData(const Track& track)
+{
+    auto promise = std::make_shared<QPromise<Track>>();
+    promise->start();
+
+    TaskScheduler::instance()->submit(TaskScheduler::Lane::IO, [this, promise, track]() {
+        Track readTrack{track};
+        readMetaData(readTrack);
+        promise->addResult(readTrack);
+        promise->finish();
+    });
+
+    return promise->future();
+}
+
+QFuture<QByteArray> TagReadService::requestCover(const Track& track, Track::Cover cover, const QSize& minimumSize)
+{
+    auto promise = std::make_shared<QPromise<QByteArray>>();
+    promise->start();
+
+    TaskScheduler::instance()->submit(TaskScheduler::Lane::IO, [this, promise, track, cover, minimumSize]() {
+        promise->addResult(readCover(track, cover, minimumSize));
+        promise->finish();
+    });
+
+    return promise->future();
+}
+
+TagReadService::Stats TagReadService::stats() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->stats;
+}
+
+void TagReadService::clear()
+{
+    const std::scoped_lock lock{p->mutex};
+    p->tracks.cache.clear();
+    p->covers.cache.clear();
+}
+} // namespace Fooyin
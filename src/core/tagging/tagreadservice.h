@@ -0,0 +1,86 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <core/track.h>
+
+#include <QFuture>
+#include <QSize>
+
+#include <cstdint>
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * Reads tags and embedded covers on behalf of everything outside the library scanner, e.g. cover loading,
+ * playlists of files not in the library and plugins.
+ *
+ * Requests for a file already being read wait for that read rather than parsing it again, and recent results
+ * are cached by path and modification time, so a changed file is always read again. Reads from every caller
+ * share one limit, that of the scheduler's I/O lane, however many threads request them.
+ * @note thread-safe.
+ */
+class FYCORE_EXPORT TagReadService
+{
+public:
+    struct Stats
+    {
+        // Files actually parsed
+        uint64_t reads{0};
+        uint64_t cacheHits{0};
+        // Requests answered by a read already in progress
+        uint64_t shared{0};
+    };
+
+    /** Creates a service allowing @p readLimit reads at once, or as many as the I/O lane if 0. */
+    explicit TagReadService(int readLimit = 0);
+    ~TagReadService();
+
+    TagReadService(const TagReadService&)            = delete;
+    TagReadService& operator=(const TagReadService&) = delete;
+
+    /** Returns the service shared by the application. */
+    static TagReadService& instance();
+
+    /*!
+     * Reads the metadata of @p track, as Tagging::readMetaData does, blocking until done.
+     * Only tracks which aren't in the database are cached, as the metadata of the rest is kept there.
+     */
+    bool readMetaData(Track& track);
+    /** Reads the embedded picture of type @p cover, as Tagging::readCover does, blocking until done. */
+    QByteArray readCover(const Track& track, Track::Cover cover = Track::Cover::Front,
+                         const QSize& minimumSize = {});
+
+    /** Queues reading the metadata of @p track on the I/O lane. The future holds the track read. */
+    QFuture<Track> requestMetaData(const Track& track);
+    /** Queues reading an embedded picture on the I/O lane. The future is empty if there's no such picture. */
+    QFuture<QByteArray> requestCover(const Track& track, Track::Cover cover = Track::Cover::Front,
+                                     const QSize& minimumSize = {});
+
+    [[nodiscard]] Stats stats() const;
+    void clear();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
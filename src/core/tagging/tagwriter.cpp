@@ -25,11 +25,13 @@
 #include <utils/helpers.h>
 
 #include <taglib/aifffile.h>
+#include <taglib/attachedpictureframe.h>
 #include <taglib/apefile.h>
 #include <taglib/apetag.h>
 #include <taglib/asffile.h>
 #include <taglib/asftag.h>
 #include <taglib/flacfile.h>
+#include <taglib/flacpicture.h>
 #include <taglib/id3v2framefactory.h>
 #include <taglib/id3v2tag.h>
 #include <taglib/mp4file.h>
@@ -45,10 +47,13 @@
 #include <taglib/vorbisfile.h>
 #include <taglib/wavfile.h>
 #include <taglib/wavpackfile.h>
+#include <taglib/xiphcomment.h>
 
+#include <QDebug>
 #include <QFileInfo>
 #include <QMimeDatabase>
 
+#include <algorithm>
 #include <set>
 
 namespace {
@@ -286,6 +291,30 @@ int ratingToPopm(float rating)
     return 255;
 };
 
+TagLib::ID3v2::PopularimeterFrame* writeID3v2Rating(TagLib::ID3v2::Tag* id3Tags, const Fooyin::Track& track)
+{
+    id3Tags->removeFrames("FMPS_Rating");
+
+    const auto rating = QString::number(track.rating());
+    auto ratingFrame  = std::make_unique<TagLib::ID3v2::TextIdentificationFrame>("FMPS_Rating", TagLib::String::UTF8);
+    ratingFrame->setText(convertString(rating));
+    id3Tags->addFrame(ratingFrame.release());
+
+    TagLib::ID3v2::PopularimeterFrame* frame{nullptr};
+    const TagLib::ID3v2::FrameListMap& map = id3Tags->frameListMap();
+    if(map.contains("POPM")) {
+        frame = dynamic_cast<TagLib::ID3v2::PopularimeterFrame*>(map["POPM"].front());
+    }
+
+    if(!frame) {
+        frame = new TagLib::ID3v2::PopularimeterFrame();
+        id3Tags->addFrame(frame);
+    }
+
+    frame->setRating(ratingToPopm(track.rating()));
+    return frame;
+}
+
 void writeID3v2Tags(TagLib::ID3v2::Tag* id3Tags, const Fooyin::Track& track)
 {
     id3Tags->removeFrames("TRCK");
@@ -306,25 +335,18 @@ void writeID3v2Tags(TagLib::ID3v2::Tag* id3Tags, const Fooyin::Track& track)
         id3Tags->addFrame(discFrame.release());
     }
 
-    id3Tags->removeFrames("FMPS_Rating");
-
-    const auto rating = QString::number(track.rating());
-    auto ratingFrame  = std::make_unique<TagLib::ID3v2::TextIdentificationFrame>("FMPS_Rating", TagLib::String::UTF8);
-    ratingFrame->setText(convertString(rating));
-    id3Tags->addFrame(ratingFrame.release());
+    writeID3v2Rating(id3Tags, track);
+}
 
-    TagLib::ID3v2::PopularimeterFrame* frame{nullptr};
-    const TagLib::ID3v2::FrameListMap& map = id3Tags->frameListMap();
-    if(map.contains("POPM")) {
-        frame = dynamic_cast<TagLib::ID3v2::PopularimeterFrame*>(map["POPM"].front());
+void writeApeRating(TagLib::APE::Tag* apeTags, const Fooyin::Track& track)
+{
+    if(track.rating() > 0) {
+        apeTags->setItem("FMPS_Rating",
+                         TagLib::APE::Item{"FMPS_Rating", convertString(QString::number(track.rating()))});
     }
-
-    if(!frame) {
-        frame = new TagLib::ID3v2::PopularimeterFrame();
-        id3Tags->addFrame(frame);
+    else {
+        apeTags->removeItem("FMPS_Rating");
     }
-
-    frame->setRating(ratingToPopm(track.rating()));
 }
 
 void writeApeTags(TagLib::APE::Tag* apeTags, const Fooyin::Track& track)
@@ -345,13 +367,7 @@ void writeApeTags(TagLib::APE::Tag* apeTags, const Fooyin::Track& track)
         apeTags->addValue("DISC", convertString(discNumber), true);
     }
 
-    if(track.rating() > 0) {
-        apeTags->setItem("FMPS_Rating",
-                         TagLib::APE::Item{"FMPS_Rating", convertString(QString::number(track.rating()))});
-    }
-    else {
-        apeTags->removeItem("FMPS_Rating");
-    }
+    writeApeRating(apeTags, track);
 }
 
 TagLib::String prefixMp4FreeFormName(const QString& name, const TagLib::MP4::ItemMap& items)
@@ -384,6 +400,11 @@ TagLib::String prefixMp4FreeFormName(const QString& name, const TagLib::MP4::Ite
     return freeFormName;
 }
 
+void writeMp4Rating(TagLib::MP4::Tag* mp4Tags, const Fooyin::Track& track)
+{
+    mp4Tags->setItem(Fooyin::Mp4::RatingAlt, TagLib::StringList(convertString(QString::number(track.rating()))));
+}
+
 void writeMp4Tags(TagLib::MP4::Tag* mp4Tags, const Fooyin::Track& track)
 {
     const int trackNumber = track.trackNumber();
@@ -407,7 +428,7 @@ void writeMp4Tags(TagLib::MP4::Tag* mp4Tags, const Fooyin::Track& track)
     }
 
     mp4Tags->setItem(Fooyin::Mp4::PerformerAlt, TagLib::StringList{convertString(track.performer())});
-    mp4Tags->setItem(Fooyin::Mp4::RatingAlt, TagLib::StringList(convertString(QString::number(track.rating()))));
+    writeMp4Rating(mp4Tags, track);
 
     static const std::set<QString> baseMp4Tags
         = {QString::fromLatin1(Fooyin::Tag::Title),       QString::fromLatin1(Fooyin::Tag::Artist),
@@ -438,6 +459,16 @@ void writeMp4Tags(TagLib::MP4::Tag* mp4Tags, const Fooyin::Track& track)
     }
 }
 
+void writeXiphRating(TagLib::Ogg::XiphComment* xiphTags, const Fooyin::Track& track)
+{
+    if(track.rating() <= 0) {
+        xiphTags->removeFields("FMPS_RATING");
+    }
+    else {
+        xiphTags->addField("FMPS_RATING", convertString(QString::number(track.rating())), true);
+    }
+}
+
 void writeXiphComment(TagLib::Ogg::XiphComment* xiphTags, const Fooyin::Track& track)
 {
     if(track.trackNumber() < 0) {
@@ -468,39 +499,170 @@ void writeXiphComment(TagLib::Ogg::XiphComment* xiphTags, const Fooyin::Track& t
         xiphTags->addField(Fooyin::Tag::DiscTotal, TagLib::String::number(track.discTotal()), true);
     }
 
-    if(track.rating() <= 0) {
-        xiphTags->removeFields("FMPS_RATING");
-    }
-    else {
-        xiphTags->addField("FMPS_RATING", convertString(QString::number(track.rating())), true);
-    }
+    writeXiphRating(xiphTags, track);
+}
+
+void writeAsfRating(TagLib::ASF::Tag* asfTags, const Fooyin::Track& track)
+{
+    // Replaces rather than adds, so repeated writes don't pile up ratings
+    asfTags->setAttribute("FMPS/Rating", convertString(QString::number(track.rating())));
 }
 
 void writeAsfTags(TagLib::ASF::Tag* asfTags, const Fooyin::Track& track)
 {
     asfTags->setAttribute("WM/TrackNumber", TagLib::String::number(track.trackNumber()));
     asfTags->setAttribute("WM/PartOfSet", TagLib::String::number(track.discNumber()));
-    asfTags->addAttribute("FMPS/Rating", convertString(QString::number(track.rating())));
+    writeAsfRating(asfTags, track);
+}
+
+TagLib::ByteVector toByteVector(const QByteArray& data)
+{
+    return {data.constData(), static_cast<unsigned int>(data.size())};
+}
+
+QString imageMimeType(const QByteArray& image)
+{
+    return QMimeDatabase{}.mimeTypeForData(image).name();
+}
+
+void writeID3v2Cover(TagLib::ID3v2::Tag* id3Tags, const QByteArray& image)
+{
+    using PictureFrame = TagLib::ID3v2::AttachedPictureFrame;
+
+    // A copy, as removing a frame changes the tag's own list
+    const TagLib::ID3v2::FrameList frames = id3Tags->frameListMap()["APIC"];
+    for(auto* frame : frames) {
+        if(static_cast<PictureFrame*>(frame)->type() == PictureFrame::FrontCover) {
+            id3Tags->removeFrame(frame);
+        }
+    }
+
+    auto frame = std::make_unique<PictureFrame>();
+    frame->setType(PictureFrame::FrontCover);
+    frame->setMimeType(convertString(imageMimeType(image)));
+    frame->setPicture(toByteVector(image));
+    id3Tags->addFrame(frame.release());
+}
+
+std::unique_ptr<TagLib::FLAC::Picture> flacCover(const QByteArray& image)
+{
+    auto picture = std::make_unique<TagLib::FLAC::Picture>();
+    picture->setType(TagLib::FLAC::Picture::FrontCover);
+    picture->setMimeType(convertString(imageMimeType(image)));
+    picture->setData(toByteVector(image));
+    return picture;
+}
+
+void writeFlacCover(TagLib::FLAC::File& file, const QByteArray& image)
+{
+    const auto pictures = file.pictureList();
+    for(auto* picture : pictures) {
+        if(picture->type() == TagLib::FLAC::Picture::FrontCover) {
+            file.removePicture(picture, true);
+        }
+    }
+    file.addPicture(flacCover(image).release());
+}
+
+void writeXiphCover(TagLib::Ogg::XiphComment* xiphTags, const QByteArray& image)
+{
+    const auto pictures = xiphTags->pictureList();
+    for(auto* picture : pictures) {
+        if(picture->type() == TagLib::FLAC::Picture::FrontCover) {
+            xiphTags->removePicture(picture, true);
+        }
+    }
+    xiphTags->addPicture(flacCover(image).release());
+}
+
+void writeMp4Cover(TagLib::MP4::Tag* mp4Tags, const QByteArray& image)
+{
+    // MP4 only tells JPEG and PNG apart, and doesn't keep the type of a picture, so the cover replaces them all
+    const auto format = imageMimeType(image) == u"image/png" ? TagLib::MP4::CoverArt::PNG : TagLib::MP4::CoverArt::JPEG;
+
+    TagLib::MP4::CoverArtList covers;
+    covers.append(TagLib::MP4::CoverArt{format, toByteVector(image)});
+    mp4Tags->setItem(Fooyin::Mp4::Cover, covers);
+}
+
+void reserveID3v2Padding(TagLib::ID3v2::Tag* id3Tags, int padding)
+{
+    if(padding <= 0) {
+        return;
+    }
+
+    TagLib::ID3v2::Header* header = id3Tags->header();
+
+    // TagLib renders a tag into the space of the original when it fits, in which case it's written in place
+    if(header->tagSize() > 0 && id3Tags->render().size() <= header->completeTagSize()) {
+        return;
+    }
+
+    unsigned int framesSize{0};
+    for(const auto* frame : id3Tags->frameList()) {
+        framesSize += frame->render().size();
+    }
+
+    // The padding of a rendered tag is whatever is left of the tag size after its frames.
+    // Note TagLib falls back to its own minimum if this is more than 1% of the file (or 1MB).
+    header->setTagSize(framesSize + static_cast<unsigned int>(padding));
 }
 } // namespace
 
 namespace Fooyin::Tagging {
 bool writeMetaData(Track& track)
 {
+    return writeMetaData(track, {}) != WriteResult::Failed;
+}
+
+WriteResult writeMetaData(Track& track, const WriteOptions& options)
+{
+    // The tags of the file are shared by every track of its CUE sheet
+    if(track.hasCue()) {
+        qDebug() << "Skipping tag writing for CUE sheet track:" << track.uniqueFilepath();
+        return WriteResult::Failed;
+    }
+    // Archives are never rewritten
+    if(track.isInArchive()) {
+        qDebug() << "Skipping tag writing for archived track:" << track.filepath();
+        return WriteResult::Failed;
+    }
+
     const QString filepath = track.filepath();
 
     TagLib::FileStream stream(filepath.toUtf8().constData(), false);
 
     if(!stream.isOpen() || stream.readOnly()) {
-        return false;
+        return WriteResult::Failed;
     }
 
-    const auto writeProperties = [&track](TagLib::File& file, bool skipExtra = false) {
+    const auto originalLength = stream.length();
+    const bool allTags        = !options.statisticsOnly;
+    const bool writeCover     = allTags && !options.frontCover.isEmpty();
+    bool saved{true};
+
+    const auto writeProperties = [&track, allTags](TagLib::File& file, bool skipExtra = false) {
+        if(!allTags) {
+            return;
+        }
         auto savedProperties = file.properties();
         writeGenericProperties(savedProperties, track, skipExtra);
         file.setProperties(savedProperties);
     };
 
+    const auto writeID3v2 = [&track, &options, allTags, writeCover](TagLib::ID3v2::Tag* id3Tags) {
+        if(allTags) {
+            writeID3v2Tags(id3Tags, track);
+        }
+        else {
+            writeID3v2Rating(id3Tags, track)->setCounter(static_cast<unsigned int>(std::max(0, track.playCount())));
+        }
+        if(writeCover) {
+            writeID3v2Cover(id3Tags, options.frontCover);
+        }
+        reserveID3v2Padding(id3Tags, options.padding);
+    };
+
     const QMimeDatabase mimeDb;
     QString mimeType = mimeDb.mimeTypeForFile(filepath).name();
     const auto style = TagLib::AudioProperties::Average;
@@ -518,10 +680,11 @@ bool writeMetaData(Track& track)
 #endif
         if(file.isValid()) {
             writeProperties(file);
-            if(file.hasID3v2Tag()) {
-                writeID3v2Tags(file.ID3v2Tag(), track);
+            // A cover needs a tag to go in, which files fresh from an encoder may not have yet
+            if(file.hasID3v2Tag() || writeCover) {
+                writeID3v2(file.ID3v2Tag(true));
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/x-aiff") || mimeType == QStringLiteral("audio/x-aifc")) {
@@ -529,9 +692,9 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.hasID3v2Tag()) {
-                writeID3v2Tags(file.tag(), track);
+                writeID3v2(file.tag());
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/vnd.wave") || mimeType == QStringLiteral("audio/wav")
@@ -540,9 +703,9 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.hasID3v2Tag()) {
-                writeID3v2Tags(file.ID3v2Tag(), track);
+                writeID3v2(file.ID3v2Tag());
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/x-musepack")) {
@@ -550,9 +713,14 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.hasAPETag()) {
-                writeApeTags(file.APETag(), track);
+                if(allTags) {
+                    writeApeTags(file.APETag(), track);
+                }
+                else {
+                    writeApeRating(file.APETag(), track);
+                }
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/x-ape")) {
@@ -560,9 +728,14 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.hasAPETag()) {
-                writeApeTags(file.APETag(), track);
+                if(allTags) {
+                    writeApeTags(file.APETag(), track);
+                }
+                else {
+                    writeApeRating(file.APETag(), track);
+                }
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/x-wavpack")) {
@@ -570,9 +743,14 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.hasAPETag()) {
-                writeApeTags(file.APETag(), track);
+                if(allTags) {
+                    writeApeTags(file.APETag(), track);
+                }
+                else {
+                    writeApeRating(file.APETag(), track);
+                }
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/mp4")) {
@@ -580,9 +758,17 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file, true);
             if(file.hasMP4Tag()) {
-                writeMp4Tags(file.tag(), track);
+                if(allTags) {
+                    writeMp4Tags(file.tag(), track);
+                }
+                else {
+                    writeMp4Rating(file.tag(), track);
+                }
+            }
+            if(writeCover) {
+                writeMp4Cover(file.tag(), options.frontCover);
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/flac")) {
@@ -594,9 +780,17 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.hasXiphComment()) {
-                writeXiphComment(file.xiphComment(), track);
+                if(allTags) {
+                    writeXiphComment(file.xiphComment(), track);
+                }
+                else {
+                    writeXiphRating(file.xiphComment(), track);
+                }
             }
-            file.save();
+            if(writeCover) {
+                writeFlacCover(file, options.frontCover);
+            }
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/ogg") || mimeType == QStringLiteral("audio/x-vorbis+ogg")) {
@@ -604,17 +798,33 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.tag()) {
-                writeXiphComment(file.tag(), track);
+                if(allTags) {
+                    writeXiphComment(file.tag(), track);
+                }
+                else {
+                    writeXiphRating(file.tag(), track);
+                }
+                if(writeCover) {
+                    writeXiphCover(file.tag(), options.frontCover);
+                }
             }
-            file.save();
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/opus") || mimeType == QStringLiteral("audio/x-opus+ogg")) {
         TagLib::Ogg::Opus::File file(&stream, false);
         if(file.isValid()) {
             writeProperties(file);
-            writeXiphComment(file.tag(), track);
-            file.save();
+            if(allTags) {
+                writeXiphComment(file.tag(), track);
+            }
+            else {
+                writeXiphRating(file.tag(), track);
+            }
+            if(writeCover) {
+                writeXiphCover(file.tag(), options.frontCover);
+            }
+            saved = file.save();
         }
     }
     else if(mimeType == QStringLiteral("audio/x-ms-wma")) {
@@ -622,15 +832,27 @@ bool writeMetaData(Track& track)
         if(file.isValid()) {
             writeProperties(file);
             if(file.tag()) {
-                writeAsfTags(file.tag(), track);
+                if(allTags) {
+                    writeAsfTags(file.tag(), track);
+                }
+                else {
+                    writeAsfRating(file.tag(), track);
+                }
             }
-            file.save();
+            saved = file.save();
         }
     }
 
+    if(!saved) {
+        qWarning() << "[TagWriter] Unable to save tags to" << filepath;
+        return WriteResult::Failed;
+    }
+
     const QDateTime modifiedTime = QFileInfo{filepath}.lastModified();
     track.setModifiedTime(modifiedTime.isValid() ? modifiedTime.toMSecsSinceEpoch() : 0);
 
-    return true;
+    // A tag is only written in place if it fits in the space of the old one, so a change in size means
+    // everything after it was moved
+    return stream.length() == originalLength ? WriteResult::InPlace : WriteResult::Rewritten;
 }
 } // namespace Fooyin::Tagging
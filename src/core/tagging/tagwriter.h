@@ -23,8 +23,41 @@
 
 #include <core/trackfwd.h>
 
+#include <QByteArray>
+
+#include <cstdint>
 #include <memory>
 
 namespace Fooyin::Tagging {
+// Padding reserved after a tag once it has outgrown its space, so later edits can be written in place
+constexpr int DefaultTagPadding = 8192;
+
+/** How a tag write was applied to a file. */
+enum class WriteResult : uint8_t
+{
+    Failed,
+    // Only the tags were written to the file
+    InPlace,
+    // The tags didn't fit in the space available, so the audio data following them was moved too
+    Rewritten,
+};
+
+struct WriteOptions
+{
+    // Only write the rating and playcount (FMPS_Rating, POPM etc), leaving other tags as they are
+    bool statisticsOnly{false};
+    // Padding reserved when the tags have to be rewritten (ID3v2 only, other formats use TagLib's default)
+    int padding{DefaultTagPadding};
+    // Image embedded as the front cover, replacing any existing one (ID3v2, FLAC, Ogg and MP4 only)
+    QByteArray frontCover;
+};
+
+/** Writes all metadata of @p track to its file. Returns @c false on failure. */
 FYCORE_EXPORT bool writeMetaData(Track& track);
+/*!
+ * Writes the metadata of @p track to its file as set by @p options.
+ * Tags which fit in the space of the existing ones and their padding are written in place;
+ * otherwise the file is rewritten, reserving @c options.padding for next time.
+ */
+FYCORE_EXPORT WriteResult writeMetaData(Track& track, const WriteOptions& options);
 } // namespace Fooyin::Tagging
@@ -0,0 +1,93 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threadpriority.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+// Kept low so audio servers (which use much higher values) are never held up by us
+constexpr auto RealtimePriority = 10;
+constexpr auto RealtimeNice     = -10;
+constexpr auto BackgroundNice   = 10;
+
+namespace {
+bool setNice([[maybe_unused]] int nice)
+{
+#if defined(__linux__)
+    // Nice values apply to individual threads on Linux
+    const auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    return ::setpriority(PRIO_PROCESS, tid, nice) == 0;
+#else
+    return false;
+#endif
+}
+
+bool setRealtime()
+{
+    int policy = SCHED_FIFO;
+#if defined(SCHED_RESET_ON_FORK)
+    // Don't pass the priority on to processes we spawn
+    policy |= SCHED_RESET_ON_FORK;
+#endif
+
+    sched_param param{};
+    param.sched_priority
+        = std::clamp(RealtimePriority, ::sched_get_priority_min(SCHED_FIFO), ::sched_get_priority_max(SCHED_FIFO));
+
+    if(::pthread_setschedparam(::pthread_self(), policy, &param) == 0) {
+        return true;
+    }
+
+    // Unprivileged processes can go as high as their limit allows
+    rlimit limit{};
+    if(::getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur > 0) {
+        param.sched_priority = std::min(param.sched_priority, static_cast<int>(limit.rlim_cur));
+        if(::pthread_setschedparam(::pthread_self(), policy, &param) == 0) {
+            return true;
+        }
+    }
+
+    setNice(RealtimeNice);
+    return false;
+}
+} // namespace
+
+namespace Fooyin {
+bool setCurrentThreadPriority(ThreadPriority priority)
+{
+    if(priority == ThreadPriority::Realtime) {
+        return setRealtime();
+    }
+
+    // Leaving SCHED_FIFO is always permitted
+    const sched_param param{};
+    ::pthread_setschedparam(::pthread_self(), SCHED_OTHER, &param);
+
+    return setNice(priority == ThreadPriority::Background ? BackgroundNice : 0);
+}
+} // namespace Fooyin
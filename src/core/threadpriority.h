@@ -0,0 +1,43 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "fycore_export.h"
+
+#include <cstdint>
+
+namespace Fooyin {
+enum class ThreadPriority : uint8_t
+{
+    // Yields to everything else, e.g. library scanning
+    Background,
+    Normal,
+    // Scheduled ahead of all normal threads, for work which has to finish in time for the output
+    Realtime,
+};
+
+/*!
+ * Sets the scheduling priority of the calling thread.
+ * Realtime uses SCHED_FIFO if the process is allowed to (see RLIMIT_RTPRIO), otherwise it falls
+ * back to a raised nice value if RLIMIT_NICE permits.
+ * @returns true if @p priority was applied in full.
+ */
+FYCORE_EXPORT bool setCurrentThreadPriority(ThreadPriority priority);
+} // namespace Fooyin
@@ -17,65 +17,215 @@
  *
  */
 
+#include "archive/archivereader.h"
 #include "core/constants.h"
 #include <core/track.h>
 
 #include <utils/crypto.h>
+#include <utils/memoryusage.h>
+#include <utils/stringpool.h>
 #include <utils/utils.h>
 
+#include <QDataStream>
 #include <QDir>
 #include <QFileInfo>
 #include <QIODevice>
 
+#include <atomic>
+#include <mutex>
+#include <utility>
+
 constexpr auto MaxStarCount = 5; // TODO: Support 10/half stars
+// Files inside archives are given paths of the form archive://<archive path>|<path in archive>
+constexpr QLatin1String ArchiveScheme{"archive://"};
+constexpr auto ArchiveSeparator = u'|';
 
 namespace Fooyin {
+namespace {
+std::mutex& extraTagsMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+/*!
+ * Extra tags as stored in the database.
+ * Most tracks never have their extra tags looked at, so they are kept serialised until first accessed.
+ * Decoding happens under a lock, as tracks sharing the same data can be read from several threads.
+ */
+class LazyExtraTags
+{
+public:
+    LazyExtraTags() = default;
+
+    LazyExtraTags(const LazyExtraTags& other)
+    {
+        const std::scoped_lock lock{extraTagsMutex()};
+        m_blob    = other.m_blob;
+        m_tags    = other.m_tags;
+        m_pending = other.m_pending.load(std::memory_order_relaxed);
+    }
+
+    LazyExtraTags& operator=(const LazyExtraTags& other)
+    {
+        if(this != &other) {
+            const std::scoped_lock lock{extraTagsMutex()};
+            m_blob    = other.m_blob;
+            m_tags    = other.m_tags;
+            m_pending = other.m_pending.load(std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] const Track::ExtraTags& tags() const
+    {
+        if(m_pending.load(std::memory_order_acquire)) {
+            const std::scoped_lock lock{extraTagsMutex()};
+            if(m_pending.load(std::memory_order_relaxed)) {
+                QDataStream stream(&m_blob, QIODevice::ReadOnly);
+                stream.setVersion(QDataStream::Qt_6_0);
+                stream >> m_tags;
+
+                m_blob.clear();
+                m_pending.store(false, std::memory_order_release);
+            }
+        }
+        return m_tags;
+    }
+
+    // Only called once the owning track has been detached
+    Track::ExtraTags& tags()
+    {
+        static_cast<void>(std::as_const(*this).tags());
+        return m_tags;
+    }
+
+    void store(const QByteArray& blob)
+    {
+        m_blob = blob;
+        m_tags.clear();
+        m_pending.store(true, std::memory_order_release);
+    }
+
+    void clear()
+    {
+        m_blob.clear();
+        m_tags.clear();
+        m_pending.store(false, std::memory_order_release);
+    }
+
+    [[nodiscard]] size_t memoryUsage() const
+    {
+        const std::scoped_lock lock{extraTagsMutex()};
+
+        auto bytes = static_cast<size_t>(m_blob.capacity());
+        for(const auto& [tag, values] : m_tags.asKeyValueRange()) {
+            bytes += MemoryUsage::stringBytes(tag) + MemoryUsage::stringBytes(values);
+        }
+        return bytes;
+    }
+
+    [[nodiscard]] QByteArray serialise() const
+    {
+        if(m_pending.load(std::memory_order_acquire)) {
+            const std::scoped_lock lock{extraTagsMutex()};
+            if(m_pending.load(std::memory_order_relaxed)) {
+                // Still exactly what was read from the database
+                return m_blob;
+            }
+        }
+
+        if(m_tags.empty()) {
+            return {};
+        }
+
+        QByteArray out;
+        QDataStream stream(&out, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+
+        stream << m_tags;
+
+        return out;
+    }
+
+private:
+    mutable QByteArray m_blob;
+    mutable Track::ExtraTags m_tags;
+    mutable std::atomic_bool m_pending{false};
+};
+} // namespace
+
 struct Track::Private : public QSharedData
 {
+    // Scalars first, grouped by size so they pack without padding
     int libraryId{-1};
-    bool enabled{true};
     int id{-1};
-    QString hash;
+    int albumId{-1};
     Type type{0};
+    int trackNumber{-1};
+    int trackTotal{-1};
+    int discNumber{-1};
+    int discTotal{-1};
+    int year{-1};
+    int bitrate{0};
+    int sampleRate{0};
+    int channels{2};
+    int bitDepth{-1};
+
+    // The filename (without extension) and relative path are views into filepath
+    int filenameStart{0};
+    int filenameLength{0};
+    int relativePathStart{-1};
+
+    bool enabled{true};
+    bool metadataWasModified{false};
+
+    uint64_t duration{0};
+    uint64_t offset{0};
+    uint64_t filesize{0};
+    uint64_t addedTime{0};
+    uint64_t modifiedTime{0};
+    uint64_t hash{0};
+
     QString filepath;
+    QString cuePath;
+    // Only set if the relative path is not a suffix of filepath
     QString relativePath;
     QString directory;
-    QString filename;
     QString extension;
     QString title;
-    QStringList artists;
     QString album;
-    QStringList albumArtists;
-    int trackNumber{-1};
-    int trackTotal{-1};
-    int discNumber{-1};
-    int discTotal{-1};
-    QStringList genres;
     QString composer;
     QString performer;
-    uint64_t duration{0};
     QString comment;
     QString date;
-    int year{-1};
-    ExtraTags extraTags;
+    QString sort;
+
+    QStringList artists;
+    QStringList albumArtists;
+    QStringList genres;
     QStringList removedTags;
 
-    uint64_t filesize{0};
-    int bitrate{0};
-    int sampleRate{0};
-    int channels{2};
-    int bitDepth{-1};
+    LazyExtraTags extraTags;
+
+    [[nodiscard]] QString filename() const
+    {
+        return filepath.mid(filenameStart, filenameLength);
+    }
 
+    [[nodiscard]] QString relative() const
+    {
+        return relativePathStart >= 0 ? filepath.mid(relativePathStart) : relativePath;
+    }
+};
+
+// Kept apart from the metadata as they change on every play, so a change only copies these
+struct Track::Stats : public QSharedData
+{
+    int playCount{0};
     float rating{-1};
-    int playcount{0};
-    uint64_t addedTime{0};
-    uint64_t modifiedTime{0};
     uint64_t firstPlayed{0};
     uint64_t lastPlayed{0};
-
-    QString sort;
-
-    bool metadataWasModified{false};
 };
 
 Track::Track()
@@ -84,6 +234,7 @@ Track::Track()
 
 Track::Track(const QString& filepath)
     : p{new Private()}
+    , m_stats{new Stats()}
 {
     setFilePath(filepath);
 }
@@ -98,20 +249,47 @@ bool Track::operator!=(const Track& other) const
     return filepath() != other.filepath() && hash() != other.hash();
 }
 
+bool Track::isSharedWith(const Track& other) const
+{
+    return p.constData() == other.p.constData() && m_stats.constData() == other.m_stats.constData();
+}
+
 Track::~Track()                             = default;
 Track::Track(const Track& other)            = default;
 Track& Track::operator=(const Track& other) = default;
 
-QString Track::generateHash()
+uint64_t Track::generateHash()
+{
+    const QString artists = p->artists.join(u',');
+
+    if(!p->title.isEmpty()) {
+        p->hash = Utils::generateHash64(artists, p->album, p->discNumber, p->trackNumber, p->title);
+    }
+    else if(!p->cuePath.isEmpty()) {
+        // Untitled CUE tracks would otherwise all share the hash of their file
+        p->hash = Utils::generateHash64(artists, p->album, p->discNumber, p->trackNumber, p->directory,
+                                        p->filename(), p->offset);
+    }
+    else {
+        p->hash = Utils::generateHash64(artists, p->album, p->discNumber, p->trackNumber, p->directory,
+                                        p->filename());
+    }
+
+    return p->hash;
+}
+
+QString Track::legacyHash() const
 {
     QString title = p->title;
     if(title.isEmpty()) {
-        title = p->directory + p->filename;
+        title = p->directory + p->filename();
+        if(!p->cuePath.isEmpty()) {
+            title += u'#' + QString::number(p->offset);
+        }
     }
 
-    p->hash = Utils::generateHash(p->artists.join(QStringLiteral(",")), p->album, QString::number(p->discNumber),
-                                  QString::number(p->trackNumber), title);
-    return p->hash;
+    return Utils::generateHash(p->artists.join(QStringLiteral(",")), p->album, QString::number(p->discNumber),
+                               QString::number(p->trackNumber), title);
 }
 
 bool Track::isValid() const
@@ -155,7 +333,12 @@ int Track::id() const
     return p->id;
 }
 
-QString Track::hash() const
+int Track::albumId() const
+{
+    return p->albumId;
+}
+
+uint64_t Track::hash() const
 {
     return p->hash;
 }
@@ -225,19 +408,27 @@ QString Track::filepath() const
     return p->filepath;
 }
 
+QString Track::uniqueFilepath() const
+{
+    if(p->cuePath.isEmpty()) {
+        return p->filepath;
+    }
+    return p->filepath + u'#' + QString::number(p->offset);
+}
+
 QString Track::relativePath() const
 {
-    return p->relativePath;
+    return p->relative();
 }
 
 QString Track::filename() const
 {
-    return p->filename;
+    return p->filename();
 }
 
 QString Track::path() const
 {
-    return QFileInfo{p->filepath}.absolutePath();
+    return QFileInfo{isInArchive() ? archivePath() : p->filepath}.absolutePath();
 }
 
 QString Track::extension() const
@@ -342,6 +533,47 @@ uint64_t Track::duration() const
     return p->duration;
 }
 
+uint64_t Track::offset() const
+{
+    return p->offset;
+}
+
+bool Track::hasCue() const
+{
+    return !p->cuePath.isEmpty();
+}
+
+QString Track::cuePath() const
+{
+    return p->cuePath;
+}
+
+bool Track::isInArchive() const
+{
+    return p->filepath.startsWith(ArchiveScheme);
+}
+
+QString Track::archivePath() const
+{
+    if(!isInArchive()) {
+        return {};
+    }
+
+    const qsizetype start     = ArchiveScheme.size();
+    const qsizetype separator = p->filepath.indexOf(ArchiveSeparator, start);
+    return separator >= 0 ? p->filepath.sliced(start, separator - start) : p->filepath.sliced(start);
+}
+
+QString Track::pathInArchive() const
+{
+    if(!isInArchive()) {
+        return {};
+    }
+
+    const qsizetype separator = p->filepath.indexOf(ArchiveSeparator, ArchiveScheme.size());
+    return separator >= 0 ? p->filepath.sliced(separator + 1) : QString{};
+}
+
 QString Track::comment() const
 {
     return p->comment;
@@ -359,30 +591,27 @@ int Track::year() const
 
 float Track::rating() const
 {
-    return p->rating;
+    return m_stats->rating;
 }
 
 int Track::ratingStars() const
 {
-    return static_cast<int>(std::floor(p->rating * MaxStarCount));
+    return static_cast<int>(std::floor(m_stats->rating * MaxStarCount));
 }
 
 bool Track::hasExtraTag(const QString& tag) const
 {
-    return p->extraTags.contains(tag);
+    return p->extraTags.tags().contains(tag);
 }
 
 QStringList Track::extraTag(const QString& tag) const
 {
-    if(p->extraTags.contains(tag)) {
-        return p->extraTags.value(tag);
-    }
-    return {};
+    return p->extraTags.tags().value(tag);
 }
 
 Track::ExtraTags Track::extraTags() const
 {
-    return p->extraTags;
+    return p->extraTags.tags();
 }
 
 QStringList Track::removedTags() const
@@ -392,17 +621,7 @@ QStringList Track::removedTags() const
 
 QByteArray Track::serialiseExtrasTags() const
 {
-    if(p->extraTags.empty()) {
-        return {};
-    }
-
-    QByteArray out;
-    QDataStream stream(&out, QIODevice::WriteOnly);
-    stream.setVersion(QDataStream::Qt_6_0);
-
-    stream << p->extraTags;
-
-    return out;
+    return p->extraTags.serialise();
 }
 
 uint64_t Track::fileSize() const
@@ -432,7 +651,7 @@ int Track::bitDepth() const
 
 int Track::playCount() const
 {
-    return p->playcount;
+    return m_stats->playCount;
 }
 
 uint64_t Track::addedTime() const
@@ -452,12 +671,12 @@ QString Track::lastModified() const
 
 uint64_t Track::firstPlayed() const
 {
-    return p->firstPlayed;
+    return m_stats->firstPlayed;
 }
 
 uint64_t Track::lastPlayed() const
 {
-    return p->lastPlayed;
+    return m_stats->lastPlayed;
 }
 
 QString Track::sort() const
@@ -465,11 +684,33 @@ QString Track::sort() const
     return p->sort;
 }
 
+size_t Track::memoryUsage() const
+{
+    using MemoryUsage::stringBytes;
+
+    // Interned lists share their strings, but each track has its own list of them
+    const auto listBytes = [](const QStringList& list) {
+        return static_cast<size_t>(list.capacity()) * sizeof(QString);
+    };
+
+    return sizeof(Private) + sizeof(Stats) + stringBytes(p->filepath) + stringBytes(p->cuePath)
+         + stringBytes(p->relativePath) + stringBytes(p->title) + stringBytes(p->comment) + stringBytes(p->sort)
+         + stringBytes(p->removedTags)
+         + listBytes(p->artists) + listBytes(p->albumArtists) + listBytes(p->genres) + p->extraTags.memoryUsage();
+}
+
 void Track::setLibraryId(int id)
 {
     p->libraryId = id;
 }
 
+void Track::setAlbumId(int id)
+{
+    if(p.constData()->albumId != id) {
+        p->albumId = id;
+    }
+}
+
 void Track::setIsEnabled(bool enabled)
 {
     p->enabled = enabled;
@@ -480,7 +721,7 @@ void Track::setId(int id)
     p->id = id;
 }
 
-void Track::setHash(const QString& hash)
+void Track::setHash(uint64_t hash)
 {
     p->hash = hash;
 }
@@ -492,26 +733,48 @@ void Track::setType(Type type)
 
 void Track::setFilePath(const QString& path)
 {
+    // The relative path may currently point into the old filepath
+    const QString relativePath = p->relative();
+
     p->filepath = path;
+    // The directory stands in for the album name in albumHash
+    p->albumId = -1;
 
     if(!path.isEmpty()) {
-        const QFileInfo fileInfo{path};
-        p->filename  = fileInfo.completeBaseName();
-        p->extension = fileInfo.suffix();
-        p->directory = fileInfo.dir().dirName();
+        const auto nameStart = static_cast<int>(path.lastIndexOf(u'/') + 1);
+        const auto dot       = static_cast<int>(path.lastIndexOf(u'.'));
+        const bool hasSuffix = dot >= nameStart;
+
+        p->filenameStart  = nameStart;
+        p->filenameLength = (hasSuffix ? dot : static_cast<int>(path.size())) - nameStart;
+        p->extension      = StringPool::intern(hasSuffix ? path.mid(dot + 1) : QString{});
+        p->directory      = StringPool::intern(QFileInfo{isInArchive() ? archivePath() : path}.dir().dirName());
+    }
+    else {
+        p->filenameStart  = 0;
+        p->filenameLength = 0;
     }
+
+    setRelativePath(relativePath);
 }
 
 void Track::setRelativePath(const QString& path)
 {
-    p->relativePath = path;
+    if(!path.isEmpty() && p->filepath.endsWith(path)) {
+        p->relativePathStart = static_cast<int>(p->filepath.size() - path.size());
+        p->relativePath.clear();
+    }
+    else {
+        p->relativePathStart = -1;
+        p->relativePath      = path;
+    }
 }
 
 void Track::setTitle(const QString& title)
 {
     p->title = title;
 
-    if(!p->hash.isEmpty()) {
+    if(p->hash != 0) {
         generateHash();
     }
 }
@@ -522,19 +785,21 @@ void Track::setArtists(const QStringList& artists)
         p->artists.clear();
     }
     else {
-        p->artists = artists;
+        p->artists = StringPool::intern(artists);
     }
+    p->albumId = -1;
 
-    if(!p->hash.isEmpty()) {
+    if(p->hash != 0) {
         generateHash();
     }
 }
 
 void Track::setAlbum(const QString& title)
 {
-    p->album = title;
+    p->album   = StringPool::intern(title);
+    p->albumId = -1;
 
-    if(!p->hash.isEmpty()) {
+    if(p->hash != 0) {
         generateHash();
     }
 }
@@ -545,15 +810,16 @@ void Track::setAlbumArtists(const QStringList& artists)
         p->albumArtists.clear();
     }
     else {
-        p->albumArtists = artists;
+        p->albumArtists = StringPool::intern(artists);
     }
+    p->albumId = -1;
 }
 
 void Track::setTrackNumber(int number)
 {
     p->trackNumber = number;
 
-    if(!p->hash.isEmpty()) {
+    if(p->hash != 0) {
         generateHash();
     }
 }
@@ -567,7 +833,7 @@ void Track::setDiscNumber(int number)
 {
     p->discNumber = number;
 
-    if(!p->hash.isEmpty()) {
+    if(p->hash != 0) {
         generateHash();
     }
 }
@@ -583,18 +849,18 @@ void Track::setGenres(const QStringList& genres)
         p->genres.clear();
     }
     else {
-        p->genres = genres;
+        p->genres = StringPool::intern(genres);
     }
 }
 
 void Track::setComposer(const QString& composer)
 {
-    p->composer = composer;
+    p->composer = StringPool::intern(composer);
 }
 
 void Track::setPerformer(const QString& performer)
 {
-    p->performer = performer;
+    p->performer = StringPool::intern(performer);
 }
 
 void Track::setDuration(uint64_t duration)
@@ -602,6 +868,16 @@ void Track::setDuration(uint64_t duration)
     p->duration = duration;
 }
 
+void Track::setOffset(uint64_t offset)
+{
+    p->offset = offset;
+}
+
+void Track::setCuePath(const QString& path)
+{
+    p->cuePath = path;
+}
+
 void Track::setComment(const QString& comment)
 {
     p->comment = comment;
@@ -609,7 +885,8 @@ void Track::setComment(const QString& comment)
 
 void Track::setDate(const QString& date)
 {
-    p->date = date;
+    p->date    = StringPool::intern(date);
+    p->albumId = -1;
 
     const QStringList dateParts = date.split(QChar::fromLatin1('-'));
     if(dateParts.empty()) {
@@ -629,17 +906,18 @@ void Track::setYear(int year)
 
 void Track::setRating(float rating)
 {
-    if(rating > 0 && rating < 1.0) {
-        p->rating = rating;
-    }
-    else {
-        p->rating = -1;
+    const float value = rating > 0 && rating < 1.0 ? rating : -1;
+    if(m_stats.constData()->rating != value) {
+        m_stats->rating = value;
     }
 }
 
 void Track::setRatingStars(int rating)
 {
-    p->rating = static_cast<float>(rating) / MaxStarCount;
+    const float value = static_cast<float>(rating) / MaxStarCount;
+    if(m_stats.constData()->rating != value) {
+        m_stats->rating = value;
+    }
 }
 
 QString Track::metaValue(const QString& name) const
@@ -684,14 +962,15 @@ void Track::addExtraTag(const QString& tag, const QString& value)
     if(tag.isEmpty() || value.isEmpty()) {
         return;
     }
-    p->extraTags[tag].push_back(value);
+    p->extraTags.tags()[tag].push_back(value);
 }
 
 void Track::removeExtraTag(const QString& tag)
 {
-    if(p->extraTags.contains(tag)) {
+    auto& extraTags = p->extraTags.tags();
+    if(extraTags.contains(tag)) {
         p->removedTags.append(tag);
-        p->extraTags.remove(tag);
+        extraTags.remove(tag);
     }
 }
 
@@ -705,7 +984,7 @@ void Track::replaceExtraTag(const QString& tag, const QString& value)
         removeExtraTag(tag);
     }
     else {
-        p->extraTags[tag] = {value};
+        p->extraTags.tags()[tag] = {value};
     }
 }
 
@@ -720,11 +999,7 @@ void Track::storeExtraTags(const QByteArray& tags)
         return;
     }
 
-    QByteArray in{tags};
-    QDataStream stream(&in, QIODevice::ReadOnly);
-    stream.setVersion(QDataStream::Qt_6_0);
-
-    stream >> p->extraTags;
+    p->extraTags.store(tags);
 }
 
 void Track::setFileSize(uint64_t fileSize)
@@ -754,7 +1029,10 @@ void Track::setBitDepth(int depth)
 
 void Track::setPlayCount(int count)
 {
-    p->playcount = count;
+    // Copies only detach once a value actually changes
+    if(m_stats.constData()->playCount != count) {
+        m_stats->playCount = count;
+    }
 }
 
 void Track::setAddedTime(uint64_t time)
@@ -772,15 +1050,15 @@ void Track::setModifiedTime(uint64_t time)
 
 void Track::setFirstPlayed(uint64_t time)
 {
-    if(p->firstPlayed == 0) {
-        p->firstPlayed = time;
+    if(m_stats.constData()->firstPlayed == 0 && time != 0) {
+        m_stats->firstPlayed = time;
     }
 }
 
 void Track::setLastPlayed(uint64_t time)
 {
-    if(time > p->lastPlayed) {
-        p->lastPlayed = time;
+    if(time > m_stats.constData()->lastPlayed) {
+        m_stats->lastPlayed = time;
     }
 }
 
@@ -794,13 +1072,23 @@ void Track::clearWasModified()
     p->metadataWasModified = false;
 }
 
+QString Track::archiveFilepath(const QString& archivePath, const QString& entryPath)
+{
+    return ArchiveScheme + archivePath + ArchiveSeparator + entryPath;
+}
+
 QStringList Track::supportedFileExtensions()
 {
     static const QStringList supportedExtensions
-        = {QStringLiteral("*.mp3"), QStringLiteral("*.ogg"),  QStringLiteral("*.opus"), QStringLiteral("*.oga"),
-           QStringLiteral("*.m4a"), QStringLiteral("*.wav"),  QStringLiteral("*.flac"), QStringLiteral("*.wma"),
-           QStringLiteral("*.mpc"), QStringLiteral("*.aiff"), QStringLiteral("*.ape"),  QStringLiteral("*.webm"),
-           QStringLiteral("*.mp4")};
+        = QStringList{QStringLiteral("*.mp3"),  QStringLiteral("*.ogg"),  QStringLiteral("*.opus"),
+                      QStringLiteral("*.oga"),  QStringLiteral("*.m4a"),  QStringLiteral("*.wav"),
+                      QStringLiteral("*.flac"), QStringLiteral("*.wma"),  QStringLiteral("*.mpc"),
+                      QStringLiteral("*.aiff"), QStringLiteral("*.ape"),  QStringLiteral("*.webm"),
+                      QStringLiteral("*.mp4"),  QStringLiteral("*.cue")}
+        + ArchiveReader::supportedExtensions();
+    return supportedExtensions;
+}
+        + ArchiveReader::supportedExtensions();
     return supportedExtensions;
 }
 
@@ -131,8 +131,8 @@ struct PlaylistControl::Private
     {
         Playlist::PlayModes mode = playerController->playMode();
 
-        if(mode & Playlist::ShuffleTracks) {
-            mode &= ~Playlist::ShuffleTracks;
+        if(mode & (Playlist::ShuffleTracks | Playlist::ShuffleAlbums)) {
+            mode &= ~(Playlist::ShuffleTracks | Playlist::ShuffleAlbums);
         }
         else {
             mode |= Playlist::ShuffleTracks;
@@ -151,7 +151,7 @@ struct PlaylistControl::Private
             repeat->setIcon(Utils::iconFromTheme(Constants::Icons::Repeat));
         }
 
-        if(mode & Playlist::ShuffleTracks) {
+        if(mode & (Playlist::ShuffleTracks | Playlist::ShuffleAlbums)) {
             shuffle->setIcon(
                 Utils::changePixmapColour(Utils::iconFromTheme(Constants::Icons::Shuffle).pixmap({128, 128}),
                                           self->palette().highlight().color()));
@@ -37,8 +37,9 @@
 #include <QSlider>
 #include <QStyleOptionSlider>
 
-constexpr auto SeekDelta    = 5000;
-constexpr auto ToolTipDelay = 5;
+constexpr auto SeekDelta        = 5000;
+constexpr auto ToolTipDelay     = 5;
+constexpr auto PositionInterval = 50;
 
 namespace Fooyin {
 class TrackSlider : public QSlider
@@ -63,6 +64,7 @@ signals:
     void seekBackward();
 
 protected:
+    void showEvent(QShowEvent* event) override;
     void mousePressEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
@@ -70,6 +72,7 @@ protected:
     void wheelEvent(QWheelEvent* event) override;
 
 private:
+    void syncValue();
     void updateSeekPosition(const QPointF& pos);
     void updateToolTip();
 
@@ -84,6 +87,19 @@ TrackSlider::TrackSlider(QWidget* parent)
     : QSlider{Qt::Horizontal, parent}
 { }
 
+int TrackSlider::positionFromValue(uint64_t value) const
+{
+    QStyleOptionSlider opt;
+    initStyleOption(&opt);
+
+    const QRect groove = style()->subControlRect(QStyle::CC_Slider, &opt, QStyle::SC_SliderGroove, this);
+    const QRect handle = style()->subControlRect(QStyle::CC_Slider, &opt, QStyle::SC_SliderHandle, this);
+
+    const int span = groove.right() - handle.width() - groove.x() + 1;
+
+    return QStyle::sliderPositionFromValue(0, maximum(), static_cast<int>(value), span, opt.upsideDown);
+}
+
 uint64_t TrackSlider::valueFromPosition(int pos)
 {
     QStyleOptionSlider opt;
@@ -110,7 +126,7 @@ void TrackSlider::updateCurrentValue(uint64_t value)
     m_currentPos = value;
 
     if(!isSeeking()) {
-        setValue(static_cast<int>(value));
+        syncValue();
     }
 
     if(m_toolTip) {
@@ -132,6 +148,29 @@ void TrackSlider::stopSeeking()
     m_seekPos = {};
 }
 
+void TrackSlider::showEvent(QShowEvent* event)
+{
+    QSlider::showEvent(event);
+
+    if(!isSeeking()) {
+        syncValue();
+    }
+}
+
+void TrackSlider::syncValue()
+{
+    // Nothing is drawn while hidden or minimised, so catch up in showEvent instead
+    if(!isVisible() || window()->isMinimized()) {
+        return;
+    }
+
+    // QSlider repaints in full on every change, so only move it once the handle would move
+    const auto current = static_cast<uint64_t>(value());
+    if(current != m_currentPos && positionFromValue(current) != positionFromValue(m_currentPos)) {
+        setValue(static_cast<int>(m_currentPos));
+    }
+}
+
 void TrackSlider::mousePressEvent(QMouseEvent* event)
 {
     if(m_max == 0) {
@@ -398,6 +437,20 @@ void SeekBar::loadLayoutData(const QJsonObject& layout)
     }
 }
 
+void SeekBar::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+
+    p->playerController->requestPositionUpdates(this, PositionInterval);
+}
+
+void SeekBar::hideEvent(QHideEvent* event)
+{
+    FyWidget::hideEvent(event);
+
+    p->playerController->releasePositionUpdates(this);
+}
+
 void SeekBar::contextMenuEvent(QContextMenuEvent* event)
 {
     if(p->slider->isSeeking()) {
@@ -39,6 +39,8 @@ public:
     void loadLayoutData(const QJsonObject& layout) override;
 
 protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
     void contextMenuEvent(QContextMenuEvent* event) override;
 
 private:
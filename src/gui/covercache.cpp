@@ -0,0 +1,260 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "covercache.h"
+
+#include <gui/guipaths.h>
+#include <utils/lrucache.h>
+#include <utils/packfile.h>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+#include <atomic>
+
+constexpr auto PackName           = "thumbnails.pack";
+constexpr auto ThumbnailQuality   = 85;
+constexpr size_t DefaultBudget    = 64 * 1024 * 1024;
+// Share of the memory budget given to thumbnails, as there are usually far more of them on screen
+constexpr size_t ThumbnailShare   = 3;
+constexpr size_t ShareDivisor     = 4;
+// Rough cost of remembering a missing cover
+constexpr size_t MissingCoverCost = 64;
+
+namespace {
+size_t pixmapCost(const QPixmap& cover)
+{
+    if(cover.isNull()) {
+        return MissingCoverCost;
+    }
+    return static_cast<size_t>(cover.width()) * static_cast<size_t>(cover.height())
+         * static_cast<size_t>(cover.depth()) / 8;
+}
+
+QString legacyThumbnailPath(const QString& key)
+{
+    return Fooyin::Gui::coverPath() + key + QStringLiteral(".jpg");
+}
+} // namespace
+
+namespace Fooyin {
+struct CoverCache::Private
+{
+    using CoverBucket = LruCache<QString, QPixmap>;
+
+    CoverBucket fullCovers;
+    CoverBucket thumbnails;
+
+    PackFile pack;
+    std::atomic<uint64_t> diskHits{0};
+    std::atomic<uint64_t> diskMisses{0};
+
+    Private()
+        : pack{Gui::coverPath() + QString::fromLatin1(PackName)}
+    {
+        setBudget(DefaultBudget);
+
+        // Pixmaps can't outlive the application
+        if(auto* app = QCoreApplication::instance()) {
+            QObject::connect(app, &QCoreApplication::aboutToQuit, app, [this]() {
+                fullCovers.clear();
+                thumbnails.clear();
+            });
+        }
+    }
+
+    void setBudget(size_t bytes)
+    {
+        const size_t thumbBudget = bytes / ShareDivisor * ThumbnailShare;
+        thumbnails.setBudget(thumbBudget);
+        fullCovers.setBudget(bytes - thumbBudget);
+    }
+
+    CoverBucket& bucket(CoverCache::Bucket type)
+    {
+        return type == CoverCache::Bucket::Thumbnail ? thumbnails : fullCovers;
+    }
+
+    [[nodiscard]] const CoverBucket& bucket(CoverCache::Bucket type) const
+    {
+        return type == CoverCache::Bucket::Thumbnail ? thumbnails : fullCovers;
+    }
+
+    bool openPack()
+    {
+        return pack.isOpen() || pack.open();
+    }
+
+    QByteArray readLegacyThumbnail(const QString& key)
+    {
+        // Thumbnails used to be stored as individual files; move them into the pack as they're requested
+        QFile file{legacyThumbnailPath(key)};
+        if(!file.exists() || !file.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+
+        const QByteArray data = file.readAll();
+        file.close();
+
+        if(!data.isEmpty() && pack.insert(key, data)) {
+            file.remove();
+        }
+
+        return data;
+    }
+};
+
+CoverCache& CoverCache::instance()
+{
+    static CoverCache cache;
+    return cache;
+}
+
+CoverCache::CoverCache()
+    : p{std::make_unique<Private>()}
+{ }
+
+CoverCache::~CoverCache() = default;
+
+void CoverCache::setMemoryBudget(size_t bytes)
+{
+    p->setBudget(bytes);
+}
+
+bool CoverCache::find(const QString& key, Bucket bucket, QPixmap& cover)
+{
+    if(const QPixmap* cached = p->bucket(bucket).find(key)) {
+        cover = *cached;
+        return true;
+    }
+    return false;
+}
+
+void CoverCache::insert(const QString& key, Bucket bucket, const QPixmap& cover)
+{
+    p->bucket(bucket).insert(key, cover, pixmapCost(cover));
+}
+
+QImage CoverCache::loadThumbnail(const QString& key)
+{
+    if(!p->openPack()) {
+        return {};
+    }
+
+    QByteArray data = p->pack.value(key);
+    if(data.isEmpty()) {
+        data = p->readLegacyThumbnail(key);
+    }
+
+    QImage image;
+    if(!data.isEmpty()) {
+        image.loadFromData(data);
+    }
+
+    if(image.isNull()) {
+        p->diskMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        p->diskHits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return image;
+}
+
+void CoverCache::storeThumbnail(const QString& key, const QImage& image)
+{
+    if(image.isNull() || !p->openPack()) {
+        return;
+    }
+
+    QByteArray data;
+    QBuffer buffer{&data};
+    buffer.open(QIODevice::WriteOnly);
+
+    if(image.save(&buffer, "JPG", ThumbnailQuality)) {
+        p->pack.insert(key, data);
+    }
+}
+
+MemoryUsage::Usage CoverCache::memoryUsage(Bucket bucket) const
+{
+    const auto& covers = p->bucket(bucket);
+    return {.bytes = covers.cost(), .entries = covers.count()};
+}
+
+void CoverCache::trimMemory(Bucket bucket, size_t bytes)
+{
+    p->bucket(bucket).trim(bytes);
+}
+
+void CoverCache::remove(const QString& key)
+{
+    p->fullCovers.remove(key);
+    p->thumbnails.remove(key);
+
+    if(p->openPack()) {
+        p->pack.remove(key);
+    }
+    QFile::remove(legacyThumbnailPath(key));
+}
+
+void CoverCache::clear()
+{
+    p->fullCovers.clear();
+    p->thumbnails.clear();
+
+    if(p->openPack()) {
+        p->pack.clear();
+    }
+
+    const QString packName = QString::fromLatin1(PackName);
+    QDir cache{Gui::coverPath()};
+    const QStringList files = cache.entryList(QDir::Files);
+    for(const QString& file : files) {
+        if(file != packName) {
+            cache.remove(file);
+        }
+    }
+}
+
+CoverProvider::CacheStats CoverCache::stats() const
+{
+    CoverProvider::CacheStats stats;
+
+    for(const auto* bucket : {&p->fullCovers, &p->thumbnails}) {
+        const auto bucketStats = bucket->stats();
+        stats.memoryHits += bucketStats.hits;
+        stats.memoryMisses += bucketStats.misses;
+        stats.memoryEvictions += bucketStats.evictions;
+        stats.memoryUsage += bucket->cost();
+        stats.memoryBudget += bucket->budget();
+        stats.memoryEntries += static_cast<int>(bucket->count());
+    }
+
+    stats.diskHits    = p->diskHits.load(std::memory_order_relaxed);
+    stats.diskMisses  = p->diskMisses.load(std::memory_order_relaxed);
+    stats.diskEntries = p->pack.count();
+    stats.diskUsage   = p->pack.size();
+
+    return stats;
+}
+} // namespace Fooyin
@@ -0,0 +1,98 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <gui/coverprovider.h>
+#include <utils/memoryusage.h>
+
+#include <QImage>
+#include <QPixmap>
+#include <QString>
+
+#include <memory>
+
+namespace Fooyin {
+/*!
+ * The cache shared by every CoverProvider.
+ *
+ * Decoded covers are held in memory in a least recently used cache with a byte budget, split into a bucket
+ * for full-size covers and one for thumbnails, so scrolling a playlist of thumbnails can't evict the cover
+ * being displayed (and vice versa). Covers which couldn't be found are remembered in the same buckets, so
+ * they're bounded by the budget too.
+ *
+ * Thumbnails are also stored on disk, in a single pack file keyed by cover key.
+ */
+class CoverCache
+{
+public:
+    enum class Bucket : uint8_t
+    {
+        Full = 0,
+        Thumbnail,
+    };
+
+    static CoverCache& instance();
+
+    ~CoverCache();
+
+    CoverCache(const CoverCache& other)            = delete;
+    CoverCache& operator=(const CoverCache& other) = delete;
+
+    /** Sets the combined budget of both memory buckets to @p bytes. */
+    void setMemoryBudget(size_t bytes);
+
+    /*!
+     * Looks up @p key in the memory cache.
+     * @returns @c true if the key is cached, in which case @p cover is set. A null @p cover means the
+     * track has no cover.
+     * @note must only be called from the main thread.
+     */
+    bool find(const QString& key, Bucket bucket, QPixmap& cover);
+    /*!
+     * Caches @p cover in memory, where a null @p cover records that there is none.
+     * @note must only be called from the main thread.
+     */
+    void insert(const QString& key, Bucket bucket, const QPixmap& cover);
+
+    /** Loads the thumbnail for @p key from disk. @note thread-safe. */
+    [[nodiscard]] QImage loadThumbnail(const QString& key);
+    /** Stores the thumbnail for @p key on disk. @note thread-safe. */
+    void storeThumbnail(const QString& key, const QImage& image);
+
+    /** Returns the memory held by covers in @p bucket. */
+    [[nodiscard]] MemoryUsage::Usage memoryUsage(Bucket bucket) const;
+    /** Evicts the least recently used covers from @p bucket until it holds at most @p bytes. */
+    void trimMemory(Bucket bucket, size_t bytes);
+
+    /** Removes @p key from memory and disk. */
+    void remove(const QString& key);
+    /** Removes everything from memory and disk. */
+    void clear();
+
+    [[nodiscard]] CoverProvider::CacheStats stats() const;
+
+private:
+    CoverCache();
+
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
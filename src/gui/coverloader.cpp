@@ -0,0 +1,400 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "coverloader.h"
+
+#include "core/tagging/embeddedcoverstore.h"
+#include "core/tagging/tagreadservice.h"
+#include "covercache.h"
+
+#include <core/scripting/scriptparser.h>
+#include <utils/tracing.h>
+#include <utils/utils.h>
+
+#include <QCoreApplication>
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPointer>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+constexpr auto MaxSize = 1024;
+// Covers for more rows than this are never on screen at once
+constexpr size_t MaxQueued = 256;
+constexpr int MaxThreads   = 4;
+
+namespace {
+QString requestId(const Fooyin::CoverLoader::Request& request)
+{
+    return request.key + QLatin1Char('|') + QString::number(static_cast<int>(request.thumbnail))
+         + QString::number(static_cast<int>(request.storeThumbnail))
+         + QString::number(static_cast<int>(request.limitThumbSize)) + QLatin1Char('|')
+         + QString::number(request.thumbnailSize.width()) + QLatin1Char('|') + QString::number(request.dpr);
+}
+
+QString findDirectoryCover(const Fooyin::CoverLoader::Request& request)
+{
+    using Fooyin::Track;
+
+    if(!request.track.isValid()) {
+        return {};
+    }
+
+    // Each pool thread keeps its own parser, so lookups don't need to be serialised
+    thread_local Fooyin::ScriptParser parser;
+
+    const QStringList* paths{nullptr};
+    switch(request.type) {
+        case(Track::Cover::Front):
+            paths = &request.paths.frontCoverPaths;
+            break;
+        case(Track::Cover::Back):
+            paths = &request.paths.backCoverPaths;
+            break;
+        case(Track::Cover::Artist):
+            paths = &request.paths.artistPaths;
+            break;
+    }
+
+    if(!paths) {
+        return {};
+    }
+
+    for(const auto& path : *paths) {
+        const QFileInfo fileInfo{QDir::cleanPath(parser.evaluate(path, request.track))};
+        const QDir filePath{fileInfo.path()};
+        const QString filePattern  = fileInfo.fileName();
+        const QStringList fileList = filePath.entryList({filePattern}, QDir::Files);
+
+        if(!fileList.isEmpty()) {
+            return filePath.absolutePath() + QStringLiteral("/") + fileList.constFirst();
+        }
+    }
+
+    return {};
+}
+
+QSize pixelSize(const QSize& size, double dpr)
+{
+    return {static_cast<int>(size.width() * dpr), static_cast<int>(size.height() * dpr)};
+}
+
+/*!
+ * Decodes the image from @p device, letting the decoder downscale it when it's larger than @p size.
+ * Large JPEGs are scaled in the DCT domain, so most of the full-resolution image is never decoded.
+ */
+QImage readImage(QIODevice* device, const QSize& size)
+{
+    QImageReader reader{device};
+
+    const QSize imageSize = reader.size();
+    if(imageSize.isValid() && (imageSize.width() > size.width() || imageSize.height() > size.height())) {
+        reader.setScaledSize(imageSize.scaled(size, Qt::KeepAspectRatio));
+    }
+
+    return reader.read();
+}
+} // namespace
+
+namespace Fooyin {
+struct CoverLoader::Private
+{
+    struct Listener
+    {
+        QPointer<QObject> receiver;
+        Callback callback;
+    };
+
+    struct Pending
+    {
+        Request request;
+        std::vector<Listener> listeners;
+        uint64_t priority{0};
+        bool running{false};
+    };
+
+    QThreadPool pool;
+    QObject dispatcher;
+
+    std::mutex mutex;
+    std::unordered_map<QString, Pending> requests;
+    // Queued requests by priority, highest last
+    std::map<uint64_t, QString> queue;
+    uint64_t nextPriority{0};
+
+    Private()
+    {
+        pool.setMaxThreadCount(std::clamp(QThread::idealThreadCount() / 2, 1, MaxThreads));
+
+        if(auto* app = QCoreApplication::instance()) {
+            QObject::connect(app, &QCoreApplication::aboutToQuit, &dispatcher, [this]() {
+                {
+                    const std::scoped_lock lock{mutex};
+                    for(const auto& [_, id] : queue) {
+                        requests.erase(id);
+                    }
+                    queue.clear();
+                }
+                pool.waitForDone();
+            });
+        }
+    }
+
+    void enqueue(const QString& id, Pending& pending)
+    {
+        if(pending.priority > 0) {
+            queue.erase(pending.priority);
+        }
+        pending.priority = ++nextPriority;
+        queue.emplace(pending.priority, id);
+    }
+
+    std::vector<Listener> dropOldest()
+    {
+        std::vector<Listener> cancelled;
+
+        while(queue.size() > MaxQueued) {
+            const auto oldest = queue.begin();
+            auto node         = requests.extract(oldest->second);
+            queue.erase(oldest);
+
+            if(node) {
+                auto& listeners = node.mapped().listeners;
+                std::ranges::move(listeners, std::back_inserter(cancelled));
+            }
+        }
+
+        return cancelled;
+    }
+
+    void runNext()
+    {
+        QString id;
+        Request request;
+
+        {
+            const std::scoped_lock lock{mutex};
+
+            if(queue.empty()) {
+                return;
+            }
+
+            const auto next = std::prev(queue.end());
+            id              = next->second;
+            queue.erase(next);
+
+            auto& pending   = requests.at(id);
+            pending.running = true;
+            request         = pending.request;
+        }
+
+        const QImage cover = loadCover(request);
+
+        QMetaObject::invokeMethod(
+            &dispatcher, [this, id, cover]() { finish(id, cover); }, Qt::QueuedConnection);
+    }
+
+    void finish(const QString& id, const QImage& cover)
+    {
+        std::vector<Listener> listeners;
+
+        {
+            const std::scoped_lock lock{mutex};
+
+            auto node = requests.extract(id);
+            if(!node) {
+                return;
+            }
+            listeners = std::move(node.mapped().listeners);
+        }
+
+        for(const auto& listener : listeners) {
+            if(listener.receiver) {
+                listener.callback(cover, false);
+            }
+        }
+    }
+};
+
+CoverLoader& CoverLoader::instance()
+{
+    static CoverLoader loader;
+    return loader;
+}
+
+CoverLoader::CoverLoader()
+    : p{std::make_unique<Private>()}
+{ }
+
+CoverLoader::~CoverLoader() = default;
+
+void CoverLoader::load(const Request& request, QObject* receiver, Callback callback)
+{
+    const QString id = requestId(request);
+
+    std::vector<Private::Listener> cancelled;
+
+    {
+        const std::scoped_lock lock{p->mutex};
+
+        auto [it, inserted] = p->requests.try_emplace(id);
+        auto& pending       = it->second;
+        pending.listeners.push_back({receiver, std::move(callback)});
+
+        if(inserted) {
+            pending.request = request;
+            p->enqueue(id, pending);
+            cancelled = p->dropOldest();
+            p->pool.start([this]() { p->runNext(); });
+        }
+        else if(!pending.running) {
+            p->enqueue(id, pending);
+        }
+    }
+
+    for(const auto& listener : cancelled) {
+        if(listener.receiver) {
+            listener.callback({}, true);
+        }
+    }
+}
+
+bool CoverLoader::prioritise(const Request& request)
+{
+    const QString id = requestId(request);
+
+    const std::scoped_lock lock{p->mutex};
+
+    const auto it = p->requests.find(id);
+    if(it == p->requests.end()) {
+        return false;
+    }
+
+    if(!it->second.running) {
+        p->enqueue(id, it->second);
+    }
+    return true;
+}
+
+void CoverLoader::cancel(const QObject* receiver)
+{
+    const std::scoped_lock lock{p->mutex};
+
+    for(auto it = p->requests.begin(); it != p->requests.end();) {
+        auto& pending = it->second;
+        std::erase_if(pending.listeners, [receiver](const Private::Listener& listener) {
+            return !listener.receiver || listener.receiver == receiver;
+        });
+
+        if(pending.listeners.empty() && !pending.running) {
+            p->queue.erase(pending.priority);
+            it = p->requests.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+QImage CoverLoader::loadCover(const Request& request)
+{
+    FY_TRACE_SCOPE("CoverLoader::loadCover");
+    auto& cache = CoverCache::instance();
+    QImage image;
+
+    bool isThumb{request.thumbnail};
+    if(isThumb) {
+        image = cache.loadThumbnail(request.key);
+    }
+    const bool stored = !image.isNull();
+
+    const QSize fullSize  = pixelSize({MaxSize, MaxSize}, request.dpr);
+    const QSize thumbSize = pixelSize(request.thumbnailSize, request.dpr);
+
+    if(image.isNull()) {
+        const QString dirPath = findDirectoryCover(request);
+        if(!dirPath.isEmpty()) {
+            const bool scaleToThumb = isThumb && (!request.storeThumbnail || request.limitThumbSize);
+            QFile file{dirPath};
+            if(file.open(QIODevice::ReadOnly)) {
+                image = readImage(&file, scaleToThumb ? thumbSize : fullSize);
+            }
+            if(!image.isNull() && isThumb && !request.storeThumbnail) {
+                // Only store thumbnails in disk cache for embedded artwork (unless overriden)
+                isThumb = false;
+                image   = Utils::scaleImage(image, request.thumbnailSize, request.dpr);
+            }
+        }
+    }
+
+    if(image.isNull()) {
+        const QSize targetSize = isThumb && request.limitThumbSize ? thumbSize : fullSize;
+
+        Track source{request.track};
+        if(request.type == Track::Cover::Front) {
+            // Extracted while scanning; only read the file if the stored thumbnail is too small
+            const auto stored = EmbeddedCoverStore::instance().find(request.track.albumHash());
+            if(stored.isValid()
+               && (!stored.scaled || stored.thumbnail.width() >= targetSize.width()
+                   || stored.thumbnail.height() >= targetSize.height())) {
+                image = stored.thumbnail;
+            }
+            else if(!stored.origin.isEmpty()) {
+                source = Track{stored.origin};
+            }
+        }
+
+        if(image.isNull()) {
+            auto& reader = TagReadService::instance();
+
+            QByteArray coverData = reader.readCover(source, request.type, targetSize);
+            if(coverData.isEmpty() && source.filepath() != request.track.filepath()) {
+                coverData = reader.readCover(request.track, request.type, targetSize);
+            }
+            if(!coverData.isEmpty()) {
+                QBuffer buffer{&coverData};
+                image = readImage(&buffer, targetSize);
+            }
+        }
+    }
+
+    if(!image.isNull()) {
+        image = Utils::scaleImage(image, MaxSize, request.dpr);
+    }
+
+    if(isThumb && !stored && !image.isNull()) {
+        if(request.limitThumbSize) {
+            image = Utils::scaleImage(image, request.thumbnailSize, request.dpr);
+        }
+        cache.storeThumbnail(request.key, image);
+    }
+
+    return image;
+}
+} // namespace Fooyin
@@ -0,0 +1,98 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "internalguisettings.h"
+
+#include <core/track.h>
+
+#include <QImage>
+#include <QSize>
+
+#include <functional>
+#include <memory>
+
+class QObject;
+
+namespace Fooyin {
+/*!
+ * Loads covers on a dedicated, size-limited thread pool shared by every CoverProvider.
+ *
+ * Requests are started newest first, and re-requesting a queued cover moves it back to the front, so covers
+ * for rows which are currently being painted load before those which have since scrolled out of view.
+ * Once too many requests are queued the oldest are cancelled. Identical requests, e.g. for every track
+ * of an album, are coalesced into a single load.
+ */
+class CoverLoader
+{
+public:
+    struct Request
+    {
+        QString key;
+        Track track;
+        Track::Cover type{Track::Cover::Front};
+        bool thumbnail{false};
+        bool storeThumbnail{false};
+        bool limitThumbSize{true};
+        QSize thumbnailSize;
+        double dpr{1.0};
+        CoverPaths paths;
+    };
+
+    /*!
+     * Called on the main thread once a request finishes.
+     * @p cover is null if there is no cover, or if @p cancelled is @c true.
+     */
+    using Callback = std::function<void(const QImage& cover, bool cancelled)>;
+
+    static CoverLoader& instance();
+
+    ~CoverLoader();
+
+    CoverLoader(const CoverLoader& other)            = delete;
+    CoverLoader& operator=(const CoverLoader& other) = delete;
+
+    /*!
+     * Queues @p request, calling @p callback with the result unless @p receiver is destroyed first.
+     * @note must only be called from the main thread.
+     */
+    void load(const Request& request, QObject* receiver, Callback callback);
+    /*!
+     * Moves @p request to the front of the queue if it hasn't started yet.
+     * @returns @c false if @p request isn't queued or loading.
+     */
+    bool prioritise(const Request& request);
+    /** Cancels all requests made for @p receiver which haven't started yet. Callbacks aren't called. */
+    void cancel(const QObject* receiver);
+
+    /*!
+     * Loads the cover described by @p request on the calling thread.
+     * Thumbnails are read from and written to the CoverCache.
+     */
+    static QImage loadCover(const Request& request);
+
+private:
+    CoverLoader();
+
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
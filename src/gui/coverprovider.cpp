@@ -19,50 +19,53 @@
 
 #include <gui/coverprovider.h>
 
-#include "core/tagging/tagreader.h"
+#include "core/tagging/embeddedcoverstore.h"
+#include "covercache.h"
+#include "coverloader.h"
 #include "internalguisettings.h"
 
-#include <core/scripting/scriptparser.h>
 #include <core/track.h>
 #include <gui/guiconstants.h>
-#include <gui/guipaths.h>
 #include <gui/guisettings.h>
-#include <utils/async.h>
 #include <utils/crypto.h>
 #include <utils/settings/settingsmanager.h>
 #include <utils/utils.h>
 
-#include <QByteArray>
-#include <QFileInfo>
 #include <QIcon>
 #include <QPixmapCache>
 
+#include <array>
 #include <set>
+#include <unordered_map>
 
 constexpr auto MaxSize = 1024;
 
 namespace {
+// Keys are only looked up from the GUI thread, so stored albums need to build and hash them just once
+std::unordered_map<int, std::array<QString, 3>> albumCoverKeys;
+
 QString generateCoverKey(const Fooyin::Track& track, Fooyin::Track::Cover type)
 {
-    return Fooyin::Utils::generateHash(QStringLiteral("FyCover") + QString::number(static_cast<int>(type)),
-                                       track.albumHash());
-}
+    const auto makeKey = [&track, type]() {
+        return Fooyin::Utils::generateHash(QStringLiteral("FyCover") + QString::number(static_cast<int>(type)),
+                                           track.albumHash());
+    };
 
-QString generateThumbCoverKey(const QString& key)
-{
-    return Fooyin::Utils::generateHash(QStringLiteral("Thumb"), key);
-}
+    const int albumId = track.albumId();
+    if(albumId < 0) {
+        return makeKey();
+    }
 
-QString coverThumbnailPath(const QString& key)
-{
-    return Fooyin::Gui::coverPath() + key + QStringLiteral(".jpg");
+    QString& key = albumCoverKeys[albumId].at(static_cast<size_t>(type));
+    if(key.isEmpty()) {
+        key = makeKey();
+    }
+    return key;
 }
 
-void saveThumbnail(const QImage& cover, const QString& key)
+Fooyin::CoverCache::Bucket cacheBucket(bool thumbnail)
 {
-    QFile file{coverThumbnailPath(key)};
-    file.open(QIODevice::WriteOnly);
-    cover.save(&file, "JPG", 85);
+    return thumbnail ? Fooyin::CoverCache::Bucket::Thumbnail : Fooyin::CoverCache::Bucket::Full;
 }
 } // namespace
 
@@ -81,19 +84,9 @@ struct CoverProvider::Private
     QPixmapCache::Key noCoverKey;
     QSize size;
     std::set<QString> pendingCovers;
-    std::set<QString> noCoverKeys;
-    ScriptParser parser;
 
     CoverPaths paths;
 
-    std::mutex fetchGuard;
-
-    struct CoverLoaderResult
-    {
-        QImage cover;
-        bool isThumb{false};
-    };
-
     explicit Private(CoverProvider* self_, SettingsManager* settings_)
         : self{self_}
         , settings{settings_}
@@ -111,15 +104,36 @@ struct CoverProvider::Private
         settings->subscribe<Settings::Gui::MainWindowPixelRatio>(self, [this](double ratio) { windowDpr = ratio; });
     }
 
-    [[nodiscard]] static QPixmap loadCachedCover(const QString& key, bool isThumb = false)
+    QPixmap loadCover(const Track& track, Track::Cover type, bool thumbnail)
     {
-        QPixmap cover;
+        if(!track.isValid()) {
+            return usePlacerholder ? loadNoCover() : QPixmap{};
+        }
+
+        QString key{coverKey};
+        if(key.isEmpty()) {
+            key = generateCoverKey(track, type);
+        }
 
-        if(QPixmapCache::find(isThumb ? generateThumbCoverKey(key) : key, &cover)) {
-            return cover;
+        if(pendingCovers.contains(key)) {
+            // Still being painted, so load it ahead of covers which have since scrolled away
+            CoverLoader::instance().prioritise(loaderRequest(key, track, type, thumbnail));
+        }
+        else {
+            QPixmap cover;
+            if(CoverCache::instance().find(key, cacheBucket(thumbnail), cover)) {
+                // A null cover means we've already looked and there isn't one
+                if(!cover.isNull()) {
+                    return cover;
+                }
+            }
+            else {
+                pendingCovers.emplace(key);
+                fetchCover(key, track, type, thumbnail);
+            }
         }
 
-        return {};
+        return usePlacerholder ? loadNoCover() : QPixmap{};
     }
 
     QPixmap loadNoCover()
@@ -138,112 +152,37 @@ struct CoverProvider::Private
         return cover;
     }
 
-    QString findDirectoryCover(const Track& track, Track::Cover type)
+    [[nodiscard]] CoverLoader::Request loaderRequest(const QString& key, const Track& track, Track::Cover type,
+                                                     bool thumbnail) const
     {
-        if(!track.isValid()) {
-            return {};
-        }
-
-        QStringList filters;
-
-        const std::scoped_lock lock{fetchGuard};
-
-        if(type == Track::Cover::Front) {
-            for(const auto& path : paths.frontCoverPaths) {
-                filters.emplace_back(parser.evaluate(path, track));
-            }
-        }
-        else if(type == Track::Cover::Back) {
-            for(const auto& path : paths.backCoverPaths) {
-                filters.emplace_back(parser.evaluate(path, track));
-            }
-        }
-        else if(type == Track::Cover::Artist) {
-            for(const auto& path : paths.artistPaths) {
-                filters.emplace_back(parser.evaluate(path, track));
-            }
-        }
-
-        for(const auto& filter : filters) {
-            const QFileInfo fileInfo{QDir::cleanPath(filter)};
-            const QDir filePath{fileInfo.path()};
-            const QString filePattern  = fileInfo.fileName();
-            const QStringList fileList = filePath.entryList({filePattern}, QDir::Files);
-
-            if(!fileList.isEmpty()) {
-                return filePath.absolutePath() + QStringLiteral("/") + fileList.constFirst();
-            }
-        }
-
-        return {};
+        return {.key            = key,
+                .track          = track,
+                .type           = type,
+                .thumbnail      = thumbnail,
+                .storeThumbnail = storeThumbnail,
+                .limitThumbSize = limitThumbSize,
+                .thumbnailSize  = size,
+                .dpr            = windowDpr,
+                .paths          = paths};
     }
 
     void fetchCover(const QString& key, const Track& track, Track::Cover type, bool thumbnail)
     {
-        auto loaderResult
-            = Utils::asyncExec([this, coverSize = size, dpr = windowDpr, thumbOverride = storeThumbnail,
-                                limit = limitThumbSize, key, track, type, thumbnail]() -> CoverLoaderResult {
-                  QImage image;
-
-                  bool isThumb{thumbnail};
-                  const QString cachePath = coverThumbnailPath(key);
-
-                  if(isThumb && QFileInfo::exists(cachePath)) {
-                      image.load(cachePath);
-                  }
-
-                  if(image.isNull()) {
-                      const QString dirPath = findDirectoryCover(track, type);
-                      if(!dirPath.isEmpty()) {
-                          image.load(dirPath);
-                          if(!image.isNull() && isThumb && !thumbOverride) {
-                              // Only store thumbnails in disk cache for embedded artwork (unless overriden)
-                              isThumb = false;
-                              image   = Utils::scaleImage(image, coverSize, dpr);
-                          }
-                      }
-                  }
-
-                  if(image.isNull()) {
-                      const QByteArray coverData = Tagging::readCover(track, type);
-                      if(!coverData.isEmpty()) {
-                          image.loadFromData(coverData);
-                      }
-                  }
-
-                  if(!image.isNull()) {
-                      image = Utils::scaleImage(image, MaxSize, dpr);
-                  }
-
-                  if(isThumb) {
-                      if(image.isNull()) {
-                          QFile::remove(cachePath);
-                      }
-                      else if(!QFileInfo::exists(cachePath)) {
-                          if(limit) {
-                              image = Utils::scaleImage(image, coverSize, dpr);
-                          }
-                          saveThumbnail(image, key);
-                      }
-                  }
-
-                  return {image, thumbnail};
-              });
-
-        loaderResult.then(self, [this, key, track](const CoverLoaderResult& result) {
+        const auto request = loaderRequest(key, track, type, thumbnail);
+
+        CoverLoader::instance().load(request, self, [this, key, track, thumbnail](const QImage& image, bool cancelled) {
             pendingCovers.erase(key);
 
-            if(result.cover.isNull()) {
+            if(cancelled) {
                 return;
             }
 
-            const QPixmap cover = QPixmap::fromImage(result.cover);
+            const QPixmap cover = image.isNull() ? QPixmap{} : QPixmap::fromImage(image);
+            CoverCache::instance().insert(key, cacheBucket(thumbnail), cover);
 
-            if(!QPixmapCache::insert(result.isThumb ? generateThumbCoverKey(key) : key, cover)) {
-                qDebug() << "Failed to cache cover for:" << track.filepath();
+            if(!cover.isNull()) {
+                emit self->coverAdded(track);
             }
-
-            emit self->coverAdded(track);
         });
     }
 };
@@ -278,62 +217,32 @@ void CoverProvider::setAlwaysStoreThumbnail(bool enabled)
     p->storeThumbnail = enabled;
 }
 
-CoverProvider::~CoverProvider() = default;
-
-QPixmap CoverProvider::trackCover(const Track& track, Track::Cover type) const
+CoverProvider::~CoverProvider()
 {
-    if(!track.isValid()) {
-        return p->usePlacerholder ? p->loadNoCover() : QPixmap{};
-    }
-
-    QString coverKey{p->coverKey};
-    if(coverKey.isEmpty()) {
-        coverKey = generateCoverKey(track, type);
-    }
-
-    if(!p->pendingCovers.contains(coverKey)) {
-        QPixmap cover = p->loadCachedCover(coverKey, false);
-        if(!cover.isNull()) {
-            return cover;
-        }
+    CoverLoader::instance().cancel(this);
+}
 
-        p->pendingCovers.emplace(coverKey);
-        p->fetchCover(coverKey, track, type, false);
-    }
+void CoverProvider::cancelPending()
+{
+    CoverLoader::instance().cancel(this);
+    p->pendingCovers.clear();
+}
 
-    return p->usePlacerholder ? p->loadNoCover() : QPixmap{};
+QPixmap CoverProvider::trackCover(const Track& track, Track::Cover type) const
+{
+    return p->loadCover(track, type, false);
 }
 
 QPixmap CoverProvider::trackCoverThumbnail(const Track& track, Track::Cover type) const
 {
-    if(!track.isValid()) {
-        return p->usePlacerholder ? p->loadNoCover() : QPixmap{};
-    }
-
-    QString coverKey{p->coverKey};
-    if(coverKey.isEmpty()) {
-        coverKey = generateCoverKey(track, type);
-    }
-
-    if(!p->pendingCovers.contains(coverKey)) {
-        QPixmap cover = p->loadCachedCover(coverKey, true);
-        if(!cover.isNull()) {
-            return cover;
-        }
-
-        p->pendingCovers.emplace(coverKey);
-        p->fetchCover(coverKey, track, type, true);
-    }
-
-    return p->usePlacerholder ? p->loadNoCover() : QPixmap{};
+    return p->loadCover(track, type, true);
 }
 
 void CoverProvider::clearCache()
 {
-    QDir cache{Fooyin::Gui::coverPath()};
-    cache.removeRecursively();
-
-    QPixmapCache::clear();
+    CoverCache::instance().clear();
+    EmbeddedCoverStore::instance().clear();
+    albumCoverKeys.clear();
 }
 
 void CoverProvider::removeFromCache(const Track& track)
@@ -341,16 +250,22 @@ void CoverProvider::removeFromCache(const Track& track)
     removeFromCache(generateCoverKey(track, Track::Cover::Front));
     removeFromCache(generateCoverKey(track, Track::Cover::Back));
     removeFromCache(generateCoverKey(track, Track::Cover::Artist));
+    EmbeddedCoverStore::instance().remove(track.albumHash());
 }
 
 void CoverProvider::removeFromCache(const QString& key)
 {
-    QDir cache{Fooyin::Gui::coverPath()};
-    cache.remove(coverThumbnailPath(key));
+    CoverCache::instance().remove(key);
+}
+
+CoverProvider::CacheStats CoverProvider::cacheStats()
+{
+    return CoverCache::instance().stats();
+}
 
-    QPixmapCache::remove(key);
-    const QString thumbKey = generateThumbCoverKey(key);
-    QPixmapCache::remove(thumbKey);
+void CoverProvider::setCacheBudget(size_t bytes)
+{
+    CoverCache::instance().setMemoryBudget(bytes);
 }
 } // namespace Fooyin
 
@@ -21,11 +21,13 @@
 
 #include <core/constants.h>
 #include <gui/guiconstants.h>
+#include <utils/memoryusage.h>
 #include <utils/utils.h>
 
 #include <QApplication>
 #include <QDialogButtonBox>
 #include <QGridLayout>
+#include <QGroupBox>
 #include <QLabel>
 #include <QPushButton>
 #include <QSysInfo>
@@ -74,11 +76,31 @@ QString description()
                           "<br/>")
         .arg(u"fooyin", QCoreApplication::applicationVersion(), qtVersion());
 }
+
+QString memoryUsage()
+{
+    const Fooyin::MemoryUsage::ReportList reports = Fooyin::MemoryUsage::report();
+
+    QString rows;
+    size_t total{0};
+
+    for(const auto& report : reports) {
+        rows += QStringLiteral("<tr><td>%1</td><td align=\"right\">%2</td><td align=\"right\">%3</td></tr>")
+                    .arg(report.name, QString::number(report.usage.entries),
+                         Fooyin::Utils::formatFileSize(report.usage.bytes));
+        total += report.usage.bytes;
+    }
+
+    return QStringLiteral("<table width=\"100%\" cellspacing=\"4\">%1<tr><td><b>%2</b></td><td></td>"
+                          "<td align=\"right\"><b>%3</b></td></tr></table>")
+        .arg(rows, Fooyin::AboutDialog::tr("Total"), Fooyin::Utils::formatFileSize(total));
+}
 } // namespace
 
 namespace Fooyin {
 AboutDialog::AboutDialog(QWidget* parent)
     : QDialog{parent}
+    , m_memoryUsage{new QLabel(this)}
 {
     setWindowTitle(tr("About %1").arg(u"fooyin"));
     auto* layout = new QGridLayout(this);
@@ -97,9 +119,31 @@ AboutDialog::AboutDialog(QWidget* parent)
     auto* logo = new QLabel(this);
     logo->setPixmap(Utils::iconFromTheme(Constants::Icons::Fooyin).pixmap(IconSize));
 
+    auto* memoryGroup  = new QGroupBox(tr("Memory Usage"), this);
+    auto* memoryLayout = new QGridLayout(memoryGroup);
+
+    auto* trimButton = new QPushButton(tr("Free Cached Memory"), this);
+    trimButton->setToolTip(tr("Drops cached covers, waveforms and script results, which are rebuilt as needed"));
+    QObject::connect(trimButton, &QPushButton::clicked, this, [this]() {
+        MemoryUsage::trim();
+        updateMemoryUsage();
+    });
+
+    memoryLayout->addWidget(m_memoryUsage, 0, 0, 1, 2);
+    memoryLayout->addWidget(trimButton, 1, 1);
+    memoryLayout->setColumnStretch(0, 1);
+
     layout->addWidget(logo, 0, 0);
     layout->addWidget(aboutLabel, 0, 1);
+    layout->addWidget(memoryGroup, 1, 1);
     layout->addWidget(buttonBox, 4, 1);
+
+    updateMemoryUsage();
+}
+
+void AboutDialog::updateMemoryUsage()
+{
+    m_memoryUsage->setText(memoryUsage());
 }
 } // namespace Fooyin
 
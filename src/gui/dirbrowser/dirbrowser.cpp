@@ -25,6 +25,7 @@
 #include "internalguisettings.h"
 #include "playlist/playlistinteractor.h"
 
+#include <core/library/musiclibrary.h>
 #include <core/player/playercontroller.h>
 #include <core/playlist/playlist.h>
 #include <core/playlist/playlisthandler.h>
@@ -32,7 +33,8 @@
 #include <gui/guiconstants.h>
 #include <gui/trackselectioncontroller.h>
 #include <gui/widgets/toolbutton.h>
-#include <utils/fileutils.h>
+#include <utils/async.h>
+#include <utils/directorycache.h>
 #include <utils/settings/settingsmanager.h>
 #include <utils/utils.h>
 
@@ -55,6 +57,13 @@
 constexpr auto DirPlaylist = "␟DirBrowserPlaylist␟";
 
 namespace {
+// Shared by all browsers, so a directory opened in one is already listed for the others
+Fooyin::DirectoryCache& directoryCache()
+{
+    static Fooyin::DirectoryCache cache{Fooyin::Track::supportedFileExtensions()};
+    return cache;
+}
+
 class DirChange : public QUndoCommand
 {
 public:
@@ -254,33 +263,41 @@ struct DirBrowser::Private
             }
         }
 
-        QList<QUrl> files;
-
+        QStringList paths;
         for(const QModelIndex& index : selected) {
             if(index.isValid()) {
-                const QFileInfo filePath{index.data(QFileSystemModel::FilePathRole).toString()};
-                if(filePath.isDir()) {
-                    if(!onlySelection) {
-                        files.append(
-                            Utils::File::getUrlsInDir(filePath.absoluteFilePath(), Track::supportedFileExtensions()));
-                    }
-                    else {
-                        files.append(Utils::File::getUrlsInDirRecursive(filePath.absoluteFilePath(),
-                                                                        Track::supportedFileExtensions()));
-                    }
+                paths.append(index.data(QFileSystemModel::FilePathRole).toString());
+            }
+        }
+
+        if(paths.empty()) {
+            return;
+        }
+
+        // Listing and resolving against the library happen off the main thread, as directories can be huge
+        const bool recursive = onlySelection;
+        Utils::asyncExec([paths, recursive, library = playlistInteractor->library()->snapshot()]() {
+            QStringList filepaths;
+            for(const QString& path : paths) {
+                if(QFileInfo{path}.isDir()) {
+                    filepaths.append(directoryCache().files(path, recursive));
                 }
                 else {
-                    files.append(QUrl::fromLocalFile(filePath.absoluteFilePath()));
+                    filepaths.append(path);
                 }
             }
-        }
+            return PlaylistInteractor::tracksForPaths(filepaths, library);
+        }).then(self, [this, action, firstPath](const TrackList& tracks) { handleTracks(action, tracks, firstPath); });
+    }
 
-        if(files.empty()) {
+    void handleTracks(TrackAction action, const TrackList& tracks, QString firstPath)
+    {
+        if(tracks.empty()) {
             return;
         }
 
         if(firstPath.isEmpty()) {
-            firstPath = files.front().path();
+            firstPath = tracks.front().filepath();
         }
 
         QDir parentDir{firstPath};
@@ -291,41 +308,37 @@ struct DirBrowser::Private
 
         switch(action) {
             case(TrackAction::Play):
-                handlePlayAction(files, firstPath);
+                handlePlayAction(tracks, firstPath);
                 break;
             case(TrackAction::AddCurrentPlaylist):
-                playlistInteractor->filesToCurrentPlaylist(files);
+                playlistInteractor->tracksToCurrentPlaylist(tracks);
                 break;
             case(TrackAction::SendCurrentPlaylist):
-                playlistInteractor->filesToCurrentPlaylistReplace(files, startPlayback);
+                playlistInteractor->tracksToCurrentPlaylistReplace(tracks, startPlayback);
                 break;
             case(TrackAction::SendNewPlaylist):
-                playlistInteractor->filesToNewPlaylist(playlistName, files, startPlayback);
+                playlistInteractor->tracksToNewPlaylist(playlistName, tracks, startPlayback);
                 break;
             case(TrackAction::AddActivePlaylist):
-                playlistInteractor->filesToActivePlaylist(files);
+                playlistInteractor->tracksToActivePlaylist(tracks);
                 break;
             case(TrackAction::None):
                 break;
         }
     }
 
-    void handlePlayAction(const QList<QUrl>& files, const QString& startingFile)
+    void handlePlayAction(const TrackList& tracks, const QString& startingFile)
     {
         int playIndex{0};
 
         if(!startingFile.isEmpty()) {
             auto rowIt = std::ranges::find_if(
-                std::as_const(files), [&startingFile](const QUrl& file) { return file.path() == startingFile; });
-            if(rowIt != files.cend()) {
-                playIndex = static_cast<int>(std::distance(files.cbegin(), rowIt));
+                tracks, [&startingFile](const Track& track) { return track.filepath() == startingFile; });
+            if(rowIt != tracks.cend()) {
+                playIndex = static_cast<int>(std::distance(tracks.cbegin(), rowIt));
             }
         }
 
-        TrackList tracks;
-        std::ranges::transform(files, std::back_inserter(tracks),
-                               [](const QUrl& file) { return Track{file.toLocalFile()}; });
-
         startPlayback(tracks, playIndex);
     }
 
@@ -36,6 +36,7 @@
 #include <utils/actions/actionmanager.h>
 #include <utils/id.h>
 #include <utils/settings/settingsmanager.h>
+#include <utils/startuptrace.h>
 #include <utils/widgets/overlaywidget.h>
 
 #include <QApplication>
@@ -523,6 +524,8 @@ EditableLayout::~EditableLayout()
 
 void EditableLayout::initialise()
 {
+    const StartupTrace::Scope trace{"EditableLayout::initialise"};
+
     auto* editMenu = p->actionManager->actionContainer(Constants::Menus::Edit);
 
     auto* undo    = new QAction(tr("Undo"), this);
@@ -647,6 +650,8 @@ void EditableLayout::saveLayout()
 
 bool EditableLayout::loadLayout(const Layout& layout)
 {
+    const StartupTrace::Scope trace{"EditableLayout::loadLayout"};
+
     if(layout.json.isEmpty()) {
         return false;
     }
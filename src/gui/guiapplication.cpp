@@ -31,6 +31,7 @@
 #include "internalguisettings.h"
 #include "librarytree/librarytreewidget.h"
 #include "mainwindow.h"
+#include "memorymonitor.h"
 #include "menubar/editmenu.h"
 #include "menubar/filemenu.h"
 #include "menubar/helpmenu.h"
@@ -41,6 +42,8 @@
 #include "playlist/organiser/playlistorganiser.h"
 #include "playlist/playlistcontroller.h"
 #include "playlist/playlistinteractor.h"
+#include "playlist/playlistprofiler.h"
+#include "playlist/playliststatswidget.h"
 #include "playlist/playlisttabs.h"
 #include "playlist/playlistwidget.h"
 #include "sandbox/sandboxdialog.h"
@@ -48,6 +51,7 @@
 #include "search/searchwidget.h"
 #include "settings/artworkpage.h"
 #include "settings/dirbrowser/dirbrowserpage.h"
+#include "settings/dsppage.h"
 #include "settings/enginepage.h"
 #include "settings/generalpage.h"
 #include "settings/guigeneralpage.h"
@@ -62,19 +66,25 @@
 #include "settings/shortcuts/shortcutspage.h"
 #include "settings/widgets/statuswidgetpage.h"
 #include "systemtrayicon.h"
+#include "visualisation/spectrogramwidget.h"
+#include "visualisation/spectrumwidget.h"
+#include "visualisation/vumeterwidget.h"
 #include "widgets/coverwidget.h"
 #include "widgets/dummy.h"
+#include "widgets/enginestatswidget.h"
 #include "widgets/lyricswidget.h"
 #include "widgets/spacer.h"
 #include "widgets/splitterwidget.h"
 #include "widgets/statuswidget.h"
 #include "widgets/tabstackwidget.h"
+#include "widgets/viewpreview.h"
 
 #include <core/coresettings.h>
 #include <core/engine/enginehandler.h>
 #include <core/library/librarymanager.h>
 #include <core/library/musiclibrary.h>
 #include <core/playlist/playlisthandler.h>
+#include <core/playlist/playlistparser.h>
 #include <core/plugins/coreplugincontext.h>
 #include <core/plugins/pluginmanager.h>
 #include <gui/coverprovider.h>
@@ -91,6 +101,7 @@
 #include <utils/actions/actionmanager.h>
 #include <utils/settings/settingsdialogcontroller.h>
 #include <utils/settings/settingsmanager.h>
+#include <utils/startuptrace.h>
 #include <utils/utils.h>
 
 #include <QAction>
@@ -98,7 +109,11 @@
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QPixmapCache>
+#include <QProgressDialog>
 #include <QPushButton>
+#include <QTimer>
+
+#include <tuple>
 
 namespace Fooyin {
 struct GuiApplication::Private
@@ -125,8 +140,11 @@ struct GuiApplication::Private
     WidgetContext* mainContext;
     std::unique_ptr<PlaylistController> playlistController;
     PlaylistInteractor playlistInteractor;
+    PlaylistProfiler* playlistProfiler;
     TrackSelectionController selectionController;
     SearchController* searchController;
+    CoverProvider* coverPrefetcher;
+    MemoryMonitor* memoryMonitor;
 
     FileMenu* fileMenu;
     EditMenu* editMenu;
@@ -148,6 +166,7 @@ struct GuiApplication::Private
     PlaylistPresetsPage playlistPresetsPage;
     PlaylistColumnPage playlistColumnPage;
     EnginePage enginePage;
+    DspPage dspPage;
     DirBrowserPage dirBrowserPage;
     LibraryTreePage libraryTreePage;
     LibraryTreeGroupPage libraryTreeGroupPage;
@@ -177,8 +196,11 @@ struct GuiApplication::Private
         , playlistController{std::make_unique<PlaylistController>(playlistHandler, playerController,
                                                                   &selectionController, settingsManager)}
         , playlistInteractor{core.playlistHandler, playlistController.get(), core.library}
+        , playlistProfiler{new PlaylistProfiler(self)}
         , selectionController{actionManager, settingsManager, playlistController.get()}
         , searchController{new SearchController(editableLayout.get(), self)}
+        , coverPrefetcher{new CoverProvider(settingsManager, self)}
+        , memoryMonitor{new MemoryMonitor(settingsManager, self)}
         , fileMenu{new FileMenu(actionManager, settingsManager, self)}
         , editMenu{new EditMenu(actionManager, settingsManager, self)}
         , viewMenu{new ViewMenu(actionManager, settingsManager, self)}
@@ -197,6 +219,7 @@ struct GuiApplication::Private
         , playlistPresetsPage{settingsManager}
         , playlistColumnPage{actionManager, settingsManager}
         , enginePage{settingsManager, engine}
+        , dspPage{settingsManager, engine}
         , dirBrowserPage{settingsManager}
         , libraryTreePage{settingsManager}
         , libraryTreeGroupPage{actionManager, settingsManager}
@@ -220,13 +243,17 @@ struct GuiApplication::Private
         mainWindow->setCentralWidget(editableLayout.get());
 
         auto openMainWindow = [this]() {
+            const StartupTrace::Scope trace{"MainWindow::open"};
             mainWindow->open();
+            // Deferred until the window's initial show and paint events have been processed
+            QTimer::singleShot(0, self, [this]() { pluginManager->initialiseLazyPlugins(); });
             if(settingsManager->value<Settings::Core::FirstRun>()) {
                 QMetaObject::invokeMethod(editableLayout.get(), &EditableLayout::showQuickSetup, Qt::QueuedConnection);
             }
         };
 
-        if(libraryManager->hasLibrary() && library->isEmpty()
+        // Views are covered by previews of their last state while the library loads
+        if(libraryManager->hasLibrary() && library->isEmpty() && !ViewPreview::exists()
            && settingsManager->value<Settings::Gui::WaitForTracks>()) {
             connect(library, &MusicLibrary::tracksLoaded, openMainWindow);
         }
@@ -239,6 +266,8 @@ struct GuiApplication::Private
 
     void initialisePlugins()
     {
+        const StartupTrace::Scope trace{"GuiApplication::initialisePlugins"};
+
         if(pluginManager->allPluginInfo().empty()) {
             QMetaObject::invokeMethod(
                 self, []() { showPluginsNotFoundMessage(); }, Qt::QueuedConnection);
@@ -247,6 +276,18 @@ struct GuiApplication::Private
 
         pluginManager->initialisePlugins<GuiPlugin>(
             [this](GuiPlugin* plugin) { plugin->initialise(guiPluginContext); });
+
+        // Lazy plugins used by the layout are initialised as it loads
+        for(const auto& [name, plugin] : pluginManager->allPluginInfo()) {
+            if(!plugin->isLazy() || plugin->isLoaded() || plugin->isDisabled()) {
+                continue;
+            }
+            for(const auto& widget : plugin->widgets()) {
+                widgetProvider.registerPlaceholder(
+                    widget.key, [this, info = plugin.get()]() { pluginManager->initialiseLazyPlugin(info); },
+                    widget.name);
+            }
+        }
     }
 
     static void showPluginsNotFoundMessage()
@@ -309,6 +350,9 @@ struct GuiApplication::Private
     {
         QObject::connect(library, &MusicLibrary::tracksUpdated, self,
                          [](const TrackList& tracks) { removeExpiredCovers(tracks); });
+        // Loads the upcoming track's cover into the shared cache so it's shown as soon as the track starts
+        QObject::connect(playlistHandler, &PlaylistHandler::upcomingTrack, coverPrefetcher,
+                         [this](const Track& track) { std::ignore = coverPrefetcher->trackCover(track); });
 
         QObject::connect(playerController, &PlayerController::playStateChanged, mainWindow.get(),
                          [this](PlayState state) {
@@ -332,9 +376,12 @@ struct GuiApplication::Private
         });
         QObject::connect(fileMenu, &FileMenu::requestAddFiles, self, [this]() { addFiles(); });
         QObject::connect(fileMenu, &FileMenu::requestAddFolders, self, [this]() { addFolders(); });
+        QObject::connect(fileMenu, &FileMenu::requestImportPlaylist, self, [this]() { importPlaylist(); });
+        QObject::connect(fileMenu, &FileMenu::requestExportPlaylist, self, [this]() { exportPlaylist(); });
         QObject::connect(viewMenu, &ViewMenu::openQuickSetup, editableLayout.get(), &EditableLayout::showQuickSetup);
         QObject::connect(viewMenu, &ViewMenu::openScriptSandbox, self, [this]() {
-            auto* sandboxDialog = new SandboxDialog(&selectionController, settingsManager, mainWindow.get());
+            auto* sandboxDialog
+                = new SandboxDialog(&selectionController, library, settingsManager, mainWindow.get());
             sandboxDialog->setAttribute(Qt::WA_DeleteOnClose);
             sandboxDialog->show();
         });
@@ -346,8 +393,9 @@ struct GuiApplication::Private
         });
         QObject::connect(engine, &EngineController::trackStatusChanged, self, [this](TrackStatus status) {
             if(status == TrackStatus::InvalidTrack) {
-                const Track track = playerController->currentTrack();
-                if(track.isValid() && !QFileInfo::exists(track.filepath())) {
+                const Track track      = playerController->currentTrack();
+                const QString filepath = track.isInArchive() ? track.archivePath() : track.filepath();
+                if(track.isValid() && !QFileInfo::exists(filepath)) {
                     showTrackNotFoundMessage(track);
                 }
             }
@@ -370,6 +418,49 @@ struct GuiApplication::Private
                     settingsManager->value<Settings::Core::Internal::MuteVolume>());
             }
         });
+
+        auto* selectionMenu  = actionManager->actionContainer(Constants::Menus::Context::TrackSelection);
+        auto* replayGainMenu = actionManager->createMenu("Fooyin.Menu.ReplayGain");
+        replayGainMenu->menu()->setTitle(tr("ReplayGain"));
+        selectionMenu->addMenu(replayGainMenu);
+
+        auto* calculateGain = new QAction(tr("Calculate ReplayGain"), mainWindow.get());
+        QObject::connect(calculateGain, &QAction::triggered, mainWindow.get(),
+                         [this]() { calculateReplayGain(false); });
+        replayGainMenu->addAction(actionManager->registerAction(calculateGain, "TrackSelection.CalculateReplayGain"));
+
+        auto* recalculateGain = new QAction(tr("Recalculate ReplayGain"), mainWindow.get());
+        QObject::connect(recalculateGain, &QAction::triggered, mainWindow.get(),
+                         [this]() { calculateReplayGain(true); });
+        replayGainMenu->addAction(
+            actionManager->registerAction(recalculateGain, "TrackSelection.RecalculateReplayGain"));
+    }
+
+    void calculateReplayGain(bool recalculate)
+    {
+        const TrackList tracks = selectionController.selectedTracks();
+        if(tracks.empty()) {
+            return;
+        }
+
+        auto* gainDialog = new QProgressDialog(tr("Calculating ReplayGain…"), tr("Abort"), 0, 100, mainWindow.get());
+        gainDialog->setAttribute(Qt::WA_DeleteOnClose);
+        gainDialog->setWindowModality(Qt::WindowModal);
+
+        const ScanRequest request = library->calculateReplayGain(tracks, recalculate);
+
+        QObject::connect(library, &MusicLibrary::scanProgress, gainDialog, [gainDialog, request](int id, int percent) {
+            if(id != request.id) {
+                return;
+            }
+
+            if(gainDialog->wasCanceled()) {
+                request.cancel();
+                gainDialog->close();
+            }
+
+            gainDialog->setValue(percent);
+        });
     }
 
     void restoreIconTheme()
@@ -517,11 +608,40 @@ struct GuiApplication::Private
         widgetProvider.registerWidget(
             QStringLiteral("Playlist"),
             [this]() {
-                return new PlaylistWidget(actionManager, &playlistInteractor, settingsManager, mainWindow.get());
+                return new PlaylistWidget(actionManager, &playlistInteractor, playlistProfiler, settingsManager,
+                                          mainWindow.get());
             },
             tr("Playlist"));
         widgetProvider.setLimit(QStringLiteral("Playlist"), 1);
 
+        widgetProvider.registerWidget(
+            QStringLiteral("PlaylistStatistics"),
+            [this]() { return new PlaylistStatsWidget(&playlistInteractor, playlistProfiler, mainWindow.get()); },
+            tr("Playlist Statistics"));
+        widgetProvider.setSubMenus(QStringLiteral("PlaylistStatistics"), {tr("Debug")});
+        widgetProvider.setLimit(QStringLiteral("PlaylistStatistics"), 1);
+
+        widgetProvider.registerWidget(
+            QStringLiteral("EngineStatistics"), [this]() { return new EngineStatsWidget(engine, mainWindow.get()); },
+            tr("Engine Statistics"));
+        widgetProvider.setSubMenus(QStringLiteral("EngineStatistics"), {tr("Debug")});
+
+        widgetProvider.registerWidget(
+            QStringLiteral("Spectrum"),
+            [this]() { return new SpectrumWidget(engine, playerController, mainWindow.get()); }, tr("Spectrum"));
+        widgetProvider.setSubMenus(QStringLiteral("Spectrum"), {tr("Visualisations")});
+
+        widgetProvider.registerWidget(
+            QStringLiteral("Spectrogram"),
+            [this]() { return new SpectrogramWidget(engine, playerController, mainWindow.get()); },
+            tr("Spectrogram"));
+        widgetProvider.setSubMenus(QStringLiteral("Spectrogram"), {tr("Visualisations")});
+
+        widgetProvider.registerWidget(
+            QStringLiteral("VuMeter"),
+            [this]() { return new VuMeterWidget(engine, playerController, mainWindow.get()); }, tr("VU Meter"));
+        widgetProvider.setSubMenus(QStringLiteral("VuMeter"), {tr("Visualisations")});
+
         widgetProvider.registerWidget(
             QStringLiteral("Spacer"), [this]() { return new Spacer(mainWindow.get()); }, tr("Spacer"));
 
@@ -612,9 +732,40 @@ struct GuiApplication::Private
         playlistInteractor.filesToCurrentPlaylist({dirs});
     }
 
+    [[nodiscard]] static QString playlistFilter()
+    {
+        QStringList patterns;
+        std::ranges::transform(PlaylistParser::supportedExtensions(), std::back_inserter(patterns),
+                               [](const QString& extension) { return QStringLiteral("*.") + extension; });
+        return tr("Playlists (%1)").arg(patterns.join(QStringLiteral(" ")));
+    }
+
+    void importPlaylist() const
+    {
+        const QString file = QFileDialog::getOpenFileName(mainWindow.get(), tr("Import Playlist"), QStringLiteral(""),
+                                                          playlistFilter());
+        if(!file.isEmpty()) {
+            playlistInteractor.importPlaylist(file);
+        }
+    }
+
+    void exportPlaylist() const
+    {
+        const auto* playlist = playlistController->currentPlaylist();
+        if(!playlist) {
+            return;
+        }
+
+        const QString file = QFileDialog::getSaveFileName(mainWindow.get(), tr("Export Playlist"),
+                                                          playlist->name() + QStringLiteral(".m3u8"), playlistFilter());
+        if(!file.isEmpty()) {
+            playlistInteractor.exportPlaylist(playlist, file);
+        }
+    }
+
     void openFiles(const QList<QUrl>& urls) const
     {
-        playlistInteractor.filesToNewPlaylist(QStringLiteral("Default"), urls, true);
+        playlistInteractor.streamFilesToPlaylist(QStringLiteral("Default"), urls, true);
     }
 };
 
@@ -625,8 +776,14 @@ GuiApplication::GuiApplication(const CorePluginContext& core)
         QPixmapCache::setCacheLimit(sizeMb * 1024);
     };
 
+    auto updateCoverCache = [](const int sizeMb) {
+        CoverProvider::setCacheBudget(static_cast<size_t>(sizeMb) * 1024 * 1024);
+    };
+
     updateCache(p->settingsManager->value<Settings::Gui::Internal::PixmapCacheSize>());
     p->settingsManager->subscribe<Settings::Gui::Internal::PixmapCacheSize>(this, updateCache);
+    updateCoverCache(p->settingsManager->value<Settings::Gui::Internal::ArtworkCacheSize>());
+    p->settingsManager->subscribe<Settings::Gui::Internal::ArtworkCacheSize>(this, updateCoverCache);
     p->settingsManager->subscribe<Settings::Gui::Internal::ArtworkThumbnailSize>(this, CoverProvider::clearCache);
 
     QObject::connect(p->settingsManager->settingsDialog(), &SettingsDialogController::opening, this, [this]() {
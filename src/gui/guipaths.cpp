@@ -38,4 +38,9 @@ QString coverPath()
 {
     return Utils::cachePath(QStringLiteral("covers")).append(QStringLiteral("/"));
 }
+
+QString previewPath()
+{
+    return Utils::cachePath(QStringLiteral("previews")).append(QStringLiteral("/"));
+}
 } // namespace Fooyin::Gui
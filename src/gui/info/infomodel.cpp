@@ -19,20 +19,299 @@
 
 #include "infomodel.h"
 
+#include <core/library/tracklistdiff.h>
 #include <core/player/playercontroller.h>
 #include <core/track.h>
+#include <utils/async.h>
 #include <utils/enum.h>
 #include <utils/utils.h>
+#include <utils/valuetally.h>
 
 #include <QCollator>
 #include <QFileInfo>
 #include <QFont>
 
 #include <algorithm>
+#include <array>
+#include <bitset>
+#include <optional>
 
 constexpr auto HeaderFontDelta = 2;
+// Selections up to this many tracks (old and new together) are aggregated in place, larger ones on a worker
+constexpr size_t SyncTrackLimit = 2000;
+// Fields listing their distinct values stop collecting them past this many
+constexpr size_t MaxListedValues = 41;
 
 namespace {
+using Fooyin::InfoModel;
+using Fooyin::Track;
+using Fooyin::TrackList;
+using Fooyin::ValueTally;
+
+// Fields aggregated as a set of distinct values
+enum class Field : uint8_t
+{
+    // Listed
+    Artist = 0,
+    Title,
+    Album,
+    Date,
+    Genre,
+    AlbumArtist,
+    TrackNumber,
+    FileName,
+    FolderName,
+    // Shown as a percentage of tracks
+    Channels,
+    BitDepth,
+    SampleRate,
+    Codec,
+    Count
+};
+
+constexpr auto FieldCount = static_cast<size_t>(Field::Count);
+using FieldSet            = std::bitset<FieldCount>;
+
+constexpr bool isListed(Field field)
+{
+    return field < Field::Channels;
+}
+
+FieldSet fieldsForOptions(InfoModel::Options options)
+{
+    FieldSet fields;
+    for(size_t i{0}; i < FieldCount; ++i) {
+        const auto field = static_cast<Field>(i);
+        if(field <= Field::TrackNumber) {
+            fields.set(i, options.testFlag(InfoModel::Metadata));
+        }
+        else if(field <= Field::FolderName) {
+            fields.set(i, options.testFlag(InfoModel::Location));
+        }
+        else {
+            fields.set(i, options.testFlag(InfoModel::General));
+        }
+    }
+    return fields;
+}
+
+// Calls @p func with each value of @p track for the fields in @p fields
+template <typename Func>
+void forEachValue(const Track& track, const FieldSet& fields, Func&& func)
+{
+    const auto has = [&fields](Field field) {
+        return fields.test(static_cast<size_t>(field));
+    };
+
+    if(has(Field::Artist)) {
+        func(Field::Artist, track.artists());
+    }
+    if(has(Field::Title)) {
+        func(Field::Title, track.title());
+    }
+    if(has(Field::Album)) {
+        func(Field::Album, track.album());
+    }
+    if(has(Field::Date)) {
+        func(Field::Date, track.date());
+    }
+    if(has(Field::Genre)) {
+        func(Field::Genre, track.genres());
+    }
+    if(has(Field::AlbumArtist)) {
+        func(Field::AlbumArtist, track.albumArtist());
+    }
+    if(has(Field::TrackNumber) && track.trackNumber() >= 0) {
+        func(Field::TrackNumber, QString::number(track.trackNumber()));
+    }
+    if(has(Field::FileName) || has(Field::FolderName)) {
+        const QFileInfo file{track.filepath()};
+        if(has(Field::FileName)) {
+            func(Field::FileName, file.fileName());
+        }
+        if(has(Field::FolderName)) {
+            func(Field::FolderName, file.absolutePath());
+        }
+    }
+    if(has(Field::Channels)) {
+        func(Field::Channels, QString::number(std::max(track.channels(), 0)));
+    }
+    if(has(Field::BitDepth) && track.bitDepth() > 0) {
+        func(Field::BitDepth, QString::number(track.bitDepth()));
+    }
+    if(has(Field::SampleRate)) {
+        func(Field::SampleRate, QStringLiteral("%1 Hz").arg(track.sampleRate()));
+    }
+    if(has(Field::Codec)) {
+        func(Field::Codec, track.typeString());
+    }
+}
+
+// The largest of a set of values, with how often it occurs so removals can tell when it has to be found again
+struct MaxValue
+{
+    uint64_t value{0};
+    int count{0};
+
+    void add(uint64_t newValue)
+    {
+        if(count == 0 || newValue > value) {
+            value = newValue;
+            count = 1;
+        }
+        else if(newValue == value) {
+            ++count;
+        }
+    }
+
+    // Returns false if the last occurrence of the maximum was removed
+    bool remove(uint64_t oldValue)
+    {
+        return oldValue != value || --count > 0;
+    }
+};
+
+/*!
+ * Everything shown for a selection, kept so the next selection can be worked out from the tracks added
+ * and removed rather than from scratch.
+ */
+struct InfoAggregate
+{
+    InfoModel::Options options;
+    FieldSet fields;
+    std::array<ValueTally, FieldCount> tallies;
+
+    int total{0};
+    uint64_t fileSize{0};
+    uint64_t duration{0};
+    uint64_t bitrate{0};
+    MaxValue modified;
+
+    // Fields whose removals couldn't be applied, to be collected again from the full selection
+    FieldSet stale;
+    bool modifiedStale{false};
+
+    explicit InfoAggregate(InfoModel::Options options_ = InfoModel::Default)
+        : options{options_}
+        , fields{fieldsForOptions(options_)}
+    {
+        resetTallies(FieldSet{}.set());
+    }
+
+    [[nodiscard]] const ValueTally& tally(Field field) const
+    {
+        return tallies.at(static_cast<size_t>(field));
+    }
+
+    void resetTallies(const FieldSet& reset)
+    {
+        for(size_t i{0}; i < FieldCount; ++i) {
+            if(reset.test(i)) {
+                tallies.at(i) = ValueTally{isListed(static_cast<Field>(i)) ? MaxListedValues : ValueTally::Unlimited};
+            }
+        }
+    }
+
+    // The fields still collecting values, i.e. those which haven't reached their limit
+    [[nodiscard]] FieldSet collecting(const FieldSet& from) const
+    {
+        FieldSet result{from};
+        for(size_t i{0}; i < FieldCount; ++i) {
+            if(tallies.at(i).overflowed()) {
+                result.reset(i);
+            }
+        }
+        return result;
+    }
+
+    void addValues(const Track& track, const FieldSet& which)
+    {
+        forEachValue(track, which, [this](Field field, const auto& value) {
+            tallies.at(static_cast<size_t>(field)).add(value);
+        });
+    }
+
+    void add(const Track& track)
+    {
+        ++total;
+        fileSize += track.fileSize();
+        duration += track.duration();
+        bitrate += static_cast<uint64_t>(std::max(track.bitrate(), 0));
+        modified.add(track.modifiedTime());
+
+        addValues(track, collecting(fields));
+    }
+
+    void remove(const Track& track)
+    {
+        --total;
+        fileSize -= track.fileSize();
+        duration -= track.duration();
+        bitrate -= static_cast<uint64_t>(std::max(track.bitrate(), 0));
+        if(!modified.remove(track.modifiedTime())) {
+            modifiedStale = true;
+        }
+
+        forEachValue(track, fields & ~stale, [this](Field field, const auto& value) {
+            if(!tallies.at(static_cast<size_t>(field)).remove(value)) {
+                stale.set(static_cast<size_t>(field));
+            }
+        });
+    }
+
+    // Collects any stale fields again from @p tracks, stopping once they've all reached their limit
+    void refresh(const TrackList& tracks)
+    {
+        if(stale.none() && !modifiedStale) {
+            return;
+        }
+
+        resetTallies(stale);
+        if(modifiedStale) {
+            modified = {};
+        }
+
+        for(const Track& track : tracks) {
+            const FieldSet pending = collecting(stale);
+            if(pending.none() && !modifiedStale) {
+                break;
+            }
+            if(modifiedStale) {
+                modified.add(track.modifiedTime());
+            }
+            addValues(track, pending);
+        }
+
+        stale.reset();
+        modifiedStale = false;
+    }
+};
+
+InfoAggregate aggregateTracks(std::optional<InfoAggregate> previous, const TrackList& previousTracks,
+                              const TrackList& tracks, InfoModel::Options options)
+{
+    if(previous && previous->options == options) {
+        // Growing or shrinking a large selection only needs the difference applied
+        if(const auto diff = Fooyin::diffTracks(previousTracks, tracks);
+           diff && diff->added.size() + diff->removed.size() < tracks.size()) {
+            for(const Track& track : diff->removed) {
+                previous->remove(track);
+            }
+            for(const Track& track : diff->added) {
+                previous->add(track);
+            }
+            previous->refresh(tracks);
+            return std::move(*previous);
+        }
+    }
+
+    InfoAggregate aggregate{options};
+    for(const Track& track : tracks) {
+        aggregate.add(track);
+    }
+    return aggregate;
+}
+
 QString formatPercentage(const std::map<QString, int>& values)
 {
     if(values.size() == 1) {
@@ -44,51 +323,36 @@ QString formatPercentage(const std::map<QString, int>& values)
         count += value;
     }
 
-    std::map<QString, double> ratios;
-    for(const auto& [key, value] : values) {
-        ratios[key] = (static_cast<double>(value) / count) * 100;
-    }
-
     QStringList formattedList;
-    for(const auto& [key, value] : ratios) {
-        formattedList.append(QStringLiteral("%1 (%2%)").arg(key, QString::number(value, 'f', 1)));
+    for(const auto& [key, value] : values) {
+        const double ratio = (static_cast<double>(value) / count) * 100;
+        formattedList.append(QStringLiteral("%1 (%2%)").arg(key, QString::number(ratio, 'f', 1)));
     }
 
     return formattedList.join(u"; ");
 }
 
-QString sortJoinSet(const std::set<QString>& values)
+QString sortJoin(QStringList values)
 {
-    QStringList list;
-    for(const QString& value : values) {
-        list.append(value);
-    }
-
     QCollator collator;
     collator.setNumericMode(true);
 
-    std::ranges::sort(list, collator);
+    std::ranges::sort(values, collator);
 
-    return list.join(u"; ");
+    return values.join(u"; ");
 }
 } // namespace
 
 namespace Fooyin {
 InfoItem::InfoItem()
-    : InfoItem{Header, QStringLiteral(""), nullptr, ValueType::Concat, {}}
+    : InfoItem{Header, QStringLiteral(""), nullptr}
 { }
 
-InfoItem::InfoItem(ItemType type, QString name, InfoItem* parent, ValueType valueType)
-    : InfoItem{type, std::move(name), parent, valueType, {}}
-{ }
-
-InfoItem::InfoItem(ItemType type, QString name, InfoItem* parent, ValueType valueType, FormatFunc numFunc)
+InfoItem::InfoItem(ItemType type, QString name, InfoItem* parent, QVariant value)
     : TreeItem{parent}
     , m_type{type}
-    , m_valueType{valueType}
     , m_name{std::move(name)}
-    , m_numValue{0}
-    , m_formatNum{std::move(numFunc)}
+    , m_value{std::move(value)}
 { }
 
 InfoItem::ItemType InfoItem::type() const
@@ -103,86 +367,9 @@ QString InfoItem::name() const
 
 QVariant InfoItem::value() const
 {
-    switch(m_valueType) {
-        case(ValueType::Concat): {
-            if(m_value.isEmpty()) {
-                m_value = sortJoinSet(m_values);
-            }
-            return m_value;
-        }
-        case(ValueType::Percentage): {
-            if(m_value.isEmpty()) {
-                m_value = formatPercentage(m_percentValues);
-            }
-            return m_value;
-        }
-        case(ValueType::Average):
-            if(m_numValue == 0 && !m_numValues.empty()) {
-                m_numValue = std::reduce(m_numValues.cbegin(), m_numValues.cend()) / m_numValues.size();
-            }
-            // Fallthrough
-        case(ValueType::Total):
-        case(ValueType::Max):
-            if(m_formatNum) {
-                return m_formatNum(m_numValue);
-            }
-            return QVariant::fromValue(m_numValue);
-    }
     return m_value;
 }
 
-void InfoItem::addTrackValue(uint64_t value)
-{
-    switch(m_valueType) {
-        case(ValueType::Concat):
-            addTrackValue(QString::number(value));
-            break;
-        case(ValueType::Average):
-            m_numValues.push_back(value);
-            break;
-        case(ValueType::Total):
-            m_numValue += value;
-            break;
-        case(ValueType::Max):
-            m_numValue = std::max(m_numValue, value);
-            break;
-        case(ValueType::Percentage):
-            m_percentValues[QString::number(value)]++;
-            break;
-    }
-}
-
-void InfoItem::addTrackValue(int value)
-{
-    value = std::max(value, 0);
-    addTrackValue(static_cast<uint64_t>(value));
-}
-
-void InfoItem::addTrackValue(const QString& value)
-{
-    if(value.isEmpty()) {
-        return;
-    }
-
-    if(m_valueType == ValueType::Percentage) {
-        m_percentValues[value]++;
-        return;
-    }
-
-    if(m_values.size() > 40) {
-        return;
-    }
-
-    m_values.emplace(value);
-}
-
-void InfoItem::addTrackValue(const QStringList& values)
-{
-    for(const auto& strValue : values) {
-        addTrackValue(strValue);
-    }
-}
-
 struct InfoModel::Private
 {
     InfoModel* self;
@@ -192,6 +379,12 @@ struct InfoModel::Private
     Options options{Default};
     QFont headerFont;
 
+    // The selection shown and its aggregate, which the next selection is worked out from
+    TrackList tracks;
+    std::optional<InfoAggregate> aggregate;
+    // Identifies the latest reset, so results of earlier ones finishing later are dropped
+    uint64_t generation{0};
+
     explicit Private(InfoModel* self_)
         : self{self_}
     {
@@ -205,7 +398,7 @@ struct InfoModel::Private
     }
 
     InfoItem* getOrAddNode(const QString& key, const QString& name, ItemParent parent, InfoItem::ItemType type,
-                           InfoItem::ValueType valueType = InfoItem::Concat, InfoItem::FormatFunc numFunc = {})
+                           QVariant value = {})
     {
         if(key.isEmpty() || name.isEmpty()) {
             return nullptr;
@@ -231,7 +424,7 @@ struct InfoModel::Private
             return nullptr;
         }
 
-        InfoItem item{type, name, parentItem, valueType, std::move(numFunc)};
+        InfoItem item{type, name, parentItem, std::move(value)};
         InfoItem* node = &nodes.emplace(key, std::move(item)).first->second;
         parentItem->appendChild(node);
 
@@ -251,107 +444,111 @@ struct InfoModel::Private
         }
     }
 
-    void checkAddEntryNode(const QString& key, const QString& name, InfoModel::ItemParent parent)
-    {
-        checkAddParentNode(parent);
-        getOrAddNode(key, name, parent, InfoItem::Entry);
-    }
-
-    template <typename Value>
-    void checkAddEntryNode(const QString& key, const QString& name, InfoModel::ItemParent parent, Value&& value,
-                           InfoItem::ValueType valueType = InfoItem::ValueType::Concat,
-                           InfoItem::FormatFunc numFunc  = {})
+    void checkAddEntryNode(const QString& key, const QString& name, InfoModel::ItemParent parent,
+                           const QVariant& value)
     {
-        if constexpr(std::is_same_v<Value, QString> || std::is_same_v<Value, QStringList>) {
-            if(value.isEmpty()) {
-                return;
-            }
+        if(value.typeId() == QMetaType::QString && value.toString().isEmpty()) {
+            return;
         }
 
         checkAddParentNode(parent);
-        auto* node = getOrAddNode(key, name, parent, InfoItem::Entry, valueType, std::move(numFunc));
-        node->addTrackValue(std::forward<Value>(value));
+        getOrAddNode(key, name, parent, InfoItem::Entry, value);
     }
 
-    void addTrackMetadata(const Track& track)
+    void addListedNode(const InfoAggregate& info, Field field, const QString& key, const QString& name,
+                       InfoModel::ItemParent parent)
     {
-        if(const auto artists = track.artists(); !artists.empty()) {
-            checkAddEntryNode(QStringLiteral("Artist"), tr("Artist"), ItemParent::Metadata, artists);
+        if(const auto& tally = info.tally(field); !tally.empty()) {
+            checkAddEntryNode(key, name, parent, sortJoin(tally.values()));
         }
+    }
 
-        checkAddEntryNode(QStringLiteral("Title"), tr("Title"), ItemParent::Metadata, track.title());
-        checkAddEntryNode(QStringLiteral("Album"), tr("Album"), ItemParent::Metadata, track.album());
-        checkAddEntryNode(QStringLiteral("Date"), tr("Date"), ItemParent::Metadata, track.date());
-        checkAddEntryNode(QStringLiteral("Genre"), tr("Genre"), ItemParent::Metadata, track.genres());
-        checkAddEntryNode(QStringLiteral("AlbumArtist"), tr("Album Artist"), ItemParent::Metadata, track.albumArtist());
-
-        if(const int trackNumber = track.trackNumber(); trackNumber >= 0) {
-            checkAddEntryNode(QStringLiteral("TrackNumber"), tr("Track Number"), ItemParent::Metadata, trackNumber);
+    void addPercentageNode(const InfoAggregate& info, Field field, const QString& key, const QString& name)
+    {
+        if(const auto& tally = info.tally(field); !tally.empty()) {
+            checkAddEntryNode(key, name, ItemParent::General, formatPercentage(tally.counts()));
         }
     }
 
-    void addTrackLocation(int total, const Track& track)
+    void addMetadataNodes(const InfoAggregate& info)
     {
-        const QFileInfo file{track.filepath()};
+        addListedNode(info, Field::Artist, QStringLiteral("Artist"), tr("Artist"), ItemParent::Metadata);
+        addListedNode(info, Field::Title, QStringLiteral("Title"), tr("Title"), ItemParent::Metadata);
+        addListedNode(info, Field::Album, QStringLiteral("Album"), tr("Album"), ItemParent::Metadata);
+        addListedNode(info, Field::Date, QStringLiteral("Date"), tr("Date"), ItemParent::Metadata);
+        addListedNode(info, Field::Genre, QStringLiteral("Genre"), tr("Genre"), ItemParent::Metadata);
+        addListedNode(info, Field::AlbumArtist, QStringLiteral("AlbumArtist"), tr("Album Artist"),
+                      ItemParent::Metadata);
+        addListedNode(info, Field::TrackNumber, QStringLiteral("TrackNumber"), tr("Track Number"),
+                      ItemParent::Metadata);
+    }
+
+    void addLocationNodes(const InfoAggregate& info)
+    {
+        const int total = info.total;
 
-        checkAddEntryNode(QStringLiteral("FileName"), total > 1 ? tr("File Names") : tr("File Name"),
-                          ItemParent::Location, file.fileName());
-        checkAddEntryNode(QStringLiteral("FolderName"), total > 1 ? tr("Folder Names") : tr("Folder Name"),
-                          ItemParent::Location, file.absolutePath());
+        addListedNode(info, Field::FileName, QStringLiteral("FileName"),
+                      total > 1 ? tr("File Names") : tr("File Name"), ItemParent::Location);
+        addListedNode(info, Field::FolderName, QStringLiteral("FolderName"),
+                      total > 1 ? tr("Folder Names") : tr("Folder Name"), ItemParent::Location);
 
         if(total == 1) {
-            checkAddEntryNode(QStringLiteral("FilePath"), tr("File Path"), ItemParent::Location, track.filepath());
+            checkAddEntryNode(QStringLiteral("FilePath"), tr("File Path"), ItemParent::Location,
+                              tracks.front().filepath());
         }
 
         checkAddEntryNode(QStringLiteral("FileSize"), total > 1 ? tr("Total Size") : tr("File Size"),
-                          ItemParent::Location, track.fileSize(), InfoItem::Total,
-                          [](uint64_t size) -> QString { return Utils::formatFileSize(size, true); });
+                          ItemParent::Location, Utils::formatFileSize(info.fileSize, true));
         checkAddEntryNode(QStringLiteral("LastModified"), tr("Last Modified"), ItemParent::Location,
-                          track.modifiedTime(), InfoItem::Max, Utils::formatTimeMs);
+                          Utils::formatTimeMs(info.modified.value));
 
         if(total == 1) {
-            checkAddEntryNode(QStringLiteral("Added"), tr("Added"), ItemParent::Location, track.addedTime(),
-                              InfoItem::Max, Utils::formatTimeMs);
+            checkAddEntryNode(QStringLiteral("Added"), tr("Added"), ItemParent::Location,
+                              Utils::formatTimeMs(tracks.front().addedTime()));
         }
     }
 
-    void addTrackGeneral(int total, const Track& track)
+    void addGeneralNodes(const InfoAggregate& info)
     {
+        const int total = info.total;
+
         if(total > 1) {
-            checkAddEntryNode(QStringLiteral("Tracks"), tr("Tracks"), ItemParent::General, total, InfoItem::Total);
+            checkAddEntryNode(QStringLiteral("Tracks"), tr("Tracks"), ItemParent::General, total);
         }
 
-        checkAddEntryNode(QStringLiteral("Duration"), tr("Duration"), ItemParent::General, track.duration(),
-                          InfoItem::Total, Utils::msToStringExtended);
-        checkAddEntryNode(QStringLiteral("Channels"), tr("Channels"), ItemParent::General, track.channels(),
-                          InfoItem::Percentage);
-
-        if(const int bitDepth = track.bitDepth(); bitDepth > 0) {
-            checkAddEntryNode(QStringLiteral("BitDepth"), tr("Bit Depth"), ItemParent::General, bitDepth,
-                              InfoItem::Percentage);
-        }
+        checkAddEntryNode(QStringLiteral("Duration"), tr("Duration"), ItemParent::General,
+                          Utils::msToStringExtended(info.duration));
+        addPercentageNode(info, Field::Channels, QStringLiteral("Channels"), tr("Channels"));
+        addPercentageNode(info, Field::BitDepth, QStringLiteral("BitDepth"), tr("Bit Depth"));
 
+        const uint64_t bitrate = info.bitrate / static_cast<uint64_t>(total);
         checkAddEntryNode(QStringLiteral("Bitrate"), total > 1 ? tr("Avg. Bitrate") : tr("Bitrate"),
-                          ItemParent::General, track.bitrate(), InfoItem::Average, [](uint64_t bitrate) -> QString {
-                              return QString::number(bitrate) + QStringLiteral(" kbps");
-                          });
-        checkAddEntryNode(QStringLiteral("SampleRate"), tr("Sample Rate"), ItemParent::General,
-                          QStringLiteral("%1 Hz").arg(track.sampleRate()), InfoItem::Percentage);
-        checkAddEntryNode(QStringLiteral("Codec"), tr("Codec"), ItemParent::General, track.typeString(),
-                          InfoItem::Percentage);
+                          ItemParent::General, QString::number(bitrate) + QStringLiteral(" kbps"));
+        addPercentageNode(info, Field::SampleRate, QStringLiteral("SampleRate"), tr("Sample Rate"));
+        addPercentageNode(info, Field::Codec, QStringLiteral("Codec"), tr("Codec"));
     }
 
-    void addTrackNodes(int total, const Track& track)
+    void applyAggregate(TrackList newTracks, InfoAggregate info)
     {
-        if(options & Metadata) {
-            addTrackMetadata(track);
-        }
-        if(options & Location) {
-            addTrackLocation(total, track);
-        }
-        if(options & General) {
-            addTrackGeneral(total, track);
+        tracks = std::move(newTracks);
+        aggregate.emplace(std::move(info));
+
+        self->beginResetModel();
+        reset();
+
+        if(aggregate->total > 0) {
+            if(options & Metadata) {
+                addMetadataNodes(*aggregate);
+            }
+            if(options & Location) {
+                addLocationNodes(*aggregate);
+            }
+            if(options & General) {
+                addGeneralNodes(*aggregate);
+            }
         }
+
+        self->endResetModel();
     }
 };
 
@@ -453,18 +650,25 @@ void InfoModel::resetModel(const TrackList& tracks, const Track& playingTrack)
         infoTracks.push_back(playingTrack);
     }
 
-    beginResetModel();
-    p->reset();
+    const uint64_t generation = ++p->generation;
+    const bool inPlace        = infoTracks.size() + p->tracks.size() <= SyncTrackLimit;
 
-    const int total = static_cast<int>(infoTracks.size());
+    auto aggregate = [previous = p->aggregate, previousTracks = p->tracks, infoTracks, options = p->options]() {
+        return aggregateTracks(previous, previousTracks, infoTracks, options);
+    };
 
-    if(total > 0) {
-        for(const Track& track : infoTracks) {
-            p->addTrackNodes(total, track);
-        }
+    if(inPlace) {
+        p->applyAggregate(infoTracks, aggregate());
+        return;
     }
 
-    endResetModel();
+    // The current selection stays on show until the new one is ready
+    Utils::asyncExec(std::move(aggregate))
+        .then(this, [this, generation, infoTracks](const InfoAggregate& info) {
+            if(generation == p->generation) {
+                p->applyAggregate(infoTracks, info);
+            }
+        });
 }
 } // namespace Fooyin
 
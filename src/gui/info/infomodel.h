@@ -23,8 +23,6 @@
 #include <utils/treeitem.h>
 #include <utils/treemodel.h>
 
-#include <set>
-
 namespace Fooyin {
 class InfoItem : public TreeItem<InfoItem>
 {
@@ -41,42 +39,17 @@ public:
         Value
     };
 
-    enum ValueType
-    {
-        Concat,
-        Average,
-        Total,
-        Max,
-        Percentage
-    };
-
-    using FormatFunc = std::function<QString(uint64_t)>;
-
     InfoItem();
-    InfoItem(ItemType type, QString name, InfoItem* parent, ValueType valueType);
-    InfoItem(ItemType type, QString name, InfoItem* parent, ValueType valueType, FormatFunc numFunc);
+    InfoItem(ItemType type, QString name, InfoItem* parent, QVariant value = {});
 
     [[nodiscard]] ItemType type() const;
     [[nodiscard]] QString name() const;
     [[nodiscard]] QVariant value() const;
 
-    void addTrackValue(uint64_t value);
-    void addTrackValue(int value);
-    void addTrackValue(const QString& value);
-    void addTrackValue(const QStringList& values);
-
 private:
     ItemType m_type;
-    ValueType m_valueType;
-
     QString m_name;
-    std::vector<uint64_t> m_numValues;
-    mutable uint64_t m_numValue;
-    std::set<QString> m_values;
-    std::map<QString, int> m_percentValues;
-    mutable QString m_value;
-
-    FormatFunc m_formatNum;
+    QVariant m_value;
 };
 
 class InfoModel : public TreeModel<InfoItem>
@@ -120,7 +120,7 @@ struct InfoWidget::Private
     void resetModel()
     {
         scrollPos = view->verticalScrollBar()->value();
-        model->resetModel(selectionController->selectedTracks(), playerController->currentTrack());
+        model->resetModel(selectionController->selection().tracks(), playerController->currentTrack());
     }
 };
 
@@ -120,5 +120,8 @@ GuiSettings::GuiSettings(SettingsManager* settingsManager)
     m_settings->createSetting<Internal::ShowTrayIcon>(false, QStringLiteral("Interface/ShowTrayIcon"));
     m_settings->createSetting<Internal::TrayOnClose>(true, QStringLiteral("Interface/TrayOnClose"));
     m_settings->createSetting<Internal::LibTreeKeepAlive>(false, QStringLiteral("LibraryTree/KeepAlive"));
+    m_settings->createSetting<Internal::PlaylistLazyColumns>(false, QStringLiteral("PlaylistWidget/LazyColumns"));
+    m_settings->createSetting<Internal::ArtworkCacheSize>(64, QStringLiteral("Artwork/CacheSize"));
+    m_settings->createSetting<Internal::MemoryBudget>(0, QStringLiteral("Interface/MemoryBudget"));
 }
 } // namespace Fooyin
@@ -115,6 +115,9 @@ enum GuiInternalSettings : uint32_t
     ShowTrayIcon            = 47 | Type::Bool,
     TrayOnClose             = 48 | Type::Bool,
     LibTreeKeepAlive        = 49 | Type::Bool,
+    PlaylistLazyColumns     = 50 | Type::Bool,
+    ArtworkCacheSize        = 51 | Type::Int,
+    MemoryBudget            = 52 | Type::Int,
 };
 Q_ENUM_NS(GuiInternalSettings)
 } // namespace Settings::Gui::Internal
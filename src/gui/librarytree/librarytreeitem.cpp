@@ -23,6 +23,20 @@
 
 #include <QCollator>
 
+#include <algorithm>
+
+namespace {
+const QCollator& titleCollator()
+{
+    static const QCollator collator = []() {
+        QCollator numericCollator;
+        numericCollator.setNumericMode(true);
+        return numericCollator;
+    }();
+    return collator;
+}
+} // namespace
+
 namespace Fooyin {
 LibraryTreeItem::LibraryTreeItem()
     : LibraryTreeItem{QStringLiteral(""), nullptr, -1}
@@ -32,8 +46,10 @@ LibraryTreeItem::LibraryTreeItem(QString title, LibraryTreeItem* parent, int lev
     : TreeItem{parent}
     , m_pending{false}
     , m_level{level}
+    , m_sortedCount{0}
     , m_key{QStringLiteral("0")}
     , m_title{std::move(title)}
+    , m_tracksSorted{true}
 { }
 
 bool LibraryTreeItem::pending() const
@@ -53,6 +69,10 @@ QString LibraryTreeItem::title() const
 
 TrackList LibraryTreeItem::tracks() const
 {
+    if(!m_tracksSorted) {
+        m_tracks       = Sorting::sortTracks(m_tracks);
+        m_tracksSorted = true;
+    }
     return m_tracks;
 }
 
@@ -74,6 +94,7 @@ void LibraryTreeItem::setPending(bool pending)
 void LibraryTreeItem::setTitle(const QString& title)
 {
     m_title = title;
+    m_sortKey.reset();
 }
 
 void LibraryTreeItem::setKey(const QString& key)
@@ -84,11 +105,13 @@ void LibraryTreeItem::setKey(const QString& key)
 void LibraryTreeItem::addTrack(const Track& track)
 {
     m_tracks.emplace_back(track);
+    m_tracksSorted = false;
 }
 
 void LibraryTreeItem::addTracks(const TrackList& tracks)
 {
     std::ranges::copy(tracks, std::back_inserter(m_tracks));
+    m_tracksSorted = m_tracks.empty();
 }
 
 void LibraryTreeItem::removeTrack(const Track& track)
@@ -106,40 +129,67 @@ void LibraryTreeItem::replaceTrack(const Track& track)
     }
     std::ranges::replace_if(
         m_tracks, [track](const Track& child) { return child.id() == track.id(); }, track);
+    // Changed tags may move it
+    m_tracksSorted = false;
+}
+
+void LibraryTreeItem::insertChild(int row, LibraryTreeItem* child)
+{
+    TreeItem::insertChild(row, child);
+    m_sortedCount = std::min(m_sortedCount, row);
+}
+
+void LibraryTreeItem::insertChildren(int row, const std::vector<LibraryTreeItem*>& children)
+{
+    TreeItem::insertChildren(row, children);
+    m_sortedCount = std::min(m_sortedCount, row);
 }
 
-void LibraryTreeItem::sortTracks()
+void LibraryTreeItem::removeChildren(int index, int count)
 {
-    m_tracks = Sorting::sortTracks(m_tracks);
+    const int previousCount = childCount();
+    TreeItem::removeChildren(index, count);
+    if(childCount() != previousCount) {
+        // Those left are still in order
+        m_sortedCount -= std::clamp(m_sortedCount - index, 0, count);
+    }
+}
+
+void LibraryTreeItem::clearChildren()
+{
+    TreeItem::clearChildren();
+    m_sortedCount = 0;
 }
 
 void LibraryTreeItem::sortChildren()
 {
-    std::vector<LibraryTreeItem*> sortedChildren{m_children};
-
-    QCollator collator;
-    collator.setNumericMode(true);
-
-    std::sort(sortedChildren.begin(), sortedChildren.end(),
-              [collator](const LibraryTreeItem* lhs, const LibraryTreeItem* rhs) {
-                  if(lhs->m_level == -1) {
-                      return true;
-                  }
-                  if(rhs->m_level == -1) {
-                      return false;
-                  }
-
-                  const auto cmp = collator.compare(lhs->m_title, rhs->m_title);
-                  if(cmp == 0) {
-                      return false;
-                  }
-                  return cmp < 0;
-              });
-    m_children = sortedChildren;
-
-    for(auto& child : m_children) {
-        child->sortChildren();
-        child->sortTracks();
+    const int count = childCount();
+    if(m_sortedCount >= count) {
+        return;
+    }
+
+    const auto lessThan = [](const LibraryTreeItem* lhs, const LibraryTreeItem* rhs) {
+        if(lhs->m_level == -1 || rhs->m_level == -1) {
+            return lhs->m_level == -1 && rhs->m_level != -1;
+        }
+        return lhs->sortKey().compare(rhs->sortKey()) < 0;
+    };
+
+    // Only the new children need sorting, then a single pass merges them into place
+    const auto middle = m_children.begin() + m_sortedCount;
+    std::stable_sort(middle, m_children.end(), lessThan);
+    std::inplace_merge(m_children.begin(), middle, m_children.end(), lessThan);
+
+    m_sortedCount = count;
+    renumberChildren(0);
+}
+
+const QCollatorSortKey& LibraryTreeItem::sortKey() const
+{
+    // Titles are collated once each, rather than on every comparison or every sort
+    if(!m_sortKey) {
+        m_sortKey = titleCollator().sortKey(m_title);
     }
+    return *m_sortKey;
 }
 } // namespace Fooyin
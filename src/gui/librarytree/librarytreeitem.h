@@ -23,9 +23,12 @@
 
 #include <utils/treeitem.h>
 
+#include <QCollatorSortKey>
 #include <QObject>
 #include <QString>
 
+#include <optional>
+
 namespace Fooyin {
 class LibraryTreeItem : public TreeItem<LibraryTreeItem>
 {
@@ -56,15 +59,31 @@ public:
     void addTracks(const TrackList& tracks);
     void removeTrack(const Track& track);
     void replaceTrack(const Track& track);
-    void sortTracks();
 
+    void insertChild(int row, LibraryTreeItem* child) override;
+    void insertChildren(int row, const std::vector<LibraryTreeItem*>& children) override;
+    void removeChildren(int index, int count) override;
+    void clearChildren() override;
+
+    /*!
+     * Sorts the children of this node by title, with the "All Music" node first.
+     * Children appended since the last sort are merged in with those already sorted. Nodes further down
+     * aren't touched, as they're sorted when their children are fetched.
+     */
     void sortChildren();
 
 private:
+    [[nodiscard]] const QCollatorSortKey& sortKey() const;
+
     bool m_pending;
     int m_level;
+    // How many children, from the first, are known to be in order
+    int m_sortedCount;
     QString m_key;
     QString m_title;
-    TrackList m_tracks;
+    mutable std::optional<QCollatorSortKey> m_sortKey;
+    // Sorted on first access after a change, as most nodes' tracks are never asked for
+    mutable TrackList m_tracks;
+    mutable bool m_tracksSorted;
 };
 } // namespace Fooyin
@@ -20,15 +20,17 @@
 #include "librarytreemodel.h"
 
 #include "librarytreepopulator.h"
+#include "modelupdatescheduler.h"
 
 #include <gui/guiconstants.h>
+#include <gui/trackmimedata.h>
+#include <utils/memoryusage.h>
+#include <utils/tracing.h>
 
 #include <QColor>
 #include <QFont>
-#include <QIODevice>
 #include <QMimeData>
 #include <QSize>
-#include <QThread>
 
 #include <ranges>
 #include <set>
@@ -78,12 +80,14 @@ struct LibraryTreeModel::Private
 
     bool resetting{false};
 
-    QThread populatorThread;
     LibraryTreePopulator populator;
 
     LibraryTreeItem allNode;
+    // Children which haven't been added to their parent yet, by parent key
     NodeKeyMap pendingNodes;
     ItemKeyMap nodes;
+    // The key of each node's parent, so pending nodes can be found from their key alone
+    std::unordered_map<QString, QString> nodeParents;
     TrackIdNodeMap trackParents;
     std::unordered_set<QString> addedNodes;
     int trackCount{0};
@@ -94,16 +98,18 @@ struct LibraryTreeModel::Private
     QFont font;
     QColor colour;
 
-    explicit Private(LibraryTreeModel* self_)
+    int memorySource{-1};
+
+    Private(LibraryTreeModel* self_, const GroupingCache* groupingCache)
         : self{self_}
+        , populator{groupingCache}
     {
-        populator.moveToThread(&populatorThread);
+        populator.setLane(TaskScheduler::Lane::Interactive);
     }
 
     void sortTree() const
     {
         self->rootItem()->sortChildren();
-        self->rootItem()->resetChildren();
     }
 
     void updateAllNode()
@@ -141,6 +147,7 @@ struct LibraryTreeModel::Private
         for(const LibraryTreeItem* item : pendingItems) {
             if(item->trackCount() == 0) {
                 pendingNodes.erase(item->key());
+                nodeParents.erase(item->key());
                 nodes.erase(item->key());
             }
         }
@@ -151,8 +158,8 @@ struct LibraryTreeModel::Private
                 const int row           = item->row();
                 self->beginRemoveRows(self->indexOfItem(parent), row, row);
                 parent->removeChild(row);
-                parent->resetChildren();
                 self->endRemoveRows();
+                nodeParents.erase(item->key());
                 nodes.erase(item->key());
             }
         }
@@ -182,7 +189,7 @@ struct LibraryTreeModel::Private
         }
     }
 
-    void batchFinished(PendingTreeData data)
+    void batchFinished(PendingTreeData& data)
     {
         if(resetting) {
             self->beginResetModel();
@@ -200,14 +207,20 @@ struct LibraryTreeModel::Private
         }
         resetting = false;
 
-        while(self->canFetchMore({})) {
-            self->fetchMore({});
-        }
-
-        QMetaObject::invokeMethod(self, &LibraryTreeModel::modelUpdated);
+        // Top level rows are added a chunk at a time, so a large library doesn't stall the main thread
+        ModelUpdateScheduler::instance().schedule(self, [this]() {
+            if(self->canFetchMore({})) {
+                self->fetchMore({});
+            }
+            if(self->canFetchMore({})) {
+                return true;
+            }
+            QMetaObject::invokeMethod(self, &LibraryTreeModel::modelUpdated);
+            return false;
+        });
     }
 
-    void traverseTree(const QModelIndex& index, Fooyin::TrackIds& trackIds)
+    void traverseTree(const QModelIndex& index, Fooyin::TrackList& tracks)
     {
         if(!index.isValid()) {
             return;
@@ -215,31 +228,25 @@ struct LibraryTreeModel::Private
 
         const auto childCount = index.model()->rowCount(index);
         if(childCount == 0) {
-            const auto tracks = index.data(Fooyin::LibraryTreeItem::Tracks).value<Fooyin::TrackList>();
-            std::ranges::transform(std::as_const(tracks), std::back_inserter(trackIds),
-                                   [](const Fooyin::Track& track) { return track.id(); });
+            const auto leafTracks = index.data(Fooyin::LibraryTreeItem::Tracks).value<Fooyin::TrackList>();
+            tracks.insert(tracks.end(), leafTracks.cbegin(), leafTracks.cend());
         }
         else {
             for(int i{0}; i < childCount; ++i) {
-                traverseTree(self->index(i, 0, index), trackIds);
+                traverseTree(self->index(i, 0, index), tracks);
             }
         }
     }
 
-    QByteArray saveTracks(const QModelIndexList& indexes)
+    Fooyin::TrackList indexTracks(const QModelIndexList& indexes)
     {
-        QByteArray result;
-        QDataStream stream(&result, QIODevice::WriteOnly);
-
-        Fooyin::TrackIds trackIds;
+        Fooyin::TrackList tracks;
 
         for(const QModelIndex& index : indexes) {
-            traverseTree(index, trackIds);
+            traverseTree(index, tracks);
         }
 
-        stream << trackIds;
-
-        return result;
+        return tracks;
     }
 
     void updatePendingNodes(const PendingTreeData& data)
@@ -277,26 +284,41 @@ struct LibraryTreeModel::Private
 
     void populateModel(PendingTreeData& data)
     {
-        for(const auto& [key, item] : data.items) {
+        FY_TRACE_SCOPE("LibraryTreeModel::populateModel");
+        for(auto& [key, item] : data.items) {
             if(nodes.contains(key)) {
                 nodes[key].addTracks(item.tracks());
             }
             else {
-                nodes[key] = item;
+                nodes[key] = std::move(item);
             }
         }
         mergeTrackParents(data.trackParents);
 
+        for(const auto& [parentKey, rows] : data.nodes) {
+            for(const QString& row : rows) {
+                nodeParents[row] = parentKey;
+            }
+        }
+
         const QModelIndex allIndex = self->indexOfItem(&allNode);
         emit self->dataChanged(allIndex, allIndex, {Qt::DisplayRole});
 
         if(resetting) {
             for(const auto& [parentKey, rows] : data.nodes) {
-                auto* parent = parentKey == QStringLiteral("0") ? self->rootItem() : &nodes.at(parentKey);
+                if(parentKey != QStringLiteral("0")) {
+                    // Only added to the tree once their parent is expanded, see fetchMore
+                    auto& pendingRows = pendingNodes[parentKey];
+                    for(const QString& row : rows) {
+                        pendingRows.push_back(row);
+                        addedNodes.insert(row);
+                    }
+                    continue;
+                }
 
                 for(const QString& row : rows) {
                     LibraryTreeItem* child = &nodes.at(row);
-                    parent->appendChild(child);
+                    self->rootItem()->appendChild(child);
                     child->setPending(false);
                 }
             }
@@ -308,10 +330,40 @@ struct LibraryTreeModel::Private
         updateAllNode();
     }
 
+    // Adds each pending ancestor of the node with @p key to the tree, along with the node itself
+    void fetchNode(const QString& key)
+    {
+        std::vector<QString> pendingKeys;
+
+        QString current{key};
+        while(nodes.contains(current) && nodes.at(current).pending()) {
+            pendingKeys.push_back(current);
+            const auto parent = nodeParents.find(current);
+            if(parent == nodeParents.cend()) {
+                break;
+            }
+            current = parent->second;
+        }
+
+        for(const QString& pendingKey : pendingKeys | std::views::reverse) {
+            const auto parent = nodeParents.find(pendingKey);
+            if(parent == nodeParents.cend()) {
+                return;
+            }
+
+            const QModelIndex parentIndex
+                = nodes.contains(parent->second) ? self->indexOfItem(&nodes.at(parent->second)) : QModelIndex{};
+            while(nodes.at(pendingKey).pending() && self->canFetchMore(parentIndex)) {
+                self->fetchMore(parentIndex);
+            }
+        }
+    }
+
     void beginReset()
     {
         self->resetRoot();
         nodes.clear();
+        nodeParents.clear();
         pendingNodes.clear();
         addedNodes.clear();
 
@@ -320,26 +372,36 @@ struct LibraryTreeModel::Private
     }
 };
 
-LibraryTreeModel::LibraryTreeModel(QObject* parent)
+LibraryTreeModel::LibraryTreeModel(const GroupingCache* groupingCache, QObject* parent)
     : TreeModel{parent}
-    , p{std::make_unique<Private>(this)}
+    , p{std::make_unique<Private>(this, groupingCache)}
 {
-    QObject::connect(&p->populator, &LibraryTreePopulator::populated, this,
-                     [this](const PendingTreeData& data) { p->batchFinished(data); });
+    // Results of superseded runs would be merged into the wrong model state
+    QObject::connect(&p->populator, &LibraryTreePopulator::populated, this, [this](const PendingTreeDataPtr& data) {
+        if(p->populator.isCurrent(data->generation)) {
+            p->batchFinished(*data);
+        }
+    });
 
     QObject::connect(&p->populator, &Worker::finished, this, [this]() {
         p->updateAllNode();
-        p->populator.stopThread();
-        p->populatorThread.quit();
         emit modelLoaded();
     });
+
+    // Items are counted at their fixed size; the titles and tracks they hold aren't included
+    p->memorySource = MemoryUsage::addSource(QStringLiteral("Library tree items"), [this]() {
+        return MemoryUsage::Usage{.bytes   = p->nodes.size() * sizeof(ItemKeyMap::value_type),
+                                  .entries = p->nodes.size()};
+    });
 }
 
 LibraryTreeModel::~LibraryTreeModel()
 {
-    p->populator.stopThread();
-    p->populatorThread.quit();
-    p->populatorThread.wait();
+    ModelUpdateScheduler::instance().cancel(this);
+    MemoryUsage::removeSource(p->memorySource);
+
+    p->populator.closeThread();
+    p->populator.waitForTasks();
 }
 
 void LibraryTreeModel::setFont(const QString& font)
@@ -443,29 +505,41 @@ void LibraryTreeModel::fetchMore(const QModelIndex& parent)
     auto* parentItem = itemForIndex(parent);
     auto& rows       = p->pendingNodes[parentItem->key()];
 
-    const int row           = parentItem->childCount();
-    const int totalRows     = static_cast<int>(rows.size());
-    const int rowCount      = parent.isValid() ? totalRows : std::min(100, totalRows);
-    const auto rowsToInsert = std::ranges::views::take(rows, rowCount);
+    const int totalRows = static_cast<int>(rows.size());
+    const int rowCount  = parent.isValid() ? totalRows : std::min(100, totalRows);
 
-    beginInsertRows(parent, row, row + rowCount - 1);
-    for(const QString& pendingRow : rowsToInsert) {
-        LibraryTreeItem* child = &p->nodes.at(pendingRow);
-        parentItem->appendChild(child);
-        child->setPending(false);
+    // Nodes may have been removed since they were queued
+    std::vector<LibraryTreeItem*> children;
+    for(const QString& pendingRow : std::views::take(rows, rowCount)) {
         p->addedNodes.erase(pendingRow);
+        if(auto node = p->nodes.find(pendingRow); node != p->nodes.end() && node->second.pending()) {
+            children.push_back(&node->second);
+        }
     }
-    endInsertRows();
-
-    emit layoutAboutToBeChanged();
-    p->sortTree();
-    emit layoutChanged();
 
     rows.erase(rows.begin(), rows.begin() + rowCount);
 
     if(rows.empty()) {
         p->pendingNodes.erase(parentItem->key());
     }
+
+    if(children.empty()) {
+        return;
+    }
+
+    const int row = parentItem->childCount();
+
+    beginInsertRows(parent, row, row + static_cast<int>(children.size()) - 1);
+    for(LibraryTreeItem* child : children) {
+        parentItem->appendChild(child);
+        child->setPending(false);
+    }
+    endInsertRows();
+
+    // Only the fetched level needs sorting, the rest of the tree is already sorted
+    emit layoutAboutToBeChanged();
+    parentItem->sortChildren();
+    emit layoutChanged();
 }
 
 bool LibraryTreeModel::canFetchMore(const QModelIndex& parent) const
@@ -486,9 +560,7 @@ Qt::DropActions LibraryTreeModel::supportedDragActions() const
 
 QMimeData* LibraryTreeModel::mimeData(const QModelIndexList& indexes) const
 {
-    auto* mimeData = new QMimeData();
-    mimeData->setData(QString::fromLatin1(Constants::Mime::TrackIds), p->saveTracks(indexes));
-    return mimeData;
+    return new TrackMimeData(p->indexTracks(indexes));
 }
 
 QModelIndexList LibraryTreeModel::findIndexes(const QStringList& values) const
@@ -550,9 +622,8 @@ void LibraryTreeModel::addTracks(const TrackList& tracks)
     }
 
     p->trackCount += static_cast<int>(tracks.size());
-    p->populatorThread.start();
 
-    QMetaObject::invokeMethod(&p->populator, [this, tracksToAdd] { p->populator.run(p->grouping, tracksToAdd); });
+    p->populator.schedule([this, grouping = p->grouping, tracksToAdd] { p->populator.run(grouping, tracksToAdd); });
 }
 
 void LibraryTreeModel::updateTracks(const TrackList& tracks)
@@ -569,9 +640,8 @@ void LibraryTreeModel::updateTracks(const TrackList& tracks)
 
     p->tracksPendingRemoval = tracksToUpdate;
 
-    p->populatorThread.start();
-
-    QMetaObject::invokeMethod(&p->populator, [this, tracksToUpdate] { p->populator.run(p->grouping, tracksToUpdate); });
+    p->populator.schedule(
+        [this, grouping = p->grouping, tracksToUpdate] { p->populator.run(grouping, tracksToUpdate); });
 
     addTracks(tracks);
 }
@@ -604,14 +674,9 @@ void LibraryTreeModel::changeGrouping(const LibraryTreeGrouping& grouping)
 
 void LibraryTreeModel::reset(const TrackList& tracks)
 {
-    if(p->populatorThread.isRunning()) {
-        p->populator.stopThread();
-    }
-    else {
-        p->populatorThread.start();
-    }
-
     if(tracks.empty()) {
+        // Nothing to populate, but earlier runs still mustn't add to the empty model
+        p->populator.startJob([]() { });
         beginResetModel();
         p->beginReset();
         endResetModel();
@@ -621,20 +686,19 @@ void LibraryTreeModel::reset(const TrackList& tracks)
     p->resetting  = true;
     p->trackCount = static_cast<int>(tracks.size());
 
-    QMetaObject::invokeMethod(&p->populator, [this, tracks] { p->populator.run(p->grouping, tracks); });
+    p->populator.startJob([this, grouping = p->grouping, tracks] { p->populator.run(grouping, tracks); });
 }
 
 QModelIndex LibraryTreeModel::indexForKey(const QString& key)
 {
-    while(!p->nodes.contains(key) && canFetchMore({})) {
-        fetchMore({});
+    if(!p->nodes.contains(key)) {
+        return {};
     }
 
-    if(p->nodes.contains(key)) {
-        return indexOfItem(&p->nodes.at(key));
-    }
+    p->fetchNode(key);
 
-    return {};
+    const LibraryTreeItem* node = &p->nodes.at(key);
+    return node->pending() ? QModelIndex{} : indexOfItem(node);
 }
 } // namespace Fooyin
 
@@ -26,6 +26,7 @@
 #include <utils/treemodel.h>
 
 namespace Fooyin {
+class GroupingCache;
 struct LibraryTreeAppearance;
 
 class LibraryTreeModel : public TreeModel<LibraryTreeItem>
@@ -33,7 +34,7 @@ class LibraryTreeModel : public TreeModel<LibraryTreeItem>
     Q_OBJECT
 
 public:
-    explicit LibraryTreeModel(QObject* parent = nullptr);
+    explicit LibraryTreeModel(const GroupingCache* groupingCache, QObject* parent = nullptr);
     ~LibraryTreeModel() override;
 
     void setFont(const QString& font);
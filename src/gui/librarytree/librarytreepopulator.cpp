@@ -19,10 +19,11 @@
 
 #include "librarytreepopulator.h"
 
-#include <core/scripting/scriptparser.h>
-#include <core/scripting/scriptregistry.h>
+#include <core/library/groupingcache.h>
+#include <core/track.h>
 
 #include <utils/crypto.h>
+#include <utils/tracing.h>
 
 constexpr int InitialBatchSize = 3000;
 constexpr int BatchSize        = 4000;
@@ -31,20 +32,17 @@ namespace Fooyin {
 struct LibraryTreePopulator::Private
 {
     LibraryTreePopulator* self;
+    const GroupingCache* groupingCache;
 
-    ScriptRegistry registry;
-    ScriptParser parser;
-
-    QString currentGrouping;
-    ParsedScript script;
+    QString grouping;
 
     LibraryTreeItem root;
     PendingTreeData data;
     TrackList pendingTracks;
 
-    explicit Private(LibraryTreePopulator* self_)
+    Private(LibraryTreePopulator* self_, const GroupingCache* groupingCache_)
         : self{self_}
-        , parser{&registry}
+        , groupingCache{groupingCache_}
         , data{}
     { }
 
@@ -63,18 +61,12 @@ struct LibraryTreePopulator::Private
         return child;
     }
 
-    void iterateTrack(const Track& track)
+    void iterateTrack(const Track& track, const QStringList& values)
     {
         LibraryTreeItem* parent = &root;
 
-        const QString field = parser.evaluate(script, track);
-        if(field.isNull()) {
-            return;
-        }
-
-        const QStringList values = field.split(QStringLiteral("\037"), Qt::SkipEmptyParts);
         for(const QString& value : values) {
-            if(value.isNull()) {
+            if(value.isEmpty()) {
                 continue;
             }
             const QStringList items = value.split(QStringLiteral("||"));
@@ -100,23 +92,26 @@ struct LibraryTreePopulator::Private
             return;
         }
 
-        auto tracksBatch = std::ranges::views::take(pendingTracks, size);
+        TrackList tracksBatch;
+        std::ranges::copy_if(std::ranges::views::take(pendingTracks, size), std::back_inserter(tracksBatch),
+                             [](const Track& track) { return track.isInLibrary(); });
+
+        // The most expensive part of building the tree, so shared with other views using the same grouping
+        const std::vector<QStringList> fields = groupingCache->values(grouping, tracksBatch);
 
-        for(const Track& track : tracksBatch) {
+        for(size_t i{0}; i < tracksBatch.size(); ++i) {
             if(!self->mayRun()) {
                 return;
             }
-
-            if(track.isInLibrary()) {
-                iterateTrack(track);
-            }
+            iterateTrack(tracksBatch.at(i), fields.at(i));
         }
 
         if(!self->mayRun()) {
             return;
         }
 
-        emit self->populated(data);
+        data.generation = self->jobGeneration();
+        emit self->populated(std::make_shared<PendingTreeData>(std::move(data)));
 
         auto tracksToKeep = std::ranges::views::drop(pendingTracks, size);
         TrackList tempTracks;
@@ -130,29 +125,29 @@ struct LibraryTreePopulator::Private
     }
 };
 
-LibraryTreePopulator::LibraryTreePopulator(QObject* parent)
+LibraryTreePopulator::LibraryTreePopulator(const GroupingCache* groupingCache, QObject* parent)
     : Worker{parent}
-    , p{std::make_unique<Private>(this)}
+    , p{std::make_unique<Private>(this, groupingCache)}
 { }
 
 LibraryTreePopulator::~LibraryTreePopulator() = default;
 
 void LibraryTreePopulator::run(const QString& grouping, const TrackList& tracks)
 {
+    FY_TRACE_SCOPE("LibraryTreePopulator::run");
     setState(Running);
 
     p->data.clear();
 
-    if(std::exchange(p->currentGrouping, grouping) != grouping) {
-        p->script = p->parser.parse(p->currentGrouping);
-    }
-
+    p->grouping = grouping;
     p->pendingTracks = tracks;
     p->runBatch(InitialBatchSize);
 
     setState(Idle);
 
-    emit finished();
+    if(isCurrent(jobGeneration())) {
+        emit finished();
+    }
 }
 } // namespace Fooyin
 
@@ -26,6 +26,8 @@
 #include <utils/worker.h>
 
 namespace Fooyin {
+class GroupingCache;
+
 using ItemKeyMap     = std::unordered_map<QString, LibraryTreeItem>;
 using NodeKeyMap     = std::unordered_map<QString, std::vector<QString>>;
 using TrackIdNodeMap = std::unordered_map<int, std::vector<QString>>;
@@ -35,6 +37,8 @@ struct PendingTreeData
     ItemKeyMap items;
     NodeKeyMap nodes;
     TrackIdNodeMap trackParents;
+    // The populator job these belong to
+    uint64_t generation{0};
 
     void clear()
     {
@@ -43,19 +47,21 @@ struct PendingTreeData
         trackParents.clear();
     }
 };
+// Batches are handed to a single receiver, which may move from them
+using PendingTreeDataPtr = std::shared_ptr<PendingTreeData>;
 
 class LibraryTreePopulator : public Worker
 {
     Q_OBJECT
 
 public:
-    explicit LibraryTreePopulator(QObject* parent = nullptr);
+    explicit LibraryTreePopulator(const GroupingCache* groupingCache, QObject* parent = nullptr);
     ~LibraryTreePopulator() override;
 
     void run(const QString& grouping, const TrackList& tracks);
 
 signals:
-    void populated(PendingTreeData data);
+    void populated(const PendingTreeDataPtr& data);
 
 private:
     struct Private;
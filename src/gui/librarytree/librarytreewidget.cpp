@@ -23,10 +23,13 @@
 #include "librarytreegroupregistry.h"
 #include "librarytreemodel.h"
 #include "librarytreeview.h"
+#include "widgets/viewpreview.h"
 
 #include <core/library/musiclibrary.h>
 #include <core/library/trackfilter.h>
 #include <core/library/tracksort.h>
+#include <core/scripting/scriptparser.h>
+#include <gui/tracksearcher.h>
 #include <gui/trackselectioncontroller.h>
 #include <utils/actions/widgetcontext.h>
 #include <utils/async.h>
@@ -109,6 +112,8 @@ struct LibraryTreeWidget::Private
     SettingsManager* settings;
 
     LibraryTreeGrouping grouping;
+    // Only used to find what the grouping script depends on
+    ScriptParser groupingParser;
 
     QVBoxLayout* layout;
     LibraryTreeView* libraryTree;
@@ -119,8 +124,7 @@ struct LibraryTreeWidget::Private
     TrackAction doubleClickAction;
     TrackAction middleClickAction;
 
-    QString prevSearch;
-    TrackList prevSearchTracks;
+    TrackSearcher searcher;
 
     bool updating{false};
     QByteArray pendingState;
@@ -134,10 +138,11 @@ struct LibraryTreeWidget::Private
         , settings{settings_}
         , layout{new QVBoxLayout(self)}
         , libraryTree{new LibraryTreeView(self)}
-        , model{new LibraryTreeModel(self)}
+        , model{new LibraryTreeModel(&library->groupingCache(), self)}
         , widgetContext{new WidgetContext(self, Context{Id{"Fooyin.Context.LibraryTree."}.append(self->id())}, self)}
         , doubleClickAction{static_cast<TrackAction>(settings->value<LibTreeDoubleClick>())}
         , middleClickAction{static_cast<TrackAction>(settings->value<LibTreeMiddleClick>())}
+        , searcher{library}
     {
         layout->setContentsMargins(0, 0, 0, 0);
         layout->addWidget(libraryTree);
@@ -179,7 +184,7 @@ struct LibraryTreeWidget::Private
 
     void reset() const
     {
-        model->reset(library->tracks());
+        model->reset(library->snapshot().tracks());
     }
 
     void changeGrouping(const LibraryTreeGrouping& newGrouping)
@@ -249,21 +254,7 @@ struct LibraryTreeWidget::Private
 
     void searchChanged(const QString& search)
     {
-        const bool reset = prevSearch.length() > search.length();
-        prevSearch       = search;
-
-        if(search.isEmpty()) {
-            prevSearchTracks.clear();
-            model->reset(library->tracks());
-            return;
-        }
-
-        const TrackList tracksToFilter = !reset && !prevSearchTracks.empty() ? prevSearchTracks : library->tracks();
-
-        const auto tracks = Filter::filterTracks(tracksToFilter, search);
-
-        prevSearchTracks = tracks;
-        model->reset(tracks);
+        searcher.search(search);
     }
 
     [[nodiscard]] QString playlistNameFromSelection() const
@@ -315,8 +306,8 @@ struct LibraryTreeWidget::Private
             return;
         }
 
-        if(!prevSearch.isEmpty()) {
-            const auto filteredTracks = Filter::filterTracks(tracks, prevSearch);
+        if(const QString search = searcher.currentSearch(); !search.isEmpty()) {
+            const auto filteredTracks = Filter::filterTracks(tracks, search, library->searchIndex());
             model->addTracks(filteredTracks);
         }
         else {
@@ -324,6 +315,17 @@ struct LibraryTreeWidget::Private
         }
     }
 
+    void handleTracksPlayed(const TrackList& tracks)
+    {
+        // Tracks only need to move if they're grouped by their stats
+        if(groupingParser.parse(grouping.script).dependencies.dependsOnStats()) {
+            handleTracksUpdated(tracks);
+        }
+        else {
+            model->refreshTracks(tracks);
+        }
+    }
+
     void handleTracksUpdated(const TrackList& tracks)
     {
         if(tracks.empty()) {
@@ -512,6 +514,9 @@ LibraryTreeWidget::LibraryTreeWidget(MusicLibrary* library, TrackSelectionContro
                          }
                      });
 
+    QObject::connect(&p->searcher, &TrackSearcher::searchFinished, this,
+                     [this](const QString& /*search*/, const TrackList& tracks) { p->model->reset(tracks); });
+
     QObject::connect(library, &MusicLibrary::tracksLoaded, this, [this]() { p->reset(); });
     QObject::connect(library, &MusicLibrary::tracksAdded, this,
                      [this](const TrackList& tracks) { p->handleTracksAdded(tracks); });
@@ -520,9 +525,15 @@ LibraryTreeWidget::LibraryTreeWidget(MusicLibrary* library, TrackSelectionContro
     QObject::connect(library, &MusicLibrary::tracksUpdated, this,
                      [this](const TrackList& tracks) { p->handleTracksUpdated(tracks); });
     QObject::connect(library, &MusicLibrary::tracksPlayed, this,
-                     [this](const TrackList& tracks) { p->model->refreshTracks(tracks); });
+                     [this](const TrackList& tracks) { p->handleTracksPlayed(tracks); });
     QObject::connect(library, &MusicLibrary::tracksDeleted, p->model, &LibraryTreeModel::removeTracks);
     QObject::connect(library, &MusicLibrary::tracksSorted, this, [this]() { p->reset(); });
+    QObject::connect(library, &MusicLibrary::libraryChanged, this, [this]() { p->reset(); });
+}
+
+LibraryTreeWidget::~LibraryTreeWidget()
+{
+    ViewPreview::save(id().name(), p->libraryTree);
 }
 
 QString LibraryTreeWidget::name() const
@@ -554,6 +565,13 @@ void LibraryTreeWidget::loadLayoutData(const QJsonObject& layout)
     if(layout.contains(QStringLiteral("State"))) {
         p->pendingState = QByteArray::fromBase64(layout.value(QStringLiteral("State")).toString().toUtf8());
     }
+
+    // The id is only known once loaded, and the library is still loading if it's empty
+    if(p->library->isEmpty()) {
+        if(auto* preview = ViewPreview::cover(id().name(), p->libraryTree)) {
+            QObject::connect(p->model, &LibraryTreeModel::modelLoaded, preview, &ViewPreview::dismiss);
+        }
+    }
 }
 
 void LibraryTreeWidget::searchEvent(const QString& search)
@@ -33,6 +33,7 @@ class LibraryTreeWidget : public FyWidget
 public:
     LibraryTreeWidget(MusicLibrary* library, TrackSelectionController* trackSelection, SettingsManager* settings,
                       QWidget* parent = nullptr);
+    ~LibraryTreeWidget() override;
 
     QString name() const override;
     QString layoutName() const override;
@@ -0,0 +1,119 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "memorymonitor.h"
+
+#include "covercache.h"
+#include "internalguisettings.h"
+
+#include <utils/memoryusage.h>
+#include <utils/metrics.h>
+#include <utils/settings/settingsmanager.h>
+#include <utils/utils.h>
+
+#include <QDebug>
+#include <QTimerEvent>
+
+// In ms
+constexpr auto CheckInterval = 10000;
+// Share of time stalled on memory over the last 10 seconds, as a percentage, which counts as pressure
+constexpr auto PressureThreshold = 10.0;
+// Pressure lingers in the average after trimming, so give it time to settle before trimming again
+constexpr auto TrimCooldown = 60000; // ms
+// Trimming for the budget leaves a quarter of it free, so it isn't exceeded again straight away
+constexpr size_t BudgetHeadroom = 4;
+
+namespace Fooyin {
+MemoryMonitor::MemoryMonitor(SettingsManager* settings, QObject* parent)
+    : QObject{parent}
+    , m_settings{settings}
+{
+    auto& covers = CoverCache::instance();
+
+    m_sources.push_back(MemoryUsage::addSource(
+        QStringLiteral("Covers"), [&covers]() { return covers.memoryUsage(CoverCache::Bucket::Full); },
+        [&covers]() { covers.trimMemory(CoverCache::Bucket::Full, 0); }, MemoryUsage::TrimPriority::First));
+    m_sources.push_back(MemoryUsage::addSource(
+        QStringLiteral("Cover thumbnails"), [&covers]() { return covers.memoryUsage(CoverCache::Bucket::Thumbnail); },
+        [&covers]() { covers.trimMemory(CoverCache::Bucket::Thumbnail, 0); }));
+
+    m_metricsCollector = Metrics::addCollector([&covers](Metrics::SampleList& samples) {
+        const auto stats     = covers.stats();
+        const QString memory = Metrics::label(QStringLiteral("cache"), QStringLiteral("memory"));
+        const QString disk   = Metrics::label(QStringLiteral("cache"), QStringLiteral("disk"));
+        const QString hits   = QStringLiteral("fooyin_cover_cache_hits");
+        const QString misses = QStringLiteral("fooyin_cover_cache_misses");
+        const auto toSample  = [](uint64_t value) {
+            return static_cast<double>(value);
+        };
+
+        samples.push_back({hits, QStringLiteral("Covers found in the cache"), Metrics::Type::Counter, memory,
+                           toSample(stats.memoryHits)});
+        samples.push_back({hits, {}, Metrics::Type::Counter, disk, toSample(stats.diskHits)});
+        samples.push_back({misses, QStringLiteral("Covers not found in the cache"), Metrics::Type::Counter, memory,
+                           toSample(stats.memoryMisses)});
+        samples.push_back({misses, {}, Metrics::Type::Counter, disk, toSample(stats.diskMisses)});
+    });
+
+    m_checkTimer.start(CheckInterval, this);
+}
+
+MemoryMonitor::~MemoryMonitor()
+{
+    for(const int source : m_sources) {
+        MemoryUsage::removeSource(source);
+    }
+    Metrics::removeCollector(m_metricsCollector);
+}
+
+void MemoryMonitor::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == m_checkTimer.timerId()) {
+        checkUsage();
+    }
+    QObject::timerEvent(event);
+}
+
+void MemoryMonitor::checkUsage()
+{
+    if(m_lastTrim.isValid() && m_lastTrim.elapsed() < TrimCooldown) {
+        return;
+    }
+
+    if(const auto pressure = MemoryUsage::pressure(); pressure && *pressure >= PressureThreshold) {
+        trim(MemoryUsage::total() / 2, "memory pressure");
+        return;
+    }
+
+    const auto budget = static_cast<size_t>(m_settings->value<Settings::Gui::Internal::MemoryBudget>()) * 1024 * 1024;
+    if(budget > 0 && MemoryUsage::total() > budget) {
+        trim(budget - (budget / BudgetHeadroom), "over budget");
+    }
+}
+
+void MemoryMonitor::trim(size_t target, const char* reason)
+{
+    const size_t freed = MemoryUsage::trim(target);
+    m_lastTrim.start();
+
+    qInfo() << "[Memory] Trimmed caches for" << reason << "and freed" << Utils::formatFileSize(freed);
+}
+} // namespace Fooyin
+
+#include "moc_memorymonitor.cpp"
@@ -0,0 +1,58 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <vector>
+
+namespace Fooyin {
+class SettingsManager;
+
+/*!
+ * Trims caches registered with MemoryUsage when memory runs short, i.e. when the system reports memory
+ * pressure or the caches grow beyond the configured budget.
+ *
+ * Also adds the cover caches as sources, and reports their hit rates as metrics.
+ */
+class MemoryMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MemoryMonitor(SettingsManager* settings, QObject* parent = nullptr);
+    ~MemoryMonitor() override;
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    void checkUsage();
+    void trim(size_t target, const char* reason);
+
+    SettingsManager* m_settings;
+    QBasicTimer m_checkTimer;
+    QElapsedTimer m_lastTrim;
+    std::vector<int> m_sources;
+    int m_metricsCollector{-1};
+};
+} // namespace Fooyin
@@ -59,6 +59,16 @@ FileMenu::FileMenu(ActionManager* actionManager, SettingsManager* settings, QObj
     fileMenu->addAction(newPlaylistCommand, Actions::Groups::Two);
     QObject::connect(newPlaylist, &QAction::triggered, this, &FileMenu::requestNewPlaylist);
 
+    auto* importPlaylist        = new QAction(tr("&Import Playlist…"), this);
+    auto* importPlaylistCommand = m_actionManager->registerAction(importPlaylist, Constants::Actions::ImportPlaylist);
+    fileMenu->addAction(importPlaylistCommand, Actions::Groups::Two);
+    QObject::connect(importPlaylist, &QAction::triggered, this, &FileMenu::requestImportPlaylist);
+
+    auto* exportPlaylist        = new QAction(tr("&Export Playlist…"), this);
+    auto* exportPlaylistCommand = m_actionManager->registerAction(exportPlaylist, Constants::Actions::ExportPlaylist);
+    fileMenu->addAction(exportPlaylistCommand, Actions::Groups::Two);
+    QObject::connect(exportPlaylist, &QAction::triggered, this, &FileMenu::requestExportPlaylist);
+
     fileMenu->addSeparator();
 
     auto* quit        = new QAction(Utils::iconFromTheme(Constants::Icons::Quit), tr("E&xit"), this);
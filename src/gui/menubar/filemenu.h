@@ -36,6 +36,8 @@ signals:
     void requestAddFiles();
     void requestAddFolders();
     void requestNewPlaylist();
+    void requestImportPlaylist();
+    void requestExportPlaylist();
 
 private:
     ActionManager* m_actionManager;
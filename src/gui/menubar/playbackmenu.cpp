@@ -49,6 +49,7 @@ PlaybackMenu::PlaybackMenu(ActionManager* actionManager, PlayerController* playe
     , m_repeatTrack{new QAction(tr("&Repeat Track"), this)}
     , m_repeatPlaylist{new QAction(tr("Repeat &Playlist"), this)}
     , m_shuffle{new QAction(tr("&Shuffle Tracks"), this)}
+    , m_shuffleAlbums{new QAction(tr("Shuffle &Albums"), this)}
 {
     auto* playbackMenu = m_actionManager->actionContainer(Constants::Menus::Playback);
 
@@ -82,11 +83,13 @@ PlaybackMenu::PlaybackMenu(ActionManager* actionManager, PlayerController* playe
     m_repeatTrack->setCheckable(true);
     m_repeatPlaylist->setCheckable(true);
     m_shuffle->setCheckable(true);
+    m_shuffleAlbums->setCheckable(true);
 
     orderMenu->addAction(actionManager->registerAction(m_defaultPlayback, Constants::Actions::PlaybackDefault));
     orderMenu->addAction(m_actionManager->registerAction(m_repeatTrack, Constants::Actions::RepeatTrack));
     orderMenu->addAction(actionManager->registerAction(m_repeatPlaylist, Constants::Actions::RepeatPlaylist));
     orderMenu->addAction(actionManager->registerAction(m_shuffle, Constants::Actions::ShuffleTracks));
+    orderMenu->addAction(actionManager->registerAction(m_shuffleAlbums, Constants::Actions::ShuffleAlbums));
 
     QObject::connect(m_defaultPlayback, &QAction::triggered, this, [this]() { setPlayMode(Playlist::Default); });
     QObject::connect(m_repeatTrack, &QAction::triggered, this,
@@ -95,6 +98,8 @@ PlaybackMenu::PlaybackMenu(ActionManager* actionManager, PlayerController* playe
                      [this]() { setPlayMode(Playlist::PlayMode::RepeatPlaylist); });
     QObject::connect(m_shuffle, &QAction::triggered, this,
                      [this]() { setPlayMode(Playlist::PlayMode::ShuffleTracks); });
+    QObject::connect(m_shuffleAlbums, &QAction::triggered, this,
+                     [this]() { setPlayMode(Playlist::PlayMode::ShuffleAlbums); });
 
     auto* followPlayback = new QAction(tr("Cursor Follows Play&back"), this);
     auto* followCursor   = new QAction(tr("Playback Follows &Cursor"), this);
@@ -139,12 +144,14 @@ void PlaybackMenu::updatePlayMode(Playlist::PlayModes mode) const
     m_repeatTrack->setChecked(mode & Playlist::RepeatTrack);
     m_repeatPlaylist->setChecked(mode & Playlist::RepeatPlaylist);
     m_shuffle->setChecked(mode & Playlist::ShuffleTracks);
+    m_shuffleAlbums->setChecked(mode & Playlist::ShuffleAlbums);
 
     if(mode == 0) {
         m_defaultPlayback->setChecked(true);
         m_repeatTrack->setChecked(false);
         m_repeatPlaylist->setChecked(false);
         m_shuffle->setChecked(false);
+        m_shuffleAlbums->setChecked(false);
     }
     else {
         m_defaultPlayback->setChecked(false);
@@ -167,6 +174,14 @@ void PlaybackMenu::setPlayMode(Playlist::PlayMode mode) const
         currentMode |= Playlist::RepeatPlaylist;
         currentMode &= ~Playlist::RepeatTrack;
     }
+    else if(mode & Playlist::ShuffleTracks) {
+        currentMode |= Playlist::ShuffleTracks;
+        currentMode &= ~Playlist::ShuffleAlbums;
+    }
+    else if(mode & Playlist::ShuffleAlbums) {
+        currentMode |= Playlist::ShuffleAlbums;
+        currentMode &= ~Playlist::ShuffleTracks;
+    }
     else {
         currentMode |= mode;
     }
@@ -60,5 +60,6 @@ private:
     QAction* m_repeatTrack;
     QAction* m_repeatPlaylist;
     QAction* m_shuffle;
+    QAction* m_shuffleAlbums;
 };
 } // namespace Fooyin
@@ -0,0 +1,165 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "modelupdatescheduler.h"
+
+#include <utils/tracing.h>
+
+#include <QPointer>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+using Clock = std::chrono::steady_clock;
+
+// Leaves most of a 60Hz frame for handling input and painting
+constexpr auto SliceBudget = std::chrono::milliseconds{4};
+
+namespace Fooyin {
+struct ModelUpdateScheduler::Private
+{
+    struct Task
+    {
+        uint64_t id{0};
+        const QObject* key{nullptr};
+        QPointer<QObject> owner;
+        Step step;
+    };
+
+    // Run round robin, so one large model doesn't starve the rest
+    std::deque<Task> tasks;
+    uint64_t nextId{0};
+    QTimer timer;
+
+    Private()
+    {
+        timer.setSingleShot(true);
+        timer.setInterval(0);
+        QObject::connect(&timer, &QTimer::timeout, &timer, [this]() { runSlice(); });
+    }
+
+    auto find(const QObject* owner)
+    {
+        return std::ranges::find(tasks, owner, &Task::key);
+    }
+
+    auto findId(uint64_t id)
+    {
+        return std::ranges::find(tasks, id, &Task::id);
+    }
+
+    // Runs one step of task @p id, dropping it once it's finished.
+    // The step may schedule or cancel work itself, so the task is looked up again afterwards.
+    // @returns whether the task is still queued.
+    bool runStep(uint64_t id)
+    {
+        auto task       = findId(id);
+        const bool more = task->owner && Step{task->step}();
+
+        task = findId(id);
+        if(task == tasks.end()) {
+            return false;
+        }
+        if(!more || !task->owner) {
+            tasks.erase(task);
+            return false;
+        }
+        return true;
+    }
+
+    void runSlice()
+    {
+        FY_TRACE_SCOPE("ModelUpdateScheduler::runSlice");
+
+        const auto deadline = Clock::now() + SliceBudget;
+        while(!tasks.empty() && Clock::now() < deadline) {
+            const uint64_t id = tasks.front().id;
+            if(runStep(id)) {
+                auto task = findId(id);
+                Task next = std::move(*task);
+                tasks.erase(task);
+                tasks.push_back(std::move(next));
+            }
+        }
+
+        if(!tasks.empty()) {
+            timer.start();
+        }
+    }
+};
+
+ModelUpdateScheduler& ModelUpdateScheduler::instance()
+{
+    static ModelUpdateScheduler scheduler;
+    return scheduler;
+}
+
+ModelUpdateScheduler::ModelUpdateScheduler()
+    : p{std::make_unique<Private>()}
+{ }
+
+ModelUpdateScheduler::~ModelUpdateScheduler() = default;
+
+void ModelUpdateScheduler::schedule(QObject* owner, Step step)
+{
+    if(!owner || !step) {
+        return;
+    }
+
+    if(auto task = p->find(owner); task != p->tasks.end()) {
+        // The owner's pending state holds both batches, so the newer step applies them together
+        task->owner = owner;
+        task->step  = std::move(step);
+        return;
+    }
+
+    p->tasks.push_back({.id = p->nextId++, .key = owner, .owner = owner, .step = std::move(step)});
+
+    if(!p->timer.isActive()) {
+        p->timer.start();
+    }
+}
+
+void ModelUpdateScheduler::cancel(const QObject* owner)
+{
+    if(auto task = p->find(owner); task != p->tasks.end()) {
+        p->tasks.erase(task);
+    }
+}
+
+void ModelUpdateScheduler::flush(const QObject* owner)
+{
+    const auto task = p->find(owner);
+    if(task == p->tasks.end()) {
+        return;
+    }
+
+    const uint64_t id = task->id;
+    while(p->runStep(id)) { }
+}
+
+bool ModelUpdateScheduler::isPending(const QObject* owner) const
+{
+    return std::ranges::any_of(p->tasks, [owner](const auto& task) { return task.key == owner; });
+}
+} // namespace Fooyin
@@ -0,0 +1,68 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+class QObject;
+
+namespace Fooyin {
+/*!
+ * Applies pending model changes, e.g. rows from populator batches, in short slices on the main thread.
+ *
+ * Each slice runs queued work until its time budget is spent, then yields to the event loop, so input and
+ * repaints aren't held up behind a large batch. Work is queued per owner, and a batch scheduled while the
+ * previous one is still being applied replaces its step rather than queueing behind it.
+ * Views still fetch the rows they're about to show themselves, so the visible region never waits on a slice.
+ * @note must only be used from the main thread.
+ */
+class ModelUpdateScheduler
+{
+public:
+    /*!
+     * Applies a small part of the owner's pending work.
+     * @returns @c true while more work remains.
+     */
+    using Step = std::function<bool()>;
+
+    static ModelUpdateScheduler& instance();
+
+    ~ModelUpdateScheduler();
+
+    ModelUpdateScheduler(const ModelUpdateScheduler& other)            = delete;
+    ModelUpdateScheduler& operator=(const ModelUpdateScheduler& other) = delete;
+
+    /** Runs @p step in slices until it's done, or until @p owner is destroyed. */
+    void schedule(QObject* owner, Step step);
+    /** Drops any work queued for @p owner without running it. */
+    void cancel(const QObject* owner);
+    /** Runs the work queued for @p owner to completion now. */
+    void flush(const QObject* owner);
+    [[nodiscard]] bool isPending(const QObject* owner) const;
+
+private:
+    ModelUpdateScheduler();
+
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin
@@ -410,7 +410,6 @@ void PlaylistOrganiserModel::playlistRemoved(Playlist* playlist)
 
     beginRemoveRows(indexOfItem(parent), row, row);
     parent->removeChild(row);
-    parent->resetChildren();
     endRemoveRows();
 
     p->nodes.erase(key);
@@ -649,15 +648,13 @@ void PlaylistOrganiserModel::removeItems(const QModelIndexList& indexes)
         auto* parentItem         = children.front()->parent();
 
         const int firstRow = children.front()->row();
-        int lastRow        = static_cast<int>(firstRow + children.size()) - 1;
+        const int lastRow  = static_cast<int>(firstRow + children.size()) - 1;
 
         beginRemoveRows(parent, firstRow, lastRow);
-        while(lastRow >= firstRow) {
-            p->deleteNodes(itemForIndex(index(lastRow, 0, parent)));
-            parentItem->removeChild(lastRow);
-            --lastRow;
+        for(int row{lastRow}; row >= firstRow; --row) {
+            p->deleteNodes(parentItem->child(row));
         }
-        parentItem->resetChildren();
+        parentItem->removeChildren(firstRow, lastRow - firstRow + 1);
         endRemoveRows();
     }
 }
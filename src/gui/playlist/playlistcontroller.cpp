@@ -178,6 +178,18 @@ struct PlaylistController::Private
         }
     }
 
+    // The same tracks in a new order, so unlike a replacement the queue and history still apply
+    void handlePlaylistReordered(Playlist* playlist, const std::vector<int>& indexes) const
+    {
+        if(changingTracks) {
+            return;
+        }
+
+        if(playlist == currentPlaylist) {
+            emit self->currentPlaylistTracksChanged(indexes, false);
+        }
+    }
+
     void handleTracksPlayed(Playlist* playlist, const std::vector<int>& indexes) const
     {
         if(changingTracks) {
@@ -286,6 +298,10 @@ PlaylistController::PlaylistController(PlaylistHandler* handler, PlayerControlle
     QObject::connect(
         handler, &PlaylistHandler::playlistTracksChanged, this,
         [this](Playlist* playlist, const std::vector<int>& indexes) { p->handlePlaylistUpdated(playlist, indexes); });
+    QObject::connect(handler, &PlaylistHandler::playlistTracksReordered, this,
+                     [this](Playlist* playlist, const std::vector<int>& indexes) {
+                         p->handlePlaylistReordered(playlist, indexes);
+                     });
     QObject::connect(
         handler, &PlaylistHandler::playlistTracksPlayed, this,
         [this](Playlist* playlist, const std::vector<int>& indexes) { p->handleTracksPlayed(playlist, indexes); });
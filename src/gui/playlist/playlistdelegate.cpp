@@ -21,34 +21,124 @@
 
 #include "playlistitem.h"
 
+#include <utils/lrucache.h>
 #include <utils/utils.h>
 
 #include <QApplication>
 #include <QPainter>
+#include <QStaticText>
+
+// Enough for the visible rows of a dense multi-column playlist, plus some scrolling either side
+constexpr size_t LayoutCacheBudget = 4 * 1024 * 1024;
+// Rough memory used per character by a prepared QStaticText (glyph index, position and text)
+constexpr size_t LayoutCharCost = 24;
+
+namespace {
+struct TextLayoutKey
+{
+    QString text;
+    QFont font;
+    QSize size;
+    int alignment{0};
+
+    bool operator==(const TextLayoutKey& other) const = default;
+};
+
+struct TextLayoutKeyHash
+{
+    size_t operator()(const TextLayoutKey& key) const
+    {
+        return qHashMulti(0, key.text, key.font, key.size.width(), key.size.height(), key.alignment);
+    }
+};
+
+// A block of text elided and shaped for a rect of a given size, with positions relative to its top left
+struct TextLayout
+{
+    QStaticText text;
+    QPoint pos;
+    QRect bound;
+    bool clip{false};
+};
+} // namespace
 
 namespace Fooyin {
+using TextLayoutCache = LruCache<TextLayoutKey, TextLayout, TextLayoutKeyHash>;
+
+struct PlaylistDelegate::Private
+{
+    // Fonts and sizes are part of the key, so entries for old column widths or fonts are simply never hit again
+    TextLayoutCache layouts{LayoutCacheBudget};
+};
+
 struct DrawTextResult
 {
     QRect bound;
     int totalWidth{0};
 };
 
+const TextLayout& textLayout(TextLayoutCache& cache, QPainter* painter, const QSize& size, const QString& text,
+                             Qt::Alignment alignment)
+{
+    TextLayoutKey key{text, painter->font(), size, static_cast<int>(alignment)};
+    if(const auto* layout = cache.find(key)) {
+        return *layout;
+    }
+
+    const QRect rect{{0, 0}, size};
+    const QString elided = painter->fontMetrics().elidedText(text, Qt::ElideRight, size.width());
+    const QRect textRect = painter->boundingRect(rect, alignment, elided);
+
+    TextLayout layout;
+    layout.text.setText(elided);
+    layout.text.setTextFormat(Qt::PlainText);
+    layout.text.setPerformanceHint(QStaticText::AggressiveCaching);
+    layout.text.prepare(painter->transform(), painter->font());
+    layout.pos   = textRect.topLeft();
+    layout.bound = painter->boundingRect(rect, alignment | Qt::TextWrapAnywhere, text);
+    layout.clip  = !rect.contains(textRect);
+
+    const size_t cost = sizeof(TextLayoutKey) + sizeof(TextLayout)
+                      + ((static_cast<size_t>(text.size()) + static_cast<size_t>(elided.size())) * LayoutCharCost);
+
+    if(cost > cache.budget()) {
+        // Too large to cache, so keep it around just long enough to draw it
+        static TextLayout uncached;
+        uncached = std::move(layout);
+        return uncached;
+    }
+
+    cache.insert(key, std::move(layout), cost);
+    return *cache.find(key);
+}
+
 template <typename Range>
-DrawTextResult drawTextBlocks(QPainter* painter, const QStyleOptionViewItem& option, QRect rect, const Range& blocks,
-                              Qt::Alignment alignment)
+DrawTextResult drawTextBlocks(TextLayoutCache& cache, QPainter* painter, const QStyleOptionViewItem& option,
+                              QRect rect, const Range& blocks, Qt::Alignment alignment)
 {
     DrawTextResult result;
 
-    QStyle* style     = option.widget ? option.widget->style() : QApplication::style();
-    const auto colour = option.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::NoRole;
+    const bool selected = option.state & QStyle::State_Selected;
 
     for(const auto& block : blocks) {
         painter->setFont(block.format.font);
-        painter->setPen(block.format.colour);
+        painter->setPen(selected ? option.palette.color(QPalette::HighlightedText) : block.format.colour);
 
-        result.bound = painter->boundingRect(rect, alignment | Qt::TextWrapAnywhere, block.text);
-        style->drawItemText(painter, rect, alignment, option.palette, true,
-                            painter->fontMetrics().elidedText(block.text, Qt::ElideRight, rect.width()), colour);
+        const TextLayout& layout = textLayout(cache, painter, rect.size(), block.text, alignment);
+
+        result.bound = layout.bound.translated(rect.topLeft());
+
+        if(!block.text.isEmpty()) {
+            if(layout.clip) {
+                painter->save();
+                painter->setClipRect(rect, Qt::IntersectClip);
+                painter->drawStaticText(rect.topLeft() + layout.pos, layout.text);
+                painter->restore();
+            }
+            else {
+                painter->drawStaticText(rect.topLeft() + layout.pos, layout.text);
+            }
+        }
 
         if(alignment & Qt::AlignRight) {
             rect.moveRight((rect.x() + rect.width()) - result.bound.width());
@@ -64,7 +154,8 @@ DrawTextResult drawTextBlocks(QPainter* painter, const QStyleOptionViewItem& opt
     return result;
 }
 
-void paintHeader(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index)
+void paintHeader(TextLayoutCache& cache, QPainter* painter, const QStyleOptionViewItem& option,
+                 const QModelIndex& index)
 {
     QStyleOptionViewItem opt{option};
     opt.text.clear();
@@ -107,7 +198,8 @@ void paintHeader(QPainter* painter, const QStyleOptionViewItem& option, const QM
 
     const QRect rightRect{rect.left() + halfWidth, rect.top(), halfWidth - offset, rect.height()};
     const auto [rightBound, totalRightWidth]
-        = drawTextBlocks(painter, opt, rightRect, side | std::views::reverse, Qt::AlignVCenter | Qt::AlignRight);
+        = drawTextBlocks(cache, painter, opt, rightRect, side | std::views::reverse,
+                         Qt::AlignVCenter | Qt::AlignRight);
 
     const int leftWidth = rect.width() - coverFrameRect.width() - totalRightWidth;
 
@@ -116,13 +208,13 @@ void paintHeader(QPainter* painter, const QStyleOptionViewItem& option, const QM
         subtitleRect.setWidth(subtitleRect.width() - (5 * offset));
     }
     const auto [subtitleBound, _]
-        = drawTextBlocks(painter, opt, subtitleRect, subtitle, Qt::AlignVCenter | Qt::AlignLeft);
+        = drawTextBlocks(cache, painter, opt, subtitleRect, subtitle, Qt::AlignVCenter | Qt::AlignLeft);
 
     const QRect titleRect{coverFrameRect.right() + 2 * offset, rect.top() + titleOffset, leftWidth, rect.height()};
-    drawTextBlocks(painter, opt, titleRect, title, Qt::AlignTop);
+    drawTextBlocks(cache, painter, opt, titleRect, title, Qt::AlignTop);
 
     const QRect infoRect{coverFrameRect.right() + 2 * offset, rect.top() - infoOffset, leftWidth, rect.height()};
-    drawTextBlocks(painter, opt, infoRect, info, Qt::AlignBottom);
+    drawTextBlocks(cache, painter, opt, infoRect, info, Qt::AlignBottom);
 
     const QLineF headerLine(coverFrameRect.right() + 2 * offset, coverFrameRect.bottom() + coverFrameWidth,
                             rect.right() - offset, coverFrameRect.bottom() + coverFrameWidth);
@@ -153,7 +245,8 @@ void paintHeader(QPainter* painter, const QStyleOptionViewItem& option, const QM
     }
 }
 
-void paintSimpleHeader(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index)
+void paintSimpleHeader(TextLayoutCache& cache, QPainter* painter, const QStyleOptionViewItem& option,
+                       const QModelIndex& index)
 {
     QStyleOptionViewItem opt{option};
     opt.text.clear();
@@ -179,13 +272,14 @@ void paintSimpleHeader(QPainter* painter, const QStyleOptionViewItem& option, co
 
     const QRect rightRect{rect.left() + halfWidth, rect.top(), halfWidth - offset, height};
     auto [rightBound, totalRightWidth]
-        = drawTextBlocks(painter, opt, rightRect, subtitle | std::views::reverse, Qt::AlignVCenter | Qt::AlignRight);
+        = drawTextBlocks(cache, painter, opt, rightRect, subtitle | std::views::reverse,
+                         Qt::AlignVCenter | Qt::AlignRight);
 
     QRect leftRect{rect.left() + offset, rect.top(), rect.width() - totalRightWidth, height};
     if(totalRightWidth > 0) {
         leftRect.setWidth(leftRect.width() - (4 * offset));
     }
-    auto [leftBound, _] = drawTextBlocks(painter, opt, leftRect, title, Qt::AlignVCenter | Qt::AlignLeft);
+    auto [leftBound, _] = drawTextBlocks(cache, painter, opt, leftRect, title, Qt::AlignVCenter | Qt::AlignLeft);
 
     if(!title.empty()) {
         if(subtitle.empty()) {
@@ -202,7 +296,8 @@ void paintSimpleHeader(QPainter* painter, const QStyleOptionViewItem& option, co
     }
 }
 
-void paintSubheader(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index)
+void paintSubheader(TextLayoutCache& cache, QPainter* painter, const QStyleOptionViewItem& option,
+                    const QModelIndex& index)
 {
     QStyleOptionViewItem opt{option};
 
@@ -226,13 +321,14 @@ void paintSubheader(QPainter* painter, const QStyleOptionViewItem& option, const
 
     const QRect rightRect{rect.left() + halfWidth, rect.top(), halfWidth - offset, height};
     auto [rightBound, totalRightWidth]
-        = drawTextBlocks(painter, opt, rightRect, subtitle | std::views::reverse, Qt::AlignVCenter | Qt::AlignRight);
+        = drawTextBlocks(cache, painter, opt, rightRect, subtitle | std::views::reverse,
+                         Qt::AlignVCenter | Qt::AlignRight);
 
     QRect leftRect{rect.left() + offset, rect.top(), rect.width() - totalRightWidth, height};
     if(totalRightWidth > 0) {
         leftRect.setWidth(leftRect.width() - (4 * offset));
     }
-    auto [leftBound, _] = drawTextBlocks(painter, opt, leftRect, title, Qt::AlignVCenter | Qt::AlignLeft);
+    auto [leftBound, _] = drawTextBlocks(cache, painter, opt, leftRect, title, Qt::AlignVCenter | Qt::AlignLeft);
 
     if(title.empty()) {
         leftBound = {rect.left(), rect.top(), 0, height};
@@ -251,7 +347,8 @@ void paintSubheader(QPainter* painter, const QStyleOptionViewItem& option, const
     painter->drawLine(titleLine);
 }
 
-void paintTrack(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index)
+void paintTrack(TextLayoutCache& cache, QPainter* painter, const QStyleOptionViewItem& option,
+                const QModelIndex& index)
 {
     QStyleOptionViewItem opt{option};
 
@@ -278,11 +375,11 @@ void paintTrack(QPainter* painter, const QStyleOptionViewItem& option, const QMo
         const auto rightSide = index.data(PlaylistItem::Role::Right).value<RichText>();
 
         const QRect rightRect     = textRect.adjusted(textRect.center().x() - textRect.left(), 0, -textMargin, 0);
-        auto [_, totalRightWidth] = drawTextBlocks(painter, opt, rightRect, rightSide | std::views::reverse,
+        auto [_, totalRightWidth] = drawTextBlocks(cache, painter, opt, rightRect, rightSide | std::views::reverse,
                                                    Qt::AlignVCenter | Qt::AlignRight);
 
         const QRect leftRect = textRect.adjusted(indent + textMargin, 0, -totalRightWidth, 0);
-        drawTextBlocks(painter, opt, leftRect, leftSide, Qt::AlignVCenter | Qt::AlignLeft);
+        drawTextBlocks(cache, painter, opt, leftRect, leftSide, Qt::AlignVCenter | Qt::AlignLeft);
 
         if(!icon.isNull()) {
             opt.rect.setX(opt.rect.x() + textMargin);
@@ -308,7 +405,7 @@ void paintTrack(QPainter* painter, const QStyleOptionViewItem& option, const QMo
             const auto columnText = index.data(PlaylistItem::Role::Column).value<RichText>();
 
             const QRect columnRect = textRect.adjusted(textMargin, 0, -textMargin, 0);
-            drawTextBlocks(painter, opt, columnRect, columnText, Qt::AlignVCenter | opt.displayAlignment);
+            drawTextBlocks(cache, painter, opt, columnRect, columnText, Qt::AlignVCenter | opt.displayAlignment);
 
             const auto icon = QIcon{index.data(Qt::DecorationRole).value<QPixmap>()};
             if(!icon.isNull()) {
@@ -318,6 +415,13 @@ void paintTrack(QPainter* painter, const QStyleOptionViewItem& option, const QMo
     }
 }
 
+PlaylistDelegate::PlaylistDelegate(QObject* parent)
+    : QStyledItemDelegate{parent}
+    , p{std::make_unique<Private>()}
+{ }
+
+PlaylistDelegate::~PlaylistDelegate() = default;
+
 void PlaylistDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
     painter->save();
@@ -328,15 +432,16 @@ void PlaylistDelegate::paint(QPainter* painter, const QStyleOptionViewItem& opti
     const auto type = index.data(PlaylistItem::Type).toInt();
     switch(type) {
         case(PlaylistItem::Track):
-            paintTrack(painter, opt, index);
+            paintTrack(p->layouts, painter, opt, index);
             break;
         case(PlaylistItem::Header): {
             const auto simple = index.data(PlaylistItem::Simple).toBool();
-            simple ? paintSimpleHeader(painter, opt, index) : paintHeader(painter, opt, index);
+            simple ? paintSimpleHeader(p->layouts, painter, opt, index)
+                   : paintHeader(p->layouts, painter, opt, index);
             break;
         }
         case(PlaylistItem::Subheader):
-            paintSubheader(painter, opt, index);
+            paintSubheader(p->layouts, painter, opt, index);
             break;
         default:
             break;
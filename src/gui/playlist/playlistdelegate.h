@@ -21,15 +21,22 @@
 
 #include <QStyledItemDelegate>
 
+#include <memory>
+
 namespace Fooyin {
 class PlaylistDelegate : public QStyledItemDelegate
 {
     Q_OBJECT
 
 public:
-    using QStyledItemDelegate::QStyledItemDelegate;
+    explicit PlaylistDelegate(QObject* parent = nullptr);
+    ~PlaylistDelegate() override;
 
     void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
     [[nodiscard]] QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
 };
 } // namespace Fooyin
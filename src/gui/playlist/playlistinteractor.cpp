@@ -25,12 +25,49 @@
 #include <core/library/musiclibrary.h>
 #include <core/playlist/playlist.h>
 #include <core/playlist/playlisthandler.h>
+#include <core/playlist/playlistparser.h>
 #include <core/track.h>
+#include <utils/async.h>
 #include <utils/fileutils.h>
+#include <utils/helpers.h>
 #include <utils/id.h>
 
+#include <QDebug>
+#include <QFileInfo>
 #include <QProgressDialog>
 
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+// Streamed additions read their first chunk small so rows appear quickly, then grow it to keep the readers busy
+constexpr size_t MinStreamChunk = 64;
+constexpr size_t MaxStreamChunk = 2048;
+
+namespace {
+// In playlist order, with a placeholder for each file which isn't in the library
+Fooyin::TrackList readPlaylist(const QString& filepath, const Fooyin::TrackSnapshot& library)
+{
+    QStringList filepaths;
+
+    QString error;
+    const bool success = Fooyin::PlaylistParser::read(
+        filepath,
+        [&filepaths](const Fooyin::PlaylistParser::Entry& entry) {
+            filepaths.append(entry.filepath);
+            return true;
+        },
+        &error);
+
+    if(!success) {
+        qWarning() << "[PlaylistInteractor] Failed to read playlist" << filepath << ":" << error;
+    }
+
+    return Fooyin::PlaylistInteractor::tracksForPaths(filepaths, library);
+}
+} // namespace
+
 namespace Fooyin {
 struct PlaylistInteractor::Private
 {
@@ -74,6 +111,165 @@ struct PlaylistInteractor::Private
                              }
                          });
     }
+
+    // As scanTracks, but without a dialog, for reads which happen in the background
+    template <typename Func>
+    void readTracks(const TrackList& tracks, Func&& func) const
+    {
+        const ScanRequest request = library->scanTracks(tracks);
+
+        // Only lives until the scan it's waiting for has finished
+        auto* receiver = new QObject(handler);
+        QObject::connect(library, &MusicLibrary::tracksScanned, receiver,
+                         [receiver, request, func = std::forward<Func>(func)](int id, const TrackList& scannedTracks) {
+                             if(id != request.id) {
+                                 return;
+                             }
+                             receiver->deleteLater();
+                             func(scannedTracks);
+                         });
+    }
+
+    // The tracks which aren't in the library, one per file
+    static TrackList unknownTracks(const TrackList& tracks)
+    {
+        TrackList unknown;
+        std::unordered_set<QString> unknownPaths;
+        for(const Track& track : tracks) {
+            if(!track.isInDatabase() && unknownPaths.emplace(track.filepath()).second) {
+                unknown.push_back(track);
+            }
+        }
+        return unknown;
+    }
+
+    // Replaces the placeholders in @p tracks with what was read for their file
+    static TrackList mergeScanned(const TrackList& tracks, const TrackList& scannedTracks)
+    {
+        std::unordered_map<QString, TrackList> scannedPaths;
+        for(const Track& track : scannedTracks) {
+            const QString container = track.hasCue()        ? track.cuePath()
+                                    : track.isInArchive() ? track.archivePath()
+                                                          : track.filepath();
+            scannedPaths[container].push_back(track);
+        }
+
+        TrackList resolvedTracks;
+        resolvedTracks.reserve(tracks.size());
+        for(const Track& track : tracks) {
+            if(track.isInDatabase()) {
+                resolvedTracks.push_back(track);
+            }
+            else if(const auto trackIt = scannedPaths.find(track.filepath()); trackIt != scannedPaths.end()) {
+                std::ranges::copy(trackIt->second, std::back_inserter(resolvedTracks));
+            }
+        }
+
+        return resolvedTracks;
+    }
+
+    /*!
+     * Calls @p func with @p tracks, in the same order, once those which aren't in the library have been read.
+     * Placeholders for unreadable files are dropped, and a CUE sheet or archive is replaced by all of its tracks.
+     */
+    template <typename Func>
+    void resolveTracks(const TrackList& tracks, Func&& func) const
+    {
+        const TrackList unknown = unknownTracks(tracks);
+
+        if(unknown.empty()) {
+            if(!tracks.empty()) {
+                func(tracks);
+            }
+            return;
+        }
+
+        scanTracks(unknown, [func = std::forward<Func>(func), tracks](const TrackList& scannedTracks) {
+            const TrackList resolvedTracks = mergeScanned(tracks, scannedTracks);
+            if(!resolvedTracks.empty()) {
+                func(resolvedTracks);
+            }
+        });
+    }
+
+    struct Stream
+    {
+        QString playlistName;
+        bool play{false};
+        TrackList tracks;
+        size_t next{0};
+        size_t chunkSize{MinStreamChunk};
+        // Set once the first rows have been added
+        Id playlistId;
+    };
+
+    // Appends @p tracks to the stream's playlist, creating it and making it current on the first chunk
+    void addStreamed(Stream& stream, const TrackList& tracks) const
+    {
+        if(tracks.empty()) {
+            return;
+        }
+
+        if(stream.playlistId.isValid()) {
+            if(handler->playlistById(stream.playlistId)) {
+                handler->appendToPlaylist(stream.playlistId, tracks);
+            }
+            return;
+        }
+
+        Playlist* playlist = handler->playlistByName(stream.playlistName);
+        if(playlist) {
+            const int indexToPlay = playlist->trackCount();
+            handler->appendToPlaylist(playlist->id(), tracks);
+            playlist->changeCurrentIndex(indexToPlay);
+        }
+        else {
+            playlist = handler->createPlaylist(stream.playlistName, tracks);
+        }
+
+        if(playlist) {
+            stream.playlistId = playlist->id();
+            controller->changeCurrentPlaylist(playlist);
+            if(stream.play) {
+                handler->startPlayback(playlist);
+            }
+        }
+    }
+
+    /*!
+     * Resolves the next chunk of @p stream and adds it, then moves on to the one after.
+     * Chunks are read one after another so rows are added in order, while the scanner reads within a chunk in
+     * parallel. A stream whose playlist is removed part way through stops at the next chunk.
+     */
+    void streamNext(const std::shared_ptr<Stream>& stream) const
+    {
+        if(stream->next >= stream->tracks.size()) {
+            return;
+        }
+        if(stream->playlistId.isValid() && !handler->playlistById(stream->playlistId)) {
+            return;
+        }
+
+        const size_t count = std::min(stream->chunkSize, stream->tracks.size() - stream->next);
+        const auto first   = stream->tracks.cbegin() + static_cast<std::ptrdiff_t>(stream->next);
+        TrackList chunk{first, first + static_cast<std::ptrdiff_t>(count)};
+
+        stream->next += count;
+        stream->chunkSize = std::min(stream->chunkSize * 2, MaxStreamChunk);
+
+        const TrackList unknown = unknownTracks(chunk);
+        if(unknown.empty()) {
+            addStreamed(*stream, chunk);
+            // Let the playlist update before resolving more, as a fully known stream never waits on a scan
+            QMetaObject::invokeMethod(handler, [this, stream]() { streamNext(stream); }, Qt::QueuedConnection);
+            return;
+        }
+
+        readTracks(unknown, [this, stream, chunk = std::move(chunk)](const TrackList& scannedTracks) {
+            addStreamed(*stream, mergeScanned(chunk, scannedTracks));
+            streamNext(stream);
+        });
+    }
 };
 
 PlaylistInteractor::PlaylistInteractor(PlaylistHandler* handler, PlaylistController* controller, MusicLibrary* library,
@@ -101,34 +297,66 @@ MusicLibrary* PlaylistInteractor::library() const
 
 void PlaylistInteractor::filesToCurrentPlaylist(const QList<QUrl>& urls) const
 {
-    const QStringList filepaths = Utils::File::getFiles(urls, Track::supportedFileExtensions());
-    if(filepaths.empty()) {
-        return;
-    }
+    tracksToCurrentPlaylist(tracksForFiles(urls));
+}
 
-    TrackList tracks;
-    std::ranges::transform(filepaths, std::back_inserter(tracks), [](const QString& path) { return Track{path}; });
+void PlaylistInteractor::filesToCurrentPlaylistReplace(const QList<QUrl>& urls, bool play) const
+{
+    tracksToCurrentPlaylistReplace(tracksForFiles(urls), play);
+}
 
-    p->scanTracks(tracks, [this](const TrackList& scannedTracks) {
-        if(auto* playlist = p->controller->currentPlaylist()) {
-            p->handler->appendToPlaylist(playlist->id(), scannedTracks);
+void PlaylistInteractor::filesToNewPlaylist(const QString& playlistName, const QList<QUrl>& urls, bool play) const
+{
+    tracksToNewPlaylist(playlistName, tracksForFiles(urls), play);
+}
+
+void PlaylistInteractor::streamFilesToPlaylist(const QString& playlistName, const QList<QUrl>& urls, bool play) const
+{
+    // Walking directories and matching against the library can take a while for thousands of files
+    Utils::asyncExec([urls, library = p->library->snapshot()]() {
+        const QStringList filepaths = Utils::File::getFiles(urls, Track::supportedFileExtensions());
+        return tracksForPaths(filepaths, library);
+    }).then(p->handler, [this, playlistName, play](const TrackList& tracks) {
+        if(tracks.empty()) {
+            return;
         }
+
+        auto stream          = std::make_shared<Private::Stream>();
+        stream->playlistName = playlistName;
+        stream->play         = play;
+        stream->tracks       = tracks;
+        p->streamNext(stream);
     });
 }
 
-void PlaylistInteractor::filesToCurrentPlaylistReplace(const QList<QUrl>& urls, bool play) const
+void PlaylistInteractor::filesToActivePlaylist(const QList<QUrl>& urls) const
 {
-    const QStringList filepaths = Utils::File::getFiles(urls, Track::supportedFileExtensions());
-    if(filepaths.empty()) {
+    if(!p->handler->activePlaylist()) {
         return;
     }
 
-    TrackList tracks;
-    std::ranges::transform(filepaths, std::back_inserter(tracks), [](const QString& path) { return Track{path}; });
+    tracksToActivePlaylist(tracksForFiles(urls));
+}
+
+void PlaylistInteractor::filesToTracks(const QList<QUrl>& urls, const std::function<void(const TrackList&)>& func) const
+{
+    p->resolveTracks(tracksForFiles(urls), func);
+}
+
+void PlaylistInteractor::tracksToCurrentPlaylist(const TrackList& tracks) const
+{
+    p->resolveTracks(tracks, [this](const TrackList& resolvedTracks) {
+        if(auto* playlist = p->controller->currentPlaylist()) {
+            p->handler->appendToPlaylist(playlist->id(), resolvedTracks);
+        }
+    });
+}
 
-    p->scanTracks(tracks, [this, play](const TrackList& scannedTracks) {
+void PlaylistInteractor::tracksToCurrentPlaylistReplace(const TrackList& tracks, bool play) const
+{
+    p->resolveTracks(tracks, [this, play](const TrackList& resolvedTracks) {
         if(auto* playlist = p->controller->currentPlaylist()) {
-            p->handler->replacePlaylistTracks(playlist->id(), scannedTracks);
+            p->handler->replacePlaylistTracks(playlist->id(), resolvedTracks);
             playlist->changeCurrentIndex(0);
             if(play) {
                 p->handler->startPlayback(playlist);
@@ -137,25 +365,17 @@ void PlaylistInteractor::filesToCurrentPlaylistReplace(const QList<QUrl>& urls,
     });
 }
 
-void PlaylistInteractor::filesToNewPlaylist(const QString& playlistName, const QList<QUrl>& urls, bool play) const
+void PlaylistInteractor::tracksToNewPlaylist(const QString& playlistName, const TrackList& tracks, bool play) const
 {
-    const QStringList filepaths = Utils::File::getFiles(urls, Track::supportedFileExtensions());
-    if(filepaths.empty()) {
-        return;
-    }
-
-    TrackList tracks;
-    std::ranges::transform(filepaths, std::back_inserter(tracks), [](const QString& path) { return Track{path}; });
-
-    auto handleScanResult = [this, playlistName, play](const TrackList& scannedTracks) {
+    p->resolveTracks(tracks, [this, playlistName, play](const TrackList& resolvedTracks) {
         Playlist* playlist = p->handler->playlistByName(playlistName);
         if(playlist) {
             const int indexToPlay = playlist->trackCount();
-            p->handler->appendToPlaylist(playlist->id(), scannedTracks);
+            p->handler->appendToPlaylist(playlist->id(), resolvedTracks);
             playlist->changeCurrentIndex(indexToPlay);
         }
         else {
-            playlist = p->handler->createPlaylist(playlistName, scannedTracks);
+            playlist = p->handler->createPlaylist(playlistName, resolvedTracks);
         }
 
         if(playlist) {
@@ -164,42 +384,71 @@ void PlaylistInteractor::filesToNewPlaylist(const QString& playlistName, const Q
                 p->handler->startPlayback(playlist);
             }
         }
-    };
-
-    p->scanTracks(tracks, handleScanResult);
+    });
 }
 
-void PlaylistInteractor::filesToActivePlaylist(const QList<QUrl>& urls) const
+void PlaylistInteractor::tracksToActivePlaylist(const TrackList& tracks) const
 {
-    if(!p->handler->activePlaylist()) {
-        return;
-    }
+    p->resolveTracks(tracks, [this](const TrackList& resolvedTracks) {
+        if(auto* playlist = p->handler->activePlaylist()) {
+            p->handler->appendToPlaylist(playlist->id(), resolvedTracks);
+        }
+    });
+}
 
+TrackList PlaylistInteractor::tracksForFiles(const QList<QUrl>& urls)
+{
     const QStringList filepaths = Utils::File::getFiles(urls, Track::supportedFileExtensions());
-    if(filepaths.empty()) {
-        return;
-    }
 
     TrackList tracks;
+    tracks.reserve(filepaths.size());
     std::ranges::transform(filepaths, std::back_inserter(tracks), [](const QString& path) { return Track{path}; });
 
-    p->scanTracks(tracks, [this](const TrackList& scannedTracks) {
-        if(auto* playlist = p->handler->activePlaylist()) {
-            p->handler->appendToPlaylist(playlist->id(), scannedTracks);
+    return tracks;
+}
+
+TrackList PlaylistInteractor::tracksForPaths(const QStringList& filepaths, const TrackSnapshot& library)
+{
+    TrackList tracks;
+    tracks.reserve(filepaths.size());
+    for(const QString& path : filepaths) {
+        if(const Track* track = library.trackForPath(path)) {
+            tracks.push_back(*track);
         }
-    });
+        else {
+            tracks.emplace_back(path);
+        }
+    }
+
+    return tracks;
 }
 
-void PlaylistInteractor::filesToTracks(const QList<QUrl>& urls, const std::function<void(const TrackList&)>& func) const
+void PlaylistInteractor::importPlaylist(const QString& filepath) const
 {
-    const QStringList filepaths = Utils::File::getFiles(urls, Track::supportedFileExtensions());
-    if(filepaths.empty()) {
+    const QString name = Utils::findUniqueString(QFileInfo{filepath}.completeBaseName(), p->handler->playlists(),
+                                                 [](const auto* playlist) { return playlist->name(); });
+
+    // Parsing and resolving against the library happen off the main thread, as playlists can be huge
+    Utils::asyncExec([filepath, library = p->library->snapshot()]() { return readPlaylist(filepath, library); })
+        .then(p->handler, [this, name](const TrackList& tracks) {
+            p->resolveTracks(tracks, [this, name](const TrackList& playlistTracks) {
+                if(auto* playlist = p->handler->createPlaylist(name, playlistTracks)) {
+                    p->controller->changeCurrentPlaylist(playlist);
+                }
+            });
+        });
+}
+
+void PlaylistInteractor::exportPlaylist(const Playlist* playlist, const QString& filepath) const
+{
+    if(!playlist) {
         return;
     }
 
-    TrackList tracks;
-    std::ranges::transform(filepaths, std::back_inserter(tracks), [](const QString& path) { return Track{path}; });
-
-    p->scanTracks(tracks, func);
+    Utils::asyncExec([filepath, tracks = playlist->tracks()]() {
+        if(!PlaylistParser::write(filepath, tracks)) {
+            qWarning() << "[PlaylistInteractor] Failed to write playlist" << filepath;
+        }
+    });
 }
 } // namespace Fooyin
@@ -23,13 +23,16 @@
 
 #include <QList>
 #include <QObject>
+#include <QStringList>
 #include <QUrl>
 
 namespace Fooyin {
 class MusicLibrary;
+class Playlist;
 class PlaylistController;
 class PlaylistHandler;
 class PlaylistWidget;
+class TrackSnapshot;
 
 class PlaylistInteractor : public QObject
 {
@@ -48,8 +51,39 @@ public:
     void filesToCurrentPlaylistReplace(const QList<QUrl>& urls, bool play = false) const;
     void filesToNewPlaylist(const QString& playlistName, const QList<QUrl>& urls, bool play = false) const;
     void filesToActivePlaylist(const QList<QUrl>& urls) const;
+    /*!
+     * Adds the files in @p urls to the playlist @p playlistName, creating it if it doesn't exist.
+     * Files are found and matched against the library in the background, then the rest are read in chunks,
+     * so rows appear as they resolve rather than once every file has been read.
+     */
+    void streamFilesToPlaylist(const QString& playlistName, const QList<QUrl>& urls, bool play = false) const;
     void filesToTracks(const QList<QUrl>& urls, const std::function<void(const TrackList&)>& func) const;
 
+    /*!
+     * As the files variants, but with tracks already resolved, e.g. from the library.
+     * Only tracks which aren't in the library are read, and the order of @p tracks is kept.
+     */
+    void tracksToCurrentPlaylist(const TrackList& tracks) const;
+    void tracksToCurrentPlaylistReplace(const TrackList& tracks, bool play = false) const;
+    void tracksToNewPlaylist(const QString& playlistName, const TrackList& tracks, bool play = false) const;
+    void tracksToActivePlaylist(const TrackList& tracks) const;
+
+    /** Returns a placeholder track for each supported file in @p urls, including those in directories. */
+    [[nodiscard]] static TrackList tracksForFiles(const QList<QUrl>& urls);
+    /*!
+     * Returns the track in @p library for each of @p filepaths, or a placeholder if it isn't there.
+     * @note safe to call from any thread.
+     */
+    [[nodiscard]] static TrackList tracksForPaths(const QStringList& filepaths, const TrackSnapshot& library);
+
+    /*!
+     * Reads the playlist file @p filepath into a new playlist named after it.
+     * Entries already in the library are resolved by path, and only the remaining files are scanned.
+     */
+    void importPlaylist(const QString& filepath) const;
+    /** Writes the tracks of @p playlist to @p filepath, in the format matching its extension. */
+    void exportPlaylist(const Playlist* playlist, const QString& filepath) const;
+
 private:
     struct Private;
     std::unique_ptr<Private> p;
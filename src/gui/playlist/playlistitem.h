@@ -86,7 +86,9 @@ public:
 
     void appendChild(PlaylistItem* child) override;
     void insertChild(int row, PlaylistItem* child) override;
+    void insertChildren(int row, const std::vector<PlaylistItem*>& children) override;
     void removeChild(int index) override;
+    void removeChildren(int index, int count) override;
 
 private:
     bool m_pending;
@@ -20,9 +20,12 @@
 #include "playlistitemmodels.h"
 
 #include <core/scripting/scriptparser.h>
+#include <core/scripting/scriptregistry.h>
 
 #include <QFontMetrics>
 
+#include <algorithm>
+
 namespace Fooyin {
 PlaylistContainerItem::PlaylistContainerItem(bool isSimple)
     : m_simple{isSimple}
@@ -39,6 +42,11 @@ int PlaylistContainerItem::trackCount() const
     return static_cast<int>(m_tracks.size());
 }
 
+const TrackListAggregate& PlaylistContainerItem::aggregate() const
+{
+    return m_aggregate;
+}
+
 RichScript PlaylistContainerItem::title() const
 {
     return m_title;
@@ -69,7 +77,8 @@ QSize PlaylistContainerItem::size() const
     return m_size;
 }
 
-void PlaylistContainerItem::updateGroupText(ScriptParser* parser, ScriptFormatter* formatter)
+void PlaylistContainerItem::updateGroupText(ScriptParser* parser, ScriptRegistry* registry,
+                                            ScriptFormatter* formatter)
 {
     if(m_tracks.empty()) {
         return;
@@ -85,10 +94,18 @@ void PlaylistContainerItem::updateGroupText(ScriptParser* parser, ScriptFormatte
         script.text           = formatter->evaluate(evalScript);
     };
 
+    if(registry) {
+        registry->setListAggregate(&m_aggregate);
+    }
+
     evaluateBlocks(m_title);
     evaluateBlocks(m_subtitle);
     evaluateBlocks(m_info);
     evaluateBlocks(m_sideText);
+
+    if(registry) {
+        registry->setListAggregate(nullptr);
+    }
 }
 
 void PlaylistContainerItem::setTitle(const RichScript& title)
@@ -119,16 +136,36 @@ void PlaylistContainerItem::setRowHeight(int height)
 void PlaylistContainerItem::addTrack(const Track& track)
 {
     m_tracks.emplace_back(track);
+    m_aggregate.add(track);
 }
 
 void PlaylistContainerItem::addTracks(const TrackList& tracks)
 {
     std::ranges::copy(tracks, std::back_inserter(m_tracks));
+    m_aggregate.add(tracks);
+}
+
+void PlaylistContainerItem::addTracks(const PlaylistContainerItem& container)
+{
+    std::ranges::copy(container.m_tracks, std::back_inserter(m_tracks));
+    m_aggregate.merge(container.m_aggregate);
+}
+
+void PlaylistContainerItem::replaceTrack(const Track& track)
+{
+    for(Track& existing : m_tracks) {
+        if(existing.id() == track.id()) {
+            m_aggregate.remove(existing);
+            m_aggregate.add(track);
+            existing = track;
+        }
+    }
 }
 
 void PlaylistContainerItem::clearTracks()
 {
     m_tracks.clear();
+    m_aggregate.clear();
 }
 
 void PlaylistContainerItem::calculateSize()
@@ -249,9 +286,20 @@ QSize PlaylistTrackItem::size(int column) const
     return m_sizes.at(column);
 }
 
+bool PlaylistTrackItem::columnsPending() const
+{
+    return m_columnsPending;
+}
+
 void PlaylistTrackItem::setColumns(const std::vector<RichScript>& columns)
 {
-    m_columns = columns;
+    m_columns        = columns;
+    m_columnsPending = false;
+}
+
+void PlaylistTrackItem::setColumnsPending(bool pending)
+{
+    m_columnsPending = pending;
 }
 
 void PlaylistTrackItem::setLeftRight(const RichScript& left, const RichScript& right)
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <core/scripting/tracklistaggregate.h>
 #include <core/track.h>
 #include <gui/scripting/scriptformatter.h>
 
@@ -27,6 +28,7 @@
 namespace Fooyin {
 class PlaylistScriptRegistry;
 class ScriptParser;
+class ScriptRegistry;
 
 class PlaylistContainerItem
 {
@@ -35,6 +37,8 @@ public:
 
     [[nodiscard]] TrackList tracks() const;
     [[nodiscard]] int trackCount() const;
+    // Totals for the list properties of the group, kept up to date as tracks are added and replaced
+    [[nodiscard]] const TrackListAggregate& aggregate() const;
 
     [[nodiscard]] RichScript title() const;
     [[nodiscard]] RichScript subtitle() const;
@@ -43,7 +47,7 @@ public:
     [[nodiscard]] int rowHeight() const;
     [[nodiscard]] QSize size() const;
 
-    void updateGroupText(ScriptParser* parser, ScriptFormatter* formatter);
+    void updateGroupText(ScriptParser* parser, ScriptRegistry* registry, ScriptFormatter* formatter);
 
     void setTitle(const RichScript& title);
     void setSubtitle(const RichScript& subtitle);
@@ -53,12 +57,17 @@ public:
 
     void addTrack(const Track& track);
     void addTracks(const TrackList& tracks);
+    // Adds the tracks of @p container, reusing its totals
+    void addTracks(const PlaylistContainerItem& container);
+    // Replaces every copy of @p track (matched by id) with the given version
+    void replaceTrack(const Track& track);
     void clearTracks();
 
     void calculateSize();
 
 private:
     TrackList m_tracks;
+    TrackListAggregate m_aggregate;
 
     RichScript m_title;
     RichScript m_subtitle;
@@ -85,8 +94,11 @@ public:
     [[nodiscard]] int rowHeight() const;
     [[nodiscard]] int depth() const;
     [[nodiscard]] QSize size(int column = 0) const;
+    // Columns left to be evaluated when first shown, see PlaylistPopulator::setLazyColumns
+    [[nodiscard]] bool columnsPending() const;
 
     void setColumns(const std::vector<RichScript>& columns);
+    void setColumnsPending(bool pending);
     void setLeftRight(const RichScript& left, const RichScript& right);
 
     void setRowHeight(int height);
@@ -104,5 +116,6 @@ private:
     std::vector<QSize> m_sizes;
     int m_rowHeight;
     int m_depth;
+    bool m_columnsPending{false};
 };
 } // namespace Fooyin
@@ -20,9 +20,11 @@
 #include "playlistmodel.h"
 
 #include "internalguisettings.h"
+#include "modelupdatescheduler.h"
 #include "playlistitem.h"
 #include "playlistpopulator.h"
 #include "playlistpreset.h"
+#include "playlistprofiler.h"
 #include "playlistscriptregistry.h"
 
 #include <core/library/musiclibrary.h>
@@ -32,21 +34,36 @@
 #include <gui/coverprovider.h>
 #include <gui/guiconstants.h>
 #include <gui/guisettings.h>
+#include <gui/trackmimedata.h>
 #include <utils/crypto.h>
+#include <utils/memoryusage.h>
 #include <utils/settings/settingsmanager.h>
+#include <utils/tracing.h>
 #include <utils/utils.h>
 #include <utils/widgets/autoheaderview.h>
 
 #include <QApplication>
+#include <QDataStream>
 #include <QFontMetrics>
 #include <QIODevice>
 #include <QIcon>
 #include <QMimeData>
 #include <QPalette>
 
+#include <algorithm>
 #include <queue>
 #include <span>
 #include <stack>
+#include <utility>
+
+// Rows with lazily evaluated columns kept evaluated, a few screens' worth
+constexpr int LazyColumnCacheSize = 2000;
+// Position updates wanted while a column shows playback state; cells are only repainted once a second passes
+constexpr int PlaybackColumnInterval = 250;
+// Top level rows added per fetch, so appending a large batch doesn't stall the main thread
+constexpr int TopLevelFetchSize = 200;
+// Rows kept from populations shown recently, enough to switch back and forth between presets on a large playlist
+constexpr size_t PopulationCacheRows = 300000;
 
 namespace {
 bool cmpItemsPlaylistItems(Fooyin::PlaylistItem* pItem1, Fooyin::PlaylistItem* pItem2, bool reverse = false)
@@ -156,7 +173,7 @@ int determineDropIndex(const QAbstractItemModel* model, const QModelIndex& paren
 
 Fooyin::PlaylistItem* cloneParent(Fooyin::ItemKeyMap& nodes, Fooyin::PlaylistItem* parent)
 {
-    const QString parentKey = Fooyin::Utils::generateRandomHash();
+    const QString parentKey = Fooyin::Utils::generateUniqueKey();
     auto* newParent         = &nodes.emplace(parentKey, *parent).first->second;
     newParent->setKey(parentKey);
     newParent->resetRow();
@@ -400,32 +417,15 @@ struct SplitParent
     std::vector<Fooyin::PlaylistItem*> children;
 };
 
-QByteArray saveTracks(const QModelIndexList& indexes)
+Fooyin::TrackList tracksForIndexes(const QModelIndexList& indexes)
 {
-    QByteArray result;
-    QDataStream stream(&result, QIODevice::WriteOnly);
+    Fooyin::TrackList tracks;
+    tracks.reserve(indexes.size());
 
-    Fooyin::TrackIds trackIds;
-    trackIds.reserve(indexes.size());
-
-    std::ranges::transform(indexes, std::back_inserter(trackIds), [](const QModelIndex& index) {
-        return index.data(Fooyin::PlaylistItem::Role::ItemData).value<Fooyin::Track>().id();
+    std::ranges::transform(indexes, std::back_inserter(tracks), [](const QModelIndex& index) {
+        return index.data(Fooyin::PlaylistItem::Role::ItemData).value<Fooyin::Track>();
     });
 
-    stream << trackIds;
-
-    return result;
-}
-
-Fooyin::TrackList restoreTracks(Fooyin::MusicLibrary* library, QByteArray data)
-{
-    Fooyin::TrackIds ids;
-    QDataStream stream(&data, QIODevice::ReadOnly);
-
-    stream >> ids;
-
-    Fooyin::TrackList tracks = library->tracksForIds(ids);
-
     return tracks;
 }
 
@@ -525,8 +525,7 @@ void updateHeaderChildren(Fooyin::PlaylistItem* header)
                 container.addTrack(track);
             }
             else {
-                const Fooyin::TrackList tracks = std::get<1>(child->data()).tracks();
-                container.addTracks(tracks);
+                container.addTracks(std::get<1>(child->data()));
             }
         }
     }
@@ -553,6 +552,12 @@ PlaylistModel::PlaylistModel(MusicLibrary* library, PlayerController* playerCont
     , m_currentPlaylist{nullptr}
     , m_currentPlayState{PlayState::Stopped}
     , m_tempCurrentPlayingIndex{-1}
+    , m_playerController{playerController}
+    , m_lazyColumns{settings->value<Settings::Gui::Internal::PlaylistLazyColumns>()}
+    , m_columnRegistry{std::make_unique<PlaylistScriptRegistry>(playerController)}
+    , m_columnParser{m_columnRegistry.get()}
+    , m_columnCache{LazyColumnCacheSize}
+    , m_populationCache{PopulationCacheRows}
 {
     m_playingColour.setAlpha(90);
     m_disabledColour.setAlpha(50);
@@ -567,8 +572,14 @@ PlaylistModel::PlaylistModel(MusicLibrary* library, PlayerController* playerCont
 
     settings->subscribe<Settings::Gui::IconTheme>(this, updateIcons);
 
-    m_populator.moveToThread(&m_populatorThread);
-    m_populatorThread.start();
+    m_populator.setLazyColumns(m_lazyColumns);
+    m_populator.setLane(TaskScheduler::Lane::Interactive);
+
+    m_settings->subscribe<Settings::Gui::Internal::PlaylistLazyColumns>(this, [this](bool enabled) {
+        // Rows populated already keep their columns until the playlist is next populated
+        m_lazyColumns = enabled;
+        m_populator.setLazyColumns(enabled);
+    });
 
     m_settings->subscribe<Settings::Gui::Internal::PlaylistAltColours>(this, [this](bool enabled) {
         m_altColours = enabled;
@@ -595,15 +606,23 @@ PlaylistModel::PlaylistModel(MusicLibrary* library, PlayerController* playerCont
 
     QObject::connect(&m_populator, &PlaylistPopulator::finished, this, [this]() {
         m_playlistLoaded = true;
+        m_loadedKey      = m_populationKey;
         emit dataChanged({}, {});
         emit playlistLoaded();
     });
 
-    QObject::connect(&m_populator, &PlaylistPopulator::populated, this,
-                     [this](PendingData data) { populateModel(data); });
+    // Results of superseded runs would be merged into the wrong model state
+    QObject::connect(&m_populator, &PlaylistPopulator::populated, this, [this](const PendingDataPtr& data) {
+        if(m_populator.isCurrent(data->generation)) {
+            populateModel(*data);
+        }
+    });
 
-    QObject::connect(&m_populator, &PlaylistPopulator::populatedTrackGroup, this,
-                     [this](PendingData data) { populateTrackGroup(data); });
+    QObject::connect(&m_populator, &PlaylistPopulator::populatedTrackGroup, this, [this](const PendingDataPtr& data) {
+        if(m_populator.isCurrent(data->generation)) {
+            populateTrackGroup(*data);
+        }
+    });
 
     QObject::connect(&m_populator, &PlaylistPopulator::headersUpdated, this,
                      [this](ItemKeyMap data) { updateModel(data); });
@@ -611,15 +630,37 @@ PlaylistModel::PlaylistModel(MusicLibrary* library, PlayerController* playerCont
     QObject::connect(&m_populator, &PlaylistPopulator::tracksUpdated, this,
                      [this](const ItemList& data) { updateTracks(data); });
 
+    QObject::connect(&m_populator, &PlaylistPopulator::tracksDiffed, this, [this](const TrackDiff& diff) {
+        if(m_populator.isCurrent(diff.generation)) {
+            applyTrackDiff(diff);
+        }
+    });
+
     QObject::connect(m_coverProvider, &CoverProvider::coverAdded, this,
                      [this](const Track& track) { coverUpdated(track); });
+
+    QObject::connect(m_playerController, &PlayerController::positionChanged, this, [this](uint64_t ms) {
+        if(ms / 1000 != m_playbackSecond) {
+            m_playbackSecond = ms / 1000;
+            updatePlaybackColumns();
+        }
+    });
+    QObject::connect(m_playerController, &PlayerController::streamTitleChanged, this,
+                     [this]() { updatePlaybackColumns(); });
+
+    registerMemorySources();
 }
 
 PlaylistModel::~PlaylistModel()
 {
-    m_populator.stopThread();
-    m_populatorThread.quit();
-    m_populatorThread.wait();
+    ModelUpdateScheduler::instance().cancel(this);
+
+    for(const int source : m_memorySources) {
+        MemoryUsage::removeSource(source);
+    }
+
+    m_populator.closeThread();
+    m_populator.waitForTasks();
 }
 
 Qt::ItemFlags PlaylistModel::flags(const QModelIndex& index) const
@@ -685,6 +726,10 @@ bool PlaylistModel::setHeaderData(int section, Qt::Orientation /*orientation*/,
 
 QVariant PlaylistModel::data(const QModelIndex& index, int role) const
 {
+    if(m_profiler) {
+        m_profiler->countDataCall();
+    }
+
     if(!checkIndex(index, CheckIndexOption::IndexIsValid)) {
         return {};
     }
@@ -737,7 +782,8 @@ void PlaylistModel::fetchMore(const QModelIndex& parent)
     auto& rows = m_pendingNodes.at(parentItem->key());
 
     const int row      = parentItem->childCount();
-    const int rowCount = static_cast<int>(rows.size());
+    const int rowCount = parent.isValid() ? static_cast<int>(rows.size())
+                                          : std::min(TopLevelFetchSize, static_cast<int>(rows.size()));
 
     const auto rowsToInsert = std::views::take(rows, rowCount);
 
@@ -750,7 +796,8 @@ void PlaylistModel::fetchMore(const QModelIndex& parent)
 
     rows.erase(rows.begin(), rows.begin() + rowCount);
 
-    updateTrackIndexes();
+    // Top level rows are appended after every track already in the tree, so only they need numbering
+    updateTrackIndexes(parent.isValid() ? 0 : row);
 }
 
 bool PlaylistModel::canFetchMore(const QModelIndex& parent) const
@@ -820,8 +867,11 @@ Qt::DropActions PlaylistModel::supportedDropActions() const
 
 QMimeData* PlaylistModel::mimeData(const QModelIndexList& indexes) const
 {
-    auto* mimeData = new QMimeData();
-    storeMimeData(indexes, mimeData);
+    QModelIndexList sortedIndexes{indexes};
+    std::ranges::sort(sortedIndexes, cmpTrackIndices);
+
+    auto* mimeData = new TrackMimeData(tracksForIndexes(sortedIndexes));
+    storeMimeData(sortedIndexes, mimeData);
     return mimeData;
 }
 
@@ -835,6 +885,12 @@ bool PlaylistModel::dropMimeData(const QMimeData* data, Qt::DropAction action, i
     return prepareDrop(data, action, row, column, parent);
 }
 
+void PlaylistModel::setProfiler(PlaylistProfiler* profiler)
+{
+    m_profiler = profiler;
+    m_populator.setProfiler(profiler);
+}
+
 bool PlaylistModel::playlistIsLoaded() const
 {
     return m_playlistLoaded;
@@ -847,6 +903,8 @@ bool PlaylistModel::haveTracks() const
 
 MoveOperation PlaylistModel::moveTracks(const MoveOperation& operation)
 {
+    invalidatePopulation();
+
     MoveOperation reverseOperation;
     MoveOperationMap pendingGroups;
 
@@ -976,20 +1034,26 @@ void PlaylistModel::reset(const PlaylistPreset& preset, const PlaylistColumnList
     m_pixmapColumns = pixmapColumns();
 
     if(!playlist) {
+        updateColumnScripts();
         return;
     }
 
-    m_populator.stopThread();
+    m_coverProvider->cancelPending();
 
     m_playlistLoaded  = false;
     m_resetting       = true;
     m_currentPlaylist = playlist;
 
     updateHeader(playlist);
+    updateColumnScripts();
 
-    QMetaObject::invokeMethod(&m_populator, [this, playlist] {
-        m_populator.run(m_currentPlaylist->id(), m_currentPreset, m_columns, playlist->tracks());
-    });
+    m_populationKey = populationKey(playlist);
+    if(restorePopulation(m_populationKey)) {
+        return;
+    }
+
+    m_populator.startJob([this, id = playlist->id(), preset = m_currentPreset, columns = m_columns,
+                          tracks = playlist->tracks()] { m_populator.run(id, preset, columns, tracks); });
 }
 
 PlaylistTrack PlaylistModel::playingTrack() const
@@ -997,6 +1061,51 @@ PlaylistTrack PlaylistModel::playingTrack() const
     return m_currentPlayingTrack;
 }
 
+std::optional<std::vector<QString>> PlaylistModel::columnSortKeys(int column, const TrackList& tracks) const
+{
+    if(!m_playlistLoaded || column < 0 || std::cmp_greater_equal(column, m_columnScripts.size())
+       || m_columns.at(column).isPixmap) {
+        return {};
+    }
+
+    const ScriptDependencies& deps = m_columnScripts.at(column).dependencies;
+    if(deps.context || deps.playback) {
+        return {};
+    }
+
+    // Tracks still to be fetched aren't numbered yet
+    if(m_trackIndexes.size() != tracks.size()) {
+        return {};
+    }
+
+    std::vector<QString> keys;
+    keys.reserve(tracks.size());
+
+    for(const auto& [index, key] : m_trackIndexes) {
+        const auto itemIt = m_nodes.find(key);
+        if(std::cmp_not_equal(index, keys.size()) || itemIt == m_nodes.cend()) {
+            return {};
+        }
+
+        const auto* track = std::get_if<PlaylistTrackItem>(&itemIt->second.data());
+        if(!track || !(track->track() == tracks.at(index))) {
+            return {};
+        }
+
+        if(!track->columnsPending()) {
+            keys.push_back(track->column(column).text.joinedText());
+        }
+        else if(const auto* columns = m_columnCache.object(key)) {
+            keys.push_back(columns->at(column).text.joinedText());
+        }
+        else {
+            return {};
+        }
+    }
+
+    return keys;
+}
+
 TrackIndexResult PlaylistModel::trackIndexAtPlaylistIndex(int index, bool fetch)
 {
     if(m_trackIndexes.empty()) {
@@ -1038,14 +1147,89 @@ QModelIndex PlaylistModel::indexAtPlaylistIndex(int index)
 
 void PlaylistModel::insertTracks(const TrackGroups& tracks)
 {
+    invalidatePopulation();
+
     if(m_currentPlaylist) {
-        QMetaObject::invokeMethod(&m_populator, [this, tracks] {
-            m_populator.runTracks(m_currentPlaylist->id(), m_currentPreset, m_columns, tracks);
-        });
+        m_populator.schedule([this, id = m_currentPlaylist->id(), preset = m_currentPreset, columns = m_columns,
+                              tracks] { m_populator.runTracks(id, preset, columns, tracks); });
     }
 }
 
 void PlaylistModel::updateTracks(const std::vector<int>& indexes)
+{
+    invalidatePopulation();
+
+    if(!m_currentPlaylist) {
+        return;
+    }
+
+    TrackChangeList changes;
+
+    for(const int index : indexes) {
+        const auto& [modelIndex, end] = trackIndexAtPlaylistIndex(index, true);
+        if(end) {
+            continue;
+        }
+
+        const auto track = m_currentPlaylist->track(index);
+        if(!track.isValid()) {
+            continue;
+        }
+
+        PlaylistItem* item = itemForIndex(modelIndex);
+
+        TrackChange& change = changes.emplace_back();
+        change.index        = index;
+        change.track        = track;
+        change.item         = *item;
+
+        PlaylistItem* parent = item->parent();
+        while(parent && parent->type() != PlaylistItem::Root) {
+            change.parents.insert(change.parents.begin(), *parent);
+            parent = parent->parent();
+        }
+    }
+
+    if(changes.empty()) {
+        tracksAboutToBeChanged();
+        tracksChanged();
+        return;
+    }
+
+    m_populator.schedule([this, id = m_currentPlaylist->id(), preset = m_currentPreset, columns = m_columns,
+                          changes] { m_populator.diffTracks(id, preset, columns, changes); });
+}
+
+void PlaylistModel::applyTrackDiff(const TrackDiff& diff)
+{
+    if(m_resetting || !m_currentPlaylist || m_currentPlaylist->id() != diff.playlistId) {
+        return;
+    }
+
+    invalidatePopulation();
+    updateTracks(diff.tracks);
+
+    for(const auto& [key, header] : diff.headers) {
+        if(m_nodes.contains(key)) {
+            // Only the text changes, the children were left untouched
+            auto* node = &m_nodes.at(key);
+            node->setData(header.data());
+
+            const QModelIndex headerIndex = indexOfItem(node);
+            emit dataChanged(headerIndex, headerIndex, {});
+        }
+    }
+
+    if(diff.regroup.empty()) {
+        tracksAboutToBeChanged();
+        tracksChanged();
+        return;
+    }
+
+    regroupTracks(diff.regroup);
+}
+
+void PlaylistModel::regroupTracks(const std::vector<int>& indexes)
 {
     TrackGroups groups;
 
@@ -1082,6 +1266,13 @@ void PlaylistModel::updateTracks(const std::vector<int>& indexes)
 
 void PlaylistModel::refreshTracks(const std::vector<int>& indexes)
 {
+    invalidatePopulation();
+
+    if(m_currentPlaylist && m_columnDependencies.context) {
+        // The queue may have changed
+        m_columnRegistry->setup(m_currentPlaylist->id(), m_playerController->playbackQueue());
+    }
+
     TrackItemMap items;
 
     for(const int index : indexes) {
@@ -1093,14 +1284,14 @@ void PlaylistModel::refreshTracks(const std::vector<int>& indexes)
     }
 
     if(m_currentPlaylist) {
-        QMetaObject::invokeMethod(&m_populator, [this, items] {
-            m_populator.updateTracks(m_currentPlaylist->id(), m_currentPreset, m_columns, items);
-        });
+        m_populator.schedule([this, id = m_currentPlaylist->id(), preset = m_currentPreset, columns = m_columns,
+                              items] { m_populator.updateTracks(id, preset, columns, items); });
     }
 }
 
 void PlaylistModel::removeTracks(const QModelIndexList& indexes)
 {
+    invalidatePopulation();
     tracksAboutToBeChanged();
 
     const auto indexesToRemove = optimiseSelection(this, indexes);
@@ -1146,6 +1337,8 @@ void PlaylistModel::updateHeader(Playlist* playlist)
 
 bool PlaylistModel::removeColumn(int column)
 {
+    invalidatePopulation();
+
     if(column < 0 || std::cmp_greater_equal(column, m_columns.size())) {
         return false;
     }
@@ -1161,6 +1354,8 @@ bool PlaylistModel::removeColumn(int column)
         node.removeColumn(column);
     }
 
+    updateColumnScripts();
+
     endRemoveColumns();
 
     return true;
@@ -1213,30 +1408,42 @@ void PlaylistModel::tracksChanged()
 
     emit playlistTracksChanged(playingIndex);
 
+    // Rows may have moved, so anything shown which depends on their position is out of date
+    if(m_columnDependencies.context) {
+        clearColumnCache();
+    }
+
     m_currentPlayingIndex     = QPersistentModelIndex{};
     m_tempCurrentPlayingIndex = -1;
 }
 
 void PlaylistModel::playingTrackChanged(const PlaylistTrack& track)
 {
-    m_currentPlayingTrack = track;
-    emit dataChanged({}, {}, {Qt::DecorationRole, Qt::BackgroundRole});
+    const PlaylistTrack previous = std::exchange(m_currentPlayingTrack, track);
+    m_playbackSecond             = 0;
+
+    playingRowChanged(previous);
+    if(track.indexInPlaylist != previous.indexInPlaylist || track.playlistId != previous.playlistId) {
+        playingRowChanged(track);
+    }
 }
 
 void PlaylistModel::playStateChanged(PlayState state)
 {
     m_currentPlayState = state;
-    emit dataChanged({}, {}, {Qt::DecorationRole, Qt::BackgroundRole});
+    playingRowChanged(m_currentPlayingTrack);
 }
 
 void PlaylistModel::populateModel(PendingData& data)
 {
+    FY_TRACE_SCOPE("PlaylistModel::populateModel");
     if(m_currentPlaylist && m_currentPlaylist->id() != data.playlistId) {
         return;
     }
 
     if(m_resetting) {
         beginResetModel();
+        stashPopulation();
         resetRoot();
         m_nodes.clear();
         m_pendingNodes.clear();
@@ -1264,11 +1471,14 @@ void PlaylistModel::populateModel(PendingData& data)
         for(auto& [parentKey, rows] : data.nodes) {
             std::ranges::copy(rows, std::back_inserter(m_pendingNodes[parentKey]));
         }
+
+        fetchInBackground();
     }
 }
 
 void PlaylistModel::populateTrackGroup(PendingData& data)
 {
+    FY_TRACE_SCOPE("PlaylistModel::populateTrackGroup");
     if(m_currentPlaylist && m_currentPlaylist->id() != data.playlistId) {
         return;
     }
@@ -1321,6 +1531,8 @@ void PlaylistModel::updateTracks(const ItemList& tracks)
     }
 
     for(const PlaylistItem& item : tracks) {
+        m_columnCache.remove(item.key());
+
         if(m_nodes.contains(item.key())) {
             auto* node = &m_nodes.at(item.key());
             node->setData(item.data());
@@ -1351,6 +1563,269 @@ void PlaylistModel::mergeTrackParents(const TrackIdNodeMap& parents)
     }
 }
 
+void PlaylistModel::updateColumnScripts()
+{
+    clearColumnCache();
+
+    if(m_currentPlaylist) {
+        m_columnRegistry->setup(m_currentPlaylist->id(), m_playerController->playbackQueue());
+    }
+
+    m_columnParser.clearCache();
+    m_columnScripts.clear();
+    m_columnDependencies = {};
+
+    for(const auto& column : m_columns) {
+        const ParsedScript& script = m_columnScripts.emplace_back(m_columnParser.parse(column.field));
+
+        const ScriptDependencies& deps = script.dependencies;
+        m_columnDependencies.variables.append(deps.variables);
+        m_columnDependencies.allFields |= deps.allFields;
+        m_columnDependencies.playback |= deps.playback;
+        m_columnDependencies.context |= deps.context;
+    }
+
+    m_columnDependencies.variables.sort();
+    m_columnDependencies.variables.removeDuplicates();
+
+    m_playbackColumns.clear();
+    for(size_t i{0}; i < m_columnScripts.size(); ++i) {
+        if(m_columnScripts.at(i).dependencies.playback) {
+            m_playbackColumns.push_back(static_cast<int>(i));
+        }
+    }
+
+    if(m_playbackColumns.empty()) {
+        m_playerController->releasePositionUpdates(this);
+    }
+    else {
+        m_playerController->requestPositionUpdates(this, PlaybackColumnInterval);
+    }
+}
+
+void PlaylistModel::registerMemorySources()
+{
+    // Items are counted at their fixed size; the text they hold isn't included
+    m_memorySources.push_back(MemoryUsage::addSource(QStringLiteral("Playlist items"), [this]() {
+        return MemoryUsage::Usage{.bytes   = m_nodes.size() * sizeof(ItemKeyMap::value_type),
+                                  .entries = m_nodes.size()};
+    }));
+
+    m_memorySources.push_back(MemoryUsage::addSource(
+        QStringLiteral("Script caches"),
+        [this]() {
+            const auto entries = static_cast<size_t>(m_columnCache.size());
+            return MemoryUsage::Usage{.bytes   = entries * m_columns.size() * sizeof(RichScript),
+                                      .entries = entries};
+        },
+        [this]() {
+            clearColumnCache();
+            m_columnParser.clearCache();
+        },
+        MemoryUsage::TrimPriority::First));
+
+    m_memorySources.push_back(MemoryUsage::addSource(
+        QStringLiteral("Playlist population cache"),
+        [this]() {
+            return MemoryUsage::Usage{.bytes   = m_populationCache.cost() * sizeof(ItemKeyMap::value_type),
+                                      .entries = m_populationCache.count()};
+        },
+        [this]() { m_populationCache.clear(); }, MemoryUsage::TrimPriority::First));
+}
+
+QByteArray PlaylistModel::populationKey(Playlist* playlist) const
+{
+    QByteArray key;
+    QDataStream stream{&key, QIODevice::WriteOnly};
+
+    stream << playlist->id() << static_cast<quint64>(playlist->revision()) << m_currentPreset << m_lazyColumns;
+    for(const PlaylistColumn& column : m_columns) {
+        stream << column.field << column.isPixmap;
+    }
+
+    const auto& header = m_currentPreset.header;
+    const auto& track  = m_currentPreset.track;
+
+    std::vector<const RichScript*> scripts{&header.title, &header.subtitle, &header.sideText,
+                                           &header.info,  &track.leftText,  &track.rightText};
+    for(const SubheaderRow& subheader : m_currentPreset.subHeaders) {
+        scripts.push_back(&subheader.leftText);
+        scripts.push_back(&subheader.rightText);
+    }
+    for(const RichScript& column : track.columns) {
+        scripts.push_back(&column);
+    }
+
+    const bool readsContext
+        = m_columnDependencies.context || std::ranges::any_of(scripts, [this](const RichScript* script) {
+              return !script->script.isEmpty() && m_columnParser.parse(script->script).dependencies.context;
+          });
+
+    // Queue positions are evaluated into the rows, so a population only applies to the queue it was made with
+    if(readsContext) {
+        const PlaylistIndexes queue = m_playerController->playbackQueue().indexesForPlaylist(playlist->id());
+        for(const auto& [index, positions] : queue) {
+            stream << index << static_cast<int>(positions.size());
+            for(const int position : positions) {
+                stream << position;
+            }
+        }
+    }
+
+    return key;
+}
+
+void PlaylistModel::invalidatePopulation()
+{
+    m_populationKey.clear();
+    m_loadedKey.clear();
+}
+
+void PlaylistModel::stashPopulation()
+{
+    if(m_loadedKey.isEmpty()) {
+        return;
+    }
+
+    auto population = std::make_shared<CachedPopulation>();
+
+    std::stack<PlaylistItem*> parents;
+    parents.push(rootItem());
+
+    while(!parents.empty()) {
+        PlaylistItem* parent = parents.top();
+        parents.pop();
+
+        const auto children = parent->children();
+        if(children.empty()) {
+            continue;
+        }
+
+        auto& rows = population->nodes[parent->key()];
+        rows.reserve(children.size());
+        for(PlaylistItem* child : children) {
+            rows.push_back(child->key());
+            parents.push(child);
+        }
+    }
+
+    // Rows not yet fetched follow those already added under the same parent
+    for(auto& [parentKey, rows] : m_pendingNodes) {
+        std::ranges::move(rows, std::back_inserter(population->nodes[parentKey]));
+    }
+
+    for(auto& [_, item] : m_nodes) {
+        item.clearChildren();
+    }
+
+    const size_t rowCount    = m_nodes.size();
+    population->items        = std::move(m_nodes);
+    population->trackParents = std::move(m_trackParents);
+
+    m_nodes.clear();
+    m_pendingNodes.clear();
+    m_trackParents.clear();
+
+    m_populationCache.insert(std::exchange(m_loadedKey, {}), std::move(population), rowCount);
+}
+
+bool PlaylistModel::restorePopulation(const QByteArray& key)
+{
+    const auto* cached = m_populationCache.find(key);
+    if(!cached) {
+        return false;
+    }
+
+    // Taken rather than copied, as it's cached again once switched away from
+    const std::shared_ptr<CachedPopulation> population = *cached;
+    m_populationCache.remove(key);
+
+    // Nothing still being populated applies any more
+    m_populator.startJob([]() { });
+
+    beginResetModel();
+    stashPopulation();
+    resetRoot();
+
+    m_nodes        = std::move(population->items);
+    m_pendingNodes = std::move(population->nodes);
+    m_trackParents = std::move(population->trackParents);
+
+    PlaylistItem* root = rootItem();
+    if(auto rows = m_pendingNodes.find(root->key()); rows != m_pendingNodes.end()) {
+        const auto count = std::min(static_cast<size_t>(TopLevelFetchSize), rows->second.size());
+        for(const QString& row : rows->second | std::views::take(count)) {
+            fetchChildren(root, &m_nodes.at(row));
+        }
+        rows->second.erase(rows->second.begin(), rows->second.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+
+    updateTrackIndexes();
+    endResetModel();
+
+    m_resetting = false;
+    m_loadedKey = key;
+
+    fetchInBackground();
+
+    // Reported once the caller has returned, as it would be after populating
+    QMetaObject::invokeMethod(
+        this,
+        [this, key]() {
+            if(!m_resetting && !m_playlistLoaded && m_populationKey == key) {
+                m_playlistLoaded = true;
+                emit dataChanged({}, {});
+                emit playlistLoaded();
+            }
+        },
+        Qt::QueuedConnection);
+
+    return true;
+}
+
+void PlaylistModel::clearColumnCache()
+{
+    m_columnCache.clear();
+}
+
+RichScript PlaylistModel::columnText(const PlaylistItem* item, const PlaylistTrackItem& track, int column,
+                                     bool isPlaying) const
+{
+    if(isPlaying && std::ranges::find(m_playbackColumns, column) != m_playbackColumns.cend()) {
+        // Changes with every tick, so there's nothing worth caching
+        m_columnRegistry->setTrackProperties(item->index(), track.depth(), true);
+        const QString evalScript = m_columnParser.evaluate(m_columnScripts.at(column), track.track());
+        return {m_columns.at(column).field, m_columnFormatter.evaluate(evalScript)};
+    }
+
+    if(!track.columnsPending()) {
+        return track.column(column);
+    }
+
+    if(column < 0 || std::cmp_greater_equal(column, m_columnScripts.size())) {
+        return {};
+    }
+
+    if(const auto* columns = m_columnCache.object(item->key())) {
+        return columns->at(column);
+    }
+
+    m_columnRegistry->setTrackProperties(item->index(), track.depth());
+
+    auto* columns = new std::vector<RichScript>();
+    columns->reserve(m_columnScripts.size());
+
+    for(size_t i{0}; i < m_columnScripts.size(); ++i) {
+        const QString evalScript = m_columnParser.evaluate(m_columnScripts.at(i), track.track());
+        columns->emplace_back(m_columns.at(i).field, m_columnFormatter.evaluate(evalScript));
+    }
+
+    RichScript text = columns->at(column);
+    m_columnCache.insert(item->key(), columns);
+
+    return text;
+}
+
 QVariant PlaylistModel::trackData(PlaylistItem* item, const QModelIndex& index, int role) const
 {
     const int column = index.column();
@@ -1362,7 +1837,7 @@ QVariant PlaylistModel::trackData(PlaylistItem* item, const QModelIndex& index,
     switch(role) {
         case(Qt::ToolTipRole): {
             if(!singleColumnMode) {
-                return track.column(column).text.joinedText();
+                return columnText(item, track, column, isPlaying).text.joinedText();
             }
             break;
         }
@@ -1398,7 +1873,7 @@ QVariant PlaylistModel::trackData(PlaylistItem* item, const QModelIndex& index,
                 break;
             }
 
-            return QVariant::fromValue(track.column(column).text);
+            return QVariant::fromValue(columnText(item, track, column, isPlaying).text);
         }
         case(PlaylistItem::Role::ImagePadding):
             return m_pixmapPadding;
@@ -1565,7 +2040,7 @@ bool PlaylistModel::prepareDrop(const QMimeData* data, Qt::DropAction action, in
         return true;
     }
 
-    const TrackList tracks = restoreTracks(m_library, data->data(QString::fromLatin1(Constants::Mime::TrackIds)));
+    const TrackList tracks = TrackMimeData::tracksFromMimeData(data, m_library);
     if(tracks.empty()) {
         return false;
     }
@@ -1834,11 +2309,7 @@ void PlaylistModel::handleTrackGroup(PendingData& data)
 void PlaylistModel::storeMimeData(const QModelIndexList& indexes, QMimeData* mimeData) const
 {
     if(mimeData) {
-        QModelIndexList sortedIndexes{indexes};
-        std::ranges::sort(sortedIndexes, cmpTrackIndices);
-        mimeData->setData(QString::fromLatin1(Constants::Mime::PlaylistItems),
-                          saveIndexes(sortedIndexes, m_currentPlaylist));
-        mimeData->setData(QString::fromLatin1(Constants::Mime::TrackIds), saveTracks(sortedIndexes));
+        mimeData->setData(QString::fromLatin1(Constants::Mime::PlaylistItems), saveIndexes(indexes, m_currentPlaylist));
     }
 }
 
@@ -1914,7 +2385,7 @@ int PlaylistModel::dropCopyRowsRecursive(const QModelIndex& source, const Playli
     auto* sourceParent = itemForIndex(source);
     for(Fooyin::PlaylistItem* childItem : rows) {
         childItem->resetRow();
-        const QString newKey = Fooyin::Utils::generateRandomHash();
+        const QString newKey = Fooyin::Utils::generateUniqueKey();
         auto* newChild       = &m_nodes.emplace(newKey, *childItem).first->second;
         newChild->clearChildren();
         newChild->setKey(newKey);
@@ -1946,10 +2417,9 @@ bool PlaylistModel::insertPlaylistRows(const QModelIndex& target, int firstRow,
     auto* parent = itemForIndex(target);
 
     beginInsertRows(target, firstRow, lastRow);
+    parent->insertChildren(firstRow, children);
     for(PlaylistItem* child : children) {
-        parent->insertChild(firstRow, child);
         child->setPending(false);
-        firstRow += 1;
     }
     endInsertRows();
 
@@ -1983,14 +2453,12 @@ bool PlaylistModel::removePlaylistRows(int row, int count, const QModelIndex& pa
         return false;
     }
 
-    int lastRow = row + count - 1;
+    const int lastRow = row + count - 1;
     beginRemoveRows(parent, row, lastRow);
-    while(lastRow >= row) {
-        deleteNodes(itemForIndex(index(lastRow, 0, parent)));
-        parentItem->removeChild(lastRow);
-        --lastRow;
+    for(int i{lastRow}; i >= row; --i) {
+        deleteNodes(parentItem->child(i));
     }
-    parentItem->resetChildren();
+    parentItem->removeChildren(row, count);
     endRemoveRows();
 
     return true;
@@ -2013,6 +2481,15 @@ void PlaylistModel::fetchChildren(PlaylistItem* parent, PlaylistItem* child)
     parent->appendChild(child);
 }
 
+void PlaylistModel::fetchInBackground()
+{
+    // Views fetch the rows they show, the rest are added in the background
+    ModelUpdateScheduler::instance().schedule(this, [this]() {
+        fetchMore({});
+        return canFetchMore({});
+    });
+}
+
 void PlaylistModel::cleanupHeaders()
 {
     removeEmptyHeaders();
@@ -2127,16 +2604,25 @@ void PlaylistModel::updateHeaders()
         updatedHeaders.emplace_back(updatedHeader);
     }
 
-    QMetaObject::invokeMethod(&m_populator, [this, updatedHeaders]() { m_populator.updateHeaders(updatedHeaders); });
+    m_populator.schedule([this, updatedHeaders]() { m_populator.updateHeaders(updatedHeaders); });
 }
 
-void PlaylistModel::updateTrackIndexes()
+void PlaylistModel::updateTrackIndexes(int firstRow)
 {
     std::stack<PlaylistItem*> trackNodes;
-    trackNodes.push(rootItem());
     int index{0};
 
-    m_trackIndexes.clear();
+    if(firstRow <= 0) {
+        trackNodes.push(rootItem());
+        m_trackIndexes.clear();
+    }
+    else {
+        const auto children = rootItem()->children();
+        for(PlaylistItem* child : children | std::views::drop(firstRow) | std::views::reverse) {
+            trackNodes.push(child);
+        }
+        index = m_trackIndexes.empty() ? 0 : m_trackIndexes.crbegin()->first + 1;
+    }
 
     while(!trackNodes.empty()) {
         PlaylistItem* node = trackNodes.top();
@@ -2222,6 +2708,46 @@ bool PlaylistModel::trackIsPlaying(const Track& track, int index) const
         && m_currentPlayingTrack.indexInPlaylist == index;
 }
 
+QModelIndex PlaylistModel::playingRow(const PlaylistTrack& track)
+{
+    if(!m_currentPlaylist || track.playlistId != m_currentPlaylist->id()) {
+        return {};
+    }
+
+    // Rows which haven't been fetched yet aren't shown, so there's nothing to repaint
+    const auto [index, end] = trackIndexAtPlaylistIndex(track.indexInPlaylist);
+    return end ? QModelIndex{} : index;
+}
+
+void PlaylistModel::playingRowChanged(const PlaylistTrack& track)
+{
+    const QModelIndex row = playingRow(track);
+    if(!row.isValid()) {
+        return;
+    }
+
+    const int lastColumn = columnCount(row.parent()) - 1;
+    emit dataChanged(row.siblingAtColumn(0), row.siblingAtColumn(lastColumn),
+                     {Qt::DecorationRole, Qt::BackgroundRole, PlaylistItem::Role::Column});
+}
+
+void PlaylistModel::updatePlaybackColumns()
+{
+    if(m_playbackColumns.empty() || m_currentPlayState == PlayState::Stopped) {
+        return;
+    }
+
+    const QModelIndex row = playingRow(m_currentPlayingTrack);
+    if(!row.isValid()) {
+        return;
+    }
+
+    for(const int column : m_playbackColumns) {
+        const QModelIndex cell = row.siblingAtColumn(column);
+        emit dataChanged(cell, cell, {PlaylistItem::Role::Column});
+    }
+}
+
 PlaylistModel::MoveOperationMap PlaylistModel::determineMoveOperationGroups(const MoveOperation& operation, bool merge)
 {
     MoveOperationMap result;
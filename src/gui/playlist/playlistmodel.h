@@ -25,19 +25,28 @@
 #include "playlistpreset.h"
 
 #include <core/player/playerdefs.h>
+#include <core/scripting/scriptparser.h>
+#include <gui/scripting/scriptformatter.h>
+#include <utils/lrucache.h>
 #include <utils/treemodel.h>
 
+#include <QByteArray>
+#include <QCache>
 #include <QPixmap>
-#include <QThread>
+
+#include <memory>
+#include <optional>
 
 namespace Fooyin {
 class SettingsManager;
 class MusicLibrary;
 class PlayerController;
 class Playlist;
+class PlaylistScriptRegistry;
 struct PlaylistPreset;
 struct PlaylistTrack;
 class CoverProvider;
+class PlaylistProfiler;
 
 struct TrackIndexResult
 {
@@ -94,6 +103,9 @@ public:
     bool dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column,
                       const QModelIndex& parent) override;
 
+    // Counts calls to data() and times populator batches while the profiler is enabled
+    void setProfiler(PlaylistProfiler* profiler);
+
     [[nodiscard]] bool playlistIsLoaded() const;
     [[nodiscard]] bool haveTracks() const;
 
@@ -105,10 +117,20 @@ public:
     void reset(const PlaylistPreset& preset, const PlaylistColumnList& columns, Playlist* playlist);
 
     PlaylistTrack playingTrack() const;
+    /*!
+     * Returns the text shown in @p column for each of @p tracks, the tracks of the current playlist, for use as
+     * sort keys without evaluating the column again. Returns nothing unless every track's text is already held
+     * and doesn't depend on the row's position or playback state.
+     */
+    [[nodiscard]] std::optional<std::vector<QString>> columnSortKeys(int column, const TrackList& tracks) const;
     TrackIndexResult trackIndexAtPlaylistIndex(int index, bool fetch = false);
     QModelIndex indexAtPlaylistIndex(int index);
 
     void insertTracks(const TrackGroups& tracks);
+    /*!
+     * Re-evaluates the tracks at playlist @p indexes after their metadata changed.
+     * Tracks which stay under the same headers are updated in place; only the rest are removed and reinserted.
+     */
     void updateTracks(const std::vector<int>& indexes);
     void refreshTracks(const std::vector<int>& indexes);
     void removeTracks(const QModelIndexList& indexes);
@@ -138,6 +160,8 @@ private:
     void populateTrackGroup(PendingData& data);
     void updateModel(ItemKeyMap& data);
     void updateTracks(const ItemList& tracks);
+    void applyTrackDiff(const TrackDiff& diff);
+    void regroupTracks(const std::vector<int>& indexes);
     void mergeTrackParents(const TrackIdNodeMap& parents);
 
     QVariant trackData(PlaylistItem* item, const QModelIndex& index, int role) const;
@@ -183,18 +207,53 @@ private:
     bool removePlaylistRows(int row, int count, const QModelIndex& parent);
 
     void fetchChildren(PlaylistItem* parentItem, PlaylistItem* child);
+    // Adds the pending top level rows a chunk at a time, see ModelUpdateScheduler
+    void fetchInBackground();
 
     void cleanupHeaders();
     void removeEmptyHeaders();
     void mergeHeaders();
     void updateHeaders();
-    void updateTrackIndexes();
+    // Numbers tracks from the top level row @p firstRow on, following on from the rows before it
+    void updateTrackIndexes(int firstRow = 0);
     void deleteNodes(PlaylistItem* parent);
 
     std::vector<int> pixmapColumns() const;
     void coverUpdated(const Track& track);
 
     [[nodiscard]] bool trackIsPlaying(const Track& track, int index) const;
+    [[nodiscard]] QModelIndex playingRow(const PlaylistTrack& track);
+    void playingRowChanged(const PlaylistTrack& track);
+    void updatePlaybackColumns();
+
+    void registerMemorySources();
+
+    // The unlinked rows of a population, kept for switching back to what it was populated from
+    struct CachedPopulation
+    {
+        ItemKeyMap items;
+        NodeKeyMap nodes;
+        TrackIdNodeMap trackParents;
+    };
+    struct PopulationKeyHash
+    {
+        size_t operator()(const QByteArray& key) const
+        {
+            return qHash(key);
+        }
+    };
+
+    [[nodiscard]] QByteArray populationKey(Playlist* playlist) const;
+    // Forgets which population the rows came from, once they're changed in place
+    void invalidatePopulation();
+    // Moves the rows into the population cache if they're complete; reset must have begun
+    void stashPopulation();
+    bool restorePopulation(const QByteArray& key);
+
+    void updateColumnScripts();
+    void clearColumnCache();
+    [[nodiscard]] RichScript columnText(const PlaylistItem* item, const PlaylistTrackItem& track, int column,
+                                        bool isPlaying) const;
 
     using MoveOperationItemGroups = std::vector<PlaylistItemList>;
 
@@ -231,7 +290,6 @@ private:
 
     bool m_altColours;
     QSize m_coverSize;
-    QThread m_populatorThread;
     PlaylistPopulator m_populator;
 
     bool m_playlistLoaded;
@@ -253,5 +311,27 @@ private:
     QPersistentModelIndex m_currentPlayingIndex;
     int m_tempCurrentPlayingIndex;
     QModelIndexList m_indexesPendingRemoval;
+
+    // Evaluates the columns of rows populated without them (see PlaylistPopulator::setLazyColumns) when shown
+    PlayerController* m_playerController;
+    PlaylistProfiler* m_profiler{nullptr};
+    bool m_lazyColumns;
+    std::unique_ptr<PlaylistScriptRegistry> m_columnRegistry;
+    mutable ScriptParser m_columnParser;
+    mutable ScriptFormatter m_columnFormatter;
+    std::vector<ParsedScript> m_columnScripts;
+    ScriptDependencies m_columnDependencies;
+    // Columns showing playback state (e.g. %playback_time%), which are only repainted for the playing row
+    std::vector<int> m_playbackColumns;
+    uint64_t m_playbackSecond{0};
+    // Keyed by item key
+    mutable QCache<QString, std::vector<RichScript>> m_columnCache;
+
+    LruCache<QByteArray, std::shared_ptr<CachedPopulation>, PopulationKeyHash> m_populationCache;
+    // What the population being built, and the one shown once complete, were populated from
+    QByteArray m_populationKey;
+    QByteArray m_loadedKey;
+
+    std::vector<int> m_memorySources;
 };
 } // namespace Fooyin
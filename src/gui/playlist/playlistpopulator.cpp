@@ -1,6 +1,6 @@
 /*
  * Fooyin
- * Copyright © 2023, Luke Taylor <LukeT1@proton.me>
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
  *
  * Fooyin is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,41 +20,221 @@
 #include "playlistpopulator.h"
 
 #include "playlistpreset.h"
+#include "playlistprofiler.h"
 #include "playlistscriptregistry.h"
 
 #include <core/player/playercontroller.h>
+#include <core/scripting/scriptparser.h>
+#include <utils/crossthreadstats.h>
 #include <utils/crypto.h>
+#include <utils/metrics.h>
+#include <utils/tracing.h>
 
-#include <QCryptographicHash>
-#include <QTimer>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <ranges>
 
 constexpr int TrackPreloadSize = 2000;
+// Tracks evaluated together by one thread
+constexpr size_t EvaluateChunkSize = 1000;
 
 namespace Fooyin {
+namespace {
+/*!
+ * The scripts of a preset parsed for a registry of their own.
+ * Parsers hold state while evaluating, so each thread populating a playlist uses its own context.
+ */
+struct PopulatorContext
+{
+    const PlaylistPreset& preset;
+    const PlaylistColumnList& columns;
+
+    PlaylistScriptRegistry registry;
+    ScriptParser parser;
+    ScriptFormatter formatter;
+
+    std::vector<ParsedScript> headerScripts;
+    std::vector<std::pair<ParsedScript, ParsedScript>> subheaderScripts;
+    std::vector<ParsedScript> columnScripts;
+    ParsedScript leftScript;
+    ParsedScript rightScript;
+    bool lazyColumns{false};
+
+    PopulatorContext(const PlaylistPreset& preset_, const PlaylistColumnList& columns_)
+        : preset{preset_}
+        , columns{columns_}
+        , parser{&registry}
+    { }
+
+    PopulatorContext(const PopulatorContext&)            = delete;
+    PopulatorContext& operator=(const PopulatorContext&) = delete;
+
+    void setup(const Id& playlistId, const PlaybackQueue& queue, bool lazy)
+    {
+        lazyColumns = lazy;
+        registry.setup(playlistId, queue);
+        parser.clearCache();
+
+        headerScripts = {parser.parse(preset.header.title.script), parser.parse(preset.header.subtitle.script),
+                         parser.parse(preset.header.sideText.script), parser.parse(preset.header.info.script)};
+
+        subheaderScripts.clear();
+        for(const auto& subheader : preset.subHeaders) {
+            subheaderScripts.emplace_back(parser.parse(subheader.leftText.script),
+                                          parser.parse(subheader.rightText.script));
+        }
+
+        columnScripts.clear();
+        for(const auto& column : columns) {
+            columnScripts.push_back(parser.parse(column.field));
+        }
+        leftScript  = parser.parse(preset.track.leftText.script);
+        rightScript = parser.parse(preset.track.rightText.script);
+    }
+
+    QString evaluateText(RichScript& script, const ParsedScript& parsedScript, const Track& track)
+    {
+        script.text.clear();
+        const auto evalScript = parser.evaluate(parsedScript, track);
+        if(!evalScript.isEmpty()) {
+            script.text = formatter.evaluate(evalScript);
+        }
+        return evalScript;
+    }
+
+    std::vector<RichScript> evaluateColumns(const Track& track)
+    {
+        std::vector<RichScript> trackColumns;
+        trackColumns.reserve(columns.size());
+
+        for(size_t i{0}; i < columns.size(); ++i) {
+            const auto evalScript = parser.evaluate(columnScripts.at(i), track);
+            trackColumns.emplace_back(columns.at(i).field, formatter.evaluate(evalScript));
+        }
+
+        return trackColumns;
+    }
+};
+
+// The scripts of a track, evaluated before it's placed in the playlist
+struct EvaluatedTrack
+{
+    HeaderRow header;
+    QString headerKey;
+    std::vector<PlaylistContainerItem> subheaders;
+    std::vector<QString> subheaderKeys;
+    PlaylistTrackItem item;
+};
+
+QString subheaderKey(const PlaylistContainerItem& subheader)
+{
+    QString key;
+    for(const auto& block : subheader.title().text) {
+        key += block.text;
+    }
+    for(const auto& block : subheader.subtitle().text) {
+        key += block.text;
+    }
+    return key;
+}
+
+void evaluateTrack(PopulatorContext& context, const Track& track, int index, EvaluatedTrack& evaluated)
+{
+    const PlaylistPreset& preset = context.preset;
+
+    // A track's depth only depends on which of its own headers and subheaders are shown
+    int depth{0};
+
+    context.registry.setTrackProperties(index, depth);
+
+    if(preset.header.isValid()) {
+        evaluated.header = preset.header;
+
+        const auto title    = context.evaluateText(evaluated.header.title, context.headerScripts.at(0), track);
+        const auto subtitle = context.evaluateText(evaluated.header.subtitle, context.headerScripts.at(1), track);
+        const auto sideText = context.evaluateText(evaluated.header.sideText, context.headerScripts.at(2), track);
+        const auto info     = context.evaluateText(evaluated.header.info, context.headerScripts.at(3), track);
+
+        evaluated.headerKey = Utils::generateKey(title, subtitle, sideText, info);
+        ++depth;
+    }
+
+    for(qsizetype i{0}; i < preset.subHeaders.size(); ++i) {
+        SubheaderRow subheader{preset.subHeaders.at(i)};
+        const auto& [leftScript, rightScript] = context.subheaderScripts.at(static_cast<size_t>(i));
+
+        subheader.leftText.text  = context.formatter.evaluate(context.parser.evaluate(leftScript, track));
+        subheader.rightText.text = context.formatter.evaluate(context.parser.evaluate(rightScript, track));
+
+        PlaylistContainerItem container{false};
+        container.setTitle(subheader.leftText);
+        container.setSubtitle(subheader.rightText);
+        container.setRowHeight(subheader.rowHeight);
+        container.calculateSize();
+
+        QString key = subheaderKey(container);
+        if(!key.isEmpty()) {
+            ++depth;
+        }
+        evaluated.subheaders.push_back(std::move(container));
+        evaluated.subheaderKeys.push_back(std::move(key));
+    }
+
+    if(!preset.track.isValid()) {
+        return;
+    }
+
+    context.registry.setTrackProperties(index, depth);
+
+    TrackRow trackRow{preset.track};
+
+    if(!context.columns.empty() && context.lazyColumns) {
+        for(const auto& column : context.columns) {
+            trackRow.columns.emplace_back(column.field, RichText{});
+        }
+        evaluated.item = {trackRow.columns, track};
+        evaluated.item.setColumnsPending(true);
+    }
+    else if(!context.columns.empty()) {
+        trackRow.columns = context.evaluateColumns(track);
+        evaluated.item   = {trackRow.columns, track};
+    }
+    else {
+        context.evaluateText(trackRow.leftText, context.leftScript, track);
+        context.evaluateText(trackRow.rightText, context.rightScript, track);
+        evaluated.item = {trackRow.leftText, trackRow.rightText, track};
+    }
+
+    evaluated.item.setRowHeight(trackRow.rowHeight);
+    evaluated.item.setDepth(depth);
+    evaluated.item.calculateSize();
+}
+} // namespace
+
 struct PlaylistPopulator::Private
 {
     PlaylistPopulator* self;
     PlayerController* playerController;
 
+    Id playlistId;
+    PlaybackQueue queue;
     PlaylistPreset currentPreset;
     PlaylistColumnList columns;
 
-    std::unique_ptr<PlaylistScriptRegistry> registry;
-    ScriptParser parser;
-
-    ScriptFormatter formatter;
+    PopulatorContext context;
+    std::atomic<bool> lazyColumns{false};
+    PlaylistProfiler* profiler{nullptr};
 
-    int trackDepth{0};
     QString prevBaseHeaderKey;
     QString prevHeaderKey;
     int prevIndex{0};
     std::vector<QString> prevBaseSubheaderKey;
     std::vector<QString> prevSubheaderKey;
 
-    std::vector<PlaylistContainerItem> subheaders;
-
     PlaylistItem root;
     PendingData data;
     ContainerKeyMap headers;
@@ -63,21 +243,28 @@ struct PlaylistPopulator::Private
     explicit Private(PlaylistPopulator* self_, PlayerController* playerController_)
         : self{self_}
         , playerController{playerController_}
-        , registry{std::make_unique<PlaylistScriptRegistry>()}
-        , parser{registry.get()}
+        , context{currentPreset, columns}
     { }
 
     void reset()
     {
         data.clear();
         headers.clear();
-        trackDepth = 0;
         prevBaseSubheaderKey.clear();
         prevSubheaderKey.clear();
         prevBaseHeaderKey.clear();
         prevHeaderKey.clear();
     }
 
+    void setup(const Id& id, const PlaylistPreset& preset, const PlaylistColumnList& playlistColumns)
+    {
+        playlistId    = id;
+        queue         = playerController->playbackQueue();
+        currentPreset = preset;
+        columns       = playlistColumns;
+        context.setup(playlistId, queue, lazyColumns);
+    }
+
     PlaylistItem* getOrInsertItem(const QString& key, PlaylistItem::ItemType type, const Data& item,
                                   PlaylistItem* parent, const QString& baseKey)
     {
@@ -101,40 +288,64 @@ struct PlaylistPopulator::Private
     void updateContainers()
     {
         for(const auto& [key, container] : headers) {
-            container->updateGroupText(&parser, &formatter);
+            container->updateGroupText(&context.parser, &context.registry, &context.formatter);
         }
     }
 
-    void iterateHeader(const Track& track, PlaylistItem*& parent, int index)
+    /*!
+     * Evaluates the scripts of each of @p tracks, the first of which is at @p startIndex in the playlist.
+     * Large sets of tracks are split into contiguous chunks evaluated on the global thread pool.
+     */
+    std::vector<EvaluatedTrack> evaluateTracks(const TrackList& tracks, int startIndex)
     {
-        HeaderRow row{currentPreset.header};
-        if(!row.isValid()) {
-            return;
-        }
-
-        auto evaluateBlocks = [this, track](RichScript& script) -> QString {
-            script.text.clear();
-            const auto evalScript = parser.evaluate(script.script, track);
-            if(!evalScript.isEmpty()) {
-                script.text = formatter.evaluate(evalScript);
+        std::vector<EvaluatedTrack> evaluated(tracks.size());
+
+        const auto evaluateRange = [this, &tracks, &evaluated, startIndex](PopulatorContext& rangeContext,
+                                                                           size_t first, size_t last) {
+            // Headers, subheaders and columns often share subexpressions for the same track
+            rangeContext.parser.setTrackCacheEnabled(true);
+            for(size_t i{first}; i < last && self->mayRun(); ++i) {
+                evaluateTrack(rangeContext, tracks.at(i), startIndex + static_cast<int>(i), evaluated.at(i));
             }
-            return evalScript;
+            rangeContext.parser.setTrackCacheEnabled(false);
         };
 
-        auto generateHeaderKey = [&row, &evaluateBlocks]() {
-            return Utils::generateHash(evaluateBlocks(row.title), evaluateBlocks(row.subtitle),
-                                       evaluateBlocks(row.sideText), evaluateBlocks(row.info));
-        };
+        if(tracks.size() <= EvaluateChunkSize) {
+            evaluateRange(context, 0, tracks.size());
+            return evaluated;
+        }
 
-        const QString baseKey = generateHeaderKey();
-        QString key           = Utils::generateRandomHash();
-        if(!prevHeaderKey.isEmpty() && prevBaseHeaderKey == baseKey && index == prevIndex + 1) {
-            key = prevHeaderKey;
+        std::vector<std::pair<size_t, size_t>> chunks;
+        for(size_t start{0}; start < tracks.size(); start += EvaluateChunkSize) {
+            chunks.emplace_back(start, std::min(tracks.size(), start + EvaluateChunkSize));
         }
-        prevBaseHeaderKey = baseKey;
-        prevHeaderKey     = key;
+
+        QtConcurrent::blockingMap(QThreadPool::globalInstance(), chunks,
+                                  [this, &evaluateRange](const std::pair<size_t, size_t>& chunk) {
+                                      PopulatorContext chunkContext{currentPreset, columns};
+                                      chunkContext.setup(playlistId, queue, lazyColumns);
+                                      evaluateRange(chunkContext, chunk.first, chunk.second);
+                                  });
+
+        return evaluated;
+    }
+
+    void placeHeader(const Track& track, EvaluatedTrack& evaluated, PlaylistItem*& parent, int index)
+    {
+        if(!currentPreset.header.isValid()) {
+            return;
+        }
+
+        const QString& baseKey = evaluated.headerKey;
+        // Consecutive tracks with the same header share it
+        const bool sameHeader = !prevHeaderKey.isEmpty() && prevBaseHeaderKey == baseKey && index == prevIndex + 1;
+        const QString key     = sameHeader ? prevHeaderKey : Utils::generateUniqueKey();
+        prevBaseHeaderKey     = baseKey;
+        prevHeaderKey         = key;
 
         if(!headers.contains(key)) {
+            const HeaderRow& row = evaluated.header;
+
             PlaylistContainerItem header{currentPreset.header.simple};
             header.setTitle(row.title);
             header.setSubtitle(row.subtitle);
@@ -151,44 +362,17 @@ struct PlaylistPopulator::Private
         header->addTrack(track);
         data.trackParents[track.id()].push_back(key);
 
-        auto* headerItem = &data.items.at(key);
-        parent           = headerItem;
-        ++trackDepth;
+        parent = &data.items.at(key);
     }
 
-    void iterateSubheaders(const Track& track, PlaylistItem*& parent, int index)
+    void placeSubheaders(const Track& track, EvaluatedTrack& evaluated, PlaylistItem*& parent, int index)
     {
-        for(auto& subheader : currentPreset.subHeaders) {
-            const auto leftScript    = parser.evaluate(subheader.leftText.script, track);
-            subheader.leftText.text  = formatter.evaluate(leftScript);
-            const auto rightScript   = parser.evaluate(subheader.rightText.script, track);
-            subheader.rightText.text = formatter.evaluate(rightScript);
-
-            PlaylistContainerItem currentContainer{false};
-            currentContainer.setTitle(subheader.leftText);
-            currentContainer.setSubtitle(subheader.rightText);
-            currentContainer.setRowHeight(subheader.rowHeight);
-            currentContainer.calculateSize();
-            subheaders.push_back(currentContainer);
-        }
-
-        const int subheaderCount = static_cast<int>(subheaders.size());
+        const int subheaderCount = static_cast<int>(evaluated.subheaders.size());
         prevSubheaderKey.resize(subheaderCount);
         prevBaseSubheaderKey.resize(subheaderCount);
 
-        auto generateSubheaderKey = [](const PlaylistContainerItem& subheader) {
-            QString subheaderKey;
-            for(const auto& block : subheader.title().text) {
-                subheaderKey += block.text;
-            }
-            for(const auto& block : subheader.subtitle().text) {
-                subheaderKey += block.text;
-            }
-            return subheaderKey;
-        };
-
-        for(int i{0}; const auto& subheader : subheaders) {
-            const QString subheaderKey = generateSubheaderKey(subheader);
+        for(int i{0}; i < subheaderCount; ++i) {
+            const QString& subheaderKey = evaluated.subheaderKeys.at(i);
 
             if(subheaderKey.isEmpty()) {
                 prevBaseSubheaderKey[i].clear();
@@ -196,17 +380,15 @@ struct PlaylistPopulator::Private
                 continue;
             }
 
-            const QString baseKey = Utils::generateHash(parent->baseKey(), subheaderKey);
-            QString key           = Utils::generateRandomHash();
-            if(static_cast<int>(prevSubheaderKey.size()) > i && prevBaseSubheaderKey.at(i) == baseKey
-               && index == prevIndex + 1) {
-                key = prevSubheaderKey.at(i);
-            }
-            prevBaseSubheaderKey[i] = baseKey;
-            prevSubheaderKey[i]     = key;
+            const QString baseKey    = Utils::generateKey(parent->baseKey(), subheaderKey);
+            const bool sameSubheader = prevBaseSubheaderKey.at(i) == baseKey && index == prevIndex + 1;
+            const QString key        = sameSubheader ? prevSubheaderKey.at(i) : Utils::generateUniqueKey();
+            prevBaseSubheaderKey[i]  = baseKey;
+            prevSubheaderKey[i]      = key;
 
             if(!headers.contains(key)) {
-                auto* subheaderItem      = getOrInsertItem(key, PlaylistItem::Subheader, subheader, parent, baseKey);
+                auto* subheaderItem = getOrInsertItem(key, PlaylistItem::Subheader, evaluated.subheaders.at(i),
+                                                      parent, baseKey);
                 auto& subheaderContainer = std::get<1>(subheaderItem->data());
                 headers.emplace(key, &subheaderContainer);
             }
@@ -214,66 +396,29 @@ struct PlaylistPopulator::Private
             subheaderContainer->addTrack(track);
             data.trackParents[track.id()].push_back(key);
 
-            auto* subheaderItem = &data.items.at(key);
-            parent              = subheaderItem;
-            ++i;
-            ++trackDepth;
-        }
-
-        subheaders.clear();
-    }
-
-    void evaluateTrackScript(RichScript& script, const Track& track)
-    {
-        script.text.clear();
-        const auto evalScript = parser.evaluate(script.script, track);
-        if(!evalScript.isEmpty()) {
-            script.text = formatter.evaluate(evalScript);
+            parent = &data.items.at(key);
         }
     }
 
-    PlaylistItem* iterateTrack(const Track& track, int index)
+    // Places @p track under its headers, which are shared with the previous track where they match
+    PlaylistItem* placeTrack(const Track& track, EvaluatedTrack& evaluated, int index)
     {
         PlaylistItem* parent = &root;
 
-        iterateHeader(track, parent, index);
-        iterateSubheaders(track, parent, index);
+        placeHeader(track, evaluated, parent, index);
+        placeSubheaders(track, evaluated, parent, index);
 
         if(!currentPreset.track.isValid()) {
             return nullptr;
         }
 
-        registry->setTrackProperties(index, trackDepth);
-
-        TrackRow trackRow{currentPreset.track};
-        PlaylistTrackItem playlistTrack;
+        const QString baseKey = Utils::generateKey(parent->key(), track.hash(), index);
+        const QString key     = Utils::generateUniqueKey();
 
-        if(!columns.empty()) {
-            for(const auto& column : columns) {
-                const auto evalScript = parser.evaluate(column.field, track);
-                trackRow.columns.emplace_back(column.field, formatter.evaluate(evalScript));
-            }
-            playlistTrack = {trackRow.columns, track};
-        }
-        else {
-            evaluateTrackScript(trackRow.leftText, track);
-            evaluateTrackScript(trackRow.rightText, track);
-
-            playlistTrack = {trackRow.leftText, trackRow.rightText, track};
-        }
-
-        playlistTrack.setRowHeight(trackRow.rowHeight);
-        playlistTrack.setDepth(trackDepth);
-        playlistTrack.calculateSize();
-
-        const QString baseKey = Utils::generateHash(parent->key(), track.hash(), QString::number(index));
-        const QString key     = Utils::generateRandomHash();
-
-        auto* trackItem = getOrInsertItem(key, PlaylistItem::Track, playlistTrack, parent, baseKey);
+        auto* trackItem = getOrInsertItem(key, PlaylistItem::Track, evaluated.item, parent, baseKey);
         data.trackParents[track.id()].push_back(key);
 
-        trackDepth = 0;
-        prevIndex  = index;
+        prevIndex = index;
         return trackItem;
     }
 
@@ -283,13 +428,18 @@ struct PlaylistPopulator::Private
             return;
         }
 
-        auto tracksBatch = std::ranges::views::take(pendingTracks, size);
+        const auto start = std::chrono::steady_clock::now();
+
+        TrackList tracksBatch;
+        std::ranges::copy(std::ranges::views::take(pendingTracks, size), std::back_inserter(tracksBatch));
 
-        for(const Track& track : tracksBatch) {
+        std::vector<EvaluatedTrack> evaluated = evaluateTracks(tracksBatch, index);
+
+        for(size_t i{0}; i < tracksBatch.size(); ++i) {
             if(!self->mayRun()) {
                 return;
             }
-            iterateTrack(track, index++);
+            placeTrack(tracksBatch.at(i), evaluated.at(i), index++);
         }
 
         updateContainers();
@@ -298,7 +448,15 @@ struct PlaylistPopulator::Private
             return;
         }
 
-        emit self->populated(data);
+        recordBatch(start);
+        data.generation = self->jobGeneration();
+        if(tracksBatch.size() < pendingTracks.size()) {
+            // Containers are shared with the next batch, so only the last batch can give them up
+            emit self->populated(std::make_shared<PendingData>(data));
+        }
+        else {
+            emit self->populated(std::make_shared<PendingData>(std::move(data)));
+        }
 
         auto tracksToKeep = std::ranges::views::drop(pendingTracks, size);
         TrackList tempTracks;
@@ -313,16 +471,20 @@ struct PlaylistPopulator::Private
 
     void runTracksGroup(const std::map<int, TrackList>& tracks)
     {
+        const auto start = std::chrono::steady_clock::now();
+
         for(const auto& [index, trackGroup] : tracks) {
             std::vector<QString> trackKeys;
 
+            std::vector<EvaluatedTrack> evaluated = evaluateTracks(trackGroup, index);
+
             int trackIndex{index};
 
-            for(const Track& track : trackGroup) {
+            for(size_t i{0}; i < trackGroup.size(); ++i) {
                 if(!self->mayRun()) {
                     return;
                 }
-                if(const auto* trackItem = iterateTrack(track, trackIndex++)) {
+                if(const auto* trackItem = placeTrack(trackGroup.at(i), evaluated.at(i), trackIndex++)) {
                     trackKeys.push_back(trackItem->key());
                 }
             }
@@ -335,7 +497,44 @@ struct PlaylistPopulator::Private
             return;
         }
 
-        emit self->populatedTrackGroup(data);
+        recordBatch(start);
+        data.generation = self->jobGeneration();
+        emit self->populatedTrackGroup(std::make_shared<PendingData>(std::move(data)));
+    }
+
+    // Whether @p evaluated would be placed under the same headers as @p parents
+    [[nodiscard]] bool hasSameParents(const EvaluatedTrack& evaluated, const ItemList& parents) const
+    {
+        std::vector<QString> baseKeys;
+        QString parentKey;
+
+        if(currentPreset.header.isValid()) {
+            parentKey = evaluated.headerKey;
+            baseKeys.push_back(parentKey);
+        }
+
+        for(const QString& subheaderKey : evaluated.subheaderKeys) {
+            if(!subheaderKey.isEmpty()) {
+                parentKey = Utils::generateKey(parentKey, subheaderKey);
+                baseKeys.push_back(parentKey);
+            }
+        }
+
+        return std::ranges::equal(baseKeys, parents, [](const QString& key, const PlaylistItem& parent) {
+            return key == parent.baseKey();
+        });
+    }
+
+    void recordBatch(std::chrono::steady_clock::time_point start) const
+    {
+        static auto& batchTime
+            = Metrics::histogram("fooyin_playlist_populate_seconds", "Time taken to build a batch of playlist items");
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        batchTime.record(elapsed);
+        if(profiler) {
+            profiler->recordPopulatorBatch(elapsed);
+        }
     }
 };
 
@@ -343,25 +542,27 @@ PlaylistPopulator::PlaylistPopulator(PlayerController* playerController, QObject
     : Worker{parent}
     , p{std::make_unique<Private>(this, playerController)}
 {
-    qRegisterMetaType<PendingData>();
+    qRegisterMetaType<PendingDataPtr>();
+    qRegisterMetaType<TrackDiff>();
 }
 
 void PlaylistPopulator::run(const Id& playlistId, const PlaylistPreset& preset, const PlaylistColumnList& columns,
                             const TrackList& tracks)
 {
+    FY_TRACE_SCOPE("PlaylistPopulator::run");
     setState(Running);
 
     p->reset();
+    p->setup(playlistId, preset, columns);
 
     p->data.playlistId = playlistId;
-    p->currentPreset   = preset;
-    p->columns         = columns;
     p->pendingTracks   = tracks;
-    p->registry->setup(playlistId, p->playerController->playbackQueue());
 
     p->runBatch(TrackPreloadSize, 0);
 
-    emit finished();
+    if(isCurrent(jobGeneration())) {
+        emit finished();
+    }
 
     setState(Idle);
 }
@@ -369,14 +570,13 @@ void PlaylistPopulator::run(const Id& playlistId, const PlaylistPreset& preset,
 void PlaylistPopulator::runTracks(const Id& playlistId, const PlaylistPreset& preset, const PlaylistColumnList& columns,
                                   const std::map<int, TrackList>& tracks)
 {
+    FY_TRACE_SCOPE("PlaylistPopulator::runTracks");
     setState(Running);
 
     p->reset();
+    p->setup(playlistId, preset, columns);
 
     p->data.playlistId = playlistId;
-    p->currentPreset   = preset;
-    p->columns         = columns;
-    p->registry->setup(playlistId, p->playerController->playbackQueue());
 
     p->runTracksGroup(tracks);
 
@@ -388,30 +588,26 @@ void PlaylistPopulator::updateTracks(const Id& playlistId, const PlaylistPreset&
 {
     setState(Running);
 
-    p->currentPreset = preset;
-    p->registry->setup(playlistId, p->playerController->playbackQueue());
+    p->setup(playlistId, preset, columns);
+
+    PopulatorContext& context = p->context;
 
     ItemList updatedTracks;
 
     for(const auto& [track, item] : tracks) {
         PlaylistTrackItem& trackData = std::get<0>(item.data());
 
-        p->registry->setTrackProperties(item.index(), trackData.depth());
+        context.registry.setTrackProperties(item.index(), trackData.depth());
 
         if(!columns.empty()) {
-            std::vector<RichScript> trackColumns;
-            for(const auto& column : columns) {
-                const auto evalScript = p->parser.evaluate(column.field, track);
-                trackColumns.emplace_back(column.field, p->formatter.evaluate(evalScript));
-            }
-            trackData.setColumns(trackColumns);
+            trackData.setColumns(context.evaluateColumns(track));
         }
         else {
             RichScript trackLeft{preset.track.leftText};
             RichScript trackRight{preset.track.rightText};
 
-            p->evaluateTrackScript(trackLeft, track);
-            p->evaluateTrackScript(trackRight, track);
+            context.evaluateText(trackLeft, context.leftScript, track);
+            context.evaluateText(trackRight, context.rightScript, track);
 
             trackData.setLeftRight(trackLeft, trackRight);
         }
@@ -419,6 +615,7 @@ void PlaylistPopulator::updateTracks(const Id& playlistId, const PlaylistPreset&
         updatedTracks.push_back(item);
     }
 
+    CrossThreadStats::recordCopy("PlaylistPopulator::tracksUpdated", updatedTracks);
     emit tracksUpdated(updatedTracks);
 
     setState(Idle);
@@ -432,15 +629,69 @@ void PlaylistPopulator::updateHeaders(const ItemList& headers)
 
     for(const PlaylistItem& item : headers) {
         PlaylistContainerItem& header = std::get<1>(item.data());
-        header.updateGroupText(&p->parser, &p->formatter);
+        header.updateGroupText(&p->context.parser, &p->context.registry, &p->context.formatter);
         updatedHeaders.emplace(item.key(), item);
     }
 
+    CrossThreadStats::recordCopy("PlaylistPopulator::headersUpdated", updatedHeaders);
     emit headersUpdated(updatedHeaders);
 
     setState(Idle);
 }
 
+void PlaylistPopulator::diffTracks(const Id& playlistId, const PlaylistPreset& preset,
+                                   const PlaylistColumnList& columns, const TrackChangeList& changes)
+{
+    setState(Running);
+
+    p->setup(playlistId, preset, columns);
+
+    TrackDiff diff;
+    diff.playlistId = playlistId;
+    diff.generation = jobGeneration();
+
+    for(const auto& change : changes) {
+        if(!mayRun()) {
+            setState(Idle);
+            return;
+        }
+
+        EvaluatedTrack evaluated;
+        evaluateTrack(p->context, change.track, change.index, evaluated);
+
+        if(!p->hasSameParents(evaluated, change.parents)) {
+            diff.regroup.push_back(change.index);
+            continue;
+        }
+
+        PlaylistItem& item = diff.tracks.emplace_back(change.item);
+        item.setData(evaluated.item);
+
+        for(const PlaylistItem& parent : change.parents) {
+            auto headerIt = diff.headers.try_emplace(parent.key(), parent).first;
+            std::get<1>(headerIt->second.data()).replaceTrack(change.track);
+        }
+    }
+
+    for(auto& [key, header] : diff.headers) {
+        std::get<1>(header.data()).updateGroupText(&p->context.parser, &p->context.registry, &p->context.formatter);
+    }
+
+    emit tracksDiffed(diff);
+
+    setState(Idle);
+}
+
+void PlaylistPopulator::setLazyColumns(bool enabled)
+{
+    p->lazyColumns = enabled;
+}
+
+void PlaylistPopulator::setProfiler(PlaylistProfiler* profiler)
+{
+    p->profiler = profiler;
+}
+
 PlaylistPopulator::~PlaylistPopulator() = default;
 } // namespace Fooyin
 
@@ -29,6 +29,7 @@
 
 namespace Fooyin {
 class PlayerController;
+class PlaylistProfiler;
 struct PlaylistPreset;
 
 using ItemList        = std::vector<PlaylistItem>;
@@ -42,6 +43,8 @@ using IndexGroupMap   = std::map<int, std::vector<QString>>;
 struct PendingData
 {
     Id playlistId;
+    // The populator job these belong to
+    uint64_t generation{0};
     ItemKeyMap items;
     NodeKeyMap nodes;
     std::vector<QString> containerOrder;
@@ -63,6 +66,31 @@ struct PendingData
         indexNodes.clear();
     }
 };
+// Batches are handed to a single receiver, which may move from them
+using PendingDataPtr = std::shared_ptr<PendingData>;
+
+// A track which changed, along with where it currently sits in the model
+struct TrackChange
+{
+    int index{-1};
+    Track track;
+    PlaylistItem item;
+    // The headers and subheaders the track is under, outermost first
+    ItemList parents;
+};
+using TrackChangeList = std::vector<TrackChange>;
+
+struct TrackDiff
+{
+    Id playlistId;
+    uint64_t generation{0};
+    // Tracks which stay under the same headers, with their text re-evaluated
+    ItemList tracks;
+    // Headers containing one of those tracks, with their text re-evaluated
+    ItemKeyMap headers;
+    // Playlist indexes of tracks which now belong under different headers
+    std::vector<int> regroup;
+};
 
 class PlaylistPopulator : public Worker
 {
@@ -79,12 +107,28 @@ public:
     void updateTracks(const Id& playlistId, const PlaylistPreset& preset, const PlaylistColumnList& columns,
                       const TrackItemMap& tracks);
     void updateHeaders(const ItemList& headers);
+    /*!
+     * Finds which of @p changes only need their text refreshed and which need regrouping.
+     * Emits tracksDiffed once done.
+     */
+    void diffTracks(const Id& playlistId, const PlaylistPreset& preset, const PlaylistColumnList& columns,
+                    const TrackChangeList& changes);
+
+    /*!
+     * While enabled, columns aren't evaluated when populating, leaving them to be evaluated when first shown.
+     * Headers and subheaders are still evaluated for every track, as grouping depends on them.
+     * Can be called from any thread.
+     */
+    void setLazyColumns(bool enabled);
+    // Must be set before the populator is first run
+    void setProfiler(PlaylistProfiler* profiler);
 
 signals:
-    void populated(PendingData data);
-    void populatedTrackGroup(PendingData data);
+    void populated(const PendingDataPtr& data);
+    void populatedTrackGroup(const PendingDataPtr& data);
     void tracksUpdated(ItemList tracks);
     void headersUpdated(ItemKeyMap headers);
+    void tracksDiffed(TrackDiff diff);
 
 private:
     struct Private;
@@ -0,0 +1,104 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "playlistprofiler.h"
+
+#include <QMetaMethod>
+
+namespace {
+uint64_t toMicroseconds(std::chrono::nanoseconds time)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+}
+} // namespace
+
+namespace Fooyin {
+PlaylistProfiler::PlaylistProfiler(QObject* parent)
+    : QObject{parent}
+{ }
+
+void PlaylistProfiler::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void PlaylistProfiler::recordPaint(std::chrono::nanoseconds time)
+{
+    if(!isEnabled()) {
+        return;
+    }
+
+    const uint64_t calls = m_dataCalls.exchange(0, std::memory_order_relaxed);
+
+    const std::scoped_lock lock{m_mutex};
+    m_profile.paintTime.add(toMicroseconds(time));
+    m_profile.dataCalls.add(calls);
+}
+
+void PlaylistProfiler::recordLayout(std::chrono::nanoseconds time)
+{
+    if(!isEnabled()) {
+        return;
+    }
+
+    const std::scoped_lock lock{m_mutex};
+    m_profile.layoutTime.add(toMicroseconds(time));
+}
+
+void PlaylistProfiler::recordPopulatorBatch(std::chrono::nanoseconds time)
+{
+    if(!isEnabled()) {
+        return;
+    }
+
+    const std::scoped_lock lock{m_mutex};
+    m_profile.populatorBatchTime.add(toMicroseconds(time));
+}
+
+PlaylistProfile PlaylistProfiler::profile() const
+{
+    const std::scoped_lock lock{m_mutex};
+    return m_profile;
+}
+
+void PlaylistProfiler::reset()
+{
+    m_dataCalls.store(0, std::memory_order_relaxed);
+
+    const std::scoped_lock lock{m_mutex};
+    m_profile = {};
+}
+
+void PlaylistProfiler::requestStressTest()
+{
+    emit stressTestRequested();
+}
+
+bool PlaylistProfiler::hasStressTestRunner() const
+{
+    return isSignalConnected(QMetaMethod::fromSignal(&PlaylistProfiler::stressTestRequested));
+}
+
+void PlaylistProfiler::finishStressTest(std::chrono::milliseconds elapsed)
+{
+    emit stressTestFinished(elapsed);
+}
+} // namespace Fooyin
+
+#include "moc_playlistprofiler.cpp"
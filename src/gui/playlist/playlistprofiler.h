@@ -0,0 +1,93 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <utils/histogram.h>
+
+#include <QObject>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace Fooyin {
+struct PlaylistProfile
+{
+    // All times are in microseconds
+    Histogram paintTime;
+    Histogram layoutTime;
+    // Calls to PlaylistModel::data between the end of one paint and the end of the next
+    Histogram dataCalls;
+    Histogram populatorBatchTime;
+};
+
+/*!
+ * Collects timings from the playlist view, model and populator while enabled.
+ * Recording can be done from any thread.
+ */
+class PlaylistProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PlaylistProfiler(QObject* parent = nullptr);
+
+    [[nodiscard]] bool isEnabled() const
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+    void setEnabled(bool enabled);
+
+    void countDataCall()
+    {
+        if(isEnabled()) {
+            m_dataCalls.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Also ends the current frame for the data call count
+    void recordPaint(std::chrono::nanoseconds time);
+    void recordLayout(std::chrono::nanoseconds time);
+    void recordPopulatorBatch(std::chrono::nanoseconds time);
+
+    [[nodiscard]] PlaylistProfile profile() const;
+    void reset();
+
+    /*!
+     * Asks the playlist widget to run a scripted scroll, jump and selection pass once the
+     * current playlist has loaded.
+     */
+    void requestStressTest();
+    // Returns true if a playlist widget is connected to run stress tests
+    [[nodiscard]] bool hasStressTestRunner() const;
+    void finishStressTest(std::chrono::milliseconds elapsed);
+
+signals:
+    void stressTestRequested();
+    void stressTestFinished(std::chrono::milliseconds elapsed);
+
+private:
+    std::atomic<bool> m_enabled{false};
+    std::atomic<uint64_t> m_dataCalls{0};
+
+    mutable std::mutex m_mutex;
+    PlaylistProfile m_profile;
+};
+} // namespace Fooyin
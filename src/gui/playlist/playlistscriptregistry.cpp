@@ -27,9 +27,11 @@ struct PlaylistScriptRegistry::Private
     Id playlistId;
     int trackIndex{0};
     int trackDepth{0};
+    bool trackPlaying{false};
 
     using QueueVar = std::function<QString()>;
-    std::unordered_map<QString, QueueVar> vars;
+    std::vector<QueueVar> vars;
+    std::unordered_map<QString, int> varIndexes;
 
     Private()
     {
@@ -38,13 +40,19 @@ struct PlaylistScriptRegistry::Private
 
     void addVars()
     {
-        vars.emplace(QStringLiteral("depth"), [this]() { return depth(); });
-        vars.emplace(QStringLiteral("queueindex"), [this]() { return queueIndex(); });
-        vars.emplace(QStringLiteral("queueindexes"), [this]() { return queueIndexes(); });
-        vars.emplace(QStringLiteral("playingicon"), [this]() { return playingQueue(); });
-        vars.emplace(QStringLiteral("frontcover"), []() { return frontCover(); });
-        vars.emplace(QStringLiteral("backcover"), []() { return backCover(); });
-        vars.emplace(QStringLiteral("artistpicture"), []() { return artistPicture(); });
+        addVar(QStringLiteral("depth"), [this]() { return depth(); });
+        addVar(QStringLiteral("queueindex"), [this]() { return queueIndex(); });
+        addVar(QStringLiteral("queueindexes"), [this]() { return queueIndexes(); });
+        addVar(QStringLiteral("playingicon"), [this]() { return playingQueue(); });
+        addVar(QStringLiteral("frontcover"), []() { return frontCover(); });
+        addVar(QStringLiteral("backcover"), []() { return backCover(); });
+        addVar(QStringLiteral("artistpicture"), []() { return artistPicture(); });
+    }
+
+    void addVar(const QString& name, QueueVar var)
+    {
+        varIndexes.emplace(name, static_cast<int>(vars.size()));
+        vars.push_back(std::move(var));
     }
 
     QString depth() const
@@ -101,8 +109,9 @@ struct PlaylistScriptRegistry::Private
     }
 };
 
-PlaylistScriptRegistry::PlaylistScriptRegistry()
-    : p{std::make_unique<Private>()}
+PlaylistScriptRegistry::PlaylistScriptRegistry(PlayerController* playerController)
+    : ScriptRegistry{playerController}
+    , p{std::make_unique<Private>()}
 { }
 
 PlaylistScriptRegistry::~PlaylistScriptRegistry() = default;
@@ -115,34 +124,50 @@ void PlaylistScriptRegistry::setup(const Id& playlistId, const PlaybackQueue& qu
     }
 }
 
-void PlaylistScriptRegistry::setTrackProperties(int index, int depth)
+void PlaylistScriptRegistry::setTrackProperties(int index, int depth, bool playing)
 {
-    p->trackIndex = index;
-    p->trackDepth = depth;
+    p->trackIndex   = index;
+    p->trackDepth   = depth;
+    p->trackPlaying = playing;
 }
 
 bool PlaylistScriptRegistry::isVariable(const QString& var, const Track& track) const
 {
-    if(isListVariable(var) || p->vars.contains(var)) {
+    if(isListVariable(var) || p->varIndexes.contains(var)) {
         return true;
     }
 
     return ScriptRegistry::isVariable(var, track);
 }
 
-ScriptResult PlaylistScriptRegistry::value(const QString& var, const Track& track) const
+ScriptRegistry::Binding PlaylistScriptRegistry::bindVariable(const QString& var) const
 {
-    if(isListVariable(var)) {
+    Binding binding = ScriptRegistry::bindVariable(var);
+
+    if(const auto it = p->varIndexes.find(var); it != p->varIndexes.cend()) {
+        binding.custom = it->second;
+    }
+
+    return binding;
+}
+
+ScriptResult PlaylistScriptRegistry::value(const Binding& var, const Track& track) const
+{
+    if(var.list >= 0) {
         return {.value = QStringLiteral("|Loading|"), .cond = true};
     }
 
-    if(p->vars.contains(var)) {
+    if(var.custom >= 0) {
         ScriptResult result;
-        result.value = p->vars.at(var)();
+        result.value = p->vars.at(var.custom)();
         result.cond  = !result.value.isEmpty();
         return result;
     }
 
+    if(var.playback >= 0 && !p->trackPlaying) {
+        return {};
+    }
+
     return ScriptRegistry::value(var, track);
 }
 } // namespace Fooyin
@@ -32,17 +32,22 @@ constexpr auto ArtistPicture = "%artistpicture%";
 class PlaylistScriptRegistry : public ScriptRegistry
 {
 public:
-    PlaylistScriptRegistry();
+    explicit PlaylistScriptRegistry(PlayerController* playerController = nullptr);
     ~PlaylistScriptRegistry() override;
 
     using ScriptRegistry::isVariable;
     using ScriptRegistry::value;
 
     void setup(const Id& playlistId, const PlaybackQueue& queue);
-    void setTrackProperties(int index, int depth);
+    /*!
+     * Sets the row evaluated next. Playback variables (e.g. %playback_time%) are only given a value
+     * when @p playing is set, so every other row evaluates them as empty.
+     */
+    void setTrackProperties(int index, int depth, bool playing = false);
 
     [[nodiscard]] bool isVariable(const QString& var, const Track& track) const override;
-    [[nodiscard]] ScriptResult value(const QString& var, const Track& track) const override;
+    [[nodiscard]] Binding bindVariable(const QString& var) const override;
+    [[nodiscard]] ScriptResult value(const Binding& var, const Track& track) const override;
 
 private:
     struct Private;
@@ -0,0 +1,206 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "playliststatswidget.h"
+
+#include "playlistcontroller.h"
+#include "playlistinteractor.h"
+#include "playlistprofiler.h"
+#include "playliststresstest.h"
+
+#include <core/playlist/playlisthandler.h>
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTimerEvent>
+
+constexpr auto UpdateInterval      = 250;
+constexpr auto DefaultStressTracks = 1000000;
+constexpr auto MaxStressTracks     = 5000000;
+
+namespace {
+QString formatTimes(const Fooyin::Histogram& histogram)
+{
+    if(histogram.count() == 0) {
+        return QStringLiteral("-");
+    }
+
+    auto ms = [](double us) {
+        return QString::number(us / 1000.0, 'f', 2);
+    };
+
+    return QStringLiteral("%1 ms mean, p50 %2, p95 %3, p99 %4, max %5 (%6 samples)")
+        .arg(ms(histogram.mean()), ms(static_cast<double>(histogram.percentile(50))),
+             ms(static_cast<double>(histogram.percentile(95))), ms(static_cast<double>(histogram.percentile(99))),
+             ms(static_cast<double>(histogram.max())))
+        .arg(histogram.count());
+}
+
+QString formatCounts(const Fooyin::Histogram& histogram)
+{
+    if(histogram.count() == 0) {
+        return QStringLiteral("-");
+    }
+
+    return QStringLiteral("%1 mean, p95 %2, max %3")
+        .arg(histogram.mean(), 0, 'f', 0)
+        .arg(histogram.percentile(95))
+        .arg(histogram.max());
+}
+} // namespace
+
+namespace Fooyin {
+PlaylistStatsWidget::PlaylistStatsWidget(PlaylistInteractor* playlistInteractor, PlaylistProfiler* profiler,
+                                         QWidget* parent)
+    : FyWidget{parent}
+    , m_playlistInteractor{playlistInteractor}
+    , m_profiler{profiler}
+    , m_paintTime{new QLabel(this)}
+    , m_layoutTime{new QLabel(this)}
+    , m_dataCalls{new QLabel(this)}
+    , m_populatorTime{new QLabel(this)}
+    , m_stressResult{new QLabel(this)}
+    , m_stressTracks{new QSpinBox(this)}
+    , m_stressButton{new QPushButton(tr("Run Stress Test"), this)}
+    , m_resetButton{new QPushButton(tr("Reset"), this)}
+{
+    setObjectName(PlaylistStatsWidget::name());
+
+    m_stressTracks->setRange(1, MaxStressTracks);
+    m_stressTracks->setValue(DefaultStressTracks);
+    m_stressTracks->setGroupSeparatorShown(true);
+    m_stressTracks->setSuffix(QStringLiteral(" ") + tr("tracks"));
+
+    auto* buttons = new QHBoxLayout();
+    buttons->addWidget(m_stressTracks);
+    buttons->addWidget(m_stressButton);
+    buttons->addWidget(m_resetButton);
+    buttons->addStretch();
+
+    auto* layout = new QFormLayout(this);
+    layout->addRow(tr("Paint time") + QStringLiteral(":"), m_paintTime);
+    layout->addRow(tr("Layout time") + QStringLiteral(":"), m_layoutTime);
+    layout->addRow(tr("Data calls per frame") + QStringLiteral(":"), m_dataCalls);
+    layout->addRow(tr("Populator batch time") + QStringLiteral(":"), m_populatorTime);
+    layout->addRow(tr("Stress test") + QStringLiteral(":"), m_stressResult);
+    layout->addRow(buttons);
+
+    QObject::connect(m_stressButton, &QPushButton::clicked, this, &PlaylistStatsWidget::startStressTest);
+    QObject::connect(m_resetButton, &QPushButton::clicked, this, [this]() {
+        m_profiler->reset();
+        updateStats();
+    });
+    QObject::connect(m_profiler, &PlaylistProfiler::stressTestFinished, this,
+                     &PlaylistStatsWidget::stressTestFinished);
+
+    updateStats();
+}
+
+QString PlaylistStatsWidget::name() const
+{
+    return tr("Playlist Statistics");
+}
+
+QString PlaylistStatsWidget::layoutName() const
+{
+    return QStringLiteral("PlaylistStatistics");
+}
+
+void PlaylistStatsWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+    m_profiler->setEnabled(true);
+    m_updateTimer.start(UpdateInterval, this);
+}
+
+void PlaylistStatsWidget::hideEvent(QHideEvent* event)
+{
+    m_updateTimer.stop();
+    m_profiler->setEnabled(false);
+    FyWidget::hideEvent(event);
+}
+
+void PlaylistStatsWidget::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == m_updateTimer.timerId()) {
+        updateStats();
+    }
+    FyWidget::timerEvent(event);
+}
+
+void PlaylistStatsWidget::updateStats()
+{
+    const PlaylistProfile profile = m_profiler->profile();
+
+    m_paintTime->setText(formatTimes(profile.paintTime));
+    m_layoutTime->setText(formatTimes(profile.layoutTime));
+    m_dataCalls->setText(formatCounts(profile.dataCalls));
+    m_populatorTime->setText(formatTimes(profile.populatorBatchTime));
+}
+
+void PlaylistStatsWidget::startStressTest()
+{
+    static const auto playlistName = QStringLiteral("Stress Test");
+
+    if(!m_profiler->hasStressTestRunner()) {
+        m_stressResult->setText(tr("Add a playlist to the layout first"));
+        return;
+    }
+
+    auto* controller = m_playlistInteractor->controller();
+    auto* handler    = m_playlistInteractor->handler();
+
+    m_stressButton->setEnabled(false);
+    m_stressResult->setText(tr("Generating tracks…"));
+    m_profiler->reset();
+
+    const TrackList tracks = PlaylistStressTest::generateTracks(m_stressTracks->value());
+
+    auto* current = controller->currentPlaylist();
+    if(current && current->isTemporary() && current->name() == playlistName) {
+        handler->replacePlaylistTracks(current->id(), tracks);
+    }
+    else if(auto* playlist = handler->createTempPlaylist(playlistName, tracks)) {
+        controller->changeCurrentPlaylist(playlist);
+    }
+
+    m_stressResult->setText(tr("Running…"));
+    m_profiler->requestStressTest();
+}
+
+void PlaylistStatsWidget::stressTestFinished(std::chrono::milliseconds elapsed)
+{
+    m_stressButton->setEnabled(true);
+    m_stressResult->setText(tr("Finished in %1 ms").arg(elapsed.count()));
+
+    updateStats();
+
+    const PlaylistProfile profile = m_profiler->profile();
+    qInfo().noquote() << "[PlaylistStats] Stress test finished in" << elapsed.count() << "ms";
+    qInfo().noquote() << "[PlaylistStats] Paint:" << formatTimes(profile.paintTime);
+    qInfo().noquote() << "[PlaylistStats] Layout:" << formatTimes(profile.layoutTime);
+    qInfo().noquote() << "[PlaylistStats] Data calls:" << formatCounts(profile.dataCalls);
+    qInfo().noquote() << "[PlaylistStats] Populator:" << formatTimes(profile.populatorBatchTime);
+}
+} // namespace Fooyin
+
+#include "moc_playliststatswidget.cpp"
@@ -0,0 +1,73 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "gui/fywidget.h"
+
+#include <QBasicTimer>
+
+#include <chrono>
+
+class QLabel;
+class QPushButton;
+class QSpinBox;
+
+namespace Fooyin {
+class PlaylistInteractor;
+class PlaylistProfiler;
+
+/*!
+ * Debug overlay showing playlist paint, layout and populator timings, with a synthetic stress test.
+ * Only records while visible.
+ */
+class PlaylistStatsWidget : public FyWidget
+{
+    Q_OBJECT
+
+public:
+    PlaylistStatsWidget(PlaylistInteractor* playlistInteractor, PlaylistProfiler* profiler, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    void updateStats();
+    void startStressTest();
+    void stressTestFinished(std::chrono::milliseconds elapsed);
+
+    PlaylistInteractor* m_playlistInteractor;
+    PlaylistProfiler* m_profiler;
+    QBasicTimer m_updateTimer;
+
+    QLabel* m_paintTime;
+    QLabel* m_layoutTime;
+    QLabel* m_dataCalls;
+    QLabel* m_populatorTime;
+    QLabel* m_stressResult;
+    QSpinBox* m_stressTracks;
+    QPushButton* m_stressButton;
+    QPushButton* m_resetButton;
+};
+} // namespace Fooyin
@@ -0,0 +1,153 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "playliststresstest.h"
+
+#include "playlistmodel.h"
+#include "playlistview.h"
+
+#include <core/track.h>
+
+#include <QScrollBar>
+#include <QTimerEvent>
+
+constexpr auto ScrollSteps = 500;
+constexpr auto DragSteps   = 200;
+constexpr auto JumpSteps   = 200;
+constexpr auto SelectSteps = 100;
+constexpr auto AlbumSize   = 12;
+
+namespace Fooyin {
+PlaylistStressTest::PlaylistStressTest(PlaylistView* view, PlaylistModel* model, int trackCount, QObject* parent)
+    : QObject{parent}
+    , m_view{view}
+    , m_model{model}
+    , m_trackCount{trackCount}
+    , m_generator{1234}
+{ }
+
+void PlaylistStressTest::start()
+{
+    m_phase = Phase::Scroll;
+    m_step  = 0;
+    m_view->verticalScrollBar()->setValue(0);
+
+    m_elapsed.start();
+    m_timer.start(0, this);
+}
+
+TrackList PlaylistStressTest::generateTracks(int count)
+{
+    TrackList tracks;
+    tracks.reserve(static_cast<size_t>(count));
+
+    for(int i{0}; i < count; ++i) {
+        const int album  = i / AlbumSize;
+        const int artist = album / 8;
+
+        Track track{QStringLiteral("/stress/%1/%2/%3.flac").arg(artist).arg(album).arg(i)};
+        track.setArtists({QStringLiteral("Artist %1").arg(artist)});
+        track.setAlbumArtists({QStringLiteral("Artist %1").arg(artist)});
+        track.setAlbum(QStringLiteral("Album %1").arg(album));
+        track.setTitle(QStringLiteral("Title %1").arg(i));
+        track.setTrackNumber((i % AlbumSize) + 1);
+        track.setDate(QString::number(1960 + (album % 60)));
+        track.setGenres({QStringLiteral("Genre %1").arg(artist % 20)});
+        track.setDuration(static_cast<uint64_t>(120000 + ((i * 7919) % 300000)));
+        tracks.push_back(track);
+    }
+
+    return tracks;
+}
+
+void PlaylistStressTest::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == m_timer.timerId()) {
+        step();
+    }
+    QObject::timerEvent(event);
+}
+
+void PlaylistStressTest::step()
+{
+    auto* scrollBar = m_view->verticalScrollBar();
+
+    switch(m_phase) {
+        case(Phase::Scroll):
+            scrollBar->setValue(scrollBar->value() + (scrollBar->singleStep() * 3));
+            if(++m_step >= ScrollSteps) {
+                m_phase = Phase::Drag;
+                m_step  = 0;
+            }
+            break;
+        case(Phase::Drag): {
+            std::uniform_int_distribution<int> dist{0, std::max(0, scrollBar->maximum())};
+            scrollBar->setValue(dist(m_generator));
+            if(++m_step >= DragSteps) {
+                m_phase = Phase::Jump;
+                m_step  = 0;
+            }
+            break;
+        }
+        case(Phase::Jump): {
+            const QModelIndex index = m_model->indexAtPlaylistIndex(randomTrack());
+            if(index.isValid()) {
+                m_view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+                m_view->setCurrentIndex(index);
+            }
+            if(++m_step >= JumpSteps) {
+                m_phase = Phase::Select;
+                m_step  = 0;
+            }
+            break;
+        }
+        case(Phase::Select): {
+            if(m_step % 2 == 0) {
+                m_view->selectAll();
+            }
+            else {
+                const QModelIndex index = m_model->indexAtPlaylistIndex(randomTrack());
+                m_view->selectionModel()->select(index,
+                                                 QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+            }
+            if(++m_step >= SelectSteps) {
+                m_phase = Phase::Finished;
+            }
+            break;
+        }
+        case(Phase::Finished):
+            break;
+    }
+
+    m_view->viewport()->repaint();
+
+    if(m_phase == Phase::Finished) {
+        m_timer.stop();
+        emit finished(std::chrono::milliseconds{m_elapsed.elapsed()});
+    }
+}
+
+int PlaylistStressTest::randomTrack()
+{
+    std::uniform_int_distribution<int> dist{0, std::max(0, m_trackCount - 1)};
+    return dist(m_generator);
+}
+} // namespace Fooyin
+
+#include "moc_playliststresstest.cpp"
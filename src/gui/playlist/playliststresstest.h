@@ -0,0 +1,82 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/trackfwd.h>
+
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <chrono>
+#include <random>
+
+namespace Fooyin {
+class PlaylistModel;
+class PlaylistView;
+
+/*!
+ * Drives a loaded playlist view through a fixed script of scrolling, scrollbar jumps,
+ * jumps to tracks (as when following playback) and selection changes.
+ * Every step repaints the viewport synchronously, so each one shows up as a frame in the PlaylistProfiler.
+ */
+class PlaylistStressTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    PlaylistStressTest(PlaylistView* view, PlaylistModel* model, int trackCount, QObject* parent = nullptr);
+
+    void start();
+
+    /** Returns @p count tracks with generated metadata, grouped into albums of 12 tracks. */
+    static TrackList generateTracks(int count);
+
+signals:
+    void finished(std::chrono::milliseconds elapsed);
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    enum class Phase : uint8_t
+    {
+        Scroll,
+        Drag,
+        Jump,
+        Select,
+        Finished,
+    };
+
+    void step();
+    [[nodiscard]] int randomTrack();
+
+    PlaylistView* m_view;
+    PlaylistModel* m_model;
+    int m_trackCount;
+
+    Phase m_phase{Phase::Scroll};
+    int m_step{0};
+    std::mt19937 m_generator;
+
+    QBasicTimer m_timer;
+    QElapsedTimer m_elapsed;
+};
+} // namespace Fooyin
@@ -21,10 +21,15 @@
 
 #include "playlistitem.h"
 #include "playlistmodel.h"
+#include "playlistprofiler.h"
 
+#include <gui/scripting/richtext.h>
+#include <utils/lrucache.h>
+#include <utils/prefixsumtree.h>
 #include <utils/widgets/autoheaderview.h>
 
 #include <QDrag>
+#include <QFontMetrics>
 #include <QHeaderView>
 #include <QKeyEvent>
 #include <QMenu>
@@ -34,9 +39,32 @@
 #include <QTimer>
 #include <QWindow>
 
+#include <random>
+
 using namespace std::chrono_literals;
 
+// Rows measured, besides the visible ones, when fitting a column to its contents
+constexpr int ColumnSampleRows = 512;
+// Text widths kept between fits, mostly repeated artist, album and genre names
+constexpr size_t TextWidthCacheSize = 8192;
+
 namespace {
+struct TextWidthKey
+{
+    QString text;
+    QFont font;
+
+    bool operator==(const TextWidthKey& other) const = default;
+};
+
+struct TextWidthKeyHash
+{
+    size_t operator()(const TextWidthKey& key) const
+    {
+        return qHashMulti(0, key.text, key.font);
+    }
+};
+
 void selectChildren(QAbstractItemModel* model, const QModelIndex& parentIndex, QItemSelection& selection)
 {
     if(model->hasChildren(parentIndex)) {
@@ -119,10 +147,13 @@ public:
     int viewIndex(const QModelIndex& index) const;
     int indexRowSizeHint(const QModelIndex& index) const;
     int indexSizeHint(const QModelIndex& index, bool span = false) const;
-    int indexWidthHint(const QModelIndex& index, int hint, const QStyleOptionViewItem& option) const;
+    int columnWidthHint(const QModelIndex& index, const QStyleOptionViewItem& option) const;
+    int textWidth(const RichTextBlock& block) const;
     int itemHeight(int item) const;
     int itemPadding(int item) const;
     int coordinateForItem(int item) const;
+    void updateRowOffsets() const;
+    void invalidateRowOffsets() const;
     void insertViewItems(int pos, int count, const PlaylistViewItem& viewItem);
     bool hasVisibleChildren(const QModelIndex& parent) const;
     void recalculatePadding();
@@ -174,6 +205,7 @@ public:
 
     AutoHeaderView* m_header;
     QAbstractItemModel* m_model{nullptr};
+    PlaylistProfiler* m_profiler{nullptr};
 
     mutable bool m_delayedPendingLayout{false};
     bool m_updatingGeometry{false};
@@ -184,6 +216,13 @@ public:
     mutable int m_lastViewedItem{0};
     int m_defaultItemHeight{20};
 
+    // Running total of item height and padding, so offset lookups don't walk every item
+    mutable PrefixSumTree<int> m_rowOffsets;
+    mutable LruCache<TextWidthKey, int, TextWidthKeyHash> m_textWidths{TextWidthCacheSize};
+    mutable bool m_rowOffsetsValid{false};
+    bool m_uniformTrackHeights{false};
+    mutable int m_trackHeight{0};
+
     mutable std::pair<int, int> m_leftAndRight;
     mutable int m_current;
     std::set<int> m_spans;
@@ -255,10 +294,8 @@ void PlaylistView::Private::updateScrollBars() const
 
     auto* verticalBar = m_self->verticalScrollBar();
 
-    int contentsHeight{0};
-    for(int i{0}; i < itemCount; ++i) {
-        contentsHeight += itemHeight(i) + itemPadding(i);
-    }
+    updateRowOffsets();
+    const int contentsHeight = m_rowOffsets.total();
 
     verticalBar->setRange(0, contentsHeight - viewportSize.height());
     verticalBar->setPageStep(viewportSize.height());
@@ -302,23 +339,20 @@ int PlaylistView::Private::itemAtCoordinate(int coordinate, bool includePadding)
         return -1;
     }
 
-    const int contentsCoord = coordinate + m_self->verticalScrollBar()->value();
+    updateRowOffsets();
 
-    int itemCoord{0};
-    for(int index{0}; index < itemCount; ++index) {
-        const int height  = itemHeight(index);
-        const int padding = itemPadding(index);
-        itemCoord += height + padding;
+    const int contentsCoord = coordinate + m_self->verticalScrollBar()->value();
+    const auto index        = static_cast<int>(m_rowOffsets.indexAt(contentsCoord));
+    if(index >= itemCount) {
+        return -1;
+    }
 
-        if(itemCoord > contentsCoord) {
-            if(includePadding && (itemCoord - padding) < contentsCoord) {
-                return -1;
-            }
-            return index >= itemCount ? -1 : index;
-        }
+    const int itemCoord = m_rowOffsets.prefix(static_cast<size_t>(index) + 1);
+    if(includePadding && (itemCoord - itemPadding(index)) < contentsCoord) {
+        return -1;
     }
 
-    return -1;
+    return index;
 }
 
 QModelIndex PlaylistView::Private::modelIndex(int i, int column) const
@@ -566,10 +600,33 @@ int PlaylistView::Private::indexSizeHint(const QModelIndex& index, bool span) co
     return height;
 }
 
-int PlaylistView::Private::indexWidthHint(const QModelIndex& index, int hint, const QStyleOptionViewItem& option) const
+int PlaylistView::Private::columnWidthHint(const QModelIndex& index, const QStyleOptionViewItem& option) const
 {
-    const int xHint = m_self->itemDelegateForIndex(index)->sizeHint(option, index).width();
-    return std::max(hint, xHint);
+    int width = m_self->itemDelegateForIndex(index)->sizeHint(option, index).width();
+
+    // Rows with lazily evaluated columns don't know their size until their text is asked for
+    if(index.data(Qt::SizeHintRole).toSize().width() <= 0) {
+        const QVariant text = index.data(PlaylistItem::Role::Column);
+        if(text.canConvert<RichText>()) {
+            for(const auto& block : text.value<RichText>()) {
+                width += textWidth(block);
+            }
+        }
+    }
+
+    return width;
+}
+
+int PlaylistView::Private::textWidth(const RichTextBlock& block) const
+{
+    const TextWidthKey key{block.text, block.format.font};
+    if(const int* width = m_textWidths.find(key)) {
+        return *width;
+    }
+
+    const int width = QFontMetrics{block.format.font}.boundingRect(block.text).width();
+    m_textWidths.insert(key, width, 1);
+    return width;
 }
 
 int PlaylistView::Private::itemHeight(int item) const
@@ -583,10 +640,25 @@ int PlaylistView::Private::itemHeight(int item) const
         return 0;
     }
 
-    int height = m_viewItems.at(item).height;
+    auto& viewItem = m_viewItems[item];
+    int height     = viewItem.height;
     if(height <= 0) {
-        height                   = indexRowSizeHint(index);
-        m_viewItems[item].height = height;
+        // All track rows share the first one's height, so only headers need a size hint
+        const bool uniform = m_uniformTrackHeights && !viewItem.hasChildren;
+        if(uniform && m_trackHeight > 0) {
+            height = m_trackHeight;
+        }
+        else {
+            height = indexRowSizeHint(index);
+            if(uniform) {
+                m_trackHeight = height;
+            }
+        }
+        viewItem.height = height;
+
+        if(m_rowOffsetsValid && std::cmp_less(item, m_rowOffsets.size())) {
+            m_rowOffsets.set(static_cast<size_t>(item), std::max(height, 0) + viewItem.padding);
+        }
     }
 
     return std::max(height, 0);
@@ -603,19 +675,39 @@ int PlaylistView::Private::itemPadding(int item) const
 
 int PlaylistView::Private::coordinateForItem(int item) const
 {
-    for(int index{0}, y{0}; const auto& viewItem : m_viewItems) {
-        if(index == item) {
-            return y - m_self->verticalScrollBar()->value();
-        }
-        y += itemHeight(index++) + viewItem.padding;
+    if(item < 0 || item >= itemCount()) {
+        return 0;
     }
 
-    return 0;
+    updateRowOffsets();
+    return m_rowOffsets.prefix(static_cast<size_t>(item)) - m_self->verticalScrollBar()->value();
+}
+
+void PlaylistView::Private::updateRowOffsets() const
+{
+    if(m_rowOffsetsValid && m_rowOffsets.size() == m_viewItems.size()) {
+        return;
+    }
+
+    std::vector<int> heights(m_viewItems.size());
+    for(int i{0}; auto& height : heights) {
+        height = itemHeight(i) + itemPadding(i);
+        ++i;
+    }
+
+    m_rowOffsets.assign(heights);
+    m_rowOffsetsValid = true;
+}
+
+void PlaylistView::Private::invalidateRowOffsets() const
+{
+    m_rowOffsetsValid = false;
 }
 
 void PlaylistView::Private::insertViewItems(int pos, int count, const PlaylistViewItem& viewItem)
 {
     m_viewItems.insert(m_viewItems.begin() + pos, count, viewItem);
+    invalidateRowOffsets();
 
     const int itemCount = this->itemCount();
     for(int i{pos + count}; i < itemCount; i++) {
@@ -675,6 +767,8 @@ void PlaylistView::Private::recalculatePadding()
             item.padding            = (max > sectionHeight) ? max - sectionHeight : 0;
         }
     }
+
+    invalidateRowOffsets();
 }
 
 void PlaylistView::Private::layout(int i, bool afterIsUninitialised)
@@ -792,7 +886,12 @@ int PlaylistView::Private::itemBelow(int item) const
 
 void PlaylistView::Private::invalidateHeightCache(int item) const
 {
-    m_viewItems[item].height = 0;
+    auto& viewItem  = m_viewItems[item];
+    viewItem.height = 0;
+
+    if(m_uniformTrackHeights && !viewItem.hasChildren) {
+        m_trackHeight = 0;
+    }
 }
 
 int PlaylistView::Private::pageUp(int i) const
@@ -1583,20 +1682,18 @@ bool PlaylistView::Private::isIndexValid(const QModelIndex& index) const
 
 int PlaylistView::Private::firstVisibleItem(int* offset) const
 {
+    updateRowOffsets();
+
     const int value = m_self->verticalScrollBar()->value();
+    const auto item = static_cast<int>(m_rowOffsets.indexAt(value));
+    if(item >= itemCount()) {
+        return -1;
+    }
 
-    int y{0};
-    for(int i{0}; i < itemCount(); ++i) {
-        const int itemHeight = this->itemHeight(i) + itemPadding(i);
-        y += itemHeight;
-        if(y > value) {
-            if(offset) {
-                *offset = y - value - itemHeight;
-            }
-            return i;
-        }
+    if(offset) {
+        *offset = m_rowOffsets.prefix(static_cast<size_t>(item)) - value;
     }
-    return -1;
+    return item;
 }
 
 int PlaylistView::Private::lastVisibleItem(int firstVisual, int offset) const
@@ -1699,6 +1796,19 @@ void PlaylistView::setSpan(int column, bool span)
     }
 }
 
+void PlaylistView::setProfiler(PlaylistProfiler* profiler)
+{
+    p->m_profiler = profiler;
+}
+
+void PlaylistView::setUniformTrackHeights(bool enabled)
+{
+    if(std::exchange(p->m_uniformTrackHeights, enabled) != enabled) {
+        p->m_trackHeight = 0;
+        p->doDelayedItemsLayout();
+    }
+}
+
 void PlaylistView::playlistAboutToBeReset()
 {
     p->m_playlistLoaded = false;
@@ -1726,87 +1836,50 @@ int PlaylistView::sizeHintForColumn(int column) const
 
     QStyleOptionViewItem option;
     initViewItemOption(&option);
-    const auto viewItems = p->m_viewItems;
-    const int itemCount  = p->itemCount();
-
-    const int maximumProcessRows = p->m_header->resizeContentsPrecision();
-
-    int offset{0};
-    int start = p->firstVisibleItem(&offset);
-    int end   = p->lastVisibleItem(start, offset);
-    if(start < 0 || end < 0 || end == itemCount - 1) {
-        end = itemCount - 1;
-        if(maximumProcessRows < 0) {
-            start = 0;
-        }
-        else if(maximumProcessRows == 0) {
-            start               = std::max(0, end - 1);
-            int remainingHeight = viewport()->height();
-            while(start > 0 && remainingHeight > 0) {
-                remainingHeight -= p->itemHeight(start);
-                --start;
-            }
-        }
-        else {
-            start = std::max(0, end - maximumProcessRows);
-        }
-    }
+    const auto& viewItems = p->m_viewItems;
+    const int itemCount   = p->itemCount();
 
     int width{0};
-    int rowsProcessed{0};
-
-    for(int i = start; i <= end; ++i) {
-        if(viewItems.at(i).hasChildren) {
-            continue;
+    auto measure = [this, &viewItems, &option, &width, column](int item) {
+        const auto& viewItem = viewItems.at(item);
+        if(!viewItem.hasChildren) {
+            const QModelIndex index = viewItem.index.sibling(viewItem.index.row(), column);
+            width                   = std::max(width, p->columnWidthHint(index, option));
         }
-        QModelIndex index = viewItems.at(i).index;
-        index             = index.sibling(index.row(), column);
-        width             = p->indexWidthHint(index, width, option);
-        ++rowsProcessed;
-        if(rowsProcessed == maximumProcessRows) {
-            break;
-        }
-    }
-
-    --end;
+    };
 
-    const int actualBottom = itemCount - 1;
+    int offset{0};
+    const int first = std::max(0, p->firstVisibleItem(&offset));
+    int last        = p->lastVisibleItem(first, offset);
+    if(last < 0) {
+        last = itemCount - 1;
+    }
 
-    if(maximumProcessRows == 0) {
-        rowsProcessed = 0;
+    for(int i{first}; i <= last; ++i) {
+        measure(i);
     }
 
-    while(rowsProcessed != maximumProcessRows && (start > 0 || end < actualBottom)) {
-        int index{-1};
+    // A negative precision asks for every row, zero for only those visible
+    const int precision = p->m_header->resizeContentsPrecision();
+    const int samples   = precision < 0 ? itemCount : std::min(precision, ColumnSampleRows);
 
-        if((rowsProcessed % 2 && start > 0) || end == actualBottom) {
-            while(start > 0) {
-                --start;
-                if(viewItems.at(start).hasChildren) {
-                    continue;
-                }
-                index = start;
-                break;
-            }
-        }
-        else {
-            while(end < actualBottom) {
-                ++end;
-                if(viewItems.at(end).hasChildren) {
-                    continue;
-                }
-                index = end;
-                break;
+    if(samples >= itemCount) {
+        for(int i{0}; i < itemCount; ++i) {
+            if(i < first || i > last) {
+                measure(i);
             }
         }
-        if(index < 0) {
-            continue;
+    }
+    else if(samples > 0) {
+        // One row from each of evenly sized runs, so a long run of similar rows (e.g. one album) can't hide the
+        // rest. Seeded by column, so fitting the same column twice gives the same width.
+        std::minstd_rand random{static_cast<uint32_t>(column) + 1};
+        const double stratum = static_cast<double>(itemCount) / samples;
+        for(int i{0}; i < samples; ++i) {
+            const auto begin = static_cast<int>(i * stratum);
+            const int size   = std::max(1, static_cast<int>((i + 1) * stratum) - begin);
+            measure(std::min(itemCount - 1, begin + static_cast<int>(random() % static_cast<uint32_t>(size))));
         }
-
-        QModelIndex viewIndex = viewItems.at(index).index;
-        viewIndex             = viewIndex.sibling(viewIndex.row(), column);
-        width                 = p->indexWidthHint(viewIndex, width, option);
-        ++rowsProcessed;
     }
 
     return width;
@@ -1950,8 +2023,12 @@ void PlaylistView::doItemsLayout()
         return;
     }
 
+    const auto start = std::chrono::steady_clock::now();
+
     p->m_layingOutItems = true;
     p->m_viewItems.clear();
+    p->invalidateRowOffsets();
+    p->m_trackHeight = 0;
 
     if(p->m_model && p->m_model->hasChildren(rootIndex())) {
         p->layout(-1);
@@ -1963,6 +2040,10 @@ void PlaylistView::doItemsLayout()
     p->m_header->doItemsLayout();
 
     p->m_layingOutItems = false;
+
+    if(p->m_profiler) {
+        p->m_profiler->recordLayout(std::chrono::steady_clock::now() - start);
+    }
 }
 
 void PlaylistView::reset()
@@ -2226,6 +2307,8 @@ void PlaylistView::dropEvent(QDropEvent* event)
 
 void PlaylistView::paintEvent(QPaintEvent* event)
 {
+    const auto start = std::chrono::steady_clock::now();
+
     p->layoutItems();
 
     QPainter painter{viewport()};
@@ -2256,6 +2339,10 @@ void PlaylistView::paintEvent(QPaintEvent* event)
         opt.rect = p->m_dropIndicatorRect;
         style()->drawPrimitive(QStyle::PE_IndicatorItemViewItemDrop, &opt, &painter);
     }
+
+    if(p->m_profiler) {
+        p->m_profiler->recordPaint(std::chrono::steady_clock::now() - start);
+    }
 }
 
 void PlaylistView::timerEvent(QTimerEvent* event)
@@ -2338,12 +2425,14 @@ void PlaylistView::rowsInserted(const QModelIndex& parent, int start, int end)
 void PlaylistView::rowsAboutToBeRemoved(const QModelIndex& parent, int start, int end)
 {
     p->m_viewItems.clear();
+    p->invalidateRowOffsets();
     QAbstractItemView::rowsAboutToBeRemoved(parent, start, end);
 }
 
 void PlaylistView::rowsRemoved(const QModelIndex& /*parent*/, int /*first*/, int /*last*/)
 {
     p->m_viewItems.clear();
+    p->invalidateRowOffsets();
     p->doDelayedItemsLayout();
 
     setState(QAbstractItemView::NoState);
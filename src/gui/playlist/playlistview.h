@@ -23,6 +23,7 @@
 
 namespace Fooyin {
 class AutoHeaderView;
+class PlaylistProfiler;
 
 class PlaylistView : public QAbstractItemView
 {
@@ -38,6 +39,13 @@ public:
 
     [[nodiscard]] bool isSpanning(int column) const;
     void setSpan(int column, bool span);
+    /*!
+     * Assumes every track (childless) row has the same height as the first one laid out,
+     * so only header rows are measured through the delegate.
+     */
+    void setUniformTrackHeights(bool enabled);
+    // Records paint and layout times while the profiler is enabled
+    void setProfiler(PlaylistProfiler* profiler);
 
     void playlistAboutToBeReset();
     void playlistReset();
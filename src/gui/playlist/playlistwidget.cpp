@@ -25,8 +25,11 @@
 #include "playlistcommands.h"
 #include "playlistcontroller.h"
 #include "playlistdelegate.h"
+#include "playlistprofiler.h"
+#include "playliststresstest.h"
 #include "playlistview.h"
 #include "playlistwidget_p.h"
+#include "widgets/viewpreview.h"
 
 #include <core/library/musiclibrary.h>
 #include <core/library/tracksort.h>
@@ -52,6 +55,7 @@
 #include <QMenu>
 #include <QScrollBar>
 
+#include <algorithm>
 #include <stack>
 
 namespace {
@@ -92,7 +96,8 @@ namespace Fooyin {
 using namespace Settings::Gui::Internal;
 
 PlaylistWidgetPrivate::PlaylistWidgetPrivate(PlaylistWidget* self_, ActionManager* actionManager_,
-                                             PlaylistInteractor* playlistInteractor_, SettingsManager* settings_)
+                                             PlaylistInteractor* playlistInteractor_, PlaylistProfiler* profiler_,
+                                             SettingsManager* settings_)
     : self{self_}
     , actionManager{actionManager_}
     , playlistInteractor{playlistInteractor_}
@@ -100,6 +105,7 @@ PlaylistWidgetPrivate::PlaylistWidgetPrivate(PlaylistWidget* self_, ActionManage
     , playerController{playlistController->playerController()}
     , selectionController{playlistController->selectionController()}
     , library{playlistInteractor_->library()}
+    , profiler{profiler_}
     , settings{settings_}
     , settingsDialog{settings->settingsDialog()}
     , columnRegistry{settings}
@@ -129,6 +135,12 @@ PlaylistWidgetPrivate::PlaylistWidgetPrivate(PlaylistWidget* self_, ActionManage
     playlistView->setItemDelegate(new PlaylistDelegate(self));
     playlistView->viewport()->installEventFilter(new ToolTipFilter(self));
 
+    if(profiler) {
+        model->setProfiler(profiler);
+        playlistView->setProfiler(profiler);
+        QObject::connect(profiler, &PlaylistProfiler::stressTestRequested, this, &PlaylistWidgetPrivate::runStressTest);
+    }
+
     layout->addWidget(playlistView);
 
     setHeaderHidden(!settings->value<PlaylistHeader>());
@@ -162,7 +174,7 @@ void PlaylistWidgetPrivate::setupConnections()
     QObject::connect(playlistController, &PlaylistController::currentPlaylistTracksChanged, this,
                      &PlaylistWidgetPrivate::handleTracksChanged);
     QObject::connect(playlistController, &PlaylistController::currentPlaylistTracksPlayed, this,
-                     [this](const std::vector<int>& indexes) { model->refreshTracks(indexes); });
+                     &PlaylistWidgetPrivate::handleTracksPlayed);
     QObject::connect(playlistController, &PlaylistController::currentPlaylistQueueChanged, this,
                      [this](const std::vector<int>& indexes) { model->refreshTracks(indexes); });
     QObject::connect(playlistController, &PlaylistController::currentPlaylistChanged, this,
@@ -380,6 +392,7 @@ void PlaylistWidgetPrivate::restoreState(Playlist* playlist)
 void PlaylistWidgetPrivate::resetModel() const
 {
     if(playlistController->currentPlaylist()) {
+        playlistView->setUniformTrackHeights(currentPreset.track.rowHeight > 0);
         model->reset(currentPreset, singleMode ? PlaylistColumnList{} : columns, playlistController->currentPlaylist());
     }
 }
@@ -703,9 +716,9 @@ void PlaylistWidgetPrivate::handleTracksChanged(const std::vector<int>& indexes,
     };
 
     const auto changedTrackCount = static_cast<int>(indexes.size());
-    // It's faster to just reset if we're going to be updating more than half the playlist
-    // or we're updating a large number of tracks
-    if(changedTrackCount > 500 || changedTrackCount > (playlistController->currentPlaylist()->trackCount() / 2)) {
+    // It's faster to just reset if we're going to be updating more than half the playlist.
+    // Otherwise only tracks which move to a different group are reinserted.
+    if(changedTrackCount > (playlistController->currentPlaylist()->trackCount() / 2)) {
         std::vector<int> selectedIndexes;
 
         if(!allNew) {
@@ -735,6 +748,28 @@ void PlaylistWidgetPrivate::handleTracksChanged(const std::vector<int>& indexes,
     }
 }
 
+void PlaylistWidgetPrivate::handleTracksPlayed(const std::vector<int>& indexes)
+{
+    const auto usesStats = [this](const QString& script) {
+        return dependencyParser.parse(script).dependencies.dependsOnStats();
+    };
+
+    // Rows only need to be evaluated again if they show the stats which changed
+    bool rowsUseStats{false};
+    if(!singleMode && !columns.empty()) {
+        rowsUseStats = std::ranges::any_of(
+            columns, [&usesStats](const PlaylistColumn& column) { return usesStats(column.field); });
+    }
+    else {
+        rowsUseStats
+            = usesStats(currentPreset.track.leftText.script) || usesStats(currentPreset.track.rightText.script);
+    }
+
+    if(rowsUseStats) {
+        model->refreshTracks(indexes);
+    }
+}
+
 void PlaylistWidgetPrivate::handlePlayingTrackChanged(const PlaylistTrack& track) const
 {
     model->playingTrackChanged(track);
@@ -940,8 +975,9 @@ void PlaylistWidgetPrivate::sortTracks(const QString& script) const
     auto* currentPlaylist    = playlistController->currentPlaylist();
     const auto currentTracks = currentPlaylist->tracks();
 
-    auto handleSortedTracks = [this, currentPlaylist](const TrackList& sortedTracks) {
-        playlistController->playlistHandler()->replacePlaylistTracks(currentPlaylist->id(), sortedTracks);
+    auto handleSortOrder = [this, playlistId = currentPlaylist->id(),
+                            revision = currentPlaylist->revision()](const std::vector<int>& order) {
+        applySortOrder(playlistId, revision, order);
     };
 
     if(playlistView->selectionModel()->hasSelection()) {
@@ -958,13 +994,13 @@ void PlaylistWidgetPrivate::sortTracks(const QString& script) const
         std::ranges::sort(indexesToSort);
 
         Utils::asyncExec([currentTracks, script, indexesToSort]() {
-            return Sorting::calcSortTracks(script, currentTracks, indexesToSort);
-        }).then(self, handleSortedTracks);
+            return Sorting::calcSortOrder(script, currentTracks, indexesToSort);
+        }).then(self, handleSortOrder);
     }
     else {
         Utils::asyncExec([currentTracks, script]() {
-            return Sorting::calcSortTracks(script, currentTracks);
-        }).then(self, handleSortedTracks);
+            return Sorting::calcSortOrder(script, currentTracks);
+        }).then(self, handleSortOrder);
     }
 }
 
@@ -981,12 +1017,37 @@ void PlaylistWidgetPrivate::sortColumn(int column, Qt::SortOrder order)
     const auto currentTracks = currentPlaylist->tracks();
     const QString sortField  = columns.at(column).field;
 
-    Utils::asyncExec([sortField, currentTracks, order]() {
-        return Sorting::calcSortTracks(sortField, currentTracks, order);
-    }).then(self, [this, currentPlaylist](const TrackList& sortedTracks) {
-        playlistController->playlistHandler()->replacePlaylistTracks(currentPlaylist->id(), sortedTracks);
+    auto handleSortOrder = [this, playlistId = currentPlaylist->id(),
+                            revision = currentPlaylist->revision()](const std::vector<int>& sortOrder) {
+        applySortOrder(playlistId, revision, sortOrder);
         m_sortingColumn = false;
-    });
+    };
+
+    // The texts already shown in the column make the sort keys, so only rows not yet shown need evaluating
+    if(auto cachedKeys = model->columnSortKeys(column, currentTracks)) {
+        Utils::asyncExec([keys = std::move(*cachedKeys), order]() {
+            return Sorting::sortIndexes(keys, order);
+        }).then(self, handleSortOrder);
+    }
+    else {
+        Utils::asyncExec([sortField, currentTracks, order]() {
+            return Sorting::calcSortOrder(sortField, currentTracks, order);
+        }).then(self, handleSortOrder);
+    }
+}
+
+void PlaylistWidgetPrivate::applySortOrder(const Id& playlistId, uint64_t revision,
+                                           const std::vector<int>& sortOrder) const
+{
+    auto* handler  = playlistController->playlistHandler();
+    auto* playlist = handler->playlistById(playlistId);
+
+    // The order only applies to the tracks it was worked out from
+    if(!playlist || playlist->revision() != revision) {
+        return;
+    }
+
+    handler->sortPlaylistTracks(playlistId, sortOrder);
 }
 
 void PlaylistWidgetPrivate::resetSort(bool force)
@@ -1041,12 +1102,47 @@ void PlaylistWidgetPrivate::addPresetMenu(QMenu* parent)
     parent->addMenu(presetsMenu);
 }
 
+void PlaylistWidgetPrivate::runStressTest()
+{
+    auto start = [this]() {
+        auto* currentPlaylist = playlistController->currentPlaylist();
+        if(!currentPlaylist) {
+            return;
+        }
+
+        auto* test = new PlaylistStressTest(playlistView, model, currentPlaylist->trackCount(), this);
+        QObject::connect(test, &PlaylistStressTest::finished, this, [this, test](std::chrono::milliseconds elapsed) {
+            profiler->finishStressTest(elapsed);
+            test->deleteLater();
+        });
+        test->start();
+    };
+
+    if(model->playlistIsLoaded()) {
+        start();
+    }
+    else {
+        QObject::connect(model, &PlaylistModel::playlistLoaded, this, start, Qt::SingleShotConnection);
+    }
+}
+
 PlaylistWidget::PlaylistWidget(ActionManager* actionManager, PlaylistInteractor* playlistInteractor,
-                               SettingsManager* settings, QWidget* parent)
+                               PlaylistProfiler* profiler, SettingsManager* settings, QWidget* parent)
     : FyWidget{parent}
-    , p{std::make_unique<PlaylistWidgetPrivate>(this, actionManager, playlistInteractor, settings)}
+    , p{std::make_unique<PlaylistWidgetPrivate>(this, actionManager, playlistInteractor, profiler, settings)}
 {
     setObjectName(PlaylistWidget::name());
+
+    if(!p->playlistController->playlistsHaveLoaded()) {
+        if(auto* preview = ViewPreview::cover(PlaylistWidget::layoutName(), p->playlistView)) {
+            QObject::connect(p->model, &PlaylistModel::playlistLoaded, preview, &ViewPreview::dismiss);
+            QObject::connect(p->playlistController, &PlaylistController::playlistsLoaded, preview, [this, preview]() {
+                if(!p->playlistController->currentPlaylist()) {
+                    preview->dismiss();
+                }
+            });
+        }
+    }
 }
 
 PlaylistWidget::~PlaylistWidget()
@@ -1055,6 +1151,10 @@ PlaylistWidget::~PlaylistWidget()
         return;
     }
 
+    if(p->model->playlistIsLoaded()) {
+        ViewPreview::save(PlaylistWidget::layoutName(), p->playlistView);
+    }
+
     p->playlistController->clearHistory();
     p->playlistController->savePlaylistState(p->playlistController->currentPlaylist(),
                                              p->getState(p->playlistController->currentPlaylist()));
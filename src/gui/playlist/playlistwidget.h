@@ -34,7 +34,7 @@ class PlaylistWidget : public FyWidget
 
 public:
     explicit PlaylistWidget(ActionManager* actionManager, PlaylistInteractor* playlistInteractor,
-                            SettingsManager* settings, QWidget* parent = nullptr);
+                            PlaylistProfiler* profiler, SettingsManager* settings, QWidget* parent = nullptr);
     ~PlaylistWidget() override;
 
     [[nodiscard]] QString name() const override;
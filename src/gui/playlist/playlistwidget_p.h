@@ -26,6 +26,7 @@
 
 #include <core/library/sortingregistry.h>
 #include <core/player/playbackqueue.h>
+#include <core/scripting/scriptparser.h>
 
 #include <QString>
 
@@ -45,6 +46,7 @@ class PlaylistWidget;
 class PlaylistController;
 class PlaylistInteractor;
 class PlaylistModel;
+class PlaylistProfiler;
 class PlaylistView;
 class MusicLibrary;
 struct PlaylistViewState;
@@ -56,7 +58,7 @@ class PlaylistWidgetPrivate : public QObject
 
 public:
     PlaylistWidgetPrivate(PlaylistWidget* self, ActionManager* actionManager, PlaylistInteractor* playlistInteractor,
-                          SettingsManager* settings);
+                          PlaylistProfiler* profiler, SettingsManager* settings);
 
     void setupConnections();
     void setupActions();
@@ -95,6 +97,7 @@ public:
 
     void playlistTracksAdded(const TrackList& tracks, int index) const;
     void handleTracksChanged(const std::vector<int>& indexes, bool allNew);
+    void handleTracksPlayed(const std::vector<int>& indexes);
     void handleQueueTracksChanged(const QueueTracks& removed, const QueueTracks& tracks);
     void handlePlayingTrackChanged(const PlaylistTrack& track) const;
 
@@ -108,11 +111,15 @@ public:
 
     void sortTracks(const QString& script) const;
     void sortColumn(int column, Qt::SortOrder order);
+    // Rearranges the playlist with @p playlistId into @p sortOrder, unless it has changed since @p revision
+    void applySortOrder(const Id& playlistId, uint64_t revision, const std::vector<int>& sortOrder) const;
     void resetSort(bool force = false);
 
     void addSortMenu(QMenu* parent, bool disabled);
     void addPresetMenu(QMenu* parent);
 
+    void runStressTest();
+
     PlaylistWidget* self;
 
     ActionManager* actionManager;
@@ -121,6 +128,7 @@ public:
     PlayerController* playerController;
     TrackSelectionController* selectionController;
     MusicLibrary* library;
+    PlaylistProfiler* profiler;
     SettingsManager* settings;
     SettingsDialogController* settingsDialog;
 
@@ -136,6 +144,8 @@ public:
     PlaylistPreset currentPreset;
     bool singleMode;
     PlaylistColumnList columns;
+    // Only used to find what the track rows depend on
+    ScriptParser dependencyParser;
     QByteArray headerState;
 
     WidgetContext* playlistContext;
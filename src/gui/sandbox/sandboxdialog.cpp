@@ -22,28 +22,58 @@
 #include "expressiontreemodel.h"
 #include "scripthighlighter.h"
 
+#include <core/library/musiclibrary.h>
 #include <core/track.h>
 #include <gui/trackselectioncontroller.h>
+#include <utils/async.h>
 #include <utils/settings/settingsmanager.h>
 
 #include <QApplication>
+#include <QComboBox>
 #include <QGridLayout>
+#include <QLabel>
 #include <QPlainTextEdit>
 #include <QSplitter>
 #include <QTextEdit>
 #include <QTimer>
 #include <QTreeView>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <random>
 
 using namespace std::chrono_literals;
 
+// Time after the last edit before the script is evaluated again
+constexpr auto PreviewDelay = 250ms;
+// Numbers of library tracks which can be sampled for the profile
+constexpr std::array SampleSizes{100, 1000, 10000};
+
+namespace {
+struct ScriptPreview
+{
+    Fooyin::ParsedScript script;
+    QString result;
+    Fooyin::ScriptProfile profile;
+    // Sampled tracks only, if a sample was requested
+    Fooyin::ScriptProfile sampleProfile;
+    size_t libraryTrackCount{0};
+};
+
+QString toMs(std::chrono::nanoseconds time)
+{
+    return QString::number(std::chrono::duration<double, std::milli>(time).count(), 'f', 3);
+}
+} // namespace
+
 namespace Fooyin {
 struct SandboxDialog::Private
 {
     SandboxDialog* self;
 
     TrackSelectionController* trackSelection;
+    MusicLibrary* library;
     SettingsManager* settings;
 
     QSplitter* mainSplitter;
@@ -56,16 +86,22 @@ struct SandboxDialog::Private
     QTreeView* expressionTree;
     ExpressionTreeModel model;
 
-    QTimer* textChangeTimer;
+    QComboBox* sampleSize;
+    QTimer* previewTimer;
 
-    ScriptRegistry registry;
+    // Shared with the preview running on a worker, which may outlive the dialog
+    std::shared_ptr<ScriptRegistry> registry;
     ScriptParser parser;
 
     ParsedScript currentScript;
+    // Incremented for each preview started, so only the latest is shown
+    int previewGeneration{0};
 
-    explicit Private(SandboxDialog* self_, TrackSelectionController* trackSelection_, SettingsManager* settings_)
+    explicit Private(SandboxDialog* self_, TrackSelectionController* trackSelection_, MusicLibrary* library_,
+                     SettingsManager* settings_)
         : self{self_}
         , trackSelection{trackSelection_}
+        , library{library_}
         , settings{settings_}
         , mainSplitter{new QSplitter(Qt::Horizontal, self)}
         , documentSplitter{new QSplitter(Qt::Vertical, self)}
@@ -73,23 +109,22 @@ struct SandboxDialog::Private
         , results{new QTextEdit(self)}
         , highlighter{editor->document()}
         , expressionTree{new QTreeView(self)}
-        , textChangeTimer{new QTimer(self)}
-        , parser{&registry}
+        , sampleSize{new QComboBox(self)}
+        , previewTimer{new QTimer(self)}
+        , registry{std::make_shared<ScriptRegistry>()}
+        , parser{registry.get()}
     {
         expressionTree->setModel(&model);
         expressionTree->setHeaderHidden(true);
         expressionTree->setSelectionMode(QAbstractItemView::SingleSelection);
 
-        textChangeTimer->setSingleShot(true);
-    }
-
-    void updateResults()
-    {
-        if(model.rowCount({}) > 0) {
-            if(const auto* item = static_cast<ExpressionTreeItem*>(model.index(0, 0, {}).internalPointer())) {
-                updateResults(item->expression());
-            }
+        sampleSize->addItem(SandboxDialog::tr("Selected tracks"), 0);
+        for(const int size : SampleSizes) {
+            sampleSize->addItem(SandboxDialog::tr("Selected tracks and %1 sampled library tracks").arg(size), size);
         }
+
+        previewTimer->setSingleShot(true);
+        previewTimer->setInterval(PreviewDelay);
     }
 
     void updateResults(const Expression& expression)
@@ -101,7 +136,7 @@ struct SandboxDialog::Private
         ParsedScript script;
         script.expressions = {expression};
 
-        const auto track  = trackSelection->selectedTracks().front();
+        const auto track  = trackSelection->selectedTrack();
         const auto result = parser.evaluate(script, track);
 
         results->setText(result);
@@ -119,24 +154,85 @@ struct SandboxDialog::Private
         updateResults(item->expression());
     }
 
-    void textChanged()
+    void startPreview()
     {
-        textChangeTimer->start(1500ms);
-        results->clear();
+        const int generation = ++previewGeneration;
+        const int samples    = sampleSize->currentData().toInt();
 
-        const Track track = trackSelection->hasTracks() ? trackSelection->selectedTracks().front() : Track{};
-        currentScript     = parser.parse(editor->toPlainText(), track);
+        const TrackList tracks     = trackSelection->selectedTracks();
+        const TrackSnapshot sample = samples > 0 ? library->snapshot() : TrackSnapshot{};
 
-        model.populate(currentScript.expressions);
-        updateResults();
+        // Parsing, evaluating and profiling all happen on a worker, so a slow script doesn't stall typing
+        Utils::asyncExec([registry = registry, input = editor->toPlainText(), tracks, sample, samples]() {
+            ScriptParser workerParser{registry.get()};
+
+            ScriptPreview preview;
+            preview.script = workerParser.parse(input, tracks.empty() ? Track{} : tracks.front());
+            if(!tracks.empty()) {
+                preview.result  = workerParser.evaluate(preview.script, tracks.front());
+                preview.profile = workerParser.profile(preview.script, tracks);
+            }
+
+            if(samples > 0 && !sample.empty()) {
+                TrackList sampled;
+                std::ranges::sample(sample.tracks(), std::back_inserter(sampled), samples,
+                                    std::mt19937{std::random_device{}()});
+                preview.sampleProfile     = workerParser.profile(preview.script, sampled);
+                preview.libraryTrackCount = sample.size();
+            }
+
+            return preview;
+        }).then(self, [this, generation](const ScriptPreview& preview) {
+            if(generation == previewGeneration) {
+                showPreview(preview);
+            }
+        });
     }
 
-    void showErrors() const
+    void showPreview(const ScriptPreview& preview)
     {
-        const auto errors = currentScript.errors;
-        for(const ScriptError& error : errors) {
+        currentScript = preview.script;
+
+        model.populate(currentScript.expressions);
+        results->setText(preview.result);
+
+        for(const ScriptError& error : currentScript.errors) {
             results->append(error.message);
         }
+
+        if(!currentScript.isValid()) {
+            return;
+        }
+
+        if(preview.profile.evaluations > 0) {
+            results->append({});
+            results->append(SandboxDialog::tr("Evaluated for %n selected track(s) in %1 ms", nullptr,
+                                              preview.profile.evaluations)
+                                .arg(toMs(preview.profile.total)));
+        }
+
+        if(preview.sampleProfile.evaluations > 0) {
+            const auto perTrack = preview.sampleProfile.total / preview.sampleProfile.evaluations;
+            const auto estimate = perTrack * static_cast<int64_t>(preview.libraryTrackCount);
+
+            results->append(SandboxDialog::tr("Evaluated for %n sampled track(s) in %1 ms (%2 ms per track)",
+                                              nullptr, preview.sampleProfile.evaluations)
+                                .arg(toMs(preview.sampleProfile.total), toMs(perTrack)));
+            results->append(SandboxDialog::tr("Estimated %1 ms for all %n library track(s)", nullptr,
+                                              static_cast<int>(preview.libraryTrackCount))
+                                .arg(toMs(estimate)));
+        }
+
+        // The sample is the larger and more representative set, if there is one
+        const ScriptProfile& profile
+            = preview.sampleProfile.evaluations > 0 ? preview.sampleProfile : preview.profile;
+
+        for(const ScriptProfileEntry& entry : profile.entries) {
+            const QString name = entry.function ? QStringLiteral("$%1()").arg(entry.name)
+                                                : QStringLiteral("%%1%").arg(entry.name);
+            results->append(
+                SandboxDialog::tr("%1: %2 ms (%n call(s))", nullptr, entry.calls).arg(name, toMs(entry.time)));
+        }
     }
 
     void restoreState()
@@ -147,6 +243,7 @@ struct SandboxDialog::Private
 
         if(byteArray.isEmpty()) {
             editor->setPlainText(defaultScript);
+            startPreview();
             return;
         }
 
@@ -158,11 +255,14 @@ struct SandboxDialog::Private
         QByteArray mainSplitterState;
         QByteArray documentSplitterState;
         QString editorText;
+        int samples{0};
 
         in >> dialogSize;
         in >> mainSplitterState;
         in >> documentSplitterState;
         in >> editorText;
+        // Not present in state saved by older versions
+        in >> samples;
 
         if(editorText.isEmpty()) {
             editorText = defaultScript;
@@ -173,11 +273,9 @@ struct SandboxDialog::Private
         documentSplitter->restoreState(documentSplitterState);
         editor->setPlainText(editorText);
         editor->moveCursor(QTextCursor::End);
+        sampleSize->setCurrentIndex(std::max(0, sampleSize->findData(samples)));
 
-        textChanged();
-        expressionTree->expandAll();
-
-        updateResults();
+        startPreview();
     }
 
     void saveState() const
@@ -189,6 +287,7 @@ struct SandboxDialog::Private
         out << mainSplitter->saveState();
         out << documentSplitter->saveState();
         out << editor->toPlainText();
+        out << sampleSize->currentData().toInt();
 
         byteArray = qCompress(byteArray, 9);
 
@@ -196,9 +295,10 @@ struct SandboxDialog::Private
     }
 };
 
-SandboxDialog::SandboxDialog(TrackSelectionController* trackSelection, SettingsManager* settings, QWidget* parent)
+SandboxDialog::SandboxDialog(TrackSelectionController* trackSelection, MusicLibrary* library,
+                             SettingsManager* settings, QWidget* parent)
     : QDialog{parent}
-    , p{std::make_unique<Private>(this, trackSelection, settings)}
+    , p{std::make_unique<Private>(this, trackSelection, library, settings)}
 {
     setWindowTitle(tr("Script Sandbox"));
 
@@ -217,26 +317,34 @@ SandboxDialog::SandboxDialog(TrackSelectionController* trackSelection, SettingsM
     p->mainSplitter->setStretchFactor(0, 4);
     p->mainSplitter->setStretchFactor(1, 2);
 
-    mainLayout->addWidget(p->mainSplitter);
+    auto* sampleLayout = new QHBoxLayout();
+    sampleLayout->setContentsMargins(5, 5, 5, 5);
+    sampleLayout->addWidget(new QLabel(tr("Profile over:"), this));
+    sampleLayout->addWidget(p->sampleSize);
+    sampleLayout->addStretch();
+
+    mainLayout->addWidget(p->mainSplitter, 0, 0);
+    mainLayout->addLayout(sampleLayout, 1, 0);
 
     p->restoreState();
 
-    QObject::connect(p->editor, &QPlainTextEdit::textChanged, this, [this]() { p->textChanged(); });
-    QObject::connect(p->textChangeTimer, &QTimer::timeout, this, [this]() { p->showErrors(); });
+    QObject::connect(p->editor, &QPlainTextEdit::textChanged, p->previewTimer, qOverload<>(&QTimer::start));
+    QObject::connect(p->sampleSize, &QComboBox::currentIndexChanged, this, [this]() { p->startPreview(); });
+    QObject::connect(p->previewTimer, &QTimer::timeout, this, [this]() { p->startPreview(); });
     QObject::connect(&p->model, &QAbstractItemModel::modelReset, p->expressionTree, &QTreeView::expandAll);
     QObject::connect(p->expressionTree->selectionModel(), &QItemSelectionModel::selectionChanged, this,
                      [this]() { p->selectionChanged(); });
-    QObject::connect(p->trackSelection, &TrackSelectionController::selectionChanged, this,
-                     [this]() { p->updateResults(); });
+    QObject::connect(p->trackSelection, &TrackSelectionController::selectionChanged, p->previewTimer,
+                     qOverload<>(&QTimer::start));
 }
 
 SandboxDialog::~SandboxDialog()
 {
     p->editor->disconnect();
 
-    p->textChangeTimer->disconnect();
-    p->textChangeTimer->stop();
-    p->textChangeTimer->deleteLater();
+    p->previewTimer->disconnect();
+    p->previewTimer->stop();
+    p->previewTimer->deleteLater();
 
     p->saveState();
 }
@@ -22,6 +22,7 @@
 #include <QDialog>
 
 namespace Fooyin {
+class MusicLibrary;
 class SettingsManager;
 class TrackSelectionController;
 
@@ -30,8 +31,8 @@ class SandboxDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit SandboxDialog(TrackSelectionController* trackSelection, SettingsManager* settings,
-                           QWidget* parent = nullptr);
+    SandboxDialog(TrackSelectionController* trackSelection, MusicLibrary* library, SettingsManager* settings,
+                  QWidget* parent = nullptr);
     ~SandboxDialog() override;
 
 private:
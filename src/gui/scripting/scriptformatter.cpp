@@ -22,12 +22,34 @@
 #include <core/scripting/scriptparser.h>
 #include <core/scripting/scriptscanner.h>
 #include <gui/scripting/scriptformatterregistry.h>
+#include <utils/lrucache.h>
 
 #include <QApplication>
 #include <QPalette>
 
+#include <algorithm>
 #include <stack>
 
+// Header texts repeat for every track of an album, so even a small cache catches most of them
+constexpr size_t CacheBudget = 1024 * 1024;
+
+namespace {
+// Formatting tags are the only markup which changes the text, and the scanner stops at the first null
+bool hasFormatting(const QString& input)
+{
+    return std::ranges::any_of(input, [](const QChar ch) { return ch == u'<' || ch.isNull(); });
+}
+
+size_t richTextCost(const QString& input, const Fooyin::RichText& text)
+{
+    size_t cost = sizeof(Fooyin::RichText) + (static_cast<size_t>(input.size()) * sizeof(QChar));
+    for(const auto& block : text) {
+        cost += sizeof(Fooyin::RichTextBlock) + (static_cast<size_t>(block.text.size()) * sizeof(QChar));
+    }
+    return cost;
+}
+} // namespace
+
 namespace Fooyin {
 struct ScriptFormatter::Private
 {
@@ -45,6 +67,41 @@ struct ScriptFormatter::Private
 
     RichText formatResult;
 
+    // Results depend on the default font and text colour, so are dropped if either changes
+    LruCache<QString, RichText> cache{CacheBudget};
+    QFont cacheFont;
+    QColor cacheColour;
+
+    void validateCache()
+    {
+        const QFont font    = QApplication::font();
+        const QColor colour = QApplication::palette().text().color();
+
+        if(font != cacheFont || colour != cacheColour) {
+            cache.clear();
+            cacheFont   = font;
+            cacheColour = colour;
+        }
+    }
+
+    void parse(const QString& input)
+    {
+        resetFormat();
+        formatResult.clear();
+        scanner.setup(input);
+
+        advance();
+        while(current.type != ScriptScanner::TokEos) {
+            expression();
+        }
+
+        consume(ScriptScanner::TokEos, QStringLiteral("Expected end of expression"));
+
+        if(!currentBlock.text.isEmpty()) {
+            formatResult.emplace_back(currentBlock);
+        }
+    }
+
     void advance()
     {
         previous = current;
@@ -241,21 +298,25 @@ RichText ScriptFormatter::evaluate(const QString& input)
         return {};
     }
 
-    p->resetFormat();
-    p->formatResult.clear();
-    p->scanner.setup(input);
+    if(!hasFormatting(input)) {
+        // Every other token is kept as written, so the whole input is a single block
+        p->resetFormat();
+        p->currentBlock.text = input;
 
-    p->advance();
-    while(p->current.type != ScriptScanner::TokEos) {
-        p->expression();
+        RichText result;
+        result.push_back(p->currentBlock);
+        return result;
     }
 
-    p->consume(ScriptScanner::TokEos, QStringLiteral("Expected end of expression"));
+    p->validateCache();
 
-    if(!p->currentBlock.text.isEmpty()) {
-        p->formatResult.emplace_back(p->currentBlock);
+    if(const RichText* cached = p->cache.find(input)) {
+        return *cached;
     }
 
+    p->parse(input);
+    p->cache.insert(input, p->formatResult, richTextCost(input, p->formatResult));
+
     return p->formatResult;
 }
 } // namespace Fooyin
@@ -58,7 +58,9 @@ private:
     QPlainTextEdit* m_artistCovers;
 
     QSpinBox* m_pixmapCache;
+    QSpinBox* m_coverCache;
     QSpinBox* m_thumbnailSize;
+    QLabel* m_cacheStats;
 };
 
 ArtworkPageWidget::ArtworkPageWidget(SettingsManager* settings)
@@ -70,7 +72,9 @@ ArtworkPageWidget::ArtworkPageWidget(SettingsManager* settings)
     , m_backCovers{new QPlainTextEdit(this)}
     , m_artistCovers{new QPlainTextEdit(this)}
     , m_pixmapCache{new QSpinBox(this)}
+    , m_coverCache{new QSpinBox(this)}
     , m_thumbnailSize{new QSpinBox(this)}
+    , m_cacheStats{new QLabel(this)}
 {
     auto* layout = new QGridLayout(this);
 
@@ -92,12 +96,17 @@ ArtworkPageWidget::ArtworkPageWidget(SettingsManager* settings)
     auto* cacheLayout   = new QGridLayout(cacheGroupBox);
 
     auto* pixmapCacheLabel   = new QLabel(tr("Pixmap cache size") + QStringLiteral(":"), this);
+    auto* coverCacheLabel    = new QLabel(tr("Artwork cache size") + QStringLiteral(":"), this);
     auto* thumbnailSizeLabel = new QLabel(tr("Thumbnail size") + QStringLiteral(":"), this);
 
     m_pixmapCache->setMinimum(10);
     m_pixmapCache->setMaximum(1000);
     m_pixmapCache->setSuffix(QStringLiteral(" MB"));
 
+    m_coverCache->setMinimum(8);
+    m_coverCache->setMaximum(4000);
+    m_coverCache->setSuffix(QStringLiteral(" MB"));
+
     m_thumbnailSize->setMinimum(1);
     m_thumbnailSize->setMaximum(500);
     m_thumbnailSize->setSuffix(QStringLiteral(" px"));
@@ -105,8 +114,11 @@ ArtworkPageWidget::ArtworkPageWidget(SettingsManager* settings)
     int row{0};
     cacheLayout->addWidget(pixmapCacheLabel, row, 0);
     cacheLayout->addWidget(m_pixmapCache, row++, 1);
+    cacheLayout->addWidget(coverCacheLabel, row, 0);
+    cacheLayout->addWidget(m_coverCache, row++, 1);
     cacheLayout->addWidget(thumbnailSizeLabel, row, 0);
     cacheLayout->addWidget(m_thumbnailSize, row++, 1);
+    cacheLayout->addWidget(m_cacheStats, row++, 0, 1, 2);
     cacheLayout->setColumnStretch(cacheLayout->columnCount(), 1);
 
     layout->addWidget(displayGroupBox, 0, 0);
@@ -133,7 +145,18 @@ void ArtworkPageWidget::load()
     m_artistCovers->setPlainText(paths.artistPaths.join(QStringLiteral("\n")));
 
     m_pixmapCache->setValue(m_settings->value<Settings::Gui::Internal::PixmapCacheSize>());
+    m_coverCache->setValue(m_settings->value<Settings::Gui::Internal::ArtworkCacheSize>());
     m_thumbnailSize->setValue(m_settings->value<Settings::Gui::Internal::ArtworkThumbnailSize>());
+
+    const auto stats        = CoverProvider::cacheStats();
+    const uint64_t lookups  = stats.memoryHits + stats.memoryMisses;
+    const int hitPercentage = lookups > 0 ? static_cast<int>(stats.memoryHits * 100 / lookups) : 0;
+    m_cacheStats->setText(tr("%1 covers in memory (%2 MB), %3% hit rate. %4 thumbnails on disk (%5 MB).")
+                              .arg(stats.memoryEntries)
+                              .arg(static_cast<double>(stats.memoryUsage) / (1024 * 1024), 0, 'f', 1)
+                              .arg(hitPercentage)
+                              .arg(stats.diskEntries)
+                              .arg(static_cast<double>(stats.diskUsage) / (1024 * 1024), 0, 'f', 1));
 }
 
 void ArtworkPageWidget::apply()
@@ -151,6 +174,7 @@ void ArtworkPageWidget::apply()
 
     m_settings->set<Settings::Gui::Internal::TrackCoverPaths>(QVariant::fromValue(paths));
     m_settings->set<Settings::Gui::Internal::PixmapCacheSize>(m_pixmapCache->value());
+    m_settings->set<Settings::Gui::Internal::ArtworkCacheSize>(m_coverCache->value());
     m_settings->set<Settings::Gui::Internal::ArtworkThumbnailSize>(m_thumbnailSize->value());
 }
 
@@ -159,6 +183,7 @@ void ArtworkPageWidget::reset()
     m_settings->reset<Settings::Gui::Internal::TrackCoverDisplayOption>();
     m_settings->reset<Settings::Gui::Internal::TrackCoverPaths>();
     m_settings->reset<Settings::Gui::Internal::PixmapCacheSize>();
+    m_settings->reset<Settings::Gui::Internal::ArtworkCacheSize>();
     m_settings->reset<Settings::Gui::Internal::ArtworkThumbnailSize>();
 }
 
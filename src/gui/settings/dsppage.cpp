@@ -0,0 +1,240 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dsppage.h"
+
+#include <core/coresettings.h>
+#include <core/engine/enginecontroller.h>
+#include <core/internalcoresettings.h>
+#include <gui/guiconstants.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QGridLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QListWidget>
+#include <QSlider>
+#include <QSpinBox>
+
+#include <algorithm>
+#include <array>
+
+constexpr std::array EqualiserBands{"31", "62", "125", "250", "500", "1K", "2K", "4K", "8K", "16K"};
+constexpr auto EqualiserRange = 12;
+
+namespace Fooyin {
+class DspPageWidget : public SettingsPageWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DspPageWidget(SettingsManager* settings, EngineController* engine);
+
+    void load() override;
+    void apply() override;
+    void reset() override;
+
+private:
+    SettingsManager* m_settings;
+    EngineController* m_engine;
+
+    QListWidget* m_dspList;
+
+    std::array<QSlider*, EqualiserBands.size()> m_equaliserBands;
+
+    QDoubleSpinBox* m_limiterThreshold;
+    QSpinBox* m_limiterRelease;
+
+    QComboBox* m_channelMixerMode;
+};
+
+DspPageWidget::DspPageWidget(SettingsManager* settings, EngineController* engine)
+    : m_settings{settings}
+    , m_engine{engine}
+    , m_dspList{new QListWidget(this)}
+    , m_equaliserBands{}
+    , m_limiterThreshold{new QDoubleSpinBox(this)}
+    , m_limiterRelease{new QSpinBox(this)}
+    , m_channelMixerMode{new QComboBox(this)}
+{
+    auto* chainBox    = new QGroupBox(tr("DSP Chain"), this);
+    auto* chainLayout = new QGridLayout(chainBox);
+
+    auto* chainHint = new QLabel(tr("Checked DSPs are applied from top to bottom. Drag to reorder."), this);
+    chainHint->setWordWrap(true);
+
+    m_dspList->setDragDropMode(QAbstractItemView::InternalMove);
+    m_dspList->setDefaultDropAction(Qt::MoveAction);
+
+    chainLayout->addWidget(chainHint, 0, 0);
+    chainLayout->addWidget(m_dspList, 1, 0);
+
+    auto* equaliserBox    = new QGroupBox(tr("Equaliser"), this);
+    auto* equaliserLayout = new QGridLayout(equaliserBox);
+
+    for(size_t i{0}; i < EqualiserBands.size(); ++i) {
+        auto* slider = new QSlider(Qt::Vertical, this);
+        slider->setRange(-EqualiserRange, EqualiserRange);
+        slider->setTickPosition(QSlider::TicksBothSides);
+        slider->setTickInterval(EqualiserRange / 2);
+
+        auto* gainLabel = new QLabel(this);
+        auto* bandLabel = new QLabel(QString::fromLatin1(EqualiserBands.at(i)), this);
+        gainLabel->setAlignment(Qt::AlignCenter);
+        bandLabel->setAlignment(Qt::AlignCenter);
+
+        QObject::connect(slider, &QSlider::valueChanged, gainLabel,
+                         [gainLabel](int value) { gainLabel->setText(QStringLiteral("%1 dB").arg(value)); });
+
+        const auto column = static_cast<int>(i);
+        equaliserLayout->addWidget(gainLabel, 0, column, Qt::AlignHCenter);
+        equaliserLayout->addWidget(slider, 1, column, Qt::AlignHCenter);
+        equaliserLayout->addWidget(bandLabel, 2, column, Qt::AlignHCenter);
+
+        m_equaliserBands.at(i) = slider;
+    }
+
+    auto* limiterBox    = new QGroupBox(tr("Limiter"), this);
+    auto* limiterLayout = new QGridLayout(limiterBox);
+
+    auto* thresholdLabel = new QLabel(tr("Threshold") + QStringLiteral(":"), this);
+    auto* releaseLabel   = new QLabel(tr("Release") + QStringLiteral(":"), this);
+
+    m_limiterThreshold->setSuffix(QStringLiteral(" dB"));
+    m_limiterThreshold->setDecimals(1);
+    m_limiterThreshold->setSingleStep(0.5);
+    m_limiterThreshold->setRange(-20.0, 0.0);
+
+    m_limiterRelease->setSuffix(QStringLiteral(" ms"));
+    m_limiterRelease->setRange(1, 1000);
+    m_limiterRelease->setSingleStep(10);
+
+    limiterLayout->addWidget(thresholdLabel, 0, 0);
+    limiterLayout->addWidget(m_limiterThreshold, 0, 1);
+    limiterLayout->addWidget(releaseLabel, 1, 0);
+    limiterLayout->addWidget(m_limiterRelease, 1, 1);
+    limiterLayout->setColumnStretch(2, 1);
+
+    auto* channelMixerBox    = new QGroupBox(tr("Channel Mixer"), this);
+    auto* channelMixerLayout = new QGridLayout(channelMixerBox);
+
+    auto* modeLabel = new QLabel(tr("Mode") + QStringLiteral(":"), this);
+
+    m_channelMixerMode->addItem(tr("Mono"), 0);
+    m_channelMixerMode->addItem(tr("Swap left and right"), 1);
+    m_channelMixerMode->addItem(tr("Left channel only"), 2);
+    m_channelMixerMode->addItem(tr("Right channel only"), 3);
+
+    channelMixerLayout->addWidget(modeLabel, 0, 0);
+    channelMixerLayout->addWidget(m_channelMixerMode, 0, 1);
+    channelMixerLayout->setColumnStretch(2, 1);
+
+    auto* mainLayout = new QGridLayout(this);
+    mainLayout->addWidget(chainBox, 0, 0);
+    mainLayout->addWidget(equaliserBox, 1, 0);
+    mainLayout->addWidget(limiterBox, 2, 0);
+    mainLayout->addWidget(channelMixerBox, 3, 0);
+    mainLayout->setRowStretch(mainLayout->rowCount(), 1);
+}
+
+void DspPageWidget::load()
+{
+    const QStringList chain = m_settings->value<Settings::Core::DspChain>();
+    const DspInfos dsps     = m_engine->getAllDsps();
+
+    m_dspList->clear();
+
+    auto addDsp = [this](const DspInfo& dsp, bool active) {
+        auto* item = new QListWidgetItem(dsp.name, m_dspList);
+        item->setData(Qt::UserRole, dsp.id);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setFlags(item->flags() & ~Qt::ItemIsDropEnabled);
+        item->setCheckState(active ? Qt::Checked : Qt::Unchecked);
+    };
+
+    // Active DSPs first, in the order they run
+    for(const QString& id : chain) {
+        const auto dsp = std::ranges::find(dsps, id, &DspInfo::id);
+        if(dsp != dsps.cend()) {
+            addDsp(*dsp, true);
+        }
+    }
+    for(const auto& dsp : dsps) {
+        if(!chain.contains(dsp.id)) {
+            addDsp(dsp, false);
+        }
+    }
+
+    const auto gains = m_settings->value<Settings::Core::Internal::EqualiserGains>().toList();
+    for(size_t i{0}; i < m_equaliserBands.size(); ++i) {
+        const auto index = static_cast<qsizetype>(i);
+        m_equaliserBands.at(i)->setValue(index < gains.size() ? static_cast<int>(gains.at(index).toDouble()) : 0);
+    }
+
+    m_limiterThreshold->setValue(m_settings->value<Settings::Core::Internal::LimiterThreshold>());
+    m_limiterRelease->setValue(m_settings->value<Settings::Core::Internal::LimiterRelease>());
+    m_channelMixerMode->setCurrentIndex(
+        std::max(0, m_channelMixerMode->findData(m_settings->value<Settings::Core::Internal::ChannelMixerMode>())));
+}
+
+void DspPageWidget::apply()
+{
+    QStringList chain;
+    for(int i{0}; i < m_dspList->count(); ++i) {
+        const auto* item = m_dspList->item(i);
+        if(item->checkState() == Qt::Checked) {
+            chain.append(item->data(Qt::UserRole).toString());
+        }
+    }
+
+    QVariantList gains;
+    for(const auto* slider : m_equaliserBands) {
+        gains.append(static_cast<double>(slider->value()));
+    }
+
+    m_settings->set<Settings::Core::Internal::EqualiserGains>(gains);
+    m_settings->set<Settings::Core::Internal::LimiterThreshold>(m_limiterThreshold->value());
+    m_settings->set<Settings::Core::Internal::LimiterRelease>(m_limiterRelease->value());
+    m_settings->set<Settings::Core::Internal::ChannelMixerMode>(m_channelMixerMode->currentData().toInt());
+    m_settings->set<Settings::Core::DspChain>(chain);
+}
+
+void DspPageWidget::reset()
+{
+    m_settings->reset<Settings::Core::Internal::EqualiserGains>();
+    m_settings->reset<Settings::Core::Internal::LimiterThreshold>();
+    m_settings->reset<Settings::Core::Internal::LimiterRelease>();
+    m_settings->reset<Settings::Core::Internal::ChannelMixerMode>();
+    m_settings->reset<Settings::Core::DspChain>();
+}
+
+DspPage::DspPage(SettingsManager* settings, EngineController* engine)
+    : SettingsPage{settings->settingsDialog()}
+{
+    setId(Constants::Page::EngineDsp);
+    setName(tr("DSP"));
+    setCategory({tr("Engine"), tr("DSP")});
+    setWidgetCreator([settings, engine] { return new DspPageWidget(settings, engine); });
+}
+} // namespace Fooyin
+
+#include "dsppage.moc"
+#include "moc_dsppage.cpp"
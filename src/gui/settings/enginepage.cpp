@@ -20,6 +20,7 @@
 #include "enginepage.h"
 
 #include <core/coresettings.h>
+#include <core/engine/audiobuffer.h>
 #include <core/engine/enginehandler.h>
 #include <core/internalcoresettings.h>
 #include <gui/guiconstants.h>
@@ -28,6 +29,7 @@
 
 #include <QCheckBox>
 #include <QComboBox>
+#include <QDoubleSpinBox>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QLabel>
@@ -57,13 +59,25 @@ private:
     ExpandingComboBox* m_deviceBox;
 
     QCheckBox* m_gaplessPlayback;
+    QCheckBox* m_realtimePlayback;
+    QCheckBox* m_bitPerfect;
     QSpinBox* m_bufferSize;
+    QComboBox* m_outputSampleRate;
+    QComboBox* m_resampleQuality;
 
     QGroupBox* m_fadingBox;
     QSpinBox* m_fadingStopIn;
     QSpinBox* m_fadingStopOut;
     // QSpinBox* m_fadingSeekIn;
     // QSpinBox* m_fadingSeekOut;
+
+    QGroupBox* m_crossfadeBox;
+    QSpinBox* m_crossfadeIn;
+    QSpinBox* m_crossfadeOut;
+    QComboBox* m_crossfadeCurve;
+
+    QComboBox* m_replayGainMode;
+    QDoubleSpinBox* m_replayGainPreAmp;
 };
 
 EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController* engine)
@@ -72,12 +86,22 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     , m_outputBox{new ExpandingComboBox(this)}
     , m_deviceBox{new ExpandingComboBox(this)}
     , m_gaplessPlayback{new QCheckBox(tr("Gapless playback"), this)}
+    , m_realtimePlayback{new QCheckBox(tr("Real-time playback threads"), this)}
+    , m_bitPerfect{new QCheckBox(tr("Bit-perfect playback"), this)}
     , m_bufferSize{new QSpinBox(this)}
+    , m_outputSampleRate{new QComboBox(this)}
+    , m_resampleQuality{new QComboBox(this)}
     , m_fadingBox{new QGroupBox(tr("Fading"), this)}
     , m_fadingStopIn{new QSpinBox(this)}
     , m_fadingStopOut{new QSpinBox(this)}
 // , m_fadingSeekIn{new QSpinBox(this)}
 // , m_fadingSeekOut{new QSpinBox(this)}
+    , m_crossfadeBox{new QGroupBox(tr("Crossfade"), this)}
+    , m_crossfadeIn{new QSpinBox(this)}
+    , m_crossfadeOut{new QSpinBox(this)}
+    , m_crossfadeCurve{new QComboBox(this)}
+    , m_replayGainMode{new QComboBox(this)}
+    , m_replayGainPreAmp{new QDoubleSpinBox(this)}
 {
     auto* outputLabel = new QLabel(tr("Output") + QStringLiteral(":"), this);
     auto* deviceLabel = new QLabel(tr("Device") + QStringLiteral(":"), this);
@@ -88,7 +112,15 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     m_gaplessPlayback->setToolTip(
         tr("Try to play consecutive tracks with no silence or disruption at the point of file change"));
 
+    m_realtimePlayback->setToolTip(tr("Schedule decoding and output ahead of other programs to avoid dropouts under "
+                                      "heavy load. Requires permission for real-time scheduling."));
+
+    m_bitPerfect->setToolTip(tr("Send audio to the output exactly as decoded, at the track's own sample rate. "
+                                "Volume, ReplayGain, crossfading and DSPs are bypassed."));
+
     generalLayout->addWidget(m_gaplessPlayback, 0, 0, 1, 3);
+    generalLayout->addWidget(m_realtimePlayback, 1, 0, 1, 3);
+    generalLayout->addWidget(m_bitPerfect, 2, 0, 1, 3);
 
     auto* bufferLabel = new QLabel(tr("Buffer length") + QStringLiteral(":"), this);
 
@@ -97,8 +129,27 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     m_bufferSize->setMinimum(50);
     m_bufferSize->setMaximum(30000);
 
-    generalLayout->addWidget(bufferLabel, 1, 0);
-    generalLayout->addWidget(m_bufferSize, 1, 1);
+    generalLayout->addWidget(bufferLabel, 3, 0);
+    generalLayout->addWidget(m_bufferSize, 3, 1);
+
+    auto* sampleRateLabel = new QLabel(tr("Output sample rate") + QStringLiteral(":"), this);
+    auto* qualityLabel    = new QLabel(tr("Resampling quality") + QStringLiteral(":"), this);
+
+    m_outputSampleRate->setToolTip(
+        tr("Resample all tracks to a fixed rate, so the output isn't reopened when the track format changes"));
+    m_outputSampleRate->addItem(tr("Same as track"), 0);
+    for(const int rate : {44100, 48000, 88200, 96000, 176400, 192000}) {
+        m_outputSampleRate->addItem(QStringLiteral("%1 Hz").arg(rate), rate);
+    }
+
+    m_resampleQuality->addItem(tr("Fast"), static_cast<int>(ResampleQuality::Fast));
+    m_resampleQuality->addItem(tr("Medium"), static_cast<int>(ResampleQuality::Medium));
+    m_resampleQuality->addItem(tr("High"), static_cast<int>(ResampleQuality::High));
+
+    generalLayout->addWidget(sampleRateLabel, 4, 0);
+    generalLayout->addWidget(m_outputSampleRate, 4, 1);
+    generalLayout->addWidget(qualityLabel, 5, 0);
+    generalLayout->addWidget(m_resampleQuality, 5, 1);
 
     generalLayout->setColumnStretch(2, 1);
 
@@ -135,6 +186,55 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     // fadingLayout->addWidget(m_fadingSeekOut, 2, 2);
     fadingLayout->setColumnStretch(3, 1);
 
+    m_crossfadeBox->setCheckable(true);
+    m_crossfadeBox->setToolTip(tr("Fade out the end of each track while the next one fades in"));
+    auto* crossfadeLayout = new QGridLayout(m_crossfadeBox);
+
+    auto* crossfadeInLabel    = new QLabel(tr("Fade In"), this);
+    auto* crossfadeOutLabel   = new QLabel(tr("Fade Out"), this);
+    auto* trackChangeLabel    = new QLabel(tr("Track change"), this);
+    auto* crossfadeCurveLabel = new QLabel(tr("Curve") + QStringLiteral(":"), this);
+
+    for(auto* spinBox : {m_crossfadeIn, m_crossfadeOut}) {
+        spinBox->setSuffix(QStringLiteral("ms"));
+        spinBox->setMaximum(10000);
+        spinBox->setSingleStep(100);
+    }
+
+    m_crossfadeCurve->addItem(tr("Linear"), static_cast<int>(AudioBuffer::RampCurve::Linear));
+    m_crossfadeCurve->addItem(tr("Equal power"), static_cast<int>(AudioBuffer::RampCurve::EqualPower));
+
+    crossfadeLayout->addWidget(crossfadeInLabel, 0, 1);
+    crossfadeLayout->addWidget(crossfadeOutLabel, 0, 2);
+    crossfadeLayout->addWidget(trackChangeLabel, 1, 0);
+    crossfadeLayout->addWidget(m_crossfadeIn, 1, 1);
+    crossfadeLayout->addWidget(m_crossfadeOut, 1, 2);
+    crossfadeLayout->addWidget(crossfadeCurveLabel, 2, 0);
+    crossfadeLayout->addWidget(m_crossfadeCurve, 2, 1, 1, 2);
+    crossfadeLayout->setColumnStretch(3, 1);
+
+    auto* replayGainBox    = new QGroupBox(tr("ReplayGain"), this);
+    auto* replayGainLayout = new QGridLayout(replayGainBox);
+
+    auto* replayGainModeLabel = new QLabel(tr("Mode") + QStringLiteral(":"), this);
+    auto* preAmpLabel         = new QLabel(tr("Pre-amp") + QStringLiteral(":"), this);
+
+    m_replayGainMode->addItem(tr("Disabled"), static_cast<int>(ReplayGainMode::Off));
+    m_replayGainMode->addItem(tr("Track"), static_cast<int>(ReplayGainMode::Track));
+    m_replayGainMode->addItem(tr("Album"), static_cast<int>(ReplayGainMode::Album));
+
+    m_replayGainPreAmp->setSuffix(QStringLiteral(" dB"));
+    m_replayGainPreAmp->setDecimals(1);
+    m_replayGainPreAmp->setSingleStep(0.5);
+    m_replayGainPreAmp->setRange(-20.0, 20.0);
+    m_replayGainPreAmp->setToolTip(tr("Gain applied on top of ReplayGain values, limited to avoid clipping"));
+
+    replayGainLayout->addWidget(replayGainModeLabel, 0, 0);
+    replayGainLayout->addWidget(m_replayGainMode, 0, 1);
+    replayGainLayout->addWidget(preAmpLabel, 1, 0);
+    replayGainLayout->addWidget(m_replayGainPreAmp, 1, 1);
+    replayGainLayout->setColumnStretch(2, 1);
+
     auto* mainLayout = new QGridLayout(this);
     mainLayout->addWidget(outputLabel, 0, 0);
     mainLayout->addWidget(m_outputBox, 0, 1);
@@ -142,6 +242,8 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     mainLayout->addWidget(m_deviceBox, 1, 1);
     mainLayout->addWidget(generalBox, 2, 0, 1, 2);
     mainLayout->addWidget(m_fadingBox, 3, 0, 1, 2);
+    mainLayout->addWidget(m_crossfadeBox, 4, 0, 1, 2);
+    mainLayout->addWidget(replayGainBox, 5, 0, 1, 2);
 
     mainLayout->setColumnStretch(1, 1);
     mainLayout->setRowStretch(mainLayout->rowCount(), 1);
@@ -153,6 +255,21 @@ EnginePageWidget::EnginePageWidget(SettingsManager* settings, EngineController*
     };
 
     QObject::connect(m_outputBox, &QComboBox::currentTextChanged, this, &EnginePageWidget::setupDevices);
+    QObject::connect(m_engine, &EngineController::outputDevicesChanged, this, [this](const QString& output) {
+        if(output != m_outputBox->currentText()) {
+            return;
+        }
+        // Devices are listed again once enumerated, which shouldn't undo a selection made meanwhile
+        const QVariant selected = m_deviceBox->currentData();
+        setupDevices(output);
+        if(const int index = m_deviceBox->findData(selected); index >= 0) {
+            m_deviceBox->setCurrentIndex(index);
+        }
+    });
+    QObject::connect(m_bitPerfect, &QCheckBox::toggled, this, [this](bool checked) {
+        m_outputSampleRate->setDisabled(checked);
+        m_resampleQuality->setDisabled(checked);
+    });
     QObject::connect(m_fadingStopIn, &QSpinBox::valueChanged, this, matchBufferInterval);
     QObject::connect(m_fadingStopOut, &QSpinBox::valueChanged, this, matchBufferInterval);
 }
@@ -162,7 +279,13 @@ void EnginePageWidget::load()
     setupOutputs();
     setupDevices(m_outputBox->currentText());
     m_gaplessPlayback->setChecked(m_settings->value<Settings::Core::GaplessPlayback>());
+    m_realtimePlayback->setChecked(m_settings->value<Settings::Core::RealtimePlayback>());
+    m_bitPerfect->setChecked(m_settings->value<Settings::Core::BitPerfect>());
     m_bufferSize->setValue(m_settings->value<Settings::Core::BufferLength>());
+    m_outputSampleRate->setCurrentIndex(
+        std::max(0, m_outputSampleRate->findData(m_settings->value<Settings::Core::OutputSampleRate>())));
+    m_resampleQuality->setCurrentIndex(
+        m_resampleQuality->findData(m_settings->value<Settings::Core::ResampleQuality>()));
 
     m_fadingBox->setChecked(m_settings->value<Settings::Core::Internal::EngineFading>());
     const auto fadingValues = m_settings->value<Settings::Core::Internal::FadingIntervals>().value<FadingIntervals>();
@@ -170,6 +293,16 @@ void EnginePageWidget::load()
     m_fadingStopOut->setValue(fadingValues.outPauseStop);
     // m_fadingSeekIn->setValue(fadingValues.inSeek);
     // m_fadingSeekOut->setValue(fadingValues.outSeek);
+
+    m_crossfadeBox->setChecked(m_settings->value<Settings::Core::Internal::EngineCrossfading>());
+    m_crossfadeIn->setValue(fadingValues.inChange);
+    m_crossfadeOut->setValue(fadingValues.outChange);
+    m_crossfadeCurve->setCurrentIndex(
+        m_crossfadeCurve->findData(m_settings->value<Settings::Core::Internal::CrossfadeCurve>()));
+
+    m_replayGainMode->setCurrentIndex(
+        m_replayGainMode->findData(m_settings->value<Settings::Core::ReplayGainMode>()));
+    m_replayGainPreAmp->setValue(m_settings->value<Settings::Core::ReplayGainPreAmp>());
 }
 
 void EnginePageWidget::apply()
@@ -177,25 +310,44 @@ void EnginePageWidget::apply()
     const QString output = m_outputBox->currentText() + QStringLiteral("|") + m_deviceBox->currentData().toString();
     m_settings->set<Settings::Core::AudioOutput>(output);
     m_settings->set<Settings::Core::GaplessPlayback>(m_gaplessPlayback->isChecked());
+    m_settings->set<Settings::Core::RealtimePlayback>(m_realtimePlayback->isChecked());
+    m_settings->set<Settings::Core::BitPerfect>(m_bitPerfect->isChecked());
     m_settings->set<Settings::Core::BufferLength>(m_bufferSize->value());
+    m_settings->set<Settings::Core::OutputSampleRate>(m_outputSampleRate->currentData().toInt());
+    m_settings->set<Settings::Core::ResampleQuality>(m_resampleQuality->currentData().toInt());
 
     FadingIntervals fadingValues;
     fadingValues.inPauseStop  = m_fadingStopIn->value();
     fadingValues.outPauseStop = m_fadingStopOut->value();
     // fadingValues.inSeek       = m_fadingSeekIn->value();
     // fadingValues.outSeek      = m_fadingSeekOut->value();
+    fadingValues.inChange     = m_crossfadeIn->value();
+    fadingValues.outChange    = m_crossfadeOut->value();
 
     m_settings->set<Settings::Core::Internal::EngineFading>(m_fadingBox->isChecked());
     m_settings->set<Settings::Core::Internal::FadingIntervals>(QVariant::fromValue(fadingValues));
+    m_settings->set<Settings::Core::Internal::EngineCrossfading>(m_crossfadeBox->isChecked());
+    m_settings->set<Settings::Core::Internal::CrossfadeCurve>(m_crossfadeCurve->currentData().toInt());
+
+    m_settings->set<Settings::Core::ReplayGainMode>(m_replayGainMode->currentData().toInt());
+    m_settings->set<Settings::Core::ReplayGainPreAmp>(m_replayGainPreAmp->value());
 }
 
 void EnginePageWidget::reset()
 {
     m_settings->reset<Settings::Core::AudioOutput>();
     m_settings->reset<Settings::Core::GaplessPlayback>();
+    m_settings->reset<Settings::Core::RealtimePlayback>();
+    m_settings->reset<Settings::Core::BitPerfect>();
     m_settings->reset<Settings::Core::BufferLength>();
+    m_settings->reset<Settings::Core::OutputSampleRate>();
+    m_settings->reset<Settings::Core::ResampleQuality>();
     m_settings->reset<Settings::Core::Internal::EngineFading>();
     m_settings->reset<Settings::Core::Internal::FadingIntervals>();
+    m_settings->reset<Settings::Core::Internal::EngineCrossfading>();
+    m_settings->reset<Settings::Core::Internal::CrossfadeCurve>();
+    m_settings->reset<Settings::Core::ReplayGainMode>();
+    m_settings->reset<Settings::Core::ReplayGainPreAmp>();
 }
 
 void EnginePageWidget::setupOutputs()
@@ -23,6 +23,7 @@
 
 #include "core/internalcoresettings.h"
 #include "core/library/libraryinfo.h"
+#include "core/library/librarymanager.h"
 
 #include <core/coresettings.h>
 #include <core/library/musiclibrary.h>
@@ -31,11 +32,13 @@
 #include <utils/settings/settingsmanager.h>
 
 #include <QCheckBox>
+#include <QDebug>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QGridLayout>
 #include <QHeaderView>
 #include <QInputDialog>
+#include <QLabel>
 #include <QMenu>
 #include <QPushButton>
 
@@ -52,6 +55,7 @@ public:
 signals:
     void refreshLibrary(const LibraryInfo& info);
     void rescanLibrary(const LibraryInfo& info);
+    void relocateLibrary(const LibraryInfo& info);
 };
 
 void LibraryTableView::setupContextActions(QMenu* menu, const QPoint& pos)
@@ -72,8 +76,13 @@ void LibraryTableView::setupContextActions(QMenu* menu, const QPoint& pos)
     rescan->setEnabled(!isPending);
     QObject::connect(rescan, &QAction::triggered, this, [this, library]() { emit rescanLibrary(library); });
 
+    auto* relocate = new QAction(tr("Relocate…"), this);
+    relocate->setEnabled(!isPending);
+    QObject::connect(relocate, &QAction::triggered, this, [this, library]() { emit relocateLibrary(library); });
+
     menu->addAction(refresh);
     menu->addAction(rescan);
+    menu->addAction(relocate);
 }
 
 class LibraryGeneralPageWidget : public SettingsPageWidget
@@ -90,6 +99,8 @@ public:
 
 private:
     void addLibrary() const;
+    void relocateLibrary(const LibraryInfo& library) const;
+    void updateScanMetrics(const ScanMetrics& metrics);
 
     LibraryManager* m_libraryManager;
     MusicLibrary* m_library;
@@ -100,6 +111,12 @@ private:
 
     QCheckBox* m_autoRefresh;
     QCheckBox* m_monitorLibraries;
+    QCheckBox* m_databaseTuning;
+    QCheckBox* m_audioFingerprints;
+    QCheckBox* m_extractCovers;
+    QCheckBox* m_scriptCache;
+    QCheckBox* m_throttleIdleWork;
+    QLabel* m_scanMetrics;
 };
 
 LibraryGeneralPageWidget::LibraryGeneralPageWidget(ActionManager* actionManager, LibraryManager* libraryManager,
@@ -111,6 +128,12 @@ LibraryGeneralPageWidget::LibraryGeneralPageWidget(ActionManager* actionManager,
     , m_model{new LibraryModel(m_libraryManager, this)}
     , m_autoRefresh{new QCheckBox(tr("Auto refresh on startup"), this)}
     , m_monitorLibraries{new QCheckBox(tr("Monitor libraries"), this)}
+    , m_databaseTuning{new QCheckBox(tr("Optimise database for speed"), this)}
+    , m_audioFingerprints{new QCheckBox(tr("Recognise moved files by their audio"), this)}
+    , m_extractCovers{new QCheckBox(tr("Extract embedded artwork while scanning"), this)}
+    , m_scriptCache{new QCheckBox(tr("Cache grouping results on disk"), this)}
+    , m_throttleIdleWork{new QCheckBox(tr("Slow down scanning and analysis while the system is busy"), this)}
+    , m_scanMetrics{new QLabel(this)}
 {
     m_libraryView->setExtendableModel(m_model);
 
@@ -124,25 +147,58 @@ LibraryGeneralPageWidget::LibraryGeneralPageWidget(ActionManager* actionManager,
 
     m_autoRefresh->setToolTip(tr("Scan libraries for changes on startup"));
     m_monitorLibraries->setToolTip(tr("Monitor libraries for external changes"));
+    m_databaseTuning->setToolTip(tr("Use write-ahead logging and larger caches for the library database. "
+                                    "Takes effect after a restart"));
+    m_audioFingerprints->setToolTip(tr("Store an acoustic fingerprint of each track when calculating ReplayGain, "
+                                       "so renamed and retagged files keep their playback statistics"));
+    m_extractCovers->setToolTip(tr("Store a thumbnail of each album's embedded front cover as its files are scanned, "
+                                   "so artwork shows without reading every file again"));
+    m_scriptCache->setToolTip(tr("Keep the results of library tree and filter scripts between sessions, "
+                                 "so views of unchanged tracks are filled without evaluating them again"));
+    m_throttleIdleWork->setToolTip(tr("Hold back library scans, ReplayGain analysis and waveform generation during "
+                                      "playback, on battery, or while the system is under heavy load"));
 
     auto* mainLayout = new QGridLayout(this);
     mainLayout->addWidget(m_libraryView, 0, 0, 1, 2);
     mainLayout->addWidget(m_autoRefresh, 1, 0, 1, 2);
     mainLayout->addWidget(m_monitorLibraries, 2, 0, 1, 2);
+    mainLayout->addWidget(m_databaseTuning, 3, 0, 1, 2);
+    mainLayout->addWidget(m_audioFingerprints, 4, 0, 1, 2);
+    mainLayout->addWidget(m_extractCovers, 5, 0, 1, 2);
+    mainLayout->addWidget(m_scriptCache, 6, 0, 1, 2);
+    mainLayout->addWidget(m_throttleIdleWork, 7, 0, 1, 2);
+    mainLayout->addWidget(m_scanMetrics, 8, 0, 1, 2);
 
     mainLayout->setColumnStretch(1, 1);
 
+    m_scanMetrics->setWordWrap(true);
+    m_scanMetrics->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_scanMetrics->hide();
+
+    if(const auto metrics = m_libraryManager->lastScanMetrics()) {
+        updateScanMetrics(metrics.value());
+    }
+    QObject::connect(m_libraryManager, &LibraryManager::scanMetricsChanged, this,
+                     &LibraryGeneralPageWidget::updateScanMetrics);
+
     QObject::connect(m_model, &LibraryModel::requestAddLibrary, this, &LibraryGeneralPageWidget::addLibrary);
     QObject::connect(m_libraryView, &LibraryTableView::refreshLibrary, this,
                      [this](const auto& info) { m_library->refresh(info); });
     QObject::connect(m_libraryView, &LibraryTableView::rescanLibrary, this,
                      [this](const auto& info) { m_library->rescan(info); });
+    QObject::connect(m_libraryView, &LibraryTableView::relocateLibrary, this,
+                     &LibraryGeneralPageWidget::relocateLibrary);
 }
 
 void LibraryGeneralPageWidget::load()
 {
     m_autoRefresh->setChecked(m_settings->value<Settings::Core::AutoRefresh>());
     m_monitorLibraries->setChecked(m_settings->value<Settings::Core::Internal::MonitorLibraries>());
+    m_databaseTuning->setChecked(m_settings->value<Settings::Core::Internal::DatabaseTuning>());
+    m_audioFingerprints->setChecked(m_settings->value<Settings::Core::Internal::AudioFingerprints>());
+    m_extractCovers->setChecked(m_settings->value<Settings::Core::Internal::ExtractCovers>());
+    m_scriptCache->setChecked(m_settings->value<Settings::Core::Internal::ScriptCache>());
+    m_throttleIdleWork->setChecked(m_settings->value<Settings::Core::Internal::ThrottleIdleWork>());
 
     m_model->populate();
 }
@@ -151,6 +207,11 @@ void LibraryGeneralPageWidget::apply()
 {
     m_settings->set<Settings::Core::AutoRefresh>(m_autoRefresh->isChecked());
     m_settings->set<Settings::Core::Internal::MonitorLibraries>(m_monitorLibraries->isChecked());
+    m_settings->set<Settings::Core::Internal::DatabaseTuning>(m_databaseTuning->isChecked());
+    m_settings->set<Settings::Core::Internal::AudioFingerprints>(m_audioFingerprints->isChecked());
+    m_settings->set<Settings::Core::Internal::ExtractCovers>(m_extractCovers->isChecked());
+    m_settings->set<Settings::Core::Internal::ScriptCache>(m_scriptCache->isChecked());
+    m_settings->set<Settings::Core::Internal::ThrottleIdleWork>(m_throttleIdleWork->isChecked());
 
     m_model->processQueue();
 }
@@ -159,6 +220,20 @@ void LibraryGeneralPageWidget::reset()
 {
     m_settings->reset<Settings::Core::AutoRefresh>();
     m_settings->reset<Settings::Core::Internal::MonitorLibraries>();
+    m_settings->reset<Settings::Core::Internal::DatabaseTuning>();
+    m_settings->reset<Settings::Core::Internal::AudioFingerprints>();
+    m_settings->reset<Settings::Core::Internal::ExtractCovers>();
+    m_settings->reset<Settings::Core::Internal::ScriptCache>();
+    m_settings->reset<Settings::Core::Internal::ThrottleIdleWork>();
+}
+
+void LibraryGeneralPageWidget::updateScanMetrics(const ScanMetrics& metrics)
+{
+    QStringList lines{tr("Last scan of %1").arg(metrics.libraryName) + QStringLiteral(":")};
+    lines.append(metrics.summary());
+
+    m_scanMetrics->setText(lines.join(u'\n'));
+    m_scanMetrics->show();
 }
 
 void LibraryGeneralPageWidget::addLibrary() const
@@ -177,6 +252,20 @@ void LibraryGeneralPageWidget::addLibrary() const
     m_model->markForAddition({name, dir});
 }
 
+void LibraryGeneralPageWidget::relocateLibrary(const LibraryInfo& library) const
+{
+    const QString dir = QFileDialog::getExistingDirectory(m_libraryView, tr("Directory"), library.path,
+                                                          QFileDialog::ShowDirsOnly);
+
+    if(dir.isEmpty() || dir == library.path) {
+        return;
+    }
+
+    if(!m_libraryManager->relocateLibrary(library.id, dir)) {
+        qWarning() << QStringLiteral("Library %1 could not be relocated to %2").arg(library.name, dir);
+    }
+}
+
 LibraryGeneralPage::LibraryGeneralPage(ActionManager* actionManager, LibraryManager* libraryManager,
                                        MusicLibrary* library, SettingsManager* settings)
     : SettingsPage{settings->settingsDialog()}
@@ -54,6 +54,20 @@ LibraryModel::LibraryModel(LibraryManager* libraryManager, QObject* parent)
             emit dataChanged({}, {}, {Qt::DisplayRole});
         }
     });
+    QObject::connect(m_libraryManager, &LibraryManager::libraryRelocated, this,
+                     [this](const LibraryInfo& library, const QString& oldPath) {
+                         // Extracting keeps the item in place, so the row pointing to it stays valid
+                         auto node = m_nodes.extract(oldPath);
+                         if(node.empty()) {
+                             return;
+                         }
+                         LibraryInfo info = node.mapped().info();
+                         info.path        = library.path;
+                         node.mapped().changeInfo(info);
+                         node.key() = library.path;
+                         m_nodes.insert(std::move(node));
+                         emit dataChanged({}, {}, {Qt::DisplayRole});
+                     });
 }
 
 void LibraryModel::populate()
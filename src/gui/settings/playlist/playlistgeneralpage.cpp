@@ -50,6 +50,8 @@ private:
     QCheckBox* m_cursorFollowsPlayback;
     QCheckBox* m_playbackFollowsCursor;
     QCheckBox* m_rewindPrevious;
+    QCheckBox* m_perPlaylistQueue;
+    QCheckBox* m_lazyColumns;
 
     QCheckBox* m_scrollBars;
     QCheckBox* m_header;
@@ -65,6 +67,8 @@ PlaylistGeneralPageWidget::PlaylistGeneralPageWidget(SettingsManager* settings)
     , m_cursorFollowsPlayback{new QCheckBox(tr("Cursor follows playback"), this)}
     , m_playbackFollowsCursor{new QCheckBox(tr("Playback follows cursor"), this)}
     , m_rewindPrevious{new QCheckBox(tr("Rewind track on previous"), this)}
+    , m_perPlaylistQueue{new QCheckBox(tr("Separate playback queue for each playlist"), this)}
+    , m_lazyColumns{new QCheckBox(tr("Only evaluate columns of visible tracks"), this)}
     , m_scrollBars{new QCheckBox(tr("Show scrollbar"), this)}
     , m_header{new QCheckBox(tr("Show header"), this)}
     , m_altColours{new QCheckBox(tr("Alternating row colours"), this)}
@@ -77,6 +81,11 @@ PlaylistGeneralPageWidget::PlaylistGeneralPageWidget(SettingsManager* settings)
     m_rewindPrevious->setToolTip(tr(
         "If the current track has been playing for more than 5s, restart it instead of moving to the previous track"));
 
+    m_perPlaylistQueue->setToolTip(tr("Tracks queued from a playlist only play while that playlist is playing"));
+
+    m_lazyColumns->setToolTip(tr("Speeds up loading very large playlists, at the cost of slower scrolling through "
+                                 "parts of the playlist not yet shown"));
+
     m_imagePadding->setMinimum(0);
     m_imagePadding->setMaximum(100);
     m_imagePadding->setSuffix(QStringLiteral("px"));
@@ -91,6 +100,8 @@ PlaylistGeneralPageWidget::PlaylistGeneralPageWidget(SettingsManager* settings)
     behaviourLayout->addWidget(m_cursorFollowsPlayback, 0, 0, 1, 2);
     behaviourLayout->addWidget(m_playbackFollowsCursor, 1, 0, 1, 2);
     behaviourLayout->addWidget(m_rewindPrevious, 2, 0, 1, 2);
+    behaviourLayout->addWidget(m_perPlaylistQueue, 3, 0, 1, 2);
+    behaviourLayout->addWidget(m_lazyColumns, 4, 0, 1, 2);
 
     auto* appearance       = new QGroupBox(tr("Appearance"), this);
     auto* appearanceLayout = new QGridLayout(appearance);
@@ -135,6 +146,8 @@ void PlaylistGeneralPageWidget::load()
     m_cursorFollowsPlayback->setChecked(m_settings->value<Settings::Gui::CursorFollowsPlayback>());
     m_playbackFollowsCursor->setChecked(m_settings->value<Settings::Gui::PlaybackFollowsCursor>());
     m_rewindPrevious->setChecked(m_settings->value<Settings::Core::RewindPreviousTrack>());
+    m_perPlaylistQueue->setChecked(m_settings->value<Settings::Core::PerPlaylistQueue>());
+    m_lazyColumns->setChecked(m_settings->value<Settings::Gui::Internal::PlaylistLazyColumns>());
 
     m_scrollBars->setChecked(m_settings->value<Settings::Gui::Internal::PlaylistScrollBar>());
     m_header->setChecked(m_settings->value<Settings::Gui::Internal::PlaylistHeader>());
@@ -151,6 +164,8 @@ void PlaylistGeneralPageWidget::apply()
     m_settings->set<Settings::Gui::CursorFollowsPlayback>(m_cursorFollowsPlayback->isChecked());
     m_settings->set<Settings::Gui::PlaybackFollowsCursor>(m_playbackFollowsCursor->isChecked());
     m_settings->set<Settings::Core::RewindPreviousTrack>(m_rewindPrevious->isChecked());
+    m_settings->set<Settings::Core::PerPlaylistQueue>(m_perPlaylistQueue->isChecked());
+    m_settings->set<Settings::Gui::Internal::PlaylistLazyColumns>(m_lazyColumns->isChecked());
 
     m_settings->set<Settings::Gui::Internal::PlaylistScrollBar>(m_scrollBars->isChecked());
     m_settings->set<Settings::Gui::Internal::PlaylistHeader>(m_header->isChecked());
@@ -167,6 +182,8 @@ void PlaylistGeneralPageWidget::reset()
     m_settings->reset<Settings::Gui::CursorFollowsPlayback>();
     m_settings->reset<Settings::Gui::PlaybackFollowsCursor>();
     m_settings->reset<Settings::Core::RewindPreviousTrack>();
+    m_settings->reset<Settings::Core::PerPlaylistQueue>();
+    m_settings->reset<Settings::Gui::Internal::PlaylistLazyColumns>();
 
     m_settings->reset<Settings::Gui::Internal::PlaylistScrollBar>();
     m_settings->reset<Settings::Gui::Internal::PlaylistHeader>();
@@ -0,0 +1,94 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gui/trackmimedata.h>
+
+#include <core/library/musiclibrary.h>
+#include <gui/guiconstants.h>
+
+#include <QDataStream>
+#include <QIODevice>
+
+#include <algorithm>
+
+namespace Fooyin {
+TrackMimeData::TrackMimeData(TrackList tracks)
+    : m_tracks{std::move(tracks)}
+{ }
+
+const TrackList& TrackMimeData::tracks() const
+{
+    return m_tracks;
+}
+
+bool TrackMimeData::hasFormat(const QString& mimeType) const
+{
+    return mimeType == QLatin1String{Constants::Mime::TrackIds} || QMimeData::hasFormat(mimeType);
+}
+
+QStringList TrackMimeData::formats() const
+{
+    QStringList formats = QMimeData::formats();
+    formats.append(QString::fromLatin1(Constants::Mime::TrackIds));
+    return formats;
+}
+
+TrackList TrackMimeData::tracksFromMimeData(const QMimeData* data, MusicLibrary* library)
+{
+    if(!data) {
+        return {};
+    }
+
+    if(const auto* trackData = qobject_cast<const TrackMimeData*>(data)) {
+        return trackData->tracks();
+    }
+
+    if(!library) {
+        return {};
+    }
+
+    QByteArray idData = data->data(QString::fromLatin1(Constants::Mime::TrackIds));
+    QDataStream stream(&idData, QIODevice::ReadOnly);
+
+    TrackIds ids;
+    stream >> ids;
+
+    return library->tracksForIds(ids);
+}
+
+QVariant TrackMimeData::retrieveData(const QString& mimeType, QMetaType type) const
+{
+    if(mimeType != QLatin1String{Constants::Mime::TrackIds}) {
+        return QMimeData::retrieveData(mimeType, type);
+    }
+
+    if(m_trackIds.isEmpty()) {
+        TrackIds ids;
+        ids.reserve(m_tracks.size());
+        std::ranges::transform(m_tracks, std::back_inserter(ids), [](const Track& track) { return track.id(); });
+
+        QDataStream stream(&m_trackIds, QIODevice::WriteOnly);
+        stream << ids;
+    }
+
+    return m_trackIds;
+}
+} // namespace Fooyin
+
+#include "moc_trackmimedata.cpp"
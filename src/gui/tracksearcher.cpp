@@ -0,0 +1,163 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <gui/tracksearcher.h>
+
+#include <core/library/musiclibrary.h>
+#include <core/library/trackfilter.h>
+#include <core/library/tracksearchindex.h>
+#include <core/library/tracksnapshot.h>
+#include <utils/async.h>
+
+#include <QTimer>
+
+#include <atomic>
+#include <optional>
+
+// Wait (in ms) after a keystroke for the next before searching
+constexpr auto DefaultDelay = 100;
+
+namespace Fooyin {
+struct TrackSearcher::Private
+{
+    TrackSearcher* self;
+    MusicLibrary* library;
+
+    // Shared with running searches, which give up as soon as it moves on from theirs
+    std::shared_ptr<std::atomic<uint64_t>> generation{std::make_shared<std::atomic<uint64_t>>(0)};
+    QTimer delayTimer;
+    QString search;
+    bool searching{false};
+
+    // The last delivered search, refined when the next one extends it
+    QString lastSearch;
+    TrackList lastResults;
+    TrackSnapshot lastSnapshot;
+
+    Private(TrackSearcher* self_, MusicLibrary* library_)
+        : self{self_}
+        , library{library_}
+    {
+        delayTimer.setSingleShot(true);
+        delayTimer.setInterval(DefaultDelay);
+        QObject::connect(&delayTimer, &QTimer::timeout, self, [this]() { run(); });
+    }
+
+    [[nodiscard]] bool canRefine(const TrackSnapshot& snapshot) const
+    {
+        // Matching is a substring search, so anything matching the new search also matched the old one.
+        // Snapshots share their track list until the library changes.
+        return !lastSearch.isEmpty() && &snapshot.tracks() == &lastSnapshot.tracks()
+            && search.contains(lastSearch, Qt::CaseInsensitive);
+    }
+
+    void run()
+    {
+        const uint64_t id            = generation->fetch_add(1, std::memory_order_relaxed) + 1;
+        const TrackSnapshot snapshot = library->snapshot();
+
+        if(search.isEmpty()) {
+            finish(id, search, snapshot, snapshot.tracks());
+            return;
+        }
+
+        const bool refine = canRefine(snapshot);
+
+        Utils::asyncExec([current = generation, id, search = search, snapshot, refine,
+                          previous = refine ? lastResults : TrackList{},
+                          index = &library->searchIndex()]() -> std::optional<TrackList> {
+            // Skip queries which were superseded while waiting for a thread
+            if(current->load(std::memory_order_relaxed) != id) {
+                return {};
+            }
+            return Filter::filterTracks(refine ? previous : snapshot.tracks(), search, *index);
+        }).then(self, [this, id, search = search, snapshot](std::optional<TrackList> results) {
+            if(results) {
+                finish(id, search, snapshot, *results);
+            }
+        });
+    }
+
+    void finish(uint64_t id, const QString& finishedSearch, const TrackSnapshot& snapshot, const TrackList& results)
+    {
+        if(generation->load(std::memory_order_relaxed) != id) {
+            return;
+        }
+
+        searching    = false;
+        lastSearch   = finishedSearch;
+        lastResults  = results;
+        lastSnapshot = snapshot;
+
+        emit self->searchFinished(finishedSearch, results);
+    }
+};
+
+TrackSearcher::TrackSearcher(MusicLibrary* library, QObject* parent)
+    : QObject{parent}
+    , p{std::make_unique<Private>(this, library)}
+{ }
+
+TrackSearcher::~TrackSearcher()
+{
+    cancel();
+}
+
+QString TrackSearcher::currentSearch() const
+{
+    return p->search;
+}
+
+bool TrackSearcher::isSearching() const
+{
+    return p->searching;
+}
+
+void TrackSearcher::setDelay(int delay)
+{
+    p->delayTimer.setInterval(delay);
+}
+
+void TrackSearcher::search(const QString& search)
+{
+    p->search    = search;
+    p->searching = true;
+
+    // Results of the previous search are no longer wanted, even if it's still running
+    p->generation->fetch_add(1, std::memory_order_relaxed);
+
+    if(search.isEmpty()) {
+        p->delayTimer.stop();
+        p->run();
+    }
+    else {
+        p->delayTimer.start();
+    }
+}
+
+void TrackSearcher::cancel()
+{
+    p->delayTimer.stop();
+    p->generation->fetch_add(1, std::memory_order_relaxed);
+    p->searching = false;
+}
+} // namespace Fooyin
+
+#include "gui/moc_tracksearcher.cpp"
@@ -36,13 +36,53 @@
 #include <QFileInfo>
 #include <QMenu>
 #include <QMenuBar>
+#include <QTimer>
 
-#include <ranges>
+#include <algorithm>
+
+// Selection changes within this many milliseconds are announced together, i.e. about once a frame
+constexpr auto NotifyInterval = 16;
+
+namespace {
+QStringView folderPath(const QString& filepath)
+{
+    const auto separator = filepath.lastIndexOf(u'/');
+    return separator < 0 ? QStringView{} : QStringView{filepath}.left(separator);
+}
+} // namespace
 
 namespace Fooyin {
+TrackSelection::TrackSelection()
+    : m_tracks{std::make_shared<const TrackList>()}
+{ }
+
+TrackSelection::TrackSelection(TrackList tracks)
+    : m_tracks{std::make_shared<const TrackList>(std::move(tracks))}
+{ }
+
+bool TrackSelection::empty() const
+{
+    return m_tracks->empty();
+}
+
+size_t TrackSelection::size() const
+{
+    return m_tracks->size();
+}
+
+Track TrackSelection::front() const
+{
+    return m_tracks->empty() ? Track{} : m_tracks->front();
+}
+
+const TrackList& TrackSelection::tracks() const
+{
+    return *m_tracks;
+}
+
 struct WidgetSelection
 {
-    TrackList tracks;
+    TrackSelection tracks;
     int firstIndex{0};
     QString name{TrackSelectionController::tr("New playlist")};
     bool playbackOnSend{false};
@@ -74,6 +114,8 @@ struct TrackSelectionController::Private
     QAction* openFolder;
     QAction* openProperties;
 
+    QTimer notifyTimer;
+
     Private(TrackSelectionController* self_, ActionManager* actionManager_, SettingsManager* settings_,
             PlaylistController* playlistController_)
         : self{self_}
@@ -130,7 +172,7 @@ struct TrackSelectionController::Private
         QObject::connect(addToQueue, &QAction::triggered, tracksQueueMenu, [this]() {
             if(self->hasTracks()) {
                 const auto& selection = contextSelection.at(activeContext);
-                playlistController->playerController()->queueTracks(selection.tracks);
+                playlistController->playerController()->queueTracks(selection.tracks.tracks());
             }
         });
         tracksQueueMenu->addAction(actionManager->registerAction(addToQueue, Constants::Actions::AddToQueue));
@@ -138,7 +180,7 @@ struct TrackSelectionController::Private
         QObject::connect(removeFromQueue, &QAction::triggered, tracksQueueMenu, [this]() {
             if(self->hasTracks()) {
                 const auto& selection = contextSelection.at(activeContext);
-                playlistController->playerController()->dequeueTracks(selection.tracks);
+                playlistController->playerController()->dequeueTracks(selection.tracks.tracks());
             }
         });
         tracksQueueMenu->addAction(actionManager->registerAction(removeFromQueue, Constants::Actions::RemoveFromQueue));
@@ -160,7 +202,34 @@ struct TrackSelectionController::Private
         tracksMenu->addAction(actionManager->registerAction(openProperties, "TrackSelection.OpenProperties"),
                               Actions::Groups::Three);
 
+        notifyTimer.setSingleShot(true);
+        notifyTimer.setInterval(NotifyInterval);
+        QObject::connect(&notifyTimer, &QTimer::timeout, self, [this]() { notifySelectionChanged(); });
+
+        updateActionState();
+    }
+
+    void notifySelectionChanged()
+    {
         updateActionState();
+        emit self->selectionChanged();
+    }
+
+    // Announces the change once the current burst of changes is over
+    void scheduleNotify()
+    {
+        if(!notifyTimer.isActive()) {
+            notifyTimer.start();
+        }
+    }
+
+    // Announces a pending change now, e.g. before the actions are shown in a menu
+    void flushNotify()
+    {
+        if(notifyTimer.isActive()) {
+            notifyTimer.stop();
+            notifySelectionChanged();
+        }
     }
 
     WidgetContext* contextObject(QWidget* widget) const
@@ -219,8 +288,7 @@ struct TrackSelectionController::Private
                 widgetContext = contextObject(focusedWidget);
                 if(widgetContext) {
                     activeContext = widgetContext;
-                    updateActionState();
-                    QMetaObject::invokeMethod(self, &TrackSelectionController::selectionChanged);
+                    scheduleNotify();
                     return;
                 }
                 focusedWidget = focusedWidget->parentWidget();
@@ -260,7 +328,7 @@ struct TrackSelectionController::Private
             const auto* activePlaylist = playlistHandler->activePlaylist();
 
             if(!activePlaylist || activePlaylist->name() != newName) {
-                auto* playlist = playlistHandler->createPlaylist(newName, selection.tracks);
+                auto* playlist = playlistHandler->createPlaylist(newName, selection.tracks.tracks());
                 handleActions(playlist, options);
                 return;
             }
@@ -274,7 +342,7 @@ struct TrackSelectionController::Private
             }
         }
 
-        auto* playlist = playlistHandler->createPlaylist(newName, selection.tracks);
+        auto* playlist = playlistHandler->createPlaylist(newName, selection.tracks.tracks());
         handleActions(playlist, options);
         emit self->actionExecuted(TrackAction::SendNewPlaylist);
     }
@@ -284,7 +352,7 @@ struct TrackSelectionController::Private
         if(self->hasTracks()) {
             const auto& selection = contextSelection.at(activeContext);
             if(auto* currentPlaylist = playlistController->currentPlaylist()) {
-                playlistHandler->createPlaylist(currentPlaylist->name(), selection.tracks);
+                playlistHandler->createPlaylist(currentPlaylist->name(), selection.tracks.tracks());
                 handleActions(currentPlaylist, options);
                 emit self->actionExecuted(TrackAction::SendCurrentPlaylist);
             }
@@ -296,7 +364,7 @@ struct TrackSelectionController::Private
         if(self->hasTracks()) {
             const auto& selection = contextSelection.at(activeContext);
             if(const auto* playlist = playlistController->currentPlaylist()) {
-                playlistHandler->appendToPlaylist(playlist->id(), selection.tracks);
+                playlistHandler->appendToPlaylist(playlist->id(), selection.tracks.tracks());
                 emit self->actionExecuted(TrackAction::AddCurrentPlaylist);
             }
         }
@@ -307,7 +375,7 @@ struct TrackSelectionController::Private
         if(self->hasTracks()) {
             const auto& selection = contextSelection.at(activeContext);
             if(const auto* playlist = playlistHandler->activePlaylist()) {
-                playlistHandler->appendToPlaylist(playlist->id(), selection.tracks);
+                playlistHandler->appendToPlaylist(playlist->id(), selection.tracks.tracks());
                 emit self->actionExecuted(TrackAction::AddActivePlaylist);
             }
         }
@@ -319,12 +387,12 @@ struct TrackSelectionController::Private
                              && !contextSelection.at(activeContext).tracks.empty();
 
         auto allTracksInSameFolder = [this]() {
-            const auto& selection   = contextSelection.at(activeContext);
-            const QString firstPath = QFileInfo{selection.tracks.front().filepath()}.absolutePath();
-            return std::ranges::all_of(selection.tracks | std::ranges::views::transform([](const Track& track) {
-                                           return QFileInfo{track.filepath()}.absolutePath();
-                                       }),
-                                       [&firstPath](const QString& folderPath) { return folderPath == firstPath; });
+            const TrackList& tracks  = contextSelection.at(activeContext).tracks.tracks();
+            const QString firstPath  = tracks.front().filepath();
+            const QStringView folder = folderPath(firstPath);
+            return std::ranges::all_of(tracks, [folder](const Track& track) {
+                return folderPath(track.filepath()) == folder;
+            });
         };
 
         addCurrent->setEnabled(haveTracks);
@@ -356,15 +424,15 @@ bool TrackSelectionController::hasTracks() const
 
 Track TrackSelectionController::selectedTrack() const
 {
-    const auto selected = selectedTracks();
-    if(!selected.empty()) {
-        return selected.front();
-    }
-
-    return {};
+    return selection().front();
 }
 
 TrackList TrackSelectionController::selectedTracks() const
+{
+    return selection().tracks();
+}
+
+TrackSelection TrackSelectionController::selection() const
 {
     if(!p->activeContext || !p->contextSelection.contains(p->activeContext)) {
         return {};
@@ -385,12 +453,12 @@ void TrackSelectionController::changeSelectedTracks(WidgetContext* context, int
             p->activeContext = context;
         }
 
-        if(std::exchange(selection.tracks, tracks) == tracks) {
+        if(selection.tracks.tracks() == tracks) {
             return;
         }
 
-        p->updateActionState();
-        emit selectionChanged();
+        selection.tracks = TrackSelection{tracks};
+        p->scheduleNotify();
     }
 }
 
@@ -410,16 +478,19 @@ void TrackSelectionController::changePlaybackOnSend(WidgetContext* context, bool
 
 void TrackSelectionController::addTrackContextMenu(QMenu* menu) const
 {
+    p->flushNotify();
     Utils::appendMenuActions(p->tracksMenu->menu(), menu);
 }
 
 void TrackSelectionController::addTrackQueueContextMenu(QMenu* menu) const
 {
+    p->flushNotify();
     Utils::appendMenuActions(p->tracksQueueMenu->menu(), menu);
 }
 
 void TrackSelectionController::addTrackPlaylistContextMenu(QMenu* menu) const
 {
+    p->flushNotify();
     Utils::appendMenuActions(p->tracksPlaylistMenu->menu(), menu);
 }
 
@@ -0,0 +1,273 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spectrogramwidget.h"
+
+#include <QActionGroup>
+#include <QContextMenuEvent>
+#include <QJsonObject>
+#include <QMenu>
+#include <QPainter>
+
+#include <algorithm>
+
+// Overlap between consecutive FFTs offered to the user, in percent
+constexpr std::array Overlaps{0, 50, 75};
+constexpr int DefaultOverlap = 50;
+// Levels at or below this are drawn as the background colour
+constexpr float DisplayFloorDb = -90.0F;
+// Once drawing falls this far behind, e.g. after a pause, it restarts from the present rather than catching up
+constexpr auto MaxBacklog = std::chrono::milliseconds{100};
+
+namespace {
+std::array<QRgb, 256> buildColourMap()
+{
+    struct Stop
+    {
+        double position;
+        QColor colour;
+    };
+    const std::array<Stop, 6> stops{{{0.0, QColor{0, 0, 0}},
+                                     {0.25, QColor{20, 10, 100}},
+                                     {0.45, QColor{120, 20, 140}},
+                                     {0.65, QColor{210, 40, 60}},
+                                     {0.85, QColor{250, 180, 30}},
+                                     {1.0, QColor{255, 255, 230}}}};
+
+    std::array<QRgb, 256> colours{};
+    for(size_t i{0}; i < colours.size(); ++i) {
+        const double position = static_cast<double>(i) / (colours.size() - 1);
+
+        const auto upper = std::find_if(stops.cbegin() + 1, stops.cend() - 1,
+                                        [position](const Stop& stop) { return position <= stop.position; });
+        const auto lower = upper - 1;
+
+        const double t = (position - lower->position) / (upper->position - lower->position);
+        const auto mix = [t](int from, int to) {
+            return static_cast<int>(from + ((to - from) * t));
+        };
+
+        colours[i] = qRgb(mix(lower->colour.red(), upper->colour.red()),
+                          mix(lower->colour.green(), upper->colour.green()),
+                          mix(lower->colour.blue(), upper->colour.blue()));
+    }
+
+    return colours;
+}
+} // namespace
+
+namespace Fooyin {
+SpectrogramWidget::SpectrogramWidget(EngineController* engine, PlayerController* playerController,
+                                     QWidget* parent)
+    : VisualisationWidget{engine, playerController, parent}
+    , m_overlap{DefaultOverlap}
+    , m_colours{buildColourMap()}
+{
+    setMinimumSize(100, 50);
+}
+
+QString SpectrogramWidget::name() const
+{
+    return tr("Spectrogram");
+}
+
+QString SpectrogramWidget::layoutName() const
+{
+    return QStringLiteral("Spectrogram");
+}
+
+void SpectrogramWidget::saveLayoutData(QJsonObject& layout)
+{
+    layout[QStringLiteral("FftSize")] = m_analyser.fftSize();
+    layout[QStringLiteral("Overlap")] = m_overlap;
+}
+
+void SpectrogramWidget::loadLayoutData(const QJsonObject& layout)
+{
+    if(layout.contains(QStringLiteral("FftSize"))) {
+        setFftSize(layout.value(QStringLiteral("FftSize")).toInt());
+    }
+    if(layout.contains(QStringLiteral("Overlap"))) {
+        setOverlap(layout.value(QStringLiteral("Overlap")).toInt());
+    }
+}
+
+bool SpectrogramWidget::updateFrame(const AnalysisTap* tap, AnalysisTap::TimePoint now)
+{
+    if(!tap) {
+        // Leave the image as it is until playback resumes
+        m_nextColumn = {};
+        return false;
+    }
+
+    const int sampleRate = tap->format().sampleRate();
+    if(m_image.isNull() || sampleRate <= 0) {
+        return true;
+    }
+
+    if(m_nextColumn == AnalysisTap::TimePoint{} || now - m_nextColumn > MaxBacklog) {
+        m_nextColumn = now;
+    }
+
+    const auto hop = hopDuration(sampleRate);
+
+    bool drawn{false};
+    while(m_nextColumn <= now) {
+        if(m_analyser.analyse(*tap, m_nextColumn)) {
+            if(m_analyser.sampleRate() != m_rowsSampleRate) {
+                updateRows();
+            }
+            drawColumn();
+            drawn = true;
+        }
+        m_nextColumn += hop;
+    }
+
+    if(drawn) {
+        update();
+    }
+
+    return true;
+}
+
+void SpectrogramWidget::resizeEvent(QResizeEvent* event)
+{
+    VisualisationWidget::resizeEvent(event);
+    resetImage();
+}
+
+void SpectrogramWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    if(m_image.isNull()) {
+        return;
+    }
+
+    QPainter painter{this};
+
+    // The oldest columns run from the write position to the end of the image, the newest from its start
+    const int width  = m_image.width();
+    const int height = m_image.height();
+    painter.drawImage(QPoint{0, 0}, m_image, QRect{m_column, 0, width - m_column, height});
+    if(m_column > 0) {
+        painter.drawImage(QPoint{width - m_column, 0}, m_image, QRect{0, 0, m_column, height});
+    }
+}
+
+void SpectrogramWidget::contextMenuEvent(QContextMenuEvent* event)
+{
+    auto* menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+
+    auto* sizeMenu  = new QMenu(tr("FFT Size"), menu);
+    auto* sizeGroup = new QActionGroup(menu);
+
+    for(const int size : SpectrumAnalyser::FftSizes) {
+        auto* sizeAction = new QAction(QString::number(size), sizeGroup);
+        sizeAction->setCheckable(true);
+        sizeAction->setChecked(size == m_analyser.fftSize());
+        QObject::connect(sizeAction, &QAction::triggered, this, [this, size]() { setFftSize(size); });
+        sizeMenu->addAction(sizeAction);
+    }
+
+    auto* overlapMenu  = new QMenu(tr("Overlap"), menu);
+    auto* overlapGroup = new QActionGroup(menu);
+
+    for(const int overlap : Overlaps) {
+        auto* overlapAction = new QAction(tr("%1%").arg(overlap), overlapGroup);
+        overlapAction->setCheckable(true);
+        overlapAction->setChecked(overlap == m_overlap);
+        QObject::connect(overlapAction, &QAction::triggered, this, [this, overlap]() { setOverlap(overlap); });
+        overlapMenu->addAction(overlapAction);
+    }
+
+    menu->addMenu(sizeMenu);
+    menu->addMenu(overlapMenu);
+    menu->popup(event->globalPos());
+}
+
+void SpectrogramWidget::resetImage()
+{
+    if(width() <= 0 || height() <= 0) {
+        m_image = {};
+        return;
+    }
+
+    m_image = QImage{size(), QImage::Format_RGB32};
+    m_image.fill(m_colours.front());
+    m_column = 0;
+
+    if(m_analyser.sampleRate() > 0) {
+        updateRows();
+    }
+}
+
+void SpectrogramWidget::updateRows()
+{
+    m_rows = m_analyser.bandRanges(m_image.height());
+    std::ranges::reverse(m_rows);
+    m_rowsSampleRate = m_analyser.sampleRate();
+}
+
+void SpectrogramWidget::drawColumn()
+{
+    const auto spectrum = m_analyser.spectrum();
+    const int rowCount  = std::min(static_cast<int>(m_rows.size()), m_image.height());
+    const auto maxIndex = static_cast<float>(m_colours.size() - 1);
+
+    for(int row{0}; row < rowCount; ++row) {
+        const auto [first, last] = m_rows[row];
+        const float level        = *std::max_element(spectrum.begin() + first, spectrum.begin() + last + 1);
+        const float position     = std::clamp((level - DisplayFloorDb) / -DisplayFloorDb, 0.0F, 1.0F);
+
+        auto* line     = reinterpret_cast<QRgb*>(m_image.scanLine(row));
+        line[m_column] = m_colours[static_cast<size_t>(position * maxIndex)];
+    }
+
+    m_column = (m_column + 1) % m_image.width();
+}
+
+void SpectrogramWidget::setFftSize(int size)
+{
+    if(size == m_analyser.fftSize()) {
+        return;
+    }
+
+    m_analyser.setFftSize(size);
+    // Rows map to bins, so are laid out again once the next column is analysed
+    m_rowsSampleRate = 0;
+    m_nextColumn     = {};
+    requestFrames();
+}
+
+void SpectrogramWidget::setOverlap(int percent)
+{
+    m_overlap    = std::clamp(percent, 0, 90);
+    m_nextColumn = {};
+    requestFrames();
+}
+
+AnalysisTap::Clock::duration SpectrogramWidget::hopDuration(int sampleRate) const
+{
+    const int frames = std::max(1, (m_analyser.fftSize() * (100 - m_overlap)) / 100);
+    return std::chrono::duration_cast<AnalysisTap::Clock::duration>(
+        std::chrono::duration<double>{static_cast<double>(frames) / sampleRate});
+}
+} // namespace Fooyin
+
+#include "moc_spectrogramwidget.cpp"
@@ -0,0 +1,74 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "spectrumanalyser.h"
+#include "visualisationwidget.h"
+
+#include <QImage>
+
+#include <array>
+
+namespace Fooyin {
+/*!
+ * A scrolling spectrogram, with time along the x axis, frequency on a log scale along the y axis and
+ * level as colour. One column is drawn per FFT hop, set by the FFT size and overlap.
+ */
+class SpectrogramWidget : public VisualisationWidget
+{
+    Q_OBJECT
+
+public:
+    SpectrogramWidget(EngineController* engine, PlayerController* playerController, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+    void saveLayoutData(QJsonObject& layout) override;
+    void loadLayoutData(const QJsonObject& layout) override;
+
+protected:
+    bool updateFrame(const AnalysisTap* tap, AnalysisTap::TimePoint now) override;
+
+    void resizeEvent(QResizeEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+
+private:
+    void resetImage();
+    void updateRows();
+    void drawColumn();
+    void setFftSize(int size);
+    void setOverlap(int percent);
+    [[nodiscard]] AnalysisTap::Clock::duration hopDuration(int sampleRate) const;
+
+    SpectrumAnalyser m_analyser;
+    int m_overlap;
+    std::array<QRgb, 256> m_colours;
+
+    // Drawn as a ring buffer: m_column is the next column to be written and the oldest shown
+    QImage m_image;
+    int m_column{0};
+    // First and last bin shown by each row of the image, from the top
+    std::vector<std::pair<int, int>> m_rows;
+    int m_rowsSampleRate{0};
+    AnalysisTap::TimePoint m_nextColumn;
+};
+} // namespace Fooyin
@@ -0,0 +1,134 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spectrumanalyser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace Fooyin {
+SpectrumAnalyser::SpectrumAnalyser(int fftSize)
+    : m_fft{fftSize}
+{
+    setFftSize(fftSize);
+}
+
+int SpectrumAnalyser::fftSize() const
+{
+    return m_fft.size();
+}
+
+void SpectrumAnalyser::setFftSize(int size)
+{
+    m_fft = RealFft{std::min(size, AnalysisTap::Capacity)};
+
+    const int points = m_fft.size();
+
+    // Hann window, doubled to make up for the half of the signal it removes on average
+    m_window.resize(points);
+    for(int i{0}; i < points; ++i) {
+        const double phase = (2.0 * std::numbers::pi * i) / (points - 1);
+        m_window[i]        = static_cast<float>(1.0 - std::cos(phase));
+    }
+
+    m_frames.assign(static_cast<size_t>(points) * AnalysisTap::MaxChannels, 0.0F);
+    m_mono.assign(points, 0.0F);
+    m_spectrum.assign(m_fft.binCount(), FloorDb);
+}
+
+int SpectrumAnalyser::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int SpectrumAnalyser::binCount() const
+{
+    return m_fft.binCount();
+}
+
+double SpectrumAnalyser::binFrequency(int bin) const
+{
+    return static_cast<double>(bin) * m_sampleRate / m_fft.size();
+}
+
+std::vector<std::pair<int, int>> SpectrumAnalyser::bandRanges(int count) const
+{
+    std::vector<std::pair<int, int>> ranges;
+    if(count <= 0 || m_sampleRate <= 0) {
+        return ranges;
+    }
+
+    const int lastBin     = m_fft.binCount() - 1;
+    const double binWidth = static_cast<double>(m_sampleRate) / m_fft.size();
+    const double ratio    = std::min(MaxFrequency, m_sampleRate / 2.0) / MinFrequency;
+
+    ranges.reserve(count);
+    for(int i{0}; i < count; ++i) {
+        const double low  = MinFrequency * std::pow(ratio, static_cast<double>(i) / count);
+        const double high = MinFrequency * std::pow(ratio, static_cast<double>(i + 1) / count);
+
+        int first = static_cast<int>(std::ceil(low / binWidth));
+        int last  = static_cast<int>(std::floor(high / binWidth));
+        if(last < first) {
+            first = last = static_cast<int>(std::lround(std::sqrt(low * high) / binWidth));
+        }
+
+        ranges.emplace_back(std::clamp(first, 1, lastBin), std::clamp(last, 1, lastBin));
+    }
+
+    return ranges;
+}
+
+bool SpectrumAnalyser::analyse(const AnalysisTap& tap, AnalysisTap::TimePoint time)
+{
+    const int points         = m_fft.size();
+    const AudioFormat format = tap.read(m_frames, points, time);
+    if(!format.isValid()) {
+        return false;
+    }
+
+    m_sampleRate = format.sampleRate();
+
+    const int channels = format.channelCount();
+    const float scale  = 1.0F / static_cast<float>(channels);
+
+    for(int frame{0}; frame < points; ++frame) {
+        const float* samples = m_frames.data() + (static_cast<size_t>(frame) * channels);
+        float sum{0.0F};
+        for(int channel{0}; channel < channels; ++channel) {
+            sum += samples[channel];
+        }
+        m_mono[frame] = sum * scale * m_window[frame];
+    }
+
+    m_fft.magnitudes(m_mono, m_spectrum);
+
+    for(float& level : m_spectrum) {
+        level = level > 0.0F ? std::max(20.0F * std::log10(level), FloorDb) : FloorDb;
+    }
+
+    return true;
+}
+
+std::span<const float> SpectrumAnalyser::spectrum() const
+{
+    return m_spectrum;
+}
+} // namespace Fooyin
@@ -0,0 +1,84 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/analysistap.h>
+#include <utils/fft.h>
+
+#include <array>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * Turns the audio captured by an AnalysisTap into a spectrum in decibels.
+ * Channels are mixed down to mono and Hann windowed before the transform. All buffers are allocated
+ * when the FFT size is set, so analysing doesn't allocate.
+ */
+class SpectrumAnalyser
+{
+public:
+    static constexpr int DefaultFftSize = 4096;
+    // Level shown for silence
+    static constexpr float FloorDb = -90.0F;
+    // FFT sizes offered to the user
+    static constexpr std::array FftSizes{1024, 2048, 4096, 8192};
+    // Range of frequencies shown, in Hz
+    static constexpr double MinFrequency = 20.0;
+    static constexpr double MaxFrequency = 20000.0;
+
+    explicit SpectrumAnalyser(int fftSize = DefaultFftSize);
+
+    [[nodiscard]] int fftSize() const;
+    void setFftSize(int size);
+
+    /** Returns the sample rate of the last audio analysed, or 0 if there hasn't been any. */
+    [[nodiscard]] int sampleRate() const;
+    [[nodiscard]] int binCount() const;
+    /** Returns the centre frequency of @p bin in Hz. */
+    [[nodiscard]] double binFrequency(int bin) const;
+
+    /*!
+     * Splits MinFrequency to MaxFrequency (or half the sample rate if lower) into @p count logarithmically
+     * spaced bands, returning the first and last bin of each. Bands narrower than a bin use the bin nearest
+     * their centre. Returns nothing until the sample rate is known.
+     */
+    [[nodiscard]] std::vector<std::pair<int, int>> bandRanges(int count) const;
+
+    /*!
+     * Analyses the fftSize() frames heard at @p time.
+     * @returns false if @p tap held no audio, in which case the spectrum is left as it was.
+     */
+    bool analyse(const AnalysisTap& tap, AnalysisTap::TimePoint time);
+
+    /** Returns the level of each bin in dB, no lower than FloorDb. */
+    [[nodiscard]] std::span<const float> spectrum() const;
+
+private:
+    RealFft m_fft;
+    int m_sampleRate{0};
+
+    std::vector<float> m_window;
+    std::vector<float> m_frames;
+    std::vector<float> m_mono;
+    std::vector<float> m_spectrum;
+};
+} // namespace Fooyin
@@ -0,0 +1,188 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "spectrumwidget.h"
+
+#include <QActionGroup>
+#include <QContextMenuEvent>
+#include <QJsonObject>
+#include <QMenu>
+#include <QPainter>
+
+#include <algorithm>
+
+// Width of each band including the gap after it, in pixels
+constexpr int BandWidth = 8;
+constexpr int BandGap   = 2;
+// Levels at or below this are drawn as empty
+constexpr float DisplayFloorDb = -70.0F;
+// How quickly bars and peaks fall, in dB per second
+constexpr float FallRate     = 120.0F;
+constexpr float PeakFallRate = 30.0F;
+// Longest step applied at once, so bars don't vanish after a stall
+constexpr float MaxElapsed = 0.1F;
+
+namespace {
+float displayLevel(float level)
+{
+    return std::clamp((level - DisplayFloorDb) / -DisplayFloorDb, 0.0F, 1.0F);
+}
+} // namespace
+
+namespace Fooyin {
+SpectrumWidget::SpectrumWidget(EngineController* engine, PlayerController* playerController, QWidget* parent)
+    : VisualisationWidget{engine, playerController, parent}
+    , m_lastFrame{AnalysisTap::Clock::now()}
+{
+    setMinimumSize(100, 50);
+}
+
+QString SpectrumWidget::name() const
+{
+    return tr("Spectrum");
+}
+
+QString SpectrumWidget::layoutName() const
+{
+    return QStringLiteral("Spectrum");
+}
+
+void SpectrumWidget::saveLayoutData(QJsonObject& layout)
+{
+    layout[QStringLiteral("FftSize")] = m_analyser.fftSize();
+}
+
+void SpectrumWidget::loadLayoutData(const QJsonObject& layout)
+{
+    if(layout.contains(QStringLiteral("FftSize"))) {
+        setFftSize(layout.value(QStringLiteral("FftSize")).toInt());
+    }
+}
+
+bool SpectrumWidget::updateFrame(const AnalysisTap* tap, AnalysisTap::TimePoint now)
+{
+    const float elapsed = std::clamp(std::chrono::duration<float>(now - m_lastFrame).count(), 0.0F, MaxElapsed);
+    m_lastFrame         = now;
+
+    const bool analysed = tap && m_analyser.analyse(*tap, now);
+    if(analysed && m_analyser.sampleRate() != m_bandSampleRate) {
+        updateBands();
+    }
+
+    const auto spectrum = m_analyser.spectrum();
+
+    bool active{analysed};
+    for(Band& band : m_bands) {
+        float level{SpectrumAnalyser::FloorDb};
+        if(analysed) {
+            level = *std::max_element(spectrum.begin() + band.firstBin, spectrum.begin() + band.lastBin + 1);
+        }
+
+        band.level = std::max(level, band.level - (FallRate * elapsed));
+        band.peak  = std::max(band.level, band.peak - (PeakFallRate * elapsed));
+        active     = active || band.peak > DisplayFloorDb;
+    }
+
+    update();
+    return active;
+}
+
+void SpectrumWidget::resizeEvent(QResizeEvent* event)
+{
+    VisualisationWidget::resizeEvent(event);
+
+    if(m_bandSampleRate > 0) {
+        updateBands();
+    }
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter{this};
+
+    const QColor barColour  = palette().color(QPalette::Highlight);
+    const QColor peakColour = palette().color(QPalette::Text);
+    const int barHeight     = height();
+    const int barWidth      = BandWidth - BandGap;
+
+    int x{(width() - (static_cast<int>(m_bands.size()) * BandWidth)) / 2};
+    for(const Band& band : m_bands) {
+        const int level = static_cast<int>(displayLevel(band.level) * static_cast<float>(barHeight));
+        const int peak  = static_cast<int>(displayLevel(band.peak) * static_cast<float>(barHeight));
+
+        if(level > 0) {
+            painter.fillRect(x, barHeight - level, barWidth, level, barColour);
+        }
+        if(peak > 0) {
+            painter.fillRect(x, barHeight - peak, barWidth, 2, peakColour);
+        }
+
+        x += BandWidth;
+    }
+}
+
+void SpectrumWidget::contextMenuEvent(QContextMenuEvent* event)
+{
+    auto* menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+
+    auto* sizeMenu  = new QMenu(tr("FFT Size"), menu);
+    auto* sizeGroup = new QActionGroup(menu);
+
+    for(const int size : SpectrumAnalyser::FftSizes) {
+        auto* sizeAction = new QAction(QString::number(size), sizeGroup);
+        sizeAction->setCheckable(true);
+        sizeAction->setChecked(size == m_analyser.fftSize());
+        QObject::connect(sizeAction, &QAction::triggered, this, [this, size]() { setFftSize(size); });
+        sizeMenu->addAction(sizeAction);
+    }
+
+    menu->addMenu(sizeMenu);
+    menu->popup(event->globalPos());
+}
+
+void SpectrumWidget::updateBands()
+{
+    const auto ranges = m_analyser.bandRanges(std::max(1, width() / BandWidth));
+
+    // Keep the current levels where possible so a resize doesn't make the bars jump
+    m_bands.resize(ranges.size());
+    for(size_t i{0}; i < ranges.size(); ++i) {
+        m_bands[i].firstBin = ranges[i].first;
+        m_bands[i].lastBin  = ranges[i].second;
+    }
+
+    m_bandSampleRate = m_analyser.sampleRate();
+}
+
+void SpectrumWidget::setFftSize(int size)
+{
+    if(size == m_analyser.fftSize()) {
+        return;
+    }
+
+    m_analyser.setFftSize(size);
+    // Band ranges depend on the FFT size
+    m_bandSampleRate = 0;
+    m_bands.clear();
+    requestFrames();
+}
+} // namespace Fooyin
+
+#include "moc_spectrumwidget.cpp"
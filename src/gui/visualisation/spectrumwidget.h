@@ -0,0 +1,67 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "spectrumanalyser.h"
+#include "visualisationwidget.h"
+
+namespace Fooyin {
+/*!
+ * A spectrum analyser drawing logarithmically spaced frequency bands as bars, with falling peaks.
+ */
+class SpectrumWidget : public VisualisationWidget
+{
+    Q_OBJECT
+
+public:
+    SpectrumWidget(EngineController* engine, PlayerController* playerController, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+    void saveLayoutData(QJsonObject& layout) override;
+    void loadLayoutData(const QJsonObject& layout) override;
+
+protected:
+    bool updateFrame(const AnalysisTap* tap, AnalysisTap::TimePoint now) override;
+
+    void resizeEvent(QResizeEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+
+private:
+    struct Band
+    {
+        int firstBin{0};
+        int lastBin{0};
+        float level{SpectrumAnalyser::FloorDb};
+        float peak{SpectrumAnalyser::FloorDb};
+    };
+
+    void updateBands();
+    void setFftSize(int size);
+
+    SpectrumAnalyser m_analyser;
+    std::vector<Band> m_bands;
+    // The sample rate the bands were laid out for
+    int m_bandSampleRate{0};
+    AnalysisTap::TimePoint m_lastFrame;
+};
+} // namespace Fooyin
@@ -0,0 +1,75 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "visualisationwidget.h"
+
+#include <core/engine/enginecontroller.h>
+#include <core/player/playercontroller.h>
+
+#include <QTimerEvent>
+
+// About 60 frames a second
+constexpr auto FrameInterval = 16;
+
+namespace Fooyin {
+VisualisationWidget::VisualisationWidget(EngineController* engine, PlayerController* playerController,
+                                         QWidget* parent)
+    : FyWidget{parent}
+    , m_engine{engine}
+    , m_playerController{playerController}
+{
+    QObject::connect(m_playerController, &PlayerController::playStateChanged, this, [this]() { requestFrames(); });
+}
+
+void VisualisationWidget::requestFrames()
+{
+    if(isVisible() && !m_frameTimer.isActive()) {
+        m_frameTimer.start(FrameInterval, Qt::PreciseTimer, this);
+    }
+}
+
+void VisualisationWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+    requestFrames();
+}
+
+void VisualisationWidget::hideEvent(QHideEvent* event)
+{
+    m_frameTimer.stop();
+    FyWidget::hideEvent(event);
+}
+
+void VisualisationWidget::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() != m_frameTimer.timerId()) {
+        FyWidget::timerEvent(event);
+        return;
+    }
+
+    const bool playing     = m_playerController->playState() == PlayState::Playing;
+    const AnalysisTap* tap = playing ? m_engine->analysisTap() : nullptr;
+
+    if(!updateFrame(tap, AnalysisTap::Clock::now()) && !playing) {
+        m_frameTimer.stop();
+    }
+}
+} // namespace Fooyin
+
+#include "moc_visualisationwidget.cpp"
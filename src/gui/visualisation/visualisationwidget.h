@@ -0,0 +1,64 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <core/engine/analysistap.h>
+#include <gui/fywidget.h>
+
+#include <QBasicTimer>
+
+namespace Fooyin {
+class EngineController;
+class PlayerController;
+
+/*!
+ * Base for widgets drawing the audio being heard, as captured by the engine's AnalysisTap.
+ *
+ * Frames are only produced while the widget is visible. Once playback stops or pauses the subclass
+ * is shown silence until it has settled, after which no more frames are produced until playback resumes.
+ */
+class VisualisationWidget : public FyWidget
+{
+    Q_OBJECT
+
+public:
+    VisualisationWidget(EngineController* engine, PlayerController* playerController, QWidget* parent = nullptr);
+
+protected:
+    /*!
+     * Updates the visualisation for the audio heard at @p now and schedules a repaint.
+     * @p tap is nullptr while nothing is playing, which should be treated as silence.
+     * @returns false once nothing is left to animate, e.g. all levels have fallen to the floor.
+     */
+    virtual bool updateFrame(const AnalysisTap* tap, AnalysisTap::TimePoint now) = 0;
+
+    /** Starts producing frames again if visible, e.g. after a setting was changed. */
+    void requestFrames();
+
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    EngineController* m_engine;
+    PlayerController* m_playerController;
+    QBasicTimer m_frameTimer;
+};
+} // namespace Fooyin
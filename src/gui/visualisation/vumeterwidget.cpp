@@ -0,0 +1,177 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "vumeterwidget.h"
+
+#include <QLinearGradient>
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Range of levels shown, in dB
+constexpr float FloorDb = -60.0F;
+// Length of audio each reading covers, in seconds
+constexpr double WindowLength = 0.05;
+// How quickly levels fall, in dB per second
+constexpr float FallRate     = 40.0F;
+constexpr float PeakFallRate = 20.0F;
+// How long a peak is held before falling, in seconds
+constexpr float PeakHoldTime = 1.5F;
+// Longest step applied at once, so levels don't vanish after a stall
+constexpr float MaxElapsed = 0.1F;
+// Space between the bar of each channel, in pixels
+constexpr int ChannelGap = 2;
+
+namespace {
+float toDb(float amplitude)
+{
+    return amplitude > 0.0F ? std::max(20.0F * std::log10(amplitude), FloorDb) : FloorDb;
+}
+
+float displayLevel(float level)
+{
+    return std::clamp((level - FloorDb) / -FloorDb, 0.0F, 1.0F);
+}
+} // namespace
+
+namespace Fooyin {
+VuMeterWidget::VuMeterWidget(EngineController* engine, PlayerController* playerController, QWidget* parent)
+    : VisualisationWidget{engine, playerController, parent}
+    , m_frames(static_cast<size_t>(AnalysisTap::Capacity) * AnalysisTap::MaxChannels)
+    , m_channels(2, Channel{FloorDb, FloorDb, FloorDb})
+    , m_lastFrame{AnalysisTap::Clock::now()}
+{
+    setMinimumSize(50, 20);
+}
+
+QString VuMeterWidget::name() const
+{
+    return tr("VU Meter");
+}
+
+QString VuMeterWidget::layoutName() const
+{
+    return QStringLiteral("VuMeter");
+}
+
+bool VuMeterWidget::updateFrame(const AnalysisTap* tap, AnalysisTap::TimePoint now)
+{
+    const float elapsed = std::clamp(std::chrono::duration<float>(now - m_lastFrame).count(), 0.0F, MaxElapsed);
+    m_lastFrame         = now;
+
+    AudioFormat format;
+    int frameCount{0};
+
+    if(tap) {
+        const int sampleRate = tap->format().sampleRate();
+        frameCount = std::clamp(static_cast<int>(sampleRate * WindowLength), 1, AnalysisTap::Capacity);
+        format     = tap->read(m_frames, frameCount, now);
+    }
+
+    const bool analysed = format.isValid();
+    if(analysed && std::cmp_not_equal(m_channels.size(), format.channelCount())) {
+        m_channels.assign(format.channelCount(), Channel{FloorDb, FloorDb, FloorDb});
+    }
+
+    const int channelCount = static_cast<int>(m_channels.size());
+
+    bool active{analysed};
+    for(int i{0}; i < channelCount; ++i) {
+        float rms{FloorDb};
+        float peak{FloorDb};
+
+        if(analysed) {
+            float sum{0.0F};
+            float maximum{0.0F};
+            for(int frame{0}; frame < frameCount; ++frame) {
+                const float sample = m_frames[(static_cast<size_t>(frame) * channelCount) + i];
+                sum += sample * sample;
+                maximum = std::max(maximum, std::abs(sample));
+            }
+            rms  = toDb(std::sqrt(sum / static_cast<float>(frameCount)));
+            peak = toDb(maximum);
+        }
+
+        Channel& channel = m_channels[i];
+        channel.rms      = std::max(rms, channel.rms - (FallRate * elapsed));
+        channel.peak     = std::max(peak, channel.peak - (FallRate * elapsed));
+
+        if(channel.peak >= channel.peakHold) {
+            channel.peakHold = channel.peak;
+            channel.holdTime = PeakHoldTime;
+        }
+        else if(channel.holdTime > 0.0F) {
+            channel.holdTime -= elapsed;
+        }
+        else {
+            channel.peakHold = std::max(channel.peak, channel.peakHold - (PeakFallRate * elapsed));
+        }
+
+        active = active || channel.peakHold > FloorDb;
+    }
+
+    update();
+    return active;
+}
+
+void VuMeterWidget::paintEvent(QPaintEvent* /*event*/)
+{
+    if(m_channels.empty()) {
+        return;
+    }
+
+    QPainter painter{this};
+
+    const int count     = static_cast<int>(m_channels.size());
+    const int barHeight = std::max(1, (height() - ((count - 1) * ChannelGap)) / count);
+    const auto barWidth = static_cast<float>(width());
+
+    QLinearGradient gradient{0, 0, barWidth, 0};
+    gradient.setColorAt(0.0, palette().color(QPalette::Highlight));
+    gradient.setColorAt(0.8, QColor{230, 200, 40});
+    gradient.setColorAt(1.0, QColor{220, 50, 40});
+
+    const QColor peakColour = palette().color(QPalette::Highlight).lighter();
+    const QColor holdColour = palette().color(QPalette::Text);
+
+    int y{0};
+    for(const Channel& channel : m_channels) {
+        const int rms  = static_cast<int>(displayLevel(channel.rms) * barWidth);
+        const int peak = static_cast<int>(displayLevel(channel.peak) * barWidth);
+        const int hold = static_cast<int>(displayLevel(channel.peakHold) * barWidth);
+
+        // Peak drawn faintly behind the RMS level
+        if(peak > rms) {
+            painter.fillRect(rms, y, peak - rms, barHeight, peakColour);
+        }
+        if(rms > 0) {
+            painter.fillRect(0, y, rms, barHeight, gradient);
+        }
+        if(hold > 0) {
+            painter.fillRect(std::max(0, hold - 2), y, 2, barHeight, holdColour);
+        }
+
+        y += barHeight + ChannelGap;
+    }
+}
+} // namespace Fooyin
+
+#include "moc_vumeterwidget.cpp"
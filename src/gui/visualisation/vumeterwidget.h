@@ -0,0 +1,59 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "visualisationwidget.h"
+
+#include <vector>
+
+namespace Fooyin {
+/*!
+ * A level meter showing the RMS and peak level of each channel, with peaks held briefly before falling.
+ */
+class VuMeterWidget : public VisualisationWidget
+{
+    Q_OBJECT
+
+public:
+    VuMeterWidget(EngineController* engine, PlayerController* playerController, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+protected:
+    bool updateFrame(const AnalysisTap* tap, AnalysisTap::TimePoint now) override;
+
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    struct Channel
+    {
+        float rms;
+        float peak;
+        float peakHold;
+        // Seconds left before the held peak starts to fall
+        float holdTime{0.0F};
+    };
+
+    std::vector<float> m_frames;
+    std::vector<Channel> m_channels;
+    AnalysisTap::TimePoint m_lastFrame;
+};
+} // namespace Fooyin
@@ -34,6 +34,8 @@ struct FactoryWidget
     QString key;
     QString name;
     std::function<Fooyin::FyWidget*()> instantiator;
+    // Set for placeholders, see WidgetProvider::registerPlaceholder
+    std::function<void()> loader;
     QStringList subMenus;
     bool isHidden{false};
     int limit{0};
@@ -118,7 +120,7 @@ void WidgetProvider::setCommandStack(QUndoStack* layoutCommands)
 bool WidgetProvider::registerWidget(const QString& key, std::function<FyWidget*()> instantiator,
                                     const QString& displayName)
 {
-    if(p->widgets.contains(key)) {
+    if(p->widgets.contains(key) && !p->widgets.at(key).loader) {
         qDebug() << "Subclass already registered";
         return false;
     }
@@ -128,6 +130,23 @@ bool WidgetProvider::registerWidget(const QString& key, std::function<FyWidget*(
     fw.name         = displayName.isEmpty() ? key : displayName;
     fw.instantiator = std::move(instantiator);
 
+    p->widgets.insert_or_assign(key, fw);
+    return true;
+}
+
+bool WidgetProvider::registerPlaceholder(const QString& key, std::function<void()> loader,
+                                         const QString& displayName)
+{
+    if(p->widgets.contains(key)) {
+        qDebug() << "Subclass already registered";
+        return false;
+    }
+
+    FactoryWidget fw;
+    fw.key    = key;
+    fw.name   = displayName.isEmpty() ? key : displayName;
+    fw.loader = std::move(loader);
+
     p->widgets.emplace(key, fw);
     return true;
 }
@@ -167,6 +186,14 @@ bool WidgetProvider::widgetExists(const QString& key) const
     return p->widgets.contains(key);
 }
 
+QString WidgetProvider::widgetName(const QString& key) const
+{
+    if(!p->widgets.contains(key)) {
+        return key;
+    }
+    return p->widgets.at(key).name;
+}
+
 bool WidgetProvider::canCreateWidget(const QString& key) const
 {
     return p->canCreateWidget(key);
@@ -178,6 +205,14 @@ FyWidget* WidgetProvider::createWidget(const QString& key)
         return nullptr;
     }
 
+    if(const auto loader = p->widgets.at(key).loader) {
+        // Replaces the placeholder with the real widget
+        loader();
+        if(!p->widgets.contains(key) || p->widgets.at(key).loader) {
+            return nullptr;
+        }
+    }
+
     auto& widget = p->widgets.at(key);
 
     if(!widget.instantiator || !p->canCreateWidget(key)) {
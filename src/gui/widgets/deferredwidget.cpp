@@ -0,0 +1,118 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "deferredwidget.h"
+
+#include <gui/widgetcontainer.h>
+#include <gui/widgetprovider.h>
+
+#include <QShowEvent>
+
+#include <utility>
+
+namespace Fooyin {
+DeferredWidget::DeferredWidget(WidgetProvider* widgetProvider, QString key, QWidget* parent)
+    : FyWidget{parent}
+    , m_widgetProvider{widgetProvider}
+    , m_key{std::move(key)}
+    , m_hasId{false}
+    , m_creating{false}
+{
+    setObjectName(DeferredWidget::name());
+}
+
+QString DeferredWidget::name() const
+{
+    return m_widgetProvider->widgetName(m_key);
+}
+
+QString DeferredWidget::layoutName() const
+{
+    return m_key;
+}
+
+void DeferredWidget::saveLayoutData(QJsonObject& layout)
+{
+    for(auto it = m_layout.constBegin(); it != m_layout.constEnd(); ++it) {
+        layout.insert(it.key(), it.value());
+    }
+}
+
+void DeferredWidget::loadLayoutData(const QJsonObject& layout)
+{
+    m_layout = layout;
+
+    // The id has been restored by FyWidget::loadLayout, so is only saved by saveLayout and not saveBaseLayout
+    m_hasId = m_layout.contains(QStringLiteral("ID"));
+    m_layout.remove(QStringLiteral("ID"));
+    setFeature(PersistId, m_hasId);
+}
+
+void DeferredWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+    checkVisible();
+}
+
+void DeferredWidget::resizeEvent(QResizeEvent* event)
+{
+    FyWidget::resizeEvent(event);
+    checkVisible();
+}
+
+void DeferredWidget::checkVisible()
+{
+    if(m_creating || !isVisible() || size().isEmpty()) {
+        return;
+    }
+
+    // Replaced outside of the event, as containers may be laying out their children
+    m_creating = true;
+    QMetaObject::invokeMethod(this, &DeferredWidget::createWidget, Qt::QueuedConnection);
+}
+
+void DeferredWidget::createWidget()
+{
+    auto* container = qobject_cast<WidgetContainer*>(findParent());
+    if(!container) {
+        return;
+    }
+
+    const int index = container->widgetIndex(id());
+    if(index < 0) {
+        return;
+    }
+
+    FyWidget* widget = m_widgetProvider->createWidget(m_key);
+    if(!widget) {
+        return;
+    }
+
+    QJsonObject layout{m_layout};
+    if(m_hasId) {
+        layout[QStringLiteral("ID")] = id().name();
+    }
+    widget->loadLayout(layout);
+
+    container->replaceWidget(index, widget);
+    widget->finalise();
+}
+} // namespace Fooyin
+
+#include "moc_deferredwidget.cpp"
@@ -0,0 +1,61 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <gui/fywidget.h>
+
+#include <QJsonObject>
+
+namespace Fooyin {
+class WidgetProvider;
+
+/*!
+ * Stands in for a widget which isn't visible when its layout is loaded, e.g. a hidden tab or
+ * collapsed splitter child. The real widget is created, and replaces this in its container,
+ * once this is first shown with a non-empty size.
+ * Until then, this saves the layout it was loaded with unchanged.
+ */
+class DeferredWidget : public FyWidget
+{
+    Q_OBJECT
+
+public:
+    DeferredWidget(WidgetProvider* widgetProvider, QString key, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+    void saveLayoutData(QJsonObject& layout) override;
+    void loadLayoutData(const QJsonObject& layout) override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    void checkVisible();
+    void createWidget();
+
+    WidgetProvider* m_widgetProvider;
+    QString m_key;
+    QJsonObject m_layout;
+    bool m_hasId;
+    bool m_creating;
+};
+} // namespace Fooyin
@@ -0,0 +1,147 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "enginestatswidget.h"
+
+#include <core/engine/enginecontroller.h>
+
+#include <QFormLayout>
+#include <QLabel>
+#include <QTimerEvent>
+
+constexpr auto UpdateInterval = 250;
+
+namespace {
+QString formatTime(uint64_t us)
+{
+    return QStringLiteral("%1 ms").arg(static_cast<double>(us) / 1000.0, 0, 'f', 2);
+}
+
+QString formatTimes(uint64_t current, uint64_t max)
+{
+    return QStringLiteral("%1 (max %2)").arg(formatTime(current), formatTime(max));
+}
+
+QString formatAudio(const Fooyin::AudioFormat& format)
+{
+    return QStringLiteral("%1 Hz, %2 bit, %3 ch")
+        .arg(format.sampleRate())
+        .arg(format.bytesPerSample() * 8)
+        .arg(format.channelCount());
+}
+} // namespace
+
+namespace Fooyin {
+EngineStatsWidget::EngineStatsWidget(EngineController* engine, QWidget* parent)
+    : FyWidget{parent}
+    , m_engine{engine}
+    , m_decodeTime{new QLabel(this)}
+    , m_queuedFrames{new QLabel(this)}
+    , m_outputSamples{new QLabel(this)}
+    , m_outputLatency{new QLabel(this)}
+    , m_timerLateness{new QLabel(this)}
+    , m_underruns{new QLabel(this)}
+    , m_outputPath{new QLabel(this)}
+{
+    setObjectName(EngineStatsWidget::name());
+
+    auto* layout = new QFormLayout(this);
+    layout->addRow(tr("Decode time") + QStringLiteral(":"), m_decodeTime);
+    layout->addRow(tr("Render queue") + QStringLiteral(":"), m_queuedFrames);
+    layout->addRow(tr("Output free/queued") + QStringLiteral(":"), m_outputSamples);
+    layout->addRow(tr("Output latency") + QStringLiteral(":"), m_outputLatency);
+    layout->addRow(tr("Timer lateness") + QStringLiteral(":"), m_timerLateness);
+    layout->addRow(tr("Underruns") + QStringLiteral(":"), m_underruns);
+    layout->addRow(tr("Output path") + QStringLiteral(":"), m_outputPath);
+
+    QObject::connect(m_engine, &EngineController::outputPathChanged, this, &EngineStatsWidget::updateOutputPath);
+
+    updateStats();
+    updateOutputPath(m_engine->outputPath());
+}
+
+QString EngineStatsWidget::name() const
+{
+    return tr("Engine Statistics");
+}
+
+QString EngineStatsWidget::layoutName() const
+{
+    return QStringLiteral("EngineStatistics");
+}
+
+void EngineStatsWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+    m_updateTimer.start(UpdateInterval, this);
+}
+
+void EngineStatsWidget::hideEvent(QHideEvent* event)
+{
+    m_updateTimer.stop();
+    FyWidget::hideEvent(event);
+}
+
+void EngineStatsWidget::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == m_updateTimer.timerId()) {
+        updateStats();
+    }
+    FyWidget::timerEvent(event);
+}
+
+void EngineStatsWidget::updateStats()
+{
+    const EngineStats stats = m_engine->engineStats();
+
+    m_decodeTime->setText(formatTimes(stats.decodeTime, stats.maxDecodeTime));
+    m_queuedFrames->setText(tr("%1 frames").arg(stats.queuedFrames));
+    m_outputSamples->setText(QStringLiteral("%1 / %2").arg(stats.outputFreeSamples).arg(stats.outputQueuedSamples));
+    m_outputLatency->setText(formatTime(stats.outputLatency));
+    m_timerLateness->setText(formatTimes(stats.timerLateness, stats.maxTimerLateness));
+
+    QStringList underruns;
+    for(const auto& [output, count] : stats.outputUnderruns) {
+        underruns.append(QStringLiteral("%1: %2").arg(output).arg(count));
+    }
+    m_underruns->setText(underruns.empty() ? QString::number(stats.underruns) : underruns.join(QStringLiteral("\n")));
+}
+
+void EngineStatsWidget::updateOutputPath(const OutputPath& path)
+{
+    if(!path.source.isValid()) {
+        m_outputPath->setText(tr("No track"));
+        return;
+    }
+
+    if(path.bitPerfect()) {
+        m_outputPath->setText(tr("Bit-perfect (%1)").arg(formatAudio(path.source)));
+        return;
+    }
+
+    QString text = QStringLiteral("%1 → %2").arg(formatAudio(path.source), formatAudio(path.output));
+    if(path.conversionForced) {
+        text += QStringLiteral("\n") + tr("Conversion forced: the output doesn't support the source format");
+    }
+    else if(path.processing) {
+        text += QStringLiteral("\n") + tr("Processed by volume, ReplayGain, crossfading or DSPs");
+    }
+    m_outputPath->setText(text);
+}
+} // namespace Fooyin
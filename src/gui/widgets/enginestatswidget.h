@@ -0,0 +1,66 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "gui/fywidget.h"
+
+#include <QBasicTimer>
+
+class QLabel;
+
+namespace Fooyin {
+class EngineController;
+struct OutputPath;
+
+/*!
+ * Debug overlay showing live engine timings, buffer levels and underrun counts.
+ * Only polls the engine while visible.
+ */
+class EngineStatsWidget : public FyWidget
+{
+    Q_OBJECT
+
+public:
+    explicit EngineStatsWidget(EngineController* engine, QWidget* parent = nullptr);
+
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    void updateStats();
+    void updateOutputPath(const OutputPath& path);
+
+    EngineController* m_engine;
+    QBasicTimer m_updateTimer;
+
+    QLabel* m_decodeTime;
+    QLabel* m_queuedFrames;
+    QLabel* m_outputSamples;
+    QLabel* m_outputLatency;
+    QLabel* m_timerLateness;
+    QLabel* m_underruns;
+    QLabel* m_outputPath;
+};
+} // namespace Fooyin
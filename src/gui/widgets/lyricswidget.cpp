@@ -19,33 +19,214 @@
 
 #include "lyricswidget.h"
 
-#include <QJsonObject>
-#include <QTextEdit>
+#include <core/lyrics/lyrics.h>
+#include <core/player/playercontroller.h>
+#include <utils/async.h>
+#include <utils/lrucache.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScrollArea>
+#include <QScrollBar>
+#include <QShowEvent>
 #include <QVBoxLayout>
 
-#include <core/player/playercontroller.h>
+#include <algorithm>
+#include <utility>
+
+// Parsed lyrics kept for tracks played recently
+constexpr size_t LyricsCacheBudget = 4 * 1024 * 1024;
+// Extra space between lines
+constexpr auto LineSpacing = 4;
+// Often enough for the highlighted line to follow the vocals
+constexpr auto PositionInterval = 100;
+
+namespace {
+Fooyin::LruCache<uint64_t, Fooyin::Lyrics>& lyricsCache()
+{
+    static Fooyin::LruCache<uint64_t, Fooyin::Lyrics> cache{LyricsCacheBudget};
+    return cache;
+}
+
+QString embeddedLyrics(const Fooyin::Track& track)
+{
+    QStringList lyrics = track.extraTag(QStringLiteral("LYRICS"));
+    if(lyrics.empty()) {
+        lyrics = track.extraTag(QStringLiteral("UNSYNCEDLYRICS"));
+    }
+    return lyrics.join(u'\n');
+}
+
+// Reads an .lrc file next to the track if there is one, otherwise uses the lyrics embedded in its tags
+Fooyin::Lyrics readLyrics(const QString& filepath, bool inArchive, const QString& embedded)
+{
+    if(!inArchive) {
+        const QFileInfo info{filepath};
+        QFile file{info.dir().filePath(info.completeBaseName() + QStringLiteral(".lrc"))};
+        if(file.open(QIODevice::ReadOnly)) {
+            auto lyrics = Fooyin::Lyrics::parse(QString::fromUtf8(file.readAll()));
+            if(!lyrics.empty()) {
+                return lyrics;
+            }
+        }
+    }
+
+    return Fooyin::Lyrics::parse(embedded);
+}
+} // namespace
 
 namespace Fooyin {
+/*!
+ * Draws the lines of the lyrics, highlighting the current one.
+ * Line positions are laid out once per width, so changing the current line only repaints the two lines
+ * involved, and a paint only draws the lines it touches.
+ */
+class LyricsView : public QWidget
+{
+public:
+    explicit LyricsView(QWidget* parent)
+        : QWidget{parent}
+    { }
+
+    void setLyrics(Lyrics lyrics)
+    {
+        m_lyrics      = std::move(lyrics);
+        m_currentLine = -1;
+        m_layoutWidth = -1;
+        updateLayout();
+        update();
+    }
+
+    [[nodiscard]] const Lyrics& lyrics() const
+    {
+        return m_lyrics;
+    }
+
+    [[nodiscard]] int currentLine() const
+    {
+        return m_currentLine;
+    }
+
+    void setCurrentLine(int line)
+    {
+        if(line == m_currentLine) {
+            return;
+        }
+
+        update(lineRect(std::exchange(m_currentLine, line)));
+        update(lineRect(m_currentLine));
+    }
+
+    [[nodiscard]] QRect lineRect(int line) const
+    {
+        if(line < 0 || std::cmp_greater_equal(line, m_lyrics.lines().size())) {
+            return {};
+        }
+        const auto index = static_cast<size_t>(line);
+        return {0, m_lineTops.at(index), width(), m_lineTops.at(index + 1) - m_lineTops.at(index)};
+    }
+
+protected:
+    void resizeEvent(QResizeEvent* event) override
+    {
+        QWidget::resizeEvent(event);
+        updateLayout();
+    }
+
+    void changeEvent(QEvent* event) override
+    {
+        QWidget::changeEvent(event);
+        if(event->type() == QEvent::FontChange) {
+            m_layoutWidth = -1;
+            updateLayout();
+        }
+    }
+
+    void paintEvent(QPaintEvent* event) override
+    {
+        QPainter painter{this};
+
+        if(m_lyrics.empty()) {
+            painter.setPen(palette().color(QPalette::PlaceholderText));
+            painter.drawText(rect(), Qt::AlignCenter, LyricsWidget::tr("No lyrics"));
+            return;
+        }
+
+        const QRect dirty = event->rect();
+        const auto& lines = m_lyrics.lines();
+
+        // The last line starting at or above the area to repaint
+        const auto firstIt = std::ranges::upper_bound(m_lineTops, dirty.top());
+        const auto first   = std::max<ptrdiff_t>(std::distance(m_lineTops.begin(), firstIt) - 1, 0);
+        auto line          = static_cast<size_t>(first);
+
+        for(; line < lines.size() && m_lineTops.at(line) <= dirty.bottom(); ++line) {
+            const bool current = std::cmp_equal(line, m_currentLine);
+            painter.setPen(palette().color(current ? QPalette::Highlight : QPalette::Text));
+            painter.drawText(lineRect(static_cast<int>(line)).adjusted(0, 0, 0, -LineSpacing),
+                             Qt::AlignHCenter | Qt::TextWordWrap, lines.at(line).text);
+        }
+    }
+
+private:
+    // Works out the top of every line for the current width, wrapping long lines
+    void updateLayout()
+    {
+        if(width() == m_layoutWidth) {
+            return;
+        }
+        m_layoutWidth = width();
+
+        const QFontMetrics metrics{font()};
+        const auto& lines = m_lyrics.lines();
+
+        m_lineTops.assign(1, 0);
+        m_lineTops.reserve(lines.size() + 1);
+
+        for(const Lyrics::Line& line : lines) {
+            const int height = line.text.isEmpty()
+                                 ? metrics.height()
+                                 : metrics.boundingRect(0, 0, m_layoutWidth, 0, Qt::TextWordWrap, line.text).height();
+            m_lineTops.push_back(m_lineTops.back() + height + LineSpacing);
+        }
+
+        setMinimumHeight(m_lineTops.back());
+    }
+
+    Lyrics m_lyrics;
+    // The top of each line, followed by the bottom of the last
+    std::vector<int> m_lineTops{0};
+    int m_currentLine{-1};
+    int m_layoutWidth{-1};
+};
+
 LyricsWidget::LyricsWidget(PlayerController* playerController, QWidget* parent)
     : FyWidget{parent}
     , m_playerController{playerController}
-    , m_lyricsTextArea{new QTextEdit(this)}
+    , m_scrollArea{new QScrollArea(this)}
+    , m_view{new LyricsView(this)}
 {
     setObjectName(LyricsWidget::name());
 
-    m_lyricsTextArea->setAcceptRichText(false);
-    m_lyricsTextArea->setReadOnly(true);
+    m_scrollArea->setWidget(m_view);
+    m_scrollArea->setWidgetResizable(true);
+    m_scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
 
     auto* layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
-    layout->setAlignment(Qt::AlignCenter);
-    layout->addWidget(m_lyricsTextArea);
+    layout->addWidget(m_scrollArea);
+
+    QObject::connect(m_playerController, &PlayerController::currentTrackChanged, this,
+                     [this](const Track& track) { loadLyrics(track); });
+    QObject::connect(m_playerController, &PlayerController::positionChanged, this,
+                     [this](uint64_t position) { updatePosition(position); });
+    QObject::connect(m_playerController, &PlayerController::positionMoved, this,
+                     [this](uint64_t position) { updatePosition(position); });
 
-    QObject::connect(m_playerController, &PlayerController::currentTrackChanged, this, [this]() {
-        auto track = m_playerController->currentTrack();
-        auto lyrics = track.extraTag(QStringLiteral("LYRICS")).join(QStringLiteral(""));
-        m_lyricsTextArea->setText(lyrics);
-    });
+    loadLyrics(m_playerController->currentTrack());
 }
 
 QString LyricsWidget::name() const
@@ -58,4 +239,93 @@ QString LyricsWidget::layoutName() const
     return QStringLiteral("Lyrics");
 }
 
+void LyricsWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+
+    updatePositionRequest();
+}
+
+void LyricsWidget::hideEvent(QHideEvent* event)
+{
+    FyWidget::hideEvent(event);
+
+    m_playerController->releasePositionUpdates(this);
 }
+
+void LyricsWidget::loadLyrics(const Track& track)
+{
+    m_track = track;
+
+    if(!track.isValid()) {
+        setLyrics({});
+        return;
+    }
+
+    if(const Lyrics* lyrics = lyricsCache().find(track.hash())) {
+        setLyrics(*lyrics);
+        updatePosition(m_playerController->currentPosition());
+        return;
+    }
+
+    setLyrics({});
+
+    // Reading a sidecar file means going to disk, which may be slow
+    const QString filepath = track.filepath();
+    const bool inArchive   = track.isInArchive();
+    const QString embedded = embeddedLyrics(track);
+
+    Utils::asyncExec([filepath, inArchive, embedded]() { return readLyrics(filepath, inArchive, embedded); })
+        .then(this, [this, track](const Lyrics& lyrics) {
+            lyricsCache().insert(track.hash(), lyrics, lyrics.cost());
+
+            if(m_track == track) {
+                setLyrics(lyrics);
+                updatePosition(m_playerController->currentPosition());
+            }
+        });
+}
+
+void LyricsWidget::setLyrics(const Lyrics& lyrics)
+{
+    m_view->setLyrics(lyrics);
+    updatePositionRequest();
+}
+
+void LyricsWidget::updatePositionRequest()
+{
+    if(isVisible() && m_view->lyrics().isSynced()) {
+        m_playerController->requestPositionUpdates(this, PositionInterval);
+    }
+    else {
+        m_playerController->releasePositionUpdates(this);
+    }
+}
+
+void LyricsWidget::updatePosition(uint64_t position)
+{
+    const Lyrics& lyrics = m_view->lyrics();
+    if(!lyrics.isSynced()) {
+        return;
+    }
+
+    const int line = lyrics.lineAt(position, m_view->currentLine());
+    if(line != m_view->currentLine()) {
+        m_view->setCurrentLine(line);
+        scrollToLine(line);
+    }
+}
+
+void LyricsWidget::scrollToLine(int line)
+{
+    const QRect rect = m_view->lineRect(line);
+    if(rect.isNull()) {
+        return;
+    }
+
+    // Scrolling moves the view, so only the newly exposed lines are painted
+    m_scrollArea->verticalScrollBar()->setValue(rect.center().y() - (m_scrollArea->viewport()->height() / 2));
+}
+} // namespace Fooyin
+
+#include "moc_lyricswidget.cpp"
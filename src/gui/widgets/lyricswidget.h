@@ -19,25 +19,41 @@
 
 #pragma once
 
-#include "gui/fywidget.h"
+#include <core/track.h>
+#include <gui/fywidget.h>
 
-class QTextEdit;
+class QScrollArea;
 
 namespace Fooyin {
+class Lyrics;
+class LyricsView;
 class PlayerController;
 
 class LyricsWidget : public FyWidget
 {
     Q_OBJECT
+
 public:
     LyricsWidget(PlayerController* playerController, QWidget* parent);
 
-    [[nodiscard]] QString name() const;
-    [[nodiscard]] QString layoutName() const;
+    [[nodiscard]] QString name() const override;
+    [[nodiscard]] QString layoutName() const override;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 private:
-    PlayerController* m_playerController{nullptr};
-    QTextEdit* m_lyricsTextArea{nullptr};
+    void loadLyrics(const Track& track);
+    void setLyrics(const Lyrics& lyrics);
+    // Asks for frequent position updates only while synced lyrics are shown
+    void updatePositionRequest();
+    void updatePosition(uint64_t position);
+    void scrollToLine(int line);
+
+    PlayerController* m_playerController;
+    QScrollArea* m_scrollArea;
+    LyricsView* m_view;
+    Track m_track;
 };
-
 } // namespace Fooyin
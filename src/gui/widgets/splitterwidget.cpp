@@ -27,12 +27,36 @@
 #include <utils/helpers.h>
 #include <utils/settings/settingsmanager.h>
 
+#include <QDataStream>
 #include <QHBoxLayout>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QMenu>
 #include <QSplitter>
 
+// Header written by QSplitter::saveState before the child sizes
+constexpr qint32 SplitterMagic   = 0xff;
+constexpr qint32 SplitterVersion = 1;
+
+namespace {
+QList<int> savedSizes(const QByteArray& state)
+{
+    QDataStream stream{state};
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    qint32 marker{0};
+    qint32 version{0};
+    stream >> marker >> version;
+    if(marker != SplitterMagic || version > SplitterVersion) {
+        return {};
+    }
+
+    QList<int> sizes;
+    stream >> sizes;
+    return stream.status() == QDataStream::Ok ? sizes : QList<int>{};
+}
+} // namespace
+
 namespace Fooyin {
 class SplitterHandle : public QSplitterHandle
 {
@@ -331,7 +355,10 @@ void SplitterWidget::loadLayoutData(const QJsonObject& layout)
     const auto state    = QByteArray::fromBase64(layout[QStringLiteral("State")].toString().toUtf8());
     const auto children = layout[QStringLiteral("Widgets")].toArray();
 
-    WidgetContainer::loadWidgets(children);
+    // Children collapsed in the saved state aren't created until they're expanded
+    const QList<int> sizes = savedSizes(state);
+    WidgetContainer::loadWidgets(children,
+                                 [&sizes](int index) { return index < sizes.size() && sizes.at(index) == 0; });
 
     restoreState(state);
 }
@@ -39,6 +39,8 @@
 #include <QTimer>
 
 constexpr int IconSize = 50;
+// The playing text shows whole seconds at most
+constexpr int PositionInterval = 250;
 
 namespace Fooyin {
 struct StatusWidget::Private
@@ -60,6 +62,7 @@ struct StatusWidget::Private
 
     QString playingScript;
     QString selectionScript;
+    bool playingUsesPosition{false};
 
     QTimer clearTimer;
     QString tempText;
@@ -102,7 +105,9 @@ struct StatusWidget::Private
         QObject::connect(playerController, &PlayerController::playStateChanged, self,
                          [this](PlayState state) { stateChanged(state); });
         QObject::connect(playerController, &PlayerController::positionChanged, self,
-                         [this](uint64_t /*pos*/) { updatePlayingText(); });
+                         [this](uint64_t /*pos*/) { positionChanged(); });
+        QObject::connect(playerController, &PlayerController::streamTitleChanged, self,
+                         [this]() { updatePlayingText(); });
         QObject::connect(selectionController, &TrackSelectionController::selectionChanged, self,
                          [this]() { updateSelectionText(); });
 
@@ -134,6 +139,31 @@ struct StatusWidget::Private
     {
         playingScript   = settings->value<Settings::Gui::Internal::StatusPlayingScript>();
         selectionScript = settings->value<Settings::Gui::Internal::StatusSelectionScript>();
+        updatePlayingDependencies();
+    }
+
+    void updatePlayingDependencies()
+    {
+        playingUsesPosition = scriptParser.parse(playingScript).dependencies.playback;
+        updatePositionRequest();
+    }
+
+    void updatePositionRequest() const
+    {
+        if(playingUsesPosition && self->isVisible()) {
+            playerController->requestPositionUpdates(self, PositionInterval);
+        }
+        else {
+            playerController->releasePositionUpdates(self);
+        }
+    }
+
+    void positionChanged()
+    {
+        // Position ticks arrive many times a second, so only evaluate if the script shows playback state
+        if(playingUsesPosition) {
+            updatePlayingText();
+        }
     }
 
     void updatePlayingText()
@@ -152,7 +182,7 @@ struct StatusWidget::Private
 
     void updateSelectionText()
     {
-        selectionText->setText(scriptParser.evaluate(selectionScript, selectionController->selectedTracks()));
+        selectionText->setText(scriptParser.evaluate(selectionScript, selectionController->selection().tracks()));
     }
 
     void stateChanged(const PlayState state)
@@ -178,13 +208,6 @@ StatusWidget::StatusWidget(PlayerController* playerController, TrackSelectionCon
 {
     setObjectName(StatusWidget::name());
 
-    QObject::connect(playerController, &PlayerController::playStateChanged, this,
-                     [this](PlayState state) { p->stateChanged(state); });
-    QObject::connect(playerController, &PlayerController::positionChanged, this,
-                     [this](uint64_t /*pos*/) { p->updatePlayingText(); });
-    QObject::connect(selectionController, &TrackSelectionController::selectionChanged, this,
-                     [this]() { p->updateSelectionText(); });
-
     settings->subscribe<Settings::Gui::IconTheme>(
         this, [this]() { p->iconLabel->setPixmap(Utils::iconFromTheme(Constants::Icons::Fooyin).pixmap(IconSize)); });
 
@@ -194,6 +217,7 @@ StatusWidget::StatusWidget(PlayerController* playerController, TrackSelectionCon
         this, [this](bool show) { p->selectionText->setHidden(!show); });
     settings->subscribe<Settings::Gui::Internal::StatusPlayingScript>(this, [this](const QString& script) {
         p->playingScript = script;
+        p->updatePlayingDependencies();
         p->updatePlayingText();
     });
     settings->subscribe<Settings::Gui::Internal::StatusSelectionScript>(this, [this](const QString& script) {
@@ -219,6 +243,20 @@ void StatusWidget::libraryScanProgress(int /*id*/, int progress)
     p->updateScanText(progress);
 }
 
+void StatusWidget::showEvent(QShowEvent* event)
+{
+    FyWidget::showEvent(event);
+
+    p->updatePositionRequest();
+}
+
+void StatusWidget::hideEvent(QHideEvent* event)
+{
+    FyWidget::hideEvent(event);
+
+    p->updatePositionRequest();
+}
+
 void StatusWidget::contextMenuEvent(QContextMenuEvent* event)
 {
     auto* menu = new QMenu(this);
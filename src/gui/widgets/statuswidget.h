@@ -46,6 +46,8 @@ public slots:
     void libraryScanProgress(int id, int progress);
 
 protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
     void contextMenuEvent(QContextMenuEvent* event) override;
 
 private:
@@ -19,6 +19,8 @@
 
 #include "tabstackwidget.h"
 
+#include "deferredwidget.h"
+
 #include <core/constants.h>
 #include <gui/widgetprovider.h>
 #include <utils/enum.h>
@@ -96,7 +98,8 @@ void TabStackWidget::loadLayoutData(const QJsonObject& layout)
 
     const auto widgets = layout.value(QStringLiteral("Widgets")).toArray();
 
-    WidgetContainer::loadWidgets(widgets);
+    // Only the first tab is shown once loaded
+    WidgetContainer::loadWidgets(widgets, [](int index) { return index > 0; });
 
     const auto state         = layout.value(QStringLiteral("State")).toString();
     const QStringList titles = state.split(QStringLiteral("\037"));
@@ -223,8 +226,12 @@ void TabStackWidget::replaceWidget(int index, FyWidget* newWidget)
         return;
     }
 
+    // Placeholders keep the title restored from the layout
+    const QString title
+        = qobject_cast<DeferredWidget*>(m_widgets.at(index)) ? m_tabs->tabText(index) : newWidget->name();
+
     m_tabs->removeTab(index);
-    m_tabs->insertTab(index, newWidget, newWidget->name());
+    m_tabs->insertTab(index, newWidget, title);
 
     m_widgets.at(index)->deleteLater();
     m_widgets.erase(m_widgets.begin() + index);
@@ -0,0 +1,126 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "viewpreview.h"
+
+#include <gui/guipaths.h>
+
+#include <QAbstractItemView>
+#include <QDir>
+#include <QEvent>
+#include <QPainter>
+
+#include <cmath>
+#include <utility>
+
+// Stored with the image, as a preview is only valid at the scale it was taken
+constexpr auto DevicePixelRatioKey = "DevicePixelRatio";
+
+namespace {
+QString previewFile(const QString& key)
+{
+    QString filename{key};
+    filename.replace(u'/', u'_');
+    return Fooyin::Gui::previewPath() + filename + QStringLiteral(".png");
+}
+} // namespace
+
+namespace Fooyin {
+ViewPreview::ViewPreview(QImage image, QWidget* viewport)
+    : QWidget{viewport}
+    , m_image{std::move(image)}
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setGeometry(viewport->rect());
+
+    viewport->installEventFilter(this);
+    raise();
+    show();
+}
+
+void ViewPreview::save(const QString& key, QAbstractItemView* view)
+{
+    if(!view || view->viewport()->findChild<ViewPreview*>(Qt::FindDirectChildrenOnly)) {
+        return;
+    }
+
+    QImage image = view->viewport()->grab().toImage();
+    if(image.isNull()) {
+        return;
+    }
+
+    image.setText(QString::fromLatin1(DevicePixelRatioKey), QString::number(image.devicePixelRatio()));
+    image.save(previewFile(key));
+}
+
+ViewPreview* ViewPreview::cover(const QString& key, QAbstractItemView* view)
+{
+    if(!view) {
+        return nullptr;
+    }
+
+    QImage image{previewFile(key)};
+    if(image.isNull()) {
+        return nullptr;
+    }
+
+    const double ratio = image.text(QString::fromLatin1(DevicePixelRatioKey)).toDouble();
+    if(std::abs(ratio - view->devicePixelRatioF()) > 0.01) {
+        return nullptr;
+    }
+    image.setDevicePixelRatio(ratio);
+
+    return new ViewPreview(std::move(image), view->viewport());
+}
+
+bool ViewPreview::exists()
+{
+    return !QDir{Gui::previewPath()}.isEmpty();
+}
+
+void ViewPreview::dismiss()
+{
+    if(auto* viewport = parentWidget()) {
+        viewport->removeEventFilter(this);
+    }
+
+    // Unparented first so save doesn't see this while it's pending deletion
+    hide();
+    setParent(nullptr);
+    deleteLater();
+}
+
+bool ViewPreview::eventFilter(QObject* watched, QEvent* event)
+{
+    if(watched == parentWidget() && event->type() == QEvent::Resize) {
+        setGeometry(parentWidget()->rect());
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void ViewPreview::paintEvent(QPaintEvent* /*event*/)
+{
+    QPainter painter{this};
+    painter.fillRect(rect(), palette().base());
+    painter.drawImage(0, 0, m_image);
+}
+} // namespace Fooyin
+
+#include "moc_viewpreview.cpp"
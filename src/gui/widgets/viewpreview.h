@@ -0,0 +1,64 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QWidget>
+
+class QAbstractItemView;
+
+namespace Fooyin {
+/*!
+ * Covers an item view with an image of what it showed when last closed, until its model is ready.
+ * This lets startup show a familiar window before the library has loaded.
+ *
+ * The preview ignores mouse events, so the view underneath still receives them.
+ */
+class ViewPreview : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * Saves how @p view currently looks as the preview for @p key.
+     * Nothing is saved while @p view is still covered by a preview.
+     */
+    static void save(const QString& key, QAbstractItemView* view);
+    /*!
+     * Covers @p view with the preview saved for @p key.
+     * @returns the preview, or nullptr if there isn't one for the current display.
+     */
+    static ViewPreview* cover(const QString& key, QAbstractItemView* view);
+    /** Returns @c true if a preview has been saved for any view. */
+    [[nodiscard]] static bool exists();
+
+    /** Removes the preview, revealing the view. */
+    void dismiss();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    ViewPreview(QImage image, QWidget* viewport);
+
+    QImage m_image;
+};
+} // namespace Fooyin
@@ -19,6 +19,7 @@
 
 #include <gui/widgetcontainer.h>
 
+#include "widgets/deferredwidget.h"
 #include "widgets/dummy.h"
 
 #include <gui/widgetprovider.h>
@@ -53,8 +54,10 @@ bool WidgetContainer::restoreState(const QByteArray& /*state*/)
     return true;
 }
 
-void WidgetContainer::loadWidgets(const QJsonArray& widgets)
+void WidgetContainer::loadWidgets(const QJsonArray& widgets, const std::function<bool(int index)>& defer)
 {
+    int index{0};
+
     for(const auto& widget : widgets) {
         if(!widget.isObject()) {
             continue;
@@ -70,6 +73,9 @@ void WidgetContainer::loadWidgets(const QJsonArray& widgets)
             currentIsMissing = true;
             childWidget      = new Dummy(widgetName, m_settings, this);
         }
+        else if(defer && widgetName != u"Dummy" && defer(index)) {
+            childWidget = new DeferredWidget(m_widgetProvider, widgetName, this);
+        }
         else {
             childWidget = m_widgetProvider->createWidget(widgetName);
         }
@@ -96,6 +102,7 @@ void WidgetContainer::loadWidgets(const QJsonArray& widgets)
 
             addWidget(childWidget);
             childWidget->finalise();
+            ++index;
         }
     }
 }
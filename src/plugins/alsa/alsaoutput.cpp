@@ -19,10 +19,25 @@
 
 #include "alsaoutput.h"
 
+#include <core/engine/audioconverter.h>
+
 #include <alsa/asoundlib.h>
 
 #include <QDebug>
 
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
 namespace {
 bool checkError(int error, const QString& message)
 {
@@ -38,32 +53,6 @@ void printError(const QString& message)
     qWarning() << QStringLiteral("[ALSA] %1").arg(message);
 }
 
-bool formatSupported(snd_pcm_format_t requestedFormat, snd_pcm_hw_params_t* hwParams)
-{
-    if(requestedFormat < 0) {
-        return false;
-    }
-
-    snd_pcm_format_mask_t* mask;
-    snd_pcm_format_mask_alloca(&mask);
-    snd_pcm_hw_params_get_format_mask(hwParams, mask);
-    const bool isSupported = snd_pcm_format_mask_test(mask, requestedFormat);
-    QStringList supportedFormats;
-
-    for(int format = 0; format <= SND_PCM_FORMAT_LAST; ++format) {
-        if(snd_pcm_format_mask_test(mask, snd_pcm_format_t(format))) {
-            supportedFormats.emplace_back(QString::fromLatin1(snd_pcm_format_name(snd_pcm_format_t(format))));
-        }
-    }
-
-    if(!isSupported) {
-        qInfo() << "[ALSA] Format not supported: " << snd_pcm_format_name(requestedFormat);
-        qInfo() << "[ALSA] Supported formats: " << supportedFormats.join(QStringLiteral(", "));
-    }
-
-    return isSupported;
-}
-
 snd_pcm_format_t findAlsaFormat(Fooyin::SampleFormat format)
 {
     switch(format) {
@@ -82,6 +71,188 @@ snd_pcm_format_t findAlsaFormat(Fooyin::SampleFormat format)
     }
 }
 
+Fooyin::SampleFormat findSampleFormat(snd_pcm_format_t format)
+{
+    switch(format) {
+        case(SND_PCM_FORMAT_U8):
+            return Fooyin::SampleFormat::U8;
+        case(SND_PCM_FORMAT_S16):
+            return Fooyin::SampleFormat::S16;
+        case(SND_PCM_FORMAT_S32):
+            return Fooyin::SampleFormat::S32;
+        case(SND_PCM_FORMAT_FLOAT):
+            return Fooyin::SampleFormat::Float;
+        default:
+            return Fooyin::SampleFormat::Unknown;
+    }
+}
+
+/*!
+ * The hardware parameter ranges a device reported when first opened.
+ * Kept for the lifetime of the process so reinitialising for each format change doesn't re-query the device.
+ */
+struct DeviceCaps
+{
+    std::bitset<SND_PCM_FORMAT_LAST + 1> formats;
+    uint32_t minRate{0};
+    uint32_t maxRate{0};
+    uint32_t minChannels{0};
+    uint32_t maxChannels{0};
+    snd_pcm_uframes_t maxBufferSize{0};
+    bool pausable{false};
+    bool mmap{false};
+
+    [[nodiscard]] bool supports(snd_pcm_format_t format) const
+    {
+        return format >= 0 && formats.test(static_cast<size_t>(format));
+    }
+
+    [[nodiscard]] QString formatNames() const
+    {
+        QStringList names;
+        for(size_t format{0}; format < formats.size(); ++format) {
+            if(formats.test(format)) {
+                names.emplace_back(QString::fromLatin1(snd_pcm_format_name(static_cast<snd_pcm_format_t>(format))));
+            }
+        }
+        return names.join(QStringLiteral(", "));
+    }
+
+    static DeviceCaps probe(snd_pcm_t* handle, snd_pcm_hw_params_t* hwParams)
+    {
+        DeviceCaps caps;
+
+        snd_pcm_format_mask_t* mask;
+        snd_pcm_format_mask_alloca(&mask);
+        snd_pcm_hw_params_get_format_mask(hwParams, mask);
+
+        for(size_t format{0}; format < caps.formats.size(); ++format) {
+            caps.formats.set(format, snd_pcm_format_mask_test(mask, static_cast<snd_pcm_format_t>(format)));
+        }
+
+        snd_pcm_hw_params_get_rate_min(hwParams, &caps.minRate, nullptr);
+        snd_pcm_hw_params_get_rate_max(hwParams, &caps.maxRate, nullptr);
+        snd_pcm_hw_params_get_channels_min(hwParams, &caps.minChannels);
+        snd_pcm_hw_params_get_channels_max(hwParams, &caps.maxChannels);
+        snd_pcm_hw_params_get_buffer_size_max(hwParams, &caps.maxBufferSize);
+
+        caps.pausable = snd_pcm_hw_params_can_pause(hwParams);
+        caps.mmap     = snd_pcm_hw_params_test_access(handle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+
+        return caps;
+    }
+
+    /*!
+     * Returns the format closest to @p format which the device can play natively,
+     * or an invalid format if the sample rate isn't supported.
+     */
+    [[nodiscard]] Fooyin::AudioFormat closestFormat(const Fooyin::AudioFormat& format) const
+    {
+        using Fooyin::SampleFormat;
+
+        const auto rate = static_cast<uint32_t>(format.sampleRate());
+        if(rate < minRate || rate > maxRate) {
+            return {};
+        }
+
+        // Preferred fallbacks for each format, losing as little precision as possible
+        std::vector<SampleFormat> candidates;
+        switch(format.sampleFormat()) {
+            case(SampleFormat::U8):
+                candidates = {SampleFormat::U8, SampleFormat::S16, SampleFormat::S32, SampleFormat::Float};
+                break;
+            case(SampleFormat::S16):
+                candidates = {SampleFormat::S16, SampleFormat::S32, SampleFormat::Float, SampleFormat::U8};
+                break;
+            case(SampleFormat::S24):
+            case(SampleFormat::S32):
+                candidates = {SampleFormat::S32, SampleFormat::Float, SampleFormat::S16, SampleFormat::U8};
+                break;
+            case(SampleFormat::Float):
+                candidates = {SampleFormat::Float, SampleFormat::S32, SampleFormat::S16, SampleFormat::U8};
+                break;
+            case(SampleFormat::Unknown):
+            default:
+                return {};
+        }
+
+        const auto native = std::ranges::find_if(
+            candidates, [this](SampleFormat candidate) { return supports(findAlsaFormat(candidate)); });
+        if(native == candidates.cend()) {
+            return {};
+        }
+
+        // Keep S24 as is when the device takes S32, since it's already stored in 32 bits
+        const SampleFormat sampleFormat
+            = format.sampleFormat() == SampleFormat::S24 && *native == SampleFormat::S32 ? SampleFormat::S24 : *native;
+        const auto channels
+            = static_cast<int>(std::clamp(static_cast<uint32_t>(format.channelCount()), minChannels, maxChannels));
+
+        return {sampleFormat, format.sampleRate(), channels};
+    }
+};
+
+// Cards are identified by index, so any change to the set of indices means a device was added or removed
+std::vector<int> availableCards()
+{
+    std::vector<int> cards;
+
+    int card{-1};
+    while(snd_card_next(&card) == 0 && card >= 0) {
+        cards.push_back(card);
+    }
+
+    return cards;
+}
+
+class DeviceCapsCache
+{
+public:
+    static DeviceCapsCache& instance()
+    {
+        static DeviceCapsCache cache;
+        return cache;
+    }
+
+    std::optional<DeviceCaps> find(const QString& device)
+    {
+        const std::scoped_lock lock{m_mutex};
+
+        checkHotplug();
+
+        if(const auto it = m_caps.find(device); it != m_caps.cend()) {
+            return it->second;
+        }
+        return {};
+    }
+
+    void insert(const QString& device, const DeviceCaps& caps)
+    {
+        const std::scoped_lock lock{m_mutex};
+        m_caps[device] = caps;
+    }
+
+    void remove(const QString& device)
+    {
+        const std::scoped_lock lock{m_mutex};
+        m_caps.erase(device);
+    }
+
+private:
+    void checkHotplug()
+    {
+        auto cards = availableCards();
+        if(cards != m_cards) {
+            m_cards = std::move(cards);
+            m_caps.clear();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::vector<int> m_cards;
+    std::map<QString, DeviceCaps> m_caps;
+};
+
 struct DeviceHint
 {
     void** hints{nullptr};
@@ -235,7 +406,12 @@ struct AlsaOutput::Private
 {
     AlsaOutput* self;
 
+    AlsaConfig config;
     AudioFormat format;
+    // The format written to the device, which differs from format if the device can't play it natively
+    AudioFormat deviceFormat;
+    // mmap mode: holds audio from the source before it's converted into the device's format
+    std::vector<std::byte> convertBuffer;
 
     bool initialised{false};
 
@@ -243,16 +419,28 @@ struct AlsaOutput::Private
     snd_pcm_uframes_t bufferSize{8192};
     snd_pcm_uframes_t periodSize{1024};
     bool pausable{true};
-    double volume{1.0};
+    std::atomic<double> volume{1.0};
     QString device{QStringLiteral("default")};
-    bool started{false};
+    std::atomic<bool> started{false};
+
+    // mmap mode
+    bool mmapActive{false};
+    std::atomic<AudioSource*> source{nullptr};
+    std::thread renderThread;
+    std::atomic<bool> stopThread{false};
+    int wakeFd{-1};
 
-    explicit Private(AlsaOutput* self_)
+    explicit Private(AlsaOutput* self_, const AlsaConfig& config_)
         : self{self_}
+        , config{config_}
+        , bufferSize{static_cast<snd_pcm_uframes_t>(std::max(config.bufferSize, 1))}
+        , periodSize{static_cast<snd_pcm_uframes_t>(std::max(config.periodSize, 1))}
     { }
 
     void reset()
     {
+        stopRenderThread();
+
         if(pcmHandle) {
             snd_pcm_drain(pcmHandle.get());
             snd_pcm_drop(pcmHandle.get());
@@ -261,13 +449,45 @@ struct AlsaOutput::Private
         started = false;
     }
 
+    // Returns false if the device has no native format close enough to the requested one
+    bool selectFormat(const DeviceCaps& caps)
+    {
+        deviceFormat = caps.closestFormat(format);
+
+        if(!deviceFormat.isValid()) {
+            printError(QStringLiteral("Format not supported: %1 Hz, %2")
+                           .arg(format.sampleRate())
+                           .arg(QString::fromLatin1(snd_pcm_format_name(findAlsaFormat(format.sampleFormat())))));
+            printError(QStringLiteral("Supported formats: %1 (%2-%3 Hz)")
+                           .arg(caps.formatNames())
+                           .arg(caps.minRate)
+                           .arg(caps.maxRate));
+            return false;
+        }
+
+        if(deviceFormat != format) {
+            qInfo() << "[ALSA] Converting to the closest supported format:"
+                    << snd_pcm_format_name(findAlsaFormat(deviceFormat.sampleFormat())) << deviceFormat.channelCount()
+                    << "channels";
+        }
+
+        return true;
+    }
+
     bool initAlsa()
     {
+        // Devices we've opened before can be checked without reopening them
+        std::optional<DeviceCaps> caps = DeviceCapsCache::instance().find(device);
+        if(caps && !selectFormat(*caps)) {
+            return false;
+        }
+
         int err{-1};
         {
             snd_pcm_t* rawHandle;
             err = snd_pcm_open(&rawHandle, device.toLocal8Bit().constData(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
             if(checkError(err, QStringLiteral("Failed to open device"))) {
+                DeviceCapsCache::instance().remove(device);
                 return false;
             }
             pcmHandle = {rawHandle, PcmHandleDeleter()};
@@ -282,49 +502,51 @@ struct AlsaOutput::Private
             return false;
         }
 
-        pausable = snd_pcm_hw_params_can_pause(hwParams);
+        if(!caps) {
+            caps = DeviceCaps::probe(handle, hwParams);
+            DeviceCapsCache::instance().insert(device, *caps);
 
-        err = snd_pcm_hw_params_set_access(handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED);
-        if(checkError(err, QStringLiteral("Failed to set access mode"))) {
-            return false;
+            if(!selectFormat(*caps)) {
+                return false;
+            }
         }
 
-        const snd_pcm_format_t alsaFormat = findAlsaFormat(format.sampleFormat());
-        if(checkError(alsaFormat, QStringLiteral("Format not supported"))) {
-            return false;
+        pausable = caps->pausable;
+
+        mmapActive = false;
+        if(config.mmap && caps->mmap) {
+            err        = snd_pcm_hw_params_set_access(handle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+            mmapActive = !checkError(err, QStringLiteral("mmap access unavailable, falling back to read/write"));
+        }
+        else if(config.mmap) {
+            printError(QStringLiteral("mmap access unavailable, falling back to read/write"));
         }
 
-        // TODO: Handle resampling
-        if(!formatSupported(alsaFormat, hwParams)) {
-            return false;
+        if(!mmapActive) {
+            err = snd_pcm_hw_params_set_access(handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED);
+            if(checkError(err, QStringLiteral("Failed to set access mode"))) {
+                return false;
+            }
         }
 
-        err = snd_pcm_hw_params_set_format(handle, hwParams, alsaFormat);
+        err = snd_pcm_hw_params_set_format(handle, hwParams, findAlsaFormat(deviceFormat.sampleFormat()));
         if(checkError(err, QStringLiteral("Failed to set audio format"))) {
             return false;
         }
 
-        const auto sampleRate = static_cast<uint32_t>(format.sampleRate());
+        const auto sampleRate = static_cast<uint32_t>(deviceFormat.sampleRate());
 
         err = snd_pcm_hw_params_set_rate(handle, hwParams, sampleRate, 0);
         if(checkError(err, QStringLiteral("Failed to set sample rate"))) {
             return false;
         }
 
-        uint32_t channelCount = format.channelCount();
-
-        err = snd_pcm_hw_params_set_channels_near(handle, hwParams, &channelCount);
+        err = snd_pcm_hw_params_set_channels(handle, hwParams, static_cast<uint32_t>(deviceFormat.channelCount()));
         if(checkError(err, QStringLiteral("Failed to set channel count"))) {
             return false;
         }
 
-        snd_pcm_uframes_t maxBufferSize;
-        err = snd_pcm_hw_params_get_buffer_size_max(hwParams, &maxBufferSize);
-        if(checkError(err, QStringLiteral("Unable to get max buffer size"))) {
-            return false;
-        }
-
-        bufferSize = std::min(bufferSize, maxBufferSize);
+        bufferSize = std::min(bufferSize, caps->maxBufferSize);
         err        = snd_pcm_hw_params_set_buffer_size_near(handle, hwParams, &bufferSize);
         if(checkError(err, QStringLiteral("Unable to set buffer size"))) {
             return false;
@@ -375,6 +597,12 @@ struct AlsaOutput::Private
             return false;
         }
 
+        // Only wake the render thread once a full period can be written
+        err = snd_pcm_sw_params_set_avail_min(handle, swParams, periodSize);
+        if(checkError(err, QStringLiteral("Unable to set minimum available count"))) {
+            return false;
+        }
+
         err = snd_pcm_sw_params(handle, swParams);
         if(checkError(err, QStringLiteral("Failed to apply software parameters"))) {
             return false;
@@ -445,6 +673,7 @@ struct AlsaOutput::Private
                 case(SND_PCM_STATE_SETUP):
                 default:
                     printError(QStringLiteral("Device lost. Stopping playback."));
+                    DeviceCapsCache::instance().remove(device);
                     QMetaObject::invokeMethod(self, [this]() { emit self->stateChanged(State::Disconnected); });
                     return false;
             }
@@ -479,10 +708,185 @@ struct AlsaOutput::Private
 
         return recovered;
     }
+
+    void startRenderThread()
+    {
+        wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if(wakeFd < 0) {
+            printError(QStringLiteral("Unable to create wakeup descriptor"));
+            return;
+        }
+
+        stopThread.store(false, std::memory_order_relaxed);
+        renderThread = std::thread{[this]() { renderLoop(); }};
+    }
+
+    void stopRenderThread()
+    {
+        if(renderThread.joinable()) {
+            stopThread.store(true, std::memory_order_release);
+            const uint64_t value{1};
+            [[maybe_unused]] const auto written = ::write(wakeFd, &value, sizeof(value));
+            renderThread.join();
+        }
+
+        if(wakeFd >= 0) {
+            ::close(wakeFd);
+            wakeFd = -1;
+        }
+    }
+
+    void renderLoop()
+    {
+        snd_pcm_t* handle = pcmHandle.get();
+
+        const int pcmCount = snd_pcm_poll_descriptors_count(handle);
+        if(pcmCount <= 0) {
+            printError(QStringLiteral("Unable to get poll descriptors"));
+            return;
+        }
+
+        // The first descriptor is our wakeup eventfd, the rest belong to the device
+        std::vector<pollfd> fds(static_cast<size_t>(pcmCount) + 1);
+        fds[0] = {.fd = wakeFd, .events = POLLIN, .revents = 0};
+        snd_pcm_poll_descriptors(handle, fds.data() + 1, static_cast<unsigned int>(pcmCount));
+
+        const auto periodMs = static_cast<int>(periodSize * 1000 / std::max(format.sampleRate(), 1));
+        bool idle{false};
+
+        while(!stopThread.load(std::memory_order_acquire)) {
+            // With no data from the source the device stays writable, so fall back to a period-length timeout
+            const auto count = static_cast<nfds_t>(idle ? 1 : fds.size());
+            const int ret    = ::poll(fds.data(), count, idle ? std::max(periodMs, 1) : -1);
+            if(ret < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                printError(QStringLiteral("Poll failed"));
+                break;
+            }
+
+            if(fds[0].revents & POLLIN) {
+                uint64_t value;
+                [[maybe_unused]] const auto bytesRead = ::read(wakeFd, &value, sizeof(value));
+                continue;
+            }
+
+            if(!idle) {
+                unsigned short revents{0};
+                snd_pcm_poll_descriptors_revents(handle, fds.data() + 1, static_cast<unsigned int>(pcmCount),
+                                                 &revents);
+                if(revents & POLLERR) {
+                    recoverMmap(-EPIPE);
+                }
+                else if(!(revents & POLLOUT)) {
+                    continue;
+                }
+            }
+
+            idle = !fillBuffer();
+        }
+    }
+
+    // Returns false if the source had nothing to give
+    bool fillBuffer()
+    {
+        snd_pcm_t* handle = pcmHandle.get();
+
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if(avail < 0) {
+            recoverMmap(static_cast<int>(avail));
+            return true;
+        }
+
+        auto* audioSource = source.load(std::memory_order_acquire);
+        if(!audioSource) {
+            return false;
+        }
+
+        const double gain = volume.load(std::memory_order_relaxed);
+        bool wrote{false};
+
+        while(avail > 0) {
+            const snd_pcm_channel_area_t* areas{nullptr};
+            snd_pcm_uframes_t offset{0};
+            auto frames = static_cast<snd_pcm_uframes_t>(avail);
+
+            int err = snd_pcm_mmap_begin(handle, &areas, &offset, &frames);
+            if(err < 0) {
+                recoverMmap(err);
+                return true;
+            }
+
+            // Interleaved, so every channel shares the first area
+            auto* dst = static_cast<std::byte*>(areas[0].addr) + (areas[0].first + (offset * areas[0].step)) / 8;
+
+            int read{0};
+            if(convertBuffer.empty()) {
+                read = audioSource->readFrames(dst, static_cast<int>(frames));
+            }
+            else {
+                const auto stride = static_cast<size_t>(format.bytesPerFrame());
+                frames            = std::min(frames, static_cast<snd_pcm_uframes_t>(convertBuffer.size() / stride));
+                read              = audioSource->readFrames(convertBuffer.data(), static_cast<int>(frames));
+                Audio::convert(format, convertBuffer.data(), deviceFormat, dst, read);
+            }
+            Audio::scale(deviceFormat, dst, read, gain);
+
+            const auto committed = snd_pcm_mmap_commit(handle, offset, static_cast<snd_pcm_uframes_t>(read));
+            if(committed < 0 || committed != read) {
+                recoverMmap(committed < 0 ? static_cast<int>(committed) : -EPIPE);
+                return true;
+            }
+
+            if(read <= 0) {
+                break;
+            }
+
+            wrote = true;
+            avail -= read;
+
+            if(static_cast<snd_pcm_uframes_t>(read) < frames) {
+                break;
+            }
+        }
+
+        return wrote;
+    }
+
+    void recoverMmap(int error)
+    {
+        if(checkError(snd_pcm_recover(pcmHandle.get(), error, 1), QStringLiteral("Unable to recover from xrun"))) {
+            QMetaObject::invokeMethod(self, [this]() { emit self->stateChanged(State::Disconnected); });
+            stopThread.store(true, std::memory_order_release);
+            return;
+        }
+
+        if(started) {
+            snd_pcm_start(pcmHandle.get());
+        }
+    }
+
+    // Returns the delay (in seconds) of the device, or a negative value if it can't be queried
+    [[nodiscard]] double deviceDelay() const
+    {
+        snd_pcm_sframes_t delay{0};
+        if(!pcmHandle || format.sampleRate() <= 0 || snd_pcm_delay(pcmHandle.get(), &delay) < 0) {
+            return -1.0;
+        }
+        return static_cast<double>(std::max(delay, 0L)) / static_cast<double>(format.sampleRate());
+    }
+
+    void mmapState(OutputState* state) const
+    {
+        // Recovery is left to the render thread; nothing is queued on our side
+        state->delay       = std::max(deviceDelay(), 0.0);
+        state->freeSamples = static_cast<int>(bufferSize);
+    }
 };
 
-AlsaOutput::AlsaOutput()
-    : p{std::make_unique<Private>(this)}
+AlsaOutput::AlsaOutput(const AlsaConfig& config)
+    : p{std::make_unique<Private>(this, config)}
 { }
 
 AlsaOutput::~AlsaOutput()
@@ -499,6 +903,15 @@ bool AlsaOutput::init(const AudioFormat& format)
         return false;
     }
 
+    p->convertBuffer.clear();
+    if(p->mmapActive && p->deviceFormat != format) {
+        p->convertBuffer.resize(static_cast<size_t>(format.bytesForFrames(static_cast<int>(p->bufferSize))));
+    }
+
+    if(p->mmapActive) {
+        p->startRenderThread();
+    }
+
     p->initialised = true;
     return true;
 }
@@ -511,11 +924,19 @@ void AlsaOutput::uninit()
 
 void AlsaOutput::reset()
 {
+    // The render thread will resume polling once the device has been prepared again
+    const bool restart = p->renderThread.joinable();
+    p->stopRenderThread();
+
     checkError(snd_pcm_drop(p->pcmHandle.get()), QStringLiteral("ALSA drop error"));
     checkError(snd_pcm_prepare(p->pcmHandle.get()), QStringLiteral("ALSA prepare error"));
 
     p->started = false;
     p->recoverState();
+
+    if(restart) {
+        p->startRenderThread();
+    }
 }
 
 void AlsaOutput::start()
@@ -543,11 +964,22 @@ OutputState AlsaOutput::currentState()
 {
     OutputState state;
 
+    if(p->mmapActive) {
+        p->mmapState(&state);
+        return state;
+    }
+
     p->recoverState(&state);
 
     return state;
 }
 
+double AlsaOutput::latency() const
+{
+    // Only asked for while pulling, from the mmap thread which owns the handle
+    return p->mmapActive ? p->deviceDelay() : -1.0;
+}
+
 OutputDevices AlsaOutput::getAllDevices() const
 {
     OutputDevices devices;
@@ -558,6 +990,11 @@ OutputDevices AlsaOutput::getAllDevices() const
     return devices;
 }
 
+AudioOutput::Capabilities AlsaOutput::capabilities() const
+{
+    return p->mmapActive ? PullMode : None;
+}
+
 int AlsaOutput::write(const AudioBuffer& buffer)
 {
     if(!p->pcmHandle || !p->recoverState()) {
@@ -566,8 +1003,8 @@ int AlsaOutput::write(const AudioBuffer& buffer)
 
     const int frameCount = buffer.frameCount();
 
-    AudioBuffer adjustedBuff{buffer};
-    adjustedBuff.scale(p->volume);
+    AudioBuffer adjustedBuff = p->deviceFormat == buffer.format() ? buffer : Audio::convert(buffer, p->deviceFormat);
+    adjustedBuff.scale(p->volume.load(std::memory_order_relaxed));
 
     snd_pcm_sframes_t err{0};
     err = snd_pcm_writei(p->pcmHandle.get(), adjustedBuff.constData().data(), frameCount);
@@ -581,6 +1018,11 @@ int AlsaOutput::write(const AudioBuffer& buffer)
     return static_cast<int>(err);
 }
 
+void AlsaOutput::setSource(AudioSource* source)
+{
+    p->source.store(source, std::memory_order_release);
+}
+
 void AlsaOutput::setPaused(bool pause)
 {
     if(!p->pausable) {
@@ -600,7 +1042,7 @@ void AlsaOutput::setPaused(bool pause)
 
 void AlsaOutput::setVolume(double volume)
 {
-    p->volume = volume;
+    p->volume.store(volume, std::memory_order_relaxed);
 }
 
 void AlsaOutput::setDevice(const QString& device)
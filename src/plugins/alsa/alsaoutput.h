@@ -24,10 +24,18 @@
 #include <memory>
 
 namespace Fooyin::Alsa {
+struct AlsaConfig
+{
+    // Render directly into the device's DMA area from a poll-driven thread
+    bool mmap{false};
+    int bufferSize{8192};
+    int periodSize{1024};
+};
+
 class AlsaOutput : public AudioOutput
 {
 public:
-    AlsaOutput();
+    explicit AlsaOutput(const AlsaConfig& config = {});
     ~AlsaOutput() override;
 
     bool init(const AudioFormat& format) override;
@@ -39,9 +47,12 @@ public:
     [[nodiscard]] QString device() const override;
     [[nodiscard]] int bufferSize() const override;
     OutputState currentState() override;
+    [[nodiscard]] double latency() const override;
     [[nodiscard]] OutputDevices getAllDevices() const override;
 
+    [[nodiscard]] Capabilities capabilities() const override;
     int write(const AudioBuffer& buffer) override;
+    void setSource(AudioSource* source) override;
     void setPaused(bool pause) override;
     void setVolume(double volume) override;
     void setDevice(const QString& device) override;
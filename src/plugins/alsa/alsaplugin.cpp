@@ -21,11 +21,33 @@
 
 #include "alsaoutput.h"
 
+#include <utils/settings/settingsmanager.h>
+
+constexpr auto MmapModeSetting   = "ALSA/MmapMode";
+constexpr auto BufferSizeSetting = "ALSA/BufferSize";
+constexpr auto PeriodSizeSetting = "ALSA/PeriodSize";
+
 namespace Fooyin::Alsa {
+void AlsaPlugin::initialise(const CorePluginContext& context)
+{
+    m_settings = context.settingsManager;
+
+    const AlsaConfig defaults;
+    m_settings->createSetting(QString::fromLatin1(MmapModeSetting), defaults.mmap);
+    m_settings->createSetting(QString::fromLatin1(BufferSizeSetting), defaults.bufferSize);
+    m_settings->createSetting(QString::fromLatin1(PeriodSizeSetting), defaults.periodSize);
+}
+
 AudioOutputBuilder AlsaPlugin::registerOutput()
 {
-    return {.name = QStringLiteral("ALSA"), .creator = []() {
-                return std::make_unique<AlsaOutput>();
+    return {.name = QStringLiteral("ALSA"), .creator = [this]() {
+                AlsaConfig config;
+                if(m_settings) {
+                    config.mmap       = m_settings->value(QString::fromLatin1(MmapModeSetting)).toBool();
+                    config.bufferSize = m_settings->value(QString::fromLatin1(BufferSizeSetting)).toInt();
+                    config.periodSize = m_settings->value(QString::fromLatin1(PeriodSizeSetting)).toInt();
+                }
+                return std::make_unique<AlsaOutput>(config);
             }};
 }
 } // namespace Fooyin::Alsa
@@ -26,10 +26,11 @@
 #include <core/library/musiclibrary.h>
 #include <core/library/trackfilter.h>
 #include <gui/editablelayout.h>
+#include <gui/tracksearcher.h>
 #include <gui/trackselectioncontroller.h>
-#include <utils/async.h>
 #include <utils/crypto.h>
 #include <utils/helpers.h>
+#include <utils/roaringbitmap.h>
 #include <utils/settings/settingsmanager.h>
 
 #include <QMenu>
@@ -37,21 +38,12 @@
 #include <ranges>
 
 namespace {
-Fooyin::TrackList trackIntersection(const Fooyin::TrackList& v1, const Fooyin::TrackList& v2)
+Fooyin::TrackList tracksInSet(const Fooyin::TrackList& tracks, const Fooyin::RoaringBitmap& ids)
 {
     Fooyin::TrackList result;
-    std::unordered_set<int> ids;
-
-    for(const auto& track : v1) {
-        ids.emplace(track.id());
-    }
-
-    for(const auto& track : v2) {
-        if(ids.contains(track.id())) {
-            result.push_back(track);
-        }
-    }
-
+    std::ranges::copy_if(tracks, std::back_inserter(result), [&ids](const Fooyin::Track& track) {
+        return ids.contains(static_cast<uint32_t>(track.id()));
+    });
     return result;
 }
 } // namespace
@@ -71,6 +63,7 @@ struct FilterController::Private
     Id defaultId{"Default"};
     FilterGroups groups;
     std::unordered_map<Id, FilterWidget*, Id::IdHash> ungrouped;
+    std::unordered_map<FilterWidget*, TrackSearcher*> searchers;
 
     TrackAction doubleClickAction;
     TrackAction middleClickAction;
@@ -127,7 +120,7 @@ struct FilterController::Private
         if(groupId == oldGroup) {
             if(!groupId.isValid()) {
                 // Ungrouped
-                widget->reset(library->tracks());
+                widget->reset(library->snapshot().tracks());
                 return;
             }
             resetGroup(widget->group());
@@ -211,7 +204,7 @@ struct FilterController::Private
         }
 
         for(auto* filterWidget : ungrouped | std::views::values) {
-            filterWidget->reset(library->tracks());
+            filterWidget->reset(library->snapshot().tracks());
         }
     }
 
@@ -257,14 +250,17 @@ struct FilterController::Private
         auto activeFilters
             = group.filters | std::views::filter([](FilterWidget* widget) { return widget->isActive(); });
 
-        for(auto& filter : activeFilters) {
-            if(group.filteredTracks.empty()) {
-                std::ranges::copy(filter->filteredTracks(), std::back_inserter(group.filteredTracks));
-            }
-            else {
-                group.filteredTracks = trackIntersection(filter->filteredTracks(), group.filteredTracks);
-            }
+        if(activeFilters.empty()) {
+            return;
         }
+
+        // Intersect the ids of each filter first, and only then pick out the tracks
+        RoaringBitmap ids = activeFilters.front()->filteredTrackIds();
+        for(auto* filter : activeFilters | std::views::drop(1)) {
+            ids &= filter->filteredTrackIds();
+        }
+
+        group.filteredTracks = tracksInSet(activeFilters.front()->filteredTracks(), ids);
     }
 
     void clearActiveFilters(const Id& group, int index)
@@ -346,7 +342,7 @@ struct FilterController::Private
     {
         for(const auto& [_, group] : groups) {
             const int count = static_cast<int>(group.filters.size());
-            TrackList activeFilterTracks;
+            const FilterWidget* activeFilter{nullptr};
 
             for(const auto& filterWidget : group.filters) {
                 if(updated) {
@@ -368,7 +364,8 @@ struct FilterController::Private
                 }
 
                 if(!filterWidget->searchFilter().isEmpty()) {
-                    const TrackList filteredTracks = Filter::filterTracks(tracks, filterWidget->searchFilter());
+                    const TrackList filteredTracks
+                        = Filter::filterTracks(tracks, filterWidget->searchFilter(), library->searchIndex());
                     if(updated) {
                         filterWidget->tracksUpdated(filteredTracks);
                     }
@@ -376,7 +373,7 @@ struct FilterController::Private
                         filterWidget->tracksAdded(filteredTracks);
                     }
                 }
-                else if(activeFilterTracks.empty()) {
+                else if(!activeFilter) {
                     if(updated) {
                         filterWidget->tracksUpdated(tracks);
                     }
@@ -385,7 +382,7 @@ struct FilterController::Private
                     }
                 }
                 else {
-                    const auto filtered = trackIntersection(activeFilterTracks, tracks);
+                    const auto filtered = tracksInSet(tracks, activeFilter->filteredTrackIds());
                     if(updated) {
                         filterWidget->tracksUpdated(filtered);
                     }
@@ -395,7 +392,7 @@ struct FilterController::Private
                 }
 
                 if(filterWidget->isActive()) {
-                    activeFilterTracks = filterWidget->filteredTracks();
+                    activeFilter = filterWidget;
                 }
             }
         }
@@ -428,22 +425,25 @@ struct FilterController::Private
         }
     }
 
-    void searchChanged(FilterWidget* filter, const QString& search)
+    TrackSearcher* searcherFor(FilterWidget* filter)
     {
-        const Id groupId = filter->group();
+        auto& searcher = searchers[filter];
+        if(!searcher) {
+            searcher = new TrackSearcher(library, filter);
+            QObject::connect(searcher, &TrackSearcher::searchFinished, filter,
+                             [filter](const QString& /*search*/, const TrackList& tracks) { filter->reset(tracks); });
+            QObject::connect(filter, &QObject::destroyed, self, [this, filter]() { searchers.erase(filter); });
+        }
+        return searcher;
+    }
 
-        if(!groups.contains(groupId)) {
+    void searchChanged(FilterWidget* filter, const QString& search)
+    {
+        if(!groups.contains(filter->group())) {
             return;
         }
 
-        FilterGroup& group = groups.at(groupId);
-
-        const bool reset         = !group.filteredTracks.empty() || filter->searchFilter().length() > search.length();
-        TrackList tracksToFilter = reset ? library->tracks() : filter->tracks();
-
-        Utils::asyncExec([search, tracksToFilter]() {
-            return Filter::filterTracks(tracksToFilter, search);
-        }).then(self, [filter](TrackList filteredTracks) { filter->reset(filteredTracks); });
+        searcherFor(filter)->search(search);
     }
 };
 
@@ -463,13 +463,14 @@ FilterController::FilterController(MusicLibrary* library, TrackSelectionControll
     QObject::connect(p->library, &MusicLibrary::tracksDeleted, this, &FilterController::tracksRemoved);
     QObject::connect(p->library, &MusicLibrary::tracksLoaded, this, [this]() { p->resetAll(); });
     QObject::connect(p->library, &MusicLibrary::tracksSorted, this, [this]() { p->resetAll(); });
+    QObject::connect(p->library, &MusicLibrary::libraryChanged, this, [this]() { p->resetAll(); });
 }
 
 FilterController::~FilterController() = default;
 
 FilterWidget* FilterController::createFilter()
 {
-    auto* widget = new FilterWidget(p->settings);
+    auto* widget = new FilterWidget(&p->library->groupingCache(), p->settings);
 
     auto& group = p->groups[p->defaultId];
     group.id    = p->defaultId;
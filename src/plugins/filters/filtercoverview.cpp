@@ -0,0 +1,141 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filtercoverview.h"
+
+#include <QMouseEvent>
+#include <QScrollBar>
+
+#include <algorithm>
+#include <utility>
+
+// Room around each cover, besides the line of text below it
+constexpr auto CellMargin = 8;
+// Used until the thumbnail size setting is applied
+constexpr auto DefaultCoverSize = 120;
+
+namespace Fooyin::Filters {
+FilterCoverView::FilterCoverView(QWidget* parent)
+    : QListView{parent}
+    , m_coverSize{DefaultCoverSize}
+{
+    setObjectName(QStringLiteral("FilterCoverView"));
+
+    setViewMode(QListView::IconMode);
+    setMovement(QListView::Static);
+    setResizeMode(QListView::Adjust);
+    setFlow(QListView::LeftToRight);
+    setWrapping(true);
+    setUniformItemSizes(true);
+    setLayoutMode(QListView::Batched);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setWordWrap(false);
+    setTextElideMode(Qt::ElideRight);
+
+    setSelectionBehavior(QAbstractItemView::SelectRows);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setMouseTracking(true);
+    setDragEnabled(true);
+    setDragDropMode(QAbstractItemView::DragOnly);
+    setDefaultDropAction(Qt::CopyAction);
+
+    updateGrid();
+}
+
+void FilterCoverView::setCoverSize(int size)
+{
+    if(std::exchange(m_coverSize, size) != size) {
+        updateGrid();
+    }
+}
+
+void FilterCoverView::mousePressEvent(QMouseEvent* event)
+{
+    const QModelIndex index = indexAt(event->position().toPoint());
+
+    if(index.isValid()) {
+        // Prevent drag-and-drop when first selecting items
+        setDragEnabled(selectionModel()->isSelected(index));
+    }
+
+    QListView::mousePressEvent(event);
+
+    if(!index.isValid()) {
+        clearSelection();
+    }
+
+    if(event->button() == Qt::MiddleButton) {
+        emit middleClicked();
+    }
+}
+
+void FilterCoverView::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    if(event->button() == Qt::MiddleButton) {
+        return;
+    }
+
+    QListView::mouseDoubleClickEvent(event);
+}
+
+void FilterCoverView::scrollContentsBy(int dx, int dy)
+{
+    QListView::scrollContentsBy(dx, dy);
+
+    if(dy != 0) {
+        prefetch(dy < 0);
+    }
+}
+
+void FilterCoverView::updateGrid()
+{
+    const int textHeight = fontMetrics().height();
+
+    setIconSize({m_coverSize, m_coverSize});
+    setGridSize({m_coverSize + CellMargin, m_coverSize + textHeight + CellMargin});
+    verticalScrollBar()->setSingleStep(gridSize().height() / 4);
+}
+
+void FilterCoverView::prefetch(bool forward)
+{
+    QAbstractItemModel* itemModel = model();
+    if(!itemModel) {
+        return;
+    }
+
+    const QSize grid = gridSize();
+    if(grid.isEmpty()) {
+        return;
+    }
+
+    const int rowCount = itemModel->rowCount(rootIndex());
+    const int columns  = std::max(1, viewport()->width() / grid.width());
+    const int pageSize = columns * ((viewport()->height() / grid.height()) + 1);
+
+    const int firstVisible = (verticalOffset() / grid.height()) * columns;
+    const int start        = forward ? firstVisible + pageSize : firstVisible - pageSize;
+
+    // Asking for the cover is enough to have it loaded in the background
+    for(int row{std::max(start, 0)}; row < std::min(start + pageSize, rowCount); ++row) {
+        itemModel->data(itemModel->index(row, 0, rootIndex()), Qt::DecorationRole);
+    }
+}
+} // namespace Fooyin::Filters
+
+#include "moc_filtercoverview.cpp"
@@ -0,0 +1,56 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QListView>
+
+namespace Fooyin::Filters {
+/*!
+ * Shows the items of a filter as a grid of covers, e.g. for albums.
+ *
+ * Every cell is the same size, so only the visible ones are laid out and painted however many items there are.
+ * Covers for the page beyond the viewport in the direction of scrolling are requested ahead of time, so they're
+ * usually loaded by the time they're shown.
+ */
+class FilterCoverView : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit FilterCoverView(QWidget* parent = nullptr);
+
+    /** Changes the size of each cover to @p size pixels square. */
+    void setCoverSize(int size);
+
+signals:
+    void middleClicked();
+
+protected:
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    void updateGrid();
+    void prefetch(bool forward);
+
+    int m_coverSize;
+};
+} // namespace Fooyin::Filters
@@ -24,28 +24,18 @@
 
 #include <QCollator>
 
+#include <algorithm>
+#include <utility>
+
 namespace {
-bool sort(const QCollator& collator, int column, Qt::SortOrder order, const Fooyin::Filters::FilterItem* lhs,
-          const Fooyin::Filters::FilterItem* rhs)
+const QCollator& columnCollator()
 {
-    if(!lhs || !rhs) {
-        return false;
-    }
-
-    const auto cmp = collator.compare(lhs->column(column), rhs->column(column));
-
-    if(cmp == 0) {
-        if(std::cmp_less(column, lhs->columns().size() - 1)) {
-            return sort(collator, column + 1, Qt::AscendingOrder, lhs, rhs);
-        }
-        return false;
-    }
-
-    if(order == Qt::AscendingOrder) {
-        return cmp < 0;
-    }
-
-    return cmp > 0;
+    static const QCollator collator = []() {
+        QCollator numericCollator;
+        numericCollator.setNumericMode(true);
+        return numericCollator;
+    }();
+    return collator;
 }
 } // namespace
 
@@ -76,32 +66,61 @@ QString FilterItem::column(int column) const
 
 TrackList FilterItem::tracks() const
 {
+    if(!m_tracksSorted) {
+        m_tracks       = Sorting::sortTracks(m_tracks);
+        m_tracksSorted = true;
+    }
     return m_tracks;
 }
 
+Track FilterItem::firstTrack() const
+{
+    if(m_tracks.empty()) {
+        return {};
+    }
+    if(!m_tracksSorted) {
+        m_tracks       = Sorting::sortTracks(m_tracks);
+        m_tracksSorted = true;
+    }
+    return m_tracks.front();
+}
+
 int FilterItem::trackCount() const
 {
     return static_cast<int>(m_tracks.size());
 }
 
+const RoaringBitmap& FilterItem::trackIds() const
+{
+    return m_trackIds;
+}
+
 void FilterItem::setColumns(const QStringList& columns)
 {
     m_columns = columns;
+    m_sortKeys.clear();
 }
 
 void FilterItem::removeColumn(int column)
 {
     m_columns.remove(column);
+    m_sortKeys.clear();
 }
 
 void FilterItem::addTrack(const Track& track)
 {
     m_tracks.emplace_back(track);
+    m_tracksSorted = false;
+    m_trackIds.add(static_cast<uint32_t>(track.id()));
 }
 
 void FilterItem::addTracks(const TrackList& tracks)
 {
     std::ranges::copy(tracks, std::back_inserter(m_tracks));
+    m_tracksSorted = m_tracks.empty();
+    for(const Track& track : tracks) {
+        m_trackIds.add(static_cast<uint32_t>(track.id()));
+    }
 }
 
 void FilterItem::removeTrack(const Track& track)
@@ -110,6 +129,7 @@ void FilterItem::removeTrack(const Track& track)
         return;
     }
     std::erase_if(m_tracks, [track](const Track& child) { return child.id() == track.id(); });
+    m_trackIds.remove(static_cast<uint32_t>(track.id()));
 }
 
 void FilterItem::replaceTrack(const Track& track)
@@ -119,27 +139,95 @@ void FilterItem::replaceTrack(const Track& track)
     }
     std::ranges::replace_if(
         m_tracks, [track](const Track& child) { return child.id() == track.id(); }, track);
+    // Changed tags may move it
+    m_tracksSorted = false;
+}
+
+void FilterItem::insertChild(int row, FilterItem* child)
+{
+    TreeItem::insertChild(row, child);
+    m_sortedCount = std::min(m_sortedCount, row);
 }
 
-void FilterItem::sortTracks()
+void FilterItem::insertChildren(int row, const std::vector<FilterItem*>& children)
 {
-    m_tracks = Sorting::sortTracks(m_tracks);
+    TreeItem::insertChildren(row, children);
+    m_sortedCount = std::min(m_sortedCount, row);
+}
+
+void FilterItem::removeChildren(int index, int count)
+{
+    const int previousCount = childCount();
+    TreeItem::removeChildren(index, count);
+    if(childCount() != previousCount) {
+        // Those left are still in order
+        m_sortedCount -= std::clamp(m_sortedCount - index, 0, count);
+    }
+}
+
+void FilterItem::clearChildren()
+{
+    TreeItem::clearChildren();
+    m_sortedCount = 0;
 }
 
 void FilterItem::sortChildren(int column, Qt::SortOrder order)
 {
-    std::vector<FilterItem*> sortedChildren{m_children};
+    if(column < 0) {
+        return;
+    }
 
-    QCollator collator;
-    collator.setNumericMode(true);
+    if(column != m_sortColumn || order != m_sortOrder) {
+        m_sortedCount = 0;
+        m_sortColumn  = column;
+        m_sortOrder   = order;
+    }
+
+    const int count = childCount();
+    if(m_sortedCount >= count) {
+        return;
+    }
+
+    const auto lessThan = [column, order](const FilterItem* lhs, const FilterItem* rhs) {
+        return lhs->lessThan(rhs, column, order);
+    };
 
-    std::ranges::sort(sortedChildren, [collator, column, order](const FilterItem* lhs, const FilterItem* rhs) {
-        return sort(collator, column, order, lhs, rhs);
-    });
-    m_children = sortedChildren;
+    // Only the new children need sorting, then a single pass merges them into place
+    const auto middle = m_children.begin() + m_sortedCount;
+    std::stable_sort(middle, m_children.end(), lessThan);
+    std::inplace_merge(m_children.begin(), middle, m_children.end(), lessThan);
 
-    for(const auto& child : m_children) {
-        child->sortTracks();
+    m_sortedCount = count;
+    renumberChildren(0);
+}
+
+void FilterItem::invalidateSort()
+{
+    m_sortedCount = 0;
+}
+
+const QCollatorSortKey& FilterItem::sortKey(int column) const
+{
+    if(std::cmp_less(m_sortKeys.size(), m_columns.size())) {
+        m_sortKeys.resize(static_cast<size_t>(m_columns.size()));
+    }
+
+    auto& key = m_sortKeys.at(static_cast<size_t>(column));
+    if(!key) {
+        key = columnCollator().sortKey(m_columns.at(column));
+    }
+    return *key;
+}
+
+bool FilterItem::lessThan(const FilterItem* other, int column, Qt::SortOrder order) const
+{
+    // Ties are broken by the following columns, always ascending
+    for(int i{column}; i < m_columns.size() && i < other->m_columns.size(); ++i) {
+        const int cmp = sortKey(i).compare(other->sortKey(i));
+        if(cmp != 0) {
+            return (i == column && order == Qt::DescendingOrder) ? cmp > 0 : cmp < 0;
+        }
     }
+    return false;
 }
 } // namespace Fooyin::Filters
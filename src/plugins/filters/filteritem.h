@@ -20,10 +20,14 @@
 #pragma once
 
 #include <core/trackfwd.h>
+#include <utils/roaringbitmap.h>
 #include <utils/treeitem.h>
 
+#include <QCollatorSortKey>
 #include <QStringList>
 
+#include <optional>
+
 namespace Fooyin::Filters {
 class FilterItem;
 
@@ -44,7 +48,11 @@ public:
     [[nodiscard]] QString column(int column) const;
 
     [[nodiscard]] TrackList tracks() const;
+    /** Returns the first of tracks without copying the rest, or an invalid track if there are none. */
+    [[nodiscard]] Track firstTrack() const;
     [[nodiscard]] int trackCount() const;
+    /** Returns the ids of the tracks in this node, for combining with other nodes and filters. */
+    [[nodiscard]] const RoaringBitmap& trackIds() const;
 
     void setColumns(const QStringList& columns);
     void removeColumn(int column);
@@ -53,13 +61,36 @@ public:
     void addTracks(const TrackList& tracks);
     void removeTrack(const Track& track);
     void replaceTrack(const Track& track);
-    void sortTracks();
 
+    void insertChild(int row, FilterItem* child) override;
+    void insertChildren(int row, const std::vector<FilterItem*>& children) override;
+    void removeChildren(int index, int count) override;
+    void clearChildren() override;
+
+    /*!
+     * Sorts the children of this node on @p column, breaking ties on the columns after it.
+     * If the order hasn't changed since the last sort, children appended since are merged in with the rest.
+     */
     void sortChildren(int column, Qt::SortOrder order);
+    /** Makes the next sortChildren sort every child, e.g. after their columns have changed. */
+    void invalidateSort();
 
 private:
+    [[nodiscard]] const QCollatorSortKey& sortKey(int column) const;
+    [[nodiscard]] bool lessThan(const FilterItem* other, int column, Qt::SortOrder order) const;
+
     QString m_key;
     QStringList m_columns;
-    TrackList m_tracks;
+    // One per column, collated when first sorted on
+    mutable std::vector<std::optional<QCollatorSortKey>> m_sortKeys;
+    // Sorted on first access after a change, as most nodes' tracks are never asked for
+    mutable TrackList m_tracks;
+    mutable bool m_tracksSorted{true};
+    RoaringBitmap m_trackIds;
+
+    // How many children, from the first, are in order for the last sort
+    int m_sortedCount{0};
+    int m_sortColumn{-1};
+    Qt::SortOrder m_sortOrder{Qt::AscendingOrder};
 };
 } // namespace Fooyin::Filters
@@ -24,38 +24,35 @@
 #include "filterpopulator.h"
 
 #include <core/track.h>
+#include <gui/coverprovider.h>
 #include <gui/guiconstants.h>
+#include <gui/trackmimedata.h>
+#include <utils/memoryusage.h>
+#include <utils/tracing.h>
 #include <utils/widgets/autoheaderview.h>
 
 #include <QColor>
 #include <QFont>
 #include <QFontMetrics>
-#include <QIODevice>
 #include <QMimeData>
 #include <QSize>
-#include <QThread>
 
+#include <algorithm>
 #include <set>
+#include <unordered_set>
 #include <utility>
 
 namespace {
-QByteArray saveTracks(const QModelIndexList& indexes)
+Fooyin::TrackList indexTracks(const QModelIndexList& indexes)
 {
-    QByteArray result;
-    QDataStream stream(&result, QIODevice::WriteOnly);
-
-    Fooyin::TrackIds trackIds;
-    trackIds.reserve(indexes.size());
+    Fooyin::TrackList tracks;
 
     for(const QModelIndex& index : indexes) {
-        const auto tracks = index.data(Fooyin::Filters::FilterItem::Tracks).value<Fooyin::TrackList>();
-        std::ranges::transform(std::as_const(tracks), std::back_inserter(trackIds),
-                               [](const Fooyin::Track& track) { return track.id(); });
+        const auto itemTracks = index.data(Fooyin::Filters::FilterItem::Tracks).value<Fooyin::TrackList>();
+        tracks.insert(tracks.end(), itemTracks.cbegin(), itemTracks.cend());
     }
 
-    stream << trackIds;
-
-    return result;
+    return tracks;
 }
 } // namespace
 
@@ -66,7 +63,6 @@ struct FilterModel::Private
 
     bool resetting{false};
 
-    QThread populatorThread;
     FilterPopulator populator;
 
     FilterItem allNode;
@@ -84,12 +80,16 @@ struct FilterModel::Private
     QFont font;
     QColor colour;
 
-    TrackList tracksPendingRemoval;
+    CoverProvider* coverProvider{nullptr};
+    QMetaObject::Connection coverConnection;
 
-    explicit Private(FilterModel* self_)
+    int memorySource{-1};
+
+    Private(FilterModel* self_, const GroupingCache* groupingCache)
         : self{self_}
+        , populator{groupingCache}
     {
-        populator.moveToThread(&populatorThread);
+        populator.setLane(TaskScheduler::Lane::Interactive);
     }
 
     void beginReset()
@@ -102,17 +102,13 @@ struct FilterModel::Private
         self->rootItem()->appendChild(&allNode);
     }
 
-    void batchFinished(PendingTreeData data)
+    void batchFinished(PendingTreeData& data)
     {
         if(resetting) {
             self->beginResetModel();
             beginReset();
         }
 
-        if(!tracksPendingRemoval.empty()) {
-            self->removeTracks(tracksPendingRemoval);
-        }
-
         populateModel(data);
 
         if(resetting) {
@@ -151,7 +147,8 @@ struct FilterModel::Private
 
     void populateModel(PendingTreeData& data)
     {
-        for(const auto& [key, item] : data.items) {
+        FY_TRACE_SCOPE("FilterModel::populateModel");
+        for(auto& [key, item] : data.items) {
             if(nodes.contains(key)) {
                 nodes.at(key).addTracks(item.tracks());
             }
@@ -161,7 +158,7 @@ struct FilterModel::Private
                     self->beginInsertRows(self->indexOfItem(&allNode), row, row);
                 }
 
-                FilterItem* child = &nodes.emplace(key, item).first->second;
+                FilterItem* child = &nodes.emplace(key, std::move(item)).first->second;
                 allNode.appendChild(child);
 
                 if(!resetting) {
@@ -174,26 +171,138 @@ struct FilterModel::Private
         allNode.sortChildren(sortColumn, sortOrder);
         updateAllNode();
     }
+
+    void coverUpdated(const Track& track)
+    {
+        const auto parents = trackParents.find(track.id());
+        if(parents == trackParents.cend()) {
+            return;
+        }
+
+        for(const QString& key : parents->second) {
+            if(const auto node = nodes.find(key); node != nodes.end()) {
+                const QModelIndex index = self->indexOfItem(&node->second);
+                emit self->dataChanged(index, index, {Qt::DecorationRole});
+            }
+        }
+    }
+
+    void removeEmptyNodes(const std::set<FilterItem*>& items)
+    {
+        for(FilterItem* item : items) {
+            if(item->trackCount() == 0) {
+                const QModelIndex parentIndex = self->indexOfItem(&allNode);
+                const int row                 = item->row();
+                self->beginRemoveRows(parentIndex, row, row);
+                allNode.removeChild(row);
+                self->endRemoveRows();
+                nodes.erase(item->key());
+            }
+        }
+    }
+
+    // Moves each of @p tracks from the nodes it was under to the nodes it now belongs to in @p data
+    void updateNodes(const TrackList& tracks, const PendingTreeData& data)
+    {
+        if(resetting) {
+            return;
+        }
+
+        std::set<FilterItem*> changedItems;
+
+        for(const Track& track : tracks) {
+            const int id = track.id();
+
+            std::vector<QString> oldKeys;
+            if(const auto parents = trackParents.find(id); parents != trackParents.cend()) {
+                oldKeys = parents->second;
+            }
+
+            std::vector<QString> newKeys;
+            if(const auto parents = data.trackParents.find(id); parents != data.trackParents.cend()) {
+                newKeys = parents->second;
+            }
+
+            const auto hasKey = [](const std::vector<QString>& keys, const QString& key) {
+                return std::ranges::find(keys, key) != keys.cend();
+            };
+
+            for(const QString& key : oldKeys) {
+                if(!nodes.contains(key)) {
+                    continue;
+                }
+                FilterItem* item = &nodes.at(key);
+                if(hasKey(newKeys, key)) {
+                    item->replaceTrack(track);
+                }
+                else {
+                    item->removeTrack(track);
+                    changedItems.emplace(item);
+                }
+            }
+
+            for(const QString& key : newKeys) {
+                if(hasKey(oldKeys, key)) {
+                    continue;
+                }
+                if(!nodes.contains(key)) {
+                    const int row = allNode.childCount();
+                    self->beginInsertRows(self->indexOfItem(&allNode), row, row);
+                    FilterItem* child
+                        = &nodes.emplace(key, FilterItem{key, data.items.at(key).columns(), &allNode}).first->second;
+                    allNode.appendChild(child);
+                    self->endInsertRows();
+                }
+                nodes.at(key).addTrack(track);
+            }
+
+            if(newKeys.empty()) {
+                trackParents.erase(id);
+            }
+            else {
+                trackParents[id] = std::move(newKeys);
+            }
+        }
+
+        removeEmptyNodes(changedItems);
+
+        allNode.sortChildren(sortColumn, sortOrder);
+        updateAllNode();
+
+        QMetaObject::invokeMethod(self, &FilterModel::modelUpdated);
+    }
 };
 
-FilterModel::FilterModel(QObject* parent)
+FilterModel::FilterModel(const GroupingCache* groupingCache, QObject* parent)
     : TreeModel{parent}
-    , p{std::make_unique<Private>(this)}
+    , p{std::make_unique<Private>(this, groupingCache)}
 {
-    QObject::connect(&p->populator, &FilterPopulator::populated, this,
-                     [this](const PendingTreeData& data) { p->batchFinished(data); });
-
-    QObject::connect(&p->populator, &Worker::finished, this, [this]() {
-        p->populator.stopThread();
-        p->populatorThread.quit();
+    // Results of superseded runs would be merged into the wrong model state
+    QObject::connect(&p->populator, &FilterPopulator::populated, this, [this](const PendingTreeDataPtr& data) {
+        if(p->populator.isCurrent(data->generation)) {
+            p->batchFinished(*data);
+        }
+    });
+    QObject::connect(&p->populator, &FilterPopulator::tracksUpdated, this,
+                     [this](const TrackList& tracks, const PendingTreeDataPtr& data) {
+                         if(p->populator.isCurrent(data->generation)) {
+                             p->updateNodes(tracks, *data);
+                         }
+                     });
+
+    // Items are counted at their fixed size; the values and tracks they hold aren't included
+    p->memorySource = MemoryUsage::addSource(QStringLiteral("Filter items"), [this]() {
+        return MemoryUsage::Usage{.bytes   = p->nodes.size() * sizeof(ItemKeyMap::value_type),
+                                  .entries = p->nodes.size()};
     });
 }
 
 FilterModel::~FilterModel()
 {
-    p->populator.stopThread();
-    p->populatorThread.quit();
-    p->populatorThread.wait();
+    MemoryUsage::removeSource(p->memorySource);
+
+    p->populator.closeThread();
+    p->populator.waitForTasks();
 }
 
 int FilterModel::sortColumn() const
@@ -240,6 +349,23 @@ void FilterModel::setRowHeight(int height)
     emit dataChanged({}, {});
 }
 
+void FilterModel::setCoverProvider(CoverProvider* coverProvider)
+{
+    if(coverProvider == p->coverProvider) {
+        return;
+    }
+
+    QObject::disconnect(p->coverConnection);
+    p->coverProvider = coverProvider;
+
+    if(coverProvider) {
+        p->coverConnection = QObject::connect(coverProvider, &CoverProvider::coverAdded, this,
+                                              [this](const Track& track) { p->coverUpdated(track); });
+    }
+
+    emit dataChanged({}, {}, {Qt::DecorationRole});
+}
+
 Qt::ItemFlags FilterModel::flags(const QModelIndex& index) const
 {
     Qt::ItemFlags defaultFlags = QAbstractItemModel::flags(index);
@@ -305,6 +431,11 @@ QVariant FilterModel::data(const QModelIndex& index, int role) const
         }
         case(FilterItem::Tracks):
             return QVariant::fromValue(item->tracks());
+        case(Qt::DecorationRole):
+            if(p->coverProvider && col == 0 && item != &p->allNode) {
+                return p->coverProvider->trackCoverThumbnail(item->firstTrack());
+            }
+            break;
         case(Qt::SizeHintRole):
             return QSize{0, p->rowHeight};
         case(Qt::FontRole):
@@ -337,9 +468,7 @@ Qt::DropActions FilterModel::supportedDragActions() const
 
 QMimeData* FilterModel::mimeData(const QModelIndexList& indexes) const
 {
-    auto* mimeData = new QMimeData();
-    mimeData->setData(QString::fromLatin1(Constants::Mime::TrackIds), saveTracks(indexes));
-    return mimeData;
+    return new TrackMimeData(indexTracks(indexes));
 }
 
 Qt::Alignment FilterModel::columnAlignment(int column) const
@@ -395,12 +524,10 @@ void FilterModel::addTracks(const TrackList& tracks)
         return;
     }
 
-    p->populatorThread.start();
-
     QStringList columns;
     std::ranges::transform(p->columns, std::back_inserter(columns), [](const auto& column) { return column.field; });
 
-    QMetaObject::invokeMethod(&p->populator, [this, columns, tracksToAdd] { p->populator.run(columns, tracksToAdd); });
+    p->populator.schedule([this, columns, tracksToAdd] { p->populator.run(columns, tracksToAdd); });
 }
 
 void FilterModel::updateTracks(const TrackList& tracks)
@@ -415,15 +542,10 @@ void FilterModel::updateTracks(const TrackList& tracks)
         return;
     }
 
-    p->tracksPendingRemoval = tracksToUpdate;
-
-    p->populatorThread.start();
-
     QStringList columns;
     std::ranges::transform(p->columns, std::back_inserter(columns), [](const auto& column) { return column.field; });
 
-    QMetaObject::invokeMethod(&p->populator,
-                              [this, columns, tracksToUpdate] { p->populator.run(columns, tracksToUpdate); });
+    p->populator.schedule([this, columns, tracksToUpdate] { p->populator.update(columns, tracksToUpdate); });
 
     addTracks(tracks);
 }
@@ -461,19 +583,51 @@ void FilterModel::removeTracks(const TrackList& tracks)
         }
     }
 
-    for(FilterItem* item : items) {
-        if(item->trackCount() == 0) {
-            const QModelIndex parentIndex = indexOfItem(&p->allNode);
-            const int row                 = item->row();
-            beginRemoveRows(parentIndex, row, row);
-            p->allNode.removeChild(row);
-            p->allNode.resetChildren();
-            endRemoveRows();
-            p->nodes.erase(item->key());
+    p->removeEmptyNodes(items);
+    p->updateAllNode();
+}
+
+void FilterModel::setTracks(const TrackList& tracks)
+{
+    if(p->resetting) {
+        reset(p->columns, tracks);
+        return;
+    }
+
+    std::unordered_set<int> ids;
+    TrackList tracksToAdd;
+
+    for(const Track& track : tracks) {
+        ids.emplace(track.id());
+        if(!p->trackParents.contains(track.id())) {
+            tracksToAdd.push_back(track);
+        }
+    }
+
+    TrackList tracksToRemove;
+    for(const auto& [id, _] : p->trackParents) {
+        if(!ids.contains(id)) {
+            // Tracks are only matched by id when removing
+            Track track;
+            track.setId(id);
+            tracksToRemove.push_back(track);
         }
     }
 
-    p->updateAllNode();
+    // It's faster to repopulate if most of the tracks are changing
+    if(tracksToAdd.size() + tracksToRemove.size() > tracks.size() / 2) {
+        reset(p->columns, tracks);
+        return;
+    }
+
+    removeTracks(tracksToRemove);
+
+    if(tracksToAdd.empty()) {
+        QMetaObject::invokeMethod(this, &FilterModel::modelUpdated, Qt::QueuedConnection);
+        return;
+    }
+
+    addTracks(tracksToAdd);
 }
 
 bool FilterModel::removeColumn(int column)
@@ -492,6 +646,7 @@ bool FilterModel::removeColumn(int column)
     for(auto& [_, node] : p->nodes) {
         node.removeColumn(column);
     }
+    p->allNode.invalidateSort();
 
     endRemoveColumns();
 
@@ -500,13 +655,6 @@ bool FilterModel::removeColumn(int column)
 
 void FilterModel::reset(const FilterColumnList& columns, const TrackList& tracks)
 {
-    if(p->populatorThread.isRunning()) {
-        p->populator.stopThread();
-    }
-    else {
-        p->populatorThread.start();
-    }
-
     p->columns = columns;
 
     p->resetting = true;
@@ -514,6 +662,6 @@ void FilterModel::reset(const FilterColumnList& columns, const TrackList& tracks
     QStringList fields;
     std::ranges::transform(p->columns, std::back_inserter(fields), [](const auto& column) { return column.field; });
 
-    QMetaObject::invokeMethod(&p->populator, [this, fields, tracks] { p->populator.run(fields, tracks); });
+    p->populator.startJob([this, fields, tracks] { p->populator.run(fields, tracks); });
 }
 } // namespace Fooyin::Filters
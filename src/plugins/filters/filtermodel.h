@@ -25,7 +25,11 @@
 #include <core/track.h>
 #include <utils/treemodel.h>
 
-namespace Fooyin::Filters {
+namespace Fooyin {
+class CoverProvider;
+class GroupingCache;
+
+namespace Filters {
 struct FilterOptions;
 
 class FilterModel : public TreeModel<FilterItem>
@@ -33,7 +37,7 @@ class FilterModel : public TreeModel<FilterItem>
     Q_OBJECT
 
 public:
-    explicit FilterModel(QObject* parent = nullptr);
+    explicit FilterModel(const GroupingCache* groupingCache, QObject* parent = nullptr);
     ~FilterModel() override;
 
     [[nodiscard]] int sortColumn() const;
@@ -43,6 +47,11 @@ public:
     void setFont(const QString& font);
     void setColour(const QColor& colour);
     void setRowHeight(int height);
+    /*!
+     * Shows the front cover of each item's first track from @p coverProvider, or no covers if @c nullptr.
+     * The 'All' node never has a cover.
+     */
+    void setCoverProvider(CoverProvider* coverProvider);
 
     [[nodiscard]] Qt::ItemFlags flags(const QModelIndex& index) const override;
     [[nodiscard]] QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
@@ -63,6 +72,11 @@ public:
     void updateTracks(const TrackList& tracks);
     void refreshTracks(const TrackList& tracks);
     void removeTracks(const TrackList& tracks);
+    /*!
+     * Changes the tracks shown to @p tracks, only adding and removing the difference unless most have changed.
+     * Emits modelUpdated once done.
+     */
+    void setTracks(const TrackList& tracks);
     bool removeColumn(int column);
 
     void reset(const FilterColumnList& columns, const TrackList& tracks);
@@ -74,4 +88,5 @@ private:
     struct Private;
     std::unique_ptr<Private> p;
 };
-} // namespace Fooyin::Filters
+} // namespace Filters
+} // namespace Fooyin
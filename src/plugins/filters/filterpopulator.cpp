@@ -20,34 +20,32 @@
 #include "filterpopulator.h"
 
 #include <core/constants.h>
-#include <core/scripting/scriptparser.h>
-#include <core/scripting/scriptregistry.h>
+#include <core/library/groupingcache.h>
 #include <core/track.h>
 
+#include <utils/crossthreadstats.h>
 #include <utils/crypto.h>
+#include <utils/tracing.h>
 
 namespace Fooyin::Filters {
 struct FilterPopulator::Private
 {
     FilterPopulator* self;
-
-    ScriptRegistry registry;
-    ScriptParser parser;
+    const GroupingCache* groupingCache;
 
     QString currentColumns;
-    ParsedScript script;
 
     FilterItem root;
     PendingTreeData data;
 
-    explicit Private(FilterPopulator* self_)
+    Private(FilterPopulator* self_, const GroupingCache* groupingCache_)
         : self{self_}
-        , parser{&registry}
+        , groupingCache{groupingCache_}
     { }
 
     FilterItem* getOrInsertItem(const QStringList& columns)
     {
-        const QString key = Utils::generateHash(columns.join(QStringLiteral("")));
+        const QString key = Utils::generateKey(columns);
         if(!data.items.contains(key)) {
             data.items.emplace(key, FilterItem{key, columns, &root});
         }
@@ -70,12 +68,9 @@ struct FilterPopulator::Private
         data.trackParents[track.id()].push_back(node->key());
     }
 
-    void iterateTrack(const Track& track)
+    void iterateTrack(const Track& track, const QStringList& values)
     {
-        const QString columns = parser.evaluate(script, track);
-
-        if(columns.contains(u"\037")) {
-            const QStringList values = columns.split(QStringLiteral("\037"));
+        if(values.size() > 1) {
             QList<QStringList> colValues;
             std::ranges::transform(values, std::back_inserter(colValues),
                                    [](const QString& col) { return col.split(QStringLiteral("\036")); });
@@ -85,51 +80,75 @@ struct FilterPopulator::Private
             }
         }
         else {
-            FilterItem* node = getOrInsertItem(columns.split(QStringLiteral("\036")));
+            const QString columns = values.empty() ? QString{} : values.constFirst();
+            FilterItem* node      = getOrInsertItem(columns.split(QStringLiteral("\036")));
             addTrackToNode(track, node);
         }
     }
 
-    void runBatch(const TrackList& tracks)
+    bool runBatch(const TrackList& tracks)
     {
-        for(const Track& track : tracks) {
-            if(!self->mayRun()) {
-                return;
-            }
+        TrackList libraryTracks;
+        std::ranges::copy_if(tracks, std::back_inserter(libraryTracks),
+                             [](const Track& track) { return track.isInLibrary(); });
 
-            if(track.isInLibrary()) {
-                iterateTrack(track);
-            }
-        }
+        // The most expensive part of populating, so shared with other filters using the same columns
+        const std::vector<QStringList> columns = groupingCache->values(currentColumns, libraryTracks);
 
-        if(!self->mayRun()) {
-            return;
+        for(size_t i{0}; i < libraryTracks.size(); ++i) {
+            if(!self->mayRun()) {
+                return false;
+            }
+            iterateTrack(libraryTracks.at(i), columns.at(i));
         }
 
-        emit self->populated(data);
-        data.clear();
+        return self->mayRun();
     }
 };
 
-FilterPopulator::FilterPopulator(QObject* parent)
+FilterPopulator::FilterPopulator(const GroupingCache* groupingCache, QObject* parent)
     : Worker{parent}
-    , p{std::make_unique<Private>(this)}
+    , p{std::make_unique<Private>(this, groupingCache)}
 { }
 
 FilterPopulator::~FilterPopulator() = default;
 
 void FilterPopulator::run(const QStringList& columns, const TrackList& tracks)
 {
+    FY_TRACE_SCOPE("FilterPopulator::run");
     setState(Running);
 
     p->data.clear();
 
-    const QString newColumns = columns.join(u"\036");
-    if(std::exchange(p->currentColumns, newColumns) != newColumns) {
-        p->script = p->parser.parse(p->currentColumns);
+    p->currentColumns = columns.join(u"\036");
+
+    if(p->runBatch(tracks)) {
+        p->data.generation = jobGeneration();
+        emit populated(std::make_shared<PendingTreeData>(std::move(p->data)));
     }
+    p->data.clear();
 
-    p->runBatch(tracks);
+    if(Worker::mayRun()) {
+        emit finished();
+    }
+
+    setState(Idle);
+}
+
+void FilterPopulator::update(const QStringList& columns, const TrackList& tracks)
+{
+    setState(Running);
+
+    p->data.clear();
+
+    p->currentColumns = columns.join(u"\036");
+
+    if(p->runBatch(tracks)) {
+        p->data.generation = jobGeneration();
+        CrossThreadStats::recordCopy("FilterPopulator::tracksUpdated", tracks);
+        emit tracksUpdated(tracks, std::make_shared<PendingTreeData>(std::move(p->data)));
+    }
+    p->data.clear();
 
     if(Worker::mayRun()) {
         emit finished();
@@ -24,7 +24,10 @@
 #include <core/trackfwd.h>
 #include <utils/worker.h>
 
-namespace Fooyin::Filters {
+namespace Fooyin {
+class GroupingCache;
+
+namespace Filters {
 using ItemKeyMap     = std::map<QString, FilterItem>;
 using TrackIdNodeMap = std::unordered_map<int, std::vector<QString>>;
 
@@ -32,6 +35,8 @@ struct PendingTreeData
 {
     ItemKeyMap items;
     TrackIdNodeMap trackParents;
+    // The populator job these belong to
+    uint64_t generation{0};
 
     void clear()
     {
@@ -39,22 +44,31 @@ struct PendingTreeData
         trackParents.clear();
     }
 };
+// Batches are handed to a single receiver, which may move from them
+using PendingTreeDataPtr = std::shared_ptr<PendingTreeData>;
 
 class FilterPopulator : public Worker
 {
     Q_OBJECT
 
 public:
-    FilterPopulator(QObject* parent = nullptr);
+    explicit FilterPopulator(const GroupingCache* groupingCache, QObject* parent = nullptr);
     ~FilterPopulator() override;
 
     void run(const QStringList& columns, const TrackList& tracks);
+    /*!
+     * Groups @p tracks, which are already in the model, by their current values.
+     * Emits tracksUpdated with the new groups so the model can move only the tracks whose values changed.
+     */
+    void update(const QStringList& columns, const TrackList& tracks);
 
 signals:
-    void populated(PendingTreeData data);
+    void populated(const PendingTreeDataPtr& data);
+    void tracksUpdated(const TrackList& tracks, const PendingTreeDataPtr& data);
 
 private:
     struct Private;
     std::unique_ptr<Private> p;
 };
-} // namespace Fooyin::Filters
+} // namespace Filters
+} // namespace Fooyin
@@ -20,6 +20,7 @@
 #include "filterwidget.h"
 
 #include "filtercolumnregistry.h"
+#include "filtercoverview.h"
 #include "filterdelegate.h"
 #include "filterfwd.h"
 #include "filteritem.h"
@@ -29,7 +30,10 @@
 
 #include <core/library/trackfilter.h>
 #include <core/library/tracksort.h>
+#include <core/scripting/scriptparser.h>
 #include <core/track.h>
+#include <gui/coverprovider.h>
+#include <gui/guisettings.h>
 #include <utils/actions/widgetcontext.h>
 #include <utils/async.h>
 #include <utils/settings/settingsmanager.h>
@@ -43,32 +47,7 @@
 #include <QJsonObject>
 #include <QMenu>
 
-#include <set>
-
-namespace {
-Fooyin::TrackList fetchAllTracks(QTreeView* view)
-{
-    std::set<int> ids;
-    Fooyin::TrackList tracks;
-
-    const QModelIndex parent = view->model()->index(0, 0, {});
-    const int rowCount       = view->model()->rowCount(parent);
-
-    for(int row = 0; row < rowCount; ++row) {
-        const QModelIndex index = view->model()->index(row, 0, parent);
-        const auto indexTracks  = index.data(Fooyin::Filters::FilterItem::Tracks).value<Fooyin::TrackList>();
-
-        for(const Fooyin::Track& track : indexTracks) {
-            const int id = track.id();
-            if(!ids.contains(id)) {
-                ids.emplace(id);
-                tracks.push_back(track);
-            }
-        }
-    }
-    return tracks;
-}
-} // namespace
+#include <ranges>
 
 namespace Fooyin::Filters {
 struct FilterWidget::Private
@@ -81,13 +60,20 @@ struct FilterWidget::Private
     FilterView* view;
     AutoHeaderView* header;
     FilterModel* model;
+    // Only created once covers are first shown
+    FilterCoverView* coverView{nullptr};
+    CoverProvider* coverProvider{nullptr};
+    bool showCovers{false};
 
     Id group;
     int index{-1};
     FilterColumnList columns;
+    // Only used to find what the columns depend on
+    ScriptParser columnParser;
     bool multipleColumns{false};
     TrackList tracks;
     TrackList filteredTracks;
+    RoaringBitmap filteredIds;
 
     WidgetContext* widgetContext;
 
@@ -97,13 +83,13 @@ struct FilterWidget::Private
 
     QByteArray headerState;
 
-    Private(FilterWidget* self_, SettingsManager* settings_)
+    Private(FilterWidget* self_, const GroupingCache* groupingCache, SettingsManager* settings_)
         : self{self_}
         , columnRegistry{settings_}
         , settings{settings_}
         , view{new FilterView(self)}
         , header{new AutoHeaderView(Qt::Horizontal, self)}
-        , model{new FilterModel(self)}
+        , model{new FilterModel(groupingCache, self)}
         , widgetContext{new WidgetContext(self, Context{Id{"Fooyin.Context.FilterWidget."}.append(self->id())}, self)}
     {
         view->setHeader(header);
@@ -135,6 +121,7 @@ struct FilterWidget::Private
     void refreshFilteredTracks()
     {
         filteredTracks.clear();
+        filteredIds.clear();
 
         const QModelIndexList selected = view->selectionModel()->selectedRows();
 
@@ -142,18 +129,33 @@ struct FilterWidget::Private
             return;
         }
 
-        TrackList selectedTracks;
+        std::vector<FilterItem*> items;
 
         for(const auto& selectedIndex : selected) {
             if(!selectedIndex.parent().isValid()) {
-                selectedTracks = fetchAllTracks(view);
+                // The 'All' node
+                items = model->itemForIndex(selectedIndex)->children();
                 break;
             }
-            const auto newTracks = selectedIndex.data(FilterItem::Tracks).value<TrackList>();
-            std::ranges::copy(newTracks, std::back_inserter(selectedTracks));
+            items.push_back(model->itemForIndex(selectedIndex));
+        }
+
+        for(const FilterItem* item : items) {
+            filteredIds |= item->trackIds();
         }
 
-        filteredTracks = selectedTracks;
+        // Tracks can be under more than one item with multi-value columns, but are only included once
+        RoaringBitmap added;
+        filteredTracks.reserve(filteredIds.size());
+
+        for(const FilterItem* item : items) {
+            const TrackList itemTracks = item->tracks();
+            for(const Track& track : itemTracks) {
+                if(added.add(static_cast<uint32_t>(track.id()))) {
+                    filteredTracks.push_back(track);
+                }
+            }
+        }
     }
 
     void selectionChanged()
@@ -167,6 +169,53 @@ struct FilterWidget::Private
         emit self->selectionChanged(playlistNameFromSelection());
     }
 
+    void createCoverView()
+    {
+        coverView     = new FilterCoverView(self);
+        coverProvider = new CoverProvider(settings, self);
+
+        coverView->setModel(model);
+        // Both views share a selection, so everything reading it works the same in either mode
+        QItemSelectionModel* ownSelection = coverView->selectionModel();
+        coverView->setSelectionModel(view->selectionModel());
+        delete ownSelection;
+
+        coverView->setRootIndex(model->index(0, 0, {}));
+        coverView->setCoverSize(settings->value<Settings::Gui::Internal::ArtworkThumbnailSize>());
+        coverView->setVerticalScrollBarPolicy(view->verticalScrollBarPolicy());
+        coverView->viewport()->installEventFilter(new ToolTipFilter(self));
+        self->layout()->addWidget(coverView);
+
+        // The cover view shows the children of the 'All' node, which is replaced on reset
+        QObject::connect(model, &QAbstractItemModel::modelReset, coverView,
+                         [this]() { coverView->setRootIndex(model->index(0, 0, {})); });
+        QObject::connect(coverView, &FilterCoverView::doubleClicked, self,
+                         [this]() { emit self->doubleClicked(playlistNameFromSelection()); });
+        QObject::connect(coverView, &FilterCoverView::middleClicked, self,
+                         [this]() { emit self->middleClicked(playlistNameFromSelection()); });
+        settings->subscribe<Settings::Gui::Internal::ArtworkThumbnailSize>(
+            coverView, [this](int size) { coverView->setCoverSize(size); });
+    }
+
+    void setShowCovers(bool show)
+    {
+        showCovers = show;
+
+        if(show && !coverView) {
+            createCoverView();
+        }
+
+        if(coverView) {
+            coverView->setVisible(show);
+        }
+        view->setVisible(!show);
+
+        if(coverProvider && !show) {
+            coverProvider->cancelPending();
+        }
+        model->setCoverProvider(show ? coverProvider : nullptr);
+    }
+
     void hideHeader(bool hide) const
     {
         header->setFixedHeight(hide ? 0 : QWIDGETSIZE_MAX);
@@ -229,6 +278,12 @@ struct FilterWidget::Private
                          [this](bool checked) { multipleColumns = checked; });
         menu->addAction(multiColAction);
 
+        auto* coversAction = new QAction(tr("Show Covers"), menu);
+        coversAction->setCheckable(true);
+        coversAction->setChecked(showCovers);
+        QObject::connect(coversAction, &QAction::triggered, self, [this](bool checked) { setShowCovers(checked); });
+        menu->addAction(coversAction);
+
         menu->addSeparator();
         header->addHeaderContextMenu(menu, self->mapToGlobal(pos));
         menu->addSeparator();
@@ -257,11 +312,71 @@ struct FilterWidget::Private
             QMetaObject::invokeMethod(self, &FilterWidget::filterUpdated);
         }
     }
+
+    // Regroups updated tracks, keeping the selection
+    void updateTracks(const TrackList& tracks, bool notify)
+    {
+        if(tracks.empty()) {
+            if(notify) {
+                emit self->finishedUpdating();
+            }
+            return;
+        }
+
+        updating = true;
+
+        const QModelIndexList selectedRows = view->selectionModel()->selectedRows();
+
+        QStringList selected;
+        for(const QModelIndex& index : selectedRows) {
+            if(!index.parent().isValid()) {
+                selected.emplace_back(QStringLiteral(""));
+            }
+            else {
+                selected.emplace_back(index.data(Qt::DisplayRole).toString());
+            }
+        }
+
+        model->updateTracks(tracks);
+
+        QObject::connect(
+            model, &FilterModel::modelUpdated, self,
+            [this, selected, notify]() {
+                const QModelIndexList selectedIndexes = model->indexesForValues(selected);
+
+                QItemSelection indexesToSelect;
+                indexesToSelect.reserve(selectedIndexes.size());
+
+                const int columnCount = static_cast<int>(columns.size());
+
+                for(const QModelIndex& index : selectedIndexes) {
+                    if(index.isValid()) {
+                        const QModelIndex last = index.siblingAtColumn(columnCount - 1);
+                        indexesToSelect.append({index, last.isValid() ? last : index});
+                    }
+                }
+
+                view->selectionModel()->select(indexesToSelect, QItemSelectionModel::ClearAndSelect);
+                updating = false;
+                if(notify) {
+                    emit self->finishedUpdating();
+                }
+            },
+            Qt::SingleShotConnection);
+    }
+
+    [[nodiscard]] bool columnsUseStats()
+    {
+        return std::ranges::any_of(columns, [this](const FilterColumn& column) {
+            return columnParser.parse(column.field).dependencies.dependsOnStats();
+        });
+    }
+
 };
 
-FilterWidget::FilterWidget(SettingsManager* settings, QWidget* parent)
+FilterWidget::FilterWidget(const GroupingCache* groupingCache, SettingsManager* settings, QWidget* parent)
     : FyWidget{parent}
-    , p{std::make_unique<Private>(this, settings)}
+    , p{std::make_unique<Private>(this, groupingCache, settings)}
 {
     setObjectName(FilterWidget::name());
 
@@ -343,6 +458,11 @@ TrackList FilterWidget::filteredTracks() const
     return p->filteredTracks;
 }
 
+const RoaringBitmap& FilterWidget::filteredTrackIds() const
+{
+    return p->filteredIds;
+}
+
 QString FilterWidget::searchFilter() const
 {
     return p->searchStr;
@@ -371,11 +491,13 @@ void FilterWidget::refetchFilteredTracks()
 void FilterWidget::setFilteredTracks(const TrackList& tracks)
 {
     p->filteredTracks = tracks;
+    p->filteredIds    = RoaringBitmap::fromValues(tracks | std::views::transform(&Track::id));
 }
 
 void FilterWidget::clearFilteredTracks()
 {
     p->filteredTracks.clear();
+    p->filteredIds.clear();
 }
 
 void FilterWidget::reset(const TrackList& tracks)
@@ -394,7 +516,8 @@ void FilterWidget::softReset(const TrackList& tracks)
         selected.emplace_back(index.data(Qt::DisplayRole).toString());
     }
 
-    reset(tracks);
+    p->tracks = tracks;
+    p->model->setTracks(tracks);
 
     QObject::connect(
         p->model, &FilterModel::modelUpdated, this,
@@ -421,7 +544,11 @@ void FilterWidget::softReset(const TrackList& tracks)
 
 void FilterWidget::setScrollbarEnabled(bool enabled)
 {
-    p->view->setVerticalScrollBarPolicy(enabled ? Qt::ScrollBarAsNeeded : Qt::ScrollBarAlwaysOff);
+    const auto policy = enabled ? Qt::ScrollBarAsNeeded : Qt::ScrollBarAlwaysOff;
+    p->view->setVerticalScrollBarPolicy(policy);
+    if(p->coverView) {
+        p->coverView->setVerticalScrollBarPolicy(policy);
+    }
 }
 
 QString FilterWidget::name() const
@@ -454,9 +581,10 @@ void FilterWidget::saveLayoutData(QJsonObject& layout)
     QByteArray state = p->header->saveHeaderState();
     state            = qCompress(state, 9);
 
-    layout[QStringLiteral("Group")] = p->group.name();
-    layout[QStringLiteral("Index")] = p->index;
-    layout[QStringLiteral("State")] = QString::fromUtf8(state.toBase64());
+    layout[QStringLiteral("Group")]      = p->group.name();
+    layout[QStringLiteral("Index")]      = p->index;
+    layout[QStringLiteral("State")]      = QString::fromUtf8(state.toBase64());
+    layout[QStringLiteral("ShowCovers")] = p->showCovers;
 }
 
 void FilterWidget::loadLayoutData(const QJsonObject& layout)
@@ -493,6 +621,10 @@ void FilterWidget::loadLayoutData(const QJsonObject& layout)
         p->index = layout.value(QStringLiteral("Index")).toInt();
     }
 
+    if(layout.value(QStringLiteral("ShowCovers")).toBool()) {
+        p->setShowCovers(true);
+    }
+
     emit filterUpdated();
 
     if(layout.contains(QStringLiteral("State"))) {
@@ -529,6 +661,7 @@ void FilterWidget::finalise()
 void FilterWidget::searchEvent(const QString& search)
 {
     p->filteredTracks.clear();
+    p->filteredIds.clear();
     emit requestSearch(search);
     p->searchStr = search;
 }
@@ -540,54 +673,18 @@ void FilterWidget::tracksAdded(const TrackList& tracks)
 
 void FilterWidget::tracksUpdated(const TrackList& tracks)
 {
-    if(tracks.empty()) {
-        emit finishedUpdating();
-        return;
-    }
-
-    p->updating = true;
-
-    const QModelIndexList selectedRows = p->view->selectionModel()->selectedRows();
-
-    QStringList selected;
-    for(const QModelIndex& index : selectedRows) {
-        if(!index.parent().isValid()) {
-            selected.emplace_back(QStringLiteral(""));
-        }
-        else {
-            selected.emplace_back(index.data(Qt::DisplayRole).toString());
-        }
-    }
-
-    p->model->updateTracks(tracks);
-
-    QObject::connect(
-        p->model, &FilterModel::modelUpdated, this,
-        [this, selected]() {
-            const QModelIndexList selectedIndexes = p->model->indexesForValues(selected);
-
-            QItemSelection indexesToSelect;
-            indexesToSelect.reserve(selectedIndexes.size());
-
-            const int columnCount = static_cast<int>(p->columns.size());
-
-            for(const QModelIndex& index : selectedIndexes) {
-                if(index.isValid()) {
-                    const QModelIndex last = index.siblingAtColumn(columnCount - 1);
-                    indexesToSelect.append({index, last.isValid() ? last : index});
-                }
-            }
-
-            p->view->selectionModel()->select(indexesToSelect, QItemSelectionModel::ClearAndSelect);
-            p->updating = false;
-            emit finishedUpdating();
-        },
-        Qt::SingleShotConnection);
+    p->updateTracks(tracks, true);
 }
 
 void FilterWidget::tracksPlayed(const TrackList& tracks)
 {
-    p->model->refreshTracks(tracks);
+    // Tracks only need to move if a column shows their stats
+    if(p->columnsUseStats()) {
+        p->updateTracks(tracks, false);
+    }
+    else {
+        p->model->refreshTracks(tracks);
+    }
 }
 
 void FilterWidget::tracksRemoved(const TrackList& tracks)
@@ -598,6 +695,10 @@ void FilterWidget::tracksRemoved(const TrackList& tracks)
 void FilterWidget::contextMenuEvent(QContextMenuEvent* event)
 {
     if(p->view->selectionModel()->selectedRows().empty()) {
+        // There's no header to right-click while showing covers
+        if(p->showCovers) {
+            p->filterHeaderMenu(event->pos());
+        }
         return;
     }
 
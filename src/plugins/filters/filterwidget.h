@@ -23,6 +23,8 @@
 #include <gui/fywidget.h>
 
 namespace Fooyin {
+class GroupingCache;
+class RoaringBitmap;
 class SettingsManager;
 class AutoHeaderView;
 class WidgetContext;
@@ -34,7 +36,7 @@ class FilterWidget : public FyWidget
     Q_OBJECT
 
 public:
-    explicit FilterWidget(SettingsManager* settings, QWidget* parent = nullptr);
+    FilterWidget(const GroupingCache* groupingCache, SettingsManager* settings, QWidget* parent = nullptr);
     ~FilterWidget() override;
 
     [[nodiscard]] Id group() const;
@@ -43,6 +45,8 @@ public:
     [[nodiscard]] bool isActive() const;
     [[nodiscard]] TrackList tracks() const;
     [[nodiscard]] TrackList filteredTracks() const;
+    /** Returns the ids of filteredTracks, for intersecting with other filters. */
+    [[nodiscard]] const RoaringBitmap& filteredTrackIds() const;
     [[nodiscard]] QString searchFilter() const;
     [[nodiscard]] WidgetContext* widgetContext() const;
 
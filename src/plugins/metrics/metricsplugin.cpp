@@ -0,0 +1,174 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "metricsplugin.h"
+
+#include "metricsserver.h"
+#include "metricssettings.h"
+
+#include <core/engine/enginecontroller.h>
+#include <utils/memoryusage.h>
+#include <utils/metrics.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QDebug>
+#include <QHostAddress>
+
+constexpr auto MicrosPerSecond = 1000000.0;
+constexpr auto MillisPerSecond = 1000.0;
+
+namespace {
+double seconds(uint64_t micros)
+{
+    return static_cast<double>(micros) / MicrosPerSecond;
+}
+
+void collectEngine(Fooyin::EngineController* engine, Fooyin::Metrics::SampleList& samples)
+{
+    using Fooyin::Metrics::Type;
+
+    const auto stats = engine->engineStats();
+    const auto fill  = engine->bufferFill();
+    const auto pool  = engine->bufferPoolStats();
+
+    for(const auto& [output, underruns] : stats.outputUnderruns) {
+        samples.push_back({QStringLiteral("fooyin_engine_underruns"),
+                           QStringLiteral("Times the output ran out of audio during playback"), Type::Counter,
+                           Fooyin::Metrics::label(QStringLiteral("output"), output), static_cast<double>(underruns)});
+    }
+
+    samples.push_back({QStringLiteral("fooyin_engine_decode_max_seconds"),
+                       QStringLiteral("Longest time taken to decode a buffer this session"), Type::Gauge, {},
+                       seconds(stats.maxDecodeTime)});
+    samples.push_back({QStringLiteral("fooyin_engine_queued_frames"),
+                       QStringLiteral("Frames waiting in the renderer for the output"), Type::Gauge, {},
+                       static_cast<double>(stats.queuedFrames)});
+    samples.push_back({QStringLiteral("fooyin_engine_output_latency_seconds"),
+                       QStringLiteral("Time taken for audio handed to the output to be heard"), Type::Gauge, {},
+                       seconds(stats.outputLatency)});
+    samples.push_back({QStringLiteral("fooyin_engine_timer_lateness_max_seconds"),
+                       QStringLiteral("Furthest a write to the output has run behind this session"), Type::Gauge, {},
+                       seconds(stats.maxTimerLateness)});
+
+    samples.push_back({QStringLiteral("fooyin_engine_buffer_fill_ratio"),
+                       QStringLiteral("Decoded audio held ahead of the output, as a share of the target"), Type::Gauge,
+                       {}, fill.fill()});
+    samples.push_back({QStringLiteral("fooyin_engine_buffered_seconds"),
+                       QStringLiteral("Decoded audio held ahead of the output"), Type::Gauge, {},
+                       static_cast<double>(fill.buffered) / MillisPerSecond});
+
+    samples.push_back({QStringLiteral("fooyin_buffer_pool_hits"),
+                       QStringLiteral("Audio buffers served from the pool"), Type::Counter, {},
+                       static_cast<double>(pool.hits)});
+    samples.push_back({QStringLiteral("fooyin_buffer_pool_misses"),
+                       QStringLiteral("Audio buffers allocated as the pool had none to reuse"), Type::Counter, {},
+                       static_cast<double>(pool.misses)});
+    samples.push_back({QStringLiteral("fooyin_buffer_pool_bytes"),
+                       QStringLiteral("Bytes held by the pool for reuse"), Type::Gauge, {},
+                       static_cast<double>(pool.pooledBytes)});
+}
+
+void collectMemory(Fooyin::Metrics::SampleList& samples)
+{
+    using Fooyin::Metrics::Type;
+
+    const auto report = Fooyin::MemoryUsage::report();
+
+    for(const auto& [name, usage, trimmable] : report) {
+        const QString labels = Fooyin::Metrics::label(QStringLiteral("subsystem"), name);
+        samples.push_back({QStringLiteral("fooyin_memory_bytes"), QStringLiteral("Memory held by each subsystem"),
+                           Type::Gauge, labels, static_cast<double>(usage.bytes)});
+        samples.push_back({QStringLiteral("fooyin_memory_entries"), QStringLiteral("Items held by each subsystem"),
+                           Type::Gauge, labels, static_cast<double>(usage.entries)});
+    }
+
+    if(const auto pressure = Fooyin::MemoryUsage::pressure()) {
+        samples.push_back({QStringLiteral("fooyin_memory_pressure_ratio"),
+                           QStringLiteral("Share of the last 10 seconds stalled waiting on memory"), Type::Gauge, {},
+                           *pressure / 100.0});
+    }
+}
+} // namespace
+
+namespace Fooyin::OpenMetrics {
+struct MetricsPlugin::Private
+{
+    SettingsManager* settings{nullptr};
+    std::unique_ptr<MetricsSettings> metricsSettings;
+    MetricsServer server;
+    std::vector<int> collectors;
+
+    void updateServer()
+    {
+        if(!settings->value<Settings::Metrics::Enabled>()) {
+            server.close();
+            return;
+        }
+
+        const QHostAddress address{settings->value<Settings::Metrics::Address>()};
+        const int port = settings->value<Settings::Metrics::Port>();
+        if(address.isNull() || port <= 0 || port > 65535) {
+            qWarning() << "[Metrics] Invalid address" << settings->value<Settings::Metrics::Address>() << port;
+            server.close();
+            return;
+        }
+
+        server.listen(address, static_cast<quint16>(port));
+    }
+};
+
+MetricsPlugin::MetricsPlugin()
+    : p{std::make_unique<Private>()}
+{ }
+
+MetricsPlugin::~MetricsPlugin()
+{
+    shutdown();
+}
+
+void MetricsPlugin::initialise(const CorePluginContext& context)
+{
+    p->settings        = context.settingsManager;
+    p->metricsSettings = std::make_unique<MetricsSettings>(p->settings);
+
+    auto* engine = context.engine;
+    p->collectors.push_back(
+        Metrics::addCollector([engine](Metrics::SampleList& samples) { collectEngine(engine, samples); }));
+    p->collectors.push_back(Metrics::addCollector(collectMemory));
+
+    p->updateServer();
+
+    const auto updateServer = [this]() { p->updateServer(); };
+    p->settings->subscribe<Settings::Metrics::Enabled>(this, updateServer);
+    p->settings->subscribe<Settings::Metrics::Address>(this, updateServer);
+    p->settings->subscribe<Settings::Metrics::Port>(this, updateServer);
+}
+
+void MetricsPlugin::shutdown()
+{
+    p->server.close();
+
+    for(const int collector : p->collectors) {
+        Metrics::removeCollector(collector);
+    }
+    p->collectors.clear();
+}
+} // namespace Fooyin::OpenMetrics
+
+#include "moc_metricsplugin.cpp"
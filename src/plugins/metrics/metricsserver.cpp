@@ -0,0 +1,124 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "metricsserver.h"
+
+#include <utils/metrics.h>
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+// Anything longer isn't a scrape, so the connection is dropped
+constexpr auto MaxRequestSize = 8 * 1024;
+// Connections which don't send a complete request line in time are dropped
+constexpr auto RequestTimeout = 5000; // ms
+
+constexpr auto MetricsPath = "/metrics";
+constexpr auto ContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+namespace {
+void respond(QTcpSocket* socket, const QByteArray& status, const QByteArray& contentType, const QByteArray& body)
+{
+    QByteArray response = "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+} // namespace
+
+namespace Fooyin::OpenMetrics {
+MetricsServer::MetricsServer(QObject* parent)
+    : QObject{parent}
+    , m_server{new QTcpServer(this)}
+{
+    QObject::connect(m_server, &QTcpServer::newConnection, this, &MetricsServer::handleConnection);
+}
+
+bool MetricsServer::listen(const QHostAddress& address, quint16 port)
+{
+    close();
+
+    if(!m_server->listen(address, port)) {
+        qWarning() << "[Metrics] Unable to listen on" << address.toString() << port << ":" << m_server->errorString();
+        return false;
+    }
+
+    qInfo() << "[Metrics] Serving metrics on" << address.toString() << m_server->serverPort();
+    return true;
+}
+
+void MetricsServer::close()
+{
+    if(m_server->isListening()) {
+        m_server->close();
+    }
+}
+
+void MetricsServer::handleConnection()
+{
+    while(QTcpSocket* socket = m_server->nextPendingConnection()) {
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        QObject::connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleRequest(socket); });
+        QTimer::singleShot(RequestTimeout, socket, [socket]() { socket->abort(); });
+    }
+}
+
+void MetricsServer::handleRequest(QTcpSocket* socket)
+{
+    if(!socket->canReadLine()) {
+        if(socket->bytesAvailable() > MaxRequestSize) {
+            socket->abort();
+        }
+        return;
+    }
+
+    // Only the request line matters, so headers and any body are ignored
+    const QByteArray requestLine = socket->readLine(MaxRequestSize).trimmed();
+    QObject::disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+
+    const QList<QByteArray> parts = requestLine.split(' ');
+    if(parts.size() != 3 || !parts.at(2).startsWith("HTTP/")) {
+        respond(socket, "400 Bad Request", "text/plain", "Bad Request\n");
+        return;
+    }
+
+    if(parts.at(0) != "GET") {
+        respond(socket, "405 Method Not Allowed", "text/plain", "Method Not Allowed\n");
+        return;
+    }
+
+    // Scrapers may add a query string, e.g. to select a format, which there's no need to honour
+    const QByteArray path = parts.at(1).split('?').constFirst();
+    if(path != MetricsPath) {
+        respond(socket, "404 Not Found", "text/plain", "Not Found\n");
+        return;
+    }
+
+    respond(socket, "200 OK", ContentType, Metrics::openMetrics());
+}
+} // namespace Fooyin::OpenMetrics
+
+#include "moc_metricsserver.cpp"
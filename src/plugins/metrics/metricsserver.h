@@ -0,0 +1,50 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+
+class QHostAddress;
+class QTcpServer;
+class QTcpSocket;
+
+namespace Fooyin::OpenMetrics {
+/*!
+ * A minimal HTTP server answering GET /metrics with Metrics::openMetrics().
+ * Each connection is closed after a single response, which is all scrapers need.
+ */
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(QObject* parent = nullptr);
+
+    /** Starts listening on @p address and @p port, closing any previous listener first. */
+    bool listen(const QHostAddress& address, quint16 port);
+    void close();
+
+private:
+    void handleConnection();
+    void handleRequest(QTcpSocket* socket);
+
+    QTcpServer* m_server;
+};
+} // namespace Fooyin::OpenMetrics
@@ -0,0 +1,38 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "metricssettings.h"
+
+#include <utils/settings/settingsmanager.h>
+
+// The port commonly used by OpenMetrics exporters
+constexpr auto DefaultPort = 9464;
+
+namespace Fooyin::OpenMetrics {
+MetricsSettings::MetricsSettings(SettingsManager* settingsManager)
+    : m_settings{settingsManager}
+{
+    using namespace Settings::Metrics;
+
+    m_settings->createSetting<Enabled>(false, QStringLiteral("Metrics/Enabled"));
+    // Only reachable from this machine unless changed, as the metrics aren't authenticated
+    m_settings->createSetting<Address>(QStringLiteral("127.0.0.1"), QStringLiteral("Metrics/Address"));
+    m_settings->createSetting<Port>(DefaultPort, QStringLiteral("Metrics/Port"));
+}
+} // namespace Fooyin::OpenMetrics
@@ -31,12 +31,21 @@
 #include "mprisroot.h"
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QDBusObjectPath>
+#include <QFile>
+#include <QTimerEvent>
+
+#include <map>
+#include <utility>
 
 constexpr auto MprisObjectPath = "/org/mpris/MediaPlayer2";
 constexpr auto ServiceName     = "org.mpris.MediaPlayer2.fooyin";
+constexpr auto RootEntity      = "org.mpris.MediaPlayer2";
 constexpr auto PlayerEntity    = "org.mpris.MediaPlayer2.Player";
 constexpr auto DbusPath        = "org.freedesktop.DBus.Properties";
+// Minimum time between Seeked signals, as clients re-query the position on each one
+constexpr auto SeekedInterval = 100;
 
 namespace {
 QDBusObjectPath formatTrackId(int index)
@@ -54,11 +63,27 @@ QString formatDateTime(uint64_t time)
     const auto dateTime = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(time));
     return dateTime.toString(Qt::ISODate);
 }
+
+QString interfaceFor(const QString& property)
+{
+    if(property == u"Fullscreen") {
+        return QString::fromLatin1(RootEntity);
+    }
+    return QString::fromLatin1(PlayerEntity);
+}
+
+QString coverPathFor(const Track& track)
+{
+    // One file per album so clients caching art by URL pick up the change
+    const QByteArray hash = QCryptographicHash::hash(track.albumHash().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return Fooyin::Gui::coverPath() + QStringLiteral("mpris-") + QString::fromLatin1(hash) + QStringLiteral(".jpg");
+}
 } // namespace
 
 namespace Fooyin::Mpris {
 MprisPlugin::MprisPlugin()
-    : m_registered{false}
+    : m_windowController{nullptr}
+    , m_registered{false}
     , m_coverProvider{nullptr}
 { }
 
@@ -69,45 +94,23 @@ void MprisPlugin::initialise(const CorePluginContext& context)
     m_settings         = context.settingsManager;
 
     QObject::connect(m_playerController, &PlayerController::playModeChanged, this, [this]() {
-        notify(QStringLiteral("LoopStatus"), loopStatus());
-        notify(QStringLiteral("Shuffle"), shuffle());
-        notify(QStringLiteral("CanGoNext"), canGoNext());
-        notify(QStringLiteral("CanGoPrevious"), canGoPrevious());
+        notify(QStringLiteral("LoopStatus"));
+        notify(QStringLiteral("Shuffle"));
+        notify(QStringLiteral("CanGoNext"));
+        notify(QStringLiteral("CanGoPrevious"));
     });
     QObject::connect(m_playerController, &PlayerController::playStateChanged, this, [this]() {
-        notify(QStringLiteral("PlaybackStatus"), playbackStatus());
-        notify(QStringLiteral("CanPause"), canPause());
-        notify(QStringLiteral("CanPlay"), canPlay());
-        notify(QStringLiteral("CanGoNext"), canGoNext());
-        notify(QStringLiteral("CanGoPrevious"), canGoPrevious());
-        notify(QStringLiteral("CanSeek"), canSeek());
+        notify(QStringLiteral("PlaybackStatus"));
+        notify(QStringLiteral("CanPause"));
+        notify(QStringLiteral("CanPlay"));
+        notify(QStringLiteral("CanGoNext"));
+        notify(QStringLiteral("CanGoPrevious"));
+        notify(QStringLiteral("CanSeek"));
     });
     QObject::connect(m_playerController, &PlayerController::playlistTrackChanged, this, &MprisPlugin::trackChanged);
-    QObject::connect(m_playerController, &PlayerController::positionMoved, this,
-                     [this](uint64_t ms) { emit Seeked(static_cast<int64_t>(ms) * 1000); });
-}
-
-void MprisPlugin::initialise(const GuiPluginContext& context)
-{
-    m_windowController = context.windowController;
-    m_coverProvider    = new CoverProvider(m_settings, this);
-
-    m_coverProvider->setUsePlaceholder(false);
-    m_coverProvider->setAlwaysStoreThumbnail(true);
-    m_coverProvider->setLimitThumbSize(false);
-    m_coverProvider->setCoverKey(QStringLiteral("MPRISCOVER"));
-
-    QObject::connect(m_windowController, &WindowController::isFullScreenChanged, this,
-                     [this]() { notify(QStringLiteral("Fullscreen"), fullscreen()); });
-
-    QObject::connect(m_coverProvider, &CoverProvider::coverAdded, this, [this](const Track& track) {
-        const auto currentTrack = m_playerController->currentPlaylistTrack();
-        if(track.id() == currentTrack.track.id()) {
-            loadMetaData(currentTrack);
-            notify(QStringLiteral("Metadata"), metadata());
-        }
-    });
+    QObject::connect(m_playerController, &PlayerController::positionMoved, this, &MprisPlugin::notifySeeked);
 
+    // Registered here rather than with the GUI, so a headless instance can be controlled too
     new MprisRoot(this);
     new MprisPlayer(this);
 
@@ -129,6 +132,28 @@ void MprisPlugin::initialise(const GuiPluginContext& context)
     m_registered = true;
 }
 
+void MprisPlugin::initialise(const GuiPluginContext& context)
+{
+    m_windowController = context.windowController;
+    m_coverProvider    = new CoverProvider(m_settings, this);
+
+    m_coverProvider->setUsePlaceholder(false);
+    m_coverProvider->setAlwaysStoreThumbnail(true);
+    m_coverProvider->setLimitThumbSize(false);
+    m_coverProvider->setCoverKey(QStringLiteral("MPRISCOVER"));
+
+    QObject::connect(m_windowController, &WindowController::isFullScreenChanged, this,
+                     [this]() { notify(QStringLiteral("Fullscreen")); });
+
+    QObject::connect(m_coverProvider, &CoverProvider::coverAdded, this, [this](const Track& track) {
+        const auto currentTrack = m_playerController->currentPlaylistTrack();
+        if(track.id() == currentTrack.track.id() && !m_currentMetaData.contains(QStringLiteral("mpris:artUrl"))) {
+            loadMetaData(currentTrack);
+            notify(QStringLiteral("Metadata"));
+        }
+    });
+}
+
 void MprisPlugin::shutdown()
 {
     if(!m_registered) {
@@ -150,7 +175,7 @@ QString MprisPlugin::desktopEntry() const
 
 bool MprisPlugin::canRaise() const
 {
-    return true;
+    return m_windowController != nullptr;
 }
 
 bool MprisPlugin::canQuit() const
@@ -160,17 +185,19 @@ bool MprisPlugin::canQuit() const
 
 bool MprisPlugin::canSetFullscreen() const
 {
-    return true;
+    return m_windowController != nullptr;
 }
 
 bool MprisPlugin::fullscreen() const
 {
-    return m_windowController->isFullScreen();
+    return m_windowController && m_windowController->isFullScreen();
 }
 
 void MprisPlugin::setFullscreen(bool fullscreen)
 {
-    m_windowController->setFullScreen(fullscreen);
+    if(m_windowController) {
+        m_windowController->setFullScreen(fullscreen);
+    }
 }
 
 QStringList MprisPlugin::supportedUriSchemes() const
@@ -321,7 +348,9 @@ double MprisPlugin::maximumRate() const
 
 void MprisPlugin::Raise()
 {
-    m_windowController->raise();
+    if(m_windowController) {
+        m_windowController->raise();
+    }
 }
 
 void MprisPlugin::Quit()
@@ -370,29 +399,90 @@ void MprisPlugin::SetPosition(const QDBusObjectPath& /*path*/, int64_t position)
     m_playerController->seek(position / 1000);
 }
 
-void MprisPlugin::notify(const QString& name, const QVariant& value)
+void MprisPlugin::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == m_notifyTimer.timerId()) {
+        m_notifyTimer.stop();
+        sendPendingChanges();
+    }
+    else if(event->timerId() == m_seekTimer.timerId()) {
+        m_seekTimer.stop();
+        if(m_pendingSeek) {
+            emit Seeked(std::exchange(m_pendingSeek, {}).value());
+            m_lastSeeked.start();
+        }
+    }
+
+    QObject::timerEvent(event);
+}
+
+void MprisPlugin::notify(const QString& name)
+{
+    if(!m_pendingProperties.contains(name)) {
+        m_pendingProperties.append(name);
+    }
+
+    if(!m_notifyTimer.isActive()) {
+        m_notifyTimer.start(0, this);
+    }
+}
+
+void MprisPlugin::sendPendingChanges()
+{
+    std::map<QString, QVariantMap> changes;
+
+    for(const QString& name : std::as_const(m_pendingProperties)) {
+        changes[interfaceFor(name)].insert(name, property(name.toLatin1().constData()));
+    }
+    m_pendingProperties.clear();
+
+    for(const auto& [interface, properties] : changes) {
+        QDBusMessage msg = QDBusMessage::createSignal(
+            QString::fromLatin1(MprisObjectPath), QString::fromLatin1(DbusPath), QStringLiteral("PropertiesChanged"));
+        msg.setArguments({interface, properties, QStringList{}});
+        QDBusConnection::sessionBus().send(msg);
+    }
+}
+
+void MprisPlugin::notifySeeked(uint64_t ms)
 {
-    QDBusMessage msg = QDBusMessage::createSignal(QString::fromLatin1(MprisObjectPath), QString::fromLatin1(DbusPath),
-                                                  QStringLiteral("PropertiesChanged"));
-    QVariantMap map;
-    map.insert(name, value);
-    msg.setArguments({QString::fromLatin1(PlayerEntity), map, QStringList{}});
-    QDBusConnection::sessionBus().send(msg);
+    const auto pos = static_cast<int64_t>(ms) * 1000;
+
+    if(!m_lastSeeked.isValid() || m_lastSeeked.elapsed() >= SeekedInterval) {
+        m_pendingSeek.reset();
+        m_seekTimer.stop();
+        emit Seeked(pos);
+        m_lastSeeked.start();
+        return;
+    }
+
+    // Collapse back-to-back seeks (e.g. dragging the seekbar), always sending the final position
+    m_pendingSeek = pos;
+    if(!m_seekTimer.isActive()) {
+        m_seekTimer.start(static_cast<int>(SeekedInterval - m_lastSeeked.elapsed()), this);
+    }
 }
 
 void MprisPlugin::trackChanged(const PlaylistTrack& playlistTrack)
 {
-    if(m_coverProvider) {
+    if(playlistTrack == m_metaDataTrack) {
+        return;
+    }
+
+    if(m_coverProvider && coverPathFor(playlistTrack.track) != m_coverPath) {
+        // The thumbnail is cached under a fixed key, so drop the previous album's cover
         CoverProvider::removeFromCache(QStringLiteral("MPRISCOVER"));
     }
+
+    m_metaDataTrack = playlistTrack;
     m_currentMetaData.clear();
 
     if(playlistTrack.isValid()) {
         loadMetaData(playlistTrack);
-        notify(QStringLiteral("Metadata"), metadata());
-        notify(QStringLiteral("CanSeek"), canSeek());
-        notify(QStringLiteral("CanGoNext"), canGoNext());
-        notify(QStringLiteral("CanGoPrevious"), canGoPrevious());
+        notify(QStringLiteral("Metadata"));
+        notify(QStringLiteral("CanSeek"));
+        notify(QStringLiteral("CanGoNext"));
+        notify(QStringLiteral("CanGoPrevious"));
     }
 }
 
@@ -418,16 +508,29 @@ void MprisPlugin::loadMetaData(const PlaylistTrack& playlistTrack)
         m_currentMetaData[QStringLiteral("xesam:useCount")]    = track.playCount();
     }
 
-    if(m_coverProvider) {
+    if(!m_coverProvider) {
+        return;
+    }
+
+    const QString coverPath = coverPathFor(track);
+
+    if(coverPath != m_coverPath) {
+        if(!m_coverPath.isEmpty()) {
+            QFile::remove(m_coverPath);
+        }
+        m_coverPath.clear();
+    }
+
+    // Thumbnails are cached in a pack file, so export the cover once per album for clients which need a file
+    if(coverPath != m_coverPath || !QFile::exists(coverPath)) {
         const QPixmap cover = m_coverProvider->trackCoverThumbnail(track, Track::Cover::Front);
-        if(cover.isNull()) {
+        if(cover.isNull() || !cover.save(coverPath, "JPG", 85)) {
             return;
         }
-
-        static const QString coverPath
-            = Fooyin::Gui::coverPath() + QStringLiteral("MPRISCOVER") + QStringLiteral(".jpg");
-        m_currentMetaData[QStringLiteral("mpris:artUrl")] = QUrl::fromLocalFile(coverPath).toString();
+        m_coverPath = coverPath;
     }
+
+    m_currentMetaData[QStringLiteral("mpris:artUrl")] = QUrl::fromLocalFile(coverPath).toString();
 }
 } // namespace Fooyin::Mpris
 
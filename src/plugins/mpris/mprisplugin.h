@@ -19,17 +19,21 @@
 
 #pragma once
 
+#include <core/player/playerdefs.h>
 #include <core/plugins/coreplugin.h>
 #include <core/plugins/plugin.h>
 #include <core/track.h>
 #include <gui/coverprovider.h>
 #include <gui/plugins/guiplugin.h>
 
+#include <QBasicTimer>
+#include <QElapsedTimer>
+
+#include <optional>
+
 class QDBusObjectPath;
 
 namespace Fooyin {
-struct PlaylistTrack;
-
 namespace Mpris {
 class MprisPlugin : public QObject,
                     public Plugin,
@@ -121,8 +125,13 @@ public:
 signals:
     void Seeked(int64_t position);
 
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
 private:
-    void notify(const QString& name, const QVariant& value);
+    void notify(const QString& name);
+    void sendPendingChanges();
+    void notifySeeked(uint64_t ms);
     void trackChanged(const PlaylistTrack& playlistTrack);
     void loadMetaData(const PlaylistTrack& playlistTrack);
 
@@ -132,8 +141,18 @@ private:
     SettingsManager* m_settings;
 
     bool m_registered;
+    PlaylistTrack m_metaDataTrack;
     QVariantMap m_currentMetaData;
+    QString m_coverPath;
     CoverProvider* m_coverProvider;
+
+    // Properties changed since the last PropertiesChanged signal, sent together on the next event loop pass
+    QStringList m_pendingProperties;
+    QBasicTimer m_notifyTimer;
+
+    QElapsedTimer m_lastSeeked;
+    std::optional<int64_t> m_pendingSeek;
+    QBasicTimer m_seekTimer;
 };
 } // namespace Mpris
 } // namespace Fooyin
@@ -25,7 +25,10 @@
 #include "pipewirestream.h"
 #include "pipewirethreadloop.h"
 
+#include <utils/spscringbuffer.h>
+
 #include <pipewire/pipewire.h>
+#include <pipewire/version.h>
 #include <spa/param/audio/format-utils.h>
 #include <spa/pod/builder.h>
 #include <spa/utils/result.h>
@@ -50,6 +53,7 @@ spa_audio_format findSpaFormat(const Fooyin::SampleFormat& format)
             return SPA_AUDIO_FORMAT_U8;
         case(Fooyin::SampleFormat::S16):
             return SPA_AUDIO_FORMAT_S16;
+        // 24-bit samples are held in the high bits of a 32-bit word, i.e. as S32
         case(Fooyin::SampleFormat::S24):
         case(Fooyin::SampleFormat::S32):
             return SPA_AUDIO_FORMAT_S32;
@@ -132,8 +136,12 @@ struct PipeWireOutput::Private
 
     AudioFormat format;
 
-    AudioBuffer buffer;
-    uint32_t bufferPos{0};
+    // Written by the engine and read from the real-time process callback
+    SpscRingBuffer<std::byte> ringBuffer;
+    // The ring can only be emptied from the consumer side while the stream is running
+    std::atomic<size_t> discardPos{0};
+
+    std::atomic<AudioSource*> source{nullptr};
 
     std::unique_ptr<PipewireThreadLoop> loop;
     std::unique_ptr<PipewireContext> context;
@@ -172,8 +180,24 @@ struct PipeWireOutput::Private
             registry.reset(nullptr);
         }
 
-        buffer.clear();
-        bufferPos = 0;
+        ringBuffer.clear();
+        discardPos.store(0, std::memory_order_relaxed);
+    }
+
+    void applyDiscard()
+    {
+        const size_t discard = discardPos.load(std::memory_order_acquire);
+        const size_t read    = ringBuffer.totalRead();
+        if(discard > read) {
+            ringBuffer.skip(discard - read);
+        }
+    }
+
+    [[nodiscard]] int queuedFrames() const
+    {
+        const size_t written = ringBuffer.totalWritten();
+        const size_t read    = std::max(ringBuffer.totalRead(), discardPos.load(std::memory_order_acquire));
+        return written > read ? static_cast<int>((written - read) / format.bytesPerFrame()) : 0;
     }
 
     bool initCore()
@@ -260,11 +284,55 @@ struct PipeWireOutput::Private
         return stream->connect(PW_ID_ANY, PW_DIRECTION_OUTPUT, params, flags);
     }
 
+    void processPull(AudioSource* audioSource)
+    {
+        auto* pwBuffer = stream->dequeueBuffer();
+        if(!pwBuffer) {
+            return;
+        }
+
+        const spa_data& data = pwBuffer->buffer->datas[0];
+        if(!data.data) {
+            stream->queueBuffer(pwBuffer);
+            return;
+        }
+
+        const int stride = format.bytesPerFrame();
+        auto frames      = static_cast<int>(data.maxsize / stride);
+#if PW_CHECK_VERSION(0, 3, 49)
+        if(pwBuffer->requested > 0) {
+            frames = std::min(frames, static_cast<int>(pwBuffer->requested));
+        }
+#endif
+
+        auto* dst            = static_cast<std::byte*>(data.data);
+        const int framesRead = audioSource->readFrames(dst, frames);
+
+        if(framesRead < frames) {
+            // Underrun or end of track: pad the period with silence
+            const auto silence = format.sampleFormat() == SampleFormat::U8 ? std::byte{0x80} : std::byte{0};
+            std::fill(dst + framesRead * stride, dst + frames * stride, silence);
+        }
+
+        data.chunk->offset = 0;
+        data.chunk->stride = stride;
+        data.chunk->size   = static_cast<uint32_t>(frames * stride);
+
+        stream->queueBuffer(pwBuffer);
+    }
+
     static void process(void* userData)
     {
         auto* self = static_cast<PipeWireOutput::Private*>(userData);
 
-        if(!self->bufferPos) {
+        if(auto* audioSource = self->source.load(std::memory_order_acquire)) {
+            self->processPull(audioSource);
+            return;
+        }
+
+        self->applyDiscard();
+
+        if(self->ringBuffer.empty()) {
             self->loop->signal(false);
             return;
         }
@@ -277,16 +345,13 @@ struct PipeWireOutput::Private
 
         const spa_data& data = pwBuffer->buffer->datas[0];
 
-        const auto size = std::min(data.maxsize, self->bufferPos);
-        auto* dst       = data.data;
-
-        std::memcpy(dst, self->buffer.data(), self->bufferPos);
-        self->bufferPos -= size;
-        self->buffer.erase(size);
+        const auto stride    = static_cast<size_t>(self->format.bytesPerFrame());
+        const size_t maxSize = std::min(static_cast<size_t>(data.maxsize), self->ringBuffer.readAvailable());
+        const size_t size    = self->ringBuffer.read(static_cast<std::byte*>(data.data), maxSize - (maxSize % stride));
 
         data.chunk->offset = 0;
-        data.chunk->stride = self->format.bytesPerFrame();
-        data.chunk->size   = size;
+        data.chunk->stride = static_cast<int32_t>(stride);
+        data.chunk->size   = static_cast<uint32_t>(size);
 
         self->stream->queueBuffer(pwBuffer);
         self->loop->signal(false);
@@ -326,7 +391,6 @@ PipeWireOutput::~PipeWireOutput() = default;
 bool PipeWireOutput::init(const AudioFormat& format)
 {
     p->format = format;
-    p->buffer = {format, 0};
 
     pw_init(nullptr, nullptr);
 
@@ -334,6 +398,9 @@ bool PipeWireOutput::init(const AudioFormat& format)
         return false;
     }
 
+    p->ringBuffer.resize(static_cast<size_t>(format.bytesForFrames(p->stream->bufferSize())));
+    p->discardPos.store(0, std::memory_order_relaxed);
+
     if(p->pendingVolumeChange) {
         p->pendingVolumeChange = false;
         setVolume(p->volume);
@@ -355,6 +422,7 @@ void PipeWireOutput::reset()
         const ThreadLoopGuard guard{p->loop.get()};
     }
 
+    p->discardPos.store(p->ringBuffer.totalWritten(), std::memory_order_release);
     p->stream->flush(false);
 }
 
@@ -398,16 +466,35 @@ OutputDevices PipeWireOutput::getAllDevices() const
     return devices;
 }
 
+AudioOutput::Capabilities PipeWireOutput::capabilities() const
+{
+    return PullMode;
+}
+
 OutputState PipeWireOutput::currentState()
 {
     OutputState state;
 
-    state.queuedSamples = p->buffer.frameCount();
-    state.freeSamples   = p->stream->bufferSize() - state.queuedSamples;
+    if(p->source.load(std::memory_order_relaxed)) {
+        // Nothing is queued on our side when pulling
+        state.freeSamples = p->stream->bufferSize();
+        return state;
+    }
+
+    state.queuedSamples = p->queuedFrames();
+    state.freeSamples   = std::max(0, p->stream->bufferSize() - state.queuedSamples);
+    // Our own queue is played after everything the graph already holds
+    const double queued = static_cast<double>(state.queuedSamples) / p->format.sampleRate();
+    state.delay         = std::max(latency(), 0.0) + queued;
 
     return state;
 }
 
+double PipeWireOutput::latency() const
+{
+    return p->stream ? p->stream->delay(p->format.sampleRate()) : -1.0;
+}
+
 int PipeWireOutput::bufferSize() const
 {
     return p->stream ? p->stream->bufferSize() : 0;
@@ -415,12 +502,22 @@ int PipeWireOutput::bufferSize() const
 
 int PipeWireOutput::write(const AudioBuffer& buffer)
 {
-    const ThreadLoopGuard guard{p->loop.get()};
+    const auto stride = static_cast<size_t>(p->format.bytesPerFrame());
+    if(stride == 0) {
+        return 0;
+    }
 
-    p->buffer.append(buffer.constData());
-    p->bufferPos += buffer.byteCount();
+    const auto data      = buffer.constData();
+    const size_t free    = p->ringBuffer.writeAvailable();
+    const size_t count   = std::min(data.size(), free - (free % stride));
+    const size_t written = p->ringBuffer.write(data.data(), count - (count % stride));
 
-    return buffer.sampleCount();
+    return static_cast<int>(written / stride);
+}
+
+void PipeWireOutput::setSource(AudioSource* source)
+{
+    p->source.store(source, std::memory_order_release);
 }
 
 void PipeWireOutput::setPaused(bool pause)
@@ -39,9 +39,12 @@ public:
     [[nodiscard]] QString device() const override;
     [[nodiscard]] OutputDevices getAllDevices() const override;
 
+    [[nodiscard]] Capabilities capabilities() const override;
     OutputState currentState() override;
     int bufferSize() const override;
+    [[nodiscard]] double latency() const override;
     int write(const AudioBuffer& buffer) override;
+    void setSource(AudioSource* source) override;
     void setPaused(bool pause) override;
 
     void setVolume(double volume) override;
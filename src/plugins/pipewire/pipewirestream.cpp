@@ -22,10 +22,13 @@
 #include <core/engine/audiobuffer.h>
 
 #include <pipewire/keys.h>
+#include <pipewire/version.h>
 #include <spa/param/props.h>
 
 #include <QDebug>
 
+#include <algorithm>
+
 #ifdef __clang__
 #pragma clang diagnostic ignored "-Wgnu-statement-expression-from-macro-expansion"
 #endif
@@ -68,6 +71,31 @@ int PipewireStream::bufferSize() const
     return BufferSize;
 }
 
+double PipewireStream::delay(int sampleRate) const
+{
+    if(sampleRate <= 0) {
+        return -1.0;
+    }
+
+    pw_time time{};
+#if PW_CHECK_VERSION(0, 3, 50)
+    if(pw_stream_get_time_n(m_stream.get(), &time, sizeof(time)) < 0 || time.rate.denom == 0) {
+        return -1.0;
+    }
+    // Frames held by resamplers and converters inside the stream
+    const double buffered = static_cast<double>(time.buffered) / sampleRate;
+#else
+    if(pw_stream_get_time(m_stream.get(), &time) < 0 || time.rate.denom == 0) {
+        return -1.0;
+    }
+    const double buffered{0.0};
+#endif
+
+    // The graph's delay to the device is given in units of its clock rate
+    const double graphDelay = static_cast<double>(time.delay) * time.rate.num / time.rate.denom;
+    return std::max(graphDelay, 0.0) + buffered;
+}
+
 void PipewireStream::setActive(bool active)
 {
     pw_stream_set_active(m_stream.get(), active);
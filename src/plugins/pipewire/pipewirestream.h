@@ -40,6 +40,8 @@ public:
 
     pw_stream_state state();
     [[nodiscard]] int bufferSize() const;
+    /** Returns the delay (in seconds) until audio queued now reaches the device, or a negative value if unknown. */
+    [[nodiscard]] double delay(int sampleRate) const;
 
     void setActive(bool active);
     void setVolume(float volume);
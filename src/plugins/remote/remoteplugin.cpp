@@ -0,0 +1,680 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "remoteplugin.h"
+
+#include "remotesettings.h"
+#include "websocketserver.h"
+
+#include <core/player/playbackqueue.h>
+#include <core/player/playercontroller.h>
+#include <core/playlist/playlist.h>
+#include <core/playlist/playlisthandler.h>
+#include <core/track.h>
+#include <gui/coverprovider.h>
+#include <utils/lrucache.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QBuffer>
+#include <QDebug>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPixmap>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Playlist rows are serialised, cached and sent in pages of this many
+constexpr auto PageSize = 500;
+// Most pages sent for a single request, so one client can't hold up the others
+constexpr auto MaxRequestPages = 10;
+// A change touching more rows than this is sent as a reset, after which clients request the pages they show
+constexpr auto MaxDeltaRows = 500;
+// Serialised pages and covers are shared by every client
+constexpr auto PageCacheBudget  = 32 * 1024 * 1024;
+constexpr auto CoverCacheBudget = 16 * 1024 * 1024;
+constexpr auto CoverQuality     = 85;
+
+/*
+ * Messages are JSON objects. Those sent by the server have a "type":
+ *   snapshot        - playback, queue, playlists (without tracks) and activePlaylist, sent on connecting
+ *   playback        - state, position and the current track, sent when any of them change other than by playing on
+ *   position        - position, sent after seeking
+ *   queue           - the whole playback queue
+ *   playlistAdded, playlistRemoved, playlistRenamed, activePlaylist
+ *   tracksInserted, tracksRemoved, tracksChanged, playlistReset
+ *                   - changes to a playlist's tracks, carrying the revision before ("from") and after the change.
+ *                     A client whose revision doesn't match "from" has missed a change and should request its pages
+ *                     again, as it should after a reset.
+ *   page            - the tracks of a playlist from offset, in reply to a page command
+ *   error           - message
+ *
+ * Clients send objects with a "command": play, pause, playPause, stop, next, previous, seek (position),
+ * snapshot, page (playlist, offset, count) and cover (playlist and index, or the current track if omitted).
+ * Covers are sent as binary messages holding the track id as a 32-bit big-endian integer followed by a JPEG.
+ */
+
+namespace {
+QString playStateName(Fooyin::PlayState state)
+{
+    switch(state) {
+        case(Fooyin::PlayState::Playing):
+            return QStringLiteral("playing");
+        case(Fooyin::PlayState::Paused):
+            return QStringLiteral("paused");
+        case(Fooyin::PlayState::Stopped):
+        default:
+            return QStringLiteral("stopped");
+    }
+}
+
+QJsonObject trackObject(const Fooyin::Track& track)
+{
+    return {{QStringLiteral("id"), track.id()},
+            {QStringLiteral("title"), track.title()},
+            {QStringLiteral("artist"), track.artist()},
+            {QStringLiteral("album"), track.album()},
+            {QStringLiteral("duration"), static_cast<qint64>(track.duration())}};
+}
+
+QJsonObject playlistObject(const Fooyin::Playlist* playlist)
+{
+    return {{QStringLiteral("id"), playlist->id().name()},
+            {QStringLiteral("name"), playlist->name()},
+            {QStringLiteral("count"), playlist->trackCount()},
+            {QStringLiteral("duration"), static_cast<qint64>(playlist->duration())},
+            {QStringLiteral("revision"), static_cast<qint64>(playlist->revision())}};
+}
+
+QJsonArray indexArray(const std::vector<int>& indexes)
+{
+    QJsonArray array;
+    for(const int index : indexes) {
+        array.append(index);
+    }
+    return array;
+}
+
+QByteArray serialise(const QJsonObject& message)
+{
+    return QJsonDocument{message}.toJson(QJsonDocument::Compact);
+}
+
+QByteArray coverPayload(int trackId, const QByteArray& jpeg)
+{
+    const auto id = static_cast<uint32_t>(trackId);
+
+    QByteArray payload;
+    payload.reserve(jpeg.size() + 4);
+    for(int shift{24}; shift >= 0; shift -= 8) {
+        payload.append(static_cast<char>((id >> shift) & 0xFF));
+    }
+    payload.append(jpeg);
+    return payload;
+}
+} // namespace
+
+namespace Fooyin::Remote {
+struct RemotePlugin::Private
+{
+    // What clients were last told about a playlist
+    struct PlaylistState
+    {
+        uint64_t revision{0};
+        int count{0};
+    };
+
+    RemotePlugin* self;
+
+    SettingsManager* settings{nullptr};
+    PlayerController* playerController{nullptr};
+    PlaylistHandler* playlistHandler{nullptr};
+    CoverProvider* coverProvider{nullptr};
+    std::unique_ptr<RemoteSettings> remoteSettings;
+
+    WebSocketServer server;
+    std::unordered_map<QString, PlaylistState> playlists;
+    // Encoded page frames, keyed by playlist, revision and page, so a change leaves stale pages to age out
+    LruCache<QString, QByteArray> pages{PageCacheBudget};
+    // Encoded covers by album hash
+    LruCache<QString, QByteArray> covers{CoverCacheBudget};
+    // Clients waiting on covers still being loaded, by track id
+    std::unordered_map<int, std::vector<int>> pendingCovers;
+
+    explicit Private(RemotePlugin* self_)
+        : self{self_}
+    { }
+
+    void updateServer()
+    {
+        if(!settings->value<Settings::Remote::Enabled>()) {
+            server.close();
+            return;
+        }
+
+        const QHostAddress address{settings->value<Settings::Remote::Address>()};
+        const int port = settings->value<Settings::Remote::Port>();
+        if(address.isNull() || port <= 0 || port > 65535) {
+            qWarning() << "[Remote] Invalid address" << settings->value<Settings::Remote::Address>() << port;
+            server.close();
+            return;
+        }
+
+        server.setToken(settings->value<Settings::Remote::Token>().toUtf8());
+        server.setAllowedOrigins(settings->value<Settings::Remote::AllowedOrigins>());
+        server.listen(address, static_cast<quint16>(port));
+    }
+
+    [[nodiscard]] bool hasClients() const
+    {
+        return server.clientCount() > 0;
+    }
+
+    void broadcast(const QJsonObject& message)
+    {
+        // Serialised once, however many clients are listening
+        server.broadcast(WebSocketServer::textFrame(serialise(message)));
+    }
+
+    void send(int client, const QJsonObject& message)
+    {
+        server.send(client, WebSocketServer::textFrame(serialise(message)));
+    }
+
+    void sendError(int client, const QString& error)
+    {
+        send(client, {{QStringLiteral("type"), QStringLiteral("error")}, {QStringLiteral("message"), error}});
+    }
+
+    /*!
+     * Records the current revision and size of @p playlist.
+     * @returns the revision clients were last told about.
+     */
+    uint64_t advance(const Playlist* playlist)
+    {
+        auto& state = playlists[playlist->id().name()];
+        return std::exchange(state, {.revision = playlist->revision(), .count = playlist->trackCount()}).revision;
+    }
+
+    [[nodiscard]] QJsonObject playbackMessage() const
+    {
+        const PlaylistTrack current = playerController->currentPlaylistTrack();
+
+        QJsonObject message{{QStringLiteral("type"), QStringLiteral("playback")},
+                            {QStringLiteral("state"), playStateName(playerController->playState())},
+                            {QStringLiteral("position"), static_cast<qint64>(playerController->currentPosition())}};
+
+        if(current.isValid()) {
+            message.insert(QStringLiteral("track"), trackObject(current.track));
+            if(current.isInPlaylist()) {
+                message.insert(QStringLiteral("playlist"), current.playlistId.name());
+                message.insert(QStringLiteral("index"), current.indexInPlaylist);
+            }
+        }
+
+        return message;
+    }
+
+    [[nodiscard]] QJsonArray queueArray() const
+    {
+        QJsonArray queue;
+        for(const PlaylistTrack& queued : playerController->playbackQueue().tracks()) {
+            QJsonObject track = trackObject(queued.track);
+            if(queued.isInPlaylist()) {
+                track.insert(QStringLiteral("playlist"), queued.playlistId.name());
+                track.insert(QStringLiteral("index"), queued.indexInPlaylist);
+            }
+            queue.append(track);
+        }
+        return queue;
+    }
+
+    void sendSnapshot(int client)
+    {
+        QJsonArray playlistArray;
+        for(const Playlist* playlist : playlistHandler->playlists()) {
+            advance(playlist);
+            playlistArray.append(playlistObject(playlist));
+        }
+
+        const Playlist* active = playlistHandler->activePlaylist();
+
+        send(client, {{QStringLiteral("type"), QStringLiteral("snapshot")},
+                      {QStringLiteral("playback"), playbackMessage()},
+                      {QStringLiteral("queue"), queueArray()},
+                      {QStringLiteral("playlists"), playlistArray},
+                      {QStringLiteral("activePlaylist"), active ? QJsonValue{active->id().name()} : QJsonValue{}},
+                      {QStringLiteral("pageSize"), PageSize}});
+    }
+
+    void sendPlayback()
+    {
+        if(hasClients()) {
+            broadcast(playbackMessage());
+        }
+    }
+
+    void sendQueue()
+    {
+        if(hasClients()) {
+            broadcast({{QStringLiteral("type"), QStringLiteral("queue")}, {QStringLiteral("queue"), queueArray()}});
+        }
+    }
+
+    void sendPlaylistReset(const Playlist* playlist, uint64_t from)
+    {
+        broadcast({{QStringLiteral("type"), QStringLiteral("playlistReset")},
+                   {QStringLiteral("from"), static_cast<qint64>(from)},
+                   {QStringLiteral("playlist"), playlistObject(playlist)}});
+    }
+
+    [[nodiscard]] QJsonObject deltaMessage(const QString& type, const Playlist* playlist, uint64_t from) const
+    {
+        return {{QStringLiteral("type"), type},
+                {QStringLiteral("playlist"), playlist->id().name()},
+                {QStringLiteral("from"), static_cast<qint64>(from)},
+                {QStringLiteral("revision"), static_cast<qint64>(playlist->revision())},
+                {QStringLiteral("count"), playlist->trackCount()}};
+    }
+
+    void tracksInserted(const Playlist* playlist, const TrackList& tracks, int index)
+    {
+        const uint64_t from = advance(playlist);
+        if(!hasClients()) {
+            return;
+        }
+
+        if(std::cmp_greater(tracks.size(), MaxDeltaRows)) {
+            sendPlaylistReset(playlist, from);
+            return;
+        }
+
+        QJsonArray trackArray;
+        for(const Track& track : tracks) {
+            trackArray.append(trackObject(track));
+        }
+
+        QJsonObject message = deltaMessage(QStringLiteral("tracksInserted"), playlist, from);
+        message.insert(QStringLiteral("index"), index);
+        message.insert(QStringLiteral("tracks"), trackArray);
+        broadcast(message);
+    }
+
+    void tracksRemoved(const Playlist* playlist, const std::vector<int>& indexes)
+    {
+        const uint64_t from = advance(playlist);
+        if(!hasClients()) {
+            return;
+        }
+
+        if(std::cmp_greater(indexes.size(), MaxDeltaRows)) {
+            sendPlaylistReset(playlist, from);
+            return;
+        }
+
+        QJsonObject message = deltaMessage(QStringLiteral("tracksRemoved"), playlist, from);
+        message.insert(QStringLiteral("indexes"), indexArray(indexes));
+        broadcast(message);
+    }
+
+    void tracksChanged(const Playlist* playlist, const std::vector<int>& indexes)
+    {
+        const auto it       = playlists.find(playlist->id().name());
+        const int lastCount = it != playlists.end() ? it->second.count : -1;
+
+        const uint64_t from = advance(playlist);
+        if(!hasClients()) {
+            return;
+        }
+
+        // Replacing and removing tracks are reported as changes too, which only a reset describes
+        const int count = playlist->trackCount();
+        if(count != lastCount || std::cmp_greater(indexes.size(), MaxDeltaRows)) {
+            sendPlaylistReset(playlist, from);
+            return;
+        }
+
+        QJsonArray changedIndexes;
+        QJsonArray trackArray;
+        for(const int index : indexes) {
+            if(index >= 0 && index < count) {
+                changedIndexes.append(index);
+                trackArray.append(trackObject(playlist->track(index)));
+            }
+        }
+
+        QJsonObject message = deltaMessage(QStringLiteral("tracksChanged"), playlist, from);
+        message.insert(QStringLiteral("indexes"), changedIndexes);
+        message.insert(QStringLiteral("tracks"), trackArray);
+        broadcast(message);
+    }
+
+    QByteArray pageFrame(Playlist* playlist, int page)
+    {
+        const QString key
+            = QStringLiteral("%1:%2:%3").arg(playlist->id().name()).arg(playlist->revision()).arg(page);
+        if(const auto* frame = pages.find(key)) {
+            return *frame;
+        }
+
+        const TrackList& tracks = playlist->tracks();
+        const auto start        = std::min(static_cast<size_t>(page) * PageSize, tracks.size());
+        const auto end          = std::min(start + PageSize, tracks.size());
+
+        QJsonArray trackArray;
+        for(auto i{start}; i < end; ++i) {
+            trackArray.append(trackObject(tracks.at(i)));
+        }
+
+        const QByteArray frame = WebSocketServer::textFrame(
+            serialise({{QStringLiteral("type"), QStringLiteral("page")},
+                       {QStringLiteral("playlist"), playlist->id().name()},
+                       {QStringLiteral("revision"), static_cast<qint64>(playlist->revision())},
+                       {QStringLiteral("count"), playlist->trackCount()},
+                       {QStringLiteral("offset"), static_cast<qint64>(start)},
+                       {QStringLiteral("tracks"), trackArray}}));
+
+        pages.insert(key, frame, static_cast<size_t>(frame.size()));
+        return frame;
+    }
+
+    void sendPages(int client, const QJsonObject& request)
+    {
+        auto* playlist = playlistHandler->playlistById(Id{request.value(QStringLiteral("playlist")).toString()});
+        if(!playlist) {
+            sendError(client, QStringLiteral("Unknown playlist"));
+            return;
+        }
+
+        const int count  = playlist->trackCount();
+        const int offset = std::max(0, request.value(QStringLiteral("offset")).toInt());
+        const int rows   = std::clamp(request.value(QStringLiteral("count")).toInt(PageSize), 1,
+                                      PageSize * MaxRequestPages);
+
+        // Rows past the end are answered with an empty page, so the client knows there aren't any
+        const int first = offset / PageSize;
+        const int end   = std::min(offset + rows, count);
+        const int last  = end > offset ? (end - 1) / PageSize : first;
+
+        for(int page{first}; page <= last; ++page) {
+            server.send(client, pageFrame(playlist, page));
+        }
+    }
+
+    [[nodiscard]] Track requestedTrack(const QJsonObject& request) const
+    {
+        if(!request.contains(QStringLiteral("playlist"))) {
+            return playerController->currentTrack();
+        }
+
+        const auto* playlist = playlistHandler->playlistById(Id{request.value(QStringLiteral("playlist")).toString()});
+        const int index      = request.value(QStringLiteral("index")).toInt(-1);
+        if(!playlist || index < 0 || index >= playlist->trackCount()) {
+            return {};
+        }
+
+        return playlist->track(index);
+    }
+
+    [[nodiscard]] QByteArray coverFrame(const Track& track)
+    {
+        const QString key = track.albumHash();
+        if(const auto* jpeg = covers.find(key)) {
+            return WebSocketServer::binaryFrame(coverPayload(track.id(), *jpeg));
+        }
+
+        const QPixmap cover = coverProvider->trackCoverThumbnail(track);
+        if(cover.isNull()) {
+            return {};
+        }
+
+        QByteArray jpeg;
+        QBuffer buffer{&jpeg};
+        buffer.open(QIODevice::WriteOnly);
+        if(!cover.save(&buffer, "JPG", CoverQuality)) {
+            return {};
+        }
+
+        covers.insert(key, jpeg, static_cast<size_t>(jpeg.size()));
+        return WebSocketServer::binaryFrame(coverPayload(track.id(), jpeg));
+    }
+
+    void sendCover(int client, const QJsonObject& request)
+    {
+        if(!coverProvider) {
+            sendError(client, QStringLiteral("Covers are unavailable"));
+            return;
+        }
+
+        const Track track = requestedTrack(request);
+        if(!track.isValid()) {
+            sendError(client, QStringLiteral("Unknown track"));
+            return;
+        }
+
+        const QByteArray frame = coverFrame(track);
+        if(!frame.isEmpty()) {
+            server.send(client, frame);
+            return;
+        }
+
+        // Sent once the cover provider has loaded it, if the track has one
+        auto& waiting = pendingCovers[track.id()];
+        if(std::ranges::find(waiting, client) == waiting.cend()) {
+            waiting.push_back(client);
+        }
+    }
+
+    void coverAdded(const Track& track)
+    {
+        const auto it = pendingCovers.find(track.id());
+        if(it == pendingCovers.end()) {
+            return;
+        }
+
+        const std::vector<int> waiting = std::move(it->second);
+        pendingCovers.erase(it);
+
+        const QByteArray frame = coverFrame(track);
+        if(frame.isEmpty()) {
+            return;
+        }
+
+        for(const int client : waiting) {
+            server.send(client, frame);
+        }
+    }
+
+    void clientDisconnected(int client)
+    {
+        for(auto it = pendingCovers.begin(); it != pendingCovers.end();) {
+            std::erase(it->second, client);
+            it = it->second.empty() ? pendingCovers.erase(it) : std::next(it);
+        }
+
+        if(!hasClients()) {
+            pages.clear();
+            covers.clear();
+        }
+    }
+
+    void handleMessage(int client, const QByteArray& message)
+    {
+        const QJsonObject request = QJsonDocument::fromJson(message).object();
+        const QString command     = request.value(QStringLiteral("command")).toString();
+
+        if(command == QStringLiteral("play")) {
+            playerController->play();
+        }
+        else if(command == QStringLiteral("pause")) {
+            playerController->pause();
+        }
+        else if(command == QStringLiteral("playPause")) {
+            playerController->playPause();
+        }
+        else if(command == QStringLiteral("stop")) {
+            playerController->stop();
+        }
+        else if(command == QStringLiteral("next")) {
+            playerController->next();
+        }
+        else if(command == QStringLiteral("previous")) {
+            playerController->previous();
+        }
+        else if(command == QStringLiteral("seek")) {
+            const auto position = request.value(QStringLiteral("position")).toInteger(-1);
+            if(position >= 0) {
+                playerController->seek(static_cast<uint64_t>(position));
+            }
+        }
+        else if(command == QStringLiteral("snapshot")) {
+            sendSnapshot(client);
+        }
+        else if(command == QStringLiteral("page")) {
+            sendPages(client, request);
+        }
+        else if(command == QStringLiteral("cover")) {
+            sendCover(client, request);
+        }
+        else {
+            sendError(client, QStringLiteral("Unknown command"));
+        }
+    }
+};
+
+RemotePlugin::RemotePlugin()
+    : p{std::make_unique<Private>(this)}
+{ }
+
+RemotePlugin::~RemotePlugin()
+{
+    shutdown();
+}
+
+void RemotePlugin::initialise(const CorePluginContext& context)
+{
+    p->settings         = context.settingsManager;
+    p->playerController = context.playerController;
+    p->playlistHandler  = context.playlistHandler;
+    p->remoteSettings   = std::make_unique<RemoteSettings>(p->settings);
+
+    QObject::connect(&p->server, &WebSocketServer::clientConnected, this,
+                     [this](int client) { p->sendSnapshot(client); });
+    QObject::connect(&p->server, &WebSocketServer::clientDisconnected, this,
+                     [this](int client) { p->clientDisconnected(client); });
+    QObject::connect(&p->server, &WebSocketServer::messageReceived, this,
+                     [this](int client, const QByteArray& message) { p->handleMessage(client, message); });
+
+    auto* player = p->playerController;
+    QObject::connect(player, &PlayerController::playStateChanged, this, [this]() { p->sendPlayback(); });
+    QObject::connect(player, &PlayerController::playlistTrackChanged, this, [this]() { p->sendPlayback(); });
+    QObject::connect(player, &PlayerController::positionMoved, this, [this](uint64_t ms) {
+        if(p->hasClients()) {
+            p->broadcast({{QStringLiteral("type"), QStringLiteral("position")},
+                          {QStringLiteral("position"), static_cast<qint64>(ms)}});
+        }
+    });
+    QObject::connect(player, &PlayerController::tracksQueued, this, [this]() { p->sendQueue(); });
+    QObject::connect(player, &PlayerController::tracksDequeued, this, [this]() { p->sendQueue(); });
+    QObject::connect(player, &PlayerController::trackQueueChanged, this, [this]() { p->sendQueue(); });
+
+    auto* handler = p->playlistHandler;
+    QObject::connect(handler, &PlaylistHandler::playlistAdded, this, [this](Playlist* playlist) {
+        p->advance(playlist);
+        if(p->hasClients()) {
+            p->broadcast({{QStringLiteral("type"), QStringLiteral("playlistAdded")},
+                          {QStringLiteral("playlist"), playlistObject(playlist)}});
+        }
+    });
+    QObject::connect(handler, &PlaylistHandler::playlistRemoved, this, [this](Playlist* playlist) {
+        p->playlists.erase(playlist->id().name());
+        if(p->hasClients()) {
+            p->broadcast({{QStringLiteral("type"), QStringLiteral("playlistRemoved")},
+                          {QStringLiteral("id"), playlist->id().name()}});
+        }
+    });
+    QObject::connect(handler, &PlaylistHandler::playlistRenamed, this, [this](Playlist* playlist) {
+        if(p->hasClients()) {
+            p->broadcast({{QStringLiteral("type"), QStringLiteral("playlistRenamed")},
+                          {QStringLiteral("id"), playlist->id().name()},
+                          {QStringLiteral("name"), playlist->name()}});
+        }
+    });
+    QObject::connect(handler, &PlaylistHandler::activePlaylistChanged, this, [this](Playlist* playlist) {
+        if(p->hasClients()) {
+            p->broadcast({{QStringLiteral("type"), QStringLiteral("activePlaylist")},
+                          {QStringLiteral("id"), playlist ? QJsonValue{playlist->id().name()} : QJsonValue{}}});
+        }
+    });
+    QObject::connect(handler, &PlaylistHandler::playlistTracksAdded, this,
+                     [this](Playlist* playlist, const TrackList& tracks, int index) {
+                         p->tracksInserted(playlist, tracks, index);
+                     });
+    QObject::connect(handler, &PlaylistHandler::playlistTracksRemoved, this,
+                     [this](Playlist* playlist, const std::vector<int>& indexes) {
+                         p->tracksRemoved(playlist, indexes);
+                     });
+    // Library changes, e.g. removed or relocated tracks, reach playlists as changed tracks
+    QObject::connect(handler, &PlaylistHandler::playlistTracksChanged, this,
+                     [this](Playlist* playlist, const std::vector<int>& indexes) {
+                         p->tracksChanged(playlist, indexes);
+                     });
+    QObject::connect(handler, &PlaylistHandler::playlistTracksReordered, this,
+                     [this](Playlist* playlist, const std::vector<int>& indexes) {
+                         p->tracksChanged(playlist, indexes);
+                     });
+    QObject::connect(handler, &PlaylistHandler::playlistTracksPlayed, this,
+                     [this](Playlist* playlist, const std::vector<int>& indexes) {
+                         p->tracksChanged(playlist, indexes);
+                     });
+
+    p->updateServer();
+
+    const auto updateServer = [this]() { p->updateServer(); };
+    p->settings->subscribe<Settings::Remote::Enabled>(this, updateServer);
+    p->settings->subscribe<Settings::Remote::Address>(this, updateServer);
+    p->settings->subscribe<Settings::Remote::Port>(this, updateServer);
+    p->settings->subscribe<Settings::Remote::Token>(this, updateServer);
+    p->settings->subscribe<Settings::Remote::AllowedOrigins>(this, updateServer);
+}
+
+void RemotePlugin::initialise(const GuiPluginContext& /*context*/)
+{
+    p->coverProvider = new CoverProvider(p->settings, this);
+    p->coverProvider->setUsePlaceholder(false);
+
+    QObject::connect(p->coverProvider, &CoverProvider::coverAdded, this,
+                     [this](const Track& track) { p->coverAdded(track); });
+}
+
+void RemotePlugin::shutdown()
+{
+    p->server.close();
+    p->pendingCovers.clear();
+    p->pages.clear();
+    p->covers.clear();
+}
+} // namespace Fooyin::Remote
+
+#include "moc_remoteplugin.cpp"
@@ -0,0 +1,48 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "remotesettings.h"
+
+#include <utils/crypto.h>
+#include <utils/settings/settingsmanager.h>
+
+// Clear of the ports used by web servers and the metrics plugin
+constexpr auto DefaultPort = 8880;
+
+namespace Fooyin::Remote {
+RemoteSettings::RemoteSettings(SettingsManager* settingsManager)
+    : m_settings{settingsManager}
+{
+    using namespace Settings::Remote;
+
+    m_settings->createSetting<Enabled>(false, QStringLiteral("Remote/Enabled"));
+    // Only reachable from this machine unless changed
+    m_settings->createSetting<Address>(QStringLiteral("127.0.0.1"), QStringLiteral("Remote/Address"));
+    m_settings->createSetting<Port>(DefaultPort, QStringLiteral("Remote/Port"));
+    m_settings->createSetting<Token>(QString{}, QStringLiteral("Remote/Token"));
+    // Web pages from other sites may not connect, as browsers let any page open a WebSocket
+    m_settings->createSetting<AllowedOrigins>(QStringList{}, QStringLiteral("Remote/AllowedOrigins"));
+
+    // Generated once and kept, so clients must be given it before they can connect
+    if(m_settings->value<Token>().isEmpty()) {
+        m_settings->set<Token>(Utils::generateUniqueHash());
+    }
+}
+} // namespace Fooyin::Remote
@@ -0,0 +1,52 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <utils/settings/settingsentry.h>
+
+namespace Fooyin {
+class SettingsManager;
+
+namespace Settings::Remote {
+Q_NAMESPACE
+
+enum RemoteSettings : uint32_t
+{
+    Enabled        = 1 | Type::Bool,
+    Address        = 2 | Type::String,
+    Port           = 3 | Type::Int,
+    Token          = 4 | Type::String,
+    AllowedOrigins = 5 | Type::StringList,
+};
+Q_ENUM_NS(RemoteSettings)
+} // namespace Settings::Remote
+
+namespace Remote {
+class RemoteSettings
+{
+public:
+    explicit RemoteSettings(SettingsManager* settingsManager);
+
+private:
+    SettingsManager* m_settings;
+};
+} // namespace Remote
+} // namespace Fooyin
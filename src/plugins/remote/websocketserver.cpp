@@ -0,0 +1,518 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "websocketserver.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Anything longer isn't a WebSocket handshake, so the connection is dropped
+constexpr auto MaxHandshakeSize = 8 * 1024;
+// Connections which don't complete the handshake in time are dropped
+constexpr auto HandshakeTimeout = 5000; // ms
+// Clients only send short commands, so larger messages are refused
+constexpr auto MaxMessageSize = 64 * 1024;
+// A client with this much still to be written to it has stopped reading, and is disconnected
+constexpr auto MaxPendingBytes = 16 * 1024 * 1024;
+// Control frames can't be fragmented or carry more than this (RFC 6455, section 5.5)
+constexpr auto MaxControlPayload = 125;
+
+// Appended to the client's key to produce Sec-WebSocket-Accept (RFC 6455, section 1.3)
+constexpr auto HandshakeGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+namespace {
+enum class Opcode : uint8_t
+{
+    Continuation = 0x0,
+    Text         = 0x1,
+    Binary       = 0x2,
+    Close        = 0x8,
+    Ping         = 0x9,
+    Pong         = 0xA,
+};
+
+// Status codes sent when closing (RFC 6455, section 7.4.1)
+enum CloseCode : uint16_t
+{
+    Normal        = 1000,
+    ProtocolError = 1002,
+    TooBig        = 1009,
+};
+
+bool isControl(Opcode opcode)
+{
+    return (static_cast<uint8_t>(opcode) & 0x8) != 0;
+}
+
+void appendBigEndian(QByteArray& data, uint64_t value, int bytes)
+{
+    for(int shift{(bytes - 1) * 8}; shift >= 0; shift -= 8) {
+        data.append(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+QByteArray encodeFrame(Opcode opcode, const QByteArray& payload)
+{
+    const auto size = static_cast<uint64_t>(payload.size());
+
+    QByteArray frame;
+    frame.reserve(payload.size() + 10);
+    frame.append(static_cast<char>(0x80 | static_cast<uint8_t>(opcode)));
+
+    // Frames sent by servers are never masked
+    if(size < 126) {
+        frame.append(static_cast<char>(size));
+    }
+    else if(size <= 0xFFFF) {
+        frame.append(static_cast<char>(126));
+        appendBigEndian(frame, size, 2);
+    }
+    else {
+        frame.append(static_cast<char>(127));
+        appendBigEndian(frame, size, 8);
+    }
+
+    frame.append(payload);
+    return frame;
+}
+
+QByteArray closeFrame(CloseCode code)
+{
+    QByteArray payload;
+    appendBigEndian(payload, code, 2);
+    return encodeFrame(Opcode::Close, payload);
+}
+
+QByteArray acceptKey(const QByteArray& key)
+{
+    return QCryptographicHash::hash(key + HandshakeGuid, QCryptographicHash::Sha1).toBase64();
+}
+
+// Compares every byte whatever the first difference, so the time taken doesn't give the token away
+bool tokensMatch(const QByteArray& given, const QByteArray& expected)
+{
+    if(given.size() != expected.size()) {
+        return false;
+    }
+
+    uint8_t difference{0};
+    for(qsizetype i{0}; i < given.size(); ++i) {
+        difference |= static_cast<uint8_t>(given.at(i) ^ expected.at(i));
+    }
+    return difference == 0;
+}
+} // namespace
+
+namespace Fooyin::Remote {
+struct WebSocketServer::Private
+{
+    struct Client
+    {
+        QTcpSocket* socket;
+        QByteArray buffer;
+        bool upgraded{false};
+        bool closing{false};
+        // A message whose remaining fragments haven't arrived yet
+        QByteArray message;
+        Opcode messageType{Opcode::Text};
+        bool fragmented{false};
+    };
+
+    WebSocketServer* self;
+
+    QTcpServer* server;
+    std::unordered_map<int, Client> clients;
+    int nextClient{0};
+
+    QByteArray token;
+    QStringList allowedOrigins;
+
+    explicit Private(WebSocketServer* self_)
+        : self{self_}
+        , server{new QTcpServer(self)}
+    { }
+
+    Client* findClient(int id)
+    {
+        const auto it = clients.find(id);
+        return it != clients.end() ? &it->second : nullptr;
+    }
+
+    void handleConnection()
+    {
+        while(QTcpSocket* socket = server->nextPendingConnection()) {
+            const int id = nextClient++;
+            clients.emplace(id, Client{.socket = socket});
+
+            QObject::connect(socket, &QTcpSocket::readyRead, self, [this, id]() { readClient(id); });
+            QObject::connect(socket, &QTcpSocket::disconnected, self, [this, id]() { removeClient(id); });
+            QTimer::singleShot(HandshakeTimeout, socket, [this, id]() {
+                if(const auto* client = findClient(id); client && !client->upgraded) {
+                    removeClient(id);
+                }
+            });
+        }
+    }
+
+    void removeClient(int id)
+    {
+        const auto it = clients.find(id);
+        if(it == clients.end()) {
+            return;
+        }
+
+        QTcpSocket* socket  = it->second.socket;
+        const bool upgraded = it->second.upgraded;
+        clients.erase(it);
+
+        QObject::disconnect(socket, nullptr, self, nullptr);
+        socket->abort();
+        socket->deleteLater();
+
+        if(upgraded) {
+            emit self->clientDisconnected(id);
+        }
+    }
+
+    static void closeClient(Client& client, CloseCode code)
+    {
+        if(std::exchange(client.closing, true)) {
+            return;
+        }
+
+        // The client is removed once it has seen the close frame and the connection has ended
+        client.socket->write(closeFrame(code));
+        client.socket->disconnectFromHost();
+    }
+
+    void readClient(int id)
+    {
+        if(auto* client = findClient(id)) {
+            client->buffer.append(client->socket->readAll());
+            if(!client->upgraded && !upgrade(id, *client)) {
+                return;
+            }
+        }
+
+        // Handling a message can disconnect the client, so it's looked up again for each frame
+        while(auto* client = findClient(id)) {
+            if(client->closing || !readFrame(id, *client)) {
+                return;
+            }
+        }
+    }
+
+    static void refuse(Client& client, const QByteArray& status)
+    {
+        client.closing = true;
+        client.socket->write("HTTP/1.1 " + status + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        client.socket->disconnectFromHost();
+    }
+
+    bool upgrade(int id, Client& client)
+    {
+        const auto end = client.buffer.indexOf("\r\n\r\n");
+        if(end < 0) {
+            if(client.buffer.size() > MaxHandshakeSize) {
+                removeClient(id);
+            }
+            return false;
+        }
+
+        const QByteArray request = client.buffer.left(end);
+        client.buffer.remove(0, end + 4);
+
+        const QList<QByteArray> lines       = request.split('\n');
+        const QList<QByteArray> requestLine = lines.constFirst().trimmed().split(' ');
+
+        bool isUpgrade{false};
+        QByteArray version;
+        QByteArray key;
+        QByteArray origin;
+
+        for(const QByteArray& line : lines.sliced(1)) {
+            const auto colon = line.indexOf(':');
+            if(colon < 0) {
+                continue;
+            }
+
+            const QByteArray name  = line.left(colon).trimmed().toLower();
+            const QByteArray value = line.mid(colon + 1).trimmed();
+
+            if(name == "upgrade") {
+                isUpgrade = value.toLower() == "websocket";
+            }
+            else if(name == "sec-websocket-version") {
+                version = value;
+            }
+            else if(name == "sec-websocket-key") {
+                key = value;
+            }
+            else if(name == "origin") {
+                origin = value;
+            }
+        }
+
+        if(requestLine.size() != 3 || requestLine.at(0) != "GET" || !isUpgrade || key.isEmpty()) {
+            refuse(client, "400 Bad Request");
+            return false;
+        }
+
+        if(version != "13") {
+            refuse(client, "426 Upgrade Required\r\nSec-WebSocket-Version: 13");
+            return false;
+        }
+
+        // Only browsers send an origin, and a page from any site may try to connect
+        if(!origin.isEmpty() && !allowedOrigins.contains(QString::fromUtf8(origin), Qt::CaseInsensitive)) {
+            qInfo() << "[Remote] Refused connection from origin" << origin;
+            refuse(client, "403 Forbidden");
+            return false;
+        }
+
+        if(!token.isEmpty()) {
+            const QUrlQuery query{QUrl::fromEncoded(requestLine.at(1)).query()};
+            const QByteArray given = query.queryItemValue(QStringLiteral("token"), QUrl::FullyDecoded).toUtf8();
+            if(!tokensMatch(given, token)) {
+                qInfo() << "[Remote] Refused connection without a valid token";
+                refuse(client, "403 Forbidden");
+                return false;
+            }
+        }
+
+        QByteArray response = "HTTP/1.1 101 Switching Protocols\r\n";
+        response += "Upgrade: websocket\r\n";
+        response += "Connection: Upgrade\r\n";
+        response += "Sec-WebSocket-Accept: " + acceptKey(key) + "\r\n\r\n";
+
+        client.socket->write(response);
+        client.upgraded = true;
+
+        emit self->clientConnected(id);
+        return true;
+    }
+
+    bool readFrame(int id, Client& client)
+    {
+        const QByteArray& buffer = client.buffer;
+        if(buffer.size() < 2) {
+            return false;
+        }
+
+        const auto byteAt = [&buffer](qsizetype index) {
+            return static_cast<uint8_t>(buffer.at(index));
+        };
+
+        const bool final    = (byteAt(0) & 0x80) != 0;
+        const bool reserved = (byteAt(0) & 0x70) != 0;
+        const auto opcode   = static_cast<Opcode>(byteAt(0) & 0x0F);
+        const bool masked   = (byteAt(1) & 0x80) != 0;
+
+        uint64_t length = byteAt(1) & 0x7F;
+        qsizetype offset{2};
+
+        if(length == 126 || length == 127) {
+            const int bytes = length == 126 ? 2 : 8;
+            if(buffer.size() < offset + bytes) {
+                return false;
+            }
+
+            length = 0;
+            for(int i{0}; i < bytes; ++i) {
+                length = (length << 8) | byteAt(offset + i);
+            }
+            offset += bytes;
+        }
+
+        // Frames from clients are always masked, and no extensions are negotiated (RFC 6455, section 5.2)
+        if(!masked || reserved || (isControl(opcode) && (!final || length > MaxControlPayload))) {
+            closeClient(client, ProtocolError);
+            return false;
+        }
+
+        if(length + static_cast<uint64_t>(client.message.size()) > MaxMessageSize) {
+            closeClient(client, TooBig);
+            return false;
+        }
+
+        const auto size = static_cast<qsizetype>(length);
+        if(buffer.size() < offset + 4 + size) {
+            return false;
+        }
+
+        QByteArray payload = buffer.mid(offset + 4, size);
+        for(qsizetype i{0}; i < size; ++i) {
+            payload[i] = static_cast<char>(payload.at(i) ^ buffer.at(offset + (i % 4)));
+        }
+        client.buffer.remove(0, offset + 4 + size);
+
+        switch(opcode) {
+            case(Opcode::Ping):
+                client.socket->write(encodeFrame(Opcode::Pong, payload));
+                return true;
+            case(Opcode::Pong):
+                return true;
+            case(Opcode::Close):
+                closeClient(client, Normal);
+                return false;
+            case(Opcode::Text):
+            case(Opcode::Binary):
+                if(client.fragmented) {
+                    closeClient(client, ProtocolError);
+                    return false;
+                }
+                client.message     = payload;
+                client.messageType = opcode;
+                break;
+            case(Opcode::Continuation):
+                if(!client.fragmented) {
+                    closeClient(client, ProtocolError);
+                    return false;
+                }
+                client.message.append(payload);
+                break;
+            default:
+                closeClient(client, ProtocolError);
+                return false;
+        }
+
+        client.fragmented = !final;
+        if(client.fragmented) {
+            return true;
+        }
+
+        QByteArray message = std::exchange(client.message, {});
+        if(client.messageType == Opcode::Text) {
+            emit self->messageReceived(id, message);
+        }
+        return true;
+    }
+};
+
+WebSocketServer::WebSocketServer(QObject* parent)
+    : QObject{parent}
+    , p{std::make_unique<Private>(this)}
+{
+    QObject::connect(p->server, &QTcpServer::newConnection, this, [this]() { p->handleConnection(); });
+}
+
+WebSocketServer::~WebSocketServer()
+{
+    // Nothing is notified of clients dropped along with the server
+    for(const auto& [id, client] : p->clients) {
+        QObject::disconnect(client.socket, nullptr, this, nullptr);
+        client.socket->abort();
+    }
+}
+
+bool WebSocketServer::listen(const QHostAddress& address, quint16 port)
+{
+    close();
+
+    if(!p->server->listen(address, port)) {
+        qWarning() << "[Remote] Unable to listen on" << address.toString() << port << ":" << p->server->errorString();
+        return false;
+    }
+
+    qInfo() << "[Remote] Serving remote control on" << address.toString() << p->server->serverPort();
+    return true;
+}
+
+void WebSocketServer::setToken(const QByteArray& token)
+{
+    p->token = token;
+}
+
+void WebSocketServer::setAllowedOrigins(const QStringList& origins)
+{
+    p->allowedOrigins = origins;
+}
+
+void WebSocketServer::close()
+{
+    if(p->server->isListening()) {
+        p->server->close();
+    }
+
+    while(!p->clients.empty()) {
+        p->removeClient(p->clients.begin()->first);
+    }
+}
+
+int WebSocketServer::clientCount() const
+{
+    return static_cast<int>(std::ranges::count_if(p->clients, [](const auto& entry) {
+        return entry.second.upgraded && !entry.second.closing;
+    }));
+}
+
+QByteArray WebSocketServer::textFrame(const QByteArray& payload)
+{
+    return encodeFrame(Opcode::Text, payload);
+}
+
+QByteArray WebSocketServer::binaryFrame(const QByteArray& payload)
+{
+    return encodeFrame(Opcode::Binary, payload);
+}
+
+void WebSocketServer::send(int client, const QByteArray& frame)
+{
+    const auto* target = p->findClient(client);
+    if(!target || !target->upgraded || target->closing) {
+        return;
+    }
+
+    if(target->socket->bytesToWrite() + frame.size() > MaxPendingBytes) {
+        qWarning() << "[Remote] Disconnecting client" << client << "as it isn't keeping up";
+        p->removeClient(client);
+        return;
+    }
+
+    target->socket->write(frame);
+}
+
+void WebSocketServer::broadcast(const QByteArray& frame)
+{
+    // Slow clients are removed while sending, so the ids are gathered first
+    std::vector<int> ids;
+    ids.reserve(p->clients.size());
+    for(const auto& [id, client] : p->clients) {
+        ids.push_back(id);
+    }
+
+    for(const int id : ids) {
+        send(id, frame);
+    }
+}
+} // namespace Fooyin::Remote
+
+#include "moc_websocketserver.cpp"
@@ -0,0 +1,78 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+
+class QHostAddress;
+
+namespace Fooyin::Remote {
+/*!
+ * A minimal RFC 6455 WebSocket server built on QTcpServer.
+ * Clients are identified by an id which is never reused. Text messages are delivered whole,
+ * once any fragments have been joined; binary messages from clients are ignored.
+ *
+ * Frames are encoded separately from sending, so a message sent to many clients is serialised once.
+ * Clients which stop reading and let too much build up for them are disconnected.
+ *
+ * Handshakes from browser pages are refused unless their origin is allowed, and once a token is set,
+ * clients must pass it in the request, as in ws://host:port/?token=<token>.
+ */
+class WebSocketServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WebSocketServer(QObject* parent = nullptr);
+    ~WebSocketServer() override;
+
+    /** Starts listening on @p address and @p port, closing any previous listener and clients first. */
+    bool listen(const QHostAddress& address, quint16 port);
+    void close();
+
+    /** Requires clients to connect with @p token; connections are unauthenticated if it's empty. */
+    void setToken(const QByteArray& token);
+    /** Sets the origins, such as https://example.com, of the browser pages which may connect. */
+    void setAllowedOrigins(const QStringList& origins);
+
+    [[nodiscard]] int clientCount() const;
+
+    /** Returns @p payload encoded as a single text frame. */
+    [[nodiscard]] static QByteArray textFrame(const QByteArray& payload);
+    /** Returns @p payload encoded as a single binary frame. */
+    [[nodiscard]] static QByteArray binaryFrame(const QByteArray& payload);
+
+    /** Sends an encoded @p frame to @p client, if it's still connected. */
+    void send(int client, const QByteArray& frame);
+    /** Sends an encoded @p frame to every connected client. */
+    void broadcast(const QByteArray& frame);
+
+signals:
+    void clientConnected(int client);
+    void clientDisconnected(int client);
+    void messageReceived(int client, const QByteArray& message);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin::Remote
@@ -0,0 +1,326 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "lastfmscrobbler.h"
+
+#include "scrobblejournal.h"
+
+#include <utils/database/dbconnectionhandler.h>
+#include <utils/database/dbconnectionprovider.h>
+
+#include <QBasicTimer>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimerEvent>
+#include <QUrl>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+using namespace std::chrono_literals;
+
+constexpr auto ApiUrl = "https://ws.audioscrobbler.com/2.0/";
+// The most scrobbles a single track.scrobble request takes
+constexpr auto MaxBatchSize = 50;
+// Scrobbles queued close together are sent in one request
+constexpr auto SubmitDelay = 5s;
+// Doubled after every failed request, up to the maximum
+constexpr auto MinRetryDelay  = 30s;
+constexpr auto MaxRetryDelay  = 2h;
+constexpr auto RequestTimeout = 30s;
+
+namespace {
+enum class ApiError : uint8_t
+{
+    // Not worth sending again, e.g. invalid parameters
+    Permanent = 0,
+    // Last.fm is down or rate limiting, so try again later
+    Temporary,
+    // The account or API key was rejected, so nothing can be sent until they change
+    Credentials,
+};
+
+ApiError classifyError(int code)
+{
+    switch(code) {
+        case(8):  // Operation failed, which Last.fm asks to be retried
+        case(11): // Service offline
+        case(16): // Temporarily unavailable
+        case(29): // Rate limit exceeded
+            return ApiError::Temporary;
+        case(4):  // Authentication failed
+        case(9):  // Invalid session key
+        case(10): // Invalid API key
+        case(13): // Invalid method signature
+        case(26): // Suspended API key
+            return ApiError::Credentials;
+        default:
+            return ApiError::Permanent;
+    }
+}
+
+QByteArray encodeForm(const std::map<QString, QString>& params)
+{
+    QByteArray body;
+    for(const auto& [name, value] : params) {
+        if(!body.isEmpty()) {
+            body.append('&');
+        }
+        body.append(QUrl::toPercentEncoding(name));
+        body.append('=');
+        body.append(QUrl::toPercentEncoding(value));
+    }
+    return body;
+}
+} // namespace
+
+namespace Fooyin::Scrobbler {
+struct LastFmScrobbler::Private
+{
+    LastFmScrobbler* self;
+
+    DbConnectionPoolPtr dbPool;
+    std::unique_ptr<DbConnectionHandler> dbHandler;
+    ScrobbleJournal journal;
+
+    QNetworkAccessManager* network{nullptr};
+    QNetworkReply* reply{nullptr};
+    ScrobbleList submitting;
+
+    QString apiKey;
+    QString apiSecret;
+    QString sessionKey;
+    bool credentialsRejected{false};
+
+    QBasicTimer submitTimer;
+    std::chrono::seconds retryDelay{0};
+    // Halved while a rejected batch is narrowed down to the scrobbles Last.fm won't take
+    int batchSize{MaxBatchSize};
+
+    Private(LastFmScrobbler* self_, DbConnectionPoolPtr dbPool_)
+        : self{self_}
+        , dbPool{std::move(dbPool_)}
+    { }
+
+    [[nodiscard]] bool canSubmit() const
+    {
+        return network && !reply && !credentialsRejected && !apiKey.isEmpty() && !apiSecret.isEmpty()
+            && !sessionKey.isEmpty();
+    }
+
+    void scheduleSubmit(std::chrono::milliseconds delay)
+    {
+        // Already waiting, either to batch or to back off
+        if(!submitTimer.isActive()) {
+            submitTimer.start(static_cast<int>(delay.count()), self);
+        }
+    }
+
+    void backOff()
+    {
+        const std::chrono::seconds minDelay{MinRetryDelay};
+        const std::chrono::seconds maxDelay{MaxRetryDelay};
+
+        retryDelay = std::clamp(retryDelay * 2, minDelay, maxDelay);
+        qInfo() << "[Scrobbler] Retrying" << journal.count() << "scrobbles in" << retryDelay.count() << "s";
+        submitTimer.start(static_cast<int>(std::chrono::milliseconds{retryDelay}.count()), self);
+    }
+
+    void submit()
+    {
+        if(!canSubmit()) {
+            return;
+        }
+
+        submitting = journal.oldest(batchSize);
+        if(submitting.empty()) {
+            return;
+        }
+
+        std::map<QString, QString> params{{QStringLiteral("method"), QStringLiteral("track.scrobble")},
+                                          {QStringLiteral("api_key"), apiKey},
+                                          {QStringLiteral("sk"), sessionKey}};
+
+        for(size_t i{0}; i < submitting.size(); ++i) {
+            const Scrobble& scrobble = submitting.at(i);
+            const auto param         = [i](const char* name) {
+                return QStringLiteral("%1[%2]").arg(QLatin1String{name}).arg(i);
+            };
+
+            params.emplace(param("artist"), scrobble.artist);
+            params.emplace(param("track"), scrobble.title);
+            params.emplace(param("timestamp"), QString::number(scrobble.timestamp));
+            if(!scrobble.album.isEmpty()) {
+                params.emplace(param("album"), scrobble.album);
+            }
+            if(!scrobble.albumArtist.isEmpty() && scrobble.albumArtist != scrobble.artist) {
+                params.emplace(param("albumArtist"), scrobble.albumArtist);
+            }
+            if(scrobble.trackNumber > 0) {
+                params.emplace(param("trackNumber"), QString::number(scrobble.trackNumber));
+            }
+            if(scrobble.duration > 0) {
+                params.emplace(param("duration"), QString::number(scrobble.duration));
+            }
+        }
+
+        params.emplace(QStringLiteral("api_sig"), signature(params, apiSecret));
+        // Not covered by the signature
+        params.emplace(QStringLiteral("format"), QStringLiteral("json"));
+
+        QNetworkRequest request{QUrl{QString::fromLatin1(ApiUrl)}};
+        request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/x-www-form-urlencoded"));
+        request.setTransferTimeout(static_cast<int>(std::chrono::milliseconds{RequestTimeout}.count()));
+
+        reply = network->post(request, encodeForm(params));
+        QObject::connect(reply, &QNetworkReply::finished, self, [this]() { handleReply(); });
+    }
+
+    void handleReply()
+    {
+        QNetworkReply* finished = std::exchange(reply, nullptr);
+        finished->deleteLater();
+
+        const int status         = finished->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QJsonObject result = QJsonDocument::fromJson(finished->readAll()).object();
+
+        if(result.contains(u"error")) {
+            const int code        = result.value(u"error").toInt();
+            const QString message = result.value(u"message").toString();
+
+            switch(classifyError(code)) {
+                case(ApiError::Temporary):
+                    qInfo() << "[Scrobbler] Last.fm is unavailable:" << message;
+                    backOff();
+                    return;
+                case(ApiError::Credentials):
+                    // Kept until the account is set up again
+                    qWarning() << "[Scrobbler] Last.fm rejected the account:" << message;
+                    credentialsRejected = true;
+                    return;
+                case(ApiError::Permanent):
+                    if(submitting.size() > 1) {
+                        // Any one of them may be at fault, so the batch is split until the culprits are found
+                        batchSize = static_cast<int>(submitting.size()) / 2;
+                        qInfo() << "[Scrobbler] Last.fm rejected" << submitting.size()
+                                << "scrobbles, retrying in batches of" << batchSize << ":" << message;
+                        submitting.clear();
+                        submit();
+                        return;
+                    }
+                    qWarning() << "[Scrobbler] Dropping scrobble of" << submitting.front().artist << "-"
+                               << submitting.front().title << "rejected by Last.fm:" << message;
+                    batchSize = MaxBatchSize;
+                    break;
+            }
+        }
+        else if(finished->error() != QNetworkReply::NoError || status >= 500 || result.isEmpty()) {
+            // Offline, timed out or a server error, none of which say anything about the scrobbles
+            qInfo() << "[Scrobbler] Unable to reach Last.fm:" << finished->errorString();
+            backOff();
+            return;
+        }
+        else {
+            const QJsonObject counts = result.value(u"scrobbles").toObject().value(u"@attr").toObject();
+            qDebug() << "[Scrobbler] Submitted" << submitting.size() << "scrobbles:"
+                     << counts.value(u"accepted").toInt() << "accepted," << counts.value(u"ignored").toInt()
+                     << "ignored";
+        }
+
+        // Nothing older was left to narrow down, so later batches can be full again
+        if(std::cmp_less(submitting.size(), batchSize)) {
+            batchSize = MaxBatchSize;
+        }
+
+        journal.remove(std::exchange(submitting, {}));
+        retryDelay = {};
+
+        // Catching up on a backlog, one batch after another
+        submit();
+    }
+};
+
+LastFmScrobbler::LastFmScrobbler(DbConnectionPoolPtr dbPool, QObject* parent)
+    : QObject{parent}
+    , p{std::make_unique<Private>(this, std::move(dbPool))}
+{ }
+
+LastFmScrobbler::~LastFmScrobbler() = default;
+
+void LastFmScrobbler::initialise()
+{
+    p->dbHandler = std::make_unique<DbConnectionHandler>(p->dbPool);
+    p->journal.initialise(DbConnectionProvider{p->dbPool});
+    if(!p->journal.initialiseDatabase()) {
+        qWarning() << "[Scrobbler] Unable to open the scrobble journal";
+    }
+
+    p->network = new QNetworkAccessManager(this);
+    p->submit();
+}
+
+void LastFmScrobbler::setCredentials(const QString& apiKey, const QString& apiSecret, const QString& sessionKey)
+{
+    p->apiKey              = apiKey;
+    p->apiSecret           = apiSecret;
+    p->sessionKey          = sessionKey;
+    p->credentialsRejected = false;
+
+    p->submit();
+}
+
+void LastFmScrobbler::queue(Scrobble scrobble)
+{
+    if(!p->journal.add(scrobble)) {
+        qWarning() << "[Scrobbler] Unable to store scrobble of" << scrobble.artist << "-" << scrobble.title;
+        return;
+    }
+
+    p->scheduleSubmit(SubmitDelay);
+}
+
+QString LastFmScrobbler::signature(const std::map<QString, QString>& params, const QString& secret)
+{
+    QByteArray data;
+    for(const auto& [name, value] : params) {
+        data.append(name.toUtf8());
+        data.append(value.toUtf8());
+    }
+    data.append(secret.toUtf8());
+
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
+}
+
+void LastFmScrobbler::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() == p->submitTimer.timerId()) {
+        p->submitTimer.stop();
+        p->submit();
+    }
+    QObject::timerEvent(event);
+}
+} // namespace Fooyin::Scrobbler
+
+#include "moc_lastfmscrobbler.cpp"
@@ -0,0 +1,66 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "scrobble.h"
+
+#include <utils/database/dbconnectionpool.h>
+
+#include <QObject>
+
+#include <map>
+#include <memory>
+
+namespace Fooyin::Scrobbler {
+/*!
+ * Submits scrobbles to Last.fm from a journal on disk.
+ *
+ * Scrobbles are stored as soon as they're queued, then sent in batches of up to 50, the most a single
+ * track.scrobble request takes, so catching up after days offline only takes a few requests. Failed requests are
+ * retried with exponential backoff, and are only dropped from the journal once Last.fm has answered for them.
+ *
+ * Runs on a thread of its own: once moved to it, call initialise() there before anything else.
+ */
+class LastFmScrobbler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LastFmScrobbler(DbConnectionPoolPtr dbPool, QObject* parent = nullptr);
+    ~LastFmScrobbler() override;
+
+    /** Opens the journal and submits anything left in it by an earlier session. */
+    void initialise();
+    /** Sets the account to scrobble to. Nothing is submitted unless all three are set. */
+    void setCredentials(const QString& apiKey, const QString& apiSecret, const QString& sessionKey);
+    /** Stores @p scrobble in the journal, to be submitted with the next batch. */
+    void queue(Scrobble scrobble);
+
+    /** Returns the api_sig of a request with @p params: the MD5 of each name and value in order, then @p secret. */
+    static QString signature(const std::map<QString, QString>& params, const QString& secret);
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> p;
+};
+} // namespace Fooyin::Scrobbler
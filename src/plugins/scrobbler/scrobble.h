@@ -0,0 +1,47 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+namespace Fooyin::Scrobbler {
+/*!
+ * A play of a track, as submitted to Last.fm.
+ * Only what's needed to submit it is kept, so it doesn't depend on the track still being in the library.
+ */
+struct Scrobble
+{
+    // Row of the journal, or -1 if not yet stored
+    int64_t id{-1};
+    // When the track started playing, in seconds since the epoch (UTC)
+    int64_t timestamp{0};
+    QString artist;
+    QString title;
+    QString album;
+    QString albumArtist;
+    int trackNumber{0};
+    // In seconds
+    int duration{0};
+};
+using ScrobbleList = std::vector<Scrobble>;
+} // namespace Fooyin::Scrobbler
@@ -0,0 +1,124 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scrobblejournal.h"
+
+#include <utils/database/dbquery.h>
+#include <utils/database/dbtransaction.h>
+
+namespace Fooyin::Scrobbler {
+bool ScrobbleJournal::initialiseDatabase() const
+{
+    const auto statement = QStringLiteral("CREATE TABLE IF NOT EXISTS Scrobbles ("
+                                          "ScrobbleID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                                          "Timestamp INTEGER NOT NULL, "
+                                          "Artist TEXT NOT NULL, "
+                                          "Title TEXT NOT NULL, "
+                                          "Album TEXT, "
+                                          "AlbumArtist TEXT, "
+                                          "TrackNumber INTEGER, "
+                                          "Duration INTEGER);");
+
+    DbQuery query{db(), statement};
+    return query.exec();
+}
+
+bool ScrobbleJournal::add(Scrobble& scrobble) const
+{
+    const auto statement
+        = QStringLiteral("INSERT INTO Scrobbles (Timestamp, Artist, Title, Album, AlbumArtist, TrackNumber, Duration) "
+                         "VALUES (:timestamp, :artist, :title, :album, :albumArtist, :trackNumber, :duration);");
+
+    DbQuery query{db(), statement};
+    query.bindValue(QStringLiteral(":timestamp"), static_cast<qint64>(scrobble.timestamp));
+    query.bindValue(QStringLiteral(":artist"), scrobble.artist);
+    query.bindValue(QStringLiteral(":title"), scrobble.title);
+    query.bindValue(QStringLiteral(":album"), scrobble.album);
+    query.bindValue(QStringLiteral(":albumArtist"), scrobble.albumArtist);
+    query.bindValue(QStringLiteral(":trackNumber"), scrobble.trackNumber);
+    query.bindValue(QStringLiteral(":duration"), scrobble.duration);
+
+    if(!query.exec()) {
+        return false;
+    }
+
+    scrobble.id = query.lastInsertId().toLongLong();
+    return true;
+}
+
+ScrobbleList ScrobbleJournal::oldest(int limit) const
+{
+    const auto statement
+        = QStringLiteral("SELECT ScrobbleID, Timestamp, Artist, Title, Album, AlbumArtist, TrackNumber, Duration "
+                         "FROM Scrobbles ORDER BY ScrobbleID LIMIT :limit;");
+
+    DbQuery query{db(), statement};
+    query.bindValue(QStringLiteral(":limit"), limit);
+
+    ScrobbleList scrobbles;
+    if(!query.exec()) {
+        return scrobbles;
+    }
+
+    while(query.next()) {
+        Scrobble& scrobble   = scrobbles.emplace_back();
+        scrobble.id          = query.value(0).toLongLong();
+        scrobble.timestamp   = query.value(1).toLongLong();
+        scrobble.artist      = query.value(2).toString();
+        scrobble.title       = query.value(3).toString();
+        scrobble.album       = query.value(4).toString();
+        scrobble.albumArtist = query.value(5).toString();
+        scrobble.trackNumber = query.value(6).toInt();
+        scrobble.duration    = query.value(7).toInt();
+    }
+
+    return scrobbles;
+}
+
+bool ScrobbleJournal::remove(const ScrobbleList& scrobbles) const
+{
+    DbTransaction transaction{db()};
+    if(!transaction) {
+        return false;
+    }
+
+    const auto statement = QStringLiteral("DELETE FROM Scrobbles WHERE ScrobbleID = :scrobbleId;");
+
+    DbQuery query{db(), statement};
+    for(const Scrobble& scrobble : scrobbles) {
+        query.bindValue(QStringLiteral(":scrobbleId"), static_cast<qint64>(scrobble.id));
+        if(!query.exec()) {
+            return false;
+        }
+    }
+
+    return transaction.commit();
+}
+
+int ScrobbleJournal::count() const
+{
+    const auto statement = QStringLiteral("SELECT COUNT(*) FROM Scrobbles;");
+
+    DbQuery query{db(), statement};
+    if(query.exec() && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+} // namespace Fooyin::Scrobbler
@@ -0,0 +1,43 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "scrobble.h"
+
+#include <utils/database/dbmodule.h>
+
+namespace Fooyin::Scrobbler {
+/*!
+ * Scrobbles waiting to be submitted, kept on disk so none are lost while offline or across restarts.
+ * Scrobbles are only removed once Last.fm has answered for them.
+ */
+class ScrobbleJournal : public DbModule
+{
+public:
+    bool initialiseDatabase() const;
+
+    /** Stores @p scrobble, setting its id. */
+    bool add(Scrobble& scrobble) const;
+    /** Returns up to @p limit of the oldest scrobbles. */
+    [[nodiscard]] ScrobbleList oldest(int limit) const;
+    bool remove(const ScrobbleList& scrobbles) const;
+    [[nodiscard]] int count() const;
+};
+} // namespace Fooyin::Scrobbler
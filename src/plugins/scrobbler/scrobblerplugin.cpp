@@ -0,0 +1,147 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "scrobblerplugin.h"
+
+#include "lastfmscrobbler.h"
+#include "scrobblersettings.h"
+
+#include <core/player/playercontroller.h>
+#include <core/track.h>
+#include <utils/paths.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QDateTime>
+#include <QThread>
+
+// Last.fm ignores tracks shorter than this
+constexpr auto MinScrobbleDuration = 30;
+
+namespace {
+Fooyin::DbConnection::DbParams dbConnectionParams()
+{
+    Fooyin::DbConnection::DbParams params;
+    params.type           = QStringLiteral("QSQLITE");
+    params.connectOptions = QStringLiteral("QSQLITE_OPEN_URI");
+    params.filePath       = Fooyin::Utils::configPath(QStringLiteral("scrobbler.db"));
+
+    return params;
+}
+} // namespace
+
+namespace Fooyin::Scrobbler {
+struct ScrobblerPlugin::Private
+{
+    PlayerController* playerController{nullptr};
+    SettingsManager* settings{nullptr};
+
+    DbConnectionPoolPtr dbPool;
+    QThread thread;
+    // Deleted on its own thread once that finishes
+    LastFmScrobbler* scrobbler;
+
+    std::unique_ptr<ScrobblerSettings> scrobblerSettings;
+
+    Private()
+        : dbPool{DbConnectionPool::create(dbConnectionParams(), QStringLiteral("scrobbler"))}
+        , scrobbler{new LastFmScrobbler(dbPool)}
+    {
+        scrobbler->moveToThread(&thread);
+        QObject::connect(&thread, &QThread::finished, scrobbler, &QObject::deleteLater);
+    }
+
+    void updateCredentials() const
+    {
+        const bool enabled = settings->value<Settings::Scrobbler::Enabled>();
+
+        const QString apiKey     = enabled ? settings->value<Settings::Scrobbler::ApiKey>() : QString{};
+        const QString apiSecret  = enabled ? settings->value<Settings::Scrobbler::ApiSecret>() : QString{};
+        const QString sessionKey = enabled ? settings->value<Settings::Scrobbler::SessionKey>() : QString{};
+
+        QMetaObject::invokeMethod(scrobbler, [scrobbler = scrobbler, apiKey, apiSecret, sessionKey]() {
+            scrobbler->setCredentials(apiKey, apiSecret, sessionKey);
+        });
+    }
+
+    void trackPlayed(const Track& track) const
+    {
+        if(!settings->value<Settings::Scrobbler::Enabled>()) {
+            return;
+        }
+
+        const auto duration = static_cast<int>(track.duration() / 1000);
+        if(duration < MinScrobbleDuration || track.artist().isEmpty() || track.title().isEmpty()) {
+            return;
+        }
+
+        // Played is emitted partway through, but Last.fm wants the time the track started
+        const auto played = static_cast<int64_t>(playerController->currentPosition() / 1000);
+
+        Scrobble scrobble;
+        scrobble.timestamp   = QDateTime::currentSecsSinceEpoch() - played;
+        scrobble.artist      = track.artist();
+        scrobble.title       = track.title();
+        scrobble.album       = track.album();
+        scrobble.albumArtist = track.albumArtist();
+        scrobble.trackNumber = track.trackNumber();
+        scrobble.duration    = duration;
+
+        QMetaObject::invokeMethod(scrobbler, [scrobbler = scrobbler, scrobble]() { scrobbler->queue(scrobble); });
+    }
+};
+
+ScrobblerPlugin::ScrobblerPlugin()
+    : p{std::make_unique<Private>()}
+{ }
+
+ScrobblerPlugin::~ScrobblerPlugin()
+{
+    shutdown();
+}
+
+void ScrobblerPlugin::initialise(const CorePluginContext& context)
+{
+    p->playerController  = context.playerController;
+    p->settings          = context.settingsManager;
+    p->scrobblerSettings = std::make_unique<ScrobblerSettings>(p->settings);
+
+    p->thread.start();
+    QMetaObject::invokeMethod(p->scrobbler, &LastFmScrobbler::initialise);
+    p->updateCredentials();
+
+    const auto updateCredentials = [this]() { p->updateCredentials(); };
+    p->settings->subscribe<Settings::Scrobbler::Enabled>(this, updateCredentials);
+    p->settings->subscribe<Settings::Scrobbler::ApiKey>(this, updateCredentials);
+    p->settings->subscribe<Settings::Scrobbler::ApiSecret>(this, updateCredentials);
+    p->settings->subscribe<Settings::Scrobbler::SessionKey>(this, updateCredentials);
+
+    QObject::connect(p->playerController, &PlayerController::trackPlayed, this,
+                     [this](const Track& track) { p->trackPlayed(track); });
+}
+
+void ScrobblerPlugin::shutdown()
+{
+    if(p->thread.isRunning()) {
+        p->thread.quit();
+        p->thread.wait();
+    }
+}
+} // namespace Fooyin::Scrobbler
+
+#include "moc_scrobblerplugin.cpp"
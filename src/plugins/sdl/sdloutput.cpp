@@ -19,11 +19,15 @@
 
 #include "sdloutput.h"
 
+#include <core/engine/audiobuffer.h>
+
 #include <SDL2/SDL.h>
 
 #include <QDebug>
 #include <QTimerEvent>
 
+#include <algorithm>
+
 using namespace std::chrono_literals;
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
@@ -31,6 +35,10 @@ constexpr auto EventInterval = 200ms;
 #else
 constexpr auto EventInterval = 200;
 #endif
+// Device buffer size requested from SDL, in frames
+constexpr auto DesiredBufferSize = 4096;
+// Device periods held in the ring buffer when samples are pushed
+constexpr auto RingPeriods = 2;
 
 namespace {
 SDL_AudioFormat findFormat(Fooyin::SampleFormat format)
@@ -54,10 +62,15 @@ SDL_AudioFormat findFormat(Fooyin::SampleFormat format)
 
 namespace Fooyin::Sdl {
 SdlOutput::SdlOutput()
-    : m_bufferSize{4096}
+    : m_bufferSize{DesiredBufferSize}
     , m_initialised{false}
     , m_device{QStringLiteral("default")}
     , m_volume{1.0}
+    , m_source{nullptr}
+    , m_desiredSpec{}
+    , m_obtainedSpec{}
+    , m_audioDeviceId{0}
+    , m_event{}
 { }
 
 bool SdlOutput::init(const AudioFormat& format)
@@ -69,22 +82,23 @@ bool SdlOutput::init(const AudioFormat& format)
     m_desiredSpec.freq     = format.sampleRate();
     m_desiredSpec.format   = findFormat(format.sampleFormat());
     m_desiredSpec.channels = format.channelCount();
-    m_desiredSpec.samples  = m_bufferSize;
-    m_desiredSpec.callback = nullptr;
+    m_desiredSpec.samples  = DesiredBufferSize;
+    m_desiredSpec.callback = audioCallback;
+    m_desiredSpec.userdata = this;
 
-    if(m_device == QStringLiteral("default")) {
-        m_audioDeviceId = SDL_OpenAudioDevice(nullptr, 0, &m_desiredSpec, &m_obtainedSpec, SDL_AUDIO_ALLOW_ANY_CHANGE);
-    }
-    else {
-        m_audioDeviceId = SDL_OpenAudioDevice(m_device.toLocal8Bit().constData(), 0, &m_desiredSpec, &m_obtainedSpec,
-                                              SDL_AUDIO_ALLOW_ANY_CHANGE);
-    }
+    // Only the period size may change; SDL converts anything else the device doesn't support itself
+    const QByteArray deviceName = m_device.toLocal8Bit();
+    m_audioDeviceId = SDL_OpenAudioDevice(m_device == u"default" ? nullptr : deviceName.constData(), 0, &m_desiredSpec,
+                                          &m_obtainedSpec, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
 
     if(m_audioDeviceId == 0) {
         qDebug() << "[SDL] Error opening audio device: " << SDL_GetError();
         return false;
     }
 
+    m_bufferSize = m_obtainedSpec.samples;
+    m_ringBuffer.resize(static_cast<size_t>(format.bytesForFrames(m_bufferSize * RingPeriods)));
+
     m_initialised = true;
     return true;
 }
@@ -95,18 +109,24 @@ void SdlOutput::uninit()
     SDL_CloseAudioDevice(m_audioDeviceId);
     SDL_Quit();
 
+    m_audioDeviceId = 0;
+    m_ringBuffer.clear();
     m_initialised = false;
 }
 
 void SdlOutput::reset()
 {
     SDL_PauseAudioDevice(m_audioDeviceId, 1);
-    SDL_ClearQueuedAudio(m_audioDeviceId);
+
+    // Holding the device lock guarantees the callback isn't reading while we empty the ring
+    SDL_LockAudioDevice(m_audioDeviceId);
+    m_ringBuffer.clear();
+    SDL_UnlockAudioDevice(m_audioDeviceId);
 }
 
 void SdlOutput::start()
 {
-    if(SDL_GetAudioStatus() != SDL_AUDIO_PLAYING) {
+    if(SDL_GetAudioDeviceStatus(m_audioDeviceId) != SDL_AUDIO_PLAYING) {
         SDL_PauseAudioDevice(m_audioDeviceId, 0);
         m_eventTimer.start(EventInterval, this);
     }
@@ -122,6 +142,11 @@ QString SdlOutput::device() const
     return m_device;
 }
 
+AudioOutput::Capabilities SdlOutput::capabilities() const
+{
+    return PullMode;
+}
+
 int SdlOutput::bufferSize() const
 {
     return m_bufferSize;
@@ -131,8 +156,17 @@ OutputState SdlOutput::currentState()
 {
     OutputState state;
 
-    state.queuedSamples = static_cast<int>(SDL_GetQueuedAudioSize(m_audioDeviceId) / m_format.bytesPerFrame());
-    state.freeSamples   = m_bufferSize - state.queuedSamples;
+    const int stride = m_format.bytesPerFrame();
+    if(stride == 0) {
+        return state;
+    }
+
+    const auto capacity = static_cast<int>(m_ringBuffer.capacity() / stride);
+
+    state.queuedSamples = static_cast<int>(m_ringBuffer.readAvailable() / stride);
+    state.freeSamples   = capacity - state.queuedSamples;
+    // Anything queued still has to pass through the device's own buffer
+    state.delay = static_cast<double>(state.queuedSamples + m_bufferSize) / m_format.sampleRate();
 
     return state;
 }
@@ -166,14 +200,22 @@ OutputDevices SdlOutput::getAllDevices() const
 
 int SdlOutput::write(const AudioBuffer& buffer)
 {
-    AudioBuffer adjustedBuffer{buffer};
-    adjustedBuffer.scale(m_volume);
-
-    if(SDL_QueueAudio(m_audioDeviceId, adjustedBuffer.constData().data(), buffer.byteCount()) == 0) {
-        return buffer.sampleCount();
+    const auto stride = static_cast<size_t>(m_format.bytesPerFrame());
+    if(stride == 0) {
+        return 0;
     }
 
-    return 0;
+    const auto data      = buffer.constData();
+    const size_t free    = m_ringBuffer.writeAvailable();
+    const size_t count   = std::min(data.size(), free - (free % stride));
+    const size_t written = m_ringBuffer.write(data.data(), count - (count % stride));
+
+    return static_cast<int>(written / stride);
+}
+
+void SdlOutput::setSource(AudioSource* source)
+{
+    m_source.store(source, std::memory_order_release);
 }
 
 void SdlOutput::setPaused(bool pause)
@@ -183,7 +225,7 @@ void SdlOutput::setPaused(bool pause)
 
 void SdlOutput::setVolume(double volume)
 {
-    m_volume = volume;
+    m_volume.store(volume, std::memory_order_relaxed);
 }
 
 void SdlOutput::setDevice(const QString& device)
@@ -202,6 +244,39 @@ void SdlOutput::timerEvent(QTimerEvent* event)
     AudioOutput::timerEvent(event);
 }
 
+void SdlOutput::audioCallback(void* userData, Uint8* stream, int len)
+{
+    auto* self       = static_cast<SdlOutput*>(userData);
+    const int stride = self->m_format.bytesPerFrame();
+
+    if(stride > 0) {
+        self->fillBuffer(reinterpret_cast<std::byte*>(stream), len / stride);
+    }
+}
+
+void SdlOutput::fillBuffer(std::byte* data, int frames)
+{
+    const int stride = m_format.bytesPerFrame();
+
+    int framesRead{0};
+    if(auto* source = m_source.load(std::memory_order_acquire)) {
+        framesRead = source->readFrames(data, frames);
+    }
+    else {
+        framesRead = static_cast<int>(m_ringBuffer.read(data, static_cast<size_t>(frames * stride)) / stride);
+    }
+
+    if(const double volume = m_volume.load(std::memory_order_relaxed); framesRead > 0 && volume < 1.0) {
+        Audio::scale(m_format, data, framesRead, volume);
+    }
+
+    if(framesRead < frames) {
+        // Underrun or end of track: pad the period with silence
+        const auto silence = m_format.sampleFormat() == SampleFormat::U8 ? std::byte{0x80} : std::byte{0};
+        std::fill(data + framesRead * stride, data + frames * stride, silence);
+    }
+}
+
 void SdlOutput::checkEvents()
 {
     while(SDL_PollEvent(&m_event)) {
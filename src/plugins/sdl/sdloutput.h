@@ -20,6 +20,7 @@
 #pragma once
 
 #include <core/engine/audiooutput.h>
+#include <utils/spscringbuffer.h>
 
 #include <SDL2/SDL_audio.h>
 #include <SDL2/SDL_events.h>
@@ -27,6 +28,8 @@
 #include <QBasicTimer>
 #include <QString>
 
+#include <atomic>
+
 namespace Fooyin::Sdl {
 class SdlOutput : public AudioOutput
 {
@@ -40,11 +43,13 @@ public:
 
     [[nodiscard]] bool initialised() const override;
     [[nodiscard]] QString device() const override;
+    [[nodiscard]] Capabilities capabilities() const override;
     int bufferSize() const override;
     OutputState currentState() override;
     [[nodiscard]] OutputDevices getAllDevices() const override;
 
     int write(const AudioBuffer& buffer) override;
+    void setSource(AudioSource* source) override;
     void setPaused(bool pause) override;
     void setVolume(double volume) override;
     void setDevice(const QString& device) override;
@@ -53,13 +58,19 @@ protected:
     void timerEvent(QTimerEvent* event) override;
 
 private:
+    static void audioCallback(void* userData, Uint8* stream, int len);
+    void fillBuffer(std::byte* data, int frames);
     void checkEvents();
 
     AudioFormat m_format;
     int m_bufferSize;
     bool m_initialised;
     QString m_device;
-    double m_volume;
+    std::atomic<double> m_volume;
+
+    // Written by the engine when pushing, and read from the SDL audio callback
+    SpscRingBuffer<std::byte> m_ringBuffer;
+    std::atomic<AudioSource*> m_source;
 
     SDL_AudioSpec m_desiredSpec;
     SDL_AudioSpec m_obtainedSpec;
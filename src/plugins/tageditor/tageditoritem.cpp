@@ -19,21 +19,12 @@
 
 #include "tageditoritem.h"
 
-#include <utils/helpers.h>
-
 #include <QCollator>
 
-constexpr auto MaxValueCount = 40;
-constexpr auto CharLimit     = 2000;
+#include <algorithm>
 
-namespace {
-bool withinCharLimit(const QStringList& strings)
-{
-    const int currentLength = std::accumulate(strings.cbegin(), strings.cend(), 0,
-                                              [](int sum, const QString& str) { return sum + str.length(); });
-    return currentLength <= CharLimit;
-}
-} // namespace
+// Values stop being added to a field once its text is this long
+constexpr auto CharLimit = 2000;
 
 namespace Fooyin::TagEditor {
 TagEditorItem::TagEditorItem()
@@ -87,43 +78,21 @@ int TagEditorItem::trackCount() const
     return m_trackCount;
 }
 
-void TagEditorItem::addTrack()
-{
-    m_trackCount++;
-}
-
-void TagEditorItem::addTrackValue(const QString& value)
-{
-    if(!value.isEmpty() && m_values.size() < MaxValueCount && !m_values.contains(value)) {
-        if(m_trackCount == 0 || withinCharLimit(m_values)) {
-            m_values.append(value);
-            m_values.sort();
-        }
-    }
-
-    m_trackCount++;
-}
-
-void TagEditorItem::addTrackValue(const QStringList& values)
+void TagEditorItem::setValues(const QStringList& values, int trackCount)
 {
-    if(values.empty()) {
-        return;
-    }
+    m_values.clear();
 
-    if(m_values.size() < MaxValueCount) {
-        for(const auto& trackValue : values) {
-            if(m_values.contains(trackValue)) {
-                continue;
-            }
-
-            if(m_trackCount == 0 || withinCharLimit(m_values)) {
-                m_values.append(trackValue);
-                m_values.sort();
-            }
+    int length{0};
+    for(const QString& value : values) {
+        if(!m_values.empty() && length > CharLimit) {
+            break;
         }
+        m_values.append(value);
+        length += static_cast<int>(value.length());
     }
 
-    m_trackCount++;
+    m_trackCount = trackCount;
+    m_value.clear();
 }
 
 void TagEditorItem::setValue(const QStringList& values)
@@ -41,9 +41,11 @@ public:
     [[nodiscard]] bool isDefault() const;
     [[nodiscard]] int trackCount() const;
 
-    void addTrack();
-    void addTrackValue(const QString& value);
-    void addTrackValue(const QStringList& values);
+    /*!
+     * Sets the distinct @p values of this field across @p trackCount tracks.
+     * Values past the point the list gets too long to show are dropped.
+     */
+    void setValues(const QStringList& values, int trackCount);
     void setValue(const QStringList& values);
     void setTitle(const QString& title);
 
@@ -23,10 +23,22 @@
 
 #include <core/constants.h>
 #include <core/scripting/scriptregistry.h>
+#include <core/library/tracklistdiff.h>
 #include <gui/trackselectioncontroller.h>
+#include <utils/async.h>
 #include <utils/helpers.h>
 #include <utils/settings/settingsmanager.h>
 #include <utils/starrating.h>
+#include <utils/valuetally.h>
+
+#include <map>
+#include <optional>
+#include <set>
+
+// Selections up to this many tracks (old and new together) are aggregated in place, larger ones on a worker
+constexpr size_t SyncTrackLimit = 2000;
+// Distinct values collected for a field, past which it's only known to have multiple values
+constexpr size_t MaxValueCount = 40;
 
 namespace Fooyin::TagEditor {
 using TagFieldMap = std::unordered_map<QString, TagEditorItem>;
@@ -36,6 +48,163 @@ struct EditorPair
     QString displayName;
     std::function<QString(const Track&)> metadata;
 };
+using EditorFields = std::vector<EditorPair>;
+
+namespace {
+QStringList fieldValues(const EditorPair& field, const Track& track)
+{
+    const QString result = field.metadata(track);
+    if(result.contains(u"\037")) {
+        return result.split(QStringLiteral("\037"));
+    }
+    return {result};
+}
+
+/*!
+ * The distinct values of every field across a selection, kept so the next selection can be worked out from
+ * the tracks added and removed rather than from scratch.
+ */
+struct TagAggregate
+{
+    struct CustomTag
+    {
+        int trackCount{0};
+        ValueTally values{MaxValueCount};
+    };
+
+    int total{0};
+    std::vector<ValueTally> fields;
+    std::map<QString, CustomTag> customTags;
+
+    // Fields whose removals couldn't be applied, to be collected again from the full selection
+    std::vector<bool> staleFields;
+    std::set<QString> staleCustomTags;
+
+    explicit TagAggregate(size_t fieldCount = 0)
+        : fields(fieldCount, ValueTally{MaxValueCount})
+        , staleFields(fieldCount, false)
+    { }
+
+    void add(const EditorFields& editorFields, const Track& track)
+    {
+        ++total;
+
+        for(size_t i{0}; i < editorFields.size(); ++i) {
+            // The field is already known to hold multiple values
+            if(!fields.at(i).overflowed()) {
+                fields.at(i).add(fieldValues(editorFields.at(i), track));
+            }
+        }
+
+        const auto trackTags = track.extraTags();
+        for(const auto& [tag, values] : Utils::asRange(trackTags)) {
+            if(!values.empty()) {
+                auto& customTag = customTags[tag];
+                ++customTag.trackCount;
+                customTag.values.add(values);
+            }
+        }
+    }
+
+    void remove(const EditorFields& editorFields, const Track& track)
+    {
+        --total;
+
+        for(size_t i{0}; i < editorFields.size(); ++i) {
+            if(!staleFields.at(i) && !fields.at(i).remove(fieldValues(editorFields.at(i), track))) {
+                staleFields.at(i) = true;
+            }
+        }
+
+        const auto trackTags = track.extraTags();
+        for(const auto& [tag, values] : Utils::asRange(trackTags)) {
+            const auto tagIt = customTags.find(tag);
+            if(values.empty() || tagIt == customTags.end()) {
+                continue;
+            }
+            if(--tagIt->second.trackCount == 0) {
+                customTags.erase(tagIt);
+                staleCustomTags.erase(tag);
+            }
+            else if(!tagIt->second.values.remove(values)) {
+                staleCustomTags.emplace(tag);
+            }
+        }
+    }
+
+    // Collects any stale fields again from @p tracks, stopping once they've all reached their limit
+    void refresh(const EditorFields& editorFields, const TrackList& tracks)
+    {
+        const bool anyStaleField = std::ranges::find(staleFields, true) != staleFields.end();
+        if(!anyStaleField && staleCustomTags.empty()) {
+            return;
+        }
+
+        for(size_t i{0}; i < fields.size(); ++i) {
+            if(staleFields.at(i)) {
+                fields.at(i) = ValueTally{MaxValueCount};
+            }
+        }
+        for(const QString& tag : staleCustomTags) {
+            customTags.at(tag).values = ValueTally{MaxValueCount};
+        }
+
+        for(const Track& track : tracks) {
+            bool collecting{false};
+
+            for(size_t i{0}; i < fields.size(); ++i) {
+                if(staleFields.at(i) && !fields.at(i).overflowed()) {
+                    collecting = true;
+                    fields.at(i).add(fieldValues(editorFields.at(i), track));
+                }
+            }
+
+            if(std::ranges::any_of(staleCustomTags,
+                                   [this](const QString& tag) { return !customTags.at(tag).values.overflowed(); })) {
+                collecting           = true;
+                const auto trackTags = track.extraTags();
+                for(const QString& tag : staleCustomTags) {
+                    if(const auto values = trackTags.constFind(tag); values != trackTags.cend()) {
+                        customTags.at(tag).values.add(values.value());
+                    }
+                }
+            }
+
+            if(!collecting) {
+                break;
+            }
+        }
+
+        staleFields.assign(staleFields.size(), false);
+        staleCustomTags.clear();
+    }
+};
+
+TagAggregate aggregateTags(const EditorFields& editorFields, std::optional<TagAggregate> previous,
+                           const TrackList& previousTracks, const TrackList& tracks)
+{
+    if(previous) {
+        // Growing or shrinking a large selection only needs the difference applied
+        if(const auto diff = diffTracks(previousTracks, tracks);
+           diff && diff->added.size() + diff->removed.size() < tracks.size()) {
+            for(const Track& track : diff->removed) {
+                previous->remove(editorFields, track);
+            }
+            for(const Track& track : diff->added) {
+                previous->add(editorFields, track);
+            }
+            previous->refresh(editorFields, tracks);
+            return std::move(*previous);
+        }
+    }
+
+    TagAggregate aggregate{editorFields.size()};
+    for(const Track& track : tracks) {
+        aggregate.add(editorFields, track);
+    }
+    return aggregate;
+}
+} // namespace
 
 struct TagEditorModel::Private
 {
@@ -46,8 +215,14 @@ struct TagEditorModel::Private
 
     TrackList tracks;
 
+    // The selection last aggregated, as it was then, and its aggregate
+    TrackList aggregatedTracks;
+    std::optional<TagAggregate> aggregate;
+    // Identifies the latest reset, so results of earlier ones finishing later are dropped
+    uint64_t generation{0};
+
     // TODO: Make fields shown configurable
-    const std::vector<EditorPair> fields{
+    const EditorFields fields{
         {QStringLiteral("Artist Name"), &Track::artist},
         {QStringLiteral("Track Title"), &Track::title},
         {QStringLiteral("Album Title"), &Track::album},
@@ -123,53 +298,30 @@ struct TagEditorModel::Private
         customTags.clear();
     }
 
-    void updateFields()
+    void applyAggregate(TrackList newTracks, TagAggregate info)
     {
-        for(const Track& track : tracks) {
-            const auto trackTags = track.extraTags();
+        aggregatedTracks = std::move(newTracks);
+        aggregate.emplace(std::move(info));
 
-            for(const auto& [field, values] : Utils::asRange(trackTags)) {
-                if(values.empty()) {
-                    continue;
-                }
+        self->beginResetModel();
+        reset();
 
-                if(!customTags.contains(field)) {
-                    auto* item = &customTags.emplace(field, TagEditorItem{field, &root, false}).first->second;
-                    root.appendChild(item);
-                }
-
-                auto* fieldItem = &customTags.at(field);
-                fieldItem->addTrackValue(values);
-            }
+        for(size_t i{0}; i < fields.size(); ++i) {
+            const QString& field = fields.at(i).displayName;
+            auto* item           = &tags.emplace(field, TagEditorItem{field, &root, true}).first->second;
+            root.appendChild(item);
+            item->setValues(aggregate->fields.at(i).values(), aggregate->total);
         }
 
-        updateEditorValues();
-    }
-
-    void updateEditorValues()
-    {
-        if(tracks.empty()) {
-            return;
+        for(const auto& [field, customTag] : aggregate->customTags) {
+            auto* item = &customTags.emplace(field, TagEditorItem{field, &root, false}).first->second;
+            root.appendChild(item);
+            item->setValues(customTag.values.values(), aggregate->total);
         }
 
-        for(const auto& track : tracks) {
-            for(const auto& [field, var] : fields) {
-                const auto result = var(track);
-                if(result.contains(u"\037")) {
-                    tags[field].addTrackValue(result.split(QStringLiteral("\037")));
-                }
-                else {
-                    tags[field].addTrackValue(result);
-                }
-            }
+        root.sortCustomTags();
 
-            for(auto& [field, node] : customTags) {
-                const auto result = scriptRegistry.value(field, track);
-                if(!result.cond) {
-                    node.addTrack();
-                }
-            }
-        }
+        self->endResetModel();
     }
 
     void updateTrackMetadata(const QString& name, const QVariant& value)
@@ -258,19 +410,30 @@ TagEditorModel::~TagEditorModel() = default;
 
 void TagEditorModel::reset(const TrackList& tracks)
 {
-    beginResetModel();
-    p->reset();
     p->tracks = tracks;
 
-    for(const auto& [field, _] : p->fields) {
-        auto* item = &p->tags.emplace(field, TagEditorItem{field, &p->root, true}).first->second;
-        p->root.appendChild(item);
-    }
+    const uint64_t generation = ++p->generation;
+    const bool inPlace        = tracks.size() + p->aggregatedTracks.size() <= SyncTrackLimit;
 
-    p->updateFields();
-    p->root.sortCustomTags();
+    auto aggregate = [fields = p->fields, previous = p->aggregate, previousTracks = p->aggregatedTracks, tracks]() {
+        return aggregateTags(fields, previous, previousTracks, tracks);
+    };
 
+    if(inPlace) {
+        p->applyAggregate(tracks, aggregate());
+        return;
+    }
+
+    // Nothing can be edited until the values of the selection are known
+    beginResetModel();
+    p->reset();
     endResetModel();
+
+    Utils::asyncExec(std::move(aggregate)).then(this, [this, generation, tracks](const TagAggregate& info) {
+        if(generation == p->generation) {
+            p->applyAggregate(tracks, info);
+        }
+    });
 }
 
 bool TagEditorModel::processQueue()
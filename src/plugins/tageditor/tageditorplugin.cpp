@@ -31,8 +31,35 @@
 #include <utils/settings/settingsmanager.h>
 
 #include <QMenu>
+#include <QProgressDialog>
 
 namespace Fooyin::TagEditor {
+void TagEditorPlugin::writeTracks(const TrackList& tracks)
+{
+    const ScanRequest request = m_library->updateTrackMetadata(tracks);
+    if(request.id < 0) {
+        return;
+    }
+
+    // Only shown if writing takes a while, e.g. when editing a large selection
+    auto* dialog = new QProgressDialog(tr("Writing tags…"), tr("Abort"), 0, 100);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowModality(Qt::WindowModal);
+
+    QObject::connect(m_library, &MusicLibrary::scanProgress, dialog, [dialog, request](int id, int percent) {
+        if(id != request.id) {
+            return;
+        }
+
+        if(dialog->wasCanceled()) {
+            request.cancel();
+            dialog->close();
+        }
+
+        dialog->setValue(percent);
+    });
+}
+
 void TagEditorPlugin::initialise(const CorePluginContext& context)
 {
     m_settings = context.settingsManager;
@@ -55,8 +82,8 @@ void TagEditorPlugin::initialise(const GuiPluginContext& context)
 
     m_propertiesDialog->insertTab(0, QStringLiteral("Metadata"), [this]() {
         auto* tagEditor = new TagEditorWidget(m_trackSelection->selectedTracks(), m_actionManager, m_settings);
-        QObject::connect(tagEditor, &TagEditorWidget::trackMetadataChanged, m_library,
-                         &MusicLibrary::updateTrackMetadata);
+        QObject::connect(tagEditor, &TagEditorWidget::trackMetadataChanged, this,
+                         [this](const TrackList& tracks) { writeTracks(tracks); });
         return tagEditor;
     });
 }
@@ -38,6 +38,8 @@ public:
     void initialise(const GuiPluginContext& context) override;
 
 private:
+    void writeTracks(const TrackList& tracks);
+
     ActionManager* m_actionManager;
     MusicLibrary* m_library;
     TrackSelectionController* m_trackSelection;
@@ -0,0 +1,89 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <QFile>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace Fooyin::WaveBar {
+/*!
+ * A waveform read straight from a file mapped into memory by WaveformStore.
+ * Each channel is three int16 arrays (max, min, rms) of sampleCount() samples, scaled to the int16 range.
+ * @note the arrays are only valid for the lifetime of the mapping.
+ */
+class MappedWaveform
+{
+public:
+    MappedWaveform(std::unique_ptr<QFile> file, const int16_t* samples, int channels, int sampleCount)
+        : m_file{std::move(file)}
+        , m_samples{samples}
+        , m_channels{channels}
+        , m_sampleCount{sampleCount}
+    { }
+
+    [[nodiscard]] int channels() const
+    {
+        return m_channels;
+    }
+
+    [[nodiscard]] int sampleCount() const
+    {
+        return m_sampleCount;
+    }
+
+    [[nodiscard]] std::span<const int16_t> max(int channel) const
+    {
+        return array(channel, 0);
+    }
+
+    [[nodiscard]] std::span<const int16_t> min(int channel) const
+    {
+        return array(channel, 1);
+    }
+
+    [[nodiscard]] std::span<const int16_t> rms(int channel) const
+    {
+        return array(channel, 2);
+    }
+
+private:
+    [[nodiscard]] std::span<const int16_t> array(int channel, int index) const
+    {
+        if(channel < 0 || channel >= m_channels) {
+            return {};
+        }
+
+        const auto count = static_cast<size_t>(m_sampleCount);
+        return {m_samples + ((static_cast<size_t>(channel) * 3 + static_cast<size_t>(index)) * count), count};
+    }
+
+    // Owns the mapping, which is released when the file is destroyed
+    std::unique_ptr<QFile> m_file;
+    const int16_t* m_samples;
+    int m_channels;
+    int m_sampleCount;
+};
+using MappedWaveformPtr = std::shared_ptr<const MappedWaveform>;
+} // namespace Fooyin::WaveBar
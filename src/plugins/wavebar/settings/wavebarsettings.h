@@ -29,17 +29,19 @@ Q_NAMESPACE
 
 enum WaveBarSettings : uint32_t
 {
-    Downmix       = 1 | Type::Int,
-    ShowCursor    = 2 | Type::Bool,
-    CursorWidth   = 3 | Type::Int,
-    ColourOptions = 4 | Type::Variant,
-    Mode          = 5 | Type::Int,
-    BarWidth      = 6 | Type::Int,
-    BarGap        = 7 | Type::Int,
-    MaxScale      = 8 | Type::Double,
-    CentreGap     = 9 | Type::Int,
-    ChannelScale  = 10 | Type::Double,
-    NumSamples    = 11 | Type::Int,
+    Downmix          = 1 | Type::Int,
+    ShowCursor       = 2 | Type::Bool,
+    CursorWidth      = 3 | Type::Int,
+    ColourOptions    = 4 | Type::Variant,
+    Mode             = 5 | Type::Int,
+    BarWidth         = 6 | Type::Int,
+    BarGap           = 7 | Type::Int,
+    MaxScale         = 8 | Type::Double,
+    CentreGap        = 9 | Type::Int,
+    ChannelScale     = 10 | Type::Double,
+    NumSamples       = 11 | Type::Int,
+    CacheCompression = 12 | Type::Int,
+    PregenerateAll   = 13 | Type::Bool,
 };
 Q_ENUM_NS(WaveBarSettings)
 } // namespace Settings::WaveBar
@@ -62,6 +64,17 @@ enum class DownmixOption
     Mono,
 };
 
+// How waveforms are compressed in the cache. Compressed samples are always delta encoded first.
+enum class CacheCodec : uint8_t
+{
+    // Flat files which are mapped and drawn from directly
+    Uncompressed = 0,
+    // zlib at its fastest level
+    Fast,
+    // zlib at its best level, which takes several times longer than Fast for a few percent
+    Small,
+};
+
 class WaveBarSettings
 {
 public:
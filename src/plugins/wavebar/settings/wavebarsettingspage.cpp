@@ -74,6 +74,8 @@ private:
 
     QLabel* m_cacheSizeLabel;
     QComboBox* m_numSamples;
+    QComboBox* m_cacheCodec;
+    QCheckBox* m_pregenerate;
 };
 
 WaveBarSettingsPageWidget::WaveBarSettingsPageWidget(SettingsManager* settings)
@@ -93,6 +95,8 @@ WaveBarSettingsPageWidget::WaveBarSettingsPageWidget(SettingsManager* settings)
     , m_centreGap{new QSpinBox(this)}
     , m_cacheSizeLabel{new QLabel(this)}
     , m_numSamples{new QComboBox(this)}
+    , m_cacheCodec{new QComboBox(this)}
+    , m_pregenerate{new QCheckBox(tr("Generate waveforms for the whole library in the background"), this)}
 {
     auto* layout = new QGridLayout(this);
 
@@ -205,10 +209,30 @@ WaveBarSettingsPageWidget::WaveBarSettingsPageWidget(SettingsManager* settings)
     numSamplesLabel->setToolTip(numSamplesTip);
     m_numSamples->setToolTip(numSamplesTip);
 
+    auto* cacheCodecLabel = new QLabel(tr("Cache compression") + QStringLiteral(":"), this);
+    const QString cacheCodecTip{tr("How waveform data is compressed in the cache.\n"
+                                   "None uses the most disk space, but waveforms are\n"
+                                   "shown straight from disk without being decoded.\n"
+                                   "Smaller saves a little disk space, but takes\n"
+                                   "noticeably longer when generating many waveforms.")};
+
+    m_cacheCodec->addItem(tr("None"), static_cast<int>(CacheCodec::Uncompressed));
+    m_cacheCodec->addItem(tr("Fast"), static_cast<int>(CacheCodec::Fast));
+    m_cacheCodec->addItem(tr("Smaller"), static_cast<int>(CacheCodec::Small));
+
+    cacheCodecLabel->setToolTip(cacheCodecTip);
+    m_cacheCodec->setToolTip(cacheCodecTip);
+
+    m_pregenerate->setToolTip(tr("Tracks without cached waveform data are processed at idle priority,\n"
+                                 "pausing while running on battery power."));
+
     generalGroupLayout->addWidget(numSamplesLabel, 0, 0);
     generalGroupLayout->addWidget(m_numSamples, 0, 1);
-    generalGroupLayout->addWidget(m_cacheSizeLabel, 1, 0);
-    generalGroupLayout->addWidget(clearCacheButton, 1, 1);
+    generalGroupLayout->addWidget(cacheCodecLabel, 1, 0);
+    generalGroupLayout->addWidget(m_cacheCodec, 1, 1);
+    generalGroupLayout->addWidget(m_cacheSizeLabel, 2, 0);
+    generalGroupLayout->addWidget(clearCacheButton, 2, 1);
+    generalGroupLayout->addWidget(m_pregenerate, 3, 0, 1, 3);
     generalGroupLayout->setColumnStretch(2, 1);
 
     row = 0;
@@ -250,6 +274,8 @@ void WaveBarSettingsPageWidget::load()
     updateCacheSize();
     const int samples = m_settings->value<Settings::WaveBar::NumSamples>();
     m_numSamples->setCurrentIndex(samples == 2048 ? 0 : 1);
+    m_cacheCodec->setCurrentIndex(m_cacheCodec->findData(m_settings->value<Settings::WaveBar::CacheCompression>()));
+    m_pregenerate->setChecked(m_settings->value<Settings::WaveBar::PregenerateAll>());
 }
 
 void WaveBarSettingsPageWidget::apply()
@@ -286,6 +312,9 @@ void WaveBarSettingsPageWidget::apply()
     }
     m_settings->set<Settings::WaveBar::Mode>(static_cast<int>(mode));
 
+    m_settings->set<Settings::WaveBar::CacheCompression>(m_cacheCodec->currentData().toInt());
+    m_settings->set<Settings::WaveBar::PregenerateAll>(m_pregenerate->isChecked());
+
     if(m_settings->set<Settings::WaveBar::NumSamples>(m_numSamples->currentIndex() == 0 ? 2048 : 4096)) {
         emit clearCache();
         updateCacheSize();
@@ -304,6 +333,8 @@ void WaveBarSettingsPageWidget::reset()
     m_settings->reset<Settings::WaveBar::ChannelScale>();
     m_settings->reset<Settings::WaveBar::Mode>();
     m_settings->reset<Settings::WaveBar::NumSamples>();
+    m_settings->reset<Settings::WaveBar::CacheCompression>();
+    m_settings->reset<Settings::WaveBar::PregenerateAll>();
 }
 
 void WaveBarSettingsPageWidget::updateCacheSize()
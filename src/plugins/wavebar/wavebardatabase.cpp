@@ -23,6 +23,8 @@
 #include <utils/crypto.h>
 #include <utils/database/dbquery.h>
 
+#include <array>
+
 namespace {
 using Fooyin::WaveBar::WaveformData;
 
@@ -86,30 +88,150 @@ QDataStream& operator<<(QDataStream& stream, const std::vector<WaveformData<int1
     return stream;
 }
 
-QByteArray serialiseData(const WaveformData<int16_t>& data)
+// Prefixes blobs in the delta encoded format. Older blobs start with the length of their zlib stream,
+// which is never this large.
+constexpr std::array<char, 4> CacheMagic{'F', 'Y', 'W', '\x02'};
+constexpr int FastLevel  = 1;
+constexpr int SmallLevel = 9;
+
+void writeVarint(QByteArray& out, uint32_t value)
 {
-    QByteArray out;
-    QDataStream stream{&out, QDataStream::WriteOnly};
-    stream.setVersion(QDataStream::Qt_6_0);
+    while(value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
 
-    stream << data.channelData;
+bool readVarint(const char*& pos, const char* end, uint32_t& value)
+{
+    value = 0;
+    for(int shift{0}; shift < 35 && pos < end; shift += 7) {
+        const auto byte = static_cast<uint8_t>(*pos++);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    out = qCompress(out, 9);
+// Neighbouring samples are close, so their zigzagged differences mostly fit in a single byte
+void writeSamples(QByteArray& out, const std::vector<int16_t>& samples)
+{
+    writeVarint(out, static_cast<uint32_t>(samples.size()));
+
+    int32_t prev{0};
+    for(const int16_t sample : samples) {
+        const int32_t delta = sample - prev;
+        prev                = sample;
+        writeVarint(out, (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31));
+    }
+}
+
+bool readSamples(const char*& pos, const char* end, std::vector<int16_t>& samples)
+{
+    uint32_t count{0};
+    if(!readVarint(pos, end, count) || count > static_cast<uint32_t>(end - pos)) {
+        return false;
+    }
+
+    samples.clear();
+    samples.reserve(count);
+
+    int32_t prev{0};
+    for(uint32_t i{0}; i < count; ++i) {
+        uint32_t zigzag{0};
+        if(!readVarint(pos, end, zigzag)) {
+            return false;
+        }
+        const auto delta = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+        prev             = static_cast<int16_t>(prev + delta);
+        samples.push_back(static_cast<int16_t>(prev));
+    }
+
+    return true;
+}
+
+QByteArray serialiseData(const WaveformData<int16_t>& data, Fooyin::WaveBar::CacheCodec codec)
+{
+    using Fooyin::WaveBar::CacheCodec;
+
+    QByteArray encoded;
+    writeVarint(encoded, static_cast<uint32_t>(data.channelData.size()));
+    for(const auto& channel : data.channelData) {
+        writeSamples(encoded, channel.max);
+        writeSamples(encoded, channel.min);
+        writeSamples(encoded, channel.rms);
+    }
+
+    QByteArray out{CacheMagic.data(), static_cast<qsizetype>(CacheMagic.size())};
+    out.append(static_cast<char>(codec));
+
+    switch(codec) {
+        case(CacheCodec::Fast):
+            out.append(qCompress(encoded, FastLevel));
+            break;
+        case(CacheCodec::Small):
+            out.append(qCompress(encoded, SmallLevel));
+            break;
+        case(CacheCodec::Uncompressed):
+        default:
+            out.append(encoded);
+            break;
+    }
 
     return out;
 }
 
-void deserialiseData(const QByteArray& cacheData, WaveformData<int16_t>& data)
+bool deserialiseData(const QByteArray& cacheData, WaveformData<int16_t>& data)
 {
-    QByteArray in = qUncompress(cacheData);
-    QDataStream stream{&in, QDataStream::ReadOnly};
-    stream.setVersion(QDataStream::Qt_6_0);
+    using Fooyin::WaveBar::CacheCodec;
+
+    const auto magicSize = static_cast<qsizetype>(CacheMagic.size());
+    if(cacheData.size() <= magicSize || !std::equal(CacheMagic.cbegin(), CacheMagic.cend(), cacheData.cbegin())) {
+        // Written before delta encoding
+        QByteArray in = qUncompress(cacheData);
+        QDataStream stream{&in, QDataStream::ReadOnly};
+        stream.setVersion(QDataStream::Qt_6_0);
+
+        stream >> data.channelData;
+        return stream.status() == QDataStream::Ok;
+    }
+
+    const auto codec         = static_cast<CacheCodec>(cacheData.at(magicSize));
+    const QByteArray body    = cacheData.sliced(magicSize + 1);
+    const QByteArray encoded = codec == CacheCodec::Uncompressed ? body : qUncompress(body);
+
+    const char* pos = encoded.constData();
+    const char* end = pos + encoded.size();
+
+    uint32_t channels{0};
+    if(!readVarint(pos, end, channels) || channels > static_cast<uint32_t>(end - pos)) {
+        return false;
+    }
+
+    data.channelData.clear();
+    data.channelData.resize(channels);
+
+    for(auto& channel : data.channelData) {
+        if(!readSamples(pos, end, channel.max) || !readSamples(pos, end, channel.min)
+           || !readSamples(pos, end, channel.rms)) {
+            data.channelData.clear();
+            return false;
+        }
+    }
 
-    stream >> data.channelData;
+    return true;
 }
 } // namespace
 
 namespace Fooyin::WaveBar {
+void WaveBarDatabase::setCodec(CacheCodec codec)
+{
+    m_codec = codec;
+}
+
 void WaveBarDatabase::initialiseDatabase() const
 {
     const auto statement = QStringLiteral("CREATE TABLE IF NOT EXISTS WaveCache ("
@@ -122,6 +244,10 @@ void WaveBarDatabase::initialiseDatabase() const
 
 bool WaveBarDatabase::existsInCache(const QString& key) const
 {
+    if(m_store.contains(key)) {
+        return true;
+    }
+
     const auto statement = QStringLiteral("SELECT COUNT(*) FROM WaveCache WHERE TrackKey = :trackKey;");
 
     DbQuery query{db(), statement};
@@ -135,6 +261,11 @@ bool WaveBarDatabase::existsInCache(const QString& key) const
     return false;
 }
 
+MappedWaveformPtr WaveBarDatabase::mapCachedData(const QString& key) const
+{
+    return m_store.map(key);
+}
+
 bool WaveBarDatabase::loadCachedData(const QString& key, WaveformData<int16_t>& data) const
 {
     const auto statement = QStringLiteral("SELECT Data FROM WaveCache WHERE TrackKey = :trackKey;");
@@ -145,8 +276,7 @@ bool WaveBarDatabase::loadCachedData(const QString& key, WaveformData<int16_t>&
 
     if(query.exec() && query.next()) {
         const QByteArray cacheData = query.value(0).toByteArray();
-        deserialiseData(cacheData, data);
-        return true;
+        return deserialiseData(cacheData, data);
     }
 
     return false;
@@ -154,35 +284,44 @@ bool WaveBarDatabase::loadCachedData(const QString& key, WaveformData<int16_t>&
 
 bool WaveBarDatabase::storeInCache(const QString& key, const WaveformData<int16_t>& data) const
 {
+    // Only one copy is kept, so a waveform stored with a different codec before isn't loaded instead
+    if(m_codec == CacheCodec::Uncompressed) {
+        return m_store.write(key, data) && removeBlob(key);
+    }
+
+    if(!m_store.remove(key)) {
+        return false;
+    }
+
     const auto statement
         = QStringLiteral("INSERT OR REPLACE INTO WaveCache (TrackKey, Data) VALUES (:trackKey, :data);");
 
     DbQuery query{db(), statement};
 
     query.bindValue(QStringLiteral(":trackKey"), key);
-    query.bindValue(QStringLiteral(":data"), serialiseData(data));
+    query.bindValue(QStringLiteral(":data"), serialiseData(data, m_codec));
 
     return query.exec();
 }
 
 bool WaveBarDatabase::removeFromCache(const QString& key) const
 {
-    const auto statement = QStringLiteral("DELETE FROM WaveCache WHERE TrackKey = :trackKey;");
-
-    DbQuery query{db(), statement};
-    query.bindValue(QStringLiteral(":trackKey"), key);
-
-    return query.exec();
+    return m_store.remove(key) && removeBlob(key);
 }
 
 bool WaveBarDatabase::removeFromCache(const QStringList& keys) const
 {
+    bool success{true};
+    for(const QString& key : keys) {
+        success &= m_store.remove(key);
+    }
+
     const QString statement = QStringLiteral("DELETE FROM WaveCache WHERE TrackKey IN (:keys);");
 
     DbQuery query{db(), statement};
     query.bindValue(QStringLiteral(":keys"), keys);
 
-    return query.exec();
+    return query.exec() && success;
 }
 
 bool WaveBarDatabase::clearCache() const
@@ -192,7 +331,7 @@ bool WaveBarDatabase::clearCache() const
     DbQuery query{db(), statement};
     DbQuery cleanQuery{db(), QStringLiteral("VACUUM")};
 
-    return query.exec() && cleanQuery.exec();
+    return m_store.clear() && query.exec() && cleanQuery.exec();
 }
 
 QString WaveBarDatabase::cacheKey(const Track& track)
@@ -202,7 +341,17 @@ QString WaveBarDatabase::cacheKey(const Track& track)
 
 QString WaveBarDatabase::cacheKey(const Track& track, int channels)
 {
-    return Utils::generateHash(track.hash(), QString::number(track.duration()), QString::number(track.sampleRate()),
-                               QString::number(channels));
+    return Utils::generateHash(QString::number(track.hash(), 16), QString::number(track.duration()),
+                               QString::number(track.sampleRate()), QString::number(channels));
+}
+
+bool WaveBarDatabase::removeBlob(const QString& key) const
+{
+    const auto statement = QStringLiteral("DELETE FROM WaveCache WHERE TrackKey = :trackKey;");
+
+    DbQuery query{db(), statement};
+    query.bindValue(QStringLiteral(":trackKey"), key);
+
+    return query.exec();
 }
 } // namespace Fooyin::WaveBar
@@ -19,7 +19,9 @@
 
 #pragma once
 
+#include "settings/wavebarsettings.h"
 #include "waveformdata.h"
+#include "waveformstore.h"
 
 #include <utils/database/dbmodule.h>
 
@@ -27,12 +29,21 @@ namespace Fooyin {
 class Track;
 
 namespace WaveBar {
+/*!
+ * The waveform cache. Uncompressed waveforms are kept as files in a WaveformStore, so they can be mapped
+ * rather than decoded; compressed ones are kept as blobs in the database.
+ */
 class WaveBarDatabase : public DbModule
 {
 public:
+    /** Sets the codec used for waveforms stored from now on. Waveforms written with any codec can be loaded. */
+    void setCodec(CacheCodec codec);
+
     void initialiseDatabase() const;
 
     [[nodiscard]] bool existsInCache(const QString& key) const;
+    /** Returns the waveform for @p key if it's held uncompressed, without reading it into memory. */
+    [[nodiscard]] MappedWaveformPtr mapCachedData(const QString& key) const;
     [[nodiscard]] bool loadCachedData(const QString& key, WaveformData<int16_t>& data) const;
     [[nodiscard]] bool storeInCache(const QString& key, const WaveformData<int16_t>& data) const;
     [[nodiscard]] bool removeFromCache(const QString& key) const;
@@ -41,6 +52,12 @@ public:
 
     static QString cacheKey(const Track& track);
     static QString cacheKey(const Track& track, int channels);
+
+private:
+    [[nodiscard]] bool removeBlob(const QString& key) const;
+
+    CacheCodec m_codec{CacheCodec::Uncompressed};
+    WaveformStore m_store;
 };
 } // namespace WaveBar
 } // namespace Fooyin
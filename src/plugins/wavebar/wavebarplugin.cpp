@@ -25,15 +25,18 @@
 #include "wavebarconstants.h"
 #include "wavebarwidget.h"
 #include "waveformbuilder.h"
+#include "waveformpregenerator.h"
 
 #include <core/engine/enginecontroller.h>
+#include <core/library/musiclibrary.h>
 #include <core/player/playercontroller.h>
+#include <core/playlist/playlisthandler.h>
 #include <gui/guiconstants.h>
 #include <gui/trackselectioncontroller.h>
 #include <gui/widgetprovider.h>
 #include <utils/actions/actioncontainer.h>
 #include <utils/actions/actionmanager.h>
-#include <utils/async.h>
+#include <utils/database/dbexecutor.h>
 #include <utils/paths.h>
 
 #include <QMenu>
@@ -58,13 +61,17 @@ struct WaveBarPlugin::Private
 
     ActionManager* actionManager;
     PlayerController* playerController;
+    PlaylistHandler* playlistHandler;
     EngineController* engine;
+    MusicLibrary* library;
     TrackSelectionController* trackSelection;
     WidgetProvider* widgetProvider;
     SettingsManager* settings;
 
     DbConnectionPoolPtr dbPool;
+    DbExecutor dbExecutor;
     std::unique_ptr<WaveformBuilder> waveBuilder;
+    std::unique_ptr<WaveformPregenerator> pregenerator;
 
     std::unique_ptr<WaveBarSettings> waveBarSettings;
     std::unique_ptr<WaveBarSettingsPage> waveBarSettingsPage;
@@ -73,6 +80,7 @@ struct WaveBarPlugin::Private
     explicit Private(WaveBarPlugin* self_)
         : self{self_}
         , dbPool{DbConnectionPool::create(dbConnectionParams(), QStringLiteral("wavebar"))}
+        , dbExecutor{dbPool, 1}
     { }
 
     FyWidget* createWavebar()
@@ -131,6 +139,35 @@ struct WaveBarPlugin::Private
         }
     }
 
+    void updatePregeneration(bool enabled)
+    {
+        if(!enabled) {
+            pregenerator.reset();
+            return;
+        }
+
+        if(!pregenerator) {
+            pregenerator = std::make_unique<WaveformPregenerator>([this]() { return engine->createDecoder(); },
+                                                                  dbPool, settings);
+        }
+        pregenerator->queue(library->tracks());
+    }
+
+    void primeTrack(const Track& track) const
+    {
+        // Only worth it if a seekbar is shown to pick the waveform up
+        if(waveBuilder) {
+            waveBuilder->prime(track);
+        }
+    }
+
+    void pregenerateTracks(const TrackList& tracks) const
+    {
+        if(pregenerator) {
+            pregenerator->queue(tracks);
+        }
+    }
+
     void removeSelection()
     {
         auto selectedTracks = trackSelection->selectedTracks();
@@ -138,15 +175,14 @@ struct WaveBarPlugin::Private
             return;
         }
 
-        Utils::asyncExec([this, selectedTracks]() {
+        dbExecutor.run(DbExecutor::Priority::Background, [selectedTracks](const DbConnectionProvider& provider) {
             QStringList keys;
             for(const Track& track : selectedTracks) {
                 keys.emplace_back(WaveBarDatabase::cacheKey(track));
             }
 
-            const DbConnectionHandler dbHandler{dbPool};
             WaveBarDatabase waveDb;
-            waveDb.initialise(DbConnectionProvider{dbPool});
+            waveDb.initialise(provider);
             waveDb.initialiseDatabase();
 
             if(!waveDb.removeFromCache(keys)) {
@@ -155,15 +191,16 @@ struct WaveBarPlugin::Private
         });
     }
 
-    void clearCache() const
+    void clearCache()
     {
-        const DbConnectionHandler handler{dbPool};
-        WaveBarDatabase waveDb;
-        waveDb.initialise(DbConnectionProvider{dbPool});
+        dbExecutor.run(DbExecutor::Priority::Interactive, [](const DbConnectionProvider& provider) {
+            WaveBarDatabase waveDb;
+            waveDb.initialise(provider);
 
-        if(!waveDb.clearCache()) {
-            qDebug() << "[WaveBar] Unable to clear cache";
-        }
+            if(!waveDb.clearCache()) {
+                qDebug() << "[WaveBar] Unable to clear cache";
+            }
+        });
     }
 };
 
@@ -173,6 +210,8 @@ WaveBarPlugin::WaveBarPlugin()
 
 WaveBarPlugin::~WaveBarPlugin()
 {
+    p->pregenerator.reset();
+
     if(p->waveBuilder) {
         p->waveBuilder.reset();
     }
@@ -181,7 +220,9 @@ WaveBarPlugin::~WaveBarPlugin()
 void WaveBarPlugin::initialise(const CorePluginContext& context)
 {
     p->playerController = context.playerController;
+    p->playlistHandler  = context.playlistHandler;
     p->engine           = context.engine;
+    p->library          = context.library;
     p->settings         = context.settingsManager;
 }
 
@@ -195,6 +236,18 @@ void WaveBarPlugin::initialise(const GuiPluginContext& context)
     p->waveBarSettingsPage    = std::make_unique<WaveBarSettingsPage>(p->settings);
     p->waveBarGuiSettingsPage = std::make_unique<WaveBarGuiSettingsPage>(p->settings);
 
+    p->settings->subscribe<Settings::WaveBar::PregenerateAll>(
+        this, [this](const bool enabled) { p->updatePregeneration(enabled); });
+    QObject::connect(p->library, &MusicLibrary::tracksLoaded, this,
+                     [this](const TrackList& tracks) { p->pregenerateTracks(tracks); });
+    QObject::connect(p->library, &MusicLibrary::tracksAdded, this,
+                     [this](const TrackList& tracks) { p->pregenerateTracks(tracks); });
+    QObject::connect(p->library, &MusicLibrary::tracksUpdated, this,
+                     [this](const TrackList& tracks) { p->pregenerateTracks(tracks); });
+    p->updatePregeneration(p->settings->value<Settings::WaveBar::PregenerateAll>());
+    QObject::connect(p->playlistHandler, &PlaylistHandler::upcomingTrack, this,
+                     [this](const Track& track) { p->primeTrack(track); });
+
     QObject::connect(p->waveBarSettingsPage.get(), &WaveBarSettingsPage::clearCache, this,
                      [this]() { p->clearCache(); });
 
@@ -35,7 +35,8 @@
 #include <QVBoxLayout>
 
 // TODO: Make setting
-constexpr auto SeekDelta = 5000;
+constexpr auto SeekDelta        = 5000;
+constexpr auto PositionInterval = 50;
 
 namespace Fooyin::WaveBar {
 WaveBarWidget::WaveBarWidget(WaveformBuilder* builder, PlayerController* playerController, SettingsManager* settings,
@@ -119,9 +120,17 @@ void WaveBarWidget::showEvent(QShowEvent* event)
 {
     FyWidget::showEvent(event);
 
+    m_playerController->requestPositionUpdates(this, PositionInterval);
     rescaleWaveform();
 }
 
+void WaveBarWidget::hideEvent(QHideEvent* event)
+{
+    FyWidget::hideEvent(event);
+
+    m_playerController->releasePositionUpdates(this);
+}
+
 void WaveBarWidget::resizeEvent(QResizeEvent* event)
 {
     FyWidget::resizeEvent(event);
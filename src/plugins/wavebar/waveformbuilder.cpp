@@ -37,14 +37,14 @@ WaveformBuilder::WaveformBuilder(std::unique_ptr<AudioDecoder> decoder, DbConnec
 {
     updateRescaler();
 
-    m_generator.moveToThread(&m_generatorThread);
-    m_rescaler.moveToThread(&m_rescalerThread);
+    m_generator.setLane(TaskScheduler::Lane::Idle);
+    m_rescaler.setLane(TaskScheduler::Lane::Interactive);
 
     QObject::connect(&m_generator, &WaveformGenerator::generatingWaveform, this, &WaveformBuilder::generatingWaveform);
     QObject::connect(&m_generator, &WaveformGenerator::waveformGenerated, this, &WaveformBuilder::waveformGenerated);
-    QObject::connect(&m_generator, &WaveformGenerator::waveformGenerated, &m_rescaler, [this](const auto& data) {
+    QObject::connect(&m_generator, &WaveformGenerator::waveformGenerated, this, [this](const auto& data) {
         if(m_rescale) {
-            m_rescaler.rescale(data, m_width);
+            m_rescaler.schedule([this, data, width = m_width]() { m_rescaler.rescale(data, width); });
         }
     });
     QObject::connect(&m_rescaler, &WaveformRescaler::waveformRescaled, this, &WaveformBuilder::waveformRescaled);
@@ -53,11 +53,9 @@ WaveformBuilder::WaveformBuilder(std::unique_ptr<AudioDecoder> decoder, DbConnec
     m_settings->subscribe<Settings::WaveBar::BarGap>(this, &WaveformBuilder::updateRescaler);
     m_settings->subscribe<Settings::WaveBar::Downmix>(this, &WaveformBuilder::updateRescaler);
     m_settings->subscribe<Settings::WaveBar::NumSamples>(this, [this](const int num) { m_samplesPerChannel = num; });
+    m_settings->subscribe<Settings::WaveBar::CacheCompression>(this, &WaveformBuilder::updateCacheCodec);
 
-    m_generatorThread.start();
-    m_rescalerThread.start();
-
-    QMetaObject::invokeMethod(&m_generator, &Worker::initialiseThread);
+    updateCacheCodec();
 }
 
 WaveformBuilder::~WaveformBuilder()
@@ -65,19 +63,17 @@ WaveformBuilder::~WaveformBuilder()
     m_generator.closeThread();
     m_rescaler.closeThread();
 
-    m_generatorThread.quit();
-    m_generatorThread.wait();
-
-    m_rescalerThread.quit();
-    m_rescalerThread.wait();
+    m_generator.waitForTasks();
+    m_rescaler.waitForTasks();
 }
 
 void WaveformBuilder::generate(const Track& track, bool update)
 {
     m_rescale = false;
 
-    QMetaObject::invokeMethod(&m_generator,
-                              [this, track, update]() { m_generator.generate(track, m_samplesPerChannel, update); });
+    m_generator.scheduleWithDatabase([this, track, update, samples = m_samplesPerChannel]() {
+        m_generator.generate(track, samples, update);
+    });
 }
 
 void WaveformBuilder::generateAndScale(const Track& track, bool update)
@@ -86,24 +82,40 @@ void WaveformBuilder::generateAndScale(const Track& track, bool update)
     m_rescaler.stopThread();
     m_rescale = true;
 
-    QMetaObject::invokeMethod(
-        &m_generator, [this, track, update]() { m_generator.generateAndRender(track, m_samplesPerChannel, update); });
+    m_generator.scheduleWithDatabase([this, track, update, samples = m_samplesPerChannel]() {
+        m_generator.generateAndRender(track, samples, update);
+    });
+}
+
+void WaveformBuilder::prime(const Track& track)
+{
+    m_generator.scheduleWithDatabase([this, track]() { m_generator.prime(track); });
 }
 
 void WaveformBuilder::rescale(const int width)
 {
     if(std::exchange(m_width, width) != width) {
-        QMetaObject::invokeMethod(&m_rescaler, [this]() { m_rescaler.rescale(m_width); });
+        m_rescaler.schedule([this, width]() { m_rescaler.rescale(width); });
     }
 }
 
+void WaveformBuilder::updateCacheCodec()
+{
+    const auto codec = static_cast<CacheCodec>(m_settings->value<Settings::WaveBar::CacheCompression>());
+    m_generator.scheduleWithDatabase([this, codec]() { m_generator.setCacheCodec(codec); });
+}
+
 void WaveformBuilder::updateRescaler()
 {
     m_rescaler.stopThread();
-    QMetaObject::invokeMethod(&m_rescaler, [this]() {
-        m_rescaler.changeSampleWidth(m_settings->value<Settings::WaveBar::BarWidth>()
-                                     + m_settings->value<Settings::WaveBar::BarGap>());
-        m_rescaler.changeDownmix(static_cast<DownmixOption>(m_settings->value<Settings::WaveBar::Downmix>()));
+
+    const int sampleWidth = m_settings->value<Settings::WaveBar::BarWidth>()
+                          + m_settings->value<Settings::WaveBar::BarGap>();
+    const auto downmix    = static_cast<DownmixOption>(m_settings->value<Settings::WaveBar::Downmix>());
+
+    m_rescaler.schedule([this, sampleWidth, downmix]() {
+        m_rescaler.changeSampleWidth(sampleWidth);
+        m_rescaler.changeDownmix(downmix);
     });
 }
 } // namespace Fooyin::WaveBar
@@ -28,7 +28,6 @@
 #include <core/track.h>
 
 #include <QObject>
-#include <QThread>
 
 namespace Fooyin {
 class AudioBuffer;
@@ -46,6 +45,8 @@ public:
 
     void generate(const Track& track, bool update = false);
     void generateAndScale(const Track& track, bool update = false);
+    /** Loads the cached waveform of @p track in the background, ready for a later @fn generateAndScale. */
+    void prime(const Track& track);
     void rescale(int width);
 
 signals:
@@ -54,13 +55,11 @@ signals:
     void waveformRescaled(const WaveformData<float>& data);
 
 private:
+    void updateCacheCodec();
     void updateRescaler();
 
     SettingsManager* m_settings;
 
-    QThread m_generatorThread;
-    QThread m_rescalerThread;
-
     WaveformGenerator m_generator;
     WaveformRescaler m_rescaler;
 
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include "mappedwaveform.h"
+
 #include <core/engine/audioformat.h>
 
 #include <tuple>
@@ -58,12 +60,14 @@ struct WaveformData
         }
     };
     std::vector<ChannelData> channelData;
+    // Set instead of channelData when read from WaveformStore, so samples are used from the file as they are
+    MappedWaveformPtr mapped;
 
     bool operator==(const WaveformData<T>& other) const noexcept
     {
-        return std::tie(format, duration, channels, complete, samplesPerChannel, channelData)
+        return std::tie(format, duration, channels, complete, samplesPerChannel, channelData, mapped)
             == std::tie(other.format, other.duration, other.channels, other.complete, other.samplesPerChannel,
-                        other.channelData);
+                        other.channelData, other.mapped);
     }
 
     bool operator!=(const WaveformData<T>& other) const noexcept
@@ -73,11 +77,14 @@ struct WaveformData
 
     [[nodiscard]] bool empty() const
     {
-        return !format.isValid() && channelData.empty();
+        return !format.isValid() && channelData.empty() && !mapped;
     }
 
     [[nodiscard]] int sampleCount() const
     {
+        if(mapped) {
+            return mapped->sampleCount();
+        }
         if(channelData.empty()) {
             return 0;
         }
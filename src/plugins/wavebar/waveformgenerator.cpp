@@ -24,10 +24,15 @@
 #include <utils/paths.h>
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include <cfenv>
+#include <cstring>
 #include <utility>
 
+// Milliseconds between partial waveforms while rendering
+constexpr auto ProgressInterval = 100;
+
 namespace {
 float convertSampleToFloat(const int16_t inSample)
 {
@@ -100,10 +105,25 @@ WaveformGenerator::WaveformGenerator(std::unique_ptr<AudioDecoder> decoder, DbCo
     : Worker{parent}
     , m_decoder{std::move(decoder)}
     , m_dbPool{std::move(dbPool)}
+    , m_databaseReady{false}
 {
     m_requiredFormat.setSampleFormat(SampleFormat::Float);
 }
 
+void WaveformGenerator::scheduleWithDatabase(std::function<void()> task)
+{
+    schedule([this, task = std::move(task)]() {
+        const DbConnectionHandler handler{m_dbPool};
+
+        if(!std::exchange(m_databaseReady, true)) {
+            m_waveDb.initialise(DbConnectionProvider{m_dbPool});
+            m_waveDb.initialiseDatabase();
+        }
+
+        task();
+    });
+}
+
 void WaveformGenerator::initialiseThread()
 {
     Worker::initialiseThread();
@@ -111,6 +131,12 @@ void WaveformGenerator::initialiseThread()
     m_dbHandler = std::make_unique<DbConnectionHandler>(m_dbPool);
     m_waveDb.initialise(DbConnectionProvider{m_dbPool});
     m_waveDb.initialiseDatabase();
+    m_databaseReady = true;
+}
+
+void WaveformGenerator::setCacheCodec(CacheCodec codec)
+{
+    m_waveDb.setCodec(codec);
 }
 
 void WaveformGenerator::generate(const Track& track, int samplesPerChannel, bool update)
@@ -119,8 +145,17 @@ void WaveformGenerator::generate(const Track& track, int samplesPerChannel, bool
         return;
     }
 
+    // Skip cached tracks before opening them, so batch runs over mostly generated libraries stay cheap
+    if(!update && track.isValid() && track.channels() > 0
+       && m_waveDb.existsInCache(WaveBarDatabase::cacheKey(track))) {
+        emit waveformGenerated({});
+        return;
+    }
+
     const QString trackKey = setup(track, samplesPerChannel);
     if(trackKey.isEmpty()) {
+        // Still report the track as done so batch callers can move on
+        emit waveformGenerated({});
         return;
     }
 
@@ -134,31 +169,10 @@ void WaveformGenerator::generate(const Track& track, int samplesPerChannel, bool
 
     emit generatingWaveform();
 
-    const uint64_t durationSecs = m_data.duration / 1000;
-    const int samples           = static_cast<int>(std::floor(durationSecs * m_format.sampleRate()));
-    const int samplesPerBuffer  = static_cast<int>(std::ceil(static_cast<double>(samples) / samplesPerChannel));
-    const int bufferSize        = samplesPerBuffer * m_format.bytesPerFrame();
-
-    m_decoder->start();
-
-    while(true) {
-        if(!mayRun()) {
-            m_decoder->stop();
-            return;
-        }
-
-        auto buffer = m_decoder->readBuffer(static_cast<size_t>(bufferSize));
-        if(!buffer.isValid()) {
-            m_data.complete = true;
-            break;
-        }
-
-        buffer = Audio::convert(buffer, m_requiredFormat);
-        processBuffer(buffer);
+    if(!decode(false)) {
+        return;
     }
 
-    m_decoder->stop();
-
     if(!m_waveDb.storeInCache(trackKey, convertCache<int16_t>(m_data))) {
         qWarning() << "[WaveBar] Unable to store waveform for track:" << m_track.filepath();
     }
@@ -176,6 +190,17 @@ void WaveformGenerator::generateAndRender(const Track& track, int samplesPerChan
         return;
     }
 
+    if(!update && !m_primedKey.isEmpty() && m_primedKey == WaveBarDatabase::cacheKey(track)) {
+        m_decoder->stop();
+        m_track                  = track;
+        m_data                   = std::exchange(m_primed, {});
+        m_data.samplesPerChannel = samplesPerChannel;
+        m_primedKey.clear();
+
+        emit waveformGenerated(m_data);
+        return;
+    }
+
     const QString trackKey = setup(track, samplesPerChannel);
     if(trackKey.isEmpty()) {
         return;
@@ -183,6 +208,19 @@ void WaveformGenerator::generateAndRender(const Track& track, int samplesPerChan
 
     setState(Running);
 
+    if(!update) {
+        if(auto mapped = m_waveDb.mapCachedData(trackKey)) {
+            m_data.channelData.clear();
+            m_data.mapped   = std::move(mapped);
+            m_data.complete = true;
+
+            setState(Idle);
+            emit waveformGenerated(m_data);
+
+            return;
+        }
+    }
+
     if(!update && m_waveDb.existsInCache(trackKey)) {
         WaveformData<int16_t> data;
         if(m_waveDb.loadCachedData(trackKey, data)) {
@@ -199,40 +237,10 @@ void WaveformGenerator::generateAndRender(const Track& track, int samplesPerChan
 
     emit generatingWaveform();
 
-    const uint64_t durationSecs = m_data.duration / 1000;
-    const int samples           = static_cast<int>(std::floor(durationSecs * m_format.sampleRate()));
-    const int samplesPerBuffer  = static_cast<int>(std::ceil(static_cast<double>(samples) / samplesPerChannel));
-    const int bufferSize        = samplesPerBuffer * m_format.bytesPerFrame();
-    const int numOfUpdates      = std::max<int>(1, std::floor(static_cast<double>(durationSecs) / 30));
-    const int updateThreshold   = samplesPerChannel / numOfUpdates;
-
-    int processedCount{0};
-
-    m_decoder->start();
-
-    while(true) {
-        if(!mayRun()) {
-            m_decoder->stop();
-            return;
-        }
-
-        auto buffer = m_decoder->readBuffer(static_cast<size_t>(bufferSize));
-        if(!buffer.isValid()) {
-            m_data.complete = true;
-            break;
-        }
-
-        buffer = Audio::convert(buffer, m_requiredFormat);
-        processBuffer(buffer);
-
-        if(processedCount++ == updateThreshold) {
-            processedCount = 0;
-            emit waveformGenerated(m_data);
-        }
+    if(!decode(true)) {
+        return;
     }
 
-    m_decoder->stop();
-
     if(!m_waveDb.storeInCache(trackKey, convertCache<int16_t>(m_data))) {
         qWarning() << "[WaveBar] Unable to store waveform for track:" << m_track.filepath();
     }
@@ -244,6 +252,40 @@ void WaveformGenerator::generateAndRender(const Track& track, int samplesPerChan
     emit waveformGenerated(m_data);
 }
 
+void WaveformGenerator::prime(const Track& track)
+{
+    m_primedKey.clear();
+    m_primed = {};
+
+    // The channel count is only known up front from the track, as the decoder isn't opened here
+    if(closing() || !track.isValid() || track.channels() <= 0) {
+        return;
+    }
+
+    const QString trackKey = WaveBarDatabase::cacheKey(track);
+
+    if(auto mapped = m_waveDb.mapCachedData(trackKey)) {
+        m_primed.mapped = std::move(mapped);
+    }
+    else {
+        WaveformData<int16_t> data;
+        if(!m_waveDb.loadCachedData(trackKey, data)) {
+            return;
+        }
+        m_primed.channelData = convertCache<float>(data).channelData;
+    }
+
+    AudioFormat format{m_requiredFormat};
+    format.setChannelCount(track.channels());
+    format.setSampleRate(track.sampleRate());
+
+    m_primed.format      = format;
+    m_primed.duration    = track.duration();
+    m_primed.channels    = track.channels();
+    m_primed.complete    = true;
+    m_primedKey          = trackKey;
+}
+
 QString WaveformGenerator::setup(const Track& track, int samplesPerChannel)
 {
     m_decoder->stop();
@@ -271,29 +313,66 @@ QString WaveformGenerator::setup(const Track& track, int samplesPerChannel)
     return WaveBarDatabase::cacheKey(m_track, m_data.channels);
 }
 
-void WaveformGenerator::processBuffer(const AudioBuffer& buffer)
+bool WaveformGenerator::decode(bool progressive)
 {
-    const int bps         = buffer.format().bytesPerSample();
-    const int sampleCount = buffer.frameCount();
-    const auto* samples   = buffer.data();
+    const uint64_t durationSecs = m_data.duration / 1000;
+    const int samples           = static_cast<int>(std::floor(durationSecs * m_format.sampleRate()));
+    const int samplesPerBuffer
+        = static_cast<int>(std::ceil(static_cast<double>(samples) / m_data.samplesPerChannel));
+    const int bufferSize = samplesPerBuffer * m_format.bytesPerFrame();
 
-    for(int ch{0}; ch < m_data.channels; ++ch) {
+    QElapsedTimer sinceUpdate;
+    sinceUpdate.start();
+
+    // The track is read front to back without seeking, which the decoder's reader is tuned for
+    m_decoder->start();
+
+    while(true) {
         if(!mayRun()) {
-            return;
+            m_decoder->stop();
+            return false;
+        }
+
+        auto buffer = m_decoder->readBuffer(static_cast<size_t>(bufferSize));
+        if(!buffer.isValid()) {
+            m_data.complete = true;
+            break;
         }
 
+        buffer = Audio::convert(buffer, m_requiredFormat);
+        processBuffer(buffer);
+
+        // Emit on a timer rather than per buffer so long tracks show progress straight away
+        // without flooding the rescaler
+        if(progressive && sinceUpdate.elapsed() >= ProgressInterval) {
+            sinceUpdate.restart();
+            emit waveformGenerated(m_data);
+        }
+    }
+
+    m_decoder->stop();
+    return true;
+}
+
+void WaveformGenerator::processBuffer(const AudioBuffer& buffer)
+{
+    const int channels    = m_data.channels;
+    const int sampleCount = buffer.frameCount();
+    const auto data       = buffer.constData();
+
+    if(sampleCount <= 0 || data.size() < static_cast<size_t>(sampleCount) * channels * sizeof(float)) {
+        return;
+    }
+
+    for(int ch{0}; ch < channels; ++ch) {
         float max{-1.0};
         float min{1.0};
         float rms{0.0};
 
         for(int i{0}; i < sampleCount; ++i) {
-            if(!mayRun()) {
-                return;
-            }
-
-            const int offset = (i * m_data.channels + ch) * bps;
             float sample;
-            std::memcpy(&sample, samples + offset, bps);
+            std::memcpy(&sample, data.data() + (((static_cast<size_t>(i) * channels) + ch) * sizeof(float)),
+                        sizeof(float));
 
             max = std::max(max, sample);
             min = std::min(min, sample);
@@ -36,28 +36,50 @@ public:
     explicit WaveformGenerator(std::unique_ptr<AudioDecoder> decoder, DbConnectionPoolPtr dbPool,
                                QObject* parent = nullptr);
 
+    /*!
+     * Runs @p task through @fn schedule with a database connection for whichever thread it runs on.
+     * Used instead of @fn initialiseThread when the generator doesn't have a thread of its own.
+     */
+    void scheduleWithDatabase(std::function<void()> task);
+
 signals:
     void generatingWaveform();
     void waveformGenerated(const WaveformData<float>& data);
 
 public slots:
     void initialiseThread() override;
+    void setCacheCodec(CacheCodec codec);
     void generate(const Fooyin::Track& track, int samplesPerChannel, bool update = false);
     void generateAndRender(const Fooyin::Track& track, int samplesPerChannel, bool update = false);
+    /*!
+     * Loads the cached waveform of @p track ahead of time, so a following @fn generateAndRender
+     * for it is answered without opening the file or querying the database.
+     */
+    void prime(const Fooyin::Track& track);
 
 private:
     QString setup(const Track& track, int samplesPerChannel);
+    /*!
+     * Decodes the whole track into m_data, emitting waveformGenerated with the partial data as it goes
+     * if @p progressive is @c true.
+     * @returns @c false if interrupted.
+     */
+    bool decode(bool progressive);
     void processBuffer(const AudioBuffer& buffer);
 
     std::unique_ptr<AudioDecoder> m_decoder;
     DbConnectionPoolPtr m_dbPool;
     std::unique_ptr<DbConnectionHandler> m_dbHandler;
     WaveBarDatabase m_waveDb;
+    bool m_databaseReady;
 
     Track m_track;
     AudioFormat m_format;
     AudioFormat m_requiredFormat;
     int m_samplesPerChannel;
     WaveformData<float> m_data;
+
+    QString m_primedKey;
+    WaveformData<float> m_primed;
 };
 } // namespace Fooyin::WaveBar
@@ -0,0 +1,213 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "waveformpregenerator.h"
+
+#include "settings/wavebarsettings.h"
+
+#include <utils/settings/settingsmanager.h>
+
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+
+// Maximum number of tracks generated at once
+constexpr auto MaxJobs = 4;
+// Pause after decoding a track before a generator starts the next
+constexpr auto TrackInterval = 250;
+// How often to check whether external power has returned
+constexpr auto PowerCheckInterval = 60 * 1000;
+
+namespace {
+QString readSupplyValue(const QString& supply, const QString& name)
+{
+    QFile file{supply + u'/' + name};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return QString::fromLatin1(file.readAll()).trimmed();
+}
+
+bool onBatteryPower()
+{
+#if defined(Q_OS_LINUX)
+    const QDir supplies{QStringLiteral("/sys/class/power_supply")};
+    const QStringList entries = supplies.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+    bool hasBattery{false};
+    for(const QString& entry : entries) {
+        const QString supply = supplies.absoluteFilePath(entry);
+        const QString type   = readSupplyValue(supply, QStringLiteral("type"));
+
+        if(type == u"Battery") {
+            hasBattery = true;
+        }
+        else if(readSupplyValue(supply, QStringLiteral("online")) == u"1") {
+            return false;
+        }
+    }
+
+    // Desktops have no battery; laptops with no supply online are discharging
+    return hasBattery;
+#else
+    return false;
+#endif
+}
+} // namespace
+
+namespace Fooyin::WaveBar {
+WaveformPregenerator::WaveformPregenerator(DecoderCreator decoderCreator, DbConnectionPoolPtr dbPool,
+                                           SettingsManager* settings, QObject* parent)
+    : QObject{parent}
+    , m_decoderCreator{std::move(decoderCreator)}
+    , m_dbPool{std::move(dbPool)}
+    , m_settings{settings}
+{
+    m_powerTimer.setSingleShot(true);
+    m_powerTimer.setInterval(PowerCheckInterval);
+    QObject::connect(&m_powerTimer, &QTimer::timeout, this, qOverload<>(&WaveformPregenerator::dispatch));
+
+    m_settings->subscribe<Settings::WaveBar::CacheCompression>(this, &WaveformPregenerator::updateCacheCodec);
+}
+
+WaveformPregenerator::~WaveformPregenerator()
+{
+    for(const auto& job : m_jobs) {
+        job->generator->closeThread();
+        job->thread.quit();
+        job->thread.wait();
+    }
+}
+
+void WaveformPregenerator::queue(const TrackList& tracks)
+{
+    if(tracks.empty()) {
+        return;
+    }
+
+    m_queue.insert(m_queue.end(), tracks.cbegin(), tracks.cend());
+
+    if(m_jobs.empty()) {
+        createJobs();
+    }
+    dispatch();
+}
+
+void WaveformPregenerator::stop()
+{
+    m_queue.clear();
+    m_powerTimer.stop();
+
+    for(const auto& job : m_jobs) {
+        job->generator->stopThread();
+        job->busy = false;
+    }
+}
+
+int WaveformPregenerator::remaining() const
+{
+    return static_cast<int>(m_queue.size());
+}
+
+void WaveformPregenerator::createJobs()
+{
+    const int count  = std::clamp(QThread::idealThreadCount() / 2, 1, MaxJobs);
+    const auto codec = static_cast<CacheCodec>(m_settings->value<Settings::WaveBar::CacheCompression>());
+
+    for(int i{0}; i < count; ++i) {
+        auto& job      = m_jobs.emplace_back(std::make_unique<Job>());
+        job->generator = std::make_unique<WaveformGenerator>(m_decoderCreator(), m_dbPool);
+        job->generator->moveToThread(&job->thread);
+
+        QObject::connect(job->generator.get(), &WaveformGenerator::waveformGenerated, this,
+                         [this, job = job.get()](const WaveformData<float>& data) {
+                             trackFinished(job, !data.channelData.empty());
+                         });
+
+        job->thread.start(QThread::IdlePriority);
+
+        auto* generator = job->generator.get();
+        QMetaObject::invokeMethod(generator, &Worker::initialiseThread);
+        QMetaObject::invokeMethod(generator, [generator, codec]() { generator->setCacheCodec(codec); });
+    }
+}
+
+void WaveformPregenerator::dispatch()
+{
+    for(const auto& job : m_jobs) {
+        if(!job->busy) {
+            dispatch(job.get());
+        }
+    }
+}
+
+void WaveformPregenerator::dispatch(Job* job)
+{
+    if(job->busy) {
+        return;
+    }
+
+    if(m_queue.empty()) {
+        if(std::ranges::none_of(m_jobs, [](const auto& other) { return other->busy; })) {
+            emit finished();
+        }
+        return;
+    }
+
+    if(onBatteryPower()) {
+        if(!m_powerTimer.isActive()) {
+            m_powerTimer.start();
+        }
+        return;
+    }
+
+    const Track track = m_queue.front();
+    m_queue.pop_front();
+
+    job->busy = true;
+
+    const int samples = m_settings->value<Settings::WaveBar::NumSamples>();
+    auto* generator   = job->generator.get();
+    QMetaObject::invokeMethod(generator, [generator, track, samples]() { generator->generate(track, samples); });
+}
+
+void WaveformPregenerator::trackFinished(Job* job, bool decoded)
+{
+    job->busy = false;
+
+    if(decoded) {
+        QTimer::singleShot(TrackInterval, this, [this, job]() { dispatch(job); });
+    }
+    else {
+        dispatch(job);
+    }
+}
+
+void WaveformPregenerator::updateCacheCodec()
+{
+    const auto codec = static_cast<CacheCodec>(m_settings->value<Settings::WaveBar::CacheCompression>());
+
+    for(const auto& job : m_jobs) {
+        auto* generator = job->generator.get();
+        QMetaObject::invokeMethod(generator, [generator, codec]() { generator->setCacheCodec(codec); });
+    }
+}
+} // namespace Fooyin::WaveBar
@@ -0,0 +1,92 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "waveformgenerator.h"
+
+#include <core/engine/audiodecoder.h>
+#include <core/track.h>
+#include <utils/database/dbconnectionpool.h>
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+
+#include <deque>
+#include <functional>
+
+namespace Fooyin {
+class SettingsManager;
+
+namespace WaveBar {
+/*!
+ * Generates waveforms for a list of tracks in the background, e.g. the whole library.
+ *
+ * Work is spread across a few generators running at idle priority, each pausing briefly between tracks
+ * to leave disk bandwidth for playback. Tracks which are already cached are skipped without being decoded,
+ * so queueing the library again after a restart resumes where the last run stopped.
+ * Generation is paused while the system is running on battery power.
+ */
+class WaveformPregenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    using DecoderCreator = std::function<std::unique_ptr<AudioDecoder>()>;
+
+    WaveformPregenerator(DecoderCreator decoderCreator, DbConnectionPoolPtr dbPool, SettingsManager* settings,
+                         QObject* parent = nullptr);
+    ~WaveformPregenerator() override;
+
+    /** Appends @p tracks to the queue and starts generating if idle. */
+    void queue(const TrackList& tracks);
+    /** Clears the queue and interrupts any tracks being generated. */
+    void stop();
+
+    [[nodiscard]] int remaining() const;
+
+signals:
+    void finished();
+
+private:
+    struct Job
+    {
+        QThread thread;
+        std::unique_ptr<WaveformGenerator> generator;
+        bool busy{false};
+    };
+
+    void createJobs();
+    void dispatch();
+    void dispatch(Job* job);
+    void trackFinished(Job* job, bool decoded);
+    void updateCacheCodec();
+
+    DecoderCreator m_decoderCreator;
+    DbConnectionPoolPtr m_dbPool;
+    SettingsManager* m_settings;
+
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    std::deque<Track> m_queue;
+    QTimer m_powerTimer;
+};
+} // namespace WaveBar
+} // namespace Fooyin
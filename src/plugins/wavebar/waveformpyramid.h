@@ -0,0 +1,134 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace Fooyin::WaveBar {
+/*!
+ * Min/max/rms summaries of one channel of a waveform at power-of-two resolutions.
+ * Level 0 holds the original samples and each level above combines pairs of the one below, so the
+ * summary of any run of samples is assembled from at most two nodes per level.
+ */
+class WaveformPyramid
+{
+public:
+    struct Summary
+    {
+        float max{-1.0};
+        float min{1.0};
+        float sumSquares{0.0};
+        int count{0};
+
+        void merge(float sampleMax, float sampleMin, float sampleSquares, int sampleCount)
+        {
+            max = std::max(max, sampleMax);
+            min = std::min(min, sampleMin);
+            sumSquares += sampleSquares;
+            count += sampleCount;
+        }
+    };
+
+    WaveformPyramid() = default;
+
+    WaveformPyramid(std::span<const float> max, std::span<const float> min, std::span<const float> rms)
+    {
+        const size_t count = std::min({max.size(), min.size(), rms.size()});
+        if(count == 0) {
+            return;
+        }
+
+        Level& base = m_levels.emplace_back();
+        base.max.assign(max.begin(), max.begin() + static_cast<std::ptrdiff_t>(count));
+        base.min.assign(min.begin(), min.begin() + static_cast<std::ptrdiff_t>(count));
+        base.squares.reserve(count);
+        for(size_t i{0}; i < count; ++i) {
+            base.squares.push_back(rms[i] * rms[i]);
+        }
+
+        while(m_levels.back().max.size() > 1) {
+            const Level& below = m_levels.back();
+            const size_t size  = below.max.size();
+
+            Level level;
+            level.max.reserve((size + 1) / 2);
+            level.min.reserve((size + 1) / 2);
+            level.squares.reserve((size + 1) / 2);
+
+            for(size_t i{0}; i < size; i += 2) {
+                const size_t next = std::min(i + 1, size - 1);
+                level.max.push_back(std::max(below.max[i], below.max[next]));
+                level.min.push_back(std::min(below.min[i], below.min[next]));
+                level.squares.push_back(next == i ? below.squares[i] : below.squares[i] + below.squares[next]);
+            }
+
+            m_levels.push_back(std::move(level));
+        }
+    }
+
+    /** Returns the number of original samples. */
+    [[nodiscard]] int size() const
+    {
+        return m_levels.empty() ? 0 : static_cast<int>(m_levels.front().max.size());
+    }
+
+    [[nodiscard]] int levelCount() const
+    {
+        return static_cast<int>(m_levels.size());
+    }
+
+    /** Merges the samples [@p begin, @p end) into @p summary. */
+    void summarise(int begin, int end, Summary& summary) const
+    {
+        begin = std::max(begin, 0);
+        end   = std::min(end, size());
+
+        const int levels = levelCount();
+
+        while(begin < end) {
+            // Use the largest node starting at begin which doesn't extend past end
+            int level{0};
+            while(level + 1 < levels && (begin & ((2 << level) - 1)) == 0 && begin + (2 << level) <= end) {
+                ++level;
+            }
+
+            const Level& nodes = m_levels[level];
+            const auto index   = static_cast<size_t>(begin >> level);
+            summary.merge(nodes.max[index], nodes.min[index], nodes.squares[index], 1 << level);
+
+            begin += 1 << level;
+        }
+    }
+
+private:
+    struct Level
+    {
+        std::vector<float> max;
+        std::vector<float> min;
+        // Sum of squared rms values of the samples covered
+        std::vector<float> squares;
+    };
+
+    std::vector<Level> m_levels;
+};
+} // namespace Fooyin::WaveBar
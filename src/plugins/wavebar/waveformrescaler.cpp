@@ -21,33 +21,31 @@
 
 #include <utils/settings/settingsmanager.h>
 
+#include <cmath>
+#include <limits>
+#include <utility>
+
 namespace {
-int buildSample(Fooyin::WaveBar::WaveformSample& sample, Fooyin::WaveBar::WaveformData<float>& data, int channel,
-                double start, double end)
+float toFloat(int16_t sample)
 {
-    int sampleCount{0};
-
-    auto& [inMax, inMin, inRms] = data.channelData.at(channel);
-
-    const int lastIndex = std::floor(end);
+    return static_cast<float>(sample) / static_cast<float>(std::numeric_limits<int16_t>::max());
+}
 
-    for(int i = std::floor(start); i < std::ceil(end); ++i) {
-        for(int index{i}; index < lastIndex; ++index) {
-            if(std::cmp_less(index, inMax.size())) {
-                const float sampleMax = inMax.at(index);
-                const float sampleMin = inMin.at(index);
-                const float sampleRms = inRms.at(index);
+// Mapped waveforms are summarised from the stored int16 samples, converting only those read
+void summariseMapped(const Fooyin::WaveBar::MappedWaveform& waveform, int channel, int begin, int end,
+                     Fooyin::WaveBar::WaveformPyramid::Summary& summary)
+{
+    const auto max = waveform.max(channel);
+    const auto min = waveform.min(channel);
+    const auto rms = waveform.rms(channel);
 
-                sample.max = std::max(sample.max, sampleMax);
-                sample.min = std::min(sample.min, sampleMin);
-                sample.rms += sampleRms * sampleRms;
+    begin = std::max(begin, 0);
+    end   = std::min(end, static_cast<int>(max.size()));
 
-                ++sampleCount;
-            }
-        }
+    for(auto i = static_cast<size_t>(begin); std::cmp_less(i, end); ++i) {
+        const float sampleRms = toFloat(rms[i]);
+        summary.merge(toFloat(max[i]), toFloat(min[i]), sampleRms * sampleRms, 1);
     }
-
-    return sampleCount;
 }
 } // namespace
 
@@ -69,6 +67,7 @@ void WaveformRescaler::rescale()
 
     WaveformData<float> data{m_data};
     data.channelData.clear();
+    data.mapped.reset();
 
     if(m_downMix == DownmixOption::Stereo) {
         data.channels = 2;
@@ -82,6 +81,8 @@ void WaveformRescaler::rescale()
     const double sampleSize
         = static_cast<double>(m_data.complete ? m_data.sampleCount() : m_data.samplesPerChannel) * m_sampleWidth;
     const auto samplesPerPixel = sampleSize / m_width;
+    const bool mixChannels
+        = m_downMix == DownmixOption::Mono || (m_downMix == DownmixOption::Stereo && m_data.channels > 2);
 
     for(int ch{0}; ch < data.channels; ++ch) {
         auto& [outMax, outMin, outRms] = data.channelData.at(ch);
@@ -94,26 +95,35 @@ void WaveformRescaler::rescale()
             }
 
             const double end = std::max(1.0, (x + 1) * samplesPerPixel);
+            const auto first = static_cast<int>(std::floor(start));
+            const auto last  = static_cast<int>(std::floor(end));
 
-            int sampleCount{0};
-            WaveformSample sample;
+            WaveformPyramid::Summary summary;
 
-            if(m_downMix == DownmixOption::Mono || (m_downMix == DownmixOption::Stereo && m_data.channels > 2)) {
-                for(int mixCh{0}; mixCh < m_data.channels; ++mixCh) {
-                    sampleCount += buildSample(sample, m_data, mixCh, start, end);
+            if(m_data.mapped) {
+                const int channels = m_data.mapped->channels();
+                if(mixChannels) {
+                    for(int mappedCh{0}; mappedCh < channels; ++mappedCh) {
+                        summariseMapped(*m_data.mapped, mappedCh, first, last, summary);
+                    }
+                }
+                else {
+                    summariseMapped(*m_data.mapped, ch, first, last, summary);
+                }
+            }
+            else if(mixChannels) {
+                for(const auto& pyramid : m_pyramids) {
+                    pyramid.summarise(first, last, summary);
                 }
             }
-            else {
-                sampleCount += buildSample(sample, m_data, ch, start, end);
+            else if(std::cmp_less(ch, m_pyramids.size())) {
+                m_pyramids.at(ch).summarise(first, last, summary);
             }
 
-            if(sampleCount > 0) {
-                sample.rms /= static_cast<float>(sampleCount);
-                sample.rms = std::sqrt(sample.rms);
-
-                outMax.emplace_back(sample.max);
-                outMin.emplace_back(sample.min);
-                outRms.emplace_back(sample.rms);
+            if(summary.count > 0) {
+                outMax.emplace_back(summary.max);
+                outMin.emplace_back(summary.min);
+                outRms.emplace_back(std::sqrt(summary.sumSquares / static_cast<float>(summary.count)));
             }
 
             start = end;
@@ -138,6 +148,11 @@ void WaveformRescaler::rescale(int width)
 void WaveformRescaler::rescale(const WaveformData<float>& data, int width)
 {
     if(std::exchange(m_data, data) != data) {
+        // Mapped samples are scanned as they are instead, as building a pyramid would copy them
+        m_pyramids.clear();
+        for(const auto& [max, min, rms] : m_data.channelData) {
+            m_pyramids.emplace_back(max, min, rms);
+        }
         rescale(width);
     }
 }
@@ -21,6 +21,7 @@
 
 #include "settings/wavebarsettings.h"
 #include "waveformdata.h"
+#include "waveformpyramid.h"
 
 #include <utils/worker.h>
 
@@ -45,6 +46,8 @@ public slots:
 
 private:
     WaveformData<float> m_data;
+    // One per channel of m_data, so any width is summarised without rescanning every sample
+    std::vector<WaveformPyramid> m_pyramids;
     int m_width;
     int m_sampleWidth;
     DownmixOption m_downMix;
@@ -0,0 +1,170 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "waveformstore.h"
+
+#include <utils/paths.h>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+// Marks version 1 of the file format
+constexpr std::array<char, 4> StoreMagic{'F', 'Y', 'W', 'F'};
+constexpr uint16_t StoreVersion = 1;
+// Samples are written in native byte order, so files copied from a machine with the other order are rejected
+constexpr uint16_t ByteOrderMark = 0x0102;
+
+namespace {
+struct FileHeader
+{
+    std::array<char, 4> magic{StoreMagic};
+    uint16_t version{StoreVersion};
+    uint16_t byteOrder{ByteOrderMark};
+    uint32_t channels{0};
+    uint32_t sampleCount{0};
+};
+static_assert(sizeof(FileHeader) == 16 && sizeof(FileHeader) % alignof(int16_t) == 0);
+
+qint64 expectedSize(const FileHeader& header)
+{
+    return static_cast<qint64>(sizeof(FileHeader))
+         + (static_cast<qint64>(header.channels) * 3 * header.sampleCount * static_cast<qint64>(sizeof(int16_t)));
+}
+
+bool writeArray(QSaveFile& file, const std::vector<int16_t>& samples)
+{
+    const auto size = static_cast<qint64>(samples.size() * sizeof(int16_t));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return file.write(reinterpret_cast<const char*>(samples.data()), size) == size;
+}
+} // namespace
+
+namespace Fooyin::WaveBar {
+WaveformStore::WaveformStore()
+    : WaveformStore{Utils::cachePath(QStringLiteral("waveforms"))}
+{ }
+
+WaveformStore::WaveformStore(QString dir)
+    : m_dir{std::move(dir)}
+{ }
+
+bool WaveformStore::contains(const QString& key) const
+{
+    return QFileInfo::exists(filepath(key));
+}
+
+MappedWaveformPtr WaveformStore::map(const QString& key) const
+{
+    auto file = std::make_unique<QFile>(filepath(key));
+    if(!file->open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    if(file->size() < static_cast<qint64>(sizeof(FileHeader))) {
+        return nullptr;
+    }
+
+    const uchar* data = file->map(0, file->size());
+    if(!data) {
+        return nullptr;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(FileHeader));
+    if(header.magic != StoreMagic || header.version != StoreVersion || header.byteOrder != ByteOrderMark
+       || header.channels == 0 || header.sampleCount > static_cast<uint32_t>(std::numeric_limits<int>::max())
+       || file->size() != expectedSize(header)) {
+        return nullptr;
+    }
+
+    // The mapping is page aligned and the header a multiple of the sample size, so the arrays are aligned
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* samples = reinterpret_cast<const int16_t*>(data + sizeof(FileHeader));
+    return std::make_shared<const MappedWaveform>(std::move(file), samples, static_cast<int>(header.channels),
+                                                  static_cast<int>(header.sampleCount));
+}
+
+bool WaveformStore::write(const QString& key, const WaveformData<int16_t>& data) const
+{
+    if(data.channelData.empty()) {
+        return false;
+    }
+
+    FileHeader header;
+    header.channels    = static_cast<uint32_t>(data.channelData.size());
+    header.sampleCount = static_cast<uint32_t>(data.channelData.front().max.size());
+
+    for(const auto& [max, min, rms] : data.channelData) {
+        if(max.size() != header.sampleCount || min.size() != header.sampleCount || rms.size() != header.sampleCount) {
+            return false;
+        }
+    }
+
+    const QString path = filepath(key);
+    if(!QDir{}.mkpath(QFileInfo{path}.absolutePath())) {
+        return false;
+    }
+
+    // Replaced atomically, so a mapping of the previous file is never truncated under a reader
+    QSaveFile file{path};
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    constexpr auto headerSize = static_cast<qint64>(sizeof(FileHeader));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if(file.write(reinterpret_cast<const char*>(&header), headerSize) != headerSize) {
+        file.cancelWriting();
+        return false;
+    }
+
+    for(const auto& [max, min, rms] : data.channelData) {
+        if(!writeArray(file, max) || !writeArray(file, min) || !writeArray(file, rms)) {
+            file.cancelWriting();
+            return false;
+        }
+    }
+
+    return file.commit();
+}
+
+bool WaveformStore::remove(const QString& key) const
+{
+    const QString path = filepath(key);
+    return !QFileInfo::exists(path) || QFile::remove(path);
+}
+
+bool WaveformStore::clear() const
+{
+    QDir dir{m_dir};
+    return !dir.exists() || dir.removeRecursively();
+}
+
+QString WaveformStore::filepath(const QString& key) const
+{
+    // Spread over subdirectories so none holds the whole library
+    return m_dir + QDir::separator() + key.left(2) + QDir::separator() + key + QStringLiteral(".fyw");
+}
+} // namespace Fooyin::WaveBar
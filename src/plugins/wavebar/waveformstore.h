@@ -0,0 +1,52 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#pragma once
+
+#include "mappedwaveform.h"
+#include "waveformdata.h"
+
+#include <QString>
+
+namespace Fooyin::WaveBar {
+/*!
+ * Keeps waveforms as flat files (a fixed header followed by the int16 sample arrays) under the cache directory,
+ * one per cache key. Files are uncompressed so they can be mapped and drawn from without decoding or copying.
+ */
+class WaveformStore
+{
+public:
+    WaveformStore();
+    explicit WaveformStore(QString dir);
+
+    [[nodiscard]] bool contains(const QString& key) const;
+    /** Returns the waveform stored for @p key, or @c nullptr if there isn't one or it can't be read. */
+    [[nodiscard]] MappedWaveformPtr map(const QString& key) const;
+    /** Writes @p data for @p key, replacing any existing file. Channels must all have the same sample count. */
+    [[nodiscard]] bool write(const QString& key, const WaveformData<int16_t>& data) const;
+    bool remove(const QString& key) const;
+    bool clear() const;
+
+private:
+    [[nodiscard]] QString filepath(const QString& key) const;
+
+    QString m_dir;
+};
+} // namespace Fooyin::WaveBar
@@ -22,6 +22,7 @@
 #include "settings/wavebarsettings.h"
 
 #include <core/track.h>
+#include <utils/memoryusage.h>
 #include <utils/settings/settingsmanager.h>
 #include <utils/utils.h>
 
@@ -29,7 +30,14 @@
 #include <QPainter>
 #include <QStyle>
 
+#include <array>
+#include <cmath>
+#include <limits>
+
 constexpr auto ToolTipDelay = 5;
+// Positions which draw every bar of a cached layer as played/unplayed
+constexpr int AllPlayed   = std::numeric_limits<int>::max() / 2;
+constexpr int AllUnplayed = std::numeric_limits<int>::min() / 2;
 
 namespace {
 QColor blendColors(const QColor& color1, const QColor& color2, double ratio)
@@ -59,12 +67,19 @@ void setupPainter(QPainter& painter, bool isInProgress, bool isPlayed, int barWi
         painter.setPen(Qt::NoPen);
     }
 }
+
+size_t pixmapBytes(const QPixmap& pixmap)
+{
+    return static_cast<size_t>(pixmap.width()) * static_cast<size_t>(pixmap.height())
+         * static_cast<size_t>(pixmap.depth()) / 8;
+}
 } // namespace
 
 namespace Fooyin::WaveBar {
 WaveSeekBar::WaveSeekBar(SettingsManager* settings, QWidget* parent)
     : QWidget{parent}
     , m_settings{settings}
+    , m_cacheValid{false}
     , m_scale{1.0}
     , m_position{0}
     , m_showCursor{settings->value<Settings::WaveBar::ShowCursor>()}
@@ -80,6 +95,22 @@ WaveSeekBar::WaveSeekBar(SettingsManager* settings, QWidget* parent)
 {
     setFocusPolicy(Qt::FocusPolicy(style()->styleHint(QStyle::SH_Button_FocusPolicy)));
 
+    // The drawn waveform is only a cache, so it can be dropped and redrawn on the next paint
+    m_memorySource = MemoryUsage::addSource(
+        QStringLiteral("Waveforms"),
+        [this]() {
+            size_t bytes = pixmapBytes(m_playedCache) + pixmapBytes(m_unplayedCache);
+            for(const auto& channel : m_data.channelData) {
+                bytes += (channel.max.capacity() + channel.min.capacity() + channel.rms.capacity()) * sizeof(float);
+            }
+            return MemoryUsage::Usage{.bytes = bytes, .entries = m_data.channelData.empty() ? 0U : 1U};
+        },
+        [this]() {
+            m_playedCache   = {};
+            m_unplayedCache = {};
+            invalidateCache();
+        });
+
     m_settings->subscribe<Settings::WaveBar::ShowCursor>(this, [this](const bool show) {
         m_showCursor = show;
         update();
@@ -90,36 +121,41 @@ WaveSeekBar::WaveSeekBar(SettingsManager* settings, QWidget* parent)
     });
     m_settings->subscribe<Settings::WaveBar::ChannelScale>(this, [this](const double scale) {
         m_channelScale = scale;
-        update();
+        invalidateCache();
     });
     m_settings->subscribe<Settings::WaveBar::BarWidth>(this, [this](const int width) {
         m_barWidth    = width;
         m_sampleWidth = m_barWidth + m_barGap;
-        update();
+        invalidateCache();
     });
     m_settings->subscribe<Settings::WaveBar::BarGap>(this, [this](const int gap) {
         m_barGap      = gap;
         m_sampleWidth = m_barWidth + m_barGap;
-        update();
+        invalidateCache();
     });
     m_settings->subscribe<Settings::WaveBar::MaxScale>(this, [this](const double scale) {
         m_maxScale = scale;
-        update();
+        invalidateCache();
     });
     m_settings->subscribe<Settings::WaveBar::CentreGap>(this, [this](const int gap) {
         m_centreGap = gap;
-        update();
+        invalidateCache();
     });
     m_settings->subscribe<Settings::WaveBar::Mode>(this, [this](const int mode) {
         m_mode = static_cast<WaveModes>(mode);
-        update();
+        invalidateCache();
     });
     m_settings->subscribe<Settings::WaveBar::ColourOptions>(this, [this](const QVariant& var) {
         m_colours = var.value<Colours>();
-        update();
+        invalidateCache();
     });
 }
 
+WaveSeekBar::~WaveSeekBar()
+{
+    MemoryUsage::removeSource(m_memorySource);
+}
+
 void WaveSeekBar::processData(const WaveformData<float>& waveData)
 {
     m_data = waveData;
@@ -132,14 +168,15 @@ void WaveSeekBar::processData(const WaveformData<float>& waveData)
         m_scale                 = std::round(m_scale * multiplier) / multiplier;
     }
 
-    update();
+    invalidateCache();
 }
 
 void WaveSeekBar::setPosition(uint64_t pos)
 {
     const uint64_t oldPos = std::exchange(m_position, pos);
 
-    if(oldPos == pos) {
+    // Nothing is drawn while hidden or minimised, so catch up in showEvent instead
+    if(oldPos == pos || !isVisible() || window()->isMinimized()) {
         return;
     }
 
@@ -164,42 +201,66 @@ void WaveSeekBar::stopSeeking()
     update();
 }
 
+void WaveSeekBar::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+
+    update();
+}
+
 void WaveSeekBar::paintEvent(QPaintEvent* event)
 {
     QPainter painter{this};
-    painter.scale(m_scale, 1.0);
 
     if(m_data.empty()) {
+        painter.scale(m_scale, 1.0);
         painter.setPen({m_colours.maxUnplayed, 1, Qt::SolidLine, Qt::FlatCap});
         const int centreY = height() / 2;
         painter.drawLine(0, centreY, rect().right(), centreY);
         return;
     }
 
-    const int channels = m_data.channels;
-    QRect rect         = event->rect();
+    updateCache();
+
+    QRect rect = event->rect();
     // Always repaint full height
     // Prevents clipping with seek tooltip and from other widgets
     rect.setHeight(contentsRect().height());
 
-    const auto first  = static_cast<int>(static_cast<double>(rect.left() / m_scale) / m_sampleWidth);
-    const auto last   = static_cast<int>(static_cast<double>(rect.right() + 1 / m_scale));
-    const double posX = positionFromValue(m_position) / m_scale;
-
-    painter.fillRect(rect, m_colours.bgUnplayed);
-    painter.fillRect(QRect{first, 0, static_cast<int>(posX) - first, height()}, m_colours.bgPlayed);
-
-    const int channelHeight     = rect.height() / channels;
-    const double waveformHeight = (channelHeight - m_centreGap) * m_channelScale;
-
-    int y = static_cast<int>((channelHeight - waveformHeight) / 2);
+    const int currentPosition = positionFromValue(m_position);
+    const double dpr          = m_playedCache.devicePixelRatio();
 
-    for(int ch{0}; ch < channels; ++ch) {
-        drawChannel(painter, ch, waveformHeight, first, last, y);
-        y += channelHeight;
+    auto drawCache = [&painter, dpr](const QPixmap& cache, const QRect& target) {
+        if(!target.isEmpty()) {
+            const QRectF source{target.x() * dpr, target.y() * dpr, target.width() * dpr, target.height() * dpr};
+            painter.drawPixmap(QRectF{target}, cache, source);
+        }
+    };
+
+    drawCache(m_playedCache, rect.intersected({0, 0, currentPosition, height()}));
+    drawCache(m_unplayedCache, rect.intersected({currentPosition, 0, width() - currentPosition, height()}));
+
+    // Only the bars around the cursor are partly played, so they're the only ones drawn live
+    const double barSpan = m_sampleWidth * m_scale;
+    if(barSpan > 0) {
+        const int firstBar = std::max(0, static_cast<int>(currentPosition / barSpan) - 1);
+        const int lastBar  = static_cast<int>(std::ceil((currentPosition + m_sampleWidth) / barSpan)) + 1;
+        const QRect liveRect
+            = rect.intersected({static_cast<int>(firstBar * barSpan), 0,
+                                static_cast<int>(std::ceil((lastBar - firstBar) * barSpan)), height()});
+
+        if(!liveRect.isEmpty()) {
+            painter.save();
+            painter.setClipRect(liveRect);
+            drawWaveform(painter, liveRect, currentPosition);
+            painter.restore();
+        }
     }
 
+    painter.scale(m_scale, 1.0);
+
     if(m_showCursor) {
+        const double posX = currentPosition / m_scale;
         painter.setPen({m_colours.cursor, static_cast<double>(m_cursorWidth), Qt::SolidLine, Qt::FlatCap});
         const QPointF pt1{posX, 0};
         const QPointF pt2{posX, static_cast<double>(height())};
@@ -332,11 +393,13 @@ void WaveSeekBar::updateRange(int first, int last)
         return;
     }
 
-    const auto cursorWidth = static_cast<int>(m_cursorWidth * m_scale);
-    const int left         = (first < last ? first : last) - cursorWidth - m_sampleWidth;
-    const int width        = (std::abs(last - first) + (2 * cursorWidth) + 1) * m_sampleWidth;
+    // Only the span between the two positions changes, plus the cursor and the partly played bar either side
+    const auto cursorWidth = static_cast<int>(std::ceil(m_cursorWidth * m_scale));
+    const auto barSpan     = static_cast<int>(std::ceil(m_sampleWidth * m_scale));
+    const int left         = std::min(first, last) - cursorWidth - barSpan;
+    const int right        = std::max(first, last) + cursorWidth + barSpan;
 
-    const QRect updateRect(left, 0, width, height());
+    const QRect updateRect(left, 0, right - left + 1, height());
     update(updateRect);
 
     if(isSeeking() && m_seekTip) {
@@ -344,7 +407,65 @@ void WaveSeekBar::updateRange(int first, int last)
     }
 }
 
-void WaveSeekBar::drawChannel(QPainter& painter, int channel, double height, int first, int last, int y)
+void WaveSeekBar::invalidateCache()
+{
+    m_cacheValid = false;
+    update();
+}
+
+void WaveSeekBar::updateCache()
+{
+    const double dpr      = devicePixelRatioF();
+    const QSize cacheSize = (QSizeF{size()} * dpr).toSize();
+
+    if(m_cacheValid && m_playedCache.size() == cacheSize && m_playedCache.devicePixelRatio() == dpr) {
+        return;
+    }
+
+    const std::array layers{std::pair{&m_playedCache, AllPlayed}, std::pair{&m_unplayedCache, AllUnplayed}};
+    for(const auto& [cache, currentPosition] : layers) {
+        *cache = QPixmap{cacheSize};
+        cache->setDevicePixelRatio(dpr);
+        cache->fill(Qt::transparent);
+
+        QPainter painter{cache};
+        drawWaveform(painter, rect(), currentPosition);
+    }
+
+    m_cacheValid = true;
+}
+
+void WaveSeekBar::drawWaveform(QPainter& painter, const QRect& rect, int currentPosition)
+{
+    const int playedWidth = std::clamp(currentPosition, 0, width()) - rect.left();
+
+    painter.fillRect(rect, m_colours.bgUnplayed);
+    if(playedWidth > 0) {
+        painter.fillRect(QRect{rect.left(), rect.top(), playedWidth, rect.height()}, m_colours.bgPlayed);
+    }
+
+    painter.save();
+    painter.scale(m_scale, 1.0);
+
+    const int channels = m_data.channels;
+    const auto first   = static_cast<int>(static_cast<double>(rect.left() / m_scale) / m_sampleWidth);
+    const auto last    = static_cast<int>(static_cast<double>(rect.right() + 1 / m_scale));
+
+    const int channelHeight     = rect.height() / channels;
+    const double waveformHeight = (channelHeight - m_centreGap) * m_channelScale;
+
+    int y = static_cast<int>((channelHeight - waveformHeight) / 2);
+
+    for(int ch{0}; ch < channels; ++ch) {
+        drawChannel(painter, ch, waveformHeight, first, last, y, currentPosition);
+        y += channelHeight;
+    }
+
+    painter.restore();
+}
+
+void WaveSeekBar::drawChannel(QPainter& painter, int channel, double height, int first, int last, int y,
+                              int currentPosition)
 {
     const auto& [max, min, rms] = m_data.channelData.at(channel);
 
@@ -358,7 +479,7 @@ void WaveSeekBar::drawChannel(QPainter& painter, int channel, double height, int
 
     if(!m_data.complete || (m_mode & WaveMode::Silence && drawMax && drawMin)) {
         const auto centreY = static_cast<double>(centre + (centreGap > 0 ? centreGap / 2 : 0));
-        drawSilence(painter, first, last, centreY);
+        drawSilence(painter, first, last, centreY, currentPosition);
     }
 
     double rmsScale{1.0};
@@ -366,8 +487,7 @@ void WaveSeekBar::drawChannel(QPainter& painter, int channel, double height, int
         rmsScale = *std::ranges::max_element(rms);
     }
 
-    const auto total           = static_cast<int>(max.size());
-    const auto currentPosition = positionFromValue(m_position);
+    const auto total = static_cast<int>(max.size());
 
     for(int i{first}; i <= last && i < total; ++i) {
         const auto x        = static_cast<double>(i * m_sampleWidth);
@@ -440,9 +560,9 @@ void WaveSeekBar::drawChannel(QPainter& painter, int channel, double height, int
     }
 }
 
-void WaveSeekBar::drawSilence(QPainter& painter, int first, int last, double y)
+void WaveSeekBar::drawSilence(QPainter& painter, int first, int last, double y, int position)
 {
-    const auto currentPosition = static_cast<double>(positionFromValue(m_position));
+    const auto currentPosition = static_cast<double>(position);
     const bool showRms         = m_data.complete && m_mode & WaveMode::Rms;
     const auto unplayedColour  = showRms ? m_colours.rmsMaxUnplayed : m_colours.maxUnplayed;
     const auto playedColour    = showRms ? m_colours.rmsMaxPlayed : m_colours.maxPlayed;
@@ -25,6 +25,7 @@
 
 #include <utils/widgets/tooltip.h>
 
+#include <QPixmap>
 #include <QPointer>
 #include <QWidget>
 
@@ -38,6 +39,7 @@ class WaveSeekBar : public QWidget
 
 public:
     explicit WaveSeekBar(SettingsManager* settings, QWidget* parent = nullptr);
+    ~WaveSeekBar() override;
 
     void processData(const WaveformData<float>& waveData);
 
@@ -51,6 +53,7 @@ signals:
     void seekBackward();
 
 protected:
+    void showEvent(QShowEvent* event) override;
     void paintEvent(QPaintEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
     void mousePressEvent(QMouseEvent* event) override;
@@ -64,13 +67,21 @@ private:
     void updateMousePosition(const QPoint& pos);
     void updateRange(int first, int last);
 
-    void drawChannel(QPainter& painter, int channel, double height, int first, int last, int y);
-    void drawSilence(QPainter& painter, int first, int last, double y);
+    void invalidateCache();
+    void updateCache();
+
+    void drawWaveform(QPainter& painter, const QRect& rect, int currentPosition);
+    void drawChannel(QPainter& painter, int channel, double height, int first, int last, int y, int currentPosition);
+    void drawSilence(QPainter& painter, int first, int last, double y, int position);
     void drawSeekTip();
 
     SettingsManager* m_settings;
 
     WaveformData<float> m_data;
+    // The whole waveform drawn fully played and fully unplayed, so moving the cursor only blits
+    QPixmap m_playedCache;
+    QPixmap m_unplayedCache;
+    bool m_cacheValid;
     double m_scale;
     uint64_t m_position;
     QPoint m_pressPos;
@@ -88,6 +99,8 @@ private:
 
     WaveModes m_mode;
     Colours m_colours;
+
+    int m_memorySource;
 };
 } // namespace WaveBar
 } // namespace Fooyin
@@ -0,0 +1,82 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/crossthreadstats.h>
+
+#include <QDebug>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string_view>
+
+namespace {
+#ifndef NDEBUG
+struct ChannelStats
+{
+    uint64_t bytes{0};
+    uint64_t copies{0};
+};
+
+std::mutex statsMutex;
+// Keyed by name rather than pointer, as the same literal may have a different address in each library
+std::map<std::string_view, ChannelStats> channelStats;
+std::atomic<uint64_t> totalBytes{0};
+#endif
+} // namespace
+
+namespace Fooyin::CrossThreadStats {
+void recordCopy([[maybe_unused]] const char* channel, [[maybe_unused]] size_t bytes)
+{
+#ifndef NDEBUG
+    totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    const std::scoped_lock lock{statsMutex};
+    auto& stats = channelStats[channel];
+    stats.bytes += bytes;
+    ++stats.copies;
+#endif
+}
+
+uint64_t bytesCopied()
+{
+#ifndef NDEBUG
+    return totalBytes.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+void logSummary()
+{
+#ifndef NDEBUG
+    const std::scoped_lock lock{statsMutex};
+
+    if(channelStats.empty()) {
+        return;
+    }
+
+    qDebug() << "[CrossThread] Copied" << totalBytes.load(std::memory_order_relaxed) << "bytes into queued signals";
+    for(const auto& [channel, stats] : channelStats) {
+        qDebug().nospace() << "[CrossThread]   " << channel.data() << ": " << stats.bytes << " bytes in "
+                           << stats.copies << " signals";
+    }
+#endif
+}
+} // namespace Fooyin::CrossThreadStats
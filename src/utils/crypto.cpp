@@ -23,7 +23,104 @@
 #include <QRandomGenerator>
 #include <QUuid>
 
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+// XXH64 primes
+constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+namespace {
+uint64_t read64(const unsigned char* data)
+{
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+uint32_t read32(const unsigned char* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+uint64_t hashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * Prime2;
+    acc = std::rotl(acc, 31);
+    return acc * Prime1;
+}
+
+uint64_t mergeRound(uint64_t acc, uint64_t value)
+{
+    acc ^= hashRound(0, value);
+    return acc * Prime1 + Prime4;
+}
+} // namespace
+
 namespace Fooyin::Utils {
+uint64_t hash64(const void* data, size_t size, uint64_t seed)
+{
+    const auto* input     = static_cast<const unsigned char*>(data);
+    const auto* const end = input + size;
+
+    uint64_t hash;
+
+    if(size >= 32) {
+        uint64_t v1 = seed + Prime1 + Prime2;
+        uint64_t v2 = seed + Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - Prime1;
+
+        const auto* const limit = end - 32;
+        do {
+            v1 = hashRound(v1, read64(input));
+            v2 = hashRound(v2, read64(input + 8));
+            v3 = hashRound(v3, read64(input + 16));
+            v4 = hashRound(v4, read64(input + 24));
+            input += 32;
+        } while(input <= limit);
+
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else {
+        hash = seed + Prime5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    for(; input + 8 <= end; input += 8) {
+        hash ^= hashRound(0, read64(input));
+        hash = std::rotl(hash, 27) * Prime1 + Prime4;
+    }
+    if(input + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(input)) * Prime1;
+        hash = std::rotl(hash, 23) * Prime2 + Prime3;
+        input += 4;
+    }
+    for(; input < end; ++input) {
+        hash ^= *input * Prime5;
+        hash = std::rotl(hash, 11) * Prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
 QString generateRandomHash()
 {
     const QString uniqueId  = QUuid::createUuid().toString();
@@ -41,4 +138,10 @@ QString generateUniqueHash()
 {
     return QUuid::createUuid().toString(QUuid::Id128);
 }
+
+QString generateUniqueKey()
+{
+    static std::atomic<uint64_t> counter{0};
+    return QString::number(++counter, 36);
+}
 } // namespace Fooyin::Utils
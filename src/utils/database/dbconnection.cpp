@@ -21,6 +21,7 @@
 
 #include <QDebug>
 #include <QSqlError>
+#include <QSqlQuery>
 
 namespace {
 void createDatabase(const Fooyin::DbConnection::DbParams& params, const QString& connectionName)
@@ -40,12 +41,16 @@ void cloneDatabase(const Fooyin::DbConnection& original, const QString& connecti
 namespace Fooyin {
 DbConnection::DbConnection(const DbParams& params, const QString& connectionName)
     : m_name{connectionName}
+    , m_profile{params.profile}
+    , m_readOnly{params.readOnly}
 {
     createDatabase(params, connectionName);
 }
 
 DbConnection::DbConnection(const DbConnection& original, const QString& connectionName)
     : m_name{connectionName}
+    , m_profile{original.profile()}
+    , m_readOnly{original.readOnly()}
 {
     cloneDatabase(original, connectionName);
 }
@@ -61,6 +66,16 @@ QString DbConnection::name() const
     return m_name;
 }
 
+DbConnection::Profile DbConnection::profile() const
+{
+    return m_profile;
+}
+
+bool DbConnection::readOnly() const
+{
+    return m_readOnly;
+}
+
 bool DbConnection::open()
 {
     auto db = this->db();
@@ -75,11 +90,19 @@ bool DbConnection::open()
 
 void DbConnection::close()
 {
+    // Prepared statements must be released before the connection goes away
+    m_queries.clear();
+
     auto db = this->db();
     if(db.isOpen()) {
         if(db.rollback()) {
             qWarning() << "[DB] Rolled back open transaction before closing connection:" << m_name;
         }
+        if(m_profile == Profile::Performance && !m_readOnly) {
+            // Lets SQLite refresh the statistics of tables this connection used heavily
+            QSqlQuery optimise{db};
+            optimise.exec(QStringLiteral("PRAGMA optimize;"));
+        }
         db.close();
     }
 }
@@ -93,4 +116,13 @@ QSqlDatabase DbConnection::db() const
 {
     return QSqlDatabase::database(m_name);
 }
+
+DbQuery& DbConnection::cachedQuery(const QString& statement)
+{
+    auto queryIt = m_queries.find(statement);
+    if(queryIt == m_queries.end()) {
+        queryIt = m_queries.try_emplace(statement, db(), statement).first;
+    }
+    return queryIt->second;
+}
 } // namespace Fooyin
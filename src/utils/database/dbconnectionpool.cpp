@@ -19,16 +19,74 @@
 
 #include <utils/database/dbconnectionpool.h>
 
+#include <QDebug>
+#include <QSqlError>
 #include <QSqlQuery>
 
+#include <algorithm>
+
+constexpr auto BusyTimeout = 5000;              // ms
+constexpr auto MmapSize    = 256 * 1024 * 1024; // bytes
+constexpr auto CacheSize   = -32 * 1024;        // KiB when negative
+
 namespace {
+bool execPragma(Fooyin::DbConnection* connection, const QString& pragma)
+{
+    QSqlQuery query{connection->db()};
+    if(!query.exec(pragma)) {
+        qWarning() << "[DB] Failed to execute" << pragma << "on" << connection->name() << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool setJournalMode(Fooyin::DbConnection* connection, const QString& mode)
+{
+    QSqlQuery query{connection->db()};
+    if(!query.exec(QStringLiteral("PRAGMA journal_mode = %1;").arg(mode)) || !query.next()) {
+        return false;
+    }
+
+    // The mode can't change while other connections have the database open, which is harmless
+    const QString current = query.value(0).toString();
+    if(current.compare(mode, Qt::CaseInsensitive) != 0) {
+        qDebug() << "[DB] Journal mode of" << connection->name() << "remains" << current;
+    }
+    return true;
+}
+
 bool updatePragmas(Fooyin::DbConnection* connection)
 {
-    QSqlQuery foreignKeys{connection->db()};
-    if(!foreignKeys.exec(QStringLiteral("PRAGMA foreign_keys = ON;"))) {
+    using Profile = Fooyin::DbConnection::Profile;
+
+    if(!execPragma(connection, QStringLiteral("PRAGMA foreign_keys = ON;"))
+       || !execPragma(connection, QStringLiteral("PRAGMA busy_timeout = %1;").arg(BusyTimeout))) {
         return false;
     }
 
+    if(connection->readOnly()) {
+        // Setting the journal mode is a write, so it's left to the writing connections
+        if(!execPragma(connection, QStringLiteral("PRAGMA query_only = ON;"))) {
+            return false;
+        }
+    }
+    else if(connection->profile() == Profile::Default) {
+        return setJournalMode(connection, QStringLiteral("DELETE"));
+    }
+    else {
+        setJournalMode(connection, QStringLiteral("WAL"));
+        execPragma(connection, QStringLiteral("PRAGMA synchronous = NORMAL;"));
+    }
+
+    if(connection->profile() == Profile::Default) {
+        return true;
+    }
+
+    // Failures below only cost performance, so they don't prevent using the connection
+    execPragma(connection, QStringLiteral("PRAGMA temp_store = MEMORY;"));
+    execPragma(connection, QStringLiteral("PRAGMA mmap_size = %1;").arg(MmapSize));
+    execPragma(connection, QStringLiteral("PRAGMA cache_size = %1;").arg(CacheSize));
+
     return true;
 }
 } // namespace
@@ -43,12 +101,17 @@ struct DbConnectionPool::PrivateKey
 DbConnectionPool::DbConnectionPool(PrivateKey /*key*/, const DbConnection::DbParams& params,
                                    const QString& connectionName)
     : m_connectionCount{0}
+    , m_openConnections{0}
+    , m_connectionLimit{0}
     , m_prototype{params, connectionName}
 { }
 
-DbConnectionPoolPtr DbConnectionPool::create(const DbConnection::DbParams& params, const QString& connectionName)
+DbConnectionPoolPtr DbConnectionPool::create(const DbConnection::DbParams& params, const QString& connectionName,
+                                             int connectionLimit)
 {
-    return std::make_shared<DbConnectionPool>(PrivateKey{}, params, connectionName);
+    auto pool               = std::make_shared<DbConnectionPool>(PrivateKey{}, params, connectionName);
+    pool->m_connectionLimit = std::max(0, connectionLimit);
+    return pool;
 }
 
 bool DbConnectionPool::hasThreadConnection() const
@@ -63,17 +126,26 @@ bool DbConnectionPool::createThreadConnection()
         return false;
     }
 
+    const int openConnections = m_openConnections.fetch_add(1, std::memory_order_relaxed);
+    if(m_connectionLimit > 0 && openConnections >= m_connectionLimit) {
+        m_openConnections.fetch_sub(1, std::memory_order_relaxed);
+        qWarning() << "[DB] Connection limit of" << m_prototype.name() << "reached";
+        return false;
+    }
+
     const int connectionIndex = m_connectionCount.fetch_add(1, std::memory_order_acquire) + 1;
     const auto connectionName = QStringLiteral("%1-%2").arg(m_prototype.name()).arg(connectionIndex);
     auto connection           = std::make_unique<DbConnection>(m_prototype, connectionName);
 
     if(!connection->open()) {
         qCritical() << "[DB] Failed to open thread connection:" << connectionName;
+        m_openConnections.fetch_sub(1, std::memory_order_relaxed);
         return false;
     }
 
     if(!updatePragmas(connection.get())) {
         qCritical() << "[DB] Failed to set pragmas:" << connectionName;
+        m_openConnections.fetch_sub(1, std::memory_order_relaxed);
         return false;
     }
 
@@ -86,8 +158,10 @@ void DbConnectionPool::destroyThreadConnection()
 {
     if(!m_threadConnections.hasLocalData()) {
         qCritical() << "[DB] Thread connection not found";
+        return;
     }
 
+    m_openConnections.fetch_sub(1, std::memory_order_relaxed);
     m_threadConnections.setLocalData(nullptr);
 }
 
@@ -51,4 +51,13 @@ QSqlDatabase DbConnectionProvider::db() const
 
     return connection->db();
 }
+
+DbQuery* DbConnectionProvider::cachedQuery(const QString& statement) const
+{
+    if(!db().isOpen()) {
+        return nullptr;
+    }
+
+    return &m_connectionPool->threadConnection()->cachedQuery(statement);
+}
 } // namespace Fooyin
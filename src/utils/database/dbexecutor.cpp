@@ -0,0 +1,118 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/database/dbexecutor.h>
+
+#include <utils/database/dbconnectionhandler.h>
+
+#include <condition_variable>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Fooyin {
+struct DbExecutor::Private
+{
+    DbConnectionPoolPtr pool;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Task> interactive;
+    std::deque<Task> background;
+    bool stopping{false};
+
+    std::vector<std::thread> threads;
+
+    explicit Private(DbConnectionPoolPtr pool_)
+        : pool{std::move(pool_)}
+    { }
+
+    bool hasWork(bool interactiveOnly) const
+    {
+        return !interactive.empty() || (!interactiveOnly && !background.empty());
+    }
+
+    Task takeTask(bool interactiveOnly)
+    {
+        auto& queue = !interactive.empty() || interactiveOnly ? interactive : background;
+
+        Task task = std::move(queue.front());
+        queue.pop_front();
+        return task;
+    }
+
+    void runThread(bool interactiveOnly)
+    {
+        const DbConnectionHandler handler{pool};
+        const DbConnectionProvider provider{pool};
+
+        while(true) {
+            Task task;
+            {
+                std::unique_lock lock{mutex};
+                cond.wait(lock, [this, interactiveOnly]() { return stopping || hasWork(interactiveOnly); });
+                if(stopping) {
+                    return;
+                }
+                task = takeTask(interactiveOnly);
+            }
+            task(provider);
+        }
+    }
+};
+
+DbExecutor::DbExecutor(DbConnectionPoolPtr pool, int threadCount)
+    : p{std::make_unique<Private>(std::move(pool))}
+{
+    threadCount = std::max(threadCount, 1);
+    p->threads.reserve(threadCount);
+
+    for(int i{0}; i < threadCount; ++i) {
+        // With a single thread, background work has nowhere else to go
+        const bool interactiveOnly = i == 0 && threadCount > 1;
+        p->threads.emplace_back([this, interactiveOnly]() { p->runThread(interactiveOnly); });
+    }
+}
+
+DbExecutor::~DbExecutor()
+{
+    {
+        const std::scoped_lock lock{p->mutex};
+        p->stopping = true;
+    }
+    p->cond.notify_all();
+
+    for(auto& thread : p->threads) {
+        thread.join();
+    }
+}
+
+void DbExecutor::enqueue(Priority priority, Task task)
+{
+    {
+        const std::scoped_lock lock{p->mutex};
+        auto& queue = priority == Priority::Interactive ? p->interactive : p->background;
+        queue.push_back(std::move(task));
+    }
+    // Any thread may be the only one allowed to take this task
+    p->cond.notify_all();
+}
+} // namespace Fooyin
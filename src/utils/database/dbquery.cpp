@@ -19,6 +19,8 @@
 
 #include <utils/database/dbquery.h>
 
+#include <utils/metrics.h>
+
 #include <QSqlError>
 
 namespace {
@@ -80,6 +82,9 @@ QString DbQuery::executedQuery() const
 
 bool DbQuery::exec()
 {
+    static auto& queryTime = Metrics::histogram("fooyin_db_query_seconds", "Time taken to execute a query");
+    const Metrics::ScopedTimer timer{queryTime};
+
     if(m_query.exec()) {
         m_status = Status::Success;
         return true;
@@ -0,0 +1,185 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/directorycache.h>
+
+#include <utils/lrucache.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+// A change within the same millisecond as a listing leaves the modification time as it was,
+// so directories modified this recently are always listed again rather than cached
+constexpr qint64 RacyWindowMSecs = 2000;
+
+namespace {
+uint64_t modifiedMSecs(const QFileInfo& info)
+{
+    return static_cast<uint64_t>(info.lastModified().toMSecsSinceEpoch());
+}
+
+size_t listingCost(const Fooyin::DirectoryCache::Listing& listing)
+{
+    size_t cost = sizeof(Fooyin::DirectoryCache::Listing) + (static_cast<size_t>(listing.path.size()) * sizeof(QChar));
+    for(const auto& file : listing.files) {
+        cost += sizeof(Fooyin::Utils::File::FileEntry) + (static_cast<size_t>(file.path.size()) * sizeof(QChar));
+    }
+    for(const QString& subdir : listing.subdirectories) {
+        cost += sizeof(QString) + (static_cast<size_t>(subdir.size()) * sizeof(QChar));
+    }
+    return cost;
+}
+} // namespace
+
+namespace Fooyin {
+struct DirectoryCache::Private
+{
+    QStringList fileExtensions;
+
+    std::mutex mutex;
+    LruCache<QString, Listing> listings;
+
+    Private(QStringList fileExtensions_, size_t budget)
+        : fileExtensions{std::move(fileExtensions_)}
+        , listings{budget}
+    { }
+
+    [[nodiscard]] Listing read(const QString& path, uint64_t modifiedTime) const
+    {
+        Listing listing{.path = path, .modifiedTime = modifiedTime, .files = {}, .subdirectories = {}};
+
+        const QDir dir{path};
+        const QDir::SortFlags sort{QDir::Name | QDir::IgnoreCase};
+
+        const QFileInfoList files = dir.entryInfoList(fileExtensions, QDir::Files, sort);
+        listing.files.reserve(files.size());
+        for(const QFileInfo& file : files) {
+            listing.files.push_back({file.absoluteFilePath(), file.size(), modifiedMSecs(file)});
+        }
+
+        const QFileInfoList subdirs = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, sort);
+        for(const QFileInfo& subdir : subdirs) {
+            listing.subdirectories.append(subdir.absoluteFilePath());
+        }
+
+        return listing;
+    }
+};
+
+DirectoryCache::DirectoryCache(QStringList fileExtensions, size_t budget)
+    : p{std::make_unique<Private>(std::move(fileExtensions), budget)}
+{ }
+
+DirectoryCache::~DirectoryCache() = default;
+
+QStringList DirectoryCache::fileExtensions() const
+{
+    return p->fileExtensions;
+}
+
+DirectoryCache::Listing DirectoryCache::listing(const QString& directory)
+{
+    const QFileInfo info{directory};
+    if(!info.isDir()) {
+        invalidate(directory);
+        return {};
+    }
+
+    const QString path          = info.absoluteFilePath();
+    const uint64_t modifiedTime = modifiedMSecs(info);
+
+    {
+        const std::scoped_lock lock{p->mutex};
+        if(const auto* cached = p->listings.find(path); cached && cached->modifiedTime == modifiedTime) {
+            return *cached;
+        }
+    }
+
+    Listing listing = p->read(path, modifiedTime);
+
+    if(QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(modifiedTime) > RacyWindowMSecs) {
+        const std::scoped_lock lock{p->mutex};
+        p->listings.insert(path, listing, listingCost(listing));
+    }
+
+    return listing;
+}
+
+bool DirectoryCache::walk(const QString& directory, bool recursive, const ListingCallback& callback)
+{
+    std::deque<QString> pending{directory};
+    // Symlinked directories lead to the same place under a different path, so are only visited once
+    std::unordered_set<QString> visited;
+
+    while(!pending.empty()) {
+        const QString path = std::move(pending.front());
+        pending.pop_front();
+
+        if(recursive && !visited.emplace(QFileInfo{path}.canonicalFilePath()).second) {
+            continue;
+        }
+
+        const Listing dirListing = listing(path);
+        if(dirListing.path.isEmpty()) {
+            continue;
+        }
+
+        if(!callback(dirListing)) {
+            return false;
+        }
+
+        if(recursive) {
+            pending.insert(pending.end(), dirListing.subdirectories.cbegin(), dirListing.subdirectories.cend());
+        }
+    }
+
+    return true;
+}
+
+QStringList DirectoryCache::files(const QString& directory, bool recursive)
+{
+    QStringList paths;
+
+    walk(directory, recursive, [&paths](const Listing& dirListing) {
+        for(const auto& file : dirListing.files) {
+            paths.append(file.path);
+        }
+        return true;
+    });
+
+    return paths;
+}
+
+void DirectoryCache::invalidate(const QString& directory)
+{
+    const std::scoped_lock lock{p->mutex};
+    p->listings.remove(QFileInfo{directory}.absoluteFilePath());
+}
+
+void DirectoryCache::clear()
+{
+    const std::scoped_lock lock{p->mutex};
+    p->listings.clear();
+}
+} // namespace Fooyin
@@ -0,0 +1,139 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/fft.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+namespace {
+using Complex = std::complex<float>;
+
+// std::complex multiplication checks for infinities and NaNs, which keeps it from being vectorised
+Complex multiply(Complex lhs, Complex rhs)
+{
+    return {(lhs.real() * rhs.real()) - (lhs.imag() * rhs.imag()),
+            (lhs.real() * rhs.imag()) + (lhs.imag() * rhs.real())};
+}
+
+Complex unitRoot(double fraction)
+{
+    const double angle = -2.0 * std::numbers::pi * fraction;
+    return {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+}
+} // namespace
+
+namespace Fooyin {
+RealFft::RealFft(int size)
+    : m_size{static_cast<int>(std::bit_ceil(static_cast<unsigned>(std::max(size, 4))))}
+{
+    const int half = m_size / 2;
+    const int bits = std::countr_zero(static_cast<unsigned>(half));
+
+    m_buffer.resize(half);
+    m_spectrum.resize(half + 1);
+
+    m_bitReversed.resize(half);
+    for(int i{0}; i < half; ++i) {
+        int reversed{0};
+        for(int bit{0}; bit < bits; ++bit) {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        m_bitReversed[i] = reversed;
+    }
+
+    m_twiddles.resize(std::max(half / 2, 1));
+    for(int i{0}; std::cmp_less(i, m_twiddles.size()); ++i) {
+        m_twiddles[i] = unitRoot(static_cast<double>(i) / half);
+    }
+
+    // -i * e^(-2πik/n), which combines the spectra of the even and odd samples
+    m_splitTwiddles.resize(half + 1);
+    for(int k{0}; k <= half; ++k) {
+        m_splitTwiddles[k] = multiply(unitRoot(static_cast<double>(k) / m_size), {0.0F, -1.0F});
+    }
+}
+
+int RealFft::size() const
+{
+    return m_size;
+}
+
+int RealFft::binCount() const
+{
+    return (m_size / 2) + 1;
+}
+
+void RealFft::transform(std::span<const float> input, std::span<std::complex<float>> output)
+{
+    if(std::ssize(input) < m_size || std::ssize(output) < binCount()) {
+        return;
+    }
+
+    const int half = m_size / 2;
+
+    // Pairs of samples become one complex value, in bit-reversed order
+    for(int k{0}; k < half; ++k) {
+        m_buffer[m_bitReversed[k]] = {input[2 * k], input[(2 * k) + 1]};
+    }
+
+    for(int length{2}; length <= half; length <<= 1) {
+        const int halfLength = length / 2;
+        const int stride     = half / length;
+
+        for(int start{0}; start < half; start += length) {
+            Complex* lower = m_buffer.data() + start;
+            Complex* upper = lower + halfLength;
+            for(int j{0}; j < halfLength; ++j) {
+                const Complex a = lower[j];
+                const Complex b = multiply(upper[j], m_twiddles[j * stride]);
+                lower[j]        = a + b;
+                upper[j]        = a - b;
+            }
+        }
+    }
+
+    // Z[k] holds the spectrum of the even samples plus i times that of the odd samples
+    for(int k{0}; k <= half; ++k) {
+        const Complex zk   = m_buffer[k == half ? 0 : k];
+        const Complex zn   = std::conj(m_buffer[k == 0 ? 0 : half - k]);
+        const Complex even = (zk + zn) * 0.5F;
+        const Complex odd  = (zk - zn) * 0.5F;
+        output[k]          = even + multiply(m_splitTwiddles[k], odd);
+    }
+}
+
+void RealFft::magnitudes(std::span<const float> input, std::span<float> output)
+{
+    if(std::ssize(output) < binCount()) {
+        return;
+    }
+
+    transform(input, m_spectrum);
+
+    const float scale = 2.0F / static_cast<float>(m_size);
+    for(int k{0}; k < binCount(); ++k) {
+        const Complex bin = m_spectrum[k];
+        output[k]         = std::sqrt((bin.real() * bin.real()) + (bin.imag() * bin.imag())) * scale;
+    }
+}
+} // namespace Fooyin
@@ -23,6 +23,96 @@
 #include <QDir>
 #include <QFile>
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/sysmacros.h>
+#include <sys/vfs.h>
+#endif
+
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+// Matches file names against QDir-style name filters, handling the common "*.ext" case without globbing
+class NameFilter
+{
+public:
+    explicit NameFilter(const QStringList& filters)
+    {
+        for(const QString& filter : filters) {
+            const QString suffix = filter.startsWith(u"*.") ? filter.mid(2) : QString{};
+            if(!suffix.isEmpty() && !suffix.contains(u'*') && !suffix.contains(u'?') && !suffix.contains(u'[')) {
+                m_suffixes.append(suffix.toLower());
+            }
+            else {
+                m_patterns.append(filter);
+            }
+        }
+        m_matchAll = filters.isEmpty();
+    }
+
+    [[nodiscard]] bool matches(const QString& name) const
+    {
+        if(m_matchAll) {
+            return true;
+        }
+
+        const auto dot = name.lastIndexOf(u'.');
+        if(dot >= 0 && m_suffixes.contains(name.sliced(dot + 1).toLower())) {
+            return true;
+        }
+
+        return !m_patterns.isEmpty() && QDir::match(m_patterns, name);
+    }
+
+private:
+    QStringList m_suffixes;
+    QStringList m_patterns;
+    bool m_matchAll{false};
+};
+
+uint64_t modifiedMSecs(const struct stat& info)
+{
+    return (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000)
+         + (static_cast<uint64_t>(info.st_mtim.tv_nsec) / 1000000);
+}
+
+#if defined(__linux__)
+bool isNetworkType(const struct statfs& info)
+{
+    switch(static_cast<uint32_t>(info.f_type)) {
+        case(0x6969):     // NFS
+        case(0x517B):     // SMB
+        case(0xFE534D42): // SMB2
+        case(0xFF534D42): // CIFS
+        case(0x65735546): // FUSE (sshfs, rclone etc.)
+            return true;
+        default:
+            return false;
+    }
+}
+#endif
+
+bool isRotational([[maybe_unused]] dev_t device)
+{
+#if defined(__linux__)
+    // Partitions don't have a queue of their own, so fall back to that of their disk
+    const auto blockPath = QStringLiteral("/sys/dev/block/%1:%2/").arg(major(device)).arg(minor(device));
+    for(const auto& queuePath : {QStringLiteral("queue/rotational"), QStringLiteral("../queue/rotational")}) {
+        QFile file{blockPath + queuePath};
+        if(file.open(QIODevice::ReadOnly)) {
+            return file.read(1) == "1";
+        }
+    }
+#endif
+    return false;
+}
+} // namespace
+
 namespace Fooyin::Utils::File {
 QString cleanPath(const QString& path)
 {
@@ -85,6 +175,37 @@ QString getParentDirectory(const QString& filename)
     return (index > 0) ? cleanPath(cleaned.left(index)) : QDir::rootPath();
 }
 
+StorageDevice storageDevice(const QString& path)
+{
+    const QByteArray encodedPath = QFile::encodeName(path);
+
+    struct stat info;
+    if(::stat(encodedPath.constData(), &info) != 0) {
+        return {};
+    }
+
+    StorageDevice device{.id = static_cast<int64_t>(info.st_dev)};
+
+#if defined(__linux__)
+    struct statfs fsInfo;
+    device.network = ::statfs(encodedPath.constData(), &fsInfo) == 0 && isNetworkType(fsInfo);
+#endif
+    // Network filesystems have no local disk to seek
+    device.rotational = !device.network && isRotational(info.st_dev);
+
+    return device;
+}
+
+bool isNetworkFilesystem([[maybe_unused]] int fd)
+{
+#if defined(__linux__)
+    struct statfs info;
+    return ::fstatfs(fd, &info) == 0 && isNetworkType(info);
+#else
+    return false;
+#endif
+}
+
 bool createDirectories(const QString& path)
 {
     return QDir().mkpath(path);
@@ -129,6 +250,104 @@ QStringList getFilesInDirRecursive(const QDir& baseDirectory, const QStringList&
     return ret;
 }
 
+bool findFilesRecursive(const QString& directory, const QStringList& fileExtensions,
+                        const FileEntryCallback& callback, const DirectoryCallback& directoryCallback)
+{
+    const NameFilter filter{fileExtensions};
+
+    struct Entry
+    {
+        QByteArray name;
+        unsigned char type;
+    };
+    std::vector<Entry> entries;
+
+    // Identified by device and inode so symlink loops can't be followed forever
+    std::set<std::pair<dev_t, ino_t>> visited;
+    std::vector<QByteArray> stack{QFile::encodeName(QDir::cleanPath(directory))};
+
+    while(!stack.empty()) {
+        const QByteArray dirPath = std::move(stack.back());
+        stack.pop_back();
+
+        DIR* dir = ::opendir(dirPath.constData());
+        if(!dir) {
+            continue;
+        }
+
+        const int dirFd = ::dirfd(dir);
+
+        struct stat dirInfo;
+        if(::fstat(dirFd, &dirInfo) != 0 || !visited.emplace(dirInfo.st_dev, dirInfo.st_ino).second) {
+            ::closedir(dir);
+            continue;
+        }
+
+        // Read in full first, so the directory callback knows the entry count
+        entries.clear();
+        while(const dirent* entry = ::readdir(dir)) {
+            const char* name = entry->d_name;
+            if(name[0] == '.') {
+                // Also skips . and ..
+                continue;
+            }
+            entries.push_back({QByteArray{name}, entry->d_type});
+        }
+
+        DirectoryAction action{DirectoryAction::Visit};
+        if(directoryCallback) {
+            action = directoryCallback(
+                {QFile::decodeName(dirPath), modifiedMSecs(dirInfo), static_cast<int>(entries.size())});
+            if(action == DirectoryAction::Stop) {
+                ::closedir(dir);
+                return false;
+            }
+        }
+        const bool reportFiles = action == DirectoryAction::Visit;
+
+        for(const auto& [name, type] : entries) {
+            const QByteArray entryPath = dirPath.endsWith('/') ? dirPath + name : dirPath + '/' + name;
+
+            // Only links and filesystems which don't report the type need a stat before we know what this is
+            if(type == DT_DIR) {
+                stack.push_back(entryPath);
+                continue;
+            }
+
+            const bool knownFile = type == DT_REG;
+            if(!knownFile && type != DT_LNK && type != DT_UNKNOWN) {
+                continue;
+            }
+
+            const bool matches = reportFiles && filter.matches(QFile::decodeName(name));
+            if(knownFile && !matches) {
+                continue;
+            }
+
+            struct stat info;
+            if(::fstatat(dirFd, name.constData(), &info, 0) != 0) {
+                continue;
+            }
+
+            if(S_ISDIR(info.st_mode)) {
+                stack.push_back(entryPath);
+            }
+            else if(S_ISREG(info.st_mode) && matches) {
+                const FileEntry file{QFile::decodeName(entryPath), static_cast<int64_t>(info.st_size),
+                                     modifiedMSecs(info)};
+                if(!callback(file)) {
+                    ::closedir(dir);
+                    return false;
+                }
+            }
+        }
+
+        ::closedir(dir);
+    }
+
+    return true;
+}
+
 QList<QUrl> getUrlsInDir(const QDir& baseDirectory, const QStringList& fileExtensions)
 {
     QList<QUrl> ret;
@@ -0,0 +1,179 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/memoryusage.h>
+
+#include <QFile>
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+constexpr auto PressurePath = "/proc/pressure/memory";
+
+namespace {
+struct Source
+{
+    int id;
+    QString name;
+    Fooyin::MemoryUsage::UsageFunc usage;
+    Fooyin::MemoryUsage::TrimFunc trim;
+    Fooyin::MemoryUsage::TrimPriority priority;
+};
+
+struct Registry
+{
+    std::vector<Source> sources;
+    int nextId{0};
+};
+
+Registry& registry()
+{
+    static Registry sources;
+    return sources;
+}
+
+void releaseFreeMemory()
+{
+#if defined(__GLIBC__)
+    // Freed blocks otherwise stay with the allocator, so the process never appears to shrink
+    ::malloc_trim(0);
+#endif
+}
+} // namespace
+
+namespace Fooyin::MemoryUsage {
+int addSource(const QString& name, UsageFunc usage, TrimFunc trim, TrimPriority priority)
+{
+    auto& reg = registry();
+
+    const int id = reg.nextId++;
+    reg.sources.push_back({id, name, std::move(usage), std::move(trim), priority});
+
+    return id;
+}
+
+void removeSource(int id)
+{
+    std::erase_if(registry().sources, [id](const Source& source) { return source.id == id; });
+}
+
+ReportList report()
+{
+    ReportList reports;
+
+    for(const Source& source : registry().sources) {
+        auto it = std::ranges::find(reports, source.name, &Report::name);
+        if(it == reports.end()) {
+            it = reports.insert(reports.end(), Report{.name = source.name});
+        }
+
+        const Usage usage = source.usage();
+        it->usage.bytes += usage.bytes;
+        it->usage.entries += usage.entries;
+        it->trimmable = it->trimmable || static_cast<bool>(source.trim);
+    }
+
+    return reports;
+}
+
+size_t total()
+{
+    size_t bytes{0};
+    for(const Source& source : registry().sources) {
+        bytes += source.usage().bytes;
+    }
+    return bytes;
+}
+
+size_t trim(size_t target)
+{
+    // Copied, as trimming may add or remove sources
+    std::vector<Source> trimmable;
+    std::ranges::copy_if(registry().sources, std::back_inserter(trimmable),
+                         [](const Source& source) { return static_cast<bool>(source.trim); });
+    std::ranges::stable_sort(trimmable, {}, &Source::priority);
+
+    size_t current = total();
+    size_t freed{0};
+
+    for(const Source& source : trimmable) {
+        if(current <= target) {
+            break;
+        }
+
+        const size_t before = source.usage().bytes;
+        source.trim();
+        const size_t after = source.usage().bytes;
+
+        if(after < before) {
+            freed += before - after;
+            current -= before - after;
+        }
+    }
+
+    releaseFreeMemory();
+
+    return freed;
+}
+
+std::optional<double> pressure()
+{
+    QFile file{QString::fromLatin1(PressurePath)};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    const QByteArray line = file.readLine();
+    if(!line.startsWith("some ")) {
+        return {};
+    }
+
+    const QList<QByteArray> fields = line.simplified().split(' ');
+    for(const QByteArray& field : fields) {
+        if(field.startsWith("avg10=")) {
+            bool ok{false};
+            const double value = field.mid(6).toDouble(&ok);
+            if(ok) {
+                return value;
+            }
+        }
+    }
+
+    return {};
+}
+
+size_t stringBytes(const QString& str)
+{
+    return static_cast<size_t>(str.capacity()) * sizeof(QChar);
+}
+
+size_t stringBytes(const QStringList& strings)
+{
+    size_t bytes = static_cast<size_t>(strings.capacity()) * sizeof(QString);
+    for(const QString& str : strings) {
+        bytes += stringBytes(str);
+    }
+    return bytes;
+}
+} // namespace Fooyin::MemoryUsage
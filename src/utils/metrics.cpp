@@ -0,0 +1,227 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/metrics.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+constexpr auto MicrosPerSecond = 1000000.0;
+
+namespace {
+template <typename T>
+struct Entry
+{
+    const char* help;
+    std::unique_ptr<T> metric;
+};
+
+// Sorted by name, so each export lists metrics in the same order
+template <typename T>
+using EntryMap = std::map<std::string_view, Entry<T>>;
+
+struct Collector
+{
+    int id;
+    Fooyin::Metrics::CollectFunc collect;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    EntryMap<Fooyin::Metrics::Counter> counters;
+    EntryMap<Fooyin::Metrics::Gauge> gauges;
+    EntryMap<Fooyin::Metrics::LatencyHistogram> histograms;
+    std::vector<Collector> collectors;
+    int nextId{0};
+};
+
+Registry& registry()
+{
+    static Registry metrics;
+    return metrics;
+}
+
+template <typename T>
+T& findOrAdd(EntryMap<T>& entries, const char* name, const char* help)
+{
+    const std::scoped_lock lock{registry().mutex};
+
+    auto it = entries.find(name);
+    if(it == entries.end()) {
+        it = entries.emplace(name, Entry<T>{help, std::make_unique<T>()}).first;
+    }
+    return *it->second.metric;
+}
+
+QByteArray formatValue(double value)
+{
+    return QByteArray::number(value, 'g', 12);
+}
+
+void writeHeader(QByteArray& out, const QByteArray& name, const char* type, const QByteArray& help)
+{
+    out += "# TYPE " + name + ' ' + type + '\n';
+    if(!help.isEmpty()) {
+        out += "# HELP " + name + ' ' + help + '\n';
+    }
+}
+
+void writeHistogram(QByteArray& out, const QByteArray& name, const Fooyin::Metrics::LatencyHistogram& histogram)
+{
+    using Fooyin::Metrics::LatencyHistogram;
+
+    // Read each bucket once, so the cumulative counts stay consistent with each other while being recorded to
+    uint64_t cumulative{0};
+    for(size_t bucket{0}; bucket < LatencyHistogram::BucketCount - 1; ++bucket) {
+        cumulative += histogram.bucketCount(bucket);
+        // Values are whole microseconds, so everything below 2^i is at most 2^i - 1
+        const uint64_t upper = bucket == 0 ? 0 : (uint64_t{1} << bucket) - 1;
+        out += name + "_bucket{le=\"" + formatValue(static_cast<double>(upper) / MicrosPerSecond) + "\"} "
+             + QByteArray::number(cumulative) + '\n';
+    }
+    cumulative += histogram.bucketCount(LatencyHistogram::BucketCount - 1);
+
+    out += name + "_bucket{le=\"+Inf\"} " + QByteArray::number(cumulative) + '\n';
+    out += name + "_sum " + formatValue(static_cast<double>(histogram.sum()) / MicrosPerSecond) + '\n';
+    out += name + "_count " + QByteArray::number(cumulative) + '\n';
+}
+
+void writeSamples(QByteArray& out, const Fooyin::Metrics::SampleList& samples)
+{
+    using Fooyin::Metrics::Type;
+
+    std::vector<bool> written(samples.size(), false);
+
+    for(size_t i{0}; i < samples.size(); ++i) {
+        if(written[i]) {
+            continue;
+        }
+
+        const auto& first      = samples[i];
+        const QByteArray name  = first.name.toUtf8();
+        const bool isCounter   = first.type == Type::Counter;
+        const QByteArray value = isCounter ? name + "_total" : name;
+
+        writeHeader(out, name, isCounter ? "counter" : "gauge", first.help.toUtf8());
+
+        for(size_t j{i}; j < samples.size(); ++j) {
+            const auto& sample = samples[j];
+            if(written[j] || sample.name != first.name) {
+                continue;
+            }
+            written[j] = true;
+
+            out += value;
+            if(!sample.labels.isEmpty()) {
+                out += '{' + sample.labels.toUtf8() + '}';
+            }
+            out += ' ' + formatValue(sample.value) + '\n';
+        }
+    }
+}
+} // namespace
+
+namespace Fooyin::Metrics {
+Counter& counter(const char* name, const char* help)
+{
+    return findOrAdd(registry().counters, name, help);
+}
+
+Gauge& gauge(const char* name, const char* help)
+{
+    return findOrAdd(registry().gauges, name, help);
+}
+
+LatencyHistogram& histogram(const char* name, const char* help)
+{
+    return findOrAdd(registry().histograms, name, help);
+}
+
+int addCollector(CollectFunc collect)
+{
+    auto& reg = registry();
+    const std::scoped_lock lock{reg.mutex};
+
+    const int id = reg.nextId++;
+    reg.collectors.push_back({id, std::move(collect)});
+
+    return id;
+}
+
+void removeCollector(int id)
+{
+    auto& reg = registry();
+    const std::scoped_lock lock{reg.mutex};
+
+    std::erase_if(reg.collectors, [id](const Collector& collector) { return collector.id == id; });
+}
+
+QString label(const QString& key, const QString& value)
+{
+    QString escaped{value};
+    escaped.replace(u'\\', QStringLiteral("\\\\"));
+    escaped.replace(u'"', QStringLiteral("\\\""));
+    escaped.replace(u'\n', QStringLiteral("\\n"));
+
+    return key + QStringLiteral("=\"") + escaped + u'"';
+}
+
+QByteArray openMetrics()
+{
+    auto& reg = registry();
+
+    QByteArray out;
+    std::vector<Collector> collectors;
+
+    {
+        const std::scoped_lock lock{reg.mutex};
+
+        for(const auto& [name, entry] : reg.counters) {
+            const QByteArray metricName = QByteArray{name.data(), static_cast<qsizetype>(name.size())};
+            writeHeader(out, metricName, "counter", entry.help);
+            out += metricName + "_total " + QByteArray::number(entry.metric->value()) + '\n';
+        }
+        for(const auto& [name, entry] : reg.gauges) {
+            const QByteArray metricName = QByteArray{name.data(), static_cast<qsizetype>(name.size())};
+            writeHeader(out, metricName, "gauge", entry.help);
+            out += metricName + ' ' + formatValue(entry.metric->value()) + '\n';
+        }
+        for(const auto& [name, entry] : reg.histograms) {
+            const QByteArray metricName = QByteArray{name.data(), static_cast<qsizetype>(name.size())};
+            writeHeader(out, metricName, "histogram", entry.help);
+            writeHistogram(out, metricName, *entry.metric);
+        }
+
+        // Called without the lock, as collectors may register metrics of their own
+        collectors = reg.collectors;
+    }
+
+    SampleList samples;
+    for(const auto& collector : collectors) {
+        collector.collect(samples);
+    }
+    writeSamples(out, samples);
+
+    out += "# EOF\n";
+    return out;
+}
+} // namespace Fooyin::Metrics
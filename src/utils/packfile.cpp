@@ -0,0 +1,362 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <utils/packfile.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+constexpr char Magic[]            = "FYPACK01";
+constexpr int64_t MagicSize       = sizeof(Magic) - 1;
+constexpr int64_t HeaderSize      = sizeof(uint16_t) + sizeof(uint32_t);
+constexpr int64_t MaxKeySize      = std::numeric_limits<uint16_t>::max();
+constexpr int64_t CompactMinWaste = 4 * 1024 * 1024;
+
+namespace {
+QByteArray recordHeader(uint16_t keySize, uint32_t dataSize)
+{
+    QByteArray header(HeaderSize, Qt::Uninitialized);
+    qToLittleEndian(keySize, header.data());
+    qToLittleEndian(dataSize, header.data() + sizeof(uint16_t));
+    return header;
+}
+} // namespace
+
+namespace Fooyin {
+struct PackFile::Private
+{
+    struct Record
+    {
+        int64_t offset{0};
+        uint32_t size{0};
+        // Header and key included
+        int64_t totalSize{0};
+    };
+
+    QString filepath;
+    QFile file;
+    std::unordered_map<QString, Record> index;
+    int64_t wasted{0};
+    mutable std::mutex mutex;
+
+    explicit Private(const QString& filepath_)
+        : filepath{filepath_}
+        , file{filepath_}
+    { }
+
+    bool reset()
+    {
+        index.clear();
+        wasted = 0;
+
+        if(!file.resize(0) || !file.seek(0)) {
+            return false;
+        }
+        return file.write(Magic, MagicSize) == MagicSize && file.flush();
+    }
+
+    void dropRecord(const QString& key)
+    {
+        const auto it = index.find(key);
+        if(it != index.end()) {
+            wasted += it->second.totalSize;
+            index.erase(it);
+        }
+    }
+
+    bool readIndex()
+    {
+        const int64_t fileSize = file.size();
+
+        if(fileSize < MagicSize || file.read(MagicSize) != QByteArray::fromRawData(Magic, MagicSize)) {
+            return reset();
+        }
+
+        int64_t pos{MagicSize};
+        while(pos + HeaderSize <= fileSize) {
+            const QByteArray header = file.read(HeaderSize);
+            if(header.size() != HeaderSize) {
+                break;
+            }
+
+            const auto keySize  = qFromLittleEndian<uint16_t>(header.constData());
+            const auto dataSize = qFromLittleEndian<uint32_t>(header.constData() + sizeof(uint16_t));
+            const int64_t total = HeaderSize + keySize + static_cast<int64_t>(dataSize);
+            if(pos + total > fileSize) {
+                break;
+            }
+
+            const QString key = QString::fromUtf8(file.read(keySize));
+            dropRecord(key);
+
+            if(dataSize == 0) {
+                // Removal marker
+                wasted += total;
+            }
+            else {
+                index[key] = {.offset = pos + HeaderSize + keySize, .size = dataSize, .totalSize = total};
+            }
+
+            pos += total;
+            if(!file.seek(pos)) {
+                break;
+            }
+        }
+
+        if(pos < fileSize) {
+            qDebug() << "[PackFile] Discarding incomplete record in" << filepath;
+            if(!file.resize(pos)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool append(const QString& key, const QByteArray& data)
+    {
+        const QByteArray keyData = key.toUtf8();
+        if(keyData.isEmpty() || keyData.size() > MaxKeySize) {
+            return false;
+        }
+
+        const int64_t pos = file.size();
+        if(!file.seek(pos)) {
+            return false;
+        }
+
+        QByteArray record = recordHeader(static_cast<uint16_t>(keyData.size()), static_cast<uint32_t>(data.size()));
+        record.append(keyData);
+        record.append(data);
+
+        if(file.write(record) != record.size() || !file.flush()) {
+            qWarning() << "[PackFile] Failed to write to" << filepath << file.errorString();
+            file.resize(pos);
+            return false;
+        }
+
+        dropRecord(key);
+
+        if(data.isEmpty()) {
+            wasted += record.size();
+        }
+        else {
+            index[key] = {.offset    = pos + HeaderSize + keyData.size(),
+                          .size      = static_cast<uint32_t>(data.size()),
+                          .totalSize = record.size()};
+        }
+
+        return true;
+    }
+
+    QByteArray read(const Record& record)
+    {
+        if(!file.seek(record.offset)) {
+            return {};
+        }
+
+        QByteArray data = file.read(record.size);
+        if(data.size() != static_cast<qsizetype>(record.size)) {
+            return {};
+        }
+        return data;
+    }
+
+    bool compact()
+    {
+        QSaveFile output{filepath};
+        if(!output.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+
+        output.write(Magic, MagicSize);
+
+        std::unordered_map<QString, Record> compacted;
+        int64_t pos{MagicSize};
+
+        for(const auto& [key, record] : index) {
+            const QByteArray data = read(record);
+            if(data.isEmpty()) {
+                continue;
+            }
+
+            const QByteArray keyData = key.toUtf8();
+            output.write(recordHeader(static_cast<uint16_t>(keyData.size()), record.size));
+            output.write(keyData);
+            output.write(data);
+
+            compacted[key]
+                = {.offset = pos + HeaderSize + keyData.size(), .size = record.size, .totalSize = record.totalSize};
+            pos += record.totalSize;
+        }
+
+        file.close();
+
+        const bool committed = output.commit();
+        if(!file.open(QIODevice::ReadWrite)) {
+            index.clear();
+            return false;
+        }
+
+        if(committed) {
+            index  = std::move(compacted);
+            wasted = 0;
+        }
+
+        return committed;
+    }
+};
+
+PackFile::PackFile(const QString& filepath)
+    : p{std::make_unique<Private>(filepath)}
+{ }
+
+PackFile::~PackFile() = default;
+
+QString PackFile::filepath() const
+{
+    return p->filepath;
+}
+
+bool PackFile::open()
+{
+    const std::scoped_lock lock{p->mutex};
+
+    if(p->file.isOpen()) {
+        return true;
+    }
+
+    const QFileInfo info{p->filepath};
+    if(!QDir{}.mkpath(info.absolutePath())) {
+        return false;
+    }
+
+    if(!p->file.open(QIODevice::ReadWrite)) {
+        qWarning() << "[PackFile] Failed to open" << p->filepath << p->file.errorString();
+        return false;
+    }
+
+    p->index.clear();
+    p->wasted = 0;
+
+    if(!p->readIndex()) {
+        p->file.close();
+        return false;
+    }
+
+    if(p->wasted > CompactMinWaste && p->wasted > p->file.size() / 2) {
+        p->compact();
+    }
+
+    return p->file.isOpen();
+}
+
+void PackFile::close()
+{
+    const std::scoped_lock lock{p->mutex};
+
+    p->file.close();
+    p->index.clear();
+    p->wasted = 0;
+}
+
+bool PackFile::isOpen() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->file.isOpen();
+}
+
+bool PackFile::contains(const QString& key) const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->index.contains(key);
+}
+
+QByteArray PackFile::value(const QString& key) const
+{
+    const std::scoped_lock lock{p->mutex};
+
+    const auto it = p->index.find(key);
+    if(it == p->index.cend()) {
+        return {};
+    }
+
+    return p->read(it->second);
+}
+
+bool PackFile::insert(const QString& key, const QByteArray& data)
+{
+    if(data.isEmpty() || data.size() > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    const std::scoped_lock lock{p->mutex};
+    return p->file.isOpen() && p->append(key, data);
+}
+
+bool PackFile::remove(const QString& key)
+{
+    const std::scoped_lock lock{p->mutex};
+
+    if(!p->file.isOpen() || !p->index.contains(key)) {
+        return false;
+    }
+
+    return p->append(key, {});
+}
+
+bool PackFile::clear()
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->file.isOpen() && p->reset();
+}
+
+int PackFile::count() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return static_cast<int>(p->index.size());
+}
+
+int64_t PackFile::size() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->file.isOpen() ? p->file.size() : 0;
+}
+
+int64_t PackFile::wastedSize() const
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->wasted;
+}
+
+bool PackFile::compact()
+{
+    const std::scoped_lock lock{p->mutex};
+    return p->file.isOpen() && p->compact();
+}
+} // namespace Fooyin
@@ -0,0 +1,163 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <utils/savescheduler.h>
+
+#include <QBasicTimer>
+#include <QTimerEvent>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace Fooyin {
+struct SaveScheduler::Private
+{
+    struct Target
+    {
+        std::chrono::milliseconds delay;
+        SaveFunc func;
+        bool dirty{false};
+        Clock::time_point due;
+    };
+
+    SaveScheduler* self;
+    std::vector<Target> targets;
+    QBasicTimer timer;
+
+    explicit Private(SaveScheduler* self_)
+        : self{self_}
+    { }
+
+    [[nodiscard]] bool isValid(int id) const
+    {
+        return id >= 0 && std::cmp_less(id, targets.size());
+    }
+
+    void save(Target& target)
+    {
+        // Cleared first, so a save which changes state again schedules itself rather than being lost
+        target.dirty = false;
+        target.func();
+    }
+
+    // Runs the timer until the earliest dirty target is due, or stops it if nothing is dirty
+    void schedule()
+    {
+        timer.stop();
+
+        auto next = Clock::time_point::max();
+        for(const Target& target : targets) {
+            if(target.dirty) {
+                next = std::min(next, target.due);
+            }
+        }
+
+        if(next == Clock::time_point::max()) {
+            return;
+        }
+
+        const auto remaining
+            = std::max<int64_t>(0, std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now()).count());
+        // Coarse, so the wakeup can share the system's own
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+        timer.start(std::chrono::milliseconds{remaining}, Qt::CoarseTimer, self);
+#else
+        timer.start(static_cast<int>(remaining), Qt::CoarseTimer, self);
+#endif
+    }
+};
+
+SaveScheduler::SaveScheduler(QObject* parent)
+    : QObject{parent}
+    , p{std::make_unique<Private>(this)}
+{ }
+
+SaveScheduler::~SaveScheduler() = default;
+
+int SaveScheduler::addTarget(int delayMs, SaveFunc func)
+{
+    p->targets.push_back({std::chrono::milliseconds{std::max(0, delayMs)}, std::move(func)});
+    return static_cast<int>(p->targets.size()) - 1;
+}
+
+void SaveScheduler::markDirty(int id)
+{
+    if(!p->isValid(id)) {
+        return;
+    }
+
+    auto& target = p->targets.at(static_cast<size_t>(id));
+    if(target.dirty) {
+        // Already scheduled, and later changes don't push the save back
+        return;
+    }
+
+    target.dirty = true;
+    target.due   = Clock::now() + target.delay;
+    p->schedule();
+}
+
+bool SaveScheduler::isDirty(int id) const
+{
+    return p->isValid(id) && p->targets.at(static_cast<size_t>(id)).dirty;
+}
+
+void SaveScheduler::flush(int id)
+{
+    if(!isDirty(id)) {
+        return;
+    }
+
+    p->save(p->targets.at(static_cast<size_t>(id)));
+    p->schedule();
+}
+
+void SaveScheduler::flushAll()
+{
+    for(auto& target : p->targets) {
+        if(target.dirty) {
+            p->save(target);
+        }
+    }
+    p->schedule();
+}
+
+void SaveScheduler::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() != p->timer.timerId()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    const auto now = Clock::now();
+    for(auto& target : p->targets) {
+        if(target.dirty && target.due <= now) {
+            p->save(target);
+        }
+    }
+    p->schedule();
+}
+} // namespace Fooyin
+
+#include "utils/moc_savescheduler.cpp"
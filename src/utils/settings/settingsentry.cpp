@@ -32,7 +32,11 @@ SettingsEntry::SettingsEntry(QString key, const QVariant& value, Settings::Type
     , m_defaultValue{value}
     , m_isTemporary{false}
     , m_wasChanged{false}
-{ }
+    , m_unsaved{false}
+    , m_scalar{0}
+{
+    publish();
+}
 
 QString SettingsEntry::key() const
 {
@@ -64,10 +68,22 @@ bool SettingsEntry::wasChanged() const
     return m_wasChanged;
 }
 
+bool SettingsEntry::isUnsaved() const
+{
+    return m_unsaved;
+}
+
+void SettingsEntry::markSaved()
+{
+    m_unsaved = false;
+}
+
 bool SettingsEntry::setValue(const QVariant& value)
 {
     if(std::exchange(m_value, value) != value) {
         m_wasChanged = true;
+        m_unsaved    = true;
+        publish();
         return true;
     }
 
@@ -76,7 +92,12 @@ bool SettingsEntry::setValue(const QVariant& value)
 
 bool SettingsEntry::setValueSilently(const QVariant& value)
 {
-    return std::exchange(m_value, value) != value;
+    if(std::exchange(m_value, value) != value) {
+        publish();
+        return true;
+    }
+
+    return false;
 }
 
 void SettingsEntry::setIsTemporary(bool isTemporary)
@@ -113,7 +134,36 @@ void SettingsEntry::notifySubscribers()
 
 bool SettingsEntry::reset()
 {
-    return std::exchange(m_value, m_defaultValue) != m_defaultValue;
+    if(std::exchange(m_value, m_defaultValue) != m_defaultValue) {
+        // Reset settings are removed from file rather than written
+        m_unsaved = false;
+        publish();
+        return true;
+    }
+
+    return false;
+}
+
+void SettingsEntry::publish()
+{
+    switch(m_type) {
+        case(Settings::Bool):
+            m_scalar.store(m_value.toBool() ? 1 : 0, std::memory_order_relaxed);
+            return;
+        case(Settings::Int):
+            m_scalar.store(std::bit_cast<uint64_t>(static_cast<int64_t>(m_value.toInt())), std::memory_order_relaxed);
+            return;
+        case(Settings::Double):
+            m_scalar.store(std::bit_cast<uint64_t>(m_value.toDouble()), std::memory_order_relaxed);
+            return;
+        case(Settings::Variant):
+        case(Settings::String):
+        case(Settings::StringList):
+        case(Settings::ByteArray):
+            break;
+    }
+
+    std::atomic_store_explicit(&m_published, std::make_shared<const QVariant>(m_value), std::memory_order_release);
 }
 } // namespace Fooyin
 
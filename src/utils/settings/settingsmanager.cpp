@@ -21,17 +21,28 @@
 
 #include <utils/settings/settingsdialogcontroller.h>
 
+#include <QDebug>
 #include <QSettings>
 
+#include <map>
 #include <ranges>
+#include <string>
 
 namespace Fooyin {
 SettingsManager::SettingsManager(const QString& settingsPath, QObject* parent)
     : QObject{parent}
     , m_settingsFile{new QSettings(settingsPath, QSettings::IniFormat, this)}
+    , m_fileModified{false}
     , m_settingsDialog{nullptr}
 { }
 
+SettingsManager::~SettingsManager()
+{
+    for(auto& table : m_slotTables) {
+        delete table.load(std::memory_order_relaxed);
+    }
+}
+
 void SettingsManager::createSettingsDialog(QMainWindow* mainWindow)
 {
     m_settingsDialog = new SettingsDialogController(this, mainWindow);
@@ -45,8 +56,14 @@ SettingsDialogController* SettingsManager::settingsDialog() const
 
 bool SettingsManager::settingsHaveChanged() const
 {
+    if(m_fileModified) {
+        return true;
+    }
+
+    const std::shared_lock lock(m_lock);
+
     return std::ranges::any_of(m_settings, [](const auto& setting) {
-        return setting.second && setting.second->wasChanged() && !setting.second->isTemporary();
+        return setting.second && setting.second->isUnsaved() && !setting.second->isTemporary();
     });
 }
 
@@ -65,6 +82,7 @@ void SettingsManager::resetAllSettings()
     std::unique_lock lock(m_lock);
 
     m_settingsFile->clear();
+    m_fileModified = true;
 
     std::vector<SettingsEntry*> resetSettings;
     for(SettingsEntry* setting : m_settings | std::views::values) {
@@ -78,6 +96,8 @@ void SettingsManager::resetAllSettings()
     for(SettingsEntry* setting : resetSettings) {
         setting->notifySubscribers();
     }
+
+    emit settingsModified();
 }
 
 QVariant SettingsManager::value(const QString& key) const
@@ -111,6 +131,7 @@ bool SettingsManager::set(const QString& key, const QVariant& value)
 
     if(success) {
         setting->notifySubscribers();
+        emit settingsModified();
     }
 
     return success;
@@ -133,6 +154,7 @@ bool SettingsManager::reset(const QString& key)
     if(success) {
         fileRemove(setting->key());
         setting->notifySubscribers();
+        emit settingsModified();
     }
 
     return success;
@@ -157,6 +179,8 @@ bool SettingsManager::fileSet(const QString& key, const QVariant& value)
     }
 
     m_settingsFile->setValue(key, value);
+    m_fileModified = true;
+    emit settingsModified();
     return true;
 }
 
@@ -167,7 +191,13 @@ bool SettingsManager::fileContains(const QString& key) const
 
 void SettingsManager::fileRemove(const QString& key)
 {
+    if(!m_settingsFile->contains(key)) {
+        return;
+    }
+
     m_settingsFile->remove(key);
+    m_fileModified = true;
+    emit settingsModified();
 }
 
 void SettingsManager::createSetting(const QString& key, const QVariant& value)
@@ -196,6 +226,45 @@ void SettingsManager::createTempSetting(const QString& key, const QVariant& valu
     setting->setIsTemporary(true);
 }
 
+size_t SettingsManager::enumIndex(const char* enumName)
+{
+    static std::mutex mutex;
+    static std::map<std::string, size_t> indexes;
+
+    const std::scoped_lock lock{mutex};
+
+    const auto [index, inserted] = indexes.emplace(enumName, indexes.size());
+    if(inserted && index->second >= MaxSettingEnums) {
+        qWarning() << "Too many setting enums registered; values of" << enumName << "will not be found";
+    }
+
+    return index->second;
+}
+
+void SettingsManager::addSlot(size_t table, size_t slot, SettingsEntry* setting)
+{
+    if(table >= MaxSettingEnums) {
+        return;
+    }
+
+    // Tables are only added under the write lock, so a relaxed load is enough here
+    SlotTable* slotTable = m_slotTables[table].load(std::memory_order_relaxed);
+    if(!slotTable) {
+        slotTable = new SlotTable{};
+        m_slotTables[table].store(slotTable, std::memory_order_release);
+    }
+
+    slotTable->entries[slot].store(setting, std::memory_order_release);
+}
+
+SettingsEntry* SettingsManager::findEntry(const QString& mapKey) const
+{
+    const std::shared_lock lock(m_lock);
+
+    const auto it = m_settings.find(mapKey);
+    return it != m_settings.end() ? it->second : nullptr;
+}
+
 bool SettingsManager::settingExists(const QString& key) const
 {
     return std::ranges::any_of(m_settings,
@@ -219,22 +288,31 @@ void SettingsManager::checkLoadSetting(SettingsEntry* setting) const
 
 void SettingsManager::saveSettings(bool onlyChanged)
 {
-    const std::shared_lock lock(m_lock);
+    std::unique_lock lock(m_lock);
 
+    bool written{false};
     for(const auto& [key, setting] : m_settings) {
-        if(setting && (!onlyChanged || setting->wasChanged()) && !setting->isTemporary()) {
+        if(setting && (!onlyChanged || setting->isUnsaved()) && !setting->isTemporary()) {
             const auto keyString = setting->key();
             if(!keyString.isEmpty()) {
                 m_settingsFile->setValue(keyString, setting->value());
+                written = true;
             }
+            setting->markSaved();
         }
     }
 
+    lock.unlock();
+
     if(m_settingsDialog) {
         m_settingsDialog->saveState();
     }
 
-    m_settingsFile->sync();
+    // Syncing re-reads the file even when there's nothing to write, so it's skipped when nothing changed
+    const bool fileModified = m_fileModified.exchange(false);
+    if(written || fileModified) {
+        m_settingsFile->sync();
+    }
 }
 } // namespace Fooyin
 
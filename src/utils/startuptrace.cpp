@@ -0,0 +1,349 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/startuptrace.h>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
+
+// Width of the phase column in the summary
+constexpr int NameWidth = 40;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+enum class Phase : uint8_t
+{
+    Complete,
+    Instant,
+    Async,
+};
+
+struct Event
+{
+    Phase phase;
+    const char* name;
+    int thread{0};
+    int endThread{0};
+    int64_t start{0};
+    int64_t duration{0};
+    uint64_t id{0};
+    bool unfinished{false};
+};
+
+struct Tracer
+{
+    std::mutex mutex;
+    QString path;
+    Clock::time_point origin;
+    // Incremented on enable so threads seen by an earlier trace are named again
+    int generation{0};
+    std::vector<Event> events;
+    // Async id -> index of its event
+    std::unordered_map<uint64_t, size_t> running;
+    std::vector<QString> threadNames;
+    uint64_t nextId{1};
+};
+
+std::atomic<bool> Enabled{false};
+
+Tracer& tracer()
+{
+    static Tracer instance;
+    return instance;
+}
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - tracer().origin).count();
+}
+
+// Must be called with the tracer locked
+int threadIndex()
+{
+    struct ThreadId
+    {
+        int generation{-1};
+        int index{0};
+    };
+    thread_local ThreadId id;
+
+    Tracer& trace = tracer();
+    if(id.generation != trace.generation) {
+        id.generation = trace.generation;
+        id.index      = static_cast<int>(trace.threadNames.size());
+
+        QString name = QThread::currentThread()->objectName();
+        if(name.isEmpty()) {
+            name = id.index == 0 ? QStringLiteral("Main") : QStringLiteral("Thread %1").arg(id.index);
+        }
+        trace.threadNames.push_back(name);
+    }
+
+    return id.index;
+}
+
+void record(Event event)
+{
+    Tracer& trace = tracer();
+    const std::scoped_lock lock{trace.mutex};
+
+    event.thread    = threadIndex();
+    event.endThread = event.thread;
+    trace.events.push_back(event);
+}
+
+QJsonObject traceEvent(const Event& event, const char* phase, int thread, int64_t timestamp)
+{
+    return {{QStringLiteral("name"), QString::fromLatin1(event.name)},
+            {QStringLiteral("cat"), QStringLiteral("startup")},
+            {QStringLiteral("ph"), QString::fromLatin1(phase)},
+            {QStringLiteral("ts"), static_cast<qint64>(timestamp)},
+            {QStringLiteral("pid"), static_cast<qint64>(QCoreApplication::applicationPid())},
+            {QStringLiteral("tid"), thread}};
+}
+
+QByteArray toJson(const Tracer& trace)
+{
+    QJsonArray events;
+
+    for(size_t i{0}; i < trace.threadNames.size(); ++i) {
+        QJsonObject thread = traceEvent({.phase = Phase::Instant, .name = "thread_name"}, "M", static_cast<int>(i), 0);
+        thread.insert(QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), trace.threadNames.at(i)}});
+        events.append(thread);
+    }
+
+    for(const Event& event : trace.events) {
+        switch(event.phase) {
+            case(Phase::Complete): {
+                QJsonObject complete = traceEvent(event, "X", event.thread, event.start);
+                complete.insert(QStringLiteral("dur"), static_cast<qint64>(event.duration));
+                events.append(complete);
+                break;
+            }
+            case(Phase::Instant): {
+                QJsonObject instant = traceEvent(event, "i", event.thread, event.start);
+                instant.insert(QStringLiteral("s"), QStringLiteral("t"));
+                events.append(instant);
+                break;
+            }
+            case(Phase::Async): {
+                const QString id = QString::number(event.id, 16);
+
+                QJsonObject begin = traceEvent(event, "b", event.thread, event.start);
+                begin.insert(QStringLiteral("id"), id);
+                events.append(begin);
+
+                QJsonObject end = traceEvent(event, "e", event.endThread, event.start + event.duration);
+                end.insert(QStringLiteral("id"), id);
+                if(event.unfinished) {
+                    end.insert(QStringLiteral("args"), QJsonObject{{QStringLiteral("unfinished"), true}});
+                }
+                events.append(end);
+                break;
+            }
+        }
+    }
+
+    const QJsonObject root{{QStringLiteral("traceEvents"), events},
+                           {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}};
+    return QJsonDocument{root}.toJson(QJsonDocument::Compact);
+}
+
+QString toMs(int64_t us)
+{
+    return QString::number(static_cast<double>(us) / 1000.0, 'f', 1);
+}
+
+void printSummary(const Tracer& trace)
+{
+    std::vector<const Event*> phases;
+    for(const Event& event : trace.events) {
+        if(event.phase != Phase::Instant) {
+            phases.push_back(&event);
+        }
+    }
+    std::ranges::stable_sort(phases, {}, &Event::start);
+
+    const auto row = QStringLiteral("%1 %2 %3 %4");
+
+    qInfo().noquote() << "[Startup]"
+                      << row.arg(QStringLiteral("Phase"), -NameWidth)
+                             .arg(QStringLiteral("Thread"), -12)
+                             .arg(QStringLiteral("Start (ms)"), 12)
+                             .arg(QStringLiteral("Duration (ms)"), 14);
+
+    for(const Event* event : phases) {
+        QString duration = toMs(event->duration);
+        if(event->unfinished) {
+            duration.prepend(u'>');
+        }
+        qInfo().noquote() << "[Startup]"
+                          << row.arg(QString::fromLatin1(event->name), -NameWidth)
+                                 .arg(trace.threadNames.at(event->thread), -12)
+                                 .arg(toMs(event->start), 12)
+                                 .arg(duration, 14);
+    }
+}
+} // namespace
+
+namespace Fooyin::StartupTrace {
+void enable(const QString& path)
+{
+    Tracer& trace = tracer();
+    {
+        const std::scoped_lock lock{trace.mutex};
+
+        trace.path   = path;
+        trace.origin = Clock::now();
+        ++trace.generation;
+        trace.events.clear();
+        trace.running.clear();
+        trace.threadNames.clear();
+
+        // Names the calling thread first
+        threadIndex();
+    }
+
+    Enabled.store(true, std::memory_order_release);
+}
+
+bool isEnabled()
+{
+    return Enabled.load(std::memory_order_relaxed);
+}
+
+void instant(const char* name)
+{
+    if(!isEnabled()) {
+        return;
+    }
+
+    record({.phase = Phase::Instant, .name = name, .start = now()});
+}
+
+uint64_t beginAsync(const char* name)
+{
+    if(!isEnabled()) {
+        return 0;
+    }
+
+    Tracer& trace = tracer();
+    const std::scoped_lock lock{trace.mutex};
+
+    const uint64_t id = trace.nextId++;
+    trace.running.emplace(id, trace.events.size());
+    trace.events.push_back({.phase = Phase::Async, .name = name, .thread = threadIndex(), .start = now(), .id = id});
+
+    return id;
+}
+
+void endAsync(uint64_t id)
+{
+    if(id == 0 || !isEnabled()) {
+        return;
+    }
+
+    Tracer& trace = tracer();
+    const std::scoped_lock lock{trace.mutex};
+
+    const auto it = trace.running.find(id);
+    if(it == trace.running.cend()) {
+        return;
+    }
+
+    Event& event    = trace.events.at(it->second);
+    event.endThread = threadIndex();
+    event.duration  = now() - event.start;
+    trace.running.erase(it);
+}
+
+bool finish()
+{
+    if(!Enabled.exchange(false, std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    Tracer& trace = tracer();
+    const std::scoped_lock lock{trace.mutex};
+
+    const int64_t end = now();
+    for(const auto& index : trace.running | std::views::values) {
+        Event& event     = trace.events.at(index);
+        event.duration   = end - event.start;
+        event.unfinished = true;
+    }
+    trace.running.clear();
+
+    printSummary(trace);
+
+    bool written{false};
+    QFile file{trace.path};
+    if(file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        written = file.write(toJson(trace)) >= 0;
+    }
+
+    if(written) {
+        qInfo() << "[Startup] Trace written to" << trace.path;
+    }
+    else {
+        qWarning() << "[Startup] Unable to write trace to" << trace.path << file.errorString();
+    }
+
+    trace.events.clear();
+    trace.threadNames.clear();
+
+    return written;
+}
+
+Scope::Scope(const char* name)
+    : m_name{name}
+    , m_start{isEnabled() ? now() : -1}
+{ }
+
+Scope::~Scope()
+{
+    end();
+}
+
+void Scope::end()
+{
+    if(m_start < 0) {
+        return;
+    }
+
+    if(isEnabled()) {
+        record({.phase = Phase::Complete, .name = m_name, .start = m_start, .duration = now() - m_start});
+    }
+    m_start = -1;
+}
+} // namespace Fooyin::StartupTrace
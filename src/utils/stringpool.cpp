@@ -0,0 +1,125 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/stringpool.h>
+
+#include <utils/memoryusage.h>
+
+#include <QSet>
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <utility>
+
+// Spread over several locks so tag reader threads rarely wait on each other
+constexpr size_t ShardCount = 16;
+// Unreferenced strings are dropped whenever a shard doubles in size
+constexpr qsizetype InitialPruneSize = 1024;
+
+namespace {
+struct Shard
+{
+    std::mutex mutex;
+    QSet<QString> strings;
+    qsizetype pruneSize{InitialPruneSize};
+
+    void prune()
+    {
+        // Strings only the pool refers to can't be picked up again without taking the lock
+        strings.removeIf([](const QString& str) { return str.isDetached(); });
+        pruneSize = std::max(InitialPruneSize, strings.size() * 2);
+    }
+};
+
+std::array<Shard, ShardCount>& shards()
+{
+    static std::array<Shard, ShardCount> pool;
+    return pool;
+}
+} // namespace
+
+namespace Fooyin::StringPool {
+QString intern(const QString& str)
+{
+    if(str.isEmpty()) {
+        return str;
+    }
+
+    Shard& shard = shards()[qHash(str) % ShardCount];
+    const std::scoped_lock lock{shard.mutex};
+
+    if(const auto it = shard.strings.constFind(str); it != shard.strings.cend()) {
+        return *it;
+    }
+
+    if(shard.strings.size() >= shard.pruneSize) {
+        shard.prune();
+    }
+
+    return *shard.strings.insert(str);
+}
+
+QStringList intern(const QStringList& strings)
+{
+    QStringList interned;
+    interned.reserve(strings.size());
+
+    for(const QString& str : strings) {
+        interned.append(intern(str));
+    }
+
+    return interned;
+}
+
+qsizetype size()
+{
+    qsizetype count{0};
+
+    for(Shard& shard : shards()) {
+        const std::scoped_lock lock{shard.mutex};
+        count += shard.strings.size();
+    }
+
+    return count;
+}
+
+size_t memoryUsage()
+{
+    size_t bytes{0};
+
+    for(Shard& shard : shards()) {
+        const std::scoped_lock lock{shard.mutex};
+        bytes += static_cast<size_t>(shard.strings.capacity()) * sizeof(QString);
+        for(const QString& str : std::as_const(shard.strings)) {
+            bytes += MemoryUsage::stringBytes(str);
+        }
+    }
+
+    return bytes;
+}
+
+void prune()
+{
+    for(Shard& shard : shards()) {
+        const std::scoped_lock lock{shard.mutex};
+        shard.prune();
+    }
+}
+} // namespace Fooyin::StringPool
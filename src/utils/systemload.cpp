@@ -0,0 +1,109 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <utils/systemload.h>
+
+#include <QDir>
+#include <QFile>
+
+#include <thread>
+
+constexpr auto LoadAveragePath = "/proc/loadavg";
+constexpr auto IoPressurePath  = "/proc/pressure/io";
+constexpr auto PowerSupplyPath = "/sys/class/power_supply";
+
+namespace {
+QByteArray readLine(const QString& path)
+{
+    QFile file{path};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return file.readLine().trimmed();
+}
+} // namespace
+
+namespace Fooyin::SystemLoad {
+std::optional<double> loadPerCore()
+{
+    const auto cores = std::thread::hardware_concurrency();
+
+    // 0.52 0.58 0.59 1/467 12345
+    const QByteArray line = readLine(QString::fromLatin1(LoadAveragePath));
+    if(line.isEmpty() || cores == 0) {
+        return {};
+    }
+
+    bool ok{false};
+    const double load = line.split(' ').constFirst().toDouble(&ok);
+    if(!ok) {
+        return {};
+    }
+
+    return load / static_cast<double>(cores);
+}
+
+std::optional<double> ioPressure()
+{
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    const QByteArray line = readLine(QString::fromLatin1(IoPressurePath));
+    if(!line.startsWith("some ")) {
+        return {};
+    }
+
+    const QList<QByteArray> fields = line.simplified().split(' ');
+    for(const QByteArray& field : fields) {
+        if(field.startsWith("avg10=")) {
+            bool ok{false};
+            const double value = field.mid(6).toDouble(&ok);
+            if(ok) {
+                return value;
+            }
+        }
+    }
+
+    return {};
+}
+
+bool onBattery()
+{
+    const QDir supplies{QString::fromLatin1(PowerSupplyPath)};
+
+    bool discharging{false};
+    const QStringList names = supplies.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for(const QString& name : names) {
+        const QString path    = supplies.filePath(name);
+        const QByteArray type = readLine(path + QStringLiteral("/type"));
+
+        // Any adapter online means mains power, even while a battery reports otherwise
+        if(type == "Mains" && readLine(path + QStringLiteral("/online")) == "1") {
+            return false;
+        }
+
+        // Batteries of peripherals, e.g. a wireless mouse, don't power the system
+        if(type == "Battery" && readLine(path + QStringLiteral("/scope")) != "Device"
+           && readLine(path + QStringLiteral("/status")) == "Discharging") {
+            discharging = true;
+        }
+    }
+
+    return discharging;
+}
+} // namespace Fooyin::SystemLoad
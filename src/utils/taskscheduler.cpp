@@ -0,0 +1,338 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/taskscheduler.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// At least two, so background work never takes every thread
+constexpr auto MinThreads = 2;
+// Concurrent I/O tasks mostly contend for the same disk
+constexpr auto MaxIoTasks = 2;
+constexpr auto LaneCount  = 4;
+// How often idle work held at a gate checks whether it's been cancelled or the throttle has changed
+constexpr auto GatePollInterval = std::chrono::milliseconds{250};
+
+namespace Fooyin {
+namespace {
+struct TaskQueue
+{
+    std::mutex mutex;
+    std::array<std::deque<TaskScheduler::Task>, LaneCount> lanes;
+};
+
+// The scheduler and queue index of the current thread, if it belongs to one
+thread_local const void* currentScheduler{nullptr};
+thread_local size_t currentQueue{0};
+
+constexpr size_t laneIndex(TaskScheduler::Lane lane)
+{
+    return static_cast<size_t>(lane);
+}
+} // namespace
+
+struct TaskScheduler::Private
+{
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    TaskQueue shared;
+
+    std::array<int, LaneCount> limits{};
+    std::array<std::atomic<int>, LaneCount> running{};
+
+    std::atomic<Throttle> throttle{Throttle::None};
+    // Unthrottle guards alive
+    std::atomic<int> unthrottled{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    // Changed whenever a task is added or a lane has room again
+    uint64_t generation{0};
+    bool stopping{false};
+
+    std::vector<std::thread> threads;
+
+    void notify(bool all)
+    {
+        {
+            const std::scoped_lock lock{sleepMutex};
+            ++generation;
+        }
+        if(all) {
+            wake.notify_all();
+        }
+        else {
+            wake.notify_one();
+        }
+    }
+
+    [[nodiscard]] int idleLimit() const
+    {
+        if(unthrottled.load(std::memory_order_acquire) > 0) {
+            return -1;
+        }
+
+        switch(throttle.load(std::memory_order_acquire)) {
+            case(Throttle::Reduced):
+                return 1;
+            case(Throttle::Paused):
+                return 0;
+            case(Throttle::None):
+            default:
+                return -1;
+        }
+    }
+
+    [[nodiscard]] int limit(size_t lane) const
+    {
+        if(lane == laneIndex(Lane::Idle)) {
+            const int throttled = idleLimit();
+            if(throttled >= 0) {
+                return std::min(throttled, limits[lane]);
+            }
+        }
+        return limits[lane];
+    }
+
+    bool reserve(size_t lane)
+    {
+        const int laneLimit = limit(lane);
+
+        int count = running[lane].load(std::memory_order_relaxed);
+        while(count < laneLimit) {
+            if(running[lane].compare_exchange_weak(count, count + 1, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool take(TaskQueue& queue, size_t lane, bool newest, Task& task)
+    {
+        const std::scoped_lock lock{queue.mutex};
+
+        auto& tasks = queue.lanes[lane];
+        if(tasks.empty()) {
+            return false;
+        }
+
+        if(newest) {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+        }
+        else {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        return true;
+    }
+
+    bool findTask(size_t index, Task& task, size_t& lane)
+    {
+        for(lane = 0; lane < LaneCount; ++lane) {
+            if(!reserve(lane)) {
+                continue;
+            }
+
+            // Our own newest task first, as its data is most likely still cached
+            if(take(*queues[index], lane, true, task) || take(shared, lane, false, task)) {
+                return true;
+            }
+
+            for(size_t offset{1}; offset < queues.size(); ++offset) {
+                if(take(*queues[(index + offset) % queues.size()], lane, false, task)) {
+                    return true;
+                }
+            }
+
+            running[lane].fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        return false;
+    }
+
+    void runThread(size_t index)
+    {
+        currentScheduler = this;
+        currentQueue     = index;
+
+        while(true) {
+            uint64_t seen{0};
+            {
+                const std::scoped_lock lock{sleepMutex};
+                if(stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+
+            Task task;
+            size_t lane{0};
+            if(findTask(index, task, lane)) {
+                task();
+                task = {};
+
+                running[lane].fetch_sub(1, std::memory_order_acq_rel);
+                if(limits[lane] < limits[laneIndex(Lane::Interactive)]) {
+                    // A thread may be sleeping on a task this lane had no room for
+                    notify(true);
+                }
+                continue;
+            }
+
+            std::unique_lock lock{sleepMutex};
+            wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+        }
+    }
+};
+
+TaskScheduler::TaskScheduler(int threadCount)
+    : p{std::make_unique<Private>()}
+{
+    if(threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threadCount = std::max(threadCount, MinThreads);
+
+    p->limits[laneIndex(Lane::Interactive)] = threadCount;
+    p->limits[laneIndex(Lane::Background)]  = threadCount - 1;
+    p->limits[laneIndex(Lane::IO)]          = std::min(threadCount - 1, MaxIoTasks);
+    p->limits[laneIndex(Lane::Idle)]        = threadCount - 1;
+
+    p->queues.reserve(threadCount);
+    for(int i{0}; i < threadCount; ++i) {
+        p->queues.emplace_back(std::make_unique<TaskQueue>());
+    }
+
+    p->threads.reserve(threadCount);
+    for(int i{0}; i < threadCount; ++i) {
+        p->threads.emplace_back([this, i]() { p->runThread(static_cast<size_t>(i)); });
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        const std::scoped_lock lock{p->sleepMutex};
+        p->stopping = true;
+    }
+    p->wake.notify_all();
+
+    for(auto& thread : p->threads) {
+        thread.join();
+    }
+}
+
+TaskScheduler* TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+    return &scheduler;
+}
+
+int TaskScheduler::threadCount() const
+{
+    return static_cast<int>(p->threads.size());
+}
+
+int TaskScheduler::laneLimit(Lane lane) const
+{
+    return p->limits[laneIndex(lane)];
+}
+
+TaskScheduler::Throttle TaskScheduler::throttle() const
+{
+    return p->throttle.load(std::memory_order_acquire);
+}
+
+void TaskScheduler::setThrottle(Throttle throttle)
+{
+    if(p->throttle.exchange(throttle, std::memory_order_acq_rel) != throttle) {
+        // Held tasks may now have room
+        p->notify(true);
+    }
+}
+
+int TaskScheduler::idleLimit() const
+{
+    return p->idleLimit();
+}
+
+void TaskScheduler::submit(Lane lane, Task task)
+{
+    TaskQueue& queue = currentScheduler == p.get() ? *p->queues[currentQueue] : p->shared;
+    {
+        const std::scoped_lock lock{queue.mutex};
+        queue.lanes[laneIndex(lane)].push_back(std::move(task));
+    }
+    p->notify(false);
+}
+
+TaskScheduler::Unthrottle::Unthrottle(TaskScheduler* scheduler)
+    : m_scheduler{scheduler}
+{
+    m_scheduler->p->unthrottled.fetch_add(1, std::memory_order_acq_rel);
+    m_scheduler->p->notify(true);
+}
+
+TaskScheduler::Unthrottle::~Unthrottle()
+{
+    m_scheduler->p->unthrottled.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+IdleGate::IdleGate(TaskScheduler* scheduler)
+    : m_scheduler{scheduler}
+    , m_running{0}
+{ }
+
+bool IdleGate::acquire(const std::function<bool()>& cancelled)
+{
+    std::unique_lock lock{m_mutex};
+
+    while(true) {
+        const int limit = m_scheduler->idleLimit();
+        if(limit < 0 || m_running < limit) {
+            ++m_running;
+            return true;
+        }
+
+        if(cancelled && cancelled()) {
+            return false;
+        }
+
+        // Changes to the throttle aren't signalled here, so they're noticed on the next poll
+        m_released.wait_for(lock, GatePollInterval);
+    }
+}
+
+void IdleGate::release()
+{
+    {
+        const std::scoped_lock lock{m_mutex};
+        --m_running;
+    }
+    m_released.notify_one();
+}
+} // namespace Fooyin
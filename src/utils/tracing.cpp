@@ -0,0 +1,300 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/tracing.h>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Spans kept per thread, about 200KB each
+constexpr size_t BufferSize = 8192;
+// Buffers of threads which have exited are kept for the next dump, up to this many
+constexpr size_t MaxFinishedBuffers = 16;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Fields are atomic so a dump can read slots the owning thread is overwriting
+struct Slot
+{
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> duration{0};
+};
+
+struct ThreadBuffer
+{
+    int index{0};
+    QString name;
+    std::atomic<bool> finished{false};
+    // Total spans written; only the last BufferSize are still held
+    std::atomic<uint64_t> head{0};
+    std::array<Slot, BufferSize> slots;
+};
+using ThreadBufferPtr = std::shared_ptr<ThreadBuffer>;
+
+struct Tracer
+{
+    std::mutex mutex;
+    // In microseconds since the clock's epoch, read by every span so it isn't guarded by the mutex
+    std::atomic<int64_t> origin{0};
+    // Incremented on start so threads register a new buffer
+    std::atomic<int> generation{0};
+    std::vector<ThreadBufferPtr> buffers;
+    int nextIndex{0};
+};
+
+std::atomic<bool> Recording{false};
+
+Tracer& tracer()
+{
+    static Tracer instance;
+    return instance;
+}
+
+int64_t clockMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+int64_t now()
+{
+    return clockMicros() - tracer().origin.load(std::memory_order_relaxed);
+}
+
+ThreadBufferPtr registerThread()
+{
+    auto buffer = std::make_shared<ThreadBuffer>();
+
+    Tracer& trace = tracer();
+    const std::scoped_lock lock{trace.mutex};
+
+    buffer->index = trace.nextIndex++;
+    buffer->name  = QThread::currentThread()->objectName();
+    if(buffer->name.isEmpty()) {
+        const auto* app = QCoreApplication::instance();
+        buffer->name    = app && QThread::currentThread() == app->thread()
+                            ? QStringLiteral("Main")
+                            : QStringLiteral("Thread %1").arg(buffer->index);
+    }
+
+    const auto isFinished = [](const ThreadBufferPtr& existing) {
+        return existing->finished.load(std::memory_order_relaxed);
+    };
+
+    // Drops the oldest, as their spans are the least likely to still be of interest
+    auto excess = std::ranges::count_if(trace.buffers, isFinished) - static_cast<std::ptrdiff_t>(MaxFinishedBuffers);
+    std::erase_if(trace.buffers, [&isFinished, &excess](const ThreadBufferPtr& existing) {
+        return excess > 0 && isFinished(existing) && excess-- > 0;
+    });
+    trace.buffers.push_back(buffer);
+
+    return buffer;
+}
+
+ThreadBuffer& threadBuffer()
+{
+    struct ThreadState
+    {
+        int generation{-1};
+        ThreadBufferPtr buffer;
+
+        ~ThreadState()
+        {
+            if(buffer) {
+                buffer->finished.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+    thread_local ThreadState state;
+
+    const int generation = tracer().generation.load(std::memory_order_acquire);
+    if(state.generation != generation) {
+        if(state.buffer) {
+            state.buffer->finished.store(true, std::memory_order_relaxed);
+        }
+        state.generation = generation;
+        state.buffer     = registerThread();
+    }
+
+    return *state.buffer;
+}
+
+void record(const char* name, int64_t start, int64_t duration)
+{
+    ThreadBuffer& buffer = threadBuffer();
+
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    Slot& slot          = buffer.slots[head % BufferSize];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+QJsonObject traceEvent(const QString& name, const char* phase, int thread, int64_t timestamp)
+{
+    return {{QStringLiteral("name"), name},
+            {QStringLiteral("cat"), QStringLiteral("fooyin")},
+            {QStringLiteral("ph"), QString::fromLatin1(phase)},
+            {QStringLiteral("ts"), static_cast<qint64>(timestamp)},
+            {QStringLiteral("pid"), static_cast<qint64>(QCoreApplication::applicationPid())},
+            {QStringLiteral("tid"), thread}};
+}
+
+void appendBuffer(QJsonArray& events, const ThreadBuffer& buffer)
+{
+    QJsonObject thread = traceEvent(QStringLiteral("thread_name"), "M", buffer.index, 0);
+    thread.insert(QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), buffer.name}});
+    events.append(thread);
+
+    const uint64_t head  = buffer.head.load(std::memory_order_acquire);
+    const uint64_t first = head > BufferSize ? head - BufferSize : 0;
+
+    struct Copied
+    {
+        const char* name;
+        int64_t start;
+        int64_t duration;
+    };
+    std::vector<Copied> copied;
+    copied.reserve(static_cast<size_t>(head - first));
+
+    for(uint64_t i{first}; i < head; ++i) {
+        const Slot& slot = buffer.slots[i % BufferSize];
+        copied.push_back({slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                          slot.duration.load(std::memory_order_relaxed)});
+    }
+
+    // Slots the thread wrapped around to while they were copied may mix two spans, so they're dropped
+    const uint64_t newHead   = buffer.head.load(std::memory_order_acquire);
+    const uint64_t overwrite = newHead > BufferSize ? newHead - BufferSize : 0;
+    const size_t skip        = overwrite > first ? std::min(static_cast<size_t>(overwrite - first), copied.size()) : 0;
+
+    for(size_t i{skip}; i < copied.size(); ++i) {
+        const auto& span = copied.at(i);
+        if(!span.name) {
+            continue;
+        }
+        QJsonObject complete = traceEvent(QString::fromLatin1(span.name), "X", buffer.index, span.start);
+        complete.insert(QStringLiteral("dur"), static_cast<qint64>(span.duration));
+        events.append(complete);
+    }
+}
+} // namespace
+
+namespace Fooyin::Tracing {
+bool isAvailable()
+{
+#if defined(FOOYIN_TRACING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void start()
+{
+    if(!isAvailable()) {
+        qWarning() << "[Tracing] Tracing isn't available, as fooyin was built without BUILD_TRACING";
+        return;
+    }
+
+    Tracer& trace = tracer();
+    {
+        const std::scoped_lock lock{trace.mutex};
+        trace.origin.store(clockMicros(), std::memory_order_relaxed);
+        trace.buffers.clear();
+        trace.nextIndex = 0;
+        trace.generation.fetch_add(1, std::memory_order_release);
+    }
+
+    Recording.store(true, std::memory_order_release);
+    qInfo() << "[Tracing] Recording spans";
+}
+
+void stop()
+{
+    Recording.store(false, std::memory_order_release);
+}
+
+bool isRecording()
+{
+    return Recording.load(std::memory_order_relaxed);
+}
+
+bool dump(const QString& path)
+{
+    Tracer& trace = tracer();
+
+    std::vector<ThreadBufferPtr> buffers;
+    {
+        const std::scoped_lock lock{trace.mutex};
+        buffers = trace.buffers;
+    }
+
+    if(buffers.empty()) {
+        qWarning() << "[Tracing] No spans have been recorded";
+        return false;
+    }
+
+    QJsonArray events;
+    for(const auto& buffer : buffers) {
+        appendBuffer(events, *buffer);
+    }
+
+    const QJsonObject root{{QStringLiteral("traceEvents"), events},
+                           {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}};
+
+    QFile file{path};
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+       || file.write(QJsonDocument{root}.toJson(QJsonDocument::Compact)) < 0) {
+        qWarning() << "[Tracing] Unable to write trace to" << path << file.errorString();
+        return false;
+    }
+
+    qInfo() << "[Tracing] Trace written to" << path;
+    return true;
+}
+
+Span::Span(const char* name)
+    : m_name{name}
+    , m_start{isRecording() ? now() : -1}
+{ }
+
+Span::~Span()
+{
+    if(m_start >= 0 && isRecording()) {
+        record(m_name, m_start, now() - m_start);
+    }
+}
+} // namespace Fooyin::Tracing
@@ -19,13 +19,48 @@
 
 #include <utils/worker.h>
 
+#include <utils/tracing.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
 namespace Fooyin {
+struct Worker::TaskQueue
+{
+    TaskScheduler::Lane lane{TaskScheduler::Lane::Background};
+
+    std::mutex mutex;
+    std::condition_variable idle;
+    struct Task
+    {
+        std::function<void()> func;
+        uint64_t generation{0};
+    };
+    std::deque<Task> tasks;
+    // Whether a task is running or submitted to the scheduler
+    bool active{false};
+};
+
 Worker::Worker(QObject* parent)
     : QObject{parent}
     , m_state{Idle}
     , m_closing{false}
+    , m_generation{0}
+    , m_jobGeneration{0}
+    , m_tasks{std::make_unique<TaskQueue>()}
 { }
 
+Worker::~Worker()
+{
+    {
+        const std::scoped_lock lock{m_tasks->mutex};
+        m_tasks->tasks.clear();
+    }
+    waitForTasks();
+}
+
 void Worker::initialiseThread()
 {
     m_closing.store(false, std::memory_order_release);
@@ -44,6 +79,57 @@ void Worker::pauseThread()
 void Worker::closeThread()
 {
     m_closing.store(true, std::memory_order_release);
+
+    const std::scoped_lock lock{m_tasks->mutex};
+    m_tasks->tasks.clear();
+}
+
+void Worker::schedule(std::function<void()> task)
+{
+    TaskScheduler::Lane lane;
+    {
+        const std::scoped_lock lock{m_tasks->mutex};
+        m_tasks->tasks.push_back({std::move(task), m_generation.load(std::memory_order_relaxed)});
+        if(std::exchange(m_tasks->active, true)) {
+            return;
+        }
+        lane = m_tasks->lane;
+    }
+
+    TaskScheduler::instance()->submit(lane, [this]() { runNextTask(); });
+}
+
+void Worker::startJob(std::function<void()> task)
+{
+    {
+        const std::scoped_lock lock{m_tasks->mutex};
+        m_tasks->tasks.clear();
+        // Under the lock, so every task queued after this belongs to the new job
+        m_generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    schedule(std::move(task));
+}
+
+void Worker::waitForTasks()
+{
+    // A throttled lane could otherwise hold back the very task being waited on
+    const TaskScheduler::Unthrottle unthrottle{TaskScheduler::instance()};
+
+    std::unique_lock lock{m_tasks->mutex};
+    m_tasks->idle.wait(lock, [this]() { return !m_tasks->active; });
+}
+
+TaskScheduler::Lane Worker::lane() const
+{
+    const std::scoped_lock lock{m_tasks->mutex};
+    return m_tasks->lane;
+}
+
+void Worker::setLane(TaskScheduler::Lane lane)
+{
+    const std::scoped_lock lock{m_tasks->mutex};
+    m_tasks->lane = lane;
 }
 
 Worker::State Worker::state() const
@@ -58,13 +144,60 @@ void Worker::setState(State state)
 
 bool Worker::mayRun() const
 {
-    return state() == Running && !closing();
+    return state() == Running && !closing()
+        && m_jobGeneration.load(std::memory_order_relaxed) == m_generation.load(std::memory_order_acquire);
 }
 
 bool Worker::closing() const
 {
     return m_closing.load(std::memory_order_acquire);
 }
+
+uint64_t Worker::jobGeneration() const
+{
+    return m_jobGeneration.load(std::memory_order_relaxed);
+}
+
+bool Worker::isCurrent(uint64_t generation) const
+{
+    return generation == m_generation.load(std::memory_order_acquire);
+}
+
+void Worker::runNextTask()
+{
+    TaskQueue::Task task;
+    {
+        const std::scoped_lock lock{m_tasks->mutex};
+        if(m_tasks->tasks.empty()) {
+            m_tasks->active = false;
+            m_tasks->idle.notify_all();
+            return;
+        }
+        task = std::move(m_tasks->tasks.front());
+        m_tasks->tasks.pop_front();
+    }
+
+    m_jobGeneration.store(task.generation, std::memory_order_relaxed);
+    {
+        // Named after the worker, as moc's class names are static
+        FY_TRACE_SCOPE(metaObject()->className());
+        task.func();
+    }
+
+    TaskScheduler::Lane lane;
+    {
+        const std::scoped_lock lock{m_tasks->mutex};
+        if(m_tasks->tasks.empty()) {
+            m_tasks->active = false;
+            m_tasks->idle.notify_all();
+            return;
+        }
+        lane = m_tasks->lane;
+    }
+
+    // One task per submission, so a busy worker doesn't hold a thread from the rest of its lane
+    TaskScheduler::instance()->submit(lane, [this]() { runNextTask(); });
+}
 } // namespace Fooyin
 
 #include "utils/moc_worker.cpp"
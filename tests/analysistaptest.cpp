@@ -0,0 +1,149 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/engine/analysistap.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+constexpr auto SampleRate = 48000;
+// Frames per write in the threaded test
+constexpr auto WriteFrames = 256;
+
+std::vector<float> ramp(float first, int frames, int channels)
+{
+    std::vector<float> samples(static_cast<size_t>(frames * channels));
+    for(int frame{0}; frame < frames; ++frame) {
+        std::fill_n(samples.begin() + (frame * channels), channels, first + static_cast<float>(frame));
+    }
+    return samples;
+}
+
+const std::byte* bytes(const std::vector<float>& samples)
+{
+    return reinterpret_cast<const std::byte*>(samples.data());
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(AnalysisTapTest, EmptyUntilWritten)
+{
+    AnalysisTap tap;
+    std::vector<float> data(64);
+
+    EXPECT_FALSE(tap.format().isValid());
+    EXPECT_FALSE(tap.read(data, 32).isValid());
+}
+
+TEST(AnalysisTapTest, ReadsAudioHeardAtTime)
+{
+    const AudioFormat format{SampleFormat::Float, SampleRate, 2};
+    const auto start = AnalysisTap::Clock::now();
+
+    AnalysisTap tap;
+    const auto samples = ramp(0.0F, 4800, 2);
+    tap.write(format, bytes(samples), 4800, start);
+
+    std::vector<float> data(200);
+
+    // 50ms in, the last frame heard is frame 2400
+    const auto result = tap.read(data, 100, start + 50ms);
+    ASSERT_EQ(result, format);
+    EXPECT_FLOAT_EQ(data.front(), 2300.0F);
+    EXPECT_FLOAT_EQ(data.back(), 2399.0F);
+
+    // Long after the end, only what has been written is returned
+    tap.read(data, 100, start + 1s);
+    EXPECT_FLOAT_EQ(data.back(), 4799.0F);
+
+    // Before enough audio has been heard, the start is padded with silence
+    tap.read(data, 100, start + 1ms);
+    EXPECT_FLOAT_EQ(data.front(), 0.0F);
+    EXPECT_FLOAT_EQ(data.at(2 * 52), 0.0F);
+    EXPECT_FLOAT_EQ(data.back(), 47.0F);
+}
+
+TEST(AnalysisTapTest, ConvertsAndRestartsOnFormatChange)
+{
+    const AudioFormat format{SampleFormat::S16, SampleRate, 1};
+    const auto start = AnalysisTap::Clock::now();
+
+    AnalysisTap tap;
+    const std::vector<int16_t> samples(AnalysisTap::Capacity * 2, 16384);
+    tap.write(format, reinterpret_cast<const std::byte*>(samples.data()), static_cast<int>(samples.size()), start);
+
+    std::vector<float> data(AnalysisTap::Capacity);
+    ASSERT_TRUE(tap.read(data, AnalysisTap::Capacity, start + 1h).isValid());
+    EXPECT_TRUE(std::ranges::all_of(data, [](float sample) { return std::abs(sample - 0.5F) < 1e-4F; }));
+
+    tap.clear();
+    const AudioFormat stereo{SampleFormat::Float, SampleRate, 2};
+    const auto next = ramp(1.0F, 10, 2);
+    tap.write(stereo, bytes(next), 10, start);
+
+    EXPECT_EQ(tap.read(data, 20, start + 1h), stereo);
+    EXPECT_FLOAT_EQ(data.at(19), 0.0F);
+    EXPECT_FLOAT_EQ(data.at(20), 1.0F);
+    EXPECT_FLOAT_EQ(data.at(39), 10.0F);
+}
+
+TEST(AnalysisTapTest, ReadsAreNeverTorn)
+{
+    const AudioFormat format{SampleFormat::Float, SampleRate, 2};
+    AnalysisTap tap;
+    std::atomic<bool> done{false};
+
+    std::thread writer{[&]() {
+        auto samples = ramp(0.0F, WriteFrames, 2);
+        for(int i{0}; i < 20000; ++i) {
+            tap.write(format, bytes(samples), WriteFrames, AnalysisTap::Clock::now());
+            std::ranges::for_each(samples, [](float& sample) { sample += WriteFrames; });
+        }
+        done = true;
+    }};
+
+    std::vector<float> data(2048 * 2);
+    int reads{0};
+    while(!done) {
+        if(!tap.read(data, 2048, AnalysisTap::Clock::now() + 1h).isValid()) {
+            continue;
+        }
+        ++reads;
+
+        // Every read is a contiguous run of the stream, with both channels from the same frame
+        for(size_t i{2}; i < data.size(); i += 2) {
+            ASSERT_EQ(data[i], data[i + 1]);
+            if(data[i - 2] != 0.0F) {
+                ASSERT_EQ(data[i], data[i - 2] + 1.0F);
+            }
+        }
+    }
+    writer.join();
+
+    EXPECT_GT(reads, 0);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,73 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audiobufferpool.h"
+
+#include <core/engine/audiobuffer.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace Fooyin::Testing {
+TEST(AudioBufferTest, WrapsExternalData)
+{
+    const AudioFormat format{SampleFormat::S16, 1000, 2};
+    auto owner = std::make_shared<std::vector<std::byte>>(16, std::byte{1});
+
+    AudioBuffer buffer{std::span<const std::byte>{*owner}, owner, format, 10};
+    EXPECT_TRUE(buffer.isExternal());
+    EXPECT_EQ(4, buffer.frameCount());
+    EXPECT_EQ(owner->data(), buffer.constData().data());
+
+    const AudioBuffer slice = buffer.slice(4, 8);
+    EXPECT_TRUE(slice.isExternal());
+    EXPECT_EQ(owner->data() + 4, slice.constData().data());
+    EXPECT_EQ(11, slice.startTime());
+
+    // Modifying the buffer copies the data rather than writing through to the owner
+    buffer.scale(0.5);
+    EXPECT_FALSE(buffer.isExternal());
+    EXPECT_EQ(std::byte{1}, owner->front());
+}
+
+TEST(AudioBufferTest, StorageIsReused)
+{
+    const AudioFormat format{SampleFormat::S16, 44100, 2};
+
+    const auto allocate = [&format]() {
+        AudioBuffer buffer{format, 0};
+        buffer.resize(10000);
+        AudioBuffer copy{buffer};
+        copy.detach();
+    };
+
+    // Warm up the pool
+    allocate();
+
+    const auto before = AudioBufferPool::instance().stats();
+    for(int i{0}; i < 100; ++i) {
+        allocate();
+    }
+    const auto after = AudioBufferPool::instance().stats();
+
+    EXPECT_EQ(before.misses, after.misses);
+    EXPECT_GT(after.hits, before.hits);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,164 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audiofingerprint.h"
+#include "core/library/fingerprintindex.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+// A sequence of tones changing every 200ms, with the same notes for the same seed
+std::vector<float> melody(int sampleRate, int channels, uint32_t seed, double gain, int seconds)
+{
+    const int frames     = sampleRate * seconds;
+    const int noteFrames = sampleRate / 5;
+
+    std::vector<float> samples(static_cast<size_t>(frames * channels));
+    double frequency{0.0};
+    double phase{0.0};
+
+    for(int i{0}; i < frames; ++i) {
+        if(i % noteFrames == 0) {
+            seed      = (seed * 1664525U) + 1013904223U;
+            frequency = 300.0 * std::pow(2.0, static_cast<double>(seed >> 24) / 100.0);
+        }
+
+        phase += 2.0 * std::numbers::pi * frequency / sampleRate;
+        const auto value = static_cast<float>(gain * (std::sin(phase) + (0.5 * std::sin(2.0 * phase))) / 1.5);
+        for(int ch{0}; ch < channels; ++ch) {
+            samples[static_cast<size_t>((i * channels) + ch)] = value;
+        }
+    }
+    return samples;
+}
+
+Fooyin::AudioFingerprint fingerprint(int sampleRate, int channels, uint32_t seed, double gain = 0.5)
+{
+    const auto samples = melody(sampleRate, channels, seed, gain, 20);
+
+    Fooyin::AudioFingerprinter fingerprinter{sampleRate, channels};
+    fingerprinter.addFrames(samples.data(), static_cast<int>(samples.size()) / channels);
+    return fingerprinter.fingerprint();
+}
+
+Fooyin::Track track(int id, uint64_t duration)
+{
+    Fooyin::Track track{QStringLiteral("/music/%1.flac").arg(id)};
+    track.setId(id);
+    track.setDuration(duration);
+    return track;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(AudioFingerprintTest, SameAudioMatches)
+{
+    const auto original = fingerprint(44100, 2, 1);
+    // Resampled, downmixed and quieter, as from a different encoding of the same recording
+    const auto copy = fingerprint(48000, 1, 1, 0.25);
+
+    ASSERT_FALSE(original.empty());
+    EXPECT_LT(AudioFingerprinter::distance(original, copy), 0.15);
+}
+
+TEST(AudioFingerprintTest, DifferentAudioDiffers)
+{
+    const auto one = fingerprint(44100, 2, 1);
+    const auto two = fingerprint(44100, 2, 2);
+
+    EXPECT_GT(AudioFingerprinter::distance(one, two), FingerprintIndex::MatchThreshold);
+}
+
+TEST(AudioFingerprintTest, SilenceIsEmpty)
+{
+    AudioFingerprinter fingerprinter{44100, 2};
+    const std::vector<float> silence(44100 * 2 * 10, 0.0F);
+    fingerprinter.addFrames(silence.data(), 44100 * 10);
+
+    EXPECT_TRUE(fingerprinter.fingerprint().empty());
+    EXPECT_EQ(1.0, AudioFingerprinter::distance({}, fingerprint(44100, 2, 1)));
+}
+
+TEST(AudioFingerprintTest, StopsAfterMaxSeconds)
+{
+    const auto samples = melody(8000, 1, 3, 0.5, AudioFingerprinter::MaxSeconds + 10);
+
+    AudioFingerprinter fingerprinter{8000, 1};
+    fingerprinter.addFrames(samples.data(), static_cast<int>(samples.size()));
+
+    EXPECT_TRUE(fingerprinter.isComplete());
+    // One word per hop of 512 reduced samples, less the first frame of four hops
+    EXPECT_EQ(static_cast<size_t>((5512 * AudioFingerprinter::MaxSeconds / 512) - 4),
+              fingerprinter.fingerprint().size());
+}
+
+TEST(AudioFingerprintTest, SerialiseRoundTrip)
+{
+    const auto original = fingerprint(44100, 2, 4);
+
+    EXPECT_EQ(original, AudioFingerprinter::deserialise(AudioFingerprinter::serialise(original)));
+    EXPECT_TRUE(AudioFingerprinter::deserialise(QByteArray{"\x02\0\0\0\x01\0\0\0", 8}).empty());
+}
+
+TEST(FingerprintIndexTest, MatchesWithinDuration)
+{
+    FingerprintIndex index;
+    index.add(track(1, 200000), fingerprint(44100, 2, 1));
+    index.add(track(2, 201000), fingerprint(44100, 2, 2));
+    index.add(track(3, 300000), fingerprint(44100, 2, 3));
+
+    const auto copy = fingerprint(48000, 2, 1, 0.25);
+
+    EXPECT_EQ(1, index.match(200500, copy).id());
+    // Same audio, but too different in length to be the same file
+    EXPECT_FALSE(index.match(260000, copy).isInDatabase());
+
+    EXPECT_EQ(1, index.take(199000, copy).id());
+    EXPECT_EQ(2U, index.size());
+    EXPECT_FALSE(index.match(200000, copy).isInDatabase());
+
+    index.remove(track(3, 300000));
+    EXPECT_FALSE(index.match(300000, fingerprint(44100, 2, 3)).isInDatabase());
+}
+
+TEST(FingerprintIndexTest, FindsDuplicates)
+{
+    FingerprintIndex index;
+    index.add(track(1, 200000), fingerprint(44100, 2, 1));
+    index.add(track(2, 200800), fingerprint(48000, 1, 1, 0.25));
+    index.add(track(3, 201500), fingerprint(22050, 2, 1, 0.75));
+    index.add(track(4, 200000), fingerprint(44100, 2, 2));
+    index.add(track(5, 210000), fingerprint(44100, 2, 5));
+
+    const auto groups = index.duplicates();
+    ASSERT_EQ(1U, groups.size());
+
+    std::vector<int> ids;
+    for(const Track& duplicate : groups.front()) {
+        ids.push_back(duplicate.id());
+    }
+    std::ranges::sort(ids);
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), ids);
+}
+} // namespace Fooyin::Testing
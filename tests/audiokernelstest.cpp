@@ -0,0 +1,212 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/audiokernels.h"
+
+#include <core/engine/audioformat.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+// Covers both the vector body and the scalar tail of every kernel
+constexpr std::array SampleCounts{0, 1, 7, 8, 15, 16, 33, 1001};
+
+template <typename T>
+std::vector<T> randomSamples(std::mt19937& gen, int count)
+{
+    std::vector<T> samples(count);
+    if constexpr(std::is_floating_point_v<T>) {
+        std::uniform_real_distribution<T> dist{-1.5, 1.5};
+        std::ranges::generate(samples, [&]() { return dist(gen); });
+    }
+    else {
+        std::uniform_int_distribution<int64_t> dist{std::numeric_limits<T>::min(), std::numeric_limits<T>::max()};
+        std::ranges::generate(samples, [&]() { return static_cast<T>(dist(gen)); });
+    }
+    return samples;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(AudioKernelsTest, ConversionMatchesScalar)
+{
+    const auto& kernels   = Audio::sampleKernels();
+    const auto& reference = Audio::scalarSampleKernels();
+
+    std::mt19937 gen{1};
+
+    for(const int count : SampleCounts) {
+        const auto n = static_cast<size_t>(count);
+
+        const auto s16 = randomSamples<int16_t>(gen, count);
+        const auto s32 = randomSamples<int32_t>(gen, count);
+        const auto flt = randomSamples<float>(gen, count);
+
+        std::vector<float> floatOut(n);
+        std::vector<float> floatExpected(n);
+        kernels.s16ToFloat(s16.data(), floatOut.data(), n);
+        reference.s16ToFloat(s16.data(), floatExpected.data(), n);
+        EXPECT_EQ(floatExpected, floatOut) << kernels.name;
+
+        kernels.s32ToFloat(s32.data(), floatOut.data(), n);
+        reference.s32ToFloat(s32.data(), floatExpected.data(), n);
+        EXPECT_EQ(floatExpected, floatOut) << kernels.name;
+
+        std::vector<int16_t> s16Out(n);
+        std::vector<int16_t> s16Expected(n);
+        kernels.floatToS16(flt.data(), s16Out.data(), n);
+        reference.floatToS16(flt.data(), s16Expected.data(), n);
+        EXPECT_EQ(s16Expected, s16Out) << kernels.name;
+
+        Audio::DitherState state;
+        Audio::DitherState expectedState;
+        kernels.floatToS16Dither(flt.data(), s16Out.data(), n, state);
+        reference.floatToS16Dither(flt.data(), s16Expected.data(), n, expectedState);
+        EXPECT_EQ(s16Expected, s16Out) << kernels.name;
+        EXPECT_EQ(expectedState.seeds, state.seeds) << kernels.name;
+
+        std::vector<int32_t> s32Out(n);
+        std::vector<int32_t> s32Expected(n);
+        kernels.floatToS32(flt.data(), s32Out.data(), n);
+        reference.floatToS32(flt.data(), s32Expected.data(), n);
+        EXPECT_EQ(s32Expected, s32Out) << kernels.name;
+    }
+}
+
+TEST(AudioKernelsTest, GainMatchesScalar)
+{
+    const auto& kernels   = Audio::sampleKernels();
+    const auto& reference = Audio::scalarSampleKernels();
+
+    std::mt19937 gen{2};
+
+    for(const int count : SampleCounts) {
+        const auto n     = static_cast<size_t>(count);
+        const auto gains = randomSamples<float>(gen, count);
+
+        auto s16         = randomSamples<int16_t>(gen, count);
+        auto s16Expected = s16;
+        kernels.scaleS16(s16.data(), n, 1.7F);
+        reference.scaleS16(s16Expected.data(), n, 1.7F);
+        EXPECT_EQ(s16Expected, s16) << kernels.name;
+        kernels.multiplyS16(s16.data(), gains.data(), n);
+        reference.multiplyS16(s16Expected.data(), gains.data(), n);
+        EXPECT_EQ(s16Expected, s16) << kernels.name;
+
+        auto s32         = randomSamples<int32_t>(gen, count);
+        auto s32Expected = s32;
+        kernels.scaleS32(s32.data(), n, 0.3F);
+        reference.scaleS32(s32Expected.data(), n, 0.3F);
+        EXPECT_EQ(s32Expected, s32) << kernels.name;
+        kernels.multiplyS32(s32.data(), gains.data(), n);
+        reference.multiplyS32(s32Expected.data(), gains.data(), n);
+        EXPECT_EQ(s32Expected, s32) << kernels.name;
+
+        auto flt         = randomSamples<float>(gen, count);
+        auto fltExpected = flt;
+        kernels.scaleFloat(flt.data(), n, 0.3F);
+        reference.scaleFloat(fltExpected.data(), n, 0.3F);
+        EXPECT_EQ(fltExpected, flt) << kernels.name;
+        kernels.multiplyFloat(flt.data(), gains.data(), n);
+        reference.multiplyFloat(fltExpected.data(), gains.data(), n);
+        EXPECT_EQ(fltExpected, flt) << kernels.name;
+    }
+}
+
+TEST(AudioKernelsTest, MixMatchesScalar)
+{
+    const auto& kernels   = Audio::sampleKernels();
+    const auto& reference = Audio::scalarSampleKernels();
+
+    std::mt19937 gen{3};
+
+    for(const int count : SampleCounts) {
+        const auto n = static_cast<size_t>(count);
+
+        const auto s16In = randomSamples<int16_t>(gen, count);
+        auto s16         = randomSamples<int16_t>(gen, count);
+        auto s16Expected = s16;
+        kernels.mixS16(s16.data(), s16In.data(), n);
+        reference.mixS16(s16Expected.data(), s16In.data(), n);
+        EXPECT_EQ(s16Expected, s16) << kernels.name;
+
+        const auto s32In = randomSamples<int32_t>(gen, count);
+        auto s32         = randomSamples<int32_t>(gen, count);
+        auto s32Expected = s32;
+        kernels.mixS32(s32.data(), s32In.data(), n);
+        reference.mixS32(s32Expected.data(), s32In.data(), n);
+        EXPECT_EQ(s32Expected, s32) << kernels.name;
+
+        const auto fltIn = randomSamples<float>(gen, count);
+        auto flt         = randomSamples<float>(gen, count);
+        auto fltExpected = flt;
+        kernels.mixFloat(flt.data(), fltIn.data(), n);
+        reference.mixFloat(fltExpected.data(), fltIn.data(), n);
+        EXPECT_EQ(fltExpected, flt) << kernels.name;
+    }
+}
+
+TEST(AudioKernelsTest, MixSaturates)
+{
+    const AudioFormat format{SampleFormat::S32, 44100, 1};
+
+    std::vector<int32_t> data{std::numeric_limits<int32_t>::max() - 10, std::numeric_limits<int32_t>::min() + 10, 5};
+    const std::vector<int32_t> in{100, -100, -7};
+
+    Audio::mix(format, reinterpret_cast<std::byte*>(data.data()), reinterpret_cast<const std::byte*>(in.data()), 3);
+
+    EXPECT_EQ(std::numeric_limits<int32_t>::max(), data.at(0));
+    EXPECT_EQ(std::numeric_limits<int32_t>::min(), data.at(1));
+    EXPECT_EQ(-2, data.at(2));
+}
+
+TEST(AudioKernelsTest, RampSpansBuffers)
+{
+    const AudioFormat format{SampleFormat::Float, 44100, 2};
+
+    std::vector<float> first(1000, 1.0F);
+    std::vector<float> second(1000, 1.0F);
+
+    Audio::GainRamp ramp{1.0F, 0.0F, 600, 0, AudioBuffer::RampCurve::EqualPower};
+    Audio::applyRamp(format, reinterpret_cast<std::byte*>(first.data()), 500, ramp);
+    EXPECT_FALSE(ramp.finished());
+    Audio::applyRamp(format, reinterpret_cast<std::byte*>(second.data()), 500, ramp);
+    EXPECT_TRUE(ramp.finished());
+
+    // Every channel of a frame gets the same gain
+    EXPECT_FLOAT_EQ(first.at(0), first.at(1));
+    EXPECT_FLOAT_EQ(ramp.gainAt(1), first.at(0));
+    EXPECT_FLOAT_EQ(ramp.gainAt(500), first.at(998));
+    EXPECT_FLOAT_EQ(ramp.gainAt(501), second.at(0));
+
+    for(size_t i{2}; i < first.size(); i += 2) {
+        EXPECT_LE(first.at(i), first.at(i - 2));
+    }
+
+    // Frames past the end of the ramp hold the final gain
+    EXPECT_EQ(0.0F, second.at(198));
+    EXPECT_EQ(0.0F, second.at(999));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,201 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "../testutils.h"
+#include "core/engine/audiokernels.h"
+#include "core/engine/ffmpeg/ffmpegdecoder.h"
+
+#include <core/engine/audioconverter.h>
+#include <core/engine/audiooutput.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <vector>
+
+namespace {
+// Frames requested from the decoder per pass, roughly one output period
+constexpr auto ChunkFrames = 4096;
+// Gain applied to every pass, standing in for volume or ReplayGain
+constexpr auto Gain = 0.5F;
+
+std::atomic<uint64_t> allocationCount{0};
+} // namespace
+
+// Counts every heap allocation in the process, including those made inside the engine
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if(void* ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+// Discards everything written to it, so only our side of the pipeline is measured
+class NullOutput : public Fooyin::AudioOutput
+{
+public:
+    bool init(const Fooyin::AudioFormat& format) override
+    {
+        m_format = format;
+        return true;
+    }
+
+    void uninit() override { }
+    void reset() override { }
+    void start() override { }
+
+    [[nodiscard]] bool initialised() const override
+    {
+        return m_format.isValid();
+    }
+
+    [[nodiscard]] QString device() const override
+    {
+        return QStringLiteral("null");
+    }
+
+    Fooyin::OutputState currentState() override
+    {
+        return {.freeSamples = ChunkFrames, .queuedSamples = 0, .delay = 0.0};
+    }
+
+    [[nodiscard]] int bufferSize() const override
+    {
+        return ChunkFrames;
+    }
+
+    [[nodiscard]] Fooyin::OutputDevices getAllDevices() const override
+    {
+        return {};
+    }
+
+    int write(const Fooyin::AudioBuffer& buffer) override
+    {
+        benchmark::DoNotOptimize(buffer.constData().data());
+        return buffer.frameCount();
+    }
+
+    void setPaused(bool /*pause*/) override { }
+    void setVolume(double /*volume*/) override { }
+    void setDevice(const QString& /*device*/) override { }
+
+private:
+    Fooyin::AudioFormat m_format;
+};
+
+double processCpuSeconds()
+{
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+/*!
+ * Decodes @p resource with FFmpegDecoder, converts it to S16, applies a gain and writes it to a null output,
+ * as fast as possible. Each iteration plays the whole file.
+ *
+ * Reports decoded frames/sec, heap allocations/sec, CPU seconds used per second of audio per channel, and the
+ * 99th percentile time of a single convert, gain and write pass (the renderer's writeNext).
+ */
+void BM_EnginePipeline(benchmark::State& state, const char* resource)
+{
+    const Fooyin::Testing::TempResource file{QString::fromLatin1(resource)};
+
+    Fooyin::FFmpegDecoder decoder;
+    if(!decoder.init(file.fileName())) {
+        state.SkipWithError("Unable to open file");
+        return;
+    }
+
+    const Fooyin::AudioFormat input = decoder.format();
+    const Fooyin::AudioFormat output{Fooyin::SampleFormat::S16, input.sampleRate(), input.channelCount()};
+    const auto chunkBytes = static_cast<size_t>(input.bytesForFrames(ChunkFrames));
+
+    NullOutput nullOutput;
+    nullOutput.init(output);
+
+    std::vector<int64_t> passTimes;
+    passTimes.reserve(1 << 16);
+
+    int64_t frames{0};
+    const uint64_t startAllocations = allocationCount.load(std::memory_order_relaxed);
+    const double startCpu           = processCpuSeconds();
+
+    for(auto _ : state) {
+        decoder.start();
+
+        while(true) {
+            const Fooyin::AudioBuffer buffer = decoder.readBuffer(chunkBytes);
+            if(!buffer.isValid()) {
+                break;
+            }
+
+            const auto passStart = std::chrono::steady_clock::now();
+
+            Fooyin::AudioBuffer converted = Fooyin::Audio::convert(buffer, output);
+            Fooyin::Audio::applyGain(output, converted.data(), converted.frameCount(), Gain);
+            nullOutput.write(converted);
+
+            const auto elapsed = std::chrono::steady_clock::now() - passStart;
+            passTimes.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            frames += buffer.frameCount();
+        }
+
+        decoder.stop();
+    }
+
+    const double cpu         = processCpuSeconds() - startCpu;
+    const uint64_t allocated = allocationCount.load(std::memory_order_relaxed) - startAllocations;
+    const double channelSecs = static_cast<double>(frames) / input.sampleRate() * input.channelCount();
+
+    state.counters["frames"]            = {static_cast<double>(frames), benchmark::Counter::kIsRate};
+    state.counters["allocs"]            = {static_cast<double>(allocated), benchmark::Counter::kIsRate};
+    state.counters["cpu_per_channel_s"] = channelSecs > 0.0 ? cpu / channelSecs : 0.0;
+
+    if(!passTimes.empty()) {
+        const auto p99 = passTimes.begin() + static_cast<std::ptrdiff_t>((passTimes.size() - 1) * 99 / 100);
+        std::nth_element(passTimes.begin(), p99, passTimes.end());
+        state.counters["p99_write_us"] = static_cast<double>(*p99) / 1000.0;
+    }
+}
+} // namespace
+
+BENCHMARK_CAPTURE(BM_EnginePipeline, aiff, ":/audio/audiotest.aiff")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnginePipeline, flac, ":/audio/audiotest.flac")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnginePipeline, m4a, ":/audio/audiotest.m4a")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnginePipeline, mp3, ":/audio/audiotest.mp3")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnginePipeline, ogg, ":/audio/audiotest.ogg")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnginePipeline, opus, ":/audio/audiotest.opus")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnginePipeline, wav, ":/audio/audiotest.wav")->Unit(benchmark::kMillisecond);
@@ -0,0 +1,65 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "librarygenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    const QCoreApplication app{argc, argv};
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Generates a synthetic music library for benchmarking."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("directory"), QStringLiteral("Where to write the library."));
+
+    const QCommandLineOption tracksOption{{QStringLiteral("n"), QStringLiteral("tracks")},
+                                          QStringLiteral("Number of tracks to generate (default 1000)."),
+                                          QStringLiteral("count"), QStringLiteral("1000")};
+    const QCommandLineOption seedOption{{QStringLiteral("s"), QStringLiteral("seed")},
+                                        QStringLiteral("Random seed, the same seed gives the same library."),
+                                        QStringLiteral("seed"), QStringLiteral("1")};
+    const QCommandLineOption noCoversOption{QStringLiteral("no-covers"), QStringLiteral("Don't embed covers.")};
+    parser.addOptions({tracksOption, seedOption, noCoversOption});
+
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if(args.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    Fooyin::Testing::LibrarySpec spec;
+    spec.trackCount = parser.value(tracksOption).toInt();
+    spec.seed       = parser.value(seedOption).toUInt();
+    spec.covers     = !parser.isSet(noCoversOption);
+
+    const int written = Fooyin::Testing::generateLibrary(args.constFirst(), spec);
+    if(written < 0) {
+        std::cerr << "Unable to create " << args.constFirst().toStdString() << '\n';
+        return 1;
+    }
+
+    std::cout << "Generated " << written << " tracks in " << args.constFirst().toStdString() << '\n';
+    return written == spec.trackCount ? 0 : 1;
+}
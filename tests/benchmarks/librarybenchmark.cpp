@@ -0,0 +1,185 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Measures scanning and loading a synthetic library, as generated by fooyin_generate_library.
+ *
+ * A library of FOOYIN_BENCHMARK_TRACKS tracks (2000 by default) is generated in a temporary directory,
+ * unless FOOYIN_BENCHMARK_LIBRARY points at an existing one. The database and settings are always temporary.
+ *
+ * Compare results across commits with Google Benchmark's JSON output, e.g.
+ *   benchmark_library --benchmark_out=before.json --benchmark_out_format=json
+ * and its tools/compare.py.
+ */
+
+#include "libraryenvironment.h"
+
+#include "core/library/libraryscanner.h"
+
+#include <core/library/groupingcache.h>
+#include <core/library/tracksort.h>
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+#include <benchmark/benchmark.h>
+
+#include <iostream>
+
+namespace {
+// The defaults of the library sort, library tree and filters
+const auto SortScript
+    = QStringLiteral("%albumartist% - %year% - %album% - $num(%disc%,5) - $num(%track%,5) - %title%");
+const auto TreeGrouping = QStringLiteral("%albumartist%||%album% (%year%)||[%disc%.]$num(%track%,2). %title%");
+const QStringList FilterColumns{QStringLiteral("%<genre>%"), QStringLiteral("%<albumartist>%"),
+                                QStringLiteral("%<artist>%"), QStringLiteral("%album%"), QStringLiteral("%date%")};
+
+Fooyin::Testing::LibraryEnvironment* environment{nullptr};
+
+void setTracksProcessed(benchmark::State& state, size_t count)
+{
+    state.counters["tracks"] = {static_cast<double>(count), benchmark::Counter::kIsIterationInvariantRate};
+}
+
+void BM_InitialScan(benchmark::State& state)
+{
+    Fooyin::LibraryScanner scanner{environment->dbPool(), environment->settings()};
+    scanner.initialiseThread();
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        environment->clearTracks();
+        state.ResumeTiming();
+
+        scanner.scanLibrary(environment->library(), {}, false, false);
+    }
+
+    setTracksProcessed(state, environment->tracks().size());
+}
+
+void BM_UnchangedRescan(benchmark::State& state)
+{
+    const Fooyin::TrackList tracks = environment->scannedTracks();
+
+    Fooyin::LibraryScanner scanner{environment->dbPool(), environment->settings()};
+    scanner.initialiseThread();
+
+    for(auto _ : state) {
+        scanner.scanLibrary(environment->library(), tracks, true, false);
+    }
+
+    setTracksProcessed(state, tracks.size());
+}
+
+// Light tracks followed by full ones, as TrackDatabaseManager::getAllTracks reads them
+void BM_GetAllTracks(benchmark::State& state)
+{
+    const size_t count   = environment->scannedTracks().size();
+    const auto& database = environment->trackDatabase();
+
+    using Projection = Fooyin::TrackDatabase::Projection;
+
+    for(auto _ : state) {
+        for(const auto projection : {Projection::Light, Projection::Full}) {
+            auto cursor = database.cursor(projection);
+            while(!cursor.atEnd()) {
+                benchmark::DoNotOptimize(cursor.nextPage());
+            }
+        }
+    }
+
+    setTracksProcessed(state, count);
+}
+
+void BM_SortLibrary(benchmark::State& state)
+{
+    const Fooyin::TrackList tracks = environment->scannedTracks();
+
+    for(auto _ : state) {
+        const auto keys = Fooyin::Sorting::calcSortKeys(SortScript, tracks);
+        benchmark::DoNotOptimize(Fooyin::Sorting::sortIndexes(keys));
+    }
+
+    setTracksProcessed(state, tracks.size());
+}
+
+// The grouping a library tree evaluates when first populated, with nothing cached yet
+void BM_PopulateTree(benchmark::State& state)
+{
+    const Fooyin::TrackList tracks = environment->scannedTracks();
+
+    for(auto _ : state) {
+        const Fooyin::GroupingCache cache;
+        benchmark::DoNotOptimize(cache.values(TreeGrouping, tracks));
+    }
+
+    setTracksProcessed(state, tracks.size());
+}
+
+// The default filter columns, each populated from the full library
+void BM_PopulateFilters(benchmark::State& state)
+{
+    const Fooyin::TrackList tracks = environment->scannedTracks();
+
+    for(auto _ : state) {
+        const Fooyin::GroupingCache cache;
+        for(const QString& column : FilterColumns) {
+            benchmark::DoNotOptimize(cache.values(column, tracks));
+        }
+    }
+
+    setTracksProcessed(state, tracks.size());
+}
+} // namespace
+
+BENCHMARK(BM_InitialScan)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_UnchangedRescan)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_GetAllTracks)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_SortLibrary)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_PopulateTree)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_PopulateFilters)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+    const QTemporaryDir dir;
+    if(!dir.isValid()) {
+        return 1;
+    }
+
+    Fooyin::Testing::LibraryEnvironment::useTemporaryDirs(dir.path());
+
+    const QCoreApplication app{argc, argv};
+
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    Fooyin::Testing::LibraryEnvironment libraryEnvironment{dir.path()};
+    if(!libraryEnvironment.isValid()) {
+        std::cerr << "Unable to set up the benchmark library\n";
+        return 1;
+    }
+    environment = &libraryEnvironment;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
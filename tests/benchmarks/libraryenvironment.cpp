@@ -0,0 +1,125 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libraryenvironment.h"
+
+#include "librarygenerator.h"
+
+#include "core/database/librarydatabase.h"
+#include "core/library/libraryscanner.h"
+
+#include <utils/database/dbconnectionprovider.h>
+
+#include <QSqlQuery>
+
+#include <iostream>
+
+constexpr auto DefaultTrackCount = 2000;
+
+namespace Fooyin::Testing {
+LibraryEnvironment::LibraryEnvironment(const QString& dir)
+    : m_libraryPath{qEnvironmentVariable("FOOYIN_BENCHMARK_LIBRARY")}
+    , m_settings{dir + QStringLiteral("/fooyin.conf")}
+    , m_database{&m_settings}
+{
+    if(m_libraryPath.isEmpty()) {
+        LibrarySpec spec;
+        spec.trackCount = qEnvironmentVariableIntValue("FOOYIN_BENCHMARK_TRACKS");
+        if(spec.trackCount <= 0) {
+            spec.trackCount = DefaultTrackCount;
+        }
+
+        m_libraryPath = dir + QStringLiteral("/library");
+        std::cout << "Generating " << spec.trackCount << " tracks..." << std::endl;
+        if(generateLibrary(m_libraryPath, spec) != spec.trackCount) {
+            return;
+        }
+    }
+
+    if(m_database.status() != Database::Status::Ok) {
+        return;
+    }
+
+    const DbConnectionProvider provider{m_database.connectionPool()};
+
+    LibraryDatabase libraryDatabase;
+    libraryDatabase.initialise(provider);
+    m_library = {QStringLiteral("Benchmark"), m_libraryPath,
+                 libraryDatabase.insertLibrary(m_libraryPath, QStringLiteral("Benchmark"))};
+
+    m_trackDatabase.initialise(provider);
+}
+
+void LibraryEnvironment::useTemporaryDirs(const QString& dir)
+{
+    qputenv("XDG_CONFIG_HOME", (dir + QStringLiteral("/config")).toLocal8Bit());
+    qputenv("XDG_DATA_HOME", (dir + QStringLiteral("/share")).toLocal8Bit());
+    qputenv("XDG_CACHE_HOME", (dir + QStringLiteral("/cache")).toLocal8Bit());
+}
+
+bool LibraryEnvironment::isValid() const
+{
+    return m_library.id >= 0;
+}
+
+DbConnectionPoolPtr LibraryEnvironment::dbPool() const
+{
+    return m_database.connectionPool();
+}
+
+SettingsManager* LibraryEnvironment::settings()
+{
+    return &m_settings;
+}
+
+const LibraryInfo& LibraryEnvironment::library() const
+{
+    return m_library;
+}
+
+const TrackDatabase& LibraryEnvironment::trackDatabase() const
+{
+    return m_trackDatabase;
+}
+
+TrackList LibraryEnvironment::tracks() const
+{
+    return m_trackDatabase.getAllTracks();
+}
+
+void LibraryEnvironment::clearTracks() const
+{
+    QSqlQuery query{DbConnectionProvider{dbPool()}.db()};
+    query.exec(QStringLiteral("DELETE FROM Tracks;"));
+    query.exec(QStringLiteral("DELETE FROM TrackStats;"));
+    query.exec(QStringLiteral("DELETE FROM LibraryDirectories;"));
+}
+
+TrackList LibraryEnvironment::scannedTracks()
+{
+    TrackList libraryTracks = tracks();
+    if(libraryTracks.empty()) {
+        LibraryScanner scanner{dbPool(), settings()};
+        scanner.initialiseThread();
+        scanner.scanLibrary(m_library, {}, false, false);
+        libraryTracks = tracks();
+    }
+    return libraryTracks;
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,65 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "core/database/database.h"
+#include "core/database/trackdatabase.h"
+#include "core/library/libraryinfo.h"
+
+#include <core/track.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QString>
+
+namespace Fooyin::Testing {
+/*!
+ * A synthetic library scanned into a temporary database, shared by the benchmarks.
+ *
+ * A library of FOOYIN_BENCHMARK_TRACKS tracks (2000 by default) is generated below @p dir, unless
+ * FOOYIN_BENCHMARK_LIBRARY points at an existing one. The database and settings are always kept in @p dir.
+ */
+class LibraryEnvironment
+{
+public:
+    explicit LibraryEnvironment(const QString& dir);
+
+    /** Points the config, data and cache directories at @p dir, so benchmarks never touch the user's own. */
+    static void useTemporaryDirs(const QString& dir);
+
+    [[nodiscard]] bool isValid() const;
+
+    [[nodiscard]] DbConnectionPoolPtr dbPool() const;
+    SettingsManager* settings();
+    [[nodiscard]] const LibraryInfo& library() const;
+    [[nodiscard]] const TrackDatabase& trackDatabase() const;
+
+    [[nodiscard]] TrackList tracks() const;
+    void clearTracks() const;
+    /** Scans the library if it hasn't been yet, returning its tracks. */
+    TrackList scannedTracks();
+
+private:
+    QString m_libraryPath;
+    SettingsManager m_settings;
+    Database m_database;
+    LibraryInfo m_library;
+    TrackDatabase m_trackDatabase;
+};
+} // namespace Fooyin::Testing
@@ -0,0 +1,340 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "librarygenerator.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QRegularExpression>
+
+#include <taglib/attachedpictureframe.h>
+#include <taglib/flacfile.h>
+#include <taglib/flacpicture.h>
+#include <taglib/id3v2tag.h>
+#include <taglib/mpegfile.h>
+#include <taglib/opusfile.h>
+#include <taglib/tpropertymap.h>
+#include <taglib/xiphcomment.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace {
+// Albums by a single artist, with the rest compilations
+constexpr auto CompilationChance = 0.08;
+// Tracks of a non-compilation album featuring further artists
+constexpr auto FeaturingChance = 0.12;
+constexpr auto MultiDiscChance = 0.15;
+constexpr auto ComposerChance  = 0.3;
+constexpr auto CommentChance   = 0.1;
+constexpr auto NoCoverChance   = 0.1;
+// Tracks per artist, so the library has about as many artists as a real one of the same size
+constexpr auto TracksPerArtist = 60;
+
+constexpr std::array CoverSizes{300, 600, 1000, 1400};
+
+const std::array Adjectives{"Silver", "Broken", "Quiet", "Electric", "Golden", "Lonely", "Crimson", "Hidden",
+                            "Endless", "Paper", "Wild", "Northern", "Hollow", "Bright", "Velvet", "Distant",
+                            "Frozen", "Little", "Sacred", "Neon", "Ægir", "Северный", "静かな", "Última"};
+const std::array Nouns{"River", "Machine", "Garden", "Signal", "Harbour", "Mirror", "Forest", "Engine",
+                       "Season", "Window", "Ocean", "Tower", "Letter", "Horizon", "Ghost", "Island",
+                       "Circle", "Canyon", "Thunder", "Station", "Fjord", "Ветер", "星空", "Corazón"};
+const std::array Genres{"Rock", "Pop", "Jazz", "Electronic", "Ambient", "Classical", "Folk", "Hip-Hop",
+                        "Metal", "Blues", "Soul", "Reggae", "Country", "Punk", "Indie", "Techno",
+                        "House", "Post-Rock", "Shoegaze", "Funk", "Soundtrack", "Drum & Bass", "Trip-Hop", "Latin"};
+
+struct Template
+{
+    QString extension;
+    QByteArray data;
+};
+
+class Generator
+{
+public:
+    explicit Generator(uint32_t seed)
+        : m_random{seed}
+    { }
+
+    bool chance(double probability)
+    {
+        return std::bernoulli_distribution{probability}(m_random);
+    }
+
+    int between(int min, int max)
+    {
+        return std::uniform_int_distribution{min, max}(m_random);
+    }
+
+    size_t index(size_t count)
+    {
+        return std::uniform_int_distribution<size_t>{0, count - 1}(m_random);
+    }
+
+    template <typename Container>
+    const auto& pick(const Container& items)
+    {
+        return items.at(index(items.size()));
+    }
+
+    QString words(int min, int max)
+    {
+        QStringList parts;
+        const int count = between(min, max);
+        for(int i{0}; i < count; ++i) {
+            parts.append(QString::fromUtf8(i % 2 == 0 ? pick(Adjectives) : pick(Nouns)));
+        }
+        return parts.join(u' ');
+    }
+
+    QString artistName()
+    {
+        return chance(0.3) ? QStringLiteral("The %1").arg(words(2, 2)) : words(1, 3);
+    }
+
+    QStringList genres()
+    {
+        QStringList genres;
+        const int count = between(1, 3);
+        while(genres.size() < count) {
+            const auto genre = QString::fromUtf8(pick(Genres));
+            if(!genres.contains(genre)) {
+                genres.append(genre);
+            }
+        }
+        return genres;
+    }
+
+    QByteArray cover(int size)
+    {
+        QImage image{size, size, QImage::Format_RGB32};
+
+        // A gradient with some noise, so the JPEGs are about as large as real covers
+        QLinearGradient gradient{0, 0, static_cast<qreal>(size), static_cast<qreal>(size)};
+        gradient.setColorAt(0.0, QColor::fromHsv(between(0, 359), 200, 220));
+        gradient.setColorAt(1.0, QColor::fromHsv(between(0, 359), 180, 80));
+
+        QPainter painter{&image};
+        painter.fillRect(image.rect(), gradient);
+        for(int i{0}; i < size; ++i) {
+            painter.setPen(QColor::fromHsv(between(0, 359), between(0, 255), between(0, 255), 60));
+            painter.drawLine(between(0, size), between(0, size), between(0, size), between(0, size));
+        }
+        painter.end();
+
+        QByteArray data;
+        QBuffer buffer{&data};
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "JPG", 85);
+        return data;
+    }
+
+private:
+    std::mt19937 m_random;
+};
+
+QString sanitise(QString name)
+{
+    static const QRegularExpression invalid{QStringLiteral(R"([/\\:*?"<>|])")};
+    return name.replace(invalid, QStringLiteral("_"));
+}
+
+TagLib::StringList toStringList(const QStringList& strings)
+{
+    TagLib::StringList list;
+    for(const QString& str : strings) {
+        list.append(QStringToTString(str));
+    }
+    return list;
+}
+
+bool writeTags(const QString& filepath, const TagLib::PropertyMap& properties, const QByteArray& cover)
+{
+    const QByteArray path = QFile::encodeName(filepath);
+    const TagLib::ByteVector coverData{cover.constData(), static_cast<unsigned int>(cover.size())};
+
+    auto xiphPicture = [&coverData]() {
+        auto* picture = new TagLib::FLAC::Picture();
+        picture->setType(TagLib::FLAC::Picture::FrontCover);
+        picture->setMimeType("image/jpeg");
+        picture->setData(coverData);
+        return picture;
+    };
+
+    if(filepath.endsWith(u".flac")) {
+        TagLib::FLAC::File file{path.constData()};
+        file.setProperties(properties);
+        if(!cover.isEmpty()) {
+            file.addPicture(xiphPicture());
+        }
+        return file.save();
+    }
+
+    if(filepath.endsWith(u".mp3")) {
+        TagLib::MPEG::File file{path.constData()};
+        file.setProperties(properties);
+        if(!cover.isEmpty()) {
+            auto* frame = new TagLib::ID3v2::AttachedPictureFrame();
+            frame->setType(TagLib::ID3v2::AttachedPictureFrame::FrontCover);
+            frame->setMimeType("image/jpeg");
+            frame->setPicture(coverData);
+            file.ID3v2Tag(true)->addFrame(frame);
+        }
+        return file.save();
+    }
+
+    if(filepath.endsWith(u".opus")) {
+        TagLib::Ogg::Opus::File file{path.constData()};
+        file.setProperties(properties);
+        if(!cover.isEmpty()) {
+            file.tag()->addPicture(xiphPicture());
+        }
+        return file.save();
+    }
+
+    return false;
+}
+
+std::vector<Template> loadTemplates()
+{
+    // Weighted towards FLAC, as most large libraries are
+    const std::array sources{QStringLiteral("flac"), QStringLiteral("flac"), QStringLiteral("flac"),
+                             QStringLiteral("mp3"), QStringLiteral("mp3"), QStringLiteral("opus")};
+
+    std::vector<Template> templates;
+    for(const QString& extension : sources) {
+        QFile file{QStringLiteral(":/audio/audiotest.%1").arg(extension)};
+        if(file.open(QIODevice::ReadOnly)) {
+            templates.push_back({extension, file.readAll()});
+        }
+    }
+    return templates;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+int generateLibrary(const QString& root, const LibrarySpec& spec)
+{
+    if(!QDir{}.mkpath(root)) {
+        return -1;
+    }
+
+    const std::vector<Template> templates = loadTemplates();
+    if(templates.empty()) {
+        return -1;
+    }
+
+    Generator generator{spec.seed};
+
+    std::vector<QString> artists;
+    const int artistCount = std::max(5, spec.trackCount / TracksPerArtist);
+    for(int i{0}; i < artistCount; ++i) {
+        artists.push_back(generator.artistName());
+    }
+
+    auto randomArtist = [&generator, &artists]() -> const QString& {
+        return generator.pick(artists);
+    };
+
+    int written{0};
+
+    while(written < spec.trackCount) {
+        const bool compilation    = generator.chance(CompilationChance);
+        const QString albumArtist = compilation ? QStringLiteral("Various Artists") : randomArtist();
+        const QString album       = generator.words(1, 4);
+        const QStringList genres  = generator.genres();
+        const int year            = generator.between(1960, 2024);
+        const int discTotal       = generator.chance(MultiDiscChance) ? 2 : 1;
+        const int trackTotal      = generator.between(8, 16);
+        const Template& format    = generator.pick(templates);
+
+        QString date = QString::number(year);
+        if(generator.chance(0.3)) {
+            date += QStringLiteral("-%1-%2")
+                        .arg(generator.between(1, 12), 2, 10, QLatin1Char{'0'})
+                        .arg(generator.between(1, 28), 2, 10, QLatin1Char{'0'});
+        }
+
+        const QByteArray cover = spec.covers && !generator.chance(NoCoverChance)
+                                   ? generator.cover(generator.pick(CoverSizes))
+                                   : QByteArray{};
+
+        const QString albumDir = QStringLiteral("%1/%2/%3/%4 - %5")
+                                     .arg(sanitise(genres.constFirst()), sanitise(albumArtist.left(1).toUpper()),
+                                          sanitise(albumArtist), QString::number(year), sanitise(album));
+
+        for(int disc{1}; disc <= discTotal && written < spec.trackCount; ++disc) {
+            const QString dir = discTotal > 1 ? QStringLiteral("%1/Disc %2").arg(albumDir).arg(disc) : albumDir;
+            QDir{root}.mkpath(dir);
+
+            for(int number{1}; number <= trackTotal && written < spec.trackCount; ++number) {
+                const QString title = generator.words(1, 5);
+
+                QStringList trackArtists{compilation ? randomArtist() : albumArtist};
+                if(!compilation && generator.chance(FeaturingChance)) {
+                    const int featuring = generator.between(1, 2);
+                    for(int i{0}; i < featuring; ++i) {
+                        trackArtists.append(randomArtist());
+                    }
+                }
+
+                TagLib::PropertyMap properties;
+                properties.replace("TITLE", QStringToTString(title));
+                properties.replace("ARTIST", toStringList(trackArtists));
+                properties.replace("ALBUMARTIST", QStringToTString(albumArtist));
+                properties.replace("ALBUM", QStringToTString(album));
+                properties.replace("GENRE", toStringList(genres));
+                properties.replace("TRACKNUMBER", QStringToTString(QString::number(number)));
+                properties.replace("DISCNUMBER", QStringToTString(QString::number(disc)));
+                properties.replace("DATE", QStringToTString(date));
+                if(generator.chance(ComposerChance)) {
+                    properties.replace("COMPOSER", QStringToTString(randomArtist()));
+                }
+                if(generator.chance(CommentChance)) {
+                    properties.replace("COMMENT", QStringToTString(generator.words(3, 8)));
+                }
+
+                const QString filepath = QStringLiteral("%1/%2/%3 - %4.%5")
+                                             .arg(root, dir)
+                                             .arg(number, 2, 10, QLatin1Char{'0'})
+                                             .arg(sanitise(title), format.extension);
+
+                QFile file{filepath};
+                if(!file.open(QIODevice::WriteOnly) || file.write(format.data) != format.data.size()) {
+                    return written;
+                }
+                file.close();
+
+                if(!writeTags(filepath, properties, cover)) {
+                    QFile::remove(filepath);
+                    return written;
+                }
+                ++written;
+            }
+        }
+    }
+
+    return written;
+}
+} // namespace Fooyin::Testing
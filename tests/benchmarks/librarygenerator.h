@@ -0,0 +1,47 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QString>
+
+#include <cstdint>
+
+namespace Fooyin::Testing {
+struct LibrarySpec
+{
+    int trackCount{1000};
+    // The same seed always produces the same library
+    uint32_t seed{1};
+    bool covers{true};
+};
+
+/*!
+ * Writes a synthetic library of @p spec.trackCount tracks below @p root, for benchmarking scanning and loading.
+ *
+ * Tracks are copies of the bundled test files (FLAC, MP3 and Opus) with varied tags, including multi-value
+ * artists and genres, compilations and multi-disc albums. They are laid out as
+ * genre/initial/artist/year - album/[disc n/]nn - title. Most albums get an embedded front cover of
+ * between 300 and 1400 pixels square.
+ *
+ * @returns the number of files written, which is only short of @p spec.trackCount if a write failed,
+ * or -1 if @p root couldn't be created.
+ */
+int generateLibrary(const QString& root, const LibrarySpec& spec = {});
+} // namespace Fooyin::Testing
@@ -0,0 +1,524 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Measures populating and updating the library tree and filter models end to end, from the populators
+ * through to the items held by the models, over the synthetic library of benchmark_library.
+ *
+ * Besides time, each benchmark reports the items the model holds and their size. Populate benchmarks also
+ * report the time spent merging batches into the model, when built with BUILD_TRACING.
+ *
+ * Run with --correctness to instead drive each model through the same changes once with
+ * QAbstractItemModelTester attached, which aborts on the first inconsistency.
+ */
+
+#include "libraryenvironment.h"
+
+#include "filtermodel.h"
+#include "librarytree/librarytreemodel.h"
+
+#include <core/library/groupingcache.h>
+#include <utils/memoryusage.h>
+#include <utils/tracing.h>
+
+#include <QAbstractItemModelTester>
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+using Fooyin::Filters::FilterColumn;
+using Fooyin::Filters::FilterModel;
+
+namespace {
+// The number of tracks added, and then updated, by the incremental benchmarks
+constexpr auto AddedTracks   = 1000;
+constexpr auto UpdatedTracks = 100;
+// Populating even a large library takes far less; reached only if a model never reports back
+constexpr auto WaitTimeout = 60000;
+
+// The defaults of the library tree and filters
+const auto TreeGrouping = QStringLiteral("%albumartist%||%album% (%year%)||[%disc%.]$num(%track%,2). %title%");
+const std::vector<FilterColumn> FilterColumns{
+    {.id = 0, .index = 0, .name = QStringLiteral("Genre"), .field = QStringLiteral("%<genre>%")},
+    {.id = 1, .index = 1, .name = QStringLiteral("Album Artist"), .field = QStringLiteral("%<albumartist>%")},
+    {.id = 2, .index = 2, .name = QStringLiteral("Artist"), .field = QStringLiteral("%<artist>%")},
+    {.id = 3, .index = 3, .name = QStringLiteral("Album"), .field = QStringLiteral("%album%")},
+    {.id = 4, .index = 4, .name = QStringLiteral("Date"), .field = QStringLiteral("%date%")}};
+
+const auto TreeSource   = QStringLiteral("Library tree items");
+const auto FilterSource = QStringLiteral("Filter items");
+
+Fooyin::Testing::LibraryEnvironment* environment{nullptr};
+QString traceFile;
+
+// The library split into the parts each incremental change works with
+struct TrackSets
+{
+    Fooyin::TrackList all;
+    // All but the last AddedTracks, and those left out
+    Fooyin::TrackList initial;
+    Fooyin::TrackList added;
+    // UpdatedTracks tracks with a changed album and genre, and the same tracks as they were
+    Fooyin::TrackList updated;
+    Fooyin::TrackList original;
+    // The tracks below the first top-level directory, as if that were a library of its own
+    Fooyin::TrackList library;
+};
+
+TrackSets trackSets()
+{
+    TrackSets sets;
+    sets.all = environment->scannedTracks();
+
+    const auto addedCount = std::min(static_cast<size_t>(AddedTracks), sets.all.size() / 2);
+    sets.initial.assign(sets.all.cbegin(), sets.all.cend() - static_cast<std::ptrdiff_t>(addedCount));
+    sets.added.assign(sets.all.cend() - static_cast<std::ptrdiff_t>(addedCount), sets.all.cend());
+
+    const auto updatedCount = std::min(static_cast<size_t>(UpdatedTracks), sets.initial.size());
+    sets.original.assign(sets.initial.cbegin(), sets.initial.cbegin() + static_cast<std::ptrdiff_t>(updatedCount));
+    for(Fooyin::Track track : sets.original) {
+        track.setAlbum(track.album() + QStringLiteral(" (Remastered)"));
+        track.setGenres({QStringLiteral("Benchmark")});
+        sets.updated.push_back(track);
+    }
+
+    const QDir root{environment->library().path};
+    if(!sets.all.empty()) {
+        const QString first = root.relativeFilePath(sets.all.front().filepath()).section(u'/', 0, 0);
+        for(const Fooyin::Track& track : sets.all) {
+            if(root.relativeFilePath(track.filepath()).section(u'/', 0, 0) == first) {
+                sets.library.push_back(track);
+            }
+        }
+    }
+
+    return sets;
+}
+
+// Runs the event loop until @p model emits @p signal, as the populators report back through queued signals
+template <typename Model, typename Signal>
+bool waitFor(const Model* model, Signal signal)
+{
+    QSignalSpy spy{model, signal};
+    return spy.wait(WaitTimeout);
+}
+
+bool resetTree(Fooyin::LibraryTreeModel& model, const Fooyin::TrackList& tracks)
+{
+    model.reset(tracks);
+    return waitFor(&model, &Fooyin::LibraryTreeModel::modelLoaded);
+}
+
+bool resetFilter(FilterModel& model, const FilterColumn& column, const Fooyin::TrackList& tracks)
+{
+    model.reset({column}, tracks);
+    return waitFor(&model, &FilterModel::modelUpdated);
+}
+
+// Adds every pending node below @p parent, as expanding the whole tree in a view would
+void fetchAll(QAbstractItemModel& model, const QModelIndex& parent = {})
+{
+    while(model.canFetchMore(parent)) {
+        model.fetchMore(parent);
+    }
+
+    const int rows = model.rowCount(parent);
+    for(int row{0}; row < rows; ++row) {
+        fetchAll(model, model.index(row, 0, parent));
+    }
+}
+
+// Returns the total duration of the @p name spans recorded since tracing was started, in milliseconds
+double spanTime(const QString& name)
+{
+    if(!Fooyin::Tracing::dump(traceFile)) {
+        return 0;
+    }
+
+    QFile file{traceFile};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    double total{0};
+    const auto events = QJsonDocument::fromJson(file.readAll()).object().value(u"traceEvents").toArray();
+    for(const auto& event : events) {
+        const QJsonObject span = event.toObject();
+        if(span.value(u"name").toString() == name) {
+            total += span.value(u"dur").toDouble();
+        }
+    }
+    return total / 1000;
+}
+
+void startMergeTiming()
+{
+    if(Fooyin::Tracing::isAvailable()) {
+        Fooyin::Tracing::start();
+    }
+}
+
+void setMergeTime(benchmark::State& state, const QString& span)
+{
+    if(Fooyin::Tracing::isAvailable()) {
+        state.counters["mergeMs"] = {spanTime(span), benchmark::Counter::kAvgIterations};
+        Fooyin::Tracing::stop();
+    }
+}
+
+void setModelCounters(benchmark::State& state, const QString& source, size_t tracks)
+{
+    state.counters["tracks"] = {static_cast<double>(tracks), benchmark::Counter::kIsIterationInvariantRate};
+
+    for(const auto& report : Fooyin::MemoryUsage::report()) {
+        if(report.name == source) {
+            state.counters["items"]     = static_cast<double>(report.usage.entries);
+            state.counters["itemBytes"] = {static_cast<double>(report.usage.bytes), benchmark::Counter::kDefaults,
+                                           benchmark::Counter::OneK::kIs1024};
+        }
+    }
+}
+
+void skipWithError(benchmark::State& state)
+{
+    state.SkipWithError("Timed out waiting for the model");
+}
+
+void BM_PopulateTree(benchmark::State& state)
+{
+    const TrackSets sets = trackSets();
+
+    const Fooyin::GroupingCache cache;
+    Fooyin::LibraryTreeModel model{&cache};
+    model.changeGrouping({.script = TreeGrouping});
+
+    startMergeTiming();
+
+    for(auto _ : state) {
+        if(!resetTree(model, sets.all)) {
+            skipWithError(state);
+            return;
+        }
+    }
+
+    setMergeTime(state, QStringLiteral("LibraryTreeModel::populateModel"));
+    setModelCounters(state, TreeSource, sets.all.size());
+}
+
+void BM_TreeAddTracks(benchmark::State& state)
+{
+    const TrackSets sets = trackSets();
+
+    const Fooyin::GroupingCache cache;
+    Fooyin::LibraryTreeModel model{&cache};
+    model.changeGrouping({.script = TreeGrouping});
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        const bool reset = resetTree(model, sets.initial);
+        state.ResumeTiming();
+
+        model.addTracks(sets.added);
+        if(!reset || !waitFor(&model, &Fooyin::LibraryTreeModel::modelLoaded)) {
+            skipWithError(state);
+            return;
+        }
+    }
+
+    setModelCounters(state, TreeSource, sets.added.size());
+}
+
+void BM_TreeUpdateTracks(benchmark::State& state)
+{
+    const TrackSets sets = trackSets();
+
+    const Fooyin::GroupingCache cache;
+    Fooyin::LibraryTreeModel model{&cache};
+    model.changeGrouping({.script = TreeGrouping});
+    if(!resetTree(model, sets.all)) {
+        skipWithError(state);
+        return;
+    }
+
+    // Alternates between the changed and original tags, so every iteration moves the tracks
+    bool changed{false};
+    for(auto _ : state) {
+        changed = !changed;
+        model.updateTracks(changed ? sets.updated : sets.original);
+        if(!waitFor(&model, &Fooyin::LibraryTreeModel::modelLoaded)) {
+            skipWithError(state);
+            return;
+        }
+    }
+
+    setModelCounters(state, TreeSource, sets.updated.size());
+}
+
+void BM_TreeRemoveLibrary(benchmark::State& state)
+{
+    const TrackSets sets = trackSets();
+
+    const Fooyin::GroupingCache cache;
+    Fooyin::LibraryTreeModel model{&cache};
+    model.changeGrouping({.script = TreeGrouping});
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        const bool reset = resetTree(model, sets.all);
+        state.ResumeTiming();
+
+        if(!reset) {
+            skipWithError(state);
+            return;
+        }
+        model.removeTracks(sets.library);
+    }
+
+    setModelCounters(state, TreeSource, sets.library.size());
+}
+
+void BM_PopulateFilter(benchmark::State& state)
+{
+    const TrackSets sets       = trackSets();
+    const FilterColumn& column = FilterColumns.at(static_cast<size_t>(state.range(0)));
+    state.SetLabel(column.name.toStdString());
+
+    const Fooyin::GroupingCache cache;
+    FilterModel model{&cache};
+
+    startMergeTiming();
+
+    for(auto _ : state) {
+        if(!resetFilter(model, column, sets.all)) {
+            skipWithError(state);
+            return;
+        }
+    }
+
+    setMergeTime(state, QStringLiteral("FilterModel::populateModel"));
+    setModelCounters(state, FilterSource, sets.all.size());
+}
+
+void BM_FilterAddTracks(benchmark::State& state)
+{
+    const TrackSets sets       = trackSets();
+    const FilterColumn& column = FilterColumns.at(static_cast<size_t>(state.range(0)));
+    state.SetLabel(column.name.toStdString());
+
+    const Fooyin::GroupingCache cache;
+    FilterModel model{&cache};
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        const bool reset = resetFilter(model, column, sets.initial);
+        state.ResumeTiming();
+
+        model.addTracks(sets.added);
+        if(!reset || !waitFor(&model, &FilterModel::modelUpdated)) {
+            skipWithError(state);
+            return;
+        }
+    }
+
+    setModelCounters(state, FilterSource, sets.added.size());
+}
+
+void BM_FilterUpdateTracks(benchmark::State& state)
+{
+    const TrackSets sets       = trackSets();
+    const FilterColumn& column = FilterColumns.at(static_cast<size_t>(state.range(0)));
+    state.SetLabel(column.name.toStdString());
+
+    const Fooyin::GroupingCache cache;
+    FilterModel model{&cache};
+    if(!resetFilter(model, column, sets.all)) {
+        skipWithError(state);
+        return;
+    }
+
+    // Alternates between the changed and original tags, so every iteration moves the tracks
+    bool changed{false};
+    for(auto _ : state) {
+        changed = !changed;
+        model.updateTracks(changed ? sets.updated : sets.original);
+        if(!waitFor(&model, &FilterModel::modelUpdated)) {
+            skipWithError(state);
+            return;
+        }
+    }
+
+    setModelCounters(state, FilterSource, sets.updated.size());
+}
+
+void BM_FilterRemoveLibrary(benchmark::State& state)
+{
+    const TrackSets sets       = trackSets();
+    const FilterColumn& column = FilterColumns.at(static_cast<size_t>(state.range(0)));
+    state.SetLabel(column.name.toStdString());
+
+    const Fooyin::GroupingCache cache;
+    FilterModel model{&cache};
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        const bool reset = resetFilter(model, column, sets.all);
+        state.ResumeTiming();
+
+        if(!reset) {
+            skipWithError(state);
+            return;
+        }
+        model.removeTracks(sets.library);
+    }
+
+    setModelCounters(state, FilterSource, sets.library.size());
+}
+
+// Drives both models through every change once, with a tester checking each signal they emit
+bool checkModels()
+{
+    const TrackSets sets = trackSets();
+    const Fooyin::GroupingCache cache;
+
+    using Tester = QAbstractItemModelTester;
+
+    {
+        Fooyin::LibraryTreeModel model{&cache};
+        const Tester tester{&model, Tester::FailureReportingMode::Fatal};
+        model.changeGrouping({.script = TreeGrouping});
+
+        if(!resetTree(model, sets.initial)) {
+            return false;
+        }
+        fetchAll(model);
+
+        model.addTracks(sets.added);
+        if(!waitFor(&model, &Fooyin::LibraryTreeModel::modelLoaded)) {
+            return false;
+        }
+        fetchAll(model);
+
+        model.updateTracks(sets.updated);
+        if(!waitFor(&model, &Fooyin::LibraryTreeModel::modelLoaded)) {
+            return false;
+        }
+        fetchAll(model);
+
+        model.removeTracks(sets.library);
+        std::cout << "Library tree: " << model.rowCount({}) << " top-level rows" << std::endl;
+    }
+
+    for(const FilterColumn& column : FilterColumns) {
+        FilterModel model{&cache};
+        const Tester tester{&model, Tester::FailureReportingMode::Fatal};
+
+        if(!resetFilter(model, column, sets.initial)) {
+            return false;
+        }
+
+        model.addTracks(sets.added);
+        if(!waitFor(&model, &FilterModel::modelUpdated)) {
+            return false;
+        }
+
+        model.updateTracks(sets.updated);
+        if(!waitFor(&model, &FilterModel::modelUpdated)) {
+            return false;
+        }
+
+        model.removeTracks(sets.library);
+        std::cout << "Filter (" << column.name.toStdString() << "): " << model.rowCount(model.index(0, 0))
+                  << " rows" << std::endl;
+    }
+
+    return true;
+}
+} // namespace
+
+BENCHMARK(BM_PopulateTree)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_TreeAddTracks)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_TreeUpdateTracks)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_TreeRemoveLibrary)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_PopulateFilter)->DenseRange(0, 4)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_FilterAddTracks)->DenseRange(0, 4)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_FilterUpdateTracks)->DenseRange(0, 4)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_FilterRemoveLibrary)->DenseRange(0, 4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+    const QTemporaryDir dir;
+    if(!dir.isValid()) {
+        return 1;
+    }
+
+    Fooyin::Testing::LibraryEnvironment::useTemporaryDirs(dir.path());
+    traceFile = dir.path() + QStringLiteral("/trace.json");
+
+    // Fonts are needed for the size hints, but there's nothing to show
+    if(!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    const bool correctness = argc > 1 && std::strcmp(argv[argc - 1], "--correctness") == 0;
+    if(correctness) {
+        --argc;
+    }
+
+    const QGuiApplication app{argc, argv};
+
+    if(!correctness) {
+        benchmark::Initialize(&argc, argv);
+        if(benchmark::ReportUnrecognizedArguments(argc, argv)) {
+            return 1;
+        }
+    }
+
+    Fooyin::Testing::LibraryEnvironment libraryEnvironment{dir.path()};
+    if(!libraryEnvironment.isValid()) {
+        std::cerr << "Unable to set up the benchmark library\n";
+        return 1;
+    }
+    environment = &libraryEnvironment;
+
+    if(correctness) {
+        if(!checkModels()) {
+            std::cerr << "Timed out waiting for a model\n";
+            return 1;
+        }
+        std::cout << "Models passed QAbstractItemModelTester" << std::endl;
+        return 0;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
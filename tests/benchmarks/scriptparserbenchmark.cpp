@@ -0,0 +1,169 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/scripting/scriptparser.h>
+#include <core/track.h>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+constexpr auto LibrarySize = 100000;
+
+// The default scripts of the playlist presets, library tree groupings, filter columns and library sort.
+// Playlist variables such as %depth% aren't known to the default registry, so evaluate to nothing.
+const QStringList PlaylistScripts{
+    QStringLiteral(" $padright(,$mul($sub(%depth%,1),5))[\\[%queueindexes%\\]  ]$num(%track%,2). "
+                   "  %title%[<alpha=180>  ▪  %uniqueartist%]"),
+    QStringLiteral("$ifgreater(%playcount%,0,%playcount% |)      %duration% "),
+    QStringLiteral("<b><sized=2>$if2(%albumartist%,Unknown Artist)"),
+    QStringLiteral("<sized=1>$if2(%album%,Unknown Album)"),
+    QStringLiteral("<b><sized=2>%year%</sized></b>"),
+    QStringLiteral("$ifgreater(%disctotal%,1,Disc #%disc%)"),
+};
+
+const auto TreeGrouping = QStringLiteral("%albumartist%||%album% (%year%)||[%disc%.]$num(%track%,2). %title%");
+
+const QStringList FilterColumns{QStringLiteral("%<genre>%"), QStringLiteral("%<albumartist>%"),
+                                QStringLiteral("%<artist>%"), QStringLiteral("%album%"), QStringLiteral("%date%")};
+
+const auto SortScript
+    = QStringLiteral("%albumartist% - %year% - %album% - $num(%disc%,5) - $num(%track%,5) - %title%");
+
+// 200 artists with 40 albums of 12 tracks each, on one or two discs
+const Fooyin::TrackList& library()
+{
+    static const Fooyin::TrackList tracks = []() {
+        Fooyin::TrackList library;
+        library.reserve(LibrarySize);
+
+        for(int i{0}; i < LibrarySize; ++i) {
+            const int album  = i / 12;
+            const int artist = album / 40;
+
+            Fooyin::Track track{QStringLiteral("/music/%1/%2/%3.flac").arg(artist).arg(album).arg(i)};
+            track.setId(i);
+            track.setTitle(QStringLiteral("Title %1").arg(i));
+            track.setArtists({QStringLiteral("Artist %1").arg(artist)});
+            track.setAlbumArtists({QStringLiteral("Artist %1").arg(artist)});
+            track.setAlbum(QStringLiteral("Album %1").arg(album));
+            track.setTrackNumber((i % 12) + 1);
+            track.setDiscNumber(album % 3 == 0 ? ((i % 12) / 6) + 1 : 1);
+            track.setDiscTotal(album % 3 == 0 ? 2 : 1);
+            track.setGenres({QStringLiteral("Genre %1").arg(artist % 20), QStringLiteral("Genre %1").arg(album % 7)});
+            track.setYear(1970 + (album % 50));
+            track.setDate(QString::number(1970 + (album % 50)));
+            track.setDuration(180000 + ((i % 60) * 1000));
+            track.setPlayCount(i % 5);
+            library.push_back(track);
+        }
+
+        return library;
+    }();
+
+    return tracks;
+}
+
+void BM_ParsePresets(benchmark::State& state)
+{
+    Fooyin::ScriptParser parser;
+
+    for(auto _ : state) {
+        parser.clearCache();
+        for(const QString& script : PlaylistScripts) {
+            benchmark::DoNotOptimize(parser.parse(script));
+        }
+    }
+}
+
+// Evaluated a track at a time, with the track cache, as the playlist populator does
+void BM_PlaylistPreset(benchmark::State& state)
+{
+    Fooyin::ScriptParser parser;
+
+    std::vector<Fooyin::ParsedScript> scripts;
+    for(const QString& script : PlaylistScripts) {
+        scripts.push_back(parser.parse(script));
+    }
+
+    const auto& tracks = library();
+
+    for(auto _ : state) {
+        parser.setTrackCacheEnabled(true);
+        for(const Fooyin::Track& track : tracks) {
+            for(const auto& script : scripts) {
+                benchmark::DoNotOptimize(parser.evaluate(script, track));
+            }
+        }
+        parser.setTrackCacheEnabled(false);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tracks.size()));
+}
+
+void BM_LibraryTreeGrouping(benchmark::State& state)
+{
+    Fooyin::ScriptParser parser;
+    const auto script  = parser.parse(TreeGrouping);
+    const auto& tracks = library();
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(Fooyin::ScriptParser::evaluateEachValues(script, tracks));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tracks.size()));
+}
+
+void BM_FilterColumns(benchmark::State& state)
+{
+    Fooyin::ScriptParser parser;
+    const auto& tracks = library();
+
+    std::vector<Fooyin::ParsedScript> scripts;
+    for(const QString& column : FilterColumns) {
+        scripts.push_back(parser.parse(column));
+    }
+
+    for(auto _ : state) {
+        for(const auto& script : scripts) {
+            benchmark::DoNotOptimize(Fooyin::ScriptParser::evaluateEachValues(script, tracks));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tracks.size() * scripts.size()));
+}
+
+void BM_SortScript(benchmark::State& state)
+{
+    Fooyin::ScriptParser parser;
+    const auto script  = parser.parse(SortScript);
+    const auto& tracks = library();
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(Fooyin::ScriptParser::evaluateEach(script, tracks));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tracks.size()));
+}
+} // namespace
+
+BENCHMARK(BM_ParsePresets);
+BENCHMARK(BM_PlaylistPreset)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LibraryTreeGrouping)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_FilterColumns)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_SortScript)->Unit(benchmark::kMillisecond)->UseRealTime();
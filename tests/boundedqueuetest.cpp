@@ -0,0 +1,167 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/boundedqueue.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace Fooyin::Testing {
+TEST(BoundedQueueTest, PopsInOrder)
+{
+    BoundedQueue<int> queue{4};
+
+    for(int i{0}; i < 4; ++i) {
+        EXPECT_TRUE(queue.push(i));
+    }
+
+    for(int i{0}; i < 4; ++i) {
+        EXPECT_EQ(i, queue.pop());
+    }
+}
+
+TEST(BoundedQueueTest, CloseDrainsRemainingItems)
+{
+    BoundedQueue<int> queue{4};
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    EXPECT_FALSE(queue.push(3));
+    EXPECT_EQ(1, queue.pop());
+    EXPECT_EQ(2, queue.pop());
+    EXPECT_FALSE(queue.pop().has_value());
+}
+
+TEST(BoundedQueueTest, TryPushLeavesItemWhenFull)
+{
+    BoundedQueue<std::vector<int>> queue{1};
+
+    std::vector<int> first{1, 2};
+    EXPECT_TRUE(queue.tryPush(std::move(first)));
+
+    std::vector<int> second{3, 4};
+    EXPECT_FALSE(queue.tryPush(std::move(second)));
+    EXPECT_EQ(2U, second.size());
+
+    using namespace std::chrono_literals;
+    EXPECT_FALSE(queue.pushFor(std::move(second), 10ms));
+    EXPECT_EQ(2U, second.size());
+
+    EXPECT_EQ(std::vector<int>({1, 2}), queue.tryPop());
+    EXPECT_FALSE(queue.tryPop().has_value());
+    EXPECT_TRUE(queue.pushFor(std::move(second), 10ms));
+}
+
+TEST(BoundedQueueTest, PopBatchTakesAvailableItems)
+{
+    BoundedQueue<int> queue{8};
+    for(int i{0}; i < 5; ++i) {
+        queue.push(i);
+    }
+
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), queue.popBatch(3));
+    EXPECT_EQ(std::vector<int>({3, 4}), queue.popBatch(3));
+
+    queue.close();
+    EXPECT_TRUE(queue.popBatch(3).empty());
+}
+
+TEST(BoundedQueueTest, PopBatchUnblocksProducers)
+{
+    BoundedQueue<int> queue{2};
+    queue.push(0);
+    queue.push(1);
+
+    std::vector<std::thread> producers;
+    for(int i{2}; i < 4; ++i) {
+        producers.emplace_back([&queue, i]() { queue.push(i); });
+    }
+
+    size_t popped{0};
+    while(popped < 4) {
+        popped += queue.popBatch(4).size();
+    }
+
+    for(auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(0U, queue.size());
+}
+
+TEST(BoundedQueueTest, CancelUnblocksProducer)
+{
+    BoundedQueue<int> queue{1};
+    queue.push(0);
+
+    std::atomic<bool> pushed{true};
+    std::thread producer{[&]() { pushed = queue.push(1); }};
+
+    queue.cancel();
+    producer.join();
+
+    EXPECT_FALSE(pushed);
+    EXPECT_FALSE(queue.pop().has_value());
+}
+
+TEST(BoundedQueueTest, ManyProducersAndConsumers)
+{
+    constexpr int Producers   = 4;
+    constexpr int Consumers   = 4;
+    constexpr int PerProducer = 10000;
+
+    BoundedQueue<int> queue{16};
+    std::atomic<int64_t> sum{0};
+    std::atomic<int> count{0};
+
+    std::vector<std::thread> consumers;
+    for(int i{0}; i < Consumers; ++i) {
+        consumers.emplace_back([&]() {
+            while(auto item = queue.pop()) {
+                sum += item.value();
+                ++count;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for(int i{0}; i < Producers; ++i) {
+        producers.emplace_back([&queue]() {
+            for(int value{1}; value <= PerProducer; ++value) {
+                queue.push(value);
+            }
+        });
+    }
+
+    for(auto& producer : producers) {
+        producer.join();
+    }
+    queue.close();
+    for(auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    EXPECT_EQ(Producers * PerProducer, count);
+    EXPECT_EQ(int64_t{Producers} * PerProducer * (PerProducer + 1) / 2, sum);
+}
+} // namespace Fooyin::Testing
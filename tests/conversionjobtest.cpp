@@ -0,0 +1,84 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/library/conversionjob.h"
+
+#include <core/track.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(ConversionJobTest, FindsDeepestCommonFolder)
+{
+    const TrackList album{Track{QStringLiteral("/music/Artist/Album/CD1/01.flac")},
+                          Track{QStringLiteral("/music/Artist/Album/CD2/01.flac")}};
+    EXPECT_EQ(QStringLiteral("/music/Artist/Album"), ConversionJob::commonRoot(album));
+
+    // Matched by whole folder names, not a shared prefix
+    const TrackList similar{Track{QStringLiteral("/music/Album/01.flac")},
+                            Track{QStringLiteral("/music/Album 2/01.flac")}};
+    EXPECT_EQ(QStringLiteral("/music"), ConversionJob::commonRoot(similar));
+
+    const TrackList apart{Track{QStringLiteral("/music/01.flac")}, Track{QStringLiteral("/other/01.flac")}};
+    EXPECT_EQ(QStringLiteral("/"), ConversionJob::commonRoot(apart));
+}
+
+TEST(ConversionJobTest, KeepsFolderLayout)
+{
+    ConversionOptions options;
+    options.codec           = ConversionOptions::Codec::Opus;
+    options.outputDirectory = QStringLiteral("/converted");
+
+    const Track track{QStringLiteral("/music/Artist/Album/01. Intro.flac")};
+    EXPECT_EQ(QStringLiteral("/converted/Artist/Album/01. Intro.opus"),
+              ConversionJob::outputPath(track, QStringLiteral("/music"), options));
+    EXPECT_EQ(QStringLiteral("/converted/01. Intro.opus"),
+              ConversionJob::outputPath(track, QStringLiteral("/music/Artist/Album"), options));
+
+    options.codec = ConversionOptions::Codec::Aac;
+    EXPECT_EQ(QStringLiteral("/converted/01. Intro.m4a"),
+              ConversionJob::outputPath(track, QStringLiteral("/music/Artist/Album"), options));
+}
+
+TEST(ConversionJobTest, NamesCueTracksAfterTitle)
+{
+    ConversionOptions options;
+    options.codec           = ConversionOptions::Codec::Flac;
+    options.outputDirectory = QStringLiteral("/converted");
+
+    Track track{QStringLiteral("/music/Album/album.flac")};
+    track.setCuePath(QStringLiteral("/music/Album/album.cue"));
+    track.setTrackNumber(3);
+    track.setTitle(QStringLiteral("AC/DC: Live?"));
+
+    EXPECT_EQ(QStringLiteral("/converted/Album/03 - AC_DC_ Live_.flac"),
+              ConversionJob::outputPath(track, QStringLiteral("/music"), options));
+}
+
+TEST(ConversionJobTest, KeepsArchiveLayout)
+{
+    ConversionOptions options;
+    options.codec           = ConversionOptions::Codec::Mp3;
+    options.outputDirectory = QStringLiteral("/converted");
+
+    const Track track{Track::archiveFilepath(QStringLiteral("/music/Album.zip"), QStringLiteral("CD1/01.flac"))};
+    EXPECT_EQ(QStringLiteral("/converted/Album/CD1/01.mp3"),
+              ConversionJob::outputPath(track, QStringLiteral("/music"), options));
+}
+} // namespace Fooyin::Testing
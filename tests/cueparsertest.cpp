@@ -0,0 +1,171 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/tagging/cueparser.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+namespace {
+Fooyin::TrackList parseSheet(const QByteArray& data, const QString& cuePath)
+{
+    QByteArray contents{data};
+    QBuffer buffer{&contents};
+    buffer.open(QIODevice::ReadOnly);
+
+    return Fooyin::Tagging::parseCueSheet(&buffer, cuePath);
+}
+
+const QByteArray Sheet = "REM GENRE \"Jazz\"\r\n"
+                         "REM DATE 1959\r\n"
+                         "PERFORMER \"Album Artist\"\r\n"
+                         "TITLE \"Album\"\r\n"
+                         "FILE \"album.flac\" WAVE\r\n"
+                         "  TRACK 01 AUDIO\r\n"
+                         "    TITLE \"First\"\r\n"
+                         "    INDEX 01 00:00:00\r\n"
+                         "  TRACK 02 AUDIO\r\n"
+                         "    TITLE \"Second\"\r\n"
+                         "    PERFORMER \"Guest\"\r\n"
+                         "    INDEX 00 03:10:00\r\n"
+                         "    INDEX 01 03:12:37\r\n"
+                         "  TRACK 03 AUDIO\r\n"
+                         "    TITLE \"Third\"\r\n"
+                         "    INDEX 01 07:00:00\r\n";
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(CueParserTest, ReadsTracks)
+{
+    const TrackList tracks = parseSheet(Sheet, QStringLiteral("/music/Album/album.cue"));
+    ASSERT_EQ(3U, tracks.size());
+
+    const Track& first = tracks.at(0);
+    EXPECT_EQ(QStringLiteral("/music/Album/album.flac"), first.filepath());
+    EXPECT_EQ(QStringLiteral("/music/Album/album.cue"), first.cuePath());
+    EXPECT_TRUE(first.hasCue());
+    EXPECT_EQ(QStringLiteral("First"), first.title());
+    EXPECT_EQ(QStringLiteral("Album"), first.album());
+    EXPECT_EQ(QStringList{QStringLiteral("Album Artist")}, first.artists());
+    EXPECT_EQ(QStringList{QStringLiteral("Album Artist")}, first.albumArtists());
+    EXPECT_EQ(QStringList{QStringLiteral("Jazz")}, first.genres());
+    EXPECT_EQ(QStringLiteral("1959"), first.date());
+    EXPECT_EQ(1, first.trackNumber());
+    EXPECT_EQ(3, first.trackTotal());
+    EXPECT_EQ(0U, first.offset());
+
+    const Track& second = tracks.at(1);
+    EXPECT_EQ(QStringList{QStringLiteral("Guest")}, second.artists());
+    // 37 frames of 1/75s, with the pregap of index 00 left to the first track
+    EXPECT_EQ(192493U, second.offset());
+    EXPECT_EQ(second.offset(), first.duration());
+    EXPECT_EQ(420000 - second.offset(), second.duration());
+
+    // Filled in from the file once read
+    EXPECT_EQ(0U, tracks.at(2).duration());
+}
+
+TEST(CueParserTest, UniqueFilepathsDiffer)
+{
+    const TrackList tracks = parseSheet(Sheet, QStringLiteral("/music/Album/album.cue"));
+    ASSERT_EQ(3U, tracks.size());
+
+    EXPECT_NE(tracks.at(0).uniqueFilepath(), tracks.at(1).uniqueFilepath());
+    EXPECT_EQ(tracks.at(0).filepath(), tracks.at(1).filepath());
+
+    const Track plain{QStringLiteral("/music/Album/album.flac")};
+    EXPECT_EQ(plain.filepath(), plain.uniqueFilepath());
+}
+
+TEST(CueParserTest, SkipsDataTracks)
+{
+    const QByteArray sheet = "TITLE \"Album\"\n"
+                             "FILE \"album.bin\" BINARY\n"
+                             "  TRACK 01 MODE1/2352\n"
+                             "    TITLE \"Data\"\n"
+                             "    INDEX 01 00:00:00\n"
+                             "FILE \"album.flac\" WAVE\n"
+                             "  TRACK 02 AUDIO\n"
+                             "    TITLE \"Audio\"\n"
+                             "    INDEX 01 00:00:00\n";
+
+    const TrackList tracks = parseSheet(sheet, QStringLiteral("/music/album.cue"));
+    ASSERT_EQ(1U, tracks.size());
+    EXPECT_EQ(QStringLiteral("Audio"), tracks.front().title());
+    EXPECT_EQ(QStringLiteral("Album"), tracks.front().album());
+    EXPECT_EQ(2, tracks.front().trackNumber());
+}
+
+TEST(CueParserTest, TracksOfSeparateFiles)
+{
+    const QByteArray sheet = "FILE \"01.wav\" WAVE\n"
+                             "  TRACK 01 AUDIO\n"
+                             "    INDEX 01 00:00:00\n"
+                             "FILE \"02.wav\" WAVE\n"
+                             "  TRACK 02 AUDIO\n"
+                             "    INDEX 01 00:00:00\n";
+
+    const TrackList tracks = parseSheet(sheet, QStringLiteral("/music/album.cue"));
+    ASSERT_EQ(2U, tracks.size());
+    EXPECT_EQ(QStringLiteral("/music/01.wav"), tracks.at(0).filepath());
+    EXPECT_EQ(QStringLiteral("/music/02.wav"), tracks.at(1).filepath());
+    // Each runs to the end of its own file
+    EXPECT_EQ(0U, tracks.at(0).duration());
+    EXPECT_EQ(0U, tracks.at(1).duration());
+}
+
+TEST(CueParserTest, FindsConvertedFile)
+{
+    const QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    QFile audio{dir.filePath(QStringLiteral("album.flac"))};
+    ASSERT_TRUE(audio.open(QIODevice::WriteOnly));
+    audio.close();
+
+    const QByteArray sheet = "FILE \"album.wav\" WAVE\n"
+                             "  TRACK 01 AUDIO\n"
+                             "    INDEX 01 00:00:00\n";
+
+    const TrackList tracks = parseSheet(sheet, dir.filePath(QStringLiteral("album.cue")));
+    ASSERT_EQ(1U, tracks.size());
+    EXPECT_EQ(dir.filePath(QStringLiteral("album.flac")), tracks.front().filepath());
+}
+
+TEST(CueParserTest, DecodesLegacyEncoding)
+{
+    QByteArray sheet = "TITLE \"Caf\xe9\"\n"
+                       "FILE \"album.flac\" WAVE\n"
+                       "  TRACK 01 AUDIO\n"
+                       "    INDEX 01 00:00:00\n";
+
+    const TrackList latin = parseSheet(sheet, QStringLiteral("/music/album.cue"));
+    ASSERT_EQ(1U, latin.size());
+    EXPECT_EQ(QString::fromLocal8Bit("Caf\xe9"), latin.front().album());
+
+    sheet.replace("Caf\xe9", "Caf\xc3\xa9");
+
+    const TrackList utf8 = parseSheet(sheet, QStringLiteral("/music/album.cue"));
+    ASSERT_EQ(1U, utf8.size());
+    EXPECT_EQ(QStringLiteral("Café"), utf8.front().album());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,148 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/database/dbconnectionhandler.h>
+#include <utils/database/dbexecutor.h>
+#include <utils/database/dbquery.h>
+
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <utility>
+
+namespace Fooyin::Testing {
+class DbExecutorTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+
+        m_params.type     = QStringLiteral("QSQLITE");
+        m_params.filePath = m_dir.filePath(QStringLiteral("test.db"));
+
+        m_pool = DbConnectionPool::create(m_params, QStringLiteral("executortest"));
+    }
+
+    QTemporaryDir m_dir;
+    DbConnection::DbParams m_params;
+    DbConnectionPoolPtr m_pool;
+};
+
+TEST_F(DbExecutorTest, RunsQueriesOffCallingThread)
+{
+    DbExecutor executor{m_pool};
+
+    const QThread* caller = QThread::currentThread();
+    auto created = executor.run(DbExecutor::Priority::Interactive, [caller](const DbConnectionProvider& provider) {
+        DbQuery query{provider.db(), QStringLiteral("CREATE TABLE Items (Value INTEGER);")};
+        return QThread::currentThread() != caller && query.exec();
+    });
+    EXPECT_TRUE(created.result());
+
+    auto inserted = executor.run(DbExecutor::Priority::Background, [](const DbConnectionProvider& provider) {
+        DbQuery query{provider.db(), QStringLiteral("INSERT INTO Items (Value) VALUES (1), (2), (3);")};
+        query.exec();
+    });
+    inserted.waitForFinished();
+
+    auto counted = executor.run(DbExecutor::Priority::Interactive, [](const DbConnectionProvider& provider) {
+        DbQuery query{provider.db(), QStringLiteral("SELECT COUNT(*) FROM Items;")};
+        if(!query.exec() || !query.next()) {
+            return -1;
+        }
+        return query.value(0).toInt();
+    });
+    EXPECT_EQ(3, counted.result());
+}
+
+TEST_F(DbExecutorTest, ReadOnlyConnectionsCantWrite)
+{
+    DbExecutor writer{m_pool, 1};
+    writer
+        .run(DbExecutor::Priority::Interactive,
+             [](const DbConnectionProvider& provider) {
+                 DbQuery create{provider.db(), QStringLiteral("CREATE TABLE Items (Value INTEGER);")};
+                 DbQuery insert{provider.db(), QStringLiteral("INSERT INTO Items (Value) VALUES (1), (2);")};
+                 create.exec();
+                 insert.exec();
+             })
+        .waitForFinished();
+
+    auto params     = m_params;
+    params.readOnly = true;
+    DbExecutor reader{DbConnectionPool::create(params, QStringLiteral("readtest")), 1};
+
+    auto result = reader.run(DbExecutor::Priority::Interactive, [](const DbConnectionProvider& provider) {
+        DbQuery count{provider.db(), QStringLiteral("SELECT COUNT(*) FROM Items;")};
+        DbQuery insert{provider.db(), QStringLiteral("INSERT INTO Items (Value) VALUES (3);")};
+        const int rows = count.exec() && count.next() ? count.value(0).toInt() : -1;
+        return std::pair{rows, insert.exec()};
+    });
+
+    EXPECT_EQ(2, result.result().first);
+    EXPECT_FALSE(result.result().second);
+}
+
+TEST_F(DbExecutorTest, LimitsOpenConnections)
+{
+    const auto pool = DbConnectionPool::create(m_params, QStringLiteral("limittest"), 1);
+
+    {
+        const DbConnectionHandler handler{pool};
+        EXPECT_TRUE(handler.hasConnection());
+
+        bool otherConnected{true};
+        std::thread other{[&pool, &otherConnected]() { otherConnected = DbConnectionHandler{pool}.hasConnection(); }};
+        other.join();
+        EXPECT_FALSE(otherConnected);
+    }
+
+    // Closing a connection frees its place
+    std::thread other{[&pool]() { EXPECT_TRUE(DbConnectionHandler{pool}.hasConnection()); }};
+    other.join();
+}
+
+TEST_F(DbExecutorTest, SkipsCancelledTasks)
+{
+    DbExecutor executor{m_pool, 1};
+
+    std::promise<void> gate;
+    auto blocked = executor.run(DbExecutor::Priority::Background,
+                                [opened = gate.get_future().share()](const DbConnectionProvider& /*provider*/) {
+                                    opened.wait();
+                                });
+
+    std::atomic_bool ran{false};
+    auto cancelled = executor.run(DbExecutor::Priority::Background,
+                                  [&ran](const DbConnectionProvider& /*provider*/) { ran = true; });
+    cancelled.cancel();
+
+    gate.set_value();
+    blocked.waitForFinished();
+    cancelled.waitForFinished();
+
+    EXPECT_FALSE(ran);
+}
+} // namespace Fooyin::Testing
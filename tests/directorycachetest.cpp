@@ -0,0 +1,139 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/directorycache.h>
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <sys/time.h>
+
+namespace Fooyin::Testing {
+class DirectoryCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+
+        const QDir root{m_dir.path()};
+        ASSERT_TRUE(root.mkpath(QStringLiteral("a/b")));
+        ASSERT_TRUE(root.mkpath(QStringLiteral("c")));
+
+        writeFile(QStringLiteral("Two.flac"));
+        writeFile(QStringLiteral("one.flac"));
+        writeFile(QStringLiteral("cover.jpg"));
+        writeFile(QStringLiteral("a/three.flac"));
+        writeFile(QStringLiteral("a/b/four.flac"));
+        writeFile(QStringLiteral("c/five.flac"));
+    }
+
+    void writeFile(const QString& name)
+    {
+        QFile file{m_dir.filePath(name)};
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(4, file.write("data"));
+    }
+
+    // Moves the modification time of @p name outside of the window in which listings aren't cached
+    void setModifiedTime(const QString& name, time_t seconds)
+    {
+        const timeval times[2]{{seconds, 0}, {seconds, 0}};
+        ASSERT_EQ(0, ::utimes(QFile::encodeName(m_dir.filePath(name)).constData(), times));
+    }
+
+    QString path(const QString& name) const
+    {
+        return m_dir.filePath(name);
+    }
+
+    QTemporaryDir m_dir;
+    DirectoryCache m_cache{{QStringLiteral("*.flac")}};
+};
+
+TEST_F(DirectoryCacheTest, ListsSortedMatchingFiles)
+{
+    const auto listing = m_cache.listing(m_dir.path());
+
+    EXPECT_EQ(m_dir.path(), listing.path);
+    ASSERT_EQ(2, listing.files.size());
+    EXPECT_EQ(path(QStringLiteral("one.flac")), listing.files.at(0).path);
+    EXPECT_EQ(path(QStringLiteral("Two.flac")), listing.files.at(1).path);
+    EXPECT_EQ(4, listing.files.at(0).size);
+
+    const QStringList subdirs{path(QStringLiteral("a")), path(QStringLiteral("c"))};
+    EXPECT_EQ(subdirs, listing.subdirectories);
+}
+
+TEST_F(DirectoryCacheTest, MissingDirectory)
+{
+    const auto listing = m_cache.listing(path(QStringLiteral("missing")));
+    EXPECT_TRUE(listing.path.isEmpty());
+    EXPECT_TRUE(listing.files.empty());
+}
+
+TEST_F(DirectoryCacheTest, WalksBreadthFirst)
+{
+    const QStringList expected{path(QStringLiteral("one.flac")), path(QStringLiteral("Two.flac")),
+                               path(QStringLiteral("a/three.flac")), path(QStringLiteral("c/five.flac")),
+                               path(QStringLiteral("a/b/four.flac"))};
+    EXPECT_EQ(expected, m_cache.files(m_dir.path(), true));
+
+    const QStringList topLevel{path(QStringLiteral("one.flac")), path(QStringLiteral("Two.flac"))};
+    EXPECT_EQ(topLevel, m_cache.files(m_dir.path(), false));
+}
+
+TEST_F(DirectoryCacheTest, StopsWhenAsked)
+{
+    int count{0};
+    const bool finished = m_cache.walk(m_dir.path(), true, [&count](const auto& /*listing*/) {
+        ++count;
+        return false;
+    });
+
+    EXPECT_FALSE(finished);
+    EXPECT_EQ(1, count);
+}
+
+TEST_F(DirectoryCacheTest, RevalidatesOnModification)
+{
+    static constexpr time_t listedTime = 1000000000;
+
+    setModifiedTime(QStringLiteral("c"), listedTime);
+    EXPECT_EQ(1, m_cache.listing(path(QStringLiteral("c"))).files.size());
+
+    // An unchanged modification time means the cached listing is used
+    writeFile(QStringLiteral("c/six.flac"));
+    setModifiedTime(QStringLiteral("c"), listedTime);
+    EXPECT_EQ(1, m_cache.listing(path(QStringLiteral("c"))).files.size());
+
+    setModifiedTime(QStringLiteral("c"), listedTime + 1);
+    EXPECT_EQ(2, m_cache.listing(path(QStringLiteral("c"))).files.size());
+
+    writeFile(QStringLiteral("c/seven.flac"));
+    setModifiedTime(QStringLiteral("c"), listedTime + 1);
+    EXPECT_EQ(2, m_cache.listing(path(QStringLiteral("c"))).files.size());
+
+    m_cache.invalidate(path(QStringLiteral("c")));
+    EXPECT_EQ(3, m_cache.listing(path(QStringLiteral("c"))).files.size());
+}
+} // namespace Fooyin::Testing
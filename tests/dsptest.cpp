@@ -0,0 +1,181 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/dsp/channelmixer.h"
+#include "core/engine/dsp/equaliser.h"
+#include "core/engine/dsp/limiter.h"
+#include "core/engine/dspchain.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+constexpr auto SampleRate = 48000;
+
+std::vector<float> sine(double frequency, double amplitude, int frames, int channels)
+{
+    std::vector<float> samples(static_cast<size_t>(frames * channels));
+    for(int frame{0}; frame < frames; ++frame) {
+        const double t = static_cast<double>(frame) / SampleRate;
+        std::fill_n(samples.begin() + (frame * channels), channels,
+                    static_cast<float>(amplitude * std::sin(2.0 * std::numbers::pi * frequency * t)));
+    }
+    return samples;
+}
+
+float peak(const std::vector<float>& samples, size_t from)
+{
+    float max{0.0F};
+    for(size_t i{from}; i < samples.size(); ++i) {
+        max = std::max(max, std::abs(samples[i]));
+    }
+    return max;
+}
+
+class GainNode : public Fooyin::DspNode
+{
+public:
+    explicit GainNode(float gain)
+        : m_gain{gain}
+    { }
+
+    [[nodiscard]] QString name() const override
+    {
+        return QStringLiteral("Gain");
+    }
+
+    void prepare(const Fooyin::AudioFormat& /*format*/, int maxFrames) override
+    {
+        m_maxFrames = maxFrames;
+    }
+
+    void process(std::span<float> data, int frames) override
+    {
+        EXPECT_LE(frames, m_maxFrames);
+        std::ranges::for_each(data, [this](float& sample) { sample *= m_gain; });
+    }
+
+private:
+    float m_gain;
+    int m_maxFrames{0};
+};
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(DspTest, FlatEqualiserIsTransparent)
+{
+    const AudioFormat format{SampleFormat::Float, SampleRate, 2};
+
+    Equaliser equaliser;
+    equaliser.prepare(format, 4800);
+
+    const auto input = sine(440.0, 0.5, 4800, 2);
+    auto output      = input;
+    equaliser.process(output, 4800);
+
+    EXPECT_EQ(output, input);
+}
+
+TEST(DspTest, EqualiserBoostsBand)
+{
+    const AudioFormat format{SampleFormat::Float, SampleRate, 2};
+
+    Equaliser::Gains gains{};
+    gains.at(5) = 6.0;
+
+    Equaliser equaliser{gains};
+    equaliser.prepare(format, 9600);
+
+    auto centre = sine(1000.0, 0.25, 9600, 2);
+    equaliser.process(centre, 9600);
+    // +6 dB at the centre of the band, once the filter has settled
+    EXPECT_NEAR(peak(centre, 4800), 0.5F, 0.01F);
+
+    equaliser.reset();
+    auto distant = sine(31.0, 0.25, 9600, 2);
+    equaliser.process(distant, 9600);
+    EXPECT_NEAR(peak(distant, 4800), 0.25F, 0.01F);
+}
+
+TEST(DspTest, LimiterHoldsThreshold)
+{
+    const AudioFormat format{SampleFormat::Float, SampleRate, 2};
+
+    Limiter limiter{-6.0, 50};
+    limiter.prepare(format, 4800);
+
+    auto loud = sine(440.0, 1.5, 4800, 2);
+    limiter.process(loud, 4800);
+    EXPECT_LE(peak(loud, 0), std::pow(10.0F, -6.0F / 20.0F) + 1e-6F);
+
+    limiter.reset();
+    const auto input = sine(440.0, 0.25, 4800, 2);
+    auto quiet       = input;
+    limiter.process(quiet, 4800);
+    EXPECT_EQ(quiet, input);
+}
+
+TEST(DspTest, ChannelMixerModes)
+{
+    const AudioFormat format{SampleFormat::Float, SampleRate, 2};
+    const std::vector<float> input{0.5F, -0.25F, 1.0F, 0.0F};
+
+    auto mix = [&](ChannelMixer::Mode mode) {
+        ChannelMixer mixer{mode};
+        mixer.prepare(format, 2);
+        auto samples = input;
+        mixer.process(samples, 2);
+        return samples;
+    };
+
+    EXPECT_EQ(mix(ChannelMixer::Mode::Mono), (std::vector<float>{0.125F, 0.125F, 0.5F, 0.5F}));
+    EXPECT_EQ(mix(ChannelMixer::Mode::SwapLeftRight), (std::vector<float>{-0.25F, 0.5F, 0.0F, 1.0F}));
+    EXPECT_EQ(mix(ChannelMixer::Mode::LeftOnly), (std::vector<float>{0.5F, 0.5F, 1.0F, 1.0F}));
+    EXPECT_EQ(mix(ChannelMixer::Mode::RightOnly), (std::vector<float>{-0.25F, -0.25F, 0.0F, 0.0F}));
+}
+
+TEST(DspTest, ChainProcessesIntegerFormats)
+{
+    const AudioFormat format{SampleFormat::S32, SampleRate, 2};
+    // More than one block, with a partial block at the end
+    const int frames = (DspChain::BlockFrames * 2) + 100;
+
+    std::vector<int32_t> samples(static_cast<size_t>(frames * 2), 1 << 30);
+    const std::span<const std::byte> bytes{reinterpret_cast<const std::byte*>(samples.data()),
+                                           samples.size() * sizeof(int32_t)};
+
+    std::vector<std::unique_ptr<DspNode>> nodes;
+    nodes.push_back(std::make_unique<GainNode>(0.5F));
+
+    DspChain chain;
+    chain.setNodes(std::move(nodes));
+    chain.prepare(format);
+
+    const AudioBuffer output = chain.process({bytes, format, 0});
+    ASSERT_EQ(output.frameCount(), frames);
+
+    const auto* processed = reinterpret_cast<const int32_t*>(output.data());
+    EXPECT_TRUE(std::all_of(processed, processed + samples.size(),
+                            [](int32_t sample) { return std::abs(sample - (1 << 29)) <= 1; }));
+}
+} // namespace Fooyin::Testing
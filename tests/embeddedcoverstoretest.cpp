@@ -0,0 +1,144 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/tagging/embeddedcoverstore.h"
+
+#include <core/track.h>
+#include <utils/packfile.h>
+
+#include <gtest/gtest.h>
+
+#include <QBuffer>
+#include <QImage>
+#include <QImageWriter>
+#include <QTemporaryDir>
+
+namespace {
+QByteArray encodeImage(int width, int height, const QColor& colour)
+{
+    QImage image{width, height, QImage::Format_RGB32};
+    image.fill(colour);
+
+    QByteArray data;
+    QBuffer buffer{&data};
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return data;
+}
+
+Fooyin::Track albumTrack(const QString& filepath, const QString& album)
+{
+    Fooyin::Track track{filepath};
+    track.setAlbum(album);
+    return track;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+class EmbeddedCoverStoreTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        if(!QImageWriter::supportedImageFormats().contains("jpg")) {
+            GTEST_SKIP() << "JPEG support is unavailable";
+        }
+        m_path = m_dir.filePath(QStringLiteral("covers.pack"));
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+};
+
+TEST_F(EmbeddedCoverStoreTest, StoresScaledThumbnail)
+{
+    EmbeddedCoverStore store{m_path};
+
+    const Track track = albumTrack(QStringLiteral("/music/a/01.flac"), QStringLiteral("A"));
+    ASSERT_TRUE(store.store(track, encodeImage(1200, 600, Qt::red)));
+
+    const auto cover = store.find(track.albumHash());
+    ASSERT_TRUE(cover.isValid());
+    EXPECT_TRUE(cover.scaled);
+    EXPECT_EQ(track.filepath(), cover.origin);
+    EXPECT_EQ(400, cover.thumbnail.width());
+    EXPECT_EQ(200, cover.thumbnail.height());
+}
+
+TEST_F(EmbeddedCoverStoreTest, KeepsSmallCoversAtFullSize)
+{
+    EmbeddedCoverStore store{m_path};
+
+    const Track track = albumTrack(QStringLiteral("/music/a/01.flac"), QStringLiteral("A"));
+    ASSERT_TRUE(store.store(track, encodeImage(100, 100, Qt::blue)));
+
+    const auto cover = store.find(track.albumHash());
+    ASSERT_TRUE(cover.isValid());
+    EXPECT_FALSE(cover.scaled);
+    EXPECT_EQ(QSize(100, 100), cover.thumbnail.size());
+}
+
+TEST_F(EmbeddedCoverStoreTest, SharesIdenticalArtwork)
+{
+    const QByteArray image = encodeImage(500, 500, Qt::green);
+
+    const Track disc1 = albumTrack(QStringLiteral("/music/a/cd1/01.flac"), QStringLiteral("A (Disc 1)"));
+    const Track disc2 = albumTrack(QStringLiteral("/music/a/cd2/01.flac"), QStringLiteral("A (Disc 2)"));
+
+    {
+        EmbeddedCoverStore store{m_path};
+        ASSERT_TRUE(store.store(disc1, image));
+        ASSERT_TRUE(store.store(disc2, image));
+
+        EXPECT_TRUE(store.contains(disc1.albumHash()));
+        EXPECT_TRUE(store.contains(disc2.albumHash()));
+        EXPECT_EQ(disc2.filepath(), store.find(disc2.albumHash()).origin);
+    }
+
+    // Two albums pointing to a single image
+    PackFile pack{m_path};
+    ASSERT_TRUE(pack.open());
+    EXPECT_EQ(3, pack.count());
+}
+
+TEST_F(EmbeddedCoverStoreTest, EmptyCoverOnlyRemovesOwnCover)
+{
+    EmbeddedCoverStore store{m_path};
+
+    const Track origin = albumTrack(QStringLiteral("/music/a/01.flac"), QStringLiteral("A"));
+    const Track other  = albumTrack(QStringLiteral("/music/a/02.flac"), QStringLiteral("A"));
+    ASSERT_TRUE(store.store(origin, encodeImage(300, 300, Qt::red)));
+
+    EXPECT_TRUE(store.store(other, {}));
+    EXPECT_TRUE(store.contains(origin.albumHash()));
+
+    EXPECT_TRUE(store.store(origin, {}));
+    EXPECT_FALSE(store.contains(origin.albumHash()));
+}
+
+TEST_F(EmbeddedCoverStoreTest, RejectsInvalidImage)
+{
+    EmbeddedCoverStore store{m_path};
+
+    const Track track = albumTrack(QStringLiteral("/music/a/01.flac"), QStringLiteral("A"));
+    EXPECT_FALSE(store.store(track, QByteArrayLiteral("not an image")));
+    EXPECT_FALSE(store.contains(track.albumHash()));
+}
+} // namespace Fooyin::Testing
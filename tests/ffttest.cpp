@@ -0,0 +1,97 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/fft.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+std::vector<std::complex<double>> naiveDft(const std::vector<float>& input)
+{
+    const auto size = static_cast<int>(input.size());
+
+    std::vector<std::complex<double>> output(size / 2 + 1);
+    for(int bin{0}; bin <= size / 2; ++bin) {
+        std::complex<double> sum;
+        for(int i{0}; i < size; ++i) {
+            const double phase = -2.0 * std::numbers::pi * bin * i / size;
+            sum += static_cast<double>(input[i]) * std::complex<double>{std::cos(phase), std::sin(phase)};
+        }
+        output[bin] = sum;
+    }
+    return output;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(RealFftTest, RoundsSizeToPowerOfTwo)
+{
+    EXPECT_EQ(4, RealFft{1}.size());
+    EXPECT_EQ(1024, RealFft{1024}.size());
+    EXPECT_EQ(2048, RealFft{1025}.size());
+    EXPECT_EQ(1025, RealFft{2048}.binCount());
+}
+
+TEST(RealFftTest, MatchesDft)
+{
+    for(const int size : {4, 8, 64, 1024}) {
+        std::vector<float> input(size);
+        for(int i{0}; i < size; ++i) {
+            // Deterministic but irregular signal
+            input[i] = static_cast<float>(std::sin(i * 0.37) + (0.5 * std::cos(i * 1.91)) + ((i % 7) * 0.1));
+        }
+
+        RealFft fft{size};
+        std::vector<std::complex<float>> output(fft.binCount());
+        fft.transform(input, output);
+
+        const auto expected = naiveDft(input);
+        for(int bin{0}; bin < fft.binCount(); ++bin) {
+            EXPECT_NEAR(expected[bin].real(), output[bin].real(), 1e-3 * size) << "size " << size << " bin " << bin;
+            EXPECT_NEAR(expected[bin].imag(), output[bin].imag(), 1e-3 * size) << "size " << size << " bin " << bin;
+        }
+    }
+}
+
+TEST(RealFftTest, SinePeaksAtItsBin)
+{
+    constexpr int Size = 2048;
+    constexpr int Bin  = 100;
+
+    std::vector<float> input(Size);
+    for(int i{0}; i < Size; ++i) {
+        input[i] = static_cast<float>(0.5 * std::sin(2.0 * std::numbers::pi * Bin * i / Size));
+    }
+
+    RealFft fft{Size};
+    std::vector<float> levels(fft.binCount());
+    fft.magnitudes(input, levels);
+
+    const auto peak = std::max_element(levels.cbegin(), levels.cend());
+    EXPECT_EQ(Bin, std::distance(levels.cbegin(), peak));
+    // Magnitudes are scaled so a full period sine reads as its amplitude
+    EXPECT_NEAR(0.5F, *peak, 1e-3F);
+    EXPECT_NEAR(0.0F, levels[Bin + 10], 1e-3F);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,53 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/library/fileoperationjob.h"
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(FileOperationJobTest, BuildsPathFromName)
+{
+    EXPECT_EQ(QStringLiteral("/music/Artist/Album/01 - Intro.flac"),
+              FileOperationJob::targetPath(QStringLiteral("Artist/Album/01 - Intro"), QStringLiteral("/music"),
+                                           QStringLiteral("flac")));
+
+    // Empty folders, e.g. from a missing tag, are left out
+    EXPECT_EQ(QStringLiteral("/music/Album/Intro.mp3"),
+              FileOperationJob::targetPath(QStringLiteral("/Album//Intro"), QStringLiteral("/music"),
+                                           QStringLiteral("mp3")));
+}
+
+TEST(FileOperationJobTest, ReplacesInvalidCharacters)
+{
+    EXPECT_EQ(QStringLiteral("/music/What_ Why/Live_ Part 1.flac"),
+              FileOperationJob::targetPath(QStringLiteral("What? Why.../Live: Part 1"), QStringLiteral("/music"),
+                                           QStringLiteral("flac")));
+}
+
+TEST(FileOperationJobTest, StaysBelowRoot)
+{
+    EXPECT_EQ(QStringLiteral("/music/etc/passwd.flac"),
+              FileOperationJob::targetPath(QStringLiteral("../../etc/passwd"), QStringLiteral("/music"),
+                                           QStringLiteral("flac")));
+    EXPECT_TRUE(FileOperationJob::targetPath(QStringLiteral(" / .. / "), QStringLiteral("/music"),
+                                             QStringLiteral("flac"))
+                    .isEmpty());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,165 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/filereader.h"
+
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <vector>
+
+namespace Fooyin::Testing {
+class FileReaderAccessTest : public ::testing::TestWithParam<FileReader::Access>
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        m_path = m_dir.filePath(QStringLiteral("data.bin"));
+
+        // Larger than a block, and not a multiple of one
+        m_data.resize(3 * 1024 * 1024 + 123);
+        for(size_t i{0}; i < m_data.size(); ++i) {
+            m_data[i] = static_cast<char>((i * 31) % 251);
+        }
+
+        QFile file{m_path};
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(static_cast<qint64>(m_data.size()), file.write(m_data.data(), static_cast<qint64>(m_data.size())));
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    std::vector<char> m_data;
+};
+
+TEST_P(FileReaderAccessTest, ReadsWholeFile)
+{
+    const FileReader::Access access = GetParam();
+
+    FileReader reader;
+    ASSERT_TRUE(reader.open(m_path, access));
+    EXPECT_EQ(static_cast<int64_t>(m_data.size()), reader.size());
+
+    const uint64_t bytesBefore = FileReader::threadBytesRead();
+
+    std::vector<char> out(m_data.size());
+    int64_t total{0};
+    while(true) {
+        // Odd chunk size so reads straddle block boundaries
+        const int64_t read = reader.read(reinterpret_cast<std::byte*>(out.data() + total),
+                                         std::min<int64_t>(4099, reader.size() - total));
+        ASSERT_GE(read, 0);
+        if(read == 0) {
+            break;
+        }
+        total += read;
+    }
+
+    EXPECT_EQ(reader.size(), total);
+    EXPECT_EQ(m_data, out);
+    EXPECT_GE(FileReader::threadBytesRead() - bytesBefore, m_data.size());
+}
+
+TEST_P(FileReaderAccessTest, ModifiedTime)
+{
+    const FileReader::Access access = GetParam();
+
+    FileReader reader;
+    ASSERT_TRUE(reader.open(m_path, access));
+    EXPECT_EQ(static_cast<uint64_t>(QFileInfo{m_path}.lastModified().toMSecsSinceEpoch()), reader.modifiedTime());
+}
+
+TEST_P(FileReaderAccessTest, SeekAndRead)
+{
+    const FileReader::Access access = GetParam();
+
+    FileReader reader;
+    ASSERT_TRUE(reader.open(m_path, access));
+
+    const std::vector<int64_t> offsets{reader.size() - 10, 0, 1024 * 1024 - 2, 2 * 1024 * 1024 + 7};
+    for(const int64_t offset : offsets) {
+        ASSERT_TRUE(reader.seek(offset));
+
+        std::vector<char> out(8);
+        const int64_t read = reader.read(reinterpret_cast<std::byte*>(out.data()), 8);
+        ASSERT_EQ(8, read);
+        EXPECT_TRUE(std::equal(out.begin(), out.end(), m_data.begin() + offset));
+        EXPECT_EQ(offset + 8, reader.pos());
+    }
+
+    EXPECT_FALSE(reader.seek(reader.size() + 1));
+    ASSERT_TRUE(reader.seek(reader.size()));
+
+    std::byte byte;
+    EXPECT_EQ(0, reader.read(&byte, 1));
+}
+
+TEST_P(FileReaderAccessTest, SurvivesTruncation)
+{
+    const FileReader::Access access = GetParam();
+
+    FileReader reader;
+    ASSERT_TRUE(reader.open(m_path, access));
+
+    // As when tags are saved while the file is playing
+    ASSERT_TRUE(QFile::resize(m_path, 1024));
+
+    ASSERT_TRUE(reader.seek(2 * 1024 * 1024));
+    std::vector<char> out(4096);
+    const int64_t read = reader.read(reinterpret_cast<std::byte*>(out.data()), static_cast<int64_t>(out.size()));
+    // Reading past the new end comes up empty rather than crashing
+    EXPECT_LE(read, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Access, FileReaderAccessTest,
+                         ::testing::Values(FileReader::Access::Sequential, FileReader::Access::Sparse));
+
+TEST(FileReaderTest, MissingFile)
+{
+    FileReader reader;
+    EXPECT_FALSE(reader.open(QStringLiteral("/nonexistent/file.flac")));
+    EXPECT_FALSE(reader.isOpen());
+
+    std::byte byte;
+    EXPECT_EQ(-1, reader.read(&byte, 1));
+}
+
+TEST(FileReaderTest, Prefetch)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    const QString path = dir.filePath(QStringLiteral("data.bin"));
+    QFile file{path};
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(4, file.write("data", 4));
+    file.close();
+
+    EXPECT_TRUE(FileReader::prefetch(path));
+    EXPECT_FALSE(FileReader::prefetch(QStringLiteral("/nonexistent/file.flac")));
+    EXPECT_FALSE(FileReader::prefetch(dir.path()));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,137 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/fileutils.h>
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <map>
+
+namespace Fooyin::Testing {
+class FindFilesTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+
+        const QDir root{m_dir.path()};
+        ASSERT_TRUE(root.mkpath(QStringLiteral("a/b")));
+        ASSERT_TRUE(root.mkpath(QStringLiteral(".hidden")));
+
+        writeFile(QStringLiteral("one.flac"), 10);
+        writeFile(QStringLiteral("cover.jpg"), 5);
+        writeFile(QStringLiteral("a/TWO.MP3"), 20);
+        writeFile(QStringLiteral("a/b/three.flac"), 30);
+        writeFile(QStringLiteral(".hidden/four.flac"), 40);
+    }
+
+    void writeFile(const QString& name, int size)
+    {
+        QFile file{m_dir.filePath(name)};
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(size, file.write(QByteArray(size, 'x')));
+    }
+
+    QTemporaryDir m_dir;
+};
+
+TEST_F(FindFilesTest, FindsMatchingFiles)
+{
+    std::map<QString, Utils::File::FileEntry> found;
+
+    const bool finished = Utils::File::findFilesRecursive(
+        m_dir.path(), {QStringLiteral("*.flac"), QStringLiteral("*.mp3")}, [&found](const auto& file) {
+            found.emplace(file.path, file);
+            return true;
+        });
+
+    EXPECT_TRUE(finished);
+    ASSERT_EQ(3, found.size());
+
+    const QStringList expected{QStringLiteral("one.flac"), QStringLiteral("a/TWO.MP3"),
+                               QStringLiteral("a/b/three.flac")};
+    for(const QString& name : expected) {
+        const QString path = m_dir.filePath(name);
+        ASSERT_TRUE(found.contains(path)) << path.toStdString();
+
+        const QFileInfo info{path};
+        EXPECT_EQ(info.size(), found.at(path).size);
+        EXPECT_EQ(static_cast<uint64_t>(info.lastModified().toMSecsSinceEpoch()), found.at(path).modifiedTime);
+    }
+}
+
+TEST_F(FindFilesTest, StopsWhenAsked)
+{
+    int count{0};
+
+    const bool finished = Utils::File::findFilesRecursive(m_dir.path(), {}, [&count](const auto& /*file*/) {
+        ++count;
+        return false;
+    });
+
+    EXPECT_FALSE(finished);
+    EXPECT_EQ(1, count);
+}
+TEST_F(FindFilesTest, SkipsDirectoryFiles)
+{
+    QStringList found;
+    std::map<QString, int> entryCounts;
+
+    const bool finished = Utils::File::findFilesRecursive(
+        m_dir.path(), {QStringLiteral("*.flac"), QStringLiteral("*.mp3")},
+        [&found](const auto& file) {
+            found.append(file.path);
+            return true;
+        },
+        [this, &entryCounts](const auto& directory) {
+            entryCounts.emplace(directory.path, directory.entryCount);
+            return directory.path == m_dir.filePath(QStringLiteral("a")) ? Utils::File::DirectoryAction::SkipFiles
+                                                                         : Utils::File::DirectoryAction::Visit;
+        });
+
+    EXPECT_TRUE(finished);
+
+    // Subdirectories of a skipped directory are still visited
+    found.sort();
+    const QStringList expected{m_dir.filePath(QStringLiteral("a/b/three.flac")),
+                               m_dir.filePath(QStringLiteral("one.flac"))};
+    EXPECT_EQ(expected, found);
+
+    ASSERT_EQ(3, entryCounts.size());
+    EXPECT_EQ(3, entryCounts.at(m_dir.path()));
+    EXPECT_EQ(2, entryCounts.at(m_dir.filePath(QStringLiteral("a"))));
+    EXPECT_EQ(1, entryCounts.at(m_dir.filePath(QStringLiteral("a/b"))));
+}
+
+TEST_F(FindFilesTest, StorageDevice)
+{
+    const auto device = Utils::File::storageDevice(m_dir.path());
+    EXPECT_GE(device.id, 0);
+    // Files are on the same device as their directory
+    EXPECT_EQ(device.id, Utils::File::storageDevice(m_dir.filePath(QStringLiteral("a/b/three.flac"))).id);
+
+    EXPECT_EQ(-1, Utils::File::storageDevice(m_dir.filePath(QStringLiteral("missing"))).id);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,100 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "testutils.h"
+
+#include <core/library/groupingcache.h>
+#include <core/scripting/scriptparser.h>
+#include <core/track.h>
+
+#include <gtest/gtest.h>
+
+#include <tuple>
+
+namespace Fooyin::Testing {
+class GroupingCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_tracks = {makeTrack(1, {.artist = QStringLiteral("Autechre"), .album = QStringLiteral("Amber")}),
+                    makeTrack(2, {.artist = QStringLiteral("Autechre"), .album = QStringLiteral("Tri Repetae")}),
+                    makeTrack(3, {.artist = QStringLiteral("Aphex Twin"), .album = QStringLiteral("Drukqs")})};
+    }
+
+    TrackList m_tracks;
+    GroupingCache m_cache;
+};
+
+TEST_F(GroupingCacheTest, MatchesDirectEvaluation)
+{
+    const QString script = QStringLiteral("%artist%||%album%");
+
+    ScriptParser parser;
+    const auto expected = ScriptParser::evaluateEachValues(parser.parse(script), m_tracks);
+
+    EXPECT_EQ(expected, m_cache.values(script, m_tracks));
+    // Served from the cache the second time
+    EXPECT_EQ(expected, m_cache.values(script, m_tracks));
+    EXPECT_EQ(1, m_cache.scriptCount());
+}
+
+TEST_F(GroupingCacheTest, SubsetsShareValues)
+{
+    const QString script = QStringLiteral("%album%");
+
+    std::ignore = m_cache.values(script, m_tracks);
+
+    const TrackList subset{m_tracks.at(2), m_tracks.at(0)};
+    const auto values = m_cache.values(script, subset);
+
+    ASSERT_EQ(2U, values.size());
+    EXPECT_EQ(QStringList{QStringLiteral("Drukqs")}, values.at(0));
+    EXPECT_EQ(QStringList{QStringLiteral("Amber")}, values.at(1));
+}
+
+TEST_F(GroupingCacheTest, ChangedTracksAreEvaluatedAgain)
+{
+    const QString script = QStringLiteral("%album%");
+
+    std::ignore = m_cache.values(script, m_tracks);
+
+    // Changing the track detaches it from the copy the cached values were evaluated for
+    Track changed = m_tracks.at(1);
+    changed.setAlbum(QStringLiteral("Confield"));
+
+    const auto values = m_cache.values(script, {changed});
+    ASSERT_EQ(1U, values.size());
+    EXPECT_EQ(QStringList{QStringLiteral("Confield")}, values.front());
+}
+
+TEST_F(GroupingCacheTest, KeepsScriptsSeparate)
+{
+    const auto albums  = m_cache.values(QStringLiteral("%album%"), m_tracks);
+    const auto artists = m_cache.values(QStringLiteral("%artist%"), m_tracks);
+
+    EXPECT_EQ(QStringList{QStringLiteral("Amber")}, albums.front());
+    EXPECT_EQ(QStringList{QStringLiteral("Autechre")}, artists.front());
+    EXPECT_EQ(2, m_cache.scriptCount());
+
+    m_cache.clear();
+    EXPECT_EQ(0, m_cache.scriptCount());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,99 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/histogram.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(HistogramTest, Empty)
+{
+    const Histogram histogram;
+    EXPECT_EQ(0, histogram.count());
+    EXPECT_EQ(0, histogram.percentile(50));
+    EXPECT_DOUBLE_EQ(0.0, histogram.mean());
+}
+
+TEST(HistogramTest, Buckets)
+{
+    Histogram histogram;
+    histogram.add(0);
+    histogram.add(1);
+    histogram.add(2);
+    histogram.add(3);
+    histogram.add(1000);
+
+    EXPECT_EQ(1, histogram.bucketCount(0));
+    EXPECT_EQ(1, histogram.bucketCount(1));
+    EXPECT_EQ(2, histogram.bucketCount(2));
+    // 512 <= 1000 < 1024
+    EXPECT_EQ(1, histogram.bucketCount(10));
+
+    EXPECT_EQ(5, histogram.count());
+    EXPECT_EQ(1006, histogram.sum());
+    EXPECT_EQ(1000, histogram.max());
+}
+
+TEST(HistogramTest, Percentiles)
+{
+    Histogram histogram;
+    for(uint64_t i{0}; i < 90; ++i) {
+        histogram.add(10);
+    }
+    for(uint64_t i{0}; i < 10; ++i) {
+        histogram.add(5000);
+    }
+
+    // 10 is in [8, 16)
+    EXPECT_EQ(15, histogram.percentile(50));
+    EXPECT_EQ(15, histogram.percentile(90));
+    // Capped at the largest value seen
+    EXPECT_EQ(5000, histogram.percentile(99));
+    EXPECT_EQ(5000, histogram.percentile(100));
+}
+
+TEST(HistogramTest, LargeValuesClampToLastBucket)
+{
+    Histogram histogram;
+    histogram.add(UINT64_MAX);
+    EXPECT_EQ(1, histogram.bucketCount(Histogram::BucketCount - 1));
+    EXPECT_EQ(UINT64_MAX, histogram.percentile(50));
+
+    histogram.clear();
+    EXPECT_EQ(0, histogram.count());
+}
+
+TEST(HistogramTest, Merge)
+{
+    Histogram first;
+    first.add(10);
+    first.add(20);
+
+    Histogram second;
+    second.add(5000);
+
+    first.merge(second);
+    EXPECT_EQ(3, first.count());
+    EXPECT_EQ(5030, first.sum());
+    EXPECT_EQ(5000, first.max());
+    EXPECT_EQ(1, first.bucketCount(4));
+    EXPECT_EQ(1, first.bucketCount(5));
+    EXPECT_EQ(1, first.bucketCount(13));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,98 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include <core/library/groupingcache.h>
+#include <core/library/tracksearchindex.h>
+#include <core/plugins/libraryapi.h>
+#include <core/track.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+class LibraryApiTest : public ::testing::Test
+{
+protected:
+    LibraryApiTest()
+        : m_snapshot{
+            {makeTrack(1, {.artist = QStringLiteral("Autechre"), .album = QStringLiteral("Amber"), .year = 1994}),
+             makeTrack(2, {.artist = QStringLiteral("Autechre"), .album = QStringLiteral("Tri Repetae"), .year = 1995}),
+             makeTrack(3, {.artist = QStringLiteral("Aphex Twin"), .album = QStringLiteral("Drukqs"), .year = 2001})}}
+        , m_api{[this]() { return m_snapshot; }, &m_searchIndex, &m_groupingCache}
+    {
+        m_searchIndex.build(m_snapshot.tracks());
+    }
+
+    TrackSnapshot m_snapshot;
+    TrackSearchIndex m_searchIndex;
+    GroupingCache m_groupingCache;
+    LibraryApi m_api;
+};
+
+TEST_F(LibraryApiTest, LooksUpTracks)
+{
+    EXPECT_EQ(LibraryApi::Version, LibraryApi::version());
+
+    const auto byId = m_api.trackForId(2);
+    ASSERT_TRUE(byId.has_value());
+    EXPECT_EQ(QStringLiteral("Tri Repetae"), byId->album());
+    EXPECT_FALSE(m_api.trackForId(4).has_value());
+
+    const auto byPath = m_api.trackForPath(QStringLiteral("/music/Aphex Twin/Drukqs/3.flac"));
+    ASSERT_TRUE(byPath.has_value());
+    EXPECT_EQ(3, byPath->id());
+
+    EXPECT_EQ((QList<int>{3, 1}), ids(m_api.tracksForIds({3, 5, 1})));
+}
+
+TEST_F(LibraryApiTest, ListsGroupsAndTheirTracks)
+{
+    const QString script = QStringLiteral("%artist%");
+
+    EXPECT_EQ((QStringList{QStringLiteral("Autechre"), QStringLiteral("Aphex Twin")}), m_api.groups(script));
+    EXPECT_EQ((QList<int>{1, 2}), ids(m_api.tracksInGroup(script, QStringLiteral("Autechre"))));
+    EXPECT_TRUE(m_api.tracksInGroup(script, QStringLiteral("Björk")).empty());
+    // Grouping shares the library's cache
+    EXPECT_EQ(1, m_groupingCache.scriptCount());
+}
+
+TEST_F(LibraryApiTest, MatchesQueries)
+{
+    EXPECT_EQ((QList<int>{2, 3}), ids(m_api.tracksMatching(QStringLiteral("year >= 1995"))));
+    EXPECT_EQ((QList<int>{3}), ids(m_api.tracksMatching(QStringLiteral("aphex"))));
+    EXPECT_EQ((QList<int>{1, 2, 3}), ids(m_api.tracksMatching(QString{})));
+
+    QString error;
+    EXPECT_TRUE(m_api.tracksMatching(QStringLiteral("year >"), &error).empty());
+    EXPECT_FALSE(error.isEmpty());
+}
+
+TEST_F(LibraryApiTest, FollowsNewSnapshots)
+{
+    const QString query = QStringLiteral("year < 2000");
+    EXPECT_EQ((QList<int>{1, 2}), ids(m_api.tracksMatching(query)));
+
+    m_snapshot = m_snapshot.updated(
+        {makeTrack(2, {.artist = QStringLiteral("Autechre"), .album = QStringLiteral("Tri Repetae"), .year = 2005})});
+
+    EXPECT_EQ((QList<int>{1}), ids(m_api.tracksMatching(query)));
+    EXPECT_EQ(2005, m_api.trackForId(2)->year());
+}
+} // namespace Fooyin::Testing
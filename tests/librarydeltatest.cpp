@@ -0,0 +1,80 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "testutils.h"
+
+#include <core/library/librarydelta.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(LibraryDeltaTest, RemovalDetachesRemainingTracks)
+{
+    const auto delta = LibraryDelta::removal(1, {5, 2});
+
+    Track kept    = makeTrack(1, {.filepath = QStringLiteral("/music/1.flac"), .libraryId = 1});
+    Track removed = makeTrack(2, {.filepath = QStringLiteral("/music/2.flac"), .libraryId = 1});
+    Track other   = makeTrack(5, {.filepath = QStringLiteral("/other/5.flac"), .libraryId = 2});
+
+    EXPECT_FALSE(delta.removes(kept));
+    EXPECT_TRUE(delta.removes(removed));
+    // Only tracks of the removed library are affected, whatever their id
+    EXPECT_FALSE(delta.removes(other));
+
+    EXPECT_TRUE(delta.apply(kept));
+    EXPECT_EQ(-1, kept.libraryId());
+    EXPECT_FALSE(delta.apply(other));
+    EXPECT_EQ(2, other.libraryId());
+}
+
+TEST(LibraryDeltaTest, RelocationRebasesPaths)
+{
+    const auto delta = LibraryDelta::relocation(1, QStringLiteral("/music"), QStringLiteral("/mnt/music"));
+
+    Track track = makeTrack(1, {.filepath = QStringLiteral("/music/Artist/01.flac"), .libraryId = 1});
+    EXPECT_TRUE(delta.apply(track));
+    EXPECT_EQ(QStringLiteral("/mnt/music/Artist/01.flac"), track.filepath());
+    EXPECT_EQ(QStringLiteral("01"), track.filename());
+
+    Track cue = makeTrack(2, {.filepath = QStringLiteral("/music/Album/image.flac"), .libraryId = 1});
+    cue.setCuePath(QStringLiteral("/music/Album/image.cue"));
+    EXPECT_TRUE(delta.apply(cue));
+    EXPECT_EQ(QStringLiteral("/mnt/music/Album/image.flac"), cue.filepath());
+    EXPECT_EQ(QStringLiteral("/mnt/music/Album/image.cue"), cue.cuePath());
+
+    const QString archivePath = Track::archiveFilepath(QStringLiteral("/music/Album.zip"), QStringLiteral("01.flac"));
+    Track archived            = makeTrack(3, {.filepath = archivePath, .libraryId = 1});
+    EXPECT_TRUE(delta.apply(archived));
+    EXPECT_EQ(QStringLiteral("/mnt/music/Album.zip"), archived.archivePath());
+    EXPECT_EQ(QStringLiteral("01.flac"), archived.pathInArchive());
+}
+
+TEST(LibraryDeltaTest, RelocationMatchesWholeDirectories)
+{
+    const auto delta = LibraryDelta::relocation(1, QStringLiteral("/music"), QStringLiteral("/mnt/music"));
+
+    EXPECT_EQ(QStringLiteral("/music2/01.flac"), delta.relocatedPath(QStringLiteral("/music2/01.flac")));
+    EXPECT_EQ(QStringLiteral("/music"), delta.relocatedPath(QStringLiteral("/music")));
+
+    Track sibling = makeTrack(1, {.filepath = QStringLiteral("/music2/01.flac"), .libraryId = 1});
+    EXPECT_FALSE(delta.apply(sibling));
+    EXPECT_EQ(QStringLiteral("/music2/01.flac"), sibling.filepath());
+}
+} // namespace Fooyin::Testing
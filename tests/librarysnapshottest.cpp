@@ -0,0 +1,123 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/library/librarysnapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace Fooyin::Testing {
+class LibrarySnapshotTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        m_path = m_dir.filePath(QStringLiteral("library.snapshot"));
+
+        for(int i{0}; i < 3; ++i) {
+            Track track{QStringLiteral("/music/Artist/Album/%1.flac").arg(i)};
+            track.setId(i + 1);
+            track.setLibraryId(1);
+            track.setRelativePath(QStringLiteral("Artist/Album/%1.flac").arg(i));
+            track.setTitle(QStringLiteral("Title %1").arg(i));
+            track.setArtists({QStringLiteral("Artist"), QStringLiteral("Guest %1").arg(i)});
+            track.setAlbumArtists({QStringLiteral("Artist")});
+            track.setAlbum(QStringLiteral("Album"));
+            track.setGenres({QStringLiteral("Rock")});
+            track.setDate(QStringLiteral("2001-02-03"));
+            track.setTrackNumber(i + 1);
+            track.setDuration(180000 + i);
+            track.setFileSize(1234567);
+            track.setSampleRate(44100);
+            track.setType(Track::Type::FLAC);
+            track.setPlayCount(i);
+            track.setRating(0.5F);
+            track.setIsEnabled(i != 1);
+            track.setSort(QStringLiteral("sort %1").arg(i));
+            if(i == 2) {
+                track.setCuePath(QStringLiteral("/music/Artist/Album/album.cue"));
+                track.setOffset(60000);
+            }
+            track.generateHash();
+            track.setAlbumId(i == 2 ? -1 : 7);
+            m_tracks.push_back(track);
+        }
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    TrackList m_tracks;
+};
+
+TEST_F(LibrarySnapshotTest, RoundTrips)
+{
+    ASSERT_TRUE(LibrarySnapshot::write(m_path, m_tracks, QStringLiteral("%album%")));
+
+    const TrackList tracks = LibrarySnapshot::read(m_path, QStringLiteral("%album%"));
+    ASSERT_EQ(m_tracks.size(), tracks.size());
+
+    for(size_t i{0}; i < tracks.size(); ++i) {
+        const Track& expected = m_tracks.at(i);
+        const Track& track    = tracks.at(i);
+
+        EXPECT_EQ(expected.id(), track.id());
+        EXPECT_EQ(expected.libraryId(), track.libraryId());
+        EXPECT_EQ(expected.albumId(), track.albumId());
+        EXPECT_EQ(expected.filepath(), track.filepath());
+        EXPECT_EQ(expected.relativePath(), track.relativePath());
+        EXPECT_EQ(expected.title(), track.title());
+        EXPECT_EQ(expected.artists(), track.artists());
+        EXPECT_EQ(expected.albumArtists(), track.albumArtists());
+        EXPECT_EQ(expected.album(), track.album());
+        EXPECT_EQ(expected.genres(), track.genres());
+        EXPECT_EQ(expected.date(), track.date());
+        EXPECT_EQ(expected.trackNumber(), track.trackNumber());
+        EXPECT_EQ(expected.duration(), track.duration());
+        EXPECT_EQ(expected.fileSize(), track.fileSize());
+        EXPECT_EQ(expected.sampleRate(), track.sampleRate());
+        EXPECT_EQ(expected.type(), track.type());
+        EXPECT_EQ(expected.playCount(), track.playCount());
+        EXPECT_FLOAT_EQ(expected.rating(), track.rating());
+        EXPECT_EQ(expected.isEnabled(), track.isEnabled());
+        EXPECT_EQ(expected.hash(), track.hash());
+        EXPECT_EQ(expected.sort(), track.sort());
+        EXPECT_EQ(expected.cuePath(), track.cuePath());
+        EXPECT_EQ(expected.offset(), track.offset());
+    }
+}
+
+TEST_F(LibrarySnapshotTest, IgnoresOtherSortScript)
+{
+    ASSERT_TRUE(LibrarySnapshot::write(m_path, m_tracks, QStringLiteral("%album%")));
+    EXPECT_TRUE(LibrarySnapshot::read(m_path, QStringLiteral("%title%")).empty());
+}
+
+TEST_F(LibrarySnapshotTest, IgnoresTruncatedFile)
+{
+    ASSERT_TRUE(LibrarySnapshot::write(m_path, m_tracks, QStringLiteral("%album%")));
+
+    QFile file{m_path};
+    ASSERT_TRUE(file.resize(file.size() / 2));
+
+    EXPECT_TRUE(LibrarySnapshot::read(m_path, QStringLiteral("%album%")).empty());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,91 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/loudnessanalyser.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+std::vector<float> sine(int sampleRate, int channels, double frequency, double amplitudeDb, int seconds)
+{
+    const double amplitude = std::pow(10.0, amplitudeDb / 20.0);
+    const int frames       = sampleRate * seconds;
+
+    std::vector<float> samples(static_cast<size_t>(frames * channels));
+    for(int i{0}; i < frames; ++i) {
+        const auto value = static_cast<float>(amplitude * std::sin(2.0 * std::numbers::pi * frequency * i / sampleRate));
+        for(int ch{0}; ch < channels; ++ch) {
+            samples[static_cast<size_t>((i * channels) + ch)] = value;
+        }
+    }
+    return samples;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+// EBU Tech 3341, test case 1 and 2: a 1kHz stereo sine at -23/-33 dBFS measures -23/-33 LUFS
+TEST(LoudnessAnalyserTest, SineReference)
+{
+    for(const double level : {-23.0, -33.0}) {
+        for(const int rate : {44100, 48000}) {
+            LoudnessAnalyser analyser{rate, 2};
+            const auto samples = sine(rate, 2, 1000.0, level, 20);
+            analyser.addFrames(samples.data(), static_cast<int>(samples.size() / 2));
+
+            const auto loudness = analyser.integratedLoudness();
+            ASSERT_TRUE(loudness.has_value());
+            EXPECT_NEAR(level, loudness.value(), 0.1);
+            EXPECT_NEAR(std::pow(10.0, level / 20.0), analyser.peak(), 1e-3);
+        }
+    }
+}
+
+TEST(LoudnessAnalyserTest, SilenceIsGated)
+{
+    LoudnessAnalyser analyser{48000, 2};
+    const std::vector<float> silence(48000 * 2 * 5, 0.0F);
+    analyser.addFrames(silence.data(), 48000 * 5);
+
+    EXPECT_FALSE(analyser.integratedLoudness().has_value());
+    EXPECT_EQ(0.0F, analyser.peak());
+}
+
+TEST(LoudnessAnalyserTest, CombinedLoudness)
+{
+    // EBU Tech 3341, test case 3: -36, -23, -36 dBFS segments of 10, 60 and 10s measure -23 LUFS
+    LoudnessAnalyser first{48000, 2};
+    LoudnessAnalyser second{48000, 2};
+    LoudnessAnalyser third{48000, 2};
+
+    const auto quiet = sine(48000, 2, 1000.0, -36.0, 10);
+    const auto loud  = sine(48000, 2, 1000.0, -23.0, 60);
+
+    first.addFrames(quiet.data(), 48000 * 10);
+    second.addFrames(loud.data(), 48000 * 60);
+    third.addFrames(quiet.data(), 48000 * 10);
+
+    const auto loudness = LoudnessAnalyser::integratedLoudness({&first, &second, &third});
+    ASSERT_TRUE(loudness.has_value());
+    EXPECT_NEAR(-23.0, loudness.value(), 0.1);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,99 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <utils/lrucache.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace Fooyin::Testing {
+TEST(LruCacheTest, FindAndReplace)
+{
+    LruCache<std::string, int> cache{100};
+
+    EXPECT_EQ(nullptr, cache.find("a"));
+    EXPECT_TRUE(cache.insert("a", 1, 10));
+    ASSERT_NE(nullptr, cache.find("a"));
+    EXPECT_EQ(1, *cache.find("a"));
+
+    EXPECT_TRUE(cache.insert("a", 2, 30));
+    EXPECT_EQ(2, *cache.find("a"));
+    EXPECT_EQ(1U, cache.count());
+    EXPECT_EQ(30U, cache.cost());
+
+    EXPECT_TRUE(cache.remove("a"));
+    EXPECT_FALSE(cache.remove("a"));
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(0U, cache.cost());
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(3U, stats.hits);
+    EXPECT_EQ(1U, stats.misses);
+    EXPECT_EQ(0U, stats.evictions);
+}
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed)
+{
+    LruCache<std::string, int> cache{30};
+
+    cache.insert("a", 1, 10);
+    cache.insert("b", 2, 10);
+    cache.insert("c", 3, 10);
+
+    // Touch "a" so "b" is the oldest
+    EXPECT_NE(nullptr, cache.find("a"));
+
+    cache.insert("d", 4, 10);
+    EXPECT_FALSE(cache.contains("b"));
+    EXPECT_TRUE(cache.contains("a"));
+    EXPECT_TRUE(cache.contains("c"));
+    EXPECT_TRUE(cache.contains("d"));
+
+    cache.insert("e", 5, 20);
+    EXPECT_FALSE(cache.contains("c"));
+    EXPECT_FALSE(cache.contains("a"));
+    EXPECT_TRUE(cache.contains("d"));
+    EXPECT_TRUE(cache.contains("e"));
+    EXPECT_EQ(30U, cache.cost());
+    EXPECT_EQ(3U, cache.stats().evictions);
+}
+
+TEST(LruCacheTest, Budget)
+{
+    LruCache<std::string, int> cache{30};
+
+    EXPECT_FALSE(cache.insert("big", 1, 31));
+    EXPECT_FALSE(cache.contains("big"));
+
+    cache.insert("a", 1, 10);
+    cache.insert("b", 2, 10);
+    cache.insert("c", 3, 10);
+
+    cache.setBudget(15);
+    EXPECT_EQ(1U, cache.count());
+    EXPECT_TRUE(cache.contains("c"));
+    EXPECT_LE(cache.cost(), cache.budget());
+
+    cache.clear();
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(0U, cache.cost());
+}
+} // namespace Fooyin::Testing
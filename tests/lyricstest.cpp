@@ -0,0 +1,93 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/lyrics/lyrics.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(LyricsTest, ParsesSyncedLines)
+{
+    const auto lyrics = Lyrics::parse(QStringLiteral("[ti:Song]\n[00:12.50]Second\n[00:01.00]First\n"));
+
+    ASSERT_TRUE(lyrics.isSynced());
+    ASSERT_EQ(2U, lyrics.lines().size());
+    EXPECT_EQ(1000U, lyrics.lines().at(0).timestamp);
+    EXPECT_EQ(QStringLiteral("First"), lyrics.lines().at(0).text);
+    EXPECT_EQ(12500U, lyrics.lines().at(1).timestamp);
+    EXPECT_EQ(QStringLiteral("Song"), lyrics.tag(QStringLiteral("ti")));
+}
+
+TEST(LyricsTest, RepeatsLinesWithSeveralTimestamps)
+{
+    const auto lyrics = Lyrics::parse(QStringLiteral("[00:10.00][00:30.00]Chorus\n[00:20.00]Verse"));
+
+    ASSERT_EQ(3U, lyrics.lines().size());
+    EXPECT_EQ(QStringLiteral("Chorus"), lyrics.lines().at(0).text);
+    EXPECT_EQ(QStringLiteral("Verse"), lyrics.lines().at(1).text);
+    EXPECT_EQ(QStringLiteral("Chorus"), lyrics.lines().at(2).text);
+    EXPECT_EQ(30000U, lyrics.lines().at(2).timestamp);
+}
+
+TEST(LyricsTest, AppliesOffset)
+{
+    const auto lyrics = Lyrics::parse(QStringLiteral("[offset:500]\n[00:02.00]Line"));
+
+    ASSERT_EQ(1U, lyrics.lines().size());
+    EXPECT_EQ(1500U, lyrics.lines().front().timestamp);
+}
+
+TEST(LyricsTest, ParsesEnhancedWords)
+{
+    const auto lyrics = Lyrics::parse(QStringLiteral("[00:01.00]<00:01.00>Hello <00:01.50>world<00:02.00>"));
+
+    ASSERT_EQ(1U, lyrics.lines().size());
+    const auto& line = lyrics.lines().front();
+    EXPECT_EQ(QStringLiteral("Hello world"), line.text);
+    ASSERT_EQ(2U, line.words.size());
+    EXPECT_EQ(1500U, line.words.at(1).timestamp);
+    EXPECT_EQ(QStringLiteral("world"), line.words.at(1).text);
+}
+
+TEST(LyricsTest, KeepsPlainText)
+{
+    const auto lyrics = Lyrics::parse(QStringLiteral("\nFirst line\n\nSecond line\n"));
+
+    EXPECT_FALSE(lyrics.isSynced());
+    ASSERT_EQ(3U, lyrics.lines().size());
+    EXPECT_EQ(QStringLiteral("First line"), lyrics.lines().at(0).text);
+    EXPECT_TRUE(lyrics.lines().at(1).text.isEmpty());
+    EXPECT_EQ(-1, lyrics.lineAt(5000));
+}
+
+TEST(LyricsTest, FindsLineAtPosition)
+{
+    const auto lyrics = Lyrics::parse(QStringLiteral("[00:01.00]A\n[00:02.00]B\n[00:03.00]C"));
+
+    EXPECT_EQ(-1, lyrics.lineAt(500));
+    EXPECT_EQ(0, lyrics.lineAt(1000));
+    EXPECT_EQ(1, lyrics.lineAt(2500));
+    EXPECT_EQ(2, lyrics.lineAt(60000));
+
+    // Hints which are stale or ahead of the position still give the right line
+    EXPECT_EQ(1, lyrics.lineAt(2500, 0));
+    EXPECT_EQ(2, lyrics.lineAt(3500, 0));
+    EXPECT_EQ(0, lyrics.lineAt(1500, 2));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,121 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/memoryusage.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace Fooyin::Testing {
+namespace {
+class MemoryUsageTest : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        for(const int source : m_sources) {
+            MemoryUsage::removeSource(source);
+        }
+    }
+
+    int addSource(const QString& name, size_t& bytes, MemoryUsage::TrimFunc trim = {},
+                  MemoryUsage::TrimPriority priority = MemoryUsage::TrimPriority::Normal)
+    {
+        const int id = MemoryUsage::addSource(
+            name, [&bytes]() { return MemoryUsage::Usage{.bytes = bytes, .entries = bytes > 0 ? 1U : 0U}; },
+            std::move(trim), priority);
+        m_sources.push_back(id);
+        return id;
+    }
+
+private:
+    std::vector<int> m_sources;
+};
+} // namespace
+
+TEST_F(MemoryUsageTest, ReportsSourcesSharingANameTogether)
+{
+    size_t first{100};
+    size_t second{50};
+    size_t other{25};
+
+    addSource(QStringLiteral("Items"), first);
+    addSource(QStringLiteral("Other"), other, [&other]() { other = 0; });
+    addSource(QStringLiteral("Items"), second);
+
+    const auto report = MemoryUsage::report();
+    ASSERT_EQ(2, report.size());
+
+    EXPECT_EQ(QStringLiteral("Items"), report.at(0).name);
+    EXPECT_EQ(150, report.at(0).usage.bytes);
+    EXPECT_EQ(2, report.at(0).usage.entries);
+    EXPECT_FALSE(report.at(0).trimmable);
+
+    EXPECT_EQ(QStringLiteral("Other"), report.at(1).name);
+    EXPECT_TRUE(report.at(1).trimmable);
+
+    EXPECT_EQ(175, MemoryUsage::total());
+}
+
+TEST_F(MemoryUsageTest, TrimsInPriorityOrderUntilTargetIsMet)
+{
+    size_t tracks{1000};
+    size_t strings{300};
+    size_t covers{400};
+    size_t scripts{200};
+
+    std::vector<QString> trimmed;
+    const auto trimmer = [&trimmed](const QString& name, size_t& bytes) {
+        return [&trimmed, name, &bytes]() {
+            trimmed.push_back(name);
+            bytes = 0;
+        };
+    };
+
+    addSource(QStringLiteral("Tracks"), tracks);
+    addSource(QStringLiteral("Strings"), strings, trimmer(QStringLiteral("Strings"), strings),
+              MemoryUsage::TrimPriority::Last);
+    addSource(QStringLiteral("Covers"), covers, trimmer(QStringLiteral("Covers"), covers));
+    addSource(QStringLiteral("Scripts"), scripts, trimmer(QStringLiteral("Scripts"), scripts),
+              MemoryUsage::TrimPriority::First);
+
+    // Dropping scripts and covers is enough, so strings are kept
+    EXPECT_EQ(600, MemoryUsage::trim(1400));
+    EXPECT_EQ((std::vector<QString>{QStringLiteral("Scripts"), QStringLiteral("Covers")}), trimmed);
+    EXPECT_EQ(300, strings);
+
+    trimmed.clear();
+    EXPECT_EQ(300, MemoryUsage::trim());
+    EXPECT_EQ(std::vector<QString>{QStringLiteral("Strings")}, trimmed);
+    EXPECT_EQ(1000, MemoryUsage::total());
+}
+
+TEST_F(MemoryUsageTest, RemovedSourcesAreNotReported)
+{
+    size_t bytes{10};
+    const int id = addSource(QStringLiteral("Removed"), bytes);
+
+    MemoryUsage::removeSource(id);
+
+    const auto report = MemoryUsage::report();
+    EXPECT_TRUE(std::ranges::none_of(report, [](const auto& entry) { return entry.name == u"Removed"; }));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,92 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/metrics.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(MetricsTest, SameNameReturnsSameMetric)
+{
+    auto& first  = Metrics::counter("test_same_counter", "First");
+    auto& second = Metrics::counter("test_same_counter", "Second");
+
+    EXPECT_EQ(&first, &second);
+
+    const uint64_t before = first.value();
+    second.add(3);
+    EXPECT_EQ(first.value(), before + 3);
+}
+
+TEST(MetricsTest, ExportsCountersAndGauges)
+{
+    Metrics::counter("test_export_events", "Events seen").add(2);
+    Metrics::gauge("test_export_level", "Current level").set(0.5);
+
+    const QByteArray metrics = Metrics::openMetrics();
+
+    EXPECT_TRUE(metrics.contains("# TYPE test_export_events counter\n# HELP test_export_events Events seen\n"));
+    EXPECT_TRUE(metrics.contains("\ntest_export_events_total 2\n"));
+    EXPECT_TRUE(metrics.contains("# TYPE test_export_level gauge\n"));
+    EXPECT_TRUE(metrics.contains("\ntest_export_level 0.5\n"));
+    EXPECT_TRUE(metrics.endsWith("# EOF\n"));
+}
+
+TEST(MetricsTest, ExportsHistogramsInSeconds)
+{
+    auto& histogram = Metrics::histogram("test_export_seconds", "Durations");
+    histogram.record(uint64_t{0});
+    histogram.record(uint64_t{3});
+    histogram.record(uint64_t{1000000});
+
+    EXPECT_EQ(histogram.count(), 3);
+    EXPECT_EQ(histogram.bucketCount(0), 1);
+    EXPECT_EQ(histogram.bucketCount(2), 1);
+
+    const QByteArray metrics = Metrics::openMetrics();
+
+    EXPECT_TRUE(metrics.contains("\ntest_export_seconds_bucket{le=\"0\"} 1\n"));
+    EXPECT_TRUE(metrics.contains("\ntest_export_seconds_bucket{le=\"3e-06\"} 2\n"));
+    EXPECT_TRUE(metrics.contains("\ntest_export_seconds_bucket{le=\"+Inf\"} 3\n"));
+    EXPECT_TRUE(metrics.contains("\ntest_export_seconds_sum 1.000003\n"));
+    EXPECT_TRUE(metrics.contains("\ntest_export_seconds_count 3\n"));
+}
+
+TEST(MetricsTest, GroupsCollectedSamplesByName)
+{
+    const int id = Metrics::addCollector([](Metrics::SampleList& samples) {
+        samples.push_back({QStringLiteral("test_collected_underruns"), QStringLiteral("Underruns"),
+                           Metrics::Type::Counter, Metrics::label(QStringLiteral("output"), QStringLiteral("A")), 1});
+        samples.push_back({QStringLiteral("test_collected_fill"), {}, Metrics::Type::Gauge, {}, 0.25});
+        samples.push_back({QStringLiteral("test_collected_underruns"), {}, Metrics::Type::Counter,
+                           Metrics::label(QStringLiteral("output"), QStringLiteral("B\"")), 4});
+    });
+
+    const QByteArray metrics = Metrics::openMetrics();
+    Metrics::removeCollector(id);
+
+    EXPECT_TRUE(
+        metrics.contains("# TYPE test_collected_underruns counter\n# HELP test_collected_underruns Underruns\n"
+                         "test_collected_underruns_total{output=\"A\"} 1\n"
+                         "test_collected_underruns_total{output=\"B\\\"\"} 4\n"
+                         "# TYPE test_collected_fill gauge\ntest_collected_fill 0.25\n"));
+
+    EXPECT_FALSE(Metrics::openMetrics().contains("test_collected_fill"));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,55 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/ffmpeg/ffmpegnetworkstream.h"
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(NetworkStreamTest, StreamsHttpUrls)
+{
+    EXPECT_TRUE(NetworkStream::canStream(QStringLiteral("http://radio.example.com:8000/stream")));
+    EXPECT_TRUE(NetworkStream::canStream(QStringLiteral("HTTPS://radio.example.com/live.mp3")));
+
+    EXPECT_FALSE(NetworkStream::canStream(QStringLiteral("/home/user/music/song.mp3")));
+    EXPECT_FALSE(NetworkStream::canStream(QStringLiteral("file:///home/user/music/song.mp3")));
+    EXPECT_FALSE(NetworkStream::canStream(QStringLiteral("rtmp://radio.example.com/live")));
+    // Left to FFmpeg's HLS demuxer
+    EXPECT_FALSE(NetworkStream::canStream(QStringLiteral("https://radio.example.com/live/playlist.m3u8")));
+}
+
+TEST(NetworkStreamTest, ParsesIcyTitle)
+{
+    EXPECT_EQ(QStringLiteral("Artist - Title"),
+              NetworkStream::icyTitle("StreamTitle='Artist - Title';StreamUrl='http://example.com';"));
+    EXPECT_EQ(QStringLiteral("Artist - Title"), NetworkStream::icyTitle("StreamTitle='Artist - Title';"));
+    EXPECT_EQ(QStringLiteral("Don't Stop"), NetworkStream::icyTitle("StreamTitle='Don't Stop';"));
+    EXPECT_EQ(QStringLiteral("Unterminated"), NetworkStream::icyTitle("StreamTitle='Unterminated'"));
+
+    EXPECT_TRUE(NetworkStream::icyTitle("StreamTitle='';").isEmpty());
+    EXPECT_TRUE(NetworkStream::icyTitle("StreamUrl='http://example.com';").isEmpty());
+    EXPECT_TRUE(NetworkStream::icyTitle({}).isEmpty());
+}
+
+TEST(NetworkStreamTest, FallsBackToLatin1)
+{
+    EXPECT_EQ(QStringLiteral("Björk"), NetworkStream::icyTitle("StreamTitle='Bj\xc3\xb6rk';"));
+    EXPECT_EQ(QStringLiteral("Björk"), NetworkStream::icyTitle("StreamTitle='Bj\xf6rk';"));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,122 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <utils/packfile.h>
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace Fooyin::Testing {
+class PackFileTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        m_path = m_dir.filePath(QStringLiteral("test.pack"));
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+};
+
+TEST_F(PackFileTest, InsertAndReopen)
+{
+    {
+        PackFile pack{m_path};
+        ASSERT_TRUE(pack.open());
+
+        EXPECT_TRUE(pack.insert(QStringLiteral("a"), QByteArrayLiteral("first")));
+        EXPECT_TRUE(pack.insert(QStringLiteral("b"), QByteArrayLiteral("second")));
+        EXPECT_TRUE(pack.insert(QStringLiteral("a"), QByteArrayLiteral("replaced")));
+        EXPECT_FALSE(pack.insert(QStringLiteral("c"), {}));
+
+        EXPECT_EQ(2, pack.count());
+        EXPECT_EQ(QByteArrayLiteral("replaced"), pack.value(QStringLiteral("a")));
+        EXPECT_GT(pack.wastedSize(), 0);
+    }
+
+    PackFile pack{m_path};
+    ASSERT_TRUE(pack.open());
+
+    EXPECT_EQ(2, pack.count());
+    EXPECT_EQ(QByteArrayLiteral("replaced"), pack.value(QStringLiteral("a")));
+    EXPECT_EQ(QByteArrayLiteral("second"), pack.value(QStringLiteral("b")));
+    EXPECT_TRUE(pack.value(QStringLiteral("c")).isEmpty());
+}
+
+TEST_F(PackFileTest, RemoveAndCompact)
+{
+    PackFile pack{m_path};
+    ASSERT_TRUE(pack.open());
+
+    for(int i{0}; i < 10; ++i) {
+        EXPECT_TRUE(pack.insert(QString::number(i), QByteArray(100, static_cast<char>('a' + i))));
+    }
+    for(int i{0}; i < 10; i += 2) {
+        EXPECT_TRUE(pack.remove(QString::number(i)));
+    }
+    EXPECT_FALSE(pack.remove(QStringLiteral("0")));
+    EXPECT_EQ(5, pack.count());
+
+    const int64_t size = pack.size();
+    ASSERT_TRUE(pack.compact());
+    EXPECT_LT(pack.size(), size);
+    EXPECT_EQ(0, pack.wastedSize());
+
+    pack.close();
+    ASSERT_TRUE(pack.open());
+
+    EXPECT_EQ(5, pack.count());
+    for(int i{0}; i < 10; ++i) {
+        EXPECT_EQ(i % 2 != 0, pack.contains(QString::number(i)));
+    }
+    EXPECT_EQ(QByteArray(100, 'b'), pack.value(QStringLiteral("1")));
+
+    EXPECT_TRUE(pack.clear());
+    EXPECT_EQ(0, pack.count());
+}
+
+TEST_F(PackFileTest, DiscardsTornRecord)
+{
+    {
+        PackFile pack{m_path};
+        ASSERT_TRUE(pack.open());
+        EXPECT_TRUE(pack.insert(QStringLiteral("a"), QByteArrayLiteral("complete")));
+        EXPECT_TRUE(pack.insert(QStringLiteral("b"), QByteArray(64, 'x')));
+    }
+
+    QFile file{m_path};
+    ASSERT_TRUE(file.resize(file.size() - 10));
+
+    PackFile pack{m_path};
+    ASSERT_TRUE(pack.open());
+    EXPECT_EQ(1, pack.count());
+    EXPECT_EQ(QByteArrayLiteral("complete"), pack.value(QStringLiteral("a")));
+
+    EXPECT_TRUE(pack.insert(QStringLiteral("c"), QByteArrayLiteral("after")));
+    pack.close();
+
+    ASSERT_TRUE(pack.open());
+    EXPECT_EQ(QByteArrayLiteral("after"), pack.value(QStringLiteral("c")));
+}
+} // namespace Fooyin::Testing
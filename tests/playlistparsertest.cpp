@@ -0,0 +1,178 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <core/playlist/playlistparser.h>
+#include <core/track.h>
+
+#include <QBuffer>
+
+#include <gtest/gtest.h>
+
+namespace {
+using Fooyin::PlaylistParser::Entry;
+using Fooyin::PlaylistParser::Format;
+
+std::vector<Entry> readEntries(const QByteArray& data, Format format, bool* success = nullptr)
+{
+    QByteArray contents{data};
+    QBuffer buffer{&contents};
+    buffer.open(QIODevice::ReadOnly);
+
+    std::vector<Entry> entries;
+    const bool result = Fooyin::PlaylistParser::read(&buffer, format, QStringLiteral("/music/lists"),
+                                                     [&entries](const Entry& entry) {
+                                                         entries.push_back(entry);
+                                                         return true;
+                                                     });
+    if(success) {
+        *success = result;
+    }
+    return entries;
+}
+
+Fooyin::Track makeTrack(const QString& filepath, const QString& title, uint64_t duration)
+{
+    Fooyin::Track track{filepath};
+    track.setTitle(title);
+    track.setArtists({QStringLiteral("Artist")});
+    track.setDuration(duration);
+    return track;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(PlaylistParserTest, FormatFromExtension)
+{
+    EXPECT_EQ(PlaylistParser::formatForFile(QStringLiteral("/a/list.m3u")), Format::M3u);
+    EXPECT_EQ(PlaylistParser::formatForFile(QStringLiteral("/a/list.M3U8")), Format::M3u8);
+    EXPECT_EQ(PlaylistParser::formatForFile(QStringLiteral("/a/list.pls")), Format::Pls);
+    EXPECT_EQ(PlaylistParser::formatForFile(QStringLiteral("/a/list.xspf")), Format::Xspf);
+    EXPECT_EQ(PlaylistParser::formatForFile(QStringLiteral("/a/list.txt")), Format::Unknown);
+}
+
+TEST(PlaylistParserTest, ReadsExtendedM3u)
+{
+    const auto entries = readEntries("\xEF\xBB\xBF#EXTM3U\n"
+                                     "#EXTINF:123,Artist - Title\n"
+                                     "../One.flac\n"
+                                     "\n"
+                                     "# A comment\n"
+                                     "http://stream.example/radio\n"
+                                     "file:///music/Two.flac\r\n"
+                                     "sub\\Three.mp3\n",
+                                     Format::M3u);
+
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries.at(0).filepath, QStringLiteral("/music/One.flac"));
+    EXPECT_EQ(entries.at(0).title, QStringLiteral("Artist - Title"));
+    EXPECT_EQ(entries.at(0).duration, 123000);
+    EXPECT_EQ(entries.at(1).filepath, QStringLiteral("/music/Two.flac"));
+    EXPECT_TRUE(entries.at(1).title.isEmpty());
+    EXPECT_EQ(entries.at(2).filepath, QStringLiteral("/music/lists/sub/Three.mp3"));
+}
+
+TEST(PlaylistParserTest, ReadsPls)
+{
+    bool success{false};
+    const auto entries = readEntries("[playlist]\n"
+                                     "File1=/music/One.flac\n"
+                                     "Title1=One\n"
+                                     "Length1=61\n"
+                                     "File2=Two.flac\n"
+                                     "Length2=-1\n"
+                                     "NumberOfEntries=2\n"
+                                     "Version=2\n",
+                                     Format::Pls, &success);
+
+    EXPECT_TRUE(success);
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries.at(0).title, QStringLiteral("One"));
+    EXPECT_EQ(entries.at(0).duration, 61000);
+    EXPECT_EQ(entries.at(1).filepath, QStringLiteral("/music/lists/Two.flac"));
+    EXPECT_EQ(entries.at(1).duration, 0);
+
+    readEntries("File1=/music/One.flac\n", Format::Pls, &success);
+    EXPECT_FALSE(success);
+}
+
+TEST(PlaylistParserTest, ReadsXspf)
+{
+    const auto entries = readEntries(R"(<?xml version="1.0" encoding="UTF-8"?>
+<playlist version="1" xmlns="http://xspf.org/ns/0/">
+  <trackList>
+    <track>
+      <location>file:///music/A%20Song.flac</location>
+      <title>A Song</title>
+      <duration>5000</duration>
+      <extension application="x"><data/></extension>
+    </track>
+    <track><location>Relative.ogg</location></track>
+    <track><location>https://example.com/stream</location></track>
+  </trackList>
+</playlist>)",
+                                     Format::Xspf);
+
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries.at(0).filepath, QStringLiteral("/music/A Song.flac"));
+    EXPECT_EQ(entries.at(0).title, QStringLiteral("A Song"));
+    EXPECT_EQ(entries.at(0).duration, 5000);
+    EXPECT_EQ(entries.at(1).filepath, QStringLiteral("/music/lists/Relative.ogg"));
+}
+
+TEST(PlaylistParserTest, StopsWhenCallbackReturnsFalse)
+{
+    QByteArray contents{"/a.flac\n/b.flac\n/c.flac\n"};
+    QBuffer buffer{&contents};
+    buffer.open(QIODevice::ReadOnly);
+
+    int count{0};
+    EXPECT_TRUE(PlaylistParser::read(&buffer, Format::M3u8, QStringLiteral("/"), [&count](const Entry& /*entry*/) {
+        return ++count < 2;
+    }));
+    EXPECT_EQ(count, 2);
+}
+
+TEST(PlaylistParserTest, WrittenPlaylistsReadBack)
+{
+    const TrackList tracks{makeTrack(QStringLiteral("/music/lists/Ünïcode & Co.flac"), QStringLiteral("One"), 61500),
+                           makeTrack(QStringLiteral("/other/Two.mp3"), QStringLiteral("Two"), 0)};
+
+    for(const Format format : {Format::M3u8, Format::Pls, Format::Xspf}) {
+        for(const bool relative : {false, true}) {
+            QByteArray contents;
+            QBuffer buffer{&contents};
+            buffer.open(QIODevice::WriteOnly);
+            ASSERT_TRUE(PlaylistParser::write(&buffer, format, tracks, QStringLiteral("/music/lists"), relative));
+            buffer.close();
+
+            if(relative) {
+                EXPECT_FALSE(contents.contains("/music/lists/"));
+            }
+
+            const auto entries = readEntries(contents, format);
+            ASSERT_EQ(entries.size(), tracks.size());
+            EXPECT_EQ(entries.at(0).filepath, tracks.at(0).filepath());
+            EXPECT_EQ(entries.at(0).duration / 1000, 61);
+            EXPECT_EQ(entries.at(1).filepath, tracks.at(1).filepath());
+            EXPECT_EQ(entries.at(1).duration, 0);
+        }
+    }
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,109 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/prefixsumtree.h>
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <random>
+
+namespace Fooyin::Testing {
+TEST(PrefixSumTreeTest, Empty)
+{
+    const PrefixSumTree<int> tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(0, tree.total());
+    EXPECT_EQ(0, tree.indexAt(0));
+    EXPECT_EQ(0, tree.indexAt(100));
+}
+
+TEST(PrefixSumTreeTest, PrefixMatchesRunningTotal)
+{
+    std::vector<int> values(1000);
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> dist{0, 60};
+    std::ranges::generate(values, [&]() { return dist(gen); });
+
+    const PrefixSumTree<int> tree{values};
+    ASSERT_EQ(values.size(), tree.size());
+
+    int sum{0};
+    for(size_t i{0}; i <= values.size(); ++i) {
+        EXPECT_EQ(sum, tree.prefix(i));
+        if(i < values.size()) {
+            sum += values.at(i);
+        }
+    }
+    EXPECT_EQ(sum, tree.total());
+}
+
+TEST(PrefixSumTreeTest, SetUpdatesSums)
+{
+    std::vector<int> values(37, 20);
+    PrefixSumTree<int> tree{values};
+
+    tree.set(0, 50);
+    tree.set(20, 0);
+    tree.set(36, 5);
+    values[0]  = 50;
+    values[20] = 0;
+    values[36] = 5;
+
+    for(size_t i{0}; i <= values.size(); ++i) {
+        EXPECT_EQ(std::accumulate(values.begin(), values.begin() + static_cast<ptrdiff_t>(i), 0), tree.prefix(i));
+    }
+    EXPECT_EQ(50, tree.value(0));
+    EXPECT_EQ(0, tree.value(20));
+}
+
+TEST(PrefixSumTreeTest, IndexAt)
+{
+    const std::vector<int> values{10, 0, 5, 20, 0, 0, 15};
+    const PrefixSumTree<int> tree{values};
+
+    EXPECT_EQ(0, tree.indexAt(-5));
+    EXPECT_EQ(0, tree.indexAt(0));
+    EXPECT_EQ(0, tree.indexAt(9));
+    // Zero-height items are never returned
+    EXPECT_EQ(2, tree.indexAt(10));
+    EXPECT_EQ(2, tree.indexAt(14));
+    EXPECT_EQ(3, tree.indexAt(15));
+    EXPECT_EQ(3, tree.indexAt(34));
+    EXPECT_EQ(6, tree.indexAt(35));
+    EXPECT_EQ(6, tree.indexAt(49));
+    EXPECT_EQ(values.size(), tree.indexAt(50));
+}
+
+TEST(PrefixSumTreeTest, IndexAtInvertsPrefix)
+{
+    std::vector<int> values(100'000);
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<int> dist{1, 80};
+    std::ranges::generate(values, [&]() { return dist(gen); });
+
+    const PrefixSumTree<int> tree{values};
+
+    for(size_t i{0}; i < values.size(); i += 997) {
+        const int start = tree.prefix(i);
+        EXPECT_EQ(i, tree.indexAt(start));
+        EXPECT_EQ(i, tree.indexAt(start + values.at(i) - 1));
+    }
+}
+} // namespace Fooyin::Testing
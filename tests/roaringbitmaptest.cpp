@@ -0,0 +1,123 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <utils/roaringbitmap.h>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+
+namespace {
+Fooyin::RoaringBitmap fromSet(const std::set<uint32_t>& values)
+{
+    return Fooyin::RoaringBitmap::fromValues(values);
+}
+
+std::vector<uint32_t> toVector(const std::set<uint32_t>& values)
+{
+    return {values.cbegin(), values.cend()};
+}
+
+std::set<uint32_t> randomSet(std::mt19937& rng, size_t count, uint32_t max)
+{
+    std::uniform_int_distribution<uint32_t> dist{0, max};
+    std::set<uint32_t> values;
+    while(values.size() < count) {
+        values.insert(dist(rng));
+    }
+    return values;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(RoaringBitmapTest, AddRemoveContains)
+{
+    RoaringBitmap bitmap;
+    EXPECT_TRUE(bitmap.empty());
+
+    EXPECT_TRUE(bitmap.add(5));
+    EXPECT_FALSE(bitmap.add(5));
+    EXPECT_TRUE(bitmap.add(70000));
+    EXPECT_EQ(2U, bitmap.size());
+
+    EXPECT_TRUE(bitmap.contains(5));
+    EXPECT_TRUE(bitmap.contains(70000));
+    EXPECT_FALSE(bitmap.contains(6));
+
+    EXPECT_TRUE(bitmap.remove(5));
+    EXPECT_FALSE(bitmap.remove(5));
+    EXPECT_FALSE(bitmap.contains(5));
+    EXPECT_EQ((std::vector<uint32_t>{70000}), bitmap.values());
+
+    EXPECT_TRUE(bitmap.remove(70000));
+    EXPECT_TRUE(bitmap.empty());
+}
+
+TEST(RoaringBitmapTest, DenseChunksStayCorrect)
+{
+    // Enough values in one chunk to switch it to a bitmap, and back again once most are removed
+    RoaringBitmap bitmap;
+    std::set<uint32_t> expected;
+    for(uint32_t value{0}; value < 10000; value += 2) {
+        bitmap.add(value);
+        expected.insert(value);
+    }
+    EXPECT_EQ(toVector(expected), bitmap.values());
+
+    for(uint32_t value{0}; value < 9000; value += 2) {
+        bitmap.remove(value);
+        expected.erase(value);
+    }
+    EXPECT_EQ(toVector(expected), bitmap.values());
+    EXPECT_EQ(expected.size(), bitmap.size());
+}
+
+TEST(RoaringBitmapTest, MatchesSetOperations)
+{
+    std::mt19937 rng{42};
+
+    // Covers sparse and dense chunks on either side
+    for(const size_t count : {10U, 3000U, 20000U}) {
+        const auto lhs = randomSet(rng, count, 200000);
+        const auto rhs = randomSet(rng, 8000, 200000);
+
+        std::vector<uint32_t> intersection;
+        std::ranges::set_intersection(lhs, rhs, std::back_inserter(intersection));
+        std::vector<uint32_t> combined;
+        std::ranges::set_union(lhs, rhs, std::back_inserter(combined));
+
+        EXPECT_EQ(intersection, (fromSet(lhs) & fromSet(rhs)).values());
+        EXPECT_EQ(intersection, (fromSet(rhs) & fromSet(lhs)).values());
+        EXPECT_EQ(combined, (fromSet(lhs) | fromSet(rhs)).values());
+        EXPECT_EQ(combined, (fromSet(rhs) | fromSet(lhs)).values());
+    }
+}
+
+TEST(RoaringBitmapTest, Equality)
+{
+    const std::set<uint32_t> values{1, 2, 3, 100000};
+    EXPECT_EQ(fromSet(values), fromSet(values));
+
+    RoaringBitmap other = fromSet(values);
+    other.remove(100000);
+    EXPECT_NE(fromSet(values), other);
+}
+} // namespace Fooyin::Testing
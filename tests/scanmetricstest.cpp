@@ -0,0 +1,85 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/library/scanmetrics.h"
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(ScanMetricsTest, MergesReaderMetrics)
+{
+    ScanMetrics metrics;
+    metrics.databaseWriteTime.add(5000);
+
+    ScanMetrics first;
+    first.addRead(QStringLiteral("flac"), 1000);
+    first.addRead(QStringLiteral("flac"), 3000);
+    first.bytesRead = 4096;
+    first.addError(ScanMetrics::Error::Unreadable);
+
+    ScanMetrics second;
+    second.addRead(QStringLiteral("mp3"), 2000);
+    second.bytesRead = 1024;
+    second.addError(ScanMetrics::Error::Unreadable);
+    second.addError(ScanMetrics::Error::Unsupported);
+
+    metrics.merge(first);
+    metrics.merge(second);
+
+    EXPECT_EQ(3, metrics.tracksRead);
+    EXPECT_EQ(5120, metrics.bytesRead);
+    ASSERT_EQ(2, metrics.readTimes.size());
+    EXPECT_EQ(2, metrics.readTimes.at(QStringLiteral("flac")).count());
+    EXPECT_EQ(1, metrics.readTimes.at(QStringLiteral("mp3")).count());
+    EXPECT_EQ(3, metrics.totalReadTime().count());
+    EXPECT_EQ(1, metrics.databaseWriteTime.count());
+
+    EXPECT_EQ(3, metrics.errorCount());
+    EXPECT_EQ(2, metrics.errorCount(ScanMetrics::Error::Unreadable));
+    EXPECT_EQ(1, metrics.errorCount(ScanMetrics::Error::Unsupported));
+    EXPECT_EQ(0, metrics.errorCount(ScanMetrics::Error::Database));
+}
+
+TEST(ScanMetricsTest, Rates)
+{
+    ScanMetrics metrics;
+    EXPECT_EQ(0.0, metrics.filesPerSecond());
+    EXPECT_EQ(0.0, metrics.tracksPerSecond());
+
+    metrics.filesDiscovered = 500;
+    metrics.discoveryTime   = 250000;
+    metrics.tracksRead      = 100;
+    metrics.elapsed         = 2000000;
+
+    EXPECT_DOUBLE_EQ(2000.0, metrics.filesPerSecond());
+    EXPECT_DOUBLE_EQ(50.0, metrics.tracksPerSecond());
+}
+
+TEST(ScanMetricsTest, Summary)
+{
+    ScanMetrics metrics;
+    metrics.addRead(QStringLiteral("flac"), 1000);
+    metrics.addError(ScanMetrics::Error::CueSheet);
+
+    const QStringList summary = metrics.summary();
+    ASSERT_EQ(3, summary.size());
+    EXPECT_TRUE(summary.at(1).contains(QStringLiteral("flac")));
+    EXPECT_EQ(QStringLiteral("Errors: 1 cue"), summary.at(2));
+}
+} // namespace Fooyin::Testing
@@ -35,6 +35,28 @@ TEST_F(ScriptFormatterTest, NoFormat)
     EXPECT_EQ(1, result.size());
 }
 
+TEST_F(ScriptFormatterTest, NoFormatKeepsText)
+{
+    const QString input = QStringLiteral("%artist% - $if(a,b) [x] \\y: \"z\" = 1/2");
+
+    const auto result = m_formattter.evaluate(input);
+    ASSERT_EQ(1, result.size());
+    EXPECT_EQ(input, result.front().text);
+    EXPECT_FALSE(result.front().format.font.bold());
+}
+
+TEST_F(ScriptFormatterTest, RepeatedInput)
+{
+    const QString input = QStringLiteral("<b>Disc 1</b> <i>2001</i>");
+
+    const auto first  = m_formattter.evaluate(input);
+    const auto second = m_formattter.evaluate(input);
+    ASSERT_EQ(3, first.size());
+    EXPECT_EQ(first, second);
+    EXPECT_TRUE(second.front().format.font.bold());
+    EXPECT_TRUE(second.back().format.font.italic());
+}
+
 TEST_F(ScriptFormatterTest, Bold)
 {
     const auto result = m_formattter.evaluate(QStringLiteral("<b>I</b> am a test."));
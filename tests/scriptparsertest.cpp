@@ -18,10 +18,13 @@
  */
 
 #include <core/scripting/scriptparser.h>
+#include <core/scripting/scriptregistry.h>
 #include <core/track.h>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 namespace Fooyin::Testing {
 class ScriptParserTest : public ::testing::Test
 {
@@ -82,6 +85,21 @@ TEST_F(ScriptParserTest, ConditionalTest)
     EXPECT_EQ(u"true", m_parser.evaluate(QStringLiteral("$iflonger(aaa,bb,true,false)")));
 }
 
+TEST_F(ScriptParserTest, ConditionalBlockTest)
+{
+    Track track;
+    track.setTitle(QStringLiteral("Title"));
+
+    EXPECT_EQ(u"Title - ", m_parser.evaluate(QStringLiteral("%title% - [%album% - ]"), track));
+    EXPECT_EQ(u"Title", m_parser.evaluate(QStringLiteral("[%title%[ - %album%]]"), track));
+    EXPECT_EQ(u"[Title]", m_parser.evaluate(QStringLiteral(R"("["[%title%]"]")"), track));
+
+    track.setAlbum(QStringLiteral("Album"));
+
+    EXPECT_EQ(u"Title - Album - ", m_parser.evaluate(QStringLiteral("%title% - [%album% - ]"), track));
+    EXPECT_EQ(u"Title - Album", m_parser.evaluate(QStringLiteral("[%title%[ - %album%]]"), track));
+}
+
 TEST_F(ScriptParserTest, MetadataTest)
 {
     Track track;
@@ -108,6 +126,111 @@ TEST_F(ScriptParserTest, MetadataTest)
     EXPECT_EQ(u"", m_parser.evaluate(QStringLiteral("[%disc% - %track%]"), track));
 }
 
+TEST_F(ScriptParserTest, EvaluateValuesTest)
+{
+    Track track1;
+    track1.setGenres({QStringLiteral("Pop"), QStringLiteral("Rock")});
+    track1.setArtists({QStringLiteral("Me")});
+
+    Track track2;
+    track2.setGenres({QStringLiteral("Jazz")});
+
+    const TrackList tracks{track1, track2, Track{}};
+
+    const auto script = m_parser.parse(QStringLiteral("%<genre>%[ - %<artist>%]"));
+    const auto values = ScriptParser::evaluateEachValues(script, tracks);
+
+    ASSERT_EQ(3, values.size());
+    EXPECT_EQ(QStringList({QStringLiteral("Pop - Me"), QStringLiteral("Rock - Me")}), values.at(0));
+    EXPECT_EQ(QStringList{QStringLiteral("Jazz")}, values.at(1));
+    EXPECT_EQ(QStringList{QStringLiteral("")}, values.at(2));
+
+    EXPECT_EQ(u"Pop - Me\037Rock - Me", ScriptParser::evaluateEach(script, tracks).front());
+}
+
+TEST_F(ScriptParserTest, EvaluateBatchTest)
+{
+    Track track1;
+    track1.setTitle(QStringLiteral("One"));
+    Track track2;
+    track2.setTitle(QStringLiteral("Two"));
+
+    const TrackList tracks{track1, track2};
+    const auto script = m_parser.parse(QStringLiteral("$upper(%title%)"));
+
+    std::vector<QString> results(tracks.size());
+    m_parser.evaluateBatch(script, tracks, results);
+
+    EXPECT_EQ((std::vector<QString>{QStringLiteral("ONE"), QStringLiteral("TWO")}), results);
+}
+
+TEST_F(ScriptParserTest, ProfileTest)
+{
+    Track track;
+    track.setTitle(QStringLiteral("Test"));
+
+    const TrackList tracks{track, track, track};
+    const auto script  = m_parser.parse(QStringLiteral("$upper(%title%) $lower(%title%) $upper(abc)"));
+    const auto profile = m_parser.profile(script, tracks);
+
+    EXPECT_EQ(3, profile.evaluations);
+    ASSERT_EQ(3, profile.entries.size());
+
+    const auto entry = [&profile](const QString& name) {
+        return std::ranges::find(profile.entries, name, &ScriptProfileEntry::name);
+    };
+
+    // Called with a literal, so $upper(abc) is folded and not profiled
+    EXPECT_EQ(3, entry(QStringLiteral("upper"))->calls);
+    EXPECT_EQ(3, entry(QStringLiteral("lower"))->calls);
+    EXPECT_EQ(6, entry(QStringLiteral("title"))->calls);
+    EXPECT_FALSE(entry(QStringLiteral("title"))->function);
+}
+
+TEST_F(ScriptParserTest, ConstantFoldingTest)
+{
+    EXPECT_EQ(u"5 - ABC", m_parser.evaluate(QStringLiteral("$add($add(1,1),3) - $upper(abc)")));
+    EXPECT_EQ(u"no", m_parser.evaluate(QStringLiteral("$if($strcmp(a,b),yes,no)")));
+    EXPECT_EQ(u"", m_parser.evaluate(QStringLiteral("[$if($strcmp(a,b),yes)]")));
+}
+
+TEST_F(ScriptParserTest, TrackCacheTest)
+{
+    Track track1{QStringLiteral("/music/1.flac")};
+    track1.setTitle(QStringLiteral("One"));
+
+    Track track2{QStringLiteral("/music/2.flac")};
+    track2.setTitle(QStringLiteral("Two"));
+
+    m_parser.setTrackCacheEnabled(true);
+
+    EXPECT_EQ(u"ONE", m_parser.evaluate(QStringLiteral("$upper(%title%)"), track1));
+    EXPECT_EQ(u"ONE!", m_parser.evaluate(QStringLiteral("$upper(%title%)!"), track1));
+    EXPECT_EQ(u"TWO!", m_parser.evaluate(QStringLiteral("$upper(%title%)!"), track2));
+    EXPECT_EQ(u"ONE", m_parser.evaluate(QStringLiteral("$upper(%title%)"), track1));
+
+    m_parser.setTrackCacheEnabled(false);
+    track1.setTitle(QStringLiteral("Uno"));
+
+    EXPECT_EQ(u"UNO", m_parser.evaluate(QStringLiteral("$upper(%title%)"), track1));
+}
+
+TEST_F(ScriptParserTest, OtherRegistryTest)
+{
+    Track track;
+    track.setTitle(QStringLiteral("A Test"));
+    track.addExtraTag(QStringLiteral("MOOD"), QStringLiteral("Happy"));
+
+    const auto script = m_parser.parse(QStringLiteral("$upper(%title%) - %mood%"));
+
+    ScriptRegistry registry;
+    ScriptParser parser{&registry};
+
+    EXPECT_EQ(u"A TEST - Happy", m_parser.evaluate(script, track));
+    EXPECT_EQ(u"A TEST - Happy", parser.evaluate(script, track));
+    EXPECT_EQ(u"A TEST - Happy", parser.evaluate(script, track));
+}
+
 TEST_F(ScriptParserTest, TrackListTest)
 {
     TrackList tracks;
@@ -126,4 +249,19 @@ TEST_F(ScriptParserTest, TrackListTest)
     EXPECT_EQ(u"00:05", m_parser.evaluate(QStringLiteral("%playtime%"), tracks));
     EXPECT_EQ(u"Pop / Rock", m_parser.evaluate(QStringLiteral("%genres%"), tracks));
 }
+
+TEST_F(ScriptParserTest, DependenciesTest)
+{
+    const auto script = m_parser.parse(QStringLiteral("[%Artist% - ]$upper(%title%)"));
+    EXPECT_EQ((QStringList{QStringLiteral("artist"), QStringLiteral("title")}), script.dependencies.variables);
+    EXPECT_FALSE(script.dependencies.allFields);
+    EXPECT_FALSE(script.dependencies.dependsOnStats());
+    EXPECT_TRUE(script.dependencies.dependsOn({QStringLiteral("title")}));
+
+    EXPECT_TRUE(m_parser.parse(QStringLiteral("%playcount% plays")).dependencies.dependsOnStats());
+
+    const auto metaScript = m_parser.parse(QStringLiteral("$meta(rating)"));
+    EXPECT_TRUE(metaScript.dependencies.allFields);
+    EXPECT_TRUE(metaScript.dependencies.dependsOnStats());
+}
 } // namespace Fooyin::Testing
@@ -0,0 +1,60 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/engine/seekindex.h"
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(SeekIndexTest, AddRespectsInterval)
+{
+    SeekIndex index;
+    EXPECT_EQ(-1, index.lastTimestamp());
+
+    index.add(0, 100, 10);
+    index.add(5, 150, 10);
+    index.add(10, 200, 10);
+    index.add(19, 250, 10);
+    index.add(25, 300, 10);
+
+    ASSERT_EQ(3, index.points().size());
+    EXPECT_EQ(25, index.lastTimestamp());
+}
+
+TEST(SeekIndexTest, FindReturnsPointAtOrBefore)
+{
+    SeekIndex index;
+    index.setPoints({{20, 300}, {0, 100}, {10, 200}});
+
+    EXPECT_EQ(nullptr, index.find(-1));
+
+    const auto* point = index.find(0);
+    ASSERT_NE(nullptr, point);
+    EXPECT_EQ(100, point->pos);
+
+    point = index.find(15);
+    ASSERT_NE(nullptr, point);
+    EXPECT_EQ(10, point->timestamp);
+    EXPECT_EQ(200, point->pos);
+
+    point = index.find(1000);
+    ASSERT_NE(nullptr, point);
+    EXPECT_EQ(300, point->pos);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,155 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/coresettings.h>
+#include <utils/settings/settingsmanager.h>
+
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace Fooyin::Settings::Core;
+
+namespace Fooyin::Testing {
+class SettingsManagerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        m_settings = std::make_unique<SettingsManager>(m_dir.filePath(QStringLiteral("fooyin.conf")));
+    }
+
+    QTemporaryDir m_dir;
+    std::unique_ptr<SettingsManager> m_settings;
+};
+
+TEST_F(SettingsManagerTest, UnregisteredReturnsDefaults)
+{
+    EXPECT_FALSE(m_settings->value<GaplessPlayback>());
+    EXPECT_EQ(0, m_settings->value<BufferLength>());
+    EXPECT_TRUE(m_settings->value<AudioOutput>().isEmpty());
+    EXPECT_FALSE(m_settings->set<GaplessPlayback>(true));
+}
+
+TEST_F(SettingsManagerTest, TypedValues)
+{
+    m_settings->createSetting<GaplessPlayback>(true, QStringLiteral("Engine/GaplessPlayback"));
+    m_settings->createSetting<BufferLength>(4000, QStringLiteral("Engine/BufferLength"));
+    m_settings->createSetting<OutputVolume>(0.5, QStringLiteral("Engine/OutputVolume"));
+    m_settings->createSetting<AudioOutput>(QStringLiteral("ALSA"), QStringLiteral("Engine/AudioOutput"));
+    m_settings->createSetting<DspChain>(QStringList{QStringLiteral("a")}, QStringLiteral("Engine/DspChain"));
+
+    EXPECT_TRUE(m_settings->value<GaplessPlayback>());
+    EXPECT_EQ(4000, m_settings->value<BufferLength>());
+    EXPECT_DOUBLE_EQ(0.5, m_settings->value<OutputVolume>());
+    EXPECT_EQ(QStringLiteral("ALSA"), m_settings->value<AudioOutput>());
+    EXPECT_EQ(QStringList{QStringLiteral("a")}, m_settings->value<DspChain>());
+
+    EXPECT_TRUE(m_settings->set<BufferLength>(-20));
+    EXPECT_FALSE(m_settings->set<BufferLength>(-20));
+    EXPECT_EQ(-20, m_settings->value<BufferLength>());
+
+    EXPECT_TRUE(m_settings->set<AudioOutput>(QStringLiteral("PipeWire")));
+    EXPECT_EQ(QStringLiteral("PipeWire"), m_settings->value<AudioOutput>());
+
+    EXPECT_TRUE(m_settings->reset<BufferLength>());
+    EXPECT_TRUE(m_settings->reset<AudioOutput>());
+    EXPECT_EQ(4000, m_settings->value<BufferLength>());
+    EXPECT_EQ(QStringLiteral("ALSA"), m_settings->value<AudioOutput>());
+}
+
+TEST_F(SettingsManagerTest, ManagersAreIndependent)
+{
+    const SettingsManager other{m_dir.filePath(QStringLiteral("other.conf"))};
+
+    m_settings->createSetting<BufferLength>(4000, QStringLiteral("Engine/BufferLength"));
+
+    EXPECT_EQ(4000, m_settings->value<BufferLength>());
+    EXPECT_EQ(0, other.value<BufferLength>());
+}
+
+TEST_F(SettingsManagerTest, LoadsStoredValues)
+{
+    m_settings->createSetting<BufferLength>(4000, QStringLiteral("Engine/BufferLength"));
+    m_settings->set<BufferLength>(1000);
+    m_settings->storeSettings();
+
+    SettingsManager reloaded{m_dir.filePath(QStringLiteral("fooyin.conf"))};
+    reloaded.createSetting<BufferLength>(4000, QStringLiteral("Engine/BufferLength"));
+
+    EXPECT_EQ(1000, reloaded.value<BufferLength>());
+}
+
+TEST_F(SettingsManagerTest, TracksUnsavedChanges)
+{
+    m_settings->createSetting<BufferLength>(4000, QStringLiteral("Engine/BufferLength"));
+    EXPECT_FALSE(m_settings->settingsHaveChanged());
+
+    m_settings->set<BufferLength>(1000);
+    EXPECT_TRUE(m_settings->settingsHaveChanged());
+
+    m_settings->storeSettings();
+    EXPECT_FALSE(m_settings->settingsHaveChanged());
+
+    m_settings->fileSet(QStringLiteral("Custom/Value"), 5);
+    EXPECT_TRUE(m_settings->settingsHaveChanged());
+    m_settings->storeSettings();
+    EXPECT_FALSE(m_settings->settingsHaveChanged());
+
+    // Setting the stored value again doesn't need another write
+    m_settings->fileSet(QStringLiteral("Custom/Value"), 5);
+    EXPECT_FALSE(m_settings->settingsHaveChanged());
+}
+
+TEST_F(SettingsManagerTest, ConcurrentReads)
+{
+    m_settings->createSetting<AudioOutput>(QStringLiteral("0"), QStringLiteral("Engine/AudioOutput"));
+    m_settings->createSetting<BufferLength>(0, QStringLiteral("Engine/BufferLength"));
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> valid{true};
+
+    std::thread reader{[&]() {
+        while(!done.load()) {
+            bool ok{false};
+            m_settings->value<AudioOutput>().toInt(&ok);
+            if(!ok || m_settings->value<BufferLength>() < 0) {
+                valid = false;
+            }
+        }
+    }};
+
+    for(int i{1}; i <= 1000; ++i) {
+        m_settings->set<AudioOutput>(QString::number(i));
+        m_settings->set<BufferLength>(i);
+    }
+
+    done = true;
+    reader.join();
+
+    EXPECT_TRUE(valid);
+    EXPECT_EQ(QStringLiteral("1000"), m_settings->value<AudioOutput>());
+    EXPECT_EQ(1000, m_settings->value<BufferLength>());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,116 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/spscringbuffer.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <numeric>
+#include <thread>
+
+namespace Fooyin::Testing {
+TEST(SpscRingBufferTest, CapacityIsPowerOfTwo)
+{
+    const SpscRingBuffer<int> buffer{100};
+    EXPECT_EQ(128, buffer.capacity());
+    EXPECT_EQ(0, buffer.readAvailable());
+    EXPECT_EQ(128, buffer.writeAvailable());
+}
+
+TEST(SpscRingBufferTest, WriteLimitedByFreeSpace)
+{
+    SpscRingBuffer<int> buffer{8};
+
+    std::vector<int> data(12);
+    std::iota(data.begin(), data.end(), 0);
+
+    EXPECT_EQ(8, buffer.write(data));
+    EXPECT_EQ(0, buffer.writeAvailable());
+    EXPECT_EQ(0, buffer.write(data));
+
+    std::vector<int> out(12);
+    EXPECT_EQ(8, buffer.read(out));
+    EXPECT_TRUE(std::equal(out.begin(), out.begin() + 8, data.begin()));
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(SpscRingBufferTest, RegionsWrapAround)
+{
+    SpscRingBuffer<int> buffer{8};
+
+    const std::vector<int> first{1, 2, 3, 4, 5, 6};
+    buffer.write(first);
+    EXPECT_EQ(4, buffer.skip(4));
+
+    const std::vector<int> second{7, 8, 9, 10, 11};
+    EXPECT_EQ(5, buffer.write(second));
+
+    const auto regions = buffer.readRegions();
+    ASSERT_EQ(7, regions.size());
+    EXPECT_EQ(4, regions.first.size());
+    EXPECT_EQ(3, regions.second.size());
+    EXPECT_EQ(5, regions.first.front());
+    EXPECT_EQ(11, regions.second.back());
+
+    buffer.commitRead(regions.size());
+    EXPECT_EQ(11, buffer.totalRead());
+    EXPECT_EQ(11, buffer.totalWritten());
+}
+
+TEST(SpscRingBufferTest, ConcurrentProducerConsumer)
+{
+    constexpr int Total = 200000;
+
+    SpscRingBuffer<int> buffer{1024};
+
+    std::thread producer{[&buffer]() {
+        std::array<int, 37> chunk;
+        int next{0};
+        while(next < Total) {
+            const int count = std::min(static_cast<int>(chunk.size()), Total - next);
+            std::iota(chunk.begin(), chunk.begin() + count, next);
+
+            size_t written{0};
+            while(written < static_cast<size_t>(count)) {
+                written += buffer.write(chunk.data() + written, count - written);
+            }
+            next += count;
+        }
+    }};
+
+    int expected{0};
+    bool inOrder{true};
+    while(expected < Total) {
+        const auto regions = buffer.readRegions();
+        for(const int value : regions.first) {
+            inOrder &= value == expected++;
+        }
+        for(const int value : regions.second) {
+            inOrder &= value == expected++;
+        }
+        buffer.commitRead(regions.size());
+    }
+
+    producer.join();
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(buffer.empty());
+}
+} // namespace Fooyin::Testing
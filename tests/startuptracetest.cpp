@@ -0,0 +1,126 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/startuptrace.h>
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <thread>
+#include <tuple>
+
+namespace {
+QJsonArray readEvents(const QString& path)
+{
+    QFile file{path};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return QJsonDocument::fromJson(file.readAll()).object().value(QStringLiteral("traceEvents")).toArray();
+}
+
+QJsonObject findEvent(const QJsonArray& events, const QString& name, const QString& phase)
+{
+    for(const auto& value : events) {
+        const QJsonObject event = value.toObject();
+        if(event.value(QStringLiteral("name")).toString() == name
+           && event.value(QStringLiteral("ph")).toString() == phase) {
+            return event;
+        }
+    }
+    return {};
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(StartupTraceTest, DisabledByDefault)
+{
+    EXPECT_FALSE(StartupTrace::isEnabled());
+    EXPECT_EQ(0, StartupTrace::beginAsync("Async"));
+    EXPECT_FALSE(StartupTrace::finish());
+}
+
+TEST(StartupTraceTest, RecordsPhasesAcrossThreads)
+{
+    const QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("trace.json"));
+
+    StartupTrace::enable(path);
+    ASSERT_TRUE(StartupTrace::isEnabled());
+
+    uint64_t asyncId{0};
+    {
+        const StartupTrace::Scope scope{"Scope"};
+        asyncId = StartupTrace::beginAsync("Async");
+        StartupTrace::instant("Instant");
+    }
+
+    // Continued on another thread, as with a query finishing in a signal
+    std::thread worker{[asyncId]() {
+        const StartupTrace::Scope scope{"Worker"};
+        StartupTrace::endAsync(asyncId);
+    }};
+    worker.join();
+
+    std::ignore = StartupTrace::beginAsync("Unfinished");
+
+    ASSERT_TRUE(StartupTrace::finish());
+    EXPECT_FALSE(StartupTrace::isEnabled());
+
+    const QJsonArray events = readEvents(path);
+    ASSERT_FALSE(events.empty());
+
+    const QJsonObject scope = findEvent(events, QStringLiteral("Scope"), QStringLiteral("X"));
+    ASSERT_FALSE(scope.isEmpty());
+    EXPECT_GE(scope.value(QStringLiteral("dur")).toInteger(), 0);
+
+    const QJsonObject workerScope = findEvent(events, QStringLiteral("Worker"), QStringLiteral("X"));
+    ASSERT_FALSE(workerScope.isEmpty());
+    EXPECT_NE(scope.value(QStringLiteral("tid")), workerScope.value(QStringLiteral("tid")));
+
+    const QJsonObject begin = findEvent(events, QStringLiteral("Async"), QStringLiteral("b"));
+    const QJsonObject end   = findEvent(events, QStringLiteral("Async"), QStringLiteral("e"));
+    ASSERT_FALSE(begin.isEmpty());
+    ASSERT_FALSE(end.isEmpty());
+    EXPECT_EQ(begin.value(QStringLiteral("id")), end.value(QStringLiteral("id")));
+    EXPECT_EQ(scope.value(QStringLiteral("tid")), begin.value(QStringLiteral("tid")));
+    EXPECT_EQ(workerScope.value(QStringLiteral("tid")), end.value(QStringLiteral("tid")));
+    EXPECT_GE(end.value(QStringLiteral("ts")).toInteger(), begin.value(QStringLiteral("ts")).toInteger());
+
+    EXPECT_FALSE(findEvent(events, QStringLiteral("Instant"), QStringLiteral("i")).isEmpty());
+
+    const QJsonObject unfinished = findEvent(events, QStringLiteral("Unfinished"), QStringLiteral("e"));
+    ASSERT_FALSE(unfinished.isEmpty());
+    EXPECT_TRUE(unfinished.value(QStringLiteral("args")).toObject().value(QStringLiteral("unfinished")).toBool());
+
+    int threads{0};
+    for(const auto& value : events) {
+        if(value.toObject().value(QStringLiteral("ph")).toString() == u"M") {
+            ++threads;
+        }
+    }
+    EXPECT_EQ(2, threads);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,71 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/track.h>
+#include <utils/stringpool.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(StringPoolTest, EqualStringsShareStorage)
+{
+    const QString first  = StringPool::intern(QStringLiteral("Artist ") + QString::number(1));
+    const QString second = StringPool::intern(QStringLiteral("Artist 1"));
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first.constData(), second.constData());
+
+    const QString other = StringPool::intern(QStringLiteral("Artist 2"));
+    EXPECT_NE(first.constData(), other.constData());
+}
+
+TEST(StringPoolTest, InternsListsElementwise)
+{
+    const QStringList first  = StringPool::intern(QStringList{QStringLiteral("Rock"), QStringLiteral("Pop")});
+    const QStringList second = StringPool::intern(QStringList{QStringLiteral("Pop")});
+
+    ASSERT_EQ(2, first.size());
+    ASSERT_EQ(1, second.size());
+    EXPECT_EQ(first.at(1).constData(), second.at(0).constData());
+}
+
+TEST(StringPoolTest, TracksShareMetadata)
+{
+    Track first{QStringLiteral("/music/Artist/Album/01.flac")};
+    Track second{QStringLiteral("/music/Artist/Album/02.flac")};
+    first.setAlbum(QStringLiteral("Album"));
+    second.setAlbum(QStringLiteral("Album"));
+
+    EXPECT_EQ(first.album().constData(), second.album().constData());
+    EXPECT_EQ(first.extension().constData(), second.extension().constData());
+}
+TEST(StringPoolTest, PruneDropsUnreferencedStrings)
+{
+    const QString kept = StringPool::intern(QStringLiteral("Kept ") + QString::number(1));
+    static_cast<void>(StringPool::intern(QStringLiteral("Dropped ") + QString::number(1)));
+
+    const qsizetype before = StringPool::size();
+    EXPECT_GT(StringPool::memoryUsage(), 0);
+
+    StringPool::prune();
+
+    EXPECT_LT(StringPool::size(), before);
+    EXPECT_EQ(kept.constData(), StringPool::intern(QStringLiteral("Kept 1")).constData());
+}
+} // namespace Fooyin::Testing
@@ -179,6 +179,23 @@ TEST_F(TagReaderTest, Mp3Read)
     EXPECT_EQ(testTag.front(), QStringLiteral("A custom tag"));
 }
 
+TEST_F(TagReaderTest, Mp3AccurateDuration)
+{
+    const TempResource file{QStringLiteral(":/audio/audiotest.mp3")};
+
+    const uint64_t estimated = Tagging::threadEstimatedDurations();
+
+    Track track{file.fileName()};
+    Tagging::readMetaData(track);
+
+    // The file has an Info header, so the duration read is already exact
+    EXPECT_EQ(estimated, Tagging::threadEstimatedDurations());
+
+    // Walking the frames counts the Info frame as well
+    const uint64_t accurate = Tagging::readAccurateDuration(track);
+    EXPECT_NEAR(static_cast<double>(accurate), static_cast<double>(track.duration()), 50);
+}
+
 TEST_F(TagReaderTest, OggRead)
 {
     const TempResource file{QStringLiteral(":/audio/audiotest.ogg")};
@@ -0,0 +1,125 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include "core/tagging/tagreadservice.h"
+
+#include <core/track.h>
+
+#include <QDateTime>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace Fooyin::Testing {
+class TagReadServiceTest : public ::testing::Test
+{
+protected:
+    TagReadServiceTest()
+        : m_file{QStringLiteral(":/audio/audiotest.flac")}
+    { }
+
+    TempResource m_file;
+};
+
+TEST_F(TagReadServiceTest, CachesUnchangedFiles)
+{
+    TagReadService service{1};
+
+    Track first{m_file.fileName()};
+    ASSERT_TRUE(service.readMetaData(first));
+    Track second{m_file.fileName()};
+    ASSERT_TRUE(service.readMetaData(second));
+
+    EXPECT_EQ(QStringLiteral("FLAC Test"), second.title());
+    EXPECT_EQ(1U, service.stats().reads);
+    EXPECT_EQ(1U, service.stats().cacheHits);
+}
+
+TEST_F(TagReadServiceTest, ReadsChangedFilesAgain)
+{
+    TagReadService service{1};
+
+    Track track{m_file.fileName()};
+    ASSERT_TRUE(service.readMetaData(track));
+
+    ASSERT_TRUE(m_file.setFileTime(QDateTime::currentDateTime().addSecs(-60), QFileDevice::FileModificationTime));
+
+    Track changed{m_file.fileName()};
+    ASSERT_TRUE(service.readMetaData(changed));
+    EXPECT_EQ(2U, service.stats().reads);
+}
+
+TEST_F(TagReadServiceTest, DoesntCacheDatabaseTracks)
+{
+    TagReadService service{1};
+
+    for(int i{0}; i < 2; ++i) {
+        Track track{m_file.fileName()};
+        track.setId(1);
+        ASSERT_TRUE(service.readMetaData(track));
+        EXPECT_EQ(1, track.id());
+    }
+    EXPECT_EQ(2U, service.stats().reads);
+}
+
+TEST_F(TagReadServiceTest, SharesConcurrentReads)
+{
+    TagReadService service{2};
+
+    constexpr int Readers = 8;
+    std::vector<QString> titles(Readers);
+
+    {
+        std::vector<std::jthread> readers;
+        for(int i{0}; i < Readers; ++i) {
+            readers.emplace_back([this, &service, &titles, i]() {
+                Track track{m_file.fileName()};
+                service.readMetaData(track);
+                titles.at(i) = track.title();
+            });
+        }
+    }
+
+    // Every request after the first either waits on its read or finds the result cached
+    const auto stats = service.stats();
+    EXPECT_EQ(1U, stats.reads);
+    EXPECT_EQ(static_cast<uint64_t>(Readers - 1), stats.shared + stats.cacheHits);
+    for(const QString& title : titles) {
+        EXPECT_EQ(QStringLiteral("FLAC Test"), title);
+    }
+}
+
+TEST_F(TagReadServiceTest, RequestsRunOnTheScheduler)
+{
+    TagReadService service;
+
+    auto metadata = service.requestMetaData(Track{m_file.fileName()});
+    auto cover    = service.requestCover(Track{m_file.fileName()});
+
+    metadata.waitForFinished();
+    cover.waitForFinished();
+
+    EXPECT_EQ(QStringLiteral("FLAC Test"), metadata.result().title());
+    EXPECT_EQ(2U, service.stats().reads);
+}
+} // namespace Fooyin::Testing
@@ -19,6 +19,7 @@
 
 #include "testutils.h"
 
+#include "core/library/tagwritejob.h"
 #include "core/tagging/tagreader.h"
 #include "core/tagging/tagwriter.h"
 
@@ -456,4 +457,81 @@ TEST_F(TagWriterTest, WavWrite)
         EXPECT_EQ(writeTag.front(), QStringLiteral("Success"));
     }
 }
+
+TEST_F(TagWriterTest, WriteJob)
+{
+    const TempResource first{QStringLiteral(":/audio/audiotest.flac")};
+    const TempResource second{QStringLiteral(":/audio/audiotest.mp3")};
+
+    TrackList tracks;
+    for(const auto* file : {&first, &second}) {
+        Track track{file->fileName()};
+        Tagging::readMetaData(track);
+        track.setId(static_cast<int>(tracks.size()));
+        track.setTitle(QStringLiteral("BatchTitle"));
+        tracks.push_back(track);
+    }
+
+    TrackList written;
+    std::vector<int> progress;
+
+    TagWriteJob job;
+    QObject::connect(&job, &TagWriteJob::writtenTracks, [&written](const TrackList& result) { written = result; });
+    QObject::connect(&job, &TagWriteJob::progressChanged, [&progress](int percent) { progress.push_back(percent); });
+    job.write(tracks);
+
+    ASSERT_EQ(2U, written.size());
+    ASSERT_FALSE(progress.empty());
+    EXPECT_EQ(100, progress.back());
+
+    for(const auto* file : {&first, &second}) {
+        Track track{file->fileName()};
+        Tagging::readMetaData(track);
+        EXPECT_EQ(track.title(), QStringLiteral("BatchTitle"));
+    }
+}
+
+TEST_F(TagWriterTest, StatisticsOnlyWrite)
+{
+    const TempResource file{QStringLiteral(":/audio/audiotest.mp3")};
+
+    QString title;
+    {
+        Track track{file.fileName()};
+        Tagging::readMetaData(track);
+        title = track.title();
+
+        track.setId(0);
+        track.setTitle(QStringLiteral("Unsaved"));
+        track.setRating(0.8F);
+        track.setPlayCount(5);
+
+        EXPECT_NE(Tagging::WriteResult::Failed, Tagging::writeMetaData(track, {.statisticsOnly = true}));
+    }
+
+    {
+        Track track{file.fileName()};
+        Tagging::readMetaData(track);
+
+        EXPECT_EQ(track.title(), title);
+        EXPECT_FLOAT_EQ(track.rating(), 0.8F);
+        EXPECT_EQ(track.playCount(), 5);
+    }
+}
+
+TEST_F(TagWriterTest, ReportsRewrites)
+{
+    const TempResource file{QStringLiteral(":/audio/audiotest.mp3")};
+
+    Track track{file.fileName()};
+    Tagging::readMetaData(track);
+    track.setId(0);
+
+    // Far larger than any padding in the file
+    track.setComment(QString{20000, u'c'});
+    EXPECT_EQ(Tagging::WriteResult::Rewritten, Tagging::writeMetaData(track, {}));
+
+    track.setComment(QString{19990, u'c'});
+    EXPECT_EQ(Tagging::WriteResult::InPlace, Tagging::writeMetaData(track, {}));
+}
 } // namespace Fooyin::Testing
@@ -0,0 +1,273 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/taskscheduler.h>
+#include <utils/worker.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace Fooyin::Testing {
+TEST(TaskSchedulerTest, RunsAllTasks)
+{
+    std::atomic<int> count{0};
+    std::promise<void> done;
+
+    {
+        TaskScheduler scheduler{4};
+        constexpr int Total = 1000;
+        for(int i{0}; i < Total; ++i) {
+            scheduler.submit(static_cast<TaskScheduler::Lane>(i % 4), [&]() {
+                if(count.fetch_add(1) + 1 == Total) {
+                    done.set_value();
+                }
+            });
+        }
+        ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(10s));
+    }
+
+    EXPECT_EQ(1000, count.load());
+}
+
+TEST(TaskSchedulerTest, LaneLimits)
+{
+    const TaskScheduler scheduler{4};
+
+    EXPECT_EQ(4, scheduler.threadCount());
+    EXPECT_EQ(4, scheduler.laneLimit(TaskScheduler::Lane::Interactive));
+    EXPECT_EQ(3, scheduler.laneLimit(TaskScheduler::Lane::Background));
+    EXPECT_EQ(2, scheduler.laneLimit(TaskScheduler::Lane::IO));
+    EXPECT_EQ(3, scheduler.laneLimit(TaskScheduler::Lane::Idle));
+
+    const TaskScheduler single{1};
+    EXPECT_EQ(2, single.threadCount());
+    EXPECT_EQ(1, single.laneLimit(TaskScheduler::Lane::Background));
+}
+
+TEST(TaskSchedulerTest, InteractiveRunsBehindBlockedBackground)
+{
+    TaskScheduler scheduler{2};
+
+    std::promise<void> release;
+    const auto released = release.get_future().share();
+
+    // Fill the background lane, which should still leave a thread for interactive work
+    for(int i{0}; i < 4; ++i) {
+        scheduler.submit(TaskScheduler::Lane::Background, [released]() { released.wait(); });
+    }
+
+    std::promise<void> interactive;
+    scheduler.submit(TaskScheduler::Lane::Interactive, [&interactive]() { interactive.set_value(); });
+
+    EXPECT_EQ(std::future_status::ready, interactive.get_future().wait_for(10s));
+    release.set_value();
+}
+
+TEST(TaskSchedulerTest, TasksSubmittedFromTasks)
+{
+    TaskScheduler scheduler{3};
+
+    std::atomic<int> count{0};
+    std::promise<void> done;
+
+    scheduler.submit(TaskScheduler::Lane::Interactive, [&]() {
+        for(int i{0}; i < 100; ++i) {
+            scheduler.submit(TaskScheduler::Lane::Interactive, [&]() {
+                if(count.fetch_add(1) + 1 == 100) {
+                    done.set_value();
+                }
+            });
+        }
+    });
+
+    EXPECT_EQ(std::future_status::ready, done.get_future().wait_for(10s));
+}
+
+TEST(TaskSchedulerTest, PausedIdleWorkWaitsForThrottle)
+{
+    TaskScheduler scheduler{2};
+    scheduler.setThrottle(TaskScheduler::Throttle::Paused);
+
+    std::promise<void> idle;
+    auto idleRan = idle.get_future();
+    scheduler.submit(TaskScheduler::Lane::Idle, [&idle]() { idle.set_value(); });
+
+    // Other lanes aren't held back
+    std::promise<void> background;
+    scheduler.submit(TaskScheduler::Lane::Background, [&background]() { background.set_value(); });
+    EXPECT_EQ(std::future_status::ready, background.get_future().wait_for(10s));
+    EXPECT_EQ(std::future_status::timeout, idleRan.wait_for(100ms));
+
+    scheduler.setThrottle(TaskScheduler::Throttle::None);
+    EXPECT_EQ(std::future_status::ready, idleRan.wait_for(10s));
+}
+
+TEST(TaskSchedulerTest, UnthrottleReleasesIdleWork)
+{
+    TaskScheduler scheduler{2};
+    scheduler.setThrottle(TaskScheduler::Throttle::Paused);
+
+    std::promise<void> idle;
+    auto idleRan = idle.get_future();
+    scheduler.submit(TaskScheduler::Lane::Idle, [&idle]() { idle.set_value(); });
+    EXPECT_EQ(std::future_status::timeout, idleRan.wait_for(100ms));
+
+    {
+        const TaskScheduler::Unthrottle unthrottle{&scheduler};
+        EXPECT_EQ(-1, scheduler.idleLimit());
+        EXPECT_EQ(std::future_status::ready, idleRan.wait_for(10s));
+    }
+
+    EXPECT_EQ(0, scheduler.idleLimit());
+    scheduler.setThrottle(TaskScheduler::Throttle::None);
+}
+
+TEST(TaskSchedulerTest, IdleGateFollowsThrottle)
+{
+    TaskScheduler scheduler{2};
+    IdleGate gate{&scheduler};
+
+    // Steps aren't limited unless throttled
+    EXPECT_TRUE(gate.acquire({}));
+    EXPECT_TRUE(gate.acquire({}));
+    gate.release();
+    gate.release();
+
+    scheduler.setThrottle(TaskScheduler::Throttle::Reduced);
+    EXPECT_EQ(1, scheduler.idleLimit());
+    ASSERT_TRUE(gate.acquire({}));
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> acquired{true};
+    std::thread second{[&]() { acquired = gate.acquire([&cancelled]() { return cancelled.load(); }); }};
+    std::this_thread::sleep_for(50ms);
+    cancelled = true;
+    second.join();
+
+    EXPECT_FALSE(acquired);
+    gate.release();
+
+    scheduler.setThrottle(TaskScheduler::Throttle::Paused);
+    EXPECT_FALSE(gate.acquire([]() { return true; }));
+
+    scheduler.setThrottle(TaskScheduler::Throttle::None);
+    EXPECT_TRUE(gate.acquire({}));
+    gate.release();
+}
+
+TEST(WorkerTest, TasksRunInOrder)
+{
+    Worker worker;
+
+    std::mutex mutex;
+    std::vector<int> order;
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+
+    for(int i{0}; i < 200; ++i) {
+        worker.schedule([&, i]() {
+            if(running.fetch_add(1) != 0) {
+                overlapped = true;
+            }
+            {
+                const std::scoped_lock lock{mutex};
+                order.push_back(i);
+            }
+            running.fetch_sub(1);
+        });
+    }
+
+    worker.waitForTasks();
+
+    EXPECT_FALSE(overlapped);
+    ASSERT_EQ(200U, order.size());
+    for(int i{0}; i < 200; ++i) {
+        EXPECT_EQ(i, order.at(i));
+    }
+}
+
+TEST(WorkerTest, CloseDropsQueuedTasks)
+{
+    Worker worker;
+
+    std::promise<void> started;
+    std::promise<void> release;
+    auto released = release.get_future();
+    std::atomic<int> count{0};
+
+    worker.schedule([&]() {
+        started.set_value();
+        released.wait();
+    });
+    for(int i{0}; i < 10; ++i) {
+        worker.schedule([&count]() { ++count; });
+    }
+
+    started.get_future().wait();
+    worker.closeThread();
+    release.set_value();
+    worker.waitForTasks();
+
+    EXPECT_EQ(0, count.load());
+    EXPECT_TRUE(worker.closing());
+}
+
+TEST(WorkerTest, StartJobSupersedesEarlierTasks)
+{
+    Worker worker;
+
+    std::promise<void> started;
+    std::atomic<uint64_t> firstGeneration{0};
+    std::atomic<bool> firstCancelled{false};
+    std::atomic<int> dropped{0};
+    std::atomic<uint64_t> secondGeneration{0};
+
+    worker.schedule([&]() {
+        worker.setState(Worker::Running);
+        firstGeneration = worker.jobGeneration();
+        started.set_value();
+        while(worker.mayRun()) {
+            std::this_thread::sleep_for(1ms);
+        }
+        firstCancelled = true;
+    });
+    worker.schedule([&dropped]() { ++dropped; });
+
+    started.get_future().wait();
+    worker.startJob([&]() {
+        worker.setState(Worker::Running);
+        secondGeneration = worker.jobGeneration();
+    });
+    worker.waitForTasks();
+
+    EXPECT_TRUE(firstCancelled);
+    EXPECT_EQ(0, dropped.load());
+    EXPECT_FALSE(worker.isCurrent(firstGeneration));
+    EXPECT_TRUE(worker.isCurrent(secondGeneration));
+    EXPECT_TRUE(worker.mayRun());
+}
+} // namespace Fooyin::Testing
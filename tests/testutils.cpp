@@ -35,4 +35,64 @@ TempResource::TempResource(const QString& filename, QObject* parent)
 
     reset();
 }
+
+Track makeTrack(int id, const TrackFields& fields)
+{
+    Track track{fields.filepath.isEmpty() ? QStringLiteral("/music/%1.flac").arg(id) : fields.filepath};
+    track.setId(id);
+
+    if(!fields.title.isEmpty()) {
+        track.setTitle(fields.title);
+    }
+    if(!fields.artist.isEmpty()) {
+        track.setArtists({fields.artist});
+    }
+    if(!fields.album.isEmpty()) {
+        track.setAlbum(fields.album);
+    }
+    if(!fields.genres.isEmpty()) {
+        track.setGenres(fields.genres);
+    }
+    if(!fields.sort.isEmpty()) {
+        track.setSort(fields.sort);
+    }
+    if(fields.year >= 0) {
+        track.setYear(fields.year);
+    }
+    if(fields.duration > 0) {
+        track.setDuration(fields.duration);
+    }
+    if(fields.fileSize > 0) {
+        track.setFileSize(fields.fileSize);
+    }
+    if(fields.playCount > 0) {
+        track.setPlayCount(fields.playCount);
+    }
+    if(fields.addedTime > 0) {
+        track.setAddedTime(fields.addedTime);
+    }
+    if(fields.libraryId >= 0) {
+        track.setLibraryId(fields.libraryId);
+    }
+
+    return track;
+}
+
+QList<int> ids(const TrackList& tracks)
+{
+    QList<int> result;
+    for(const auto& track : tracks) {
+        result.append(track.id());
+    }
+    return result;
+}
+
+QStringList titles(const TrackList& tracks)
+{
+    QStringList result;
+    for(const auto& track : tracks) {
+        result.append(track.title());
+    }
+    return result;
+}
 } // namespace Fooyin::Testing
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <core/track.h>
+
 #include <QTemporaryFile>
 
 namespace Fooyin::Testing {
@@ -27,4 +29,31 @@ class TempResource : public QTemporaryFile
 public:
     explicit TempResource(const QString& filename, QObject* parent = nullptr);
 };
+
+/** The fields set by makeTrack. Those left at their defaults aren't set. */
+struct TrackFields
+{
+    // Defaults to /music/<id>.flac
+    QString filepath;
+    QString title;
+    QString artist;
+    QString album;
+    QStringList genres;
+    QString sort;
+    // No year, as for a default Track
+    int year{-1};
+    uint64_t duration{0};
+    uint64_t fileSize{0};
+    int playCount{0};
+    uint64_t addedTime{0};
+    int libraryId{-1};
+};
+
+/** Returns a track with @p id and @p fields, as tests build their libraries from. */
+Track makeTrack(int id, const TrackFields& fields = {});
+
+/** Returns the ids of @p tracks in order. */
+QList<int> ids(const TrackList& tracks);
+/** Returns the titles of @p tracks in order. */
+QStringList titles(const TrackList& tracks);
 } // namespace Fooyin::Testing
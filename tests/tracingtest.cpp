@@ -0,0 +1,145 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/tracing.h>
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <set>
+#include <thread>
+
+namespace {
+QJsonArray readEvents(const QString& path)
+{
+    QFile file{path};
+    if(!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return QJsonDocument::fromJson(file.readAll()).object().value(QStringLiteral("traceEvents")).toArray();
+}
+
+int countEvents(const QJsonArray& events, const QString& name)
+{
+    int count{0};
+    for(const auto& value : events) {
+        if(value.toObject().value(QStringLiteral("name")).toString() == name) {
+            ++count;
+        }
+    }
+    return count;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+class TracingTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if(!Tracing::isAvailable()) {
+            GTEST_SKIP() << "Built without BUILD_TRACING";
+        }
+        ASSERT_TRUE(m_dir.isValid());
+        Tracing::start();
+    }
+
+    void TearDown() override
+    {
+        Tracing::stop();
+    }
+
+    [[nodiscard]] QString path() const
+    {
+        return m_dir.filePath(QStringLiteral("trace.json"));
+    }
+
+private:
+    QTemporaryDir m_dir;
+};
+
+TEST_F(TracingTest, RecordsSpansOnEachThread)
+{
+    {
+        const Tracing::Span span{"Main"};
+    }
+
+    std::thread worker{[]() {
+        const Tracing::Span outer{"Outer"};
+        const Tracing::Span inner{"Inner"};
+    }};
+    worker.join();
+
+    ASSERT_TRUE(Tracing::dump(path()));
+    // Recording carries on after a dump
+    EXPECT_TRUE(Tracing::isRecording());
+
+    const QJsonArray events = readEvents(path());
+    EXPECT_EQ(1, countEvents(events, QStringLiteral("Main")));
+    EXPECT_EQ(1, countEvents(events, QStringLiteral("Outer")));
+    EXPECT_EQ(1, countEvents(events, QStringLiteral("Inner")));
+    // One per thread, including the one which has since exited
+    EXPECT_EQ(2, countEvents(events, QStringLiteral("thread_name")));
+
+    std::set<int> threads;
+    for(const auto& value : events) {
+        threads.insert(value.toObject().value(QStringLiteral("tid")).toInt());
+    }
+    EXPECT_EQ(2, threads.size());
+}
+
+TEST_F(TracingTest, KeepsOnlyTheMostRecentSpans)
+{
+    for(int i{0}; i < 10000; ++i) {
+        const Tracing::Span span{"Repeated"};
+    }
+    {
+        const Tracing::Span span{"Last"};
+    }
+
+    ASSERT_TRUE(Tracing::dump(path()));
+
+    const QJsonArray events = readEvents(path());
+    EXPECT_EQ(1, countEvents(events, QStringLiteral("Last")));
+    EXPECT_EQ(8191, countEvents(events, QStringLiteral("Repeated")));
+}
+
+TEST_F(TracingTest, SpansStartedWhileStoppedAreDropped)
+{
+    Tracing::stop();
+    {
+        const Tracing::Span span{"Stopped"};
+    }
+    Tracing::start();
+    {
+        const Tracing::Span span{"Started"};
+    }
+
+    ASSERT_TRUE(Tracing::dump(path()));
+
+    const QJsonArray events = readEvents(path());
+    EXPECT_EQ(0, countEvents(events, QStringLiteral("Stopped")));
+    EXPECT_EQ(1, countEvents(events, QStringLiteral("Started")));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,145 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include <core/library/trackcolumns.h>
+#include <core/track.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+std::vector<uint32_t> selectedRows(const std::vector<uint64_t>& words, size_t count)
+{
+    std::vector<uint32_t> rows;
+    for(uint32_t row{0}; row < count; ++row) {
+        if((words[row / 64] >> (row % 64)) & 1) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+using Field = TrackQuery::Field;
+
+TEST(TrackColumnsTest, SelectsRange)
+{
+    // Spans more than one word, with a partial last word
+    TrackList tracks;
+    for(int i{0}; i < 150; ++i) {
+        tracks.push_back(makeTrack(i + 1, {.year = i % 10 == 0 ? 0 : 1900 + i}));
+    }
+
+    TrackColumns columns;
+    columns.build(tracks);
+
+    ASSERT_EQ(150U, columns.size());
+    EXPECT_TRUE(std::isnan(columns.values(Field::Year)[0]));
+    EXPECT_EQ(1901.0, columns.values(Field::Year)[1]);
+
+    std::vector<uint64_t> words((columns.size() + 63) / 64);
+
+    TrackQuery::Range range;
+    range.low  = 1995;
+    range.high = 2039;
+    columns.selectRange(Field::Year, range, words);
+
+    std::vector<uint32_t> expected;
+    for(uint32_t row{95}; row <= 139; ++row) {
+        if(row % 10 != 0) {
+            expected.push_back(row);
+        }
+    }
+    EXPECT_EQ(expected, selectedRows(words, columns.size()));
+
+    range.lowExclusive  = true;
+    range.highExclusive = true;
+    columns.selectRange(Field::Year, range, words);
+
+    expected.erase(std::ranges::find(expected, 95U));
+    expected.pop_back();
+    EXPECT_EQ(expected, selectedRows(words, columns.size()));
+}
+
+TEST(TrackColumnsTest, SelectsDictionaryCodes)
+{
+    const TrackList tracks{makeTrack(1, {.genres = {QStringLiteral("Rock")}, .year = 2000}),
+                           makeTrack(2, {.genres = {QStringLiteral("Jazz"), QStringLiteral("rock")}, .year = 2000}),
+                           makeTrack(3, {.filepath = QStringLiteral("/music/3.mp3"), .year = 2000}),
+                           makeTrack(4, {.filepath = QStringLiteral("/music/4.mp3"),
+                                         .genres   = {QStringLiteral("Pop")},
+                                         .year     = 2000})};
+
+    TrackColumns columns;
+    columns.build(tracks);
+
+    // Values are case folded, and each is held once
+    const auto genres = columns.dictionary(Field::Genre);
+    ASSERT_EQ(3U, genres.size());
+    EXPECT_EQ(QStringLiteral("rock"), genres[0]);
+    EXPECT_EQ(QStringLiteral("jazz"), genres[1]);
+    EXPECT_EQ(QStringLiteral("pop"), genres[2]);
+
+    std::vector<uint64_t> words(1);
+    columns.selectCodes(Field::Genre, {true, false, false}, words);
+    EXPECT_EQ(std::vector<uint32_t>({0, 1}), selectedRows(words, columns.size()));
+
+    columns.selectCodes(Field::Genre, {false, true, true}, words);
+    EXPECT_EQ(std::vector<uint32_t>({1, 3}), selectedRows(words, columns.size()));
+
+    const auto extensions = columns.dictionary(Field::Extension);
+    ASSERT_EQ(2U, extensions.size());
+    EXPECT_EQ(QStringLiteral("mp3"), extensions[1]);
+
+    columns.selectCodes(Field::Extension, {false, true}, words);
+    EXPECT_EQ(std::vector<uint32_t>({2, 3}), selectedRows(words, columns.size()));
+}
+
+TEST(TrackColumnsTest, RadixSortIsStable)
+{
+    constexpr double NoValue = std::numeric_limits<double>::quiet_NaN();
+    const std::vector<double> keys{3.5, -2.0, NoValue, 3.5, 0.0, -0.0, 1e12, -2.0};
+
+    EXPECT_EQ(std::vector<uint32_t>({2, 1, 7, 4, 5, 0, 3, 6}), TrackColumns::radixSort(keys));
+    EXPECT_EQ(std::vector<uint32_t>({6, 0, 3, 4, 5, 1, 7, 2}), TrackColumns::radixSort(keys, Qt::DescendingOrder));
+}
+
+TEST(TrackColumnsTest, RadixSortMatchesSort)
+{
+    std::vector<double> keys;
+    uint64_t seed{12345};
+    for(int i{0}; i < 5000; ++i) {
+        seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+        keys.push_back(static_cast<double>(seed >> 40) / 16.0);
+    }
+
+    std::vector<uint32_t> expected(keys.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    std::ranges::stable_sort(expected, [&keys](uint32_t lhs, uint32_t rhs) { return keys[lhs] < keys[rhs]; });
+
+    EXPECT_EQ(expected, TrackColumns::radixSort(keys));
+}
+} // namespace Fooyin::Testing
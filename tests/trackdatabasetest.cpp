@@ -0,0 +1,171 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "core/database/trackdatabase.h"
+
+#include <utils/database/dbconnectionhandler.h>
+#include <utils/database/dbconnectionprovider.h>
+#include <utils/database/dbquery.h>
+
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <ostream>
+
+namespace Fooyin::Testing {
+struct AlbumTotals
+{
+    int trackCount{0};
+    int duration{0};
+    QString format;
+
+    bool operator==(const AlbumTotals& other) const = default;
+};
+
+void PrintTo(const AlbumTotals& totals, std::ostream* os)
+{
+    *os << "{" << totals.trackCount << ", " << totals.duration << ", \"" << totals.format.toStdString() << "\"}";
+}
+
+// Runs the summary triggers against just the columns they read and write, rather than the whole schema
+class TrackDatabaseTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+
+        DbConnection::DbParams params;
+        params.type     = QStringLiteral("QSQLITE");
+        params.filePath = m_dir.filePath(QStringLiteral("test.db"));
+
+        m_pool    = DbConnectionPool::create(params, QStringLiteral("trackdatabasetest"));
+        m_handler = DbConnectionHandler{m_pool};
+        ASSERT_TRUE(m_handler.hasConnection());
+
+        ASSERT_TRUE(exec(QStringLiteral("CREATE TABLE Albums (AlbumID INTEGER PRIMARY KEY, TrackCount INTEGER "
+                                        "DEFAULT 0, Duration INTEGER DEFAULT 0, Format TEXT);")));
+        ASSERT_TRUE(exec(QStringLiteral("CREATE TABLE Tracks (TrackID INTEGER PRIMARY KEY, FilePath TEXT, "
+                                        "Duration INTEGER DEFAULT 0, AlbumID INTEGER);")));
+        ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Albums (AlbumID) VALUES (1), (2);")));
+    }
+
+    [[nodiscard]] QSqlDatabase db() const
+    {
+        return DbConnectionProvider{m_pool}.db();
+    }
+
+    bool exec(const QString& statement) const
+    {
+        DbQuery query{db(), statement};
+        return query.exec();
+    }
+
+    [[nodiscard]] AlbumTotals totals(int albumId) const
+    {
+        DbQuery query{db(), QStringLiteral("SELECT TrackCount, Duration, Format FROM Albums WHERE AlbumID = :id;")};
+        query.bindValue(QStringLiteral(":id"), albumId);
+
+        if(!query.exec() || !query.next()) {
+            return {.trackCount = -1};
+        }
+        return {.trackCount = query.value(0).toInt(),
+                .duration   = query.value(1).toInt(),
+                .format     = query.value(2).toString()};
+    }
+
+    QTemporaryDir m_dir;
+    DbConnectionPoolPtr m_pool;
+    DbConnectionHandler m_handler;
+};
+
+TEST_F(TrackDatabaseTest, SummarisesStoredAlbums)
+{
+    ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Tracks (FilePath, Duration, AlbumID) VALUES "
+                                    "('/music/one.flac', 100, 1), ('/music/two.FLAC', 200, 1), "
+                                    "('/music/three.mp3', 300, 1);")));
+
+    ASSERT_TRUE(TrackDatabase::summariseAlbums(db()));
+
+    EXPECT_EQ((AlbumTotals{3, 600, QStringLiteral("flac")}), totals(1));
+    EXPECT_EQ((AlbumTotals{0, 0, QString{}}), totals(2));
+}
+
+TEST_F(TrackDatabaseTest, UpdatesOnInsert)
+{
+    ASSERT_TRUE(TrackDatabase::summariseAlbums(db()));
+
+    ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Tracks (FilePath, Duration, AlbumID) VALUES "
+                                    "('/music/one.ogg', 100, 1);")));
+    EXPECT_EQ((AlbumTotals{1, 100, QStringLiteral("ogg")}), totals(1));
+
+    ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Tracks (FilePath, Duration, AlbumID) VALUES "
+                                    "('/music/two.opus', 50, 1), ('/music/three.opus', 50, 1);")));
+    EXPECT_EQ((AlbumTotals{3, 200, QStringLiteral("opus")}), totals(1));
+}
+
+TEST_F(TrackDatabaseTest, UpdatesBothAlbumsOnRelink)
+{
+    ASSERT_TRUE(TrackDatabase::summariseAlbums(db()));
+    ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Tracks (TrackID, FilePath, Duration, AlbumID) VALUES "
+                                    "(1, '/music/one.flac', 100, 1), (2, '/music/two.mp3', 200, 1);")));
+
+    ASSERT_TRUE(exec(QStringLiteral("UPDATE Tracks SET AlbumID = 2 WHERE TrackID = 2;")));
+
+    EXPECT_EQ((AlbumTotals{1, 100, QStringLiteral("flac")}), totals(1));
+    EXPECT_EQ((AlbumTotals{1, 200, QStringLiteral("mp3")}), totals(2));
+}
+
+TEST_F(TrackDatabaseTest, UpdatesOnDelete)
+{
+    ASSERT_TRUE(TrackDatabase::summariseAlbums(db()));
+    ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Tracks (TrackID, FilePath, Duration, AlbumID) VALUES "
+                                    "(1, '/music/one.flac', 100, 1), (2, '/music/two.mp3', 200, 1);")));
+
+    ASSERT_TRUE(exec(QStringLiteral("DELETE FROM Tracks WHERE TrackID = 1;")));
+    EXPECT_EQ((AlbumTotals{1, 200, QStringLiteral("mp3")}), totals(1));
+
+    ASSERT_TRUE(exec(QStringLiteral("DELETE FROM Tracks WHERE TrackID = 2;")));
+    EXPECT_EQ((AlbumTotals{0, 0, QString{}}), totals(1));
+}
+
+TEST_F(TrackDatabaseTest, UpdatesOnPathChange)
+{
+    ASSERT_TRUE(TrackDatabase::summariseAlbums(db()));
+    ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Tracks (TrackID, FilePath, Duration, AlbumID) VALUES "
+                                    "(1, '/music/one.wav', 100, 1);")));
+
+    ASSERT_TRUE(exec(QStringLiteral("UPDATE Tracks SET FilePath = '/music/one.flac' WHERE TrackID = 1;")));
+    EXPECT_EQ((AlbumTotals{1, 100, QStringLiteral("flac")}), totals(1));
+}
+
+TEST_F(TrackDatabaseTest, IgnoresFilesWithoutExtension)
+{
+    ASSERT_TRUE(TrackDatabase::summariseAlbums(db()));
+
+    // The '.' in the directory name isn't taken as the start of an extension
+    ASSERT_TRUE(exec(QStringLiteral("INSERT INTO Tracks (FilePath, Duration, AlbumID) VALUES "
+                                    "('/music/Vol.1/one', 100, 1), ('/music/Vol.1/two', 100, 1), "
+                                    "('/music/Vol.1/three.mka', 100, 1), ('/music/Vol.2/four', 100, 2);")));
+
+    EXPECT_EQ((AlbumTotals{3, 300, QStringLiteral("mka")}), totals(1));
+    EXPECT_EQ((AlbumTotals{1, 100, QString{}}), totals(2));
+}
+} // namespace Fooyin::Testing
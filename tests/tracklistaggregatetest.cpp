@@ -0,0 +1,78 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include <core/scripting/tracklistaggregate.h>
+#include <core/track.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(TrackListAggregateTest, SumsTracks)
+{
+    const Track rock     = makeTrack(1, {.genres = {QStringLiteral("Rock")}, .duration = 1000, .fileSize = 10000});
+    const Track jazzRock = makeTrack(2, {.genres   = {QStringLiteral("Jazz"), QStringLiteral("Rock")},
+                                         .duration = 2500,
+                                         .fileSize = 25000});
+    const TrackListAggregate aggregate{{rock, jazzRock}};
+
+    EXPECT_EQ(2, aggregate.trackCount());
+    EXPECT_EQ(3500U, aggregate.duration());
+    EXPECT_EQ(35000U, aggregate.fileSize());
+
+    const std::map<QString, int> expected{{QStringLiteral("Jazz"), 1}, {QStringLiteral("Rock"), 2}};
+    EXPECT_EQ(expected, aggregate.genres());
+}
+
+TEST(TrackListAggregateTest, CountsRepeatedGenreOnce)
+{
+    TrackListAggregate aggregate;
+    aggregate.add(makeTrack(1, {.genres = {QStringLiteral("Rock"), QStringLiteral("Rock")}, .duration = 1000}));
+
+    EXPECT_EQ(1, aggregate.genres().at(QStringLiteral("Rock")));
+}
+
+TEST(TrackListAggregateTest, RemovesTracks)
+{
+    const Track rock = makeTrack(1, {.genres = {QStringLiteral("Rock")}, .duration = 1000, .fileSize = 10000});
+    const Track jazz = makeTrack(2, {.genres = {QStringLiteral("Jazz")}, .duration = 2000, .fileSize = 20000});
+
+    TrackListAggregate aggregate{{rock, jazz}};
+    aggregate.remove(rock);
+
+    EXPECT_EQ(1, aggregate.trackCount());
+    EXPECT_EQ(2000U, aggregate.duration());
+    EXPECT_FALSE(aggregate.genres().contains(QStringLiteral("Rock")));
+    EXPECT_TRUE(aggregate.genres().contains(QStringLiteral("Jazz")));
+}
+
+TEST(TrackListAggregateTest, MergesTotals)
+{
+    TrackListAggregate first{{makeTrack(1, {.genres = {QStringLiteral("Rock")}, .duration = 1000, .fileSize = 10000})}};
+    const TrackListAggregate second{
+        {makeTrack(2, {.genres = {QStringLiteral("Rock")}, .duration = 500, .fileSize = 5000})}};
+
+    first.merge(second);
+
+    EXPECT_EQ(2, first.trackCount());
+    EXPECT_EQ(1500U, first.duration());
+    EXPECT_EQ(2, first.genres().at(QStringLiteral("Rock")));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,81 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include <core/library/tracklistdiff.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(TrackListDiffTest, FindsAddedAndRemovedTracks)
+{
+    const Track first  = makeTrack(1);
+    const Track second = makeTrack(2);
+    const Track third  = makeTrack(3);
+
+    const auto diff = diffTracks({first, second}, {third, first});
+    ASSERT_TRUE(diff.has_value());
+    ASSERT_EQ(1U, diff->added.size());
+    EXPECT_EQ(3, diff->added.front().id());
+    ASSERT_EQ(1U, diff->removed.size());
+    EXPECT_EQ(2, diff->removed.front().id());
+}
+
+TEST(TrackListDiffTest, IgnoresOrder)
+{
+    const TrackList tracks{makeTrack(1), makeTrack(2), makeTrack(3)};
+    const TrackList reversed{tracks.rbegin(), tracks.rend()};
+
+    const auto diff = diffTracks(tracks, reversed);
+    ASSERT_TRUE(diff.has_value());
+    EXPECT_TRUE(diff->empty());
+}
+
+TEST(TrackListDiffTest, MatchesDuplicatesOneForOne)
+{
+    const Track track = makeTrack(1);
+
+    const auto diff = diffTracks({track}, {track, track});
+    ASSERT_TRUE(diff.has_value());
+    ASSERT_EQ(1U, diff->added.size());
+    EXPECT_TRUE(diff->removed.empty());
+}
+
+TEST(TrackListDiffTest, ReplacesEditedTracks)
+{
+    const Track track = makeTrack(1);
+    Track edited{track};
+    edited.setTitle(QStringLiteral("Edited"));
+
+    const auto diff = diffTracks({track}, {edited});
+    ASSERT_TRUE(diff.has_value());
+    ASSERT_EQ(1U, diff->added.size());
+    EXPECT_EQ(QStringLiteral("Edited"), diff->added.front().title());
+    ASSERT_EQ(1U, diff->removed.size());
+    EXPECT_TRUE(diff->removed.front().title().isEmpty());
+}
+
+TEST(TrackListDiffTest, RejectsTracksNotInDatabase)
+{
+    const Track unknown{QStringLiteral("/music/unknown.flac")};
+
+    EXPECT_FALSE(diffTracks({makeTrack(1)}, {unknown}).has_value());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,185 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "testutils.h"
+
+#include <core/library/trackquery.h>
+#include <core/library/trackqueryindex.h>
+#include <core/library/tracksearchindex.h>
+#include <core/track.h>
+
+#include <gtest/gtest.h>
+
+constexpr uint64_t Now      = 1'700'000'000'000;
+constexpr uint64_t MinuteMs = 60 * 1000;
+constexpr uint64_t DayMs    = 24 * 60 * 60 * 1000;
+
+namespace Fooyin::Testing {
+class TrackQueryTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_tracks = {makeTrack(1, {.title     = QStringLiteral("Roygbiv"),
+                                  .artist    = QStringLiteral("Boards of Canada"),
+                                  .year      = 1998,
+                                  .duration  = 1 * MinuteMs,
+                                  .playCount = 12,
+                                  .addedTime = Now - (400 * DayMs)}),
+                    makeTrack(2, {.title     = QStringLiteral("Xtal"),
+                                  .artist    = QStringLiteral("Aphex Twin"),
+                                  .year      = 1992,
+                                  .duration  = 2 * MinuteMs,
+                                  .playCount = 3,
+                                  .addedTime = Now - (10 * DayMs)}),
+                    makeTrack(3, {.title     = QStringLiteral("Jóga"),
+                                  .artist    = QStringLiteral("Björk"),
+                                  .year      = 1997,
+                                  .duration  = 3 * MinuteMs,
+                                  .addedTime = Now - (2 * DayMs)}),
+                    makeTrack(4, {.title     = QStringLiteral("Avril 14th"),
+                                  .artist    = QStringLiteral("Aphex Twin"),
+                                  .year      = 2001,
+                                  .duration  = 4 * MinuteMs,
+                                  .playCount = 25}),
+                    makeTrack(5, {.title     = QStringLiteral("Bike"),
+                                  .artist    = QStringLiteral("Autechre"),
+                                  .year      = 1994,
+                                  .duration  = 5 * MinuteMs,
+                                  .playCount = 7,
+                                  .addedTime = Now - (40 * DayMs)})};
+        m_tracks[2].addExtraTag(QStringLiteral("MOOD"), QStringLiteral("Calm"));
+        m_tracks[4].addExtraTag(QStringLiteral("MOOD"), QStringLiteral("Dark"));
+
+        m_index.build(m_tracks);
+        m_searchIndex.build(m_tracks);
+    }
+
+    [[nodiscard]] QStringList evaluate(const QString& query) const
+    {
+        return titles(m_index.evaluate(TrackQuery::parse(query), Now, &m_searchIndex));
+    }
+
+    [[nodiscard]] QStringList bruteForce(const QString& query) const
+    {
+        const TrackQuery parsed = TrackQuery::parse(query);
+
+        TrackList result;
+        for(const Track& track : m_tracks) {
+            if(parsed.matches(track, Now)) {
+                result.push_back(track);
+            }
+        }
+        return titles(result);
+    }
+
+    TrackList m_tracks;
+    TrackQueryIndex m_index;
+    TrackSearchIndex m_searchIndex;
+};
+
+TEST_F(TrackQueryTest, ParsesValidQueries)
+{
+    const QStringList queries{QStringLiteral("aphex"),
+                              QStringLiteral("artist = \"Aphex Twin\""),
+                              QStringLiteral("year >= 1995 AND (playcount > 5 OR added < 30 days)"),
+                              QStringLiteral("NOT genre:ambient"),
+                              QStringLiteral("duration < 3:30"),
+                              QStringLiteral("added > 2w"),
+                              QStringLiteral("lastplayed >= 2024-01-31")};
+
+    for(const QString& query : queries) {
+        const TrackQuery parsed = TrackQuery::parse(query);
+        EXPECT_TRUE(parsed.isValid()) << query.toStdString() << ": " << parsed.error().toStdString();
+    }
+}
+
+TEST_F(TrackQueryTest, RejectsInvalidQueries)
+{
+    const QStringList queries{QStringLiteral("(year > 1990"), QStringLiteral("year >"),
+                              QStringLiteral("year > soon"), QStringLiteral("title = \"unterminated"),
+                              QStringLiteral("added < 3fortnights"), QStringLiteral("aphex AND"),
+                              QStringLiteral("year > 1990)")};
+
+    for(const QString& query : queries) {
+        const TrackQuery parsed = TrackQuery::parse(query);
+        EXPECT_FALSE(parsed.isValid()) << query.toStdString();
+        EXPECT_FALSE(parsed.error().isEmpty());
+    }
+}
+
+TEST_F(TrackQueryTest, EmptyQueryMatchesEverything)
+{
+    const TrackQuery query = TrackQuery::parse({});
+    EXPECT_TRUE(query.isValid());
+    EXPECT_TRUE(query.isEmpty());
+    EXPECT_EQ(m_tracks.size(), m_index.evaluate(query, Now).size());
+}
+
+TEST_F(TrackQueryTest, ComparesFields)
+{
+    EXPECT_EQ(evaluate(QStringLiteral("artist = \"aphex twin\"")),
+              (QStringList{QStringLiteral("Xtal"), QStringLiteral("Avril 14th")}));
+    EXPECT_EQ(evaluate(QStringLiteral("title:i")),
+              (QStringList{QStringLiteral("Roygbiv"), QStringLiteral("Avril 14th"), QStringLiteral("Bike")}));
+    EXPECT_EQ(evaluate(QStringLiteral("year < 1995")), (QStringList{QStringLiteral("Xtal"), QStringLiteral("Bike")}));
+    EXPECT_EQ(evaluate(QStringLiteral("duration > 3:00")),
+              (QStringList{QStringLiteral("Avril 14th"), QStringLiteral("Bike")}));
+    EXPECT_EQ(evaluate(QStringLiteral("mood = calm")), QStringList{QStringLiteral("Jóga")});
+}
+
+TEST_F(TrackQueryTest, ComparesAges)
+{
+    EXPECT_EQ(evaluate(QStringLiteral("added < 30 days")),
+              (QStringList{QStringLiteral("Xtal"), QStringLiteral("Jóga")}));
+    EXPECT_EQ(evaluate(QStringLiteral("added > 1y")), QStringList{QStringLiteral("Roygbiv")});
+    // Tracks without an added time don't match either way
+    EXPECT_FALSE(evaluate(QStringLiteral("added > 0")).contains(QStringLiteral("Avril 14th")));
+}
+
+TEST_F(TrackQueryTest, CombinesTerms)
+{
+    EXPECT_EQ(evaluate(QStringLiteral("aphex playcount > 5")), QStringList{QStringLiteral("Avril 14th")});
+    EXPECT_EQ(evaluate(QStringLiteral("year > 1996 AND NOT artist = björk")),
+              (QStringList{QStringLiteral("Roygbiv"), QStringLiteral("Avril 14th")}));
+    EXPECT_EQ(evaluate(QStringLiteral("mood = dark OR year = 1992")),
+              (QStringList{QStringLiteral("Xtal"), QStringLiteral("Bike")}));
+}
+
+TEST_F(TrackQueryTest, IndexMatchesBruteForce)
+{
+    const QStringList queries{QStringLiteral("a"),
+                              QStringLiteral("twin"),
+                              QStringLiteral("artist != \"aphex twin\""),
+                              QStringLiteral("title >= b"),
+                              QStringLiteral("year >= 1995 AND (playcount > 5 OR added < 30 days)"),
+                              QStringLiteral("NOT (mood:a OR plays = 0)"),
+                              QStringLiteral("duration <= 120"),
+                              QStringLiteral("added = 10d"),
+                              QStringLiteral("mood > c year < 2000"),
+                              QStringLiteral("NOT NOT bike")};
+
+    for(const QString& query : queries) {
+        EXPECT_EQ(bruteForce(query), evaluate(query)) << query.toStdString();
+        EXPECT_EQ(bruteForce(query), titles(m_index.evaluate(TrackQuery::parse(query), Now)))
+            << query.toStdString();
+    }
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,131 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include <core/library/trackfilter.h>
+#include <core/library/tracksearchindex.h>
+#include <core/track.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+class TrackSearchIndexTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_tracks = {makeTrack(1, {.title  = QStringLiteral("Roygbiv"),
+                                  .artist = QStringLiteral("Boards of Canada"),
+                                  .album  = QStringLiteral("Music Has the Right to Children")}),
+                    makeTrack(2, {.title  = QStringLiteral("Xtal"),
+                                  .artist = QStringLiteral("Aphex Twin"),
+                                  .album  = QStringLiteral("Selected Ambient Works 85-92")}),
+                    makeTrack(3, {.title  = QStringLiteral("Jóga"),
+                                  .artist = QStringLiteral("Björk"),
+                                  .album  = QStringLiteral("Homogenic")}),
+                    makeTrack(4, {.title  = QStringLiteral("Bike"),
+                                  .artist = QStringLiteral("Autechre"),
+                                  .album  = QStringLiteral("Amber")})};
+        m_index.build(m_tracks);
+    }
+
+    TrackList m_tracks;
+    TrackSearchIndex m_index;
+};
+
+TEST_F(TrackSearchIndexTest, MatchesLinearFilter)
+{
+    const QStringList searches{QStringLiteral("a"),      QStringLiteral("tw"),      QStringLiteral("AMB"),
+                               QStringLiteral("björk"),  QStringLiteral("JÓGA"),    QStringLiteral("85-92"),
+                               QStringLiteral("roygbiv"), QStringLiteral("missing"), QStringLiteral("ambient works")};
+
+    for(const QString& search : searches) {
+        EXPECT_EQ(titles(Filter::filterTracks(m_tracks, search)), titles(m_index.filter(m_tracks, search)))
+            << search.toStdString();
+    }
+}
+
+TEST_F(TrackSearchIndexTest, KeepsOrderOfInput)
+{
+    const TrackList reversed{m_tracks.rbegin(), m_tracks.rend()};
+    EXPECT_EQ(QStringList({QStringLiteral("Bike"), QStringLiteral("Xtal")}),
+              titles(m_index.filter(reversed, QStringLiteral("am"))));
+}
+
+TEST_F(TrackSearchIndexTest, IgnoresAccents)
+{
+    EXPECT_EQ(QStringList{QStringLiteral("Jóga")}, titles(m_index.filter(m_tracks, QStringLiteral("jog"))));
+    EXPECT_EQ(QStringList{QStringLiteral("Jóga")}, titles(Filter::filterTracks(m_tracks, QStringLiteral("JOGA"))));
+
+    // Decomposed and precomposed accents match each other
+    EXPECT_EQ(TrackSearchIndex::searchKey(QStringLiteral("Beyonce\u0301")),
+              TrackSearchIndex::searchKey(QStringLiteral("Beyoncé")));
+    EXPECT_EQ(QStringLiteral("beyonce"), TrackSearchIndex::searchKey(QStringLiteral("Beyoncé")));
+}
+
+TEST_F(TrackSearchIndexTest, UpdatesAndRemovesTracks)
+{
+    Track renamed = m_tracks.at(3);
+    renamed.setTitle(QStringLiteral("Gantz Graf"));
+    m_index.update({renamed});
+
+    TrackList tracks{m_tracks.at(0), m_tracks.at(1), m_tracks.at(2), renamed};
+    EXPECT_TRUE(m_index.filter(tracks, QStringLiteral("bike")).empty());
+    EXPECT_EQ(QStringList{QStringLiteral("Gantz Graf")}, titles(m_index.filter(tracks, QStringLiteral("gantz"))));
+
+    m_index.remove({m_tracks.at(1)});
+    EXPECT_EQ(3, m_index.size());
+
+    // Tracks which aren't indexed are still compared directly
+    EXPECT_EQ(QStringList{QStringLiteral("Xtal")}, titles(m_index.filter(tracks, QStringLiteral("xtal"))));
+}
+
+TEST_F(TrackSearchIndexTest, LinearFilterFollowsChangedTracks)
+{
+    EXPECT_EQ(QStringList{QStringLiteral("Bike")}, titles(Filter::filterTracks(m_tracks, QStringLiteral("bike"))));
+
+    // The cached text of the track as it was isn't matched once it changes
+    Track renamed = m_tracks.at(3);
+    renamed.setTitle(QStringLiteral("Gantz Graf"));
+
+    const TrackList tracks{renamed};
+    EXPECT_TRUE(Filter::filterTracks(tracks, QStringLiteral("bike")).empty());
+    EXPECT_EQ(QStringList{QStringLiteral("Gantz Graf")}, titles(Filter::filterTracks(tracks, QStringLiteral("gantz"))));
+}
+
+TEST_F(TrackSearchIndexTest, CompactsRemovedTracks)
+{
+    TrackList tracks;
+    for(int i{0}; i < 3000; ++i) {
+        tracks.push_back(makeTrack(i + 10, {.title  = QStringLiteral("Title %1").arg(i),
+                                            .artist = QStringLiteral("Artist %1").arg(i),
+                                            .album  = QStringLiteral("Album")}));
+    }
+    m_index.build(tracks);
+
+    const TrackList removed{tracks.begin(), tracks.begin() + 2000};
+    const TrackList remaining{tracks.begin() + 2000, tracks.end()};
+    m_index.remove(removed);
+    EXPECT_EQ(1000, m_index.size());
+
+    EXPECT_EQ(1000U, m_index.filter(remaining, QStringLiteral("title 2")).size());
+    EXPECT_EQ(QStringList{QStringLiteral("Title 2999")}, titles(m_index.filter(remaining, QStringLiteral("e 2999"))));
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,86 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include <core/library/tracksnapshot.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(TrackSnapshotTest, LooksUpTracksById)
+{
+    const TrackSnapshot snapshot{
+        {makeTrack(3, {.title = QStringLiteral("C")}), makeTrack(1, {.title = QStringLiteral("A")})}};
+
+    ASSERT_EQ(2U, snapshot.size());
+    EXPECT_TRUE(snapshot.contains(1));
+    EXPECT_FALSE(snapshot.contains(2));
+    ASSERT_NE(nullptr, snapshot.track(3));
+    EXPECT_EQ(QStringLiteral("C"), snapshot.track(3)->title());
+
+    const TrackList found = snapshot.tracksForIds({1, 2, 3});
+    ASSERT_EQ(2U, found.size());
+    EXPECT_EQ(1, found.at(0).id());
+    EXPECT_EQ(3, found.at(1).id());
+}
+
+TEST(TrackSnapshotTest, UpdatesLeaveOriginalUntouched)
+{
+    const TrackSnapshot original{
+        {makeTrack(1, {.title = QStringLiteral("A")}), makeTrack(2, {.title = QStringLiteral("B")})}};
+    const TrackSnapshot copy{original};
+    EXPECT_EQ(&original.tracks(), &copy.tracks());
+
+    const TrackSnapshot updated = original.updated(
+        {makeTrack(2, {.title = QStringLiteral("B2")}), makeTrack(5, {.title = QStringLiteral("Unknown")})});
+
+    ASSERT_EQ(2U, updated.size());
+    EXPECT_EQ(QStringLiteral("B2"), updated.tracks().at(1).title());
+    EXPECT_FALSE(updated.contains(5));
+    EXPECT_EQ(QStringLiteral("B"), original.tracks().at(1).title());
+}
+
+TEST(TrackSnapshotTest, DefaultIsEmpty)
+{
+    const TrackSnapshot snapshot;
+
+    EXPECT_TRUE(snapshot.empty());
+    EXPECT_EQ(nullptr, snapshot.track(1));
+    EXPECT_TRUE(snapshot.tracksForIds({1}).empty());
+    EXPECT_EQ(nullptr, snapshot.trackForPath(QStringLiteral("/music/1.flac")));
+}
+
+TEST(TrackSnapshotTest, LooksUpTracksByPath)
+{
+    Track cueTrack = makeTrack(2, {.title = QStringLiteral("Cue")});
+    cueTrack.setCuePath(QStringLiteral("/music/2.cue"));
+
+    const TrackSnapshot snapshot{{makeTrack(1, {.title = QStringLiteral("A")}), cueTrack}};
+    const TrackSnapshot copy{snapshot};
+
+    const Track* track = snapshot.trackForPath(QStringLiteral("/music/1.flac"));
+    ASSERT_NE(nullptr, track);
+    EXPECT_EQ(1, track->id());
+    EXPECT_EQ(track, copy.trackForPath(QStringLiteral("/music/1.flac")));
+
+    EXPECT_EQ(nullptr, snapshot.trackForPath(QStringLiteral("/music/2.flac")));
+    EXPECT_EQ(nullptr, snapshot.trackForPath(QStringLiteral("/music/3.flac")));
+}
+} // namespace Fooyin::Testing
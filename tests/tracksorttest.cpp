@@ -0,0 +1,147 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "testutils.h"
+
+#include <core/library/tracksort.h>
+#include <core/track.h>
+
+#include <QCollator>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+QStringList sortKeys(const Fooyin::TrackList& tracks)
+{
+    QStringList keys;
+    for(const Fooyin::Track& track : tracks) {
+        keys.push_back(track.sort());
+    }
+    return keys;
+}
+} // namespace
+
+namespace Fooyin::Testing {
+TEST(TrackSortTest, MergeMatchesFullSort)
+{
+    const TrackList library = Sorting::sortTracks({makeTrack(1, {.sort = QStringLiteral("Track 2")}),
+                                                   makeTrack(2, {.sort = QStringLiteral("Track 10")}),
+                                                   makeTrack(3, {.sort = QStringLiteral("Track 5")}),
+                                                   makeTrack(4, {.sort = QStringLiteral("Track 1")})});
+    const TrackList changes = {makeTrack(2, {.sort = QStringLiteral("Track 3")}),
+                               makeTrack(5, {.sort = QStringLiteral("Track 20")}),
+                               makeTrack(6, {.sort = QStringLiteral("Track 0")})};
+
+    TrackList combined;
+    for(const Track& track : library) {
+        if(track.id() != 2) {
+            combined.push_back(track);
+        }
+    }
+    combined.insert(combined.end(), changes.cbegin(), changes.cend());
+
+    const TrackList merged = Sorting::mergeTracks(library, changes);
+
+    ASSERT_EQ(6U, merged.size());
+    EXPECT_EQ(sortKeys(Sorting::sortTracks(combined)), sortKeys(merged));
+    EXPECT_EQ(QStringLiteral("Track 0"), merged.front().sort());
+    EXPECT_EQ(QStringLiteral("Track 20"), merged.back().sort());
+}
+
+TEST(TrackSortTest, MergeDescending)
+{
+    const TrackList library = {makeTrack(1, {.sort = QStringLiteral("C")}), makeTrack(2, {.sort = QStringLiteral("B")}),
+                               makeTrack(3, {.sort = QStringLiteral("A")})};
+
+    const TrackList merged
+        = Sorting::mergeTracks(library, {makeTrack(3, {.sort = QStringLiteral("D")})}, Qt::DescendingOrder);
+
+    EXPECT_EQ(QStringList({QStringLiteral("D"), QStringLiteral("C"), QStringLiteral("B")}), sortKeys(merged));
+}
+
+TEST(TrackSortTest, SortingByKeysLeavesSortFields)
+{
+    const TrackList tracks = {makeTrack(1), makeTrack(2), makeTrack(3)};
+    const QString script   = QStringLiteral("%track%");
+
+    const std::vector<QString> keys = Sorting::calcSortKeys(script, tracks);
+    ASSERT_EQ(3U, keys.size());
+
+    const std::vector<int> order
+        = Sorting::sortIndexes({QStringLiteral("b"), QStringLiteral("a"), QStringLiteral("b")});
+    EXPECT_EQ(std::vector<int>({1, 0, 2}), order);
+
+    const TrackList sorted = Sorting::calcSortTracks(script, tracks, Qt::DescendingOrder);
+    ASSERT_EQ(3U, sorted.size());
+    for(const Track& track : sorted) {
+        EXPECT_TRUE(track.sort().isEmpty());
+    }
+}
+TEST(TrackSortTest, ParallelSortMatchesStableSort)
+{
+    // Spans several chunks, with plenty of equal keys to check the merges keep their order
+    std::vector<QString> keys;
+    for(int i{0}; i < 100000; ++i) {
+        keys.push_back(QStringLiteral("Artist %1").arg((i * 7919) % 997));
+    }
+
+    QCollator collator;
+    collator.setNumericMode(true);
+
+    std::vector<int> expected(keys.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    std::ranges::stable_sort(
+        expected, [&collator, &keys](int lhs, int rhs) { return collator.compare(keys[lhs], keys[rhs]) < 0; });
+
+    EXPECT_EQ(expected, Sorting::sortIndexes(keys));
+
+    std::ranges::stable_sort(
+        expected, [&collator, &keys](int lhs, int rhs) { return collator.compare(keys[lhs], keys[rhs]) > 0; });
+
+    EXPECT_EQ(expected, Sorting::sortIndexes(keys, Qt::DescendingOrder));
+}
+
+TEST(TrackSortTest, SortOrderOfSelectedIndexes)
+{
+    const std::vector<QString> keys{QStringLiteral("d"), QStringLiteral("c"), QStringLiteral("b"),
+                                    QStringLiteral("a")};
+
+    // Only the first, third and fourth keys are sorted amongst themselves
+    EXPECT_EQ(std::vector<int>({3, 1, 2, 0}), Sorting::sortIndexes(keys, {0, 2, 3, 7}));
+
+    TrackList tracks = {makeTrack(1), makeTrack(2), makeTrack(3)};
+    tracks[0].setTitle(QStringLiteral("B"));
+    tracks[1].setTitle(QStringLiteral("A"));
+    tracks[2].setTitle(QStringLiteral("C"));
+
+    const QString script   = QStringLiteral("%title%");
+    const TrackList sorted = Sorting::applySortOrder(tracks, Sorting::calcSortOrder(script, tracks));
+
+    ASSERT_EQ(3U, sorted.size());
+    EXPECT_EQ(2, sorted.at(0).id());
+    EXPECT_EQ(1, sorted.at(1).id());
+    EXPECT_EQ(3, sorted.at(2).id());
+
+    const std::vector<int> partial = Sorting::calcSortOrder(script, tracks, {0, 1}, Qt::DescendingOrder);
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), partial);
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,185 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <core/track.h>
+#include <utils/crypto.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(TrackTest, DerivesPathComponents)
+{
+    const Track track{QStringLiteral("/music/Artist/Album/01. Intro.flac")};
+
+    EXPECT_EQ(QStringLiteral("01. Intro"), track.filename());
+    EXPECT_EQ(QStringLiteral("flac"), track.extension());
+    EXPECT_EQ(QStringLiteral("01. Intro.flac"), track.filenameExt());
+
+    const Track noSuffix{QStringLiteral("/music/Artist.Name/track")};
+    EXPECT_EQ(QStringLiteral("track"), noSuffix.filename());
+    EXPECT_TRUE(noSuffix.extension().isEmpty());
+}
+
+TEST(TrackTest, RelativePathSurvivesMove)
+{
+    Track track{QStringLiteral("/music/Artist/01.flac")};
+    track.setRelativePath(QStringLiteral("Artist/01.flac"));
+    EXPECT_EQ(QStringLiteral("Artist/01.flac"), track.relativePath());
+
+    const Track copy{track};
+    track.setFilePath(QStringLiteral("/other/Artist/02.flac"));
+
+    EXPECT_EQ(QStringLiteral("Artist/01.flac"), track.relativePath());
+    EXPECT_EQ(QStringLiteral("Artist/01.flac"), copy.relativePath());
+    EXPECT_EQ(QStringLiteral("01"), copy.filename());
+}
+
+TEST(TrackTest, SplitsArchivePaths)
+{
+    const Track track{Track::archiveFilepath(QStringLiteral("/music/Album.zip"), QStringLiteral("CD1/01.flac"))};
+
+    EXPECT_TRUE(track.isInArchive());
+    EXPECT_EQ(QStringLiteral("/music/Album.zip"), track.archivePath());
+    EXPECT_EQ(QStringLiteral("CD1/01.flac"), track.pathInArchive());
+    EXPECT_EQ(QStringLiteral("/music"), track.path());
+    EXPECT_EQ(QStringLiteral("01"), track.filename());
+    EXPECT_EQ(QStringLiteral("flac"), track.extension());
+
+    const Track file{QStringLiteral("/music/Album/01.flac")};
+    EXPECT_FALSE(file.isInArchive());
+    EXPECT_TRUE(file.archivePath().isEmpty());
+    EXPECT_TRUE(file.pathInArchive().isEmpty());
+}
+
+TEST(TrackTest, ExtraTagsDecodeLazily)
+{
+    Track source;
+    source.addExtraTag(QStringLiteral("MOOD"), QStringLiteral("Calm"));
+    source.addExtraTag(QStringLiteral("MOOD"), QStringLiteral("Dark"));
+    const QByteArray blob = source.serialiseExtrasTags();
+    ASSERT_FALSE(blob.isEmpty());
+
+    Track track;
+    track.storeExtraTags(blob);
+    // Stored tags round-trip untouched
+    EXPECT_EQ(blob, track.serialiseExtrasTags());
+
+    const Track copy{track};
+    EXPECT_TRUE(copy.hasExtraTag(QStringLiteral("MOOD")));
+    EXPECT_EQ(QStringList({QStringLiteral("Calm"), QStringLiteral("Dark")}), track.extraTag(QStringLiteral("MOOD")));
+
+    track.removeExtraTag(QStringLiteral("MOOD"));
+    EXPECT_FALSE(track.hasExtraTag(QStringLiteral("MOOD")));
+    EXPECT_TRUE(copy.hasExtraTag(QStringLiteral("MOOD")));
+    EXPECT_EQ(QStringList{QStringLiteral("MOOD")}, track.removedTags());
+}
+
+TEST(TrackTest, Hash64MatchesReference)
+{
+    // Reference values of XXH64 with a seed of 0
+    EXPECT_EQ(0xEF46DB3751D8E999ULL, Utils::hash64("", 0));
+    EXPECT_EQ(0x44BC2CF5AD770999ULL, Utils::hash64("abc", 3));
+
+    const QByteArray longInput{"Nobody inspects the spammish repetition"};
+    EXPECT_EQ(0xFBCEA83C8A378BF1ULL, Utils::hash64(longInput.constData(), static_cast<size_t>(longInput.size())));
+
+    EXPECT_NE(Utils::generateHash64(QStringLiteral("ab"), QStringLiteral("c")),
+              Utils::generateHash64(QStringLiteral("a"), QStringLiteral("bc")));
+}
+
+TEST(TrackTest, HashFollowsMetadata)
+{
+    Track track{QStringLiteral("/music/Artist/Album/01.flac")};
+    track.setArtists({QStringLiteral("Artist")});
+    track.setAlbum(QStringLiteral("Album"));
+    track.setTitle(QStringLiteral("Intro"));
+    track.setTrackNumber(1);
+
+    const uint64_t hash = track.generateHash();
+    EXPECT_NE(0U, hash);
+
+    // The same metadata elsewhere has the same hash
+    Track moved{QStringLiteral("/other/01.flac")};
+    moved.setArtists({QStringLiteral("Artist")});
+    moved.setAlbum(QStringLiteral("Album"));
+    moved.setTitle(QStringLiteral("Intro"));
+    moved.setTrackNumber(1);
+    EXPECT_EQ(hash, moved.generateHash());
+
+    // Once generated, the hash follows changes to the fields it's made from
+    track.setTrackNumber(2);
+    EXPECT_NE(hash, track.hash());
+    track.setTrackNumber(1);
+    EXPECT_EQ(hash, track.hash());
+}
+
+TEST(TrackTest, StatsChangeWithoutCopyingMetadata)
+{
+    Track track{QStringLiteral("/music/Artist/Album/01.flac")};
+    track.setTitle(QStringLiteral("Intro"));
+    track.setPlayCount(3);
+
+    Track played{track};
+    // Unchanged stats leave the copy sharing everything
+    played.setPlayCount(3);
+    played.setFirstPlayed(0);
+    EXPECT_TRUE(played.isSharedWith(track));
+
+    played.setPlayCount(4);
+    played.setLastPlayed(1000);
+    played.setRating(0.8F);
+
+    EXPECT_FALSE(played.isSharedWith(track));
+    EXPECT_EQ(4, played.playCount());
+    EXPECT_EQ(1000U, played.lastPlayed());
+    EXPECT_FLOAT_EQ(0.8F, played.rating());
+    EXPECT_EQ(3, track.playCount());
+    EXPECT_EQ(0U, track.lastPlayed());
+    EXPECT_FLOAT_EQ(-1.0F, track.rating());
+
+    // The metadata is still shared, so changing it detaches as usual
+    EXPECT_EQ(QStringLiteral("Intro"), played.title());
+    played.setTitle(QStringLiteral("Outro"));
+    EXPECT_EQ(QStringLiteral("Intro"), track.title());
+}
+
+TEST(TrackTest, AlbumIdFollowsAlbum)
+{
+    Track track{QStringLiteral("/music/Artist/Album/01.flac")};
+    track.setAlbum(QStringLiteral("Album"));
+    EXPECT_EQ(-1, track.albumId());
+
+    track.setAlbumId(5);
+    track.setTitle(QStringLiteral("Intro"));
+    track.setTrackNumber(1);
+    EXPECT_EQ(5, track.albumId());
+
+    // Changing anything making up the album leaves it unassigned until stored again
+    track.setAlbumArtists({QStringLiteral("Artist")});
+    EXPECT_EQ(-1, track.albumId());
+
+    track.setAlbumId(5);
+    track.setDate(QStringLiteral("2001"));
+    EXPECT_EQ(-1, track.albumId());
+
+    track.setAlbumId(5);
+    track.setFilePath(QStringLiteral("/music/Other/01.flac"));
+    EXPECT_EQ(-1, track.albumId());
+}
+} // namespace Fooyin::Testing
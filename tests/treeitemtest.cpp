@@ -0,0 +1,109 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <utils/treeitem.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+
+namespace Fooyin::Testing {
+namespace {
+class Node : public TreeItem<Node>
+{
+public:
+    using TreeItem::TreeItem;
+
+    void reverseChildren()
+    {
+        std::ranges::reverse(m_children);
+    }
+};
+
+void expectRows(const Node& parent)
+{
+    for(int i{0}; i < parent.childCount(); ++i) {
+        EXPECT_EQ(i, parent.child(i)->row());
+    }
+}
+} // namespace
+
+TEST(TreeItemTest, RowsFollowInsertsAndRemovals)
+{
+    std::deque<Node> nodes(10);
+    Node root;
+
+    for(int i{0}; i < 4; ++i) {
+        root.appendChild(&nodes.at(i));
+    }
+    root.insertChild(1, &nodes.at(4));
+    expectRows(root);
+    EXPECT_EQ(1, nodes.at(4).row());
+    EXPECT_EQ(4, nodes.at(3).row());
+
+    root.insertChildren(0, {&nodes.at(5), &nodes.at(6)});
+    expectRows(root);
+    EXPECT_EQ(2, nodes.at(0).row());
+
+    root.removeChildren(1, 3);
+    expectRows(root);
+    EXPECT_EQ(4, root.childCount());
+    EXPECT_EQ(1, nodes.at(1).row());
+
+    root.removeChild(0);
+    expectRows(root);
+    EXPECT_EQ(0, nodes.at(1).row());
+}
+
+TEST(TreeItemTest, RowsRenumberAfterDirectReordering)
+{
+    std::deque<Node> nodes(5);
+    Node root;
+    for(Node& node : nodes) {
+        root.appendChild(&node);
+    }
+
+    root.reverseChildren();
+    root.resetChildren();
+    expectRows(root);
+    EXPECT_EQ(4, nodes.front().row());
+
+    root.reverseChildren();
+    for(Node& node : nodes) {
+        node.resetRow();
+    }
+    EXPECT_EQ(4, nodes.back().row());
+    expectRows(root);
+}
+
+TEST(TreeItemTest, IgnoresInvalidRemovals)
+{
+    Node child;
+    Node root;
+    root.appendChild(&child);
+
+    root.removeChild(-1);
+    root.removeChild(1);
+    root.removeChildren(0, 2);
+    EXPECT_EQ(1, root.childCount());
+    EXPECT_EQ(0, child.row());
+}
+} // namespace Fooyin::Testing
@@ -0,0 +1,68 @@
+/*
+ * Fooyin
+ * Copyright © 2024, Luke Taylor <LukeT1@proton.me>
+ *
+ * Fooyin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Fooyin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Fooyin.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utils/valuetally.h>
+
+#include <gtest/gtest.h>
+
+namespace Fooyin::Testing {
+TEST(ValueTallyTest, CountsDistinctValues)
+{
+    ValueTally tally;
+    tally.add(QStringLiteral("b"));
+    tally.add(QStringList{QStringLiteral("a"), QStringLiteral("b")});
+    tally.add(QString{});
+
+    EXPECT_EQ(2U, tally.size());
+    EXPECT_EQ(2, tally.count(QStringLiteral("b")));
+    EXPECT_EQ((QStringList{QStringLiteral("a"), QStringLiteral("b")}), tally.values());
+}
+
+TEST(ValueTallyTest, RemovesLastOccurrence)
+{
+    ValueTally tally;
+    tally.add(QStringLiteral("a"));
+    tally.add(QStringLiteral("a"));
+
+    EXPECT_TRUE(tally.remove(QStringLiteral("a")));
+    EXPECT_EQ(1, tally.count(QStringLiteral("a")));
+    EXPECT_TRUE(tally.remove(QStringLiteral("a")));
+    EXPECT_TRUE(tally.empty());
+}
+
+TEST(ValueTallyTest, StopsCollectingPastLimit)
+{
+    ValueTally tally{2};
+    tally.add(QStringLiteral("a"));
+    tally.add(QStringLiteral("b"));
+    EXPECT_FALSE(tally.overflowed());
+
+    tally.add(QStringLiteral("a"));
+    EXPECT_FALSE(tally.overflowed());
+
+    tally.add(QStringLiteral("c"));
+    EXPECT_TRUE(tally.overflowed());
+    EXPECT_EQ(2U, tally.size());
+
+    tally.add(QStringLiteral("b"));
+    EXPECT_EQ(1, tally.count(QStringLiteral("b")));
+    EXPECT_FALSE(tally.remove(QStringLiteral("a")));
+    EXPECT_EQ(2, tally.count(QStringLiteral("a")));
+}
+} // namespace Fooyin::Testing